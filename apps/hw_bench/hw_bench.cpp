@@ -0,0 +1,464 @@
+/// @file hw_bench.cpp
+/// @brief Hardware-in-the-loop I2C / PCI throughput and latency sweep.
+///
+/// Adapters are enabled by the same environment variables as the
+/// integration tests; unset ones are skipped:
+///   PLAS_TEST_AARDVARK_PORT=port:address   e.g. 0:0x50
+///   PLAS_TEST_FT4222H_PORT=master:slave    e.g. 0:1 (target --i2c-addr)
+///   PLAS_TEST_PCIUTILS_BDF=DDDD:BB:DD.F    e.g. 0000:03:00.0
+///
+/// For every adapter the sweep runs bitrates x sizes x threads (PCI has no
+/// bitrate), with all threads sharing the one opened device, and reports
+/// p50/p99/p999/max latency of successful transfers and bytes/s over the
+/// whole point as CSV or JSON.
+///
+/// Usage: plas_hw_bench [options]
+///   --bitrates=100000,400000,1000000   I2C bus speeds in Hz
+///   --sizes=1,16,64,256                bytes per transfer
+///   --threads=1,2,4                    concurrent callers
+///   --iterations=1000                  transfers per thread per point
+///   --op=read|writeread|write          I2C operation (default read);
+///                                      write modifies the target!
+///   --i2c-addr=0x50                    FT4222H target (Aardvark: from env)
+///   --pci=config|bar0..bar5            PCI path (default config; config
+///                                      reads wrap at 256 bytes)
+///   --format=csv|json                  (default csv)
+///   --out=FILE                         (default stdout)
+///   --label=TEXT                       tag for every row, e.g. firmware
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/core/types.h"
+#include "plas/hal/driver/aardvark/aardvark_device.h"
+#include "plas/hal/driver/ft4222h/ft4222h_device.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/pci/types.h"
+
+#ifdef PLAS_HAS_PCIUTILS
+#include "plas/hal/driver/pciutils/pciutils_device.h"
+#endif
+
+namespace {
+
+using plas::core::Byte;
+using plas::hal::Device;
+using plas::hal::I2c;
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kWarmupOps = 10;
+constexpr size_t kPciConfigWindow = 256;  // always-present config header
+
+struct Options {
+    std::vector<uint32_t> bitrates{100000, 400000, 1000000};
+    std::vector<size_t> sizes{1, 16, 64, 256};
+    std::vector<size_t> threads{1, 2, 4};
+    size_t iterations = 1000;
+    std::string op = "read";
+    uint16_t i2c_addr = 0x50;
+    std::string pci = "config";
+    std::string format = "csv";
+    std::string out;
+    std::string label;
+};
+
+/// One transfer of `size` bytes through `buf`; true on success.
+using Transfer = std::function<bool(Byte* buf, size_t size)>;
+
+struct Point {
+    std::string adapter;
+    std::string op;
+    uint32_t bitrate = 0;  ///< 0 for PCI
+    size_t size = 0;
+    size_t threads = 0;
+    uint64_t ops = 0;
+    uint64_t errors = 0;
+    double p50_us = 0;
+    double p99_us = 0;
+    double p999_us = 0;
+    double max_us = 0;
+    double bytes_per_sec = 0;
+};
+
+template <typename T>
+bool ParseList(const char* text, std::vector<T>& out) {
+    out.clear();
+    const char* p = text;
+    while (*p != '\0') {
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(p, &end, 0);
+        if (end == p || value == 0) {
+            return false;
+        }
+        out.push_back(static_cast<T>(value));
+        p = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') {
+            return false;
+        }
+    }
+    return !out.empty();
+}
+
+bool ParseArgs(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        auto value = [arg](const char* name) -> const char* {
+            size_t n = std::strlen(name);
+            return std::strncmp(arg, name, n) == 0 && arg[n] == '=' ? arg + n + 1
+                                                                   : nullptr;
+        };
+        const char* v = nullptr;
+        if ((v = value("--bitrates"))) {
+            if (!ParseList(v, opts.bitrates)) return false;
+        } else if ((v = value("--sizes"))) {
+            if (!ParseList(v, opts.sizes)) return false;
+        } else if ((v = value("--threads"))) {
+            if (!ParseList(v, opts.threads)) return false;
+        } else if ((v = value("--iterations"))) {
+            opts.iterations = std::strtoull(v, nullptr, 0);
+            if (opts.iterations == 0) return false;
+        } else if ((v = value("--op"))) {
+            opts.op = v;
+            if (opts.op != "read" && opts.op != "writeread" && opts.op != "write") {
+                return false;
+            }
+        } else if ((v = value("--i2c-addr"))) {
+            opts.i2c_addr = static_cast<uint16_t>(std::strtoul(v, nullptr, 0));
+        } else if ((v = value("--pci"))) {
+            opts.pci = v;
+            if (opts.pci != "config" &&
+                !(opts.pci.size() == 4 && opts.pci.compare(0, 3, "bar") == 0 &&
+                  opts.pci[3] >= '0' && opts.pci[3] <= '5')) {
+                return false;
+            }
+        } else if ((v = value("--format"))) {
+            opts.format = v;
+            if (opts.format != "csv" && opts.format != "json") return false;
+        } else if ((v = value("--out"))) {
+            opts.out = v;
+        } else if ((v = value("--label"))) {
+            opts.label = v;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string Env(const char* name) {
+    const char* env = std::getenv(name);
+    return env != nullptr ? env : "";
+}
+
+/// Nearest-rank percentile of sorted samples, in microseconds.
+double Percentile(const std::vector<uint64_t>& sorted_ns, double p) {
+    if (sorted_ns.empty()) {
+        return 0;
+    }
+    auto rank = static_cast<size_t>(p * static_cast<double>(sorted_ns.size()) + 0.999999);
+    size_t index = rank == 0 ? 0 : std::min(rank, sorted_ns.size()) - 1;
+    return static_cast<double>(sorted_ns[index]) / 1000.0;
+}
+
+/// Run `transfer` from `threads` threads, `iterations` times each, once all
+/// threads have warmed up.
+Point RunPoint(const Transfer& transfer, size_t size, size_t threads,
+               size_t iterations) {
+    std::vector<std::vector<uint64_t>> latencies(threads);
+    std::vector<uint64_t> errors(threads, 0);
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::vector<Byte> buf(std::max<size_t>(size, 1));
+            auto& samples = latencies[t];
+            samples.reserve(iterations);
+            for (int i = 0; i < kWarmupOps; ++i) {
+                (void)transfer(buf.data(), size);
+            }
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < iterations; ++i) {
+                auto start = Clock::now();
+                bool ok = transfer(buf.data(), size);
+                auto elapsed = Clock::now() - start;
+                if (ok) {
+                    samples.push_back(static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                            .count()));
+                } else {
+                    ++errors[t];
+                }
+            }
+        });
+    }
+
+    while (ready.load() != threads) {
+        std::this_thread::yield();
+    }
+    auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double wall_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<uint64_t> all;
+    Point point;
+    point.size = size;
+    point.threads = threads;
+    for (size_t t = 0; t < threads; ++t) {
+        all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+        point.errors += errors[t];
+    }
+    std::sort(all.begin(), all.end());
+    point.ops = all.size();
+    point.p50_us = Percentile(all, 0.50);
+    point.p99_us = Percentile(all, 0.99);
+    point.p999_us = Percentile(all, 0.999);
+    point.max_us = all.empty() ? 0 : static_cast<double>(all.back()) / 1000.0;
+    point.bytes_per_sec =
+        wall_s > 0 ? static_cast<double>(point.ops * size) / wall_s : 0;
+    return point;
+}
+
+Transfer I2cTransfer(I2c& i2c, uint16_t addr, const std::string& op) {
+    if (op == "write") {
+        // First byte is the register/word address the target sees.
+        return [&i2c, addr](Byte* buf, size_t size) {
+            buf[0] = 0x00;
+            return i2c.Write(addr, buf, size).IsOk();
+        };
+    }
+    if (op == "writeread") {
+        return [&i2c, addr](Byte* buf, size_t size) {
+            const Byte reg = 0x00;
+            return i2c.WriteRead(addr, &reg, 1, buf, size).IsOk();
+        };
+    }
+    return [&i2c, addr](Byte* buf, size_t size) {
+        return i2c.Read(addr, buf, size).IsOk();
+    };
+}
+
+void SweepI2c(const std::string& adapter, Device& device, I2c& i2c,
+              uint16_t addr, const Options& opts, std::vector<Point>& points) {
+    if (device.Init().IsError() || device.Open().IsError()) {
+        std::fprintf(stderr, "[!] %s: Init/Open failed, skipped\n", adapter.c_str());
+        return;
+    }
+    auto transfer = I2cTransfer(i2c, addr, opts.op);
+    for (uint32_t bitrate : opts.bitrates) {
+        if (i2c.SetBitrate(bitrate).IsError()) {
+            std::fprintf(stderr, "[!] %s: SetBitrate(%u) failed, skipped\n",
+                         adapter.c_str(), bitrate);
+            continue;
+        }
+        for (size_t size : opts.sizes) {
+            for (size_t threads : opts.threads) {
+                auto point = RunPoint(transfer, size, threads, opts.iterations);
+                point.adapter = adapter;
+                point.op = opts.op;
+                point.bitrate = i2c.GetBitrate();
+                std::fprintf(stderr, "[*] %s %u Hz %zu B x%zu: p50 %.1f us, %.0f B/s\n",
+                             adapter.c_str(), point.bitrate, size, threads,
+                             point.p50_us, point.bytes_per_sec);
+                points.push_back(std::move(point));
+            }
+        }
+    }
+    (void)device.Close();
+}
+
+#ifdef PLAS_HAS_PCIUTILS
+void SweepPci(const std::string& bdf_text, const Options& opts,
+              std::vector<Point>& points) {
+    auto address = plas::hal::pci::PciAddress::FromString(bdf_text);
+    if (address.IsError()) {
+        std::fprintf(stderr, "[!] pciutils: bad BDF '%s', skipped\n", bdf_text.c_str());
+        return;
+    }
+    plas::config::DeviceEntry entry{"bench_pci", "pciutils://" + bdf_text,
+                                    "pciutils", {}};
+    plas::hal::driver::PciUtilsDevice device(entry);
+    if (device.Init().IsError() || device.Open().IsError()) {
+        std::fprintf(stderr, "[!] pciutils: Init/Open failed, skipped\n");
+        return;
+    }
+    const auto bdf = address.Value().bdf;
+
+    Transfer transfer;
+    if (opts.pci == "config") {
+        transfer = [&device, bdf](Byte* buf, size_t size) {
+            if (size == 1) {
+                auto r = device.ReadConfig8(bdf, 0);
+                return r.IsOk() ? (buf[0] = r.Value(), true) : false;
+            }
+            if (size == 2) {
+                auto r = device.ReadConfig16(bdf, 0);
+                if (r.IsError()) {
+                    return false;
+                }
+                uint16_t value = r.Value();
+                std::memcpy(buf, &value, sizeof(value));
+                return true;
+            }
+            for (size_t off = 0; off < size; off += 4) {
+                auto r = device.ReadConfig32(
+                    bdf, static_cast<plas::hal::pci::ConfigOffset>(off % kPciConfigWindow));
+                if (r.IsError()) {
+                    return false;
+                }
+                uint32_t value = r.Value();
+                std::memcpy(buf + off, &value, std::min<size_t>(4, size - off));
+            }
+            return true;
+        };
+    } else {
+        auto bar = static_cast<uint8_t>(opts.pci[3] - '0');
+        transfer = [&device, bdf, bar](Byte* buf, size_t size) {
+            return device.BarReadBuffer(bdf, bar, 0, buf, size).IsOk();
+        };
+    }
+
+    const std::string adapter = "pciutils";
+    const std::string op = opts.pci + "-read";
+    for (size_t size : opts.sizes) {
+        for (size_t threads : opts.threads) {
+            auto point = RunPoint(transfer, size, threads, opts.iterations);
+            point.adapter = adapter;
+            point.op = op;
+            std::fprintf(stderr, "[*] %s %s %zu B x%zu: p50 %.1f us, %.0f B/s\n",
+                         adapter.c_str(), op.c_str(), size, threads, point.p50_us,
+                         point.bytes_per_sec);
+            points.push_back(std::move(point));
+        }
+    }
+    (void)device.Close();
+}
+#endif
+
+void WriteCsv(std::FILE* out, const std::vector<Point>& points,
+              const std::string& label) {
+    std::fprintf(out,
+                 "label,adapter,op,bitrate_hz,size,threads,ops,errors,"
+                 "p50_us,p99_us,p999_us,max_us,bytes_per_sec\n");
+    for (const auto& p : points) {
+        std::fprintf(out, "%s,%s,%s,%u,%zu,%zu,%llu,%llu,%.3f,%.3f,%.3f,%.3f,%.1f\n",
+                     label.c_str(), p.adapter.c_str(), p.op.c_str(), p.bitrate,
+                     p.size, p.threads, static_cast<unsigned long long>(p.ops),
+                     static_cast<unsigned long long>(p.errors), p.p50_us, p.p99_us,
+                     p.p999_us, p.max_us, p.bytes_per_sec);
+    }
+}
+
+void WriteJson(std::FILE* out, const std::vector<Point>& points,
+               const std::string& label, size_t iterations) {
+    // Labels come from the command line; keep the JSON valid regardless.
+    std::string escaped;
+    for (char c : label) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        if (static_cast<unsigned char>(c) >= 0x20) {
+            escaped += c;
+        }
+    }
+    std::fprintf(out, "{\n  \"label\": \"%s\",\n  \"iterations\": %zu,\n  \"results\": [",
+                 escaped.c_str(), iterations);
+    for (size_t i = 0; i < points.size(); ++i) {
+        const auto& p = points[i];
+        std::fprintf(out,
+                     "%s\n    {\"adapter\": \"%s\", \"op\": \"%s\", \"bitrate_hz\": %u, "
+                     "\"size\": %zu, \"threads\": %zu, \"ops\": %llu, \"errors\": %llu, "
+                     "\"p50_us\": %.3f, \"p99_us\": %.3f, \"p999_us\": %.3f, "
+                     "\"max_us\": %.3f, \"bytes_per_sec\": %.1f}",
+                     i == 0 ? "" : ",", p.adapter.c_str(), p.op.c_str(), p.bitrate,
+                     p.size, p.threads, static_cast<unsigned long long>(p.ops),
+                     static_cast<unsigned long long>(p.errors), p.p50_us, p.p99_us,
+                     p.p999_us, p.max_us, p.bytes_per_sec);
+    }
+    std::fprintf(out, "\n  ]\n}\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!ParseArgs(argc, argv, opts)) {
+        std::fprintf(stderr,
+                     "usage: %s [--bitrates=HZ,..] [--sizes=N,..] [--threads=N,..]\n"
+                     "          [--iterations=N] [--op=read|writeread|write]\n"
+                     "          [--i2c-addr=ADDR] [--pci=config|barN]\n"
+                     "          [--format=csv|json] [--out=FILE] [--label=TEXT]\n",
+                     argv[0]);
+        return 2;
+    }
+
+    std::vector<Point> points;
+
+    if (auto port = Env("PLAS_TEST_AARDVARK_PORT"); !port.empty()) {
+        uint16_t addr = opts.i2c_addr;
+        auto colon = port.find(':');
+        if (colon != std::string::npos && colon + 1 < port.size()) {
+            addr = static_cast<uint16_t>(std::strtoul(port.c_str() + colon + 1, nullptr, 0));
+        }
+        plas::hal::driver::AardvarkDevice device(
+            {"bench_aardvark", "aardvark://" + port, "aardvark", {}});
+        SweepI2c("aardvark", device, device, addr, opts, points);
+    }
+
+    if (auto port = Env("PLAS_TEST_FT4222H_PORT"); !port.empty()) {
+        plas::hal::driver::Ft4222hDevice device(
+            {"bench_ft4222h", "ft4222h://" + port, "ft4222h", {}});
+        SweepI2c("ft4222h", device, device, opts.i2c_addr, opts, points);
+    }
+
+    if (auto bdf = Env("PLAS_TEST_PCIUTILS_BDF"); !bdf.empty()) {
+#ifdef PLAS_HAS_PCIUTILS
+        SweepPci(bdf, opts, points);
+#else
+        std::fprintf(stderr, "[!] pciutils driver not built (libpci not found), skipped\n");
+#endif
+    }
+
+    if (points.empty()) {
+        std::fprintf(stderr,
+                     "[!] nothing measured: set PLAS_TEST_AARDVARK_PORT, "
+                     "PLAS_TEST_FT4222H_PORT and/or PLAS_TEST_PCIUTILS_BDF\n");
+        return 1;
+    }
+
+    std::FILE* out = stdout;
+    if (!opts.out.empty()) {
+        out = std::fopen(opts.out.c_str(), "w");
+        if (out == nullptr) {
+            std::fprintf(stderr, "[!] cannot open %s\n", opts.out.c_str());
+            return 1;
+        }
+    }
+    if (opts.format == "json") {
+        WriteJson(out, points, opts.label, opts.iterations);
+    } else {
+        WriteCsv(out, points, opts.label);
+    }
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    return 0;
+}
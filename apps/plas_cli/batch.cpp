@@ -0,0 +1,496 @@
+#include "batch.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include "plas/bootstrap/bootstrap.h"
+#include "plas/core/error.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/power_control.h"
+
+namespace plas::cli {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Sleep this close to a scheduled start, then yield-spin the rest.
+constexpr auto kSpinWindow = std::chrono::microseconds(200);
+
+constexpr std::size_t kMaxI2cRead = 4096;
+constexpr uint64_t kMaxPowerOffMs = 600000;
+
+bool ParseNumber(const std::string& text, uint64_t max, uint64_t& out) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long value = std::strtoull(text.c_str(), &end, 0);
+    if (errno != 0 || *end != '\0' || value > max) return false;
+    out = value;
+    return true;
+}
+
+/// "<number>[ns|us|ms|s]"; a bare number is milliseconds.
+bool ParseDuration(const std::string& text, std::chrono::nanoseconds& out) {
+    std::size_t digits = 0;
+    while (digits < text.size() && std::isdigit(static_cast<unsigned char>(text[digits]))) {
+        ++digits;
+    }
+    uint64_t value;
+    if (digits == 0 || !ParseNumber(text.substr(0, digits), 1ull << 40, value)) return false;
+    auto unit = text.substr(digits);
+    if (unit == "ns") {
+        out = std::chrono::nanoseconds(value);
+    } else if (unit == "us") {
+        out = std::chrono::microseconds(value);
+    } else if (unit == "ms" || unit.empty()) {
+        out = std::chrono::milliseconds(value);
+    } else if (unit == "s") {
+        out = std::chrono::seconds(value);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ParseWidth(const std::string& text, uint8_t& width) {
+    uint64_t value;
+    if (!ParseNumber(text, 32, value) || (value != 8 && value != 16 && value != 32)) {
+        return false;
+    }
+    width = static_cast<uint8_t>(value);
+    return true;
+}
+
+std::string Hex(uint64_t value, int digits) {
+    char buf[24];
+    std::snprintf(buf, sizeof(buf), "%0*llx", digits, static_cast<unsigned long long>(value));
+    return buf;
+}
+
+std::string HexBytes(const std::vector<core::Byte>& data) {
+    std::string text;
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        text += (i == 0 ? "0x" : " 0x") + Hex(data[i], 2);
+    }
+    return text + "\n";
+}
+
+std::string HexDump(const std::vector<core::Byte>& data) {
+    std::string text;
+    for (std::size_t i = 0; i < data.size(); i += 16) {
+        text += Hex(i, 3) + ":";
+        for (std::size_t j = i; j < i + 16 && j < data.size(); ++j) {
+            text += " " + Hex(data[j], 2);
+        }
+        text += "\n";
+    }
+    return text;
+}
+
+void AppendJsonString(std::string& out, const std::string& text) {
+    out += '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += "\\u00" + Hex(static_cast<unsigned char>(c), 2);
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+std::string EncodeJson(const StepResult& result) {
+    std::string out = "{\"line\":" + std::to_string(result.line) + ",\"op\":\"" +
+                      ToString(result.op) + "\",\"device\":";
+    AppendJsonString(out, *result.device);
+    out += ",\"start_ns\":" + std::to_string(result.start.count()) +
+           ",\"duration_ns\":" + std::to_string(result.duration.count()) +
+           ",\"status\":" + std::to_string(result.error.value());
+    if (result.error) {
+        out += ",\"error\":";
+        AppendJsonString(out, result.error.message());
+    } else if (result.op == StepOp::kConfigRead || result.op == StepOp::kPowerStatus) {
+        out += ",\"value\":" + std::to_string(result.value);
+    } else if (!result.data.empty()) {
+        out += ",\"data\":\"";
+        for (auto byte : result.data) out += Hex(byte, 2);
+        out += '"';
+    }
+    return out + "}\n";
+}
+
+std::string EncodeBinary(const StepResult& result) {
+    BatchRecord record{};
+    record.line = result.line;
+    record.op = static_cast<uint8_t>(result.op);
+    record.status = static_cast<uint16_t>(result.error.value());
+    record.start_ns = static_cast<uint64_t>(result.start.count());
+    record.duration_ns = static_cast<uint64_t>(result.duration.count());
+    record.value = result.value;
+    record.data_length = static_cast<uint32_t>(result.data.size());
+    std::string out(reinterpret_cast<const char*>(&record), sizeof(record));
+    out.append(reinterpret_cast<const char*>(result.data.data()), result.data.size());
+    return out;
+}
+
+void WaitUntil(Clock::time_point target) {
+    auto now = Clock::now();
+    if (target - now > kSpinWindow) {
+        std::this_thread::sleep_until(target - kSpinWindow);
+    }
+    while (Clock::now() < target) {
+        std::this_thread::yield();
+    }
+}
+
+template <typename T>
+std::error_code ErrorOf(const core::Result<T>& result) {
+    return result.IsError() ? std::error_code(result.Error()) : std::error_code();
+}
+
+}  // namespace
+
+const char* ToString(StepOp op) {
+    switch (op) {
+        case StepOp::kI2cRead: return "i2c-read";
+        case StepOp::kI2cWrite: return "i2c-write";
+        case StepOp::kConfigRead: return "cfg-read";
+        case StepOp::kConfigWrite: return "cfg-write";
+        case StepOp::kConfigDump: return "cfg-dump";
+        case StepOp::kPowerOn: return "power-on";
+        case StepOp::kPowerOff: return "power-off";
+        case StepOp::kPowerStatus: return "power-status";
+        case StepOp::kPowerCycle: return "power-cycle";
+        case StepOp::kDelay: return "delay";
+    }
+    return "unknown";
+}
+
+bool IsStepCommand(const std::string& command) {
+    static const char* kCommands[] = {"i2c-read", "i2c-write", "cfg-read", "cfg-write",
+                                      "cfg-dump", "power",     "delay"};
+    return std::any_of(std::begin(kCommands), std::end(kCommands),
+                       [&](const char* name) { return command == name; });
+}
+
+int ParseStep(const std::vector<std::string>& words, bootstrap::Bootstrap& bootstrap,
+              Step& step, std::string& error) {
+    const std::string command = words.empty() ? "" : words[0];
+    auto usage = [&](const char* text) {
+        error = std::string("usage: ") + text;
+        return 2;
+    };
+    auto missing = [&](const char* iface) {
+        error = command + ": no " + iface + " device '" + step.device + "'";
+        return 1;
+    };
+    if (words.size() < 2) {
+        error = command.empty() ? "empty command" : "usage: " + command + " DEV ...";
+        return 2;
+    }
+    step.device = words[1];
+    uint64_t n = 0;
+
+    if (command == "i2c-read") {
+        uint64_t reg = 0;
+        uint64_t length = 0;
+        if (words.size() != 5 || !ParseNumber(words[2], 0x3FF, n) ||
+            !ParseNumber(words[3], 0xFF, reg) || !ParseNumber(words[4], kMaxI2cRead, length) ||
+            length == 0) {
+            return usage("i2c-read DEV ADDR REG LEN");
+        }
+        step.op = StepOp::kI2cRead;
+        step.length = static_cast<std::size_t>(length);
+        step.address = static_cast<uint16_t>(n);
+        step.offset = static_cast<uint32_t>(reg);
+        step.i2c = bootstrap.GetInterface<hal::I2c>(step.device);
+        return step.i2c ? 0 : missing("I2c");
+    }
+    if (command == "i2c-write") {
+        if (words.size() < 4 || !ParseNumber(words[2], 0x3FF, n)) {
+            return usage("i2c-write DEV ADDR BYTE...");
+        }
+        step.op = StepOp::kI2cWrite;
+        step.address = static_cast<uint16_t>(n);
+        for (std::size_t i = 3; i < words.size(); ++i) {
+            uint64_t byte;
+            if (!ParseNumber(words[i], 0xFF, byte)) {
+                error = "i2c-write: bad byte " + words[i];
+                return 2;
+            }
+            step.data.push_back(static_cast<core::Byte>(byte));
+        }
+        step.i2c = bootstrap.GetInterface<hal::I2c>(step.device);
+        return step.i2c ? 0 : missing("I2c");
+    }
+    if (command == "cfg-read" || command == "cfg-write") {
+        bool write = command == "cfg-write";
+        std::size_t width_at = write ? 5 : 4;
+        bool ok = words.size() >= width_at && words.size() <= width_at + 1 &&
+                  hal::pci::Bdf::Parse(words[2], step.bdf) == core::ErrorCode::kSuccess &&
+                  ParseNumber(words[3], hal::pci::kConfigSpaceSize - 1, n) &&
+                  (words.size() == width_at || ParseWidth(words[width_at], step.width)) &&
+                  n % (step.width / 8) == 0 &&
+                  (!write || ParseNumber(words[4], (uint64_t{1} << step.width) - 1, step.value));
+        if (!ok) {
+            return usage(write ? "cfg-write DEV BDF OFFSET VALUE [8|16|32] (aligned)"
+                               : "cfg-read DEV BDF OFFSET [8|16|32] (aligned)");
+        }
+        step.op = write ? StepOp::kConfigWrite : StepOp::kConfigRead;
+        step.offset = static_cast<uint32_t>(n);
+        step.config = bootstrap.GetInterface<hal::pci::PciConfig>(step.device);
+        return step.config ? 0 : missing("PciConfig");
+    }
+    if (command == "cfg-dump") {
+        uint64_t length = 256;
+        if (words.size() < 3 || words.size() > 4 ||
+            hal::pci::Bdf::Parse(words[2], step.bdf) != core::ErrorCode::kSuccess ||
+            (words.size() == 4 &&
+             (!ParseNumber(words[3], hal::pci::kConfigSpaceSize, length) || length == 0))) {
+            return usage("cfg-dump DEV BDF [LENGTH]");
+        }
+        step.op = StepOp::kConfigDump;
+        step.length = static_cast<std::size_t>(length);
+        step.config = bootstrap.GetInterface<hal::pci::PciConfig>(step.device);
+        return step.config ? 0 : missing("PciConfig");
+    }
+    if (command == "power") {
+        const std::string action = words.size() >= 3 ? words[2] : "";
+        uint64_t off_ms = 1000;
+        if (words.size() == 3 && action == "on") {
+            step.op = StepOp::kPowerOn;
+        } else if (words.size() == 3 && action == "off") {
+            step.op = StepOp::kPowerOff;
+        } else if (words.size() == 3 && action == "status") {
+            step.op = StepOp::kPowerStatus;
+        } else if (action == "cycle" && words.size() <= 4 &&
+                   (words.size() == 3 || ParseNumber(words[3], kMaxPowerOffMs, off_ms))) {
+            step.op = StepOp::kPowerCycle;
+            step.duration = std::chrono::milliseconds(off_ms);
+        } else {
+            return usage("power DEV on|off|status|cycle [OFF_MS]");
+        }
+        step.power = bootstrap.GetInterface<hal::PowerControl>(step.device);
+        return step.power ? 0 : missing("PowerControl");
+    }
+    if (command == "delay") {
+        std::chrono::nanoseconds duration{};
+        if (words.size() != 3 || !ParseDuration(words[2], duration)) {
+            return usage("delay DEV DURATION (e.g. 500us, 10ms, 2s)");
+        }
+        step.op = StepOp::kDelay;
+        step.duration = duration;
+        if (!bootstrap.GetDevice(step.device)) {
+            error = "delay: no device '" + step.device + "'";
+            return 1;
+        }
+        return 0;
+    }
+    error = "unknown command '" + command + "'";
+    return 2;
+}
+
+StepResult RunStep(const Step& step, Clock::time_point run_start) {
+    if (step.at.count() >= 0) {
+        WaitUntil(run_start + step.at);
+    }
+    StepResult result;
+    result.line = step.line;
+    result.op = step.op;
+    result.device = &step.device;
+    auto begin = Clock::now();
+
+    switch (step.op) {
+        case StepOp::kI2cRead: {
+            auto reg = static_cast<core::Byte>(step.offset);
+            result.data.resize(step.length);
+            auto read = step.i2c->WriteRead(step.address, &reg, 1, result.data.data(),
+                                            result.data.size());
+            result.error = ErrorOf(read);
+            result.data.resize(read.IsOk() ? read.Value() : 0);
+            break;
+        }
+        case StepOp::kI2cWrite:
+            result.error =
+                ErrorOf(step.i2c->Write(step.address, step.data.data(), step.data.size(), true));
+            break;
+        case StepOp::kConfigRead: {
+            auto offset = static_cast<hal::pci::ConfigOffset>(step.offset);
+            auto widen = [](auto v) { return static_cast<uint64_t>(v); };
+            auto read = step.width == 8    ? step.config->ReadConfig8(step.bdf, offset).Map(widen)
+                        : step.width == 16 ? step.config->ReadConfig16(step.bdf, offset).Map(widen)
+                                           : step.config->ReadConfig32(step.bdf, offset).Map(widen);
+            result.error = ErrorOf(read);
+            result.value = read.IsOk() ? read.Value() : 0;
+            break;
+        }
+        case StepOp::kConfigWrite: {
+            auto offset = static_cast<hal::pci::ConfigOffset>(step.offset);
+            result.error = ErrorOf(
+                step.width == 8
+                    ? step.config->WriteConfig8(step.bdf, offset,
+                                                static_cast<core::Byte>(step.value))
+                : step.width == 16
+                    ? step.config->WriteConfig16(step.bdf, offset,
+                                                 static_cast<core::Word>(step.value))
+                    : step.config->WriteConfig32(step.bdf, offset,
+                                                 static_cast<core::DWord>(step.value)));
+            break;
+        }
+        case StepOp::kConfigDump:
+            result.data.resize(step.length);
+            result.error = ErrorOf(
+                step.config->ReadConfigBlock(step.bdf, 0, result.data.data(), step.length));
+            if (result.error) result.data.clear();
+            break;
+        case StepOp::kPowerOn:
+            result.error = ErrorOf(step.power->PowerOn());
+            break;
+        case StepOp::kPowerOff:
+            result.error = ErrorOf(step.power->PowerOff());
+            break;
+        case StepOp::kPowerStatus: {
+            auto on = step.power->IsPowerOn();
+            result.error = ErrorOf(on);
+            result.value = on.IsOk() && on.Value() ? 1 : 0;
+            break;
+        }
+        case StepOp::kPowerCycle:
+            result.error = ErrorOf(step.power->PowerOff());
+            if (!result.error) {
+                std::this_thread::sleep_for(step.duration);
+                result.error = ErrorOf(step.power->PowerOn());
+            }
+            break;
+        case StepOp::kDelay:
+            WaitUntil(begin + step.duration);
+            break;
+    }
+
+    auto end = Clock::now();
+    result.start = begin - run_start;
+    result.duration = end - begin;
+    return result;
+}
+
+std::string FormatResult(const Step& step, const StepResult& result) {
+    switch (result.op) {
+        case StepOp::kI2cRead:
+            return HexBytes(result.data);
+        case StepOp::kConfigDump:
+            return HexDump(result.data);
+        case StepOp::kConfigRead:
+            return "0x" + Hex(result.value, step.width / 4) + "\n";
+        case StepOp::kPowerStatus:
+            return result.value ? "on\n" : "off\n";
+        default:
+            return {};
+    }
+}
+
+int ParseBatch(std::istream& in, bootstrap::Bootstrap& bootstrap, std::vector<Step>& steps,
+               std::string& error) {
+    std::string text;
+    uint32_t line = 0;
+    while (std::getline(in, text)) {
+        ++line;
+        text = text.substr(0, text.find('#'));
+        std::istringstream fields(text);
+        std::vector<std::string> words;
+        for (std::string word; fields >> word;) {
+            words.push_back(word);
+        }
+        if (words.empty()) continue;
+
+        Step step;
+        step.line = line;
+        if (words[0][0] == '@') {
+            if (!ParseDuration(words[0].substr(1), step.at)) {
+                error = "line " + std::to_string(line) + ": bad start time " + words[0];
+                return 2;
+            }
+            words.erase(words.begin());
+        }
+        std::string step_error;
+        int status = ParseStep(words, bootstrap, step, step_error);
+        if (status != 0) {
+            error = "line " + std::to_string(line) + ": " + step_error;
+            return status;
+        }
+        steps.push_back(std::move(step));
+    }
+    if (steps.empty()) {
+        error = "script has no steps";
+        return 2;
+    }
+    return 0;
+}
+
+BatchSummary RunBatch(const std::vector<Step>& steps, BatchFormat format,
+                      const std::function<void(const std::string&)>& sink) {
+    // One lane per device, in script order within the lane.
+    std::vector<std::vector<const Step*>> lanes;
+    std::unordered_map<std::string, std::size_t> lane_of;
+    for (const auto& step : steps) {
+        auto [it, added] = lane_of.emplace(step.device, lanes.size());
+        if (added) lanes.emplace_back();
+        lanes[it->second].push_back(&step);
+    }
+
+    BatchSummary summary;
+    summary.steps = steps.size();
+    summary.lanes = lanes.size();
+    std::mutex sink_mutex;
+    if (format == BatchFormat::kBinary) {
+        BatchStreamHeader header{};
+        std::memcpy(header.magic, kBatchMagic, sizeof(header.magic));
+        header.version = kBatchFormatVersion;
+        header.steps = static_cast<uint32_t>(steps.size());
+        sink(std::string(reinterpret_cast<const char*>(&header), sizeof(header)));
+    }
+
+    auto run_start = Clock::now();
+    auto run_lane = [&](const std::vector<const Step*>& lane) {
+        for (const Step* step : lane) {
+            auto result = RunStep(*step, run_start);
+            auto encoded = format == BatchFormat::kJson ? EncodeJson(result)
+                                                        : EncodeBinary(result);
+            std::lock_guard<std::mutex> lock(sink_mutex);
+            summary.failed += result.error ? 1u : 0u;
+            sink(encoded);
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(lanes.size() - 1);
+    for (std::size_t i = 1; i < lanes.size(); ++i) {
+        threads.emplace_back(run_lane, std::cref(lanes[i]));
+    }
+    run_lane(lanes[0]);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    summary.elapsed = Clock::now() - run_start;
+
+    if (format == BatchFormat::kJson) {
+        sink("{\"steps\":" + std::to_string(summary.steps) +
+             ",\"failed\":" + std::to_string(summary.failed) +
+             ",\"lanes\":" + std::to_string(summary.lanes) +
+             ",\"elapsed_ns\":" + std::to_string(summary.elapsed.count()) + "}\n");
+    }
+    return summary;
+}
+
+}  // namespace plas::cli
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "plas/core/types.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::bootstrap {
+class Bootstrap;
+}  // namespace plas::bootstrap
+
+namespace plas::hal {
+class I2c;
+class PowerControl;
+namespace pci {
+class PciConfig;
+}  // namespace pci
+}  // namespace plas::hal
+
+namespace plas::cli {
+
+/// One HAL operation of plas_cli, shared by the one-off commands and batch
+/// scripts. Parsed and resolved (interface pointer looked up, numbers
+/// range-checked) before anything runs.
+enum class StepOp : uint8_t {
+    kI2cRead = 1,
+    kI2cWrite,
+    kConfigRead,
+    kConfigWrite,
+    kConfigDump,
+    kPowerOn,
+    kPowerOff,
+    kPowerStatus,
+    kPowerCycle,
+    kDelay,
+};
+
+const char* ToString(StepOp op);
+
+struct Step {
+    StepOp op = StepOp::kDelay;
+    uint32_t line = 0;  ///< script line (1-based), 0 for a one-off command
+    std::string device;
+    /// Offset from the start of the run before which the step must not
+    /// start (script "@<duration>" prefix); negative: as soon as possible.
+    std::chrono::nanoseconds at{-1};
+
+    hal::I2c* i2c = nullptr;
+    hal::pci::PciConfig* config = nullptr;
+    hal::PowerControl* power = nullptr;
+
+    hal::pci::Bdf bdf{};
+    uint16_t address = 0;  ///< I2C target
+    uint32_t offset = 0;   ///< I2C register / config offset
+    uint8_t width = 32;    ///< config access width in bits
+    uint64_t value = 0;    ///< config value to write
+    std::size_t length = 0;
+    std::vector<core::Byte> data;  ///< I2C bytes to write
+    std::chrono::nanoseconds duration{0};  ///< delay, power-cycle off time
+};
+
+struct StepResult {
+    uint32_t line = 0;
+    StepOp op = StepOp::kDelay;
+    const std::string* device = nullptr;  ///< the Step's
+    std::chrono::nanoseconds start{0};     ///< from the start of the run
+    std::chrono::nanoseconds duration{0};
+    std::error_code error;
+    uint64_t value = 0;             ///< cfg-read value, power status (1 = on)
+    std::vector<core::Byte> data;   ///< i2c-read / cfg-dump bytes
+};
+
+/// Parse `words` (a command and its arguments, as on the plas_cli command
+/// line) into `step` and resolve its device in `bootstrap`. On failure
+/// `error` holds a message and the return value is 2 for a usage error, 1
+/// for a missing device or interface.
+int ParseStep(const std::vector<std::string>& words, bootstrap::Bootstrap& bootstrap,
+              Step& step, std::string& error);
+
+/// True if `command` names a Step operation.
+bool IsStepCommand(const std::string& command);
+
+/// Run one resolved step. `run_start` is the time `at` and `start` refer to.
+StepResult RunStep(const Step& step, std::chrono::steady_clock::time_point run_start);
+
+/// The reply text of a one-off command: read data or value, or nothing.
+std::string FormatResult(const Step& step, const StepResult& result);
+
+// ---------------------------------------------------------------------------
+// Batch scripts
+//
+// One step per line, in the command syntax of plas_cli, with '#' comments:
+//
+//   @10ms i2c-read eeprom 0x50 0x00 16   # not before 10 ms into the run
+//   cfg-write nvme 03:00.0 0x04 0x0006 16
+//   delay psu0 500ms                     # pause psu0's lane
+//   power psu0 cycle 2000
+//
+// Steps of one device run in script order; devices run concurrently, one
+// thread per device. The whole script is parsed and resolved before the
+// first step runs, so a typo on line 3000 fails before line 1 executes.
+// ---------------------------------------------------------------------------
+
+enum class BatchFormat { kJson, kBinary };
+
+/// Binary result stream: a BatchStreamHeader, then per step a
+/// BatchRecord followed by `data_length` bytes. Host byte order.
+inline constexpr char kBatchMagic[8] = {'P', 'L', 'A', 'S', 'B', 'A', 'T', '\0'};
+inline constexpr uint32_t kBatchFormatVersion = 1;
+
+struct BatchStreamHeader {
+    char magic[8];  ///< kBatchMagic
+    uint32_t version;
+    uint32_t steps;
+};
+
+struct BatchRecord {
+    uint32_t line;
+    uint8_t op;        ///< StepOp
+    uint8_t reserved;
+    uint16_t status;   ///< core::ErrorCode value, 0 = success
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    uint64_t value;
+    uint32_t data_length;
+    uint32_t reserved2;
+};
+static_assert(sizeof(BatchRecord) == 40, "BatchRecord layout is fixed");
+
+struct BatchSummary {
+    std::size_t steps = 0;
+    std::size_t failed = 0;
+    std::size_t lanes = 0;
+    std::chrono::nanoseconds elapsed{0};
+};
+
+/// Parse and resolve a whole script. On failure `error` names the line.
+int ParseBatch(std::istream& in, bootstrap::Bootstrap& bootstrap, std::vector<Step>& steps,
+               std::string& error);
+
+/// Run `steps`, handing each result to `sink` (serialized, in completion
+/// order) encoded as `format`: a JSON object per line, or BatchRecords
+/// after one BatchStreamHeader.
+BatchSummary RunBatch(const std::vector<Step>& steps, BatchFormat format,
+                      const std::function<void(const std::string&)>& sink);
+
+}  // namespace plas::cli
@@ -0,0 +1,444 @@
+/// @file plas_cli.cpp
+/// @brief Command-line access to the devices of a device config, either in
+///        process or through a long-lived daemon that keeps them open.
+///
+/// Scripts that call a CLI in a loop would pay Bootstrap::Init (config
+/// parse, validation, device open) on every call. With --daemon, one
+/// process runs Init once and serves commands on a Unix socket; later
+/// invocations only connect, send their arguments and print the reply, so
+/// a register read finishes in milliseconds. Without a daemon on the
+/// socket, a command given --config runs in process (devices opened lazily,
+/// only the one it touches).
+///
+/// Usage:
+///   plas_cli --config=FILE --daemon [--socket=PATH]   serve until SIGINT/
+///                                                     SIGTERM or "shutdown";
+///                                                     SIGHUP reloads the config
+///   plas_cli [--socket=PATH] [--config=FILE] COMMAND [ARGS...]
+///   --socket=PATH   default $PLAS_CLI_SOCKET or /tmp/plas-cli-<uid>.sock
+///   --local         run in process even if a daemon is listening
+///
+/// Commands (numbers take 0x for hex):
+///   list                                  loaded devices
+///   i2c-read DEV ADDR REG LEN             write REG, read LEN bytes
+///   i2c-write DEV ADDR BYTE...
+///   cfg-read DEV BDF OFFSET [8|16|32]     config space (default 32)
+///   cfg-write DEV BDF OFFSET VALUE [8|16|32]
+///   cfg-dump DEV BDF [LENGTH]             hex dump (default 256 bytes)
+///   power DEV on|off|status|cycle [OFF_MS] (cycle: default 1000 ms off)
+///   run SCRIPT [json|binary]              batch script (batch.h); results on
+///                                         stdout, exit 3 if a step failed
+///   metrics                               per-device call statistics
+///   reload                                re-read the device config
+///   shutdown                              stop the daemon
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "batch.h"
+#include "plas/bootstrap/bootstrap.h"
+
+namespace {
+
+using plas::bootstrap::Bootstrap;
+using Args = std::vector<std::string>;
+
+constexpr uint32_t kMaxMessage = 1u << 20;  // request
+constexpr uint32_t kMaxReply = 1u << 30;    // batch results can be large
+constexpr int kStepsFailed = 3;             // run: the script ran, some steps failed
+constexpr int kIoTimeoutMs = 5000;
+
+/// Exit status and text of one command (stdout on 0 and kStepsFailed,
+/// stderr otherwise).
+struct Reply {
+    int status = 0;
+    std::string text;
+};
+
+Reply Fail(int status, const std::string& text) {
+    return Reply{status, text + "\n"};
+}
+
+Reply Failed(const std::string& command, std::error_code error) {
+    return Fail(1, command + ": " + error.message());
+}
+
+/// A device command (see batch.h), run once.
+Reply RunStepCommand(Bootstrap& bootstrap, const Args& args) {
+    plas::cli::Step step;
+    std::string error;
+    int status = plas::cli::ParseStep(args, bootstrap, step, error);
+    if (status != 0) return Fail(status, error);
+    auto result = plas::cli::RunStep(step, std::chrono::steady_clock::now());
+    if (result.error) return Failed(args[0], result.error);
+    return Reply{0, plas::cli::FormatResult(step, result)};
+}
+
+/// run SCRIPT [json|binary]: parse and resolve the whole script, then run
+/// it, passing each encoded result to `sink` as it completes.
+Reply RunScript(Bootstrap& bootstrap, const Args& args,
+                const std::function<void(const std::string&)>& sink) {
+    auto format = plas::cli::BatchFormat::kJson;
+    if (args.size() < 2 || args.size() > 3 ||
+        (args.size() == 3 && args[2] != "json" && args[2] != "binary")) {
+        return Fail(2, "usage: run SCRIPT [json|binary]");
+    }
+    if (args.size() == 3 && args[2] == "binary") format = plas::cli::BatchFormat::kBinary;
+    std::ifstream in(args[1]);
+    if (!in) return Fail(1, "run: cannot open " + args[1]);
+
+    std::vector<plas::cli::Step> steps;
+    std::string error;
+    int status = plas::cli::ParseBatch(in, bootstrap, steps, error);
+    if (status != 0) return Fail(status, "run: " + args[1] + ": " + error);
+    auto summary = plas::cli::RunBatch(steps, format, sink);
+    return Reply{summary.failed == 0 ? 0 : kStepsFailed, {}};
+}
+
+Reply RunCommand(Bootstrap& bootstrap, const Args& args) {
+    const std::string& command = args[0];
+    if (command == "list") return Reply{0, bootstrap.DumpDevices()};
+    if (plas::cli::IsStepCommand(command)) return RunStepCommand(bootstrap, args);
+    if (command == "run") {
+        // Through the daemon the results travel in the reply.
+        Reply collected;
+        auto reply = RunScript(bootstrap, args,
+                               [&](const std::string& chunk) { collected.text += chunk; });
+        if (reply.status != 0 && reply.status != kStepsFailed) return reply;
+        collected.status = reply.status;
+        return collected;
+    }
+    if (command == "metrics") return Reply{0, bootstrap.DumpMetrics()};
+    if (command == "reload") {
+        auto reloaded = bootstrap.Reload();
+        if (reloaded.IsError()) return Failed("reload", reloaded.Error());
+        const auto& r = reloaded.Value();
+        return Reply{0, std::to_string(r.devices_added) + " added, " +
+                            std::to_string(r.devices_changed) + " changed, " +
+                            std::to_string(r.devices_removed) + " removed\n"};
+    }
+    return Fail(2, "unknown command '" + command + "'");
+}
+
+// ---------------------------------------------------------------------------
+// Wire format (host byte order, one request per connection):
+//   request  u32 argc, then per argument u32 length + bytes
+//   reply    i32 status, u32 length + text
+// ---------------------------------------------------------------------------
+
+bool SendAll(int fd, const void* data, std::size_t length) {
+    const auto* p = static_cast<const char*>(data);
+    while (length > 0) {
+        ssize_t n = ::send(fd, p, length, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        length -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool RecvAll(int fd, void* data, std::size_t length) {
+    auto* p = static_cast<char*>(data);
+    while (length > 0) {
+        ssize_t n = ::recv(fd, p, length, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        length -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool SendString(int fd, const std::string& text) {
+    auto length = static_cast<uint32_t>(text.size());
+    return SendAll(fd, &length, sizeof(length)) && SendAll(fd, text.data(), text.size());
+}
+
+bool RecvString(int fd, std::string& text, uint32_t& budget) {
+    uint32_t length = 0;
+    if (!RecvAll(fd, &length, sizeof(length)) || length > budget) return false;
+    budget -= length;
+    text.resize(length);
+    return RecvAll(fd, text.data(), length);
+}
+
+bool MakeAddress(const std::string& path, sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) return false;
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+/// Bound sends, and receives unless the peer may legitimately take long
+/// (a client waiting for a batch run).
+void SetTimeouts(int fd, bool receive) {
+    timeval tv{kIoTimeoutMs / 1000, (kIoTimeoutMs % 1000) * 1000};
+    if (receive) ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+void Print(const Reply& reply) {
+    bool ok = reply.status == 0 || reply.status == kStepsFailed;
+    std::fwrite(reply.text.data(), 1, reply.text.size(), ok ? stdout : stderr);
+}
+
+/// Connected socket to the daemon at `path`, or -1 if none is listening.
+int Connect(const std::string& path) {
+    sockaddr_un addr;
+    if (!MakeAddress(path, addr)) return -1;
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/// Send `args` to the daemon on `fd` and print its reply.
+int RunRemote(int fd, const Args& args) {
+    SetTimeouts(fd, false);
+    auto argc = static_cast<uint32_t>(args.size());
+    bool sent = SendAll(fd, &argc, sizeof(argc));
+    for (std::size_t i = 0; sent && i < args.size(); ++i) {
+        sent = SendString(fd, args[i]);
+    }
+    int32_t status = 0;
+    Reply reply;
+    uint32_t budget = kMaxReply;
+    bool received =
+        sent && RecvAll(fd, &status, sizeof(status)) && RecvString(fd, reply.text, budget);
+    ::close(fd);
+    if (!received) {
+        std::fprintf(stderr, "lost connection to the daemon\n");
+        return 1;
+    }
+    reply.status = status;
+    Print(reply);
+    return status;
+}
+
+volatile std::sig_atomic_t g_stop = 0;
+volatile std::sig_atomic_t g_reload = 0;
+
+void OnSignal(int signal) {
+    if (signal == SIGHUP) {
+        g_reload = 1;
+    } else {
+        g_stop = 1;
+    }
+}
+
+/// Read one request from a connected client; false on a malformed one.
+bool ReadRequest(int fd, Args& args) {
+    uint32_t argc = 0;
+    if (!RecvAll(fd, &argc, sizeof(argc)) || argc == 0 || argc > 4096) return false;
+    uint32_t budget = kMaxMessage;
+    args.resize(argc);
+    for (auto& arg : args) {
+        if (!RecvString(fd, arg, budget)) return false;
+    }
+    return true;
+}
+
+int RunDaemon(Bootstrap& bootstrap, const std::string& path) {
+    sockaddr_un addr;
+    if (!MakeAddress(path, addr)) {
+        std::fprintf(stderr, "socket path too long: %s\n", path.c_str());
+        return 2;
+    }
+    int existing = Connect(path);
+    if (existing >= 0) {
+        ::close(existing);
+        std::fprintf(stderr, "a daemon is already serving %s\n", path.c_str());
+        return 1;
+    }
+    ::unlink(path.c_str());  // stale socket of a daemon that died
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    mode_t old_mask = ::umask(0077);  // the socket grants device access
+    bool bound = listener >= 0 &&
+                 ::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    ::umask(old_mask);
+    if (!bound || ::listen(listener, 16) != 0) {
+        std::fprintf(stderr, "cannot listen on %s: %s\n", path.c_str(), std::strerror(errno));
+        if (listener >= 0) ::close(listener);
+        return 1;
+    }
+
+    struct sigaction action {};
+    action.sa_handler = OnSignal;
+    sigemptyset(&action.sa_mask);
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+    ::sigaction(SIGHUP, &action, nullptr);
+    std::fprintf(stderr, "serving %zu devices on %s\n", bootstrap.DeviceNames().size(),
+                 path.c_str());
+
+    uint64_t served = 0;
+    while (!g_stop) {
+        if (g_reload) {
+            g_reload = 0;
+            auto reply = RunCommand(bootstrap, {"reload"});
+            std::fwrite(reply.text.data(), 1, reply.text.size(), stderr);
+        }
+        pollfd pfd{listener, POLLIN, 0};
+        if (::poll(&pfd, 1, 200) <= 0) continue;
+        int client = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) continue;
+
+        // One client at a time: commands are short, and serializing them
+        // keeps scripts from interleaving transactions on a device.
+        SetTimeouts(client, true);
+        Args args;
+        Reply reply;
+        if (!ReadRequest(client, args)) {
+            ::close(client);
+            continue;
+        }
+        if (args.size() == 1 && args[0] == "shutdown") {
+            g_stop = 1;
+        } else {
+            reply = RunCommand(bootstrap, args);
+        }
+        auto status = static_cast<int32_t>(reply.status);
+        if (reply.text.size() > kMaxReply) reply.text.resize(kMaxReply);
+        (void)(SendAll(client, &status, sizeof(status)) && SendString(client, reply.text));
+        ::close(client);
+        ++served;
+    }
+
+    ::close(listener);
+    ::unlink(path.c_str());
+    std::fprintf(stderr, "served %llu commands\n", static_cast<unsigned long long>(served));
+    return 0;
+}
+
+struct Options {
+    std::string config;
+    std::string socket;
+    bool daemon = false;
+    bool local = false;
+    Args command;
+};
+
+std::string DefaultSocket() {
+    if (const char* env = std::getenv("PLAS_CLI_SOCKET"); env && *env) return env;
+    return "/tmp/plas-cli-" + std::to_string(::getuid()) + ".sock";
+}
+
+bool ParseArgs(int argc, char** argv, Options& opts) {
+    int i = 1;
+    for (; i < argc && std::strncmp(argv[i], "--", 2) == 0; ++i) {
+        const char* arg = argv[i];
+        auto value = [arg](const char* name) -> const char* {
+            size_t n = std::strlen(name);
+            return std::strncmp(arg, name, n) == 0 && arg[n] == '=' ? arg + n + 1
+                                                                   : nullptr;
+        };
+        const char* v = nullptr;
+        if ((v = value("--config"))) {
+            opts.config = v;
+        } else if ((v = value("--socket"))) {
+            opts.socket = v;
+        } else if (std::strcmp(arg, "--daemon") == 0) {
+            opts.daemon = true;
+        } else if (std::strcmp(arg, "--local") == 0) {
+            opts.local = true;
+        } else {
+            return false;
+        }
+    }
+    opts.command.assign(argv + i, argv + argc);
+    if (opts.socket.empty()) opts.socket = DefaultSocket();
+    if (opts.daemon) return !opts.config.empty() && opts.command.empty();
+    if (opts.local && opts.config.empty()) return false;
+    return !opts.command.empty();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!ParseArgs(argc, argv, opts)) {
+        std::fprintf(stderr,
+                     "usage: %s --config=FILE --daemon [--socket=PATH]\n"
+                     "       %s [--socket=PATH] [--config=FILE] [--local] COMMAND [ARGS...]\n"
+                     "commands: list, i2c-read, i2c-write, cfg-read, cfg-write, cfg-dump,\n"
+                     "          power, delay, run, metrics, reload, shutdown\n",
+                     argv[0], argv[0]);
+        return 2;
+    }
+
+    if (!opts.daemon && !opts.local) {
+        int fd = Connect(opts.socket);
+        if (fd >= 0) {
+            // The daemon resolves paths from its own working directory.
+            if (opts.command[0] == "run" && opts.command.size() > 1) {
+                if (char* path = ::realpath(opts.command[1].c_str(), nullptr)) {
+                    opts.command[1] = path;
+                    std::free(path);
+                }
+            }
+            return RunRemote(fd, opts.command);
+        }
+        if (opts.config.empty()) {
+            std::fprintf(stderr, "no daemon on %s; start one with --daemon or pass --config\n",
+                         opts.socket.c_str());
+            return 1;
+        }
+    }
+    if (!opts.daemon && opts.command[0] == "shutdown") {
+        std::fprintf(stderr, "no daemon on %s\n", opts.socket.c_str());
+        return 1;
+    }
+
+    plas::bootstrap::BootstrapConfig cfg;
+    cfg.device_config_path = opts.config;
+    // A one-off command opens only the device it uses; the daemon opens
+    // everything up front and keeps it open.
+    cfg.lazy_open_devices = !opts.daemon;
+    Bootstrap bootstrap;
+    auto init = bootstrap.Init(cfg);
+    if (init.IsError()) {
+        std::fprintf(stderr, "cannot load %s: %s\n", opts.config.c_str(),
+                     init.Error().message().c_str());
+        return 1;
+    }
+
+    int status = 0;
+    if (opts.daemon) {
+        status = RunDaemon(bootstrap, opts.socket);
+    } else {
+        Reply reply;
+        if (opts.command[0] == "run") {
+            // In process, results stream out as steps complete.
+            reply = RunScript(bootstrap, opts.command, [](const std::string& chunk) {
+                std::fwrite(chunk.data(), 1, chunk.size(), stdout);
+            });
+        } else {
+            reply = RunCommand(bootstrap, opts.command);
+        }
+        Print(reply);
+        status = reply.status;
+    }
+    bootstrap.Deinit();
+    return status;
+}
@@ -0,0 +1,184 @@
+/// @file remote_server.cpp
+/// @brief Serves the devices of a device config to remote:// clients and,
+///        with --shm, to shm:// clients on this host.
+///
+/// Devices are opened on their first remote call and, with --idle-close-ms,
+/// closed again when unused, so adapters shared with local tools are only
+/// held while a client is using them. SIGHUP reloads the config (changed
+/// devices are picked up by the next call); SIGINT/SIGTERM stop the server.
+///
+/// Usage: plas_remote_server --config=FILE [options]
+///   --config=FILE         device config (JSON/YAML, as Bootstrap)
+///   --bind=ADDRESS        listen address (default 127.0.0.1; no authentication,
+///                         so other hosts need a lab-internal address here)
+///   --port=N              TCP port (default 7700)
+///   --workers=N           threads running device calls (default 4)
+///   --idle-close-ms=N     close devices unused for N ms (default 0 = never)
+///   --shm=NAME            also run a shared-memory broker (shm://NAME:nickname)
+///   --shm-slots=N         client devices the broker can attach (default 16)
+///   --no-tcp              broker only; do not listen on TCP (needs --shm)
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <pthread.h>
+
+#include "plas/bootstrap/bootstrap.h"
+#include "plas/remote/remote_server.h"
+#ifdef PLAS_HAS_SHM_BROKER
+#include "plas/remote/shm_broker.h"
+#endif
+
+namespace {
+
+struct Options {
+    std::string config;
+    plas::remote::RemoteServerOptions server;
+    uint32_t idle_close_ms = 0;
+    bool tcp = true;
+#ifdef PLAS_HAS_SHM_BROKER
+    bool shm = false;
+    plas::remote::ShmBrokerOptions broker;
+#endif
+};
+
+bool ParseArgs(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        auto value = [arg](const char* name) -> const char* {
+            size_t n = std::strlen(name);
+            return std::strncmp(arg, name, n) == 0 && arg[n] == '=' ? arg + n + 1
+                                                                   : nullptr;
+        };
+        const char* v = nullptr;
+        if ((v = value("--config"))) {
+            opts.config = v;
+        } else if ((v = value("--bind"))) {
+            opts.server.bind_address = v;
+        } else if ((v = value("--port"))) {
+            unsigned long port = std::strtoul(v, nullptr, 0);
+            if (port == 0 || port > 65535) return false;
+            opts.server.port = static_cast<uint16_t>(port);
+        } else if ((v = value("--workers"))) {
+            opts.server.workers = std::strtoul(v, nullptr, 0);
+            if (opts.server.workers == 0) return false;
+        } else if ((v = value("--idle-close-ms"))) {
+            opts.idle_close_ms = static_cast<uint32_t>(std::strtoul(v, nullptr, 0));
+        } else if (std::strcmp(arg, "--no-tcp") == 0) {
+            opts.tcp = false;
+#ifdef PLAS_HAS_SHM_BROKER
+        } else if ((v = value("--shm"))) {
+            opts.shm = true;
+            opts.broker.name = v;
+        } else if ((v = value("--shm-slots"))) {
+            opts.broker.slots = static_cast<uint32_t>(std::strtoul(v, nullptr, 0));
+            if (opts.broker.slots == 0) return false;
+#endif
+        } else {
+            return false;
+        }
+    }
+#ifdef PLAS_HAS_SHM_BROKER
+    if (!opts.tcp && !opts.shm) return false;
+#else
+    if (!opts.tcp) return false;
+#endif
+    return !opts.config.empty();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!ParseArgs(argc, argv, opts)) {
+        std::fprintf(stderr,
+                     "usage: %s --config=FILE [--bind=ADDRESS] [--port=N] [--workers=N] "
+                     "[--idle-close-ms=N] [--shm=NAME [--shm-slots=N] [--no-tcp]]\n",
+                     argv[0]);
+        return 2;
+    }
+
+    plas::bootstrap::BootstrapConfig cfg;
+    cfg.device_config_path = opts.config;
+    cfg.lazy_open_devices = true;
+    cfg.idle_close_ms = opts.idle_close_ms;
+    plas::bootstrap::Bootstrap bootstrap;
+    auto init = bootstrap.Init(cfg);
+    if (init.IsError()) {
+        std::fprintf(stderr, "cannot load %s: %s\n", opts.config.c_str(),
+                     init.Error().message().c_str());
+        return 1;
+    }
+
+    // Block the stop signals here so every thread inherits the mask, then
+    // wait for them synchronously.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    plas::remote::RemoteServer server;
+    if (opts.tcp) {
+        auto started = server.Start(opts.server);
+        if (started.IsError()) {
+            std::fprintf(stderr, "cannot listen on %s:%u: %s\n",
+                         opts.server.bind_address.c_str(),
+                         static_cast<unsigned>(opts.server.port),
+                         started.Error().message().c_str());
+            return 1;
+        }
+        std::fprintf(stderr, "serving %zu devices on %s:%u\n", bootstrap.DeviceNames().size(),
+                     opts.server.bind_address.c_str(), static_cast<unsigned>(server.Port()));
+    }
+#ifdef PLAS_HAS_SHM_BROKER
+    plas::remote::ShmBroker broker;
+    if (opts.shm) {
+        auto started = broker.Start(opts.broker);
+        if (started.IsError()) {
+            std::fprintf(stderr, "cannot start broker '%s': %s\n", opts.broker.name.c_str(),
+                         started.Error().message().c_str());
+            return 1;
+        }
+        std::fprintf(stderr, "serving %zu devices as shm://%s:<nickname>\n",
+                     bootstrap.DeviceNames().size(), opts.broker.name.c_str());
+    }
+#endif
+
+    int signal = 0;
+    while (sigwait(&signals, &signal) == 0 && signal == SIGHUP) {
+        auto reloaded = bootstrap.Reload();
+        if (reloaded.IsError()) {
+            std::fprintf(stderr, "reload failed: %s\n", reloaded.Error().message().c_str());
+            continue;
+        }
+        std::fprintf(stderr, "reloaded: %zu added, %zu changed, %zu removed\n",
+                     reloaded.Value().devices_added, reloaded.Value().devices_changed,
+                     reloaded.Value().devices_removed);
+    }
+
+    server.Stop();
+    if (opts.tcp) {
+        auto stats = server.GetStats();
+        std::fprintf(stderr, "served %llu requests (%llu calls) over %llu connections\n",
+                     static_cast<unsigned long long>(stats.requests),
+                     static_cast<unsigned long long>(stats.calls),
+                     static_cast<unsigned long long>(stats.connections));
+    }
+#ifdef PLAS_HAS_SHM_BROKER
+    broker.Stop();
+    if (opts.shm) {
+        auto stats = broker.GetStats();
+        std::fprintf(stderr, "brokered %llu requests (%llu calls) for %llu attaches\n",
+                     static_cast<unsigned long long>(stats.requests),
+                     static_cast<unsigned long long>(stats.calls),
+                     static_cast<unsigned long long>(stats.attaches));
+    }
+#endif
+    bootstrap.Deinit();
+    return 0;
+}
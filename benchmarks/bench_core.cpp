@@ -0,0 +1,302 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/core/byte_buffer.h"
+#include "plas/core/mpsc_ring.h"
+#include "plas/core/properties.h"
+#include "plas/core/result.h"
+#include "plas/core/spsc_ring.h"
+
+namespace {
+
+using plas::core::ByteBuffer;
+using plas::core::ErrorCode;
+using plas::core::MpscRing;
+using plas::core::Properties;
+using plas::core::PropertyKey;
+using plas::core::Result;
+using plas::core::SharedSpscRing;
+using plas::core::SpscRing;
+
+// --- Result<T> ---
+
+Result<uint32_t> MakeResult(uint32_t value) {
+    if (value == 0xFFFFFFFFu) {
+        return Result<uint32_t>::Err(ErrorCode::kInvalidArgument);
+    }
+    return Result<uint32_t>::Ok(value);
+}
+
+void BM_ResultOk(benchmark::State& state) {
+    uint32_t value = 0;
+    for (auto _ : state) {
+        auto result = MakeResult(value++);
+        benchmark::DoNotOptimize(result);
+        if (result.IsOk()) {
+            benchmark::DoNotOptimize(result.Value());
+        }
+    }
+}
+BENCHMARK(BM_ResultOk);
+
+void BM_ResultErr(benchmark::State& state) {
+    for (auto _ : state) {
+        auto result = MakeResult(0xFFFFFFFFu);
+        benchmark::DoNotOptimize(result);
+        benchmark::DoNotOptimize(result.Error());
+    }
+}
+BENCHMARK(BM_ResultErr);
+
+void BM_ResultMap(benchmark::State& state) {
+    uint32_t value = 0;
+    for (auto _ : state) {
+        auto result = MakeResult(value++).Map([](uint32_t v) { return v * 2u; });
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_ResultMap);
+
+void BM_ResultString(benchmark::State& state) {
+    for (auto _ : state) {
+        auto result = Result<std::string>::Ok(std::string("aardvark://0:0x50"));
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_ResultString);
+
+// --- Properties ---
+
+class PropertiesFixture : public benchmark::Fixture {
+public:
+    void SetUp(const benchmark::State&) override {
+        Properties::DestroySession("bench");
+        props_ = &Properties::GetSession("bench");
+        props_->Set("voltage_mv", int32_t{3300});
+        props_->Set("serial", std::string("SN0001"));
+        props_->Set("byte_count", uint64_t{1} << 40);
+        props_->Set("timeout_ms", int64_t{5000});  // config loads store int64_t
+        key_ = PropertyKey::Intern("voltage_mv");
+        u64_key_ = PropertyKey::Intern("byte_count");
+        i64_key_ = PropertyKey::Intern("timeout_ms");
+    }
+    void TearDown(const benchmark::State&) override {
+        Properties::DestroySession("bench");
+    }
+
+protected:
+    Properties* props_ = nullptr;
+    PropertyKey key_;
+    PropertyKey u64_key_;
+    PropertyKey i64_key_;
+};
+
+BENCHMARK_F(PropertiesFixture, GetByString)(benchmark::State& state) {
+    for (auto _ : state) {
+        auto value = props_->Get<int32_t>("voltage_mv");
+        benchmark::DoNotOptimize(value);
+    }
+}
+
+BENCHMARK_F(PropertiesFixture, GetByKey)(benchmark::State& state) {
+    for (auto _ : state) {
+        auto value = props_->Get<int32_t>(key_);
+        benchmark::DoNotOptimize(value);
+    }
+}
+
+BENCHMARK_F(PropertiesFixture, GetAsDouble)(benchmark::State& state) {
+    for (auto _ : state) {
+        auto value = props_->GetAs<double>(key_);
+        benchmark::DoNotOptimize(value);
+    }
+}
+
+// GetAs dispatches on the stored PropertyKind in one switch, so the last
+// kinds in the list cost the same as the first.
+BENCHMARK_F(PropertiesFixture, GetAsDoubleFromUint64)(benchmark::State& state) {
+    for (auto _ : state) {
+        auto value = props_->GetAs<double>(u64_key_);
+        benchmark::DoNotOptimize(value);
+    }
+}
+
+BENCHMARK_F(PropertiesFixture, GetAsInt32FromInt64)(benchmark::State& state) {
+    for (auto _ : state) {
+        auto value = props_->GetAs<int32_t>(i64_key_);
+        benchmark::DoNotOptimize(value);
+    }
+}
+
+BENCHMARK_F(PropertiesFixture, GetString)(benchmark::State& state) {
+    for (auto _ : state) {
+        auto value = props_->Get<std::string>("serial");
+        benchmark::DoNotOptimize(value);
+    }
+}
+
+BENCHMARK_F(PropertiesFixture, SetByKey)(benchmark::State& state) {
+    int32_t value = 0;
+    for (auto _ : state) {
+        props_->Set(key_, value++);
+    }
+}
+
+// --- ByteBuffer ---
+
+// Arg: payload size. Sizes up to ByteBuffer::kInlineCapacity stay inline;
+// larger ones go through the BufferPool.
+void BM_ByteBufferAppend(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    std::vector<uint8_t> payload(size, 0xA5);
+    for (auto _ : state) {
+        ByteBuffer buffer;
+        buffer.Append(payload.data(), payload.size());
+        benchmark::DoNotOptimize(buffer.Data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            state.range(0));
+}
+BENCHMARK(BM_ByteBufferAppend)->Arg(4)->Arg(64)->Arg(4096);
+
+void BM_ByteBufferCopy(benchmark::State& state) {
+    ByteBuffer source(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        ByteBuffer copy(source);
+        benchmark::DoNotOptimize(copy.Data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            state.range(0));
+}
+BENCHMARK(BM_ByteBufferCopy)->Arg(4)->Arg(64)->Arg(4096);
+
+void BM_ByteBufferAppendUninitialized(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        ByteBuffer buffer;
+        uint8_t* out = buffer.AppendUninitialized(size);
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(BM_ByteBufferAppendUninitialized)->Arg(4)->Arg(64)->Arg(4096);
+
+// --- Rings ---
+
+// One thread pushes a batch of range(0) entries and pops it back: the
+// uncontended cost per entry, including the wrap at the end of the slots.
+template <typename Ring>
+void RingRoundTrip(benchmark::State& state, Ring& ring) {
+    const auto batch = static_cast<size_t>(state.range(0));
+    std::vector<uint64_t> in(batch, 1);
+    std::vector<uint64_t> out(batch);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ring.Push(in.data(), batch));
+        benchmark::DoNotOptimize(ring.Pop(out.data(), batch));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                            state.range(0));
+}
+
+void BM_SpscRingRoundTrip(benchmark::State& state) {
+    SpscRing<uint64_t> ring(1000);
+    RingRoundTrip(state, ring);
+}
+BENCHMARK(BM_SpscRingRoundTrip)->Arg(1)->Arg(16)->Arg(256);
+
+void BM_MpscRingRoundTrip(benchmark::State& state) {
+    MpscRing<uint64_t> ring(1000);
+    RingRoundTrip(state, ring);
+}
+BENCHMARK(BM_MpscRingRoundTrip)->Arg(1)->Arg(16)->Arg(256);
+
+void BM_SharedSpscRingRoundTrip(benchmark::State& state) {
+    using Ring = SharedSpscRing<uint64_t>;
+    size_t bytes = Ring::BytesFor(1000);
+    auto memory = std::make_unique<uint64_t[]>(bytes / sizeof(uint64_t) + 8);
+    // Step to the first cache line boundary inside the allocation.
+    auto address = reinterpret_cast<uintptr_t>(memory.get());
+    address = (address + plas::core::kCacheLineSize - 1) &
+              ~static_cast<uintptr_t>(plas::core::kCacheLineSize - 1);
+    auto ring = Ring::Create(reinterpret_cast<void*>(address), bytes, 1000);
+    RingRoundTrip(state, ring.Value());
+}
+BENCHMARK(BM_SharedSpscRingRoundTrip)->Arg(1)->Arg(16)->Arg(256);
+
+// A producer thread streams 1M entries in batches of range(0) to this
+// thread: cross-core throughput, where the head/tail padding and the
+// cached peer positions matter.
+void BM_SpscRingStream(benchmark::State& state) {
+    constexpr uint64_t kCount = 1 << 20;
+    const auto batch = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        SpscRing<uint64_t> ring(4096);
+        std::thread producer([&ring, batch] {
+            std::vector<uint64_t> in(batch, 1);
+            for (uint64_t sent = 0; sent < kCount;) {
+                size_t n = ring.Push(in.data(), std::min<uint64_t>(batch, kCount - sent));
+                if (n == 0) {
+                    std::this_thread::yield();
+                }
+                sent += n;
+            }
+        });
+        std::vector<uint64_t> out(batch);
+        for (uint64_t received = 0; received < kCount;) {
+            size_t n = ring.Pop(out.data(), batch);
+            if (n == 0) {
+                std::this_thread::yield();
+            }
+            received += n;
+        }
+        producer.join();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(kCount));
+}
+BENCHMARK(BM_SpscRingStream)->Arg(1)->Arg(64)->UseRealTime();
+
+// range(0) producer threads share one MpscRing with batches of 16.
+void BM_MpscRingStream(benchmark::State& state) {
+    constexpr uint64_t kPerProducer = 1 << 18;
+    constexpr size_t kBatch = 16;
+    const auto producers = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        MpscRing<uint64_t> ring(4096);
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&ring] {
+                uint64_t in[kBatch] = {};
+                for (uint64_t sent = 0; sent < kPerProducer;) {
+                    size_t n = ring.Push(in, kBatch);
+                    if (n == 0) {
+                        std::this_thread::yield();
+                    }
+                    sent += n;
+                }
+            });
+        }
+        uint64_t out[64];
+        const uint64_t total = kPerProducer * static_cast<uint64_t>(producers);
+        for (uint64_t received = 0; received < total;) {
+            size_t n = ring.Pop(out, 64);
+            if (n == 0) {
+                std::this_thread::yield();
+            }
+            received += n;
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(kPerProducer) * state.range(0));
+}
+BENCHMARK(BM_MpscRingStream)->Arg(1)->Arg(4)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,225 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "plas/config/device_entry.h"
+#include "plas/core/result.h"
+#include "plas/hal/device_manager.h"
+#include "plas/hal/driver/aardvark/aardvark_device.h"
+#include "plas/hal/driver/pmu3/pmu3_device.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace {
+
+using plas::core::Byte;
+using plas::core::ErrorCode;
+using plas::core::Result;
+using plas::hal::DeviceManager;
+using plas::hal::DeviceState;
+using plas::hal::I2c;
+
+// Minimal in-memory I2c device: isolates registry and dispatch cost from
+// any driver work.
+class BenchI2cDevice : public plas::hal::Device, public I2c {
+public:
+    explicit BenchI2cDevice(std::string name) : name_(std::move(name)) {}
+
+    Result<void> Init() override {
+        state_ = DeviceState::kInitialized;
+        return Result<void>::Ok();
+    }
+    Result<void> Open() override {
+        state_ = DeviceState::kOpen;
+        return Result<void>::Ok();
+    }
+    Result<void> Close() override {
+        state_ = DeviceState::kClosed;
+        return Result<void>::Ok();
+    }
+    Result<void> Reset() override {
+        state_ = DeviceState::kInitialized;
+        return Result<void>::Ok();
+    }
+    DeviceState GetState() const override { return state_; }
+    std::string GetName() const override { return name_; }
+    std::string GetUri() const override { return "bench://" + name_; }
+    std::string GetDriverName() const override { return "bench"; }
+
+    plas::hal::Device* GetDevice() override { return this; }
+    Result<size_t> Read(plas::core::Address, Byte* data, size_t length,
+                        bool) override {
+        for (size_t i = 0; i < length; ++i) {
+            data[i] = static_cast<Byte>(i);
+        }
+        return Result<size_t>::Ok(length);
+    }
+    Result<size_t> Write(plas::core::Address, const Byte*, size_t length,
+                         bool) override {
+        return Result<size_t>::Ok(length);
+    }
+    Result<size_t> WriteRead(plas::core::Address, const Byte*, size_t,
+                             Byte* read_data, size_t read_len) override {
+        return Read(0, read_data, read_len, true);
+    }
+    Result<void> SetBitrate(uint32_t) override { return Result<void>::Ok(); }
+    uint32_t GetBitrate() const override { return 400000; }
+
+private:
+    std::string name_;
+    DeviceState state_ = DeviceState::kUninitialized;
+};
+
+// --- DeviceManager lookups ---
+
+// Arg: number of registered devices; the looked-up one is the last.
+class DeviceManagerFixture : public benchmark::Fixture {
+public:
+    void SetUp(const benchmark::State& state) override {
+        auto& mgr = DeviceManager::GetInstance();
+        mgr.Reset();
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            auto device = std::make_unique<BenchI2cDevice>("dev" + std::to_string(i));
+            (void)device->Init();
+            (void)device->Open();
+            (void)mgr.AddDevice("dev" + std::to_string(i), std::move(device));
+        }
+        target_ = "dev" + std::to_string(state.range(0) - 1);
+    }
+    void TearDown(const benchmark::State&) override {
+        DeviceManager::GetInstance().Reset();
+    }
+
+protected:
+    std::string target_;
+};
+
+BENCHMARK_DEFINE_F(DeviceManagerFixture, GetInterface)(benchmark::State& state) {
+    auto& mgr = DeviceManager::GetInstance();
+    for (auto _ : state) {
+        auto* i2c = mgr.GetInterface<I2c>(target_);
+        benchmark::DoNotOptimize(i2c);
+    }
+}
+BENCHMARK_REGISTER_F(DeviceManagerFixture, GetInterface)->Arg(1)->Arg(64);
+
+BENCHMARK_DEFINE_F(DeviceManagerFixture, HandleGet)(benchmark::State& state) {
+    auto handle = DeviceManager::GetInstance().GetHandle<I2c>(target_);
+    if (!handle.IsValid()) {
+        state.SkipWithError("GetHandle failed");
+        return;
+    }
+    for (auto _ : state) {
+        auto* i2c = handle.Get();
+        benchmark::DoNotOptimize(i2c);
+    }
+}
+BENCHMARK_REGISTER_F(DeviceManagerFixture, HandleGet)->Arg(1)->Arg(64);
+
+BENCHMARK_DEFINE_F(DeviceManagerFixture, HandleWriteRead)(benchmark::State& state) {
+    auto handle = DeviceManager::GetInstance().GetHandle<I2c>(target_);
+    if (!handle.IsValid()) {
+        state.SkipWithError("GetHandle failed");
+        return;
+    }
+    const Byte reg = 0x10;
+    Byte data[4];
+    for (auto _ : state) {
+        auto result = handle.Get()->WriteRead(0x50, &reg, 1, data, sizeof(data));
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK_REGISTER_F(DeviceManagerFixture, HandleWriteRead)->Arg(1);
+
+// --- PCI addressing ---
+
+void BM_PciAddressFromString(benchmark::State& state) {
+    const std::string text = "0000:3b:00.1";
+    for (auto _ : state) {
+        auto address = plas::hal::pci::PciAddress::FromString(text);
+        benchmark::DoNotOptimize(address);
+    }
+}
+BENCHMARK(BM_PciAddressFromString);
+
+void BM_PciAddressToString(benchmark::State& state) {
+    auto address = plas::hal::pci::PciAddress::FromString("0000:3b:00.1").Value();
+    for (auto _ : state) {
+        auto text = address.ToString();
+        benchmark::DoNotOptimize(text);
+    }
+}
+BENCHMARK(BM_PciAddressToString);
+
+void BM_PciAddressParse(benchmark::State& state) {
+    const std::string_view text = "0000:3b:00.1";
+    for (auto _ : state) {
+        plas::hal::pci::PciAddress address{};
+        auto status = plas::hal::pci::PciAddress::Parse(text, address);
+        benchmark::DoNotOptimize(status);
+        benchmark::DoNotOptimize(address);
+    }
+}
+BENCHMARK(BM_PciAddressParse);
+
+void BM_PciAddressToChars(benchmark::State& state) {
+    plas::hal::pci::PciAddress address{0x0000, {0x3b, 0x00, 0x1}};
+    char buf[plas::hal::pci::PciAddress::kStringLength];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(address);
+        auto* end = address.ToChars(buf);
+        benchmark::DoNotOptimize(end);
+    }
+}
+BENCHMARK(BM_PciAddressToChars);
+
+void BM_BdfPack(benchmark::State& state) {
+    plas::hal::pci::Bdf bdf{0x3b, 0x00, 0x1};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(bdf);
+        auto packed = bdf.Pack();
+        benchmark::DoNotOptimize(packed);
+    }
+}
+BENCHMARK(BM_BdfPack);
+
+// --- Driver stub paths (no vendor SDK / hardware) ---
+
+plas::config::DeviceEntry MakeEntry(const std::string& uri, const std::string& driver) {
+    return plas::config::DeviceEntry{"bench0", uri, driver, {}};
+}
+
+// Without the Aardvark SDK Open() succeeds and transfers fail with
+// kNotSupported after bus arbitration; this is the error-path overhead.
+void BM_AardvarkStubWrite(benchmark::State& state) {
+    plas::hal::driver::AardvarkDevice device(MakeEntry("aardvark://0:0x50", "aardvark"));
+    if (device.Init().IsError() || device.Open().IsError()) {
+        state.SkipWithError("Aardvark device could not be opened");
+        return;
+    }
+    const Byte data[2] = {0x00, 0x01};
+    for (auto _ : state) {
+        auto result = device.Write(0x50, data, sizeof(data), true);
+        benchmark::DoNotOptimize(result);
+    }
+    (void)device.Close();
+}
+BENCHMARK(BM_AardvarkStubWrite);
+
+void BM_Pmu3StubSetVoltage(benchmark::State& state) {
+    plas::hal::driver::Pmu3Device device(MakeEntry("pmu3://usb:PMU3-001", "pmu3"));
+    (void)device.Init();
+    (void)device.Open();
+    for (auto _ : state) {
+        auto result = device.SetVoltage(plas::core::Voltage(3.3));
+        benchmark::DoNotOptimize(result);
+    }
+    (void)device.Close();
+}
+BENCHMARK(BM_Pmu3StubSetVoltage);
+
+}  // namespace
@@ -54,4 +54,36 @@ if(PLAS_BUILD_TESTS)
     FetchContent_MakeAvailable(googletest)
 endif()
 
+# google-benchmark - microbenchmarks
+if(PLAS_BUILD_BENCHMARKS)
+    FetchContent_Declare(
+        benchmark
+        GIT_REPOSITORY https://github.com/google/benchmark.git
+        GIT_TAG        v1.9.1
+        GIT_SHALLOW    TRUE
+    )
+    set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+    set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE BOOL "" FORCE)
+    set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+    FetchContent_MakeAvailable(benchmark)
+endif()
+
+# Perfetto SDK - system trace backend (PLAS_SYSTEM_TRACE=PERFETTO). The
+# amalgamated SDK has no CMake project, so build its one source here.
+string(TOUPPER "${PLAS_SYSTEM_TRACE}" _plas_system_trace)
+if(_plas_system_trace STREQUAL "PERFETTO")
+    FetchContent_Declare(
+        perfetto
+        GIT_REPOSITORY https://github.com/google/perfetto.git
+        GIT_TAG        v49.0
+        GIT_SHALLOW    TRUE
+    )
+    FetchContent_MakeAvailable(perfetto)
+    find_package(Threads REQUIRED)
+    add_library(plas_perfetto_sdk STATIC ${perfetto_SOURCE_DIR}/sdk/perfetto.cc)
+    target_include_directories(plas_perfetto_sdk SYSTEM PUBLIC
+        $<BUILD_INTERFACE:${perfetto_SOURCE_DIR}/sdk>)
+    target_link_libraries(plas_perfetto_sdk PUBLIC Threads::Threads)
+endif()
+
 FetchContent_MakeAvailable(spdlog nlohmann_json yaml-cpp json-schema-validator)
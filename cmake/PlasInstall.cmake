@@ -24,6 +24,39 @@ install(DIRECTORY components/plas-bootstrap/include/plas
     FILES_MATCHING PATTERN "*.h"
 )
 
+install(DIRECTORY components/plas-mctp/include/plas
+    DESTINATION ${CMAKE_INSTALL_INCLUDEDIR}
+    FILES_MATCHING PATTERN "*.h"
+)
+
+if(PLAS_HAS_REMOTE)
+    install(DIRECTORY components/plas-remote/include/plas
+        DESTINATION ${CMAKE_INSTALL_INCLUDEDIR}
+        FILES_MATCHING PATTERN "*.h"
+    )
+    install(TARGETS plas_remote
+        EXPORT PlasTargets
+        LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR}
+        ARCHIVE DESTINATION ${CMAKE_INSTALL_LIBDIR}
+        RUNTIME DESTINATION ${CMAKE_INSTALL_BINDIR}
+        INCLUDES DESTINATION ${CMAKE_INSTALL_INCLUDEDIR}
+    )
+endif()
+
+if(PLAS_HAS_CORO)
+    install(DIRECTORY components/plas-coro/include/plas
+        DESTINATION ${CMAKE_INSTALL_INCLUDEDIR}
+        FILES_MATCHING PATTERN "*.h"
+    )
+    install(TARGETS plas_coro
+        EXPORT PlasTargets
+        LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR}
+        ARCHIVE DESTINATION ${CMAKE_INSTALL_LIBDIR}
+        RUNTIME DESTINATION ${CMAKE_INSTALL_BINDIR}
+        INCLUDES DESTINATION ${CMAKE_INSTALL_INCLUDEDIR}
+    )
+endif()
+
 # Install plas library targets
 install(TARGETS
         plas_core
@@ -33,6 +66,7 @@ install(TARGETS
         plas_hal_driver
         plas_configspec
         plas_bootstrap
+        plas_mctp
         plas_compiler_settings
     EXPORT PlasTargets
     LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR}
@@ -41,6 +75,14 @@ install(TARGETS
     INCLUDES DESTINATION ${CMAKE_INSTALL_INCLUDEDIR}
 )
 
+# Perfetto SDK, built in-tree when PLAS_SYSTEM_TRACE=PERFETTO
+if(TARGET plas_perfetto_sdk)
+    install(TARGETS plas_perfetto_sdk
+        EXPORT PlasTargets
+        ARCHIVE DESTINATION ${CMAKE_INSTALL_LIBDIR}
+    )
+endif()
+
 # Also install the FetchContent-provided dependency targets so that
 # the export set can reference them.  Each FetchContent project uses
 # a separate export set to keep things tidy.
@@ -1,14 +1,19 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "plas/config/config.h"
 #include "plas/config/config_format.h"
 #include "plas/config/config_node.h"
+#include "plas/config/device_uri.h"
 #include "plas/core/error.h"
+#include "plas/core/executor.h"
 #include "plas/core/result.h"
 #include "plas/hal/device_manager.h"
 #include "plas/log/log_config.h"
@@ -18,6 +23,14 @@ namespace plas::config {
 class PropertyManager;
 }  // namespace plas::config
 
+namespace plas::configspec {
+class SpecRegistry;
+}  // namespace plas::configspec
+
+namespace plas::log {
+class Logger;
+}  // namespace plas::log
+
 namespace plas::bootstrap {
 
 struct BootstrapConfig {
@@ -31,12 +44,72 @@ struct BootstrapConfig {
     std::string properties_config_path;
     config::ConfigFormat properties_config_format = config::ConfigFormat::kAuto;
 
+    /// Directory for compiled config files (config::ConfigCache). Set it to
+    /// let repeated Init() calls across processes skip JSON/YAML parsing of
+    /// unchanged device and properties files. Empty leaves the process-wide
+    /// setting ($PLAS_CONFIG_CACHE_DIR) alone.
+    std::string config_cache_dir;
+
     bool auto_open_devices = true;
     bool skip_unknown_drivers = true;
     bool skip_device_failures = true;
 
+    /// Devices opened concurrently by auto_open_devices (<= 1: one at a
+    /// time). Devices on the same bus ("driver://bus") still open one after
+    /// another in DeviceNames() order.
+    std::size_t open_workers = 1;
+
+    /// Worker count and CPU pinning of core::Executor::Shared(), which runs
+    /// parallel open, async DOE exchanges and the monitors. Takes effect
+    /// only if set before anything in the process has used the executor
+    /// (in practice: on the first Init()); otherwise a warning is logged.
+    std::optional<core::ExecutorOptions> executor;
+
+    /// Skip opening at Init(); DeviceManager opens each device on its first
+    /// lookup instead (overrides auto_open_devices). With idle_close_ms > 0,
+    /// lazily opened devices unused for that long are closed again.
+    bool lazy_open_devices = false;
+    uint32_t idle_close_ms = 0;
+
+    /// Probe the opened devices in the background and reconnect the ones
+    /// that drop out (hal::DeviceManager::StartHealthSupervisor), started at
+    /// the end of Init() and stopped by Deinit(). Invalid options are logged
+    /// and leave the supervisor off.
+    std::optional<hal::HealthSupervisorOptions> health_supervisor;
+
+    /// Turn on per-device latency/throughput metrics (hal::MetricsRegistry).
+    bool enable_metrics = false;
+
+    /// Record every I2c/PciConfig/PciDoe/PciBar call of the devices created
+    /// by Init() to this file (hal::RecordTransactions), for replay through
+    /// the "replay" driver. Devices added later by Reload() are not recorded.
+    std::string record_trace_path;
+
     configspec::ValidationMode validation_mode = configspec::ValidationMode::kLenient;
     std::string spec_dir;
+
+    /// Write BootstrapResult::timing as Chrome trace JSON (chrome://tracing,
+    /// Perfetto) to this file after a successful Init(). A write failure is
+    /// logged and does not fail Init().
+    std::string startup_trace_path;
+
+    /// Adopt the devices that the process which exec'ed this one handed
+    /// over with Bootstrap::PrepareWarmRestart() ($PLAS_WARM_RESTART_FD)
+    /// instead of opening them. Applies to auto_open_devices; entries whose
+    /// driver or URI changed, and handoffs a driver refuses, are opened
+    /// normally and their old fds closed.
+    bool warm_restart = false;
+
+    /// Run on this Bootstrap's own hal::DeviceManager, config::PropertyManager
+    /// and configspec::SpecRegistry (and, with log_config, log::Logger)
+    /// instead of the process-wide instances, so several Bootstraps can
+    /// Init() and run side by side in one process, e.g. one per tenant of a
+    /// test farm, even with the same nicknames and session names. Reach
+    /// them through the Bootstrap's getters. Init(), Reload() and Deinit()
+    /// log to the own logger on the calling thread; executor workers and
+    /// monitors log to the process-wide one. Drivers, the shared executor,
+    /// the config cache and metrics (hal::MetricsRegistry) stay process-wide.
+    bool isolated = false;
 };
 
 struct DeviceFailure {
@@ -48,10 +121,60 @@ struct DeviceFailure {
     std::string detail;  // human-readable context (driver-specific)
 };
 
+/// One timed step of Init(). `start` is relative to the start of Init();
+/// `cpu` is the CPU time of the thread that ran the step.
+struct PhaseTiming {
+    std::chrono::nanoseconds start{0};
+    std::chrono::nanoseconds wall{0};
+    std::chrono::nanoseconds cpu{0};
+};
+
+/// Timing of one device entry that reached the create step. init/open stay
+/// zero for devices that were not opened by Init() (or failed before).
+struct DeviceTiming {
+    std::string nickname;
+    std::string driver;
+    PhaseTiming create;  // URI check, DeviceFactory (registered together at the end of the phase)
+    PhaseTiming init;
+    PhaseTiming open;
+    uint32_t thread = 0;  // 0: the Init() caller, 1..n: executor workers
+};
+
+/// Where Init() spent its time. Phases run one after another on the
+/// caller's thread, except that `open` spans the parallel Init()+Open() of
+/// all devices: its `cpu` is the sum over devices, which can exceed `wall`.
+struct BootstrapTiming {
+    PhaseTiming total;
+    PhaseTiming setup;       // driver table, logger, executor, metrics
+    PhaseTiming properties;  // properties_config_path
+    PhaseTiming parse;       // device config
+    PhaseTiming validate;    // config spec (validation_mode != kLenient)
+    PhaseTiming create;      // devices, then one DeviceManager::AddDevices
+    PhaseTiming open;
+    std::vector<DeviceTiming> devices;  // config order
+
+    /// Chrome trace event JSON: one complete ("X") event per phase on
+    /// thread 0 and per device init/open on the thread that ran it, with
+    /// the CPU time in `args.cpu_us`.
+    std::string ToChromeTrace() const;
+};
+
 struct BootstrapResult {
     std::size_t devices_opened = 0;
     std::size_t devices_failed = 0;
     std::size_t devices_skipped = 0;
+    std::size_t devices_adopted = 0;  // of devices_opened, taken over by warm_restart
+    std::vector<DeviceFailure> failures;
+    BootstrapTiming timing;
+};
+
+struct ReloadResult {
+    std::size_t devices_added = 0;
+    std::size_t devices_changed = 0;
+    std::size_t devices_removed = 0;
+    std::size_t devices_unchanged = 0;
+    std::size_t devices_failed = 0;
+    std::size_t devices_skipped = 0;
     std::vector<DeviceFailure> failures;
 };
 
@@ -69,19 +192,49 @@ public:
     /// Register all available drivers (hides #ifdef guards internally).
     static void RegisterAllDrivers();
 
-    /// Validate URI format: "driver://bus:identifier".
+    /// Validate URI format: "driver://bus:identifier" or "driver://host/path".
     static bool ValidateUri(const std::string& uri);
+    static bool ValidateUri(const config::DeviceUri& uri);
 
     /// Run the full initialization sequence.
     core::Result<BootstrapResult> Init(const BootstrapConfig& config);
 
+    /// Apply a changed device config without a Deinit(): diff it against
+    /// the loaded devices, validate (validation_mode) and create only added
+    /// and changed entries, close and replace those, and drop removed ones.
+    /// Unchanged devices stay open. Failure handling follows Init()'s
+    /// BootstrapConfig; a skipped changed entry keeps its old device. Without
+    /// skip_device_failures, a rejected entry fails the reload before any
+    /// device is touched. kNotInitialized before Init().
+    core::Result<ReloadResult> Reload(const config::Config& updated);
+
+    /// Reload() from the device config source given to Init().
+    core::Result<ReloadResult> Reload();
+
     /// Tear down in reverse order (idempotent).
     void Deinit();
 
+    /// Environment variable naming the fd that carries the handoff state.
+    static constexpr const char* kWarmRestartEnv = "PLAS_WARM_RESTART_FD";
+
+    /// Prepare to exec a new version of this process without reopening
+    /// adapters: every open device implementing hal::DeviceHandoffSupport
+    /// is released (left kClosed, its fds kept open and made inheritable),
+    /// the handoff is written to an inheritable memfd and
+    /// $PLAS_WARM_RESTART_FD is set. Exec right after; the new process calls
+    /// Init() with warm_restart. Returns the number of devices handed off.
+    /// If exec fails, Deinit() closes the released fds. kNotInitialized
+    /// before Init(), kNotSupported on platforms without memfd.
+    core::Result<std::size_t> PrepareWarmRestart();
+
     bool IsInitialized() const;
 
+    /// The contexts Init() uses: the process-wide instances, or this
+    /// Bootstrap's own after an isolated Init().
     hal::DeviceManager* GetDeviceManager();
     config::PropertyManager* GetPropertyManager();
+    configspec::SpecRegistry* GetSpecRegistry();
+    log::Logger* GetLogger();
 
     hal::Device* GetDevice(const std::string& nickname);
     hal::Device* GetDeviceByUri(const std::string& uri);
@@ -93,11 +246,18 @@ public:
     std::vector<std::pair<std::string, T*>> GetDevicesByInterface();
 
     std::vector<std::string> DeviceNames() const;
+    /// Failures of the last Init() or Reload().
     const std::vector<DeviceFailure>& GetFailures() const;
 
     /// Return a formatted summary of all loaded devices (for debugging).
     std::string DumpDevices() const;
 
+    /// Latency/throughput counters of the loaded devices.
+    hal::MetricsSnapshot GetMetricsSnapshot() const;
+
+    /// Return a formatted per-device, per-operation metrics table.
+    std::string DumpMetrics() const;
+
 private:
     struct Impl;
     std::unique_ptr<Impl> impl_;
@@ -107,14 +267,12 @@ private:
 
 template <typename T>
 T* Bootstrap::GetInterface(const std::string& nickname) {
-    auto* device = GetDevice(nickname);
-    if (!device) return nullptr;
-    return dynamic_cast<T*>(device);
+    return GetDeviceManager()->GetInterface<T>(nickname);
 }
 
 template <typename T>
 std::vector<std::pair<std::string, T*>> Bootstrap::GetDevicesByInterface() {
-    return hal::DeviceManager::GetInstance().GetDevicesByInterface<T>();
+    return GetDeviceManager()->GetDevicesByInterface<T>();
 }
 
 }  // namespace plas::bootstrap
@@ -1,13 +1,38 @@
 #include "plas/bootstrap/bootstrap.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <map>
 #include <set>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 
+#ifndef _WIN32
+#include <time.h>
+#endif
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include "plas/config/config.h"
+#include "plas/config/config_cache.h"
+#include "plas/config/config_diff.h"
 #include "plas/config/property_manager.h"
+#include "plas/core/executor.h"
 #include "plas/core/properties.h"
 #include "plas/hal/interface/device_factory.h"
+#include "plas/hal/interface/device_handoff.h"
 #include "plas/hal/interface/i2c.h"
 #include "plas/hal/interface/i3c.h"
 #include "plas/hal/interface/power_control.h"
@@ -19,17 +44,36 @@
 #include "plas/hal/interface/pci/pci_doe.h"
 #include "plas/hal/interface/pci/cxl.h"
 #include "plas/hal/interface/pci/cxl_mailbox.h"
+#include "plas/hal/transaction_trace.h"
 #include "plas/log/logger.h"
 #include "plas/configspec/spec_registry.h"
 #include "plas/configspec/validator.h"
 
 #include "plas/hal/driver/aardvark/aardvark_device.h"
 #include "plas/hal/driver/ft4222h/ft4222h_device.h"
+#include "plas/hal/driver/image/config_image_device.h"
 #include "plas/hal/driver/pmu3/pmu3_device.h"
 #include "plas/hal/driver/pmu4/pmu4_device.h"
+#include "plas/hal/driver/replay/replay_device.h"
+#include "plas/hal/driver/sim/sim_device.h"
 #ifdef PLAS_HAS_PCIUTILS
 #include "plas/hal/driver/pciutils/pciutils_device.h"
 #endif
+#ifdef PLAS_HAS_I3CDEV
+#include "plas/hal/driver/i3cdev/i3cdev_device.h"
+#endif
+#ifdef PLAS_HAS_VFIO
+#include "plas/hal/driver/vfio/vfio_device.h"
+#endif
+#ifdef PLAS_HAS_TERMIOS
+#include "plas/hal/driver/termios/termios_device.h"
+#endif
+#ifdef PLAS_HAS_REMOTE
+#include "plas/remote/remote_device.h"
+#endif
+#ifdef PLAS_HAS_SHM_BROKER
+#include "plas/remote/shm_device.h"
+#endif
 
 namespace plas::bootstrap {
 
@@ -68,32 +112,442 @@ std::string ProbeInterfaces(hal::Device* dev) {
         result += name;
     };
 
-    if (dynamic_cast<hal::I2c*>(dev))              append("I2c");
-    if (dynamic_cast<hal::I3c*>(dev))              append("I3c");
-    if (dynamic_cast<hal::PowerControl*>(dev))     append("PowerControl");
-    if (dynamic_cast<hal::Serial*>(dev))           append("Serial");
-    if (dynamic_cast<hal::Uart*>(dev))             append("Uart");
-    if (dynamic_cast<hal::SsdGpio*>(dev))          append("SsdGpio");
-    if (dynamic_cast<hal::pci::PciConfig*>(dev))   append("PciConfig");
-    if (dynamic_cast<hal::pci::PciDoe*>(dev))      append("PciDoe");
-    if (dynamic_cast<hal::pci::PciBar*>(dev))      append("PciBar");
-    if (dynamic_cast<hal::pci::Cxl*>(dev))         append("Cxl");
-    if (dynamic_cast<hal::pci::CxlMailbox*>(dev))  append("CxlMailbox");
+    if (hal::InterfaceCast<hal::I2c>(dev))             append("I2c");
+    if (hal::InterfaceCast<hal::I3c>(dev))             append("I3c");
+    if (hal::InterfaceCast<hal::PowerControl>(dev))    append("PowerControl");
+    if (hal::InterfaceCast<hal::Serial>(dev))          append("Serial");
+    if (hal::InterfaceCast<hal::Uart>(dev))            append("Uart");
+    if (hal::InterfaceCast<hal::SsdGpio>(dev))         append("SsdGpio");
+    if (hal::InterfaceCast<hal::pci::PciConfig>(dev))  append("PciConfig");
+    if (hal::InterfaceCast<hal::pci::PciDoe>(dev))     append("PciDoe");
+    if (hal::InterfaceCast<hal::pci::PciBar>(dev))     append("PciBar");
+    if (hal::InterfaceCast<hal::pci::Cxl>(dev))        append("Cxl");
+    if (hal::InterfaceCast<hal::pci::CxlMailbox>(dev)) append("CxlMailbox");
 
     return result.empty() ? "(none)" : result;
 }
 
+using Clock = std::chrono::steady_clock;
+
+/// CPU time consumed by the calling thread (0 where unsupported).
+std::chrono::nanoseconds ThreadCpuTime() {
+#ifndef _WIN32
+    timespec ts{};
+    if (::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+    }
+#endif
+    return std::chrono::nanoseconds(0);
+}
+
+/// Measures one PhaseTiming, from construction to Stop(), on one thread.
+class PhaseTimer {
+public:
+    explicit PhaseTimer(Clock::time_point origin)
+        : origin_(origin), wall_(Clock::now()), cpu_(ThreadCpuTime()) {}
+
+    PhaseTiming Stop() const {
+        PhaseTiming timing;
+        timing.start = wall_ - origin_;
+        timing.wall = Clock::now() - wall_;
+        timing.cpu = ThreadCpuTime() - cpu_;
+        return timing;
+    }
+
+private:
+    Clock::time_point origin_;
+    Clock::time_point wall_;
+    std::chrono::nanoseconds cpu_;
+};
+
+/// Result of Init()+Open() on one device; `phase` names the failing step.
+struct OpenOutcome {
+    std::error_code error;
+    const char* phase = "";
+    PhaseTiming init;
+    PhaseTiming open;
+    std::thread::id thread;
+    bool adopted = false;  // opened from a warm-restart handoff
+};
+
+/// Devices sharing a bus must not open concurrently. The bus is everything
+/// in "driver://bus:identifier" up to the last colon, e.g. "aardvark://0"
+/// or "pciutils://0000:03".
+std::string BusKey(const std::string& uri) {
+    auto colon = uri.rfind(':');
+    auto scheme_end = uri.find("://");
+    if (colon == std::string::npos || scheme_end == std::string::npos ||
+        colon <= scheme_end) {
+        return uri;
+    }
+    return uri.substr(0, colon);
+}
+
+/// Init() + Open() every non-null device. Devices on the same bus run in
+/// list order on one thread; distinct buses are spread over up to `workers`
+/// threads of core::Executor::Shared() (<= 1: caller thread only). With `stop_on_error`, devices not yet
+/// started after the first failure are left untouched (error stays empty).
+/// A device with a non-null `handoffs[i]` is adopted from it instead of
+/// opened, falling back to Open() if the driver refuses.
+std::vector<OpenOutcome> OpenDevices(const std::vector<hal::Device*>& devices,
+                                     std::size_t workers,
+                                     bool stop_on_error,
+                                     Clock::time_point origin,
+                                     const std::vector<const hal::DeviceHandoff*>& handoffs = {}) {
+    std::vector<OpenOutcome> outcomes(devices.size());
+
+    std::vector<std::vector<std::size_t>> buses;
+    std::map<std::string, std::size_t> bus_index;
+    for (std::size_t i = 0; i < devices.size(); ++i) {
+        if (!devices[i]) continue;
+        auto key = BusKey(devices[i]->GetUri());
+        auto [it, inserted] = bus_index.emplace(key, buses.size());
+        if (inserted) {
+            buses.emplace_back();
+        }
+        buses[it->second].push_back(i);
+    }
+
+    std::atomic<bool> failed{false};
+    auto open_bus = [&](const std::vector<std::size_t>& members) {
+        for (auto i : members) {
+            if (stop_on_error && failed.load()) {
+                return;
+            }
+            auto& outcome = outcomes[i];
+            outcome.thread = std::this_thread::get_id();
+            PhaseTimer init_timer(origin);
+            auto init = devices[i]->Init();
+            outcome.init = init_timer.Stop();
+            if (init.IsError()) {
+                outcome.error = init.Error();
+                outcome.phase = "init";
+                failed.store(true);
+                continue;
+            }
+            PhaseTimer open_timer(origin);
+            if (i < handoffs.size() && handoffs[i]) {
+                auto* support = dynamic_cast<hal::DeviceHandoffSupport*>(devices[i]);
+                auto adopt = support ? support->AdoptHandoff(*handoffs[i])
+                                     : core::Result<void>::Err(core::ErrorCode::kNotSupported);
+                if (adopt.IsOk()) {
+                    outcome.open = open_timer.Stop();
+                    outcome.adopted = true;
+                    continue;
+                }
+                PLAS_LOG_WARN("Bootstrap: cannot adopt '" + devices[i]->GetName() +
+                              "' from warm restart (" + adopt.Error().message() +
+                              "), reopening");
+            }
+            auto open = devices[i]->Open();
+            outcome.open = open_timer.Stop();
+            if (open.IsError()) {
+                outcome.error = open.Error();
+                outcome.phase = "open";
+                failed.store(true);
+            }
+        }
+    };
+
+    workers = std::min(workers, buses.size());
+    if (workers <= 1) {
+        std::vector<std::size_t> all;
+        for (std::size_t i = 0; i < devices.size(); ++i) {
+            if (devices[i]) all.push_back(i);
+        }
+        open_bus(all);
+        return outcomes;
+    }
+
+    core::Executor::Shared().ParallelFor(
+        buses.size(), [&](std::size_t b) { open_bus(buses[b]); }, workers);
+    return outcomes;
+}
+
+/// `text` as a JSON string literal.
+std::string JsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        auto u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (u < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", u);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+double Micros(std::chrono::nanoseconds ns) {
+    return std::chrono::duration<double, std::micro>(ns).count();
+}
+
+void AppendTraceEvent(std::ostringstream& out, bool& first, const std::string& name,
+                      const char* category, uint32_t thread, const PhaseTiming& timing) {
+    out << (first ? "\n" : ",\n") << "{\"name\":" << JsonString(name) << ",\"cat\":\""
+        << category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+        << ",\"ts\":" << Micros(timing.start) << ",\"dur\":" << Micros(timing.wall)
+        << ",\"args\":{\"cpu_us\":" << Micros(timing.cpu) << "}}";
+    first = false;
+}
+
+/// One device of a warm-restart handoff.
+struct HandoffRecord {
+    std::string nickname;
+    std::string driver;
+    std::string uri;
+    hal::DeviceHandoff handoff;
+};
+
+constexpr const char kHandoffHeader[] = "plas-warm-restart 1\n";
+
+bool HandoffFieldOk(const std::string& field) {
+    return !field.empty() && field.find_first_of("\t\n") == std::string::npos;
+}
+
+/// Header line, then one line per device:
+/// "nickname\tdriver\turi\tfd,fd,...\thex(state)".
+std::string EncodeHandoffs(const std::vector<HandoffRecord>& records) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::string out = kHandoffHeader;
+    for (const auto& record : records) {
+        out += record.nickname + '\t' + record.driver + '\t' + record.uri + '\t';
+        for (std::size_t i = 0; i < record.handoff.fds.size(); ++i) {
+            out += (i ? "," : "") + std::to_string(record.handoff.fds[i]);
+        }
+        out += '\t';
+        for (char c : record.handoff.state) {
+            const auto byte = static_cast<unsigned char>(c);
+            out += kHex[byte >> 4];
+            out += kHex[byte & 0xF];
+        }
+        out += '\n';
+    }
+    return out;
+}
+
+void CloseHandoffFds(const std::vector<int>& fds) {
+#ifdef __linux__
+    for (int fd : fds) {
+        ::close(fd);
+    }
+#else
+    (void)fds;
+#endif
+}
+
+/// Records of an EncodeHandoffs() blob; malformed lines are dropped, and
+/// the descriptors they did name are closed so they do not leak.
+std::vector<HandoffRecord> DecodeHandoffs(const std::string& blob) {
+    std::vector<HandoffRecord> records;
+    if (blob.compare(0, sizeof(kHandoffHeader) - 1, kHandoffHeader) != 0) {
+        return records;
+    }
+    std::istringstream in(blob.substr(sizeof(kHandoffHeader) - 1));
+    std::string line;
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields;
+        std::istringstream split(line);
+        for (std::string field; std::getline(split, field, '\t');) {
+            fields.push_back(field);
+        }
+        if (fields.size() == 4) fields.emplace_back();  // empty state
+        if (fields.size() < 4) continue;
+
+        HandoffRecord record{fields[0], fields[1], fields[2], {}};
+        std::istringstream fds(fields[3]);
+        bool ok = fields.size() == 5 && fields[4].size() % 2 == 0;
+        for (std::string fd; std::getline(fds, fd, ',');) {
+            char* end = nullptr;
+            long value = std::strtol(fd.c_str(), &end, 10);
+            if (fd.empty() || *end != '\0' || value < 0 || value > INT32_MAX) {
+                ok = false;
+                continue;
+            }
+            record.handoff.fds.push_back(static_cast<int>(value));
+        }
+        auto nibble = [](char c) {
+            return c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+        };
+        for (std::size_t i = 0; ok && i < fields[4].size(); i += 2) {
+            int hi = nibble(fields[4][i]);
+            int lo = nibble(fields[4][i + 1]);
+            ok = hi >= 0 && lo >= 0;
+            record.handoff.state += static_cast<char>((hi << 4) | lo);
+        }
+        if (ok && !record.handoff.fds.empty()) {
+            records.push_back(std::move(record));
+        } else {
+            CloseHandoffFds(record.handoff.fds);
+        }
+    }
+    return records;
+}
+
+/// Read and consume the handoff left by PrepareWarmRestart() in the
+/// process that exec'ed us: the state fd is closed and the variable unset.
+std::vector<HandoffRecord> TakeWarmRestartHandoffs() {
+    std::vector<HandoffRecord> records;
+#ifdef __linux__
+    const char* env = std::getenv(Bootstrap::kWarmRestartEnv);
+    if (!env) {
+        return records;
+    }
+    char* end = nullptr;
+    long fd = std::strtol(env, &end, 10);
+    ::unsetenv(Bootstrap::kWarmRestartEnv);
+    if (end == env || *end != '\0' || fd < 0 || fd > INT32_MAX) {
+        PLAS_LOG_WARN("Bootstrap: ignoring malformed " + std::string(Bootstrap::kWarmRestartEnv));
+        return records;
+    }
+    std::string blob;
+    char buf[4096];
+    ssize_t n = 0;
+    while ((n = ::pread(static_cast<int>(fd), buf, sizeof(buf),
+                        static_cast<off_t>(blob.size()))) > 0) {
+        blob.append(buf, static_cast<std::size_t>(n));
+    }
+    ::close(static_cast<int>(fd));
+    records = DecodeHandoffs(blob);
+    if (records.empty()) {
+        PLAS_LOG_WARN("Bootstrap: warm restart state is empty or unreadable");
+    }
+#endif
+    return records;
+}
+
+/// Copy per-device init/open timings into `timing.devices` (matched by
+/// nickname), number the threads that ran them, and add their CPU time to
+/// the open phase.
+void RecordOpenTimings(const std::vector<std::string>& names,
+                       const std::vector<OpenOutcome>& outcomes, BootstrapTiming& timing) {
+    std::unordered_map<std::string, DeviceTiming*> by_name;
+    for (auto& device : timing.devices) {
+        by_name.emplace(device.nickname, &device);
+    }
+    std::unordered_map<std::thread::id, uint32_t> threads{{std::this_thread::get_id(), 0}};
+    for (std::size_t i = 0; i < outcomes.size(); ++i) {
+        auto it = by_name.find(names[i]);
+        if (it == by_name.end() || outcomes[i].thread == std::thread::id()) continue;
+        auto& device = *it->second;
+        device.init = outcomes[i].init;
+        device.open = outcomes[i].open;
+        auto thread = threads.emplace(outcomes[i].thread, static_cast<uint32_t>(threads.size()));
+        device.thread = thread.first->second;
+        timing.open.cpu += device.init.cpu + device.open.cpu;
+    }
+}
+
+core::Result<config::Config> LoadDeviceConfig(const BootstrapConfig& cfg) {
+    if (cfg.device_config_node.has_value()) {
+        return config::Config::LoadFromNode(cfg.device_config_node.value());
+    }
+    if (!cfg.device_config_key_path.empty()) {
+        return config::Config::LoadFromFile(cfg.device_config_path,
+                                            cfg.device_config_key_path,
+                                            cfg.device_config_format);
+    }
+    return config::Config::LoadFromFile(cfg.device_config_path,
+                                        cfg.device_config_format);
+}
+
 }  // namespace
 
+// ---------------------------------------------------------------------------
+// BootstrapTiming
+// ---------------------------------------------------------------------------
+
+std::string BootstrapTiming::ToChromeTrace() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+    bool first = true;
+    const std::pair<const char*, const PhaseTiming*> phases[] = {
+        {"bootstrap", &total}, {"setup", &setup},       {"properties", &properties},
+        {"parse", &parse},     {"validate", &validate}, {"create", &create},
+        {"open", &open},
+    };
+    for (const auto& [name, phase] : phases) {
+        AppendTraceEvent(out, first, name, "phase", 0, *phase);
+    }
+    for (const auto& device : devices) {
+        AppendTraceEvent(out, first, "create " + device.nickname, "device", 0, device.create);
+        if (device.init.wall.count() > 0) {
+            AppendTraceEvent(out, first, "init " + device.nickname, "device", device.thread,
+                             device.init);
+        }
+        if (device.open.wall.count() > 0) {
+            AppendTraceEvent(out, first, "open " + device.nickname, "device", device.thread,
+                             device.open);
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return out.str();
+}
+
 // ---------------------------------------------------------------------------
 // Impl
 // ---------------------------------------------------------------------------
 
 struct Bootstrap::Impl {
+    // BootstrapConfig::isolated: this Bootstrap's own contexts. The logger
+    // is declared first so it outlives the devices that may log on close.
+    std::unique_ptr<log::Logger> own_logger;
+    std::unique_ptr<hal::DeviceManager> own_devices;
+    std::unique_ptr<config::PropertyManager> own_properties;
+    std::unique_ptr<configspec::SpecRegistry> own_specs;
+
     bool initialized = false;
     bool logger_initialized = false;
     bool properties_loaded = false;
     std::vector<DeviceFailure> failures;
+    BootstrapConfig config;  // from Init(), reused by Reload()
+    std::shared_ptr<hal::TraceWriter> trace_writer;  // record_trace_path
+    std::vector<int> handoff_fds;  // released by PrepareWarmRestart(), closed by Deinit()
+
+    hal::DeviceManager& Devices() {
+        return own_devices ? *own_devices : hal::DeviceManager::GetInstance();
+    }
+    config::PropertyManager& PropertyStore() {
+        return own_properties ? *own_properties : config::PropertyManager::GetInstance();
+    }
+    configspec::SpecRegistry& Specs() {
+        return own_specs ? *own_specs : configspec::SpecRegistry::GetInstance();
+    }
+    log::Logger& Log() { return own_logger ? *own_logger : log::Logger::GetInstance(); }
+    /// Where PLAS_LOG_* output of this Bootstrap's calls goes: the own
+    /// logger, or whatever the caller's thread already uses.
+    log::Logger& LogScope() { return own_logger ? *own_logger : log::Logger::Current(); }
+
+    /// Create the own contexts for an isolated Init(), or drop them for a
+    /// shared one. Only called while not initialized.
+    void SelectContexts(bool isolated) {
+        if (!isolated) {
+            own_specs.reset();
+            own_properties.reset();
+            own_devices.reset();
+            own_logger.reset();
+            return;
+        }
+        if (!own_devices) own_devices = std::make_unique<hal::DeviceManager>();
+        if (!own_properties) own_properties = std::make_unique<config::PropertyManager>();
+        if (!own_specs) own_specs = std::make_unique<configspec::SpecRegistry>();
+    }
+
+    /// Undo the properties load: the own manager drops its sessions, the
+    /// shared one also destroys every registry session.
+    void UnloadProperties() {
+        if (!properties_loaded) return;
+        PropertyStore().Reset();
+        if (!own_properties) {
+            core::Properties::DestroyAll();
+        }
+        properties_loaded = false;
+    }
 };
 
 // ---------------------------------------------------------------------------
@@ -115,14 +569,42 @@ Bootstrap& Bootstrap::operator=(Bootstrap&& other) noexcept = default;
 // RegisterAllDrivers
 // ---------------------------------------------------------------------------
 
-void Bootstrap::RegisterAllDrivers() {
-    hal::driver::AardvarkDevice::Register();
-    hal::driver::Ft4222hDevice::Register();
-    hal::driver::Pmu3Device::Register();
-    hal::driver::Pmu4Device::Register();
+namespace {
+
+/// Drivers compiled into this build; PLAS_HAS_* come from the optional
+/// driver checks in CMake.
+constexpr hal::DeviceFactory::BuiltinDriver kBuiltinDrivers[] = {
+    {"aardvark", &hal::DeviceFactory::Make<hal::driver::AardvarkDevice>},
+    {"ft4222h", &hal::DeviceFactory::Make<hal::driver::Ft4222hDevice>},
+    {"pmu3", &hal::DeviceFactory::Make<hal::driver::Pmu3Device>},
+    {"pmu4", &hal::DeviceFactory::Make<hal::driver::Pmu4Device>},
+    {"sim", &hal::driver::SimDevice::Create},
+    {"replay", &hal::driver::ReplayDevice::Create},
+    {"image", &hal::DeviceFactory::Make<hal::driver::ConfigImageDevice>},
 #ifdef PLAS_HAS_PCIUTILS
-    hal::driver::PciUtilsDevice::Register();
+    {"pciutils", &hal::DeviceFactory::Make<hal::driver::PciUtilsDevice>},
+#endif
+#ifdef PLAS_HAS_I3CDEV
+    {"i3cdev", &hal::DeviceFactory::Make<hal::driver::I3cDevDevice>},
+#endif
+#ifdef PLAS_HAS_VFIO
+    {"vfio", &hal::DeviceFactory::Make<hal::driver::VfioDevice>},
 #endif
+#ifdef PLAS_HAS_TERMIOS
+    {"termios", &hal::DeviceFactory::Make<hal::driver::TermiosDevice>},
+#endif
+#ifdef PLAS_HAS_REMOTE
+    {"remote", &remote::RemoteDevice::Create},
+#endif
+#ifdef PLAS_HAS_SHM_BROKER
+    {"shm", &remote::ShmDevice::Create},
+#endif
+};
+
+}  // namespace
+
+void Bootstrap::RegisterAllDrivers() {
+    hal::DeviceFactory::SetBuiltinDrivers(kBuiltinDrivers, std::size(kBuiltinDrivers));
 }
 
 // ---------------------------------------------------------------------------
@@ -130,25 +612,14 @@ void Bootstrap::RegisterAllDrivers() {
 // ---------------------------------------------------------------------------
 
 bool Bootstrap::ValidateUri(const std::string& uri) {
-    // Expected format: driver://bus:identifier
-    auto scheme_end = uri.find("://");
-    if (scheme_end == std::string::npos || scheme_end == 0) {
-        return false;
-    }
-
-    auto authority = uri.substr(scheme_end + 3);
-    if (authority.empty()) {
-        return false;
-    }
-
-    // Must contain at least one colon separating bus and identifier
-    auto colon = authority.find(':');
-    if (colon == std::string::npos || colon == 0 ||
-        colon == authority.size() - 1) {
-        return false;
-    }
+    return ValidateUri(config::DeviceUri::Parse(uri));
+}
 
-    return true;
+bool Bootstrap::ValidateUri(const config::DeviceUri& uri) {
+    // Expected format: driver://bus:identifier — at least two fields — or
+    // driver://host/path (remote://)
+    return uri.IsValid() &&
+           (uri.FieldCount() >= 2 || uri.Authority().find('/') != std::string_view::npos);
 }
 
 // ---------------------------------------------------------------------------
@@ -166,18 +637,44 @@ core::Result<BootstrapResult> Bootstrap::Init(const BootstrapConfig& cfg) {
             core::ErrorCode::kInvalidArgument);
     }
 
+    const auto origin = Clock::now();
+    PhaseTimer total_timer(origin);
+    BootstrapTiming timing;
+
     // 1. Register drivers
+    PhaseTimer setup_timer(origin);
     RegisterAllDrivers();
 
-    // 2. Logger init (optional)
+    // 2. Contexts, logger init (optional)
+    impl_->SelectContexts(cfg.isolated);
     if (cfg.log_config.has_value()) {
-        log::Logger::GetInstance().Init(cfg.log_config.value());
+        if (cfg.isolated && !impl_->own_logger) {
+            impl_->own_logger = std::make_unique<log::Logger>();
+        }
+        impl_->Log().Init(cfg.log_config.value());
         impl_->logger_initialized = true;
     }
+    log::Logger::ScopedCurrent log_scope(impl_->LogScope());
+    if (cfg.executor.has_value()) {
+        auto configured = core::Executor::ConfigureShared(cfg.executor.value());
+        if (configured.IsError()) {
+            PLAS_LOG_WARN("Bootstrap: shared executor already in use; "
+                          "executor options ignored");
+        }
+    }
+    if (cfg.enable_metrics) {
+        impl_->Devices().SetMetricsEnabled(true);
+    }
+
+    if (!cfg.config_cache_dir.empty()) {
+        config::ConfigCache::SetDirectory(cfg.config_cache_dir);
+    }
+    timing.setup = setup_timer.Stop();
 
     // 3. Properties load (optional)
+    PhaseTimer properties_timer(origin);
     if (!cfg.properties_config_path.empty()) {
-        auto& pm = config::PropertyManager::GetInstance();
+        auto& pm = impl_->PropertyStore();
         auto prop_result = pm.LoadFromFile(cfg.properties_config_path,
                                             cfg.properties_config_format);
         if (prop_result.IsError()) {
@@ -186,56 +683,47 @@ core::Result<BootstrapResult> Bootstrap::Init(const BootstrapConfig& cfg) {
         }
         impl_->properties_loaded = true;
     }
+    timing.properties = properties_timer.Stop();
 
     // 4. Parse device config
-    core::Result<config::Config> config_result = [&]() -> core::Result<config::Config> {
-        if (cfg.device_config_node.has_value()) {
-            return config::Config::LoadFromNode(cfg.device_config_node.value());
-        }
-        if (!cfg.device_config_key_path.empty()) {
-            return config::Config::LoadFromFile(cfg.device_config_path,
-                                                cfg.device_config_key_path,
-                                                cfg.device_config_format);
-        }
-        return config::Config::LoadFromFile(cfg.device_config_path,
-                                            cfg.device_config_format);
-    }();
+    PhaseTimer parse_timer(origin);
+    auto config_result = LoadDeviceConfig(cfg);
+    timing.parse = parse_timer.Stop();
 
     if (config_result.IsError()) {
         // Rollback properties if loaded
-        if (impl_->properties_loaded) {
-            config::PropertyManager::GetInstance().Reset();
-            core::Properties::DestroyAll();
-            impl_->properties_loaded = false;
-        }
+        impl_->UnloadProperties();
         return core::Result<BootstrapResult>::Err(config_result.Error());
     }
 
     const auto& entries = config_result.Value().GetDevices();
-    auto& dm = hal::DeviceManager::GetInstance();
+    auto& dm = impl_->Devices();
     BootstrapResult result;
     impl_->failures.clear();
 
     // 4b. Config spec validation (opt-in via validation_mode)
+    PhaseTimer validate_timer(origin);
     std::set<std::string> validation_failed_nicknames;
     if (cfg.validation_mode != configspec::ValidationMode::kLenient) {
-        auto& registry = configspec::SpecRegistry::GetInstance();
+        auto& registry = impl_->Specs();
         registry.RegisterBuiltinSpecs();
 
         if (!cfg.spec_dir.empty()) {
             registry.LoadSpecsFromDirectory(cfg.spec_dir);
         }
 
-        configspec::Validator validator(cfg.validation_mode);
+        configspec::Validator validator(impl_->Specs(), cfg.validation_mode);
+        auto batch = validator.ValidateDeviceEntries(entries);
+        const std::vector<configspec::ValidationResult> no_results;
+        const auto& results = batch.IsOk() ? batch.Value() : no_results;
 
-        for (const auto& entry : entries) {
-            auto vr = validator.ValidateDeviceEntry(entry);
-            if (vr.IsError()) continue;  // no spec → skip
-            if (vr.Value().valid) continue;
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto& entry = entries[i];
+            if (results[i].valid) continue;  // also: no spec for the driver
 
             auto ec = core::make_error_code(core::ErrorCode::kInvalidArgument);
             std::string detail =
-                "config spec validation failed: " + vr.Value().Summary();
+                "config spec validation failed: " + results[i].Summary();
 
             if (cfg.validation_mode == configspec::ValidationMode::kWarning) {
                 impl_->failures.push_back(
@@ -256,21 +744,42 @@ core::Result<BootstrapResult> Bootstrap::Init(const BootstrapConfig& cfg) {
 
             // Hard failure — rollback
             dm.Reset();
-            if (impl_->properties_loaded) {
-                config::PropertyManager::GetInstance().Reset();
-                core::Properties::DestroyAll();
-                impl_->properties_loaded = false;
-            }
+            impl_->UnloadProperties();
             return core::Result<BootstrapResult>::Err(ec);
         }
     }
 
-    // 5. Create + add devices individually
+    timing.validate = validate_timer.Stop();
+
+    // 5. Create devices, then add them to the registry together
+    PhaseTimer create_timer(origin);
+    impl_->trace_writer.reset();
+    if (!cfg.record_trace_path.empty()) {
+        auto writer = hal::TraceWriter::Open(cfg.record_trace_path);
+        if (writer.IsError()) {
+            PLAS_LOG_ERROR("Bootstrap: cannot create trace " + cfg.record_trace_path);
+            impl_->UnloadProperties();
+            return core::Result<BootstrapResult>::Err(writer.Error());
+        }
+        impl_->trace_writer = std::move(writer).Value();
+    }
+    timing.devices.reserve(entries.size());
+    std::vector<std::pair<config::DeviceEntry, std::unique_ptr<hal::Device>>> created;
+    std::vector<const config::DeviceEntry*> created_entries;
+    created.reserve(entries.size());
+    created_entries.reserve(entries.size());
     for (const auto& entry : entries) {
         // Skip devices that failed spec validation
         if (validation_failed_nicknames.count(entry.nickname)) continue;
-        // 5a. URI format validation (early detection)
-        if (!ValidateUri(entry.uri)) {
+        auto& device_timing = timing.devices.emplace_back();
+        device_timing.nickname = entry.nickname;
+        device_timing.driver = entry.driver;
+        PhaseTimer device_timer(origin);
+        // 5a. URI format validation (early detection); the parsed URI is
+        // handed to the driver as is.
+        const auto uri = config::DeviceUri::Parse(entry.uri);
+        if (!ValidateUri(uri)) {
+            device_timing.create = device_timer.Stop();
             auto ec = core::make_error_code(core::ErrorCode::kInvalidArgument);
             std::string detail = "invalid URI format: \"" + entry.uri +
                                  "\" (expected driver://bus:identifier)";
@@ -282,16 +791,13 @@ core::Result<BootstrapResult> Bootstrap::Init(const BootstrapConfig& cfg) {
                 continue;
             }
             dm.Reset();
-            if (impl_->properties_loaded) {
-                config::PropertyManager::GetInstance().Reset();
-                core::Properties::DestroyAll();
-                impl_->properties_loaded = false;
-            }
+            impl_->UnloadProperties();
             return core::Result<BootstrapResult>::Err(ec);
         }
 
-        auto create = hal::DeviceFactory::CreateFromConfig(entry);
+        auto create = hal::DeviceFactory::CreateFromConfig(entry, uri);
         if (create.IsError()) {
+            device_timing.create = device_timer.Stop();
             if (create.Error() ==
                     core::make_error_code(core::ErrorCode::kNotFound) &&
                 cfg.skip_unknown_drivers) {
@@ -313,113 +819,372 @@ core::Result<BootstrapResult> Bootstrap::Init(const BootstrapConfig& cfg) {
             }
             // Hard failure — rollback
             dm.Reset();
-            if (impl_->properties_loaded) {
-                config::PropertyManager::GetInstance().Reset();
-                core::Properties::DestroyAll();
-                impl_->properties_loaded = false;
-            }
+            impl_->UnloadProperties();
             return core::Result<BootstrapResult>::Err(create.Error());
         }
 
-        auto add = dm.AddDevice(entry.nickname, std::move(create).Value());
-        if (add.IsError()) {
-            if (cfg.skip_device_failures) {
-                ++result.devices_failed;
-                impl_->failures.push_back(
-                    {entry.nickname, entry.uri, entry.driver,
-                     add.Error(), "create",
-                     MakeDetail("create", add.Error())});
-                continue;
-            }
-            dm.Reset();
-            if (impl_->properties_loaded) {
-                config::PropertyManager::GetInstance().Reset();
-                core::Properties::DestroyAll();
-                impl_->properties_loaded = false;
-            }
-            return core::Result<BootstrapResult>::Err(add.Error());
+        auto device = std::move(create).Value();
+        if (impl_->trace_writer) {
+            device = hal::RecordTransactions(std::move(device), impl_->trace_writer);
         }
+        created.emplace_back(entry, std::move(device));
+        created_entries.push_back(&entry);
+        device_timing.create = device_timer.Stop();
     }
 
-    // 6. Init + Open devices (optional)
-    if (cfg.auto_open_devices) {
-        for (const auto& name : dm.DeviceNames()) {
-            auto* dev = dm.GetDevice(name);
-            if (!dev) continue;
+    // One registry snapshot for all of them: DeviceManager keeps every
+    // snapshot it publishes, so adding devices one by one is quadratic.
+    auto added = dm.AddDevices(std::move(created));
+    for (std::size_t i = 0; i < added.size(); ++i) {
+        if (added[i].IsOk()) continue;
+        const auto& entry = *created_entries[i];
+        if (cfg.skip_device_failures) {
+            ++result.devices_failed;
+            impl_->failures.push_back(
+                {entry.nickname, entry.uri, entry.driver,
+                 added[i].Error(), "create",
+                 MakeDetail("create", added[i].Error())});
+            continue;
+        }
+        dm.Reset();
+        impl_->UnloadProperties();
+        return core::Result<BootstrapResult>::Err(added[i].Error());
+    }
 
-            auto init = dev->Init();
-            if (init.IsError()) {
-                if (cfg.skip_device_failures) {
-                    ++result.devices_failed;
-                    impl_->failures.push_back(
-                        {name, dev->GetUri(), dev->GetName(),
-                         init.Error(), "init",
-                         MakeDetail("init", init.Error())});
-                    continue;
-                }
-                dm.Reset();
-                if (impl_->properties_loaded) {
-                    config::PropertyManager::GetInstance().Reset();
-                    core::Properties::DestroyAll();
-                    impl_->properties_loaded = false;
+    timing.create = create_timer.Stop();
+
+    // 6. Init + Open devices (optional, or deferred to first lookup)
+    PhaseTimer open_timer(origin);
+    if (cfg.lazy_open_devices) {
+        dm.SetLazyOpen(true);
+        dm.SetIdleCloseTimeout(std::chrono::milliseconds(cfg.idle_close_ms));
+        // Devices open on first GetDevice/GetInterface; count them as loaded.
+        result.devices_opened = dm.DeviceCount();
+    } else if (cfg.auto_open_devices) {
+        auto names = dm.DeviceNames();
+        std::vector<hal::Device*> devices;
+        devices.reserve(names.size());
+        for (const auto& name : names) {
+            devices.push_back(dm.PeekDevice(name));
+        }
+
+        // Hand each unchanged device its predecessor's fds; the rest are
+        // closed once the open step is over.
+        std::vector<HandoffRecord> handoffs;
+        std::vector<const hal::DeviceHandoff*> adopt(devices.size(), nullptr);
+        if (cfg.warm_restart) {
+            handoffs = TakeWarmRestartHandoffs();
+            std::unordered_map<std::string, std::size_t> by_name;
+            for (std::size_t i = 0; i < names.size(); ++i) by_name.emplace(names[i], i);
+            for (const auto& record : handoffs) {
+                auto it = by_name.find(record.nickname);
+                if (it == by_name.end()) continue;
+                auto* dev = devices[it->second];
+                if (dev && dev->GetDriverName() == record.driver && dev->GetUri() == record.uri) {
+                    adopt[it->second] = &record.handoff;
                 }
-                return core::Result<BootstrapResult>::Err(init.Error());
             }
+        }
 
-            auto open = dev->Open();
-            if (open.IsError()) {
+        auto outcomes = OpenDevices(devices, cfg.open_workers,
+                                    !cfg.skip_device_failures, origin, adopt);
+        for (const auto& record : handoffs) {
+            auto it = std::find(adopt.begin(), adopt.end(), &record.handoff);
+            if (it == adopt.end() || !outcomes[static_cast<std::size_t>(it - adopt.begin())].adopted) {
+                CloseHandoffFds(record.handoff.fds);
+            }
+        }
+        timing.open = open_timer.Stop();
+        timing.open.cpu = std::chrono::nanoseconds(0);
+        RecordOpenTimings(names, outcomes, timing);
+
+        // Report in DeviceNames() order regardless of completion order.
+        for (std::size_t i = 0; i < devices.size(); ++i) {
+            auto* dev = devices[i];
+            if (!dev) continue;
+
+            const auto& outcome = outcomes[i];
+            if (outcome.error) {
                 if (cfg.skip_device_failures) {
                     ++result.devices_failed;
                     impl_->failures.push_back(
-                        {name, dev->GetUri(), dev->GetName(),
-                         open.Error(), "open",
-                         MakeDetail("open", open.Error())});
+                        {names[i], dev->GetUri(), dev->GetName(),
+                         outcome.error, outcome.phase,
+                         MakeDetail(outcome.phase, outcome.error)});
                     continue;
                 }
                 dm.Reset();
-                if (impl_->properties_loaded) {
-                    config::PropertyManager::GetInstance().Reset();
-                    core::Properties::DestroyAll();
-                    impl_->properties_loaded = false;
-                }
-                return core::Result<BootstrapResult>::Err(open.Error());
+                impl_->UnloadProperties();
+                return core::Result<BootstrapResult>::Err(outcome.error);
             }
 
             ++result.devices_opened;
+            if (outcome.adopted) ++result.devices_adopted;
         }
     } else {
         // Count successfully created devices as "opened" (loaded, not opened)
         result.devices_opened = dm.DeviceCount();
     }
 
+    if (!cfg.auto_open_devices || cfg.lazy_open_devices) {
+        timing.open = open_timer.Stop();
+    }
+    if (cfg.health_supervisor) {
+        auto supervised = dm.StartHealthSupervisor(*cfg.health_supervisor);
+        if (supervised.IsError()) {
+            PLAS_LOG_WARN("Bootstrap: health supervisor not started: " +
+                          supervised.Error().message());
+        }
+    }
+    timing.total = total_timer.Stop();
+    if (!cfg.startup_trace_path.empty()) {
+        std::ofstream trace(cfg.startup_trace_path, std::ios::trunc);
+        trace << timing.ToChromeTrace();
+        if (!trace) {
+            PLAS_LOG_WARN("Bootstrap: cannot write startup trace " + cfg.startup_trace_path);
+        }
+    }
+
     result.failures = impl_->failures;
+    result.timing = std::move(timing);
+    impl_->config = cfg;
     impl_->initialized = true;
     return core::Result<BootstrapResult>::Ok(std::move(result));
 }
 
+// ---------------------------------------------------------------------------
+// Reload
+// ---------------------------------------------------------------------------
+
+core::Result<ReloadResult> Bootstrap::Reload() {
+    if (!impl_->initialized) {
+        return core::Result<ReloadResult>::Err(core::ErrorCode::kNotInitialized);
+    }
+    auto config_result = LoadDeviceConfig(impl_->config);
+    if (config_result.IsError()) {
+        return core::Result<ReloadResult>::Err(config_result.Error());
+    }
+    return Reload(config_result.Value());
+}
+
+core::Result<ReloadResult> Bootstrap::Reload(const config::Config& updated) {
+    if (!impl_->initialized) {
+        return core::Result<ReloadResult>::Err(core::ErrorCode::kNotInitialized);
+    }
+    const auto& cfg = impl_->config;
+    log::Logger::ScopedCurrent log_scope(impl_->LogScope());
+    auto& dm = impl_->Devices();
+
+    auto diff = config::DiffDevices(dm.LoadedEntries(), updated.GetDevices());
+    ReloadResult result;
+    result.devices_removed = diff.removed.size();
+    result.devices_unchanged = diff.unchanged;
+    if (diff.Empty()) {
+        impl_->failures.clear();
+        return core::Result<ReloadResult>::Ok(std::move(result));
+    }
+
+    // 1. Check only the added and changed entries. A rejected entry is
+    //    dropped from the diff, so a changed device keeps its old instance.
+    std::vector<const config::DeviceEntry*> candidates;
+    candidates.reserve(diff.added.size() + diff.changed.size());
+    for (const auto& entry : diff.added) candidates.push_back(&entry);
+    for (const auto& entry : diff.changed) candidates.push_back(&entry);
+
+    std::vector<std::optional<DeviceFailure>> rejected(candidates.size());
+    if (cfg.validation_mode != configspec::ValidationMode::kLenient) {
+        std::vector<config::DeviceEntry> to_validate;
+        to_validate.reserve(candidates.size());
+        for (const auto* entry : candidates) to_validate.push_back(*entry);
+
+        configspec::Validator validator(impl_->Specs(), cfg.validation_mode);
+        auto batch = validator.ValidateDeviceEntries(to_validate);
+        const std::vector<configspec::ValidationResult> no_results;
+        const auto& results = batch.IsOk() ? batch.Value() : no_results;
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            if (results[i].valid) continue;
+            const auto& entry = *candidates[i];
+            DeviceFailure failure{
+                entry.nickname, entry.uri, entry.driver,
+                core::make_error_code(core::ErrorCode::kInvalidArgument),
+                "validate",
+                "config spec validation failed: " + results[i].Summary()};
+            if (cfg.validation_mode == configspec::ValidationMode::kWarning) {
+                result.failures.push_back(std::move(failure));
+                continue;
+            }
+            if (!cfg.skip_device_failures) {
+                return core::Result<ReloadResult>::Err(failure.error);
+            }
+            ++result.devices_failed;
+            rejected[i] = std::move(failure);
+        }
+    }
+
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (rejected[i]) continue;
+        const auto& entry = *candidates[i];
+        if (!ValidateUri(entry.uri)) {
+            auto ec = core::make_error_code(core::ErrorCode::kInvalidArgument);
+            if (!cfg.skip_device_failures) {
+                return core::Result<ReloadResult>::Err(ec);
+            }
+            ++result.devices_failed;
+            rejected[i] = DeviceFailure{
+                entry.nickname, entry.uri, entry.driver, ec, "create",
+                "invalid URI format: \"" + entry.uri +
+                    "\" (expected driver://bus:identifier)"};
+        } else if (!hal::DeviceFactory::HasDriver(entry.driver)) {
+            auto ec = core::make_error_code(core::ErrorCode::kNotFound);
+            if (!cfg.skip_unknown_drivers) {
+                return core::Result<ReloadResult>::Err(ec);
+            }
+            ++result.devices_skipped;
+            rejected[i] = DeviceFailure{
+                entry.nickname, entry.uri, entry.driver, ec, "create",
+                MakeDetail("create", ec) + " (driver \"" + entry.driver +
+                    "\" not registered)"};
+        }
+    }
+
+    config::DeviceDiff accepted;
+    accepted.removed = std::move(diff.removed);
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (rejected[i]) {
+            result.failures.push_back(std::move(*rejected[i]));
+        } else if (i < diff.added.size()) {
+            accepted.added.push_back(*candidates[i]);
+        } else {
+            accepted.changed.push_back(*candidates[i]);
+        }
+    }
+    result.devices_added = accepted.added.size();
+    result.devices_changed = accepted.changed.size();
+
+    // 2. Swap the affected devices; untouched ones stay open.
+    auto apply = dm.ApplyDiff(accepted);
+    if (apply.IsError()) {
+        return core::Result<ReloadResult>::Err(apply.Error());
+    }
+
+    // 3. Open the new devices as Init() would.
+    if (!cfg.lazy_open_devices && cfg.auto_open_devices) {
+        std::vector<std::string> names;
+        std::vector<hal::Device*> devices;
+        for (const auto* list : {&accepted.added, &accepted.changed}) {
+            for (const auto& entry : *list) {
+                names.push_back(entry.nickname);
+                devices.push_back(dm.PeekDevice(entry.nickname));
+            }
+        }
+        auto outcomes =
+            OpenDevices(devices, cfg.open_workers, !cfg.skip_device_failures,
+                        Clock::now());
+        for (std::size_t i = 0; i < devices.size(); ++i) {
+            const auto& outcome = outcomes[i];
+            if (!outcome.error) continue;
+            if (!cfg.skip_device_failures) {
+                // The new devices stay registered, unopened.
+                return core::Result<ReloadResult>::Err(outcome.error);
+            }
+            ++result.devices_failed;
+            result.failures.push_back(
+                {names[i], devices[i]->GetUri(), devices[i]->GetName(),
+                 outcome.error, outcome.phase,
+                 MakeDetail(outcome.phase, outcome.error)});
+        }
+    }
+
+    impl_->failures = result.failures;
+    return core::Result<ReloadResult>::Ok(std::move(result));
+}
+
 // ---------------------------------------------------------------------------
 // Deinit
 // ---------------------------------------------------------------------------
 
 void Bootstrap::Deinit() {
     if (!impl_ || !impl_->initialized) return;
+    log::Logger::ScopedCurrent log_scope(impl_->LogScope());
 
     // 1. Close + clear devices
-    hal::DeviceManager::GetInstance().Reset();
+    auto& dm = impl_->Devices();
+    dm.StopHealthSupervisor();
+    dm.SetIdleCloseTimeout(std::chrono::milliseconds(0));
+    dm.SetLazyOpen(false);
+    dm.Reset();
+    if (impl_->trace_writer) {
+        impl_->trace_writer->Flush();
+        impl_->trace_writer.reset();
+    }
 
     // 2. Properties cleanup
-    if (impl_->properties_loaded) {
-        config::PropertyManager::GetInstance().Reset();
-        core::Properties::DestroyAll();
-        impl_->properties_loaded = false;
-    }
+    impl_->UnloadProperties();
 
-    // Logger: no teardown (process lifetime)
+    // Logger: no teardown (process lifetime, or the Bootstrap's when own)
 
+    CloseHandoffFds(impl_->handoff_fds);
+    impl_->handoff_fds.clear();
     impl_->failures.clear();
     impl_->initialized = false;
 }
 
+// ---------------------------------------------------------------------------
+// Warm restart
+// ---------------------------------------------------------------------------
+
+core::Result<std::size_t> Bootstrap::PrepareWarmRestart() {
+    if (!impl_->initialized) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+#ifdef __linux__
+    // No MFD_CLOEXEC: the state has to survive exec together with the fds.
+    int state_fd = ::memfd_create("plas-warm-restart", 0);
+    if (state_fd < 0) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kResourceExhausted);
+    }
+
+    log::Logger::ScopedCurrent log_scope(impl_->LogScope());
+    auto& dm = impl_->Devices();
+    std::vector<HandoffRecord> records;
+    for (const auto& name : dm.DeviceNames()) {
+        auto* dev = dm.PeekDevice(name);
+        auto* support = dynamic_cast<hal::DeviceHandoffSupport*>(dev);
+        if (!support || dev->GetState() != hal::DeviceState::kOpen) continue;
+        HandoffRecord record{name, dev->GetDriverName(), dev->GetUri(), {}};
+        if (!HandoffFieldOk(record.nickname) || !HandoffFieldOk(record.driver) ||
+            !HandoffFieldOk(record.uri)) {
+            continue;
+        }
+        auto exported = support->ExportHandoff();
+        if (exported.IsError()) {
+            PLAS_LOG_WARN("Bootstrap: '" + name + "' not handed off (" +
+                          exported.Error().message() + ")");
+            continue;
+        }
+        record.handoff = std::move(exported.Value());
+        for (int fd : record.handoff.fds) {
+            ::fcntl(fd, F_SETFD, ::fcntl(fd, F_GETFD) & ~FD_CLOEXEC);
+            impl_->handoff_fds.push_back(fd);
+        }
+        records.push_back(std::move(record));
+    }
+
+    const auto blob = EncodeHandoffs(records);
+    if (::pwrite(state_fd, blob.data(), blob.size(), 0) != static_cast<ssize_t>(blob.size())) {
+        ::close(state_fd);
+        return core::Result<std::size_t>::Err(core::ErrorCode::kIOError);
+    }
+    impl_->handoff_fds.push_back(state_fd);
+    ::setenv(kWarmRestartEnv, std::to_string(state_fd).c_str(), 1);
+    PLAS_LOG_INFO("Bootstrap: handed off " + std::to_string(records.size()) +
+                  " device(s) for warm restart");
+    return core::Result<std::size_t>::Ok(records.size());
+#else
+    return core::Result<std::size_t>::Err(core::ErrorCode::kNotSupported);
+#endif
+}
+
 // ---------------------------------------------------------------------------
 // Accessors
 // ---------------------------------------------------------------------------
@@ -427,23 +1192,31 @@ void Bootstrap::Deinit() {
 bool Bootstrap::IsInitialized() const { return impl_->initialized; }
 
 hal::DeviceManager* Bootstrap::GetDeviceManager() {
-    return &hal::DeviceManager::GetInstance();
+    return &impl_->Devices();
 }
 
 config::PropertyManager* Bootstrap::GetPropertyManager() {
-    return &config::PropertyManager::GetInstance();
+    return &impl_->PropertyStore();
+}
+
+configspec::SpecRegistry* Bootstrap::GetSpecRegistry() {
+    return &impl_->Specs();
+}
+
+log::Logger* Bootstrap::GetLogger() {
+    return &impl_->Log();
 }
 
 hal::Device* Bootstrap::GetDevice(const std::string& nickname) {
-    return hal::DeviceManager::GetInstance().GetDevice(nickname);
+    return impl_->Devices().GetDevice(nickname);
 }
 
 hal::Device* Bootstrap::GetDeviceByUri(const std::string& uri) {
-    return hal::DeviceManager::GetInstance().GetDeviceByUri(uri);
+    return impl_->Devices().GetDeviceByUri(uri);
 }
 
 std::vector<std::string> Bootstrap::DeviceNames() const {
-    return hal::DeviceManager::GetInstance().DeviceNames();
+    return impl_->Devices().DeviceNames();
 }
 
 const std::vector<DeviceFailure>& Bootstrap::GetFailures() const {
@@ -455,14 +1228,14 @@ const std::vector<DeviceFailure>& Bootstrap::GetFailures() const {
 // ---------------------------------------------------------------------------
 
 std::string Bootstrap::DumpDevices() const {
-    auto& dm = hal::DeviceManager::GetInstance();
+    auto& dm = impl_->Devices();
     auto names = dm.DeviceNames();
 
     std::ostringstream os;
     os << "Devices (" << names.size() << "):\n";
 
     for (const auto& name : names) {
-        auto* dev = dm.GetDevice(name);
+        auto* dev = dm.PeekDevice(name);
         if (!dev) continue;
 
         os << "  " << name << "\n"
@@ -487,4 +1260,69 @@ std::string Bootstrap::DumpDevices() const {
     return os.str();
 }
 
+// ---------------------------------------------------------------------------
+// Metrics
+// ---------------------------------------------------------------------------
+
+hal::MetricsSnapshot Bootstrap::GetMetricsSnapshot() const {
+    return impl_->Devices().GetMetricsSnapshot();
+}
+
+std::string Bootstrap::DumpMetrics() const {
+    auto snapshot = GetMetricsSnapshot();
+
+    std::ostringstream os;
+    os << "Metrics (" << snapshot.operations.size() << " operations):\n";
+
+    char line[192];
+    for (const auto& op : snapshot.operations) {
+        std::snprintf(line, sizeof(line),
+                      "  %-16s %-18s count=%llu errors=%llu mean=%lluus "
+                      "p99=%lluus max=%lluus %.1fKB/s\n",
+                      op.device.c_str(), hal::ToString(op.op),
+                      static_cast<unsigned long long>(op.count),
+                      static_cast<unsigned long long>(op.errors),
+                      static_cast<unsigned long long>(op.MeanNs() / 1000),
+                      static_cast<unsigned long long>(op.PercentileNs(99) / 1000),
+                      static_cast<unsigned long long>(op.max_ns / 1000),
+                      op.BytesPerSecond() / 1000.0);
+        os << line;
+    }
+
+    if (!snapshot.retries.empty()) {
+        os << "Retries (" << snapshot.retries.size() << " devices):\n";
+        for (const auto& retry : snapshot.retries) {
+            std::snprintf(line, sizeof(line),
+                          "  %-16s retried=%llu retries=%llu recovered=%llu "
+                          "exhausted=%llu backoff=%lluus\n",
+                          retry.device.c_str(),
+                          static_cast<unsigned long long>(retry.retried_calls),
+                          static_cast<unsigned long long>(retry.retries),
+                          static_cast<unsigned long long>(retry.recovered),
+                          static_cast<unsigned long long>(retry.exhausted),
+                          static_cast<unsigned long long>(retry.backoff_us));
+            os << line;
+        }
+    }
+
+    if (!snapshot.locks.empty()) {
+        os << "Locks (" << snapshot.locks.size() << "):\n";
+        for (const auto& lock : snapshot.locks) {
+            std::snprintf(line, sizeof(line),
+                          "  %-24s acquired=%llu contended=%llu mean_wait=%lluus "
+                          "max_wait=%lluus mean_hold=%lluus max_hold=%lluus\n",
+                          lock.name.c_str(),
+                          static_cast<unsigned long long>(lock.acquisitions),
+                          static_cast<unsigned long long>(lock.contended),
+                          static_cast<unsigned long long>(lock.MeanWaitNs() / 1000),
+                          static_cast<unsigned long long>(lock.max_wait_ns / 1000),
+                          static_cast<unsigned long long>(lock.MeanHoldNs() / 1000),
+                          static_cast<unsigned long long>(lock.max_hold_ns / 1000));
+            os << line;
+        }
+    }
+
+    return os.str();
+}
+
 }  // namespace plas::bootstrap
@@ -13,10 +13,17 @@ namespace detail {
 class SpecRegistryAccessor;
 }  // namespace detail
 
+/// Driver and config specs by name. GetInstance() is the process-wide
+/// registry; a SpecRegistry constructed directly is independent of it, so
+/// tenants can register different specs under the same driver name.
+/// Builtin specs are decoded once per process and shared by all instances.
 class SpecRegistry {
 public:
     static SpecRegistry& GetInstance();
 
+    SpecRegistry();
+    ~SpecRegistry();
+
     void RegisterBuiltinSpecs();
 
     core::Result<void> RegisterDriverSpec(const std::string& name,
@@ -41,9 +48,6 @@ public:
 private:
     friend class detail::SpecRegistryAccessor;
 
-    SpecRegistry();
-    ~SpecRegistry();
-
     SpecRegistry(const SpecRegistry&) = delete;
     SpecRegistry& operator=(const SpecRegistry&) = delete;
 
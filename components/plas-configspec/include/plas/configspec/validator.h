@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "plas/config/config_format.h"
 #include "plas/config/config_node.h"
@@ -11,11 +13,17 @@
 
 namespace plas::configspec {
 
+class SpecRegistry;
+
 enum class ValidationMode { kStrict, kWarning, kLenient };
 
 class Validator {
 public:
+    /// Validates against SpecRegistry::GetInstance().
     explicit Validator(ValidationMode mode = ValidationMode::kStrict);
+    /// Validates against `registry`, which must outlive the Validator.
+    explicit Validator(const SpecRegistry& registry,
+                       ValidationMode mode = ValidationMode::kStrict);
     ~Validator();
 
     Validator(Validator&&) noexcept;
@@ -37,6 +45,16 @@ public:
     core::Result<ValidationResult> ValidateDeviceEntry(
         const config::DeviceEntry& entry) const;
 
+    /// Validates every entry; results[i] belongs to entries[i]. Entries
+    /// without a driver spec come back valid, as with ValidateDeviceEntry.
+    /// Runs on up to `workers` threads of core::Executor::Shared(), the
+    /// caller included (0 = all of them). Batches too small to be worth
+    /// splitting run on the calling thread. Each driver's compiled schema
+    /// is shared, not rebuilt per entry.
+    core::Result<std::vector<ValidationResult>> ValidateDeviceEntries(
+        const std::vector<config::DeviceEntry>& entries,
+        std::size_t workers = 0) const;
+
     ValidationMode GetMode() const;
 
 private:
@@ -1,10 +1,14 @@
 #include "plas/configspec/spec_registry.h"
 
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <map>
 #include <mutex>
 #include <sstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 #include <yaml-cpp/yaml.h>
@@ -14,11 +18,12 @@
 
 namespace plas::configspec {
 
-// --- Builtin spec data (generated by CMake) ---
+// --- Builtin spec data (generated by plas_schema_gen) ---
 
 struct BuiltinSpecEntry {
     const char* name;
-    const char* content;
+    const uint8_t* cbor;  ///< the schema as JSON, CBOR-encoded
+    std::size_t size;
 };
 
 extern const BuiltinSpecEntry kBuiltinSpecs[];
@@ -117,16 +122,136 @@ std::string ExtractDriverName(const std::string& filename) {
     return filename;
 }
 
+/// FNV-1a over the format and the content of a spec file.
+uint64_t HashSpec(const std::string& content, config::ConfigFormat fmt) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](unsigned char byte) {
+        hash ^= byte;
+        hash *= 0x100000001b3ull;
+    };
+    mix(static_cast<unsigned char>(fmt));
+    for (char c : content) {
+        mix(static_cast<unsigned char>(c));
+    }
+    return hash;
+}
+
+/// The builtin specs, decoded once per process. CompiledSpec compiles its
+/// validator on first use and is shared, so after the first validation
+/// neither RegisterBuiltinSpecs nor Reset() costs a schema compile again.
+const std::vector<std::pair<std::string, detail::CompiledSpecPtr>>& BuiltinSpecs() {
+    static const auto specs = [] {
+        std::vector<std::pair<std::string, detail::CompiledSpecPtr>> decoded;
+        decoded.reserve(kBuiltinSpecCount);
+        for (std::size_t i = 0; i < kBuiltinSpecCount; ++i) {
+            const auto& entry = kBuiltinSpecs[i];
+            // Checked by plas_schema_gen; from_cbor cannot fail on its output.
+            decoded.emplace_back(entry.name,
+                                 std::make_shared<const detail::CompiledSpec>(
+                                     nlohmann::json::from_cbor(entry.cbor, entry.cbor + entry.size)));
+        }
+        return decoded;
+    }();
+    return specs;
+}
+
 }  // namespace
 
 // --- Impl ---
 
+namespace {
+
+// Collects issues instead of throwing
+class PlasErrorHandler : public nlohmann::json_schema::basic_error_handler {
+public:
+    void error(const nlohmann::json::json_pointer& pointer,
+               const nlohmann::json& instance,
+               const std::string& message) override {
+        nlohmann::json_schema::basic_error_handler::error(pointer, instance,
+                                                           message);
+        issues.push_back(
+            {Severity::kError, pointer.to_string(), message});
+    }
+
+    std::vector<ValidationIssue> issues;
+};
+
+}  // namespace
+
+// --- CompiledSpec ---
+
+namespace detail {
+
+void CompiledSpec::Compile() const {
+    try {
+        validator_.set_root_schema(schema_);
+    } catch (const std::exception& e) {
+        compile_error_ = std::string("spec error: ") + e.what();
+    }
+}
+
+ValidationResult CompiledSpec::Validate(const nlohmann::json& data) const {
+    std::call_once(compiled_, [this] { Compile(); });
+
+    ValidationResult result;
+    if (!compile_error_.empty()) {
+        result.valid = false;
+        result.issues.push_back({Severity::kError, "/", compile_error_});
+        return result;
+    }
+    try {
+        PlasErrorHandler handler;
+        validator_.validate(data, handler);
+
+        result.issues = std::move(handler.issues);
+        result.valid = result.Errors().empty();
+    } catch (const std::exception& e) {
+        result.valid = false;
+        result.issues.push_back(
+            {Severity::kError, "/", std::string("spec error: ") + e.what()});
+    }
+    return result;
+}
+
+}  // namespace detail
+
+// --- Impl ---
+
 struct SpecRegistry::Impl {
+    /// A spec file loaded by LoadSpecsFromDirectory. The content is kept to
+    /// rule out hash collisions.
+    struct CachedFile {
+        std::string content;
+        detail::CompiledSpecPtr spec;
+    };
+
     mutable std::mutex mutex;
-    std::map<std::string, nlohmann::json> driver_specs;
-    nlohmann::json config_spec;
-    bool config_spec_set = false;
+    std::map<std::string, detail::CompiledSpecPtr> driver_specs;
+    detail::CompiledSpecPtr config_spec;
     bool builtins_loaded = false;
+
+    /// Specs by HashSpec() of their file, kept across Reset(): reloading an
+    /// unchanged file reuses its parsed schema and compiled validator.
+    std::mutex file_cache_mutex;
+    std::unordered_map<uint64_t, CachedFile> file_cache;
+
+    /// Parsed spec for a file's content, from the cache if seen before.
+    /// Throws what ParseContent throws.
+    detail::CompiledSpecPtr LoadFile(const std::string& content,
+                                     config::ConfigFormat fmt) {
+        auto hash = HashSpec(content, fmt);
+        {
+            std::lock_guard<std::mutex> lock(file_cache_mutex);
+            auto it = file_cache.find(hash);
+            if (it != file_cache.end() && it->second.content == content) {
+                return it->second.spec;
+            }
+        }
+        auto spec = std::make_shared<const detail::CompiledSpec>(ParseContent(content, fmt));
+        std::lock_guard<std::mutex> lock(file_cache_mutex);
+        file_cache[hash] = CachedFile{content, spec};
+        return spec;
+    }
 };
 
 // --- Singleton ---
@@ -145,19 +270,11 @@ void SpecRegistry::RegisterBuiltinSpecs() {
     std::lock_guard<std::mutex> lock(impl_->mutex);
     if (impl_->builtins_loaded) return;
 
-    for (std::size_t i = 0; i < kBuiltinSpecCount; ++i) {
-        const auto& entry = kBuiltinSpecs[i];
-        std::string name(entry.name);
-        try {
-            auto json = ParseContent(entry.content, config::ConfigFormat::kYaml);
-            if (name == "device_config") {
-                impl_->config_spec = std::move(json);
-                impl_->config_spec_set = true;
-            } else {
-                impl_->driver_specs[name] = std::move(json);
-            }
-        } catch (...) {
-            // Skip malformed builtin specs
+    for (const auto& [name, spec] : BuiltinSpecs()) {
+        if (name == "device_config") {
+            impl_->config_spec = spec;
+        } else {
+            impl_->driver_specs[name] = spec;
         }
     }
     impl_->builtins_loaded = true;
@@ -167,9 +284,10 @@ core::Result<void> SpecRegistry::RegisterDriverSpec(
     const std::string& name, const std::string& content,
     config::ConfigFormat fmt) {
     try {
-        auto json = ParseContent(content, fmt);
+        auto spec = std::make_shared<const detail::CompiledSpec>(
+            ParseContent(content, fmt));
         std::lock_guard<std::mutex> lock(impl_->mutex);
-        impl_->driver_specs[name] = std::move(json);
+        impl_->driver_specs[name] = std::move(spec);
         return core::Result<void>::Ok();
     } catch (...) {
         return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
@@ -194,10 +312,10 @@ core::Result<void> SpecRegistry::RegisterDriverSpecFromFile(
 core::Result<void> SpecRegistry::RegisterConfigSpec(
     const std::string& content, config::ConfigFormat fmt) {
     try {
-        auto json = ParseContent(content, fmt);
+        auto spec = std::make_shared<const detail::CompiledSpec>(
+            ParseContent(content, fmt));
         std::lock_guard<std::mutex> lock(impl_->mutex);
-        impl_->config_spec = std::move(json);
-        impl_->config_spec_set = true;
+        impl_->config_spec = std::move(spec);
         return core::Result<void>::Ok();
     } catch (...) {
         return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
@@ -213,7 +331,7 @@ bool SpecRegistry::HasDriverSpec(const std::string& name) const {
 
 bool SpecRegistry::HasConfigSpec() const {
     std::lock_guard<std::mutex> lock(impl_->mutex);
-    return impl_->config_spec_set;
+    return impl_->config_spec != nullptr;
 }
 
 std::vector<std::string> SpecRegistry::RegisteredDrivers() const {
@@ -233,7 +351,7 @@ core::Result<std::string> SpecRegistry::ExportDriverSpec(
     if (it == impl_->driver_specs.end()) {
         return core::Result<std::string>::Err(core::ErrorCode::kNotFound);
     }
-    return core::Result<std::string>::Ok(it->second.dump(2));
+    return core::Result<std::string>::Ok(it->second->Schema().dump(2));
 }
 
 // --- Directory loading ---
@@ -268,13 +386,19 @@ core::Result<std::size_t> SpecRegistry::LoadSpecsFromDirectory(
         std::ostringstream ss;
         ss << file.rdbuf();
 
+        detail::CompiledSpecPtr spec;
+        try {
+            spec = impl_->LoadFile(ss.str(), fmt);
+        } catch (...) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(impl_->mutex);
         if (name == "device_config") {
-            auto result = RegisterConfigSpec(ss.str(), fmt);
-            if (result.IsOk()) ++count;
+            impl_->config_spec = std::move(spec);
         } else {
-            auto result = RegisterDriverSpec(name, ss.str(), fmt);
-            if (result.IsOk()) ++count;
+            impl_->driver_specs[name] = std::move(spec);
         }
+        ++count;
     }
     return core::Result<std::size_t>::Ok(count);
 }
@@ -284,8 +408,7 @@ core::Result<std::size_t> SpecRegistry::LoadSpecsFromDirectory(
 void SpecRegistry::Reset() {
     std::lock_guard<std::mutex> lock(impl_->mutex);
     impl_->driver_specs.clear();
-    impl_->config_spec = nlohmann::json();
-    impl_->config_spec_set = false;
+    impl_->config_spec.reset();
     impl_->builtins_loaded = false;
 }
 
@@ -293,20 +416,19 @@ void SpecRegistry::Reset() {
 
 namespace detail {
 
-const nlohmann::json* GetDriverSpecJson(const SpecRegistry& registry,
-                                         const std::string& name) {
+CompiledSpecPtr GetDriverSpec(const SpecRegistry& registry,
+                              const std::string& name) {
     auto* impl = SpecRegistryAccessor::GetImpl(registry);
     std::lock_guard<std::mutex> lock(impl->mutex);
     auto it = impl->driver_specs.find(name);
     if (it == impl->driver_specs.end()) return nullptr;
-    return &it->second;
+    return it->second;
 }
 
-const nlohmann::json* GetConfigSpecJson(const SpecRegistry& registry) {
+CompiledSpecPtr GetConfigSpec(const SpecRegistry& registry) {
     auto* impl = SpecRegistryAccessor::GetImpl(registry);
     std::lock_guard<std::mutex> lock(impl->mutex);
-    if (!impl->config_spec_set) return nullptr;
-    return &impl->config_spec;
+    return impl->config_spec;
 }
 
 }  // namespace detail
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include <string>
 
 #include <nlohmann/json.hpp>
+#include <nlohmann/json-schema.hpp>
 
 #include "plas/configspec/spec_registry.h"
+#include "plas/configspec/validation_result.h"
 
 namespace plas::configspec::detail {
 
@@ -15,9 +19,38 @@ public:
     }
 };
 
-const nlohmann::json* GetDriverSpecJson(const SpecRegistry& registry,
-                                         const std::string& name);
+/// A registered schema and its json_validator. The validator is compiled
+/// once, on first use, and is then only read: validate() is const, so one
+/// CompiledSpec is shared by every Validator and thread. The registry hands
+/// out shared_ptrs, so Reset() or re-registration never pulls a spec out
+/// from under a running validation.
+class CompiledSpec {
+public:
+    explicit CompiledSpec(nlohmann::json schema) : schema_(std::move(schema)) {}
+
+    CompiledSpec(const CompiledSpec&) = delete;
+    CompiledSpec& operator=(const CompiledSpec&) = delete;
+
+    const nlohmann::json& Schema() const { return schema_; }
+
+    /// A schema that fails to compile reports "spec error: ..." as an issue.
+    ValidationResult Validate(const nlohmann::json& data) const;
+
+private:
+    void Compile() const;
+
+    nlohmann::json schema_;
+    mutable std::once_flag compiled_;
+    mutable nlohmann::json_schema::json_validator validator_;
+    mutable std::string compile_error_;
+};
+
+using CompiledSpecPtr = std::shared_ptr<const CompiledSpec>;
+
+/// nullptr when nothing is registered under `name`.
+CompiledSpecPtr GetDriverSpec(const SpecRegistry& registry,
+                              const std::string& name);
 
-const nlohmann::json* GetConfigSpecJson(const SpecRegistry& registry);
+CompiledSpecPtr GetConfigSpec(const SpecRegistry& registry);
 
 }  // namespace plas::configspec::detail
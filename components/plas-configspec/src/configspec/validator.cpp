@@ -1,13 +1,15 @@
 #include "plas/configspec/validator.h"
 
+#include <algorithm>
 #include <fstream>
+#include <map>
 #include <sstream>
 
 #include <nlohmann/json.hpp>
-#include <nlohmann/json-schema.hpp>
 #include <yaml-cpp/yaml.h>
 
 #include "plas/core/error.h"
+#include "plas/core/executor.h"
 #include "plas/configspec/spec_registry.h"
 #include "spec_registry_internal.h"
 
@@ -94,26 +96,16 @@ config::ConfigFormat DetectFormat(const std::string& path) {
     return config::ConfigFormat::kAuto;
 }
 
-// Custom error handler that collects issues instead of throwing
-class PlasErrorHandler : public nlohmann::json_schema::basic_error_handler {
-public:
-    void error(const nlohmann::json::json_pointer& pointer,
-               const nlohmann::json& instance,
-               const std::string& message) override {
-        nlohmann::json_schema::basic_error_handler::error(pointer, instance,
-                                                           message);
-        issues.push_back(
-            {Severity::kError, pointer.to_string(), message});
-    }
-
-    std::vector<ValidationIssue> issues;
-};
+constexpr std::size_t kMinEntriesPerWorker = 64;
 
 // Try to convert string args to typed JSON values
 nlohmann::json ArgsToTypedJson(
     const std::map<std::string, std::string>& args) {
     auto obj = nlohmann::json::object();
     for (const auto& [key, value] : args) {
+        // DeviceManager's, not the driver's
+        if (config::IsDeviceManagerArg(key)) continue;
+
         // Try bool
         if (value == "true" || value == "True" || value == "TRUE" ||
             value == "yes" || value == "Yes" || value == "YES") {
@@ -154,38 +146,23 @@ nlohmann::json ArgsToTypedJson(
     return obj;
 }
 
-ValidationResult RunValidation(const nlohmann::json& spec,
-                                const nlohmann::json& data) {
-    ValidationResult result;
-    try {
-        nlohmann::json_schema::json_validator validator;
-        validator.set_root_schema(spec);
-
-        PlasErrorHandler handler;
-        validator.validate(data, handler);
-
-        result.issues = std::move(handler.issues);
-        result.valid = result.Errors().empty();
-    } catch (const std::exception& e) {
-        result.valid = false;
-        result.issues.push_back(
-            {Severity::kError, "/", std::string("spec error: ") + e.what()});
-    }
-    return result;
-}
-
 }  // namespace
 
 // --- Impl ---
 
 struct Validator::Impl {
     ValidationMode mode;
+    const SpecRegistry* registry;
 };
 
 // --- Lifecycle ---
 
-Validator::Validator(ValidationMode mode) : impl_(std::make_unique<Impl>()) {
+Validator::Validator(ValidationMode mode) : Validator(SpecRegistry::GetInstance(), mode) {}
+
+Validator::Validator(const SpecRegistry& registry, ValidationMode mode)
+    : impl_(std::make_unique<Impl>()) {
     impl_->mode = mode;
+    impl_->registry = &registry;
 }
 
 Validator::~Validator() = default;
@@ -232,14 +209,13 @@ core::Result<ValidationResult> Validator::ValidateConfigString(
             core::ErrorCode::kInvalidArgument);
     }
 
-    auto* spec =
-        detail::GetConfigSpecJson(SpecRegistry::GetInstance());
+    auto spec = detail::GetConfigSpec(*impl_->registry);
     if (!spec) {
         // No config spec registered — pass through
         return core::Result<ValidationResult>::Ok(ValidationResult{});
     }
 
-    return core::Result<ValidationResult>::Ok(RunValidation(*spec, data));
+    return core::Result<ValidationResult>::Ok(spec->Validate(data));
 }
 
 core::Result<ValidationResult> Validator::ValidateConfigNode(
@@ -257,16 +233,49 @@ core::Result<ValidationResult> Validator::ValidateDeviceEntry(
         return core::Result<ValidationResult>::Ok(ValidationResult{});
     }
 
-    auto* spec = detail::GetDriverSpecJson(
-        SpecRegistry::GetInstance(), entry.driver);
+    auto spec = detail::GetDriverSpec(*impl_->registry, entry.driver);
     if (!spec) {
         // No spec for this driver — pass through
         return core::Result<ValidationResult>::Ok(ValidationResult{});
     }
 
-    auto args_json = ArgsToTypedJson(entry.args);
     return core::Result<ValidationResult>::Ok(
-        RunValidation(*spec, args_json));
+        spec->Validate(ArgsToTypedJson(entry.args)));
+}
+
+core::Result<std::vector<ValidationResult>> Validator::ValidateDeviceEntries(
+    const std::vector<config::DeviceEntry>& entries,
+    std::size_t workers) const {
+    std::vector<ValidationResult> results(entries.size());
+    if (impl_->mode == ValidationMode::kLenient || entries.empty()) {
+        return core::Result<std::vector<ValidationResult>>::Ok(std::move(results));
+    }
+
+    // Resolve each driver's spec once, up front; workers then only read.
+    std::map<std::string, detail::CompiledSpecPtr, std::less<>> specs;
+    const auto& registry = *impl_->registry;
+    for (const auto& entry : entries) {
+        if (specs.find(entry.driver) == specs.end()) {
+            specs.emplace(entry.driver, detail::GetDriverSpec(registry, entry.driver));
+        }
+    }
+
+    auto validate = [&](std::size_t i) {
+        const auto& spec = specs.find(entries[i].driver)->second;
+        if (spec) {
+            results[i] = spec->Validate(ArgsToTypedJson(entries[i].args));
+        }
+    };
+
+    auto& executor = core::Executor::Shared();
+    if (workers == 0) {
+        workers = executor.ThreadCount() + 1;
+    }
+    // Small batches are cheaper on the calling thread.
+    workers = std::max<std::size_t>(
+        1, std::min(workers, entries.size() / kMinEntriesPerWorker));
+    executor.ParallelFor(entries.size(), validate, workers);
+    return core::Result<std::vector<ValidationResult>>::Ok(std::move(results));
 }
 
 }  // namespace plas::configspec
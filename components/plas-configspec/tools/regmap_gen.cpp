@@ -0,0 +1,312 @@
+// plas_regmap_gen — turns a register description (registers/*.regs.yaml)
+// into a header of constexpr register/field accessors over
+// plas/core/register.h.
+//
+//   plas_regmap_gen <in.regs.yaml> <out.h> [<in.regs.yaml> <out.h> ...]
+//   plas_regmap_gen --check <in.regs.yaml> <out.h> ...
+//
+// --check writes nothing and exits 1 if any header differs from what the
+// YAML generates. Description errors exit 2.
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+namespace {
+
+struct Field {
+    std::string name;
+    std::string description;
+    unsigned lsb = 0;
+    unsigned width = 0;
+    std::string access;  // ro / rw / rw1c
+    std::string type;    // C++ value type
+};
+
+struct Register {
+    std::string name;
+    std::string description;
+    uint64_t offset = 0;
+    unsigned width = 0;
+    std::vector<Field> fields;
+};
+
+struct RegisterMap {
+    std::string name_space;
+    std::string description;
+    std::vector<std::string> includes;
+    std::vector<Register> registers;
+};
+
+class DescriptionError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+bool IsIdentifier(const std::string& s) {
+    static const std::regex kIdentifier("[A-Za-z_][A-Za-z0-9_]*");
+    return std::regex_match(s, kIdentifier);
+}
+
+std::string Required(const YAML::Node& node, const char* key,
+                     const std::string& where) {
+    if (!node[key] || !node[key].IsScalar()) {
+        throw DescriptionError(where + ": missing '" + key + "'");
+    }
+    return node[key].Scalar();
+}
+
+std::string Optional(const YAML::Node& node, const char* key) {
+    return node[key] && node[key].IsScalar() ? node[key].Scalar() : std::string();
+}
+
+uint64_t ParseNumber(const std::string& text, const std::string& where) {
+    try {
+        std::size_t used = 0;
+        uint64_t value = std::stoull(text, &used, 0);
+        if (used == text.size()) {
+            return value;
+        }
+    } catch (const std::exception&) {
+    }
+    throw DescriptionError(where + ": '" + text + "' is not a number");
+}
+
+/// "bits: 5" or "bits: 9:4" (msb:lsb, as in the specs).
+void ParseBits(const std::string& text, Field& field, const std::string& where) {
+    auto colon = text.find(':');
+    if (colon == std::string::npos) {
+        field.lsb = static_cast<unsigned>(ParseNumber(text, where));
+        field.width = 1;
+        return;
+    }
+    auto msb = ParseNumber(text.substr(0, colon), where);
+    auto lsb = ParseNumber(text.substr(colon + 1), where);
+    if (msb < lsb) {
+        throw DescriptionError(where + ": bits '" + text + "' must be msb:lsb");
+    }
+    field.lsb = static_cast<unsigned>(lsb);
+    field.width = static_cast<unsigned>(msb - lsb + 1);
+}
+
+uint64_t FieldMask(const Field& field) {
+    uint64_t ones = field.width == 64 ? ~uint64_t{0} : (uint64_t{1} << field.width) - 1;
+    return ones << field.lsb;
+}
+
+std::string UnsignedType(unsigned bits) {
+    if (bits <= 8) return "uint8_t";
+    if (bits <= 16) return "uint16_t";
+    if (bits <= 32) return "uint32_t";
+    return "uint64_t";
+}
+
+RegisterMap Load(const std::string& path) {
+    YAML::Node root;
+    try {
+        root = YAML::LoadFile(path);
+    } catch (const YAML::Exception& e) {
+        throw DescriptionError(path + ": " + e.what());
+    }
+
+    RegisterMap map;
+    map.name_space = Required(root, "namespace", path);
+    map.description = Optional(root, "description");
+    if (root["includes"]) {
+        for (const auto& include : root["includes"]) {
+            map.includes.push_back(include.as<std::string>());
+        }
+    }
+    if (!root["registers"] || !root["registers"].IsSequence()) {
+        throw DescriptionError(path + ": missing 'registers' list");
+    }
+
+    std::set<std::string> register_names;
+    for (std::size_t r = 0; r < root["registers"].size(); ++r) {
+        const auto& node = root["registers"][r];
+        Register reg;
+        std::string where = path + ": registers[" + std::to_string(r) + "]";
+        reg.name = Required(node, "name", where);
+        where += " (" + reg.name + ")";
+        if (!IsIdentifier(reg.name) || !register_names.insert(reg.name).second) {
+            throw DescriptionError(where + ": name must be a unique identifier");
+        }
+        reg.description = Optional(node, "description");
+        reg.offset = ParseNumber(Required(node, "offset", where), where);
+        reg.width = static_cast<unsigned>(
+            ParseNumber(Required(node, "width", where), where));
+        if (reg.width != 8 && reg.width != 16 && reg.width != 32 && reg.width != 64) {
+            throw DescriptionError(where + ": width must be 8, 16, 32 or 64");
+        }
+
+        std::set<std::string> field_names;
+        uint64_t used_bits = 0;
+        const auto& fields = node["fields"];
+        for (std::size_t f = 0; fields && f < fields.size(); ++f) {
+            const auto& fnode = fields[f];
+            Field field;
+            std::string fwhere = where + ": fields[" + std::to_string(f) + "]";
+            field.name = Required(fnode, "name", fwhere);
+            fwhere += " (" + field.name + ")";
+            if (!IsIdentifier(field.name) || field.name == reg.name ||
+                !field_names.insert(field.name).second) {
+                throw DescriptionError(
+                    fwhere + ": name must be a unique identifier other than the register's");
+            }
+            field.description = Optional(fnode, "description");
+            ParseBits(Required(fnode, "bits", fwhere), field, fwhere);
+            if (field.lsb + field.width > reg.width) {
+                throw DescriptionError(fwhere + ": bits outside the register");
+            }
+            uint64_t mask = FieldMask(field);
+            if (used_bits & mask) {
+                throw DescriptionError(fwhere + ": overlaps another field");
+            }
+            used_bits |= mask;
+
+            field.access = Optional(fnode, "access");
+            if (field.access.empty()) field.access = "rw";
+            if (field.access != "ro" && field.access != "rw" && field.access != "rw1c") {
+                throw DescriptionError(fwhere + ": access must be ro, rw or rw1c");
+            }
+            field.type = Optional(fnode, "type");
+            if (field.type.empty()) {
+                field.type = field.width == 1 ? "bool" : UnsignedType(field.width);
+            }
+            reg.fields.push_back(std::move(field));
+        }
+        map.registers.push_back(std::move(reg));
+    }
+    return map;
+}
+
+std::string Hex(uint64_t value) {
+    char text[24];
+    std::snprintf(text, sizeof(text), "0x%02llX", static_cast<unsigned long long>(value));
+    return text;
+}
+
+std::string BaseName(const std::string& path) {
+    auto slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+std::string Generate(const RegisterMap& map, const std::string& source) {
+    static const char* kAccess[] = {"kRO", "kRW", "kRW1C"};
+    std::ostringstream out;
+    out << "// Generated by plas_regmap_gen from " << BaseName(source)
+        << ". Do not edit:\n"
+        << "// change the YAML and rebuild the plas_regmaps target.\n"
+        << "#pragma once\n\n"
+        << "#include <cstdint>\n\n"
+        << "#include \"plas/core/register.h\"\n";
+    for (const auto& include : map.includes) {
+        out << "#include \"" << include << "\"\n";
+    }
+    out << "\n";
+    if (!map.description.empty()) {
+        out << "/// " << map.description << "\n";
+    }
+    out << "namespace " << map.name_space << " {\n";
+
+    for (const auto& reg : map.registers) {
+        uint64_t w1c = 0;
+        for (const auto& field : reg.fields) {
+            if (field.access == "rw1c") {
+                w1c |= FieldMask(field);
+            }
+        }
+        std::string raw = UnsignedType(reg.width);
+        out << "\n";
+        if (!reg.description.empty()) {
+            out << "/// " << reg.description << " (offset " << Hex(reg.offset)
+                << ", " << reg.width << " bits)\n";
+        }
+        out << "struct " << reg.name << " : plas::core::Register<" << raw << ", "
+            << Hex(reg.offset);
+        if (w1c != 0) {
+            out << ", " << Hex(w1c);
+        }
+        out << "> {";
+        if (reg.fields.empty()) {
+            out << "};\n";
+            continue;
+        }
+        out << "\n";
+        for (const auto& field : reg.fields) {
+            if (!field.description.empty()) {
+                out << "    /// " << field.description << "\n";
+            }
+            int access = field.access == "ro" ? 0 : field.access == "rw" ? 1 : 2;
+            out << "    using " << field.name << " = plas::core::RegisterField<" << reg.name
+                << ", " << field.lsb << ", " << field.width
+                << ", plas::core::FieldAccess::" << kAccess[access] << ", " << field.type
+                << ">;\n";
+        }
+        out << "};\n";
+    }
+    out << "\n}  // namespace " << map.name_space << "\n";
+    return out.str();
+}
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream content;
+    content << in.rdbuf();
+    return content.str();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bool check = false;
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (!args.empty() && args.front() == "--check") {
+        check = true;
+        args.erase(args.begin());
+    }
+    if (args.empty() || args.size() % 2 != 0) {
+        std::cerr << "usage: plas_regmap_gen [--check] <in.regs.yaml> <out.h> ...\n";
+        return 2;
+    }
+
+    int status = 0;
+    for (std::size_t i = 0; i < args.size(); i += 2) {
+        const auto& input = args[i];
+        const auto& output = args[i + 1];
+        std::string header;
+        try {
+            header = Generate(Load(input), input);
+        } catch (const DescriptionError& e) {
+            std::cerr << e.what() << "\n";
+            return 2;
+        }
+        if (check) {
+            if (ReadFile(output) != header) {
+                std::cerr << output << " is out of date with " << input
+                          << " (rebuild the plas_regmaps target)\n";
+                status = 1;
+            }
+            continue;
+        }
+        if (ReadFile(output) == header) {
+            continue;  // keep the timestamp, nothing to rebuild
+        }
+        std::ofstream out(output, std::ios::binary | std::ios::trunc);
+        out << header;
+        if (!out) {
+            std::cerr << output << ": cannot write\n";
+            return 2;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,196 @@
+// plas_schema_gen — compiles the builtin specs (schemas/*.schema.{yaml,json})
+// into a C++ source of CBOR-encoded JSON for plas_configspec.
+//
+//   plas_schema_gen <out.cpp> <schema> [<schema> ...]
+//
+// Each schema is converted to JSON exactly as SpecRegistry converts specs
+// at runtime, then loaded into a json_validator: a spec that does not
+// parse or compile fails the build (exit 2) instead of being skipped by
+// RegisterBuiltinSpecs.
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json-schema.hpp>
+#include <nlohmann/json.hpp>
+#include <yaml-cpp/yaml.h>
+
+namespace {
+
+// --- YAML-to-JSON helper (same as src/configspec/spec_registry.cpp) ---
+
+nlohmann::json YamlNodeToJson(const YAML::Node& node) {
+    switch (node.Type()) {
+        case YAML::NodeType::Null:
+            return nullptr;
+
+        case YAML::NodeType::Scalar: {
+            try {
+                auto val = node.as<bool>();
+                auto raw = node.Scalar();
+                if (raw == "true" || raw == "false" || raw == "True" ||
+                    raw == "False" || raw == "TRUE" || raw == "FALSE" ||
+                    raw == "yes" || raw == "no" || raw == "Yes" ||
+                    raw == "No" || raw == "YES" || raw == "NO" ||
+                    raw == "on" || raw == "off" || raw == "On" ||
+                    raw == "Off" || raw == "ON" || raw == "OFF") {
+                    return val;
+                }
+            } catch (...) {
+            }
+
+            try {
+                auto val = node.as<int64_t>();
+                if (std::to_string(val) == node.Scalar() ||
+                    node.Scalar() == "0") {
+                    return val;
+                }
+            } catch (...) {
+            }
+
+            try {
+                auto val = node.as<double>();
+                return val;
+            } catch (...) {
+            }
+
+            return node.as<std::string>();
+        }
+
+        case YAML::NodeType::Sequence: {
+            auto arr = nlohmann::json::array();
+            for (const auto& item : node) {
+                arr.push_back(YamlNodeToJson(item));
+            }
+            return arr;
+        }
+
+        case YAML::NodeType::Map: {
+            auto obj = nlohmann::json::object();
+            for (const auto& pair : node) {
+                obj[pair.first.as<std::string>()] = YamlNodeToJson(pair.second);
+            }
+            return obj;
+        }
+
+        default:
+            return nullptr;
+    }
+}
+
+struct Spec {
+    std::string name;
+    std::vector<uint8_t> cbor;
+};
+
+class SpecError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream content;
+    content << in.rdbuf();
+    return content.str();
+}
+
+Spec Compile(const std::string& path) {
+    // "dir/aardvark.schema.yaml" -> "aardvark"
+    static const std::regex kSchemaFile(R"((?:.*/)?([^/]+)\.schema\.(yaml|yml|json))");
+    std::smatch match;
+    if (!std::regex_match(path, match, kSchemaFile)) {
+        throw SpecError(path + ": not a <name>.schema.{yaml,yml,json} file");
+    }
+    std::ifstream probe(path);
+    if (!probe.is_open()) {
+        throw SpecError(path + ": cannot read");
+    }
+    auto content = ReadFile(path);
+
+    nlohmann::json schema;
+    try {
+        schema = match[2] == "json" ? nlohmann::json::parse(content)
+                                    : YamlNodeToJson(YAML::Load(content));
+    } catch (const std::exception& e) {
+        throw SpecError(path + ": " + e.what());
+    }
+    try {
+        nlohmann::json_schema::json_validator validator;
+        validator.set_root_schema(schema);
+    } catch (const std::exception& e) {
+        throw SpecError(path + ": invalid schema: " + e.what());
+    }
+    return Spec{match[1], nlohmann::json::to_cbor(schema)};
+}
+
+std::string Generate(const std::vector<Spec>& specs) {
+    std::ostringstream out;
+    out << "// Generated by plas_schema_gen from "
+           "components/plas-configspec/schemas. Do not edit.\n\n"
+        << "#include <cstddef>\n#include <cstdint>\n\n"
+        << "namespace plas::configspec {\n\n"
+        << "struct BuiltinSpecEntry {\n"
+        << "    const char* name;\n"
+        << "    const uint8_t* cbor;\n"
+        << "    std::size_t size;\n"
+        << "};\n\n"
+        << "namespace {\n";
+    for (std::size_t i = 0; i < specs.size(); ++i) {
+        out << "\n// " << specs[i].name << "\nconst uint8_t kSpec" << i << "[] = {";
+        const auto& bytes = specs[i].cbor;
+        for (std::size_t b = 0; b < bytes.size(); ++b) {
+            char hex[8];
+            std::snprintf(hex, sizeof(hex), "0x%02x,", bytes[b]);
+            out << (b % 16 == 0 ? "\n    " : " ") << hex;
+        }
+        out << "\n};\n";
+    }
+    out << "\n}  // namespace\n\n"
+        << "extern const BuiltinSpecEntry kBuiltinSpecs[] = {\n";
+    for (std::size_t i = 0; i < specs.size(); ++i) {
+        out << "    {\"" << specs[i].name << "\", kSpec" << i << ", sizeof(kSpec" << i
+            << ")},\n";
+    }
+    out << "};\n\n"
+        << "extern const std::size_t kBuiltinSpecCount =\n"
+        << "    sizeof(kBuiltinSpecs) / sizeof(kBuiltinSpecs[0]);\n\n"
+        << "}  // namespace plas::configspec\n";
+    return out.str();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (args.size() < 2) {
+        std::cerr << "usage: plas_schema_gen <out.cpp> <schema> ...\n";
+        return 2;
+    }
+    const auto& output = args.front();
+
+    std::vector<Spec> specs;
+    try {
+        for (std::size_t i = 1; i < args.size(); ++i) {
+            specs.push_back(Compile(args[i]));
+        }
+    } catch (const SpecError& e) {
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
+
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    out << Generate(specs);
+    if (!out) {
+        std::cerr << output << ": cannot write\n";
+        return 2;
+    }
+    return 0;
+}
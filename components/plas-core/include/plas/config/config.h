@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <optional>
 #include <string>
 #include <vector>
@@ -7,10 +8,15 @@
 #include "plas/config/config_format.h"
 #include "plas/config/config_node.h"
 #include "plas/config/device_entry.h"
+#include "plas/config/device_table.h"
 #include "plas/core/result.h"
 
 namespace plas::config {
 
+/// Receives each device from Config::StreamFromFile; an error stops the
+/// stream and is returned from it.
+using DeviceEntrySink = std::function<core::Result<void>(DeviceEntry&&)>;
+
 class Config {
 public:
     static core::Result<Config> LoadFromFile(const std::string& path,
@@ -22,6 +28,22 @@ public:
 
     static core::Result<Config> LoadFromNode(const ConfigNode& node);
 
+    /// Arena-backed parse of the same "devices" section, for large configs:
+    /// no per-device or per-arg allocations (see DeviceTable).
+    static core::Result<DeviceTable> LoadDeviceTable(
+        const std::string& path, ConfigFormat fmt = ConfigFormat::kAuto);
+
+    static core::Result<DeviceTable> LoadDeviceTable(const ConfigNode& node);
+
+    /// Event-driven parse of the "devices" section: no document tree is
+    /// built, and each device reaches `sink` as soon as it has been read.
+    /// Devices arrive in document order (grouped layouts included); on a
+    /// malformed entry the devices before it have already been delivered.
+    /// Returns the number of devices delivered.
+    static core::Result<size_t> StreamFromFile(
+        const std::string& path, const DeviceEntrySink& sink,
+        ConfigFormat fmt = ConfigFormat::kAuto);
+
     const std::vector<DeviceEntry>& GetDevices() const;
 
     std::optional<DeviceEntry> FindDevice(const std::string& nickname) const;
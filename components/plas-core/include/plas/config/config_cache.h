@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace plas::config {
+
+/// Process-wide switch for compiled config files.
+///
+/// When a directory is set, Config::LoadFromFile, Config::LoadDeviceTable
+/// and PropertyManager::LoadFromFile hash the source file and look for a
+/// compiled copy named after that hash. On a hit, the compiled file is
+/// memory-mapped and decoded without parsing any JSON/YAML. On a miss, the
+/// source is parsed as usual and the compiled form is written for the next
+/// process. Compiled files are versioned, so a stale or corrupt one counts
+/// as a miss and gets rewritten. Any edit to the source changes its hash,
+/// so out-of-date entries are never picked up.
+///
+/// The directory defaults to $PLAS_CONFIG_CACHE_DIR. Empty disables caching.
+class ConfigCache {
+public:
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t writes = 0;
+    };
+
+    static void SetDirectory(const std::string& dir);
+    static std::string Directory();
+
+    static Stats GetStats();
+    static void ResetStats();
+};
+
+}  // namespace plas::config
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+
+namespace plas::config {
+
+/// Difference between two device lists, matched by nickname. A device is
+/// "changed" when its URI, driver or args differ.
+struct DeviceDiff {
+    std::vector<DeviceEntry> added;    ///< only in the new list
+    std::vector<DeviceEntry> changed;  ///< new version of the entry
+    std::vector<std::string> removed;  ///< nicknames only in the old list
+    size_t unchanged = 0;
+
+    bool Empty() const {
+        return added.empty() && changed.empty() && removed.empty();
+    }
+};
+
+/// Diff `current` against `updated`. `added` and `changed` keep the order of
+/// `updated`, `removed` the order of `current`. Nicknames must be unique
+/// within each list (as Config guarantees).
+DeviceDiff DiffDevices(const std::vector<DeviceEntry>& current,
+                       const std::vector<DeviceEntry>& updated);
+
+}  // namespace plas::config
@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "plas/config/config_format.h"
 #include "plas/core/result.h"
@@ -18,8 +19,18 @@ public:
         const std::string& path,
         ConfigFormat fmt = ConfigFormat::kAuto);
 
+    /// Node at dotted `key_path` ("plas.devices"); empty segments are
+    /// ignored and an empty path is this node. The first lookup flattens
+    /// the whole tree into a path index shared by every copy and subtree of
+    /// the root, so later lookups are one hash probe. The result is a view
+    /// that keeps the root alive rather than a copy. kNotFound if a segment
+    /// is missing or crosses a non-map.
     core::Result<ConfigNode> GetSubtree(const std::string& key_path) const;
 
+    /// GetSubtree for each of `key_paths`, in order.
+    std::vector<core::Result<ConfigNode>> GetSubtrees(
+        const std::vector<std::string>& key_paths) const;
+
     bool IsMap() const;
     bool IsArray() const;
     bool IsScalar() const;
@@ -2,9 +2,59 @@
 
 #include <map>
 #include <string>
+#include <string_view>
 
 namespace plas::config {
 
+/// Arg naming the device groups an entry belongs to, comma separated
+/// ("group: rack3" or "group: rack3,psu"). Read by hal::DeviceManager, not
+/// passed to driver spec validation.
+inline constexpr const char* kGroupArg = "group";
+
+/// Arg turning on read coalescing for an entry, with the freshness window
+/// in microseconds ("coalesce_reads_us: 500"; 0 shares only reads in
+/// flight). Read by hal::DeviceManager, not passed to driver spec
+/// validation.
+inline constexpr const char* kCoalesceReadsArg = "coalesce_reads_us";
+
+/// Arg wrapping an entry's interfaces in interceptors, outermost first
+/// ("interceptors: metrics,trace"; see hal::InterceptorRegistry). Read by
+/// hal::DeviceManager, not passed to driver spec validation.
+inline constexpr const char* kInterceptorsArg = "interceptors";
+
+/// Args of the "retry" interceptor. Setting retry_attempts (attempts in
+/// total, first included) adds "retry" as the innermost interceptor unless
+/// the `interceptors` list already names it:
+///
+///   retry_attempts: 4
+///   retry_backoff_us: 200        # first backoff, doubled per retry
+///   retry_max_backoff_us: 20000
+///   retry_jitter: 0.5            # backoff shortened by up to this fraction
+///   retry_on: busy,timeout       # also: io, resource_exhausted, data_loss
+inline constexpr const char* kRetryAttemptsArg = "retry_attempts";
+inline constexpr const char* kRetryBackoffArg = "retry_backoff_us";
+inline constexpr const char* kRetryMaxBackoffArg = "retry_max_backoff_us";
+inline constexpr const char* kRetryJitterArg = "retry_jitter";
+inline constexpr const char* kRetryOnArg = "retry_on";
+
+/// Arg declaring signals for hal::Sampler::AddFromConfig, comma separated
+/// "<kind>@<period>" ("sample: voltage@100ms,i2c:0x48:0x00:2@1s"). Not
+/// passed to driver spec validation.
+inline constexpr const char* kSampleArg = "sample";
+
+/// True for the args above, which hal::DeviceManager (or hal::Sampler)
+/// reads itself.
+inline bool IsDeviceManagerArg(std::string_view key) {
+    for (const char* arg : {kGroupArg, kCoalesceReadsArg, kInterceptorsArg, kRetryAttemptsArg,
+                            kRetryBackoffArg, kRetryMaxBackoffArg, kRetryJitterArg,
+                            kRetryOnArg, kSampleArg}) {
+        if (key == arg) {
+            return true;
+        }
+    }
+    return false;
+}
+
 struct DeviceEntry {
     std::string nickname;
     std::string uri;
@@ -12,4 +62,13 @@ struct DeviceEntry {
     std::map<std::string, std::string> args;
 };
 
+inline bool operator==(const DeviceEntry& a, const DeviceEntry& b) {
+    return a.nickname == b.nickname && a.uri == b.uri &&
+           a.driver == b.driver && a.args == b.args;
+}
+
+inline bool operator!=(const DeviceEntry& a, const DeviceEntry& b) {
+    return !(a == b);
+}
+
 }  // namespace plas::config
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+
+namespace plas::config {
+
+struct DeviceArg {
+    std::string_view key;
+    std::string_view value;
+};
+
+/// Read-only view of one device in a DeviceTable. Strings point into the
+/// table's arena and stay valid for the table's lifetime (moves included).
+class DeviceEntryView {
+public:
+    std::string_view Nickname() const { return nickname_; }
+    std::string_view Uri() const { return uri_; }
+    std::string_view Driver() const { return driver_; }
+
+    /// Args sorted by key.
+    const DeviceArg* ArgsBegin() const { return args_; }
+    const DeviceArg* ArgsEnd() const { return args_ + arg_count_; }
+    size_t ArgCount() const { return arg_count_; }
+
+    /// Binary search over the sorted args.
+    std::optional<std::string_view> FindArg(std::string_view key) const;
+
+    /// Owning copy, for code that takes a DeviceEntry.
+    DeviceEntry ToEntry() const;
+
+private:
+    friend class DeviceTable;
+
+    std::string_view nickname_;
+    std::string_view uri_;
+    std::string_view driver_;
+    const DeviceArg* args_ = nullptr;
+    size_t arg_count_ = 0;
+};
+
+/// Arena-backed device list for large configs. All strings live in a few
+/// large blocks; driver names, arg keys and arg values are interned, and
+/// each device's args are a slice of one flat sorted vector. Parsing N
+/// devices costs O(blocks) allocations instead of O(N * args).
+///
+/// Built by Config::LoadDeviceTable(); DeviceFactory::CreateFromConfig and
+/// DeviceManager::LoadFromTable accept its entries directly.
+class DeviceTable {
+public:
+    DeviceTable();
+    ~DeviceTable();
+    DeviceTable(DeviceTable&& other) noexcept;
+    DeviceTable& operator=(DeviceTable&& other) noexcept;
+    DeviceTable(const DeviceTable&) = delete;
+    DeviceTable& operator=(const DeviceTable&) = delete;
+
+    size_t Size() const;
+    bool Empty() const;
+    const DeviceEntryView& operator[](size_t index) const;
+    const DeviceEntryView* begin() const;
+    const DeviceEntryView* end() const;
+
+    std::optional<DeviceEntryView> Find(std::string_view nickname) const;
+
+    /// Owning copies of every entry, in order.
+    std::vector<DeviceEntry> ToEntries() const;
+
+    /// Bytes held by the arena blocks.
+    size_t ArenaBytes() const;
+    /// Distinct interned strings (drivers, arg keys, arg values).
+    size_t InternedCount() const;
+
+    /// Incremental construction, used by the config parsers. Strings are
+    /// copied, so the arguments only need to live for the call. Entries
+    /// become visible once Finish() has run; call it once, at the end.
+    void BeginEntry(std::string_view nickname, std::string_view uri,
+                    std::string_view driver);
+    void AddArg(std::string_view key, std::string_view value);
+    void Finish();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::config
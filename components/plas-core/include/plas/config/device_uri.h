@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace plas::config {
+
+/// A device URI ("scheme://f0:f1:...") split in one pass. Fields are the
+/// ':'-separated parts of the authority; each must be non-empty. All views
+/// point into the parsed string, which must outlive the DeviceUri.
+class DeviceUri {
+public:
+    static constexpr size_t kMaxFields = 4;
+
+    /// Invalid (IsValid() false, no fields) when `uri` has no scheme, no
+    /// "://", an empty authority or field, or more than kMaxFields fields.
+    static DeviceUri Parse(std::string_view uri);
+
+    bool IsValid() const { return valid_; }
+    std::string_view Scheme() const { return scheme_; }
+    std::string_view Authority() const { return authority_; }
+    size_t FieldCount() const { return field_count_; }
+    std::string_view Field(size_t index) const {
+        return index < field_count_ ? fields_[index] : std::string_view();
+    }
+
+    /// Field `index` as an unsigned number in `base` (0 = C prefix rules:
+    /// 0x hex, leading 0 octal) no greater than `max`. The whole field must
+    /// be consumed.
+    bool Number(size_t index, int base, uint64_t max, uint64_t& out) const {
+        return ParseNumber(Field(index), base, max, out);
+    }
+
+    template <typename T>
+    bool Number(size_t index, int base, T& out) const {
+        static_assert(std::is_unsigned_v<T>);
+        uint64_t value = 0;
+        if (!Number(index, base, static_cast<uint64_t>(T(~T(0))), value)) {
+            return false;
+        }
+        out = static_cast<T>(value);
+        return true;
+    }
+
+    /// Number() on arbitrary text, for fields with inner structure
+    /// (e.g. PCI "dev.fn").
+    static bool ParseNumber(std::string_view text, int base, uint64_t max,
+                            uint64_t& out);
+
+private:
+    std::string_view scheme_;
+    std::string_view authority_;
+    std::array<std::string_view, kMaxFields> fields_{};
+    size_t field_count_ = 0;
+    bool valid_ = false;
+};
+
+}  // namespace plas::config
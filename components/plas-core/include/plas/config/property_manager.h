@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -10,10 +13,25 @@
 
 namespace plas::config {
 
+/// Loads property files into core::Properties sessions.
+///
+/// Files are parsed (or read from the config cache) without any lock, so
+/// loads from several threads run in parallel. Each session of a file is
+/// then published with one Properties::SetMany() commit; the manager's
+/// lock only guards its list of session names.
+///
+/// GetInstance() loads into the process-wide Properties::GetSession()
+/// registry. A PropertyManager constructed directly keeps its own sessions
+/// (Properties::CreateDetached()), so several instances can load files
+/// with the same session names side by side without seeing each other.
 class PropertyManager {
 public:
     static PropertyManager& GetInstance();
 
+    /// An isolated manager owning its sessions.
+    PropertyManager();
+    ~PropertyManager();
+
     // Multi-session mode: each top-level key becomes a session name
     core::Result<void> LoadFromFile(
         const std::string& path,
@@ -25,7 +43,16 @@ public:
         const std::string& session_name,
         ConfigFormat fmt = ConfigFormat::kAuto);
 
-    // Session access (delegates to Properties)
+    /// Multi-session LoadFromFile() of every path (format from the
+    /// extension), parsed in parallel on core::Executor::Shared() by up to
+    /// `workers` threads, the caller included (0 = all of them). Once all
+    /// are parsed, files are published in `paths` order, so a key set by
+    /// several files keeps the last file's value as with sequential loads.
+    /// results[i] belongs to paths[i]; a file that fails publishes nothing.
+    std::vector<core::Result<void>> LoadFromFiles(
+        const std::vector<std::string>& paths, std::size_t workers = 0);
+
+    // Session access (delegates to Properties; created if missing)
     core::Properties& Session(const std::string& name);
     bool HasSession(const std::string& name) const;
     std::vector<std::string> SessionNames() const;
@@ -37,11 +64,20 @@ public:
     PropertyManager& operator=(const PropertyManager&) = delete;
 
 private:
-    PropertyManager() = default;
-    ~PropertyManager() = default;
+    struct GlobalTag {};
+    explicit PropertyManager(GlobalTag);
 
     static ConfigFormat DetectFormat(const std::string& path);
 
+    /// Session `name`: from the registry for GetInstance(), else from
+    /// sessions_, created on first use.
+    core::Properties& Resolve(const std::string& name);
+
+    /// Record `name` as managed (for SessionNames() and Reset()).
+    void AddManagedSession(const std::string& name);
+
+    const bool global_ = false;
+    std::map<std::string, std::shared_ptr<core::Properties>> sessions_;  // !global_ only
     std::vector<std::string> managed_sessions_;
     mutable std::mutex mutex_;
 };
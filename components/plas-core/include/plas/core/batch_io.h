@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace plas::core {
+
+/// One read of a BatchReader batch: up to `length` bytes at `offset` into
+/// `buffer`, from the open `fd`, or from `path` when fd < 0 (opened
+/// read-only for the batch and closed again).
+struct BatchRead {
+    int fd = -1;
+    std::string path;
+    uint64_t offset = 0;
+    void* buffer = nullptr;
+    std::size_t length = 0;
+
+    /// Set by BatchReader::Read(): bytes read (short reads are not errors,
+    /// as with pread) or the failure (kNotFound, kPermissionDenied,
+    /// kIOError, kInvalidArgument for a null buffer).
+    std::size_t transferred = 0;
+    std::error_code error;
+};
+
+struct BatchReaderOptions {
+    /// Submission queue entries: reads in flight per io_uring_enter.
+    unsigned depth = 64;
+    /// false: always use plain open/pread/close (the fallback path).
+    bool io_uring = true;
+};
+
+/// Runs many small file reads (sysfs attributes, PCI config space) as
+/// batches on an io_uring: a batch of N path reads costs three
+/// io_uring_enter calls (open all, read all, close all) instead of 3N
+/// syscalls, and N fd reads cost one. Where the kernel has no io_uring,
+/// or a seccomp policy refuses it, or an opcode is too new for the
+/// running kernel, the affected reads fall back to open/pread/close with
+/// the same results.
+///
+/// Not thread-safe: use one reader per thread (ForThisThread()).
+class BatchReader {
+public:
+    explicit BatchReader(const BatchReaderOptions& options = {});
+    ~BatchReader();
+
+    BatchReader(const BatchReader&) = delete;
+    BatchReader& operator=(const BatchReader&) = delete;
+
+    /// True if reads go through an io_uring.
+    bool UsesIoUring() const;
+
+    /// Run every read and fill in its `transferred`/`error`. Returns how
+    /// many succeeded.
+    std::size_t Read(BatchRead* reads, std::size_t count);
+    std::size_t Read(std::vector<BatchRead>& reads) {
+        return Read(reads.data(), reads.size());
+    }
+
+    /// The calling thread's reader, created with default options on first
+    /// use, so the ring is set up once per thread rather than per batch.
+    static BatchReader& ForThisThread();
+
+private:
+    struct Ring;
+
+    std::unique_ptr<Ring> ring_;
+};
+
+}  // namespace plas::core
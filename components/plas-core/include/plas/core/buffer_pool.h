@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace plas::core {
+
+/// Counters of the calling thread's cache.
+struct BufferPoolStats {
+    uint64_t allocations = 0;  ///< blocks taken from the heap
+    uint64_t reuses = 0;       ///< blocks served from the cache
+    std::size_t cached_bytes = 0;
+};
+
+/// Size-classed block allocator with a per-thread cache, behind
+/// PooledBuffer. Classes are powers of two from kMinBlock to kMaxPooledBlock;
+/// larger requests go straight to the heap. A released block is kept by the
+/// releasing thread (up to kMaxCachedPerClass per class and kMaxCachedBytes
+/// in total) and freed when that thread exits.
+class BufferPool {
+public:
+    static constexpr std::size_t kMinBlock = 64;
+    static constexpr std::size_t kMaxPooledBlock = std::size_t{1} << 20;
+    static constexpr std::size_t kMaxCachedPerClass = 8;
+    static constexpr std::size_t kMaxCachedBytes = std::size_t{8} << 20;
+
+    /// At least `bytes` bytes (rounded up to the class size) of
+    /// uninitialized, max_align_t-aligned storage. `capacity` receives the
+    /// usable size. `bytes` == 0 returns nullptr.
+    static void* Allocate(std::size_t bytes, std::size_t& capacity);
+
+    /// Return a block from Allocate(); `capacity` as reported there.
+    static void Release(void* block, std::size_t capacity) noexcept;
+
+    static BufferPoolStats ThreadStats();
+
+    /// Free every block cached by the calling thread.
+    static void TrimThreadCache();
+};
+
+/// Move-only buffer of trivially copyable elements backed by BufferPool.
+/// Growing within Capacity() never allocates and new elements are left
+/// uninitialized, so a buffer can be sized to a device's maximum payload
+/// and filled in place.
+template <typename T>
+class PooledBuffer {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "PooledBuffer holds raw device data");
+
+public:
+    PooledBuffer() = default;
+
+    /// `size` uninitialized elements.
+    explicit PooledBuffer(std::size_t size) { Reserve(size); size_ = size; }
+
+    PooledBuffer(const T* data, std::size_t size) { Assign(data, size); }
+
+    ~PooledBuffer() { Reset(); }
+
+    PooledBuffer(PooledBuffer&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          capacity_(std::exchange(other.capacity_, 0)) {}
+
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            capacity_ = std::exchange(other.capacity_, 0);
+        }
+        return *this;
+    }
+
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    T* Data() { return data_; }
+    const T* Data() const { return data_; }
+    std::size_t Size() const { return size_; }
+    std::size_t Capacity() const { return capacity_; }
+    bool Empty() const { return size_ == 0; }
+
+    T* begin() { return data_; }
+    T* end() { return data_ + size_; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+
+    T& operator[](std::size_t index) { return data_[index]; }
+    const T& operator[](std::size_t index) const { return data_[index]; }
+
+    /// Make room for `capacity` elements, keeping the contents.
+    void Reserve(std::size_t capacity) {
+        if (capacity <= capacity_) {
+            return;
+        }
+        std::size_t bytes = 0;
+        auto* block =
+            static_cast<T*>(BufferPool::Allocate(capacity * sizeof(T), bytes));
+        if (size_ > 0) {
+            std::memcpy(block, data_, size_ * sizeof(T));
+        }
+        if (data_) {
+            BufferPool::Release(data_, capacity_ * sizeof(T));
+        }
+        data_ = block;
+        capacity_ = bytes / sizeof(T);
+    }
+
+    /// Keeps the first min(size, Size()) elements; the rest are
+    /// uninitialized.
+    void Resize(std::size_t size) {
+        Reserve(size);
+        size_ = size;
+    }
+
+    void Assign(const T* data, std::size_t size) {
+        size_ = 0;
+        Reserve(size);
+        if (size > 0) {
+            std::memcpy(data_, data, size * sizeof(T));
+        }
+        size_ = size;
+    }
+
+    void Clear() { size_ = 0; }
+
+    std::vector<T> ToVector() const { return std::vector<T>(begin(), end()); }
+
+    bool operator==(const std::vector<T>& other) const {
+        return size_ == other.size() &&
+               (size_ == 0 ||
+                std::memcmp(data_, other.data(), size_ * sizeof(T)) == 0);
+    }
+
+private:
+    /// Give the block back to the pool.
+    void Reset() noexcept {
+        if (data_) {
+            BufferPool::Release(data_, capacity_ * sizeof(T));
+        }
+        data_ = nullptr;
+        size_ = 0;
+        capacity_ = 0;
+    }
+
+    T* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+};
+
+using PooledBytes = PooledBuffer<uint8_t>;
+
+}  // namespace plas::core
@@ -2,32 +2,120 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <initializer_list>
 #include <vector>
 
 namespace plas::core {
 
+/// Non-owning, read-only view of contiguous bytes: a ByteBuffer, a mapped
+/// BAR window, a DOE response. The memory must outlive the view.
+class ByteView {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    constexpr ByteView() = default;
+    constexpr ByteView(const uint8_t* data, size_t size)
+        : data_(data), size_(size) {}
+    template <size_t N>
+    constexpr ByteView(const uint8_t (&array)[N]) : data_(array), size_(N) {}
+    ByteView(const std::vector<uint8_t>& bytes)
+        : data_(bytes.data()), size_(bytes.size()) {}
+
+    constexpr const uint8_t* Data() const { return data_; }
+    constexpr size_t Size() const { return size_; }
+    constexpr bool Empty() const { return size_ == 0; }
+
+    constexpr const uint8_t& operator[](size_t index) const {
+        return data_[index];
+    }
+    constexpr const uint8_t* begin() const { return data_; }
+    constexpr const uint8_t* end() const { return data_ + size_; }
+
+    /// Bytes [offset, offset + length), clamped to the view.
+    constexpr ByteView Slice(size_t offset, size_t length = npos) const {
+        if (offset >= size_) {
+            return ByteView(data_ + size_, 0);
+        }
+        size_t available = size_ - offset;
+        return ByteView(data_ + offset,
+                        length < available ? length : available);
+    }
+
+    /// Same bytes (not the same memory).
+    bool operator==(ByteView other) const {
+        return size_ == other.size_ &&
+               (size_ == 0 || std::memcmp(data_, other.data_, size_) == 0);
+    }
+    bool operator!=(ByteView other) const { return !(*this == other); }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/// Growable byte buffer with kInlineCapacity bytes of inline storage, so
+/// short register reads and writes never touch the heap. Larger contents
+/// move to a core::BufferPool block. Resize() zero-fills new bytes;
+/// AppendUninitialized() does not, for filling straight from a device.
 class ByteBuffer {
 public:
+    static constexpr size_t kInlineCapacity = 64;
+
     ByteBuffer();
     explicit ByteBuffer(size_t size);
     ByteBuffer(std::initializer_list<uint8_t> init);
     ByteBuffer(const uint8_t* data, size_t size);
+    explicit ByteBuffer(ByteView view);
+    ~ByteBuffer();
+
+    ByteBuffer(const ByteBuffer& other);
+    ByteBuffer& operator=(const ByteBuffer& other);
+    ByteBuffer(ByteBuffer&& other) noexcept;
+    ByteBuffer& operator=(ByteBuffer&& other) noexcept;
 
     const uint8_t* Data() const;
     uint8_t* Data();
     size_t Size() const;
     bool Empty() const;
+    size_t Capacity() const;
+    /// Contents live in the inline storage.
+    bool IsInline() const;
 
     void Clear();
     void Resize(size_t new_size);
+    /// Make room for `capacity` bytes without changing Size().
+    void Reserve(size_t capacity);
     void Append(const uint8_t* data, size_t size);
+    void Append(ByteView view);
+    /// Grow by `count` uninitialized bytes and return a pointer to them.
+    /// Valid until the next call that changes the capacity.
+    uint8_t* AppendUninitialized(size_t count);
 
     uint8_t& operator[](size_t index);
     const uint8_t& operator[](size_t index) const;
 
+    uint8_t* begin() { return data_; }
+    uint8_t* end() { return data_ + size_; }
+    const uint8_t* begin() const { return data_; }
+    const uint8_t* end() const { return data_ + size_; }
+
+    ByteView View() const { return ByteView(data_, size_); }
+    operator ByteView() const { return View(); }
+    /// View of bytes [offset, offset + length), clamped to the buffer.
+    ByteView Slice(size_t offset, size_t length = ByteView::npos) const {
+        return View().Slice(offset, length);
+    }
+
 private:
-    std::vector<uint8_t> buffer_;
+    /// Move to a block of at least `min_capacity` bytes (geometric growth).
+    void Grow(size_t min_capacity);
+    void ReleaseHeap() noexcept;
+
+    uint8_t* data_;
+    size_t size_ = 0;
+    size_t capacity_ = kInlineCapacity;
+    alignas(std::max_align_t) uint8_t inline_[kInlineCapacity];
 };
 
 }  // namespace plas::core
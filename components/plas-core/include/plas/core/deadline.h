@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+namespace plas::core {
+
+/// Point in time by which an operation must finish, or none.
+///
+/// A deadline is not passed as an argument: ScopedDeadline installs one for
+/// the calling thread, and drivers read Deadline::Current() in their poll
+/// and wait loops, returning kTimeout once it has passed. Their own
+/// per-device timeouts (bus_timeout_ms, doe_timeout_ms, ...) still apply;
+/// the earlier of the two wins. Work handed to other threads by
+/// Executor::ParallelFor, DeviceManager::ForEachInGroup, PowerSequencer and
+/// the Aardvark async queue carries the submitter's deadline along.
+class Deadline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// No deadline.
+    constexpr Deadline() = default;
+
+    static Deadline At(Clock::time_point when) { return Deadline(when); }
+    static Deadline After(std::chrono::nanoseconds timeout) {
+        return Deadline(Clock::now() + timeout);
+    }
+
+    /// The innermost ScopedDeadline of the calling thread; none outside one.
+    static Deadline Current();
+
+    bool IsSet() const { return when_ != Clock::time_point::max(); }
+    bool IsExpired() const { return IsSet() && Clock::now() >= when_; }
+
+    /// Clock::time_point::max() if none.
+    Clock::time_point When() const { return when_; }
+
+    /// Time left, zero once expired; nanoseconds::max() if none.
+    std::chrono::nanoseconds Remaining() const {
+        if (!IsSet()) {
+            return std::chrono::nanoseconds::max();
+        }
+        return std::max(std::chrono::nanoseconds(0),
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            when_ - Clock::now()));
+    }
+
+    /// The earlier of `local` (a driver's own timeout) and this deadline.
+    Clock::time_point Clamp(Clock::time_point local) const {
+        return std::min(local, when_);
+    }
+
+    /// The earlier of the two deadlines.
+    Deadline Min(Deadline other) const {
+        return Deadline(std::min(when_, other.when_));
+    }
+
+private:
+    explicit constexpr Deadline(Clock::time_point when) : when_(when) {}
+
+    Clock::time_point when_ = Clock::time_point::max();
+};
+
+/// Install a deadline for the calling thread until destruction. Scopes
+/// nest and only tighten: the effective deadline is the earlier of
+/// `deadline` and the enclosing one. Not movable; keep it on the stack.
+///
+///   core::ScopedDeadline scope(core::Deadline::After(std::chrono::milliseconds(20)));
+///   auto r = i2c->Read(0x50, buf, 16);  // kTimeout rather than a late result
+class ScopedDeadline {
+public:
+    explicit ScopedDeadline(Deadline deadline);
+    ~ScopedDeadline();
+
+    ScopedDeadline(const ScopedDeadline&) = delete;
+    ScopedDeadline& operator=(const ScopedDeadline&) = delete;
+
+private:
+    Deadline previous_;
+};
+
+}  // namespace plas::core
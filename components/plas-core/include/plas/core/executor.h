@@ -0,0 +1,153 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "plas/core/result.h"
+
+namespace plas::core {
+
+struct ExecutorOptions {
+    /// Worker threads; 0 = one per CPU in `cpus`, or in the process's
+    /// affinity mask when `cpus` is empty.
+    std::size_t threads = 0;
+    /// Pin worker i to cpus[i % cpus.size()] (Linux). Empty: workers keep
+    /// the affinity of the thread that creates the executor.
+    std::vector<int> cpus;
+    /// Worker thread name prefix (Linux shows 15 characters).
+    std::string name = "plas-exec";
+};
+
+struct ExecutorStats {
+    uint64_t executed = 0;      ///< tasks run by the workers
+    uint64_t stolen = 0;        ///< of those, taken from another worker
+    uint64_t timers_fired = 0;  ///< timer callbacks run
+};
+
+/// Work-stealing thread pool with timers.
+///
+/// Each worker owns a deque: tasks posted from a worker go to its own
+/// deque and are run newest first, so a task's follow-up work stays on the
+/// same core; an idle worker steals the oldest task of another. Tasks
+/// posted from other threads go through a shared queue. Tasks must not
+/// block for long on each other: a worker waiting inside a task is a
+/// worker lost to the pool (ParallelFor is the exception — the caller
+/// works through the items itself).
+///
+/// Timers are kept by one timer thread, which only posts their callbacks.
+class Executor {
+public:
+    using Task = std::function<void()>;
+    using TimerId = uint64_t;
+
+    explicit Executor(ExecutorOptions options = {});
+
+    /// Cancel the timers, run the tasks already posted and join the
+    /// workers. Tasks must not be posted during or after destruction.
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    /// The process-wide executor behind Bootstrap's parallel open,
+    /// PciDoe::DoeExchangeAsync, PciLinkMonitor and DeviceManager's idle
+    /// reaper. Created on first use and never destroyed.
+    static Executor& Shared();
+
+    /// Options for Shared(). kBusy once Shared() has been created.
+    static Result<void> ConfigureShared(ExecutorOptions options);
+
+    /// A process-wide executor with one worker pinned to each CPU of
+    /// `cpus`, for work that should stay near a device (see
+    /// PciDevice::LocalExecutor). One per distinct CPU set, created on
+    /// first use and never destroyed. Empty `cpus`: Shared().
+    static Executor& ForCpus(std::vector<int> cpus);
+
+    void Post(Task task);
+
+    /// Post `fn` and get its result through a future.
+    template <typename F>
+    auto Submit(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+        auto future = task->get_future();
+        Post([task] { (*task)(); });
+        return future;
+    }
+
+    /// Call body(0) ... body(count - 1) and return when all calls have
+    /// finished. The calling thread takes items too, together with up to
+    /// `max_threads` - 1 workers (0: all of them), so nested and
+    /// concurrent ParallelFor calls cannot deadlock. Items are handed out in
+    /// index order. The caller's Deadline::Current() applies to every item.
+    void ParallelFor(std::size_t count, const std::function<void(std::size_t)>& body,
+                     std::size_t max_threads = 0);
+
+    /// Run `task` once after `delay`.
+    TimerId PostAfter(std::chrono::nanoseconds delay, Task task);
+
+    /// Run `task` every `period`, the first time after `first_delay`. Fixed
+    /// rate: ticks are period apart from the first, a run that overran
+    /// skips the ticks it missed, and runs of one timer never overlap.
+    TimerId PostEvery(std::chrono::nanoseconds period, Task task,
+                      std::chrono::nanoseconds first_delay = std::chrono::nanoseconds::zero());
+
+    /// Stop a timer. When this returns the callback is not running (unless
+    /// Cancel is called from it) and will not run again. False if `id` is
+    /// unknown or a one-shot timer already ran.
+    bool Cancel(TimerId id);
+
+    std::size_t ThreadCount() const;
+
+    /// True on one of this executor's workers.
+    bool RunningInThisThread() const;
+
+    ExecutorStats GetStats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/// Runs tasks posted to it one at a time, in order, on an executor's
+/// workers. One strand per device serializes that device's work without a
+/// thread of its own. Tasks already posted still run after the Strand
+/// object is destroyed.
+class Strand {
+public:
+    explicit Strand(Executor& executor = Executor::Shared());
+    ~Strand();
+
+    Strand(const Strand&) = delete;
+    Strand& operator=(const Strand&) = delete;
+
+    void Post(Executor::Task task);
+
+    template <typename F>
+    auto Submit(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+        auto future = task->get_future();
+        Post([task] { (*task)(); });
+        return future;
+    }
+
+    /// True while one of this strand's tasks runs on the calling thread.
+    bool RunningInThisThread() const;
+
+    Executor& GetExecutor() const;
+
+private:
+    struct State;
+    std::shared_ptr<State> state_;
+};
+
+}  // namespace plas::core
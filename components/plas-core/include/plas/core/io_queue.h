@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <utility>
+
+#include "plas/core/lock_stats.h"
+
+namespace plas::core {
+
+/// Class of a device operation. Control work (power, PERST#, health reads)
+/// runs in the foreground; bulk work (firmware transfer, log dumps, EEPROM
+/// images) marks itself background so control work overtakes it.
+enum class IoPriority : uint8_t { kForeground = 0, kBackground = 1 };
+
+inline constexpr std::size_t kIoPriorityCount = 2;
+
+/// The calling thread's priority: kForeground unless a ScopedIoPriority is
+/// active. Like core::Deadline it follows work handed to
+/// Executor::ParallelFor, PowerSequencer and the Aardvark async queue.
+IoPriority CurrentIoPriority();
+
+/// Set the calling thread's I/O priority until destruction; scopes nest
+/// and the innermost wins. Not movable; keep it on the stack.
+///
+///   core::ScopedIoPriority background(core::IoPriority::kBackground);
+///   eeprom.Write(0, image.data(), image.size());  // yields to control I/O per page
+class ScopedIoPriority {
+public:
+    explicit ScopedIoPriority(IoPriority priority);
+    ~ScopedIoPriority();
+
+    ScopedIoPriority(const ScopedIoPriority&) = delete;
+    ScopedIoPriority& operator=(const ScopedIoPriority&) = delete;
+
+private:
+    IoPriority previous_;
+};
+
+struct IoQueueStats {
+    /// Indexed by IoPriority.
+    std::array<uint64_t, kIoPriorityCount> grants{};         ///< turns granted
+    std::array<uint64_t, kIoPriorityCount> total_wait_us{};  ///< time spent queued
+    std::array<uint64_t, kIoPriorityCount> max_wait_us{};
+};
+
+/// Lock for one device's I/O path that grants turns by the waiters'
+/// CurrentIoPriority(), then in arrival order, instead of whichever thread
+/// a std::mutex happens to wake.
+///
+/// A turn is one transaction: drivers hold it per register access, DOE
+/// exchange or mailbox command, never across a whole chunked operation, so
+/// a foreground caller waits for at most the transaction in progress and
+/// is then served before every queued background one. Background waiters
+/// only run when no foreground waiter is queued.
+///
+/// Satisfies Lockable (lock/try_lock/unlock), so std::lock_guard and
+/// std::unique_lock work as with the std::mutex it replaces. Not recursive.
+/// A named queue also reports to core::LockStatsSnapshot() when built with
+/// PLAS_LOCK_STATS.
+class IoQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    IoQueue() = default;
+    explicit IoQueue(const char* name);
+    IoQueue(const IoQueue&) = delete;
+    IoQueue& operator=(const IoQueue&) = delete;
+
+    void lock();
+    /// Take the turn only if the queue is idle and nobody is waiting.
+    bool try_lock();
+    /// lock(), giving up at `deadline`; false if it passed first.
+    bool try_lock_until(Clock::time_point deadline);
+    void unlock();
+
+    /// Callers waiting at `priority`.
+    std::size_t Waiting(IoPriority priority) const;
+
+    IoQueueStats Stats() const;
+    void ResetStats();
+
+private:
+    void GrantLocked(IoPriority priority, Clock::time_point since, bool queued);
+
+    mutable std::mutex mutex_;
+    std::condition_variable turn_;
+    bool owned_ = false;
+    uint64_t next_ticket_ = 0;
+    std::set<std::pair<int, uint64_t>> waiters_;  // (priority, ticket)
+    IoQueueStats stats_;
+#if PLAS_LOCK_STATS
+    LockCounters* lock_stats_ = nullptr;  // null when unnamed
+    Clock::time_point granted_at_;
+#endif
+};
+
+}  // namespace plas::core
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Set by the PLAS_LOCK_STATS CMake option (PUBLIC on plas_core, so every
+// consumer sees the same InstrumentedMutex layout).
+#ifndef PLAS_LOCK_STATS
+#define PLAS_LOCK_STATS 0
+#endif
+
+namespace plas::core {
+
+inline constexpr bool kLockStatsEnabled = PLAS_LOCK_STATS != 0;
+
+/// Contention counters of one named lock. Instances sharing a name (every
+/// FT4222H device's I2C queue, every Properties session) are summed.
+struct LockStats {
+    std::string name;
+    uint64_t acquisitions = 0;
+    uint64_t contended = 0;  ///< acquisitions that had to wait
+    uint64_t wait_ns = 0;    ///< total time spent waiting
+    uint64_t max_wait_ns = 0;
+    uint64_t hold_ns = 0;    ///< total time held
+    uint64_t max_hold_ns = 0;
+
+    uint64_t MeanWaitNs() const { return contended ? wait_ns / contended : 0; }
+    uint64_t MeanHoldNs() const { return acquisitions ? hold_ns / acquisitions : 0; }
+};
+
+/// Process-wide counters behind one lock name, updated without locks.
+/// Pointers from For() stay valid for the life of the process.
+class LockCounters {
+public:
+    /// Counters of `name`, created on first use.
+    static LockCounters* For(const char* name);
+
+    void RecordAcquire(uint64_t wait_ns, bool contended) {
+        acquisitions_.fetch_add(1, std::memory_order_relaxed);
+        if (contended) {
+            contended_.fetch_add(1, std::memory_order_relaxed);
+            wait_ns_.fetch_add(wait_ns, std::memory_order_relaxed);
+            UpdateMax(max_wait_ns_, wait_ns);
+        }
+    }
+
+    void RecordRelease(uint64_t hold_ns) {
+        hold_ns_.fetch_add(hold_ns, std::memory_order_relaxed);
+        UpdateMax(max_hold_ns_, hold_ns);
+    }
+
+private:
+    friend std::vector<LockStats> LockStatsSnapshot();
+    friend void ResetLockStats();
+
+    static void UpdateMax(std::atomic<uint64_t>& max, uint64_t value) {
+        auto seen = max.load(std::memory_order_relaxed);
+        while (value > seen &&
+               !max.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    std::atomic<uint64_t> acquisitions_{0};
+    std::atomic<uint64_t> contended_{0};
+    std::atomic<uint64_t> wait_ns_{0};
+    std::atomic<uint64_t> max_wait_ns_{0};
+    std::atomic<uint64_t> hold_ns_{0};
+    std::atomic<uint64_t> max_hold_ns_{0};
+};
+
+/// Every named lock acquired at least once, sorted by name. Always empty
+/// unless built with PLAS_LOCK_STATS. hal::MetricsRegistry::Snapshot()
+/// includes it as MetricsSnapshot::locks.
+std::vector<LockStats> LockStatsSnapshot();
+
+/// Zero all lock counters. Existing LockCounters pointers stay valid.
+void ResetLockStats();
+
+/// std::mutex that, when built with PLAS_LOCK_STATS, records wait time,
+/// hold time and contention under `name`. Otherwise it is a plain
+/// std::mutex and the name is dropped. Lockable; not for
+/// std::condition_variable (use condition_variable_any).
+///
+///   mutable core::InstrumentedMutex mutex_{"device_manager"};
+///   std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+class InstrumentedMutex {
+public:
+#if PLAS_LOCK_STATS
+    explicit InstrumentedMutex(const char* name) : counters_(LockCounters::For(name)) {}
+
+    void lock() {
+        if (mutex_.try_lock()) {
+            acquired_ = Clock::now();
+            counters_->RecordAcquire(0, false);
+            return;
+        }
+        auto start = Clock::now();
+        mutex_.lock();
+        acquired_ = Clock::now();
+        counters_->RecordAcquire(Ns(acquired_ - start), true);
+    }
+
+    bool try_lock() {
+        if (!mutex_.try_lock()) {
+            return false;
+        }
+        acquired_ = Clock::now();
+        counters_->RecordAcquire(0, false);
+        return true;
+    }
+
+    void unlock() {
+        auto held = Ns(Clock::now() - acquired_);
+        mutex_.unlock();
+        counters_->RecordRelease(held);
+    }
+#else
+    explicit InstrumentedMutex(const char* /*name*/) {}
+
+    void lock() { mutex_.lock(); }
+    bool try_lock() { return mutex_.try_lock(); }
+    void unlock() { mutex_.unlock(); }
+#endif
+
+    InstrumentedMutex(const InstrumentedMutex&) = delete;
+    InstrumentedMutex& operator=(const InstrumentedMutex&) = delete;
+
+private:
+    std::mutex mutex_;
+#if PLAS_LOCK_STATS
+    using Clock = std::chrono::steady_clock;
+
+    static uint64_t Ns(Clock::duration d) {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    }
+
+    LockCounters* counters_;
+    Clock::time_point acquired_;  // written by the owner only
+#endif
+};
+
+}  // namespace plas::core
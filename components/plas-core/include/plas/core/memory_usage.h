@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace plas::core {
+
+/// Helpers for Device::MemoryUsage() and DeviceManager::GetMemoryReport().
+/// They estimate what the standard containers allocate (libstdc++ layout);
+/// allocator headers and rounding are not counted.
+
+/// Heap behind `s`: nothing while it fits the inline buffer, else its
+/// capacity plus the terminator.
+inline std::size_t HeapBytes(const std::string& s) {
+    static const std::size_t kInline = std::string().capacity();
+    return s.capacity() > kInline ? s.capacity() + 1 : 0;
+}
+
+/// Element storage of `v` (not what the elements own).
+template <typename T, typename Alloc>
+std::size_t HeapBytes(const std::vector<T, Alloc>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+/// Colour and parent/left/right links of a std::map / std::set node.
+inline constexpr std::size_t kTreeNodeOverhead = 4 * sizeof(void*);
+
+/// Nodes of a std::map / std::set (not what the values own).
+template <typename Tree>
+std::size_t TreeNodeBytes(const Tree& tree) {
+    return tree.size() * (sizeof(typename Tree::value_type) + kTreeNodeOverhead);
+}
+
+/// Nodes (next link and cached hash) and bucket array of a
+/// std::unordered_map / std::unordered_set (not what the values own).
+template <typename Table>
+std::size_t HashNodeBytes(const Table& table) {
+    return table.size() * (sizeof(typename Table::value_type) + 2 * sizeof(void*)) +
+           table.bucket_count() * sizeof(void*);
+}
+
+}  // namespace plas::core
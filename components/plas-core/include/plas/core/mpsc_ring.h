@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "plas/core/spsc_ring.h"
+
+namespace plas::core {
+
+/// Bounded multi-producer/single-consumer ring. Any number of threads
+/// push, one thread pops; nobody blocks or takes a lock. Like SpscRing, a
+/// full ring drops the newest entries and counts them.
+///
+/// A producer claims a run of consecutive positions with one CAS on the
+/// head (so a batch Push stays contiguous and in order), fills them, and
+/// marks each slot ready with its sequence number. The consumer pops ready
+/// slots in position order and stops at the first one still being filled,
+/// so a producer preempted mid-copy holds back entries claimed after it
+/// until it finishes.
+template <typename T>
+class MpscRing {
+public:
+    /// `capacity` is rounded up to a power of two (at least 1).
+    explicit MpscRing(std::size_t capacity)
+        : capacity_(detail::RoundUpPow2(capacity)),
+          cells_(std::make_unique<Cell[]>(capacity_)) {}
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    std::size_t Capacity() const { return capacity_; }
+
+    /// Claimed positions not yet popped, including ones still being filled.
+    std::size_t Size() const {
+        auto tail = tail_.load(std::memory_order_acquire);
+        auto head = head_.load(std::memory_order_acquire);
+        return static_cast<std::size_t>(head - tail);
+    }
+
+    /// Any thread: copy up to `count` entries in as one contiguous run;
+    /// returns how many fit.
+    std::size_t Push(const T* items, std::size_t count) {
+        auto head = head_.load(std::memory_order_relaxed);
+        std::size_t n = 0;
+        for (;;) {
+            // Positions below tail + capacity were popped, and the consumer
+            // published tail after it finished reading them.
+            auto tail = tail_.load(std::memory_order_acquire);
+            std::size_t free = capacity_ - static_cast<std::size_t>(head - tail);
+            n = std::min(count, free);
+            if (n == 0 || head_.compare_exchange_weak(head, head + n,
+                                                      std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            auto position = head + i;
+            Cell& cell = cells_[static_cast<std::size_t>(position) & (capacity_ - 1)];
+            cell.value = items[i];
+            cell.sequence.store(position + 1, std::memory_order_release);
+        }
+        if (n < count) {
+            dropped_.fetch_add(count - n, std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+    bool Push(const T& item) { return Push(&item, 1) == 1; }
+
+    /// Consumer: move up to `max` of the oldest ready entries into `out`.
+    std::size_t Pop(T* out, std::size_t max) {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        std::size_t n = 0;
+        while (n < max) {
+            auto position = tail + n;
+            Cell& cell = cells_[static_cast<std::size_t>(position) & (capacity_ - 1)];
+            if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+                break;
+            }
+            out[n++] = std::move(cell.value);
+        }
+        if (n != 0) {
+            tail_.store(tail + n, std::memory_order_release);
+        }
+        return n;
+    }
+
+    /// Entries Push() could not store.
+    uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell {
+        std::atomic<uint64_t> sequence{0};  // position + 1 once filled
+        T value{};
+    };
+
+    std::size_t capacity_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(kCacheLineSize) std::atomic<uint64_t> head_{0};  // next claim, producers
+    alignas(kCacheLineSize) std::atomic<uint64_t> tail_{0};  // next read, consumer
+    alignas(kCacheLineSize) std::atomic<uint64_t> dropped_{0};
+};
+
+}  // namespace plas::core
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "plas/core/result.h"
+
+namespace plas::core {
+
+/// Parse a kernel CPU list ("0-3,8,10-11", as in sysfs cpulist files) into
+/// ascending CPU numbers. Surrounding whitespace is ignored; an empty list
+/// gives an empty vector. kInvalidArgument on anything else.
+Result<std::vector<int>> ParseCpuList(std::string_view text);
+
+/// Size of the huge pages NumaBuffer asks for (x86-64 / arm64 PMD size).
+inline constexpr std::size_t kHugePageSize = std::size_t{2} << 20;
+
+/// What backs a NumaBuffer's pages.
+enum class PageBacking : uint8_t {
+    kNormal,       ///< base pages
+    kHugetlb,      ///< 2 MiB pages reserved in the hugetlbfs pool (MAP_HUGETLB)
+    kTransparent,  ///< 2 MiB-aligned and madvise(MADV_HUGEPAGE): THP where
+                   ///< the kernel can assemble huge pages
+};
+
+/// Page-aligned, zeroed memory whose pages are placed on one NUMA node, for
+/// buffers that a device's local CPUs fill or drain (DMA staging, BAR copy
+/// buffers). The placement is a preference: when the node is out of memory
+/// the kernel falls back to another. Move-only; unmapped on destruction.
+class NumaBuffer {
+public:
+    NumaBuffer() = default;
+    ~NumaBuffer();
+
+    NumaBuffer(NumaBuffer&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          capacity_(std::exchange(other.capacity_, 0)),
+          node_(std::exchange(other.node_, -1)),
+          backing_(std::exchange(other.backing_, PageBacking::kNormal)) {}
+    NumaBuffer& operator=(NumaBuffer&& other) noexcept;
+
+    NumaBuffer(const NumaBuffer&) = delete;
+    NumaBuffer& operator=(const NumaBuffer&) = delete;
+
+    /// `bytes` bytes on `node` (< 0: no placement). The pages are faulted
+    /// in here, so the first device access does not take the page faults.
+    /// kInvalidArgument for 0 bytes or a node the system does not have,
+    /// kOutOfMemory if the mapping fails. Where the placement cannot be
+    /// applied (no NUMA support, or mbind denied in a container) the buffer
+    /// is still returned, with Node() == -1.
+    ///
+    /// With `huge_pages` the mapping is rounded up to kHugePageSize and
+    /// backed by 2 MiB pages, so a multi-MB copy takes a TLB miss per 2 MiB
+    /// instead of per 4 KiB: hugetlbfs pages first, then a 2 MiB-aligned
+    /// mapping marked MADV_HUGEPAGE, then base pages. Backing() says which.
+    static Result<NumaBuffer> Allocate(std::size_t bytes, int node,
+                                       bool huge_pages = false);
+
+    void* Data() const { return data_; }
+    std::size_t Size() const { return size_; }
+    /// Bytes mapped: Size() rounded up to the page size used.
+    std::size_t Capacity() const { return capacity_; }
+    /// The node the pages were bound to; -1 if unplaced.
+    int Node() const { return node_; }
+    PageBacking Backing() const { return backing_; }
+
+private:
+    void* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+    int node_ = -1;
+    PageBacking backing_ = PageBacking::kNormal;
+};
+
+class NumaBufferPool;
+
+/// A NumaBuffer borrowed from a NumaBufferPool; returns it on destruction.
+/// Move-only. The pool must outlive the lease.
+class NumaBufferLease {
+public:
+    NumaBufferLease() = default;
+    ~NumaBufferLease();
+
+    NumaBufferLease(NumaBufferLease&& other) noexcept
+        : pool_(std::exchange(other.pool_, nullptr)),
+          buffer_(std::move(other.buffer_)),
+          size_(std::exchange(other.size_, 0)),
+          node_(std::exchange(other.node_, -1)) {}
+    NumaBufferLease& operator=(NumaBufferLease&& other) noexcept;
+
+    NumaBufferLease(const NumaBufferLease&) = delete;
+    NumaBufferLease& operator=(const NumaBufferLease&) = delete;
+
+    void* Data() const { return buffer_.Data(); }
+    /// The size asked for; the buffer behind it may be larger.
+    std::size_t Size() const { return size_; }
+    int Node() const { return buffer_.Node(); }
+    PageBacking Backing() const { return buffer_.Backing(); }
+
+private:
+    friend class NumaBufferPool;
+    NumaBufferLease(NumaBufferPool* pool, NumaBuffer buffer, std::size_t size, int node)
+        : pool_(pool), buffer_(std::move(buffer)), size_(size), node_(node) {}
+
+    NumaBufferPool* pool_ = nullptr;
+    NumaBuffer buffer_;
+    std::size_t size_ = 0;
+    int node_ = -1;  ///< node asked for; the pool's cache key
+};
+
+struct NumaBufferPoolStats {
+    uint64_t allocations = 0;  ///< Acquire() calls that mapped a new buffer
+    uint64_t reuses = 0;       ///< Acquire() calls served from the cache
+    std::size_t cached_bytes = 0;
+};
+
+/// Cache of large NumaBuffers for staging that repeats (BAR bulk copies,
+/// firmware chunks, DMA buffers), where mapping, binding and faulting in
+/// a fresh buffer each time costs more than the copy. Sizes are rounded
+/// up to a power of two of at least kHugePageSize and buffers are kept per
+/// (node, size); a returned buffer that would push the cache past
+/// `max_cached_bytes` is unmapped instead. Reused buffers keep their old
+/// contents. Thread-safe.
+class NumaBufferPool {
+public:
+    explicit NumaBufferPool(std::size_t max_cached_bytes = std::size_t{256} << 20,
+                            bool huge_pages = true)
+        : max_cached_bytes_(max_cached_bytes), huge_pages_(huge_pages) {}
+
+    NumaBufferPool(const NumaBufferPool&) = delete;
+    NumaBufferPool& operator=(const NumaBufferPool&) = delete;
+
+    /// Process-wide pool (256 MiB cache, huge pages).
+    static NumaBufferPool& Shared();
+
+    /// A buffer of at least `bytes` on `node` (< 0: no placement). Same
+    /// errors as NumaBuffer::Allocate().
+    Result<NumaBufferLease> Acquire(std::size_t bytes, int node);
+
+    /// Unmap every cached buffer.
+    void Trim();
+
+    NumaBufferPoolStats Stats() const;
+
+private:
+    friend class NumaBufferLease;
+
+    struct Cached {
+        int node;  ///< node asked for, which Node() may not be
+        NumaBuffer buffer;
+    };
+
+    void Release(NumaBuffer buffer, int node);
+
+    const std::size_t max_cached_bytes_;
+    const bool huge_pages_;
+    mutable std::mutex mutex_;
+    std::vector<Cached> cached_;
+    NumaBufferPoolStats stats_;
+};
+
+}  // namespace plas::core
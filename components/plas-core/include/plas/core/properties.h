@@ -1,21 +1,252 @@
 #pragma once
 
 #include <any>
+#include <atomic>
 #include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
 #include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
-#include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <type_traits>
+#include <variant>
 #include <vector>
 
 #include "plas/core/error.h"
+#include "plas/core/lock_stats.h"
 #include "plas/core/result.h"
 
 namespace plas::core {
 
+/// Interned property name. Resolve a name once with Intern() and pass the
+/// key to Properties in hot loops: lookups become an array index instead of
+/// a string compare. Ids are process-wide, shared by all sessions and never
+/// reused.
+class PropertyKey {
+public:
+    PropertyKey() = default;
+
+    /// Key for `name`, registering it on first use.
+    static PropertyKey Intern(std::string_view name);
+
+    /// Key for `name` if it was ever interned, otherwise an invalid key.
+    static PropertyKey Find(std::string_view name);
+
+    bool IsValid() const { return id_ != kInvalidId; }
+    uint32_t Id() const { return id_; }
+
+    /// Interned name ("" for an invalid key).
+    const std::string& Name() const;
+
+    bool operator==(PropertyKey other) const { return id_ == other.id_; }
+    bool operator!=(PropertyKey other) const { return id_ != other.id_; }
+
+private:
+    static constexpr uint32_t kInvalidId = std::numeric_limits<uint32_t>::max();
+
+    explicit PropertyKey(uint32_t id) : id_(id) {}
+
+    friend class Properties;
+    friend class PropertyStore;
+
+    uint32_t id_ = kInvalidId;
+};
+
+namespace detail {
+
+/// Stored type of a property value. Scalars live in the slot itself;
+/// strings and any other type are boxed.
+enum class PropertyKind : uint8_t {
+    kEmpty,
+    kBool,
+    kInt8,
+    kUint8,
+    kInt16,
+    kUint16,
+    kInt32,
+    kUint32,
+    kInt64,
+    kUint64,
+    kFloat,
+    kDouble,
+    kString,
+    kOther,
+    kRemoved,  ///< fork only: hides the base session's value
+};
+
+template <typename T>
+struct PropertyKindOf
+    : std::integral_constant<PropertyKind, PropertyKind::kOther> {};
+
+#define PLAS_PROPERTY_KIND(type, kind)                                    \
+    template <>                                                           \
+    struct PropertyKindOf<type>                                           \
+        : std::integral_constant<PropertyKind, PropertyKind::kind> {}
+
+PLAS_PROPERTY_KIND(bool, kBool);
+PLAS_PROPERTY_KIND(int8_t, kInt8);
+PLAS_PROPERTY_KIND(uint8_t, kUint8);
+PLAS_PROPERTY_KIND(int16_t, kInt16);
+PLAS_PROPERTY_KIND(uint16_t, kUint16);
+PLAS_PROPERTY_KIND(int32_t, kInt32);
+PLAS_PROPERTY_KIND(uint32_t, kUint32);
+PLAS_PROPERTY_KIND(int64_t, kInt64);
+PLAS_PROPERTY_KIND(uint64_t, kUint64);
+PLAS_PROPERTY_KIND(float, kFloat);
+PLAS_PROPERTY_KIND(double, kDouble);
+PLAS_PROPERTY_KIND(std::string, kString);
+
+#undef PLAS_PROPERTY_KIND
+
+template <typename T>
+constexpr bool kIsScalarProperty =
+    PropertyKindOf<T>::value != PropertyKind::kString &&
+    PropertyKindOf<T>::value != PropertyKind::kOther;
+
+using PropertyBox = std::variant<std::string, std::any>;
+
+/// One key's value within a session. Guarded by a seqlock: readers retry
+/// while `seq` is odd or changed under them; writers are serialized by the
+/// session. `box` is only accessed through std::atomic_load/atomic_store.
+struct PropertySlot {
+    std::atomic<uint32_t> seq{0};
+    std::atomic<PropertyKind> kind{PropertyKind::kEmpty};
+    std::atomic<uint64_t> bits{0};
+    std::shared_ptr<const PropertyBox> box;
+};
+
+struct PropertyRead {
+    PropertyKind kind = PropertyKind::kEmpty;
+    uint64_t bits = 0;
+    std::shared_ptr<const PropertyBox> box;
+};
+
+/// One pending write; kEmpty removes the key.
+struct PropertyWrite {
+    PropertyKey key;
+    PropertyKind kind = PropertyKind::kEmpty;
+    uint64_t bits = 0;
+    std::shared_ptr<const PropertyBox> box;
+};
+
+template <typename T>
+uint64_t ToBits(T value) {
+    static_assert(sizeof(T) <= sizeof(uint64_t));
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(T));
+    return bits;
+}
+
+template <typename T>
+T FromBits(uint64_t bits) {
+    T value;
+    std::memcpy(&value, &bits, sizeof(T));
+    return value;
+}
+
+/// Consistent copy of `slot`; false if the slot is empty (a kRemoved
+/// tombstone counts as present).
+inline bool ReadSlot(const PropertySlot& slot, PropertyRead& out) {
+    for (;;) {
+        uint32_t before = slot.seq.load(std::memory_order_acquire);
+        if (before & 1u) {
+            continue;  // writer in progress
+        }
+        out.kind = slot.kind.load(std::memory_order_relaxed);
+        out.bits = slot.bits.load(std::memory_order_relaxed);
+        if (out.kind == PropertyKind::kString ||
+            out.kind == PropertyKind::kOther) {
+            out.box = std::atomic_load_explicit(&slot.box,
+                                                std::memory_order_acquire);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == before) {
+            return out.kind != PropertyKind::kEmpty;
+        }
+    }
+}
+
+template <typename T>
+PropertyWrite EncodeProperty(PropertyKey key, T value) {
+    constexpr auto kind = PropertyKindOf<T>::value;
+    if constexpr (kind == PropertyKind::kString) {
+        return {key, kind, 0,
+                std::make_shared<const PropertyBox>(std::in_place_index<0>,
+                                                    std::move(value))};
+    } else if constexpr (kind == PropertyKind::kOther) {
+        return {key, kind, 0,
+                std::make_shared<const PropertyBox>(
+                    std::in_place_index<1>, std::any(std::move(value)))};
+    } else {
+        return {key, kind, ToBits(value), nullptr};
+    }
+}
+
+}  // namespace detail
+
+/// Keys of one commit (Set, Remove, Clear, SetMany or Update) that match a
+/// subscriber's prefix.
+struct PropertyChange {
+    std::string session;
+    uint64_t version = 0;           ///< Properties::Version() after the commit
+    std::vector<std::string> keys;  ///< in commit order
+};
+
+/// Writes collected for Properties::SetMany() / Update().
+class PropertyBatch {
+public:
+    template <typename T>
+    PropertyBatch& Set(PropertyKey key, T value) {
+        writes_.push_back(detail::EncodeProperty(key, std::move(value)));
+        return *this;
+    }
+
+    template <typename T>
+    PropertyBatch& Set(const std::string& key, T value) {
+        return Set(PropertyKey::Intern(key), std::move(value));
+    }
+
+    PropertyBatch& Remove(PropertyKey key) {
+        writes_.push_back({key, detail::PropertyKind::kEmpty, 0, nullptr});
+        return *this;
+    }
+
+    PropertyBatch& Remove(const std::string& key) {
+        return Remove(PropertyKey::Find(key));
+    }
+
+    size_t Size() const { return writes_.size(); }
+    bool Empty() const { return writes_.empty(); }
+    void Clear() { writes_.clear(); }
+
+private:
+    friend class Properties;
+    friend class SharedProperties;
+    std::vector<detail::PropertyWrite> writes_;
+};
+
+/// Named, process-wide key-value sessions.
+///
+/// A session created with ForkSession() is layered over a base session:
+/// keys it has not written are read from the base, so a fork of a large
+/// session costs nothing up front and stores only its own overrides.
+/// Snapshot() freezes a session; forks of a snapshot are isolated from
+/// later writes to the original.
+///
+/// Values are typed: scalars (bool, fixed-width integers, float, double)
+/// are stored inline, std::string and other types are boxed. Reads take no
+/// lock; each key's slot is read under a seqlock, so Get() may run
+/// concurrently with Set() on the same session. Writers are serialized per
+/// session. The string-keyed overloads intern the name and forward to the
+/// PropertyKey overloads; use PropertyKey directly on hot paths.
+///
+/// Every commit that changes something advances Version(), and
+/// subscribers registered by key prefix are notified on a shared
+/// notification thread, so pollers and writers never block on callbacks.
 class Properties {
 public:
     // --- Session management (static, thread-safe) ---
@@ -23,8 +254,51 @@ public:
     static void DestroySession(const std::string& name);
     static void DestroyAll();
     static bool HasSession(const std::string& name);
+    static std::vector<std::string> SessionNames();  // sorted
+
+    /// A session named `name` outside the registry: GetSession() and
+    /// friends never see it and it lives as long as the returned pointer.
+    /// For owners that keep their own set of sessions, such as a
+    /// config::PropertyManager instance.
+    static std::shared_ptr<Properties> CreateDetached(const std::string& name);
+
+    /// Create session `name` layered over the live session `base`. Changes
+    /// to `base` show through for keys the fork has not overridden, but
+    /// advance neither the fork's Version() nor its subscribers.
+    /// kNotFound if `base` does not exist, kAlreadyOpen if `name` does.
+    static Result<Properties*> ForkSession(const std::string& name,
+                                           const std::string& base);
+
+    /// Create session `name` layered over a Snapshot(). kInvalidArgument
+    /// if `base` is null, kAlreadyOpen if `name` exists.
+    static Result<Properties*> ForkSession(
+        const std::string& name, std::shared_ptr<const Properties> base);
+
+    // --- Snapshots ---
+
+    /// Read-only copy of the current state, Version() included. Values are
+    /// shared rather than copied (boxed strings and types are reference
+    /// counted). If this session is a fork of a snapshot, only its own
+    /// overrides are copied and the base is shared, so a worker fork can be
+    /// snapshotted in time proportional to what it changed.
+    std::shared_ptr<const Properties> Snapshot() const;
+
+    /// Session this one was forked from, or null.
+    const Properties* Base() const { return base_.get(); }
 
     // --- Key-Value access (per-session, thread-safe) ---
+    template <typename T>
+    void Set(PropertyKey key, T value);
+
+    template <typename T>
+    Result<T> Get(PropertyKey key) const;
+
+    template <typename To>
+    Result<To> GetAs(PropertyKey key) const;
+
+    bool Has(PropertyKey key) const;
+    void Remove(PropertyKey key);
+
     template <typename T>
     void Set(const std::string& key, T value);
 
@@ -40,19 +314,120 @@ public:
     size_t Size() const;
     std::vector<std::string> Keys() const;
 
+    // --- Batched updates ---
+
+    /// Apply all writes of `batch` under one writer lock, as one Version()
+    /// step and one notification.
+    void SetMany(const PropertyBatch& batch);
+
+    /// Run fn(PropertyBatch&) with the writer lock held, then apply the
+    /// batch like SetMany(). No other writer can interleave, so fn may read
+    /// this session and write back derived values. fn must not write to
+    /// this session directly (deadlock).
+    template <typename Fn>
+    void Update(Fn&& fn);
+
+    // --- Change tracking ---
+
+    /// Advanced by every commit that changed a key: odd while the commit is
+    /// being applied, even once it is complete. Equal even readings before
+    /// and after a series of Get() calls mean they saw one consistent state.
+    uint64_t Version() const {
+        return version_.load(std::memory_order_acquire);
+    }
+
+    using ChangeCallback = std::function<void(const PropertyChange&)>;
+    using SubscriptionId = uint64_t;
+
+    /// Call `callback` after each commit that touched a key starting with
+    /// `prefix` ("" matches every key). Callbacks of all sessions run in
+    /// commit order on one notification thread, never on the writer's.
+    SubscriptionId Subscribe(std::string prefix, ChangeCallback callback);
+
+    /// Once this returns, the callback is not running and will not be called
+    /// again (except when called from the callback itself). Do not call it
+    /// while holding a lock the callback takes.
+    void Unsubscribe(SubscriptionId id);
+
+    /// Block until every change committed so far has been delivered. No-op
+    /// on the notification thread.
+    static void FlushNotifications();
+
     Properties(const Properties&) = delete;
     Properties& operator=(const Properties&) = delete;
 
 private:
-    Properties() = default;
+    friend class PropertyStore;
+    friend class PropertyCheckpoint;
+    struct Subscriber;
+    class Dispatcher;
+    using SubscriberList = std::vector<std::shared_ptr<Subscriber>>;
+
+    static void PostChange(std::shared_ptr<const SubscriberList> subscribers,
+                           const std::string& session, uint64_t version,
+                           std::vector<uint32_t> ids);
+
+    explicit Properties(std::string name) : name_(std::move(name)) {}
 
     // --- Session registry ---
-    static std::mutex& RegistryMutex();
-    static std::map<std::string, std::unique_ptr<Properties>>& Registry();
+    static InstrumentedMutex& RegistryMutex();
+    static std::map<std::string, std::shared_ptr<Properties>>& Registry();
+    static std::shared_ptr<Properties> FindSession(const std::string& name);
+
+    /// Slot pointers indexed by PropertyKey id. Replaced (never resized in
+    /// place) when a larger id arrives; old tables stay alive for readers.
+    struct SlotTable {
+        explicit SlotTable(size_t n)
+            : capacity(n),
+              slots(std::make_unique<std::atomic<detail::PropertySlot*>[]>(n)) {}
+        size_t capacity;
+        std::unique_ptr<std::atomic<detail::PropertySlot*>[]> slots;
+    };
+
+    const detail::PropertySlot* FindSlot(PropertyKey key) const {
+        const auto* table = table_.load(std::memory_order_acquire);
+        if (!key.IsValid() || !table || key.Id() >= table->capacity) {
+            return nullptr;
+        }
+        return table->slots[key.Id()].load(std::memory_order_acquire);
+    }
+
+    /// Value of `key` in this session or the nearest base that has it.
+    bool Read(PropertyKey key, detail::PropertyRead& out) const {
+        for (const auto* layer = this; layer; layer = layer->base_.get()) {
+            const auto* slot = layer->FindSlot(key);
+            if (slot && detail::ReadSlot(*slot, out)) {
+                return out.kind != detail::PropertyKind::kRemoved;
+            }
+        }
+        return false;
+    }
+
+    /// Ids of all keys visible through this session, ascending. Caller
+    /// holds write_mutex_; the bases' mutexes are taken here.
+    std::vector<uint32_t> VisibleIdsLocked() const;
+
+    void Commit(const detail::PropertyWrite* writes, size_t count);
+
+    /// Apply `writes` as one commit. Caller holds write_mutex_.
+    void CommitLocked(const detail::PropertyWrite* writes, size_t count);
+
+    /// Slot for `key`, created on demand. Caller holds write_mutex_.
+    detail::PropertySlot& SlotForWriteLocked(PropertyKey key);
 
     // --- Per-session storage ---
-    mutable std::shared_mutex mutex_;
-    std::map<std::string, std::any> store_;
+    mutable InstrumentedMutex write_mutex_{"properties.write"};
+    std::atomic<const SlotTable*> table_{nullptr};
+    std::vector<std::unique_ptr<SlotTable>> tables_;  // last = current
+    std::deque<detail::PropertySlot> slots_;          // stable addresses
+    std::atomic<size_t> size_{0};
+    std::atomic<uint64_t> version_{0};
+    std::shared_ptr<const Properties> base_;  // set once, before sharing
+    bool frozen_ = false;                     // created by Snapshot()
+
+    // --- Subscriptions (guarded by write_mutex_) ---
+    std::string name_;
+    std::shared_ptr<const SubscriberList> subscribers_;
 };
 
 // --- SafeNumericCast: range-checked numeric conversion ---
@@ -126,28 +501,24 @@ constexpr bool SafeNumericCast(From from, To& out) {
     }
 }
 
-// Try to extract `from` as type `From`, then safe-cast to `To`.
-template <typename To, typename From>
-bool TryCastFrom(const std::any& from, To& out) {
-    auto* p = std::any_cast<From>(&from);
-    if (!p) return false;
-    return SafeNumericCast<To>(*p, out);
-}
-
-// Try all numeric source types to cast to `To`.
+/// Range-checked conversion of a stored scalar to `To`; false for
+/// non-numeric kinds or out-of-range values.
 template <typename To>
-bool TryNumericCast(const std::any& from, To& out) {
-    return TryCastFrom<To, bool>(from, out) ||
-           TryCastFrom<To, int8_t>(from, out) ||
-           TryCastFrom<To, uint8_t>(from, out) ||
-           TryCastFrom<To, int16_t>(from, out) ||
-           TryCastFrom<To, uint16_t>(from, out) ||
-           TryCastFrom<To, int32_t>(from, out) ||
-           TryCastFrom<To, uint32_t>(from, out) ||
-           TryCastFrom<To, int64_t>(from, out) ||
-           TryCastFrom<To, uint64_t>(from, out) ||
-           TryCastFrom<To, float>(from, out) ||
-           TryCastFrom<To, double>(from, out);
+bool ConvertNumeric(PropertyKind kind, uint64_t bits, To& out) {
+    switch (kind) {
+        case PropertyKind::kBool:   return SafeNumericCast<To>(FromBits<bool>(bits), out);
+        case PropertyKind::kInt8:   return SafeNumericCast<To>(FromBits<int8_t>(bits), out);
+        case PropertyKind::kUint8:  return SafeNumericCast<To>(FromBits<uint8_t>(bits), out);
+        case PropertyKind::kInt16:  return SafeNumericCast<To>(FromBits<int16_t>(bits), out);
+        case PropertyKind::kUint16: return SafeNumericCast<To>(FromBits<uint16_t>(bits), out);
+        case PropertyKind::kInt32:  return SafeNumericCast<To>(FromBits<int32_t>(bits), out);
+        case PropertyKind::kUint32: return SafeNumericCast<To>(FromBits<uint32_t>(bits), out);
+        case PropertyKind::kInt64:  return SafeNumericCast<To>(FromBits<int64_t>(bits), out);
+        case PropertyKind::kUint64: return SafeNumericCast<To>(FromBits<uint64_t>(bits), out);
+        case PropertyKind::kFloat:  return SafeNumericCast<To>(FromBits<float>(bits), out);
+        case PropertyKind::kDouble: return SafeNumericCast<To>(FromBits<double>(bits), out);
+        default:                    return false;
+    }
 }
 
 }  // namespace detail
@@ -155,49 +526,83 @@ bool TryNumericCast(const std::any& from, To& out) {
 // --- Template implementations ---
 
 template <typename T>
-void Properties::Set(const std::string& key, T value) {
-    std::unique_lock lock(mutex_);
-    store_.insert_or_assign(key, std::any(std::move(value)));
+void Properties::Set(PropertyKey key, T value) {
+    auto write = detail::EncodeProperty(key, std::move(value));
+    Commit(&write, 1);
 }
 
 template <typename T>
-Result<T> Properties::Get(const std::string& key) const {
-    std::shared_lock lock(mutex_);
-    auto it = store_.find(key);
-    if (it == store_.end()) {
+Result<T> Properties::Get(PropertyKey key) const {
+    detail::PropertyRead read;
+    if (!Read(key, read)) {
         return Result<T>::Err(ErrorCode::kNotFound);
     }
-    auto* val = std::any_cast<T>(&it->second);
-    if (!val) {
+    constexpr auto kind = detail::PropertyKindOf<T>::value;
+    if (read.kind != kind) {
         return Result<T>::Err(ErrorCode::kTypeMismatch);
     }
-    return Result<T>::Ok(*val);
+    if constexpr (kind == detail::PropertyKind::kString) {
+        return Result<T>::Ok(std::get<0>(*read.box));
+    } else if constexpr (kind == detail::PropertyKind::kOther) {
+        auto* val = std::any_cast<T>(&std::get<1>(*read.box));
+        if (!val) {
+            return Result<T>::Err(ErrorCode::kTypeMismatch);
+        }
+        return Result<T>::Ok(*val);
+    } else {
+        return Result<T>::Ok(detail::FromBits<T>(read.bits));
+    }
 }
 
 template <typename To>
-Result<To> Properties::GetAs(const std::string& key) const {
+Result<To> Properties::GetAs(PropertyKey key) const {
     static_assert(std::is_arithmetic_v<To>,
                   "GetAs<To> requires To to be an arithmetic type");
 
-    std::shared_lock lock(mutex_);
-    auto it = store_.find(key);
-    if (it == store_.end()) {
+    detail::PropertyRead read;
+    if (!Read(key, read)) {
         return Result<To>::Err(ErrorCode::kNotFound);
     }
 
-    // Exact type match
-    if (auto* val = std::any_cast<To>(&it->second)) {
-        return Result<To>::Ok(*val);
+    // Arithmetic types without a scalar kind (e.g. char, long long) are
+    // boxed; only an exact match is possible there.
+    if (read.kind == detail::PropertyKind::kOther) {
+        if (auto* val = std::any_cast<To>(&std::get<1>(*read.box))) {
+            return Result<To>::Ok(*val);
+        }
+        return Result<To>::Err(ErrorCode::kTypeMismatch);
     }
 
-    // Try numeric conversion from all known source types
     To out{};
-    if (detail::TryNumericCast<To>(it->second, out)) {
+    if (detail::ConvertNumeric<To>(read.kind, read.bits, out)) {
         return Result<To>::Ok(out);
     }
 
-    // Stored value is not a numeric type
+    // Stored value is not a numeric type (or out of range)
     return Result<To>::Err(ErrorCode::kTypeMismatch);
 }
 
+template <typename Fn>
+void Properties::Update(Fn&& fn) {
+    PropertyBatch batch;
+    std::lock_guard lock(write_mutex_);
+    fn(batch);
+    CommitLocked(batch.writes_.data(), batch.writes_.size());
+}
+
+template <typename T>
+void Properties::Set(const std::string& key, T value) {
+    Set(PropertyKey::Intern(key), std::move(value));
+}
+
+template <typename T>
+Result<T> Properties::Get(const std::string& key) const {
+    return Get<T>(PropertyKey::Find(key));
+}
+
+template <typename To>
+Result<To> Properties::GetAs(const std::string& key) const {
+    return GetAs<To>(PropertyKey::Find(key));
+}
+
 }  // namespace plas::core
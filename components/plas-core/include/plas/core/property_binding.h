@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "plas/core/properties.h"
+
+namespace plas::core {
+
+/// One member of a bound struct and the property key it is read from.
+template <typename Struct, typename Member>
+struct PropertyField {
+    const char* key;
+    Member Struct::*member;
+};
+
+template <typename Struct, typename Member>
+constexpr PropertyField<Struct, Member> Field(const char* key, Member Struct::*member) {
+    return {key, member};
+}
+
+/// Field list of a struct for PropertyBinding: specialize it with a tuple
+/// of Field()s.
+///
+///   struct LinkParams {
+///       int32_t timeout_ms = 100;
+///       double vcc = 3.3;
+///       std::string mode = "gen4";
+///   };
+///
+///   namespace plas::core {
+///   template <>
+///   struct PropertyFields<LinkParams> {
+///       static constexpr auto kFields = std::make_tuple(
+///           Field("link.timeout_ms", &LinkParams::timeout_ms),
+///           Field("link.vcc", &LinkParams::vcc),
+///           Field("link.mode", &LinkParams::mode));
+///   };
+///   }  // namespace plas::core
+template <typename T>
+struct PropertyFields;
+
+/// A struct kept in step with a Properties session.
+///
+/// Keys are interned once, at construction. Refresh() compares the
+/// session's Version() (and that of every base it was forked from) with the
+/// last pass and, only if one moved, reads every field in one pass under
+/// the session's writer lock, so the struct never mixes two commits of the
+/// session. Between changes, reading the struct costs a few atomic loads
+/// instead of a key lookup and type check per field.
+///
+/// Arithmetic members are read with GetAs() (range-checked conversion, so
+/// an int64_t from a config file fills an int32_t), bool and other types
+/// need the exact stored type. A field whose key is missing or does not
+/// convert keeps its previous value (initially the struct's default) and
+/// is counted in MissingFields().
+///
+/// Not thread-safe: give each thread its own binding. The session must
+/// outlive the binding.
+template <typename T>
+class PropertyBinding {
+public:
+    explicit PropertyBinding(Properties& session, T initial = T{})
+        : session_(session), value_(std::move(initial)) {
+        InternKeys(std::make_index_sequence<kFieldCount>{});
+    }
+
+    /// Re-read the struct if the session changed. Returns true if it did.
+    bool Refresh() {
+        if (!Changed()) {
+            return false;
+        }
+        session_.Update([this](PropertyBatch&) {
+            // Versions first: a commit after this point shows up next time.
+            versions_.clear();
+            for (const auto* layer = &session_; layer; layer = layer->Base()) {
+                versions_.push_back(layer->Version());
+            }
+            missing_ = 0;
+            ReadFields(std::make_index_sequence<kFieldCount>{});
+        });
+        return true;
+    }
+
+    /// The struct, refreshed first if the session changed.
+    const T& Get() {
+        Refresh();
+        return value_;
+    }
+
+    /// The struct as of the last Refresh(), without checking the session.
+    const T& Cached() const { return value_; }
+
+    /// Fields left unread by the last refresh (missing key or wrong type).
+    std::size_t MissingFields() const { return missing_; }
+
+    /// Session Version() at the last refresh.
+    uint64_t Version() const { return versions_.empty() ? 0 : versions_.front(); }
+
+private:
+    static constexpr auto& kFields = PropertyFields<T>::kFields;
+    static constexpr std::size_t kFieldCount =
+        std::tuple_size_v<std::decay_t<decltype(PropertyFields<T>::kFields)>>;
+
+    template <std::size_t... I>
+    void InternKeys(std::index_sequence<I...>) {
+        ((keys_[I] = PropertyKey::Intern(std::get<I>(kFields).key)), ...);
+    }
+
+    template <std::size_t... I>
+    void ReadFields(std::index_sequence<I...>) {
+        (ReadField(keys_[I], value_.*(std::get<I>(kFields).member)), ...);
+    }
+
+    template <typename Member>
+    void ReadField(PropertyKey key, Member& member) {
+        auto read = [&] {
+            if constexpr (std::is_arithmetic_v<Member> && !std::is_same_v<Member, bool>) {
+                return session_.GetAs<Member>(key);
+            } else {
+                return session_.Get<Member>(key);
+            }
+        }();
+        if (read.IsOk()) {
+            member = std::move(read).Value();
+        } else {
+            ++missing_;
+        }
+    }
+
+    bool Changed() const {
+        if (versions_.empty()) {
+            return true;
+        }
+        std::size_t i = 0;
+        for (const auto* layer = &session_; layer; layer = layer->Base(), ++i) {
+            if (i == versions_.size() || layer->Version() != versions_[i]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Properties& session_;
+    T value_;
+    std::array<PropertyKey, kFieldCount> keys_;
+    std::vector<uint64_t> versions_;  ///< session first, then its bases
+    std::size_t missing_ = 0;
+};
+
+}  // namespace plas::core
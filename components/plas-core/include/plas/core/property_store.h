@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "plas/core/byte_buffer.h"
+#include "plas/core/result.h"
+
+namespace plas::core {
+
+/// Binary save/restore of Properties sessions.
+///
+/// Layout (native byte order): a fixed header (magic, format version,
+/// session count, payload size, FNV-1a of the payload), then per session
+/// a length-prefixed name and entry count, then per entry a length-prefixed
+/// key, a PropertyKind tag and either the 64-bit scalar or a
+/// length-prefixed string. Values of other (std::any) types cannot be
+/// serialized and are skipped.
+///
+/// Each session is encoded from a Snapshot(), so concurrent writers never
+/// produce a torn session.
+class PropertyStore {
+public:
+    static constexpr uint32_t kFormatVersion = 1;
+
+    /// Encode the named sessions, or every session when `sessions` is empty.
+    /// Names that do not exist are ignored.
+    static std::vector<uint8_t> Encode(const std::vector<std::string>& sessions = {});
+
+    /// Restore every session in `bytes`, replacing its current contents in
+    /// one commit. Nothing is applied unless the whole buffer is valid:
+    /// kDataLoss for a truncated or corrupt buffer, kNotSupported for
+    /// another format version. Returns the number of sessions restored.
+    static Result<size_t> Decode(ByteView bytes);
+
+    /// Encode to `path` atomically (write beside it, then rename).
+    static Result<void> Save(const std::string& path,
+                             const std::vector<std::string>& sessions = {});
+
+    /// Decode the file at `path`. kNotFound if it does not exist.
+    static Result<size_t> Load(const std::string& path);
+};
+
+/// Background thread that Save()s sessions every `interval`, skipping
+/// rounds in which no session's Version() changed. Stop() (and the
+/// destructor) writes a final checkpoint.
+class PropertyCheckpoint {
+public:
+    struct Options {
+        std::string path;
+        std::chrono::milliseconds interval{1000};
+        std::vector<std::string> sessions;  ///< empty = all sessions
+    };
+
+    PropertyCheckpoint() = default;
+    ~PropertyCheckpoint();
+
+    PropertyCheckpoint(const PropertyCheckpoint&) = delete;
+    PropertyCheckpoint& operator=(const PropertyCheckpoint&) = delete;
+
+    /// kInvalidArgument for an empty path or a zero interval, kAlreadyOpen
+    /// if running.
+    Result<void> Start(Options options);
+    void Stop();
+    bool IsRunning() const;
+
+    /// Checkpoint now if anything changed since the last one.
+    Result<void> Flush();
+
+    uint64_t SaveCount() const { return saves_.load(std::memory_order_relaxed); }
+    uint64_t FailureCount() const { return failures_.load(std::memory_order_relaxed); }
+
+private:
+    void Run();
+    Result<void> SaveIfChangedLocked();
+
+    Options options_;
+    mutable std::mutex mutex_;      // options_, stop_, thread_
+    std::mutex save_mutex_;         // serializes saves, guards last_state_
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread thread_;
+    std::vector<std::pair<std::string, uint64_t>> last_state_;
+    bool saved_once_ = false;
+    std::atomic<uint64_t> saves_{0};
+    std::atomic<uint64_t> failures_{0};
+};
+
+}  // namespace plas::core
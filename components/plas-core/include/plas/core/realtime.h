@@ -0,0 +1,169 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "plas/core/result.h"
+
+namespace plas::core {
+
+/// Cycle counter calibrated against std::chrono::steady_clock, for waits
+/// and timestamps that must not go through a system call: the invariant
+/// TSC on x86-64, CNTVCT_EL0 on arm64. Elsewhere, and on x86 CPUs without
+/// an invariant TSC, ticks are steady_clock nanoseconds.
+class TscClock {
+public:
+    /// The process-wide clock. The first call calibrates it by spinning
+    /// for about 10 ms.
+    static const TscClock& Get();
+
+    uint64_t Ticks() const {
+        if (hardware_) {
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+            return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+            uint64_t value;
+            asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+            return value;
+#endif
+        }
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+    }
+
+    uint64_t ToNs(uint64_t ticks) const {
+        return static_cast<uint64_t>(static_cast<double>(ticks) * ns_per_tick_);
+    }
+    uint64_t FromNs(uint64_t ns) const {
+        return static_cast<uint64_t>(static_cast<double>(ns) / ns_per_tick_);
+    }
+
+    /// Busy-wait until Ticks() reaches `ticks`, with a pause hint between
+    /// reads. Takes no lock and makes no system call on a hardware clock.
+    void SpinUntil(uint64_t ticks) const;
+
+    /// False when ticks come from steady_clock.
+    bool IsHardware() const { return hardware_; }
+    double TicksPerSecond() const { return 1e9 / ns_per_tick_; }
+
+private:
+    TscClock();
+
+    bool hardware_ = false;
+    double ns_per_tick_ = 1.0;
+};
+
+/// Settings EnterRealtime() applies to the calling thread.
+struct RealtimeOptions {
+    /// CPU to pin the thread to, ideally one kept free of other work
+    /// (isolcpus=/nohz_full=, see IsolatedCpus()). -1 leaves the affinity.
+    int cpu = -1;
+    /// SCHED_FIFO priority (clamped to 1..99); 0 keeps the normal scheduler.
+    /// Needs CAP_SYS_NICE or an RLIMIT_RTPRIO allowance.
+    int fifo_priority = 80;
+    /// Stack touched up front, so the critical section takes no stack page
+    /// faults.
+    std::size_t stack_prefault_bytes = 64 * 1024;
+};
+
+/// What a real-time section actually got; a refused setting is false
+/// rather than an error, so the caller can run anyway and report it.
+struct RealtimeStatus {
+    bool fifo = false;           ///< SCHED_FIFO in effect
+    bool pinned = false;         ///< affinity set to the requested CPU
+    bool isolated_cpu = false;   ///< that CPU is in IsolatedCpus()
+    bool memory_locked = false;  ///< the section's RealtimeArena is mlock'ed
+    bool hardware_clock = false; ///< TscClock reads a cycle counter
+};
+
+/// Apply `options` to the calling thread, which keeps them until it exits.
+/// Never fails: see the returned status for what took effect.
+RealtimeStatus EnterRealtime(const RealtimeOptions& options);
+
+/// CPUs the kernel keeps out of general scheduling
+/// (/sys/devices/system/cpu/isolated). Empty when there are none or the
+/// file cannot be read.
+std::vector<int> IsolatedCpus();
+
+/// Bump allocator over memory that is faulted in and, where the process
+/// may, mlock'ed when created, so allocating from it in a timing-critical
+/// section never takes a page fault, a lock or a system call. Allocations
+/// are released together by Reset() or destruction. Not thread-safe;
+/// move-only.
+class RealtimeArena {
+public:
+    RealtimeArena() = default;
+    ~RealtimeArena();
+
+    RealtimeArena(RealtimeArena&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          capacity_(std::exchange(other.capacity_, 0)),
+          used_(std::exchange(other.used_, 0)),
+          locked_(std::exchange(other.locked_, false)) {}
+    RealtimeArena& operator=(RealtimeArena&& other) noexcept;
+
+    RealtimeArena(const RealtimeArena&) = delete;
+    RealtimeArena& operator=(const RealtimeArena&) = delete;
+
+    /// At least `bytes` bytes (rounded up to whole pages). kInvalidArgument
+    /// for 0 bytes, kOutOfMemory if the mapping fails. If mlock is refused
+    /// (RLIMIT_MEMLOCK, no CAP_IPC_LOCK) the arena is still returned,
+    /// pre-faulted, with IsLocked() false.
+    static Result<RealtimeArena> Create(std::size_t bytes);
+
+    /// `bytes` bytes aligned to `align` (a power of two); nullptr if they
+    /// do not fit.
+    void* Allocate(std::size_t bytes, std::size_t align = alignof(std::max_align_t));
+
+    /// `count` value-initialized T; nullptr if they do not fit.
+    template <typename T>
+    T* AllocateArray(std::size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>,
+                      "arena memory is released without running destructors");
+        if (count > capacity_ / sizeof(T)) {
+            return nullptr;
+        }
+        auto* data = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        for (std::size_t i = 0; data != nullptr && i < count; ++i) {
+            ::new (static_cast<void*>(data + i)) T();
+        }
+        return data;
+    }
+
+    /// Drop every allocation; the pages stay mapped and locked.
+    void Reset() { used_ = 0; }
+
+    std::size_t Capacity() const { return capacity_; }
+    std::size_t Used() const { return used_; }
+    bool IsLocked() const { return locked_; }
+
+private:
+    unsigned char* data_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t used_ = 0;
+    bool locked_ = false;
+};
+
+/// Summary of how late a series of timed events fired, to report the
+/// determinism a real-time section achieved.
+struct JitterStats {
+    std::size_t samples = 0;
+    uint64_t min_ns = 0;
+    uint64_t max_ns = 0;
+    uint64_t mean_ns = 0;
+    uint64_t p99_ns = 0;
+
+    /// max_ns - min_ns: the spread of the lateness.
+    uint64_t SpreadNs() const { return max_ns - min_ns; }
+
+    static JitterStats FromSamples(std::vector<uint64_t> lateness_ns);
+};
+
+}  // namespace plas::core
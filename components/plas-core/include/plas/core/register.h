@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace plas::core {
+
+/// How software may access a register field.
+enum class FieldAccess : uint8_t {
+    kRO,    ///< read-only; Set() does not compile
+    kRW,    ///< read-write
+    kRW1C,  ///< write 1 to clear; never written back by a read-modify-write
+};
+
+/// A hardware register: its width (T = uint8_t .. uint64_t), its offset
+/// from the block it lives in, and the mask of its RW1C bits. Generated
+/// register maps (plas/hal/interface/pci/regs/) derive one struct per
+/// register from it and nest their fields as RegisterField aliases.
+template <typename T, uint64_t Offset, T W1cMask = 0>
+struct Register {
+    static_assert(std::is_unsigned_v<T> && !std::is_same_v<T, bool>,
+                  "registers are unsigned integers");
+    using ValueType = T;
+    static constexpr uint64_t kOffset = Offset;
+    static constexpr T kW1cMask = W1cMask;
+};
+
+/// Bits [Lsb, Lsb + Width) of register `Reg`, read and written as `V`
+/// (an unsigned integer, bool or enum). All members are constexpr shifts
+/// and masks.
+template <typename Reg, unsigned Lsb, unsigned Width,
+          FieldAccess Access = FieldAccess::kRW, typename V = bool>
+struct RegisterField {
+    using Register = Reg;
+    using RawType = typename Reg::ValueType;
+    using ValueType = V;
+    static_assert(Width > 0 && Lsb + Width <= sizeof(RawType) * 8,
+                  "field does not fit its register");
+    static_assert(!std::is_same_v<V, bool> || Width == 1,
+                  "bool fields are one bit wide");
+
+    static constexpr unsigned kLsb = Lsb;
+    static constexpr unsigned kWidth = Width;
+    static constexpr FieldAccess kAccess = Access;
+    static constexpr RawType kMask = static_cast<RawType>(
+        (Width == sizeof(RawType) * 8 ? ~RawType{0}
+                                      : static_cast<RawType>((RawType{1} << Width) - 1))
+        << Lsb);
+
+    static constexpr V Get(RawType raw) {
+        return static_cast<V>((raw & kMask) >> Lsb);
+    }
+
+    /// `raw` with this field replaced by `value` (truncated to the field).
+    static constexpr RawType Insert(RawType raw, V value) {
+        return static_cast<RawType>((raw & ~kMask) |
+                                    ((static_cast<RawType>(value) << Lsb) & kMask));
+    }
+};
+
+/// The value of one register as read or about to be written. Get<F>() and
+/// Set<F>() take fields of that register only, checked at compile time.
+///
+/// For a read-modify-write, ForWrite() drops every RW1C bit that was read
+/// as 1, so writing the value back clears only the RW1C fields explicitly
+/// Set() to 1 — the usual RMW bug on status registers cannot happen.
+template <typename Reg>
+class RegisterValue {
+public:
+    using Register = Reg;
+    using RawType = typename Reg::ValueType;
+
+    constexpr RegisterValue() = default;
+    constexpr explicit RegisterValue(RawType raw) : raw_(raw) {}
+
+    constexpr RawType Raw() const { return raw_; }
+
+    template <typename F>
+    constexpr typename F::ValueType Get() const {
+        static_assert(std::is_same_v<typename F::Register, Reg>,
+                      "field belongs to another register");
+        return F::Get(raw_);
+    }
+
+    template <typename F>
+    constexpr RegisterValue& Set(typename F::ValueType value) {
+        static_assert(std::is_same_v<typename F::Register, Reg>,
+                      "field belongs to another register");
+        static_assert(F::kAccess != FieldAccess::kRO, "field is read-only");
+        raw_ = F::Insert(raw_, value);
+        if constexpr (F::kAccess == FieldAccess::kRW1C) {
+            clear_ = F::Insert(clear_, value);
+        }
+        return *this;
+    }
+
+    /// The raw value to write: RW1C bits only where Set() asked for it.
+    constexpr RawType ForWrite() const {
+        return static_cast<RawType>((raw_ & ~Reg::kW1cMask) | clear_);
+    }
+
+    constexpr bool operator==(const RegisterValue& other) const {
+        return raw_ == other.raw_;
+    }
+    constexpr bool operator!=(const RegisterValue& other) const {
+        return raw_ != other.raw_;
+    }
+
+private:
+    RawType raw_ = 0;
+    RawType clear_ = 0;  // RW1C bits Set() to 1
+};
+
+}  // namespace plas::core
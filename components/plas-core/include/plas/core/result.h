@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <system_error>
 #include <type_traits>
 #include <utility>
@@ -10,86 +12,286 @@
 namespace plas::core {
 
 template <typename T>
-class Result {
+class Result;
+
+namespace detail {
+
+template <typename R>
+struct IsResult : std::false_type {};
+
+template <typename T>
+struct IsResult<Result<T>> : std::true_type {};
+
+/// Process-wide small index for an error category, so a compact Result
+/// stores 16 bits instead of a category pointer. 0 means "no error",
+/// kPlasCategory is PlasErrorCategory; other categories are numbered on
+/// first use. Once the table is full, further categories are recorded as
+/// ErrorCode::kUnknown.
+inline constexpr uint16_t kNoError = 0;
+inline constexpr uint16_t kPlasCategory = 1;
+
+uint16_t ErrorCategoryIndex(const std::error_category& category);
+const std::error_category& ErrorCategoryAt(uint16_t index);
+
+/// Index and value to store for `error`.
+inline std::pair<uint16_t, int32_t> PackError(std::error_code error) {
+    uint16_t index = ErrorCategoryIndex(error.category());
+    if (index == kNoError) {
+        return {kPlasCategory, static_cast<int32_t>(ErrorCode::kUnknown)};
+    }
+    return {index, error.value()};
+}
+
+/// Trivially copyable T of up to 8 bytes (DWord, Byte, size_t, enums,
+/// pointers) share storage with the error value, next to a 16-bit category
+/// index. Result<DWord> is 8 bytes and Result<uint64_t> 16, both trivially
+/// copyable, so they are returned in registers; the std::error_code is
+/// only built when Error() is called.
+template <typename T>
+inline constexpr bool kCompactResult =
+    std::is_trivially_copyable_v<T> && sizeof(T) <= 8 && alignof(T) <= 8;
+
+template <typename T>
+class CompactStorage {
 public:
-    static Result Ok(T value) {
-        return Result(std::variant<T, std::error_code>(std::in_place_index<0>, std::move(value)));
+    template <typename... Args>
+    explicit CompactStorage(std::in_place_t, Args&&... args)
+        : value_(std::forward<Args>(args)...), category_(kNoError) {}
+
+    explicit CompactStorage(ErrorCode code)
+        : error_(static_cast<int32_t>(code)), category_(kPlasCategory) {}
+
+    explicit CompactStorage(std::error_code error) {
+        auto [index, value] = PackError(error);
+        error_ = value;
+        category_ = index;
+    }
+
+    bool HasValue() const { return category_ == kNoError; }
+    T& Get() { return value_; }
+    const T& Get() const { return value_; }
+    std::error_code Error() const {
+        return {error_, ErrorCategoryAt(category_)};
+    }
+
+private:
+    union {
+        T value_;
+        int32_t error_;
+    };
+    uint16_t category_;
+};
+
+template <typename T>
+class VariantStorage {
+public:
+    template <typename... Args>
+    explicit VariantStorage(std::in_place_t, Args&&... args)
+        : storage_(std::in_place_index<0>, std::forward<Args>(args)...) {}
+
+    explicit VariantStorage(std::error_code error)
+        : storage_(std::in_place_index<1>, error) {}
+
+    explicit VariantStorage(ErrorCode code)
+        : VariantStorage(make_error_code(code)) {}
+
+    bool HasValue() const { return storage_.index() == 0; }
+    T& Get() { return std::get<0>(storage_); }
+    const T& Get() const { return std::get<0>(storage_); }
+    std::error_code Error() const { return std::get<1>(storage_); }
+
+private:
+    std::variant<T, std::error_code> storage_;
+};
+
+template <typename T>
+using ResultStorage = std::conditional_t<kCompactResult<T>, CompactStorage<T>,
+                                         VariantStorage<T>>;
+
+}  // namespace detail
+
+// Defined before the primary template, whose Map() returns Result<void>.
+template <>
+class Result<void> {
+public:
+    static Result Ok() {
+        return Result(detail::kNoError, 0);
     }
 
     static Result Err(std::error_code error) {
-        return Result(std::variant<T, std::error_code>(std::in_place_index<1>, error));
+        auto [index, value] = detail::PackError(error);
+        return Result(index, value);
     }
 
     static Result Err(ErrorCode code) {
-        return Err(make_error_code(code));
+        return Result(detail::kPlasCategory, static_cast<int32_t>(code));
     }
 
     bool IsOk() const {
-        return std::holds_alternative<T>(storage_);
+        return category_ == detail::kNoError;
     }
 
     bool IsError() const {
-        return std::holds_alternative<std::error_code>(storage_);
+        return category_ != detail::kNoError;
     }
 
-    T& Value() & {
-        return std::get<T>(storage_);
-    }
-
-    const T& Value() const& {
-        return std::get<T>(storage_);
+    std::error_code Error() const {
+        return {error_, detail::ErrorCategoryAt(category_)};
     }
 
-    T&& Value() && {
-        return std::get<T>(std::move(storage_));
+    /// `f()` (which returns a Result) if ok, else this error.
+    template <typename F>
+    [[nodiscard]] auto AndThen(F&& f) const {
+        using R = std::remove_cv_t<
+            std::remove_reference_t<std::invoke_result_t<F>>>;
+        static_assert(detail::IsResult<R>::value,
+                      "AndThen callback must return a Result");
+        if (IsError()) {
+            return R::Err(Error());
+        }
+        return std::invoke(std::forward<F>(f));
     }
 
-    std::error_code Error() const {
-        return std::get<std::error_code>(storage_);
+    /// Result<U> holding `f()` if ok, else this error.
+    template <typename F>
+    [[nodiscard]] auto Map(F&& f) const {
+        using U = std::remove_cv_t<
+            std::remove_reference_t<std::invoke_result_t<F>>>;
+        if (IsError()) {
+            return Result<U>::Err(Error());
+        }
+        if constexpr (std::is_void_v<U>) {
+            std::invoke(std::forward<F>(f));
+            return Result<void>::Ok();
+        } else {
+            return Result<U>::Emplace(std::invoke(std::forward<F>(f)));
+        }
     }
 
 private:
-    explicit Result(std::variant<T, std::error_code> storage)
-        : storage_(std::move(storage)) {}
+    Result(uint16_t category, int32_t error)
+        : error_(error), category_(category) {}
 
-    std::variant<T, std::error_code> storage_;
+    // Same layout as a compact Result<T>: 8 bytes, category 0 = ok.
+    int32_t error_;
+    uint16_t category_;
 };
 
-template <>
-class Result<void> {
+template <typename T>
+class Result {
 public:
-    static Result Ok() {
-        Result result;
-        result.storage_ = std::monostate{};
-        return result;
+    static Result Ok(T value) {
+        return Result(std::in_place, std::move(value));
+    }
+
+    /// Construct the value in place from `args`; a returned
+    /// `Result<T>::Emplace(...)` never copies or moves T.
+    template <typename... Args>
+    static Result Emplace(Args&&... args) {
+        return Result(std::in_place, std::forward<Args>(args)...);
     }
 
     static Result Err(std::error_code error) {
-        Result result;
-        result.storage_ = error;
-        return result;
+        return Result(error);
     }
 
     static Result Err(ErrorCode code) {
-        return Err(make_error_code(code));
+        return Result(code);
     }
 
     bool IsOk() const {
-        return std::holds_alternative<std::monostate>(storage_);
+        return storage_.HasValue();
     }
 
     bool IsError() const {
-        return std::holds_alternative<std::error_code>(storage_);
+        return !storage_.HasValue();
+    }
+
+    T& Value() & {
+        return storage_.Get();
+    }
+
+    const T& Value() const& {
+        return storage_.Get();
+    }
+
+    T&& Value() && {
+        return std::move(storage_.Get());
     }
 
     std::error_code Error() const {
-        return std::get<std::error_code>(storage_);
+        return storage_.Error();
+    }
+
+    /// `f(value)` (which returns a Result) if ok, else this error as the
+    /// same Result type. The value is passed by reference, or as an rvalue
+    /// from an rvalue Result.
+    template <typename F>
+    [[nodiscard]] auto AndThen(F&& f) & {
+        return AndThenImpl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    [[nodiscard]] auto AndThen(F&& f) const& {
+        return AndThenImpl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    [[nodiscard]] auto AndThen(F&& f) && {
+        return AndThenImpl(std::move(*this), std::forward<F>(f));
+    }
+
+    /// Result<U> holding `f(value)` if ok (Result<void> if f returns void),
+    /// else this error.
+    template <typename F>
+    [[nodiscard]] auto Map(F&& f) & {
+        return MapImpl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    [[nodiscard]] auto Map(F&& f) const& {
+        return MapImpl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    [[nodiscard]] auto Map(F&& f) && {
+        return MapImpl(std::move(*this), std::forward<F>(f));
     }
 
 private:
-    Result() = default;
+    template <typename... Args>
+    explicit Result(std::in_place_t, Args&&... args)
+        : storage_(std::in_place, std::forward<Args>(args)...) {}
+
+    explicit Result(std::error_code error) : storage_(error) {}
+    explicit Result(ErrorCode code) : storage_(code) {}
+
+    template <typename Self, typename F>
+    static auto AndThenImpl(Self&& self, F&& f) {
+        using R = std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<
+            F, decltype(std::forward<Self>(self).Value())>>>;
+        static_assert(detail::IsResult<R>::value,
+                      "AndThen callback must return a Result");
+        if (self.IsError()) {
+            return R::Err(self.Error());
+        }
+        return std::invoke(std::forward<F>(f),
+                           std::forward<Self>(self).Value());
+    }
+
+    template <typename Self, typename F>
+    static auto MapImpl(Self&& self, F&& f) {
+        using U = std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<
+            F, decltype(std::forward<Self>(self).Value())>>>;
+        if (self.IsError()) {
+            return Result<U>::Err(self.Error());
+        }
+        if constexpr (std::is_void_v<U>) {
+            std::invoke(std::forward<F>(f), std::forward<Self>(self).Value());
+            return Result<void>::Ok();
+        } else {
+            return Result<U>::Emplace(std::invoke(
+                std::forward<F>(f), std::forward<Self>(self).Value()));
+        }
+    }
 
-    std::variant<std::monostate, std::error_code> storage_;
+    detail::ResultStorage<T> storage_;
 };
 
 }  // namespace plas::core
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <system_error>
+#include <utility>
+
+#include "plas/core/error.h"
+
+namespace plas::core {
+
+/// When and how often to repeat a call that failed transiently.
+///
+/// Backoff before retry n (1-based) is initial_backoff * 2^(n-1), capped at
+/// max_backoff, then shortened by a random fraction of up to `jitter` so
+/// that callers failing together (a bus arbitration loss, a busy mailbox)
+/// do not retry in lockstep.
+struct RetryPolicy {
+    /// Attempts in total, the first included; 1 never retries.
+    uint32_t max_attempts = 1;
+    std::chrono::microseconds initial_backoff{100};
+    std::chrono::microseconds max_backoff{10000};
+    /// 0 = fixed backoff, 1 = anywhere in (0, backoff].
+    double jitter = 0.5;
+    /// ErrorCodes treated as transient, one bit (1 << code) each.
+    uint32_t retry_on = RetryMask({ErrorCode::kBusy, ErrorCode::kTimeout});
+
+    static constexpr uint32_t RetryMask(std::initializer_list<ErrorCode> codes) {
+        uint32_t mask = 0;
+        for (auto code : codes) {
+            mask |= 1u << static_cast<uint32_t>(code);
+        }
+        return mask;
+    }
+
+    bool Enabled() const { return max_attempts > 1; }
+
+    /// True if `error` is a plas ErrorCode in retry_on.
+    bool IsRetryable(const std::error_code& error) const;
+
+    /// Jittered backoff before retry `retry` (1-based).
+    std::chrono::microseconds Backoff(uint32_t retry) const;
+};
+
+/// What one RetryCall() did.
+struct RetryOutcome {
+    uint32_t attempts = 0;  ///< calls made, the first included
+    bool exhausted = false; ///< still transient after the last attempt
+    std::chrono::microseconds slept{0};
+};
+
+/// Sleep `delay`, unless the calling thread's core::Deadline passes first;
+/// then return false without sleeping.
+bool SleepForRetry(std::chrono::microseconds delay);
+
+/// Call `fn` until `transient(result)` is false or `policy.max_attempts`
+/// calls were made, sleeping Backoff() between them. Stops early, with the
+/// last result, when the next backoff would run past the caller's
+/// core::Deadline.
+///
+///   auto r = core::RetryCall(policy, [&] { return i2c.Read(addr, buf, n); },
+///                            [&](const auto& r) {
+///                                return r.IsError() && policy.IsRetryable(r.Error());
+///                            });
+template <typename Fn, typename Transient>
+auto RetryCall(const RetryPolicy& policy, Fn&& fn, Transient&& transient,
+               RetryOutcome* outcome = nullptr) -> decltype(fn()) {
+    RetryOutcome local;
+    auto& out = outcome ? *outcome : local;
+    out = RetryOutcome{};
+    auto result = fn();
+    out.attempts = 1;
+    while (transient(result)) {
+        if (out.attempts >= policy.max_attempts) {
+            out.exhausted = true;
+            break;
+        }
+        auto delay = policy.Backoff(out.attempts);
+        if (!SleepForRetry(delay)) {
+            out.exhausted = true;
+            break;
+        }
+        out.slept += delay;
+        result = fn();
+        ++out.attempts;
+    }
+    return result;
+}
+
+}  // namespace plas::core
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/core/properties.h"
+#include "plas/core/result.h"
+
+namespace plas::core {
+
+/// Properties session in a POSIX shared-memory region, so several processes
+/// read the same values without IPC. One process Create()s the region and
+/// is its writer; others Open() it read-only.
+///
+/// The region is a flat open-addressed table of fixed-size entries plus a
+/// string arena, guarded by one seqlock: readers retry while a write is in
+/// progress and never block the writer. Only scalar and std::string values
+/// can be stored. Keys are at most kMaxKeyLength bytes; removed keys keep
+/// their entry, so capacity bounds the number of distinct keys ever set.
+class SharedProperties {
+public:
+    static constexpr size_t kMaxKeyLength = 95;
+
+    struct Options {
+        uint32_t capacity = 1024;           ///< entries (distinct keys)
+        uint64_t string_bytes = 64 * 1024;  ///< arena for string values
+    };
+
+    /// Create region `name` (e.g. "/plas-tuning") and open it for writing.
+    /// kAlreadyOpen if it exists (Unlink() a stale one first),
+    /// kInvalidArgument for a zero capacity.
+    static Result<std::unique_ptr<SharedProperties>> Create(const std::string& name,
+                                                            Options options);
+    static Result<std::unique_ptr<SharedProperties>> Create(const std::string& name) {
+        return Create(name, Options{});
+    }
+
+    /// Map an existing region read-only. kNotFound if it does not exist,
+    /// kDataLoss if it is not a region of this format.
+    static Result<std::unique_ptr<SharedProperties>> Open(const std::string& name);
+
+    /// Remove the name; processes that mapped it keep their mapping.
+    static Result<void> Unlink(const std::string& name);
+
+    ~SharedProperties();
+
+    SharedProperties(const SharedProperties&) = delete;
+    SharedProperties& operator=(const SharedProperties&) = delete;
+
+    bool IsWriter() const;
+
+    // --- Writer (kPermissionDenied on a read-only mapping) ---
+
+    /// kInvalidArgument for an empty or too-long key, kResourceExhausted
+    /// when the table or the string arena is full.
+    template <typename T>
+    Result<void> Set(std::string_view key, T value);
+
+    Result<void> Remove(std::string_view key);
+
+    /// Apply every write of `batch` as one seqlock section (one Version()
+    /// step), so readers see all of it or none of it. Nothing is applied if
+    /// any write would fail.
+    Result<void> SetMany(const PropertyBatch& batch);
+
+    // --- Readers (any process) ---
+
+    template <typename T>
+    Result<T> Get(std::string_view key) const;
+
+    template <typename To>
+    Result<To> GetAs(std::string_view key) const;
+
+    bool Has(std::string_view key) const;
+    size_t Size() const;
+    std::vector<std::string> Keys() const;
+
+    /// Odd while the writer is updating, even otherwise.
+    uint64_t Version() const;
+
+private:
+    struct Impl;
+    explicit SharedProperties(std::unique_ptr<Impl> impl);
+
+    /// Consistent copy of `key`'s value; `text` is filled for strings.
+    bool Read(std::string_view key, detail::PropertyKind& kind, uint64_t& bits,
+              std::string& text) const;
+
+    Result<void> Write(const detail::PropertyWrite* writes, size_t count);
+
+    std::unique_ptr<Impl> impl_;
+};
+
+// --- Template implementations ---
+
+template <typename T>
+Result<void> SharedProperties::Set(std::string_view key, T value) {
+    static_assert(detail::PropertyKindOf<T>::value != detail::PropertyKind::kOther,
+                  "SharedProperties stores scalars and std::string only");
+    auto write = detail::EncodeProperty(PropertyKey::Intern(key), std::move(value));
+    return Write(&write, 1);
+}
+
+template <typename T>
+Result<T> SharedProperties::Get(std::string_view key) const {
+    constexpr auto kind = detail::PropertyKindOf<T>::value;
+    static_assert(kind != detail::PropertyKind::kOther,
+                  "SharedProperties stores scalars and std::string only");
+
+    detail::PropertyKind stored;
+    uint64_t bits = 0;
+    std::string text;
+    if (!Read(key, stored, bits, text)) {
+        return Result<T>::Err(ErrorCode::kNotFound);
+    }
+    if (stored != kind) {
+        return Result<T>::Err(ErrorCode::kTypeMismatch);
+    }
+    if constexpr (kind == detail::PropertyKind::kString) {
+        return Result<T>::Ok(std::move(text));
+    } else {
+        return Result<T>::Ok(detail::FromBits<T>(bits));
+    }
+}
+
+template <typename To>
+Result<To> SharedProperties::GetAs(std::string_view key) const {
+    static_assert(std::is_arithmetic_v<To>,
+                  "GetAs<To> requires To to be an arithmetic type");
+
+    detail::PropertyKind stored;
+    uint64_t bits = 0;
+    std::string text;
+    if (!Read(key, stored, bits, text)) {
+        return Result<To>::Err(ErrorCode::kNotFound);
+    }
+    To out{};
+    if (detail::ConvertNumeric<To>(stored, bits, out)) {
+        return Result<To>::Ok(out);
+    }
+    return Result<To>::Err(ErrorCode::kTypeMismatch);
+}
+
+}  // namespace plas::core
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "plas/core/result.h"
+
+namespace plas::core {
+
+/// Cache line size the rings pad their positions to, so a producer and a
+/// consumer never write the same line.
+inline constexpr std::size_t kCacheLineSize = 64;
+
+namespace detail {
+
+inline std::size_t RoundUpPow2(std::size_t n) {
+    std::size_t capacity = 1;
+    while (capacity < n) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+/// Producer side of an SPSC ring. `cached_tail` is the consumer position
+/// as last seen; the producer reads the consumer's line only when that
+/// copy says the ring is too full.
+struct alignas(kCacheLineSize) SpscProducerLine {
+    std::atomic<uint64_t> head{0};  // next write
+    uint64_t cached_tail = 0;
+    std::atomic<uint64_t> dropped{0};
+};
+
+/// Consumer side, same idea with `cached_head`.
+struct alignas(kCacheLineSize) SpscConsumerLine {
+    std::atomic<uint64_t> tail{0};  // next read
+    uint64_t cached_head = 0;
+};
+
+struct SpscControl {
+    SpscProducerLine producer;
+    SpscConsumerLine consumer;
+};
+
+template <typename T>
+std::size_t SpscPush(SpscControl& control, T* slots, std::size_t capacity,
+                     const T* items, std::size_t count) {
+    auto& p = control.producer;
+    auto head = p.head.load(std::memory_order_relaxed);
+    std::size_t free = capacity - static_cast<std::size_t>(head - p.cached_tail);
+    if (free < count) {
+        p.cached_tail = control.consumer.tail.load(std::memory_order_acquire);
+        free = capacity - static_cast<std::size_t>(head - p.cached_tail);
+    }
+    std::size_t n = std::min(count, free);
+    if (n != 0) {
+        // At most two runs: up to the end of the slots, then from the start.
+        std::size_t first = static_cast<std::size_t>(head) & (capacity - 1);
+        std::size_t run = std::min(n, capacity - first);
+        std::copy_n(items, run, slots + first);
+        std::copy_n(items + run, n - run, slots);
+        p.head.store(head + n, std::memory_order_release);
+    }
+    if (n < count) {
+        p.dropped.fetch_add(count - n, std::memory_order_relaxed);
+    }
+    return n;
+}
+
+template <typename T>
+std::size_t SpscPop(SpscControl& control, T* slots, std::size_t capacity, T* out,
+                    std::size_t max) {
+    auto& c = control.consumer;
+    auto tail = c.tail.load(std::memory_order_relaxed);
+    std::size_t available = static_cast<std::size_t>(c.cached_head - tail);
+    if (available < max) {
+        c.cached_head = control.producer.head.load(std::memory_order_acquire);
+        available = static_cast<std::size_t>(c.cached_head - tail);
+    }
+    std::size_t n = std::min(max, available);
+    if (n != 0) {
+        std::size_t first = static_cast<std::size_t>(tail) & (capacity - 1);
+        std::size_t run = std::min(n, capacity - first);
+        std::move(slots + first, slots + first + run, out);
+        std::move(slots, slots + (n - run), out + run);
+        c.tail.store(tail + n, std::memory_order_release);
+    }
+    return n;
+}
+
+inline std::size_t SpscSize(const SpscControl& control) {
+    auto tail = control.consumer.tail.load(std::memory_order_acquire);
+    auto head = control.producer.head.load(std::memory_order_acquire);
+    return static_cast<std::size_t>(head - tail);
+}
+
+}  // namespace detail
+
+/// Bounded single-producer/single-consumer ring. One thread pushes, one
+/// thread pops; neither blocks. When the ring is full the newest entries
+/// are dropped and counted, so a slow consumer loses data but never stalls
+/// the producer.
+///
+/// Head and tail sit on separate cache lines, each next to a cached copy
+/// of the other, so a side touches the other's line only when its copy
+/// says the ring is full (producer) or empty (consumer). Batch Push/Pop
+/// copy in at most two contiguous runs and publish once.
+template <typename T>
+class SpscRing {
+public:
+    /// `capacity` is rounded up to a power of two (at least 1).
+    explicit SpscRing(std::size_t capacity)
+        : slots_(detail::RoundUpPow2(capacity)) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    std::size_t Capacity() const { return slots_.size(); }
+
+    std::size_t Size() const { return detail::SpscSize(control_); }
+
+    /// Producer: copy up to `count` entries in; returns how many fit.
+    std::size_t Push(const T* items, std::size_t count) {
+        return detail::SpscPush(control_, slots_.data(), slots_.size(), items, count);
+    }
+
+    bool Push(const T& item) { return Push(&item, 1) == 1; }
+
+    /// Consumer: move up to `max` of the oldest entries into `out`.
+    std::size_t Pop(T* out, std::size_t max) {
+        return detail::SpscPop(control_, slots_.data(), slots_.size(), out, max);
+    }
+
+    /// Entries Push() could not store.
+    uint64_t Dropped() const {
+        return control_.producer.dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<T> slots_;
+    detail::SpscControl control_;
+};
+
+/// SpscRing laid out in caller-provided memory (a shared mapping, a
+/// hugepage, a device window), so the producer and consumer may live in
+/// different processes. The memory holds a header, the SpscRing control
+/// lines and the slots inline; nothing points outside it, so each process
+/// may map it at a different address. T must be trivially copyable and the
+/// memory aligned to kCacheLineSize (any mmap() is).
+///
+/// One side calls Create(), the other Attach() once Create() returned
+/// (the handshake is the caller's). The view does not own the memory.
+template <typename T>
+class SharedSpscRing {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "SharedSpscRing slots are copied as raw memory");
+    static_assert(alignof(T) <= kCacheLineSize, "slot alignment above a cache line");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                  "shared ring positions need lock-free 64-bit atomics");
+
+public:
+    static constexpr uint32_t kMagic = 0x474E5253;  // "SRNG"
+    static constexpr uint32_t kVersion = 1;
+
+    /// Bytes Create() needs for `capacity` (rounded up to a power of two).
+    static std::size_t BytesFor(std::size_t capacity) {
+        return sizeof(Layout) + detail::RoundUpPow2(capacity) * sizeof(T);
+    }
+
+    /// Initialize an empty ring in `memory`. kInvalidArgument for null or
+    /// misaligned memory, kOutOfRange when `bytes` < BytesFor(capacity).
+    static Result<SharedSpscRing> Create(void* memory, std::size_t bytes,
+                                         std::size_t capacity) {
+        if (!Aligned(memory)) {
+            return Result<SharedSpscRing>::Err(ErrorCode::kInvalidArgument);
+        }
+        if (bytes < BytesFor(capacity)) {
+            return Result<SharedSpscRing>::Err(ErrorCode::kOutOfRange);
+        }
+        auto* layout = new (memory) Layout();
+        layout->capacity = detail::RoundUpPow2(capacity);
+        layout->slot_size = sizeof(T);
+        layout->version = kVersion;
+        layout->magic = kMagic;
+        return Result<SharedSpscRing>::Ok(SharedSpscRing(layout));
+    }
+
+    /// View a ring another process created. kInvalidArgument for null or
+    /// misaligned memory; kDataLoss when the header is not a version-1
+    /// ring of this T, or claims more than `bytes`.
+    static Result<SharedSpscRing> Attach(void* memory, std::size_t bytes) {
+        if (!Aligned(memory)) {
+            return Result<SharedSpscRing>::Err(ErrorCode::kInvalidArgument);
+        }
+        if (bytes < sizeof(Layout)) {
+            return Result<SharedSpscRing>::Err(ErrorCode::kDataLoss);
+        }
+        auto* layout = std::launder(reinterpret_cast<Layout*>(memory));
+        uint64_t capacity = layout->capacity;
+        if (layout->magic != kMagic || layout->version != kVersion ||
+            layout->slot_size != sizeof(T) || capacity == 0 ||
+            (capacity & (capacity - 1)) != 0 ||
+            capacity > (bytes - sizeof(Layout)) / sizeof(T)) {
+            return Result<SharedSpscRing>::Err(ErrorCode::kDataLoss);
+        }
+        return Result<SharedSpscRing>::Ok(SharedSpscRing(layout));
+    }
+
+    std::size_t Capacity() const { return static_cast<std::size_t>(layout_->capacity); }
+
+    std::size_t Size() const { return detail::SpscSize(layout_->control); }
+
+    /// Producer: copy up to `count` entries in; returns how many fit.
+    std::size_t Push(const T* items, std::size_t count) {
+        return detail::SpscPush(layout_->control, Slots(), Capacity(), items, count);
+    }
+
+    bool Push(const T& item) { return Push(&item, 1) == 1; }
+
+    /// Consumer: copy up to `max` of the oldest entries into `out`.
+    std::size_t Pop(T* out, std::size_t max) {
+        return detail::SpscPop(layout_->control, Slots(), Capacity(), out, max);
+    }
+
+    /// Entries Push() could not store.
+    uint64_t Dropped() const {
+        return layout_->control.producer.dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct alignas(kCacheLineSize) Layout {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint64_t capacity = 0;
+        uint64_t slot_size = 0;
+        detail::SpscControl control;
+    };
+
+    explicit SharedSpscRing(Layout* layout) : layout_(layout) {}
+
+    static bool Aligned(const void* memory) {
+        return memory != nullptr &&
+               reinterpret_cast<std::uintptr_t>(memory) % kCacheLineSize == 0;
+    }
+
+    T* Slots() const {
+        return reinterpret_cast<T*>(reinterpret_cast<unsigned char*>(layout_) +
+                                    sizeof(Layout));
+    }
+
+    Layout* layout_;
+};
+
+}  // namespace plas::core
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/core/result.h"
+
+namespace plas::hal {
+
+/// Outcome of a group operation on one member, see
+/// DeviceManager::ForEachInGroup().
+template <typename R>
+struct GroupOpResult {
+    std::string nickname;
+    core::Result<R> result;
+};
+
+/// Per-member outcomes of a group operation, in name order. Members that
+/// do not implement the operation's interface are not listed.
+template <typename R>
+struct GroupResult {
+    std::vector<GroupOpResult<R>> devices;
+
+    std::size_t FailedCount() const {
+        std::size_t failed = 0;
+        for (const auto& device : devices) {
+            if (device.result.IsError()) ++failed;
+        }
+        return failed;
+    }
+
+    bool AllOk() const { return FailedCount() == 0; }
+
+    /// Ok, or the error of the first member (in name order) that failed.
+    core::Result<void> Status() const {
+        for (const auto& device : devices) {
+            if (device.result.IsError()) {
+                return core::Result<void>::Err(device.result.Error());
+            }
+        }
+        return core::Result<void>::Ok();
+    }
+};
+
+namespace detail {
+
+template <typename R>
+struct GroupOpValue {};
+
+template <typename R>
+struct GroupOpValue<core::Result<R>> {
+    using type = R;
+};
+
+}  // namespace detail
+
+}  // namespace plas::hal
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace plas::hal {
+
+class Device;
+
+/// What lookups do while DeviceManager's health supervisor reconnects the
+/// device they name.
+enum class ReconnectPolicy {
+    kFailFast,  // return the device at once; its calls fail until it is back
+    kWait,      // block the lookup until reconnected, wait_timeout or the
+                // caller's core::Deadline passes
+};
+
+/// DeviceManager::StartHealthSupervisor() settings.
+struct HealthSupervisorOptions {
+    /// How often every open device is probed.
+    std::chrono::milliseconds probe_interval{1000};
+
+    /// Delay before the first reconnect attempt of an outage; doubled after
+    /// each failed attempt up to max_backoff.
+    std::chrono::milliseconds initial_backoff{100};
+    std::chrono::milliseconds max_backoff{30000};
+
+    ReconnectPolicy policy = ReconnectPolicy::kFailFast;
+    std::chrono::milliseconds wait_timeout{5000};  // kWait only
+
+    /// Liveness check for an open device, run on an executor thread while
+    /// the device's open/close lock is held. Must be cheap and must not call
+    /// back into DeviceManager lookups. Unset: a device is unhealthy only
+    /// once it reports DeviceState::kError.
+    std::function<bool(Device&)> probe;
+};
+
+/// Outage counters of one device, see DeviceManager::GetHealthReport().
+struct DeviceHealth {
+    std::string nickname;
+    bool reconnecting = false;        // currently down
+    uint64_t disconnects = 0;         // outages detected
+    uint64_t reconnects = 0;          // outages ended by a reconnect
+    uint64_t failed_attempts = 0;     // reconnect attempts that failed
+    std::chrono::nanoseconds downtime{0};        // total, including a current outage
+    std::chrono::nanoseconds longest_outage{0};  // finished outages only
+};
+
+}  // namespace plas::hal
@@ -1,26 +1,66 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <set>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "plas/config/config.h"
+#include "plas/config/config_diff.h"
 #include "plas/config/config_format.h"
 #include "plas/config/config_node.h"
 #include "plas/config/device_entry.h"
+#include "plas/core/executor.h"
+#include "plas/core/lock_stats.h"
 #include "plas/core/result.h"
+#include "plas/hal/device_group.h"
+#include "plas/hal/device_health.h"
+#include "plas/hal/device_memory.h"
 #include "plas/hal/interface/device.h"
 #include "plas/hal/interface/device_factory.h"
+#include "plas/hal/interface/interface_kind.h"
+#include "plas/hal/interceptor.h"
+#include "plas/hal/interface/pci/pci_hotplug.h"
+#include "plas/hal/metrics.h"
+#include "plas/hal/read_coalescing.h"
 
 namespace plas::hal {
 
+template <typename T>
+class DeviceHandle;
+
+/// Registry of configured devices, keyed by nickname.
+///
+/// Lookups (GetDevice, GetDeviceByUri, GetInterface, GetDevicesByInterface,
+/// DeviceNames, HasDevice, DeviceCount) take no lock: they read an immutable
+/// snapshot of the registry. AddDevice/LoadFrom* build a new snapshot under
+/// the writer mutex and publish it atomically. A lookup pins the snapshot it
+/// reads with an epoch guard, and a publish frees the superseded snapshots
+/// no guard can still see. Devices replaced by ApplyDiff are kept until
+/// Reset(), which must not race with lookups (it destroys the devices).
+///
+/// GetInstance() is the process-wide registry. A DeviceManager constructed
+/// directly is a separate registry with its own devices, health
+/// supervisor, hotplug monitor and idle reaper, so independent device sets
+/// (one per tenant of a test farm) can load and run side by side. Metrics
+/// stay process-wide: MetricsRegistry keys them by nickname.
 class DeviceManager {
 public:
     static DeviceManager& GetInstance();
 
+    DeviceManager();
+    ~DeviceManager();
+
     core::Result<void> LoadFromConfig(
         const std::string& path,
         config::ConfigFormat fmt = config::ConfigFormat::kAuto);
@@ -35,55 +75,640 @@ public:
     core::Result<void> LoadFromEntries(
         const std::vector<config::DeviceEntry>& entries);
 
+    /// Same as LoadFromEntries, from an arena-backed table
+    /// (config::Config::LoadDeviceTable). LoadFromConfig(path) uses this.
+    core::Result<void> LoadFromTable(const config::DeviceTable& table);
+
+    /// Same as LoadFromConfig(path), but each device is created while the
+    /// file is still being parsed (config::Config::StreamFromFile), so no
+    /// document tree or device list is held. Lookups see the new devices
+    /// once the stream ends, as with LoadFromEntries.
+    core::Result<void> StreamFromConfig(
+        const std::string& path,
+        config::ConfigFormat fmt = config::ConfigFormat::kAuto);
+
     core::Result<void> AddDevice(const std::string& nickname,
                                   std::unique_ptr<Device> device);
 
+    /// AddDevice() for a device created from `entry`, which is remembered
+    /// for LoadedEntries()/ApplyDiff() like the LoadFrom* devices.
+    core::Result<void> AddDevice(const config::DeviceEntry& entry,
+                                  std::unique_ptr<Device> device);
+
+    /// AddDevice(entry, device) for each pair, published as one snapshot
+    /// rather than one per device (each is kept until Reset(), so adding
+    /// devices one at a time costs O(n^2) time and memory). One result per
+    /// pair, in order: kAlreadyOpen for a nickname that is taken, also by
+    /// an earlier pair; that device is destroyed.
+    std::vector<core::Result<void>> AddDevices(
+        std::vector<std::pair<config::DeviceEntry, std::unique_ptr<Device>>> devices);
+
+    // -- Reload ----------------------------------------------------------------
+    //
+    // Devices created by LoadFrom*/StreamFromConfig remember the entry they
+    // came from, so a changed config can be applied without a Reset():
+    //
+    //   auto diff = config::DiffDevices(dm.LoadedEntries(), updated);
+    //   dm.ApplyDiff(diff);
+    //
+    // Only added, changed and removed devices are touched; the others keep
+    // their state (open, lazily opened, hot-removed) and their pointers.
+
+    /// Entries of the config-loaded devices, in name order. Devices added
+    /// with AddDevice(nickname, device) are not listed.
+    std::vector<config::DeviceEntry> LoadedEntries() const;
+
+    /// Create `added` and `changed`, then close and retire the old devices of
+    /// `changed` and `removed` and publish the result in one snapshot. New
+    /// devices are not opened (see Bootstrap::Reload). Retired devices stay
+    /// allocated until Reset() so in-flight lookups remain safe, but their
+    /// DeviceHandles become stale. All-or-nothing: kAlreadyOpen if an added
+    /// nickname exists, kNotFound if a changed/removed one was not loaded
+    /// from config, or the factory error; the registry is then unchanged.
+    core::Result<void> ApplyDiff(const config::DeviceDiff& diff);
+
     Device* GetDevice(const std::string& nickname);
     Device* GetDeviceByUri(const std::string& uri);
 
+    /// GetDevice() without lazy open or use tracking (for diagnostics).
+    Device* PeekDevice(const std::string& nickname);
+
+    /// For the built-in interfaces (see InterfaceKind) this is a table
+    /// lookup resolved at AddDevice time through Device::QueryInterface;
+    /// other types fall back to dynamic_cast.
     template <typename T>
     T* GetInterface(const std::string& nickname);
 
     template <typename T>
     std::vector<std::pair<std::string, T*>> GetDevicesByInterface();
 
+    /// Call fn(nickname, T*) for every device implementing T, in name order,
+    /// without allocating. Built-in interfaces only.
+    template <typename T, typename Fn>
+    void ForEachInterface(Fn&& fn);
+
+    /// Resolve `nickname` once into a DeviceHandle for hot paths. Empty
+    /// handle if the device is missing or lacks T. Built-in interfaces only.
+    template <typename T>
+    DeviceHandle<T> GetHandle(const std::string& nickname);
+
+    /// Incremented by every Reset(); DeviceHandles from an older generation
+    /// are stale.
+    uint64_t Generation() const {
+        return generation_.load(std::memory_order_acquire);
+    }
+
     std::vector<std::string> DeviceNames() const;
     bool HasDevice(const std::string& nickname) const;
     std::size_t DeviceCount() const;
 
+    // -- Groups --------------------------------------------------------------
+    //
+    // A config-loaded device joins the groups listed in its `group` arg
+    // (config::kGroupArg, comma separated); AddToGroup() adds any device at
+    // runtime. Membership follows the device through ApplyDiff: a changed
+    // entry takes its new `group` arg, AddToGroup() memberships are kept by
+    // nickname until Reset().
+
+    /// kNotFound if no device is named `nickname`, kInvalidArgument for an
+    /// empty group name.
+    core::Result<void> AddToGroup(const std::string& group, const std::string& nickname);
+
+    /// Groups with at least one member, in name order.
+    std::vector<std::string> GroupNames() const;
+
+    /// Members of `group` in name order; empty if there is no such group.
+    std::vector<std::string> GroupMembers(const std::string& group) const;
+
+    /// Call fn(T&) for every member of `group` implementing T, in parallel
+    /// on core::Executor::Shared() (the caller works too; at most
+    /// `max_parallel` threads, 0 = no limit), and collect each member's
+    /// result. fn returns a core::Result and must be safe to call
+    /// concurrently for different devices. Members are opened lazily first
+    /// if lazy open is on, and follow the health supervisor's reconnect
+    /// policy. The caller's core::Deadline applies to every call. kNotFound
+    /// if the group has no members.
+    ///
+    ///   auto r = dm.ForEachInGroup<PowerControl>("rack3", [](PowerControl& p) {
+    ///       return p.PowerOn();
+    ///   });
+    template <typename T, typename Fn>
+    auto ForEachInGroup(const std::string& group, Fn&& fn, std::size_t max_parallel = 0)
+        -> core::Result<GroupResult<
+            typename detail::GroupOpValue<std::invoke_result_t<Fn&, T&>>::type>>;
+
+    // -- Read coalescing -----------------------------------------------------
+    //
+    // Concurrent identical reads of a device share one hardware transaction:
+    // I2c Read/WriteRead, SmBus command reads, PciConfig reads and read-only
+    // CxlMailbox commands (see ReadCoalescer), for devices several threads
+    // poll (a temperature sensor, CXL health info). With a freshness window
+    // a read completed less than that long ago is reused as well; writes
+    // through the device drop the shared results. Opt-in per device, by the
+    // `coalesce_reads_us` arg (config::kCoalesceReadsArg) or
+    // EnableReadCoalescing(), and only for devices whose reads have no side
+    // effects. GetInterface/GetDevicesByInterface/ForEachInterface/GetHandle
+    // then return the coalescing wrappers; handles resolved before keep the
+    // device's own interface.
+
+    /// Coalesce the reads of `nickname`, overriding its config arg. Kept by
+    /// nickname through ApplyDiff until Reset(). kNotFound if no device is
+    /// named `nickname`, kInvalidArgument for a negative freshness.
+    core::Result<void> EnableReadCoalescing(const std::string& nickname,
+                                            const ReadCoalescingOptions& options = {});
+
+    /// Stop coalescing `nickname`, whatever its config arg says. kNotFound
+    /// as EnableReadCoalescing().
+    core::Result<void> DisableReadCoalescing(const std::string& nickname);
+
+    bool IsReadCoalescing(const std::string& nickname) const;
+
+    /// kNotFound if the device is unknown or not coalescing.
+    core::Result<ReadCoalescingStats> GetReadCoalescingStats(
+        const std::string& nickname) const;
+
+    // -- Interceptors --------------------------------------------------------
+    //
+    // A device's I2c, PciConfig, PciDoe, PciBar and PowerControl interfaces
+    // can be wrapped in a chain of interceptors (see InterceptorRegistry:
+    // "metrics", "trace" or registered ones), named outermost first by the
+    // `interceptors` arg (config::kInterceptorsArg, comma separated) or
+    // SetInterceptors(). A `retry_attempts` arg (config::kRetryAttemptsArg)
+    // adds "retry" innermost unless the arg list names it. The chain sits
+    // outside read coalescing.
+    // GetInterface/GetDevicesByInterface/ForEachInterface/GetHandle then
+    // return the outermost wrappers; handles resolved before keep what they
+    // had. A device without interceptors hands out its own interfaces, so
+    // leaving one out of the list costs nothing.
+
+    /// Wrap `nickname` in `names`, overriding its config arg; an empty list
+    /// removes every interceptor. Kept by nickname through ApplyDiff until
+    /// Reset(). kNotFound if no device is named `nickname`,
+    /// kInvalidArgument if a name has no interceptor.
+    core::Result<void> SetInterceptors(const std::string& nickname,
+                                       const std::vector<std::string>& names);
+
+    /// Interceptors wrapping `nickname`, outermost first. Empty if none or
+    /// the device is unknown.
+    std::vector<std::string> GetInterceptors(const std::string& nickname) const;
+
+    // -- Lazy open -----------------------------------------------------------
+    //
+    // With lazy open enabled, GetDevice/GetDeviceByUri/GetInterface/
+    // GetDevicesByInterface run Init()+Open() on a device the first time it
+    // is requested (once per device, even under concurrent callers). Failures
+    // are logged and retried on the next request; the device is returned in
+    // whatever state it reached.
+    //
+    // With an idle timeout, devices opened this way are closed again once no
+    // lookup has touched them for that long, and reopened on the next lookup.
+    // Callers must then fetch the device per use instead of caching the
+    // pointer across idle periods, and the timeout must exceed the longest
+    // single operation.
+
+    void SetLazyOpen(bool enabled);
+    bool IsLazyOpen() const;
+
+    /// 0 disables idle-close (default).
+    void SetIdleCloseTimeout(std::chrono::milliseconds timeout);
+    std::chrono::milliseconds GetIdleCloseTimeout() const;
+
+    /// Close lazily opened devices idle for at least the timeout. Runs
+    /// periodically once a timeout is set; returns the number closed.
+    std::size_t CloseIdleDevices();
+
+    // -- PCI hotplug ---------------------------------------------------------
+    //
+    // Devices whose URI names a PCI function ("<scheme>://DDDD:BB:DD.F", as
+    // pciutils:// does) follow hotplug events. On removal an open device is
+    // closed and marked removed; lazy open skips removed devices instead of
+    // retrying Open() on a missing function. When the function is added
+    // back, a device that was open is reopened (lazily opened ones wait for
+    // the next lookup) and the mark is cleared.
+
+    /// Start a PciHotplugMonitor that feeds HandlePciHotplug(). Errors as
+    /// PciHotplugMonitor::Start().
+    core::Result<void> StartPciHotplugMonitor();
+    void StopPciHotplugMonitor();
+    bool IsPciHotplugMonitorRunning() const;
+
+    /// Apply one event (from the monitor, or forwarded by the caller).
+    /// Returns the number of devices closed or reopened.
+    std::size_t HandlePciHotplug(const pci::PciHotplugEvent& event);
+
+    /// True if the device's PCI function was hot-removed and has not come
+    /// back.
+    bool IsDeviceRemoved(const std::string& nickname) const;
+
+    // -- Health supervision --------------------------------------------------
+    //
+    // Every probe_interval the supervisor (a timer on core::Executor::Shared())
+    // probes each open device. A device that fails the probe or reports
+    // kError is reconnected in the background: Reset(), Init() if needed,
+    // Open(), probe again, retried with exponential backoff until it
+    // succeeds. Lookups of a device being reconnected follow the
+    // ReconnectPolicy. Devices that are closed, never opened, hot-removed or
+    // retired are not touched.
+
+    /// Start the supervisor, or restart it with new options.
+    /// kInvalidArgument for a non-positive probe_interval or backoff.
+    core::Result<void> StartHealthSupervisor(const HealthSupervisorOptions& options = {});
+    void StopHealthSupervisor();
+    bool IsHealthSupervisorRunning() const;
+
+    /// One probe/reconnect pass now, as the supervisor runs it on each tick,
+    /// with the options of the last StartHealthSupervisor() (defaults
+    /// before that). Returns the number of devices reconnected.
+    std::size_t CheckDeviceHealth();
+
+    /// Outage counters of every device, in name order.
+    std::vector<DeviceHealth> GetHealthReport() const;
+
+    // -- Memory accounting ---------------------------------------------------
+
+    /// Estimated memory per device and per subsystem (see MemoryReport).
+    /// Takes the writer lock and calls every device's MemoryUsage(), so do
+    /// not call it from a hot path.
+    MemoryReport GetMemoryReport() const;
+
+    /// Enable/disable driver metrics collection (MetricsRegistry).
+    void SetMetricsEnabled(bool enabled);
+    bool IsMetricsEnabled() const;
+
+    /// Latency/throughput counters of the managed devices, plus the
+    /// process-wide lock counters in PLAS_LOCK_STATS builds.
+    MetricsSnapshot GetMetricsSnapshot() const;
+    void ResetMetrics();
+
     void Reset();
 
     DeviceManager(const DeviceManager&) = delete;
     DeviceManager& operator=(const DeviceManager&) = delete;
 
 private:
-    DeviceManager() = default;
-    ~DeviceManager() = default;
+    template <typename T>
+    friend class DeviceHandle;
+
+    /// Per-device lazy-open bookkeeping.
+    struct LazyState {
+        Device* device = nullptr;  // set by InsertLocked, never changed
+        std::string name;
+
+        std::mutex mutex;  // serializes Init/Open/idle Close of the device
+        std::atomic<std::chrono::steady_clock::rep> last_use{0};
+        std::atomic<bool> opened_lazily{false};
+        std::atomic<bool> removed{false};  // PCI function hot-removed
+        std::atomic<bool> retired{false};  // replaced/removed by ApplyDiff
+        bool reopen_on_add = false;        // guarded by mutex
+
+        // Health supervision. `reconnecting` is written under health_mutex
+        // (waiters sleep on `reconnected`); the rest is guarded by
+        // health_mutex and changed only by CheckDeviceHealth().
+        std::atomic<bool> reconnecting{false};
+        std::mutex health_mutex;
+        std::condition_variable reconnected;
+        std::chrono::steady_clock::time_point down_since;
+        std::chrono::steady_clock::time_point next_attempt;
+        std::chrono::milliseconds backoff{0};
+        DeviceHealth health;
+    };
 
+    /// Interface pointers of one device, indexed by InterfaceKind; null where
+    /// the device does not implement the interface. Each slot holds the
+    /// device's QueryInterface result for that kind.
+    using InterfaceTable = hal::InterfaceTable;
+
+    static InterfaceTable ResolveInterfaces(Device* device);
+
+    template <typename T>
+    static constexpr std::size_t InterfaceIndex() {
+        return static_cast<std::size_t>(InterfaceKindOf<T>::value);
+    }
+
+    /// Immutable view of the registry read by lookups without locking.
+    struct Snapshot {
+        struct Entry {
+            std::string name;
+            Device* device;
+            LazyState* lazy;
+            InterfaceTable interfaces;
+        };
+        std::vector<Entry> entries;  // sorted by name
+        std::unordered_map<std::string, std::size_t> index;  // name -> entries
+        std::array<std::vector<std::size_t>, kInterfaceKindCount>
+            by_interface;  // InterfaceKind -> entries implementing it
+        std::map<std::string, std::vector<std::size_t>>
+            groups;  // group -> member entries, in name order
+
+        const Entry* Find(const std::string& nickname) const {
+            auto it = index.find(nickname);
+            return it == index.end() ? nullptr : &entries[it->second];
+        }
+    };
+
+    /// Heap of `snapshot` outside its Entry structs and their names.
+    static std::size_t SnapshotSharedBytes(const Snapshot& snapshot);
+
+    /// The published snapshot. Caller holds mutex_, which keeps it alive.
+    const Snapshot& CurrentSnapshot() const { return *current_snapshot_; }
+
+    /// Pins the published snapshot for a lock-free lookup. The guard counts
+    /// itself in readers_[epoch & 1]; PublishLocked() advances the epoch
+    /// only once the other slot is empty and frees a superseded snapshot two
+    /// epochs later, when no guard can still see it.
+    class SnapshotGuard {
+    public:
+        explicit SnapshotGuard(const DeviceManager& manager) {
+            for (;;) {
+                auto epoch = manager.epoch_.load();
+                readers_ = &manager.readers_[epoch & 1];
+                readers_->fetch_add(1);
+                if (manager.epoch_.load() == epoch) {
+                    break;
+                }
+                readers_->fetch_sub(1, std::memory_order_release);
+            }
+            snapshot_ = manager.snapshot_.load();
+        }
+        ~SnapshotGuard() { readers_->fetch_sub(1, std::memory_order_release); }
+
+        SnapshotGuard(const SnapshotGuard&) = delete;
+        SnapshotGuard& operator=(const SnapshotGuard&) = delete;
+
+        const Snapshot& operator*() const { return *snapshot_; }
+        const Snapshot* operator->() const { return snapshot_; }
+
+    private:
+        std::atomic<uint64_t>* readers_ = nullptr;
+        const Snapshot* snapshot_ = nullptr;
+    };
+
+    /// Advance the epoch as far as the guards allow and free the retired
+    /// snapshots they can no longer see. Caller holds mutex_.
+    void ReclaimSnapshotsLocked();
+
+    /// Register `device` under `nickname`. Caller holds mutex_ and checked
+    /// for duplicates.
+    void InsertLocked(const std::string& nickname,
+                      std::unique_ptr<Device> device);
+
+    /// Close the device and move it to the retired lists. Caller holds
+    /// mutex_ and publishes afterwards.
+    void RetireLocked(const std::string& nickname);
+
+    /// Rebuild the snapshot from devices_ and publish it. Caller holds mutex_.
+    void PublishLocked();
+
+    /// Apply the reconnect policy, then open the state's device if lazy
+    /// open is on and it is not open yet.
+    void EnsureOpen(LazyState& state) {
+        if (state.reconnecting.load(std::memory_order_acquire) && !WaitForReconnect(state)) {
+            return;
+        }
+        if (lazy_open_.load(std::memory_order_relaxed)) {
+            OpenLazily(state);
+        }
+    }
+
+    void OpenLazily(LazyState& state);
+
+    /// Block per the reconnect policy; true once the device is back.
+    bool WaitForReconnect(LazyState& state);
+
+    /// Reset/Init/Open and probe the entry's device. Caller holds mutex_
+    /// and the entry's state mutex.
+    bool ReconnectLocked(const Snapshot::Entry& entry,
+                         const HealthSupervisorOptions& options);
+
+    /// Mark the outage over and wake waiting lookups.
+    static void EndOutage(LazyState& state, bool reconnected);
+
+    /// Coalescing options of `nickname`: the EnableReadCoalescing()/
+    /// DisableReadCoalescing() override, else its config arg. Caller holds
+    /// mutex_.
+    std::optional<ReadCoalescingOptions> CoalescingOptionsLocked(
+        const std::string& nickname) const;
+
+    /// Create, replace or retire the device's coalescing layer to match
+    /// CoalescingOptionsLocked(). Caller holds mutex_.
+    void SyncCoalescingLocked(const std::string& nickname, Device& device);
+
+    /// Interceptor names of `nickname`: the SetInterceptors() override,
+    /// else its config args (unknown names dropped with a warning, "retry"
+    /// appended for retry_attempts). Caller holds mutex_.
+    std::vector<std::string> InterceptorNamesLocked(const std::string& nickname) const;
+
+    /// Create, replace or retire the device's interceptor chain to match
+    /// InterceptorNamesLocked() over `inner`; returns the table to publish.
+    /// Caller holds mutex_.
+    InterfaceTable SyncInterceptorsLocked(const std::string& nickname,
+                                          const InterfaceTable& inner);
+
+    void StopIdleReaper();
+
+    // Writer state, guarded by mutex_.
     std::map<std::string, std::unique_ptr<Device>> devices_;
-    mutable std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<LazyState>> lazy_states_;
+    std::map<std::string, InterfaceTable> interface_tables_;
+    std::map<std::string, config::DeviceEntry> config_entries_;
+    std::map<std::string, std::set<std::string>> group_members_;  // AddToGroup()
+    std::map<std::string, std::unique_ptr<ReadCoalescingLayer>> coalescing_layers_;
+    std::map<std::string, std::optional<ReadCoalescingOptions>>
+        coalescing_overrides_;  // Enable/DisableReadCoalescing(); nullopt = off
+    std::vector<std::unique_ptr<Device>> retired_devices_;
+    std::vector<std::unique_ptr<LazyState>> retired_states_;
+    std::vector<std::unique_ptr<ReadCoalescingLayer>> retired_layers_;
+    std::map<std::string, std::unique_ptr<InterceptorChain>> interceptor_chains_;
+    std::map<std::string, std::vector<std::string>>
+        interceptor_overrides_;  // SetInterceptors()
+    std::vector<std::unique_ptr<InterceptorChain>> retired_chains_;
+    std::unique_ptr<const Snapshot> current_snapshot_;
+    struct RetiredSnapshot {
+        uint64_t epoch;  // epoch_ when it was superseded
+        std::unique_ptr<const Snapshot> snapshot;
+    };
+    std::vector<RetiredSnapshot> retired_snapshots_;  // oldest first
+    mutable core::InstrumentedMutex mutex_{"device_manager"};
+
+    // Published snapshot and its reclamation epoch; see SnapshotGuard.
+    std::atomic<const Snapshot*> snapshot_{nullptr};
+    std::atomic<uint64_t> epoch_{0};
+    mutable std::atomic<uint64_t> readers_[2] = {};
+    std::atomic<bool> lazy_open_{false};
+    std::atomic<uint64_t> generation_{0};
+
+    std::chrono::milliseconds idle_timeout_{0};  // guarded by mutex_
+
+    uint64_t reaper_timer_ = 0;  // core::Executor timer; guarded by reaper_mutex_
+    std::mutex reaper_mutex_;    // serializes reaper start/stop
+
+    std::unique_ptr<pci::PciHotplugMonitor> hotplug_monitor_;
+    mutable std::mutex hotplug_mutex_;  // serializes monitor start/stop
+
+    HealthSupervisorOptions health_options_;  // guarded by mutex_
+    std::atomic<bool> reconnect_wait_{false};          // policy == kWait
+    std::atomic<int64_t> reconnect_wait_ms_{0};        // wait_timeout
+    uint64_t health_timer_ = 0;  // core::Executor timer; guarded by health_timer_mutex_
+    mutable std::mutex health_timer_mutex_;
+};
+
+/// Interface of one device, resolved once by DeviceManager::GetHandle().
+///
+/// Get() returns the bound interface pointer directly: no name hashing, no
+/// locking, only a generation check and (with lazy open on) the device's
+/// open fast path. After DeviceManager::Reset(), or once ApplyDiff() replaces
+/// or removes its device, the handle is stale and Get() returns nullptr.
+/// Trivially copyable; copies may be used from any thread.
+template <typename T>
+class DeviceHandle {
+public:
+    DeviceHandle() = default;
+
+    /// True if bound, the manager has not been Reset() since and the device
+    /// was not retired by a reload.
+    bool IsValid() const {
+        return iface_ != nullptr && generation_ == manager_->Generation() &&
+               !state_->retired.load(std::memory_order_acquire);
+    }
+
+    explicit operator bool() const { return IsValid(); }
+
+    /// The interface, or nullptr if empty or stale.
+    T* Get() const {
+        if (!IsValid()) return nullptr;
+        manager_->EnsureOpen(*state_);
+        return iface_;
+    }
+
+    T* operator->() const { return Get(); }
+
+    uint64_t Generation() const { return generation_; }
+
+private:
+    friend class DeviceManager;
+
+    DeviceHandle(DeviceManager* manager, DeviceManager::LazyState* state, T* iface,
+                 uint64_t generation)
+        : manager_(manager), state_(state), iface_(iface), generation_(generation) {}
+
+    DeviceManager* manager_ = nullptr;
+    DeviceManager::LazyState* state_ = nullptr;  // outlives snapshots, kept until Reset()
+    T* iface_ = nullptr;
+    uint64_t generation_ = 0;
 };
 
 // --- Template implementation ---
 
 template <typename T>
 T* DeviceManager::GetInterface(const std::string& nickname) {
-    auto* device = GetDevice(nickname);
-    if (!device) return nullptr;
-    return dynamic_cast<T*>(device);
+    if constexpr (HasInterfaceKind<T>::value) {
+        SnapshotGuard snapshot(*this);
+        const auto* entry = snapshot->Find(nickname);
+        if (!entry) return nullptr;
+        void* iface = entry->interfaces[InterfaceIndex<T>()];
+        if (!iface) return nullptr;
+        EnsureOpen(*entry->lazy);
+        return static_cast<T*>(iface);
+    } else {
+        auto* device = GetDevice(nickname);
+        if (!device) return nullptr;
+        return dynamic_cast<T*>(device);
+    }
 }
 
 template <typename T>
 std::vector<std::pair<std::string, T*>> DeviceManager::GetDevicesByInterface() {
-    std::lock_guard<std::mutex> lock(mutex_);
     std::vector<std::pair<std::string, T*>> result;
-    for (auto& [name, device] : devices_) {
-        auto* iface = dynamic_cast<T*>(device.get());
-        if (iface) {
+    if constexpr (HasInterfaceKind<T>::value) {
+        {
+            SnapshotGuard snapshot(*this);
+            result.reserve(snapshot->by_interface[InterfaceIndex<T>()].size());
+        }
+        ForEachInterface<T>([&result](const std::string& name, T* iface) {
             result.emplace_back(name, iface);
+        });
+    } else {
+        SnapshotGuard snapshot(*this);
+        for (const auto& entry : snapshot->entries) {
+            auto* iface = dynamic_cast<T*>(entry.device);
+            if (iface) {
+                EnsureOpen(*entry.lazy);
+                result.emplace_back(entry.name, iface);
+            }
         }
     }
     return result;
 }
 
+template <typename T, typename Fn>
+void DeviceManager::ForEachInterface(Fn&& fn) {
+    static_assert(HasInterfaceKind<T>::value,
+                  "ForEachInterface requires a built-in interface");
+    constexpr auto kind = InterfaceIndex<T>();
+    SnapshotGuard snapshot(*this);
+    for (auto i : snapshot->by_interface[kind]) {
+        const auto& entry = snapshot->entries[i];
+        EnsureOpen(*entry.lazy);
+        fn(entry.name, static_cast<T*>(entry.interfaces[kind]));
+    }
+}
+
+template <typename T, typename Fn>
+auto DeviceManager::ForEachInGroup(const std::string& group, Fn&& fn, std::size_t max_parallel)
+    -> core::Result<GroupResult<
+        typename detail::GroupOpValue<std::invoke_result_t<Fn&, T&>>::type>> {
+    using R = typename detail::GroupOpValue<std::invoke_result_t<Fn&, T&>>::type;
+    SnapshotGuard snapshot(*this);
+    auto it = snapshot->groups.find(group);
+    if (it == snapshot->groups.end()) {
+        return core::Result<GroupResult<R>>::Err(core::ErrorCode::kNotFound);
+    }
+
+    std::vector<std::pair<const Snapshot::Entry*, T*>> members;
+    members.reserve(it->second.size());
+    for (auto i : it->second) {
+        const auto& entry = snapshot->entries[i];
+        T* iface = nullptr;
+        if constexpr (HasInterfaceKind<T>::value) {
+            iface = static_cast<T*>(entry.interfaces[InterfaceIndex<T>()]);
+        } else {
+            iface = dynamic_cast<T*>(entry.device);
+        }
+        if (iface) {
+            members.emplace_back(&entry, iface);
+        }
+    }
+
+    std::vector<std::optional<core::Result<R>>> outcomes(members.size());
+    core::Executor::Shared().ParallelFor(
+        members.size(),
+        [&](std::size_t i) {
+            EnsureOpen(*members[i].first->lazy);
+            outcomes[i].emplace(fn(*members[i].second));
+        },
+        max_parallel);
+
+    GroupResult<R> result;
+    result.devices.reserve(members.size());
+    for (std::size_t i = 0; i < members.size(); ++i) {
+        result.devices.push_back({members[i].first->name, std::move(*outcomes[i])});
+    }
+    return core::Result<GroupResult<R>>::Ok(std::move(result));
+}
+
+template <typename T>
+DeviceHandle<T> DeviceManager::GetHandle(const std::string& nickname) {
+    static_assert(HasInterfaceKind<T>::value,
+                  "GetHandle requires a built-in interface");
+    uint64_t generation = Generation();
+    SnapshotGuard snapshot(*this);
+    const auto* entry = snapshot->Find(nickname);
+    if (!entry || !entry->interfaces[InterfaceIndex<T>()]) {
+        return {};
+    }
+    return DeviceHandle<T>(
+        this, entry->lazy, static_cast<T*>(entry->interfaces[InterfaceIndex<T>()]),
+        generation);
+}
+
 }  // namespace plas::hal
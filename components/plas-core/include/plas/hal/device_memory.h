@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace plas::hal {
+
+/// Estimated bytes of one managed device, see
+/// DeviceManager::GetMemoryReport().
+struct DeviceMemory {
+    std::string nickname;
+    std::string driver;
+    std::size_t device_bytes = 0;    // Device::MemoryUsage(); 0 if not reported
+    std::size_t config_bytes = 0;    // its config::DeviceEntry copy
+    std::size_t registry_bytes = 0;  // registry maps, lazy/health state, snapshot entry
+    std::size_t layer_bytes = 0;     // read coalescing layer and interceptor chain
+
+    std::size_t TotalBytes() const {
+        return device_bytes + config_bytes + registry_bytes + layer_bytes;
+    }
+};
+
+/// Estimated memory of DeviceManager and the devices it owns, per device
+/// and per subsystem. Counts object sizes, container nodes and strings
+/// past their inline storage (see plas/core/memory_usage.h); allocator
+/// overhead is not included, so the real heap use is somewhat higher.
+struct MemoryReport {
+    std::vector<DeviceMemory> devices;          // in name order
+    std::map<std::string, std::size_t> drivers;  // device_bytes per driver name
+
+    // Subsystem totals. The first four sum `devices`; registry_bytes also
+    // holds what the current snapshot and the group tables share.
+    std::size_t device_bytes = 0;
+    std::size_t config_bytes = 0;
+    std::size_t registry_bytes = 0;
+    std::size_t layer_bytes = 0;
+    /// Superseded snapshots and retired devices, states and layers, kept
+    /// for lock-free readers until DeviceManager::Reset().
+    std::size_t retained_bytes = 0;
+
+    std::size_t TotalBytes() const {
+        return device_bytes + config_bytes + registry_bytes + layer_bytes + retained_bytes;
+    }
+};
+
+}  // namespace plas::hal
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+
+namespace plas::hal {
+
+class DeviceManager;
+
+struct I2cScanOptions {
+    /// Span probed on every bus; the default skips the reserved addresses
+    /// (0x00-0x07 and 0x78-0x7F).
+    core::Address first = 0x08;
+    core::Address last = 0x77;
+    /// Per-probe bus timeout passed to I2c::Scan(); 0 keeps the backend's.
+    std::chrono::milliseconds probe_timeout{10};
+    /// Buses scanned at once, each on its own thread (<= 1: caller thread
+    /// only).
+    std::size_t workers = 8;
+    /// How long a result is reused; 0 keeps it until Invalidate().
+    std::chrono::milliseconds cache_ttl{0};
+};
+
+/// Addresses that answered on one bus.
+struct I2cBusScan {
+    std::string bus;                      ///< I2cBusScanner::BusOf() of the device URIs
+    std::vector<std::string> devices;     ///< nicknames on the bus, name order
+    std::vector<core::Address> addresses; ///< ascending
+    std::error_code error;                ///< set if the scan failed
+    std::chrono::microseconds duration{0};
+    bool cached = false;                  ///< answered from the cache
+
+    bool Responds(core::Address addr) const;
+};
+
+/// Finds the responding targets on every configured I2C bus.
+///
+/// Devices from GetDevicesByInterface<I2c>() are grouped by bus (several
+/// nicknames on one adapter port share a bus) and each bus is scanned once,
+/// through its first device, with I2c::Scan(): backends that support it
+/// probe with zero-length writes in one bus turn, others read one byte per
+/// address. Distinct buses are scanned in parallel. Successful results are
+/// cached per bus; failed ones are not, so the next call retries them.
+///
+/// Calls are serialized; the devices must outlive the scanner's calls.
+class I2cBusScanner {
+public:
+    explicit I2cBusScanner(DeviceManager& manager, I2cScanOptions options = {});
+    ~I2cBusScanner();
+
+    I2cBusScanner(const I2cBusScanner&) = delete;
+    I2cBusScanner& operator=(const I2cBusScanner&) = delete;
+
+    /// One result per bus, in bus order.
+    std::vector<I2cBusScan> ScanAll();
+
+    /// The bus of `nickname`. kNotFound if it is unknown or not I2C.
+    core::Result<I2cBusScan> Scan(const std::string& nickname);
+
+    /// The cached result for `bus`, without scanning. kNotFound if there is
+    /// none or it has expired.
+    core::Result<I2cBusScan> Cached(const std::string& bus) const;
+
+    /// Drop the cached result of `bus` (after re-cabling a fixture, say).
+    void Invalidate(const std::string& bus);
+    void InvalidateAll();
+
+    /// Bus part of a device URI: everything before the last ':' after the
+    /// scheme, e.g. "aardvark://0" for "aardvark://0:0x50". The URI itself
+    /// if it has no such colon.
+    static std::string BusOf(const std::string& uri);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal
@@ -0,0 +1,613 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/core/result.h"
+#include "plas/core/retry.h"
+#include "plas/core/types.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/interface_kind.h"
+#include "plas/hal/interface/pci/cxl_mailbox.h"
+#include "plas/hal/interface/pci/pci_bar.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/interface/power_control.h"
+
+namespace plas::hal {
+
+class Device;  // forward declaration
+
+/// One interface pointer per InterfaceKind (nullptr if absent), as
+/// DeviceManager resolves them.
+using InterfaceTable = std::array<void*, kInterfaceKindCount>;
+
+/// What a call does, for interceptors that treat reads and writes apart.
+enum class CallKind : uint8_t {
+    kControl = 0,  ///< moves no payload (SetBitrate, FindCapability, PowerOn, ...)
+    kRead,
+    kWrite,
+    kWriteRead,
+    kExchange,     ///< I2c Transfer, DOE exchange, CXL mailbox command
+};
+
+/// An intercepted call, described before it runs.
+struct CallInfo {
+    InterfaceKind interface = InterfaceKind::kI2c;
+    CallKind kind = CallKind::kControl;
+    const char* op = "";    ///< method name: "Read", "ReadConfig32", ...
+    uint64_t address = 0;   ///< I2C target, config/BAR/DOE offset
+    uint16_t target = 0;    ///< PCI: Bdf::Pack(); otherwise 0
+    uint32_t extra = 0;     ///< BAR index / DOE protocol (vendor | type << 16) / CXL opcode
+    std::size_t bytes = 0;  ///< payload bytes requested
+};
+
+/// True if `result` is a core::Result holding an error. Calls returning
+/// anything else (WriteConfigBatch's count) never count as failed.
+template <typename T>
+bool CallFailed(const core::Result<T>& result) {
+    return result.IsError();
+}
+template <typename T>
+bool CallFailed(const T&) {
+    return false;
+}
+
+/// True if `result` failed in a way `policy` retries: an error in
+/// policy.retry_on or, for CXL mailbox commands, a kBusy or kRetryRequired
+/// return code. Never true for calls that do not return a Result.
+template <typename T>
+bool IsTransientFailure(const core::RetryPolicy& policy, const core::Result<T>& result) {
+    return result.IsError() && policy.IsRetryable(result.Error());
+}
+template <typename T>
+bool IsTransientFailure(const core::RetryPolicy&, const T&) {
+    return false;
+}
+inline bool IsTransientReturnCode(pci::CxlMailboxReturnCode code) {
+    return code == pci::CxlMailboxReturnCode::kBusy ||
+           code == pci::CxlMailboxReturnCode::kRetryRequired;
+}
+inline bool IsTransientFailure(const core::RetryPolicy& policy,
+                               const core::Result<pci::CxlMailboxResult>& result) {
+    return result.IsError() ? policy.IsRetryable(result.Error())
+                            : IsTransientReturnCode(result.Value().return_code);
+}
+inline bool IsTransientFailure(const core::RetryPolicy& policy,
+                               const core::Result<pci::CxlMailboxPooledResult>& result) {
+    return result.IsError() ? policy.IsRetryable(result.Error())
+                            : IsTransientReturnCode(result.Value().return_code);
+}
+
+/// Cross-cutting behavior (metrics, tracing, retry, logging, fault
+/// injection) applied to a device's I2c, PciConfig, PciDoe, PciBar,
+/// PowerControl and CxlMailbox interfaces without touching its driver. DeviceManager builds one
+/// instance per device from the `interceptors` arg (see InterceptorChain)
+/// and hands out the wrappers in place of the device's own interfaces.
+///
+/// Derive from InterceptorBase, not from this class.
+class Interceptor {
+public:
+    virtual ~Interceptor() = default;
+
+    /// Replace each supported entry of `table` with a wrapper that runs
+    /// this interceptor around the entry it replaces. Called once.
+    virtual void Wrap(InterfaceTable& table) = 0;
+};
+
+namespace detail {
+
+// Forwarding wrappers of InterceptorBase<D>. Every call goes to `next` via
+// D::Around(), which the compiler sees through (no virtual hop into the
+// interceptor). Calls that return neither a Result nor move data
+// (InterfaceName, GetDevice, GetBitrate, IsSampling) and DoeExchangeAsync
+// are forwarded as is; Transfer, Scan, WriteConfigBatch and the block
+// reads are intercepted once, not per message.
+
+template <typename D>
+class InterceptedI2c final : public I2c {
+public:
+    InterceptedI2c(I2c& next, D& self) : next_(next), self_(self) {}
+
+    std::string InterfaceName() const override { return next_.InterfaceName(); }
+    Device* GetDevice() override { return next_.GetDevice(); }
+
+    core::Result<size_t> Read(core::Address addr, core::Byte* data, size_t length,
+                              bool stop = true) override {
+        return self_.Around(Info(CallKind::kRead, "Read", addr, length),
+                            [&] { return next_.Read(addr, data, length, stop); });
+    }
+    core::Result<size_t> Write(core::Address addr, const core::Byte* data, size_t length,
+                               bool stop = true) override {
+        return self_.Around(Info(CallKind::kWrite, "Write", addr, length),
+                            [&] { return next_.Write(addr, data, length, stop); });
+    }
+    core::Result<size_t> WriteRead(core::Address addr, const core::Byte* write_data,
+                                   size_t write_len, core::Byte* read_data,
+                                   size_t read_len) override {
+        return self_.Around(
+            Info(CallKind::kWriteRead, "WriteRead", addr, write_len + read_len),
+            [&] { return next_.WriteRead(addr, write_data, write_len, read_data, read_len); });
+    }
+    core::Result<size_t> Transfer(I2cMessage* msgs, size_t count) override {
+        std::size_t bytes = 0;
+        for (std::size_t i = 0; msgs && i < count; ++i) {
+            bytes += msgs[i].length;
+        }
+        core::Address addr = msgs && count > 0 ? msgs[0].addr : 0;
+        return self_.Around(Info(CallKind::kExchange, "Transfer", addr, bytes),
+                            [&] { return next_.Transfer(msgs, count); });
+    }
+    core::Result<bool> Probe(core::Address addr) override {
+        return self_.Around(Info(CallKind::kControl, "Probe", addr, 0),
+                            [&] { return next_.Probe(addr); });
+    }
+    core::Result<std::vector<core::Address>> Scan(
+        core::Address first, core::Address last,
+        std::chrono::milliseconds timeout = std::chrono::milliseconds{0}) override {
+        return self_.Around(Info(CallKind::kControl, "Scan", first, 0),
+                            [&] { return next_.Scan(first, last, timeout); });
+    }
+    core::Result<void> SetBitrate(uint32_t bitrate) override {
+        return self_.Around(Info(CallKind::kControl, "SetBitrate", 0, 0),
+                            [&] { return next_.SetBitrate(bitrate); });
+    }
+    uint32_t GetBitrate() const override { return next_.GetBitrate(); }
+
+private:
+    static CallInfo Info(CallKind kind, const char* op, core::Address addr, std::size_t bytes) {
+        CallInfo info;
+        info.interface = InterfaceKind::kI2c;
+        info.kind = kind;
+        info.op = op;
+        info.address = addr;
+        info.bytes = bytes;
+        return info;
+    }
+
+    I2c& next_;
+    D& self_;
+};
+
+inline CallInfo PciCallInfo(InterfaceKind interface, CallKind kind, const char* op,
+                            pci::Bdf bdf, uint64_t address, std::size_t bytes,
+                            uint32_t extra = 0) {
+    CallInfo info;
+    info.interface = interface;
+    info.kind = kind;
+    info.op = op;
+    info.address = address;
+    info.target = bdf.Pack();
+    info.extra = extra;
+    info.bytes = bytes;
+    return info;
+}
+
+template <typename D>
+class InterceptedPciConfig final : public pci::PciConfig {
+public:
+    InterceptedPciConfig(pci::PciConfig& next, D& self) : next_(next), self_(self) {}
+
+    std::string InterfaceName() const override { return next_.InterfaceName(); }
+    Device* GetDevice() override { return next_.GetDevice(); }
+
+    core::Result<core::Byte> ReadConfig8(pci::Bdf bdf, pci::ConfigOffset offset) override {
+        return self_.Around(Info(CallKind::kRead, "ReadConfig8", bdf, offset, 1),
+                            [&] { return next_.ReadConfig8(bdf, offset); });
+    }
+    core::Result<core::Word> ReadConfig16(pci::Bdf bdf, pci::ConfigOffset offset) override {
+        return self_.Around(Info(CallKind::kRead, "ReadConfig16", bdf, offset, 2),
+                            [&] { return next_.ReadConfig16(bdf, offset); });
+    }
+    core::Result<core::DWord> ReadConfig32(pci::Bdf bdf, pci::ConfigOffset offset) override {
+        return self_.Around(Info(CallKind::kRead, "ReadConfig32", bdf, offset, 4),
+                            [&] { return next_.ReadConfig32(bdf, offset); });
+    }
+    core::Result<void> WriteConfig8(pci::Bdf bdf, pci::ConfigOffset offset,
+                                    core::Byte value) override {
+        return self_.Around(Info(CallKind::kWrite, "WriteConfig8", bdf, offset, 1),
+                            [&] { return next_.WriteConfig8(bdf, offset, value); });
+    }
+    core::Result<void> WriteConfig16(pci::Bdf bdf, pci::ConfigOffset offset,
+                                     core::Word value) override {
+        return self_.Around(Info(CallKind::kWrite, "WriteConfig16", bdf, offset, 2),
+                            [&] { return next_.WriteConfig16(bdf, offset, value); });
+    }
+    core::Result<void> WriteConfig32(pci::Bdf bdf, pci::ConfigOffset offset,
+                                     core::DWord value) override {
+        return self_.Around(Info(CallKind::kWrite, "WriteConfig32", bdf, offset, 4),
+                            [&] { return next_.WriteConfig32(bdf, offset, value); });
+    }
+    std::size_t WriteConfigBatch(pci::Bdf bdf, const pci::ConfigWrite* writes,
+                                 std::size_t count, std::error_code* status) override {
+        std::size_t bytes = 0;
+        for (std::size_t i = 0; writes && i < count; ++i) {
+            bytes += writes[i].width;
+        }
+        pci::ConfigOffset offset = writes && count > 0 ? writes[0].offset : 0;
+        return self_.Around(Info(CallKind::kWrite, "WriteConfigBatch", bdf, offset, bytes),
+                            [&] { return next_.WriteConfigBatch(bdf, writes, count, status); });
+    }
+    core::Result<std::optional<pci::ConfigOffset>> FindCapability(
+        pci::Bdf bdf, pci::CapabilityId id) override {
+        return self_.Around(Info(CallKind::kControl, "FindCapability", bdf, 0, 0),
+                            [&] { return next_.FindCapability(bdf, id); });
+    }
+    core::Result<std::optional<pci::ConfigOffset>> FindExtCapability(
+        pci::Bdf bdf, pci::ExtCapabilityId id) override {
+        return self_.Around(Info(CallKind::kControl, "FindExtCapability", bdf, 0, 0),
+                            [&] { return next_.FindExtCapability(bdf, id); });
+    }
+    core::Result<void> ReadConfigBlock(pci::Bdf bdf, pci::ConfigOffset offset,
+                                       core::Byte* buffer, std::size_t length) override {
+        return self_.Around(Info(CallKind::kRead, "ReadConfigBlock", bdf, offset, length),
+                            [&] { return next_.ReadConfigBlock(bdf, offset, buffer, length); });
+    }
+    core::Result<std::vector<core::Byte>> SnapshotConfig(pci::Bdf bdf) override {
+        return self_.Around(
+            Info(CallKind::kRead, "SnapshotConfig", bdf, 0, pci::kConfigSpaceSize),
+            [&] { return next_.SnapshotConfig(bdf); });
+    }
+    core::Result<pci::CapabilityIndex> GetCapabilityIndex(pci::Bdf bdf) override {
+        return self_.Around(Info(CallKind::kControl, "GetCapabilityIndex", bdf, 0, 0),
+                            [&] { return next_.GetCapabilityIndex(bdf); });
+    }
+
+private:
+    static CallInfo Info(CallKind kind, const char* op, pci::Bdf bdf, uint64_t offset,
+                         std::size_t bytes) {
+        return PciCallInfo(InterfaceKind::kPciConfig, kind, op, bdf, offset, bytes);
+    }
+
+    pci::PciConfig& next_;
+    D& self_;
+};
+
+template <typename D>
+class InterceptedPciDoe final : public pci::PciDoe {
+public:
+    InterceptedPciDoe(pci::PciDoe& next, D& self) : next_(next), self_(self) {}
+
+    std::string InterfaceName() const override { return next_.InterfaceName(); }
+    Device* GetDevice() override { return next_.GetDevice(); }
+
+    core::Result<std::vector<pci::DoeProtocolId>> DoeDiscover(
+        pci::Bdf bdf, pci::ConfigOffset doe_offset) override {
+        return self_.Around(PciCallInfo(InterfaceKind::kPciDoe, CallKind::kControl,
+                                        "DoeDiscover", bdf, doe_offset, 0),
+                            [&] { return next_.DoeDiscover(bdf, doe_offset); });
+    }
+    core::Result<pci::DoePayload> DoeExchange(pci::Bdf bdf, pci::ConfigOffset doe_offset,
+                                              pci::DoeProtocolId protocol,
+                                              const pci::DoePayload& request) override {
+        return self_.Around(Info("DoeExchange", bdf, doe_offset, protocol, request.size()),
+                            [&] { return next_.DoeExchange(bdf, doe_offset, protocol, request); });
+    }
+    core::Result<std::size_t> DoeExchangeInto(pci::Bdf bdf, pci::ConfigOffset doe_offset,
+                                              pci::DoeProtocolId protocol,
+                                              const core::DWord* request,
+                                              std::size_t request_len, core::DWord* response,
+                                              std::size_t response_capacity) override {
+        return self_.Around(Info("DoeExchangeInto", bdf, doe_offset, protocol, request_len),
+                            [&] {
+                                return next_.DoeExchangeInto(bdf, doe_offset, protocol, request,
+                                                             request_len, response,
+                                                             response_capacity);
+                            });
+    }
+    std::future<core::Result<pci::DoePayload>> DoeExchangeAsync(
+        pci::Bdf bdf, pci::ConfigOffset doe_offset, pci::DoeProtocolId protocol,
+        pci::DoePayload request) override {
+        return next_.DoeExchangeAsync(bdf, doe_offset, protocol, std::move(request));
+    }
+
+private:
+    static CallInfo Info(const char* op, pci::Bdf bdf, pci::ConfigOffset doe_offset,
+                         pci::DoeProtocolId protocol, std::size_t dwords) {
+        return PciCallInfo(InterfaceKind::kPciDoe, CallKind::kExchange, op, bdf, doe_offset,
+                           dwords * sizeof(core::DWord),
+                           protocol.vendor_id |
+                               (static_cast<uint32_t>(protocol.data_object_type) << 16));
+    }
+
+    pci::PciDoe& next_;
+    D& self_;
+};
+
+template <typename D>
+class InterceptedPciBar final : public pci::PciBar {
+public:
+    InterceptedPciBar(pci::PciBar& next, D& self) : next_(next), self_(self) {}
+
+    std::string InterfaceName() const override { return next_.InterfaceName(); }
+    Device* GetDevice() override { return next_.GetDevice(); }
+
+    core::Result<core::DWord> BarRead32(pci::Bdf bdf, uint8_t bar_index,
+                                        uint64_t offset) override {
+        return self_.Around(Info(CallKind::kRead, "BarRead32", bdf, bar_index, offset, 4),
+                            [&] { return next_.BarRead32(bdf, bar_index, offset); });
+    }
+    core::Result<core::QWord> BarRead64(pci::Bdf bdf, uint8_t bar_index,
+                                        uint64_t offset) override {
+        return self_.Around(Info(CallKind::kRead, "BarRead64", bdf, bar_index, offset, 8),
+                            [&] { return next_.BarRead64(bdf, bar_index, offset); });
+    }
+    core::Result<void> BarWrite32(pci::Bdf bdf, uint8_t bar_index, uint64_t offset,
+                                  core::DWord value) override {
+        return self_.Around(Info(CallKind::kWrite, "BarWrite32", bdf, bar_index, offset, 4),
+                            [&] { return next_.BarWrite32(bdf, bar_index, offset, value); });
+    }
+    core::Result<void> BarWrite64(pci::Bdf bdf, uint8_t bar_index, uint64_t offset,
+                                  core::QWord value) override {
+        return self_.Around(Info(CallKind::kWrite, "BarWrite64", bdf, bar_index, offset, 8),
+                            [&] { return next_.BarWrite64(bdf, bar_index, offset, value); });
+    }
+    core::Result<void> BarReadBuffer(pci::Bdf bdf, uint8_t bar_index, uint64_t offset,
+                                     void* buffer, std::size_t length) override {
+        return self_.Around(
+            Info(CallKind::kRead, "BarReadBuffer", bdf, bar_index, offset, length),
+            [&] { return next_.BarReadBuffer(bdf, bar_index, offset, buffer, length); });
+    }
+    core::Result<void> BarWriteBuffer(pci::Bdf bdf, uint8_t bar_index, uint64_t offset,
+                                      const void* buffer, std::size_t length) override {
+        return self_.Around(
+            Info(CallKind::kWrite, "BarWriteBuffer", bdf, bar_index, offset, length),
+            [&] { return next_.BarWriteBuffer(bdf, bar_index, offset, buffer, length); });
+    }
+    core::Result<void> SetBarMapping(pci::Bdf bdf, uint8_t bar_index,
+                                     pci::BarMapping mapping) override {
+        return self_.Around(Info(CallKind::kControl, "SetBarMapping", bdf, bar_index, 0, 0),
+                            [&] { return next_.SetBarMapping(bdf, bar_index, mapping); });
+    }
+    core::Result<void> BarFlush(pci::Bdf bdf, uint8_t bar_index) override {
+        return self_.Around(Info(CallKind::kControl, "BarFlush", bdf, bar_index, 0, 0),
+                            [&] { return next_.BarFlush(bdf, bar_index); });
+    }
+
+private:
+    static CallInfo Info(CallKind kind, const char* op, pci::Bdf bdf, uint8_t bar_index,
+                         uint64_t offset, std::size_t bytes) {
+        return PciCallInfo(InterfaceKind::kPciBar, kind, op, bdf, offset, bytes, bar_index);
+    }
+
+    pci::PciBar& next_;
+    D& self_;
+};
+
+template <typename D>
+class InterceptedPowerControl final : public PowerControl {
+public:
+    InterceptedPowerControl(PowerControl& next, D& self) : next_(next), self_(self) {}
+
+    std::string InterfaceName() const override { return next_.InterfaceName(); }
+    Device* GetDevice() override { return next_.GetDevice(); }
+
+    core::Result<void> SetVoltage(core::Voltage voltage) override {
+        return self_.Around(Info("SetVoltage"), [&] { return next_.SetVoltage(voltage); });
+    }
+    core::Result<core::Voltage> GetVoltage() override {
+        return self_.Around(Info("GetVoltage"), [&] { return next_.GetVoltage(); });
+    }
+    core::Result<void> SetCurrent(core::Current current) override {
+        return self_.Around(Info("SetCurrent"), [&] { return next_.SetCurrent(current); });
+    }
+    core::Result<core::Current> GetCurrent() override {
+        return self_.Around(Info("GetCurrent"), [&] { return next_.GetCurrent(); });
+    }
+    core::Result<void> PowerOn() override {
+        return self_.Around(Info("PowerOn"), [&] { return next_.PowerOn(); });
+    }
+    core::Result<void> PowerOff() override {
+        return self_.Around(Info("PowerOff"), [&] { return next_.PowerOff(); });
+    }
+    core::Result<bool> IsPowerOn() override {
+        return self_.Around(Info("IsPowerOn"), [&] { return next_.IsPowerOn(); });
+    }
+    core::Result<void> StartSampling(const PowerSamplingOptions& options,
+                                     PowerSampleRing& ring) override {
+        return self_.Around(Info("StartSampling"),
+                            [&] { return next_.StartSampling(options, ring); });
+    }
+    core::Result<void> StopSampling() override {
+        return self_.Around(Info("StopSampling"), [&] { return next_.StopSampling(); });
+    }
+    bool IsSampling() const override { return next_.IsSampling(); }
+
+private:
+    static CallInfo Info(const char* op) {
+        CallInfo info;
+        info.interface = InterfaceKind::kPowerControl;
+        info.op = op;
+        return info;
+    }
+
+    PowerControl& next_;
+    D& self_;
+};
+
+template <typename D>
+class InterceptedCxlMailbox final : public pci::CxlMailbox {
+public:
+    InterceptedCxlMailbox(pci::CxlMailbox& next, D& self) : next_(next), self_(self) {}
+
+    std::string InterfaceName() const override { return next_.InterfaceName(); }
+    Device* GetDevice() override { return next_.GetDevice(); }
+
+    core::Result<pci::CxlMailboxResult> ExecuteCommand(
+        pci::Bdf bdf, pci::CxlMailboxOpcode opcode,
+        const pci::CxlMailboxPayload& payload) override {
+        return self_.Around(
+            Info(CallKind::kExchange, "ExecuteCommand", bdf, static_cast<uint16_t>(opcode),
+                 payload.size()),
+            [&] { return next_.ExecuteCommand(bdf, opcode, payload); });
+    }
+    core::Result<pci::CxlMailboxResult> ExecuteCommand(
+        pci::Bdf bdf, uint16_t raw_opcode, const pci::CxlMailboxPayload& payload) override {
+        return self_.Around(
+            Info(CallKind::kExchange, "ExecuteCommand", bdf, raw_opcode, payload.size()),
+            [&] { return next_.ExecuteCommand(bdf, raw_opcode, payload); });
+    }
+    core::Result<pci::CxlMailboxResult> ExecuteCommandGather(
+        pci::Bdf bdf, uint16_t raw_opcode, const uint8_t* header, std::size_t header_len,
+        const uint8_t* data, std::size_t data_len) override {
+        return self_.Around(Info(CallKind::kExchange, "ExecuteCommandGather", bdf, raw_opcode,
+                                 header_len + data_len),
+                            [&] {
+                                return next_.ExecuteCommandGather(bdf, raw_opcode, header,
+                                                                  header_len, data, data_len);
+                            });
+    }
+    core::Result<pci::CxlMailboxPooledResult> ExecuteCommandPooled(
+        pci::Bdf bdf, uint16_t raw_opcode, const uint8_t* payload,
+        std::size_t length) override {
+        return self_.Around(
+            Info(CallKind::kExchange, "ExecuteCommandPooled", bdf, raw_opcode, length),
+            [&] { return next_.ExecuteCommandPooled(bdf, raw_opcode, payload, length); });
+    }
+    core::Result<uint32_t> GetPayloadSize(pci::Bdf bdf) override {
+        return self_.Around(Info(CallKind::kControl, "GetPayloadSize", bdf, 0, 0),
+                            [&] { return next_.GetPayloadSize(bdf); });
+    }
+    core::Result<bool> IsReady(pci::Bdf bdf) override {
+        return self_.Around(Info(CallKind::kControl, "IsReady", bdf, 0, 0),
+                            [&] { return next_.IsReady(bdf); });
+    }
+    core::Result<pci::CxlMailboxResult> GetBackgroundCmdStatus(pci::Bdf bdf) override {
+        return self_.Around(Info(CallKind::kControl, "GetBackgroundCmdStatus", bdf, 0, 0),
+                            [&] { return next_.GetBackgroundCmdStatus(bdf); });
+    }
+
+private:
+    static CallInfo Info(CallKind kind, const char* op, pci::Bdf bdf, uint16_t opcode,
+                         std::size_t bytes) {
+        return PciCallInfo(InterfaceKind::kCxlMailbox, kind, op, bdf, 0, bytes, opcode);
+    }
+
+    pci::CxlMailbox& next_;
+    D& self_;
+};
+
+}  // namespace detail
+
+/// CRTP base of every interceptor. `Derived` supplies
+///
+///   template <typename Call>
+///   auto Around(const CallInfo& info, Call&& call) -> decltype(call());
+///
+/// which must invoke `call` (the next interceptor, or the device) exactly
+/// once and return its result, or return a result of its own without
+/// calling it. Around() is resolved at compile time, so a link costs one
+/// virtual call into its wrapper plus whatever Around() does.
+///
+///   class CountingInterceptor : public InterceptorBase<CountingInterceptor> {
+///   public:
+///       template <typename Call>
+///       auto Around(const CallInfo& info, Call&& call) {
+///           calls_.fetch_add(1, std::memory_order_relaxed);
+///           return call();
+///       }
+///   };
+template <typename Derived>
+class InterceptorBase : public Interceptor {
+public:
+    void Wrap(InterfaceTable& table) final {
+        WrapOne<I2c>(table, i2c_);
+        WrapOne<pci::PciConfig>(table, pci_config_);
+        WrapOne<pci::PciDoe>(table, pci_doe_);
+        WrapOne<pci::PciBar>(table, pci_bar_);
+        WrapOne<PowerControl>(table, power_control_);
+        WrapOne<pci::CxlMailbox>(table, cxl_mailbox_);
+    }
+
+private:
+    template <typename T, typename W>
+    void WrapOne(InterfaceTable& table, std::unique_ptr<W>& wrapper) {
+        auto& slot = table[static_cast<std::size_t>(InterfaceKindOf<T>::value)];
+        if (slot == nullptr) {
+            return;
+        }
+        wrapper = std::make_unique<W>(*static_cast<T*>(slot), static_cast<Derived&>(*this));
+        slot = static_cast<void*>(static_cast<T*>(wrapper.get()));
+    }
+
+    std::unique_ptr<detail::InterceptedI2c<Derived>> i2c_;
+    std::unique_ptr<detail::InterceptedPciConfig<Derived>> pci_config_;
+    std::unique_ptr<detail::InterceptedPciDoe<Derived>> pci_doe_;
+    std::unique_ptr<detail::InterceptedPciBar<Derived>> pci_bar_;
+    std::unique_ptr<detail::InterceptedPowerControl<Derived>> power_control_;
+    std::unique_ptr<detail::InterceptedCxlMailbox<Derived>> cxl_mailbox_;
+};
+
+/// Interceptors by name. Built in:
+///
+///   metrics  MetricsRegistry samples under the device's nickname (I2c,
+///            PciConfig, PciDoe and PciBar data calls), timed as the
+///            caller sees them: coalescing and I/O queue waits included.
+///   trace    log::TraceSpan per data call of the same interfaces, under a
+///            Tracer id registered for the nickname.
+///   retry    core::RetryCall() around every call, with the policy of
+///            RetryPolicyFromArgs() (a single attempt if the entry sets
+///            none); counts go to the device's MetricsSnapshot::retries.
+///
+/// metrics and trace are meant for drivers that record no metrics or spans
+/// of their own (sim, proxies, out-of-tree drivers); on one that does,
+/// each call is counted twice.
+class InterceptorRegistry {
+public:
+    /// Makes the interceptor for the device of `entry` (its nickname and
+    /// args; just the nickname for devices added without one).
+    using CreatorFunc =
+        std::function<std::unique_ptr<Interceptor>(const config::DeviceEntry& entry)>;
+
+    /// Add (or replace) `name`. Registered names shadow the built-ins.
+    static void Register(const std::string& name, CreatorFunc creator);
+
+    static bool Has(std::string_view name);
+
+    /// nullptr if no interceptor is called `name`.
+    static std::unique_ptr<Interceptor> Create(std::string_view name,
+                                               const config::DeviceEntry& entry);
+};
+
+/// Retry policy from an entry's retry args (config::kRetryAttemptsArg and
+/// the ones after it); nullopt without `retry_attempts`. Values that do
+/// not parse are logged and left at their defaults.
+std::optional<core::RetryPolicy> RetryPolicyFromArgs(const config::DeviceEntry& entry);
+
+/// The interceptors of one device, applied over `inner` (the device's
+/// interfaces, or its read-coalescing wrappers). The first name is the
+/// outermost: it sees each call first and its result last. Names with no
+/// interceptor are skipped. Interfaces no interceptor supports (SmBus,
+/// Cxl, Serial, ...) keep their `inner` entry.
+class InterceptorChain {
+public:
+    InterceptorChain(const config::DeviceEntry& entry, const std::vector<std::string>& names,
+                     const InterfaceTable& inner);
+
+    InterceptorChain(const InterceptorChain&) = delete;
+    InterceptorChain& operator=(const InterceptorChain&) = delete;
+
+    /// Names actually applied, outermost first.
+    const std::vector<std::string>& Names() const { return names_; }
+    const InterfaceTable& Inner() const { return inner_; }
+    const InterfaceTable& Outer() const { return outer_; }
+
+private:
+    std::vector<std::string> names_;
+    std::vector<std::unique_ptr<Interceptor>> interceptors_;  // innermost first
+    InterfaceTable inner_;
+    InterfaceTable outer_;
+};
+
+}  // namespace plas::hal
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 #include "plas/core/result.h"
+#include "plas/hal/interface/interface_kind.h"
 
 namespace plas::hal {
 
@@ -32,6 +34,29 @@ public:
 
     /// Returns the driver type name (e.g. "aardvark", "pciutils").
     virtual std::string GetDriverName() const = 0;
+
+    /// Estimated bytes this device holds: the object itself plus the heap
+    /// it owns (buffers, containers, strings past their inline storage).
+    /// Allocator overhead and memory shared between devices are left out.
+    /// 0 if the driver does not report it. See
+    /// DeviceManager::GetMemoryReport().
+    virtual std::size_t MemoryUsage() const { return 0; }
+
+    /// This device as built-in interface `kind` (a T* for
+    /// InterfaceKindOf<T>, converted to void*), or nullptr if it does not
+    /// implement it. The default probes with dynamic_cast; drivers override
+    /// it with QueryInterfaceOf and their InterfaceList
+    /// (plas/hal/interface/device_interfaces.h), which needs no RTTI.
+    virtual void* QueryInterface(InterfaceKind kind);
 };
 
+/// `device` as built-in interface T through Device::QueryInterface, or
+/// nullptr.
+template <typename T>
+T* InterfaceCast(Device* device) {
+    static_assert(HasInterfaceKind<T>::value, "InterfaceCast takes a built-in interface");
+    return device ? static_cast<T*>(device->QueryInterface(InterfaceKindOf<T>::value))
+                  : nullptr;
+}
+
 }  // namespace plas::hal
@@ -1,12 +1,16 @@
 #pragma once
 
+#include <cstddef>
 #include <functional>
-#include <map>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 #include "plas/hal/interface/device.h"
 #include "plas/config/device_entry.h"
+#include "plas/config/device_uri.h"
+#include "plas/config/device_table.h"
 #include "plas/core/result.h"
 
 namespace plas::hal {
@@ -16,14 +20,63 @@ public:
     using CreatorFunc =
         std::function<std::unique_ptr<Device>(const config::DeviceEntry&)>;
 
+    /// Receives entry.uri already parsed, so drivers need not re-parse it.
+    using UriCreatorFunc = std::function<std::unique_ptr<Device>(
+        const config::DeviceEntry&, const config::DeviceUri&)>;
+
+    /// Creator of a built-in driver. A plain function pointer, so a table of
+    /// them can be a constexpr array.
+    using DriverCreateFn = std::unique_ptr<Device> (*)(const config::DeviceEntry&,
+                                                       const config::DeviceUri&);
+
+    struct BuiltinDriver {
+        std::string_view name;
+        DriverCreateFn create;
+    };
+
+    /// DriverCreateFn for a Device type constructed from (entry, uri), or
+    /// from entry alone.
+    template <typename T>
+    static std::unique_ptr<Device> Make(const config::DeviceEntry& entry,
+                                        const config::DeviceUri& uri) {
+        if constexpr (std::is_constructible_v<T, const config::DeviceEntry&,
+                                              const config::DeviceUri&>) {
+            return std::make_unique<T>(entry, uri);
+        } else {
+            (void)uri;
+            return std::make_unique<T>(entry);
+        }
+    }
+
+    /// Parses entry.uri once and hands it to the creator.
     static core::Result<std::unique_ptr<Device>> CreateFromConfig(
         const config::DeviceEntry& entry);
 
+    /// For callers that already parsed entry.uri; `uri` must view it.
+    static core::Result<std::unique_ptr<Device>> CreateFromConfig(
+        const config::DeviceEntry& entry, const config::DeviceUri& uri);
+
+    /// Looks the driver up without copying; the creator still receives a
+    /// DeviceEntry, materialized from the view.
+    static core::Result<std::unique_ptr<Device>> CreateFromConfig(
+        const config::DeviceEntryView& entry);
+
     static void RegisterDriver(const std::string& driver_name,
                                CreatorFunc creator);
+    static void RegisterDriver(const std::string& driver_name,
+                               UriCreatorFunc creator);
+
+    /// Install a table of built-in drivers, searched after the drivers
+    /// added with RegisterDriver (which therefore override it). Only the
+    /// pointer is kept: the table must outlive every lookup, e.g. a
+    /// namespace-scope constexpr array. Replaces any previous table.
+    static void SetBuiltinDrivers(const BuiltinDriver* table, std::size_t count);
+
+    static bool HasDriver(std::string_view driver_name);
 
 private:
-    static std::map<std::string, CreatorFunc>& GetRegistry();
+    static const UriCreatorFunc* FindCreator(std::string_view driver_name);
+    static DriverCreateFn FindBuiltin(std::string_view driver_name);
 };
 
 }  // namespace plas::hal
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "plas/core/result.h"
+
+namespace plas::hal {
+
+class Device;  // forward declaration
+
+/// An open device's OS handles plus the driver state needed to keep using
+/// them in another process (warm restart across exec, see
+/// bootstrap::Bootstrap::PrepareWarmRestart).
+struct DeviceHandoff {
+    std::vector<int> fds;  // descriptors the next process inherits
+    std::string state;     // driver-defined, opaque to the caller
+};
+
+/// Implemented by drivers whose open state is a set of file descriptors
+/// that survive exec (tty, character devices). Drivers built on SDK handles
+/// that are only valid in the opening process (Aardvark, FT4222H) do not
+/// implement it and are reopened normally.
+class DeviceHandoffSupport {
+public:
+    virtual ~DeviceHandoffSupport() = default;
+
+    virtual Device* GetDevice() = 0;
+
+    /// Release the open device without closing its descriptors: pending
+    /// output is drained, background I/O stops and the device ends up
+    /// kClosed. The caller owns the returned fds from then on.
+    /// kNotInitialized unless open.
+    virtual core::Result<DeviceHandoff> ExportHandoff() = 0;
+
+    /// Open an initialized device from a handoff exported by the same
+    /// driver for the same URI, instead of Open(). On success the device
+    /// owns the fds; on error they are left untouched for the caller to
+    /// close.
+    virtual core::Result<void> AdoptHandoff(const DeviceHandoff& handoff) = 0;
+};
+
+}  // namespace plas::hal
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "plas/hal/interface/interface_kind.h"
+
+namespace plas::hal {
+
+/// Compile-time list of built-in interfaces (see InterfaceKind).
+template <typename... Interfaces>
+struct InterfaceList {
+    static constexpr std::size_t kSize = sizeof...(Interfaces);
+};
+
+/// Every built-in interface, in InterfaceKind order.
+using BuiltinInterfaces =
+    InterfaceList<I2c, I3c, Serial, Uart, PowerControl, SsdGpio, pci::PciConfig,
+                  pci::PciDoe, pci::PciBar, pci::Cxl, pci::CxlMailbox, SmBus, Spi, Gpio>;
+static_assert(BuiltinInterfaces::kSize == kInterfaceKindCount,
+              "BuiltinInterfaces must list every InterfaceKind");
+
+namespace detail {
+
+template <typename Self, typename List>
+struct CountImplemented;
+
+template <typename Self, typename... Interfaces>
+struct CountImplemented<Self, InterfaceList<Interfaces...>>
+    : std::integral_constant<std::size_t,
+                             (std::size_t{0} + ... +
+                              (std::is_base_of_v<Interfaces, Self> ? 1 : 0))> {};
+
+template <typename A, typename B>
+struct ConcatInterfaces;
+
+template <typename... A, typename... B>
+struct ConcatInterfaces<InterfaceList<A...>, InterfaceList<B...>> {
+    using type = InterfaceList<A..., B...>;
+};
+
+template <typename Self, typename List>
+struct FilterImplemented;
+
+template <typename Self>
+struct FilterImplemented<Self, InterfaceList<>> {
+    using type = InterfaceList<>;
+};
+
+template <typename Self, typename First, typename... Rest>
+struct FilterImplemented<Self, InterfaceList<First, Rest...>> {
+    using type = typename ConcatInterfaces<
+        std::conditional_t<std::is_base_of_v<First, Self>, InterfaceList<First>,
+                           InterfaceList<>>,
+        typename FilterImplemented<Self, InterfaceList<Rest...>>::type>::type;
+};
+
+}  // namespace detail
+
+/// The built-in interfaces `Self` derives from, for wrappers whose bases
+/// depend on template arguments. Drivers spell theirs out instead.
+template <typename Self>
+using ImplementedInterfaces =
+    typename detail::FilterImplemented<Self, BuiltinInterfaces>::type;
+
+/// Device::QueryInterface for a device implementing exactly `Interfaces`:
+/// a compare per listed interface and a static upcast, no RTTI. Fails to
+/// compile if the list misses a built-in interface `Self` derives from or
+/// names one it does not, so the descriptor cannot drift from the class.
+///
+///   using Interfaces = InterfaceList<I2c, SmBus, Spi>;
+///   void* QueryInterface(InterfaceKind kind) override {
+///       return QueryInterfaceOf(this, kind, Interfaces{});
+///   }
+template <typename Self, typename... Interfaces>
+void* QueryInterfaceOf([[maybe_unused]] Self* self, [[maybe_unused]] InterfaceKind kind,
+                       InterfaceList<Interfaces...>) {
+    static_assert((std::is_base_of_v<Interfaces, Self> && ...),
+                  "device does not implement a listed interface");
+    static_assert(detail::CountImplemented<Self, BuiltinInterfaces>::value ==
+                      sizeof...(Interfaces),
+                  "device implements a built-in interface missing from its list");
+    void* result = nullptr;
+    (void)((kind == InterfaceKindOf<Interfaces>::value
+                ? (result = static_cast<void*>(static_cast<Interfaces*>(self)), true)
+                : false) ||
+           ...);
+    return result;
+}
+
+}  // namespace plas::hal
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "plas/core/result.h"
+
+namespace plas::hal {
+
+class Device;  // forward declaration
+
+/// General-purpose I/O pins of an adapter. Pins are addressed as a bit
+/// mask (bit i = the backend's pin i), so several pins change in one
+/// transaction.
+class Gpio {
+public:
+    virtual ~Gpio() = default;
+
+    virtual std::string InterfaceName() const { return "Gpio"; }
+    virtual Device* GetDevice() = 0;
+
+    /// Pins this device may use; the other calls reject pins outside it
+    /// with kInvalidArgument.
+    virtual uint32_t PinMask() const = 0;
+
+    /// Make the pins in `mask` outputs where `outputs` has a 1 and inputs
+    /// where it has a 0. Other pins keep their direction.
+    virtual core::Result<void> SetDirection(uint32_t mask, uint32_t outputs) = 0;
+
+    /// Drive the output pins in `mask` to the matching bits of `values`.
+    /// Other pins are left alone.
+    virtual core::Result<void> WritePins(uint32_t mask, uint32_t values) = 0;
+
+    /// Level of every pin in PinMask(), inputs and outputs alike.
+    virtual core::Result<uint32_t> ReadPins() = 0;
+};
+
+}  // namespace plas::hal
@@ -1,9 +1,14 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "plas/core/byte_buffer.h"
+#include "plas/core/error.h"
 #include "plas/core/result.h"
 #include "plas/core/types.h"
 
@@ -11,6 +16,18 @@ namespace plas::hal {
 
 class Device;  // forward declaration
 
+/// One segment of a combined I2C transaction (cf. Linux struct i2c_msg).
+/// Consecutive messages are joined by a repeated START unless `stop` is set;
+/// the last message in a Transfer always ends with STOP.
+struct I2cMessage {
+    core::Address addr = 0;
+    core::Byte* data = nullptr;  ///< read destination or write source
+    size_t length = 0;
+    bool read = false;
+    bool stop = false;
+    size_t transferred = 0;  ///< bytes moved, filled in by Transfer
+};
+
 class I2c {
 public:
     virtual ~I2c() = default;
@@ -28,8 +45,102 @@ public:
                                            size_t write_len,
                                            core::Byte* read_data,
                                            size_t read_len) = 0;
+
+    /// Run `count` messages back to back. Returns the number of messages
+    /// completed; the first failure aborts the rest of the batch.
+    ///
+    /// The default implementation issues one Read/Write per message.
+    /// Backends override it to hold the bus once for the whole batch.
+    virtual core::Result<size_t> Transfer(I2cMessage* msgs, size_t count) {
+        if (msgs == nullptr && count > 0) {
+            return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            auto& msg = msgs[i];
+            bool stop = msg.stop || i + 1 == count;
+            auto result = msg.read
+                              ? Read(msg.addr, msg.data, msg.length, stop)
+                              : Write(msg.addr, msg.data, msg.length, stop);
+            if (result.IsError()) {
+                return core::Result<size_t>::Err(result.Error());
+            }
+            msg.transferred = result.Value();
+        }
+        return core::Result<size_t>::Ok(count);
+    }
+
+    /// True if a target ACKs `addr`. The default reads one byte and takes
+    /// kIOError or kTimeout (how backends report a NACK) as no target;
+    /// backends that can address a target without moving data (a
+    /// zero-length "quick" write) override it. Other errors are returned.
+    virtual core::Result<bool> Probe(core::Address addr) {
+        core::Byte byte = 0;
+        auto result = Read(addr, &byte, 1);
+        if (result.IsOk()) {
+            return core::Result<bool>::Ok(result.Value() > 0);
+        }
+        if (result.Error() == core::make_error_code(core::ErrorCode::kIOError) ||
+            result.Error() == core::make_error_code(core::ErrorCode::kTimeout)) {
+            return core::Result<bool>::Ok(false);
+        }
+        return core::Result<bool>::Err(result.Error());
+    }
+
+    /// Probe() every 7-bit address in [first, last]; the ones that ACK, in
+    /// ascending order. `timeout` bounds each probe where the backend can
+    /// shorten its bus timeout (0 = as configured; the default ignores it).
+    /// kInvalidArgument for an empty or out-of-range span, otherwise the
+    /// first error Probe() returns.
+    virtual core::Result<std::vector<core::Address>> Scan(
+        core::Address first, core::Address last,
+        std::chrono::milliseconds timeout = std::chrono::milliseconds{0}) {
+        (void)timeout;
+        if (first > last || last > 0x7F) {
+            return core::Result<std::vector<core::Address>>::Err(
+                core::ErrorCode::kInvalidArgument);
+        }
+        std::vector<core::Address> found;
+        for (core::Address addr = first; addr <= last; ++addr) {
+            auto present = Probe(addr);
+            if (present.IsError()) {
+                return core::Result<std::vector<core::Address>>::Err(present.Error());
+            }
+            if (present.Value()) {
+                found.push_back(addr);
+            }
+        }
+        return core::Result<std::vector<core::Address>>::Ok(std::move(found));
+    }
+
     virtual core::Result<void> SetBitrate(uint32_t bitrate) = 0;
     virtual uint32_t GetBitrate() const = 0;
+
+    /// Append up to `length` bytes read from `addr` to `out`, without
+    /// zero-filling; `out` keeps only the bytes actually read.
+    core::Result<size_t> ReadBytes(core::Address addr, core::ByteBuffer& out,
+                                   size_t length, bool stop = true) {
+        size_t base = out.Size();
+        auto result = Read(addr, out.AppendUninitialized(length), length, stop);
+        out.Resize(base + (result.IsOk() ? result.Value() : 0));
+        return result;
+    }
+
+    core::Result<size_t> WriteBytes(core::Address addr, core::ByteView data,
+                                    bool stop = true) {
+        return Write(addr, data.Data(), data.Size(), stop);
+    }
+
+    /// WriteRead with the response appended to `out` (see ReadBytes).
+    core::Result<size_t> WriteReadBytes(core::Address addr,
+                                        core::ByteView write_data,
+                                        core::ByteBuffer& out,
+                                        size_t read_len) {
+        size_t base = out.Size();
+        auto result = WriteRead(addr, write_data.Data(), write_data.Size(),
+                                out.AppendUninitialized(read_len), read_len);
+        out.Resize(base + (result.IsOk() ? result.Value() : 0));
+        return result;
+    }
 };
 
 }  // namespace plas::hal
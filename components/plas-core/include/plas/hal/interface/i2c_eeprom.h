@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+#include "plas/hal/interface/i2c.h"
+
+namespace plas::hal {
+
+/// Layout of a 24Cxx-style serial EEPROM.
+///
+/// Memory offsets wider than the `address_bytes` sent on the bus go into
+/// the low bits of the device address (block select), as on the 24C04-16
+/// and 24C1024: byte 0x1A5 of a 24C04 at 0x50 is register 0xA5 of 0x51.
+struct I2cEepromGeometry {
+    std::size_t size = 256;       ///< bytes, a power of two
+    std::size_t page_size = 8;    ///< write page, a power of two
+    uint8_t address_bytes = 1;    ///< memory address bytes (1 or 2), MSB first
+
+    /// Geometry of a common part: "24c02" through "24c512" and "24c1024"
+    /// (case-insensitive, an "at"/"m" prefix is accepted). kNotFound for
+    /// other names.
+    static core::Result<I2cEepromGeometry> FromPart(std::string_view part);
+};
+
+struct I2cEepromOptions {
+    /// Bytes per sequential read; every backend accepts 32 KiB (the
+    /// Aardvark caps a transfer at 64 KiB - 1).
+    std::size_t max_read_chunk = 0x8000;
+    /// Longest write cycle (datasheet tWR, 5 ms on most parts) before
+    /// ACK-polling gives up with kTimeout.
+    std::chrono::milliseconds write_timeout{10};
+    /// Pause between ACK polls; 0 polls back to back (one bus round trip
+    /// apart).
+    std::chrono::microseconds poll_interval{0};
+    /// Write(): read the range first and write only the pages that differ.
+    bool skip_unchanged = false;
+    /// Write(): read the range back afterwards; kDataLoss on a mismatch.
+    bool verify = false;
+};
+
+struct I2cEepromStats {
+    uint64_t pages_written = 0;
+    uint64_t pages_skipped = 0;   ///< unchanged pages (skip_unchanged)
+    uint64_t bytes_written = 0;
+    uint64_t bytes_read = 0;
+    uint64_t read_transfers = 0;  ///< I2c::Transfer batches issued by reads
+    uint64_t ack_polls = 0;       ///< NACKed attempts while a write cycle ran
+};
+
+/// Block access to one serial EEPROM (24Cxx, FRU) over I2c.
+///
+/// Read() issues a whole range as one I2c::Transfer of pointer-write +
+/// sequential-read pairs, split only at options.max_read_chunk and at
+/// block-select boundaries, so backends that batch (Aardvark) take the bus
+/// once. Write() splits at page boundaries, where the part would wrap, and
+/// waits out each write cycle by ACK polling instead of a fixed delay: the
+/// next page's write is itself the poll, retried while the part NACKs, and
+/// only the last page is followed by I2c::Probe() polls. Write() returns
+/// once every byte is committed.
+///
+/// Not thread-safe; the bus must outlive the helper.
+class I2cEeprom {
+public:
+    /// `addr` is the device address of the first block.
+    I2cEeprom(I2c& bus, core::Address addr, I2cEepromGeometry geometry,
+              I2cEepromOptions options = {});
+
+    const I2cEepromGeometry& Geometry() const { return geometry_; }
+
+    /// kOutOfRange past the end of the part, kInvalidArgument for a null
+    /// buffer or a bad geometry, otherwise the bus error.
+    core::Result<void> Read(std::size_t offset, core::Byte* data, std::size_t length);
+    core::Result<void> Write(std::size_t offset, const core::Byte* data, std::size_t length);
+
+    /// Read [offset, offset + length) back and compare; kDataLoss on a
+    /// mismatch.
+    core::Result<void> Verify(std::size_t offset, const core::Byte* data, std::size_t length);
+
+    /// Poll until the part ACKs (a write cycle has finished); kTimeout after
+    /// options.write_timeout.
+    core::Result<void> WaitReady();
+
+    I2cEepromStats Stats() const { return stats_; }
+    void ResetStats() { stats_ = {}; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    bool ValidGeometry() const;
+    core::Result<void> CheckRange(std::size_t offset, const void* data,
+                                  std::size_t length) const;
+    /// Device address and on-bus memory address of `offset`.
+    core::Address DeviceFor(std::size_t offset) const;
+    std::size_t BlockSize() const;
+    core::Result<void> WritePage(std::size_t offset, const core::Byte* data,
+                                 std::size_t length);
+    void Pause() const;
+
+    I2c& bus_;
+    core::Address addr_;
+    I2cEepromGeometry geometry_;
+    I2cEepromOptions options_;
+    I2cEepromStats stats_;
+    /// End of the last page write; a cycle may run until + write_timeout.
+    Clock::time_point last_write_{};
+    bool write_pending_ = false;
+};
+
+}  // namespace plas::hal
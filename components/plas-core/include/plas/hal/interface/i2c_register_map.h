@@ -0,0 +1,148 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+#include "plas/hal/interface/i2c.h"
+
+namespace plas::hal {
+
+/// One register of an I2C target: `size` bytes at register address
+/// `offset`, read as an unsigned value.
+struct I2cRegister {
+    std::string name;
+    uint16_t offset = 0;
+    uint8_t size = 1;            ///< 1-8 bytes
+    bool little_endian = false;  ///< byte order of the value (default MSB first)
+    /// Fixed for the life of the target (ID, revision, calibration): read
+    /// once, then answered from the cache. Writes are rejected.
+    bool constant = false;
+    /// Poll() reads it at most this often; 0 reads it on every poll.
+    std::chrono::milliseconds period{0};
+};
+
+/// One target on the bus and its registers.
+struct I2cRegisterDevice {
+    std::string name;
+    core::Address addr = 0;
+    uint8_t offset_width = 1;    ///< register address bytes (1 or 2), sent MSB first
+    /// The target advances the register pointer on sequential reads, so
+    /// neighbouring registers can be read in one transfer. False gives
+    /// every register its own transfer.
+    bool auto_increment = true;
+    std::vector<I2cRegister> registers;
+};
+
+/// Index of a register across all devices of a map (AddDevice order, then
+/// register order).
+using I2cRegisterId = uint32_t;
+
+/// One coalesced read: `length` bytes of device `device` from `offset`.
+struct I2cReadBlock {
+    uint32_t device;
+    uint16_t offset;
+    uint16_t length;
+};
+
+struct I2cRegisterMapOptions {
+    std::size_t max_block = 32;  ///< bytes per coalesced read
+    /// Unused bytes a read may span to join two registers; 0 joins only
+    /// registers that touch.
+    std::size_t max_gap = 4;
+    std::chrono::milliseconds interval{100};  ///< Start(): time between polls
+};
+
+struct I2cRegisterMapStats {
+    uint64_t polls = 0;
+    uint64_t transfers = 0;      ///< write-pointer + read pairs put on the bus
+    uint64_t bytes_read = 0;
+    uint64_t registers_read = 0;
+    uint64_t cache_hits = 0;     ///< constant registers answered from the cache
+    uint64_t errors = 0;         ///< failed transfers
+};
+
+/// Parse a register map from text, as held by the `regmap` arg of an I2C
+/// device entry:
+///
+///   tmp75@0x48: temp=0x00/2, config=0x01; ina226@0x40: id=0xFE/2/const
+///
+/// Devices are separated by ';' as `name@addr[/a16][/noinc]: registers`,
+/// registers by ',' as `name=offset` followed by '/'-separated size (1-8,
+/// default 1), `le`, `const` and a period like `500ms`. Numbers are
+/// decimal or 0x hex. kInvalidArgument with anything else.
+core::Result<std::vector<I2cRegisterDevice>> ParseI2cRegisterMap(std::string_view text);
+
+/// Declarative register access to the targets on one I2C bus.
+///
+/// Poll() reads every due register of every device with as few bus
+/// transactions as possible: registers of one target that lie within
+/// options.max_gap bytes of each other are read by one block WriteRead
+/// (register pointer write, repeated START, sequential read) of up to
+/// options.max_block bytes, and all blocks of a poll go to the backend as
+/// one I2c::Transfer so the bus is taken once. Constant registers are read
+/// once and then served from the cache. If the batch fails, the blocks are
+/// retried one by one so a target that NACKs does not hide the others.
+///
+/// Start() polls from a timer on core::Executor::Shared(). Devices are
+/// added before Start(); the bus must outlive the map.
+class I2cRegisterMap {
+public:
+    /// Called on an executor worker after each timed poll with its result.
+    using PollCallback = std::function<void(core::Result<void> result)>;
+
+    explicit I2cRegisterMap(I2c& bus, I2cRegisterMapOptions options = {});
+    ~I2cRegisterMap();  // Stop()
+
+    I2cRegisterMap(const I2cRegisterMap&) = delete;
+    I2cRegisterMap& operator=(const I2cRegisterMap&) = delete;
+
+    /// Add a target; returns its index. kInvalidArgument for a duplicate
+    /// device or register name, a bad size or offset width, or a register
+    /// past the end of the register space. kBusy while running.
+    core::Result<uint32_t> AddDevice(I2cRegisterDevice device);
+    /// AddDevice for each device of ParseI2cRegisterMap(text); all or none.
+    core::Result<void> AddDevices(std::string_view text);
+    std::size_t DeviceCount() const;
+
+    /// kNotFound for an unknown device or register name.
+    core::Result<I2cRegisterId> Find(std::string_view device, std::string_view reg) const;
+
+    /// Read one register now (constant ones from the cache once read).
+    core::Result<uint64_t> Read(I2cRegisterId id);
+    /// Write one register; kInvalidArgument for a constant register or a
+    /// value wider than the register.
+    core::Result<void> Write(I2cRegisterId id, uint64_t value);
+
+    /// The value from the last successful read of `id` (Poll() or Read()).
+    /// kNotFound before the first one; the error of the last attempt if it
+    /// failed.
+    core::Result<uint64_t> Value(I2cRegisterId id) const;
+
+    /// The reads one Poll() would issue now, in issue order.
+    std::vector<I2cReadBlock> PlanPoll() const;
+
+    /// Read all due registers; the first transfer error, if any.
+    core::Result<void> Poll();
+
+    /// Poll every options.interval until Stop(). kAlreadyOpen if running.
+    /// Stop() returns once a poll in progress has finished.
+    core::Result<void> Start(PollCallback callback = {});
+    void Stop();
+    bool IsRunning() const;
+
+    I2cRegisterMapStats Stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <string>
+#include <vector>
 
 #include "plas/core/result.h"
+#include "plas/core/spsc_ring.h"
 #include "plas/core/types.h"
 #include "plas/core/units.h"
 
@@ -12,6 +16,59 @@ namespace plas::hal {
 
 class Device;  // forward declaration
 
+/// Common Command Codes used by the library (MIPI I3C Basic v1.1).
+/// Broadcast codes are 0x00-0x7F, direct codes 0x80-0xFE.
+namespace i3c_ccc {
+inline constexpr uint8_t kRstdaa = 0x06;   ///< broadcast: reset dynamic addresses
+inline constexpr uint8_t kEntdaa = 0x07;   ///< broadcast: enter dynamic address assignment
+inline constexpr uint8_t kSetmwlAll = 0x09;
+inline constexpr uint8_t kSetmrlAll = 0x0A;
+inline constexpr uint8_t kSetnewda = 0x88;
+inline constexpr uint8_t kSetmwl = 0x89;
+inline constexpr uint8_t kSetmrl = 0x8A;
+inline constexpr uint8_t kGetmwl = 0x8B;
+inline constexpr uint8_t kGetmrl = 0x8C;
+inline constexpr uint8_t kGetpid = 0x8D;
+inline constexpr uint8_t kGetbcr = 0x8E;
+inline constexpr uint8_t kGetdcr = 0x8F;
+}  // namespace i3c_ccc
+
+/// One entry of the bus's dynamic address table: what ENTDAA (or the
+/// GETPID/GETBCR/GETDCR/GETMRL/GETMWL CCCs) reported for a target.
+struct I3cTargetInfo {
+    core::Address dynamic_address = 0;
+    uint64_t pid = 0;  ///< 48-bit provisioned ID
+    uint8_t bcr = 0;   ///< bus characteristics register
+    uint8_t dcr = 0;   ///< device characteristics register
+    uint16_t max_read_length = 0;   ///< 0 = not known
+    uint16_t max_write_length = 0;  ///< 0 = not known
+
+    bool IbiCapable() const { return (bcr & 0x02) != 0; }
+    bool HdrCapable() const { return (bcr & 0x20) != 0; }
+};
+
+/// One in-band interrupt as the controller received it.
+struct I3cIbi {
+    static constexpr size_t kMaxPayload = 16;
+
+    uint64_t timestamp_ns = 0;  ///< steady_clock when the controller took the IBI
+    core::Address addr = 0;     ///< dynamic address of the target that raised it
+    uint8_t length = 0;         ///< bytes in `payload`; payload[0] is the MDB if sent
+    bool truncated = false;     ///< the target sent more than kMaxPayload bytes
+    std::array<core::Byte, kMaxPayload> payload{};
+};
+
+using I3cIbiQueue = core::SpscRing<I3cIbi>;
+
+struct I3cIbiOptions {
+    /// Targets whose IBIs are enabled (ENEC); empty = every IBI-capable target.
+    std::vector<core::Address> targets;
+    /// Delivery: called on the backend's IBI thread, and/or pushed to
+    /// `queue` (caller-owned, one consumer). At least one is required.
+    std::function<void(const I3cIbi&)> callback;
+    I3cIbiQueue* queue = nullptr;
+};
+
 class I3c {
 public:
     virtual ~I3c() = default;
@@ -42,6 +99,59 @@ public:
                                                size_t length) = 0;
 
     virtual core::Result<void> SetFrequency(core::Frequency freq) = 0;
+
+    // Dynamic address table from the last assignment, answered from the
+    // backend's cache without bus traffic. Default: kNotSupported.
+    virtual core::Result<std::vector<I3cTargetInfo>> GetTargets() {
+        return core::Result<std::vector<I3cTargetInfo>>::Err(
+            core::ErrorCode::kNotSupported);
+    }
+
+    // Assign dynamic addresses to targets that have none (ENTDAA) and
+    // refresh the cache; returns how many targets were added. Targets that
+    // already have an address keep it. Default: kNotSupported.
+    virtual core::Result<size_t> AssignDynamicAddresses() {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    // HDR-DDR private transfers for bulk data. `command` is the HDR command
+    // code: 0x80-0xFF read, 0x00-0x7F write (kInvalidArgument otherwise).
+    // Default: kNotSupported.
+    virtual core::Result<size_t> HdrDdrRead(core::Address addr, uint8_t command,
+                                            core::Byte* data, size_t length) {
+        (void)addr;
+        (void)command;
+        (void)data;
+        (void)length;
+        return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+    }
+    virtual core::Result<size_t> HdrDdrWrite(core::Address addr, uint8_t command,
+                                             const core::Byte* data,
+                                             size_t length) {
+        (void)addr;
+        (void)command;
+        (void)data;
+        (void)length;
+        return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    // Enable IBIs from `options.targets` and deliver each one, timestamped,
+    // until StopIbi(). Backends reject options ValidateIbiOptions() refuses.
+    // Default: kNotSupported.
+    virtual core::Result<void> StartIbi(const I3cIbiOptions& options) {
+        (void)options;
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    virtual core::Result<void> StopIbi() { return core::Result<void>::Ok(); }
+    virtual bool IsIbiActive() const { return false; }
+
+    // kInvalidArgument for no callback and no queue.
+    static core::Result<void> ValidateIbiOptions(const I3cIbiOptions& options) {
+        if (!options.callback && options.queue == nullptr) {
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        }
+        return core::Result<void>::Ok();
+    }
 };
 
 }  // namespace plas::hal
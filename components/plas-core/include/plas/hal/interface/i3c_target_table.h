@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+#include "plas/hal/interface/i3c.h"
+
+namespace plas::hal {
+
+/// Cached dynamic address table of one I3C bus, shared by I3c backends.
+/// The backend fills it once after ENTDAA and then answers GETPID, GETBCR,
+/// GETDCR, GETMRL and GETMWL from it instead of going to the bus; Observe()
+/// keeps it coherent with SET CCCs the backend does send. Thread-safe.
+class I3cTargetTable {
+public:
+    /// Size of one ENTDAA arbitration record: PID (6, MSB first), BCR, DCR.
+    static constexpr std::size_t kDaaRecordSize = 8;
+
+    /// A 7-bit address a controller may hand out as a dynamic address:
+    /// 0x08-0x77 minus 0x3E/0x5E/0x6E/0x76, which are one bit away from
+    /// the broadcast address 0x7E.
+    static bool IsAssignable(core::Address addr);
+
+    /// Decode an ENTDAA record for the target that was given `dynamic_address`.
+    static I3cTargetInfo FromDaaRecord(const core::Byte* record,
+                                       core::Address dynamic_address);
+
+    /// kInvalidArgument for an address IsAssignable() rejects, or a PID or
+    /// address already in the table.
+    core::Result<void> Add(const I3cTargetInfo& target);
+    void Clear();
+
+    std::optional<I3cTargetInfo> Find(core::Address dynamic_address) const;
+    std::optional<I3cTargetInfo> FindByPid(uint64_t pid) const;
+    std::vector<I3cTargetInfo> Targets() const;  ///< in address order
+    std::size_t Size() const;
+
+    /// Lowest assignable address at or above `from` not in the table;
+    /// kResourceExhausted when none is left.
+    core::Result<core::Address> NextFreeAddress(core::Address from = 0x08) const;
+
+    /// Answer a direct GET CCC from the cache. kNotFound for an unknown
+    /// address, kNotSupported for a CCC the table does not hold (or a
+    /// MRL/MWL that was never reported), kInvalidArgument if `length` is
+    /// shorter than the reply.
+    core::Result<std::size_t> Answer(uint8_t ccc, core::Address addr,
+                                     core::Byte* data, std::size_t length) const;
+
+    /// Apply a CCC that was sent successfully: RSTDAA clears the table,
+    /// SETNEWDA moves a target, SETMRL/SETMWL (direct or broadcast) update
+    /// the cached lengths. Other CCCs are ignored. `addr` is unused for
+    /// broadcast CCCs.
+    void Observe(uint8_t ccc, core::Address addr, const core::Byte* data,
+                 std::size_t length);
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<I3cTargetInfo> targets_;  // sorted by dynamic_address
+};
+
+}  // namespace plas::hal
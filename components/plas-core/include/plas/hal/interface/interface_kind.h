@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace plas::hal {
+
+class I2c;
+class I3c;
+class Serial;
+class Uart;
+class PowerControl;
+class SsdGpio;
+class SmBus;
+class Spi;
+class Gpio;
+
+namespace pci {
+class PciConfig;
+class PciDoe;
+class PciBar;
+class Cxl;
+class CxlMailbox;
+}  // namespace pci
+
+/// Built-in device interfaces. DeviceManager resolves each device against
+/// all of them once, when the device is added, so GetInterface<T>() for
+/// these types is a table lookup instead of a dynamic_cast.
+enum class InterfaceKind : uint8_t {
+    kI2c = 0,
+    kI3c,
+    kSerial,
+    kUart,
+    kPowerControl,
+    kSsdGpio,
+    kPciConfig,
+    kPciDoe,
+    kPciBar,
+    kCxl,
+    kCxlMailbox,
+    kSmBus,
+    kSpi,
+    kGpio,
+    kCount,  // number of interfaces, not an interface
+};
+
+inline constexpr std::size_t kInterfaceKindCount =
+    static_cast<std::size_t>(InterfaceKind::kCount);
+
+/// InterfaceKindOf<T>::value is the kind of built-in interface T; undefined
+/// for any other type.
+template <typename T>
+struct InterfaceKindOf {};
+
+#define PLAS_HAL_INTERFACE_KIND(Type, Kind)                                  \
+    template <>                                                              \
+    struct InterfaceKindOf<Type>                                             \
+        : std::integral_constant<InterfaceKind, InterfaceKind::Kind> {}
+
+PLAS_HAL_INTERFACE_KIND(I2c, kI2c);
+PLAS_HAL_INTERFACE_KIND(I3c, kI3c);
+PLAS_HAL_INTERFACE_KIND(Serial, kSerial);
+PLAS_HAL_INTERFACE_KIND(Uart, kUart);
+PLAS_HAL_INTERFACE_KIND(PowerControl, kPowerControl);
+PLAS_HAL_INTERFACE_KIND(SsdGpio, kSsdGpio);
+PLAS_HAL_INTERFACE_KIND(pci::PciConfig, kPciConfig);
+PLAS_HAL_INTERFACE_KIND(pci::PciDoe, kPciDoe);
+PLAS_HAL_INTERFACE_KIND(pci::PciBar, kPciBar);
+PLAS_HAL_INTERFACE_KIND(pci::Cxl, kCxl);
+PLAS_HAL_INTERFACE_KIND(pci::CxlMailbox, kCxlMailbox);
+PLAS_HAL_INTERFACE_KIND(SmBus, kSmBus);
+PLAS_HAL_INTERFACE_KIND(Spi, kSpi);
+PLAS_HAL_INTERFACE_KIND(Gpio, kGpio);
+
+#undef PLAS_HAL_INTERFACE_KIND
+
+/// True if T is one of the built-in interfaces above.
+template <typename T, typename = void>
+struct HasInterfaceKind : std::false_type {};
+
+template <typename T>
+struct HasInterfaceKind<T, std::void_t<decltype(InterfaceKindOf<T>::value)>>
+    : std::true_type {};
+
+}  // namespace plas::hal
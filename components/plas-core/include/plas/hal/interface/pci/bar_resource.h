@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "plas/core/result.h"
+
+namespace plas::hal::pci {
+
+/// One line of a device's sysfs `resource` file: the BAR's address range
+/// and IORESOURCE_* flags.
+struct BarResource {
+    static constexpr uint64_t kFlagIo = 0x00000100;        // IORESOURCE_IO
+    static constexpr uint64_t kFlagMem = 0x00000200;       // IORESOURCE_MEM
+    static constexpr uint64_t kFlagPrefetch = 0x00002000;  // IORESOURCE_PREFETCH
+    static constexpr uint64_t kFlagMem64 = 0x00100000;     // IORESOURCE_MEM_64
+
+    uint64_t start = 0;
+    uint64_t end = 0;
+    uint64_t flags = 0;
+
+    bool IsImplemented() const { return end != 0 && end >= start; }
+    uint64_t Size() const { return IsImplemented() ? end - start + 1 : 0; }
+    bool IsMemory() const { return (flags & kFlagMem) != 0; }
+    bool IsPrefetchable() const { return (flags & kFlagPrefetch) != 0; }
+};
+
+inline constexpr std::size_t kBarCount = 6;
+
+/// The six standard BARs, in order. Unimplemented BARs are all zero.
+using BarResources = std::array<BarResource, kBarCount>;
+
+/// Parse the first six lines of a sysfs `resource` file
+/// ("0x<start> 0x<end> 0x<flags>" each). Missing or malformed lines leave
+/// the BAR unimplemented.
+BarResources ParseBarResources(const char* text, std::size_t length);
+
+/// Read and parse `<device_path>/resource`; kNotFound if it cannot be read.
+core::Result<BarResources> ReadBarResources(const std::string& device_path);
+
+}  // namespace plas::hal::pci
@@ -22,7 +22,9 @@ public:
     virtual std::string InterfaceName() const { return "Cxl"; }
     virtual plas::hal::Device* GetDevice() = 0;
 
-    /// Enumerate all CXL DVSECs for the given device.
+    /// Enumerate all CXL DVSECs for the given device. Implementations that
+    /// also provide PciConfig can take the DVSEC offsets from
+    /// GetCapabilityIndex(bdf).FindAll(ExtCapabilityId::kDvsec).
     virtual core::Result<std::vector<DvsecHeader>> EnumerateCxlDvsecs(
         Bdf bdf) = 0;
 
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+class Cxl;
+class PciBar;
+
+/// CXL.cache/mem capability IDs (CXL 3.1 Table 8-22).
+enum class CxlCacheMemCapId : uint16_t {
+    kCapability = 0x0001,
+    kRas = 0x0002,
+    kSecurity = 0x0003,
+    kLink = 0x0004,
+    kHdmDecoder = 0x0005,
+    kExtendedSecurity = 0x0006,
+    kIde = 0x0007,
+    kSnoopFilter = 0x0008,
+    kTimeoutIsolation = 0x0009,
+};
+
+/// Where a function's CXL.cache/mem registers live: the component register
+/// block from the Register Locator DVSEC, plus 0x1000.
+struct CxlComponentLocation {
+    uint8_t bar_index;
+    uint64_t offset;  ///< BAR offset of the CXL Capability Header
+
+    constexpr bool operator==(const CxlComponentLocation& other) const {
+        return bar_index == other.bar_index && offset == other.offset;
+    }
+
+    constexpr bool operator!=(const CxlComponentLocation& other) const {
+        return !(*this == other);
+    }
+};
+
+/// One HDM decoder (CXL 3.1 8.2.4.20.5-12).
+struct CxlHdmDecoder {
+    uint8_t index;
+    uint64_t base;
+    uint64_t size;
+    uint16_t interleave_ways;         ///< decoded (1, 2, 3, 4, 6, ...); 0 if reserved
+    uint32_t interleave_granularity;  ///< bytes (256 << IG)
+    bool lock_on_commit;
+    bool committed;
+    bool error_not_committed;
+    bool host_only;                   ///< Target Range Type: HDM-H rather than HDM-D
+    /// Target List (ports) or DPA Skip (devices), high dword first as one
+    /// 64-bit value.
+    uint64_t target_list_or_dpa_skip;
+    uint32_t control;                 ///< the Control register as read
+};
+
+/// HDM Decoder Capability structure.
+struct CxlHdmInfo {
+    uint16_t decoder_count;  ///< decoded from the capability register
+    uint8_t target_count;
+    bool enabled;            ///< Global Control: HDM Decoder Enable
+    std::vector<CxlHdmDecoder> decoders;
+};
+
+/// RAS Capability structure (CXL 3.1 8.2.4.17).
+struct CxlRasStatus {
+    uint32_t uncorrectable;           ///< Uncorrectable Error Status
+    uint32_t uncorrectable_mask;
+    uint32_t uncorrectable_severity;
+    uint32_t correctable;             ///< Correctable Error Status
+    uint32_t correctable_mask;
+    uint8_t first_error;              ///< First Error Pointer (a bit of uncorrectable)
+    std::array<uint32_t, 16> header_log;
+
+    /// Unmasked status bits.
+    uint32_t UncorrectablePending() const { return uncorrectable & ~uncorrectable_mask; }
+    uint32_t CorrectablePending() const { return correctable & ~correctable_mask; }
+};
+
+/// The CXL.cache/mem primary register range (4 KiB) as copied out of the
+/// BAR. Decoding works on the copy, with no further MMIO.
+struct CxlComponentSnapshot {
+    static constexpr std::size_t kSize = 0x1000;
+
+    uint64_t timestamp_ns = 0;  ///< steady_clock, when the copy was taken
+    std::array<core::Byte, kSize> data{};
+
+    core::DWord Read32(std::size_t offset) const;
+
+    /// Offset of capability `id` from its CXL Capability Header element,
+    /// nullopt if absent.
+    std::optional<uint16_t> FindCapability(CxlCacheMemCapId id) const;
+
+    /// kNotFound without the capability; kIOError if it runs past the range.
+    core::Result<CxlHdmInfo> HdmDecoders() const;
+    core::Result<CxlRasStatus> Ras() const;
+};
+
+/// CXL.cache/mem component registers read through PciBar MMIO.
+///
+/// Snapshot() copies the whole 4 KiB range with one BarReadBuffer (64-bit
+/// MMIO accesses on the PciBar implementations in this tree), so sampling
+/// HDM decoders and RAS status costs one bulk read instead of a BarRead32
+/// per register. The BAR mapping is the PciBar's own, made once.
+///
+///   auto location = CxlComponentRegisters::Locate(cxl, bar, bdf);
+///   CxlComponentRegisters regs(bar, bdf, location.Value());
+///   CxlComponentSnapshot snapshot;
+///   regs.Snapshot(snapshot);
+///   auto ras = snapshot.Ras();
+///
+/// Thread-safe (stateless beyond the location). The PciBar must outlive
+/// this object.
+class CxlComponentRegisters {
+public:
+    CxlComponentRegisters(PciBar& bar, Bdf bdf, CxlComponentLocation location);
+
+    /// Component register block from the Register Locator DVSEC, then a
+    /// check of the CXL Capability Header at +0x1000. kNotFound if either
+    /// is missing.
+    static core::Result<CxlComponentLocation> Locate(Cxl& cxl, PciBar& bar, Bdf bdf);
+
+    const CxlComponentLocation& Location() const { return location_; }
+
+    /// Copy the register range into `out`, reusing its storage.
+    core::Result<void> Snapshot(CxlComponentSnapshot& out);
+    core::Result<CxlComponentSnapshot> Snapshot();
+
+private:
+    PciBar& bar_;
+    Bdf bdf_;
+    CxlComponentLocation location_;
+};
+
+}  // namespace plas::hal::pci
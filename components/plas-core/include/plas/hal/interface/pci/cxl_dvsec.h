@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include "plas/core/types.h"
+#include "plas/hal/interface/pci/cxl_types.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+/// CXL DVSECs of one PCI function, parsed from a single config-space
+/// snapshot: every DVSEC header with the CXL vendor ID, the Register
+/// Locator entries, and the device type from the CXL Device DVSEC. Lets Cxl
+/// implementations answer FindCxlDvsec/GetCxlDeviceType/GetRegisterBlocks
+/// from memory instead of walking the extended capability chain.
+struct CxlDvsecIndex {
+    std::vector<DvsecHeader> dvsecs;  ///< chain order; vendor 0x1E98 only
+    std::vector<RegisterBlockEntry> register_blocks;  ///< non-empty entries
+    CxlDeviceType device_type = CxlDeviceType::kUnknown;
+
+    /// First CXL DVSEC with `id`.
+    std::optional<DvsecHeader> Find(CxlDvsecId id) const;
+
+    /// Decode the DVSECs at caps.FindAll(ExtCapabilityId::kDvsec) in `size`
+    /// bytes of config space. DVSECs extending beyond `size` keep their
+    /// header but contribute no register blocks or device type.
+    static CxlDvsecIndex Parse(const core::Byte* config, std::size_t size,
+                               const CapabilityIndex& caps);
+};
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "plas/core/io_queue.h"
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/cxl_types.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+class CxlMailbox;
+
+/// Read-only memory mapping of a firmware image file. Transfer chunks are
+/// handed to the mailbox as pointers into the mapping, so the image is never
+/// copied into an intermediate buffer. Move-only.
+class CxlFirmwareImage {
+public:
+    CxlFirmwareImage() = default;
+    ~CxlFirmwareImage();
+
+    CxlFirmwareImage(CxlFirmwareImage&& other) noexcept;
+    CxlFirmwareImage& operator=(CxlFirmwareImage&& other) noexcept;
+    CxlFirmwareImage(const CxlFirmwareImage&) = delete;
+    CxlFirmwareImage& operator=(const CxlFirmwareImage&) = delete;
+
+    /// Map `path`. kNotFound / kPermissionDenied if it cannot be opened,
+    /// kInvalidArgument if it is empty or not a regular file, kIOError if
+    /// the mapping fails.
+    static core::Result<CxlFirmwareImage> Open(const std::string& path);
+
+    const uint8_t* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+/// Transfer FW (opcode 0x0201) actions, CXL 3.1 8.2.9.3.2.
+enum class CxlFwTransferAction : uint8_t {
+    kFull = 0x00,
+    kInitiate = 0x01,
+    kContinue = 0x02,
+    kEnd = 0x03,
+    kAbort = 0x04,
+};
+
+/// Transfer FW input header; image data follows it in the payload.
+inline constexpr std::size_t kCxlFwTransferHeaderSize = 0x80;
+/// Offsets are in units of this many bytes, so every part but the last
+/// carries a multiple of it.
+inline constexpr std::size_t kCxlFwTransferUnit = 0x80;
+
+struct CxlFwTransferOptions {
+    uint8_t slot = 1;  ///< slot written by the Full / End transfer
+    /// First backoff after kBusy / kRetryRequired, doubled up to
+    /// max_backoff.
+    std::chrono::microseconds backoff{100};
+    std::chrono::microseconds max_backoff{10000};
+    /// GetBackgroundCmdStatus poll period while a part runs in background.
+    std::chrono::microseconds background_poll{1000};
+    /// Longest one part may take, retries and background time included.
+    std::chrono::milliseconds chunk_timeout{30000};
+    /// TransferFirmwareAll targets in flight, on core::Executor::Shared()
+    /// and the calling thread; 0 = as many as the executor runs.
+    std::size_t max_parallel = 0;
+    /// I/O priority the parts are sent at. Background lets control
+    /// commands on the same mailbox go first between parts.
+    core::IoPriority priority = core::IoPriority::kBackground;
+};
+
+struct CxlFwProgress {
+    std::size_t target;  ///< index into the TransferFirmwareAll targets
+    std::size_t bytes_sent;
+    std::size_t total;
+};
+
+/// Called after each accepted part. TransferFirmwareAll calls it from its
+/// worker threads concurrently, so it must be thread-safe.
+using CxlFwProgressCallback = std::function<void(const CxlFwProgress&)>;
+
+/// Send `image` to one device with Transfer FW, split into the largest
+/// parts the mailbox payload allows (one Full transfer if it fits,
+/// otherwise Initiate / Continue... / End). Each part is gathered from a
+/// stack header and a pointer into `image`.
+///
+/// kBusy / kRetryRequired (and a kBusy error from the backend) are retried
+/// with exponential backoff; kBackgroundCmdStarted is polled through
+/// GetBackgroundCmdStatus until the part finishes. Any other return code
+/// aborts the transfer (best effort) and is returned as the value;
+/// kSuccess means the image is in `options.slot`. kTimeout if one part
+/// exceeds chunk_timeout.
+core::Result<CxlMailboxReturnCode> TransferFirmware(
+    CxlMailbox& mailbox, Bdf bdf, const uint8_t* image, std::size_t size,
+    const CxlFwTransferOptions& options = {},
+    const CxlFwProgressCallback& progress = {}, std::size_t target = 0);
+
+struct CxlFwTarget {
+    CxlMailbox* mailbox;
+    Bdf bdf;
+};
+
+/// TransferFirmware to every target at once, at most
+/// options.max_parallel in flight. Results are in target order; a failure
+/// on one target does not stop the others.
+std::vector<core::Result<CxlMailboxReturnCode>> TransferFirmwareAll(
+    const std::vector<CxlFwTarget>& targets, const uint8_t* image,
+    std::size_t size, const CxlFwTransferOptions& options = {},
+    const CxlFwProgressCallback& progress = {});
+
+}  // namespace plas::hal::pci
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <string>
 
+#include "plas/core/error.h"
 #include "plas/core/result.h"
 #include "plas/hal/interface/pci/cxl_types.h"
 #include "plas/hal/interface/pci/types.h"
@@ -28,6 +32,52 @@ public:
         Bdf bdf, uint16_t raw_opcode,
         const CxlMailboxPayload& payload) = 0;
 
+    /// ExecuteCommand with the input payload gathered from two caller
+    /// buffers, `header` followed by `data` (e.g. a Transfer FW header and a
+    /// slice of a memory-mapped image).
+    ///
+    /// The default implementation concatenates them into a
+    /// CxlMailboxPayload; backends override it to write both straight into
+    /// the mailbox payload registers.
+    virtual core::Result<CxlMailboxResult> ExecuteCommandGather(
+        Bdf bdf, uint16_t raw_opcode, const uint8_t* header,
+        std::size_t header_len, const uint8_t* data, std::size_t data_len) {
+        if ((header_len > 0 && !header) || (data_len > 0 && !data)) {
+            return core::Result<CxlMailboxResult>::Err(
+                core::ErrorCode::kInvalidArgument);
+        }
+        CxlMailboxPayload payload(header_len + data_len);
+        if (header_len > 0) {
+            std::memcpy(payload.data(), header, header_len);
+        }
+        if (data_len > 0) {
+            std::memcpy(payload.data() + header_len, data, data_len);
+        }
+        return ExecuteCommand(bdf, raw_opcode, payload);
+    }
+
+    /// ExecuteCommand with the output payload in a core::BufferPool buffer
+    /// and the input read from `payload`/`length`. Once the calling thread
+    /// has released one result of that size class, a polling loop that
+    /// drops each result before the next command allocates nothing.
+    ///
+    /// The default implementation copies the result of ExecuteCommandGather;
+    /// backends override it to read the mailbox straight into the buffer.
+    virtual core::Result<CxlMailboxPooledResult> ExecuteCommandPooled(
+        Bdf bdf, uint16_t raw_opcode, const uint8_t* payload,
+        std::size_t length) {
+        auto result =
+            ExecuteCommandGather(bdf, raw_opcode, payload, length, nullptr, 0);
+        if (result.IsError()) {
+            return core::Result<CxlMailboxPooledResult>::Err(result.Error());
+        }
+        const auto& output = result.Value().payload;
+        return core::Result<CxlMailboxPooledResult>::Ok(
+            CxlMailboxPooledResult{
+                result.Value().return_code,
+                core::PooledBytes(output.data(), output.size())});
+    }
+
     /// Query the maximum payload size supported by the mailbox.
     virtual core::Result<uint32_t> GetPayloadSize(Bdf bdf) = 0;
 
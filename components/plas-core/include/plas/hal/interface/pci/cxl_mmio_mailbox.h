@@ -0,0 +1,141 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/cxl_types.h"
+#include "plas/hal/interface/pci/irq_signal.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+class Cxl;
+class PciBar;
+
+/// Where a function's Primary Mailbox registers live.
+struct CxlMailboxLocation {
+    uint8_t bar_index;
+    uint64_t offset;  ///< BAR offset of Mailbox Capabilities (mailbox + 0x00)
+
+    constexpr bool operator==(const CxlMailboxLocation& other) const {
+        return bar_index == other.bar_index && offset == other.offset;
+    }
+
+    constexpr bool operator!=(const CxlMailboxLocation& other) const {
+        return !(*this == other);
+    }
+};
+
+struct CxlMmioMailboxOptions {
+    /// Longest Execute() waits for the doorbell to clear (less if the
+    /// caller's core::Deadline comes first).
+    std::chrono::milliseconds timeout{2000};
+    /// Doorbell is re-read without sleeping for this long, then with
+    /// exponential backoff from 1 us up to poll_interval.
+    std::chrono::microseconds spin{20};
+    std::chrono::microseconds poll_interval{100};
+    /// Raised by the interrupt vector of the mailbox's Interrupt Message
+    /// Number (Mailbox Capabilities [10:7]). When set and the mailbox is
+    /// doorbell-interrupt capable (Capabilities bit 5), Submit() also sets
+    /// the Doorbell Interrupt enable and Execute() sleeps on the signal
+    /// after the spin window instead of polling.
+    std::shared_ptr<IrqSignal> doorbell_irq;
+};
+
+/// Background Command Status register (mailbox + 0x18) together with the
+/// Background Operation bit of Mailbox Status.
+struct CxlBackgroundStatus {
+    bool running;  ///< a background command is still executing
+    uint16_t opcode;
+    uint8_t percent_complete;
+    CxlMailboxReturnCode return_code;  ///< meaningful once !running
+    uint64_t raw;                      ///< the register as read
+};
+
+/// CXL Primary Mailbox driven through PciBar MMIO (CXL 3.1 8.2.8.4).
+///
+/// Payloads move with BarWriteBuffer/BarReadBuffer, i.e. 64-bit MMIO
+/// accesses on the PciBar implementations in this tree. The mailbox
+/// location and payload size are resolved once, so each command costs the
+/// payload copy, a command-register write, the doorbell read-modify-write,
+/// doorbell polls and the status/payload reads.
+///
+/// Execute() runs one command to completion. Submit()/TryComplete() split it
+/// so one thread can keep many mailboxes busy (ring every doorbell, then
+/// collect). Commands the device runs in the background (Sanitize, Transfer
+/// FW, ...) complete with kBackgroundCmdStarted; GetBackgroundStatus()
+/// tracks them without occupying the mailbox.
+///
+/// Thread-safe; the mailbox runs one command at a time. The PciBar must
+/// outlive this object.
+class CxlMmioMailbox {
+public:
+    CxlMmioMailbox(PciBar& bar, Bdf bdf, CxlMailboxLocation location,
+                   CxlMmioMailboxOptions options = {});
+    ~CxlMmioMailbox();
+
+    CxlMmioMailbox(const CxlMmioMailbox&) = delete;
+    CxlMmioMailbox& operator=(const CxlMmioMailbox&) = delete;
+
+    /// Find the Primary Mailbox: the CXL Device Register block from the
+    /// Register Locator DVSEC, then capability ID 0x0002 in its Device
+    /// Capabilities Array. kNotFound if either is missing.
+    static core::Result<CxlMailboxLocation> Locate(Cxl& cxl, PciBar& bar,
+                                                   Bdf bdf);
+
+    const CxlMailboxLocation& Location() const;
+
+    /// Payload area size in bytes (Mailbox Capabilities [4:0]), read once.
+    core::Result<uint32_t> PayloadSize();
+
+    /// True if the doorbell is clear and no Submit() is outstanding.
+    core::Result<bool> IsReady();
+
+    /// Run a command and wait for the doorbell to clear (kTimeout after
+    /// options.timeout or the caller's core::Deadline). kBusy if the
+    /// doorbell is already set; kInvalidArgument if the payload exceeds
+    /// PayloadSize(). A device return code other than kSuccess is reported
+    /// in the result, not as an error.
+    core::Result<CxlMailboxResult> Execute(uint16_t opcode,
+                                           const CxlMailboxPayload& payload);
+
+    /// Execute() with the payload gathered from `header` then `data`, each
+    /// copied straight into the payload registers.
+    core::Result<CxlMailboxResult> Execute(uint16_t opcode,
+                                           const uint8_t* header,
+                                           std::size_t header_len,
+                                           const uint8_t* data,
+                                           std::size_t data_len);
+
+    /// Execute() with the output payload read straight into a pooled
+    /// buffer; no heap allocation once the thread's cache is warm.
+    core::Result<CxlMailboxPooledResult> ExecutePooled(uint16_t opcode,
+                                                       const uint8_t* payload,
+                                                       std::size_t length);
+
+    /// Write the payload and ring the doorbell without waiting. Same errors
+    /// as Execute(), minus kTimeout.
+    core::Result<void> Submit(uint16_t opcode,
+                              const CxlMailboxPayload& payload);
+    core::Result<void> Submit(uint16_t opcode, const uint8_t* header,
+                              std::size_t header_len, const uint8_t* data,
+                              std::size_t data_len);
+
+    /// Finish the command started by Submit(): nullopt while the doorbell
+    /// is still set, otherwise its result. kNotFound if none is pending.
+    core::Result<std::optional<CxlMailboxResult>> TryComplete();
+
+    /// Progress of the last background command; one 64-bit read plus one of
+    /// Mailbox Status.
+    core::Result<CxlBackgroundStatus> GetBackgroundStatus();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal::pci
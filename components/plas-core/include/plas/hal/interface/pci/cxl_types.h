@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <vector>
 
+#include "plas/core/buffer_pool.h"
+
 namespace plas::hal::pci {
 
 /// CXL vendor ID (CXL Consortium).
@@ -129,6 +131,14 @@ struct CxlMailboxResult {
     CxlMailboxPayload payload;
 };
 
+/// CxlMailboxResult with the output payload in a pooled buffer (see
+/// CxlMailbox::ExecuteCommandPooled); the buffer goes back to the pool when
+/// the result is destroyed.
+struct CxlMailboxPooledResult {
+    CxlMailboxReturnCode return_code;
+    core::PooledBytes payload;
+};
+
 /// DOE data object type for IDE-KM (CXL/PCIe IDE Key Management).
 namespace doe_type {
 constexpr uint8_t kIdeKm = 0x02;
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+/// One DOE capability instance and the protocols it reported.
+struct DoeMailbox {
+    ConfigOffset offset;
+    std::vector<DoeProtocolId> protocols;
+    std::error_code error;  ///< DoeDiscover failure; `protocols` is empty
+};
+
+/// The DOE mailboxes of one function, in capability chain order.
+struct DoeDeviceInventory {
+    Bdf bdf;
+    std::vector<DoeMailbox> mailboxes;
+    std::error_code error;  ///< GetCapabilityIndex failure; no mailboxes
+
+    /// First mailbox that reported `protocol`.
+    std::optional<ConfigOffset> FindMailbox(DoeProtocolId protocol) const;
+};
+
+struct DoeInventoryOptions {
+    /// Most threads (caller included) discovering at once; 0: the caller
+    /// and every worker of core::Executor::Shared().
+    std::size_t max_threads = 0;
+};
+
+/// System-wide cache of DOE protocol lists.
+///
+/// Refresh() finds the DOE capabilities of every registered function
+/// through its CapabilityIndex, then runs DoeDiscover on all mailboxes of
+/// all functions at once on core::Executor::Shared(), so startup waits for
+/// the slowest mailbox rather than the sum of them. A function's entry
+/// goes stale when the PCI topology changes (PciTopology remove/rescan) or
+/// the function is reset through FunctionLevelReset/SecondaryBusReset
+/// (GetResetCount), and is discovered again on the next Refresh() or Get().
+///
+/// The PciConfig/PciDoe backends must outlive the inventory and accept
+/// DoeDiscover on different mailboxes from several threads.
+class DoeInventory {
+public:
+    explicit DoeInventory(DoeInventoryOptions options = {});
+    ~DoeInventory();
+
+    DoeInventory(const DoeInventory&) = delete;
+    DoeInventory& operator=(const DoeInventory&) = delete;
+
+    /// Register a function; returns its index. Nothing is read until
+    /// Refresh() or Get().
+    uint32_t AddDevice(PciConfig& config, PciDoe& doe, Bdf bdf);
+    std::size_t DeviceCount() const;
+
+    /// Discover every stale or never-discovered function, concurrently.
+    /// Per-function and per-mailbox failures are kept in the entries.
+    void Refresh();
+
+    /// The entry of `index`, discovered first if stale. kOutOfRange for an
+    /// unknown index.
+    core::Result<DoeDeviceInventory> Get(uint32_t index);
+
+    /// True if Get(index) would discover again.
+    bool IsStale(uint32_t index) const;
+
+    /// Force rediscovery, e.g. after a reset issued outside pci_reset.h.
+    void Invalidate(uint32_t index);
+    void InvalidateAll();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+/// One ECAM window from the ACPI MCFG table: the config space of buses
+/// [start_bus, end_bus] of a PCI segment, 4 KiB per function.
+struct EcamRegion {
+    uint64_t base_address;  ///< physical address of bus 0 (even if
+                            ///< start_bus > 0, per the MCFG definition)
+    uint16_t segment;
+    uint8_t start_bus;
+    uint8_t end_bus;
+
+    bool Contains(const PciAddress& addr) const {
+        return addr.domain == segment && addr.bdf.bus >= start_bus &&
+               addr.bdf.bus <= end_bus;
+    }
+
+    /// Physical address of the function's 4 KiB config space.
+    uint64_t ConfigAddress(const PciAddress& addr) const {
+        return base_address + (static_cast<uint64_t>(addr.bdf.bus) << 20) +
+               (static_cast<uint64_t>(addr.bdf.device & 0x1F) << 15) +
+               (static_cast<uint64_t>(addr.bdf.function & 0x07) << 12);
+    }
+};
+
+/// ECAM (memory-mapped config space) discovery.
+///
+/// All methods are static. The MCFG table is read from
+/// <sysfs root>/firmware/acpi/tables/MCFG (see PciTopology::SetSysfsRoot);
+/// config space is mapped from the physical memory device, "/dev/mem" by
+/// default. Reading MCFG and mapping /dev/mem need root, and kernels built
+/// with CONFIG_STRICT_DEVMEM or in lockdown refuse the mapping.
+class Ecam {
+public:
+    /// Parse a raw MCFG table (ACPI header + allocation entries).
+    static core::Result<std::vector<EcamRegion>> ParseMcfg(
+        const uint8_t* data, std::size_t length);
+
+    /// Read and parse the MCFG table under the current sysfs root.
+    static core::Result<std::vector<EcamRegion>> LoadRegions();
+
+    /// Region covering `addr`; kNotFound if MCFG has none, or the error of
+    /// LoadRegions().
+    static core::Result<EcamRegion> FindRegion(const PciAddress& addr);
+
+    /// Override the physical memory device for unit testing.
+    static void SetMemoryPath(const std::string& path);
+    static const std::string& GetMemoryPath();
+
+private:
+    static std::string memory_path_;
+};
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/cxl_types.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+class PciConfig;
+class PciDoe;
+
+/// DOE protocol carrying IDE_KM messages.
+inline constexpr DoeProtocolId kIdeKmProtocol{doe_vendor::kPciSig,
+                                              doe_type::kIdeKm};
+
+/// IdeStreamId::sub_stream values.
+namespace ide_sub_stream {
+constexpr uint8_t kPosted = 0x0;
+constexpr uint8_t kNonPosted = 0x1;
+constexpr uint8_t kCompletion = 0x2;
+}  // namespace ide_sub_stream
+
+/// KP_ACK status.
+enum class IdeKmStatus : uint8_t {
+    kSuccess = 0x00,
+    kIncorrectLength = 0x01,
+    kUnsupportedPortIndex = 0x02,
+    kUnsupportedValue = 0x03,
+    kUnspecifiedFailure = 0x04,
+};
+
+/// One KEY_PROG: the key and initial IV for one stream / key set /
+/// direction / sub-stream. Words go on the wire as given.
+struct IdeKmKey {
+    IdeStreamId stream;
+    std::array<core::DWord, 8> key;  ///< 256-bit AES-GCM key
+    std::array<core::DWord, 2> iv;   ///< initial invocation field
+};
+
+/// Every key of one device (port), programmed as one batch.
+struct IdeKmBatch {
+    PciDoe* doe;
+    PciConfig* config;  ///< for the DOE capability walk; usually == doe
+    Bdf bdf;
+    uint8_t port_index = 0;
+    std::vector<IdeKmKey> keys;
+    /// Send K_SET_GO for every key once all KEY_PROGs succeeded.
+    bool set_go = true;
+};
+
+struct IdeKmBatchResult {
+    std::vector<IdeKmStatus> status;  ///< KP_ACK per key, in batch order
+    bool activated = false;           ///< every K_SET_GO acknowledged
+};
+
+struct IdeKmOptions {
+    /// ProgramAll batches in flight, on core::Executor::Shared() and the
+    /// calling thread; 0 = as many as the executor runs.
+    std::size_t max_parallel = 0;
+};
+
+/// IDE_KM requester for key rotation across many devices.
+///
+/// The IDE_KM DOE instance of each function is found once (capability
+/// index + DoeDiscover) and cached per (PciDoe, bdf) until the PciTopology
+/// generation changes. A batch encodes every KEY_PROG into one pooled
+/// buffer and sends them back to back over DoeExchangeInto, then the
+/// K_SET_GOs, so a device costs two exchanges per key and no allocation
+/// per message. Key material is wiped from the buffer afterwards.
+///
+/// A rejected KEY_PROG is reported in IdeKmBatchResult::status and
+/// suppresses K_SET_GO for the whole batch, so no stream switches to a
+/// partially programmed key set. Transport errors and malformed or
+/// mismatched acks are errors (kIOError). Thread-safe.
+class IdeKmProgrammer {
+public:
+    explicit IdeKmProgrammer(IdeKmOptions options = {});
+    ~IdeKmProgrammer();
+
+    IdeKmProgrammer(const IdeKmProgrammer&) = delete;
+    IdeKmProgrammer& operator=(const IdeKmProgrammer&) = delete;
+
+    /// Config offset of the DOE instance supporting IDE_KM (cached).
+    /// kNotSupported if the function has none.
+    core::Result<ConfigOffset> Locate(PciConfig& config, PciDoe& doe,
+                                      Bdf bdf);
+
+    /// Program one device. kInvalidArgument for a null interface or a
+    /// stream field out of range (key_set, direction > 1; sub_stream > 0xF).
+    core::Result<IdeKmBatchResult> Program(const IdeKmBatch& batch);
+
+    /// Program every batch on the shared executor (options.max_parallel), so
+    /// exchanges on different devices overlap. Results are in batch order;
+    /// a failure on one device does not stop the others.
+    std::vector<core::Result<IdeKmBatchResult>> ProgramAll(
+        const std::vector<IdeKmBatch>& batches);
+
+    /// Drop the cached DOE offset of `bdf` behind `doe`.
+    void Forget(const PciDoe* doe, Bdf bdf);
+    void Clear();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal::pci
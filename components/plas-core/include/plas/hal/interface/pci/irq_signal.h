@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace plas::hal::pci {
+
+/// Completion signal raised by an interrupt (an MSI/MSI-X vector) and
+/// waited on by whoever polls the register the interrupt reports on.
+///
+/// Take a token with Arm() before reading the register, then Wait() with
+/// it if the register says "not yet": an interrupt that lands between the
+/// read and the wait has already moved the generation past the token, so
+/// Wait() returns at once instead of missing it.
+///
+/// Thread-safe; any number of waiters may share one signal.
+class IrqSignal {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Current generation; pass it to Wait().
+    uint64_t Arm() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return generation_;
+    }
+
+    /// Called by the interrupt path: wake every waiter.
+    void Notify() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++generation_;
+        }
+        raised_.notify_all();
+    }
+
+    /// Sleep until Notify() ran after the Arm() that returned `token`, or
+    /// until `until`. True if notified.
+    bool Wait(uint64_t token, Clock::time_point until) const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return raised_.wait_until(lock, until,
+                                  [&] { return generation_ != token; });
+    }
+
+    /// Notify() calls so far.
+    uint64_t Count() const { return Arm(); }
+
+private:
+    mutable std::mutex mutex_;
+    mutable std::condition_variable raised_;
+    uint64_t generation_ = 0;
+};
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "plas/core/result.h"
+
+namespace plas::hal::pci {
+
+/// Width of each access MmioRead/MmioWrite issue to the MMIO side.
+enum class MmioWidth : uint8_t {
+    kAuto = 0,  ///< 64-bit accesses, narrower only at unaligned edges
+    k8 = 1,
+    k16 = 2,
+    k32 = 4,
+    k64 = 8,
+    k128 = 16,  ///< SSE4.1 non-temporal (MOVNTDQA / MOVNTDQ), x86-64 only
+    k256 = 32,  ///< AVX2 non-temporal (VMOVNTDQA / VMOVNTDQ), x86-64 only
+};
+
+/// How a BAR is mapped into the process.
+enum class BarMapping : uint8_t {
+    kUncached,        ///< sysfs resourceN: every access reaches the device
+                      ///< in program order
+    kWriteCombining,  ///< sysfs resourceN_wc: stores are buffered and merged
+                      ///< into bursts; prefetchable memory BARs only
+};
+
+/// True if this CPU can issue `width` accesses. Scalar widths always can;
+/// k128/k256 are checked once at runtime.
+bool IsMmioWidthSupported(MmioWidth width);
+
+/// Copy `length` bytes out of an MMIO mapping with accesses of exactly
+/// `width` bytes (never byte-wise or unaligned, unlike memcpy).
+///
+/// For a fixed width, `src` and `length` must be multiples of it
+/// (kInvalidArgument); unsupported SIMD widths fail with kNotSupported.
+/// `dst` is ordinary memory and needs no alignment.
+core::Result<void> MmioRead(const volatile void* src, void* dst,
+                            std::size_t length,
+                            MmioWidth width = MmioWidth::kAuto);
+
+/// Copy `length` bytes into an MMIO mapping; same rules as MmioRead.
+/// Non-temporal stores are fenced before returning.
+core::Result<void> MmioWrite(volatile void* dst, const void* src,
+                             std::size_t length,
+                             MmioWidth width = MmioWidth::kAuto);
+
+/// Store fence: every MMIO store issued before it, including stores still
+/// held in write-combining buffers, is globally visible (posted to the bus)
+/// before any store after it. Use after writes to a write-combining mapping
+/// when ordering against a later uncached doorbell write matters; to know
+/// the device has consumed the data, read a register back.
+void MmioFlush();
+
+}  // namespace plas::hal::pci
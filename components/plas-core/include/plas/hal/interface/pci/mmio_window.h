@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace plas::hal::pci {
+
+/// A mapped BAR as a raw pointer and size, for polling loops that cannot
+/// afford a virtual call, a Result, tracing and metrics per access.
+///
+/// Obtained once from a concrete driver (PciDevice, PciUtilsDevice or
+/// VfioDevice GetBarWindow). Accessors are inline volatile loads and
+/// stores with no checks: validate offsets once with Contains(). The
+/// window is valid until the BAR is unmapped — Close(), SetBarMapping()
+/// on that BAR, or a topology change that remaps it — and accesses are
+/// not traced or counted in DeviceMetrics.
+class MmioWindow {
+public:
+    MmioWindow() = default;
+    MmioWindow(volatile void* base, uint64_t size)
+        : base_(static_cast<volatile uint8_t*>(base)), size_(size) {}
+
+    volatile void* Base() const { return base_; }
+    uint64_t Size() const { return size_; }
+
+    /// True if [offset, offset + length) lies inside the window.
+    bool Contains(uint64_t offset, std::size_t length) const {
+        return offset <= size_ && length <= size_ - offset;
+    }
+
+    uint32_t Read32(uint64_t offset) const {
+        return *reinterpret_cast<volatile const uint32_t*>(base_ + offset);
+    }
+    uint64_t Read64(uint64_t offset) const {
+        return *reinterpret_cast<volatile const uint64_t*>(base_ + offset);
+    }
+    void Write32(uint64_t offset, uint32_t value) const {
+        *reinterpret_cast<volatile uint32_t*>(base_ + offset) = value;
+    }
+    void Write64(uint64_t offset, uint64_t value) const {
+        *reinterpret_cast<volatile uint64_t*>(base_ + offset) = value;
+    }
+
+private:
+    volatile uint8_t* base_ = nullptr;
+    uint64_t size_ = 0;
+};
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+class PciDevice;
+
+/// One AER event: the capability's status and logs as they were when the
+/// collector found a status bit set (PCIe 6.0 7.8.4).
+struct PciAerRecord {
+    uint64_t timestamp_ns;           ///< steady_clock
+    uint32_t device;                 ///< index returned by AddDevice()
+    uint32_t uncorrectable;          ///< Uncorrectable Error Status
+    uint32_t uncorrectable_severity; ///< Uncorrectable Error Severity (1 = fatal)
+    uint32_t correctable;            ///< Correctable Error Status
+    uint32_t header_log[4];          ///< TLP header of the first error
+    uint32_t root_status;            ///< Root Error Status (root ports, RCECs)
+    uint32_t source_id;              ///< Error Source Identification (same)
+    uint8_t first_error;             ///< First Error Pointer (a bit of uncorrectable)
+
+    uint32_t Fatal() const { return uncorrectable & uncorrectable_severity; }
+    uint32_t NonFatal() const { return uncorrectable & ~uncorrectable_severity; }
+};
+
+/// Per-device totals since AddDevice().
+struct PciAerCounters {
+    uint64_t records = 0;        ///< polls that found a status bit set
+    uint64_t correctable = 0;    ///< correctable status bits seen
+    uint64_t nonfatal = 0;       ///< uncorrectable non-fatal status bits seen
+    uint64_t fatal = 0;          ///< uncorrectable fatal status bits seen
+    uint64_t read_errors = 0;    ///< AER block reads that failed
+};
+
+struct PciAerCollectorOptions {
+    std::size_t ring_capacity = 4096;  ///< records kept; rounded up to 2^n
+    /// At most one log line per device per interval, aggregating every
+    /// error seen since the last one; 0 disables logging.
+    std::chrono::milliseconds report_interval{1000};
+};
+
+/// Collects AER events of many functions without falling behind error
+/// storms.
+///
+/// AddDevice() resolves the AER capability once. Each Poll() then costs
+/// one ReadConfigBlock of the AER block per function and, only for
+/// functions with a status bit set, one WriteConfigBatch that clears
+/// exactly the bits read (RW1C). Events become compact PciAerRecords in a
+/// single-producer/single-consumer ring: Poll() is the producer (calls are
+/// serialized), one consumer drains it with Pop() without locks. When the
+/// ring is full, new records are dropped and counted.
+///
+/// Logging is aggregated per device: per-bit counts accumulate and one
+/// PLAS_LOG line per report_interval summarizes them (PLAS_LOG_ERROR when
+/// an uncorrectable error is included, PLAS_LOG_WARN otherwise).
+///
+/// Devices are registered before the first Poll(); the PciConfig backends
+/// or PciDevices must outlive the collector.
+class PciAerCollector {
+public:
+    explicit PciAerCollector(PciAerCollectorOptions options = {});
+    ~PciAerCollector();
+
+    PciAerCollector(const PciAerCollector&) = delete;
+    PciAerCollector& operator=(const PciAerCollector&) = delete;
+
+    /// Register a function; returns its index (PciAerRecord::device).
+    /// kNotSupported without an AER capability; errors of
+    /// GetCapabilityIndex.
+    core::Result<uint32_t> AddDevice(PciConfig& config, Bdf bdf);
+    core::Result<uint32_t> AddDevice(PciDevice& device);
+    std::size_t DeviceCount() const;
+
+    /// Snapshot, record and clear every device; then log the summaries
+    /// that are due. Returns the number of records produced.
+    std::size_t Poll();
+
+    /// Log every pending summary now, regardless of report_interval.
+    void FlushReports();
+
+    /// Consumer: move up to `max` of the oldest records into `out`.
+    std::size_t Pop(PciAerRecord* out, std::size_t max);
+
+    /// Records dropped because the ring was full.
+    uint64_t Dropped() const;
+
+    /// kOutOfRange for an unknown device.
+    core::Result<PciAerCounters> GetCounters(uint32_t device) const;
+
+    /// Short names of the AER status bits ("BadTLP", "SurpriseDown"), or
+    /// nullptr for a reserved bit.
+    static const char* UncorrectableName(unsigned bit);
+    static const char* CorrectableName(unsigned bit);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal::pci
@@ -4,7 +4,9 @@
 #include <cstdint>
 #include <string>
 
+#include "plas/hal/interface/pci/mmio_copy.h"
 #include "plas/hal/interface/pci/types.h"
+#include "plas/core/error.h"
 #include "plas/core/result.h"
 #include "plas/core/types.h"
 
@@ -37,6 +39,27 @@ public:
                                                uint64_t offset,
                                                const void* buffer,
                                                std::size_t length) = 0;
+
+    /// Select how `bar_index` is mapped; takes effect on its next access
+    /// (an existing mapping is dropped). kWriteCombining needs a
+    /// prefetchable memory BAR. With it, BarWriteBuffer fences before
+    /// returning, but single BarWrite32/64 stores may stay buffered until
+    /// BarFlush(). Must not race with other accesses to the same BAR.
+    /// Default: kNotSupported for anything but kUncached.
+    virtual core::Result<void> SetBarMapping(Bdf /*bdf*/,
+                                             uint8_t /*bar_index*/,
+                                             BarMapping mapping) {
+        if (mapping == BarMapping::kUncached) {
+            return core::Result<void>::Ok();
+        }
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    /// Post all buffered stores to `bar_index` (see MmioFlush()).
+    virtual core::Result<void> BarFlush(Bdf /*bdf*/, uint8_t /*bar_index*/) {
+        MmioFlush();
+        return core::Result<void>::Ok();
+    }
 };
 
 }  // namespace plas::hal::pci
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <cstddef>
 #include <optional>
 #include <string>
+#include <system_error>
+#include <vector>
 
 #include "plas/hal/interface/pci/types.h"
+#include "plas/core/error.h"
 #include "plas/core/result.h"
 #include "plas/core/types.h"
 
@@ -35,11 +39,129 @@ public:
     virtual core::Result<void> WriteConfig32(Bdf bdf, ConfigOffset offset,
                                              core::DWord value) = 0;
 
+    /// Apply `count` writes to `bdf` in order, stopping at the first one
+    /// that fails. If `status` is non-null, `status[i]` receives each
+    /// write's error: empty on success, kInvalidArgument for a width other
+    /// than 1, 2 or 4, kCancelled for writes after a failure. Returns the
+    /// number of writes that succeeded.
+    ///
+    /// The default implementation issues one WriteConfig8/16/32 per write.
+    /// Backends override it to take their lock once or to submit adjacent
+    /// DWord writes together.
+    virtual std::size_t WriteConfigBatch(Bdf bdf, const ConfigWrite* writes,
+                                         std::size_t count,
+                                         std::error_code* status) {
+        std::size_t done = 0;
+        for (; done < count; ++done) {
+            const auto& w = writes[done];
+            core::Result<void> r = core::Result<void>::Ok();
+            switch (w.width) {
+            case 1:
+                r = WriteConfig8(bdf, w.offset, static_cast<core::Byte>(w.value));
+                break;
+            case 2:
+                r = WriteConfig16(bdf, w.offset, static_cast<core::Word>(w.value));
+                break;
+            case 4:
+                r = WriteConfig32(bdf, w.offset, w.value);
+                break;
+            default:
+                r = core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+                break;
+            }
+            if (status) {
+                status[done] = r.IsError() ? r.Error() : std::error_code{};
+            }
+            if (r.IsError()) {
+                break;
+            }
+        }
+        if (status) {
+            for (std::size_t i = done + 1; i < count; ++i) {
+                status[i] = core::make_error_code(core::ErrorCode::kCancelled);
+            }
+        }
+        return done;
+    }
+
     // Capability walking
     virtual core::Result<std::optional<ConfigOffset>> FindCapability(
         Bdf bdf, CapabilityId id) = 0;
     virtual core::Result<std::optional<ConfigOffset>> FindExtCapability(
         Bdf bdf, ExtCapabilityId id) = 0;
+
+    // Bulk reads
+
+    /// Read `length` bytes of config space starting at `offset` into
+    /// `buffer`. The range must lie within kConfigSpaceSize.
+    ///
+    /// The default implementation composes the range from ReadConfig32 for
+    /// the DWord-aligned middle and ReadConfig8 for an unaligned head/tail.
+    /// Backends with a native block primitive should override it.
+    virtual core::Result<void> ReadConfigBlock(Bdf bdf, ConfigOffset offset,
+                                               core::Byte* buffer,
+                                               std::size_t length) {
+        if (length == 0) {
+            return core::Result<void>::Ok();
+        }
+        if (!buffer) {
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        }
+        if (offset >= kConfigSpaceSize ||
+            length > kConfigSpaceSize - offset) {
+            return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+        }
+
+        std::size_t pos = offset;
+        const std::size_t end = pos + length;
+        while (pos < end) {
+            if ((pos & 0x3) == 0 && end - pos >= 4) {
+                auto r = ReadConfig32(bdf, static_cast<ConfigOffset>(pos));
+                if (r.IsError()) {
+                    return core::Result<void>::Err(r.Error());
+                }
+                // Config space is little-endian.
+                core::DWord v = r.Value();
+                for (int i = 0; i < 4; ++i) {
+                    *buffer++ = static_cast<core::Byte>(v >> (8 * i));
+                }
+                pos += 4;
+            } else {
+                auto r = ReadConfig8(bdf, static_cast<ConfigOffset>(pos));
+                if (r.IsError()) {
+                    return core::Result<void>::Err(r.Error());
+                }
+                *buffer++ = r.Value();
+                pos += 1;
+            }
+        }
+        return core::Result<void>::Ok();
+    }
+
+    /// Read the full extended config space (kConfigSpaceSize bytes).
+    virtual core::Result<std::vector<core::Byte>> SnapshotConfig(Bdf bdf) {
+        std::vector<core::Byte> data(kConfigSpaceSize);
+        auto r = ReadConfigBlock(bdf, 0, data.data(), data.size());
+        if (r.IsError()) {
+            return core::Result<std::vector<core::Byte>>::Err(r.Error());
+        }
+        return core::Result<std::vector<core::Byte>>::Ok(std::move(data));
+    }
+
+    /// Standard and extended capability offsets for `bdf`, including every
+    /// instance of repeated capabilities such as DVSEC and DOE.
+    ///
+    /// The default implementation parses a fresh SnapshotConfig() on each
+    /// call; backends override it to cache the index per device.
+    virtual core::Result<CapabilityIndex> GetCapabilityIndex(Bdf bdf) {
+        auto snapshot = SnapshotConfig(bdf);
+        if (snapshot.IsError()) {
+            return core::Result<CapabilityIndex>::Err(snapshot.Error());
+        }
+        const auto& data = snapshot.Value();
+        return core::Result<CapabilityIndex>::Ok(
+            CapabilityIndex::Parse(data.data(), data.size()));
+    }
 };
 
 }  // namespace plas::hal::pci
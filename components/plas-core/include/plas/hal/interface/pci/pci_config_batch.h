@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <system_error>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+class PciDevice;
+
+/// Config writes for one function, queued and submitted in order by Flush().
+///
+/// Each run of writes between two reads goes to the backend as a single
+/// WriteConfigBatch, so backends can take their lock once or submit
+/// adjacent DWord writes in one syscall (PciDevice over sysfs). A queued
+/// Read32 is a fence: it runs after every write queued before it and
+/// before any queued after it, e.g. to read a control register back before
+/// the next step depends on it.
+///
+/// Flush stops at the first failed operation; every later one reports
+/// kCancelled. Results stay available until Clear(). Not thread-safe; the
+/// backend must outlive the batch.
+///
+///   PciConfigBatch batch(config, bdf);
+///   batch.Write32(aer + 0x08, uncorrectable_mask);
+///   batch.Write32(aer + 0x14, correctable_mask);
+///   auto readback = batch.Read32(aer + 0x08);
+///   batch.Write16(pcie + 0x10, link_control);
+///   if (batch.Flush().IsOk()) { auto mask = batch.Value(readback); }
+class PciConfigBatch {
+public:
+    PciConfigBatch(PciConfig& config, Bdf bdf);
+    explicit PciConfigBatch(PciDevice& device);
+
+    /// Queue a write; returns its index for Status().
+    std::size_t Write8(ConfigOffset offset, core::Byte value);
+    std::size_t Write16(ConfigOffset offset, core::Word value);
+    std::size_t Write32(ConfigOffset offset, core::DWord value);
+
+    /// Queue a fencing DWord read; returns its index for Value().
+    std::size_t Read32(ConfigOffset offset);
+
+    /// Submit everything queued since the last Flush; returns the first
+    /// error.
+    core::Result<void> Flush();
+
+    /// Outcome of operation `index`: kBusy while it is still queued,
+    /// kOutOfRange for an unknown index.
+    core::Result<void> Status(std::size_t index) const;
+
+    /// Value read by the Read32 at `index`; Status() errors, or
+    /// kInvalidArgument if `index` is a write.
+    core::Result<core::DWord> Value(std::size_t index) const;
+
+    /// Operations queued since construction or Clear().
+    std::size_t Size() const { return ops_.size(); }
+
+    /// Operations not yet flushed.
+    std::size_t Pending() const { return ops_.size() - flushed_; }
+
+    /// Drop all operations and results.
+    void Clear();
+
+private:
+    struct Op {
+        ConfigWrite access;
+        bool read = false;
+        std::error_code status;
+        core::DWord value = 0;
+    };
+
+    using WriteFn =
+        std::function<std::size_t(const ConfigWrite*, std::size_t, std::error_code*)>;
+    using ReadFn = std::function<core::Result<core::DWord>(ConfigOffset)>;
+
+    std::size_t Queue(ConfigOffset offset, uint8_t width, core::DWord value, bool read);
+
+    WriteFn write_;
+    ReadFn read_;
+    std::vector<Op> ops_;
+    std::size_t flushed_ = 0;
+    std::vector<ConfigWrite> run_;  // scratch for one WriteConfigBatch
+    std::vector<std::error_code> run_status_;
+};
+
+}  // namespace plas::hal::pci
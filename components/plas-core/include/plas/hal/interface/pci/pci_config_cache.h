@@ -0,0 +1,131 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+/// How long a cached config register stays valid.
+enum class CachePolicy : uint8_t {
+    kNever,       ///< always read from the backend
+    kImmutable,   ///< kept until a write overlaps it or Invalidate()
+    kUntilWrite,  ///< kept until any write to the same function
+    kTtl,         ///< kept for CacheRange::ttl (and dropped by overlapping writes)
+};
+
+/// Policy of config bytes [offset, offset + length).
+struct CacheRange {
+    ConfigOffset offset;
+    uint16_t length;
+    CachePolicy policy;
+    std::chrono::nanoseconds ttl{0};  ///< kTtl only
+};
+
+struct PciConfigCacheStats {
+    uint64_t hits = 0;           ///< reads answered from the cache
+    uint64_t misses = 0;         ///< cacheable reads that went to the backend
+    uint64_t bypassed = 0;       ///< reads of kNever ranges
+    uint64_t invalidations = 0;  ///< cached DWords dropped by writes or Invalidate()
+
+    /// hits / all reads; 0 before the first read.
+    double HitRate() const {
+        uint64_t reads = hits + misses + bypassed;
+        return reads == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(reads);
+    }
+};
+
+/// Read-side cache over another PciConfig, for callers that re-read
+/// registers that do not change (IDs, class code, BARs, capability chains).
+///
+/// The cache holds aligned DWords per function: a cacheable 8/16-bit read
+/// fetches its whole DWord once and later reads of any byte in it are
+/// answered locally. A read is cached only if every byte it covers is,
+/// each under the policy of its range; later ranges override earlier ones,
+/// and bytes outside every range are kNever. Writes go straight to the backend and drop the DWords
+/// they overlap (never updated in place: RW1C and read-only bits make the
+/// written value differ from what reads back), plus every kUntilWrite DWord
+/// of the function. FindCapability/FindExtCapability and
+/// GetCapabilityIndex results are kept per function until Invalidate().
+///
+/// Thread-safe if the backend is; the lock is not held across backend
+/// calls. The backend must outlive the cache.
+class PciConfigCache : public PciConfig {
+public:
+    /// Type 0/1 header fields that do not change while a function is
+    /// enumerated: IDs, revision/class, header type, subsystem IDs and the
+    /// capability pointer as kImmutable; the BARs (0x10-0x27) as kUntilWrite
+    /// so BAR sizing reads the hardware.
+    static std::vector<CacheRange> DefaultRanges();
+
+    explicit PciConfigCache(PciConfig& backend,
+                            std::vector<CacheRange> ranges = DefaultRanges());
+    ~PciConfigCache() override;
+
+    PciConfigCache(const PciConfigCache&) = delete;
+    PciConfigCache& operator=(const PciConfigCache&) = delete;
+
+    /// Add a range on top of the existing ones, e.g. a capability header
+    /// found at run time. Cached DWords are kept; a range that turns
+    /// caching off drops the ones it covers. kOutOfRange past the end of
+    /// config space.
+    core::Result<void> SetPolicy(CacheRange range);
+
+    /// Drop everything cached for `bdf` (after a reset, hot-plug or
+    /// anything else that changes it behind the cache's back).
+    void Invalidate(Bdf bdf);
+    void InvalidateAll();
+
+    PciConfigCacheStats Stats() const;
+    void ResetStats();
+
+    PciConfig& Backend() { return backend_; }
+
+    // -- PciConfig -----------------------------------------------------------
+
+    std::string InterfaceName() const override { return backend_.InterfaceName(); }
+    plas::hal::Device* GetDevice() override { return backend_.GetDevice(); }
+
+    core::Result<core::Byte> ReadConfig8(Bdf bdf, ConfigOffset offset) override;
+    core::Result<core::Word> ReadConfig16(Bdf bdf, ConfigOffset offset) override;
+    core::Result<core::DWord> ReadConfig32(Bdf bdf, ConfigOffset offset) override;
+
+    core::Result<void> WriteConfig8(Bdf bdf, ConfigOffset offset, core::Byte value) override;
+    core::Result<void> WriteConfig16(Bdf bdf, ConfigOffset offset, core::Word value) override;
+    core::Result<void> WriteConfig32(Bdf bdf, ConfigOffset offset, core::DWord value) override;
+    /// Forwarded as one backend batch; the DWords it touched are dropped
+    /// afterwards.
+    std::size_t WriteConfigBatch(Bdf bdf, const ConfigWrite* writes, std::size_t count,
+                                 std::error_code* status) override;
+
+    core::Result<std::optional<ConfigOffset>> FindCapability(Bdf bdf,
+                                                             CapabilityId id) override;
+    core::Result<std::optional<ConfigOffset>> FindExtCapability(Bdf bdf,
+                                                                ExtCapabilityId id) override;
+
+    /// Cached DWords are copied; each run of the others is one backend
+    /// ReadConfigBlock, whose cacheable DWords are then kept.
+    core::Result<void> ReadConfigBlock(Bdf bdf, ConfigOffset offset, core::Byte* buffer,
+                                       std::size_t length) override;
+    core::Result<CapabilityIndex> GetCapabilityIndex(Bdf bdf) override;
+
+private:
+    struct Impl;
+
+    /// The DWord holding a `width`-byte read at `offset`, from the cache or
+    /// the backend.
+    core::Result<core::DWord> ReadDWord(Bdf bdf, ConfigOffset offset, std::size_t width);
+    void AfterWrite(Bdf bdf, ConfigOffset offset, std::size_t length);
+
+    PciConfig& backend_;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal::pci
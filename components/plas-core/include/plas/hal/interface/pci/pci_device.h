@@ -6,13 +6,38 @@
 #include <string>
 #include <vector>
 
+#include "plas/core/executor.h"
+#include "plas/core/numa.h"
 #include "plas/core/result.h"
 #include "plas/core/types.h"
+#include "plas/hal/interface/pci/bar_resource.h"
+#include "plas/hal/interface/pci/cxl_dvsec.h"
+#include "plas/hal/interface/pci/mmio_copy.h"
+#include "plas/hal/interface/pci/mmio_window.h"
 #include "plas/hal/interface/pci/pci_topology.h"
+#include "plas/hal/interface/pci/pci_topology_snapshot.h"
 #include "plas/hal/interface/pci/types.h"
 
 namespace plas::hal::pci {
 
+/// How PciDevice reaches config space.
+enum class ConfigAccess : uint8_t {
+    kSysfs,  ///< pread/pwrite on the sysfs config file (one syscall each)
+    kEcam,   ///< memory-mapped ECAM window from ACPI MCFG via /dev/mem;
+             ///< config reads/writes become volatile loads/stores
+    kAuto,   ///< ECAM if available, otherwise sysfs
+};
+
+class PciDevice;
+
+/// One read of PciDevice::ReadConfigBlocks.
+struct PciConfigBlockRead {
+    PciDevice* device = nullptr;
+    ConfigOffset offset = 0;
+    core::Byte* buffer = nullptr;
+    std::size_t length = 0;
+};
+
 /// sysfs-based PCI device facade providing unified config space, BAR MMIO,
 /// and topology access through a single object.
 ///
@@ -28,10 +53,19 @@ namespace plas::hal::pci {
 class PciDevice {
 public:
     /// Open a device by PciAddress. Fails if device does not exist in sysfs.
-    static core::Result<PciDevice> Open(const PciAddress& addr);
+    ///
+    /// With ConfigAccess::kEcam, fails if the device has no MCFG region or
+    /// the window cannot be mapped (kNotSupported, kNotFound,
+    /// kPermissionDenied, kIOError); kAuto falls back to sysfs instead.
+    /// In ECAM mode, unaligned accesses and block reads beyond the window
+    /// still go through sysfs.
+    static core::Result<PciDevice> Open(
+        const PciAddress& addr, ConfigAccess access = ConfigAccess::kSysfs);
 
     /// Open a device by address string ("DDDD:BB:DD.F").
-    static core::Result<PciDevice> Open(const std::string& addr_str);
+    static core::Result<PciDevice> Open(
+        const std::string& addr_str,
+        ConfigAccess access = ConfigAccess::kSysfs);
 
     ~PciDevice();
     PciDevice(PciDevice&& other) noexcept;
@@ -47,28 +81,134 @@ public:
     bool IsBridge() const;
     const std::string& SysfsPath() const;
 
-    // --- Config Space (sysfs /config pread/pwrite) ---
+    /// Config access in effect: kSysfs or kEcam (never kAuto).
+    ConfigAccess GetConfigAccess() const;
+
+    // --- NUMA locality (sysfs numa_node / local_cpulist, read at Open) ---
+
+    /// Node of the root complex the device hangs off; -1 if not reported.
+    int NumaNode() const;
+    /// CPUs nearest the device; empty if not reported.
+    const std::vector<int>& LocalCpus() const;
+    /// core::Executor::ForCpus(LocalCpus()): run BAR and config work for
+    /// this device there to keep MMIO off the cross-socket link. Shared()
+    /// when the CPUs are unknown.
+    core::Executor& LocalExecutor() const;
+    /// A zeroed buffer on NumaNode() (unplaced when the node is unknown),
+    /// e.g. for BarReadBuffer/BarWriteBuffer staging; `huge_pages` backs it
+    /// with 2 MiB pages where available (see core::NumaBuffer::Allocate).
+    core::Result<core::NumaBuffer> AllocateLocalBuffer(std::size_t bytes,
+                                                       bool huge_pages = false) const;
+    /// A huge-page buffer on NumaNode() from core::NumaBufferPool::Shared(),
+    /// for staging that repeats; contents are not cleared on reuse.
+    core::Result<core::NumaBufferLease> AcquireLocalBuffer(std::size_t bytes) const;
+
+    // --- Config Space (ECAM loads/stores or sysfs /config pread/pwrite) ---
     core::Result<core::Byte> ReadConfig8(ConfigOffset offset);
     core::Result<core::Word> ReadConfig16(ConfigOffset offset);
     core::Result<core::DWord> ReadConfig32(ConfigOffset offset);
     core::Result<void> WriteConfig8(ConfigOffset offset, core::Byte value);
     core::Result<void> WriteConfig16(ConfigOffset offset, core::Word value);
     core::Result<void> WriteConfig32(ConfigOffset offset, core::DWord value);
+    /// Same contract as PciConfig::WriteConfigBatch. Over sysfs, each run
+    /// of adjacent aligned DWord writes is one pwritev (the kernel splits
+    /// it back into DWord config writes, in order); other writes go one by
+    /// one.
+    std::size_t WriteConfigBatch(const ConfigWrite* writes, std::size_t count,
+                                 std::error_code* status);
     core::Result<std::optional<ConfigOffset>> FindCapability(CapabilityId id);
     core::Result<std::optional<ConfigOffset>> FindExtCapability(
         ExtCapabilityId id);
 
-    // --- BAR MMIO (sysfs resourceN mmap) ---
+    /// Capability offsets parsed from one config snapshot, cached until the
+    /// PciTopology generation changes. Find*Capability are served from it.
+    core::Result<CapabilityIndex> GetCapabilityIndex();
+
+    // --- CXL DVSECs (same contracts as the pci::Cxl ABC, without Bdf) ---
+    // Headers, Register Locator entries and device type are parsed together
+    // with the capability index and share its cache.
+    core::Result<std::vector<DvsecHeader>> EnumerateCxlDvsecs();
+    core::Result<std::optional<DvsecHeader>> FindCxlDvsec(CxlDvsecId dvsec_id);
+    /// kUnknown if the function has no CXL Device DVSEC.
+    core::Result<CxlDeviceType> GetCxlDeviceType();
+    core::Result<std::vector<RegisterBlockEntry>> GetRegisterBlocks();
+    /// Config access at dvsec_offset + reg_offset; kOutOfRange past 4 KiB.
+    core::Result<core::DWord> ReadDvsecRegister(ConfigOffset dvsec_offset,
+                                                uint16_t reg_offset);
+    core::Result<void> WriteDvsecRegister(ConfigOffset dvsec_offset,
+                                          uint16_t reg_offset,
+                                          core::DWord value);
+
+    /// Read `length` bytes starting at `offset` with a single pread (or
+    /// from the ECAM window).
+    core::Result<void> ReadConfigBlock(ConfigOffset offset, core::Byte* buffer,
+                                       std::size_t length);
+
+    /// ReadConfigBlock across many devices: the sysfs reads are submitted
+    /// together (core::BatchReader, io_uring where available) instead of
+    /// one pread each; ECAM devices are read from their window. One
+    /// result per read, in order, with ReadConfigBlock's contract
+    /// (kInvalidArgument also for a null device).
+    static std::vector<core::Result<void>> ReadConfigBlocks(
+        const PciConfigBlockRead* reads, std::size_t count);
+
+    /// Dump config space with a single pread. The result holds as many bytes
+    /// as sysfs exposes (4096 for PCIe, 256 for conventional PCI, 64 when
+    /// unprivileged); in ECAM mode always the full 4096.
+    core::Result<std::vector<core::Byte>> SnapshotConfig();
+
+    // --- BAR MMIO (sysfs resourceN / resourceN_wc mmap) ---
+
+    /// Address range and flags of `bar_index` from sysfs `resource`. The
+    /// file is parsed once for all six BARs and re-read only after a
+    /// PciTopology remove/rescan.
+    core::Result<BarResource> GetBarResource(uint8_t bar_index);
+
+    /// True if `bar_index` is a prefetchable memory BAR (IORESOURCE_PREFETCH
+    /// in sysfs `resource`); kNotFound if the BAR is unimplemented.
+    core::Result<bool> IsBarPrefetchable(uint8_t bar_index);
+
+    /// Map every implemented memory BAR now, so the first BAR access in a
+    /// timed region does not pay for open+mmap. BARs are otherwise mapped
+    /// on first access. Returns the first mapping error.
+    core::Result<void> MapAllBars();
+
+    /// Map `bar_index` uncached (the default) or write-combining, for bulk
+    /// writes. Takes effect on the next access; an existing mapping is
+    /// dropped, so pointers into it must not be in use. kWriteCombining
+    /// fails with kNotSupported unless the BAR is prefetchable and sysfs
+    /// offers resourceN_wc.
+    ///
+    /// On a write-combining BAR, BarWriteBuffer fences before returning;
+    /// BarWrite32/64 do not, so call BarFlush() before a dependent doorbell.
+    core::Result<void> SetBarMapping(uint8_t bar_index, BarMapping mapping);
+    BarMapping GetBarMapping(uint8_t bar_index) const;
+
+    /// Post all buffered stores to the BAR (see MmioFlush()).
+    core::Result<void> BarFlush(uint8_t bar_index);
+
+    /// Map `bar_index` now and return it as an MmioWindow, whose inline
+    /// accessors skip the per-call checks of BarRead32/BarWrite32 (see
+    /// mmio_window.h for how long it stays valid).
+    core::Result<MmioWindow> GetBarWindow(uint8_t bar_index);
+
+
     core::Result<core::DWord> BarRead32(uint8_t bar_index, uint64_t offset);
     core::Result<core::QWord> BarRead64(uint8_t bar_index, uint64_t offset);
     core::Result<void> BarWrite32(uint8_t bar_index, uint64_t offset,
                                   core::DWord value);
     core::Result<void> BarWrite64(uint8_t bar_index, uint64_t offset,
                                   core::QWord value);
+
+    /// Bulk BAR copies through MmioRead/MmioWrite: every access has exactly
+    /// `width` bytes (kAuto: aligned 64-bit with narrower edges). Fixed
+    /// widths require `offset` and `length` to be multiples of the width.
     core::Result<void> BarReadBuffer(uint8_t bar_index, uint64_t offset,
-                                     void* buffer, std::size_t length);
+                                     void* buffer, std::size_t length,
+                                     MmioWidth width = MmioWidth::kAuto);
     core::Result<void> BarWriteBuffer(uint8_t bar_index, uint64_t offset,
-                                      const void* buffer, std::size_t length);
+                                      const void* buffer, std::size_t length,
+                                      MmioWidth width = MmioWidth::kAuto);
 
     // --- Topology (delegates to PciTopology, returns PciDevice) ---
     core::Result<std::optional<PciDevice>> FindParent();
@@ -76,6 +216,13 @@ public:
     core::Result<PciDevice> FindRootPort();
     core::Result<std::vector<PciDeviceNode>> GetPathToRoot();
 
+    // --- Topology from a snapshot (no sysfs I/O) ---
+    core::Result<std::optional<PciDevice>> FindParent(
+        const PciTopologySnapshot& snapshot);
+    core::Result<std::vector<PciDevice>> FindChildren(
+        const PciTopologySnapshot& snapshot);
+    core::Result<PciDevice> FindRootPort(const PciTopologySnapshot& snapshot);
+
     // --- Lifecycle (sysfs) ---
     core::Result<void> Remove();
     core::Result<void> Rescan();
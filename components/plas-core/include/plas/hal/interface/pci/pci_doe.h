@@ -1,9 +1,15 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <future>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "plas/hal/interface/pci/types.h"
+#include "plas/core/error.h"
+#include "plas/core/executor.h"
 #include "plas/core/result.h"
 
 namespace plas::hal { class Device; }  // forward declaration
@@ -26,6 +32,69 @@ public:
     virtual core::Result<DoePayload> DoeExchange(
         Bdf bdf, ConfigOffset doe_offset, DoeProtocolId protocol,
         const DoePayload& request) = 0;
+
+    /// DoeExchange over caller-owned buffers: `request_len` payload DWords
+    /// in, up to `response_capacity` payload DWords out (headers excluded).
+    /// Returns the number of response DWords written, or kOverflow if the
+    /// response does not fit.
+    ///
+    /// The default implementation goes through DoeExchange; backends
+    /// override it to stream the mailbox straight into `response`.
+    virtual core::Result<std::size_t> DoeExchangeInto(
+        Bdf bdf, ConfigOffset doe_offset, DoeProtocolId protocol,
+        const core::DWord* request, std::size_t request_len,
+        core::DWord* response, std::size_t response_capacity) {
+        if ((request_len > 0 && !request) ||
+            (response_capacity > 0 && !response)) {
+            return core::Result<std::size_t>::Err(
+                core::ErrorCode::kInvalidArgument);
+        }
+        auto result = DoeExchange(bdf, doe_offset, protocol,
+                                  DoePayload(request, request + request_len));
+        if (result.IsError()) {
+            return core::Result<std::size_t>::Err(result.Error());
+        }
+        const auto& payload = result.Value();
+        if (payload.size() > response_capacity) {
+            return core::Result<std::size_t>::Err(core::ErrorCode::kOverflow);
+        }
+        std::copy(payload.begin(), payload.end(), response);
+        return core::Result<std::size_t>::Ok(payload.size());
+    }
+
+    /// DoeExchangeInto with the response in a core::BufferPool buffer of
+    /// `response_capacity` DWords, trimmed to the response length. Once the
+    /// calling thread has released one buffer of that size class, a polling
+    /// loop that drops each response before the next exchange allocates
+    /// nothing.
+    core::Result<DoePooledPayload> DoeExchangePooled(
+        Bdf bdf, ConfigOffset doe_offset, DoeProtocolId protocol,
+        const core::DWord* request, std::size_t request_len,
+        std::size_t response_capacity) {
+        DoePooledPayload response(response_capacity);
+        auto written =
+            DoeExchangeInto(bdf, doe_offset, protocol, request, request_len,
+                            response.Data(), response_capacity);
+        if (written.IsError()) {
+            return core::Result<DoePooledPayload>::Err(written.Error());
+        }
+        response.Resize(written.Value());
+        return core::Result<DoePooledPayload>::Ok(std::move(response));
+    }
+
+    /// Start a DoeExchange without blocking. The default implementation runs
+    /// the synchronous exchange on core::Executor::Shared(), so exchanges to
+    /// independent (bdf, doe_offset) mailboxes overlap (up to the executor's
+    /// thread count) when the backend locks per mailbox. The PciDoe object
+    /// must outlive the returned future.
+    virtual std::future<core::Result<DoePayload>> DoeExchangeAsync(
+        Bdf bdf, ConfigOffset doe_offset, DoeProtocolId protocol,
+        DoePayload request) {
+        return core::Executor::Shared().Submit(
+            [this, bdf, doe_offset, protocol, request = std::move(request)]() {
+                return DoeExchange(bdf, doe_offset, protocol, request);
+            });
+    }
 };
 
 }  // namespace plas::hal::pci
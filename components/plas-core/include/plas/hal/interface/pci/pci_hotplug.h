@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+enum class PciHotplugAction : uint8_t {
+    kAdd,
+    kRemove,
+};
+
+/// A PCI function appeared or disappeared.
+struct PciHotplugEvent {
+    PciHotplugAction action;
+    PciAddress address;
+};
+
+/// Parse one kernel uevent datagram ("ACTION@DEVPATH\0KEY=VALUE\0...").
+/// nullopt unless it is an add/remove of a device with SUBSYSTEM=pci and a
+/// valid PCI_SLOT_NAME.
+std::optional<PciHotplugEvent> ParseUevent(const char* data,
+                                           std::size_t length);
+
+/// Listens for kernel PCI add/remove uevents on a NETLINK_KOBJECT_UEVENT
+/// socket, so hot-added and surprise-removed functions are seen without
+/// polling sysfs.
+///
+/// Every event first bumps the PciTopology generation
+/// (PciTopology::NotifyTopologyChanged(): PciDevice caches and
+/// PciTopologySnapshot::IsStale() follow), then runs the callback on the
+/// monitor thread. Kernel uevents carry no ordering against sysfs reads:
+/// for kAdd the device's sysfs directory exists, but a driver may still
+/// be binding.
+class PciHotplugMonitor {
+public:
+    using Callback = std::function<void(const PciHotplugEvent&)>;
+
+    PciHotplugMonitor();
+    ~PciHotplugMonitor();  // Stop()
+
+    PciHotplugMonitor(const PciHotplugMonitor&) = delete;
+    PciHotplugMonitor& operator=(const PciHotplugMonitor&) = delete;
+
+    /// Open the uevent socket and start the monitor thread. kAlreadyOpen
+    /// if running; kPermissionDenied or kIOError if the socket cannot be
+    /// opened (e.g. no netlink in a container).
+    core::Result<void> Start(Callback callback);
+
+    /// Stop and join the monitor thread. Must not be called from the
+    /// callback.
+    void Stop();
+
+    bool IsRunning() const;
+
+    /// Handle `event` exactly as if it had been received (for events
+    /// forwarded from udev, and for testing). Runs on the calling thread.
+    void Dispatch(const PciHotplugEvent& event);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+class PciDevice;
+
+/// PCIe link speed, in the encoding of Link Status Current Link Speed and
+/// Link Control 2 Target Link Speed.
+enum class PciLinkSpeed : uint8_t {
+    kUnknown = 0,
+    kGen1 = 1,  ///< 2.5 GT/s
+    kGen2 = 2,  ///< 5.0 GT/s
+    kGen3 = 3,  ///< 8.0 GT/s
+    kGen4 = 4,  ///< 16.0 GT/s
+    kGen5 = 5,  ///< 32.0 GT/s
+    kGen6 = 6,  ///< 64.0 GT/s
+};
+
+/// Link Status (PCIe cap + 0x12), decoded.
+struct PciLinkState {
+    PciLinkSpeed speed;  ///< Current Link Speed
+    uint8_t width;       ///< Negotiated Link Width (lanes)
+    bool training;       ///< Link Training
+    bool dll_active;     ///< Data Link Layer Link Active
+    uint16_t raw;        ///< the register as read
+
+    static PciLinkState Decode(uint16_t link_status);
+};
+
+/// What a port supports, from PCIe Capabilities, Link Capabilities and
+/// Link Capabilities 2. Read once and cached by PciLink.
+struct PciLinkCapabilities {
+    ConfigOffset pcie_cap;  ///< offset of the PCIe capability
+    PciePortType port_type;
+    PciLinkSpeed max_speed;
+    uint8_t max_width;
+    /// Supported Link Speeds Vector: bit n-1 set if Gen n is supported.
+    /// Derived from max_speed on ports without Link Capabilities 2.
+    uint8_t supported_speeds;
+    bool dll_active_reporting;  ///< Data Link Layer Link Active is valid
+
+    bool Supports(PciLinkSpeed speed) const;
+    /// Root and switch downstream ports; Retrain Link is reserved elsewhere.
+    bool CanRetrain() const;
+};
+
+/// One retrain, timed from the Link Control write to the first Link Status
+/// read that showed training done.
+struct PciLinkTransition {
+    PciLinkState before;
+    PciLinkState after;
+    std::chrono::microseconds elapsed;
+    uint32_t polls;             ///< Link Status reads after the write
+    bool observed_training;     ///< Link Training was seen set at least once
+};
+
+struct PciLinkOptions {
+    /// Longest a retrain may take (less if the caller's core::Deadline
+    /// comes first). Training normally finishes in well under 100 ms.
+    std::chrono::milliseconds timeout{1000};
+    /// Link Status is re-read without sleeping for this long, then with
+    /// exponential backoff from 1 us up to poll_interval.
+    std::chrono::microseconds spin{2000};
+    std::chrono::microseconds poll_interval{50};
+    /// On ports with dll_active_reporting, a retrain is complete only once
+    /// Data Link Layer Link Active is set again.
+    bool wait_for_dll_active = true;
+};
+
+/// Retrain and speed changes of one PCIe port, through PciConfig or a
+/// PciDevice.
+///
+/// The PCIe capability offset and the capability registers are resolved on
+/// first use and re-read only after a PciTopology change, so each retrain
+/// costs a Link Control read-modify-write followed by Link Status reads.
+/// Completion is detected by polling Link Status (spin, then short sleeps)
+/// rather than fixed sleeps, and the transition time is reported in
+/// microseconds.
+///
+/// Operate on the downstream side of the link (root port or switch
+/// downstream port). There is no standard control for link width; the
+/// negotiated width is reported in PciLinkTransition::after.
+///
+/// Thread-safe; retrains of one PciLink are serialized. The PciConfig
+/// backend or PciDevice must outlive this object.
+class PciLink {
+public:
+    PciLink(PciConfig& config, Bdf bdf, PciLinkOptions options = {});
+    explicit PciLink(PciDevice& device, PciLinkOptions options = {});
+    ~PciLink();
+
+    PciLink(const PciLink&) = delete;
+    PciLink& operator=(const PciLink&) = delete;
+
+    /// kNotSupported if the function has no PCIe capability; errors of
+    /// GetCapabilityIndex or the config reads.
+    core::Result<PciLinkCapabilities> GetCapabilities();
+
+    /// Current Link Status.
+    core::Result<PciLinkState> GetState();
+
+    /// Set Retrain Link and wait for training to finish. kNotSupported
+    /// unless CanRetrain(); kTimeout if the link is still training (or,
+    /// with wait_for_dll_active, not yet active) at the deadline.
+    core::Result<PciLinkTransition> Retrain();
+
+    /// Write `speed` to Target Link Speed (Link Control 2) and Retrain().
+    /// kInvalidArgument if the port does not support it. The link may
+    /// still come up slower if the partner cannot follow; check
+    /// PciLinkTransition::after.speed.
+    core::Result<PciLinkTransition> SetTargetSpeed(PciLinkSpeed speed);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal::pci
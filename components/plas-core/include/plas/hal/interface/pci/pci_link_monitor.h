@@ -0,0 +1,116 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+class PciDevice;
+
+/// One sample of a monitored function's error and link state.
+///
+/// Registers of a capability the function lacks read as 0; registers that
+/// could not be read (e.g. the function was surprise-removed) read as all
+/// ones, as config reads of a missing function do on the bus.
+struct PciLinkSample {
+    uint64_t timestamp_ns;       ///< steady_clock
+    uint32_t device;             ///< index returned by AddDevice()
+    uint16_t device_status;      ///< PCIe Device Status (cap + 0x0A)
+    uint16_t link_status;        ///< PCIe Link Status (cap + 0x12)
+    uint32_t aer_uncorrectable;  ///< AER Uncorrectable Error Status (+0x04)
+    uint32_t aer_correctable;    ///< AER Correctable Error Status (+0x10)
+
+    /// True if the register values (not the timestamp) differ.
+    bool StateDiffers(const PciLinkSample& other) const {
+        return device_status != other.device_status ||
+               link_status != other.link_status ||
+               aer_uncorrectable != other.aer_uncorrectable ||
+               aer_correctable != other.aer_correctable;
+    }
+};
+
+struct PciLinkMonitorOptions {
+    std::chrono::milliseconds interval{100};  ///< time between batches
+    std::size_t ring_capacity = 4096;  ///< samples kept; rounded up to 2^n
+    /// A changed state must hold for this long (across samples) before the
+    /// change callback fires; 0 reports every change on the next sample.
+    std::chrono::milliseconds debounce{0};
+    /// Sample from core::Executor::ForCpus(cpus), e.g. a device's
+    /// PciDevice::LocalCpus() so config reads stay on its socket. Empty:
+    /// Executor::Shared().
+    std::vector<int> cpus;
+};
+
+/// Samples PCIe Device/Link Status and AER status of many functions at a
+/// fixed rate, from a timer on core::Executor::Shared() (or the executor of
+/// options.cpus).
+///
+/// AddDevice() resolves the PCIe and AER capability offsets once; each
+/// batch then costs two ReadConfigBlock calls per function (PCIe status
+/// words, AER status block) with no capability walks. Samples go into a
+/// ring that any number of readers consume with their own cursor, without
+/// locks and without ever blocking the sampler: a reader that falls more
+/// than ring_capacity behind loses the oldest samples and is told how many.
+///
+/// Devices and the callback are registered before Start(); the PciConfig
+/// backends or PciDevices must outlive the monitor.
+class PciLinkMonitor {
+public:
+    /// Called on an executor worker with the last reported and the new
+    /// state of one device.
+    using ChangeCallback = std::function<void(const PciLinkSample& previous,
+                                              const PciLinkSample& current)>;
+
+    explicit PciLinkMonitor(PciLinkMonitorOptions options = {});
+    ~PciLinkMonitor();  // Stop()
+
+    PciLinkMonitor(const PciLinkMonitor&) = delete;
+    PciLinkMonitor& operator=(const PciLinkMonitor&) = delete;
+
+    /// Register a function; returns its index (PciLinkSample::device).
+    /// kBusy while running; errors of GetCapabilityIndex.
+    core::Result<uint32_t> AddDevice(PciConfig& config, Bdf bdf);
+    core::Result<uint32_t> AddDevice(PciDevice& device);
+    std::size_t DeviceCount() const;
+
+    /// Debounced per-device change notification (see options.debounce).
+    /// The first sample of a device sets its baseline without a call.
+    /// kBusy while running.
+    core::Result<void> SetChangeCallback(ChangeCallback callback);
+
+    /// Start sampling (first batch right away). kAlreadyOpen if running.
+    /// Stop() returns once a batch in progress has finished.
+    core::Result<void> Start();
+    void Stop();
+    bool IsRunning() const;
+
+    /// Sample every device once on the calling thread, as one tick of the
+    /// timer does. Serialized with the timer.
+    void SampleOnce();
+
+    // -- Ring readers --------------------------------------------------------
+
+    /// Position of the next sample to be written. Start a cursor here to
+    /// read only samples taken from now on, or at 0 for the oldest kept.
+    uint64_t WritePosition() const;
+
+    /// Copy up to `max` samples from `cursor` on into `out` and advance
+    /// `cursor`. Samples overwritten before they were read are skipped and
+    /// added to `*lost`. Wait-free; each reader owns its cursor.
+    std::size_t Read(uint64_t& cursor, PciLinkSample* out, std::size_t max,
+                     uint64_t* lost = nullptr) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/pci_bar.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+class PciDevice;
+
+/// One MSI-X table entry, laid out as in the table (PCIe 6.0 7.7.2), so a
+/// range of entries is copied to and from the BAR as is.
+struct PciMsixEntry {
+    uint32_t address_lo;
+    uint32_t address_hi;
+    uint32_t data;
+    uint32_t vector_control;  ///< bit 0 = Mask
+
+    static constexpr uint32_t kMask = 1u << 0;
+
+    uint64_t Address() const {
+        return (static_cast<uint64_t>(address_hi) << 32) | address_lo;
+    }
+    bool Masked() const { return (vector_control & kMask) != 0; }
+};
+static_assert(sizeof(PciMsixEntry) == 16, "MSI-X table entries are 16 bytes");
+
+/// Where the MSI-X structures live, from the capability.
+struct PciMsixLocation {
+    ConfigOffset cap;       ///< MSI-X capability offset
+    uint16_t table_size;    ///< vectors
+    uint8_t table_bar;
+    uint32_t table_offset;  ///< within table_bar
+    uint8_t pba_bar;
+    uint32_t pba_offset;    ///< within pba_bar
+};
+
+/// MSI-X table access through the function's mapped BAR.
+///
+/// The capability is read once for the table and PBA locations (again only
+/// after a PciTopology remove/rescan). Table ranges move with one bulk BAR
+/// copy of QWord accesses instead of a BarRead32/BarWrite32 per dword.
+///
+///   PciMsix msix(device);
+///   std::vector<PciMsixEntry> table(msix.GetLocation().Value().table_size);
+///   msix.ReadEntries(0, table.data(), table.size());
+///   msix.SetMasked(0, table.size(), true);
+///
+/// Thread-safe; calls are serialized.
+class PciMsix {
+public:
+    PciMsix(PciConfig& config, PciBar& bar, Bdf bdf);
+    explicit PciMsix(PciDevice& device);
+    ~PciMsix();
+
+    PciMsix(const PciMsix&) = delete;
+    PciMsix& operator=(const PciMsix&) = delete;
+
+    /// kNotSupported without an MSI-X capability; kIOError if it names a
+    /// BAR above 5.
+    core::Result<PciMsixLocation> GetLocation();
+
+    /// MSI-X Enable and Function Mask (Message Control bits 15 and 14).
+    core::Result<bool> IsEnabled();
+    core::Result<void> SetEnabled(bool enabled);
+    core::Result<bool> IsFunctionMasked();
+    core::Result<void> SetFunctionMasked(bool masked);
+
+    /// Copy `count` entries starting at vector `first` out of / into the
+    /// table. kOutOfRange past table_size. A device may latch an unmasked
+    /// entry while it is being rewritten: mask it (or the function) first,
+    /// or write it with the Mask bit set.
+    core::Result<void> ReadEntries(uint16_t first, PciMsixEntry* entries,
+                                   std::size_t count);
+    core::Result<void> WriteEntries(uint16_t first, const PciMsixEntry* entries,
+                                    std::size_t count);
+
+    /// Set or clear the Mask bit of vectors [first, first + count): one
+    /// bulk read of the range, then a Vector Control write only for the
+    /// entries that change. Returns how many changed.
+    core::Result<std::size_t> SetMasked(uint16_t first, std::size_t count, bool masked);
+
+    /// Pending Bit Array: bit n of word n / 64 is vector n, table_size
+    /// bits in all.
+    core::Result<std::vector<uint64_t>> ReadPendingBits();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+class PciDevice;
+
+/// What allowed polling for readiness to start before the default wait.
+/// With several functions, the slowest (latest listed) one is reported.
+enum class PciReadinessSource : uint8_t {
+    kImmediate,      ///< Immediate Readiness (Status bit 0) on every function
+    kDrs,            ///< DRS (SBR: Link Capabilities 2 of the bridge)
+    kFrs,            ///< FRS (FLR: Device Capabilities 2 of the function)
+    kReadinessTime,  ///< Readiness Time Reporting capability, valid times
+    kDefaultWait,    ///< none of the above: options.min_wait
+};
+
+struct PciResetOptions {
+    /// Longest a function may take to answer config reads after the reset
+    /// (less if the caller's core::Deadline comes first). PCIe allows 1 s
+    /// of Request Retry Status completions.
+    std::chrono::milliseconds timeout{1000};
+    /// Wait before the first config read to a function that reports
+    /// nothing faster: the PCIe 100 ms rule. Lowering it is only safe with
+    /// Configuration RRS Software Visibility enabled on the root port.
+    std::chrono::milliseconds min_wait{100};
+    /// Secondary Bus Reset is held asserted this long (Trst is 1 ms).
+    std::chrono::microseconds reset_hold{2000};
+    /// Vendor ID is re-read with exponential backoff from 10 us up to this.
+    std::chrono::microseconds poll_interval{1000};
+};
+
+struct PciResetResult {
+    PciReadinessSource source;
+    /// From the end of the reset (FLR write, SBR deassert) until every
+    /// function read back a valid Vendor ID.
+    std::chrono::microseconds elapsed;
+    /// Fixed part of `elapsed` spent before the first Vendor ID read.
+    std::chrono::microseconds waited;
+    uint32_t polls;      ///< Vendor ID reads
+    uint32_t rrs_polls;  ///< of which returned 0x0001 (Request Retry Status)
+};
+
+// Reset primitives that return as soon as the reset functions are ready
+// instead of sleeping for the worst case.
+//
+// Readiness signals are read before the reset: Immediate Readiness,
+// Readiness Time Reporting, DRS support on the bridge (SBR) and FRS
+// support on the function (FLR). Without one, polling starts after
+// options.min_wait. A function is ready once Vendor ID reads as neither
+// 0xFFFF (no response) nor 0x0001 (RRS).
+//
+// A reset clears the functions' config space (BARs, Command, MSI);
+// restore what the caller needs, e.g. from SnapshotConfig(), afterwards.
+// Each reset issued is counted (GetResetCount) so caches of function state
+// such as DoeInventory notice it.
+
+/// Function Level Reset through Device Control (Initiate FLR), after
+/// waiting up to 100 ms for Transactions Pending to clear. kNotSupported
+/// unless Device Capabilities reports FLR; kTimeout if the function is not
+/// ready in time.
+core::Result<PciResetResult> FunctionLevelReset(PciConfig& config, Bdf function,
+                                                const PciResetOptions& options = {});
+core::Result<PciResetResult> FunctionLevelReset(PciDevice& function,
+                                                const PciResetOptions& options = {});
+
+/// Secondary Bus Reset through the Bridge Control register of `bridge`;
+/// on a PCIe root or downstream port this is a Hot Reset of its link. Waits
+/// for DLL Link Active where the bridge reports it, then for every one of
+/// `functions` (the functions below the bridge to wait for; may be empty).
+/// kInvalidArgument if `bridge` is not a bridge; kTimeout as above.
+core::Result<PciResetResult> SecondaryBusReset(PciConfig& config, Bdf bridge,
+                                               const std::vector<Bdf>& functions,
+                                               const PciResetOptions& options = {});
+core::Result<PciResetResult> SecondaryBusReset(PciDevice& bridge,
+                                               const std::vector<PciDevice*>& functions,
+                                               const PciResetOptions& options = {});
+
+/// Resets issued by this process that reached `function`: its FLRs plus
+/// Secondary Bus Resets of bridges whose secondary..subordinate bus range
+/// holds its bus. Counted once the reset is written, whether or not the
+/// function came back in time. PCI segments are not told apart.
+uint64_t GetResetCount(Bdf function);
+
+}  // namespace plas::hal::pci
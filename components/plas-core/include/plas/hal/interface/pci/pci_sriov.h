@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_device.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+/// The PF's SR-IOV Extended Capability (PCIe 6.0 9.3.3), as last read.
+struct PciSriovInfo {
+    ConfigOffset offset;       ///< capability offset in the PF
+    uint16_t initial_vfs;
+    uint16_t total_vfs;
+    uint16_t num_vfs;          ///< NumVFs register
+    bool enabled;              ///< VF Enable (SR-IOV Control bit 0)
+    uint16_t first_vf_offset;  ///< valid for the current NumVFs
+    uint16_t vf_stride;
+    uint16_t vf_device_id;
+};
+
+/// SR-IOV PF: enables VFs through sysfs `sriov_numvfs` and gives pooled
+/// config access to all of them.
+///
+/// VF addresses come from the capability's First VF Offset and VF Stride
+/// (routing ID of VF n = PF + offset + n * stride) instead of a sysfs walk,
+/// and VfConfig() reaches every VF without a PciDevice::Open per VF: with
+/// ECAM one mapping covers all VFs, with sysfs each VF's config file is
+/// opened on first use and kept open.
+///
+///   auto sriov = PciSriov::Open(pf_address);
+///   sriov.Value().Enable(128);
+///   auto results = sriov.Value().ForEachVf([](PciConfig& config, Bdf vf) {
+///       return config.WriteConfig16(vf, 0x04, 0x0006);  // MSE | BME
+///   });
+///
+/// Enable()/Disable() must not run concurrently with any other call; VF
+/// config access itself is thread-safe.
+class PciSriov {
+public:
+    /// Open the PF (PciDevice::Open with `access`) and read its SR-IOV
+    /// capability. kNotSupported if the function has none. kEcam fails
+    /// like PciDevice::Open; kAuto falls back to sysfs, VFs included.
+    static core::Result<PciSriov> Open(const PciAddress& pf,
+                                       ConfigAccess access = ConfigAccess::kSysfs);
+
+    ~PciSriov();
+    PciSriov(PciSriov&& other) noexcept;
+    PciSriov& operator=(PciSriov&& other) noexcept;
+
+    PciSriov(const PciSriov&) = delete;
+    PciSriov& operator=(const PciSriov&) = delete;
+
+    PciDevice& Pf();
+
+    /// Re-read the capability; kIOError if it has gone away.
+    core::Result<PciSriovInfo> GetInfo();
+
+    /// Enable `num_vfs` VFs by writing `sriov_numvfs`. The kernel adds
+    /// the VFs before the write returns (their drivers may still be
+    /// probing). A different non-zero count is disabled first, as the
+    /// kernel requires. kInvalidArgument above TotalVFs; kPermissionDenied
+    /// or kIOError if the kernel refuses (no PF driver, VFs in use).
+    core::Result<void> Enable(uint16_t num_vfs);
+    core::Result<void> Disable();
+
+    /// Enabled VFs in VF order, as of Open/Enable/Disable.
+    const std::vector<PciAddress>& VfAddresses() const;
+    std::size_t NumVfs() const;
+
+    /// Config space of the enabled VFs, addressed by their Bdf (the PF's
+    /// domain). kNotFound for any other Bdf. The reference stays valid for
+    /// the lifetime of this object; Enable/Disable retarget it.
+    PciConfig& VfConfig();
+
+    /// Run `body` once per enabled VF on core::Executor::Shared() with up
+    /// to `workers` threads (the caller included; 0 = all workers). One
+    /// result per VF, in VF order.
+    std::vector<core::Result<void>> ForEachVf(
+        const std::function<core::Result<void>(PciConfig&, Bdf)>& body,
+        std::size_t workers = 0);
+
+    /// Addresses of `count` VFs of `pf` from First VF Offset and VF Stride.
+    /// kInvalidArgument for a zero offset (or zero stride with several
+    /// VFs); kOutOfRange if a VF would fall past bus 255.
+    static core::Result<std::vector<PciAddress>> ComputeVfAddresses(
+        const PciAddress& pf, uint16_t first_vf_offset, uint16_t vf_stride,
+        uint16_t count);
+
+private:
+    PciSriov();
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal::pci
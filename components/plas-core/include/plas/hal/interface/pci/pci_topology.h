@@ -1,7 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "plas/core/result.h"
@@ -15,6 +20,47 @@ struct PciDeviceNode {
     PciePortType port_type;
     bool is_bridge;          ///< Header Type 1
     std::string sysfs_path;  ///< e.g., /sys/bus/pci/devices/0000:03:00.0
+    int numa_node = -1;      ///< sysfs numa_node; -1 if the platform reports none
+    std::vector<int> local_cpus;  ///< sysfs local_cpulist; empty if unknown
+};
+
+/// Every PCI function in the system, as parallel arrays: element i of each
+/// vector describes the same function. Sorted by address.
+struct PciInventory {
+    std::vector<PciAddress> addresses;
+    std::vector<uint16_t> vendor_ids;
+    std::vector<uint16_t> device_ids;
+    std::vector<uint32_t> class_codes;   ///< base class[23:16] | sub[15:8] | prog-if[7:0]
+    std::vector<uint8_t> header_types;   ///< offset 0x0E, multi-function bit masked
+    std::vector<PciePortType> port_types;
+    std::vector<uint16_t> link_status;   ///< PCIe Link Status (speed [3:0],
+                                         ///< width [9:4]); 0 without a PCIe cap
+
+    std::size_t Size() const { return addresses.size(); }
+};
+
+struct PciRescanOptions {
+    /// Longest to wait for the set to reappear after the rescans (less if
+    /// the caller's core::Deadline comes first).
+    std::chrono::milliseconds timeout{10000};
+    /// sysfs is re-checked this often when no uevent arrives (or the
+    /// uevent socket cannot be opened).
+    std::chrono::milliseconds poll_interval{10};
+    /// Subtrees handled at once on core::Executor::Shared() (the caller
+    /// included); 0 = all workers.
+    std::size_t workers = 0;
+};
+
+/// Per-device timings of PciTopology::RemoveAndRescan.
+struct PciRescanTiming {
+    PciAddress address;
+    /// sysfs remove write of the device, or of the ancestor in the set
+    /// that took it along.
+    std::chrono::microseconds remove{0};
+    /// sysfs rescan write of the bridge above the removed subtree.
+    std::chrono::microseconds rescan{0};
+    /// From the start of that rescan write until the device was back.
+    std::chrono::microseconds reappear{0};
 };
 
 /// sysfs-based PCI topology traversal and device management.
@@ -49,6 +95,16 @@ public:
     static core::Result<std::vector<PciDeviceNode>> GetPathToRoot(
         const PciAddress& addr);
 
+    /// Read the header of every function under <sysfs root>/bus/pci/devices
+    /// (all domains and buses) on up to `workers` threads of
+    /// core::Executor::Shared() (the caller included), 0 = all of them.
+    /// Each thread reads its share in batches of 64 (core::BatchReader,
+    /// io_uring where available).
+    /// Functions whose config space cannot be read are listed with
+    /// vendor ID 0xFFFF; unprivileged reads (64 bytes) give kUnknown port
+    /// type and zero link status. kNotFound if the directory is missing.
+    static core::Result<PciInventory> EnumerateAll(std::size_t workers = 0);
+
     /// Remove a device via sysfs (writes "1" to remove file).
     static core::Result<void> RemoveDevice(const PciAddress& addr);
 
@@ -58,20 +114,63 @@ public:
     /// Global PCI bus rescan.
     static core::Result<void> RescanAll();
 
+    /// Remove every device of `devices` and bring it back.
+    ///
+    /// Devices with an ancestor in the set go away with that ancestor, so
+    /// only the topmost ones are removed; each is brought back by a rescan
+    /// of its parent bridge (RescanAll for devices on a root bus). Work is
+    /// grouped by the subtree under the root complex: groups run
+    /// concurrently, removes and rescans within one group in order. The
+    /// call then waits for all devices to reappear, woken by kernel
+    /// uevents (PciHotplugMonitor) and re-checking sysfs every
+    /// poll_interval.
+    ///
+    /// One result per device, in order: kNotFound if it did not exist,
+    /// the remove or rescan error, or kTimeout if it was not back in time.
+    static std::vector<core::Result<PciRescanTiming>> RemoveAndRescan(
+        const std::vector<PciAddress>& devices,
+        const PciRescanOptions& options = {});
+
     /// Override sysfs root for unit testing (default: "/sys").
     static void SetSysfsRoot(const std::string& root);
 
     /// Get the current sysfs root (for PciDevice to share).
     static const std::string& GetSysfsRoot();
 
+    /// Monotonic counter bumped by every successful RemoveDevice,
+    /// RescanBridge, or RescanAll. Components that cache per-device handles
+    /// compare against it to detect topology changes.
+    static uint64_t GetTopologyGeneration();
+
+    /// Bump the generation for a topology change made outside this class
+    /// (hotplug, a udev add/remove event, another process's rescan), so
+    /// caches and PciTopologySnapshot see it as stale.
+    static void NotifyTopologyChanged();
+
 private:
+    friend class PciTopologySnapshot;
+
     static std::string sysfs_root_;
+    static std::atomic<uint64_t> topology_generation_;
 
     static core::Result<std::string> ReadSysfsFile(const std::string& path);
     static core::Result<void> WriteSysfsFile(const std::string& path,
                                               const std::string& value);
     static PciePortType ReadPortType(const std::string& sysfs_device_path);
-    static bool ReadIsBridge(const std::string& sysfs_device_path);
+    /// Port type and bridge flag from one read of the config header.
+    static void ReadHeaderInfo(const std::string& sysfs_device_path,
+                               PciePortType& port_type, bool& is_bridge);
+    /// The same from header bytes already read (`size` may be short).
+    static void ParseHeaderInfo(const core::Byte* data, std::size_t size,
+                                PciePortType& port_type, bool& is_bridge);
+    /// numa_node and local_cpulist; missing or unreadable files leave
+    /// the node's defaults.
+    static void ReadNumaInfo(const std::string& sysfs_device_path,
+                             PciDeviceNode& node);
+    /// The same from file contents already read (empty = missing).
+    static void ParseNumaInfo(std::string_view numa_node,
+                              std::string_view local_cpulist,
+                              PciDeviceNode& node);
     static core::Result<std::vector<PciAddress>> ParseTopologyPath(
         const std::string& real_path);
 };
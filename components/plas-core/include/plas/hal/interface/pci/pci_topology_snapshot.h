@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/pci_hotplug.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+/// In-memory copy of the PCI hierarchy under <sysfs root>/bus/pci/devices.
+///
+/// Build() walks the directory once, with one realpath per device; the
+/// config headers, numa_node and local_cpulist files are then read in
+/// batches (core::BatchReader, io_uring where available). After that every query is a hash lookup with no
+/// sysfs I/O, unlike the PciTopology statics, which go back to sysfs on
+/// each call. Answers match PciTopology for the devices sysfs listed at
+/// build time.
+///
+/// A snapshot does not follow hotplug by itself: IsStale() turns true once
+/// the PciTopology generation moves (RemoveDevice/Rescan*, or
+/// PciTopology::NotifyTopologyChanged() from a udev event handler), and
+/// Refresh() rebuilds it, or Apply() folds in one PciHotplugMonitor event
+/// at the cost of a single device read. Const queries may run
+/// concurrently; Refresh() and Apply() must not race with them.
+class PciTopologySnapshot {
+public:
+    /// Scan sysfs. kNotFound if <sysfs root>/bus/pci/devices is missing.
+    static core::Result<PciTopologySnapshot> Build();
+
+    /// Rebuild in place; on error the snapshot is left unchanged.
+    core::Result<void> Refresh();
+
+    /// Update for one hotplug event: kAdd reads just that device from
+    /// sysfs (kNotFound if it is already gone again), kRemove drops it and
+    /// everything below it. Afterwards the snapshot takes the current
+    /// generation, so apply every event the monitor delivers, in order.
+    core::Result<void> Apply(const PciHotplugEvent& event);
+
+    /// PciTopology generation the snapshot was built or last updated at.
+    uint64_t Generation() const { return generation_; }
+    bool IsStale() const;
+
+    /// All devices, sorted by address.
+    const std::vector<PciDeviceNode>& Devices() const { return nodes_; }
+    bool Contains(const PciAddress& addr) const;
+
+    // Same contracts as the PciTopology functions of the same name
+    // (kNotFound for devices missing from the snapshot).
+    core::Result<PciDeviceNode> GetDeviceInfo(const PciAddress& addr) const;
+    core::Result<std::optional<PciAddress>> FindParent(
+        const PciAddress& addr) const;
+    core::Result<std::vector<PciAddress>> FindChildren(
+        const PciAddress& bridge_addr) const;
+    core::Result<PciAddress> FindRootPort(const PciAddress& addr) const;
+    core::Result<std::vector<PciDeviceNode>> GetPathToRoot(
+        const PciAddress& addr) const;
+
+private:
+    struct Links {
+        std::vector<PciAddress> path;  // root first, the device last
+        std::vector<std::size_t> children;  // indexes into nodes_
+        std::optional<PciAddress> root_port;
+    };
+
+    static uint32_t Key(const PciAddress& addr) {
+        return (static_cast<uint32_t>(addr.domain) << 16) | addr.bdf.Pack();
+    }
+
+    /// Read one device's node and ancestor path from sysfs.
+    static void ReadDevice(const PciAddress& addr, PciDeviceNode& node,
+                           Links& links);
+
+    /// Address, sysfs path and ancestor path (one realpath).
+    static void ReadLinks(const PciAddress& addr, PciDeviceNode& node,
+                          Links& links);
+
+    /// Port type, bridge flag and NUMA info of `count` nodes whose
+    /// sysfs_path is set, three batched reads per node.
+    static void ReadAttributes(PciDeviceNode* nodes, std::size_t count);
+
+    /// Rebuild index_, child lists and root ports from nodes_ and the
+    /// paths (no sysfs I/O).
+    void Relink();
+
+    /// Index of `addr` in nodes_, or nullopt.
+    std::optional<std::size_t> IndexOf(const PciAddress& addr) const;
+
+    std::vector<PciDeviceNode> nodes_;
+    std::vector<Links> links_;  // parallel to nodes_
+    std::unordered_map<uint32_t, std::size_t> index_;  // key: Key(address)
+    uint64_t generation_ = 0;
+};
+
+}  // namespace plas::hal::pci
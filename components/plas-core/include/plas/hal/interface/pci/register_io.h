@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "plas/core/register.h"
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/pci_bar.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_device.h"
+
+namespace plas::hal::pci {
+
+// Typed access to the registers of the generated register maps
+// (plas/hal/interface/pci/regs/*.h). `base` is where the register block
+// starts: a capability offset in config space, or a register block offset
+// in a BAR. Each call is one access of the register's width (two for
+// ModifyRegister), exactly as the hand-written ReadConfig16 & mask code.
+//
+//   auto status = ReadRegister<regs::pcie::LinkStatus>(device, pcie_cap);
+//   auto width = status.Value().Get<regs::pcie::LinkStatus::NegotiatedLinkWidth>();
+
+namespace detail {
+
+struct ConfigRegisterIo {
+    PciConfig& config;
+    Bdf bdf;
+
+    template <typename T>
+    core::Result<T> Read(uint64_t offset) {
+        auto at = static_cast<ConfigOffset>(offset);
+        static_assert(sizeof(T) <= 4, "config space registers are at most 32 bits");
+        if constexpr (sizeof(T) == 1) return config.ReadConfig8(bdf, at);
+        else if constexpr (sizeof(T) == 2) return config.ReadConfig16(bdf, at);
+        else return config.ReadConfig32(bdf, at);
+    }
+    template <typename T>
+    core::Result<void> Write(uint64_t offset, T value) {
+        auto at = static_cast<ConfigOffset>(offset);
+        if constexpr (sizeof(T) == 1) return config.WriteConfig8(bdf, at, value);
+        else if constexpr (sizeof(T) == 2) return config.WriteConfig16(bdf, at, value);
+        else return config.WriteConfig32(bdf, at, value);
+    }
+};
+
+struct DeviceRegisterIo {
+    PciDevice& device;
+
+    template <typename T>
+    core::Result<T> Read(uint64_t offset) {
+        auto at = static_cast<ConfigOffset>(offset);
+        static_assert(sizeof(T) <= 4, "config space registers are at most 32 bits");
+        if constexpr (sizeof(T) == 1) return device.ReadConfig8(at);
+        else if constexpr (sizeof(T) == 2) return device.ReadConfig16(at);
+        else return device.ReadConfig32(at);
+    }
+    template <typename T>
+    core::Result<void> Write(uint64_t offset, T value) {
+        auto at = static_cast<ConfigOffset>(offset);
+        if constexpr (sizeof(T) == 1) return device.WriteConfig8(at, value);
+        else if constexpr (sizeof(T) == 2) return device.WriteConfig16(at, value);
+        else return device.WriteConfig32(at, value);
+    }
+};
+
+struct BarRegisterIo {
+    PciBar& bar;
+    Bdf bdf;
+    uint8_t bar_index;
+
+    template <typename T>
+    core::Result<T> Read(uint64_t offset) {
+        static_assert(sizeof(T) == 4 || sizeof(T) == 8,
+                      "BAR registers are 32 or 64 bits");
+        if constexpr (sizeof(T) == 4) return bar.BarRead32(bdf, bar_index, offset);
+        else return bar.BarRead64(bdf, bar_index, offset);
+    }
+    template <typename T>
+    core::Result<void> Write(uint64_t offset, T value) {
+        if constexpr (sizeof(T) == 4) return bar.BarWrite32(bdf, bar_index, offset, value);
+        else return bar.BarWrite64(bdf, bar_index, offset, value);
+    }
+};
+
+template <typename Reg, typename Io>
+core::Result<core::RegisterValue<Reg>> ReadRegister(Io io, uint64_t base) {
+    using T = typename Reg::ValueType;
+    auto raw = io.template Read<T>(base + Reg::kOffset);
+    if (raw.IsError()) {
+        return core::Result<core::RegisterValue<Reg>>::Err(raw.Error());
+    }
+    return core::Result<core::RegisterValue<Reg>>::Ok(
+        core::RegisterValue<Reg>(raw.Value()));
+}
+
+template <typename Reg, typename Io>
+core::Result<void> WriteRegister(Io io, uint64_t base,
+                                 const core::RegisterValue<Reg>& value) {
+    using T = typename Reg::ValueType;
+    return io.template Write<T>(base + Reg::kOffset, value.ForWrite());
+}
+
+template <typename Reg, typename Io, typename Fn>
+core::Result<core::RegisterValue<Reg>> ModifyRegister(Io io, uint64_t base, Fn&& fn) {
+    auto value = ReadRegister<Reg>(io, base);
+    if (value.IsError()) {
+        return value;
+    }
+    std::forward<Fn>(fn)(value.Value());
+    auto written = WriteRegister<Reg>(io, base, value.Value());
+    if (written.IsError()) {
+        return core::Result<core::RegisterValue<Reg>>::Err(written.Error());
+    }
+    return value;
+}
+
+}  // namespace detail
+
+// --- Config space through a PciConfig backend ---
+
+template <typename Reg>
+core::Result<core::RegisterValue<Reg>> ReadRegister(PciConfig& config, Bdf bdf,
+                                                    ConfigOffset base = 0) {
+    return detail::ReadRegister<Reg>(detail::ConfigRegisterIo{config, bdf}, base);
+}
+
+template <typename Reg>
+core::Result<void> WriteRegister(PciConfig& config, Bdf bdf, ConfigOffset base,
+                                 const core::RegisterValue<Reg>& value) {
+    return detail::WriteRegister<Reg>(detail::ConfigRegisterIo{config, bdf}, base,
+                                      value);
+}
+
+/// One read, `fn(RegisterValue<Reg>&)`, one write of ForWrite(). Returns
+/// the value as modified (RW1C bits as read).
+template <typename Reg, typename Fn>
+core::Result<core::RegisterValue<Reg>> ModifyRegister(PciConfig& config, Bdf bdf,
+                                                      ConfigOffset base, Fn&& fn) {
+    return detail::ModifyRegister<Reg>(detail::ConfigRegisterIo{config, bdf}, base,
+                                       std::forward<Fn>(fn));
+}
+
+// --- Config space of an open PciDevice ---
+
+template <typename Reg>
+core::Result<core::RegisterValue<Reg>> ReadRegister(PciDevice& device,
+                                                    ConfigOffset base = 0) {
+    return detail::ReadRegister<Reg>(detail::DeviceRegisterIo{device}, base);
+}
+
+template <typename Reg>
+core::Result<void> WriteRegister(PciDevice& device, ConfigOffset base,
+                                 const core::RegisterValue<Reg>& value) {
+    return detail::WriteRegister<Reg>(detail::DeviceRegisterIo{device}, base, value);
+}
+
+template <typename Reg, typename Fn>
+core::Result<core::RegisterValue<Reg>> ModifyRegister(PciDevice& device,
+                                                      ConfigOffset base, Fn&& fn) {
+    return detail::ModifyRegister<Reg>(detail::DeviceRegisterIo{device}, base,
+                                       std::forward<Fn>(fn));
+}
+
+// --- MMIO registers in a BAR (32/64-bit registers only) ---
+
+template <typename Reg>
+core::Result<core::RegisterValue<Reg>> ReadRegister(PciBar& bar, Bdf bdf,
+                                                    uint8_t bar_index,
+                                                    uint64_t base) {
+    return detail::ReadRegister<Reg>(detail::BarRegisterIo{bar, bdf, bar_index},
+                                     base);
+}
+
+template <typename Reg>
+core::Result<void> WriteRegister(PciBar& bar, Bdf bdf, uint8_t bar_index,
+                                 uint64_t base,
+                                 const core::RegisterValue<Reg>& value) {
+    return detail::WriteRegister<Reg>(detail::BarRegisterIo{bar, bdf, bar_index},
+                                      base, value);
+}
+
+template <typename Reg, typename Fn>
+core::Result<core::RegisterValue<Reg>> ModifyRegister(PciBar& bar, Bdf bdf,
+                                                      uint8_t bar_index,
+                                                      uint64_t base, Fn&& fn) {
+    return detail::ModifyRegister<Reg>(detail::BarRegisterIo{bar, bdf, bar_index},
+                                       base, std::forward<Fn>(fn));
+}
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,97 @@
+// Generated by plas_regmap_gen from aer.regs.yaml. Do not edit:
+// change the YAML and rebuild the plas_regmaps target.
+#pragma once
+
+#include <cstdint>
+
+#include "plas/core/register.h"
+
+/// Advanced Error Reporting registers (PCIe 6.0 7.8.4), offsets from the extended capability.
+namespace plas::hal::pci::regs::aer {
+
+/// Uncorrectable Error Status Register (offset 0x04, 32 bits)
+struct UncorrectableErrorStatus : plas::core::Register<uint32_t, 0x04, 0xFFFFF030> {
+    using DataLinkProtocolError = plas::core::RegisterField<UncorrectableErrorStatus, 4, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using SurpriseDownError = plas::core::RegisterField<UncorrectableErrorStatus, 5, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using PoisonedTlpReceived = plas::core::RegisterField<UncorrectableErrorStatus, 12, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using FlowControlProtocolError = plas::core::RegisterField<UncorrectableErrorStatus, 13, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using CompletionTimeout = plas::core::RegisterField<UncorrectableErrorStatus, 14, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using CompleterAbort = plas::core::RegisterField<UncorrectableErrorStatus, 15, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using UnexpectedCompletion = plas::core::RegisterField<UncorrectableErrorStatus, 16, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using ReceiverOverflow = plas::core::RegisterField<UncorrectableErrorStatus, 17, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using MalformedTlp = plas::core::RegisterField<UncorrectableErrorStatus, 18, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using EcrcError = plas::core::RegisterField<UncorrectableErrorStatus, 19, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using UnsupportedRequestError = plas::core::RegisterField<UncorrectableErrorStatus, 20, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using AcsViolation = plas::core::RegisterField<UncorrectableErrorStatus, 21, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using UncorrectableInternalError = plas::core::RegisterField<UncorrectableErrorStatus, 22, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using McBlockedTlp = plas::core::RegisterField<UncorrectableErrorStatus, 23, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using AtomicOpEgressBlocked = plas::core::RegisterField<UncorrectableErrorStatus, 24, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using TlpPrefixBlockedError = plas::core::RegisterField<UncorrectableErrorStatus, 25, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using PoisonedTlpEgressBlocked = plas::core::RegisterField<UncorrectableErrorStatus, 26, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using DmwrRequestEgressBlocked = plas::core::RegisterField<UncorrectableErrorStatus, 27, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using IdeCheckFailed = plas::core::RegisterField<UncorrectableErrorStatus, 28, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using MisroutedIdeTlp = plas::core::RegisterField<UncorrectableErrorStatus, 29, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using PcrcCheckFailed = plas::core::RegisterField<UncorrectableErrorStatus, 30, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using TlpTranslationEgressBlocked = plas::core::RegisterField<UncorrectableErrorStatus, 31, 1, plas::core::FieldAccess::kRW1C, bool>;
+};
+
+/// Uncorrectable Error Mask Register (bit layout of the status register) (offset 0x08, 32 bits)
+struct UncorrectableErrorMask : plas::core::Register<uint32_t, 0x08> {};
+
+/// Uncorrectable Error Severity Register (bit layout of the status register, 1 = fatal) (offset 0x0C, 32 bits)
+struct UncorrectableErrorSeverity : plas::core::Register<uint32_t, 0x0C> {};
+
+/// Correctable Error Status Register (offset 0x10, 32 bits)
+struct CorrectableErrorStatus : plas::core::Register<uint32_t, 0x10, 0xF1C1> {
+    using ReceiverError = plas::core::RegisterField<CorrectableErrorStatus, 0, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using BadTlp = plas::core::RegisterField<CorrectableErrorStatus, 6, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using BadDllp = plas::core::RegisterField<CorrectableErrorStatus, 7, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using ReplayNumRollover = plas::core::RegisterField<CorrectableErrorStatus, 8, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using ReplayTimerTimeout = plas::core::RegisterField<CorrectableErrorStatus, 12, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using AdvisoryNonFatalError = plas::core::RegisterField<CorrectableErrorStatus, 13, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using CorrectedInternalError = plas::core::RegisterField<CorrectableErrorStatus, 14, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using HeaderLogOverflow = plas::core::RegisterField<CorrectableErrorStatus, 15, 1, plas::core::FieldAccess::kRW1C, bool>;
+};
+
+/// Correctable Error Mask Register (bit layout of the status register) (offset 0x14, 32 bits)
+struct CorrectableErrorMask : plas::core::Register<uint32_t, 0x14> {};
+
+/// Advanced Error Capabilities and Control Register (offset 0x18, 32 bits)
+struct CapabilitiesControl : plas::core::Register<uint32_t, 0x18> {
+    using FirstErrorPointer = plas::core::RegisterField<CapabilitiesControl, 0, 5, plas::core::FieldAccess::kRO, uint8_t>;
+    using EcrcGenerationCapable = plas::core::RegisterField<CapabilitiesControl, 5, 1, plas::core::FieldAccess::kRO, bool>;
+    using EcrcGenerationEnable = plas::core::RegisterField<CapabilitiesControl, 6, 1, plas::core::FieldAccess::kRW, bool>;
+    using EcrcCheckCapable = plas::core::RegisterField<CapabilitiesControl, 7, 1, plas::core::FieldAccess::kRO, bool>;
+    using EcrcCheckEnable = plas::core::RegisterField<CapabilitiesControl, 8, 1, plas::core::FieldAccess::kRW, bool>;
+    using MultipleHeaderRecordingCapable = plas::core::RegisterField<CapabilitiesControl, 9, 1, plas::core::FieldAccess::kRO, bool>;
+    using MultipleHeaderRecordingEnable = plas::core::RegisterField<CapabilitiesControl, 10, 1, plas::core::FieldAccess::kRW, bool>;
+    using TlpPrefixLogPresent = plas::core::RegisterField<CapabilitiesControl, 11, 1, plas::core::FieldAccess::kRO, bool>;
+    using CompletionTimeoutPrefixHeaderLogCapable = plas::core::RegisterField<CapabilitiesControl, 12, 1, plas::core::FieldAccess::kRO, bool>;
+};
+
+/// Root Error Command Register (root ports and RCECs) (offset 0x2C, 32 bits)
+struct RootErrorCommand : plas::core::Register<uint32_t, 0x2C> {
+    using CorrectableErrorReportingEnable = plas::core::RegisterField<RootErrorCommand, 0, 1, plas::core::FieldAccess::kRW, bool>;
+    using NonFatalErrorReportingEnable = plas::core::RegisterField<RootErrorCommand, 1, 1, plas::core::FieldAccess::kRW, bool>;
+    using FatalErrorReportingEnable = plas::core::RegisterField<RootErrorCommand, 2, 1, plas::core::FieldAccess::kRW, bool>;
+};
+
+/// Root Error Status Register (root ports and RCECs) (offset 0x30, 32 bits)
+struct RootErrorStatus : plas::core::Register<uint32_t, 0x30, 0x7F> {
+    using ErrCorReceived = plas::core::RegisterField<RootErrorStatus, 0, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using MultipleErrCorReceived = plas::core::RegisterField<RootErrorStatus, 1, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using ErrFatalNonFatalReceived = plas::core::RegisterField<RootErrorStatus, 2, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using MultipleErrFatalNonFatalReceived = plas::core::RegisterField<RootErrorStatus, 3, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using FirstUncorrectableFatal = plas::core::RegisterField<RootErrorStatus, 4, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using NonFatalErrorMessagesReceived = plas::core::RegisterField<RootErrorStatus, 5, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using FatalErrorMessagesReceived = plas::core::RegisterField<RootErrorStatus, 6, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using AdvancedErrorInterruptMessageNumber = plas::core::RegisterField<RootErrorStatus, 27, 5, plas::core::FieldAccess::kRO, uint8_t>;
+};
+
+/// Error Source Identification Register (root ports and RCECs) (offset 0x34, 32 bits)
+struct ErrorSourceIdentification : plas::core::Register<uint32_t, 0x34> {
+    using ErrCorSourceId = plas::core::RegisterField<ErrorSourceIdentification, 0, 16, plas::core::FieldAccess::kRO, uint16_t>;
+    using ErrFatalNonFatalSourceId = plas::core::RegisterField<ErrorSourceIdentification, 16, 16, plas::core::FieldAccess::kRO, uint16_t>;
+};
+
+}  // namespace plas::hal::pci::regs::aer
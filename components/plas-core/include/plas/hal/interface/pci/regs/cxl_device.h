@@ -0,0 +1,71 @@
+// Generated by plas_regmap_gen from cxl_device.regs.yaml. Do not edit:
+// change the YAML and rebuild the plas_regmaps target.
+#pragma once
+
+#include <cstdint>
+
+#include "plas/core/register.h"
+#include "plas/hal/interface/pci/cxl_types.h"
+
+/// CXL device capabilities array and mailbox registers (CXL 3.1 8.2.8).
+namespace plas::hal::pci::regs::cxl_device {
+
+/// Device Capabilities Array Register (offset 0x00, 64 bits)
+struct CapabilitiesArray : plas::core::Register<uint64_t, 0x00> {
+    /// 0x0000 for the array itself
+    using CapabilityId = plas::core::RegisterField<CapabilitiesArray, 0, 16, plas::core::FieldAccess::kRO, uint16_t>;
+    using Version = plas::core::RegisterField<CapabilitiesArray, 16, 8, plas::core::FieldAccess::kRO, uint8_t>;
+    using Type = plas::core::RegisterField<CapabilitiesArray, 24, 4, plas::core::FieldAccess::kRO, uint8_t>;
+    using CapabilitiesCount = plas::core::RegisterField<CapabilitiesArray, 32, 16, plas::core::FieldAccess::kRO, uint16_t>;
+};
+
+/// Device Capability Header Register; entry n (from 1) is at 16 * n (offset 0x00, 64 bits)
+struct CapabilityHeader : plas::core::Register<uint64_t, 0x00> {
+    /// 0x0002 for the primary mailbox
+    using CapabilityId = plas::core::RegisterField<CapabilityHeader, 0, 16, plas::core::FieldAccess::kRO, uint16_t>;
+    using Version = plas::core::RegisterField<CapabilityHeader, 16, 8, plas::core::FieldAccess::kRO, uint8_t>;
+    /// From the start of the CXL Device Register block
+    using Offset = plas::core::RegisterField<CapabilityHeader, 32, 32, plas::core::FieldAccess::kRO, uint32_t>;
+};
+
+/// Mailbox Capabilities Register (offset 0x00, 32 bits)
+struct MailboxCapabilities : plas::core::Register<uint32_t, 0x00> {
+    /// 2^n bytes, n = 8 (256 B) .. 20 (1 MiB)
+    using PayloadSize = plas::core::RegisterField<MailboxCapabilities, 0, 5, plas::core::FieldAccess::kRO, uint8_t>;
+    using DoorbellInterruptCapable = plas::core::RegisterField<MailboxCapabilities, 5, 1, plas::core::FieldAccess::kRO, bool>;
+    using BackgroundCommandCompleteInterruptCapable = plas::core::RegisterField<MailboxCapabilities, 6, 1, plas::core::FieldAccess::kRO, bool>;
+    using InterruptMessageNumber = plas::core::RegisterField<MailboxCapabilities, 7, 4, plas::core::FieldAccess::kRO, uint8_t>;
+    using MailboxReadyTime = plas::core::RegisterField<MailboxCapabilities, 11, 8, plas::core::FieldAccess::kRO, uint8_t>;
+    using Type = plas::core::RegisterField<MailboxCapabilities, 19, 4, plas::core::FieldAccess::kRO, uint8_t>;
+};
+
+/// Mailbox Control Register (offset 0x04, 32 bits)
+struct MailboxControl : plas::core::Register<uint32_t, 0x04> {
+    /// Set by the host to submit; cleared by the device on completion
+    using Doorbell = plas::core::RegisterField<MailboxControl, 0, 1, plas::core::FieldAccess::kRW, bool>;
+    using DoorbellInterrupt = plas::core::RegisterField<MailboxControl, 1, 1, plas::core::FieldAccess::kRW, bool>;
+    using BackgroundCommandCompleteInterrupt = plas::core::RegisterField<MailboxControl, 2, 1, plas::core::FieldAccess::kRW, bool>;
+};
+
+/// Command Register (offset 0x08, 64 bits)
+struct Command : plas::core::Register<uint64_t, 0x08> {
+    using Opcode = plas::core::RegisterField<Command, 0, 16, plas::core::FieldAccess::kRW, uint16_t>;
+    using PayloadLength = plas::core::RegisterField<Command, 16, 21, plas::core::FieldAccess::kRW, uint32_t>;
+};
+
+/// Mailbox Status Register (offset 0x10, 64 bits)
+struct MailboxStatus : plas::core::Register<uint64_t, 0x10> {
+    using BackgroundOperation = plas::core::RegisterField<MailboxStatus, 0, 1, plas::core::FieldAccess::kRO, bool>;
+    using ReturnCode = plas::core::RegisterField<MailboxStatus, 32, 16, plas::core::FieldAccess::kRO, CxlMailboxReturnCode>;
+    using VendorSpecificExtendedStatus = plas::core::RegisterField<MailboxStatus, 48, 16, plas::core::FieldAccess::kRO, uint16_t>;
+};
+
+/// Background Command Status Register (offset 0x18, 64 bits)
+struct BackgroundCommandStatus : plas::core::Register<uint64_t, 0x18> {
+    using Opcode = plas::core::RegisterField<BackgroundCommandStatus, 0, 16, plas::core::FieldAccess::kRO, uint16_t>;
+    using PercentageComplete = plas::core::RegisterField<BackgroundCommandStatus, 16, 7, plas::core::FieldAccess::kRO, uint8_t>;
+    using ReturnCode = plas::core::RegisterField<BackgroundCommandStatus, 32, 16, plas::core::FieldAccess::kRO, CxlMailboxReturnCode>;
+    using VendorSpecificExtendedStatus = plas::core::RegisterField<BackgroundCommandStatus, 48, 16, plas::core::FieldAccess::kRO, uint16_t>;
+};
+
+}  // namespace plas::hal::pci::regs::cxl_device
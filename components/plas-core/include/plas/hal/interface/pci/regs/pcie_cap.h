@@ -0,0 +1,119 @@
+// Generated by plas_regmap_gen from pcie_cap.regs.yaml. Do not edit:
+// change the YAML and rebuild the plas_regmaps target.
+#pragma once
+
+#include <cstdint>
+
+#include "plas/core/register.h"
+#include "plas/hal/interface/pci/types.h"
+
+/// PCI Express Capability registers (PCIe 6.0 7.5.3), offsets from the capability.
+namespace plas::hal::pci::regs::pcie {
+
+/// PCI Express Capabilities Register (offset 0x02, 16 bits)
+struct Capabilities : plas::core::Register<uint16_t, 0x02> {
+    using Version = plas::core::RegisterField<Capabilities, 0, 4, plas::core::FieldAccess::kRO, uint8_t>;
+    using PortType = plas::core::RegisterField<Capabilities, 4, 4, plas::core::FieldAccess::kRO, PciePortType>;
+    using SlotImplemented = plas::core::RegisterField<Capabilities, 8, 1, plas::core::FieldAccess::kRO, bool>;
+    using InterruptMessageNumber = plas::core::RegisterField<Capabilities, 9, 5, plas::core::FieldAccess::kRO, uint8_t>;
+};
+
+/// Device Capabilities Register (offset 0x04, 32 bits)
+struct DeviceCapabilities : plas::core::Register<uint32_t, 0x04> {
+    using MaxPayloadSizeSupported = plas::core::RegisterField<DeviceCapabilities, 0, 3, plas::core::FieldAccess::kRO, uint8_t>;
+    using ExtendedTagFieldSupported = plas::core::RegisterField<DeviceCapabilities, 5, 1, plas::core::FieldAccess::kRO, bool>;
+    using RoleBasedErrorReporting = plas::core::RegisterField<DeviceCapabilities, 15, 1, plas::core::FieldAccess::kRO, bool>;
+    using FunctionLevelResetCapability = plas::core::RegisterField<DeviceCapabilities, 28, 1, plas::core::FieldAccess::kRO, bool>;
+};
+
+/// Device Control Register (offset 0x08, 16 bits)
+struct DeviceControl : plas::core::Register<uint16_t, 0x08> {
+    using CorrectableErrorReportingEnable = plas::core::RegisterField<DeviceControl, 0, 1, plas::core::FieldAccess::kRW, bool>;
+    using NonFatalErrorReportingEnable = plas::core::RegisterField<DeviceControl, 1, 1, plas::core::FieldAccess::kRW, bool>;
+    using FatalErrorReportingEnable = plas::core::RegisterField<DeviceControl, 2, 1, plas::core::FieldAccess::kRW, bool>;
+    using UnsupportedRequestReportingEnable = plas::core::RegisterField<DeviceControl, 3, 1, plas::core::FieldAccess::kRW, bool>;
+    using EnableRelaxedOrdering = plas::core::RegisterField<DeviceControl, 4, 1, plas::core::FieldAccess::kRW, bool>;
+    using MaxPayloadSize = plas::core::RegisterField<DeviceControl, 5, 3, plas::core::FieldAccess::kRW, uint8_t>;
+    using ExtendedTagFieldEnable = plas::core::RegisterField<DeviceControl, 8, 1, plas::core::FieldAccess::kRW, bool>;
+    using EnableNoSnoop = plas::core::RegisterField<DeviceControl, 11, 1, plas::core::FieldAccess::kRW, bool>;
+    using MaxReadRequestSize = plas::core::RegisterField<DeviceControl, 12, 3, plas::core::FieldAccess::kRW, uint8_t>;
+    /// Always reads 0
+    using InitiateFunctionLevelReset = plas::core::RegisterField<DeviceControl, 15, 1, plas::core::FieldAccess::kRW, bool>;
+};
+
+/// Device Status Register (offset 0x0A, 16 bits)
+struct DeviceStatus : plas::core::Register<uint16_t, 0x0A, 0x0F> {
+    using CorrectableErrorDetected = plas::core::RegisterField<DeviceStatus, 0, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using NonFatalErrorDetected = plas::core::RegisterField<DeviceStatus, 1, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using FatalErrorDetected = plas::core::RegisterField<DeviceStatus, 2, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using UnsupportedRequestDetected = plas::core::RegisterField<DeviceStatus, 3, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using AuxPowerDetected = plas::core::RegisterField<DeviceStatus, 4, 1, plas::core::FieldAccess::kRO, bool>;
+    using TransactionsPending = plas::core::RegisterField<DeviceStatus, 5, 1, plas::core::FieldAccess::kRO, bool>;
+};
+
+/// Link Capabilities Register (offset 0x0C, 32 bits)
+struct LinkCapabilities : plas::core::Register<uint32_t, 0x0C> {
+    /// Index into the Supported Link Speeds Vector
+    using MaxLinkSpeed = plas::core::RegisterField<LinkCapabilities, 0, 4, plas::core::FieldAccess::kRO, uint8_t>;
+    using MaximumLinkWidth = plas::core::RegisterField<LinkCapabilities, 4, 6, plas::core::FieldAccess::kRO, uint8_t>;
+    using AspmSupport = plas::core::RegisterField<LinkCapabilities, 10, 2, plas::core::FieldAccess::kRO, uint8_t>;
+    using ClockPowerManagement = plas::core::RegisterField<LinkCapabilities, 18, 1, plas::core::FieldAccess::kRO, bool>;
+    using SurpriseDownErrorReportingCapable = plas::core::RegisterField<LinkCapabilities, 19, 1, plas::core::FieldAccess::kRO, bool>;
+    using DataLinkLayerLinkActiveReportingCapable = plas::core::RegisterField<LinkCapabilities, 20, 1, plas::core::FieldAccess::kRO, bool>;
+    using LinkBandwidthNotificationCapability = plas::core::RegisterField<LinkCapabilities, 21, 1, plas::core::FieldAccess::kRO, bool>;
+    using PortNumber = plas::core::RegisterField<LinkCapabilities, 24, 8, plas::core::FieldAccess::kRO, uint8_t>;
+};
+
+/// Link Control Register (offset 0x10, 16 bits)
+struct LinkControl : plas::core::Register<uint16_t, 0x10> {
+    using AspmControl = plas::core::RegisterField<LinkControl, 0, 2, plas::core::FieldAccess::kRW, uint8_t>;
+    using ReadCompletionBoundary = plas::core::RegisterField<LinkControl, 3, 1, plas::core::FieldAccess::kRW, bool>;
+    using LinkDisable = plas::core::RegisterField<LinkControl, 4, 1, plas::core::FieldAccess::kRW, bool>;
+    /// Always reads 0
+    using RetrainLink = plas::core::RegisterField<LinkControl, 5, 1, plas::core::FieldAccess::kRW, bool>;
+    using CommonClockConfiguration = plas::core::RegisterField<LinkControl, 6, 1, plas::core::FieldAccess::kRW, bool>;
+    using ExtendedSynch = plas::core::RegisterField<LinkControl, 7, 1, plas::core::FieldAccess::kRW, bool>;
+    using EnableClockPowerManagement = plas::core::RegisterField<LinkControl, 8, 1, plas::core::FieldAccess::kRW, bool>;
+    using HardwareAutonomousWidthDisable = plas::core::RegisterField<LinkControl, 9, 1, plas::core::FieldAccess::kRW, bool>;
+    using LinkBandwidthManagementInterruptEnable = plas::core::RegisterField<LinkControl, 10, 1, plas::core::FieldAccess::kRW, bool>;
+    using LinkAutonomousBandwidthInterruptEnable = plas::core::RegisterField<LinkControl, 11, 1, plas::core::FieldAccess::kRW, bool>;
+};
+
+/// Link Status Register (offset 0x12, 16 bits)
+struct LinkStatus : plas::core::Register<uint16_t, 0x12, 0xC000> {
+    using CurrentLinkSpeed = plas::core::RegisterField<LinkStatus, 0, 4, plas::core::FieldAccess::kRO, uint8_t>;
+    using NegotiatedLinkWidth = plas::core::RegisterField<LinkStatus, 4, 6, plas::core::FieldAccess::kRO, uint8_t>;
+    using LinkTraining = plas::core::RegisterField<LinkStatus, 11, 1, plas::core::FieldAccess::kRO, bool>;
+    using SlotClockConfiguration = plas::core::RegisterField<LinkStatus, 12, 1, plas::core::FieldAccess::kRO, bool>;
+    using DataLinkLayerLinkActive = plas::core::RegisterField<LinkStatus, 13, 1, plas::core::FieldAccess::kRO, bool>;
+    using LinkBandwidthManagementStatus = plas::core::RegisterField<LinkStatus, 14, 1, plas::core::FieldAccess::kRW1C, bool>;
+    using LinkAutonomousBandwidthStatus = plas::core::RegisterField<LinkStatus, 15, 1, plas::core::FieldAccess::kRW1C, bool>;
+};
+
+/// Link Capabilities 2 Register (capability version 2 and later) (offset 0x2C, 32 bits)
+struct LinkCapabilities2 : plas::core::Register<uint32_t, 0x2C> {
+    /// Bit n-1 set: speed n (2.5 GT/s = 1) supported
+    using SupportedLinkSpeedsVector = plas::core::RegisterField<LinkCapabilities2, 1, 7, plas::core::FieldAccess::kRO, uint8_t>;
+    using CrosslinkSupported = plas::core::RegisterField<LinkCapabilities2, 8, 1, plas::core::FieldAccess::kRO, bool>;
+};
+
+/// Link Control 2 Register (offset 0x30, 16 bits)
+struct LinkControl2 : plas::core::Register<uint16_t, 0x30> {
+    using TargetLinkSpeed = plas::core::RegisterField<LinkControl2, 0, 4, plas::core::FieldAccess::kRW, uint8_t>;
+    using EnterCompliance = plas::core::RegisterField<LinkControl2, 4, 1, plas::core::FieldAccess::kRW, bool>;
+    using HardwareAutonomousSpeedDisable = plas::core::RegisterField<LinkControl2, 5, 1, plas::core::FieldAccess::kRW, bool>;
+    using SelectableDeEmphasis = plas::core::RegisterField<LinkControl2, 6, 1, plas::core::FieldAccess::kRW, bool>;
+    using TransmitMargin = plas::core::RegisterField<LinkControl2, 7, 3, plas::core::FieldAccess::kRW, uint8_t>;
+    using EnterModifiedCompliance = plas::core::RegisterField<LinkControl2, 10, 1, plas::core::FieldAccess::kRW, bool>;
+    using ComplianceSos = plas::core::RegisterField<LinkControl2, 11, 1, plas::core::FieldAccess::kRW, bool>;
+    using CompliancePresetDeEmphasis = plas::core::RegisterField<LinkControl2, 12, 4, plas::core::FieldAccess::kRW, uint8_t>;
+};
+
+/// Link Status 2 Register (offset 0x32, 16 bits)
+struct LinkStatus2 : plas::core::Register<uint16_t, 0x32, 0x20> {
+    using CurrentDeEmphasisLevel = plas::core::RegisterField<LinkStatus2, 0, 1, plas::core::FieldAccess::kRO, bool>;
+    using EqualizationComplete = plas::core::RegisterField<LinkStatus2, 1, 1, plas::core::FieldAccess::kRO, bool>;
+    using LinkEqualizationRequest = plas::core::RegisterField<LinkStatus2, 5, 1, plas::core::FieldAccess::kRW1C, bool>;
+};
+
+}  // namespace plas::hal::pci::regs::pcie
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::pci {
+
+class PciDoe;
+
+/// SPDM requester over DOE CMA (DMTF DSP0274 1.0-1.2, PCIe CMA).
+namespace spdm {
+
+/// DOE protocol carrying SPDM messages.
+inline constexpr DoeProtocolId kCmaProtocol{doe_vendor::kPciSig,
+                                            doe_type::kCma};
+
+/// Largest SPDM message the engine sends or accepts, in bytes.
+inline constexpr std::size_t kMaxMessageSize = 0x10000;
+
+/// GET_MEASUREMENTS operation selecting every measurement block.
+inline constexpr uint8_t kAllMeasurements = 0xFF;
+
+enum class RequestCode : uint8_t {
+    kGetDigests = 0x81,
+    kGetCertificate = 0x82,
+    kGetVersion = 0x84,
+    kGetMeasurements = 0xE0,
+    kGetCapabilities = 0xE1,
+    kNegotiateAlgorithms = 0xE3,
+    kRespondIfReady = 0xFF,
+};
+
+enum class ResponseCode : uint8_t {
+    kDigests = 0x01,
+    kCertificate = 0x02,
+    kVersion = 0x04,
+    kMeasurements = 0x60,
+    kCapabilities = 0x61,
+    kAlgorithms = 0x63,
+    kError = 0x7F,
+};
+
+/// ERROR response codes (Param1).
+enum class SpdmError : uint8_t {
+    kNone = 0x00,
+    kInvalidRequest = 0x01,
+    kBusy = 0x03,
+    kUnexpectedRequest = 0x04,
+    kUnspecified = 0x05,
+    kUnsupportedRequest = 0x07,
+    kVersionMismatch = 0x41,
+    kResponseNotReady = 0x42,
+    kRequestResynch = 0x43,
+};
+
+/// Responder CAPABILITIES flags used by the engine.
+namespace cap_flag {
+constexpr uint32_t kCert = 1u << 1;
+constexpr uint32_t kChal = 1u << 2;
+constexpr uint32_t kMeasNoSig = 1u << 3;  ///< MEAS_CAP = 01b
+constexpr uint32_t kMeasSig = 1u << 4;    ///< MEAS_CAP = 10b
+}  // namespace cap_flag
+
+/// BaseHashAlgo bits.
+namespace hash_algo {
+constexpr uint32_t kSha256 = 1u << 0;
+constexpr uint32_t kSha384 = 1u << 1;
+constexpr uint32_t kSha512 = 1u << 2;
+}  // namespace hash_algo
+
+/// Digest size for one BaseHashAlgo bit; 0 if unknown.
+std::size_t HashSize(uint32_t base_hash_algo);
+
+/// Signature size for one BaseAsymAlgo bit; 0 if unknown.
+std::size_t SignatureSize(uint32_t base_asym_algo);
+
+struct Capabilities {
+    uint8_t ct_exponent = 0;
+    uint32_t flags = 0;
+    uint32_t data_transfer_size = 0;  ///< 1.2+, else 0
+    uint32_t max_message_size = 0;    ///< 1.2+, else 0
+};
+
+struct Algorithms {
+    uint8_t measurement_spec = 0;
+    uint32_t measurement_hash = 0;
+    uint32_t base_asym = 0;
+    uint32_t base_hash = 0;
+};
+
+/// State negotiated by GET_VERSION / GET_CAPABILITIES /
+/// NEGOTIATE_ALGORITHMS; cached per device.
+struct Connection {
+    uint8_t version = 0;  ///< e.g. 0x12 for SPDM 1.2
+    Capabilities capabilities;
+    Algorithms algorithms;
+};
+
+struct CertificateChain {
+    uint8_t slot = 0;
+    std::vector<uint8_t> digest;  ///< as reported by DIGESTS
+    std::vector<uint8_t> chain;   ///< SPDM certificate chain format
+};
+
+struct MeasurementBlock {
+    uint8_t index = 0;
+    uint8_t spec = 0;           ///< MeasurementSpecification
+    std::vector<uint8_t> data;  ///< Measurement field
+};
+
+struct Measurements {
+    uint8_t total_indices = 0;  ///< for operation 0 (count only)
+    std::vector<MeasurementBlock> blocks;
+    std::vector<uint8_t> nonce;      ///< responder nonce (1.1+ or signed)
+    std::vector<uint8_t> opaque;
+    std::vector<uint8_t> signature;  ///< when signed measurements requested
+    /// GET_MEASUREMENTS request + MEASUREMENTS response without the
+    /// signature: the L1/L2 message the signature covers. Signed only.
+    std::vector<uint8_t> transcript;
+};
+
+struct Attestation {
+    Connection connection;
+    std::optional<CertificateChain> certificate;
+    Measurements measurements;
+    bool reused_connection = false;   ///< handshake skipped (cached)
+    bool reused_certificate = false;  ///< DIGESTS matched the cached chain
+};
+
+struct EngineOptions {
+    /// Highest SPDM version offered; the highest common one is used.
+    uint8_t max_version = 0x12;
+    bool fetch_certificate = true;  ///< if the responder has CERT_CAP
+    uint8_t cert_slot = 0;
+    /// Ask for signed measurements with a fresh nonce. kNotSupported if the
+    /// responder cannot sign. The signature is returned, not verified.
+    bool signed_measurements = false;
+    uint8_t measurement_operation = kAllMeasurements;
+    /// Longest one request may take across Busy / ResponseNotReady retries.
+    std::chrono::milliseconds retry_timeout{1000};
+    std::chrono::microseconds backoff{100};  ///< first Busy backoff
+    /// AttestAll targets in flight, on core::Executor::Shared() and the
+    /// calling thread; 0 = as many as the executor runs.
+    std::size_t max_parallel = 0;
+};
+
+/// One SPDM responder: a DOE mailbox carrying CMA.
+struct Target {
+    PciDoe* doe;
+    Bdf bdf;
+    ConfigOffset doe_offset;
+};
+
+/// SPDM requester that attests devices concurrently and remembers each
+/// responder's negotiated connection and certificate chain.
+///
+/// A first Attest() runs GET_VERSION, GET_CAPABILITIES and
+/// NEGOTIATE_ALGORITHMS, GET_DIGESTS and GET_CERTIFICATE, then
+/// GET_MEASUREMENTS. Later calls for the same target go straight to
+/// GET_DIGESTS (the chain is re-read only if its digest changed) and
+/// GET_MEASUREMENTS. A responder that has lost the connection (reset)
+/// answers UnexpectedRequest / RequestResynch, after which the handshake
+/// is redone once. The cache is dropped on a PciTopology generation change.
+///
+/// Busy is retried with exponential backoff and ResponseNotReady with
+/// RESPOND_IF_READY, both within options.retry_timeout. Other ERROR
+/// responses map to kNotSupported (UnsupportedRequest, VersionMismatch)
+/// or kIOError; malformed responses are kIOError.
+///
+/// Thread-safe. Attest() calls for the same target are serialized; calls
+/// for different targets run in parallel, each on its own DOE mailbox.
+class Engine {
+public:
+    explicit Engine(EngineOptions options = {});
+    ~Engine();
+
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+
+    core::Result<Attestation> Attest(const Target& target);
+
+    /// Attest every target on the shared executor (options.max_parallel).
+    /// Results are in target order; one failure does not stop the others.
+    std::vector<core::Result<Attestation>> AttestAll(
+        const std::vector<Target>& targets);
+
+    std::optional<Connection> CachedConnection(const Target& target) const;
+
+    /// Drop what is cached for `target` (e.g. after a device reset).
+    void Forget(const Target& target);
+    void Clear();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace spdm
+}  // namespace plas::hal::pci
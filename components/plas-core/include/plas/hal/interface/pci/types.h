@@ -1,14 +1,74 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <map>
+#include <optional>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "plas/core/buffer_pool.h"
 #include "plas/core/result.h"
 #include "plas/core/types.h"
 
 namespace plas::hal::pci {
 
+namespace detail {
+
+constexpr int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/// Parse `count` hex fields from `text`, field i ending at `delims[i]` (0
+/// for the end of the text) and bounded by `max[i]`. Fields may have any
+/// number of digits. kInvalidArgument if a field is empty, has a non-hex
+/// character or a delimiter is missing; otherwise kOutOfRange if a field
+/// exceeds its bound.
+constexpr core::ErrorCode ParseHexFields(std::string_view text, const char* delims,
+                                         const uint32_t* max, uint32_t* values,
+                                         std::size_t count) {
+    auto status = core::ErrorCode::kSuccess;
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::size_t start = pos;
+        uint32_t value = 0;
+        for (; pos < text.size() && text[pos] != delims[i]; ++pos) {
+            int digit = HexValue(text[pos]);
+            if (digit < 0) {
+                return core::ErrorCode::kInvalidArgument;
+            }
+            value = value * 16 + static_cast<uint32_t>(digit);
+            if (value > max[i]) {
+                value = max[i] + 1;  // stay bounded however long the field is
+                status = core::ErrorCode::kOutOfRange;
+            }
+        }
+        if (pos == start || (delims[i] != 0 && pos == text.size())) {
+            return core::ErrorCode::kInvalidArgument;
+        }
+        if (delims[i] != 0) ++pos;
+        values[i] = value;
+    }
+    return status;
+}
+
+/// Write `value` as `digits` lowercase hex digits; returns the end.
+constexpr char* WriteHex(char* out, uint32_t value, int digits) {
+    constexpr char kDigits[] = "0123456789abcdef";
+    for (int i = digits - 1; i >= 0; --i) {
+        out[i] = kDigits[value & 0xF];
+        value >>= 4;
+    }
+    return out + digits;
+}
+
+}  // namespace detail
+
 /// PCI Bus-Device-Function address.
 struct Bdf {
     uint8_t bus;       ///< Bus number [7:0]
@@ -29,6 +89,34 @@ struct Bdf {
                    static_cast<uint8_t>(packed & 0x07)};
     }
 
+    /// Characters written by ToChars ("BB:DD.F").
+    static constexpr std::size_t kStringLength = 7;
+
+    /// Format as "BB:DD.F" into `out` (at least kStringLength chars, not
+    /// NUL-terminated); returns the end of the written text.
+    constexpr char* ToChars(char* out) const {
+        out = detail::WriteHex(out, bus, 2);
+        *out++ = ':';
+        out = detail::WriteHex(out, device & 0x1F, 2);
+        *out++ = '.';
+        return detail::WriteHex(out, function & 0x07, 1);
+    }
+
+    /// Parse "BB:DD.F" (hex, either case) without allocating. kInvalidArgument
+    /// for malformed text, kOutOfRange if a field is too large; `out` is only
+    /// written on success.
+    static constexpr core::ErrorCode Parse(std::string_view text, Bdf& out) {
+        constexpr char kDelims[] = {':', '.', 0};
+        constexpr uint32_t kMax[] = {0xFF, 0x1F, 0x07};
+        uint32_t v[3] = {};
+        auto status = detail::ParseHexFields(text, kDelims, kMax, v, 3);
+        if (status == core::ErrorCode::kSuccess) {
+            out = Bdf{static_cast<uint8_t>(v[0]), static_cast<uint8_t>(v[1]),
+                      static_cast<uint8_t>(v[2])};
+        }
+        return status;
+    }
+
     constexpr bool operator==(const Bdf& other) const {
         return bus == other.bus && device == other.device &&
                function == other.function;
@@ -42,6 +130,12 @@ struct Bdf {
 /// PCI configuration space offset (0x000–0xFFF for extended config).
 using ConfigOffset = uint16_t;
 
+/// Size of the PCIe extended configuration space in bytes.
+constexpr std::size_t kConfigSpaceSize = 4096;
+
+/// Size of the conventional PCI configuration space in bytes.
+constexpr std::size_t kLegacyConfigSpaceSize = 256;
+
 /// Standard PCI capability IDs (Type 0 config space, offset 0x34 chain).
 enum class CapabilityId : uint8_t {
     kPowerManagement = 0x01,
@@ -56,10 +150,40 @@ enum class CapabilityId : uint8_t {
 enum class ExtCapabilityId : uint16_t {
     kAer = 0x0001,
     kSriov = 0x0010,
+    kReadinessTimeReporting = 0x0022,
     kDvsec = 0x0023,
     kDoe = 0x002E,
 };
 
+/// Standard and extended capability layout of one PCI function, parsed from
+/// a single config-space snapshot. Each ID maps to the offsets of all its
+/// instances in chain order (DVSEC and DOE commonly appear more than once).
+struct CapabilityIndex {
+    std::map<uint8_t, std::vector<ConfigOffset>> capabilities;
+    std::map<uint16_t, std::vector<ConfigOffset>> ext_capabilities;
+
+    /// First instance of a standard capability.
+    std::optional<ConfigOffset> Find(CapabilityId id) const;
+
+    /// First instance of an extended capability.
+    std::optional<ConfigOffset> Find(ExtCapabilityId id) const;
+
+    /// All instances of an extended capability (e.g. every DVSEC or DOE).
+    std::vector<ConfigOffset> FindAll(ExtCapabilityId id) const;
+
+    /// Walk both capability chains in `size` bytes of config space starting
+    /// at offset 0. Pointers beyond `size` terminate the walk.
+    static CapabilityIndex Parse(const core::Byte* config, std::size_t size);
+};
+
+/// One config write for PciConfig::WriteConfigBatch and
+/// PciDevice::WriteConfigBatch.
+struct ConfigWrite {
+    ConfigOffset offset = 0;
+    uint8_t width = 4;  ///< 1, 2 or 4 bytes
+    core::DWord value = 0;
+};
+
 /// DOE (Data Object Exchange) protocol identifier.
 struct DoeProtocolId {
     uint16_t vendor_id;
@@ -89,16 +213,46 @@ constexpr uint8_t kCma = 0x01;
 /// DWord-aligned DOE payload.
 using DoePayload = std::vector<core::DWord>;
 
+/// DOE payload in a pooled buffer (see PciDoe::DoeExchangePooled).
+using DoePooledPayload = core::PooledBuffer<core::DWord>;
+
 /// Full PCI address including domain.
 struct PciAddress {
     uint16_t domain;
     Bdf bdf;
 
+    /// Characters written by ToChars ("DDDD:BB:DD.F").
+    static constexpr std::size_t kStringLength = 12;
+
+    /// Format as "DDDD:BB:DD.F" into `out` (at least kStringLength chars,
+    /// not NUL-terminated); returns the end of the written text.
+    constexpr char* ToChars(char* out) const {
+        out = detail::WriteHex(out, domain, 4);
+        *out++ = ':';
+        return bdf.ToChars(out);
+    }
+
+    /// Parse "DDDD:BB:DD.F" (hex, either case, sysfs directory names)
+    /// without allocating. kInvalidArgument for malformed text, kOutOfRange
+    /// if a field is too large; `out` is only written on success.
+    static constexpr core::ErrorCode Parse(std::string_view text, PciAddress& out) {
+        constexpr char kDelims[] = {':', ':', '.', 0};
+        constexpr uint32_t kMax[] = {0xFFFF, 0xFF, 0x1F, 0x07};
+        uint32_t v[4] = {};
+        auto status = detail::ParseHexFields(text, kDelims, kMax, v, 4);
+        if (status == core::ErrorCode::kSuccess) {
+            out = PciAddress{static_cast<uint16_t>(v[0]),
+                             Bdf{static_cast<uint8_t>(v[1]), static_cast<uint8_t>(v[2]),
+                                 static_cast<uint8_t>(v[3])}};
+        }
+        return status;
+    }
+
     /// Format as "DDDD:BB:DD.F".
     std::string ToString() const;
 
-    /// Parse "DDDD:BB:DD.F" string.
-    static core::Result<PciAddress> FromString(const std::string& str);
+    /// Parse "DDDD:BB:DD.F"; Result form of Parse().
+    static core::Result<PciAddress> FromString(std::string_view str);
 
     constexpr bool operator==(const PciAddress& other) const {
         return domain == other.domain && bdf == other.bdf;
@@ -124,3 +278,20 @@ enum class PciePortType : uint8_t {
 };
 
 }  // namespace plas::hal::pci
+
+namespace std {
+
+/// Hashes keyed on the packed encoding, for unordered containers.
+template <>
+struct hash<plas::hal::pci::Bdf> {
+    size_t operator()(const plas::hal::pci::Bdf& bdf) const noexcept { return bdf.Pack(); }
+};
+
+template <>
+struct hash<plas::hal::pci::PciAddress> {
+    size_t operator()(const plas::hal::pci::PciAddress& addr) const noexcept {
+        return (static_cast<size_t>(addr.domain) << 16) | addr.bdf.Pack();
+    }
+};
+
+}  // namespace std
@@ -2,8 +2,10 @@
 
 #include <string>
 
+#include "plas/core/error.h"
 #include "plas/core/result.h"
 #include "plas/core/units.h"
+#include "plas/hal/interface/power_stream.h"
 
 namespace plas::hal {
 
@@ -23,6 +25,21 @@ public:
     virtual core::Result<void> PowerOn() = 0;
     virtual core::Result<void> PowerOff() = 0;
     virtual core::Result<bool> IsPowerOn() = 0;
+
+    /// Stream voltage/current at `options.rate_hz` into `ring` until
+    /// StopSampling(). Backends move whole blocks per device transfer (see
+    /// PowerCapture) instead of one GetVoltage()/GetCurrent() per sample.
+    /// kAlreadyOpen while sampling; kNotSupported by default.
+    virtual core::Result<void> StartSampling(const PowerSamplingOptions& options,
+                                             PowerSampleRing& ring) {
+        (void)options;
+        (void)ring;
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    /// End the stream; returns the error that stopped it early, if any.
+    virtual core::Result<void> StopSampling() { return core::Result<void>::Ok(); }
+    virtual bool IsSampling() const { return false; }
 };
 
 }  // namespace plas::hal
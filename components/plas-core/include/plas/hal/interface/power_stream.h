@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "plas/core/result.h"
+#include "plas/core/spsc_ring.h"
+#include "plas/core/units.h"
+
+namespace plas::hal {
+
+/// One point of a PowerControl sampling stream.
+struct PowerSample {
+    /// steady_clock at StartSampling() plus sample index / rate: the
+    /// instrument's sample clock, not the time the block reached the host.
+    uint64_t timestamp_ns = 0;
+    core::Voltage voltage{0.0};
+    core::Current current{0.0};
+};
+
+struct PowerSamplingOptions {
+    uint32_t rate_hz = 1000;
+    std::size_t block_samples = 64;  ///< samples moved per device transfer
+    /// Called on the capture thread after each block is pushed, with the
+    /// number of samples pushed (e.g. to wake a consumer). Optional.
+    std::function<void(std::size_t)> on_block;
+};
+
+/// Caller-owned ring the capture thread pushes samples into; one consumer
+/// pops them. Full ring: newest samples are dropped and counted.
+using PowerSampleRing = core::SpscRing<PowerSample>;
+
+/// Capture thread shared by PowerControl backends. The backend arms its
+/// instrument's continuous capture, then hands Start() a reader that blocks
+/// until the next block of samples is available and fills in voltage and
+/// current; PowerCapture stamps the samples and pushes them to the ring.
+/// One device transfer therefore moves a whole block, never one sample.
+class PowerCapture {
+public:
+    /// Fill up to `max` samples (voltage/current only) and return how many.
+    /// Should return within about one block period so Stop() is prompt;
+    /// an error ends the capture.
+    using BlockReader =
+        std::function<core::Result<std::size_t>(PowerSample* out, std::size_t max)>;
+
+    PowerCapture();
+    ~PowerCapture();  // Stop()
+
+    PowerCapture(const PowerCapture&) = delete;
+    PowerCapture& operator=(const PowerCapture&) = delete;
+
+    /// kInvalidArgument for a zero rate or block size, or a ring smaller
+    /// than one block.
+    static core::Result<void> Validate(const PowerSamplingOptions& options,
+                                       const PowerSampleRing& ring);
+
+    /// Start the capture thread. kAlreadyOpen if running, otherwise the
+    /// errors of Validate(). `ring` must outlive the capture.
+    core::Result<void> Start(PowerSamplingOptions options, PowerSampleRing& ring,
+                             BlockReader reader);
+
+    /// Stop and join the thread. Returns the reader's error if the capture
+    /// ended on one. A no-op when not started.
+    core::Result<void> Stop();
+
+    /// True from Start() until Stop(), even if the reader failed.
+    bool IsRunning() const;
+
+    /// Samples read since Start(), including any the ring dropped.
+    uint64_t SampleCount() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <string>
 
+#include "plas/core/byte_buffer.h"
+#include "plas/core/error.h"
 #include "plas/core/result.h"
 #include "plas/core/types.h"
 
@@ -24,6 +28,40 @@ public:
     virtual core::Result<void> SetBaudRate(uint32_t baud_rate) = 0;
     virtual uint32_t GetBaudRate() const = 0;
     virtual core::Result<void> Flush() = 0;
+
+    /// Read with an explicit wait: returns as soon as any byte is buffered,
+    /// kTimeout if none arrived within `timeout`. Backends without an RX
+    /// buffer keep the default (kNotSupported).
+    virtual core::Result<size_t> ReadFor(core::Byte* data, size_t length,
+                                         std::chrono::milliseconds timeout) {
+        (void)data;
+        (void)length;
+        (void)timeout;
+        return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    /// Bytes already received and waiting for Read(); 0 if unknown.
+    virtual size_t Available() const { return 0; }
+
+    /// Invoke `callback` from the backend's I/O thread whenever new bytes
+    /// are buffered (empty clears it). The callback must not block.
+    virtual core::Result<void> SetReadyCallback(std::function<void()> callback) {
+        (void)callback;
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    /// Append up to `length` received bytes to `out`, without zero-filling;
+    /// `out` keeps only the bytes actually read.
+    core::Result<size_t> ReadBytes(core::ByteBuffer& out, size_t length) {
+        size_t base = out.Size();
+        auto result = Read(out.AppendUninitialized(length), length);
+        out.Resize(base + (result.IsOk() ? result.Value() : 0));
+        return result;
+    }
+
+    core::Result<size_t> WriteBytes(core::ByteView data) {
+        return Write(data.Data(), data.Size());
+    }
 };
 
 }  // namespace plas::hal
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+#include "plas/hal/interface/serial.h"
+#include "plas/hal/interface/uart.h"
+
+namespace plas::hal {
+
+/// Aho-Corasick automaton over a fixed set of byte patterns, built once
+/// as a dense DFA (256 transitions per state) so scanning is one table
+/// lookup per input byte regardless of how many patterns there are.
+class LinePatternMatcher {
+public:
+    LinePatternMatcher() = default;
+    explicit LinePatternMatcher(const std::vector<std::string>& patterns);
+
+    /// Indices (into the constructor's list, ascending, no duplicates) of
+    /// every pattern occurring in `text`. Returns hits.size().
+    size_t Match(std::string_view text, std::vector<uint32_t>& hits) const;
+
+    size_t PatternCount() const { return pattern_count_; }
+    size_t StateCount() const { return fail_.size(); }
+
+private:
+    std::vector<uint32_t> next_;                 // state * 256 + byte -> state
+    std::vector<uint32_t> fail_;
+    std::vector<std::vector<uint32_t>> output_;  // patterns ending here (incl. via fail)
+    size_t pattern_count_ = 0;
+};
+
+/// One received line. `timestamp_ns` is when its first byte was read,
+/// relative to SerialLogCapture::Start().
+struct LogLine {
+    uint64_t sequence = 0;
+    uint64_t timestamp_ns = 0;
+    std::string text;                ///< without the trailing "\n" / "\r\n"
+    std::vector<uint32_t> triggers;  ///< matched SerialLogCaptureOptions::triggers
+    bool truncated = false;          ///< cut at max_line_length
+};
+
+struct SerialLogCaptureOptions {
+    /// Markers such as "PANIC" or "READY"; matched anywhere in a line.
+    std::vector<std::string> triggers;
+    /// Called for lines with at least one trigger, on the matcher thread.
+    std::function<void(const LogLine&)> on_trigger;
+    /// Called for every line, on the matcher thread. Optional.
+    std::function<void(const LogLine&)> on_line;
+
+    /// Rotating log file; empty = no file. Rotation renames `path` to
+    /// `path.1`, `path.1` to `path.2`, ... keeping `max_files` in total.
+    std::string file_path;
+    size_t max_file_bytes = 64 * 1024 * 1024;
+    size_t max_files = 4;
+
+    size_t ring_bytes = 1024 * 1024;  ///< receive -> matcher buffer
+    size_t max_line_length = 4096;
+    std::chrono::milliseconds read_timeout{50};  ///< per ReadFor() call
+};
+
+struct SerialLogCaptureStats {
+    uint64_t bytes_received = 0;
+    uint64_t bytes_dropped = 0;   ///< lost because the matcher fell behind
+    uint64_t lines = 0;
+    uint64_t truncated_lines = 0;
+    uint64_t trigger_lines = 0;
+    uint64_t read_errors = 0;     ///< failed reads other than kTimeout
+};
+
+/// Boot-log capture on a Serial or Uart. A receive thread does nothing but
+/// bulk reads (ReadFor() when the backend buffers, else Read()) into a
+/// ring of timestamped chunks; a matcher thread splits the chunks into
+/// lines, runs every trigger over each line in one pass, and appends
+/// "[seconds] line" records to the rotating file. A slow callback or disk
+/// therefore backs up the ring, never the UART.
+///
+/// The interface must outlive the capture.
+class SerialLogCapture {
+public:
+    SerialLogCapture();
+    ~SerialLogCapture();  // Stop()
+
+    SerialLogCapture(const SerialLogCapture&) = delete;
+    SerialLogCapture& operator=(const SerialLogCapture&) = delete;
+
+    /// kInvalidArgument for an empty trigger, a zero ring, line length,
+    /// file size or file count.
+    static core::Result<void> Validate(const SerialLogCaptureOptions& options);
+
+    /// kAlreadyOpen if running, the errors of Validate(), kIOError if the
+    /// log file cannot be opened.
+    core::Result<void> Start(Serial& serial, SerialLogCaptureOptions options);
+    core::Result<void> Start(Uart& uart, SerialLogCaptureOptions options);
+
+    /// Stop reading, process what is buffered (a trailing partial line is
+    /// emitted as a line) and close the file. kIOError if a file write failed.
+    core::Result<void> Stop();
+
+    bool IsRunning() const;
+    SerialLogCaptureStats Stats() const;
+    /// Lines that matched trigger `index` since Start().
+    uint64_t TriggerCount(size_t index) const;
+
+    /// Next '\n' in [begin, end), or end. SSE2 on x86-64, memchr elsewhere.
+    static const core::Byte* FindNewline(const core::Byte* begin, const core::Byte* end);
+
+private:
+    using Reader = std::function<core::Result<size_t>(core::Byte*, size_t,
+                                                      std::chrono::milliseconds)>;
+    core::Result<void> StartWith(Reader reader, SerialLogCaptureOptions options);
+
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+#include "plas/hal/interface/i2c.h"
+
+namespace plas::hal {
+
+class Device;  // forward declaration
+
+/// SMBus Packet Error Code: CRC-8 (x^8 + x^2 + x + 1, init 0) over `data`,
+/// continuing from `crc`. Table-driven, one lookup per byte.
+uint8_t SmBusPec(const core::Byte* data, size_t length, uint8_t crc = 0);
+
+/// SMBus protocol operations (SMBus 3.x).
+///
+/// Backends implement one primitive, Transact(): a command write followed
+/// by a repeated START read, where a block read is sized by the target's
+/// byte count within the same transaction. Adapters with a sized-read
+/// primitive (Aardvark) or a receive FIFO (FT4222H) read the count and the
+/// block in one go instead of reading the count first and then re-issuing
+/// the command for the data. The protocol calls below are built on it and
+/// add and check PEC.
+class SmBus {
+public:
+    /// Longest block (SMBus 3.x); SMBus 2.0 targets stop at 32.
+    static constexpr size_t kMaxBlock = 255;
+
+    virtual ~SmBus() = default;
+
+    virtual std::string InterfaceName() const { return "SmBus"; }
+    virtual Device* GetDevice() = 0;
+
+    /// Write `write_len` bytes (command code first) to `addr`, then, if
+    /// `read_len` > 0, a repeated START and a read into `read`; STOP
+    /// either way. With `block`, the first byte read is a byte count N and
+    /// the read ends after N more bytes, plus one if `pec`; `read_len` is
+    /// then the capacity. Returns the bytes read, the count byte included.
+    /// kOverflow if the block does not fit in `read_len`, kInvalidArgument
+    /// for an empty write.
+    virtual core::Result<size_t> Transact(core::Address addr, const core::Byte* write,
+                                          size_t write_len, core::Byte* read, size_t read_len,
+                                          bool block, bool pec) = 0;
+
+    // -- Protocol ---------------------------------------------------------
+    //
+    // With `pec` a PEC byte is appended to every write and expected after
+    // every read; a read whose PEC does not match fails with kDataLoss.
+
+    core::Result<uint8_t> ReadByteData(core::Address addr, uint8_t command, bool pec = false);
+    core::Result<void> WriteByteData(core::Address addr, uint8_t command, uint8_t value,
+                                     bool pec = false);
+    /// Words are little-endian on the bus.
+    core::Result<uint16_t> ReadWordData(core::Address addr, uint8_t command, bool pec = false);
+    core::Result<void> WriteWordData(core::Address addr, uint8_t command, uint16_t value,
+                                     bool pec = false);
+    core::Result<uint16_t> ProcessCall(core::Address addr, uint8_t command, uint16_t value,
+                                       bool pec = false);
+
+    /// Read a block into `data`; returns its length. kOverflow if the
+    /// target sends more than `capacity` bytes.
+    core::Result<size_t> BlockRead(core::Address addr, uint8_t command, core::Byte* data,
+                                   size_t capacity, bool pec = false);
+    /// kInvalidArgument for more than kMaxBlock bytes.
+    core::Result<void> BlockWrite(core::Address addr, uint8_t command, const core::Byte* data,
+                                  size_t length, bool pec = false);
+    /// Block write, then block read in the same transaction.
+    core::Result<size_t> BlockProcessCall(core::Address addr, uint8_t command,
+                                          const core::Byte* write, size_t write_len,
+                                          core::Byte* read, size_t capacity, bool pec = false);
+};
+
+/// SmBus on any I2c backend.
+///
+/// Plain I2c has no sized read, so a block read takes 1 + `read_ahead`
+/// bytes (plus PEC) in one WriteRead and repeats the transaction for the
+/// full length only when the byte count says the block is longer. Keep
+/// `read_ahead` at least as long as the blocks a non-idempotent block
+/// process call returns, since the repeat re-sends the write.
+class I2cSmBus : public SmBus {
+public:
+    explicit I2cSmBus(I2c& bus, size_t read_ahead = 32);
+
+    Device* GetDevice() override { return bus_.GetDevice(); }
+
+    core::Result<size_t> Transact(core::Address addr, const core::Byte* write,
+                                  size_t write_len, core::Byte* read, size_t read_len,
+                                  bool block, bool pec) override;
+
+private:
+    I2c& bus_;
+    size_t read_ahead_;
+};
+
+}  // namespace plas::hal
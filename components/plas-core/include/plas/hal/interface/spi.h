@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+#include "plas/core/units.h"
+
+namespace plas::hal {
+
+class Device;  // forward declaration
+
+/// Data lines of an SPI phase: MOSI/MISO, or 2 / 4 bidirectional I/O lines.
+enum class SpiLines : uint8_t {
+    kSingle = 1,
+    kDual = 2,
+    kQuad = 4,
+};
+
+/// Clock polarity and phase: mode 0 = CPOL 0 / CPHA 0 ... mode 3 = 1 / 1.
+enum class SpiMode : uint8_t {
+    kMode0 = 0,
+    kMode1,
+    kMode2,
+    kMode3,
+};
+
+/// A command transaction as SPI-NOR flash uses it, under one chip select:
+/// `opcode`, `address_bytes` of `address` (MSB first) and `dummy_bytes`
+/// on a single line, then `length` data bytes written from `write` or read
+/// into `read` (exactly one of the two, or neither for `length` 0) on
+/// `lines` lines. E.g. Fast Read Quad Output (0x6B) is 3 address bytes,
+/// one dummy byte and a kQuad read.
+struct SpiCommand {
+    uint8_t opcode = 0;
+    uint32_t address = 0;
+    uint8_t address_bytes = 0;  ///< 0, 3 or 4
+    uint8_t dummy_bytes = 0;
+    SpiLines lines = SpiLines::kSingle;
+    const core::Byte* write = nullptr;
+    core::Byte* read = nullptr;
+    size_t length = 0;
+};
+
+/// SPI master on one chip select.
+///
+/// Backends implement Exchange(), a single-line full-duplex transfer that
+/// can leave chip select asserted between calls, and may override
+/// Command() for dual/quad data phases; the default Command() runs
+/// single-line commands through Exchange() and fails others with
+/// kNotSupported.
+class Spi {
+public:
+    virtual ~Spi() = default;
+
+    virtual std::string InterfaceName() const { return "Spi"; }
+    virtual Device* GetDevice() = 0;
+
+    /// Clock out `length` bytes of `write` while clocking in `read`. A null
+    /// `write` clocks out filler bytes, a null `read` discards the input
+    /// (not both).
+    /// With `end` false chip select stays asserted and the next call
+    /// continues the same transaction. Returns the bytes transferred.
+    virtual core::Result<size_t> Exchange(const core::Byte* write, core::Byte* read,
+                                          size_t length, bool end = true) = 0;
+
+    /// Run `command`; returns the data bytes transferred. kInvalidArgument
+    /// for a malformed command (see SpiCommand).
+    virtual core::Result<size_t> Command(const SpiCommand& command);
+
+    /// Set the SPI clock; backends round down to the nearest rate they
+    /// can generate (see GetClock()).
+    virtual core::Result<void> SetClock(core::Frequency freq) = 0;
+    virtual core::Frequency GetClock() const = 0;
+
+    virtual core::Result<void> SetMode(SpiMode mode) = 0;
+};
+
+/// Longest SpiCommand header: opcode, 4 address bytes, 255 dummy bytes.
+inline constexpr size_t kSpiMaxCommandHeader = 1 + 4 + 255;
+
+/// Validate `command` and write its single-line header (opcode, address,
+/// dummy bytes) to `header`, which holds kSpiMaxCommandHeader bytes.
+/// Returns the header length; kInvalidArgument for a malformed command.
+core::Result<size_t> EncodeSpiCommandHeader(const SpiCommand& command,
+                                            core::Byte* header);
+
+}  // namespace plas::hal
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+#include "plas/hal/interface/spi.h"
+
+namespace plas::hal {
+
+/// CRC-32C (Castagnoli, reflected poly 0x82F63B78) of `data`, continuing
+/// from `crc` (0 to start). Uses the SSE4.2 crc32 instruction when the CPU
+/// has it, otherwise a table lookup per byte.
+uint32_t Crc32c(const core::Byte* data, size_t length, uint32_t crc = 0);
+
+/// Layout of a SPI-NOR flash part.
+struct SpiFlashGeometry {
+    std::size_t size = 0;            ///< bytes, a power of two
+    std::size_t page_size = 256;     ///< program page, a power of two
+    std::size_t sector_size = 4096;  ///< smallest erase unit (opcode 0x20)
+    uint8_t address_bytes = 3;       ///< 3, or 4 for parts above 16 MiB
+
+    /// Geometry from a JEDEC ID (manufacturer, memory type, capacity
+    /// bytes, as ReadJedecId() returns it): the capacity byte is log2 of
+    /// the size, or 0x20-0x22 for 64-256 MiB. Parts above 16 MiB use 4
+    /// address bytes, with the 4-byte opcodes, so no address mode switch
+    /// is needed. kNotFound for an unknown capacity or no part (all 0 or
+    /// all 1).
+    static core::Result<SpiFlashGeometry> FromJedecId(uint32_t jedec_id);
+};
+
+struct SpiFlashOptions {
+    /// Data lines for reads: kSingle uses Fast Read (0x0B/0x0C), kQuad
+    /// Fast Read Quad Output (0x6B/0x6C; the part's QE bit must be set).
+    SpiLines read_lines = SpiLines::kSingle;
+    /// Program with Quad Input Page Program (0x32/0x34) instead of 0x02/0x12.
+    bool quad_program = false;
+    /// Bytes per read command; a multiple of the sector size.
+    std::size_t read_chunk = 0x10000;
+    /// Longest page program / sector erase (datasheet tPP / tSE max)
+    /// before status polling gives up with kTimeout.
+    std::chrono::milliseconds program_timeout{5};
+    std::chrono::milliseconds erase_timeout{500};
+    /// Pause between status polls; 0 polls back to back (one bus round
+    /// trip apart).
+    std::chrono::microseconds poll_interval{0};
+    /// Program(): read the target first; skip pages that already match and
+    /// erase only sectors where a bit has to go from 0 to 1. Off: erase
+    /// every sector the range touches and program every page.
+    bool skip_unchanged = true;
+    /// Program(): read the range back afterwards and compare CRC-32C per
+    /// read chunk; kDataLoss on a mismatch.
+    bool verify = true;
+    /// Called after each read chunk of Program() with the bytes of the
+    /// range done so far and the total.
+    std::function<void(std::size_t done, std::size_t total)> progress;
+};
+
+struct SpiFlashStats {
+    uint64_t pages_programmed = 0;
+    uint64_t pages_skipped = 0;   ///< already matching (skip_unchanged)
+    uint64_t sectors_erased = 0;
+    uint64_t bytes_read = 0;
+    uint64_t status_polls = 0;    ///< busy status reads while a cycle ran
+    uint32_t crc32c = 0;          ///< Crc32c of the last Program()/Verify() range
+};
+
+/// SPI-NOR programming over Spi.
+///
+/// Program() works through the range one read chunk at a time: it reads
+/// the chunk's sectors in one command, merges the image in, then per
+/// sector either skips it, erases it when some bit must go from 0 to 1, or
+/// programs only the pages that differ. Each page program returns as soon
+/// as the command is sent; the status poll for it waits until the next
+/// page to program has been found and compared, so that work overlaps the
+/// program cycle instead of following it. Verification reads the range
+/// back and checks the CRC-32C of each chunk as it arrives.
+///
+/// Not thread-safe; the Spi must outlive the helper.
+class SpiFlash {
+public:
+    SpiFlash(Spi& spi, SpiFlashGeometry geometry, SpiFlashOptions options = {});
+
+    /// Read the 3-byte JEDEC ID (0x9F): manufacturer << 16 | type << 8 |
+    /// capacity.
+    static core::Result<uint32_t> ReadJedecId(Spi& spi);
+
+    const SpiFlashGeometry& Geometry() const { return geometry_; }
+
+    /// kOutOfRange past the end of the part, kInvalidArgument for a null
+    /// buffer or a bad geometry, otherwise the bus error.
+    core::Result<void> Read(std::size_t offset, core::Byte* data, std::size_t length);
+    /// Program [offset, offset + length) to `data`, keeping the rest of
+    /// every sector it erases.
+    core::Result<void> Program(std::size_t offset, const core::Byte* data, std::size_t length);
+    /// Program() an image file at `offset`. The file is mapped, not
+    /// copied; kNotFound / kPermissionDenied if it cannot be opened,
+    /// kInvalidArgument if it is empty.
+    core::Result<void> ProgramFile(const std::string& path, std::size_t offset = 0);
+
+    /// Read [offset, offset + length) back and compare CRC-32C per read
+    /// chunk; kDataLoss on a mismatch.
+    core::Result<void> Verify(std::size_t offset, const core::Byte* data, std::size_t length);
+
+    /// Erase the sector holding `offset`.
+    core::Result<void> EraseSector(std::size_t offset);
+
+    /// Poll the status register until the write-in-progress bit clears;
+    /// kTimeout after `timeout` or at the current core::Deadline.
+    core::Result<void> WaitReady(std::chrono::milliseconds timeout);
+
+    SpiFlashStats Stats() const { return stats_; }
+    void ResetStats() { stats_ = {}; }
+
+private:
+    bool ValidGeometry() const;
+    core::Result<void> CheckRange(std::size_t offset, const void* data,
+                                  std::size_t length) const;
+    SpiCommand MakeCommand(uint8_t opcode3, uint8_t opcode4, std::size_t offset) const;
+    core::Result<void> WriteEnable();
+    core::Result<void> ProgramPage(std::size_t offset, const core::Byte* data);
+    /// Bring the sector at `sector` from `current` to `wanted`; a null
+    /// `current` (contents not read) always erases.
+    core::Result<void> UpdateSector(std::size_t sector, const core::Byte* current,
+                                    const core::Byte* wanted);
+    core::Result<void> Finish();
+
+    Spi& spi_;
+    SpiFlashGeometry geometry_;
+    SpiFlashOptions options_;
+    SpiFlashStats stats_;
+    bool program_pending_ = false;  ///< a page program may still be running
+    std::vector<core::Byte> current_;  ///< Program(): chunk as read
+    std::vector<core::Byte> wanted_;   ///< Program(): chunk with the image merged in
+};
+
+}  // namespace plas::hal
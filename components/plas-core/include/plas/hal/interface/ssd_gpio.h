@@ -1,13 +1,65 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <string>
 
+#include "plas/core/error.h"
 #include "plas/core/result.h"
+#include "plas/core/spsc_ring.h"
 
 namespace plas::hal {
 
 class Device;  // forward declaration
 
+/// All sideband signals of a slot at once. A set bit means the signal is
+/// active (for PERST#: reset asserted).
+struct SsdPinState {
+    static constexpr uint8_t kPerst = 0x01;
+    static constexpr uint8_t kClkReq = 0x02;
+    static constexpr uint8_t kDualPort = 0x04;
+    static constexpr uint8_t kAll = kPerst | kClkReq | kDualPort;
+
+    uint8_t values = 0;
+
+    bool Perst() const { return (values & kPerst) != 0; }
+    bool ClkReq() const { return (values & kClkReq) != 0; }
+    bool DualPort() const { return (values & kDualPort) != 0; }
+};
+
+/// Clock an SsdPinEvent timestamp comes from.
+enum class SsdEventClock : uint8_t {
+    kHardware,  ///< the PMU's capture timer, converted to ns
+    kHost,      ///< steady_clock when a poll saw the change
+};
+
+/// One edge on a sideband signal.
+struct SsdPinEvent {
+    uint64_t timestamp_ns = 0;
+    /// The edge happened within [timestamp_ns - window_ns, timestamp_ns]:
+    /// 0 for hardware capture, the time since the previous poll otherwise.
+    uint64_t window_ns = 0;
+    uint8_t pin = 0;        ///< the SsdPinState bit that changed
+    bool level = false;     ///< new level (true = active)
+    SsdPinState state;      ///< every pin after the edge
+    SsdEventClock clock = SsdEventClock::kHardware;
+};
+
+using SsdPinEventQueue = core::SpscRing<SsdPinEvent>;
+
+struct SsdPinEventOptions {
+    uint8_t pins = SsdPinState::kAll;  ///< signals to watch
+    /// Delivery: called on the capture thread, and/or pushed to `queue`
+    /// (caller-owned, one consumer). At least one is required.
+    std::function<void(const SsdPinEvent&)> callback;
+    SsdPinEventQueue* queue = nullptr;
+
+    // Polling fallback (SsdPinEventCapture) only.
+    std::chrono::microseconds poll_interval{50};
+    int realtime_priority = 0;  ///< SCHED_FIFO priority; 0 = normal thread
+};
+
 class SsdGpio {
 public:
     virtual ~SsdGpio() = default;
@@ -23,6 +75,66 @@ public:
 
     virtual core::Result<void> SetDualPort(bool enable) = 0;
     virtual core::Result<bool> GetDualPort() = 0;
+
+    /// Read every signal. Backends override this to sample all pins in one
+    /// transaction; the default makes one Get* call per pin.
+    virtual core::Result<SsdPinState> GetPinState() {
+        SsdPinState state;
+        auto perst = GetPerst();
+        if (perst.IsError()) {
+            return core::Result<SsdPinState>::Err(perst.Error());
+        }
+        auto clkreq = GetClkReq();
+        if (clkreq.IsError()) {
+            return core::Result<SsdPinState>::Err(clkreq.Error());
+        }
+        auto dual = GetDualPort();
+        if (dual.IsError()) {
+            return core::Result<SsdPinState>::Err(dual.Error());
+        }
+        state.values = static_cast<uint8_t>(
+            (perst.Value() ? SsdPinState::kPerst : 0) |
+            (clkreq.Value() ? SsdPinState::kClkReq : 0) |
+            (dual.Value() ? SsdPinState::kDualPort : 0));
+        return core::Result<SsdPinState>::Ok(state);
+    }
+
+    /// Drive the signals selected by `mask` to the matching bits of
+    /// `values`; others are left alone. kInvalidArgument for bits outside
+    /// SsdPinState::kAll. Backends override this to change all pins in one
+    /// transaction; the default makes one Set* call per pin in bit order
+    /// and stops at the first failure.
+    virtual core::Result<void> SetPinState(uint8_t mask, uint8_t values) {
+        if ((mask & ~SsdPinState::kAll) != 0) {
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        }
+        if ((mask & SsdPinState::kPerst) != 0) {
+            auto result = SetPerst((values & SsdPinState::kPerst) != 0);
+            if (result.IsError()) {
+                return result;
+            }
+        }
+        if ((mask & SsdPinState::kClkReq) != 0) {
+            auto result = SetClkReq((values & SsdPinState::kClkReq) != 0);
+            if (result.IsError()) {
+                return result;
+            }
+        }
+        if ((mask & SsdPinState::kDualPort) != 0) {
+            return SetDualPort((values & SsdPinState::kDualPort) != 0);
+        }
+        return core::Result<void>::Ok();
+    }
+
+    /// Deliver timestamped edges of `options.pins` from the device's own
+    /// capture hardware until StopPinEvents(). kNotSupported by default;
+    /// SsdPinEventCapture then falls back to polling GetPinState().
+    virtual core::Result<void> StartPinEvents(const SsdPinEventOptions& options) {
+        (void)options;
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    virtual core::Result<void> StopPinEvents() { return core::Result<void>::Ok(); }
+    virtual bool IsCapturingPinEvents() const { return false; }
 };
 
 }  // namespace plas::hal
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/ssd_gpio.h"
+
+namespace plas::hal {
+
+/// Edge-event capture on any SsdGpio. Start() first asks the backend for
+/// hardware capture (SsdGpio::StartPinEvents, hardware timestamps); if the
+/// backend answers kNotSupported it starts a dedicated polling thread that
+/// reads all pins with one GetPinState() per interval and reports edges
+/// with host timestamps and the poll window they fell in.
+///
+/// The SsdGpio must outlive the capture.
+class SsdPinEventCapture {
+public:
+    SsdPinEventCapture();
+    ~SsdPinEventCapture();  // Stop()
+
+    SsdPinEventCapture(const SsdPinEventCapture&) = delete;
+    SsdPinEventCapture& operator=(const SsdPinEventCapture&) = delete;
+
+    /// kInvalidArgument for no pins, pins outside SsdPinState::kAll, no
+    /// callback and no queue, or a zero poll interval.
+    static core::Result<void> Validate(const SsdPinEventOptions& options);
+
+    /// kAlreadyOpen if running, the errors of Validate(), the backend's
+    /// StartPinEvents() error other than kNotSupported, or the error of the
+    /// first GetPinState() (which sets the polling baseline).
+    core::Result<void> Start(SsdGpio& gpio, SsdPinEventOptions options);
+
+    /// Stop capturing. Returns the GetPinState() error that ended polling
+    /// early, or the backend's StopPinEvents() result.
+    core::Result<void> Stop();
+
+    bool IsRunning() const;
+    bool IsPolling() const;   ///< running on the polling fallback
+    bool IsRealtime() const;  ///< the poll thread got its SCHED_FIFO priority
+
+    /// Edges delivered since Start().
+    uint64_t EventCount() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "plas/core/lock_stats.h"
+#include "plas/core/retry.h"
+
+namespace plas::hal {
+
+/// Operation a latency sample belongs to.
+enum class MetricOp : uint8_t {
+    kI2cRead = 0,
+    kI2cWrite,
+    kI2cWriteRead,
+    kPciConfigRead,
+    kPciConfigWrite,
+    kDoeExchange,
+    kBarRead,
+    kBarWrite,
+    kSpiRead,
+    kSpiWrite,
+    kCount,  // number of operations, not an operation
+};
+
+inline constexpr std::size_t kMetricOpCount =
+    static_cast<std::size_t>(MetricOp::kCount);
+
+const char* ToString(MetricOp op);
+
+// ---------------------------------------------------------------------------
+// LatencyHistogram — lock-free, HDR-style buckets
+// ---------------------------------------------------------------------------
+
+/// Log-linear histogram of nanosecond latencies. Values below 8 get their
+/// own bucket; above that every power of two is split into 8 linear
+/// sub-buckets, so any recorded value is reported within 12.5%.
+class LatencyHistogram {
+public:
+    static constexpr std::size_t kSubBucketBits = 3;
+    static constexpr std::size_t kSubBuckets = 1u << kSubBucketBits;
+    static constexpr std::size_t kBucketCount =
+        (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    static std::size_t BucketIndex(uint64_t value_ns);
+
+    /// Smallest value that maps to `index`.
+    static uint64_t BucketLowerBound(std::size_t index);
+
+    void Record(uint64_t value_ns) {
+        buckets_[BucketIndex(value_ns)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t BucketCount(std::size_t index) const {
+        return buckets_[index].load(std::memory_order_relaxed);
+    }
+
+    void Reset();
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+};
+
+// ---------------------------------------------------------------------------
+// Snapshot types
+// ---------------------------------------------------------------------------
+
+/// Counters and latency distribution of one (device, operation) pair.
+struct OperationStats {
+    std::string device;
+    MetricOp op = MetricOp::kI2cRead;
+    uint64_t count = 0;     ///< completed operations (including errors)
+    uint64_t errors = 0;
+    uint64_t bytes = 0;     ///< payload bytes of successful operations
+    uint64_t total_ns = 0;
+    uint64_t min_ns = 0;
+    uint64_t max_ns = 0;
+    std::vector<uint64_t> histogram;  ///< LatencyHistogram bucket counts
+
+    uint64_t MeanNs() const { return count ? total_ns / count : 0; }
+
+    /// Latency at percentile `p` (0-100), as a bucket lower bound clamped
+    /// to [min_ns, max_ns]. 0 if no samples.
+    uint64_t PercentileNs(double p) const;
+
+    /// Payload bytes per second of time spent inside the operation.
+    double BytesPerSecond() const;
+};
+
+/// Transient-failure retries of one device (the "retry" interceptor, see
+/// hal/interceptor.h). Counted whether or not the registry is enabled.
+struct RetryStats {
+    std::string device;
+    uint64_t retried_calls = 0;  ///< calls that took more than one attempt
+    uint64_t retries = 0;        ///< attempts after the first
+    uint64_t recovered = 0;      ///< retried calls that ended without a transient failure
+    uint64_t exhausted = 0;      ///< calls still failing transiently when retries ran out
+    uint64_t backoff_us = 0;     ///< time slept between attempts
+};
+
+struct MetricsSnapshot {
+    std::vector<OperationStats> operations;  ///< sorted by device, then op
+
+    /// Devices with at least one retried or exhausted call, sorted by device.
+    std::vector<RetryStats> retries;
+
+    /// Named driver/core locks (core::LockStatsSnapshot()), sorted by name.
+    /// Process-wide, so device-filtered snapshots carry all of them too.
+    /// Empty unless built with PLAS_LOCK_STATS.
+    std::vector<core::LockStats> locks;
+
+    /// nullptr if the pair has no samples.
+    const OperationStats* Find(const std::string& device, MetricOp op) const;
+
+    /// nullptr if `name` was never acquired.
+    const core::LockStats* FindLock(const std::string& name) const;
+
+    /// nullptr if `device` never retried.
+    const RetryStats* FindRetries(const std::string& device) const;
+};
+
+// ---------------------------------------------------------------------------
+// DeviceMetrics — per-device counters, updated without locks
+// ---------------------------------------------------------------------------
+
+class DeviceMetrics {
+public:
+    void Record(MetricOp op, uint64_t duration_ns, std::size_t bytes,
+                bool ok);
+
+    /// Count one core::RetryCall(); no-op for a call that neither retried
+    /// nor ran out of attempts.
+    void RecordRetry(const core::RetryOutcome& outcome);
+
+    void Reset();
+
+    /// Append non-empty operations of this device to `out`.
+    void AppendTo(const std::string& device,
+                  std::vector<OperationStats>& out) const;
+
+    /// Append this device's retry counters to `out` if any are non-zero.
+    void AppendRetriesTo(const std::string& device, std::vector<RetryStats>& out) const;
+
+private:
+    struct Counters {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> errors{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> total_ns{0};
+        std::atomic<uint64_t> min_ns{UINT64_MAX};
+        std::atomic<uint64_t> max_ns{0};
+        LatencyHistogram histogram;
+    };
+
+    std::array<Counters, kMetricOpCount> ops_;
+    std::atomic<uint64_t> retried_calls_{0};
+    std::atomic<uint64_t> retries_{0};
+    std::atomic<uint64_t> recovered_{0};
+    std::atomic<uint64_t> exhausted_{0};
+    std::atomic<uint64_t> backoff_us_{0};
+};
+
+// ---------------------------------------------------------------------------
+// MetricsRegistry
+// ---------------------------------------------------------------------------
+
+/// Process-wide latency/throughput metrics keyed by device nickname and
+/// operation. Disabled by default.
+///
+/// Drivers look up their DeviceMetrics once in Open() and record through a
+/// MetricsTimer; the pointer stays valid for the life of the process, so the
+/// hot path takes no lock. When disabled a MetricsTimer costs one relaxed
+/// atomic load.
+class MetricsRegistry {
+public:
+    static MetricsRegistry& GetInstance();
+
+    void SetEnabled(bool enabled) {
+        enabled_.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool IsEnabled() const {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    /// Return the metrics of `nickname`, creating them on first use.
+    DeviceMetrics* GetDeviceMetrics(const std::string& nickname);
+
+    /// Copy out every (device, operation) pair with at least one sample.
+    MetricsSnapshot Snapshot() const;
+
+    /// Same, restricted to `devices`.
+    MetricsSnapshot Snapshot(const std::vector<std::string>& devices) const;
+
+    /// Zero all counters, retry and lock counters included. Existing DeviceMetrics
+    /// pointers stay valid.
+    void Reset();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+private:
+    MetricsRegistry() = default;
+    ~MetricsRegistry() = default;
+
+    std::atomic<bool> enabled_{false};
+    std::map<std::string, std::unique_ptr<DeviceMetrics>> devices_;
+    mutable std::mutex mutex_;
+};
+
+// ---------------------------------------------------------------------------
+// MetricsDeferScope — hold a thread's samples through a critical section
+// ---------------------------------------------------------------------------
+
+/// Keeps the samples the calling thread's MetricsTimers take in a buffer
+/// sized up front, for its lifetime (nestable), and records them when it
+/// ends, so a timing-critical section does not touch the shared counters'
+/// cache lines. Samples past `capacity` are recorded at once.
+class MetricsDeferScope {
+public:
+    explicit MetricsDeferScope(std::size_t capacity = 256);
+    ~MetricsDeferScope();
+
+    MetricsDeferScope(const MetricsDeferScope&) = delete;
+    MetricsDeferScope& operator=(const MetricsDeferScope&) = delete;
+
+    /// Samples held so far.
+    std::size_t Held() const { return used_; }
+
+    /// Hold a sample in the calling thread's innermost scope; false if
+    /// there is none or it is full.
+    static bool Hold(DeviceMetrics* metrics, MetricOp op, uint64_t duration_ns,
+                     std::size_t bytes, bool ok);
+
+private:
+    struct Sample {
+        DeviceMetrics* metrics = nullptr;
+        MetricOp op = MetricOp::kI2cRead;
+        bool ok = true;
+        uint64_t duration_ns = 0;
+        std::size_t bytes = 0;
+    };
+
+    std::vector<Sample> samples_;
+    std::size_t used_ = 0;
+    MetricsDeferScope* previous_;
+};
+
+// ---------------------------------------------------------------------------
+// MetricsTimer — times one operation and records it on destruction
+// ---------------------------------------------------------------------------
+
+/// Usage inside a driver:
+///
+///     hal::MetricsTimer timer(metrics_, hal::MetricOp::kI2cRead);
+///     int rc = sdk_read(...);
+///     if (rc < 0) timer.SetError();
+///     else timer.SetBytes(rc);
+///
+/// Nothing is recorded if `metrics` is null or the registry was disabled
+/// when the timer was created. Inside a MetricsDeferScope the sample is
+/// recorded when the scope ends.
+class MetricsTimer {
+public:
+    MetricsTimer(DeviceMetrics* metrics, MetricOp op, std::size_t bytes = 0)
+        : op_(op), bytes_(bytes) {
+        if (metrics == nullptr || !MetricsRegistry::GetInstance().IsEnabled()) {
+            return;
+        }
+        metrics_ = metrics;
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    ~MetricsTimer() {
+        if (metrics_ == nullptr) {
+            return;
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start_)
+                      .count();
+        if (!MetricsDeferScope::Hold(metrics_, op_, static_cast<uint64_t>(ns),
+                                     ok_ ? bytes_ : 0, ok_)) {
+            metrics_->Record(op_, static_cast<uint64_t>(ns), ok_ ? bytes_ : 0, ok_);
+        }
+    }
+
+    void SetError() { ok_ = false; }
+
+    /// Override the byte count given at construction (e.g. short reads).
+    void SetBytes(std::size_t bytes) { bytes_ = bytes; }
+
+    MetricsTimer(const MetricsTimer&) = delete;
+    MetricsTimer& operator=(const MetricsTimer&) = delete;
+
+private:
+    DeviceMetrics* metrics_ = nullptr;
+    MetricOp op_;
+    std::size_t bytes_;
+    bool ok_ = true;
+    std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace plas::hal
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "plas/core/realtime.h"
+#include "plas/core/result.h"
+#include "plas/core/units.h"
+
+namespace plas::hal {
+
+class DeviceManager;
+class PowerControl;
+class SsdGpio;
+
+/// What one timeline step does. kDelay only moves the schedule.
+enum class PowerStepAction : uint8_t {
+    kPowerOn,
+    kPowerOff,
+    kSetVoltage,
+    kSetCurrent,
+    kPerst,     ///< SetPerst(active): true asserts PERST#
+    kClkReq,    ///< SetClkReq(active)
+    kDualPort,  ///< SetDualPort(active)
+    kPins,      ///< SetPinState(pin_mask, pin_values): pins change together
+    kDelay,
+};
+
+const char* ToString(PowerStepAction action);
+
+/// One step of a power timeline; build with the factories.
+struct PowerStep {
+    PowerStepAction action = PowerStepAction::kDelay;
+    bool active = false;                  ///< kPerst/kClkReq/kDualPort
+    double value = 0.0;                   ///< volts or amps
+    std::chrono::microseconds delay{0};   ///< kDelay
+    uint8_t pin_mask = 0;                 ///< kPins, SsdPinState bits
+    uint8_t pin_values = 0;               ///< kPins
+
+    static PowerStep PowerOn() { return {PowerStepAction::kPowerOn}; }
+    static PowerStep PowerOff() { return {PowerStepAction::kPowerOff}; }
+    static PowerStep SetVoltage(core::Voltage v) {
+        return {PowerStepAction::kSetVoltage, false, v.Value()};
+    }
+    static PowerStep SetCurrent(core::Current c) {
+        return {PowerStepAction::kSetCurrent, false, c.Value()};
+    }
+    static PowerStep Perst(bool asserted) { return {PowerStepAction::kPerst, asserted}; }
+    static PowerStep ClkReq(bool active) { return {PowerStepAction::kClkReq, active}; }
+    static PowerStep DualPort(bool enable) { return {PowerStepAction::kDualPort, enable}; }
+    static PowerStep Pins(uint8_t mask, uint8_t values) {
+        return {PowerStepAction::kPins, false, 0.0, std::chrono::microseconds{0},
+                mask, values};
+    }
+    static PowerStep Delay(std::chrono::microseconds d) {
+        return {PowerStepAction::kDelay, false, 0.0, d};
+    }
+
+    /// True for the steps that go through SsdGpio rather than PowerControl.
+    bool NeedsGpio() const {
+        return action == PowerStepAction::kPerst ||
+               action == PowerStepAction::kClkReq ||
+               action == PowerStepAction::kDualPort ||
+               action == PowerStepAction::kPins;
+    }
+};
+
+/// One slot: the interfaces a timeline drives. Either may be null if the
+/// timeline does not need it.
+struct PowerSequenceTarget {
+    std::string name;
+    PowerControl* power = nullptr;
+    SsdGpio* gpio = nullptr;
+};
+
+/// Timing of one executed (or failed) step. Times are nanoseconds from the
+/// common start of the run, so slots can be compared directly.
+struct PowerStepTiming {
+    std::size_t step = 0;        ///< index into the timeline
+    PowerStepAction action = PowerStepAction::kDelay;
+    uint64_t scheduled_ns = 0;   ///< when the timeline said to issue it
+    uint64_t start_ns = 0;       ///< when the call was issued
+    uint64_t end_ns = 0;         ///< when the call returned
+    std::error_code error;
+
+    uint64_t LatenessNs() const { return start_ns - scheduled_ns; }
+};
+
+struct PowerSlotReport {
+    std::string name;
+    std::vector<PowerStepTiming> steps;  ///< action steps actually issued
+    std::error_code error;               ///< first failure, if any
+    bool completed = false;              ///< every step ran and succeeded
+    core::RealtimeStatus realtime;       ///< what Options::realtime obtained
+};
+
+struct PowerSequenceReport {
+    std::vector<PowerSlotReport> slots;  ///< in target order
+    uint64_t duration_ns = 0;            ///< start to last slot finished
+
+    bool Ok() const;
+    /// Worst LatenessNs() over every step of every slot.
+    uint64_t MaxLatenessNs() const;
+    /// Distribution of LatenessNs() over every step of every slot.
+    core::JitterStats Jitter() const;
+};
+
+/// Issue one action step on `target` and return its error (kDelay does
+/// nothing). The interface the step needs must be non-null.
+std::error_code ExecutePowerStep(const PowerStep& step, const PowerSequenceTarget& target);
+
+/// Runs one declarative power timeline on many slots at once.
+///
+/// Each slot gets its own thread. All slots share one start instant and
+/// every step is issued at an absolute offset from it (the sum of the
+/// preceding delays, plus the slot's stagger), so call latency on one step
+/// never pushes later steps back and slots stay aligned. Waits sleep until
+/// shortly before the deadline and spin the rest.
+class PowerSequencer {
+public:
+    struct Options {
+        /// Extra offset per slot index (slot i starts at i * stagger), e.g.
+        /// to spread inrush current across a chassis.
+        std::chrono::microseconds stagger{0};
+        /// Stop a slot at its first failed step; otherwise log it in the
+        /// report and carry on.
+        bool stop_on_error = true;
+        /// Wait this close to a deadline by spinning instead of sleeping.
+        std::chrono::microseconds spin{200};
+
+        /// Low-jitter mode for timing-critical sequences. Each slot thread
+        /// enters real time (core::EnterRealtime: SCHED_FIFO, pinned,
+        /// stack pre-faulted) before the start, keeps its step timings in
+        /// one mlock'ed core::RealtimeArena, spins on core::TscClock
+        /// rather than steady_clock, and holds its log messages and
+        /// metrics samples until its last step. Settings the process may
+        /// not apply are left out and shown in PowerSlotReport::realtime.
+        bool realtime = false;
+        /// Scheduling for the slot threads; `cpu` is overridden per slot
+        /// by `realtime_cpus`.
+        core::RealtimeOptions realtime_options;
+        /// CPUs for the slots (slot i on realtime_cpus[i % size]). Empty:
+        /// core::IsolatedCpus(), and if there are none, no pinning.
+        std::vector<int> realtime_cpus;
+    };
+
+    explicit PowerSequencer(std::vector<PowerStep> timeline);
+
+    const std::vector<PowerStep>& Timeline() const { return timeline_; }
+
+    /// Total of the timeline's delays.
+    std::chrono::microseconds Duration() const;
+
+    /// Run the timeline on every target and wait for all of them.
+    /// kInvalidArgument (before anything runs) if there are no targets, or
+    /// a target lacks an interface the timeline uses; kOutOfMemory if the
+    /// real-time arena cannot be mapped. Step failures do not
+    /// fail Run(); they are in the report. Under a core::Deadline the slot
+    /// threads inherit it, and a slot whose next step is scheduled after it
+    /// stops there with kTimeout.
+    core::Result<PowerSequenceReport> Run(const std::vector<PowerSequenceTarget>& targets,
+                                          const Options& options) const;
+    core::Result<PowerSequenceReport> Run(
+        const std::vector<PowerSequenceTarget>& targets) const {
+        return Run(targets, Options{});
+    }
+
+    /// Targets for the named devices, resolved through GetInterface (so
+    /// lazily opened devices are opened here, not mid-timeline). kNotFound
+    /// if a name is unknown or implements neither interface.
+    static core::Result<std::vector<PowerSequenceTarget>> ResolveTargets(
+        DeviceManager& manager, const std::vector<std::string>& names);
+
+private:
+    std::vector<PowerStep> timeline_;
+};
+
+}  // namespace plas::hal
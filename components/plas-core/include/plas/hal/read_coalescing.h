@@ -0,0 +1,284 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/pci/cxl_mailbox.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/smbus.h"
+
+namespace plas::hal {
+
+class Device;  // forward declaration
+
+struct ReadCoalescingOptions {
+    /// How long a completed read is reused by identical reads that start
+    /// after it. 0 shares only reads still in flight.
+    std::chrono::microseconds freshness{0};
+};
+
+inline bool operator==(const ReadCoalescingOptions& a, const ReadCoalescingOptions& b) {
+    return a.freshness == b.freshness;
+}
+
+inline bool operator!=(const ReadCoalescingOptions& a, const ReadCoalescingOptions& b) {
+    return !(a == b);
+}
+
+struct ReadCoalescingStats {
+    uint64_t reads = 0;          ///< reads that went to the hardware
+    uint64_t joined = 0;         ///< reads that waited for an identical one in flight
+    uint64_t fresh_hits = 0;     ///< reads answered within the freshness window
+    uint64_t invalidations = 0;  ///< Invalidate() calls (writes through the wrappers)
+};
+
+/// Single-flight table: identical reads (same key) that overlap in time
+/// run once and all callers get the result.
+///
+/// The first caller of a key runs the read; callers arriving while it is in
+/// flight wait for it, and, with a freshness window, callers arriving up to
+/// `freshness` after it completed get the same result without a read.
+/// Errors are shared with the callers that waited but never reused after
+/// that. A waiter stops at its own core::Deadline with kTimeout; the read
+/// itself runs under the first caller's deadline. Invalidate() (every
+/// write) makes later reads start afresh, so a read issued after a write
+/// never sees a result from before it.
+class ReadCoalescer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ReadCoalescer(std::chrono::nanoseconds freshness = std::chrono::nanoseconds(0))
+        : freshness_(freshness) {}
+
+    ReadCoalescer(const ReadCoalescer&) = delete;
+    ReadCoalescer& operator=(const ReadCoalescer&) = delete;
+
+    /// Result of `read()` for `key`, shared as above. With `keep`, a
+    /// successful result is reused only if keep(value) is true.
+    template <typename T, typename Read>
+    core::Result<T> Run(const std::string& key, Read&& read,
+                        bool (*keep)(const T&) = nullptr) {
+        bool leader = false;
+        auto flight = Join(key, leader);
+        if (!leader) {
+            if (!flight) {
+                return core::Result<T>::Err(core::ErrorCode::kTimeout);
+            }
+            return *static_cast<const core::Result<T>*>(flight->result.get());
+        }
+        auto result = std::make_shared<const core::Result<T>>(read());
+        bool reusable = result->IsOk() && (!keep || keep(result->Value()));
+        Finish(key, flight, result, reusable);
+        return *result;
+    }
+
+    /// Drop every shared result; reads in flight finish for their waiters
+    /// but are not reused.
+    void Invalidate();
+
+    ReadCoalescingStats Stats() const;
+
+private:
+    struct Flight {
+        bool done = false;
+        Clock::time_point finished;
+        std::shared_ptr<const void> result;  // core::Result<T>
+    };
+
+    /// The flight to wait for (completed on return), or a new one the
+    /// caller leads (`leader` set). nullptr if the caller's deadline passed.
+    std::shared_ptr<Flight> Join(const std::string& key, bool& leader);
+    void Finish(const std::string& key, const std::shared_ptr<Flight>& flight,
+                std::shared_ptr<const void> result, bool reusable);
+
+    const std::chrono::nanoseconds freshness_;
+    mutable std::mutex mutex_;
+    std::condition_variable done_;
+    std::unordered_map<std::string, std::shared_ptr<Flight>> flights_;
+    ReadCoalescingStats stats_;
+};
+
+/// I2c whose Read (with STOP) and WriteRead calls are coalesced. Write,
+/// Transfer and SetBitrate go to the backend and invalidate; Probe and Scan
+/// are not coalesced.
+class CoalescingI2c : public I2c {
+public:
+    CoalescingI2c(I2c& backend, ReadCoalescer& coalescer)
+        : backend_(backend), coalescer_(coalescer) {}
+
+    std::string InterfaceName() const override { return backend_.InterfaceName(); }
+    Device* GetDevice() override { return backend_.GetDevice(); }
+
+    core::Result<size_t> Read(core::Address addr, core::Byte* data, size_t length,
+                              bool stop = true) override;
+    core::Result<size_t> Write(core::Address addr, const core::Byte* data, size_t length,
+                               bool stop = true) override;
+    core::Result<size_t> WriteRead(core::Address addr, const core::Byte* write_data,
+                                   size_t write_len, core::Byte* read_data,
+                                   size_t read_len) override;
+    core::Result<size_t> Transfer(I2cMessage* msgs, size_t count) override;
+    core::Result<bool> Probe(core::Address addr) override { return backend_.Probe(addr); }
+    core::Result<std::vector<core::Address>> Scan(
+        core::Address first, core::Address last,
+        std::chrono::milliseconds timeout = std::chrono::milliseconds{0}) override {
+        return backend_.Scan(first, last, timeout);
+    }
+    core::Result<void> SetBitrate(uint32_t bitrate) override;
+    uint32_t GetBitrate() const override { return backend_.GetBitrate(); }
+
+private:
+    I2c& backend_;
+    ReadCoalescer& coalescer_;
+};
+
+/// SmBus whose command reads (Transact with a one-byte write and a read:
+/// ReadByteData, ReadWordData, BlockRead) are coalesced. Writes and process
+/// calls go to the backend and invalidate.
+class CoalescingSmBus : public SmBus {
+public:
+    CoalescingSmBus(SmBus& backend, ReadCoalescer& coalescer)
+        : backend_(backend), coalescer_(coalescer) {}
+
+    std::string InterfaceName() const override { return backend_.InterfaceName(); }
+    Device* GetDevice() override { return backend_.GetDevice(); }
+
+    core::Result<size_t> Transact(core::Address addr, const core::Byte* write,
+                                  size_t write_len, core::Byte* read, size_t read_len,
+                                  bool block, bool pec) override;
+
+private:
+    SmBus& backend_;
+    ReadCoalescer& coalescer_;
+};
+
+/// PciConfig whose ReadConfig8/16/32 and ReadConfigBlock calls are
+/// coalesced. Writes go to the backend and invalidate; capability lookups
+/// are forwarded.
+class CoalescingPciConfig : public pci::PciConfig {
+public:
+    CoalescingPciConfig(pci::PciConfig& backend, ReadCoalescer& coalescer)
+        : backend_(backend), coalescer_(coalescer) {}
+
+    std::string InterfaceName() const override { return backend_.InterfaceName(); }
+    Device* GetDevice() override { return backend_.GetDevice(); }
+
+    core::Result<core::Byte> ReadConfig8(pci::Bdf bdf, pci::ConfigOffset offset) override;
+    core::Result<core::Word> ReadConfig16(pci::Bdf bdf, pci::ConfigOffset offset) override;
+    core::Result<core::DWord> ReadConfig32(pci::Bdf bdf, pci::ConfigOffset offset) override;
+
+    core::Result<void> WriteConfig8(pci::Bdf bdf, pci::ConfigOffset offset,
+                                    core::Byte value) override;
+    core::Result<void> WriteConfig16(pci::Bdf bdf, pci::ConfigOffset offset,
+                                     core::Word value) override;
+    core::Result<void> WriteConfig32(pci::Bdf bdf, pci::ConfigOffset offset,
+                                     core::DWord value) override;
+    std::size_t WriteConfigBatch(pci::Bdf bdf, const pci::ConfigWrite* writes,
+                                 std::size_t count, std::error_code* status) override;
+
+    core::Result<std::optional<pci::ConfigOffset>> FindCapability(
+        pci::Bdf bdf, pci::CapabilityId id) override {
+        return backend_.FindCapability(bdf, id);
+    }
+    core::Result<std::optional<pci::ConfigOffset>> FindExtCapability(
+        pci::Bdf bdf, pci::ExtCapabilityId id) override {
+        return backend_.FindExtCapability(bdf, id);
+    }
+
+    core::Result<void> ReadConfigBlock(pci::Bdf bdf, pci::ConfigOffset offset,
+                                       core::Byte* buffer, std::size_t length) override;
+    core::Result<pci::CapabilityIndex> GetCapabilityIndex(pci::Bdf bdf) override {
+        return backend_.GetCapabilityIndex(bdf);
+    }
+
+private:
+    pci::PciConfig& backend_;
+    ReadCoalescer& coalescer_;
+};
+
+/// CxlMailbox whose read-only commands (IsReadOnlyCommand) are coalesced
+/// by opcode and input payload; only kSuccess results are reused within the
+/// freshness window. Other commands go to the backend and invalidate.
+class CoalescingCxlMailbox : public pci::CxlMailbox {
+public:
+    CoalescingCxlMailbox(pci::CxlMailbox& backend, ReadCoalescer& coalescer)
+        : backend_(backend), coalescer_(coalescer) {}
+
+    /// Identify, Get Supported Logs, Get Log, Get Supported Features,
+    /// Get Feature, Get FW Info, Get Timestamp, Identify Memory Device,
+    /// Get Health Info, Get Alert Configuration and Get Poison List.
+    static bool IsReadOnlyCommand(uint16_t raw_opcode);
+
+    std::string InterfaceName() const override { return backend_.InterfaceName(); }
+    Device* GetDevice() override { return backend_.GetDevice(); }
+
+    core::Result<pci::CxlMailboxResult> ExecuteCommand(
+        pci::Bdf bdf, pci::CxlMailboxOpcode opcode,
+        const pci::CxlMailboxPayload& payload) override {
+        return ExecuteCommand(bdf, static_cast<uint16_t>(opcode), payload);
+    }
+    core::Result<pci::CxlMailboxResult> ExecuteCommand(
+        pci::Bdf bdf, uint16_t raw_opcode, const pci::CxlMailboxPayload& payload) override;
+    core::Result<pci::CxlMailboxResult> ExecuteCommandGather(
+        pci::Bdf bdf, uint16_t raw_opcode, const uint8_t* header, std::size_t header_len,
+        const uint8_t* data, std::size_t data_len) override;
+    core::Result<pci::CxlMailboxPooledResult> ExecuteCommandPooled(
+        pci::Bdf bdf, uint16_t raw_opcode, const uint8_t* payload,
+        std::size_t length) override;
+
+    core::Result<uint32_t> GetPayloadSize(pci::Bdf bdf) override {
+        return backend_.GetPayloadSize(bdf);
+    }
+    core::Result<bool> IsReady(pci::Bdf bdf) override { return backend_.IsReady(bdf); }
+    core::Result<pci::CxlMailboxResult> GetBackgroundCmdStatus(pci::Bdf bdf) override {
+        return backend_.GetBackgroundCmdStatus(bdf);
+    }
+
+private:
+    pci::CxlMailbox& backend_;
+    ReadCoalescer& coalescer_;
+};
+
+/// The coalescing wrappers of one device's I2c, SmBus, PciConfig and
+/// CxlMailbox interfaces, sharing one ReadCoalescer (a write through any
+/// of them invalidates all). DeviceManager puts them in place of the
+/// device's own interfaces (see DeviceManager::EnableReadCoalescing); the
+/// device must outlive the layer.
+class ReadCoalescingLayer {
+public:
+    ReadCoalescingLayer(Device& device, const ReadCoalescingOptions& options);
+    ~ReadCoalescingLayer();
+
+    ReadCoalescingLayer(const ReadCoalescingLayer&) = delete;
+    ReadCoalescingLayer& operator=(const ReadCoalescingLayer&) = delete;
+
+    const ReadCoalescingOptions& Options() const { return options_; }
+    ReadCoalescer& Coalescer() { return coalescer_; }
+    const ReadCoalescer& Coalescer() const { return coalescer_; }
+
+    /// The wrapper, or nullptr if the device lacks the interface.
+    I2c* GetI2c() { return i2c_.get(); }
+    SmBus* GetSmBus() { return smbus_.get(); }
+    pci::PciConfig* GetPciConfig() { return pci_config_.get(); }
+    pci::CxlMailbox* GetCxlMailbox() { return cxl_mailbox_.get(); }
+
+private:
+    ReadCoalescingOptions options_;
+    ReadCoalescer coalescer_;
+    std::unique_ptr<CoalescingI2c> i2c_;
+    std::unique_ptr<CoalescingSmBus> smbus_;
+    std::unique_ptr<CoalescingPciConfig> pci_config_;
+    std::unique_ptr<CoalescingCxlMailbox> cxl_mailbox_;
+};
+
+}  // namespace plas::hal
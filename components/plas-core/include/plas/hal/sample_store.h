@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/hal/sampler.h"
+
+namespace plas::hal {
+
+// ---------------------------------------------------------------------------
+// On-disk format
+//
+// One append-only file per signal: a SampleFileHeader followed by blocks.
+// Each block is a SampleBlockHeader and three columns of the block's
+// samples, padded to 8 bytes:
+//
+//   timestamps  zigzag varint deltas from the previous timestamp
+//               (the first from SampleBlockHeader::min_ns)
+//   values      varint of the value's bits XOR the previous value's bits
+//               (the first XOR 0), so a repeated value costs one byte
+//   errors      varint of Sample::error.value() (a core::ErrorCode)
+//
+// A block's `size` is written last; the zero-filled space after the last
+// block reads as size 0, so a reader stops there and a block torn by a
+// crash is never seen. All fields are little-endian host order.
+// ---------------------------------------------------------------------------
+
+inline constexpr char kSampleFileMagic[8] = {'P', 'L', 'A', 'S', 'S', 'M', 'P', '\0'};
+inline constexpr uint32_t kSampleFileVersion = 1;
+inline constexpr std::size_t kSampleSignalNameSize = 96;
+inline constexpr const char* kSampleFileExtension = ".samples";
+
+struct SampleFileHeader {
+    char     magic[8];                       ///< kSampleFileMagic
+    uint32_t version;                        ///< kSampleFileVersion
+    uint32_t header_size;                    ///< sizeof(SampleFileHeader)
+    char     signal[kSampleSignalNameSize];  ///< NUL-terminated signal name
+    uint64_t created_ns;                     ///< system_clock since epoch
+    uint64_t reserved;
+};
+static_assert(sizeof(SampleFileHeader) == 128, "SampleFileHeader layout is fixed");
+
+struct SampleBlockHeader {
+    uint32_t size;             ///< header + columns + padding; 0 = no block
+    uint32_t count;            ///< samples in the block
+    uint64_t min_ns;           ///< smallest timestamp (also the delta base)
+    uint64_t max_ns;           ///< largest timestamp
+    uint32_t timestamp_bytes;  ///< column lengths
+    uint32_t value_bytes;
+    uint32_t error_bytes;
+    uint32_t error_count;      ///< samples with an error
+};
+static_assert(sizeof(SampleBlockHeader) == 40, "SampleBlockHeader layout is fixed");
+
+// ---------------------------------------------------------------------------
+// SampleStore — writer
+// ---------------------------------------------------------------------------
+
+struct SampleStoreOptions {
+    std::size_t block_samples = 4096;  ///< samples buffered per signal before a block is written
+    /// Bytes of a signal file mapped at a time; the file grows by this much.
+    /// Must hold one full block (block_samples * 25 + 40 bytes).
+    std::size_t map_window = 4u << 20;
+};
+
+/// Persists samples as compressed columnar blocks in memory-mapped,
+/// append-only files, one per signal, for runs too long to keep in memory
+/// or to write as text.
+///
+/// Memory stays bounded: per signal, one block of pending samples and one
+/// mapped window of the file. Appending to an existing directory continues
+/// each signal's file. Samples of a signal are expected in time order;
+/// out-of-order samples are stored but widen their block's time range.
+/// Thread-safe.
+class SampleStore {
+public:
+    explicit SampleStore(SampleStoreOptions options = {});
+    ~SampleStore();  // Close()
+
+    SampleStore(const SampleStore&) = delete;
+    SampleStore& operator=(const SampleStore&) = delete;
+
+    /// Create `directory` if needed and start storing. kAlreadyOpen if
+    /// open, kInvalidArgument for an empty path or a map_window too small
+    /// for a block.
+    core::Result<void> Open(const std::string& directory);
+
+    /// Write the pending blocks and unmap every file.
+    void Close();
+    bool IsOpen() const;
+
+    /// Buffer `count` samples of `signal`, writing a block whenever
+    /// block_samples are pending. kNotInitialized if not open,
+    /// kInvalidArgument for an empty name or one of kSampleSignalNameSize
+    /// or more bytes, kTypeMismatch if an existing file belongs to a
+    /// different format version, kIOError if the file cannot be grown or
+    /// mapped.
+    core::Result<void> Append(const std::string& signal, const Sample* samples,
+                              std::size_t count);
+
+    /// Move every sample waiting in `sampler`'s rings into the store, under
+    /// the sampler's signal names. Call it periodically (e.g. from
+    /// Executor::PostEvery) as the rings' only consumer. Returns the number
+    /// of samples moved.
+    core::Result<std::size_t> Drain(Sampler& sampler);
+
+    /// Write the pending samples of every signal as (possibly short) blocks
+    /// so readers see them.
+    core::Result<void> Flush();
+
+    std::string GetDirectory() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// ---------------------------------------------------------------------------
+// SampleStoreReader
+// ---------------------------------------------------------------------------
+
+struct SampleRange {
+    uint64_t first_ns = 0;  ///< smallest timestamp stored
+    uint64_t last_ns = 0;   ///< largest timestamp stored
+    uint64_t count = 0;
+    uint64_t errors = 0;
+    std::size_t blocks = 0;
+};
+
+/// Time-range queries over a SampleStore directory. Sees the blocks
+/// written so far, also while a SampleStore is appending; samples still
+/// pending in the writer are not visible until its Flush(). Blocks outside
+/// the queried range are skipped by their headers without decoding.
+class SampleStoreReader {
+public:
+    explicit SampleStoreReader(std::string directory);
+
+    /// Names of the signals stored in the directory, sorted.
+    core::Result<std::vector<std::string>> ListSignals() const;
+
+    /// Extent of `signal`'s data from the block headers. kNotFound if the
+    /// signal has no file.
+    core::Result<SampleRange> GetRange(const std::string& signal) const;
+
+    /// Append the samples of `signal` with from_ns <= timestamp_ns <= to_ns
+    /// to `out`, in storage order. Returns the number appended. kNotFound
+    /// if the signal has no file, kDataLoss for a corrupt block.
+    core::Result<std::size_t> Query(const std::string& signal, uint64_t from_ns,
+                                    uint64_t to_ns, std::vector<Sample>& out) const;
+
+private:
+    std::string directory_;
+};
+
+}  // namespace plas::hal
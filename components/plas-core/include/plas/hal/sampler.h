@@ -0,0 +1,142 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+
+#include "plas/core/result.h"
+
+namespace plas::core {
+class Executor;
+}  // namespace plas::core
+
+namespace plas::hal {
+
+class DeviceManager;
+
+/// One reading of a signal.
+struct Sample {
+    uint64_t timestamp_ns = 0;  ///< steady_clock, when the read was issued
+    double value = 0.0;         ///< meaningless unless Ok()
+    std::error_code error;
+
+    bool Ok() const { return !error; }
+};
+
+using SignalId = uint32_t;
+
+/// Reads the due signals of one batch key together, e.g. in one bus
+/// transaction: fills out[i] (value and error; the timestamp is preset)
+/// for the signal registered with tags[i].
+using SampleBatchReader =
+    std::function<void(const uint32_t* tags, std::size_t count, Sample* out)>;
+
+struct SamplerSignal {
+    std::string name;  ///< unique
+    std::chrono::microseconds period{1000000};
+    /// Signals with the same key (a device nickname, a bus) that fall due
+    /// in the same tick are read by one executor task, one after another or
+    /// through the key's SampleBatchReader. Empty: the signal's own name.
+    std::string batch_key;
+    /// Read of this signal alone; unused if the key has a batch reader.
+    std::function<core::Result<double>()> read;
+    uint32_t tag = 0;  ///< passed to the key's batch reader
+};
+
+struct SamplerOptions {
+    /// Timer wheel resolution; periods are rounded up to whole ticks.
+    std::chrono::microseconds tick{1000};
+    std::size_t wheel_slots = 512;
+    std::size_t ring_capacity = 1024;  ///< samples kept per signal; rounded up to 2^n
+    /// Executor for the tick timer and the reads. nullptr:
+    /// core::Executor::Shared().
+    core::Executor* executor = nullptr;
+};
+
+struct SignalStats {
+    uint64_t samples = 0;  ///< reads done, errors included
+    uint64_t errors = 0;
+    uint64_t skipped = 0;  ///< falls due while the previous read of its key still ran
+    uint64_t dropped = 0;  ///< samples lost because the ring was full
+};
+
+/// Samples many signals at their own rates from one timer instead of a
+/// thread with a read/sleep loop per signal.
+///
+/// A hashed timer wheel driven by one core::Executor::PostEvery(tick)
+/// finds the signals due in each tick; they are grouped by batch key and
+/// each group is read by one task on the executor, so a device or bus sees
+/// its reads back to back rather than interleaved with other loops'. A
+/// group still running when its next reads fall due skips them (counted)
+/// instead of queueing. Missed ticks are skipped the same way: periods are
+/// fixed rate, not catch-up.
+///
+/// Samples go into a lock-free ring per signal: the group task is the one
+/// producer, Read() the one consumer. When a ring is full, new samples are
+/// dropped and counted.
+///
+/// Signals are registered before Start(). Read callbacks and batch readers
+/// run on executor workers and must not block for long.
+class Sampler {
+public:
+    explicit Sampler(SamplerOptions options = {});
+    ~Sampler();  // Stop()
+
+    Sampler(const Sampler&) = delete;
+    Sampler& operator=(const Sampler&) = delete;
+
+    /// kBusy while running; kInvalidArgument for an empty or duplicate
+    /// name or a zero period.
+    core::Result<SignalId> AddSignal(SamplerSignal signal);
+
+    /// Read every signal of `batch_key` through `reader`. kBusy while
+    /// running.
+    core::Result<void> SetBatchReader(const std::string& batch_key, SampleBatchReader reader);
+
+    /// Add the signals that config entries declare with the `sample` arg
+    /// (config::kSampleArg), for the devices of `manager` loaded from
+    /// config:
+    ///
+    ///   sample: voltage@100ms,current@10ms,i2c:0x48:0x00:2@1s
+    ///
+    /// `voltage` and `current` read PowerControl (volts, amps);
+    /// `i2c:<addr>:<reg>[:<len>]` reads 1-4 bytes of register `reg`
+    /// (MSB first) through I2c. Periods take us, ms or s. Signals are named
+    /// "<nickname>.<kind>" and batched per device; a device's due I2C
+    /// reads share one I2c::Transfer. All or nothing: kInvalidArgument for
+    /// a malformed entry, kNotFound if the device lacks the interface.
+    /// Returns the number of signals added.
+    core::Result<std::size_t> AddFromConfig(DeviceManager& manager);
+
+    std::optional<SignalId> FindSignal(const std::string& name) const;
+    /// Empty for an unknown id. Ids run from 0 to SignalCount() - 1.
+    std::string GetSignalName(SignalId id) const;
+    std::size_t SignalCount() const;
+
+    /// kAlreadyOpen if running, kNotInitialized without signals,
+    /// kInvalidArgument if a signal has neither a read nor a batch reader.
+    /// Every signal is first due one tick after Start().
+    core::Result<void> Start();
+
+    /// Returns once the reads in progress have finished.
+    void Stop();
+    bool IsRunning() const;
+
+    /// Consumer of `id`'s ring: move up to `max` of the oldest samples into
+    /// `out`. 0 for an unknown id.
+    std::size_t Read(SignalId id, Sample* out, std::size_t max);
+
+    /// kOutOfRange for an unknown id.
+    core::Result<SignalStats> GetStats(SignalId id) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+
+namespace plas::hal {
+
+struct SerialPortOptions {
+    std::size_t rx_capacity = 64 * 1024;  ///< rounded up to a power of two
+    std::size_t tx_capacity = 16 * 1024;
+    /// Called on the I/O thread after new bytes were buffered. Optional.
+    std::function<void()> on_readable;
+};
+
+/// One epoll thread serving many serial file descriptors. Each port gets an
+/// RX ring the thread fills as bytes arrive and a TX ring it drains as the
+/// fd accepts them, so callers never block in read(2)/write(2) and 48
+/// consoles cost one thread, not 48. Reads wait with a timeout; readiness
+/// is signalled through SerialPortOptions::on_readable.
+///
+/// Linux only; elsewhere AddPort() returns kNotSupported.
+class SerialIoLoop {
+public:
+    using PortId = uint32_t;
+
+    SerialIoLoop();
+    ~SerialIoLoop();  // stops the thread; ports must be removed first
+
+    SerialIoLoop(const SerialIoLoop&) = delete;
+    SerialIoLoop& operator=(const SerialIoLoop&) = delete;
+
+    /// Process-wide loop shared by serial drivers.
+    static SerialIoLoop& Shared();
+
+    /// Serve `fd` (switched to O_NONBLOCK; still owned by the caller, who
+    /// closes it after RemovePort()). Starts the thread on first use.
+    /// read(2) returning 0 counts as hangup, so ttys need VMIN >= 1.
+    core::Result<PortId> AddPort(int fd, SerialPortOptions options);
+
+    /// Stop serving a port. Once this returns the loop no longer touches the
+    /// fd and no on_readable call is running; must not be called from
+    /// inside that port's callback. kNotFound for an unknown id.
+    core::Result<void> RemovePort(PortId id);
+
+    /// Move up to `length` buffered bytes into `data`, waiting up to
+    /// `timeout` for the first one (0 = do not wait). kTimeout if none
+    /// arrived, kIOError once the fd hung up and the ring is empty.
+    core::Result<std::size_t> Read(PortId id, core::Byte* data, std::size_t length,
+                                   std::chrono::milliseconds timeout);
+
+    /// Queue bytes for transmission, waiting up to `timeout` for ring space
+    /// when it is full. Returns how many were queued; kTimeout if none.
+    core::Result<std::size_t> Write(PortId id, const core::Byte* data,
+                                    std::size_t length,
+                                    std::chrono::milliseconds timeout);
+
+    /// Wait until every queued byte was handed to the fd. kTimeout if not.
+    core::Result<void> Drain(PortId id, std::chrono::milliseconds timeout);
+
+    /// Replace the port's on_readable callback (empty clears it).
+    core::Result<void> SetReadyCallback(PortId id, std::function<void()> callback);
+
+    /// Bytes buffered for Read(); 0 for an unknown id.
+    std::size_t Available(PortId id) const;
+
+    /// Received bytes lost because the RX ring was full.
+    uint64_t RxDropped(PortId id) const;
+
+    std::size_t PortCount() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::hal
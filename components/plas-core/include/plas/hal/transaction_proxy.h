@@ -0,0 +1,223 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/pci/pci_bar.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/transaction_trace.h"
+
+namespace plas::hal {
+
+/// Carries out HAL calls described as TraceRecords (see the field table in
+/// transaction_trace.h) somewhere other than a local device object: a
+/// trace being replayed, a server on another host, ...
+class TransactionPort {
+public:
+    virtual ~TransactionPort() = default;
+
+    /// Perform `call`. On success fills its outputs (value, response); on
+    /// failure returns the call's error (or the port's own, e.g. kIOError
+    /// for a lost connection).
+    virtual core::Result<void> Execute(TraceRecord& call) = 0;
+
+    /// Perform `count` calls in order, stopping at the first that fails;
+    /// each call's `error` is set and the calls after a failure get
+    /// kCancelled. The result is an error only if the port itself failed.
+    /// The default runs Execute() per call; ports that pay a round trip per
+    /// call override it to send the whole batch at once.
+    virtual core::Result<void> ExecuteBatch(TraceRecord* calls, std::size_t count);
+};
+
+/// InterfaceKind bits (1 << kind) of the I2c, PciConfig, PciDoe and PciBar
+/// interfaces `device` implements — the ones a TraceRecord can describe.
+uint32_t TransactionInterfaces(Device& device);
+
+/// Perform `call` on `device` through the matching interface (the inverse
+/// of a proxy). kNotSupported if the device lacks the interface.
+core::Result<void> ExecuteTransaction(Device& device, TraceRecord& call);
+
+namespace detail {
+
+/// Interface halves of a transaction proxy: each turns its calls into
+/// TraceRecords for the port and unpacks the outputs.
+class ProxyI2c : public I2c {
+public:
+    ProxyI2c(Device& device, TransactionPort& port) : device_(device), port_(port) {}
+
+    Device* GetDevice() override { return &device_; }
+    core::Result<size_t> Read(core::Address addr, core::Byte* data, size_t length,
+                              bool stop) override;
+    core::Result<size_t> Write(core::Address addr, const core::Byte* data, size_t length,
+                               bool stop) override;
+    core::Result<size_t> WriteRead(core::Address addr, const core::Byte* write_data,
+                                   size_t write_len, core::Byte* read_data,
+                                   size_t read_len) override;
+    /// One ExecuteBatch() for the whole batch.
+    core::Result<size_t> Transfer(I2cMessage* msgs, size_t count) override;
+    core::Result<void> SetBitrate(uint32_t bitrate) override;
+    /// The last bitrate set through this proxy (400 kHz until then).
+    uint32_t GetBitrate() const override;
+
+private:
+    Device& device_;
+    TransactionPort& port_;
+    std::atomic<uint32_t> bitrate_{400000};
+};
+
+class ProxyPciConfig : public pci::PciConfig {
+public:
+    ProxyPciConfig(Device& device, TransactionPort& port) : device_(device), port_(port) {}
+
+    Device* GetDevice() override { return &device_; }
+    core::Result<core::Byte> ReadConfig8(pci::Bdf bdf, pci::ConfigOffset offset) override;
+    core::Result<core::Word> ReadConfig16(pci::Bdf bdf, pci::ConfigOffset offset) override;
+    core::Result<core::DWord> ReadConfig32(pci::Bdf bdf, pci::ConfigOffset offset) override;
+    core::Result<void> WriteConfig8(pci::Bdf bdf, pci::ConfigOffset offset,
+                                    core::Byte value) override;
+    core::Result<void> WriteConfig16(pci::Bdf bdf, pci::ConfigOffset offset,
+                                     core::Word value) override;
+    core::Result<void> WriteConfig32(pci::Bdf bdf, pci::ConfigOffset offset,
+                                     core::DWord value) override;
+    core::Result<std::optional<pci::ConfigOffset>> FindCapability(
+        pci::Bdf bdf, pci::CapabilityId id) override;
+    core::Result<std::optional<pci::ConfigOffset>> FindExtCapability(
+        pci::Bdf bdf, pci::ExtCapabilityId id) override;
+    core::Result<void> ReadConfigBlock(pci::Bdf bdf, pci::ConfigOffset offset,
+                                       core::Byte* buffer, std::size_t length) override;
+
+private:
+    Device& device_;
+    TransactionPort& port_;
+};
+
+class ProxyPciDoe : public pci::PciDoe {
+public:
+    ProxyPciDoe(Device& device, TransactionPort& port) : device_(device), port_(port) {}
+
+    Device* GetDevice() override { return &device_; }
+    core::Result<std::vector<pci::DoeProtocolId>> DoeDiscover(
+        pci::Bdf bdf, pci::ConfigOffset doe_offset) override;
+    core::Result<pci::DoePayload> DoeExchange(pci::Bdf bdf, pci::ConfigOffset doe_offset,
+                                              pci::DoeProtocolId protocol,
+                                              const pci::DoePayload& request) override;
+
+private:
+    Device& device_;
+    TransactionPort& port_;
+};
+
+class ProxyPciBar : public pci::PciBar {
+public:
+    ProxyPciBar(Device& device, TransactionPort& port) : device_(device), port_(port) {}
+
+    Device* GetDevice() override { return &device_; }
+    core::Result<core::DWord> BarRead32(pci::Bdf bdf, uint8_t bar_index,
+                                        uint64_t offset) override;
+    core::Result<core::QWord> BarRead64(pci::Bdf bdf, uint8_t bar_index,
+                                        uint64_t offset) override;
+    core::Result<void> BarWrite32(pci::Bdf bdf, uint8_t bar_index, uint64_t offset,
+                                  core::DWord value) override;
+    core::Result<void> BarWrite64(pci::Bdf bdf, uint8_t bar_index, uint64_t offset,
+                                  core::QWord value) override;
+    core::Result<void> BarReadBuffer(pci::Bdf bdf, uint8_t bar_index, uint64_t offset,
+                                     void* buffer, std::size_t length) override;
+    core::Result<void> BarWriteBuffer(pci::Bdf bdf, uint8_t bar_index, uint64_t offset,
+                                      const void* buffer, std::size_t length) override;
+    /// Mapping mode only affects local MMIO; any mode is accepted.
+    core::Result<void> SetBarMapping(pci::Bdf, uint8_t, pci::BarMapping) override {
+        return core::Result<void>::Ok();
+    }
+
+private:
+    Device& device_;
+    TransactionPort& port_;
+};
+
+/// Placeholder base for an interface the proxy does not expose.
+template <int kSlot>
+struct ProxyAbsent {
+    ProxyAbsent(Device&, TransactionPort&) {}
+};
+
+template <uint32_t kInterfaces, InterfaceKind kKind, typename T, int kSlot>
+using ProxyPart = std::conditional_t<((kInterfaces >> static_cast<uint32_t>(kKind)) & 1u) != 0,
+                                     T, ProxyAbsent<kSlot>>;
+
+/// `Base` (a Device and TransactionPort) plus one proxy interface per
+/// InterfaceKind bit in `kInterfaces`.
+template <typename Base, uint32_t kInterfaces>
+class TransactionProxy final
+    : public Base,
+      public ProxyPart<kInterfaces, InterfaceKind::kI2c, ProxyI2c, 0>,
+      public ProxyPart<kInterfaces, InterfaceKind::kPciConfig, ProxyPciConfig, 1>,
+      public ProxyPart<kInterfaces, InterfaceKind::kPciDoe, ProxyPciDoe, 2>,
+      public ProxyPart<kInterfaces, InterfaceKind::kPciBar, ProxyPciBar, 3> {
+public:
+    template <typename... Args>
+    explicit TransactionProxy(Args&&... args)
+        : Base(std::forward<Args>(args)...),
+          ProxyPart<kInterfaces, InterfaceKind::kI2c, ProxyI2c, 0>(*this, *this),
+          ProxyPart<kInterfaces, InterfaceKind::kPciConfig, ProxyPciConfig, 1>(*this, *this),
+          ProxyPart<kInterfaces, InterfaceKind::kPciDoe, ProxyPciDoe, 2>(*this, *this),
+          ProxyPart<kInterfaces, InterfaceKind::kPciBar, ProxyPciBar, 3>(*this, *this) {}
+};
+
+inline constexpr uint32_t kProxyInterfaces[] = {
+    1u << static_cast<uint32_t>(InterfaceKind::kI2c),
+    1u << static_cast<uint32_t>(InterfaceKind::kPciConfig),
+    1u << static_cast<uint32_t>(InterfaceKind::kPciDoe),
+    1u << static_cast<uint32_t>(InterfaceKind::kPciBar),
+};
+
+/// InterfaceKind bits of combination `index` (bit i of index = interface i
+/// of kProxyInterfaces).
+constexpr uint32_t ProxyCombination(std::size_t index) {
+    uint32_t bits = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        if ((index >> i) & 1u) bits |= kProxyInterfaces[i];
+    }
+    return bits;
+}
+
+template <typename Base, std::size_t... kIndex, typename... Args>
+std::unique_ptr<Device> MakeProxyOf(std::size_t index, std::index_sequence<kIndex...>,
+                                    Args&&... args) {
+    std::unique_ptr<Device> device;
+    // Exactly one alternative matches, so the arguments are forwarded once.
+    (void)((index == kIndex &&
+            (device = std::make_unique<TransactionProxy<Base, ProxyCombination(kIndex)>>(
+                 std::forward<Args>(args)...),
+             true)) ||
+           ...);
+    return device;
+}
+
+}  // namespace detail
+
+/// Construct `Base(args...)` — a Device that is also a TransactionPort —
+/// extended with the I2c / PciConfig / PciDoe / PciBar interfaces named in
+/// `interfaces` (InterfaceKind bits; other bits are ignored). Each of those
+/// calls becomes a TraceRecord handed to the object's Execute().
+template <typename Base, typename... Args>
+std::unique_ptr<Device> MakeTransactionProxy(uint32_t interfaces, Args&&... args) {
+    static_assert(std::is_base_of_v<Device, Base> && std::is_base_of_v<TransactionPort, Base>);
+    std::size_t index = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        if (interfaces & detail::kProxyInterfaces[i]) index |= std::size_t{1} << i;
+    }
+    return detail::MakeProxyOf<Base>(index, std::make_index_sequence<16>(),
+                                     std::forward<Args>(args)...);
+}
+
+}  // namespace plas::hal
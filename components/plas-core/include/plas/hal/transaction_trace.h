@@ -0,0 +1,187 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+#include "plas/hal/interface/interface_kind.h"
+
+namespace plas::hal {
+
+class Device;
+
+/// HAL call captured in a transaction trace.
+enum class TraceOp : uint8_t {
+    kI2cRead = 0,
+    kI2cWrite,
+    kI2cWriteRead,
+    kConfigRead8,
+    kConfigRead16,
+    kConfigRead32,
+    kConfigWrite8,
+    kConfigWrite16,
+    kConfigWrite32,
+    kConfigReadBlock,
+    kFindCapability,
+    kFindExtCapability,
+    kDoeDiscover,
+    kDoeExchange,
+    kBarRead32,
+    kBarRead64,
+    kBarWrite32,
+    kBarWrite64,
+    kBarReadBuffer,
+    kBarWriteBuffer,
+    kI2cSetBitrate,
+    kCount,  // number of operations, not an operation
+};
+
+const char* ToString(TraceOp op);
+
+/// A recorded device: identity plus the interfaces it implemented.
+struct TraceDevice {
+    std::string name;
+    std::string uri;
+    std::string driver;
+    uint32_t interfaces = 0;  ///< bit (1 << InterfaceKind) per interface
+
+    bool Has(InterfaceKind kind) const {
+        return (interfaces >> static_cast<uint32_t>(kind)) & 1u;
+    }
+};
+
+/// One HAL call. Fields an operation does not use are zero.
+///
+///   op                 target   offset   arg          length  value       request   response
+///   I2cRead            addr     -        stop         length  bytes read  -         data
+///   I2cWrite           addr     -        stop         -       bytes sent  data      -
+///   I2cWriteRead       addr     -        -            length  bytes read  data      data
+///   ConfigRead8/16/32  bdf      offset   -            -       value       -         -
+///   ConfigWrite8/16/32 bdf      offset   -            -       value       -         -
+///   ConfigReadBlock    bdf      offset   -            length  -           -         data
+///   Find(Ext)Cap.      bdf      -        cap ID       -       offset|~0   -         -
+///   DoeDiscover        bdf      offset   -            -       -           -         vendor|type<<16 DWords
+///   DoeExchange        bdf      offset   vendor|type<<16 -    -           DWords    DWords
+///   BarRead32/64       bdf      offset   bar          -       value       -         -
+///   BarWrite32/64      bdf      offset   bar          -       value       -         -
+///   BarReadBuffer      bdf      offset   bar          length  -           -         data
+///   BarWriteBuffer     bdf      offset   bar          -       -           data      -
+///   I2cSetBitrate      -        -        -            -       bitrate     -         -
+///
+/// `bdf` is Bdf::Pack(); DWords are stored little-endian. A failed call
+/// keeps its inputs and has `error` set; its outputs are empty.
+struct TraceRecord {
+    uint32_t device = 0;  ///< index into TraceFile::devices
+    TraceOp op = TraceOp::kI2cRead;
+    core::ErrorCode error = core::ErrorCode::kSuccess;
+    uint64_t start_ns = 0;  ///< since the TraceWriter was opened
+    uint64_t duration_ns = 0;
+    uint64_t target = 0;
+    uint64_t offset = 0;
+    uint64_t arg = 0;
+    uint64_t length = 0;
+    uint64_t value = 0;
+    std::vector<core::Byte> request;
+    std::vector<core::Byte> response;
+};
+
+/// Value of TraceRecord::value for a capability that was not found.
+inline constexpr uint64_t kTraceNoCapability = ~uint64_t{0};
+
+/// DWord payloads (DOE) as stored in TraceRecord::request/response.
+std::vector<core::Byte> EncodeTraceDWords(const core::DWord* data, std::size_t count);
+std::vector<core::DWord> DecodeTraceDWords(const std::vector<core::Byte>& bytes);
+
+// ---------------------------------------------------------------------------
+// TraceWriter
+// ---------------------------------------------------------------------------
+
+/// Appends devices and records to a binary trace file. Thread-safe; records
+/// are encoded into a buffer under a mutex and written out in 64 KiB
+/// blocks, so a crashed session loses at most the unflushed tail.
+///
+/// File layout: "PLASTRC" '\0', format version, then a sequence of device
+/// ('D') and record ('R') entries. Integers are LEB128 varints; record start
+/// times are zigzag deltas from the previous record.
+class TraceWriter {
+public:
+    static constexpr uint32_t kFormatVersion = 1;
+
+    /// Create (truncate) `path`. kIOError if it cannot be opened.
+    static core::Result<std::shared_ptr<TraceWriter>> Open(const std::string& path);
+
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    /// Declare a device; returns its index for TraceRecord::device.
+    uint32_t AddDevice(const TraceDevice& device);
+
+    void Write(const TraceRecord& record);
+
+    /// Nanoseconds since Open(); the time base of TraceRecord::start_ns.
+    uint64_t Now() const;
+
+    /// Write buffered entries to the file. kIOError once any write failed.
+    core::Result<void> Flush();
+
+    uint64_t RecordCount() const;
+
+private:
+    explicit TraceWriter(std::FILE* file);
+    void FlushLocked();
+
+    std::FILE* file_;
+    const std::chrono::steady_clock::time_point epoch_;
+    mutable std::mutex mutex_;
+    std::vector<uint8_t> buffer_;
+    uint32_t device_count_ = 0;
+    uint64_t record_count_ = 0;
+    uint64_t last_start_ns_ = 0;
+    bool failed_ = false;
+};
+
+// ---------------------------------------------------------------------------
+// TraceFile
+// ---------------------------------------------------------------------------
+
+/// A trace read back into memory.
+struct TraceFile {
+    std::vector<TraceDevice> devices;
+    std::vector<TraceRecord> records;  ///< in the order they completed
+
+    /// kNotFound if `path` cannot be read, kDataLoss if it is not a trace
+    /// or an entry is malformed. A truncated final entry (an interrupted
+    /// recording) is dropped silently.
+    static core::Result<TraceFile> Load(const std::string& path);
+
+    /// Index of the device named `name`, or -1.
+    int FindDevice(const std::string& name) const;
+};
+
+// ---------------------------------------------------------------------------
+// Recording
+// ---------------------------------------------------------------------------
+
+/// Wrap `device` so every I2c, PciConfig, PciDoe and PciBar call is
+/// timed and written to `writer`, then forwarded. The wrapper implements
+/// exactly those of the four interfaces the device does, and forwards the
+/// Device lifecycle; other interfaces (I3c, Serial, Cxl, ...) are not
+/// exposed through it. A device with none of the four is returned as is.
+///
+/// Default-implemented calls (I2c::Transfer, PciConfig::SnapshotConfig,
+/// PciDoe::DoeExchangeInto, ...) are recorded as the primitive calls they
+/// are made of, so a replay can serve them too.
+std::unique_ptr<Device> RecordTransactions(std::unique_ptr<Device> device,
+                                           std::shared_ptr<TraceWriter> writer);
+
+}  // namespace plas::hal
@@ -7,13 +7,40 @@
 
 namespace plas::log {
 
+/// What an async logger does when its queue is full.
+enum class LogOverflowPolicy {
+    kBlock,       ///< caller waits for space (no loss)
+    kDropOldest,  ///< discard the oldest queued message
+    kDropNewest,  ///< discard the message being logged
+};
+
+/// How the log file is written and rotated.
+enum class LogFileMode {
+    kDirect,      ///< the logging call writes and rotates (spdlog rotating sink)
+    kBackground,  ///< buffered; a writer thread writes, preallocates and rotates
+};
+
 struct LogConfig {
     std::string log_dir = "logs";
     std::string file_prefix = "plas";
     std::size_t max_file_size = 10 * 1024 * 1024;  // 10 MB
     std::size_t max_files = 5;
+    LogFileMode file_mode = LogFileMode::kDirect;
+    std::size_t file_buffer_size = 256 * 1024;  // kBackground: bytes per write
     LogLevel level = LogLevel::kInfo;
     bool console_enabled = true;
+
+    /// Hand messages to a background writer thread instead of writing to
+    /// the sinks on the calling thread.
+    bool async_enabled = false;
+    std::size_t async_queue_size = 8192;  // rounded up to a power of two
+    LogOverflowPolicy overflow_policy = LogOverflowPolicy::kBlock;
+
+    /// Repeated identical messages: log the first, then 1 of every
+    /// `repeat_sample_every`, each carrying the number suppressed before it.
+    /// A run ends after `repeat_window_ms` without the message. 0 or 1: off.
+    std::size_t repeat_sample_every = 0;
+    std::size_t repeat_window_ms = 10000;
 };
 
 }  // namespace plas::log
@@ -1,17 +1,84 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "plas/log/log_config.h"
 #include "plas/log/log_level.h"
 
 namespace plas::log {
 
+/// Messages discarded since Init(): by the async overflow policy, and as
+/// repeats by LogConfig::repeat_sample_every.
+struct LogDropStats {
+    uint64_t dropped_oldest = 0;
+    uint64_t dropped_newest = 0;
+    uint64_t suppressed_repeats = 0;
+};
+
 class Logger {
 public:
+    /// The process-wide logger.
     static Logger& GetInstance();
 
+    /// The logger the PLAS_LOG_* macros write to on this thread: the one
+    /// installed by a live ScopedCurrent, else GetInstance().
+    static Logger& Current();
+
+    /// Routes the calling thread's PLAS_LOG_* output to `logger` for its
+    /// lifetime (nestable), so a tenant with its own Logger keeps its
+    /// messages apart. Threads the library starts itself (executors,
+    /// monitors) keep logging to GetInstance().
+    class ScopedCurrent {
+    public:
+        explicit ScopedCurrent(Logger& logger);
+        ~ScopedCurrent();
+        ScopedCurrent(const ScopedCurrent&) = delete;
+        ScopedCurrent& operator=(const ScopedCurrent&) = delete;
+
+    private:
+        Logger* previous_;
+    };
+
+    /// Holds the calling thread's messages, to whichever logger, in
+    /// pre-reserved storage for its lifetime (nestable) and writes them in
+    /// order when it ends, so a timing-critical section takes no sink lock
+    /// and no file I/O. The level is still checked when a message is
+    /// logged. Messages past `capacity`, or longer than the reserved
+    /// `reserve_chars`, are written at once as usual.
+    class DeferScope {
+    public:
+        explicit DeferScope(std::size_t capacity = 256, std::size_t reserve_chars = 160);
+        ~DeferScope();
+        DeferScope(const DeferScope&) = delete;
+        DeferScope& operator=(const DeferScope&) = delete;
+
+        /// Messages held so far.
+        std::size_t Held() const { return used_; }
+
+    private:
+        friend class Logger;
+        struct Entry {
+            Logger* logger = nullptr;
+            LogLevel level = LogLevel::kInfo;
+            std::string text;
+        };
+
+        bool Hold(Logger& logger, LogLevel level, const std::string& text);
+
+        std::vector<Entry> entries_;
+        std::size_t used_ = 0;
+        DeferScope* previous_;
+    };
+
+    /// A logger independent of GetInstance(), with its own level, sinks
+    /// and async writer. Init() it with its own log_dir/file_prefix.
+    Logger();
+    ~Logger();
+
     /// Initialize the logger with the given configuration.
     /// Must be called before any logging occurs.
     void Init(const LogConfig& config);
@@ -25,9 +92,47 @@ public:
     /// Return the path to the current log file.
     std::string GetCurrentLogFile() const;
 
+    /// True if a message at `level` would be emitted. The PLAS_LOG_* macros
+    /// check this before building their message.
+    bool ShouldLog(LogLevel level) const;
+
     /// Core logging method. Messages below the current level are discarded.
     void Log(LogLevel level, const std::string& msg);
 
+    // --- Per-device levels ---
+
+    /// Level for the messages of one device (by nickname), or of one of its
+    /// interfaces when `interface_name` is not empty, in place of the
+    /// global level: lower it to debug one device, raise it to quiet one.
+    /// An interface level wins over its device's. Takes effect at once and
+    /// survives Init().
+    void SetDeviceLevel(const std::string& device, LogLevel level,
+                        const std::string& interface_name = "");
+    void ClearDeviceLevel(const std::string& device,
+                          const std::string& interface_name = "");
+    void ClearDeviceLevels();
+
+    /// Level that applies to `device`/`interface_name`.
+    LogLevel GetDeviceLevel(std::string_view device,
+                            std::string_view interface_name = {}) const;
+
+    /// ShouldLog() for a message of `device`/`interface_name`.
+    bool ShouldLog(LogLevel level, std::string_view device,
+                   std::string_view interface_name = {}) const;
+
+    /// Log `msg` as "[device][interface] msg" if the device's level allows
+    /// it. The PLAS_LOG_DEVICE_* macros call this.
+    void Log(LogLevel level, std::string_view device,
+             std::string_view interface_name, const std::string& msg);
+
+    /// Block until every message logged so far has reached the sinks
+    /// (drains the async queue first when async mode is on).
+    void Flush();
+
+    /// Overflow drop counters (always zero in sync mode) and the number of
+    /// repeats suppressed.
+    LogDropStats GetDropStats() const;
+
     /// Convenience methods for each log level.
     void Trace(const std::string& msg);
     void Debug(const std::string& msg);
@@ -36,16 +141,20 @@ public:
     void Error(const std::string& msg);
     void Critical(const std::string& msg);
 
-    // Not copyable or movable (singleton).
+    // Not copyable or movable.
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
     Logger(Logger&&) = delete;
     Logger& operator=(Logger&&) = delete;
 
-private:
-    Logger();
-    ~Logger();
+    /// printf-style formatting for the PLAS_LOG_*F macros.
+    static std::string Format(const char* fmt, ...)
+#if defined(__GNUC__) || defined(__clang__)
+        __attribute__((format(printf, 1, 2)))
+#endif
+        ;
 
+private:
     struct Impl;
     std::unique_ptr<Impl> impl_;
 };
@@ -54,10 +163,118 @@ private:
 
 // ---------------------------------------------------------------------------
 // Convenience macros
+//
+// The message argument is only evaluated when the level is enabled, so
+// string concatenation in a disabled PLAS_LOG_DEBUG costs nothing.
+// The *F variants take a printf-style format and arguments.
+// PLAS_LOG_DEVICE_*(device, interface, msg) apply the device's level
+// (Logger::SetDeviceLevel) and prefix "[device][interface] ".
+//
+// Levels below PLAS_LOG_COMPILED_LEVEL (CMake option of the same name,
+// values match LogLevel) are removed at compile time; the argument stays
+// in an unevaluated sizeof so it is still type-checked.
 // ---------------------------------------------------------------------------
-#define PLAS_LOG_TRACE(msg)    ::plas::log::Logger::GetInstance().Trace(msg)
-#define PLAS_LOG_DEBUG(msg)    ::plas::log::Logger::GetInstance().Debug(msg)
-#define PLAS_LOG_INFO(msg)     ::plas::log::Logger::GetInstance().Info(msg)
-#define PLAS_LOG_WARN(msg)     ::plas::log::Logger::GetInstance().Warn(msg)
-#define PLAS_LOG_ERROR(msg)    ::plas::log::Logger::GetInstance().Error(msg)
-#define PLAS_LOG_CRITICAL(msg) ::plas::log::Logger::GetInstance().Critical(msg)
+#define PLAS_LOG_LEVEL_TRACE    0
+#define PLAS_LOG_LEVEL_DEBUG    1
+#define PLAS_LOG_LEVEL_INFO     2
+#define PLAS_LOG_LEVEL_WARN     3
+#define PLAS_LOG_LEVEL_ERROR    4
+#define PLAS_LOG_LEVEL_CRITICAL 5
+#define PLAS_LOG_LEVEL_OFF      6
+
+#ifndef PLAS_LOG_COMPILED_LEVEL
+#define PLAS_LOG_COMPILED_LEVEL PLAS_LOG_LEVEL_TRACE
+#endif
+
+#define PLAS_LOG_DISCARD(msg) \
+    do {                      \
+        (void)sizeof(msg);    \
+    } while (0)
+
+#define PLAS_LOG_AT(level, msg)                                      \
+    do {                                                             \
+        auto& plas_log_logger_ = ::plas::log::Logger::Current();     \
+        if (plas_log_logger_.ShouldLog(level)) {                     \
+            plas_log_logger_.Log(level, msg);                        \
+        }                                                            \
+    } while (0)
+
+#define PLAS_LOG_DEVICE_AT(level, device, iface, msg)                        \
+    do {                                                                     \
+        auto& plas_log_logger_ = ::plas::log::Logger::Current();             \
+        if (plas_log_logger_.ShouldLog(level, device, iface)) {              \
+            plas_log_logger_.Log(level, device, iface, msg);                 \
+        }                                                                    \
+    } while (0)
+
+#if PLAS_LOG_COMPILED_LEVEL <= PLAS_LOG_LEVEL_TRACE
+#define PLAS_LOG_TRACE(msg) PLAS_LOG_AT(::plas::log::LogLevel::kTrace, msg)
+#define PLAS_LOG_TRACEF(...) \
+    PLAS_LOG_AT(::plas::log::LogLevel::kTrace, ::plas::log::Logger::Format(__VA_ARGS__))
+#define PLAS_LOG_DEVICE_TRACE(device, iface, msg) \
+    PLAS_LOG_DEVICE_AT(::plas::log::LogLevel::kTrace, device, iface, msg)
+#else
+#define PLAS_LOG_TRACE(msg)  PLAS_LOG_DISCARD(msg)
+#define PLAS_LOG_TRACEF(...) PLAS_LOG_DISCARD(::plas::log::Logger::Format(__VA_ARGS__))
+#define PLAS_LOG_DEVICE_TRACE(device, iface, msg) PLAS_LOG_DISCARD(msg)
+#endif
+
+#if PLAS_LOG_COMPILED_LEVEL <= PLAS_LOG_LEVEL_DEBUG
+#define PLAS_LOG_DEBUG(msg) PLAS_LOG_AT(::plas::log::LogLevel::kDebug, msg)
+#define PLAS_LOG_DEBUGF(...) \
+    PLAS_LOG_AT(::plas::log::LogLevel::kDebug, ::plas::log::Logger::Format(__VA_ARGS__))
+#define PLAS_LOG_DEVICE_DEBUG(device, iface, msg) \
+    PLAS_LOG_DEVICE_AT(::plas::log::LogLevel::kDebug, device, iface, msg)
+#else
+#define PLAS_LOG_DEBUG(msg)  PLAS_LOG_DISCARD(msg)
+#define PLAS_LOG_DEBUGF(...) PLAS_LOG_DISCARD(::plas::log::Logger::Format(__VA_ARGS__))
+#define PLAS_LOG_DEVICE_DEBUG(device, iface, msg) PLAS_LOG_DISCARD(msg)
+#endif
+
+#if PLAS_LOG_COMPILED_LEVEL <= PLAS_LOG_LEVEL_INFO
+#define PLAS_LOG_INFO(msg) PLAS_LOG_AT(::plas::log::LogLevel::kInfo, msg)
+#define PLAS_LOG_INFOF(...) \
+    PLAS_LOG_AT(::plas::log::LogLevel::kInfo, ::plas::log::Logger::Format(__VA_ARGS__))
+#define PLAS_LOG_DEVICE_INFO(device, iface, msg) \
+    PLAS_LOG_DEVICE_AT(::plas::log::LogLevel::kInfo, device, iface, msg)
+#else
+#define PLAS_LOG_INFO(msg)  PLAS_LOG_DISCARD(msg)
+#define PLAS_LOG_INFOF(...) PLAS_LOG_DISCARD(::plas::log::Logger::Format(__VA_ARGS__))
+#define PLAS_LOG_DEVICE_INFO(device, iface, msg) PLAS_LOG_DISCARD(msg)
+#endif
+
+#if PLAS_LOG_COMPILED_LEVEL <= PLAS_LOG_LEVEL_WARN
+#define PLAS_LOG_WARN(msg) PLAS_LOG_AT(::plas::log::LogLevel::kWarn, msg)
+#define PLAS_LOG_WARNF(...) \
+    PLAS_LOG_AT(::plas::log::LogLevel::kWarn, ::plas::log::Logger::Format(__VA_ARGS__))
+#define PLAS_LOG_DEVICE_WARN(device, iface, msg) \
+    PLAS_LOG_DEVICE_AT(::plas::log::LogLevel::kWarn, device, iface, msg)
+#else
+#define PLAS_LOG_WARN(msg)  PLAS_LOG_DISCARD(msg)
+#define PLAS_LOG_WARNF(...) PLAS_LOG_DISCARD(::plas::log::Logger::Format(__VA_ARGS__))
+#define PLAS_LOG_DEVICE_WARN(device, iface, msg) PLAS_LOG_DISCARD(msg)
+#endif
+
+#if PLAS_LOG_COMPILED_LEVEL <= PLAS_LOG_LEVEL_ERROR
+#define PLAS_LOG_ERROR(msg) PLAS_LOG_AT(::plas::log::LogLevel::kError, msg)
+#define PLAS_LOG_ERRORF(...) \
+    PLAS_LOG_AT(::plas::log::LogLevel::kError, ::plas::log::Logger::Format(__VA_ARGS__))
+#define PLAS_LOG_DEVICE_ERROR(device, iface, msg) \
+    PLAS_LOG_DEVICE_AT(::plas::log::LogLevel::kError, device, iface, msg)
+#else
+#define PLAS_LOG_ERROR(msg)  PLAS_LOG_DISCARD(msg)
+#define PLAS_LOG_ERRORF(...) PLAS_LOG_DISCARD(::plas::log::Logger::Format(__VA_ARGS__))
+#define PLAS_LOG_DEVICE_ERROR(device, iface, msg) PLAS_LOG_DISCARD(msg)
+#endif
+
+#if PLAS_LOG_COMPILED_LEVEL <= PLAS_LOG_LEVEL_CRITICAL
+#define PLAS_LOG_CRITICAL(msg) PLAS_LOG_AT(::plas::log::LogLevel::kCritical, msg)
+#define PLAS_LOG_CRITICALF(...) \
+    PLAS_LOG_AT(::plas::log::LogLevel::kCritical, ::plas::log::Logger::Format(__VA_ARGS__))
+#define PLAS_LOG_DEVICE_CRITICAL(device, iface, msg) \
+    PLAS_LOG_DEVICE_AT(::plas::log::LogLevel::kCritical, device, iface, msg)
+#else
+#define PLAS_LOG_CRITICAL(msg)  PLAS_LOG_DISCARD(msg)
+#define PLAS_LOG_CRITICALF(...) PLAS_LOG_DISCARD(::plas::log::Logger::Format(__VA_ARGS__))
+#define PLAS_LOG_DEVICE_CRITICAL(device, iface, msg) PLAS_LOG_DISCARD(msg)
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Backend for system-wide timelines, chosen by the PLAS_SYSTEM_TRACE CMake
+// cache variable (PUBLIC on plas_log): 0 none, 1 Perfetto SDK, 2 LTTng-UST.
+#ifndef PLAS_SYSTEM_TRACE
+#define PLAS_SYSTEM_TRACE 0
+#endif
+
+namespace plas::log {
+
+struct TraceRecord;
+
+/// False when built without a system trace backend; TraceSpan then
+/// compiles the calls below out entirely.
+inline constexpr bool kSystemTraceCompiled = PLAS_SYSTEM_TRACE != 0;
+
+/// Begin/end events for every TraceSpan, emitted to the platform tracer so
+/// HAL transactions line up with kernel scheduling and USB activity in one
+/// timeline. Independent of the Tracer ring file: either, both or neither
+/// can be recording.
+///
+/// Perfetto: track events in category "plas" on the calling thread's
+/// track, named after the interface ("i2c", "pci-config", ...) with device,
+/// op, address and bytes as arguments; the process connects to the system
+/// `traced` service. LTTng-UST: tracepoints plas:transaction_begin and
+/// plas:transaction_end.
+class SystemTrace {
+public:
+    /// "none", "perfetto" or "lttng".
+    static const char* Backend();
+
+    /// Connect to the system tracing service. Idempotent, and done
+    /// implicitly by the first Tracer::RegisterDevice(); no-op without a
+    /// backend.
+    static void Initialize();
+
+    /// True while a system trace session is recording plas events.
+    static bool IsActive();
+
+    /// Name used for `id` in events. Called by Tracer::RegisterDevice().
+    static void NameDevice(uint16_t id, const std::string& name);
+
+    /// Emit the begin event of `record` (interface, op, address, length,
+    /// target, device) and the matching end event (status, final length).
+    /// Both on the same thread.
+    static void Begin(const TraceRecord& record);
+    static void End(const TraceRecord& record);
+};
+
+}  // namespace plas::log
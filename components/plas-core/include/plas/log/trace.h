@@ -0,0 +1,231 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <system_error>
+
+#include "plas/core/result.h"
+#include "plas/log/system_trace.h"
+
+namespace plas::log {
+
+// ---------------------------------------------------------------------------
+// On-disk format
+//
+// A trace file is a TraceFileHeader followed by `capacity` TraceRecord
+// slots used as a ring. Record N (0-based, counting every record ever
+// written) lives in slot N % capacity and carries sequence N + 1; a slot
+// whose sequence does not match is empty or was being overwritten.
+// All fields are little-endian host order.
+// ---------------------------------------------------------------------------
+
+inline constexpr char kTraceMagic[8] = {'P', 'L', 'A', 'S', 'T', 'R', 'C', '\0'};
+inline constexpr uint32_t kTraceFormatVersion = 1;
+inline constexpr std::size_t kTraceMaxDevices = 64;
+inline constexpr std::size_t kTraceDeviceNameSize = 32;
+
+/// Bus/interface a record belongs to.
+enum class TraceInterface : uint8_t {
+    kUnknown = 0,
+    kI2c,
+    kI3c,
+    kSpi,
+    kUart,
+    kPciConfig,
+    kPciBar,
+    kPciDoe,
+};
+
+/// Transaction kind.
+enum class TraceOp : uint8_t {
+    kUnknown = 0,
+    kRead,
+    kWrite,
+    kWriteRead,
+    kExchange,
+};
+
+const char* ToString(TraceInterface iface);
+const char* ToString(TraceOp op);
+
+/// One bus transaction (48 bytes, fixed layout).
+struct TraceRecord {
+    uint64_t sequence;      ///< record index + 1 (0 = empty slot)
+    uint64_t timestamp_ns;  ///< start time, system_clock since epoch
+    uint64_t address;       ///< I2C target address, config/BAR offset
+    uint32_t duration_ns;   ///< saturates at UINT32_MAX
+    uint32_t length;        ///< bytes transferred (DOE: request DWords)
+    uint32_t extra;         ///< BAR index / DOE protocol (interface-specific)
+    uint16_t device_id;     ///< index into TraceFileHeader::device_names + 1
+    uint16_t target;        ///< PCI: Bdf::Pack(); otherwise 0
+    uint16_t status;        ///< core::ErrorCode value, 0 = success
+    uint8_t  interface;     ///< TraceInterface
+    uint8_t  op;            ///< TraceOp
+    uint32_t reserved;
+};
+static_assert(sizeof(TraceRecord) == 48, "TraceRecord layout is fixed");
+
+struct TraceFileHeader {
+    char     magic[8];          ///< kTraceMagic
+    uint32_t version;           ///< kTraceFormatVersion
+    uint32_t record_size;       ///< sizeof(TraceRecord)
+    uint64_t capacity;          ///< number of record slots
+    uint64_t write_index;       ///< records written so far (all time)
+    uint64_t start_time_ns;     ///< Tracer::Open() time, system_clock
+    uint32_t device_count;
+    uint32_t reserved;
+    char     device_names[kTraceMaxDevices][kTraceDeviceNameSize];
+};
+static_assert(sizeof(TraceFileHeader) % alignof(TraceRecord) == 0,
+              "records must start aligned after the header");
+
+// ---------------------------------------------------------------------------
+// Tracer
+// ---------------------------------------------------------------------------
+
+struct TraceConfig {
+    std::string path = "logs/plas.trace";
+    std::size_t capacity = 65536;  // records (~3 MB file)
+};
+
+/// Binary transaction trace written into a memory-mapped ring file.
+///
+/// Recording is lock-free and allocation-free: a writer claims a slot with
+/// one atomic increment and copies its record into the mapping. The file
+/// size is fixed at Open(), so tracing can stay on indefinitely; the OS
+/// writes dirty pages back and the file survives a crash of the process.
+/// When no trace is open, TraceSpan costs one relaxed atomic load.
+class Tracer {
+public:
+    static Tracer& GetInstance();
+
+    /// Create (or truncate) the trace file and start recording.
+    /// Returns kAlreadyOpen if a trace is already open.
+    core::Result<void> Open(const TraceConfig& config);
+
+    /// Stop recording and unmap the file. Waits for in-flight writers.
+    void Close();
+
+    bool IsEnabled() const {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    /// Return a stable id (1-based) for `name`, adding it to the device
+    /// table. May be called before Open(); the table is copied into each
+    /// new trace file. Returns 0 once kTraceMaxDevices names are taken.
+    uint16_t RegisterDevice(const std::string& name);
+
+    /// Append `record` (its sequence field is overwritten). No-op when
+    /// tracing is disabled.
+    void Record(const TraceRecord& record);
+
+    /// Records written since Open().
+    uint64_t GetRecordCount() const;
+
+    std::string GetPath() const;
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+    Tracer(Tracer&&) = delete;
+    Tracer& operator=(Tracer&&) = delete;
+
+private:
+    Tracer();
+    ~Tracer();
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<uint32_t> writers_{0};  // Record() calls inside the mapping
+
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// ---------------------------------------------------------------------------
+// TraceSpan — times one transaction and records it on destruction
+// ---------------------------------------------------------------------------
+
+/// Usage inside a driver:
+///
+///     log::TraceSpan span(trace_id_, log::TraceInterface::kI2c,
+///                         log::TraceOp::kRead, addr, length);
+///     int rc = sdk_read(...);
+///     if (rc < 0) span.SetStatus(err);
+///
+/// Nothing is captured if neither the Tracer nor a system trace session
+/// (SystemTrace::IsActive()) was recording when the span was created.
+/// Without a system trace backend that check compiles away.
+class TraceSpan {
+public:
+    TraceSpan(uint16_t device_id, TraceInterface iface, TraceOp op,
+              uint64_t address, std::size_t length, uint16_t target = 0,
+              uint32_t extra = 0) {
+        file_ = Tracer::GetInstance().IsEnabled();
+        if constexpr (kSystemTraceCompiled) {
+            system_ = SystemTrace::IsActive();
+        }
+        if (!file_ && !system_) {
+            return;
+        }
+        record_.timestamp_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch())
+                .count());
+        record_.address = address;
+        record_.length = static_cast<uint32_t>(length);
+        record_.extra = extra;
+        record_.device_id = device_id;
+        record_.target = target;
+        record_.interface = static_cast<uint8_t>(iface);
+        record_.op = static_cast<uint8_t>(op);
+        if constexpr (kSystemTraceCompiled) {
+            if (system_) {
+                SystemTrace::Begin(record_);
+            }
+        }
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    ~TraceSpan() {
+        if (!file_ && !system_) {
+            return;
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start_)
+                      .count();
+        record_.duration_ns =
+            ns > static_cast<int64_t>(UINT32_MAX) ? UINT32_MAX
+                                                  : static_cast<uint32_t>(ns);
+        if (file_) {
+            Tracer::GetInstance().Record(record_);
+        }
+        if constexpr (kSystemTraceCompiled) {
+            if (system_) {
+                SystemTrace::End(record_);
+            }
+        }
+    }
+
+    void SetStatus(std::error_code error) {
+        record_.status = static_cast<uint16_t>(error.value());
+    }
+
+    /// Override the length given at construction (e.g. short reads).
+    void SetLength(std::size_t length) {
+        record_.length = static_cast<uint32_t>(length);
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    bool file_ = false;
+    bool system_ = false;  // stays false without a backend
+    TraceRecord record_{};
+    std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace plas::log
@@ -0,0 +1,528 @@
+#include "compiled_config.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+
+#include "plas/config/config_cache.h"
+
+namespace plas::config {
+
+namespace {
+
+struct CacheState {
+    std::mutex mutex;
+    std::string directory;
+    bool env_checked = false;
+    std::atomic<size_t> hits{0};
+    std::atomic<size_t> misses{0};
+    std::atomic<size_t> writes{0};
+};
+
+CacheState& State() {
+    static CacheState state;
+    return state;
+}
+
+}  // namespace
+
+void ConfigCache::SetDirectory(const std::string& dir) {
+    auto& state = State();
+    std::lock_guard lock(state.mutex);
+    state.directory = dir;
+    state.env_checked = true;
+}
+
+std::string ConfigCache::Directory() {
+    auto& state = State();
+    std::lock_guard lock(state.mutex);
+    if (!state.env_checked) {
+        if (const char* env = std::getenv("PLAS_CONFIG_CACHE_DIR")) {
+            state.directory = env;
+        }
+        state.env_checked = true;
+    }
+    return state.directory;
+}
+
+ConfigCache::Stats ConfigCache::GetStats() {
+    auto& state = State();
+    Stats stats;
+    stats.hits = state.hits.load(std::memory_order_relaxed);
+    stats.misses = state.misses.load(std::memory_order_relaxed);
+    stats.writes = state.writes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ConfigCache::ResetStats() {
+    auto& state = State();
+    state.hits.store(0, std::memory_order_relaxed);
+    state.misses.store(0, std::memory_order_relaxed);
+    state.writes.store(0, std::memory_order_relaxed);
+}
+
+namespace detail {
+
+namespace {
+
+constexpr size_t kHashChunkSize = 64 * 1024;
+
+std::string CachePath(const std::string& dir, const SourceKey& key,
+                      std::string_view tag) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%016" PRIx64 "-%016" PRIx64 ".plasc",
+                  key.hash, Fnv1a(tag));
+    return (std::filesystem::path(dir) / name).string();
+}
+
+// --- Reading ---
+
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            size_ = static_cast<size_t>(st.st_size);
+            void* base = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (base != MAP_FAILED) {
+                base_ = base;
+            }
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (base_ != nullptr) {
+            ::munmap(base_, size_);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* Data() const { return static_cast<const char*>(base_); }
+    size_t Size() const { return base_ != nullptr ? size_ : 0; }
+
+private:
+    void* base_ = nullptr;
+    size_t size_ = 0;
+};
+
+class StringSection {
+public:
+    StringSection(const char* data, uint64_t size) : data_(data), size_(size) {}
+
+    bool Get(CompiledString s, std::string_view& out) const {
+        if (static_cast<uint64_t>(s.offset) + s.size > size_) {
+            return false;
+        }
+        out = std::string_view(data_ + s.offset, s.size);
+        return true;
+    }
+
+private:
+    const char* data_;
+    uint64_t size_;
+};
+
+/// Map the compiled file for (key, tag), check its header and section
+/// bounds, then hand the sections to `decode`. Counts the hit or miss.
+template <typename Record, typename Item, typename Decode>
+bool ReadSections(const SourceKey& key, std::string_view tag,
+                  CompiledKind kind, Decode&& decode) {
+    auto& stats = State();
+    std::string dir = ConfigCache::Directory();
+    bool ok = false;
+    if (!dir.empty()) {
+        MappedFile file(CachePath(dir, key, tag));
+        const char* base = file.Data();
+        const auto* header = reinterpret_cast<const CompiledHeader*>(base);
+        if (file.Size() >= sizeof(CompiledHeader) &&
+            std::memcmp(header->magic, kCompiledMagic, sizeof(kCompiledMagic)) == 0 &&
+            header->version == kCompiledFormatVersion &&
+            header->kind == static_cast<uint32_t>(kind) &&
+            header->source_hash == key.hash &&
+            header->source_size == key.size &&
+            header->tag_hash == Fnv1a(tag)) {
+            uint64_t records_size =
+                static_cast<uint64_t>(header->record_count) * sizeof(Record);
+            uint64_t items_size =
+                static_cast<uint64_t>(header->item_count) * sizeof(Item);
+            uint64_t expected = sizeof(CompiledHeader) + records_size +
+                                items_size + header->string_bytes;
+            if (expected == file.Size()) {
+                const char* records = base + sizeof(CompiledHeader);
+                const char* items = records + records_size;
+                StringSection strings(items + items_size, header->string_bytes);
+                ok = decode(reinterpret_cast<const Record*>(records),
+                            header->record_count,
+                            reinterpret_cast<const Item*>(items),
+                            header->item_count, strings);
+            }
+        }
+    }
+    (ok ? stats.hits : stats.misses).fetch_add(1, std::memory_order_relaxed);
+    return ok;
+}
+
+bool InRange(uint32_t begin, uint32_t count, uint32_t total) {
+    return static_cast<uint64_t>(begin) + count <= total;
+}
+
+/// Visit each device as (nickname, uri, driver) followed by its args.
+template <typename BeginFn, typename ArgFn>
+bool DecodeDevices(const CompiledDevice* devices, uint32_t device_count,
+                   const CompiledArg* args, uint32_t arg_count,
+                   const StringSection& strings, BeginFn&& begin, ArgFn&& arg) {
+    for (uint32_t i = 0; i < device_count; ++i) {
+        const auto& device = devices[i];
+        std::string_view nickname;
+        std::string_view uri;
+        std::string_view driver;
+        if (!strings.Get(device.nickname, nickname) ||
+            !strings.Get(device.uri, uri) ||
+            !strings.Get(device.driver, driver) ||
+            !InRange(device.arg_begin, device.arg_count, arg_count)) {
+            return false;
+        }
+        begin(nickname, uri, driver);
+        for (uint32_t a = device.arg_begin; a < device.arg_begin + device.arg_count; ++a) {
+            std::string_view key;
+            std::string_view value;
+            if (!strings.Get(args[a].key, key) ||
+                !strings.Get(args[a].value, value)) {
+                return false;
+            }
+            arg(key, value);
+        }
+    }
+    return true;
+}
+
+// --- Writing ---
+
+class StringWriter {
+public:
+    CompiledString Add(std::string_view s) {
+        auto it = offsets_.find(std::string(s));
+        if (it != offsets_.end()) {
+            return it->second;
+        }
+        CompiledString ref{static_cast<uint32_t>(data_.size()),
+                           static_cast<uint32_t>(s.size())};
+        data_.append(s.data(), s.size());
+        offsets_.emplace(std::string(s), ref);
+        return ref;
+    }
+
+    const std::string& Data() const { return data_; }
+
+private:
+    std::string data_;
+    std::unordered_map<std::string, CompiledString> offsets_;
+};
+
+template <typename Record, typename Item>
+void WriteSections(const SourceKey& key, std::string_view tag,
+                   CompiledKind kind, const std::vector<Record>& records,
+                   const std::vector<Item>& items, const StringWriter& strings) {
+    std::string dir = ConfigCache::Directory();
+    if (dir.empty() ||
+        strings.Data().size() > std::numeric_limits<uint32_t>::max() ||
+        items.size() > std::numeric_limits<uint32_t>::max()) {
+        return;
+    }
+
+    CompiledHeader header{};
+    std::memcpy(header.magic, kCompiledMagic, sizeof(header.magic));
+    header.version = kCompiledFormatVersion;
+    header.kind = static_cast<uint32_t>(kind);
+    header.source_hash = key.hash;
+    header.source_size = key.size;
+    header.tag_hash = Fnv1a(tag);
+    header.record_count = static_cast<uint32_t>(records.size());
+    header.item_count = static_cast<uint32_t>(items.size());
+    header.string_bytes = strings.Data().size();
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+
+    // Write beside the target and rename: concurrent processes (or threads,
+    // hence the sequence number) compiling the same source never see a
+    // partial file.
+    static std::atomic<uint64_t> sequence{0};
+    std::string path = CachePath(dir, key, tag);
+    std::string tmp_path = path + ".tmp." + std::to_string(::getpid()) + "." +
+                           std::to_string(sequence.fetch_add(1, std::memory_order_relaxed));
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()),
+                  static_cast<std::streamsize>(records.size() * sizeof(Record)));
+        out.write(reinterpret_cast<const char*>(items.data()),
+                  static_cast<std::streamsize>(items.size() * sizeof(Item)));
+        out.write(strings.Data().data(),
+                  static_cast<std::streamsize>(strings.Data().size()));
+        if (!out.good()) {
+            out.close();
+            std::remove(tmp_path.c_str());
+            return;
+        }
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return;
+    }
+    State().writes.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename Bits>
+uint64_t ToBits(Bits value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(value));
+    return bits;
+}
+
+template <typename Bits>
+Bits FromBits(uint64_t bits) {
+    Bits value{};
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+}  // namespace
+
+uint64_t Fnv1a(std::string_view bytes, uint64_t seed) {
+    uint64_t hash = seed;
+    for (char c : bytes) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+std::optional<SourceKey> HashSourceFile(const std::string& path) {
+    if (ConfigCache::Directory().empty()) {
+        return std::nullopt;
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+
+    SourceKey key;
+    key.hash = 0xcbf29ce484222325ULL;
+    std::string chunk(kHashChunkSize, '\0');
+    while (file) {
+        file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        auto got = static_cast<size_t>(file.gcount());
+        key.hash = Fnv1a(std::string_view(chunk.data(), got), key.hash);
+        key.size += got;
+    }
+    return key;
+}
+
+// --- Devices ---
+
+bool ReadCompiled(const SourceKey& key, std::string_view tag,
+                  std::vector<DeviceEntry>& out) {
+    return ReadSections<CompiledDevice, CompiledArg>(
+        key, tag, CompiledKind::kDevices,
+        [&out](const CompiledDevice* devices, uint32_t device_count,
+               const CompiledArg* args, uint32_t arg_count,
+               const StringSection& strings) {
+            std::vector<DeviceEntry> entries;
+            entries.reserve(device_count);
+            bool ok = DecodeDevices(
+                devices, device_count, args, arg_count, strings,
+                [&entries](std::string_view nickname, std::string_view uri,
+                           std::string_view driver) {
+                    DeviceEntry& entry = entries.emplace_back();
+                    entry.nickname = std::string(nickname);
+                    entry.uri = std::string(uri);
+                    entry.driver = std::string(driver);
+                },
+                [&entries](std::string_view arg_key, std::string_view arg_value) {
+                    auto& entry_args = entries.back().args;
+                    entry_args.emplace_hint(entry_args.end(), std::string(arg_key),
+                                            std::string(arg_value));
+                });
+            if (ok) {
+                out = std::move(entries);
+            }
+            return ok;
+        });
+}
+
+bool ReadCompiled(const SourceKey& key, std::string_view tag, DeviceTable& out) {
+    return ReadSections<CompiledDevice, CompiledArg>(
+        key, tag, CompiledKind::kDevices,
+        [&out](const CompiledDevice* devices, uint32_t device_count,
+               const CompiledArg* args, uint32_t arg_count,
+               const StringSection& strings) {
+            DeviceTable table;
+            bool ok = DecodeDevices(
+                devices, device_count, args, arg_count, strings,
+                [&table](std::string_view nickname, std::string_view uri,
+                         std::string_view driver) {
+                    table.BeginEntry(nickname, uri, driver);
+                },
+                [&table](std::string_view arg_key, std::string_view arg_value) {
+                    table.AddArg(arg_key, arg_value);
+                });
+            if (ok) {
+                table.Finish();
+                out = std::move(table);
+            }
+            return ok;
+        });
+}
+
+void WriteCompiled(const SourceKey& key, std::string_view tag,
+                   const std::vector<DeviceEntry>& devices) {
+    StringWriter strings;
+    std::vector<CompiledDevice> records;
+    std::vector<CompiledArg> args;
+    records.reserve(devices.size());
+    for (const auto& entry : devices) {
+        records.push_back({strings.Add(entry.nickname), strings.Add(entry.uri),
+                           strings.Add(entry.driver),
+                           static_cast<uint32_t>(args.size()),
+                           static_cast<uint32_t>(entry.args.size())});
+        for (const auto& [arg_key, arg_value] : entry.args) {
+            args.push_back({strings.Add(arg_key), strings.Add(arg_value)});
+        }
+    }
+    WriteSections(key, tag, CompiledKind::kDevices, records, args, strings);
+}
+
+void WriteCompiled(const SourceKey& key, std::string_view tag,
+                   const DeviceTable& devices) {
+    StringWriter strings;
+    std::vector<CompiledDevice> records;
+    std::vector<CompiledArg> args;
+    records.reserve(devices.Size());
+    for (const auto& entry : devices) {
+        records.push_back({strings.Add(entry.Nickname()), strings.Add(entry.Uri()),
+                           strings.Add(entry.Driver()),
+                           static_cast<uint32_t>(args.size()),
+                           static_cast<uint32_t>(entry.ArgCount())});
+        for (const DeviceArg* arg = entry.ArgsBegin(); arg != entry.ArgsEnd(); ++arg) {
+            args.push_back({strings.Add(arg->key), strings.Add(arg->value)});
+        }
+    }
+    WriteSections(key, tag, CompiledKind::kDevices, records, args, strings);
+}
+
+// --- Property sessions ---
+
+bool ReadCompiled(const SourceKey& key, std::string_view tag,
+                  std::vector<PropertySession>& out) {
+    return ReadSections<CompiledSession, CompiledProperty>(
+        key, tag, CompiledKind::kPropertySessions,
+        [&out](const CompiledSession* sessions, uint32_t session_count,
+               const CompiledProperty* values, uint32_t value_count,
+               const StringSection& strings) {
+            std::vector<PropertySession> result;
+            result.reserve(session_count);
+            for (uint32_t i = 0; i < session_count; ++i) {
+                const auto& record = sessions[i];
+                std::string_view name;
+                if (!strings.Get(record.name, name) ||
+                    !InRange(record.value_begin, record.value_count, value_count)) {
+                    return false;
+                }
+                PropertySession& session = result.emplace_back();
+                session.name = std::string(name);
+                session.values.reserve(record.value_count);
+                for (uint32_t v = record.value_begin;
+                     v < record.value_begin + record.value_count; ++v) {
+                    const auto& value = values[v];
+                    std::string_view value_key;
+                    if (!strings.Get(value.key, value_key)) {
+                        return false;
+                    }
+                    PropertyValue& entry = session.values.emplace_back();
+                    entry.key = std::string(value_key);
+                    switch (static_cast<CompiledValueType>(value.type)) {
+                        case CompiledValueType::kBool:
+                            entry.value = value.bits != 0;
+                            break;
+                        case CompiledValueType::kInt:
+                            entry.value = FromBits<int64_t>(value.bits);
+                            break;
+                        case CompiledValueType::kDouble:
+                            entry.value = FromBits<double>(value.bits);
+                            break;
+                        case CompiledValueType::kString: {
+                            std::string_view text;
+                            if (!strings.Get(value.text, text)) {
+                                return false;
+                            }
+                            entry.value = std::string(text);
+                            break;
+                        }
+                        default:
+                            return false;
+                    }
+                }
+            }
+            out = std::move(result);
+            return true;
+        });
+}
+
+void WriteCompiled(const SourceKey& key, std::string_view tag,
+                   const std::vector<PropertySession>& sessions) {
+    StringWriter strings;
+    std::vector<CompiledSession> records;
+    std::vector<CompiledProperty> values;
+    records.reserve(sessions.size());
+    for (const auto& session : sessions) {
+        records.push_back({strings.Add(session.name),
+                           static_cast<uint32_t>(values.size()),
+                           static_cast<uint32_t>(session.values.size())});
+        for (const auto& entry : session.values) {
+            CompiledProperty record{};
+            record.key = strings.Add(entry.key);
+            if (const auto* b = std::get_if<bool>(&entry.value)) {
+                record.type = static_cast<uint32_t>(CompiledValueType::kBool);
+                record.bits = *b ? 1 : 0;
+            } else if (const auto* i = std::get_if<int64_t>(&entry.value)) {
+                record.type = static_cast<uint32_t>(CompiledValueType::kInt);
+                record.bits = ToBits(*i);
+            } else if (const auto* d = std::get_if<double>(&entry.value)) {
+                record.type = static_cast<uint32_t>(CompiledValueType::kDouble);
+                record.bits = ToBits(*d);
+            } else {
+                record.type = static_cast<uint32_t>(CompiledValueType::kString);
+                record.text = strings.Add(std::get<std::string>(entry.value));
+            }
+            values.push_back(record);
+        }
+    }
+    WriteSections(key, tag, CompiledKind::kPropertySessions, records, values,
+                  strings);
+}
+
+}  // namespace detail
+}  // namespace plas::config
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/config/device_table.h"
+#include "plas/core/result.h"
+#include "property_values.h"
+
+namespace plas::config::detail {
+
+// ---------------------------------------------------------------------------
+// On-disk format (native byte order, every section 8-byte aligned):
+//
+//   CompiledHeader
+//   CompiledDevice[record_count] | CompiledSession[record_count]
+//   CompiledArg[item_count]      | CompiledProperty[item_count]
+//   char strings[string_bytes]
+//
+// Records refer to text by (offset, size) into the string section, so a
+// mapped file is read in place.
+// ---------------------------------------------------------------------------
+
+inline constexpr char kCompiledMagic[8] = {'P', 'L', 'A', 'S', 'C', 'F', 'G', '\0'};
+inline constexpr uint32_t kCompiledFormatVersion = 1;
+
+enum class CompiledKind : uint32_t {
+    kDevices = 1,
+    kPropertySessions = 2,
+};
+
+struct CompiledHeader {
+    char     magic[8];          ///< kCompiledMagic
+    uint32_t version;           ///< kCompiledFormatVersion
+    uint32_t kind;              ///< CompiledKind
+    uint64_t source_hash;       ///< FNV-1a of the source file bytes
+    uint64_t source_size;
+    uint64_t tag_hash;          ///< FNV-1a of the load tag (format, key path)
+    uint32_t record_count;
+    uint32_t item_count;
+    uint64_t string_bytes;
+};
+static_assert(sizeof(CompiledHeader) == 56, "format layout changed");
+
+struct CompiledString {
+    uint32_t offset;
+    uint32_t size;
+};
+
+struct CompiledDevice {
+    CompiledString nickname;
+    CompiledString uri;
+    CompiledString driver;
+    uint32_t arg_begin;
+    uint32_t arg_count;
+};
+
+struct CompiledArg {
+    CompiledString key;
+    CompiledString value;
+};
+
+struct CompiledSession {
+    CompiledString name;
+    uint32_t value_begin;
+    uint32_t value_count;
+};
+
+enum class CompiledValueType : uint32_t {
+    kBool = 0,
+    kInt = 1,
+    kDouble = 2,
+    kString = 3,
+};
+
+struct CompiledProperty {
+    CompiledString key;
+    CompiledString text;        ///< kString only
+    uint32_t type;              ///< CompiledValueType
+    uint32_t reserved;
+    uint64_t bits;              ///< bool / int64_t / double, bit-copied
+};
+
+// ---------------------------------------------------------------------------
+// Cache access
+// ---------------------------------------------------------------------------
+
+/// Identity of a source file's contents.
+struct SourceKey {
+    uint64_t hash = 0;
+    uint64_t size = 0;
+};
+
+uint64_t Fnv1a(std::string_view bytes, uint64_t seed = 0xcbf29ce484222325ULL);
+
+/// nullopt when caching is disabled or the file cannot be read.
+std::optional<SourceKey> HashSourceFile(const std::string& path);
+
+/// Each Read returns false on a miss (absent, stale, wrong version or
+/// malformed file); each Write is best effort and never fails the load.
+bool ReadCompiled(const SourceKey& key, std::string_view tag,
+                  std::vector<DeviceEntry>& out);
+bool ReadCompiled(const SourceKey& key, std::string_view tag, DeviceTable& out);
+bool ReadCompiled(const SourceKey& key, std::string_view tag,
+                  std::vector<PropertySession>& out);
+
+void WriteCompiled(const SourceKey& key, std::string_view tag,
+                   const std::vector<DeviceEntry>& devices);
+void WriteCompiled(const SourceKey& key, std::string_view tag,
+                   const DeviceTable& devices);
+void WriteCompiled(const SourceKey& key, std::string_view tag,
+                   const std::vector<PropertySession>& sessions);
+
+/// Serve `parse()` from the cache when a compiled copy of `path` exists
+/// for `tag`; otherwise parse and store the result. `tag` names what was
+/// loaded (kind, format, key path) since one file can be loaded several ways.
+template <typename T, typename Parse>
+core::Result<T> LoadCompiled(const std::string& path, std::string_view tag,
+                             Parse&& parse) {
+    auto key = HashSourceFile(path);
+    if (key.has_value()) {
+        T cached;
+        if (ReadCompiled(*key, tag, cached)) {
+            return core::Result<T>::Ok(std::move(cached));
+        }
+    }
+
+    core::Result<T> result = parse();
+    if (key.has_value() && result.IsOk()) {
+        WriteCompiled(*key, tag, result.Value());
+    }
+    return result;
+}
+
+}  // namespace plas::config::detail
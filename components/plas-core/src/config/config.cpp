@@ -2,33 +2,80 @@
 
 #include <algorithm>
 
+#include "compiled_config.h"
 #include "config_node_internal.h"
 #include "device_parser.h"
+#include "device_stream.h"
 #include "json_parser.h"
 #include "plas/core/error.h"
 #include "yaml_parser.h"
+#include "yaml_to_json.h"
 
 namespace plas::config {
 
+namespace {
+
+/// Names one way of loading a file, for the compiled config cache.
+std::string CacheTag(const char* kind, ConfigFormat fmt,
+                     const std::string& key_path = {}) {
+    std::string tag = kind;
+    switch (fmt) {
+        case ConfigFormat::kJson: tag += ":json"; break;
+        case ConfigFormat::kYaml: tag += ":yaml"; break;
+        default: tag += ":auto"; break;
+    }
+    if (!key_path.empty()) {
+        tag += '@';
+        tag += key_path;
+    }
+    return tag;
+}
+
+core::Result<DeviceTable> ParseDeviceTableFile(const std::string& path,
+                                               ConfigFormat fmt) {
+    if (fmt == ConfigFormat::kYaml) {
+        auto yaml_result = detail::LoadYamlFile(path);
+        if (yaml_result.IsError()) {
+            return core::Result<DeviceTable>::Err(yaml_result.Error());
+        }
+        const YAML::Node& root = yaml_result.Value();
+        if (!root.IsMap() || !root["devices"]) {
+            return core::Result<DeviceTable>::Err(core::ErrorCode::kInvalidArgument);
+        }
+        return detail::ParseDeviceTable(root["devices"]);
+    }
+    if (fmt != ConfigFormat::kJson) {
+        return core::Result<DeviceTable>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    auto root_result = detail::LoadJsonFile(path);
+    if (root_result.IsError()) {
+        return core::Result<DeviceTable>::Err(root_result.Error());
+    }
+
+    auto& root = root_result.Value();
+    if (!root.contains("devices")) {
+        return core::Result<DeviceTable>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    return detail::ParseDeviceTable(root["devices"]);
+}
+
+}  // namespace
+
 core::Result<Config> Config::LoadFromFile(const std::string& path, ConfigFormat fmt) {
     if (fmt == ConfigFormat::kAuto) {
         fmt = DetectFormat(path);
     }
-
-    core::Result<std::vector<DeviceEntry>> parse_result =
-        core::Result<std::vector<DeviceEntry>>::Err(core::ErrorCode::kInvalidArgument);
-
-    switch (fmt) {
-        case ConfigFormat::kJson:
-            parse_result = detail::ParseJsonConfig(path);
-            break;
-        case ConfigFormat::kYaml:
-            parse_result = detail::ParseYamlConfig(path);
-            break;
-        default:
-            return core::Result<Config>::Err(core::ErrorCode::kInvalidArgument);
+    if (fmt != ConfigFormat::kJson && fmt != ConfigFormat::kYaml) {
+        return core::Result<Config>::Err(core::ErrorCode::kInvalidArgument);
     }
 
+    auto parse_result = detail::LoadCompiled<std::vector<DeviceEntry>>(
+        path, CacheTag("devices", fmt), [&path, fmt]() {
+            return fmt == ConfigFormat::kJson ? detail::ParseJsonConfig(path)
+                                              : detail::ParseYamlConfig(path);
+        });
+
     if (parse_result.IsError()) {
         return core::Result<Config>::Err(parse_result.Error());
     }
@@ -41,22 +88,43 @@ core::Result<Config> Config::LoadFromFile(const std::string& path, ConfigFormat
 core::Result<Config> Config::LoadFromFile(const std::string& path,
                                           const std::string& key_path,
                                           ConfigFormat fmt) {
-    auto tree_result = ConfigNode::LoadFromFile(path, fmt);
-    if (tree_result.IsError()) {
-        return core::Result<Config>::Err(tree_result.Error());
+    if (fmt == ConfigFormat::kAuto) {
+        fmt = DetectFormat(path);
     }
 
-    auto subtree_result = tree_result.Value().GetSubtree(key_path);
-    if (subtree_result.IsError()) {
-        return core::Result<Config>::Err(subtree_result.Error());
+    auto parse_result = detail::LoadCompiled<std::vector<DeviceEntry>>(
+        path, CacheTag("devices", fmt, key_path),
+        [&]() -> core::Result<std::vector<DeviceEntry>> {
+            auto tree_result = ConfigNode::LoadFromFile(path, fmt);
+            if (tree_result.IsError()) {
+                return core::Result<std::vector<DeviceEntry>>::Err(tree_result.Error());
+            }
+
+            auto subtree_result = tree_result.Value().GetSubtree(key_path);
+            if (subtree_result.IsError()) {
+                return core::Result<std::vector<DeviceEntry>>::Err(subtree_result.Error());
+            }
+
+            auto config_result = LoadFromNode(subtree_result.Value());
+            if (config_result.IsError()) {
+                return core::Result<std::vector<DeviceEntry>>::Err(config_result.Error());
+            }
+            return core::Result<std::vector<DeviceEntry>>::Ok(
+                std::move(config_result).Value().devices_);
+        });
+    if (parse_result.IsError()) {
+        return core::Result<Config>::Err(parse_result.Error());
     }
 
-    return LoadFromNode(subtree_result.Value());
+    Config config;
+    config.devices_ = std::move(parse_result).Value();
+    return core::Result<Config>::Ok(std::move(config));
 }
 
 core::Result<Config> Config::LoadFromNode(const ConfigNode& node) {
-    const auto& json = detail::GetNodeJson(node);
-    auto parse_result = detail::ParseDeviceEntries(json);
+    auto parse_result = detail::IsYamlNode(node)
+                            ? detail::ParseDeviceEntries(detail::GetNodeYaml(node))
+                            : detail::ParseDeviceEntries(detail::GetNodeJson(node));
     if (parse_result.IsError()) {
         return core::Result<Config>::Err(parse_result.Error());
     }
@@ -66,6 +134,44 @@ core::Result<Config> Config::LoadFromNode(const ConfigNode& node) {
     return core::Result<Config>::Ok(std::move(config));
 }
 
+core::Result<DeviceTable> Config::LoadDeviceTable(const std::string& path,
+                                                  ConfigFormat fmt) {
+    if (fmt == ConfigFormat::kAuto) {
+        fmt = DetectFormat(path);
+    }
+    if (fmt != ConfigFormat::kJson && fmt != ConfigFormat::kYaml) {
+        return core::Result<DeviceTable>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    return detail::LoadCompiled<DeviceTable>(
+        path, CacheTag("devices", fmt),
+        [&path, fmt]() { return ParseDeviceTableFile(path, fmt); });
+}
+
+core::Result<DeviceTable> Config::LoadDeviceTable(const ConfigNode& node) {
+    if (detail::IsYamlNode(node)) {
+        return detail::ParseDeviceTable(detail::GetNodeYaml(node));
+    }
+    return detail::ParseDeviceTable(detail::GetNodeJson(node));
+}
+
+core::Result<size_t> Config::StreamFromFile(const std::string& path,
+                                            const DeviceEntrySink& sink,
+                                            ConfigFormat fmt) {
+    if (fmt == ConfigFormat::kAuto) {
+        fmt = DetectFormat(path);
+    }
+
+    switch (fmt) {
+        case ConfigFormat::kJson:
+            return detail::StreamJsonDevices(path, sink);
+        case ConfigFormat::kYaml:
+            return detail::StreamYamlDevices(path, sink);
+        default:
+            return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+}
+
 const std::vector<DeviceEntry>& Config::GetDevices() const {
     return devices_;
 }
@@ -0,0 +1,40 @@
+#include "plas/config/config_diff.h"
+
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace plas::config {
+
+DeviceDiff DiffDevices(const std::vector<DeviceEntry>& current,
+                       const std::vector<DeviceEntry>& updated) {
+    std::unordered_map<std::string_view, const DeviceEntry*> old_by_name;
+    old_by_name.reserve(current.size());
+    for (const auto& entry : current) {
+        old_by_name.emplace(entry.nickname, &entry);
+    }
+
+    DeviceDiff diff;
+    std::unordered_set<std::string_view> seen;
+    seen.reserve(updated.size());
+    for (const auto& entry : updated) {
+        seen.insert(entry.nickname);
+        auto it = old_by_name.find(entry.nickname);
+        if (it == old_by_name.end()) {
+            diff.added.push_back(entry);
+        } else if (*it->second != entry) {
+            diff.changed.push_back(entry);
+        } else {
+            ++diff.unchanged;
+        }
+    }
+
+    for (const auto& entry : current) {
+        if (seen.count(entry.nickname) == 0) {
+            diff.removed.push_back(entry.nickname);
+        }
+    }
+    return diff;
+}
+
+}  // namespace plas::config
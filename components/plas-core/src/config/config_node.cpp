@@ -1,7 +1,6 @@
 #include "plas/config/config_node.h"
 
 #include <fstream>
-#include <sstream>
 
 #include <nlohmann/json.hpp>
 
@@ -40,7 +39,7 @@ core::Result<ConfigNode> ConfigNode::LoadFromFile(
     }
 
     if (fmt == ConfigFormat::kYaml) {
-        auto result = detail::LoadYamlFileAsJson(path);
+        auto result = detail::LoadYamlFile(path);
         if (result.IsError()) {
             return core::Result<ConfigNode>::Err(result.Error());
         }
@@ -65,44 +64,141 @@ core::Result<ConfigNode> ConfigNode::LoadFromFile(
     return core::Result<ConfigNode>::Err(core::ErrorCode::kInvalidArgument);
 }
 
+// --- Path index ---
+
+namespace {
+
+/// True if `key` can be one segment of a dotted path.
+bool IsPathKey(const std::string& key) {
+    return !key.empty() && key.find('.') == std::string::npos;
+}
+
+void IndexJson(const nlohmann::json& node, std::string& path, detail::ConfigPathIndex& index) {
+    if (!node.is_object()) return;
+    for (auto it = node.begin(); it != node.end(); ++it) {
+        if (!IsPathKey(it.key())) continue;
+        std::size_t length = path.size();
+        if (length > 0) path += '.';
+        path += it.key();
+        index[path].json = &it.value();
+        IndexJson(it.value(), path, index);
+        path.resize(length);
+    }
+}
+
+void IndexYaml(const YAML::Node& node, std::string& path, detail::ConfigPathIndex& index) {
+    if (!node.IsMap()) return;
+    for (const auto& kv : node) {
+        if (!kv.first.IsScalar() || !IsPathKey(kv.first.Scalar())) continue;
+        std::size_t length = path.size();
+        if (length > 0) path += '.';
+        path += kv.first.Scalar();
+        // First occurrence wins, like operator[] on a map with duplicate keys
+        index.emplace(path, detail::ConfigPathEntry{nullptr, kv.second});
+        IndexYaml(kv.second, path, index);
+        path.resize(length);
+    }
+}
+
+/// `key_path` without empty segments, the form index keys take.
+std::string NormalizePath(const std::string& key_path) {
+    bool clean = key_path.empty() ||
+                 (key_path.front() != '.' && key_path.back() != '.' &&
+                  key_path.find("..") == std::string::npos);
+    if (clean) return key_path;
+
+    std::string path;
+    std::size_t start = 0;
+    while (start <= key_path.size()) {
+        std::size_t end = key_path.find('.', start);
+        if (end == std::string::npos) end = key_path.size();
+        if (end > start) {
+            if (!path.empty()) path += '.';
+            path.append(key_path, start, end - start);
+        }
+        start = end + 1;
+    }
+    return path;
+}
+
+}  // namespace
+
+const detail::ConfigPathIndex& ConfigNode::Impl::Index() const {
+    std::call_once(index_once_, [this] {
+        std::string path;
+        if (is_yaml_) {
+            IndexYaml(yaml_, path, index_);
+        } else {
+            IndexJson(Json(), path, index_);
+        }
+    });
+    return index_;
+}
+
 // --- GetSubtree ---
 
 core::Result<ConfigNode> ConfigNode::GetSubtree(const std::string& key_path) const {
-    const nlohmann::json* current = &impl_->data_;
+    std::string path = NormalizePath(key_path);
+    if (path.empty()) {
+        return core::Result<ConfigNode>::Ok(*this);
+    }
 
-    std::istringstream stream(key_path);
-    std::string key;
-    while (std::getline(stream, key, '.')) {
-        if (key.empty()) continue;
-        if (!current->is_object() || !current->contains(key)) {
-            return core::Result<ConfigNode>::Err(core::ErrorCode::kNotFound);
-        }
-        current = &(*current)[key];
+    std::shared_ptr<const Impl> root = impl_->root_ ? impl_->root_ : impl_;
+    if (!impl_->prefix_.empty()) {
+        path.insert(0, impl_->prefix_ + '.');
     }
+    const auto& index = root->Index();
+    auto it = index.find(path);
+    if (it == index.end()) {
+        return core::Result<ConfigNode>::Err(core::ErrorCode::kNotFound);
+    }
+
+    ConfigNode node;
+    node.impl_ = std::make_shared<Impl>(std::move(root), std::move(path), it->second);
+    return core::Result<ConfigNode>::Ok(std::move(node));
+}
 
-    return core::Result<ConfigNode>::Ok(detail::MakeNode(*current));
+std::vector<core::Result<ConfigNode>> ConfigNode::GetSubtrees(
+    const std::vector<std::string>& key_paths) const {
+    std::vector<core::Result<ConfigNode>> subtrees;
+    subtrees.reserve(key_paths.size());
+    for (const auto& key_path : key_paths) {
+        subtrees.push_back(GetSubtree(key_path));
+    }
+    return subtrees;
 }
 
 // --- Type queries ---
 
 bool ConfigNode::IsMap() const {
-    return impl_->data_.is_object();
+    if (impl_->is_yaml_) return impl_->yaml_.IsMap();
+    return impl_->Json().is_object();
 }
 
 bool ConfigNode::IsArray() const {
-    return impl_->data_.is_array();
+    if (impl_->is_yaml_) return impl_->yaml_.IsSequence();
+    return impl_->Json().is_array();
 }
 
 bool ConfigNode::IsScalar() const {
-    return impl_->data_.is_primitive() && !impl_->data_.is_null();
+    if (impl_->is_yaml_) {
+        return impl_->yaml_.IsScalar() && !detail::YamlScalarToJson(impl_->yaml_).is_null();
+    }
+    return impl_->Json().is_primitive() && !impl_->Json().is_null();
 }
 
 bool ConfigNode::IsNull() const {
-    return impl_->data_.is_null();
+    if (impl_->is_yaml_) {
+        return !impl_->yaml_.IsDefined() || impl_->yaml_.IsNull() ||
+               (impl_->yaml_.IsScalar() && detail::YamlScalarToJson(impl_->yaml_).is_null());
+    }
+    return impl_->Json().is_null();
 }
 
 std::string ConfigNode::Dump() const {
-    return impl_->data_.dump();
+    // The one place a YAML tree is converted: configspec validates JSON.
+    if (impl_->is_yaml_) return detail::YamlToJson(impl_->yaml_).dump();
+    return impl_->Json().dump();
 }
 
 }  // namespace plas::config
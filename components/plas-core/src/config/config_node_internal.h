@@ -1,23 +1,84 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 #include <nlohmann/json.hpp>
+#include <yaml-cpp/yaml.h>
 
 #include "plas/config/config_node.h"
 
 namespace plas::config {
 
+namespace detail {
+
+/// A node reachable by a dotted key path (see ConfigNode::Impl::Index).
+struct ConfigPathEntry {
+    const nlohmann::json* json = nullptr;
+    YAML::Node yaml;
+};
+
+using ConfigPathIndex = std::unordered_map<std::string, ConfigPathEntry>;
+
+}  // namespace detail
+
+/// Holds whichever tree the file was parsed into: YAML documents stay as
+/// yaml-cpp nodes and are only converted to JSON by Dump().
+///
+/// A subtree returned by GetSubtree is a view: it points into its root's
+/// tree, keeps the root alive through `root_`, and resolves further paths
+/// through the root's index under `prefix_`.
 class ConfigNode::Impl {
 public:
     explicit Impl(nlohmann::json data) : data_(std::move(data)) {}
+    explicit Impl(YAML::Node yaml) : yaml_(std::move(yaml)), is_yaml_(true) {}
+    Impl(std::shared_ptr<const Impl> root, std::string prefix, const detail::ConfigPathEntry& entry)
+        : json_(entry.json),
+          yaml_(entry.yaml),
+          is_yaml_(root->is_yaml_),
+          root_(std::move(root)),
+          prefix_(std::move(prefix)) {}
+
+    Impl(const Impl&) = delete;
+    Impl& operator=(const Impl&) = delete;
+
+    const nlohmann::json& Json() const { return *json_; }
+
+    /// Index of the root's tree, flattened on first use: every node
+    /// reachable from the root through map keys, keyed by its path without empty segments.
+    /// Keys that are empty or contain '.' cannot be named by a path and are
+    /// skipped, along with their subtrees.
+    const detail::ConfigPathIndex& Index() const;
+
     nlohmann::json data_;
+    const nlohmann::json* json_ = &data_;
+    YAML::Node yaml_;
+    bool is_yaml_ = false;
+
+    std::shared_ptr<const Impl> root_;  // null for a root
+    std::string prefix_;                // path of this node under root_
+
+private:
+    mutable std::once_flag index_once_;
+    mutable detail::ConfigPathIndex index_;
 };
 
 namespace detail {
 
 class ConfigNodeAccessor {
 public:
+    static bool IsYaml(const ConfigNode& node) {
+        return node.impl_->is_yaml_;
+    }
+
     static const nlohmann::json& GetJson(const ConfigNode& node) {
-        return node.impl_->data_;
+        return node.impl_->Json();
+    }
+
+    static const YAML::Node& GetYaml(const ConfigNode& node) {
+        return node.impl_->yaml_;
     }
 
     static ConfigNode Make(nlohmann::json data) {
@@ -25,15 +86,35 @@ public:
         node.impl_ = std::make_shared<ConfigNode::Impl>(std::move(data));
         return node;
     }
+
+    static ConfigNode Make(YAML::Node yaml) {
+        ConfigNode node;
+        node.impl_ = std::make_shared<ConfigNode::Impl>(std::move(yaml));
+        return node;
+    }
 };
 
+inline bool IsYamlNode(const ConfigNode& node) {
+    return ConfigNodeAccessor::IsYaml(node);
+}
+
+/// Only meaningful when !IsYamlNode(node).
 inline const nlohmann::json& GetNodeJson(const ConfigNode& node) {
     return ConfigNodeAccessor::GetJson(node);
 }
 
+/// Only meaningful when IsYamlNode(node).
+inline const YAML::Node& GetNodeYaml(const ConfigNode& node) {
+    return ConfigNodeAccessor::GetYaml(node);
+}
+
 inline ConfigNode MakeNode(nlohmann::json data) {
     return ConfigNodeAccessor::Make(std::move(data));
 }
 
+inline ConfigNode MakeNode(YAML::Node yaml) {
+    return ConfigNodeAccessor::Make(std::move(yaml));
+}
+
 }  // namespace detail
 }  // namespace plas::config
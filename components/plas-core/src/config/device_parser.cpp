@@ -1,11 +1,15 @@
 #include "device_parser.h"
 
+#include <algorithm>
+#include <deque>
+#include <string_view>
+#include <utility>
+
 #include "plas/core/error.h"
+#include "yaml_to_json.h"
 
 namespace plas::config::detail {
 
-namespace {
-
 std::string JsonScalarToString(const nlohmann::json& val) {
     if (val.is_string()) return val.get<std::string>();
     if (val.is_boolean()) return val.get<bool>() ? "true" : "false";
@@ -15,81 +19,118 @@ std::string JsonScalarToString(const nlohmann::json& val) {
     return {};
 }
 
-core::Result<std::vector<DeviceEntry>> ParseFlatDevices(
-    const nlohmann::json& arr) {
-    std::vector<DeviceEntry> devices;
+namespace {
 
-    for (const auto& item : arr) {
+/// Collects parsed devices into std::vector<DeviceEntry>.
+class EntrySink {
+public:
+    void Begin(std::string_view nickname, std::string_view uri,
+               std::string_view driver) {
         DeviceEntry entry;
+        entry.nickname = std::string(nickname);
+        entry.uri = std::string(uri);
+        entry.driver = std::string(driver);
+        devices_.push_back(std::move(entry));
+    }
 
-        if (!item.contains("nickname") || !item["nickname"].is_string()) {
-            return core::Result<std::vector<DeviceEntry>>::Err(
-                core::ErrorCode::kInvalidArgument);
+    void Arg(const std::string& key, const nlohmann::json& value) {
+        devices_.back().args[key] = JsonScalarToString(value);
+    }
+
+    std::vector<DeviceEntry> Take() { return std::move(devices_); }
+
+private:
+    std::vector<DeviceEntry> devices_;
+};
+
+/// Collects parsed devices into a DeviceTable; string values are viewed in
+/// place rather than copied out of the JSON tree.
+class TableSink {
+public:
+    void Begin(std::string_view nickname, std::string_view uri,
+               std::string_view driver) {
+        table_.BeginEntry(nickname, uri, driver);
+    }
+
+    void Arg(const std::string& key, const nlohmann::json& value) {
+        if (value.is_string()) {
+            table_.AddArg(key, value.get_ref<const std::string&>());
+        } else {
+            table_.AddArg(key, JsonScalarToString(value));
         }
-        entry.nickname = item["nickname"].get<std::string>();
+    }
+
+    DeviceTable Take() {
+        table_.Finish();
+        return std::move(table_);
+    }
+
+private:
+    DeviceTable table_;
+};
 
+bool IsScalarArg(const nlohmann::json& value) {
+    return !value.is_object() && !value.is_array();
+}
+
+template <typename Sink>
+bool ParseFlatDevices(const nlohmann::json& arr, Sink& sink) {
+    for (const auto& item : arr) {
+        if (!item.contains("nickname") || !item["nickname"].is_string()) {
+            return false;
+        }
         if (!item.contains("uri") || !item["uri"].is_string()) {
-            return core::Result<std::vector<DeviceEntry>>::Err(
-                core::ErrorCode::kInvalidArgument);
+            return false;
         }
-        entry.uri = item["uri"].get<std::string>();
-
         if (!item.contains("driver") || !item["driver"].is_string()) {
-            return core::Result<std::vector<DeviceEntry>>::Err(
-                core::ErrorCode::kInvalidArgument);
+            return false;
         }
-        entry.driver = item["driver"].get<std::string>();
+        sink.Begin(item["nickname"].get_ref<const std::string&>(),
+                   item["uri"].get_ref<const std::string&>(),
+                   item["driver"].get_ref<const std::string&>());
 
         if (item.contains("args") && item["args"].is_object()) {
             for (auto it = item["args"].begin(); it != item["args"].end(); ++it) {
                 if (it.value().is_null()) continue;
-                if (it.value().is_object() || it.value().is_array()) {
-                    return core::Result<std::vector<DeviceEntry>>::Err(
-                        core::ErrorCode::kInvalidArgument);
+                if (!IsScalarArg(it.value())) {
+                    return false;
                 }
-                entry.args[it.key()] = JsonScalarToString(it.value());
+                sink.Arg(it.key(), it.value());
             }
         }
-
-        devices.push_back(std::move(entry));
     }
-
-    return core::Result<std::vector<DeviceEntry>>::Ok(std::move(devices));
+    return true;
 }
 
-core::Result<std::vector<DeviceEntry>> ParseGroupedDevices(
-    const nlohmann::json& obj) {
-    std::vector<DeviceEntry> devices;
-
+template <typename Sink>
+bool ParseGroupedDevices(const nlohmann::json& obj, Sink& sink) {
+    std::string default_nickname;
     for (auto it = obj.begin(); it != obj.end(); ++it) {
         const std::string& driver_name = it.key();
         const auto& group_array = it.value();
 
         if (!group_array.is_array()) {
-            return core::Result<std::vector<DeviceEntry>>::Err(
-                core::ErrorCode::kInvalidArgument);
+            return false;
         }
 
         int index = 0;
         for (const auto& item : group_array) {
             if (!item.is_object()) {
-                return core::Result<std::vector<DeviceEntry>>::Err(
-                    core::ErrorCode::kInvalidArgument);
+                return false;
             }
 
-            DeviceEntry entry;
-            entry.driver = driver_name;
-
             if (!item.contains("uri") || !item["uri"].is_string()) {
-                return core::Result<std::vector<DeviceEntry>>::Err(
-                    core::ErrorCode::kInvalidArgument);
+                return false;
             }
-            entry.uri = item["uri"].get<std::string>();
+            const auto& uri = item["uri"].get_ref<const std::string&>();
 
             if (item.contains("nickname") && item["nickname"].is_string()) {
-                entry.nickname = item["nickname"].get<std::string>();
+                sink.Begin(
+                    item["nickname"].get_ref<const std::string&>(),
+                    uri, driver_name);
             } else {
-                entry.nickname = driver_name + "_" + std::to_string(index);
+                default_nickname = driver_name + "_" + std::to_string(index);
+                sink.Begin(default_nickname, uri, driver_name);
             }
 
             for (auto arg_it = item.begin(); arg_it != item.end(); ++arg_it) {
@@ -99,33 +140,181 @@ core::Result<std::vector<DeviceEntry>> ParseGroupedDevices(
                 if (arg_it.value().is_null()) {
                     continue;
                 }
-                if (arg_it.value().is_object() || arg_it.value().is_array()) {
-                    return core::Result<std::vector<DeviceEntry>>::Err(
-                        core::ErrorCode::kInvalidArgument);
+                if (!IsScalarArg(arg_it.value())) {
+                    return false;
                 }
-                entry.args[arg_it.key()] = JsonScalarToString(arg_it.value());
+                sink.Arg(arg_it.key(), arg_it.value());
             }
 
-            devices.push_back(std::move(entry));
             ++index;
         }
     }
+    return true;
+}
 
-    return core::Result<std::vector<DeviceEntry>>::Ok(std::move(devices));
+// --- YAML trees, read in place with the same rules as the JSON walkers ---
+
+bool IsYamlString(const YAML::Node& node) {
+    return node.IsDefined() && node.IsScalar() &&
+           YamlScalarToJson(node).is_string();
 }
 
-}  // namespace
+template <typename Sink>
+bool ParseFlatYamlDevices(const YAML::Node& seq, Sink& sink) {
+    for (const auto& item : seq) {
+        if (!item.IsMap()) {
+            return false;
+        }
+        const YAML::Node nickname = item["nickname"];
+        const YAML::Node uri = item["uri"];
+        const YAML::Node driver = item["driver"];
+        if (!IsYamlString(nickname) || !IsYamlString(uri) ||
+            !IsYamlString(driver)) {
+            return false;
+        }
+        sink.Begin(nickname.Scalar(), uri.Scalar(), driver.Scalar());
 
-core::Result<std::vector<DeviceEntry>> ParseDeviceEntries(
-    const nlohmann::json& node) {
+        const YAML::Node args = item["args"];
+        if (args.IsDefined() && args.IsMap()) {
+            for (const auto& pair : args) {
+                if (pair.second.IsNull()) continue;
+                if (!pair.second.IsScalar()) {
+                    return false;
+                }
+                nlohmann::json value = YamlScalarToJson(pair.second);
+                if (value.is_null()) continue;
+                sink.Arg(pair.first.as<std::string>(), value);
+            }
+        }
+    }
+    return true;
+}
+
+template <typename Sink>
+bool ParseGroupedYamlDevices(const YAML::Node& map, Sink& sink) {
+    // Visit groups in driver-name order, as the JSON object did. Nodes are
+    // held in a deque and sorted by index: assigning a YAML::Node writes
+    // through to the document.
+    std::deque<YAML::Node> group_nodes;
+    std::vector<std::pair<std::string, size_t>> groups;
+    for (const auto& pair : map) {
+        groups.emplace_back(pair.first.as<std::string>(), group_nodes.size());
+        group_nodes.push_back(pair.second);
+    }
+    std::stable_sort(groups.begin(), groups.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::string default_nickname;
+    for (const auto& [driver_name, node_index] : groups) {
+        const YAML::Node& group = group_nodes[node_index];
+        if (!group.IsSequence()) {
+            return false;
+        }
+
+        int index = 0;
+        for (const auto& item : group) {
+            if (!item.IsMap()) {
+                return false;
+            }
+            const YAML::Node uri = item["uri"];
+            if (!IsYamlString(uri)) {
+                return false;
+            }
+            const YAML::Node nickname = item["nickname"];
+            if (IsYamlString(nickname)) {
+                sink.Begin(nickname.Scalar(), uri.Scalar(), driver_name);
+            } else {
+                default_nickname = driver_name + "_" + std::to_string(index);
+                sink.Begin(default_nickname, uri.Scalar(), driver_name);
+            }
+
+            for (const auto& pair : item) {
+                std::string key = pair.first.as<std::string>();
+                if (key == "nickname" || key == "uri") {
+                    continue;
+                }
+                if (pair.second.IsNull()) {
+                    continue;
+                }
+                if (!pair.second.IsScalar()) {
+                    return false;
+                }
+                nlohmann::json value = YamlScalarToJson(pair.second);
+                if (value.is_null()) {
+                    continue;
+                }
+                sink.Arg(key, value);
+            }
+
+            ++index;
+        }
+    }
+    return true;
+}
+
+template <typename Sink>
+bool ParseDevices(const YAML::Node& node, Sink& sink) {
+    try {
+        if (node.IsSequence()) {
+            return ParseFlatYamlDevices(node, sink);
+        }
+        if (node.IsMap()) {
+            return ParseGroupedYamlDevices(node, sink);
+        }
+    } catch (const YAML::Exception&) {
+        // e.g. a key that is not a scalar
+    }
+    return false;
+}
+
+template <typename Sink>
+bool ParseDevices(const nlohmann::json& node, Sink& sink) {
     if (node.is_array()) {
-        return ParseFlatDevices(node);
+        return ParseFlatDevices(node, sink);
     }
     if (node.is_object()) {
-        return ParseGroupedDevices(node);
+        return ParseGroupedDevices(node, sink);
+    }
+    return false;
+}
+
+template <typename Node>
+core::Result<std::vector<DeviceEntry>> CollectEntries(const Node& node) {
+    EntrySink sink;
+    if (!ParseDevices(node, sink)) {
+        return core::Result<std::vector<DeviceEntry>>::Err(
+            core::ErrorCode::kInvalidArgument);
     }
-    return core::Result<std::vector<DeviceEntry>>::Err(
-        core::ErrorCode::kInvalidArgument);
+    return core::Result<std::vector<DeviceEntry>>::Ok(sink.Take());
+}
+
+template <typename Node>
+core::Result<DeviceTable> CollectTable(const Node& node) {
+    TableSink sink;
+    if (!ParseDevices(node, sink)) {
+        return core::Result<DeviceTable>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    return core::Result<DeviceTable>::Ok(sink.Take());
+}
+
+}  // namespace
+
+core::Result<std::vector<DeviceEntry>> ParseDeviceEntries(
+    const nlohmann::json& node) {
+    return CollectEntries(node);
+}
+
+core::Result<std::vector<DeviceEntry>> ParseDeviceEntries(
+    const YAML::Node& node) {
+    return CollectEntries(node);
+}
+
+core::Result<DeviceTable> ParseDeviceTable(const nlohmann::json& node) {
+    return CollectTable(node);
+}
+
+core::Result<DeviceTable> ParseDeviceTable(const YAML::Node& node) {
+    return CollectTable(node);
 }
 
 }  // namespace plas::config::detail
@@ -4,13 +4,27 @@
 #include <vector>
 
 #include <nlohmann/json.hpp>
+#include <yaml-cpp/yaml.h>
 
 #include "plas/config/device_entry.h"
+#include "plas/config/device_table.h"
 #include "plas/core/result.h"
 
 namespace plas::config::detail {
 
+/// Text form of a scalar arg value as stored in DeviceEntry::args.
+std::string JsonScalarToString(const nlohmann::json& val);
+
+/// `node` is the "devices" section: a flat array or a driver-grouped map.
+/// The YAML overloads walk the yaml-cpp tree directly and accept exactly
+/// what the JSON ones accept for the converted document.
 core::Result<std::vector<DeviceEntry>> ParseDeviceEntries(
     const nlohmann::json& node);
+core::Result<std::vector<DeviceEntry>> ParseDeviceEntries(
+    const YAML::Node& node);
+
+/// Same input and validation as ParseDeviceEntries, into an arena.
+core::Result<DeviceTable> ParseDeviceTable(const nlohmann::json& node);
+core::Result<DeviceTable> ParseDeviceTable(const YAML::Node& node);
 
 }  // namespace plas::config::detail
@@ -0,0 +1,445 @@
+#include "device_stream.h"
+
+#include <fstream>
+#include <map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+#include <yaml-cpp/eventhandler.h>
+#include <yaml-cpp/yaml.h>
+
+#include "device_parser.h"
+#include "plas/core/error.h"
+#include "yaml_to_json.h"
+
+namespace plas::config::detail {
+
+namespace {
+
+/// Turns a stream of structural events into DeviceEntry values, applying
+/// the same rules as ParseDeviceEntries. Keys and scalars arrive as JSON
+/// values so both front ends share one notion of "is a string".
+///
+/// Every event returns false once the stream should stop.
+class DeviceEventBuilder {
+public:
+    explicit DeviceEventBuilder(const DeviceEntrySink& sink) : sink_(sink) {}
+
+    bool Key(const std::string& key) {
+        key_ = key;
+        return true;
+    }
+
+    bool StartObject() { return Open(true); }
+    bool StartArray() { return Open(false); }
+
+    bool End() {
+        Frame frame = stack_.back();
+        stack_.pop_back();
+        return frame == Frame::kItem ? EndItem() : true;
+    }
+
+    bool Value(const nlohmann::json& value) {
+        if (stack_.empty()) {
+            return true;  // scalar document: no "devices" key
+        }
+        switch (stack_.back()) {
+            case Frame::kRoot:
+                if (key_ == "devices") {
+                    return Fail(core::ErrorCode::kInvalidArgument);
+                }
+                return true;
+            case Frame::kFlatList:
+            case Frame::kGroups:
+            case Frame::kGroup:
+                return Fail(core::ErrorCode::kInvalidArgument);
+            case Frame::kItem:
+                return grouped_ ? GroupedItemValue(value) : FlatItemValue(value);
+            case Frame::kArgs:
+                if (!value.is_null()) {
+                    entry_.args[key_] = JsonScalarToString(value);
+                }
+                return true;
+            case Frame::kSkip:
+                return true;
+        }
+        return true;
+    }
+
+    bool Fail(core::ErrorCode code) {
+        if (status_.IsOk()) {
+            status_ = core::Result<void>::Err(code);
+        }
+        return false;
+    }
+
+    bool Failed() const { return status_.IsError(); }
+
+    core::Result<size_t> Finish() const {
+        if (status_.IsError()) {
+            return core::Result<size_t>::Err(status_.Error());
+        }
+        if (!seen_devices_) {
+            return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+        }
+        return core::Result<size_t>::Ok(delivered_);
+    }
+
+private:
+    enum class Frame {
+        kRoot,      // top-level object
+        kFlatList,  // devices: [ ... ]
+        kGroups,    // devices: { driver: [ ... ] }
+        kGroup,     // one driver's array
+        kItem,      // one device object
+        kArgs,      // "args" object of a flat item
+        kSkip,      // anything we ignore, nested to any depth
+    };
+
+    bool Open(bool object) {
+        Frame next = Frame::kSkip;
+        if (stack_.empty()) {
+            next = object ? Frame::kRoot : Frame::kSkip;
+        } else {
+            switch (stack_.back()) {
+                case Frame::kRoot:
+                    if (key_ == "devices") {
+                        seen_devices_ = true;
+                        next = object ? Frame::kGroups : Frame::kFlatList;
+                    }
+                    break;
+                case Frame::kFlatList:
+                case Frame::kGroup:
+                    if (!object) {
+                        return Fail(core::ErrorCode::kInvalidArgument);
+                    }
+                    BeginItem(stack_.back() == Frame::kGroup);
+                    next = Frame::kItem;
+                    break;
+                case Frame::kGroups:
+                    if (object) {
+                        return Fail(core::ErrorCode::kInvalidArgument);
+                    }
+                    group_driver_ = key_;
+                    group_index_ = 0;
+                    next = Frame::kGroup;
+                    break;
+                case Frame::kItem:
+                    if (grouped_) {
+                        // Nested arg values are rejected; a nested nickname
+                        // falls back to the default one, a nested uri fails.
+                        if (key_ != "nickname") {
+                            return Fail(core::ErrorCode::kInvalidArgument);
+                        }
+                    } else if (key_ == "nickname" || key_ == "uri" ||
+                               key_ == "driver") {
+                        return Fail(core::ErrorCode::kInvalidArgument);
+                    } else if (key_ == "args" && object) {
+                        next = Frame::kArgs;
+                    }
+                    break;
+                case Frame::kArgs:
+                    return Fail(core::ErrorCode::kInvalidArgument);
+                case Frame::kSkip:
+                    break;
+            }
+        }
+        stack_.push_back(next);
+        return true;
+    }
+
+    void BeginItem(bool grouped) {
+        grouped_ = grouped;
+        entry_ = DeviceEntry{};
+        has_nickname_ = has_uri_ = has_driver_ = false;
+    }
+
+    bool FlatItemValue(const nlohmann::json& value) {
+        bool* seen = key_ == "nickname" ? &has_nickname_
+                     : key_ == "uri"    ? &has_uri_
+                     : key_ == "driver" ? &has_driver_
+                                        : nullptr;
+        if (seen == nullptr) {
+            return true;  // unknown keys are ignored in the flat layout
+        }
+        if (!value.is_string()) {
+            return Fail(core::ErrorCode::kInvalidArgument);
+        }
+        std::string& field = key_ == "nickname" ? entry_.nickname
+                             : key_ == "uri"    ? entry_.uri
+                                                : entry_.driver;
+        field = value.get<std::string>();
+        *seen = true;
+        return true;
+    }
+
+    bool GroupedItemValue(const nlohmann::json& value) {
+        if (key_ == "nickname") {
+            if (value.is_string()) {
+                entry_.nickname = value.get<std::string>();
+                has_nickname_ = true;
+            }
+            return true;
+        }
+        if (key_ == "uri") {
+            if (!value.is_string()) {
+                return Fail(core::ErrorCode::kInvalidArgument);
+            }
+            entry_.uri = value.get<std::string>();
+            has_uri_ = true;
+            return true;
+        }
+        if (!value.is_null()) {
+            entry_.args[key_] = JsonScalarToString(value);
+        }
+        return true;
+    }
+
+    bool EndItem() {
+        if (grouped_) {
+            if (!has_uri_) {
+                return Fail(core::ErrorCode::kInvalidArgument);
+            }
+            if (!has_nickname_) {
+                entry_.nickname =
+                    group_driver_ + "_" + std::to_string(group_index_);
+            }
+            entry_.driver = group_driver_;
+            ++group_index_;
+        } else if (!has_nickname_ || !has_uri_ || !has_driver_) {
+            return Fail(core::ErrorCode::kInvalidArgument);
+        }
+
+        auto delivered = sink_(std::move(entry_));
+        if (delivered.IsError()) {
+            status_ = std::move(delivered);
+            return false;
+        }
+        ++delivered_;
+        return true;
+    }
+
+    const DeviceEntrySink& sink_;
+    core::Result<void> status_ = core::Result<void>::Ok();
+    std::vector<Frame> stack_;
+    std::string key_;
+    bool seen_devices_ = false;
+
+    std::string group_driver_;
+    int group_index_ = 0;
+
+    DeviceEntry entry_;
+    bool grouped_ = false;
+    bool has_nickname_ = false;
+    bool has_uri_ = false;
+    bool has_driver_ = false;
+    size_t delivered_ = 0;
+};
+
+/// nlohmann::json SAX interface over DeviceEventBuilder.
+class JsonSaxHandler {
+public:
+    explicit JsonSaxHandler(DeviceEventBuilder& builder) : builder_(builder) {}
+
+    bool null() { return builder_.Value(nullptr); }
+    bool boolean(bool val) { return builder_.Value(val); }
+    bool number_integer(nlohmann::json::number_integer_t val) {
+        return builder_.Value(val);
+    }
+    bool number_unsigned(nlohmann::json::number_unsigned_t val) {
+        return builder_.Value(val);
+    }
+    bool number_float(nlohmann::json::number_float_t val, const std::string&) {
+        return builder_.Value(val);
+    }
+    bool string(std::string& val) { return builder_.Value(std::move(val)); }
+    bool binary(nlohmann::json::binary_t&) { return true; }
+
+    bool start_object(std::size_t) { return builder_.StartObject(); }
+    bool key(std::string& val) { return builder_.Key(val); }
+    bool end_object() { return builder_.End(); }
+    bool start_array(std::size_t) { return builder_.StartArray(); }
+    bool end_array() { return builder_.End(); }
+
+    bool parse_error(std::size_t, const std::string&,
+                     const nlohmann::detail::exception&) {
+        return builder_.Fail(core::ErrorCode::kInvalidArgument);
+    }
+
+private:
+    DeviceEventBuilder& builder_;
+};
+
+/// yaml-cpp event interface over DeviceEventBuilder. Mapping keys are told
+/// apart from values by position; anchored nodes are recorded so that
+/// aliases replay them, as the node API would have expanded them.
+class YamlEventHandler : public YAML::EventHandler {
+public:
+    explicit YamlEventHandler(DeviceEventBuilder& builder)
+        : builder_(builder) {}
+
+    void OnDocumentStart(const YAML::Mark&) override {}
+    void OnDocumentEnd() override {}
+
+    void OnNull(const YAML::Mark&, YAML::anchor_t anchor) override {
+        Handle({Event::kNull, {}}, anchor);
+    }
+    void OnAlias(const YAML::Mark&, YAML::anchor_t anchor) override {
+        auto it = anchors_.find(anchor);
+        if (it == anchors_.end()) {
+            builder_.Fail(core::ErrorCode::kInvalidArgument);
+            return;
+        }
+        for (const auto& event : it->second) {
+            Handle(event, YAML::NullAnchor);
+        }
+    }
+    void OnScalar(const YAML::Mark&, const std::string&, YAML::anchor_t anchor,
+                  const std::string& value) override {
+        Handle({Event::kScalar, value}, anchor);
+    }
+    void OnSequenceStart(const YAML::Mark&, const std::string&,
+                         YAML::anchor_t anchor, YAML::EmitterStyle::value) override {
+        Handle({Event::kSequenceStart, {}}, anchor);
+    }
+    void OnSequenceEnd() override { Handle({Event::kSequenceEnd, {}}, YAML::NullAnchor); }
+    void OnMapStart(const YAML::Mark&, const std::string&, YAML::anchor_t anchor,
+                    YAML::EmitterStyle::value) override {
+        Handle({Event::kMapStart, {}}, anchor);
+    }
+    void OnMapEnd() override { Handle({Event::kMapEnd, {}}, YAML::NullAnchor); }
+
+private:
+    struct Event {
+        enum Kind { kNull, kScalar, kSequenceStart, kSequenceEnd, kMapStart, kMapEnd };
+        Kind kind;
+        std::string value;
+    };
+
+    struct Recording {
+        YAML::anchor_t anchor;
+        int depth;
+        std::vector<Event> events;
+    };
+
+    void Handle(const Event& event, YAML::anchor_t anchor) {
+        if (builder_.Failed()) {
+            return;  // the parser cannot be stopped; drain quietly
+        }
+        if (anchor != YAML::NullAnchor) {
+            recordings_.push_back({anchor, 0, {}});
+        }
+        Record(event);
+        Dispatch(event);
+    }
+
+    void Record(const Event& event) {
+        for (auto& rec : recordings_) {
+            rec.events.push_back(event);
+            if (event.kind == Event::kSequenceStart || event.kind == Event::kMapStart) {
+                ++rec.depth;
+            } else if (event.kind == Event::kSequenceEnd || event.kind == Event::kMapEnd) {
+                --rec.depth;
+            }
+        }
+        // A recording is complete once its node has closed (scalars at once).
+        while (!recordings_.empty() && recordings_.back().depth == 0) {
+            anchors_[recordings_.back().anchor] = std::move(recordings_.back().events);
+            recordings_.pop_back();
+        }
+    }
+
+    void Dispatch(const Event& event) {
+        bool key_position = !open_.empty() && open_.back().expect_key;
+        switch (event.kind) {
+            case Event::kNull:
+            case Event::kScalar:
+                if (key_position) {
+                    // Node API: a null key reads as "null".
+                    builder_.Key(event.kind == Event::kNull ? "null" : event.value);
+                    open_.back().expect_key = false;
+                    return;
+                }
+                builder_.Value(event.kind == Event::kNull
+                                   ? nlohmann::json(nullptr)
+                                   : YamlScalarToJson(event.value));
+                AfterValue();
+                return;
+            case Event::kSequenceStart:
+            case Event::kMapStart: {
+                if (key_position) {
+                    builder_.Fail(core::ErrorCode::kInvalidArgument);  // complex key
+                    return;
+                }
+                bool map = event.kind == Event::kMapStart;
+                if (map) {
+                    builder_.StartObject();
+                } else {
+                    builder_.StartArray();
+                }
+                open_.push_back({map, map});
+                return;
+            }
+            case Event::kSequenceEnd:
+            case Event::kMapEnd:
+                open_.pop_back();
+                builder_.End();
+                AfterValue();
+                return;
+        }
+    }
+
+    /// In a mapping, a finished value means a key comes next.
+    void AfterValue() {
+        if (!open_.empty() && open_.back().map) {
+            open_.back().expect_key = true;
+        }
+    }
+
+    struct Collection {
+        bool map;
+        bool expect_key;
+    };
+
+    DeviceEventBuilder& builder_;
+    std::vector<Collection> open_;
+    std::vector<Recording> recordings_;
+    std::map<YAML::anchor_t, std::vector<Event>> anchors_;
+};
+
+}  // namespace
+
+core::Result<size_t> StreamJsonDevices(const std::string& path,
+                                       const DeviceEntrySink& sink) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotFound);
+    }
+
+    DeviceEventBuilder builder(sink);
+    JsonSaxHandler handler(builder);
+    if (!nlohmann::json::sax_parse(file, &handler) && !builder.Failed()) {
+        builder.Fail(core::ErrorCode::kInvalidArgument);
+    }
+    return builder.Finish();
+}
+
+core::Result<size_t> StreamYamlDevices(const std::string& path,
+                                       const DeviceEntrySink& sink) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotFound);
+    }
+
+    DeviceEventBuilder builder(sink);
+    YamlEventHandler handler(builder);
+    try {
+        YAML::Parser parser(file);
+        parser.HandleNextDocument(handler);
+    } catch (const YAML::ParserException&) {
+        builder.Fail(core::ErrorCode::kInvalidArgument);
+    }
+    return builder.Finish();
+}
+
+}  // namespace plas::config::detail
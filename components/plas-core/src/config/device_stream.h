@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+#include "plas/config/config.h"
+#include "plas/core/result.h"
+
+namespace plas::config::detail {
+
+/// Event-driven parsers behind Config::StreamFromFile. Neither builds a
+/// document tree: each device is handed to `sink` as soon as its closing
+/// brace / end of mapping is read. Validation matches ParseDeviceEntries.
+core::Result<size_t> StreamJsonDevices(const std::string& path,
+                                       const DeviceEntrySink& sink);
+core::Result<size_t> StreamYamlDevices(const std::string& path,
+                                       const DeviceEntrySink& sink);
+
+}  // namespace plas::config::detail
@@ -0,0 +1,228 @@
+#include "plas/config/device_table.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+
+namespace plas::config {
+
+std::optional<std::string_view> DeviceEntryView::FindArg(
+    std::string_view key) const {
+    const DeviceArg* it = std::lower_bound(
+        ArgsBegin(), ArgsEnd(), key,
+        [](const DeviceArg& arg, std::string_view k) { return arg.key < k; });
+    if (it != ArgsEnd() && it->key == key) {
+        return it->value;
+    }
+    return std::nullopt;
+}
+
+DeviceEntry DeviceEntryView::ToEntry() const {
+    DeviceEntry entry;
+    entry.nickname = std::string(nickname_);
+    entry.uri = std::string(uri_);
+    entry.driver = std::string(driver_);
+    for (const DeviceArg* arg = ArgsBegin(); arg != ArgsEnd(); ++arg) {
+        // Sorted input: hinting at end() makes each insert O(1).
+        entry.args.emplace_hint(entry.args.end(), std::string(arg->key),
+                                std::string(arg->value));
+    }
+    return entry;
+}
+
+namespace {
+
+constexpr size_t kArenaBlockSize = 16 * 1024;
+
+struct PendingEntry {
+    std::string_view nickname;
+    std::string_view uri;
+    std::string_view driver;
+    size_t arg_begin;
+};
+
+}  // namespace
+
+struct DeviceTable::Impl {
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t block_used = 0;
+    size_t block_size = 0;
+    size_t arena_bytes = 0;
+
+    std::unordered_set<std::string_view> interned;
+    std::vector<DeviceArg> args;
+    std::vector<PendingEntry> pending;
+
+    std::vector<DeviceEntryView> entries;
+    std::vector<size_t> by_nickname;  // entry indices sorted by nickname
+
+    char* Allocate(size_t size) {
+        if (size > kArenaBlockSize / 4) {
+            // Oversized strings get a block of their own, slotted in before
+            // the current block so it keeps its free space.
+            auto pos = blocks.empty() ? blocks.end() : blocks.end() - 1;
+            char* block = blocks.insert(pos, std::make_unique<char[]>(size))->get();
+            arena_bytes += size;
+            return block;
+        }
+        if (size > block_size - block_used) {
+            blocks.push_back(std::make_unique<char[]>(kArenaBlockSize));
+            arena_bytes += kArenaBlockSize;
+            block_size = kArenaBlockSize;
+            block_used = 0;
+        }
+        char* dst = blocks.back().get() + block_used;
+        block_used += size;
+        return dst;
+    }
+
+    std::string_view Copy(std::string_view s) {
+        if (s.empty()) {
+            return {};
+        }
+        char* dst = Allocate(s.size());
+        std::memcpy(dst, s.data(), s.size());
+        return std::string_view(dst, s.size());
+    }
+
+    std::string_view Intern(std::string_view s) {
+        auto it = interned.find(s);
+        if (it != interned.end()) {
+            return *it;
+        }
+        std::string_view copy = Copy(s);
+        interned.insert(copy);
+        return copy;
+    }
+};
+
+DeviceTable::DeviceTable() : impl_(std::make_unique<Impl>()) {}
+
+DeviceTable::~DeviceTable() = default;
+
+DeviceTable::DeviceTable(DeviceTable&& other) noexcept = default;
+
+DeviceTable& DeviceTable::operator=(DeviceTable&& other) noexcept = default;
+
+size_t DeviceTable::Size() const {
+    return impl_->entries.size();
+}
+
+bool DeviceTable::Empty() const {
+    return impl_->entries.empty();
+}
+
+const DeviceEntryView& DeviceTable::operator[](size_t index) const {
+    return impl_->entries[index];
+}
+
+const DeviceEntryView* DeviceTable::begin() const {
+    return impl_->entries.data();
+}
+
+const DeviceEntryView* DeviceTable::end() const {
+    return impl_->entries.data() + impl_->entries.size();
+}
+
+std::optional<DeviceEntryView> DeviceTable::Find(
+    std::string_view nickname) const {
+    const auto& entries = impl_->entries;
+    auto it = std::lower_bound(
+        impl_->by_nickname.begin(), impl_->by_nickname.end(), nickname,
+        [&entries](size_t index, std::string_view name) {
+            return entries[index].Nickname() < name;
+        });
+    if (it != impl_->by_nickname.end() &&
+        entries[*it].Nickname() == nickname) {
+        return entries[*it];
+    }
+    return std::nullopt;
+}
+
+std::vector<DeviceEntry> DeviceTable::ToEntries() const {
+    std::vector<DeviceEntry> result;
+    result.reserve(Size());
+    for (const auto& entry : *this) {
+        result.push_back(entry.ToEntry());
+    }
+    return result;
+}
+
+size_t DeviceTable::ArenaBytes() const {
+    return impl_->arena_bytes;
+}
+
+size_t DeviceTable::InternedCount() const {
+    return impl_->interned.size();
+}
+
+void DeviceTable::BeginEntry(std::string_view nickname, std::string_view uri,
+                             std::string_view driver) {
+    impl_->pending.push_back({impl_->Copy(nickname), impl_->Copy(uri),
+                              impl_->Intern(driver), impl_->args.size()});
+}
+
+void DeviceTable::AddArg(std::string_view key, std::string_view value) {
+    impl_->args.push_back({impl_->Intern(key), impl_->Intern(value)});
+}
+
+void DeviceTable::Finish() {
+    auto& impl = *impl_;
+    impl.entries.clear();
+    impl.entries.reserve(impl.pending.size());
+    std::vector<size_t> arg_offsets;
+    arg_offsets.reserve(impl.pending.size());
+
+    // Sort each entry's args by key (last value wins on a repeated key, as
+    // with DeviceEntry::args) and compact them in place.
+    size_t out = 0;
+    for (size_t i = 0; i < impl.pending.size(); ++i) {
+        const auto& pending = impl.pending[i];
+        size_t arg_end = i + 1 < impl.pending.size()
+                             ? impl.pending[i + 1].arg_begin
+                             : impl.args.size();
+        auto first = impl.args.begin() + static_cast<ptrdiff_t>(pending.arg_begin);
+        auto last = impl.args.begin() + static_cast<ptrdiff_t>(arg_end);
+        std::stable_sort(first, last, [](const DeviceArg& a, const DeviceArg& b) {
+            return a.key < b.key;
+        });
+
+        size_t entry_begin = out;
+        for (auto it = first; it != last; ++it) {
+            if (out > entry_begin && impl.args[out - 1].key == it->key) {
+                impl.args[out - 1].value = it->value;
+            } else {
+                impl.args[out++] = *it;
+            }
+        }
+
+        DeviceEntryView view;
+        view.nickname_ = pending.nickname;
+        view.uri_ = pending.uri;
+        view.driver_ = pending.driver;
+        view.arg_count_ = out - entry_begin;
+        impl.entries.push_back(view);
+        arg_offsets.push_back(entry_begin);
+    }
+    impl.args.resize(out);
+    impl.args.shrink_to_fit();
+    // args has its final address now.
+    for (size_t i = 0; i < impl.entries.size(); ++i) {
+        impl.entries[i].args_ = impl.args.data() + arg_offsets[i];
+    }
+    impl.pending.clear();
+    impl.pending.shrink_to_fit();
+
+    impl.by_nickname.resize(impl.entries.size());
+    for (size_t i = 0; i < impl.by_nickname.size(); ++i) {
+        impl.by_nickname[i] = i;
+    }
+    std::stable_sort(impl.by_nickname.begin(), impl.by_nickname.end(),
+                     [&impl](size_t a, size_t b) {
+                         return impl.entries[a].Nickname() <
+                                impl.entries[b].Nickname();
+                     });
+}
+
+}  // namespace plas::config
@@ -0,0 +1,78 @@
+#include "plas/config/device_uri.h"
+
+namespace plas::config {
+
+DeviceUri DeviceUri::Parse(std::string_view uri) {
+    DeviceUri parsed;
+    auto scheme_end = uri.find("://");
+    if (scheme_end == std::string_view::npos || scheme_end == 0 ||
+        scheme_end + 3 == uri.size()) {
+        return parsed;
+    }
+    parsed.scheme_ = uri.substr(0, scheme_end);
+    parsed.authority_ = uri.substr(scheme_end + 3);
+
+    size_t begin = 0;
+    const auto& authority = parsed.authority_;
+    for (size_t i = 0; i <= authority.size(); ++i) {
+        if (i < authority.size() && authority[i] != ':') {
+            continue;
+        }
+        if (i == begin || parsed.field_count_ == kMaxFields) {
+            return DeviceUri();  // empty field or too many
+        }
+        parsed.fields_[parsed.field_count_++] = authority.substr(begin, i - begin);
+        begin = i + 1;
+    }
+    parsed.valid_ = true;
+    return parsed;
+}
+
+bool DeviceUri::ParseNumber(std::string_view text, int base, uint64_t max,
+                            uint64_t& out) {
+    if (text.empty()) {
+        return false;
+    }
+    size_t pos = 0;
+    if (base == 0) {
+        base = 10;
+        if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+            base = 16;
+            pos = 2;
+        } else if (text.size() > 1 && text[0] == '0') {
+            base = 8;
+            pos = 1;
+        }
+    } else if (base == 16 && text.size() > 2 && text[0] == '0' &&
+               (text[1] == 'x' || text[1] == 'X')) {
+        pos = 2;
+    }
+
+    uint64_t value = 0;
+    for (; pos < text.size(); ++pos) {
+        char c = text[pos];
+        int digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else {
+            return false;
+        }
+        if (digit >= base) {
+            return false;
+        }
+        auto b = static_cast<uint64_t>(base);
+        auto d = static_cast<uint64_t>(digit);
+        if (d > max || value > (max - d) / b) {
+            return false;  // exceeds max
+        }
+        value = value * b + d;
+    }
+    out = value;
+    return true;
+}
+
+}  // namespace plas::config
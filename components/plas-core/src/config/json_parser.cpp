@@ -9,18 +9,28 @@
 
 namespace plas::config::detail {
 
-core::Result<std::vector<DeviceEntry>> ParseJsonConfig(const std::string& path) {
+core::Result<nlohmann::json> LoadJsonFile(const std::string& path) {
     std::ifstream file(path);
     if (!file.is_open()) {
-        return core::Result<std::vector<DeviceEntry>>::Err(core::ErrorCode::kNotFound);
+        return core::Result<nlohmann::json>::Err(core::ErrorCode::kNotFound);
     }
 
     nlohmann::json root;
     try {
         file >> root;
     } catch (const nlohmann::json::parse_error&) {
-        return core::Result<std::vector<DeviceEntry>>::Err(core::ErrorCode::kInvalidArgument);
+        return core::Result<nlohmann::json>::Err(core::ErrorCode::kInvalidArgument);
     }
+    return core::Result<nlohmann::json>::Ok(std::move(root));
+}
+
+core::Result<std::vector<DeviceEntry>> ParseJsonConfig(const std::string& path) {
+    auto json_result = LoadJsonFile(path);
+    if (json_result.IsError()) {
+        return core::Result<std::vector<DeviceEntry>>::Err(json_result.Error());
+    }
+
+    auto& root = json_result.Value();
 
     if (!root.contains("devices")) {
         return core::Result<std::vector<DeviceEntry>>::Err(core::ErrorCode::kInvalidArgument);
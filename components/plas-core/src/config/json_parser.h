@@ -3,11 +3,16 @@
 #include <string>
 #include <vector>
 
+#include <nlohmann/json.hpp>
+
 #include "plas/config/device_entry.h"
 #include "plas/core/result.h"
 
 namespace plas::config::detail {
 
+/// kNotFound if the file cannot be opened, kInvalidArgument on bad JSON.
+core::Result<nlohmann::json> LoadJsonFile(const std::string& path);
+
 core::Result<std::vector<DeviceEntry>> ParseJsonConfig(const std::string& path);
 
 }  // namespace plas::config::detail
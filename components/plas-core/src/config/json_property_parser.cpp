@@ -12,23 +12,23 @@ namespace {
 
 void FlattenJson(const nlohmann::json& node,
                  const std::string& prefix,
-                 core::Properties& props) {
+                 std::vector<PropertyValue>& out) {
     for (auto it = node.begin(); it != node.end(); ++it) {
         std::string key = prefix.empty() ? it.key() : prefix + "." + it.key();
         const auto& val = it.value();
 
         if (val.is_object()) {
-            FlattenJson(val, key, props);
+            FlattenJson(val, key, out);
         } else if (val.is_boolean()) {
-            props.Set(key, val.get<bool>());
+            out.push_back({key, val.get<bool>()});
         } else if (val.is_number_integer()) {
-            props.Set(key, val.get<int64_t>());
+            out.push_back({key, val.get<int64_t>()});
         } else if (val.is_number_float()) {
-            props.Set(key, val.get<double>());
+            out.push_back({key, val.get<double>()});
         } else if (val.is_string()) {
-            props.Set(key, val.get<std::string>());
+            out.push_back({key, val.get<std::string>()});
         } else if (val.is_array()) {
-            props.Set(key, val.dump());
+            out.push_back({key, val.dump()});
         }
         // null → skip
     }
@@ -36,61 +36,62 @@ void FlattenJson(const nlohmann::json& node,
 
 }  // namespace
 
-core::Result<void> PopulatePropertiesFromJson(
-    const std::string& path, core::Properties& props) {
+core::Result<std::vector<PropertyValue>> ParsePropertiesFromJson(
+    const std::string& path) {
     std::ifstream file(path);
     if (!file.is_open()) {
-        return core::Result<void>::Err(core::ErrorCode::kNotFound);
+        return core::Result<std::vector<PropertyValue>>::Err(core::ErrorCode::kNotFound);
     }
 
     nlohmann::json root;
     try {
         file >> root;
     } catch (const nlohmann::json::parse_error&) {
-        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        return core::Result<std::vector<PropertyValue>>::Err(core::ErrorCode::kInvalidArgument);
     }
 
     if (!root.is_object()) {
-        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        return core::Result<std::vector<PropertyValue>>::Err(core::ErrorCode::kInvalidArgument);
     }
 
-    FlattenJson(root, "", props);
-    return core::Result<void>::Ok();
+    std::vector<PropertyValue> values;
+    FlattenJson(root, "", values);
+    return core::Result<std::vector<PropertyValue>>::Ok(std::move(values));
 }
 
-core::Result<std::vector<std::string>> PopulateSessionsFromJson(
+core::Result<std::vector<PropertySession>> ParseSessionsFromJson(
     const std::string& path) {
     std::ifstream file(path);
     if (!file.is_open()) {
-        return core::Result<std::vector<std::string>>::Err(core::ErrorCode::kNotFound);
+        return core::Result<std::vector<PropertySession>>::Err(core::ErrorCode::kNotFound);
     }
 
     nlohmann::json root;
     try {
         file >> root;
     } catch (const nlohmann::json::parse_error&) {
-        return core::Result<std::vector<std::string>>::Err(core::ErrorCode::kInvalidArgument);
+        return core::Result<std::vector<PropertySession>>::Err(core::ErrorCode::kInvalidArgument);
     }
 
     if (!root.is_object()) {
-        return core::Result<std::vector<std::string>>::Err(core::ErrorCode::kInvalidArgument);
+        return core::Result<std::vector<PropertySession>>::Err(core::ErrorCode::kInvalidArgument);
     }
 
-    std::vector<std::string> session_names;
+    std::vector<PropertySession> sessions;
 
     for (auto it = root.begin(); it != root.end(); ++it) {
         if (!it.value().is_object()) {
-            return core::Result<std::vector<std::string>>::Err(
+            return core::Result<std::vector<PropertySession>>::Err(
                 core::ErrorCode::kInvalidArgument);
         }
 
-        const std::string& session_name = it.key();
-        auto& props = core::Properties::GetSession(session_name);
-        FlattenJson(it.value(), "", props);
-        session_names.push_back(session_name);
+        PropertySession session;
+        session.name = it.key();
+        FlattenJson(it.value(), "", session.values);
+        sessions.push_back(std::move(session));
     }
 
-    return core::Result<std::vector<std::string>>::Ok(std::move(session_names));
+    return core::Result<std::vector<PropertySession>>::Ok(std::move(sessions));
 }
 
 }  // namespace plas::config::detail
@@ -1,50 +1,111 @@
 #include "plas/config/property_manager.h"
 
 #include <algorithm>
+#include <utility>
 
 #include "plas/core/error.h"
+#include "plas/core/executor.h"
 
+#include "compiled_config.h"
 #include "json_property_parser.h"
 #include "yaml_property_parser.h"
 
 namespace plas::config {
 
+namespace {
+
+/// Sessions from `path`, through the compiled config cache. Single-session
+/// loads come back as one unnamed session.
+core::Result<std::vector<detail::PropertySession>> LoadSessions(
+    const std::string& path, ConfigFormat fmt, bool single_session) {
+    using SessionsResult = core::Result<std::vector<detail::PropertySession>>;
+
+    if (fmt != ConfigFormat::kJson && fmt != ConfigFormat::kYaml) {
+        return SessionsResult::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::string tag = single_session ? "properties" : "sessions";
+    tag += fmt == ConfigFormat::kJson ? ":json" : ":yaml";
+
+    return detail::LoadCompiled<std::vector<detail::PropertySession>>(
+        path, tag, [&path, fmt, single_session]() -> SessionsResult {
+            if (!single_session) {
+                return fmt == ConfigFormat::kJson
+                           ? detail::ParseSessionsFromJson(path)
+                           : detail::ParseSessionsFromYaml(path);
+            }
+            auto values = fmt == ConfigFormat::kJson
+                              ? detail::ParsePropertiesFromJson(path)
+                              : detail::ParsePropertiesFromYaml(path);
+            if (values.IsError()) {
+                return SessionsResult::Err(values.Error());
+            }
+            std::vector<detail::PropertySession> sessions(1);
+            sessions[0].values = std::move(values).Value();
+            return SessionsResult::Ok(std::move(sessions));
+        });
+}
+
+/// One session of a parsed file, ready to commit.
+struct ParsedSession {
+    std::string name;
+    core::PropertyBatch batch;
+};
+
+/// Parse a multi-session file into batches. Takes no lock.
+core::Result<std::vector<ParsedSession>> ParseSessions(const std::string& path,
+                                                       ConfigFormat fmt) {
+    using ParsedResult = core::Result<std::vector<ParsedSession>>;
+    auto sessions = LoadSessions(path, fmt, false);
+    if (sessions.IsError()) {
+        return ParsedResult::Err(sessions.Error());
+    }
+    std::vector<ParsedSession> parsed;
+    parsed.reserve(sessions.Value().size());
+    for (auto& session : sessions.Value()) {
+        parsed.push_back({std::move(session.name), detail::MakeBatch(session.values)});
+    }
+    return ParsedResult::Ok(std::move(parsed));
+}
+
+}  // namespace
+
 PropertyManager& PropertyManager::GetInstance() {
-    static PropertyManager instance;
+    static PropertyManager instance{GlobalTag{}};
     return instance;
 }
 
+PropertyManager::PropertyManager() = default;
+
+PropertyManager::PropertyManager(GlobalTag) : global_(true) {}
+
+PropertyManager::~PropertyManager() = default;
+
+core::Properties& PropertyManager::Resolve(const std::string& name) {
+    if (global_) {
+        return core::Properties::GetSession(name);
+    }
+    std::lock_guard lock(mutex_);
+    auto& session = sessions_[name];
+    if (!session) {
+        session = core::Properties::CreateDetached(name);
+    }
+    return *session;
+}
+
 core::Result<void> PropertyManager::LoadFromFile(
     const std::string& path, ConfigFormat fmt) {
     if (fmt == ConfigFormat::kAuto) {
         fmt = DetectFormat(path);
     }
 
-    core::Result<std::vector<std::string>> result =
-        core::Result<std::vector<std::string>>::Err(core::ErrorCode::kInvalidArgument);
-
-    switch (fmt) {
-        case ConfigFormat::kJson:
-            result = detail::PopulateSessionsFromJson(path);
-            break;
-        case ConfigFormat::kYaml:
-            result = detail::PopulateSessionsFromYaml(path);
-            break;
-        default:
-            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
-    }
-
+    auto result = ParseSessions(path, fmt);
     if (result.IsError()) {
         return core::Result<void>::Err(result.Error());
     }
 
-    std::lock_guard lock(mutex_);
-    auto& names = result.Value();
-    for (auto& name : names) {
-        if (std::find(managed_sessions_.begin(), managed_sessions_.end(), name) ==
-            managed_sessions_.end()) {
-            managed_sessions_.push_back(std::move(name));
-        }
+    for (const auto& session : result.Value()) {
+        Resolve(session.name).SetMany(session.batch);
+        AddManagedSession(session.name);
     }
 
     return core::Result<void>::Ok();
@@ -58,37 +119,48 @@ core::Result<void> PropertyManager::LoadFromFile(
         fmt = DetectFormat(path);
     }
 
-    auto& props = core::Properties::GetSession(session_name);
-
-    core::Result<void> result =
-        core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
-
-    switch (fmt) {
-        case ConfigFormat::kJson:
-            result = detail::PopulatePropertiesFromJson(path, props);
-            break;
-        case ConfigFormat::kYaml:
-            result = detail::PopulatePropertiesFromYaml(path, props);
-            break;
-        default:
-            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
-    }
-
+    auto result = LoadSessions(path, fmt, true);
     if (result.IsError()) {
         return core::Result<void>::Err(result.Error());
     }
 
-    std::lock_guard lock(mutex_);
-    if (std::find(managed_sessions_.begin(), managed_sessions_.end(), session_name) ==
-        managed_sessions_.end()) {
-        managed_sessions_.push_back(session_name);
+    auto& props = Resolve(session_name);
+    for (const auto& session : result.Value()) {
+        detail::ApplyProperties(session.values, props);
     }
+    AddManagedSession(session_name);
 
     return core::Result<void>::Ok();
 }
 
+std::vector<core::Result<void>> PropertyManager::LoadFromFiles(
+    const std::vector<std::string>& paths, std::size_t workers) {
+    std::vector<core::Result<std::vector<ParsedSession>>> parsed(
+        paths.size(),
+        core::Result<std::vector<ParsedSession>>::Err(core::ErrorCode::kNotInitialized));
+    core::Executor::Shared().ParallelFor(
+        paths.size(),
+        [&](std::size_t i) { parsed[i] = ParseSessions(paths[i], DetectFormat(paths[i])); },
+        workers);
+
+    std::vector<core::Result<void>> results;
+    results.reserve(paths.size());
+    for (const auto& file : parsed) {
+        if (file.IsError()) {
+            results.push_back(core::Result<void>::Err(file.Error()));
+            continue;
+        }
+        for (const auto& session : file.Value()) {
+            Resolve(session.name).SetMany(session.batch);
+            AddManagedSession(session.name);
+        }
+        results.push_back(core::Result<void>::Ok());
+    }
+    return results;
+}
+
 core::Properties& PropertyManager::Session(const std::string& name) {
-    return core::Properties::GetSession(name);
+    return Resolve(name);
 }
 
 bool PropertyManager::HasSession(const std::string& name) const {
@@ -105,11 +177,23 @@ std::vector<std::string> PropertyManager::SessionNames() const {
 void PropertyManager::Reset() {
     std::lock_guard lock(mutex_);
     for (const auto& name : managed_sessions_) {
-        core::Properties::DestroySession(name);
+        if (global_) {
+            core::Properties::DestroySession(name);
+        } else {
+            sessions_.erase(name);
+        }
     }
     managed_sessions_.clear();
 }
 
+void PropertyManager::AddManagedSession(const std::string& name) {
+    std::lock_guard lock(mutex_);
+    if (std::find(managed_sessions_.begin(), managed_sessions_.end(), name) ==
+        managed_sessions_.end()) {
+        managed_sessions_.push_back(name);
+    }
+}
+
 ConfigFormat PropertyManager::DetectFormat(const std::string& path) {
     auto dot_pos = path.rfind('.');
     if (dot_pos == std::string::npos) {
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "plas/core/properties.h"
+
+namespace plas::config::detail {
+
+/// One flattened property ("a.b.c" key) as read from a config file. The
+/// parsers produce these instead of writing Properties directly so a load
+/// can be compiled into the config cache and replayed later.
+struct PropertyValue {
+    std::string key;
+    std::variant<bool, int64_t, double, std::string> value;
+};
+
+struct PropertySession {
+    std::string name;
+    std::vector<PropertyValue> values;
+};
+
+/// Every value in order as one batch (a repeated key keeps the last
+/// value). Interns the keys; takes no session lock.
+inline core::PropertyBatch MakeBatch(const std::vector<PropertyValue>& values) {
+    core::PropertyBatch batch;
+    for (const auto& entry : values) {
+        std::visit([&](const auto& v) { batch.Set(entry.key, v); }, entry.value);
+    }
+    return batch;
+}
+
+/// Set every value in order (a repeated key keeps the last value), as one
+/// Properties commit.
+inline void ApplyProperties(const std::vector<PropertyValue>& values,
+                            core::Properties& props) {
+    props.SetMany(MakeBatch(values));
+}
+
+}  // namespace plas::config::detail
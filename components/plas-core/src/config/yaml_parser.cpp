@@ -7,14 +7,14 @@
 namespace plas::config::detail {
 
 core::Result<std::vector<DeviceEntry>> ParseYamlConfig(const std::string& path) {
-    auto json_result = LoadYamlFileAsJson(path);
-    if (json_result.IsError()) {
-        return core::Result<std::vector<DeviceEntry>>::Err(json_result.Error());
+    auto yaml_result = LoadYamlFile(path);
+    if (yaml_result.IsError()) {
+        return core::Result<std::vector<DeviceEntry>>::Err(yaml_result.Error());
     }
 
-    auto& root = json_result.Value();
-
-    if (!root.contains("devices")) {
+    // Const access: operator[] on a mutable node would insert the key.
+    const YAML::Node& root = yaml_result.Value();
+    if (!root.IsMap() || !root["devices"]) {
         return core::Result<std::vector<DeviceEntry>>::Err(core::ErrorCode::kInvalidArgument);
     }
 
@@ -12,21 +12,22 @@ namespace {
 
 void FlattenYaml(const YAML::Node& node,
                  const std::string& prefix,
-                 core::Properties& props) {
+                 std::vector<PropertyValue>& out) {
     for (auto it = node.begin(); it != node.end(); ++it) {
         std::string key = prefix.empty()
             ? it->first.as<std::string>()
             : prefix + "." + it->first.as<std::string>();
-        const auto& val = it->second;
+        // By value: it-> yields a temporary proxy.
+        const YAML::Node val = it->second;
 
         if (val.IsMap()) {
-            FlattenYaml(val, key, props);
+            FlattenYaml(val, key, out);
         } else if (val.IsScalar()) {
             const std::string& scalar = val.Scalar();
 
             // Try boolean
             if (scalar == "true" || scalar == "false") {
-                props.Set(key, val.as<bool>());
+                out.push_back({key, val.as<bool>()});
                 continue;
             }
 
@@ -35,7 +36,7 @@ void FlattenYaml(const YAML::Node& node,
                 std::size_t pos = 0;
                 int64_t int_val = std::stoll(scalar, &pos);
                 if (pos == scalar.size()) {
-                    props.Set(key, int_val);
+                    out.push_back({key, int_val});
                     continue;
                 }
             } catch (...) {}
@@ -45,18 +46,18 @@ void FlattenYaml(const YAML::Node& node,
                 std::size_t pos = 0;
                 double dbl_val = std::stod(scalar, &pos);
                 if (pos == scalar.size()) {
-                    props.Set(key, dbl_val);
+                    out.push_back({key, dbl_val});
                     continue;
                 }
             } catch (...) {}
 
             // Default to string
-            props.Set(key, scalar);
+            out.push_back({key, scalar});
         } else if (val.IsSequence()) {
             // Store arrays as JSON string representation
             YAML::Emitter emitter;
             emitter << YAML::Flow << val;
-            props.Set(key, std::string(emitter.c_str()));
+            out.push_back({key, std::string(emitter.c_str())});
         }
         // null → skip
     }
@@ -64,55 +65,56 @@ void FlattenYaml(const YAML::Node& node,
 
 }  // namespace
 
-core::Result<void> PopulatePropertiesFromYaml(
-    const std::string& path, core::Properties& props) {
+core::Result<std::vector<PropertyValue>> ParsePropertiesFromYaml(
+    const std::string& path) {
     YAML::Node root;
     try {
         root = YAML::LoadFile(path);
     } catch (const YAML::BadFile&) {
-        return core::Result<void>::Err(core::ErrorCode::kNotFound);
+        return core::Result<std::vector<PropertyValue>>::Err(core::ErrorCode::kNotFound);
     } catch (const YAML::ParserException&) {
-        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        return core::Result<std::vector<PropertyValue>>::Err(core::ErrorCode::kInvalidArgument);
     }
 
     if (!root.IsMap()) {
-        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        return core::Result<std::vector<PropertyValue>>::Err(core::ErrorCode::kInvalidArgument);
     }
 
-    FlattenYaml(root, "", props);
-    return core::Result<void>::Ok();
+    std::vector<PropertyValue> values;
+    FlattenYaml(root, "", values);
+    return core::Result<std::vector<PropertyValue>>::Ok(std::move(values));
 }
 
-core::Result<std::vector<std::string>> PopulateSessionsFromYaml(
+core::Result<std::vector<PropertySession>> ParseSessionsFromYaml(
     const std::string& path) {
     YAML::Node root;
     try {
         root = YAML::LoadFile(path);
     } catch (const YAML::BadFile&) {
-        return core::Result<std::vector<std::string>>::Err(core::ErrorCode::kNotFound);
+        return core::Result<std::vector<PropertySession>>::Err(core::ErrorCode::kNotFound);
     } catch (const YAML::ParserException&) {
-        return core::Result<std::vector<std::string>>::Err(core::ErrorCode::kInvalidArgument);
+        return core::Result<std::vector<PropertySession>>::Err(core::ErrorCode::kInvalidArgument);
     }
 
     if (!root.IsMap()) {
-        return core::Result<std::vector<std::string>>::Err(core::ErrorCode::kInvalidArgument);
+        return core::Result<std::vector<PropertySession>>::Err(core::ErrorCode::kInvalidArgument);
     }
 
-    std::vector<std::string> session_names;
+    std::vector<PropertySession> sessions;
 
     for (auto it = root.begin(); it != root.end(); ++it) {
         if (!it->second.IsMap()) {
-            return core::Result<std::vector<std::string>>::Err(
+            return core::Result<std::vector<PropertySession>>::Err(
                 core::ErrorCode::kInvalidArgument);
         }
 
-        std::string session_name = it->first.as<std::string>();
-        auto& props = core::Properties::GetSession(session_name);
-        FlattenYaml(it->second, "", props);
-        session_names.push_back(std::move(session_name));
+        PropertySession session;
+        session.name = it->first.as<std::string>();
+        FlattenYaml(it->second, "", session.values);
+        sessions.push_back(std::move(session));
     }
 
-    return core::Result<std::vector<std::string>>::Ok(std::move(session_names));
+    return core::Result<std::vector<PropertySession>>::Ok(std::move(sessions));
 }
 
 }  // namespace plas::config::detail
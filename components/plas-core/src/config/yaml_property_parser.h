@@ -3,17 +3,17 @@
 #include <string>
 #include <vector>
 
-#include "plas/core/properties.h"
 #include "plas/core/result.h"
+#include "property_values.h"
 
 namespace plas::config::detail {
 
-// Single session: populate a Properties session from YAML file root
-core::Result<void> PopulatePropertiesFromYaml(
-    const std::string& path, core::Properties& props);
+// Single session: flatten the whole YAML file root
+core::Result<std::vector<PropertyValue>> ParsePropertiesFromYaml(
+    const std::string& path);
 
 // Multi session: each top-level key becomes a session name
-core::Result<std::vector<std::string>> PopulateSessionsFromYaml(
+core::Result<std::vector<PropertySession>> ParseSessionsFromYaml(
     const std::string& path);
 
 }  // namespace plas::config::detail
@@ -1,53 +1,52 @@
 #include "yaml_to_json.h"
 
-#include <fstream>
-
-#include <yaml-cpp/yaml.h>
-
 #include "plas/core/error.h"
 
 namespace plas::config::detail {
 
 namespace {
 
+nlohmann::json ScalarNodeToJson(const YAML::Node& node) {
+    // Try bool first (YAML "true"/"false"/"yes"/"no" etc.)
+    try {
+        auto val = node.as<bool>();
+        // Only accept explicit bool-like strings to avoid "0"/"1" matching
+        auto raw = node.Scalar();
+        if (raw == "true" || raw == "false" || raw == "True" || raw == "False" ||
+            raw == "TRUE" || raw == "FALSE" || raw == "yes" || raw == "no" ||
+            raw == "Yes" || raw == "No" || raw == "YES" || raw == "NO" ||
+            raw == "on" || raw == "off" || raw == "On" || raw == "Off" ||
+            raw == "ON" || raw == "OFF") {
+            return val;
+        }
+    } catch (...) {}
+
+    // Try int64
+    try {
+        auto val = node.as<int64_t>();
+        // Verify round-trip to avoid partial float matches
+        if (std::to_string(val) == node.Scalar() || node.Scalar() == "0") {
+            return val;
+        }
+    } catch (...) {}
+
+    // Try double
+    try {
+        auto val = node.as<double>();
+        return val;
+    } catch (...) {}
+
+    // Fallback: string
+    return node.as<std::string>();
+}
+
 nlohmann::json YamlNodeToJson(const YAML::Node& node) {
     switch (node.Type()) {
         case YAML::NodeType::Null:
             return nullptr;
 
-        case YAML::NodeType::Scalar: {
-            // Try bool first (YAML "true"/"false"/"yes"/"no" etc.)
-            try {
-                auto val = node.as<bool>();
-                // Only accept explicit bool-like strings to avoid "0"/"1" matching
-                auto raw = node.Scalar();
-                if (raw == "true" || raw == "false" || raw == "True" || raw == "False" ||
-                    raw == "TRUE" || raw == "FALSE" || raw == "yes" || raw == "no" ||
-                    raw == "Yes" || raw == "No" || raw == "YES" || raw == "NO" ||
-                    raw == "on" || raw == "off" || raw == "On" || raw == "Off" ||
-                    raw == "ON" || raw == "OFF") {
-                    return val;
-                }
-            } catch (...) {}
-
-            // Try int64
-            try {
-                auto val = node.as<int64_t>();
-                // Verify round-trip to avoid partial float matches
-                if (std::to_string(val) == node.Scalar() || node.Scalar() == "0") {
-                    return val;
-                }
-            } catch (...) {}
-
-            // Try double
-            try {
-                auto val = node.as<double>();
-                return val;
-            } catch (...) {}
-
-            // Fallback: string
-            return node.as<std::string>();
-        }
+        case YAML::NodeType::Scalar:
+            return ScalarNodeToJson(node);
 
         case YAML::NodeType::Sequence: {
             auto arr = nlohmann::json::array();
@@ -72,17 +71,26 @@ nlohmann::json YamlNodeToJson(const YAML::Node& node) {
 
 }  // namespace
 
-core::Result<nlohmann::json> LoadYamlFileAsJson(const std::string& path) {
-    YAML::Node root;
+nlohmann::json YamlScalarToJson(const std::string& scalar) {
+    return ScalarNodeToJson(YAML::Node(scalar));
+}
+
+nlohmann::json YamlScalarToJson(const YAML::Node& node) {
+    return node.IsScalar() ? ScalarNodeToJson(node) : nlohmann::json(nullptr);
+}
+
+nlohmann::json YamlToJson(const YAML::Node& node) {
+    return YamlNodeToJson(node);
+}
+
+core::Result<YAML::Node> LoadYamlFile(const std::string& path) {
     try {
-        root = YAML::LoadFile(path);
+        return core::Result<YAML::Node>::Ok(YAML::LoadFile(path));
     } catch (const YAML::BadFile&) {
-        return core::Result<nlohmann::json>::Err(core::ErrorCode::kNotFound);
+        return core::Result<YAML::Node>::Err(core::ErrorCode::kNotFound);
     } catch (const YAML::ParserException&) {
-        return core::Result<nlohmann::json>::Err(core::ErrorCode::kInvalidArgument);
+        return core::Result<YAML::Node>::Err(core::ErrorCode::kInvalidArgument);
     }
-
-    return core::Result<nlohmann::json>::Ok(YamlNodeToJson(root));
 }
 
 }  // namespace plas::config::detail
@@ -3,11 +3,23 @@
 #include <string>
 
 #include <nlohmann/json.hpp>
+#include <yaml-cpp/yaml.h>
 
 #include "plas/core/result.h"
 
 namespace plas::config::detail {
 
-core::Result<nlohmann::json> LoadYamlFileAsJson(const std::string& path);
+/// kNotFound if the file cannot be opened, kInvalidArgument on bad YAML.
+core::Result<YAML::Node> LoadYamlFile(const std::string& path);
+
+/// The JSON value a plain YAML scalar stands for: bool, integer, double,
+/// else string. Config code types YAML scalars through this so YAML and
+/// JSON inputs read the same.
+nlohmann::json YamlScalarToJson(const std::string& scalar);
+nlohmann::json YamlScalarToJson(const YAML::Node& node);
+
+/// Whole-tree conversion. Only ConfigNode::Dump() needs it (configspec
+/// validates the dumped JSON); the config loaders read YAML natively.
+nlohmann::json YamlToJson(const YAML::Node& node);
 
 }  // namespace plas::config::detail
@@ -0,0 +1,396 @@
+#include "plas/core/batch_io.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <initializer_list>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+// OPENAT/READ/CLOSE and the opcode probe arrived together (Linux 5.6).
+#if defined(__NR_io_uring_setup) && defined(IO_URING_OP_SUPPORTED)
+#define PLAS_IO_URING_UAPI 1
+#endif
+#endif
+
+#include "plas/core/error.h"
+
+namespace plas::core {
+
+namespace {
+
+std::error_code ErrnoCode(int err) {
+    switch (err) {
+        case ENOENT:
+        case ENODEV:
+        case ENXIO:
+            return make_error_code(ErrorCode::kNotFound);
+        case EACCES:
+        case EPERM:
+            return make_error_code(ErrorCode::kPermissionDenied);
+        default:
+            return make_error_code(ErrorCode::kIOError);
+    }
+}
+
+int OpenForRead(BatchRead& read) {
+    int fd = ::open(read.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        read.error = ErrnoCode(errno);
+    }
+    return fd;
+}
+
+void PreadInto(BatchRead& read, int fd) {
+    auto n = ::pread(fd, read.buffer, read.length,
+                     static_cast<off_t>(read.offset));
+    if (n < 0) {
+        read.error = ErrnoCode(errno);
+        return;
+    }
+    read.transferred = static_cast<std::size_t>(n);
+}
+
+void ReadOne(BatchRead& read) {
+    if (read.fd >= 0) {
+        PreadInto(read, read.fd);
+        return;
+    }
+    int fd = OpenForRead(read);
+    if (fd < 0) {
+        return;
+    }
+    PreadInto(read, fd);
+    ::close(fd);
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Ring — a raw io_uring (no liburing), one submission per phase
+// ---------------------------------------------------------------------------
+
+struct BatchReader::Ring {
+#ifdef PLAS_IO_URING_UAPI
+    int fd = -1;
+    unsigned entries = 0;
+    void* sq_map = nullptr;
+    std::size_t sq_map_size = 0;
+    void* cq_map = nullptr;
+    std::size_t cq_map_size = 0;
+    io_uring_sqe* sqes = nullptr;
+    std::size_t sqes_size = 0;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    ~Ring() {
+        if (sqes) ::munmap(sqes, sqes_size);
+        if (cq_map && cq_map != sq_map) ::munmap(cq_map, cq_map_size);
+        if (sq_map) ::munmap(sq_map, sq_map_size);
+        if (fd >= 0) ::close(fd);
+    }
+
+    /// nullptr if the kernel has no io_uring, refuses it, or lacks one of
+    /// the opcodes a batch uses.
+    static std::unique_ptr<Ring> Create(unsigned depth) {
+        io_uring_params params{};
+        params.flags = IORING_SETUP_CLAMP;
+        int fd = static_cast<int>(
+            ::syscall(__NR_io_uring_setup, std::max(depth, 1u), &params));
+        if (fd < 0) {
+            return nullptr;
+        }
+        auto ring = std::make_unique<Ring>();
+        ring->fd = fd;
+        ring->entries = params.sq_entries;
+
+        ring->sq_map_size =
+            params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        ring->cq_map_size =
+            params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) {
+            ring->sq_map_size = ring->cq_map_size =
+                std::max(ring->sq_map_size, ring->cq_map_size);
+        }
+        ring->sq_map = Map(fd, ring->sq_map_size, IORING_OFF_SQ_RING);
+        if (!ring->sq_map) {
+            return nullptr;
+        }
+        ring->cq_map = single ? ring->sq_map
+                              : Map(fd, ring->cq_map_size, IORING_OFF_CQ_RING);
+        if (!ring->cq_map) {
+            return nullptr;
+        }
+        ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        ring->sqes = static_cast<io_uring_sqe*>(
+            Map(fd, ring->sqes_size, IORING_OFF_SQES));
+        if (!ring->sqes) {
+            return nullptr;
+        }
+
+        auto* sq = static_cast<char*>(ring->sq_map);
+        auto* cq = static_cast<char*>(ring->cq_map);
+        ring->sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        ring->sq_mask =
+            reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        ring->sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        ring->cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        ring->cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        ring->cq_mask =
+            reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        ring->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        return ring->Supports({IORING_OP_OPENAT, IORING_OP_READ,
+                               IORING_OP_CLOSE})
+                   ? std::move(ring)
+                   : nullptr;
+    }
+
+    static void* Map(int fd, std::size_t size, off_t offset) {
+        void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, fd, offset);
+        return map == MAP_FAILED ? nullptr : map;
+    }
+
+    bool Supports(std::initializer_list<int> ops) const {
+        constexpr unsigned kProbeOps = 256;
+        std::vector<char> storage(sizeof(io_uring_probe) +
+                                  kProbeOps * sizeof(io_uring_probe_op));
+        auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+        if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe,
+                      kProbeOps) < 0) {
+            return false;
+        }
+        return std::all_of(ops.begin(), ops.end(), [&](int op) {
+            return op <= probe->last_op &&
+                   (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+        });
+    }
+
+    /// Submit `count` (<= entries) requests, prepare(sqe, k) filling the
+    /// k-th, and reap them all, calling complete(k, res). False if the
+    /// ring failed before anything was submitted; those requests are not
+    /// completed.
+    template <typename Prepare, typename Complete>
+    bool Run(std::size_t count, Prepare&& prepare, Complete&& complete) {
+        unsigned tail = *sq_tail;  // only this thread moves it
+        for (std::size_t k = 0; k < count; ++k, ++tail) {
+            unsigned index = tail & *sq_mask;
+            io_uring_sqe& sqe = sqes[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            prepare(sqe, k);
+            sqe.user_data = k;
+            sq_array[index] = index;
+        }
+        __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+
+        auto to_submit = static_cast<unsigned>(count);
+        std::size_t submitted = 0, reaped = 0;
+        while (reaped < count) {
+            int n = static_cast<int>(
+                ::syscall(__NR_io_uring_enter, fd, to_submit, 1u,
+                          IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (n < 0) {
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                    continue;
+                }
+                if (submitted == reaped) {
+                    return false;
+                }
+                // Requests in flight still target the callers' buffers:
+                // keep waiting for them.
+                to_submit = 0;
+                continue;
+            }
+            to_submit -= static_cast<unsigned>(n);
+            submitted += static_cast<std::size_t>(n);
+
+            unsigned head = *cq_head;
+            unsigned ready = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+            for (; head != ready; ++head, ++reaped) {
+                const io_uring_cqe& cqe = cqes[head & *cq_mask];
+                complete(static_cast<std::size_t>(cqe.user_data), cqe.res);
+            }
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        }
+        return true;
+    }
+
+    /// One chunk of at most `entries` reads: open all, read all, close
+    /// all. False if the ring failed; every read still gets its result
+    /// through the fallback.
+    bool ReadChunk(BatchRead* reads, std::size_t count) {
+        bool healthy = true;
+        std::vector<int> fds(count, -1);
+        std::vector<char> opened(count, 0);
+        std::vector<std::size_t> items;
+        std::vector<char> done;
+
+        // -- open --
+        for (std::size_t i = 0; i < count; ++i) {
+            if (reads[i].error) {
+                continue;  // rejected before the batch
+            }
+            if (reads[i].fd >= 0) {
+                fds[i] = reads[i].fd;
+            } else {
+                items.push_back(i);
+            }
+        }
+        done.assign(items.size(), 0);
+        if (!items.empty()) {
+            healthy = Run(
+                items.size(),
+                [&](io_uring_sqe& sqe, std::size_t k) {
+                    sqe.opcode = IORING_OP_OPENAT;
+                    sqe.fd = AT_FDCWD;
+                    sqe.addr = reinterpret_cast<uintptr_t>(
+                        reads[items[k]].path.c_str());
+                    sqe.open_flags = O_RDONLY | O_CLOEXEC;
+                },
+                [&](std::size_t k, int res) {
+                    done[k] = 1;
+                    if (res >= 0) {
+                        fds[items[k]] = res;
+                        opened[items[k]] = 1;
+                    } else {
+                        reads[items[k]].error = ErrnoCode(-res);
+                    }
+                });
+        }
+        for (std::size_t k = 0; k < items.size(); ++k) {
+            if (!done[k]) {
+                fds[items[k]] = OpenForRead(reads[items[k]]);
+                opened[items[k]] = fds[items[k]] >= 0;
+            }
+        }
+
+        // -- read --
+        items.clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            if (fds[i] >= 0) {
+                items.push_back(i);
+            }
+        }
+        done.assign(items.size(), 0);
+        if (healthy && !items.empty()) {
+            healthy = Run(
+                items.size(),
+                [&](io_uring_sqe& sqe, std::size_t k) {
+                    const auto& read = reads[items[k]];
+                    sqe.opcode = IORING_OP_READ;
+                    sqe.fd = fds[items[k]];
+                    sqe.addr = reinterpret_cast<uintptr_t>(read.buffer);
+                    sqe.len = static_cast<uint32_t>(read.length);
+                    sqe.off = read.offset;
+                },
+                [&](std::size_t k, int res) {
+                    done[k] = 1;
+                    if (res >= 0) {
+                        reads[items[k]].transferred =
+                            static_cast<std::size_t>(res);
+                    } else {
+                        reads[items[k]].error = ErrnoCode(-res);
+                    }
+                });
+        }
+        for (std::size_t k = 0; k < items.size(); ++k) {
+            if (!done[k]) {
+                PreadInto(reads[items[k]], fds[items[k]]);
+            }
+        }
+
+        // -- close --
+        items.clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            if (opened[i]) {
+                items.push_back(i);
+            }
+        }
+        done.assign(items.size(), 0);
+        if (healthy && !items.empty()) {
+            healthy = Run(
+                items.size(),
+                [&](io_uring_sqe& sqe, std::size_t k) {
+                    sqe.opcode = IORING_OP_CLOSE;
+                    sqe.fd = fds[items[k]];
+                },
+                [&](std::size_t k, int) { done[k] = 1; });
+        }
+        for (std::size_t k = 0; k < items.size(); ++k) {
+            if (!done[k]) {
+                ::close(fds[items[k]]);
+            }
+        }
+        return healthy;
+    }
+#endif
+};
+
+// ---------------------------------------------------------------------------
+// BatchReader
+// ---------------------------------------------------------------------------
+
+BatchReader::BatchReader(const BatchReaderOptions& options) {
+#ifdef PLAS_IO_URING_UAPI
+    if (options.io_uring) {
+        ring_ = Ring::Create(options.depth);
+    }
+#else
+    (void)options;
+#endif
+}
+
+BatchReader::~BatchReader() = default;
+
+bool BatchReader::UsesIoUring() const {
+    return ring_ != nullptr;
+}
+
+std::size_t BatchReader::Read(BatchRead* reads, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        reads[i].transferred = 0;
+        reads[i].error.clear();
+        if (reads[i].length > 0 && !reads[i].buffer) {
+            reads[i].error = make_error_code(ErrorCode::kInvalidArgument);
+        }
+    }
+
+    std::size_t start = 0;
+#ifdef PLAS_IO_URING_UAPI
+    while (ring_ && start < count) {
+        std::size_t chunk = std::min<std::size_t>(count - start, ring_->entries);
+        if (!ring_->ReadChunk(reads + start, chunk)) {
+            ring_.reset();  // fall back from now on
+        }
+        start += chunk;
+    }
+#endif
+    for (std::size_t i = start; i < count; ++i) {
+        if (!reads[i].error) {
+            ReadOne(reads[i]);
+        }
+    }
+
+    return static_cast<std::size_t>(
+        std::count_if(reads, reads + count,
+                      [](const BatchRead& read) { return !read.error; }));
+}
+
+BatchReader& BatchReader::ForThisThread() {
+    thread_local BatchReader reader;
+    return reader;
+}
+
+}  // namespace plas::core
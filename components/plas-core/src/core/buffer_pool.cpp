@@ -0,0 +1,127 @@
+#include "plas/core/buffer_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <new>
+
+namespace plas::core {
+
+namespace {
+
+constexpr std::size_t kClassCount = 15;  // 64 B .. 1 MiB
+
+static_assert(BufferPool::kMinBlock << (kClassCount - 1) ==
+              BufferPool::kMaxPooledBlock);
+
+std::size_t ClassIndex(std::size_t bytes) {
+    std::size_t index = 0;
+    std::size_t size = BufferPool::kMinBlock;
+    while (size < bytes) {
+        size <<= 1;
+        ++index;
+    }
+    return index;
+}
+
+std::size_t ClassSize(std::size_t index) {
+    return BufferPool::kMinBlock << index;
+}
+
+struct ThreadCache {
+    ~ThreadCache() {
+        Trim();
+        destroyed = true;
+    }
+
+    void Trim() {
+        for (auto& free_list : free) {
+            for (void* block : free_list) {
+                ::operator delete(block);
+            }
+            free_list.clear();
+        }
+        stats.cached_bytes = 0;
+    }
+
+    std::array<std::vector<void*>, kClassCount> free;
+    BufferPoolStats stats;
+    // Set once the cache is gone; trivially destructible, so it stays
+    // readable while other thread_local destructors release buffers.
+    static thread_local bool destroyed;
+};
+
+thread_local bool ThreadCache::destroyed = false;
+
+ThreadCache* Cache() {
+    if (ThreadCache::destroyed) {
+        return nullptr;
+    }
+    thread_local ThreadCache cache;
+    return &cache;
+}
+
+}  // namespace
+
+void* BufferPool::Allocate(std::size_t bytes, std::size_t& capacity) {
+    if (bytes == 0) {
+        capacity = 0;
+        return nullptr;
+    }
+    ThreadCache* cache = Cache();
+    if (bytes > kMaxPooledBlock) {
+        if (cache) {
+            ++cache->stats.allocations;
+        }
+        capacity = bytes;
+        return ::operator new(bytes);
+    }
+    std::size_t index = ClassIndex(bytes);
+    capacity = ClassSize(index);
+    if (cache) {
+        auto& free_list = cache->free[index];
+        if (!free_list.empty()) {
+            void* block = free_list.back();
+            free_list.pop_back();
+            cache->stats.cached_bytes -= capacity;
+            ++cache->stats.reuses;
+            return block;
+        }
+        ++cache->stats.allocations;
+        // Grow the free list now, so releasing never allocates.
+        free_list.reserve(kMaxCachedPerClass);
+    }
+    return ::operator new(capacity);
+}
+
+void BufferPool::Release(void* block, std::size_t capacity) noexcept {
+    if (!block) {
+        return;
+    }
+    ThreadCache* cache = Cache();
+    if (cache && capacity <= kMaxPooledBlock) {
+        std::size_t index = ClassIndex(capacity);
+        auto& free_list = cache->free[index];
+        // Only lists reserved by Allocate() take blocks: no heap use here.
+        if (free_list.size() < std::min(free_list.capacity(),
+                                        kMaxCachedPerClass) &&
+            cache->stats.cached_bytes + capacity <= kMaxCachedBytes) {
+            free_list.push_back(block);
+            cache->stats.cached_bytes += capacity;
+            return;
+        }
+    }
+    ::operator delete(block);
+}
+
+BufferPoolStats BufferPool::ThreadStats() {
+    ThreadCache* cache = Cache();
+    return cache ? cache->stats : BufferPoolStats{};
+}
+
+void BufferPool::TrimThreadCache() {
+    if (ThreadCache* cache = Cache()) {
+        cache->Trim();
+    }
+}
+
+}  // namespace plas::core
@@ -1,50 +1,161 @@
 #include "plas/core/byte_buffer.h"
 
+#include <algorithm>
+
+#include "plas/core/buffer_pool.h"
+
 namespace plas::core {
 
-ByteBuffer::ByteBuffer() = default;
+ByteBuffer::ByteBuffer() : data_(inline_) {}
+
+ByteBuffer::ByteBuffer(size_t size) : ByteBuffer() {
+    Resize(size);
+}
+
+ByteBuffer::ByteBuffer(std::initializer_list<uint8_t> init)
+    : ByteBuffer(init.begin(), init.size()) {}
+
+ByteBuffer::ByteBuffer(const uint8_t* data, size_t size) : ByteBuffer() {
+    Append(data, size);
+}
 
-ByteBuffer::ByteBuffer(size_t size) : buffer_(size) {}
+ByteBuffer::ByteBuffer(ByteView view) : ByteBuffer(view.Data(), view.Size()) {}
 
-ByteBuffer::ByteBuffer(std::initializer_list<uint8_t> init) : buffer_(init) {}
+ByteBuffer::~ByteBuffer() {
+    ReleaseHeap();
+}
 
-ByteBuffer::ByteBuffer(const uint8_t* data, size_t size)
-    : buffer_(data, data + size) {}
+ByteBuffer::ByteBuffer(const ByteBuffer& other) : ByteBuffer() {
+    Append(other.data_, other.size_);
+}
+
+ByteBuffer& ByteBuffer::operator=(const ByteBuffer& other) {
+    if (this != &other) {
+        size_ = 0;
+        Append(other.data_, other.size_);
+    }
+    return *this;
+}
+
+ByteBuffer::ByteBuffer(ByteBuffer&& other) noexcept : ByteBuffer() {
+    *this = std::move(other);
+}
+
+ByteBuffer& ByteBuffer::operator=(ByteBuffer&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    ReleaseHeap();
+    if (other.IsInline()) {
+        std::memcpy(inline_, other.inline_, other.size_);
+        data_ = inline_;
+        capacity_ = kInlineCapacity;
+    } else {
+        data_ = other.data_;
+        capacity_ = other.capacity_;
+        other.data_ = other.inline_;
+        other.capacity_ = kInlineCapacity;
+    }
+    size_ = other.size_;
+    other.size_ = 0;
+    return *this;
+}
 
 const uint8_t* ByteBuffer::Data() const {
-    return buffer_.data();
+    return data_;
 }
 
 uint8_t* ByteBuffer::Data() {
-    return buffer_.data();
+    return data_;
 }
 
 size_t ByteBuffer::Size() const {
-    return buffer_.size();
+    return size_;
 }
 
 bool ByteBuffer::Empty() const {
-    return buffer_.empty();
+    return size_ == 0;
+}
+
+size_t ByteBuffer::Capacity() const {
+    return capacity_;
+}
+
+bool ByteBuffer::IsInline() const {
+    return data_ == inline_;
 }
 
 void ByteBuffer::Clear() {
-    buffer_.clear();
+    size_ = 0;
 }
 
 void ByteBuffer::Resize(size_t new_size) {
-    buffer_.resize(new_size);
+    if (new_size > size_) {
+        std::memset(AppendUninitialized(new_size - size_), 0,
+                    new_size - size_);
+    }
+    size_ = new_size;
+}
+
+void ByteBuffer::Reserve(size_t capacity) {
+    if (capacity > capacity_) {
+        Grow(capacity);
+    }
 }
 
 void ByteBuffer::Append(const uint8_t* data, size_t size) {
-    buffer_.insert(buffer_.end(), data, data + size);
+    if (size == 0) {
+        return;
+    }
+    // Appending a slice of ourselves: growing would free the source.
+    if (data >= data_ && data < data_ + size_) {
+        size_t offset = static_cast<size_t>(data - data_);
+        uint8_t* tail = AppendUninitialized(size);
+        std::memmove(tail, data_ + offset, size);
+        return;
+    }
+    std::memcpy(AppendUninitialized(size), data, size);
+}
+
+void ByteBuffer::Append(ByteView view) {
+    Append(view.Data(), view.Size());
+}
+
+uint8_t* ByteBuffer::AppendUninitialized(size_t count) {
+    if (size_ + count > capacity_) {
+        Grow(std::max(size_ + count, capacity_ * 2));
+    }
+    uint8_t* tail = data_ + size_;
+    size_ += count;
+    return tail;
 }
 
 uint8_t& ByteBuffer::operator[](size_t index) {
-    return buffer_[index];
+    return data_[index];
 }
 
 const uint8_t& ByteBuffer::operator[](size_t index) const {
-    return buffer_[index];
+    return data_[index];
+}
+
+void ByteBuffer::Grow(size_t min_capacity) {
+    size_t capacity = 0;
+    auto* block =
+        static_cast<uint8_t*>(BufferPool::Allocate(min_capacity, capacity));
+    if (size_ > 0) {
+        std::memcpy(block, data_, size_);
+    }
+    ReleaseHeap();
+    data_ = block;
+    capacity_ = capacity;
+}
+
+void ByteBuffer::ReleaseHeap() noexcept {
+    if (!IsInline()) {
+        BufferPool::Release(data_, capacity_);
+        data_ = inline_;
+        capacity_ = kInlineCapacity;
+    }
 }
 
 }  // namespace plas::core
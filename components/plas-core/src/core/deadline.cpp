@@ -0,0 +1,23 @@
+#include "plas/core/deadline.h"
+
+namespace plas::core {
+
+namespace {
+
+thread_local Deadline tls_deadline;
+
+}  // namespace
+
+Deadline Deadline::Current() {
+    return tls_deadline;
+}
+
+ScopedDeadline::ScopedDeadline(Deadline deadline) : previous_(tls_deadline) {
+    tls_deadline = previous_.Min(deadline);
+}
+
+ScopedDeadline::~ScopedDeadline() {
+    tls_deadline = previous_;
+}
+
+}  // namespace plas::core
@@ -0,0 +1,544 @@
+#include "plas/core/executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "plas/core/deadline.h"
+#include "plas/core/io_queue.h"
+
+namespace plas::core {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Tasks a strand runs before giving its worker back to the pool.
+constexpr std::size_t kStrandBatch = 32;
+
+/// One per CPU the process may run on.
+std::size_t DefaultThreadCount() {
+#ifdef __linux__
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0 && CPU_COUNT(&mask) > 0) {
+        return static_cast<std::size_t>(CPU_COUNT(&mask));
+    }
+#endif
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void SetupWorkerThread(std::thread& thread, const ExecutorOptions& options,
+                       std::size_t index) {
+#ifdef __linux__
+    auto name = (options.name + "-" + std::to_string(index)).substr(0, 15);
+    pthread_setname_np(thread.native_handle(), name.c_str());
+    if (!options.cpus.empty()) {
+        int cpu = options.cpus[index % options.cpus.size()];
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            cpu_set_t mask;
+            CPU_ZERO(&mask);
+            CPU_SET(static_cast<std::size_t>(cpu), &mask);
+            // A CPU outside the process's mask leaves the worker unpinned.
+            pthread_setaffinity_np(thread.native_handle(), sizeof(mask), &mask);
+        }
+    }
+#else
+    (void)thread;
+    (void)options;
+    (void)index;
+#endif
+}
+
+struct Worker {
+    std::mutex mutex;
+    std::deque<Executor::Task> tasks;  // guarded by mutex; owner takes the back
+    std::thread thread;
+};
+
+struct Timer {
+    Executor::Task task;
+    std::chrono::nanoseconds period;  // zero: one-shot
+    Clock::time_point due;
+    bool cancelled = false;  // guarded by Impl::timer_mutex
+    bool running = false;    // guarded by Impl::timer_mutex
+    std::thread::id runner;  // guarded by Impl::timer_mutex
+};
+
+using DueEntry = std::pair<Clock::time_point, Executor::TimerId>;
+
+}  // namespace
+
+struct Executor::Impl {
+    explicit Impl(ExecutorOptions opts) : options(std::move(opts)) {}
+
+    ExecutorOptions options;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    std::mutex inject_mutex;
+    std::deque<Task> injected;  // guarded by inject_mutex
+
+    std::atomic<std::size_t> pending{0};  // posted, not yet taken
+    std::atomic<std::size_t> idle{0};     // workers asleep or about to be
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_cv;
+    bool stopping = false;  // guarded by sleep_mutex
+
+    std::mutex timer_mutex;
+    std::condition_variable timer_cv;  // timer thread: new due entry or stop
+    std::condition_variable run_cv;    // Cancel(): a callback finished
+    std::map<TimerId, std::shared_ptr<Timer>> timers;  // guarded by timer_mutex
+    std::priority_queue<DueEntry, std::vector<DueEntry>, std::greater<DueEntry>>
+        due;                  // guarded by timer_mutex; may hold stale ids
+    TimerId next_timer = 1;   // guarded by timer_mutex
+    bool timer_stop = false;  // guarded by timer_mutex
+    std::thread timer_thread;
+
+    std::atomic<uint64_t> executed{0};
+    std::atomic<uint64_t> stolen{0};
+    std::atomic<uint64_t> timers_fired{0};
+
+    void Post(Task task);
+    bool Take(std::size_t index, Task& task, bool& was_stolen);
+    void RunWorker(std::size_t index);
+    void RunTimers();
+    void Fire(TimerId id, const std::shared_ptr<Timer>& timer);
+    TimerId AddTimer(Clock::time_point first, std::chrono::nanoseconds period, Task task);
+};
+
+namespace {
+
+/// The executor and worker index of the calling thread, if it is a worker.
+struct CurrentWorker {
+    const void* impl = nullptr;
+    std::size_t index = 0;
+};
+
+thread_local CurrentWorker tls_worker;
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Workers
+// ---------------------------------------------------------------------------
+
+void Executor::Impl::Post(Task task) {
+    // Counted before it is queued, so a worker never sleeps past it.
+    pending.fetch_add(1);
+    if (tls_worker.impl == this) {
+        auto& worker = *workers[tls_worker.index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    } else {
+        std::lock_guard<std::mutex> lock(inject_mutex);
+        injected.push_back(std::move(task));
+    }
+    if (idle.load() > 0) {
+        { std::lock_guard<std::mutex> lock(sleep_mutex); }
+        sleep_cv.notify_one();
+    }
+}
+
+bool Executor::Impl::Take(std::size_t index, Task& task, bool& was_stolen) {
+    was_stolen = false;
+    {
+        auto& own = *workers[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(inject_mutex);
+        if (!injected.empty()) {
+            task = std::move(injected.front());
+            injected.pop_front();
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+    for (std::size_t k = 1; k < workers.size(); ++k) {
+        auto& victim = *workers[(index + k) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            pending.fetch_sub(1);
+            was_stolen = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Executor::Impl::RunWorker(std::size_t index) {
+    tls_worker = {this, index};
+    for (;;) {
+        Task task;
+        bool was_stolen = false;
+        if (Take(index, task, was_stolen)) {
+            task();
+            executed.fetch_add(1, std::memory_order_relaxed);
+            if (was_stolen) {
+                stolen.fetch_add(1, std::memory_order_relaxed);
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        idle.fetch_add(1);
+        sleep_cv.wait(lock, [this] { return stopping || pending.load() > 0; });
+        idle.fetch_sub(1);
+        // Tasks posted before shutdown still run.
+        if (stopping && pending.load() == 0) {
+            break;
+        }
+    }
+    tls_worker = {};
+}
+
+// ---------------------------------------------------------------------------
+// Timers
+// ---------------------------------------------------------------------------
+
+void Executor::Impl::RunTimers() {
+    std::unique_lock<std::mutex> lock(timer_mutex);
+    while (!timer_stop) {
+        if (due.empty()) {
+            timer_cv.wait(lock);
+            continue;
+        }
+        auto [when, id] = due.top();
+        if (Clock::now() < when) {
+            timer_cv.wait_until(lock, when);
+            continue;
+        }
+        due.pop();
+        auto it = timers.find(id);
+        if (it == timers.end() || it->second->cancelled) {
+            continue;
+        }
+        auto timer = it->second;
+        lock.unlock();
+        Post([this, id, timer] { Fire(id, timer); });
+        lock.lock();
+    }
+}
+
+void Executor::Impl::Fire(TimerId id, const std::shared_ptr<Timer>& timer) {
+    {
+        std::lock_guard<std::mutex> lock(timer_mutex);
+        if (timer->cancelled) {
+            return;
+        }
+        timer->running = true;
+        timer->runner = std::this_thread::get_id();
+    }
+    timer->task();
+    timers_fired.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(timer_mutex);
+    timer->running = false;
+    timer->runner = {};
+    if (timer->period.count() == 0) {
+        timers.erase(id);
+    } else if (!timer->cancelled) {
+        // Fixed rate; a run that overran skips the missed ticks.
+        timer->due += std::chrono::duration_cast<Clock::duration>(timer->period);
+        auto now = Clock::now();
+        if (timer->due < now) {
+            timer->due = now;
+        }
+        due.emplace(timer->due, id);
+        timer_cv.notify_one();
+    }
+    run_cv.notify_all();
+}
+
+Executor::TimerId Executor::Impl::AddTimer(Clock::time_point first,
+                                           std::chrono::nanoseconds period, Task task) {
+    auto timer = std::make_shared<Timer>();
+    timer->task = std::move(task);
+    timer->period = period;
+    timer->due = first;
+    std::lock_guard<std::mutex> lock(timer_mutex);
+    TimerId id = next_timer++;
+    timers.emplace(id, std::move(timer));
+    due.emplace(first, id);
+    timer_cv.notify_one();
+    return id;
+}
+
+// ---------------------------------------------------------------------------
+// Executor
+// ---------------------------------------------------------------------------
+
+namespace {
+
+std::mutex& SharedMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+bool shared_created = false;      // guarded by SharedMutex()
+ExecutorOptions* shared_options;  // guarded by SharedMutex(); set by ConfigureShared
+
+}  // namespace
+
+Executor::Executor(ExecutorOptions options) : impl_(std::make_unique<Impl>(std::move(options))) {
+    std::size_t count = impl_->options.threads;
+    if (count == 0) {
+        count = impl_->options.cpus.empty() ? DefaultThreadCount() : impl_->options.cpus.size();
+    }
+    impl_->workers.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        impl_->workers.push_back(std::make_unique<Worker>());
+    }
+    // All deques exist before any worker can steal from them.
+    for (std::size_t i = 0; i < count; ++i) {
+        auto& thread = impl_->workers[i]->thread;
+        thread = std::thread([impl = impl_.get(), i] { impl->RunWorker(i); });
+        SetupWorkerThread(thread, impl_->options, i);
+    }
+    impl_->timer_thread = std::thread([impl = impl_.get()] { impl->RunTimers(); });
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard<std::mutex> lock(impl_->timer_mutex);
+        impl_->timer_stop = true;
+        for (auto& [id, timer] : impl_->timers) {
+            timer->cancelled = true;
+        }
+        impl_->timers.clear();
+    }
+    impl_->timer_cv.notify_all();
+    impl_->timer_thread.join();
+
+    {
+        std::lock_guard<std::mutex> lock(impl_->sleep_mutex);
+        impl_->stopping = true;
+    }
+    impl_->sleep_cv.notify_all();
+    for (auto& worker : impl_->workers) {
+        worker->thread.join();
+    }
+}
+
+Executor& Executor::Shared() {
+    static Executor* executor = [] {
+        std::lock_guard<std::mutex> lock(SharedMutex());
+        shared_created = true;
+        // Never destroyed: tasks and timers may be posted from static
+        // destructors.
+        return new Executor(shared_options ? *shared_options : ExecutorOptions{});
+    }();
+    return *executor;
+}
+
+Result<void> Executor::ConfigureShared(ExecutorOptions options) {
+    std::lock_guard<std::mutex> lock(SharedMutex());
+    if (shared_created) {
+        return Result<void>::Err(ErrorCode::kBusy);
+    }
+    delete shared_options;
+    shared_options = new ExecutorOptions(std::move(options));
+    return Result<void>::Ok();
+}
+
+Executor& Executor::ForCpus(std::vector<int> cpus) {
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    if (cpus.empty()) {
+        return Shared();
+    }
+    static std::mutex mutex;
+    static auto* executors = new std::map<std::vector<int>, Executor*>();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& executor = (*executors)[cpus];
+    if (executor == nullptr) {
+        ExecutorOptions options;
+        options.cpus = std::move(cpus);
+        options.name = "plas-local";
+        // Never destroyed, like Shared().
+        executor = new Executor(std::move(options));
+    }
+    return *executor;
+}
+
+void Executor::Post(Task task) {
+    impl_->Post(std::move(task));
+}
+
+void Executor::ParallelFor(std::size_t count, const std::function<void(std::size_t)>& body,
+                           std::size_t max_threads) {
+    if (count == 0) {
+        return;
+    }
+    std::size_t helpers = std::min(count - 1, impl_->workers.size());
+    if (max_threads > 0) {
+        helpers = std::min(helpers, max_threads - 1);
+    }
+    if (helpers == 0) {
+        for (std::size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    // Helpers that start after the last item was taken return at once; the
+    // loop state outlives this call for them.
+    struct Loop {
+        const std::function<void(std::size_t)>* body;
+        std::size_t count;
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    auto loop = std::make_shared<Loop>();
+    loop->body = &body;
+    loop->count = count;
+    auto run = [loop, deadline = Deadline::Current(), priority = CurrentIoPriority()] {
+        ScopedDeadline scope(deadline);  // the caller's, on the helpers too
+        ScopedIoPriority io_priority(priority);
+        for (auto i = loop->next.fetch_add(1); i < loop->count; i = loop->next.fetch_add(1)) {
+            (*loop->body)(i);
+            if (loop->done.fetch_add(1) + 1 == loop->count) {
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                loop->cv.notify_all();
+            }
+        }
+    };
+    for (std::size_t h = 0; h < helpers; ++h) {
+        Post(run);
+    }
+    run();
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->cv.wait(lock, [&] { return loop->done.load() == count; });
+}
+
+Executor::TimerId Executor::PostAfter(std::chrono::nanoseconds delay, Task task) {
+    return impl_->AddTimer(Clock::now() + std::chrono::duration_cast<Clock::duration>(delay),
+                           std::chrono::nanoseconds::zero(), std::move(task));
+}
+
+Executor::TimerId Executor::PostEvery(std::chrono::nanoseconds period, Task task,
+                                      std::chrono::nanoseconds first_delay) {
+    period = std::max(period, std::chrono::nanoseconds(1));
+    return impl_->AddTimer(
+        Clock::now() + std::chrono::duration_cast<Clock::duration>(first_delay), period,
+        std::move(task));
+}
+
+bool Executor::Cancel(TimerId id) {
+    std::unique_lock<std::mutex> lock(impl_->timer_mutex);
+    auto it = impl_->timers.find(id);
+    if (it == impl_->timers.end()) {
+        return false;
+    }
+    auto timer = it->second;
+    impl_->timers.erase(it);
+    timer->cancelled = true;
+    auto self = std::this_thread::get_id();
+    impl_->run_cv.wait(lock, [&] { return !timer->running || timer->runner == self; });
+    return true;
+}
+
+std::size_t Executor::ThreadCount() const {
+    return impl_->workers.size();
+}
+
+bool Executor::RunningInThisThread() const {
+    return tls_worker.impl == impl_.get();
+}
+
+ExecutorStats Executor::GetStats() const {
+    ExecutorStats stats;
+    stats.executed = impl_->executed.load(std::memory_order_relaxed);
+    stats.stolen = impl_->stolen.load(std::memory_order_relaxed);
+    stats.timers_fired = impl_->timers_fired.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// ---------------------------------------------------------------------------
+// Strand
+// ---------------------------------------------------------------------------
+
+struct Strand::State {
+    explicit State(Executor& e) : executor(e) {}
+
+    Executor& executor;
+    std::mutex mutex;
+    std::deque<Executor::Task> tasks;  // guarded by mutex
+    bool scheduled = false;            // guarded by mutex; a Drain is posted
+
+    static void Drain(const std::shared_ptr<State>& state);
+};
+
+namespace {
+
+thread_local const void* tls_strand = nullptr;
+
+}  // namespace
+
+void Strand::State::Drain(const std::shared_ptr<State>& state) {
+    const void* outer = tls_strand;
+    tls_strand = state.get();
+    for (std::size_t n = 0; n < kStrandBatch; ++n) {
+        Executor::Task task;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->tasks.empty()) {
+                state->scheduled = false;
+                tls_strand = outer;
+                return;
+            }
+            task = std::move(state->tasks.front());
+            state->tasks.pop_front();
+        }
+        task();
+    }
+    tls_strand = outer;
+    // Still scheduled: let other work have the worker, then continue.
+    state->executor.Post([state] { Drain(state); });
+}
+
+Strand::Strand(Executor& executor) : state_(std::make_shared<State>(executor)) {}
+
+Strand::~Strand() = default;
+
+void Strand::Post(Executor::Task task) {
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->tasks.push_back(std::move(task));
+        if (state_->scheduled) {
+            return;
+        }
+        state_->scheduled = true;
+    }
+    state_->executor.Post([state = state_] { State::Drain(state); });
+}
+
+bool Strand::RunningInThisThread() const {
+    return tls_strand == state_.get();
+}
+
+Executor& Strand::GetExecutor() const {
+    return state_->executor;
+}
+
+}  // namespace plas::core
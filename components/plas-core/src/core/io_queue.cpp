@@ -0,0 +1,125 @@
+#include "plas/core/io_queue.h"
+
+#include <algorithm>
+
+namespace plas::core {
+
+namespace {
+
+thread_local IoPriority tls_priority = IoPriority::kForeground;
+
+}  // namespace
+
+IoPriority CurrentIoPriority() {
+    return tls_priority;
+}
+
+ScopedIoPriority::ScopedIoPriority(IoPriority priority) : previous_(tls_priority) {
+    tls_priority = priority;
+}
+
+ScopedIoPriority::~ScopedIoPriority() {
+    tls_priority = previous_;
+}
+
+#if PLAS_LOCK_STATS
+IoQueue::IoQueue(const char* name) : lock_stats_(LockCounters::For(name)) {}
+#else
+IoQueue::IoQueue(const char* /*name*/) {}
+#endif
+
+void IoQueue::lock() {
+    try_lock_until(Clock::time_point::max());
+}
+
+bool IoQueue::try_lock() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (owned_ || !waiters_.empty()) {
+        return false;
+    }
+    GrantLocked(CurrentIoPriority(), Clock::now(), false);
+    return true;
+}
+
+bool IoQueue::try_lock_until(Clock::time_point deadline) {
+    const auto priority = CurrentIoPriority();
+    const auto since = Clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!owned_ && waiters_.empty()) {
+        GrantLocked(priority, since, false);
+        return true;
+    }
+    const auto key = std::make_pair(static_cast<int>(priority), next_ticket_++);
+    waiters_.insert(key);
+    auto my_turn = [this, &key] { return !owned_ && *waiters_.begin() == key; };
+    if (deadline == Clock::time_point::max()) {
+        turn_.wait(lock, my_turn);
+    } else if (!turn_.wait_until(lock, deadline, my_turn)) {
+        waiters_.erase(key);
+        // We may have been the head; let the next waiter re-check.
+        turn_.notify_all();
+        return false;
+    }
+    waiters_.erase(key);
+    GrantLocked(priority, since, true);
+    return true;
+}
+
+void IoQueue::unlock() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        owned_ = false;
+#if PLAS_LOCK_STATS
+        if (lock_stats_) {
+            lock_stats_->RecordRelease(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - granted_at_)
+                    .count()));
+        }
+#endif
+        if (waiters_.empty()) {
+            return;
+        }
+    }
+    turn_.notify_all();
+}
+
+void IoQueue::GrantLocked(IoPriority priority, Clock::time_point since, bool queued) {
+    owned_ = true;
+    auto now = Clock::now();
+    auto waited_us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(now - since).count());
+#if PLAS_LOCK_STATS
+    if (lock_stats_) {
+        granted_at_ = now;
+        lock_stats_->RecordAcquire(
+            static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - since).count()),
+            queued);
+    }
+#else
+    (void)queued;
+#endif
+    auto p = static_cast<std::size_t>(priority);
+    stats_.grants[p]++;
+    stats_.total_wait_us[p] += waited_us;
+    stats_.max_wait_us[p] = std::max(stats_.max_wait_us[p], waited_us);
+}
+
+std::size_t IoQueue::Waiting(IoPriority priority) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<std::size_t>(std::count_if(
+        waiters_.begin(), waiters_.end(),
+        [priority](const auto& key) { return key.first == static_cast<int>(priority); }));
+}
+
+IoQueueStats IoQueue::Stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void IoQueue::ResetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_ = IoQueueStats{};
+}
+
+}  // namespace plas::core
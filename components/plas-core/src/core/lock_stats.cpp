@@ -0,0 +1,67 @@
+#include "plas/core/lock_stats.h"
+
+#include <map>
+#include <memory>
+
+namespace plas::core {
+
+namespace {
+
+struct LockRegistry {
+    std::mutex mutex;  // plain: the registry does not count itself
+    std::map<std::string, std::unique_ptr<LockCounters>> locks;
+};
+
+LockRegistry& Registry() {
+    static auto* registry = new LockRegistry;  // outlives static destructors
+    return *registry;
+}
+
+}  // namespace
+
+LockCounters* LockCounters::For(const char* name) {
+    auto& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto& counters = registry.locks[name];
+    if (!counters) {
+        counters = std::make_unique<LockCounters>();
+    }
+    return counters.get();
+}
+
+std::vector<LockStats> LockStatsSnapshot() {
+    std::vector<LockStats> out;
+    auto& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const auto& [name, counters] : registry.locks) {
+        LockStats stats;
+        stats.acquisitions = counters->acquisitions_.load(std::memory_order_relaxed);
+        if (stats.acquisitions == 0) {
+            continue;
+        }
+        stats.name = name;
+        stats.contended = counters->contended_.load(std::memory_order_relaxed);
+        stats.wait_ns = counters->wait_ns_.load(std::memory_order_relaxed);
+        stats.max_wait_ns = counters->max_wait_ns_.load(std::memory_order_relaxed);
+        stats.hold_ns = counters->hold_ns_.load(std::memory_order_relaxed);
+        stats.max_hold_ns = counters->max_hold_ns_.load(std::memory_order_relaxed);
+        out.push_back(std::move(stats));
+    }
+    return out;
+}
+
+void ResetLockStats() {
+    auto& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto& entry : registry.locks) {
+        auto& c = *entry.second;
+        c.acquisitions_.store(0, std::memory_order_relaxed);
+        c.contended_.store(0, std::memory_order_relaxed);
+        c.wait_ns_.store(0, std::memory_order_relaxed);
+        c.max_wait_ns_.store(0, std::memory_order_relaxed);
+        c.hold_ns_.store(0, std::memory_order_relaxed);
+        c.max_hold_ns_.store(0, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace plas::core
@@ -0,0 +1,284 @@
+#include "plas/core/numa.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <sys/mman.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "plas/core/error.h"
+
+namespace plas::core {
+
+namespace {
+
+#ifdef __linux__
+// From <linux/mempolicy.h>; the kernel header is not always installed.
+constexpr int kMpolPreferred = 1;
+#endif
+constexpr int kMaxNodes = 1024;
+
+std::size_t RoundUp(std::size_t n, std::size_t to) {
+    return (n + to - 1) / to * to;
+}
+
+std::size_t PoolClass(std::size_t bytes) {
+    std::size_t size = kHugePageSize;
+    while (size < bytes) {
+        size <<= 1;
+    }
+    return size;
+}
+
+void* MapAnonymous(std::size_t bytes, int extra_flags) {
+    void* data = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+    return data == MAP_FAILED ? nullptr : data;
+}
+
+// `capacity` bytes (a kHugePageSize multiple) on 2 MiB pages where the
+// system has them; base pages otherwise.
+void* MapHuge(std::size_t capacity, PageBacking& backing) {
+#if defined(__linux__) && defined(MAP_HUGETLB)
+    // MAP_HUGE_2MB is 21 << MAP_HUGE_SHIFT; without it the default huge
+    // page size is used, which is 2 MiB on the platforms this targets.
+    if (void* data = MapAnonymous(capacity, MAP_HUGETLB | (21 << 26))) {
+        backing = PageBacking::kHugetlb;
+        return data;
+    }
+#endif
+    // No reserved huge pages: over-map by one huge page and trim to a
+    // 2 MiB boundary so THP can back every PMD of the range.
+    void* raw = MapAnonymous(capacity + kHugePageSize, 0);
+    if (raw == nullptr) {
+        return nullptr;
+    }
+    auto start = reinterpret_cast<std::uintptr_t>(raw);
+    auto aligned = RoundUp(start, kHugePageSize);
+    if (aligned > start) {
+        ::munmap(raw, aligned - start);
+    }
+    std::size_t tail = start + capacity + kHugePageSize - (aligned + capacity);
+    if (tail > 0) {
+        ::munmap(reinterpret_cast<void*>(aligned + capacity), tail);
+    }
+    void* data = reinterpret_cast<void*>(aligned);
+    backing = PageBacking::kNormal;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // EINVAL when THP is compiled out or disabled: base pages it is.
+    if (::madvise(data, capacity, MADV_HUGEPAGE) == 0) {
+        backing = PageBacking::kTransparent;
+    }
+#endif
+    return data;
+}
+
+std::string_view Trim(std::string_view text) {
+    const char* space = " \t\r\n";
+    auto first = text.find_first_not_of(space);
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    auto last = text.find_last_not_of(space);
+    return text.substr(first, last - first + 1);
+}
+
+bool ParseCpu(std::string_view text, int& cpu) {
+    if (text.empty() || text.size() > 9) {
+        return false;
+    }
+    int value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + (c - '0');
+    }
+    cpu = value;
+    return true;
+}
+
+}  // namespace
+
+Result<std::vector<int>> ParseCpuList(std::string_view text) {
+    text = Trim(text);
+    std::vector<int> cpus;
+    while (!text.empty()) {
+        auto comma = text.find(',');
+        auto item = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+
+        auto dash = item.find('-');
+        int first = 0;
+        int last = 0;
+        if (!ParseCpu(item.substr(0, dash), first) ||
+            (dash != std::string_view::npos && !ParseCpu(item.substr(dash + 1), last))) {
+            return Result<std::vector<int>>::Err(ErrorCode::kInvalidArgument);
+        }
+        if (dash == std::string_view::npos) {
+            last = first;
+        }
+        if (last < first) {
+            return Result<std::vector<int>>::Err(ErrorCode::kInvalidArgument);
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return Result<std::vector<int>>::Ok(std::move(cpus));
+}
+
+NumaBuffer::~NumaBuffer() {
+    if (data_ != nullptr) {
+        ::munmap(data_, capacity_);
+    }
+}
+
+NumaBuffer& NumaBuffer::operator=(NumaBuffer&& other) noexcept {
+    if (this != &other) {
+        if (data_ != nullptr) {
+            ::munmap(data_, capacity_);
+        }
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        capacity_ = std::exchange(other.capacity_, 0);
+        node_ = std::exchange(other.node_, -1);
+        backing_ = std::exchange(other.backing_, PageBacking::kNormal);
+    }
+    return *this;
+}
+
+Result<NumaBuffer> NumaBuffer::Allocate(std::size_t bytes, int node, bool huge_pages) {
+    if (bytes == 0 || node >= kMaxNodes) {
+        return Result<NumaBuffer>::Err(ErrorCode::kInvalidArgument);
+    }
+    PageBacking backing = PageBacking::kNormal;
+    std::size_t capacity = bytes;
+    void* data = nullptr;
+    if (huge_pages) {
+        capacity = RoundUp(bytes, kHugePageSize);
+        data = MapHuge(capacity, backing);
+    } else {
+        data = MapAnonymous(bytes, 0);
+    }
+    if (data == nullptr) {
+        return Result<NumaBuffer>::Err(ErrorCode::kOutOfMemory);
+    }
+    NumaBuffer buffer;
+    buffer.data_ = data;
+    buffer.size_ = bytes;
+    buffer.capacity_ = capacity;
+    buffer.backing_ = backing;
+
+#ifdef __linux__
+    if (node >= 0) {
+        constexpr int kBits = static_cast<int>(sizeof(unsigned long) * CHAR_BIT);
+        unsigned long mask[kMaxNodes / kBits] = {};
+        mask[node / kBits] |= 1UL << (node % kBits);
+        // maxnode counts one past the last bit the kernel reads.
+        if (::syscall(SYS_mbind, data, capacity, kMpolPreferred, mask,
+                      static_cast<unsigned long>(kMaxNodes) + 1, 0) == 0) {
+            buffer.node_ = node;
+        } else if (errno == EINVAL) {
+            return Result<NumaBuffer>::Err(ErrorCode::kInvalidArgument);
+        }
+        // EPERM (seccomp) / ENOSYS (no NUMA): leave the pages unplaced.
+    }
+#endif
+
+    // Fault the pages in now, under the policy.
+    std::memset(data, 0, capacity);
+    return Result<NumaBuffer>::Ok(std::move(buffer));
+}
+
+NumaBufferLease::~NumaBufferLease() {
+    if (pool_ != nullptr) {
+        pool_->Release(std::move(buffer_), node_);
+    }
+}
+
+NumaBufferLease& NumaBufferLease::operator=(NumaBufferLease&& other) noexcept {
+    if (this != &other) {
+        if (pool_ != nullptr) {
+            pool_->Release(std::move(buffer_), node_);
+        }
+        pool_ = std::exchange(other.pool_, nullptr);
+        buffer_ = std::move(other.buffer_);
+        size_ = std::exchange(other.size_, 0);
+        node_ = std::exchange(other.node_, -1);
+    }
+    return *this;
+}
+
+NumaBufferPool& NumaBufferPool::Shared() {
+    static NumaBufferPool pool;
+    return pool;
+}
+
+Result<NumaBufferLease> NumaBufferPool::Acquire(std::size_t bytes, int node) {
+    if (bytes == 0 || node >= kMaxNodes) {
+        return Result<NumaBufferLease>::Err(ErrorCode::kInvalidArgument);
+    }
+    std::size_t size = PoolClass(bytes);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = cached_.begin(); it != cached_.end(); ++it) {
+            if (it->node == node && it->buffer.Size() == size) {
+                NumaBuffer buffer = std::move(it->buffer);
+                cached_.erase(it);
+                stats_.cached_bytes -= buffer.Capacity();
+                ++stats_.reuses;
+                return Result<NumaBufferLease>::Ok(
+                    NumaBufferLease(this, std::move(buffer), bytes, node));
+            }
+        }
+    }
+    auto buffer = NumaBuffer::Allocate(size, node, huge_pages_);
+    if (buffer.IsError()) {
+        return Result<NumaBufferLease>::Err(buffer.Error());
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.allocations;
+    }
+    return Result<NumaBufferLease>::Ok(
+        NumaBufferLease(this, std::move(buffer.Value()), bytes, node));
+}
+
+void NumaBufferPool::Release(NumaBuffer buffer, int node) {
+    if (buffer.Data() == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stats_.cached_bytes + buffer.Capacity() > max_cached_bytes_) {
+        return;  // unmapped as `buffer` goes out of scope
+    }
+    stats_.cached_bytes += buffer.Capacity();
+    cached_.push_back(Cached{node, std::move(buffer)});
+}
+
+void NumaBufferPool::Trim() {
+    std::vector<Cached> drop;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        drop.swap(cached_);
+        stats_.cached_bytes = 0;
+    }
+}
+
+NumaBufferPoolStats NumaBufferPool::Stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+}  // namespace plas::core
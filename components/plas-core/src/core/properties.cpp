@@ -1,14 +1,80 @@
 #include "plas/core/properties.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+
 namespace plas::core {
 
-std::mutex& Properties::RegistryMutex() {
-    static std::mutex mutex;
+// ---------------------------------------------------------------------------
+// PropertyKey
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct KeyRegistry {
+    std::shared_mutex mutex;
+    std::unordered_map<std::string_view, uint32_t> ids;  // views into names
+    std::deque<std::string> names;                       // indexed by id
+};
+
+KeyRegistry& KeyTable() {
+    static KeyRegistry registry;
+    return registry;
+}
+
+}  // namespace
+
+PropertyKey PropertyKey::Intern(std::string_view name) {
+    auto& registry = KeyTable();
+    {
+        std::shared_lock lock(registry.mutex);
+        auto it = registry.ids.find(name);
+        if (it != registry.ids.end()) {
+            return PropertyKey(it->second);
+        }
+    }
+    std::unique_lock lock(registry.mutex);
+    auto it = registry.ids.find(name);
+    if (it != registry.ids.end()) {
+        return PropertyKey(it->second);
+    }
+    auto id = static_cast<uint32_t>(registry.names.size());
+    registry.names.emplace_back(name);
+    registry.ids.emplace(registry.names.back(), id);
+    return PropertyKey(id);
+}
+
+PropertyKey PropertyKey::Find(std::string_view name) {
+    auto& registry = KeyTable();
+    std::shared_lock lock(registry.mutex);
+    auto it = registry.ids.find(name);
+    return it == registry.ids.end() ? PropertyKey() : PropertyKey(it->second);
+}
+
+const std::string& PropertyKey::Name() const {
+    static const std::string kEmpty;
+    if (!IsValid()) {
+        return kEmpty;
+    }
+    auto& registry = KeyTable();
+    std::shared_lock lock(registry.mutex);
+    return registry.names[id_];  // deque elements never move
+}
+
+// ---------------------------------------------------------------------------
+// Sessions
+// ---------------------------------------------------------------------------
+
+InstrumentedMutex& Properties::RegistryMutex() {
+    static InstrumentedMutex mutex("properties.registry");
     return mutex;
 }
 
-std::map<std::string, std::unique_ptr<Properties>>& Properties::Registry() {
-    static std::map<std::string, std::unique_ptr<Properties>> registry;
+std::map<std::string, std::shared_ptr<Properties>>& Properties::Registry() {
+    static std::map<std::string, std::shared_ptr<Properties>> registry;
     return registry;
 }
 
@@ -19,10 +85,44 @@ Properties& Properties::GetSession(const std::string& name) {
     if (it != reg.end()) {
         return *it->second;
     }
-    auto [inserted, _] = reg.emplace(name, std::unique_ptr<Properties>(new Properties()));
+    auto [inserted, _] = reg.emplace(name, std::shared_ptr<Properties>(new Properties(name)));
     return *inserted->second;
 }
 
+std::shared_ptr<Properties> Properties::CreateDetached(const std::string& name) {
+    return std::shared_ptr<Properties>(new Properties(name));
+}
+
+Result<Properties*> Properties::ForkSession(const std::string& name,
+                                            const std::string& base) {
+    std::shared_ptr<const Properties> base_session;
+    {
+        std::lock_guard lock(RegistryMutex());
+        auto it = Registry().find(base);
+        if (it == Registry().end()) {
+            return Result<Properties*>::Err(ErrorCode::kNotFound);
+        }
+        base_session = it->second;
+    }
+    return ForkSession(name, std::move(base_session));
+}
+
+Result<Properties*> Properties::ForkSession(
+    const std::string& name, std::shared_ptr<const Properties> base) {
+    if (!base) {
+        return Result<Properties*>::Err(ErrorCode::kInvalidArgument);
+    }
+    auto fork = std::shared_ptr<Properties>(new Properties(name));
+    fork->base_ = std::move(base);
+
+    std::lock_guard lock(RegistryMutex());
+    auto [it, inserted] = Registry().emplace(name, std::move(fork));
+    if (!inserted) {
+        return Result<Properties*>::Err(ErrorCode::kAlreadyOpen);
+    }
+    return Result<Properties*>::Ok(it->second.get());
+}
+
 void Properties::DestroySession(const std::string& name) {
     std::lock_guard lock(RegistryMutex());
     Registry().erase(name);
@@ -38,34 +138,446 @@ bool Properties::HasSession(const std::string& name) {
     return Registry().count(name) > 0;
 }
 
+std::vector<std::string> Properties::SessionNames() {
+    std::lock_guard lock(RegistryMutex());
+    std::vector<std::string> names;
+    names.reserve(Registry().size());
+    for (const auto& [name, _] : Registry()) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+std::shared_ptr<Properties> Properties::FindSession(const std::string& name) {
+    std::lock_guard lock(RegistryMutex());
+    auto it = Registry().find(name);
+    return it == Registry().end() ? nullptr : it->second;
+}
+
+// ---------------------------------------------------------------------------
+// Storage
+// ---------------------------------------------------------------------------
+
+detail::PropertySlot& Properties::SlotForWriteLocked(PropertyKey key) {
+    const auto* table = table_.load(std::memory_order_relaxed);
+    if (!table || key.Id() >= table->capacity) {
+        size_t capacity = table ? table->capacity * 2 : 16;
+        capacity = std::max<size_t>(capacity, size_t{key.Id()} + 1);
+        auto grown = std::make_unique<SlotTable>(capacity);
+        if (table) {
+            for (size_t i = 0; i < table->capacity; ++i) {
+                grown->slots[i].store(
+                    table->slots[i].load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+            }
+        }
+        table = grown.get();
+        tables_.push_back(std::move(grown));
+        table_.store(table, std::memory_order_release);
+    }
+
+    auto* slot = table->slots[key.Id()].load(std::memory_order_relaxed);
+    if (!slot) {
+        slot = &slots_.emplace_back();
+        table->slots[key.Id()].store(slot, std::memory_order_release);
+    }
+    return *slot;
+}
+
+namespace {
+
+/// Seqlock write; caller holds the session's write_mutex_.
+void StoreSlot(detail::PropertySlot& slot, detail::PropertyKind kind,
+               uint64_t bits, std::shared_ptr<const detail::PropertyBox> box) {
+    auto seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.kind.store(kind, std::memory_order_relaxed);
+    slot.bits.store(bits, std::memory_order_relaxed);
+    std::atomic_store_explicit(&slot.box, std::move(box),
+                               std::memory_order_release);
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Change notification
+// ---------------------------------------------------------------------------
+
+struct Properties::Subscriber {
+    SubscriptionId id = 0;
+    std::string prefix;
+    ChangeCallback callback;
+    std::atomic<bool> active{true};
+};
+
+/// Process-wide notification thread, started by the first posted change.
+/// Events carry the subscriber list and key ids of one commit; names are
+/// resolved and prefixes matched here, off the writer's thread.
+class Properties::Dispatcher {
+public:
+    struct Event {
+        std::shared_ptr<const SubscriberList> subscribers;
+        std::string session;
+        uint64_t version;
+        std::vector<uint32_t> ids;
+    };
+
+    static Dispatcher& Instance() {
+        static Dispatcher dispatcher;
+        return dispatcher;
+    }
+
+    ~Dispatcher() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        queue_cv_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void Post(Event event) {
+        {
+            std::lock_guard lock(mutex_);
+            if (!thread_.joinable()) {
+                thread_ = std::thread([this] { Run(); });
+            }
+            queue_.push_back(std::move(event));
+        }
+        queue_cv_.notify_one();
+    }
+
+    void Flush() {
+        if (OnDispatcherThread()) {
+            return;
+        }
+        std::unique_lock lock(mutex_);
+        idle_cv_.wait(lock, [this] { return queue_.empty() && !busy_; });
+    }
+
+    /// Wait for a callback that is running right now to return.
+    void WaitForCallback() {
+        if (!OnDispatcherThread()) {
+            std::lock_guard lock(invoke_mutex_);
+        }
+    }
+
+private:
+    Dispatcher() = default;
+
+    bool OnDispatcherThread() const {
+        return std::this_thread::get_id() == thread_id_.load();
+    }
+
+    void Run() {
+        thread_id_.store(std::this_thread::get_id());
+        std::unique_lock lock(mutex_);
+        for (;;) {
+            queue_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (stop_) {
+                return;
+            }
+            auto event = std::move(queue_.front());
+            queue_.pop_front();
+            busy_ = true;
+            lock.unlock();
+
+            Deliver(event);
+
+            lock.lock();
+            busy_ = false;
+            if (queue_.empty()) {
+                idle_cv_.notify_all();
+            }
+        }
+    }
+
+    void Deliver(const Event& event) {
+        std::vector<const std::string*> names;
+        names.reserve(event.ids.size());
+        for (auto id : event.ids) {
+            names.push_back(&PropertyKey(id).Name());
+        }
+
+        PropertyChange change;
+        change.session = event.session;
+        change.version = event.version;
+        for (const auto& subscriber : *event.subscribers) {
+            change.keys.clear();
+            for (const auto* name : names) {
+                if (name->compare(0, subscriber->prefix.size(),
+                                  subscriber->prefix) == 0) {
+                    change.keys.push_back(*name);
+                }
+            }
+            if (change.keys.empty()) {
+                continue;
+            }
+            std::lock_guard invoke(invoke_mutex_);
+            if (subscriber->active.load(std::memory_order_acquire)) {
+                subscriber->callback(change);
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable queue_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<Event> queue_;
+    bool busy_ = false;
+    bool stop_ = false;
+    std::thread thread_;
+    std::atomic<std::thread::id> thread_id_{};
+    std::mutex invoke_mutex_;  // held while a callback runs
+};
+
+void Properties::PostChange(std::shared_ptr<const SubscriberList> subscribers,
+                            const std::string& session, uint64_t version,
+                            std::vector<uint32_t> ids) {
+    Dispatcher::Instance().Post(
+        {std::move(subscribers), session, version, std::move(ids)});
+}
+
+Properties::SubscriptionId Properties::Subscribe(std::string prefix,
+                                                 ChangeCallback callback) {
+    static std::atomic<SubscriptionId> next_id{1};
+    auto subscriber = std::make_shared<Subscriber>();
+    subscriber->id = next_id.fetch_add(1, std::memory_order_relaxed);
+    subscriber->prefix = std::move(prefix);
+    subscriber->callback = std::move(callback);
+
+    std::lock_guard lock(write_mutex_);
+    auto list = subscribers_ ? std::make_shared<SubscriberList>(*subscribers_)
+                             : std::make_shared<SubscriberList>();
+    list->push_back(subscriber);
+    subscribers_ = std::move(list);
+    return subscriber->id;
+}
+
+void Properties::Unsubscribe(SubscriptionId id) {
+    std::shared_ptr<Subscriber> removed;
+    {
+        std::lock_guard lock(write_mutex_);
+        if (!subscribers_) {
+            return;
+        }
+        auto list = std::make_shared<SubscriberList>();
+        for (const auto& subscriber : *subscribers_) {
+            if (subscriber->id == id) {
+                removed = subscriber;
+            } else {
+                list->push_back(subscriber);
+            }
+        }
+        subscribers_ = std::move(list);
+    }
+    if (removed) {
+        // Events already queued still hold the subscriber; make them skip it.
+        removed->active.store(false, std::memory_order_release);
+        Dispatcher::Instance().WaitForCallback();
+    }
+}
+
+void Properties::FlushNotifications() {
+    Dispatcher::Instance().Flush();
+}
+
+void Properties::Commit(const detail::PropertyWrite* writes, size_t count) {
+    std::lock_guard lock(write_mutex_);
+    CommitLocked(writes, count);
+}
+
+void Properties::SetMany(const PropertyBatch& batch) {
+    Commit(batch.writes_.data(), batch.writes_.size());
+}
+
+void Properties::CommitLocked(const detail::PropertyWrite* writes,
+                              size_t count) {
+    const bool notify = subscribers_ && !subscribers_->empty();
+    std::vector<uint32_t> changed;
+    bool started = false;
+
+    for (size_t i = 0; i < count; ++i) {
+        const auto& write = writes[i];
+        if (!write.key.IsValid()) {
+            continue;
+        }
+        const bool is_set = write.kind != detail::PropertyKind::kEmpty;
+        const auto* existing = FindSlot(write.key);
+        const auto own = existing ? existing->kind.load(std::memory_order_relaxed)
+                                  : detail::PropertyKind::kEmpty;
+        const bool was_set = own != detail::PropertyKind::kEmpty &&
+                             own != detail::PropertyKind::kRemoved;
+        auto kind = write.kind;
+        if (!is_set) {
+            if (!Has(write.key)) {
+                continue;  // removing a key that is not set
+            }
+            if (base_ && base_->Has(write.key)) {
+                kind = detail::PropertyKind::kRemoved;  // hide the base's value
+            }
+        }
+
+        if (!started) {
+            version_.fetch_add(1, std::memory_order_relaxed);  // odd: in progress
+            std::atomic_thread_fence(std::memory_order_release);
+            started = true;
+        }
+        StoreSlot(SlotForWriteLocked(write.key), kind, write.bits, write.box);
+        if (is_set && !was_set) {
+            size_.fetch_add(1, std::memory_order_relaxed);
+        } else if (was_set && !is_set) {
+            size_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        if (notify) {
+            changed.push_back(write.key.Id());
+        }
+    }
+
+    if (!started) {
+        return;
+    }
+    auto version = version_.fetch_add(1, std::memory_order_release) + 1;
+    if (notify) {
+        PostChange(subscribers_, name_, version, std::move(changed));
+    }
+}
+
+bool Properties::Has(PropertyKey key) const {
+    for (const auto* layer = this; layer; layer = layer->base_.get()) {
+        const auto* slot = layer->FindSlot(key);
+        if (!slot) {
+            continue;
+        }
+        auto kind = slot->kind.load(std::memory_order_acquire);
+        if (kind != detail::PropertyKind::kEmpty) {
+            return kind != detail::PropertyKind::kRemoved;
+        }
+    }
+    return false;
+}
+
+void Properties::Remove(PropertyKey key) {
+    detail::PropertyWrite write{key, detail::PropertyKind::kEmpty, 0, nullptr};
+    Commit(&write, 1);
+}
+
 bool Properties::Has(const std::string& key) const {
-    std::shared_lock lock(mutex_);
-    return store_.count(key) > 0;
+    return Has(PropertyKey::Find(key));
 }
 
 void Properties::Remove(const std::string& key) {
-    std::unique_lock lock(mutex_);
-    store_.erase(key);
+    Remove(PropertyKey::Find(key));
 }
 
 void Properties::Clear() {
-    std::unique_lock lock(mutex_);
-    store_.clear();
+    std::lock_guard lock(write_mutex_);
+    std::vector<detail::PropertyWrite> removals;
+    for (auto id : VisibleIdsLocked()) {
+        removals.push_back(
+            {PropertyKey(id), detail::PropertyKind::kEmpty, 0, nullptr});
+    }
+    CommitLocked(removals.data(), removals.size());
 }
 
 size_t Properties::Size() const {
-    std::shared_lock lock(mutex_);
-    return store_.size();
+    if (!base_) {
+        return size_.load(std::memory_order_relaxed);
+    }
+    std::lock_guard lock(write_mutex_);
+    return VisibleIdsLocked().size();
 }
 
 std::vector<std::string> Properties::Keys() const {
-    std::shared_lock lock(mutex_);
     std::vector<std::string> keys;
-    keys.reserve(store_.size());
-    for (const auto& [key, _] : store_) {
-        keys.push_back(key);
+    std::lock_guard lock(write_mutex_);
+    for (auto id : VisibleIdsLocked()) {
+        keys.push_back(PropertyKey(id).Name());
     }
+    std::sort(keys.begin(), keys.end());
     return keys;
 }
 
+std::vector<uint32_t> Properties::VisibleIdsLocked() const {
+    enum : uint8_t { kUndecided, kVisible, kHidden };
+    std::vector<uint8_t> state;
+    for (const auto* layer = this; layer; layer = layer->base_.get()) {
+        // Forks lock their bases, never the reverse, so this cannot deadlock.
+        std::unique_lock<InstrumentedMutex> lock;
+        if (layer != this) {
+            lock = std::unique_lock(layer->write_mutex_);
+        }
+        const auto* table = layer->table_.load(std::memory_order_relaxed);
+        if (!table) {
+            continue;
+        }
+        if (state.size() < table->capacity) {
+            state.resize(table->capacity, kUndecided);
+        }
+        for (uint32_t id = 0; id < table->capacity; ++id) {
+            const auto* slot = table->slots[id].load(std::memory_order_relaxed);
+            if (!slot || state[id] != kUndecided) {
+                continue;
+            }
+            auto kind = slot->kind.load(std::memory_order_relaxed);
+            if (kind != detail::PropertyKind::kEmpty) {
+                state[id] = kind == detail::PropertyKind::kRemoved ? kHidden
+                                                                   : kVisible;
+            }
+        }
+    }
+
+    std::vector<uint32_t> ids;
+    for (uint32_t id = 0; id < state.size(); ++id) {
+        if (state[id] == kVisible) {
+            ids.push_back(id);
+        }
+    }
+    return ids;
+}
+
+std::shared_ptr<const Properties> Properties::Snapshot() const {
+    // Not yet shared, so the copy is filled without taking its lock.
+    auto snapshot = std::shared_ptr<Properties>(new Properties(name_));
+    snapshot->frozen_ = true;
+    size_t size = 0;
+    auto copy = [&](uint32_t id, const detail::PropertyRead& read) {
+        StoreSlot(snapshot->SlotForWriteLocked(PropertyKey(id)), read.kind,
+                  read.bits, read.box);
+        if (read.kind != detail::PropertyKind::kRemoved) {
+            ++size;
+        }
+    };
+
+    std::lock_guard lock(write_mutex_);
+    if (base_ && base_->frozen_) {
+        // The base cannot change: share it and copy only this layer,
+        // tombstones included.
+        snapshot->base_ = base_;
+        const auto* table = table_.load(std::memory_order_relaxed);
+        for (uint32_t id = 0; table && id < table->capacity; ++id) {
+            const auto* slot = table->slots[id].load(std::memory_order_relaxed);
+            detail::PropertyRead read;
+            if (slot && detail::ReadSlot(*slot, read)) {
+                copy(id, read);
+            }
+        }
+    } else {
+        for (auto id : VisibleIdsLocked()) {
+            detail::PropertyRead read;
+            if (Read(PropertyKey(id), read)) {
+                copy(id, read);
+            }
+        }
+    }
+    snapshot->size_.store(size, std::memory_order_relaxed);
+    snapshot->version_.store(version_.load(std::memory_order_relaxed),
+                             std::memory_order_relaxed);
+    return snapshot;
+}
+
 }  // namespace plas::core
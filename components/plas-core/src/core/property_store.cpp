@@ -0,0 +1,369 @@
+#include "plas/core/property_store.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#include "plas/core/properties.h"
+
+namespace plas::core {
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'L', 'A', 'S', 'P', 'R', 'P', '\0'};
+
+struct FileHeader {
+    char     magic[8];        ///< kMagic
+    uint32_t version;         ///< PropertyStore::kFormatVersion
+    uint32_t session_count;
+    uint64_t payload_bytes;   ///< bytes after the header
+    uint64_t checksum;        ///< FNV-1a of the payload
+};
+static_assert(sizeof(FileHeader) == 32, "format layout changed");
+
+uint64_t Fnv1a(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+class Writer {
+public:
+    template <typename T>
+    void Put(T value) {
+        auto offset = bytes_.size();
+        bytes_.resize(offset + sizeof(T));
+        std::memcpy(bytes_.data() + offset, &value, sizeof(T));
+    }
+
+    void PutString(const std::string& text) {
+        Put(static_cast<uint32_t>(text.size()));
+        bytes_.insert(bytes_.end(), text.begin(), text.end());
+    }
+
+    template <typename T>
+    void PutAt(size_t offset, T value) {
+        std::memcpy(bytes_.data() + offset, &value, sizeof(T));
+    }
+
+    size_t Size() const { return bytes_.size(); }
+    std::vector<uint8_t>& Bytes() { return bytes_; }
+
+private:
+    std::vector<uint8_t> bytes_;
+};
+
+/// Bounds-checked cursor; every getter returns false past the end.
+class Reader {
+public:
+    explicit Reader(ByteView bytes) : bytes_(bytes) {}
+
+    template <typename T>
+    bool Get(T& value) {
+        if (bytes_.Size() - offset_ < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, bytes_.Data() + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    bool GetString(std::string& text) {
+        uint32_t size = 0;
+        if (!Get(size) || bytes_.Size() - offset_ < size) {
+            return false;
+        }
+        text.assign(reinterpret_cast<const char*>(bytes_.Data() + offset_), size);
+        offset_ += size;
+        return true;
+    }
+
+    bool AtEnd() const { return offset_ == bytes_.Size(); }
+
+private:
+    ByteView bytes_;
+    size_t offset_ = 0;
+};
+
+bool IsStoredKind(detail::PropertyKind kind) {
+    return kind >= detail::PropertyKind::kBool &&
+           kind <= detail::PropertyKind::kString;
+}
+
+struct DecodedSession {
+    std::string name;
+    std::vector<detail::PropertyWrite> writes;
+};
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// PropertyStore
+// ---------------------------------------------------------------------------
+
+std::vector<uint8_t> PropertyStore::Encode(const std::vector<std::string>& sessions) {
+    const auto names = sessions.empty() ? Properties::SessionNames() : sessions;
+
+    Writer out;
+    out.Put(FileHeader{});
+    uint32_t session_count = 0;
+    for (const auto& name : names) {
+        auto session = Properties::FindSession(name);
+        if (!session) {
+            continue;
+        }
+        auto snapshot = session->Snapshot();
+        out.PutString(name);
+        const size_t count_offset = out.Size();
+        out.Put(uint32_t{0});
+
+        uint32_t entry_count = 0;
+        for (const auto& key : snapshot->Keys()) {
+            detail::PropertyRead read;
+            if (!snapshot->Read(PropertyKey::Find(key), read) ||
+                !IsStoredKind(read.kind)) {
+                continue;  // std::any values have no binary form
+            }
+            out.PutString(key);
+            out.Put(static_cast<uint8_t>(read.kind));
+            if (read.kind == detail::PropertyKind::kString) {
+                out.PutString(std::get<0>(*read.box));
+            } else {
+                out.Put(read.bits);
+            }
+            ++entry_count;
+        }
+        out.PutAt(count_offset, entry_count);
+        ++session_count;
+    }
+
+    auto& bytes = out.Bytes();
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.session_count = session_count;
+    header.payload_bytes = bytes.size() - sizeof(FileHeader);
+    header.checksum = Fnv1a(bytes.data() + sizeof(FileHeader), header.payload_bytes);
+    out.PutAt(0, header);
+    return std::move(bytes);
+}
+
+Result<size_t> PropertyStore::Decode(ByteView bytes) {
+    Reader in(bytes);
+    FileHeader header{};
+    if (!in.Get(header) ||
+        std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        return Result<size_t>::Err(ErrorCode::kDataLoss);
+    }
+    if (header.version != kFormatVersion) {
+        return Result<size_t>::Err(ErrorCode::kNotSupported);
+    }
+    if (header.payload_bytes != bytes.Size() - sizeof(FileHeader) ||
+        header.checksum != Fnv1a(bytes.Data() + sizeof(FileHeader),
+                                 bytes.Size() - sizeof(FileHeader))) {
+        return Result<size_t>::Err(ErrorCode::kDataLoss);
+    }
+
+    // Parse everything before touching a session.
+    std::vector<DecodedSession> decoded(header.session_count);
+    for (auto& session : decoded) {
+        uint32_t entry_count = 0;
+        if (!in.GetString(session.name) || !in.Get(entry_count)) {
+            return Result<size_t>::Err(ErrorCode::kDataLoss);
+        }
+        for (uint32_t i = 0; i < entry_count; ++i) {
+            std::string key;
+            uint8_t tag = 0;
+            if (!in.GetString(key) || !in.Get(tag)) {
+                return Result<size_t>::Err(ErrorCode::kDataLoss);
+            }
+            detail::PropertyWrite write;
+            write.key = PropertyKey::Intern(key);
+            write.kind = static_cast<detail::PropertyKind>(tag);
+            if (!IsStoredKind(write.kind)) {
+                return Result<size_t>::Err(ErrorCode::kDataLoss);
+            }
+            if (write.kind == detail::PropertyKind::kString) {
+                std::string text;
+                if (!in.GetString(text)) {
+                    return Result<size_t>::Err(ErrorCode::kDataLoss);
+                }
+                write.box = std::make_shared<const detail::PropertyBox>(
+                    std::in_place_index<0>, std::move(text));
+            } else if (!in.Get(write.bits)) {
+                return Result<size_t>::Err(ErrorCode::kDataLoss);
+            }
+            session.writes.push_back(std::move(write));
+        }
+    }
+    if (!in.AtEnd()) {
+        return Result<size_t>::Err(ErrorCode::kDataLoss);
+    }
+
+    for (auto& session : decoded) {
+        auto& props = Properties::GetSession(session.name);
+        std::lock_guard lock(props.write_mutex_);
+        // Drop keys the checkpoint does not have, in the same commit.
+        std::vector<bool> restored;
+        for (const auto& write : session.writes) {
+            if (restored.size() <= write.key.Id()) {
+                restored.resize(size_t{write.key.Id()} + 1);
+            }
+            restored[write.key.Id()] = true;
+        }
+        for (auto id : props.VisibleIdsLocked()) {
+            if (id >= restored.size() || !restored[id]) {
+                session.writes.push_back(
+                    {PropertyKey(id), detail::PropertyKind::kEmpty, 0, nullptr});
+            }
+        }
+        props.CommitLocked(session.writes.data(), session.writes.size());
+    }
+    return Result<size_t>::Ok(decoded.size());
+}
+
+Result<void> PropertyStore::Save(const std::string& path,
+                                 const std::vector<std::string>& sessions) {
+    const auto bytes = Encode(sessions);
+
+    // Write beside the target and rename, so a crash mid-save leaves the
+    // previous checkpoint intact.
+    static std::atomic<uint64_t> sequence{0};
+    const std::string tmp_path = path + ".tmp." + std::to_string(::getpid()) +
+                                 "." + std::to_string(sequence.fetch_add(1));
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return Result<void>::Err(ErrorCode::kIOError);
+        }
+        out.write(reinterpret_cast<const char*>(bytes.data()),
+                  static_cast<std::streamsize>(bytes.size()));
+        if (!out.good()) {
+            out.close();
+            std::remove(tmp_path.c_str());
+            return Result<void>::Err(ErrorCode::kIOError);
+        }
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return Result<void>::Err(ErrorCode::kIOError);
+    }
+    return Result<void>::Ok();
+}
+
+Result<size_t> PropertyStore::Load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return Result<size_t>::Err(ErrorCode::kNotFound);
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)),
+                               std::istreambuf_iterator<char>());
+    if (in.bad()) {
+        return Result<size_t>::Err(ErrorCode::kIOError);
+    }
+    return Decode(bytes);
+}
+
+// ---------------------------------------------------------------------------
+// PropertyCheckpoint
+// ---------------------------------------------------------------------------
+
+PropertyCheckpoint::~PropertyCheckpoint() {
+    Stop();
+}
+
+Result<void> PropertyCheckpoint::Start(Options options) {
+    if (options.path.empty() || options.interval.count() <= 0) {
+        return Result<void>::Err(ErrorCode::kInvalidArgument);
+    }
+    // Lock order: save_mutex_, then mutex_ (as in SaveIfChangedLocked).
+    std::lock_guard save_lock(save_mutex_);
+    std::lock_guard lock(mutex_);
+    if (thread_.joinable()) {
+        return Result<void>::Err(ErrorCode::kAlreadyOpen);
+    }
+    options_ = std::move(options);
+    stop_ = false;
+    last_state_.clear();
+    saved_once_ = false;
+    thread_ = std::thread([this] { Run(); });
+    return Result<void>::Ok();
+}
+
+void PropertyCheckpoint::Stop() {
+    std::thread thread;
+    {
+        std::lock_guard lock(mutex_);
+        if (!thread_.joinable()) {
+            return;
+        }
+        stop_ = true;
+        thread = std::move(thread_);
+    }
+    cv_.notify_all();
+    thread.join();
+    Flush();
+}
+
+bool PropertyCheckpoint::IsRunning() const {
+    std::lock_guard lock(mutex_);
+    return thread_.joinable();
+}
+
+Result<void> PropertyCheckpoint::Flush() {
+    std::lock_guard save_lock(save_mutex_);
+    return SaveIfChangedLocked();
+}
+
+void PropertyCheckpoint::Run() {
+    std::unique_lock lock(mutex_);
+    while (!cv_.wait_for(lock, options_.interval, [this] { return stop_; })) {
+        lock.unlock();
+        Flush();
+        lock.lock();
+    }
+}
+
+Result<void> PropertyCheckpoint::SaveIfChangedLocked() {
+    Options options;
+    {
+        std::lock_guard lock(mutex_);
+        options = options_;
+    }
+    if (options.path.empty()) {
+        return Result<void>::Err(ErrorCode::kNotInitialized);
+    }
+
+    // Versions are read before encoding: a commit landing in between is
+    // either in this checkpoint or triggers the next one.
+    const auto names = options.sessions.empty() ? Properties::SessionNames()
+                                                : options.sessions;
+    std::vector<std::pair<std::string, uint64_t>> state;
+    for (const auto& name : names) {
+        if (auto session = Properties::FindSession(name)) {
+            state.emplace_back(name, session->Version());
+        }
+    }
+    if (saved_once_ && state == last_state_) {
+        return Result<void>::Ok();
+    }
+
+    auto result = PropertyStore::Save(options.path, options.sessions);
+    if (result.IsError()) {
+        failures_.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+    last_state_ = std::move(state);
+    saved_once_ = true;
+    saves_.fetch_add(1, std::memory_order_relaxed);
+    return result;
+}
+
+}  // namespace plas::core
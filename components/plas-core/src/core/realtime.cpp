@@ -0,0 +1,230 @@
+#include "plas/core/realtime.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <cpuid.h>
+#endif
+
+#include "plas/core/error.h"
+#include "plas/core/numa.h"
+
+namespace plas::core {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto kCalibration = std::chrono::milliseconds(10);
+
+void CpuRelax() {
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    asm volatile("yield");
+#endif
+}
+
+/// A cycle counter that ticks at a constant rate in every P/C-state.
+bool HasHardwareCounter() {
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid(0x80000000u, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007u) {
+        return false;
+    }
+    __get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx);
+    return (edx & (1u << 8)) != 0;  // invariant TSC
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    return true;  // the generic timer is architecturally constant-rate
+#else
+    return false;
+#endif
+}
+
+/// Touch `bytes` of stack, a page per frame; the use after the recursive
+/// call keeps the frames from being merged.
+__attribute__((noinline)) void PrefaultStack(std::size_t bytes) {
+    constexpr std::size_t kPage = 4096;
+    volatile unsigned char page[kPage];
+    page[0] = 0;
+    page[kPage - 1] = 0;
+    if (bytes > kPage) {
+        PrefaultStack(bytes - kPage);
+    }
+    page[0] = page[kPage - 1];
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// TscClock
+// ---------------------------------------------------------------------------
+
+const TscClock& TscClock::Get() {
+    static const TscClock clock;
+    return clock;
+}
+
+TscClock::TscClock() : hardware_(HasHardwareCounter()) {
+    if (!hardware_) {
+        return;
+    }
+    const auto wall_start = Clock::now();
+    const uint64_t ticks_start = Ticks();
+    auto wall_end = wall_start;
+    while (wall_end - wall_start < kCalibration) {
+        wall_end = Clock::now();
+    }
+    const uint64_t ticks_end = Ticks();
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wall_end - wall_start);
+    if (ticks_end <= ticks_start) {
+        hardware_ = false;  // a counter that does not advance is no clock
+        return;
+    }
+    ns_per_tick_ = static_cast<double>(ns.count()) / static_cast<double>(ticks_end - ticks_start);
+}
+
+void TscClock::SpinUntil(uint64_t ticks) const {
+    while (Ticks() < ticks) {
+        CpuRelax();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Real-time threads
+// ---------------------------------------------------------------------------
+
+RealtimeStatus EnterRealtime(const RealtimeOptions& options) {
+    RealtimeStatus status;
+#ifdef __linux__
+    if (options.cpu >= 0 && options.cpu < CPU_SETSIZE) {
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        CPU_SET(static_cast<std::size_t>(options.cpu), &mask);
+        status.pinned = pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+        if (status.pinned) {
+            auto isolated = IsolatedCpus();
+            status.isolated_cpu =
+                std::find(isolated.begin(), isolated.end(), options.cpu) != isolated.end();
+        }
+    }
+#endif
+#ifndef _WIN32
+    if (options.fifo_priority > 0) {
+        sched_param param{};
+        param.sched_priority = std::clamp(options.fifo_priority, sched_get_priority_min(SCHED_FIFO),
+                                          sched_get_priority_max(SCHED_FIFO));
+        status.fifo = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+    }
+#endif
+    PrefaultStack(options.stack_prefault_bytes);
+    status.hardware_clock = TscClock::Get().IsHardware();
+    return status;
+}
+
+std::vector<int> IsolatedCpus() {
+    std::ifstream in("/sys/devices/system/cpu/isolated");
+    if (!in) {
+        return {};
+    }
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    auto cpus = ParseCpuList(text);
+    return cpus.IsOk() ? std::move(cpus).Value() : std::vector<int>{};
+}
+
+// ---------------------------------------------------------------------------
+// RealtimeArena
+// ---------------------------------------------------------------------------
+
+RealtimeArena::~RealtimeArena() {
+    if (data_ != nullptr) {
+        if (locked_) {
+            ::munlock(data_, capacity_);
+        }
+        ::munmap(data_, capacity_);
+    }
+}
+
+RealtimeArena& RealtimeArena::operator=(RealtimeArena&& other) noexcept {
+    if (this != &other) {
+        RealtimeArena old(std::move(*this));
+        data_ = std::exchange(other.data_, nullptr);
+        capacity_ = std::exchange(other.capacity_, 0);
+        used_ = std::exchange(other.used_, 0);
+        locked_ = std::exchange(other.locked_, false);
+    }
+    return *this;
+}
+
+Result<RealtimeArena> RealtimeArena::Create(std::size_t bytes) {
+    if (bytes == 0) {
+        return Result<RealtimeArena>::Err(ErrorCode::kInvalidArgument);
+    }
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t capacity = (bytes + page - 1) / page * page;
+    void* data = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                        -1, 0);
+    if (data == MAP_FAILED) {
+        return Result<RealtimeArena>::Err(ErrorCode::kOutOfMemory);
+    }
+    RealtimeArena arena;
+    arena.data_ = static_cast<unsigned char*>(data);
+    arena.capacity_ = capacity;
+    // Write every page so each has its own frame (not the shared zero
+    // page), then pin them.
+    for (std::size_t offset = 0; offset < capacity; offset += page) {
+        arena.data_[offset] = 0;
+    }
+    arena.locked_ = ::mlock(data, capacity) == 0;
+    return Result<RealtimeArena>::Ok(std::move(arena));
+}
+
+void* RealtimeArena::Allocate(std::size_t bytes, std::size_t align) {
+    if (data_ == nullptr || align == 0 || (align & (align - 1)) != 0) {
+        return nullptr;
+    }
+    const auto base = reinterpret_cast<uintptr_t>(data_);
+    const uintptr_t aligned = (base + used_ + align - 1) & ~static_cast<uintptr_t>(align - 1);
+    const std::size_t offset = static_cast<std::size_t>(aligned - base);
+    if (offset > capacity_ || bytes > capacity_ - offset) {
+        return nullptr;
+    }
+    used_ = offset + bytes;
+    return data_ + offset;
+}
+
+// ---------------------------------------------------------------------------
+// JitterStats
+// ---------------------------------------------------------------------------
+
+JitterStats JitterStats::FromSamples(std::vector<uint64_t> lateness_ns) {
+    JitterStats stats;
+    if (lateness_ns.empty()) {
+        return stats;
+    }
+    std::sort(lateness_ns.begin(), lateness_ns.end());
+    const std::size_t n = lateness_ns.size();
+    uint64_t total = 0;
+    for (uint64_t sample : lateness_ns) {
+        total += sample;
+    }
+    stats.samples = n;
+    stats.min_ns = lateness_ns.front();
+    stats.max_ns = lateness_ns.back();
+    stats.mean_ns = total / n;
+    stats.p99_ns = lateness_ns[(n * 99 + 99) / 100 - 1];
+    return stats;
+}
+
+}  // namespace plas::core
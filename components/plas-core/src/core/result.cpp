@@ -0,0 +1,61 @@
+#include "plas/core/result.h"
+
+#include <array>
+#include <atomic>
+
+namespace plas::core::detail {
+
+namespace {
+
+constexpr std::size_t kMaxCategories = 64;
+
+/// Slot 0 is "no error"; slots fill in order and are never cleared, so a
+/// reader that sees a slot set sees its final value.
+struct CategoryTable {
+    CategoryTable() {
+        slots[kPlasCategory].store(&PlasErrorCategory::Instance(),
+                                   std::memory_order_relaxed);
+        slots[2].store(&std::generic_category(), std::memory_order_relaxed);
+        slots[3].store(&std::system_category(), std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<const std::error_category*>, kMaxCategories>
+        slots{};
+};
+
+CategoryTable& Table() {
+    static CategoryTable table;
+    return table;
+}
+
+}  // namespace
+
+uint16_t ErrorCategoryIndex(const std::error_category& category) {
+    auto& slots = Table().slots;
+    for (std::size_t i = kPlasCategory; i < kMaxCategories; ++i) {
+        const std::error_category* current =
+            slots[i].load(std::memory_order_acquire);
+        while (current == nullptr) {
+            if (slots[i].compare_exchange_weak(current, &category,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {
+                return static_cast<uint16_t>(i);
+            }
+        }
+        // error_category equality is identity.
+        if (*current == category) {
+            return static_cast<uint16_t>(i);
+        }
+    }
+    return kNoError;
+}
+
+const std::error_category& ErrorCategoryAt(uint16_t index) {
+    const std::error_category* category =
+        index < kMaxCategories
+            ? Table().slots[index].load(std::memory_order_acquire)
+            : nullptr;
+    return category ? *category : PlasErrorCategory::Instance();
+}
+
+}  // namespace plas::core::detail
@@ -0,0 +1,54 @@
+#include "plas/core/retry.h"
+
+#include <algorithm>
+#include <random>
+#include <thread>
+
+#include "plas/core/deadline.h"
+
+namespace plas::core {
+
+namespace {
+
+std::minstd_rand& Rng() {
+    thread_local std::minstd_rand rng(std::random_device{}());
+    return rng;
+}
+
+}  // namespace
+
+bool RetryPolicy::IsRetryable(const std::error_code& error) const {
+    if (error.category() != PlasErrorCategory::Instance()) {
+        return false;
+    }
+    auto code = static_cast<uint32_t>(error.value());
+    return code < 32 && ((retry_on >> code) & 1u);
+}
+
+std::chrono::microseconds RetryPolicy::Backoff(uint32_t retry) const {
+    auto delay = initial_backoff;
+    for (uint32_t i = 1; i < retry && delay < max_backoff; ++i) {
+        delay *= 2;
+    }
+    delay = std::min(delay, max_backoff);
+    double spread = std::clamp(jitter, 0.0, 1.0);
+    if (spread > 0.0 && delay.count() > 0) {
+        std::uniform_real_distribution<double> cut(0.0, spread);
+        delay = std::chrono::microseconds(std::max<int64_t>(
+            1, static_cast<int64_t>(static_cast<double>(delay.count()) * (1.0 - cut(Rng())))));
+    }
+    return delay;
+}
+
+bool SleepForRetry(std::chrono::microseconds delay) {
+    auto deadline = Deadline::Current();
+    if (deadline.IsSet() && deadline.Remaining() <= delay) {
+        return false;
+    }
+    if (delay.count() > 0) {
+        std::this_thread::sleep_for(delay);
+    }
+    return true;
+}
+
+}  // namespace plas::core
@@ -0,0 +1,495 @@
+#include "plas/core/shared_properties.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <unordered_set>
+
+namespace plas::core {
+
+namespace {
+
+constexpr char kShmMagic[8] = {'P', 'L', 'A', 'S', 'S', 'H', 'M', '\0'};
+constexpr uint32_t kShmFormatVersion = 1;
+
+// Region layout: ShmHeader, ShmEntry[capacity], char arena[string_bytes].
+// Every field readers touch is atomic, so a torn read is detected by the
+// seqlock rather than being undefined behaviour.
+struct ShmHeader {
+    char magic[8];                    ///< kShmMagic
+    uint32_t format;                  ///< kShmFormatVersion
+    uint32_t capacity;                ///< entries, power of two
+    uint64_t string_bytes;
+    std::atomic<uint32_t> ready;      ///< set last by Create()
+    std::atomic<uint32_t> size;       ///< live keys
+    std::atomic<uint64_t> seq;        ///< seqlock; odd while writing
+};
+
+struct ShmEntry {
+    std::atomic<uint64_t> hash;       ///< 0: never used
+    std::atomic<uint64_t> bits;
+    std::atomic<uint32_t> text_offset;
+    std::atomic<uint32_t> text_size;
+    std::atomic<uint8_t> kind;        ///< detail::PropertyKind; kEmpty = removed
+    std::atomic<uint8_t> key_size;
+    std::atomic<char> key[SharedProperties::kMaxKeyLength];
+};
+static_assert(sizeof(ShmEntry) == 128, "region layout changed");
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared-memory atomics must be address-free");
+
+uint64_t HashKey(std::string_view key) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (char c : key) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash | 1u;  // 0 marks an unused entry
+}
+
+size_t RegionSize(uint32_t capacity, uint64_t string_bytes) {
+    return sizeof(ShmHeader) + size_t{capacity} * sizeof(ShmEntry) +
+           static_cast<size_t>(string_bytes);
+}
+
+ErrorCode ShmError(int err) {
+    switch (err) {
+        case ENOENT:       return ErrorCode::kNotFound;
+        case EEXIST:       return ErrorCode::kAlreadyOpen;
+        case EACCES:       return ErrorCode::kPermissionDenied;
+        case EINVAL:
+        case ENAMETOOLONG: return ErrorCode::kInvalidArgument;
+        default:           return ErrorCode::kIOError;
+    }
+}
+
+bool KeyEquals(const ShmEntry& entry, std::string_view key) {
+    if (entry.key_size.load(std::memory_order_relaxed) != key.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < key.size(); ++i) {
+        if (entry.key[i].load(std::memory_order_relaxed) != key[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+struct SharedProperties::Impl {
+    ~Impl() {
+        if (base) {
+            ::munmap(base, map_size);
+        }
+    }
+
+    /// Entry holding `key`, or null. Safe on a torn table: probing is
+    /// bounded and the caller validates the read with the seqlock.
+    ShmEntry* Find(std::string_view key, uint64_t hash) const {
+        const uint32_t mask = header->capacity - 1;
+        uint32_t index = static_cast<uint32_t>(hash) & mask;
+        for (uint32_t probes = 0; probes < header->capacity; ++probes) {
+            auto& entry = entries[index];
+            auto stored = entry.hash.load(std::memory_order_relaxed);
+            if (stored == 0) {
+                return nullptr;
+            }
+            if (stored == hash && KeyEquals(entry, key)) {
+                return &entry;
+            }
+            index = (index + 1) & mask;
+        }
+        return nullptr;
+    }
+
+    /// First unused entry on `key`'s probe path. Writer only.
+    ShmEntry* Claim(std::string_view key, uint64_t hash) {
+        const uint32_t mask = header->capacity - 1;
+        uint32_t index = static_cast<uint32_t>(hash) & mask;
+        while (entries[index].hash.load(std::memory_order_relaxed) != 0) {
+            index = (index + 1) & mask;
+        }
+        auto& entry = entries[index];
+        for (size_t i = 0; i < key.size(); ++i) {
+            entry.key[i].store(key[i], std::memory_order_relaxed);
+        }
+        entry.key_size.store(static_cast<uint8_t>(key.size()),
+                             std::memory_order_relaxed);
+        entry.hash.store(hash, std::memory_order_relaxed);
+        ++used;
+        return &entry;
+    }
+
+    uint64_t LiveStringBytes() const {
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < header->capacity; ++i) {
+            if (entries[i].kind.load(std::memory_order_relaxed) ==
+                static_cast<uint8_t>(detail::PropertyKind::kString)) {
+                total += entries[i].text_size.load(std::memory_order_relaxed);
+            }
+        }
+        return total;
+    }
+
+    /// Rewrite live strings from the start of the arena. Writer only,
+    /// inside a seqlock section.
+    void CompactArena() {
+        std::vector<std::pair<ShmEntry*, std::string>> live;
+        for (uint32_t i = 0; i < header->capacity; ++i) {
+            auto& entry = entries[i];
+            if (entry.kind.load(std::memory_order_relaxed) ==
+                static_cast<uint8_t>(detail::PropertyKind::kString)) {
+                live.emplace_back(&entry, ReadText(entry));
+            }
+        }
+        arena_used = 0;
+        for (auto& [entry, text] : live) {
+            StoreText(*entry, text);
+        }
+    }
+
+    std::string ReadText(const ShmEntry& entry) const {
+        auto offset = entry.text_offset.load(std::memory_order_relaxed);
+        auto size = entry.text_size.load(std::memory_order_relaxed);
+        if (uint64_t{offset} + size > header->string_bytes) {
+            return {};  // torn; the seqlock check discards it
+        }
+        std::string text(size, '\0');
+        for (uint32_t i = 0; i < size; ++i) {
+            text[i] = arena[offset + i].load(std::memory_order_relaxed);
+        }
+        return text;
+    }
+
+    void StoreText(ShmEntry& entry, std::string_view text) {
+        for (size_t i = 0; i < text.size(); ++i) {
+            arena[arena_used + i].store(text[i], std::memory_order_relaxed);
+        }
+        entry.text_offset.store(static_cast<uint32_t>(arena_used),
+                                std::memory_order_relaxed);
+        entry.text_size.store(static_cast<uint32_t>(text.size()),
+                              std::memory_order_relaxed);
+        arena_used += text.size();
+    }
+
+    void* base = nullptr;
+    size_t map_size = 0;
+    ShmHeader* header = nullptr;
+    ShmEntry* entries = nullptr;
+    std::atomic<char>* arena = nullptr;
+    bool writer = false;
+
+    // Writer state (the only process that changes the region).
+    std::mutex write_mutex;
+    uint32_t used = 0;        // entries claimed, including removed keys
+    uint64_t arena_used = 0;  // bytes; strings are appended until compaction
+};
+
+// ---------------------------------------------------------------------------
+// Region lifetime
+// ---------------------------------------------------------------------------
+
+SharedProperties::SharedProperties(std::unique_ptr<Impl> impl)
+    : impl_(std::move(impl)) {}
+
+SharedProperties::~SharedProperties() = default;
+
+Result<std::unique_ptr<SharedProperties>> SharedProperties::Create(
+    const std::string& name, Options options) {
+    using R = Result<std::unique_ptr<SharedProperties>>;
+    if (options.capacity == 0 ||
+        options.capacity > (std::numeric_limits<uint32_t>::max() >> 1) + 1 ||
+        options.string_bytes > std::numeric_limits<uint32_t>::max()) {
+        return R::Err(ErrorCode::kInvalidArgument);
+    }
+    uint32_t capacity = 1;
+    while (capacity < options.capacity) {
+        capacity <<= 1;
+    }
+
+    int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        return R::Err(ShmError(errno));
+    }
+    const size_t map_size = RegionSize(capacity, options.string_bytes);
+    void* base = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(map_size)) == 0) {
+        base = ::mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        ::shm_unlink(name.c_str());
+        return R::Err(ErrorCode::kIOError);
+    }
+
+    // ftruncate zero-fills: every entry starts unused and the seqlock at 0.
+    auto* header = static_cast<ShmHeader*>(base);
+    std::memcpy(header->magic, kShmMagic, sizeof(header->magic));
+    header->format = kShmFormatVersion;
+    header->capacity = capacity;
+    header->string_bytes = options.string_bytes;
+    new (&header->size) std::atomic<uint32_t>(0);
+    new (&header->seq) std::atomic<uint64_t>(0);
+    new (&header->ready) std::atomic<uint32_t>(0);
+    header->ready.store(1, std::memory_order_release);
+
+    auto impl = std::make_unique<Impl>();
+    impl->base = base;
+    impl->map_size = map_size;
+    impl->header = header;
+    impl->entries = reinterpret_cast<ShmEntry*>(header + 1);
+    impl->arena = reinterpret_cast<std::atomic<char>*>(impl->entries + capacity);
+    impl->writer = true;
+    return R::Ok(std::unique_ptr<SharedProperties>(new SharedProperties(std::move(impl))));
+}
+
+Result<std::unique_ptr<SharedProperties>> SharedProperties::Open(
+    const std::string& name) {
+    using R = Result<std::unique_ptr<SharedProperties>>;
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return R::Err(ShmError(errno));
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(ShmHeader))) {
+        ::close(fd);
+        return R::Err(ErrorCode::kDataLoss);
+    }
+    const auto map_size = static_cast<size_t>(st.st_size);
+    void* base = ::mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        return R::Err(ErrorCode::kIOError);
+    }
+
+    auto impl = std::make_unique<Impl>();
+    impl->base = base;
+    impl->map_size = map_size;
+    const auto* header = static_cast<const ShmHeader*>(base);
+    if (header->ready.load(std::memory_order_acquire) != 1) {
+        return R::Err(ErrorCode::kNotInitialized);
+    }
+    if (std::memcmp(header->magic, kShmMagic, sizeof(kShmMagic)) != 0 ||
+        header->format != kShmFormatVersion || header->capacity == 0 ||
+        (header->capacity & (header->capacity - 1)) != 0 ||
+        RegionSize(header->capacity, header->string_bytes) != map_size) {
+        return R::Err(ErrorCode::kDataLoss);
+    }
+    // Read-only mapping: const_cast only gives Impl one pointer type; the
+    // writer paths are unreachable without `writer`.
+    impl->header = const_cast<ShmHeader*>(header);
+    impl->entries = reinterpret_cast<ShmEntry*>(impl->header + 1);
+    impl->arena = reinterpret_cast<std::atomic<char>*>(impl->entries + header->capacity);
+    return R::Ok(std::unique_ptr<SharedProperties>(new SharedProperties(std::move(impl))));
+}
+
+Result<void> SharedProperties::Unlink(const std::string& name) {
+    if (::shm_unlink(name.c_str()) != 0) {
+        return Result<void>::Err(ShmError(errno));
+    }
+    return Result<void>::Ok();
+}
+
+bool SharedProperties::IsWriter() const {
+    return impl_->writer;
+}
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+
+Result<void> SharedProperties::Write(const detail::PropertyWrite* writes,
+                                     size_t count) {
+    auto& impl = *impl_;
+    if (!impl.writer) {
+        return Result<void>::Err(ErrorCode::kPermissionDenied);
+    }
+    std::lock_guard lock(impl.write_mutex);
+
+    // Validate the whole batch before the region is touched.
+    std::unordered_set<std::string_view> new_keys;
+    uint64_t text_bytes = 0;
+    bool effective = false;
+    for (size_t i = 0; i < count; ++i) {
+        const auto& write = writes[i];
+        if (!write.key.IsValid()) {
+            continue;  // removing a key that was never named
+        }
+        const auto& name = write.key.Name();
+        if (name.empty() || name.size() > kMaxKeyLength) {
+            return Result<void>::Err(ErrorCode::kInvalidArgument);
+        }
+        const auto* entry = impl.Find(name, HashKey(name));
+        if (write.kind == detail::PropertyKind::kEmpty) {
+            effective |= entry && entry->kind.load(std::memory_order_relaxed) !=
+                                      static_cast<uint8_t>(detail::PropertyKind::kEmpty);
+            continue;
+        }
+        effective = true;
+        if (!entry) {
+            new_keys.insert(name);
+        }
+        if (write.kind == detail::PropertyKind::kString) {
+            text_bytes += std::get<0>(*write.box).size();
+        }
+    }
+    if (!effective) {
+        return Result<void>::Ok();
+    }
+    if (impl.used + new_keys.size() > impl.header->capacity) {
+        return Result<void>::Err(ErrorCode::kResourceExhausted);
+    }
+    const bool compact = impl.arena_used + text_bytes > impl.header->string_bytes;
+    if (compact && impl.LiveStringBytes() + text_bytes > impl.header->string_bytes) {
+        return Result<void>::Err(ErrorCode::kResourceExhausted);
+    }
+
+    auto& header = *impl.header;
+    const auto seq = header.seq.load(std::memory_order_relaxed);
+    header.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (compact) {
+        impl.CompactArena();
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const auto& write = writes[i];
+        if (!write.key.IsValid()) {
+            continue;
+        }
+        const auto& name = write.key.Name();
+        const auto hash = HashKey(name);
+        auto* entry = impl.Find(name, hash);
+        const bool is_set = write.kind != detail::PropertyKind::kEmpty;
+        if (!entry) {
+            if (!is_set) {
+                continue;
+            }
+            entry = impl.Claim(name, hash);
+        }
+        const bool was_set = entry->kind.load(std::memory_order_relaxed) !=
+                             static_cast<uint8_t>(detail::PropertyKind::kEmpty);
+        if (write.kind == detail::PropertyKind::kString) {
+            impl.StoreText(*entry, std::get<0>(*write.box));
+        }
+        entry->bits.store(write.bits, std::memory_order_relaxed);
+        entry->kind.store(static_cast<uint8_t>(write.kind), std::memory_order_relaxed);
+        if (is_set && !was_set) {
+            header.size.fetch_add(1, std::memory_order_relaxed);
+        } else if (was_set && !is_set) {
+            header.size.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    header.seq.store(seq + 2, std::memory_order_release);
+    return Result<void>::Ok();
+}
+
+Result<void> SharedProperties::Remove(std::string_view key) {
+    detail::PropertyWrite write{PropertyKey::Find(key), detail::PropertyKind::kEmpty,
+                                0, nullptr};
+    return Write(&write, 1);
+}
+
+Result<void> SharedProperties::SetMany(const PropertyBatch& batch) {
+    for (const auto& write : batch.writes_) {
+        if (write.kind == detail::PropertyKind::kOther) {
+            return Result<void>::Err(ErrorCode::kTypeMismatch);
+        }
+    }
+    return Write(batch.writes_.data(), batch.writes_.size());
+}
+
+// ---------------------------------------------------------------------------
+// Readers
+// ---------------------------------------------------------------------------
+
+bool SharedProperties::Read(std::string_view key, detail::PropertyKind& kind,
+                            uint64_t& bits, std::string& text) const {
+    if (key.empty() || key.size() > kMaxKeyLength) {
+        return false;
+    }
+    const auto& impl = *impl_;
+    const auto& header = *impl.header;
+    const auto hash = HashKey(key);
+    for (;;) {
+        auto before = header.seq.load(std::memory_order_acquire);
+        if (before & 1u) {
+            continue;  // writer in progress
+        }
+        bool found = false;
+        if (const auto* entry = impl.Find(key, hash)) {
+            kind = static_cast<detail::PropertyKind>(
+                entry->kind.load(std::memory_order_relaxed));
+            bits = entry->bits.load(std::memory_order_relaxed);
+            found = kind != detail::PropertyKind::kEmpty;
+            if (kind == detail::PropertyKind::kString) {
+                text = impl.ReadText(*entry);
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header.seq.load(std::memory_order_relaxed) == before) {
+            return found;
+        }
+    }
+}
+
+bool SharedProperties::Has(std::string_view key) const {
+    detail::PropertyKind kind;
+    uint64_t bits = 0;
+    std::string text;
+    return Read(key, kind, bits, text);
+}
+
+size_t SharedProperties::Size() const {
+    return impl_->header->size.load(std::memory_order_acquire);
+}
+
+std::vector<std::string> SharedProperties::Keys() const {
+    const auto& impl = *impl_;
+    const auto& header = *impl.header;
+    std::vector<std::string> keys;
+    for (;;) {
+        auto before = header.seq.load(std::memory_order_acquire);
+        if (before & 1u) {
+            continue;
+        }
+        keys.clear();
+        for (uint32_t i = 0; i < header.capacity; ++i) {
+            const auto& entry = impl.entries[i];
+            if (entry.hash.load(std::memory_order_relaxed) == 0 ||
+                entry.kind.load(std::memory_order_relaxed) ==
+                    static_cast<uint8_t>(detail::PropertyKind::kEmpty)) {
+                continue;
+            }
+            size_t size = std::min<size_t>(
+                entry.key_size.load(std::memory_order_relaxed), kMaxKeyLength);
+            std::string name(size, '\0');
+            for (size_t c = 0; c < size; ++c) {
+                name[c] = entry.key[c].load(std::memory_order_relaxed);
+            }
+            keys.push_back(std::move(name));
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header.seq.load(std::memory_order_relaxed) == before) {
+            break;
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+uint64_t SharedProperties::Version() const {
+    return impl_->header->seq.load(std::memory_order_acquire);
+}
+
+}  // namespace plas::core
@@ -1,6 +1,28 @@
 #include "plas/hal/device_manager.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+
+#include "plas/core/deadline.h"
 #include "plas/core/error.h"
+#include "plas/core/executor.h"
+#include "plas/core/memory_usage.h"
+#include "plas/hal/interface/gpio.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/i3c.h"
+#include "plas/hal/interface/pci/cxl.h"
+#include "plas/hal/interface/pci/cxl_mailbox.h"
+#include "plas/hal/interface/pci/pci_bar.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/interface/power_control.h"
+#include "plas/hal/interface/serial.h"
+#include "plas/hal/interface/smbus.h"
+#include "plas/hal/interface/spi.h"
+#include "plas/hal/interface/ssd_gpio.h"
+#include "plas/hal/interface/uart.h"
+#include "plas/log/logger.h"
 
 namespace plas::hal {
 
@@ -9,14 +31,25 @@ DeviceManager& DeviceManager::GetInstance() {
     return instance;
 }
 
+DeviceManager::DeviceManager() {
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+    PublishLocked();
+}
+
+DeviceManager::~DeviceManager() {
+    StopHealthSupervisor();
+    StopPciHotplugMonitor();
+    StopIdleReaper();
+}
+
 core::Result<void> DeviceManager::LoadFromConfig(
     const std::string& path, config::ConfigFormat fmt) {
-    auto config_result = config::Config::LoadFromFile(path, fmt);
-    if (config_result.IsError()) {
-        return core::Result<void>::Err(config_result.Error());
+    auto table_result = config::Config::LoadDeviceTable(path, fmt);
+    if (table_result.IsError()) {
+        return core::Result<void>::Err(table_result.Error());
     }
 
-    return LoadFromEntries(config_result.Value().GetDevices());
+    return LoadFromTable(table_result.Value());
 }
 
 core::Result<void> DeviceManager::LoadFromConfig(
@@ -41,79 +74,1169 @@ core::Result<void> DeviceManager::LoadFromTree(const config::ConfigNode& node) {
 
 core::Result<void> DeviceManager::LoadFromEntries(
     const std::vector<config::DeviceEntry>& entries) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
 
+    // Devices added before a failure stay registered, as before; publish
+    // them in one snapshot either way.
+    auto status = core::Result<void>::Ok();
     for (const auto& entry : entries) {
         if (devices_.count(entry.nickname) > 0) {
-            return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+            status = core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+            break;
+        }
+
+        auto result = DeviceFactory::CreateFromConfig(entry);
+        if (result.IsError()) {
+            status = core::Result<void>::Err(result.Error());
+            break;
+        }
+
+        InsertLocked(entry.nickname, std::move(result).Value());
+        config_entries_.emplace(entry.nickname, entry);
+    }
+
+    PublishLocked();
+    return status;
+}
+
+core::Result<void> DeviceManager::LoadFromTable(
+    const config::DeviceTable& table) {
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+
+    auto status = core::Result<void>::Ok();
+    std::string nickname;
+    for (const auto& entry : table) {
+        nickname.assign(entry.Nickname());
+        if (devices_.count(nickname) > 0) {
+            status = core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+            break;
         }
 
         auto result = DeviceFactory::CreateFromConfig(entry);
         if (result.IsError()) {
-            return core::Result<void>::Err(result.Error());
+            status = core::Result<void>::Err(result.Error());
+            break;
         }
 
-        devices_[entry.nickname] = std::move(result).Value();
+        InsertLocked(nickname, std::move(result).Value());
+        config_entries_.emplace(nickname, entry.ToEntry());
     }
 
+    PublishLocked();
+    return status;
+}
+
+core::Result<void> DeviceManager::StreamFromConfig(
+    const std::string& path, config::ConfigFormat fmt) {
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+
+    auto streamed = config::Config::StreamFromFile(
+        path,
+        [this](config::DeviceEntry&& entry) {
+            if (devices_.count(entry.nickname) > 0) {
+                return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+            }
+            auto result = DeviceFactory::CreateFromConfig(entry);
+            if (result.IsError()) {
+                return core::Result<void>::Err(result.Error());
+            }
+            InsertLocked(entry.nickname, std::move(result).Value());
+            config_entries_.emplace(entry.nickname, std::move(entry));
+            return core::Result<void>::Ok();
+        },
+        fmt);
+
+    PublishLocked();
+    if (streamed.IsError()) {
+        return core::Result<void>::Err(streamed.Error());
+    }
     return core::Result<void>::Ok();
 }
 
 core::Result<void> DeviceManager::AddDevice(
     const std::string& nickname, std::unique_ptr<Device> device) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
     if (devices_.count(nickname) > 0) {
         return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
     }
-    devices_[nickname] = std::move(device);
+    InsertLocked(nickname, std::move(device));
+    PublishLocked();
     return core::Result<void>::Ok();
 }
 
+std::vector<config::DeviceEntry> DeviceManager::LoadedEntries() const {
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+    std::vector<config::DeviceEntry> entries;
+    entries.reserve(config_entries_.size());
+    for (const auto& [_, entry] : config_entries_) {
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+core::Result<void> DeviceManager::ApplyDiff(const config::DeviceDiff& diff) {
+    // Create the new devices first so a factory failure leaves the registry
+    // untouched.
+    std::vector<std::pair<const config::DeviceEntry*, std::unique_ptr<Device>>>
+        created;
+    created.reserve(diff.added.size() + diff.changed.size());
+    for (const auto* list : {&diff.added, &diff.changed}) {
+        for (const auto& entry : *list) {
+            auto result = DeviceFactory::CreateFromConfig(entry);
+            if (result.IsError()) {
+                return core::Result<void>::Err(result.Error());
+            }
+            created.emplace_back(&entry, std::move(result).Value());
+        }
+    }
+
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+    for (const auto& entry : diff.added) {
+        if (devices_.count(entry.nickname) > 0) {
+            return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+        }
+    }
+    for (const auto& entry : diff.changed) {
+        if (config_entries_.count(entry.nickname) == 0) {
+            return core::Result<void>::Err(core::ErrorCode::kNotFound);
+        }
+    }
+    for (const auto& name : diff.removed) {
+        if (config_entries_.count(name) == 0) {
+            return core::Result<void>::Err(core::ErrorCode::kNotFound);
+        }
+    }
+
+    for (const auto& name : diff.removed) {
+        RetireLocked(name);
+    }
+    for (const auto& entry : diff.changed) {
+        RetireLocked(entry.nickname);
+    }
+    for (auto& [entry, device] : created) {
+        InsertLocked(entry->nickname, std::move(device));
+        config_entries_[entry->nickname] = *entry;
+    }
+
+    PublishLocked();
+    PLAS_LOG_INFO("DeviceManager: applied config diff (" +
+                  std::to_string(diff.added.size()) + " added, " +
+                  std::to_string(diff.changed.size()) + " changed, " +
+                  std::to_string(diff.removed.size()) + " removed)");
+    return core::Result<void>::Ok();
+}
+
+void DeviceManager::RetireLocked(const std::string& nickname) {
+    auto device_it = devices_.find(nickname);
+    auto state_it = lazy_states_.find(nickname);
+    auto& device = device_it->second;
+    auto& state = state_it->second;
+    {
+        // Waits for a lazy open in progress; OpenLazily skips it afterwards.
+        std::lock_guard<std::mutex> state_lock(state->mutex);
+        state->retired.store(true, std::memory_order_release);
+        state->opened_lazily.store(false, std::memory_order_relaxed);
+        if (device->GetState() == DeviceState::kOpen) {
+            auto result = device->Close();
+            if (result.IsError()) {
+                PLAS_LOG_WARN("DeviceManager: close of replaced '" + nickname +
+                              "' failed: " + result.Error().message());
+            }
+        }
+    }
+    retired_devices_.push_back(std::move(device));
+    retired_states_.push_back(std::move(state));
+    devices_.erase(device_it);
+    lazy_states_.erase(state_it);
+    interface_tables_.erase(nickname);
+    config_entries_.erase(nickname);
+    auto layer_it = coalescing_layers_.find(nickname);
+    if (layer_it != coalescing_layers_.end()) {
+        retired_layers_.push_back(std::move(layer_it->second));
+        coalescing_layers_.erase(layer_it);
+    }
+    auto chain_it = interceptor_chains_.find(nickname);
+    if (chain_it != interceptor_chains_.end()) {
+        retired_chains_.push_back(std::move(chain_it->second));
+        interceptor_chains_.erase(chain_it);
+    }
+}
+
+core::Result<void> DeviceManager::AddDevice(
+    const config::DeviceEntry& entry, std::unique_ptr<Device> device) {
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+    if (devices_.count(entry.nickname) > 0) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+    }
+    InsertLocked(entry.nickname, std::move(device));
+    config_entries_.emplace(entry.nickname, entry);
+    PublishLocked();
+    return core::Result<void>::Ok();
+}
+
+std::vector<core::Result<void>> DeviceManager::AddDevices(
+    std::vector<std::pair<config::DeviceEntry, std::unique_ptr<Device>>> devices) {
+    std::vector<core::Result<void>> results;
+    results.reserve(devices.size());
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+    for (auto& [entry, device] : devices) {
+        if (devices_.count(entry.nickname) > 0) {
+            results.push_back(core::Result<void>::Err(core::ErrorCode::kAlreadyOpen));
+            continue;
+        }
+        InsertLocked(entry.nickname, std::move(device));
+        auto nickname = entry.nickname;
+        config_entries_.emplace(std::move(nickname), std::move(entry));
+        results.push_back(core::Result<void>::Ok());
+    }
+    PublishLocked();
+    return results;
+}
+
 Device* DeviceManager::GetDevice(const std::string& nickname) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = devices_.find(nickname);
-    if (it == devices_.end()) return nullptr;
-    return it->second.get();
+    SnapshotGuard snapshot(*this);
+    const auto* entry = snapshot->Find(nickname);
+    if (!entry) return nullptr;
+    EnsureOpen(*entry->lazy);
+    return entry->device;
+}
+
+Device* DeviceManager::PeekDevice(const std::string& nickname) {
+    SnapshotGuard snapshot(*this);
+    const auto* entry = snapshot->Find(nickname);
+    return entry ? entry->device : nullptr;
 }
 
 Device* DeviceManager::GetDeviceByUri(const std::string& uri) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& [_, device] : devices_) {
-        if (device->GetUri() == uri) {
-            return device.get();
+    SnapshotGuard snapshot(*this);
+    for (const auto& entry : snapshot->entries) {
+        if (entry.device->GetUri() == uri) {
+            EnsureOpen(*entry.lazy);
+            return entry.device;
         }
     }
     return nullptr;
 }
 
 std::vector<std::string> DeviceManager::DeviceNames() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    SnapshotGuard snapshot(*this);
     std::vector<std::string> names;
-    names.reserve(devices_.size());
-    for (const auto& [name, _] : devices_) {
-        names.push_back(name);
+    names.reserve(snapshot->entries.size());
+    for (const auto& entry : snapshot->entries) {
+        names.push_back(entry.name);
     }
     return names;
 }
 
 bool DeviceManager::HasDevice(const std::string& nickname) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return devices_.count(nickname) > 0;
+    SnapshotGuard snapshot(*this);
+    return snapshot->Find(nickname) != nullptr;
 }
 
 std::size_t DeviceManager::DeviceCount() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return devices_.size();
+    SnapshotGuard snapshot(*this);
+    return snapshot->entries.size();
+}
+
+core::Result<void> DeviceManager::AddToGroup(const std::string& group,
+                                             const std::string& nickname) {
+    if (group.empty()) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+    if (devices_.count(nickname) == 0) {
+        return core::Result<void>::Err(core::ErrorCode::kNotFound);
+    }
+    if (group_members_[group].insert(nickname).second) {
+        PublishLocked();
+    }
+    return core::Result<void>::Ok();
+}
+
+std::vector<std::string> DeviceManager::GroupNames() const {
+    SnapshotGuard guard(*this);
+    const auto& snapshot = *guard;
+    std::vector<std::string> names;
+    names.reserve(snapshot.groups.size());
+    for (const auto& [group, _] : snapshot.groups) {
+        names.push_back(group);
+    }
+    return names;
+}
+
+std::vector<std::string> DeviceManager::GroupMembers(const std::string& group) const {
+    SnapshotGuard guard(*this);
+    const auto& snapshot = *guard;
+    std::vector<std::string> names;
+    auto it = snapshot.groups.find(group);
+    if (it == snapshot.groups.end()) {
+        return names;
+    }
+    names.reserve(it->second.size());
+    for (auto i : it->second) {
+        names.push_back(snapshot.entries[i].name);
+    }
+    return names;
+}
+
+core::Result<void> DeviceManager::EnableReadCoalescing(
+    const std::string& nickname, const ReadCoalescingOptions& options) {
+    if (options.freshness.count() < 0) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+    if (devices_.count(nickname) == 0) {
+        return core::Result<void>::Err(core::ErrorCode::kNotFound);
+    }
+    coalescing_overrides_[nickname] = options;
+    PublishLocked();
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> DeviceManager::DisableReadCoalescing(const std::string& nickname) {
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+    if (devices_.count(nickname) == 0) {
+        return core::Result<void>::Err(core::ErrorCode::kNotFound);
+    }
+    coalescing_overrides_[nickname] = std::nullopt;
+    PublishLocked();
+    return core::Result<void>::Ok();
+}
+
+bool DeviceManager::IsReadCoalescing(const std::string& nickname) const {
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+    return coalescing_layers_.count(nickname) > 0;
+}
+
+core::Result<ReadCoalescingStats> DeviceManager::GetReadCoalescingStats(
+    const std::string& nickname) const {
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+    auto it = coalescing_layers_.find(nickname);
+    if (it == coalescing_layers_.end()) {
+        return core::Result<ReadCoalescingStats>::Err(core::ErrorCode::kNotFound);
+    }
+    return core::Result<ReadCoalescingStats>::Ok(it->second->Coalescer().Stats());
+}
+
+std::optional<ReadCoalescingOptions> DeviceManager::CoalescingOptionsLocked(
+    const std::string& nickname) const {
+    auto override_it = coalescing_overrides_.find(nickname);
+    if (override_it != coalescing_overrides_.end()) {
+        return override_it->second;
+    }
+    auto entry_it = config_entries_.find(nickname);
+    if (entry_it == config_entries_.end()) {
+        return std::nullopt;
+    }
+    auto arg = entry_it->second.args.find(config::kCoalesceReadsArg);
+    if (arg == entry_it->second.args.end()) {
+        return std::nullopt;
+    }
+    char* end = nullptr;
+    errno = 0;
+    long long us = std::strtoll(arg->second.c_str(), &end, 10);
+    if (arg->second.empty() || *end != '\0' || errno != 0 || us < 0) {
+        PLAS_LOG_WARN("DeviceManager: ignoring " + std::string(config::kCoalesceReadsArg) +
+                      " '" + arg->second + "' of '" + nickname + "'");
+        return std::nullopt;
+    }
+    return ReadCoalescingOptions{std::chrono::microseconds(us)};
+}
+
+void DeviceManager::SyncCoalescingLocked(const std::string& nickname, Device& device) {
+    auto options = CoalescingOptionsLocked(nickname);
+    auto it = coalescing_layers_.find(nickname);
+    if (it != coalescing_layers_.end() && (!options || it->second->Options() != *options)) {
+        // Older snapshots may still hand out its wrappers.
+        retired_layers_.push_back(std::move(it->second));
+        coalescing_layers_.erase(it);
+        it = coalescing_layers_.end();
+    }
+    if (options && it == coalescing_layers_.end()) {
+        coalescing_layers_.emplace(nickname,
+                                   std::make_unique<ReadCoalescingLayer>(device, *options));
+    }
+}
+
+namespace {
+
+/// Items of a comma-separated arg, blanks trimmed, empty items dropped.
+std::vector<std::string> SplitArgList(const std::string& list) {
+    std::vector<std::string> items;
+    std::size_t begin = 0;
+    while (begin <= list.size()) {
+        auto end = std::min(list.find(',', begin), list.size());
+        auto first = list.find_first_not_of(" \t", begin);
+        if (first < end) {
+            auto last = list.find_last_not_of(" \t", end - 1);
+            items.push_back(list.substr(first, last - first + 1));
+        }
+        begin = end + 1;
+    }
+    return items;
+}
+
+/// Add `index` to each group named in a comma-separated `group` arg.
+void JoinConfigGroups(const config::DeviceEntry& entry, std::size_t index,
+                      std::map<std::string, std::vector<std::size_t>>& groups) {
+    auto arg = entry.args.find(config::kGroupArg);
+    if (arg == entry.args.end()) {
+        return;
+    }
+    for (auto& group : SplitArgList(arg->second)) {
+        groups[group].push_back(index);
+    }
+}
+
+/// Put a coalescing wrapper in place of the device's own interface.
+template <typename T>
+void Substitute(T* wrapper, std::array<void*, kInterfaceKindCount>& table) {
+    if (wrapper) {
+        table[static_cast<std::size_t>(InterfaceKindOf<T>::value)] = static_cast<void*>(wrapper);
+    }
+}
+
+}  // namespace
+
+core::Result<void> DeviceManager::SetInterceptors(const std::string& nickname,
+                                                  const std::vector<std::string>& names) {
+    for (const auto& name : names) {
+        if (!InterceptorRegistry::Has(name)) {
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        }
+    }
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+    if (devices_.count(nickname) == 0) {
+        return core::Result<void>::Err(core::ErrorCode::kNotFound);
+    }
+    interceptor_overrides_[nickname] = names;
+    PublishLocked();
+    return core::Result<void>::Ok();
+}
+
+std::vector<std::string> DeviceManager::GetInterceptors(const std::string& nickname) const {
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+    auto it = interceptor_chains_.find(nickname);
+    if (it == interceptor_chains_.end()) {
+        return {};
+    }
+    return it->second->Names();
+}
+
+std::vector<std::string> DeviceManager::InterceptorNamesLocked(
+    const std::string& nickname) const {
+    auto override_it = interceptor_overrides_.find(nickname);
+    if (override_it != interceptor_overrides_.end()) {
+        return override_it->second;
+    }
+    auto entry_it = config_entries_.find(nickname);
+    if (entry_it == config_entries_.end()) {
+        return {};
+    }
+    const auto& args = entry_it->second.args;
+    std::vector<std::string> names;
+    auto arg = args.find(config::kInterceptorsArg);
+    if (arg != args.end()) {
+        for (auto& name : SplitArgList(arg->second)) {
+            if (!InterceptorRegistry::Has(name)) {
+                PLAS_LOG_WARN("DeviceManager: ignoring unknown interceptor '" + name +
+                              "' of '" + nickname + "'");
+                continue;
+            }
+            names.push_back(std::move(name));
+        }
+    }
+    if (args.count(config::kRetryAttemptsArg) > 0 &&
+        std::find(names.begin(), names.end(), "retry") == names.end()) {
+        names.push_back("retry");  // innermost: retries go straight to the device
+    }
+    return names;
+}
+
+DeviceManager::InterfaceTable DeviceManager::SyncInterceptorsLocked(
+    const std::string& nickname, const InterfaceTable& inner) {
+    auto names = InterceptorNamesLocked(nickname);
+    auto it = interceptor_chains_.find(nickname);
+    if (it != interceptor_chains_.end() &&
+        (it->second->Names() != names || it->second->Inner() != inner)) {
+        // Older snapshots may still hand out its wrappers.
+        retired_chains_.push_back(std::move(it->second));
+        interceptor_chains_.erase(it);
+        it = interceptor_chains_.end();
+    }
+    if (names.empty()) {
+        return inner;
+    }
+    if (it == interceptor_chains_.end()) {
+        auto entry_it = config_entries_.find(nickname);
+        auto entry = entry_it != config_entries_.end() ? entry_it->second
+                                                       : config::DeviceEntry{nickname, "", "", {}};
+        it = interceptor_chains_
+                 .emplace(nickname, std::make_unique<InterceptorChain>(entry, names, inner))
+                 .first;
+    }
+    return it->second->Outer();
+}
+
+DeviceManager::InterfaceTable DeviceManager::ResolveInterfaces(
+    Device* device) {
+    InterfaceTable table{};
+    for (std::size_t k = 0; k < kInterfaceKindCount; ++k) {
+        table[k] = device->QueryInterface(static_cast<InterfaceKind>(k));
+    }
+    return table;
+}
+
+void DeviceManager::InsertLocked(const std::string& nickname,
+                                 std::unique_ptr<Device> device) {
+    interface_tables_[nickname] = ResolveInterfaces(device.get());
+    auto state = std::make_unique<LazyState>();
+    state->device = device.get();
+    state->name = nickname;
+    lazy_states_[nickname] = std::move(state);
+    devices_[nickname] = std::move(device);
+}
+
+void DeviceManager::PublishLocked() {
+    auto snapshot = std::make_unique<Snapshot>();
+    snapshot->entries.reserve(devices_.size());
+    snapshot->index.reserve(devices_.size());
+    for (auto& [name, device] : devices_) {
+        auto index = snapshot->entries.size();
+        auto interfaces = interface_tables_.at(name);
+        SyncCoalescingLocked(name, *device);
+        auto layer_it = coalescing_layers_.find(name);
+        if (layer_it != coalescing_layers_.end()) {
+            auto& layer = *layer_it->second;
+            Substitute<I2c>(layer.GetI2c(), interfaces);
+            Substitute<SmBus>(layer.GetSmBus(), interfaces);
+            Substitute<pci::PciConfig>(layer.GetPciConfig(), interfaces);
+            Substitute<pci::CxlMailbox>(layer.GetCxlMailbox(), interfaces);
+        }
+        interfaces = SyncInterceptorsLocked(name, interfaces);
+        for (std::size_t k = 0; k < kInterfaceKindCount; ++k) {
+            if (interfaces[k]) {
+                snapshot->by_interface[k].push_back(index);
+            }
+        }
+        snapshot->index.emplace(name, index);
+        snapshot->entries.push_back(
+            {name, device.get(), lazy_states_.at(name).get(), interfaces});
+        auto entry_it = config_entries_.find(name);
+        if (entry_it != config_entries_.end()) {
+            JoinConfigGroups(entry_it->second, index, snapshot->groups);
+        }
+    }
+    for (const auto& [group, names] : group_members_) {
+        for (const auto& name : names) {
+            auto it = snapshot->index.find(name);
+            if (it != snapshot->index.end()) {
+                snapshot->groups[group].push_back(it->second);
+            }
+        }
+    }
+    for (auto& [_, members] : snapshot->groups) {
+        std::sort(members.begin(), members.end());
+        members.erase(std::unique(members.begin(), members.end()), members.end());
+    }
+    snapshot_.store(snapshot.get());
+    if (current_snapshot_) {
+        retired_snapshots_.push_back({epoch_.load(), std::move(current_snapshot_)});
+    }
+    current_snapshot_ = std::move(snapshot);
+    ReclaimSnapshotsLocked();
+}
+
+void DeviceManager::ReclaimSnapshotsLocked() {
+    // Two advances let a publish with no lookup in flight free the snapshot
+    // it just superseded.
+    for (int i = 0; i < 2 && !retired_snapshots_.empty(); ++i) {
+        auto epoch = epoch_.load();
+        if (readers_[(epoch + 1) & 1].load() != 0) {
+            break;  // guards from epoch - 1 are still running
+        }
+        epoch_.store(epoch + 1);
+    }
+    auto epoch = epoch_.load();
+    auto freeable = std::find_if(
+        retired_snapshots_.begin(), retired_snapshots_.end(),
+        [epoch](const RetiredSnapshot& retired) { return retired.epoch + 2 > epoch; });
+    retired_snapshots_.erase(retired_snapshots_.begin(), freeable);
+}
+
+// ---------------------------------------------------------------------------
+// Lazy open
+// ---------------------------------------------------------------------------
+
+void DeviceManager::SetLazyOpen(bool enabled) {
+    lazy_open_.store(enabled, std::memory_order_relaxed);
+}
+
+bool DeviceManager::IsLazyOpen() const {
+    return lazy_open_.load(std::memory_order_relaxed);
+}
+
+void DeviceManager::SetIdleCloseTimeout(std::chrono::milliseconds timeout) {
+    std::lock_guard<std::mutex> reaper_lock(reaper_mutex_);
+    StopIdleReaper();
+    {
+        std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+        idle_timeout_ = timeout;
+    }
+    if (timeout.count() <= 0) {
+        return;
+    }
+
+    // Check twice per timeout so a device closes at most 1.5x late.
+    auto interval = std::max(timeout / 2, std::chrono::milliseconds(1));
+    reaper_timer_ = core::Executor::Shared().PostEvery(
+        interval, [this] { CloseIdleDevices(); }, interval);
+}
+
+std::chrono::milliseconds DeviceManager::GetIdleCloseTimeout() const {
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+    return idle_timeout_;
+}
+
+void DeviceManager::StopIdleReaper() {
+    if (reaper_timer_ != 0) {
+        core::Executor::Shared().Cancel(std::exchange(reaper_timer_, 0));
+    }
+}
+
+std::size_t DeviceManager::CloseIdleDevices() {
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);  // keeps Reset() out
+    if (idle_timeout_.count() <= 0) {
+        return 0;
+    }
+    auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    auto timeout =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            idle_timeout_)
+            .count();
+    std::size_t closed = 0;
+    for (const auto& entry : CurrentSnapshot().entries) {
+        auto* state = entry.lazy;
+        // A device being opened right now is not idle.
+        std::unique_lock<std::mutex> state_lock(state->mutex, std::try_to_lock);
+        if (!state_lock.owns_lock() ||
+            !state->opened_lazily.load(std::memory_order_relaxed) ||
+            now - state->last_use.load(std::memory_order_relaxed) < timeout) {
+            continue;
+        }
+        if (entry.device->GetState() == DeviceState::kOpen) {
+            auto result = entry.device->Close();
+            if (result.IsError()) {
+                PLAS_LOG_WARN("DeviceManager: idle close of '" + entry.name +
+                              "' failed: " + result.Error().message());
+                continue;
+            }
+            PLAS_LOG_DEBUG("DeviceManager: closed idle device '" +
+                           entry.name + "'");
+            ++closed;
+        }
+        state->opened_lazily.store(false, std::memory_order_release);
+    }
+    return closed;
+}
+
+void DeviceManager::OpenLazily(LazyState& lazy) {
+    auto* state = &lazy;
+    auto* device = lazy.device;
+    state->last_use.store(
+        std::chrono::steady_clock::now().time_since_epoch().count(),
+        std::memory_order_relaxed);
+
+    // Fast path: already opened by an earlier lookup.
+    if (state->opened_lazily.load(std::memory_order_acquire) &&
+        device->GetState() == DeviceState::kOpen) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (state->removed.load(std::memory_order_relaxed) ||
+        state->retired.load(std::memory_order_relaxed)) {
+        return;
+    }
+    auto current = device->GetState();
+    if (current == DeviceState::kOpen || current == DeviceState::kError) {
+        return;
+    }
+    if (current != DeviceState::kInitialized) {
+        auto init = device->Init();
+        if (init.IsError()) {
+            PLAS_LOG_ERROR("DeviceManager: lazy Init() of '" + state->name +
+                           "' failed: " + init.Error().message());
+            return;
+        }
+    }
+    auto open = device->Open();
+    if (open.IsError()) {
+        PLAS_LOG_ERROR("DeviceManager: lazy Open() of '" + state->name +
+                       "' failed: " + open.Error().message());
+        return;
+    }
+    state->opened_lazily.store(true, std::memory_order_release);
+}
+
+// ---------------------------------------------------------------------------
+// PCI hotplug
+// ---------------------------------------------------------------------------
+
+namespace {
+
+/// True if `uri` is "<scheme>://<addr>".
+bool UriNamesPciFunction(const std::string& uri, const pci::PciAddress& addr) {
+    auto separator = uri.find("://");
+    if (separator == std::string::npos) {
+        return false;
+    }
+    pci::PciAddress parsed{};
+    return pci::PciAddress::Parse(std::string_view(uri).substr(separator + 3), parsed) ==
+               core::ErrorCode::kSuccess &&
+           parsed == addr;
+}
+
+}  // namespace
+
+core::Result<void> DeviceManager::StartPciHotplugMonitor() {
+    std::lock_guard<std::mutex> lock(hotplug_mutex_);
+    if (!hotplug_monitor_) {
+        hotplug_monitor_ = std::make_unique<pci::PciHotplugMonitor>();
+    }
+    return hotplug_monitor_->Start(
+        [this](const pci::PciHotplugEvent& event) { HandlePciHotplug(event); });
+}
+
+void DeviceManager::StopPciHotplugMonitor() {
+    std::lock_guard<std::mutex> lock(hotplug_mutex_);
+    if (hotplug_monitor_) {
+        hotplug_monitor_->Stop();
+    }
+}
+
+bool DeviceManager::IsPciHotplugMonitorRunning() const {
+    std::lock_guard<std::mutex> lock(hotplug_mutex_);
+    return hotplug_monitor_ && hotplug_monitor_->IsRunning();
+}
+
+std::size_t DeviceManager::HandlePciHotplug(const pci::PciHotplugEvent& event) {
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);  // keeps Reset() out
+    const bool removed = event.action == pci::PciHotplugAction::kRemove;
+    std::size_t changed = 0;
+    for (const auto& entry : CurrentSnapshot().entries) {
+        if (!UriNamesPciFunction(entry.device->GetUri(), event.address)) {
+            continue;
+        }
+        auto* state = entry.lazy;
+        auto* device = entry.device;
+        std::lock_guard<std::mutex> state_lock(state->mutex);
+        if (state->removed.load(std::memory_order_relaxed) == removed) {
+            continue;  // duplicate event
+        }
+
+        if (removed) {
+            bool was_open = device->GetState() == DeviceState::kOpen;
+            state->reopen_on_add =
+                was_open &&
+                !state->opened_lazily.load(std::memory_order_relaxed);
+            if (was_open) {
+                auto result = device->Close();
+                if (result.IsError()) {
+                    PLAS_LOG_WARN("DeviceManager: close of removed '" +
+                                  entry.name +
+                                  "' failed: " + result.Error().message());
+                }
+            }
+            state->opened_lazily.store(false, std::memory_order_relaxed);
+            state->removed.store(true, std::memory_order_release);
+            PLAS_LOG_INFO("DeviceManager: '" + entry.name + "' removed (" +
+                          event.address.ToString() + ")");
+            ++changed;
+            continue;
+        }
+
+        state->removed.store(false, std::memory_order_release);
+        PLAS_LOG_INFO("DeviceManager: '" + entry.name + "' added back (" +
+                      event.address.ToString() + ")");
+        ++changed;
+        if (!state->reopen_on_add) {
+            continue;
+        }
+        state->reopen_on_add = false;
+        if (device->GetState() != DeviceState::kInitialized) {
+            auto init = device->Init();
+            if (init.IsError()) {
+                PLAS_LOG_ERROR("DeviceManager: re-Init() of '" + entry.name +
+                               "' failed: " + init.Error().message());
+                continue;
+            }
+        }
+        auto open = device->Open();
+        if (open.IsError()) {
+            PLAS_LOG_ERROR("DeviceManager: reopen of '" + entry.name +
+                           "' failed: " + open.Error().message());
+        }
+    }
+    return changed;
+}
+
+bool DeviceManager::IsDeviceRemoved(const std::string& nickname) const {
+    SnapshotGuard snapshot(*this);
+    const auto* entry = snapshot->Find(nickname);
+    return entry && entry->lazy->removed.load(std::memory_order_acquire);
+}
+
+// ---------------------------------------------------------------------------
+// Health supervision
+// ---------------------------------------------------------------------------
+
+core::Result<void> DeviceManager::StartHealthSupervisor(
+    const HealthSupervisorOptions& options) {
+    if (options.probe_interval.count() <= 0 || options.initial_backoff.count() <= 0 ||
+        options.max_backoff < options.initial_backoff) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::lock_guard<std::mutex> timer_lock(health_timer_mutex_);
+    if (health_timer_ != 0) {
+        core::Executor::Shared().Cancel(std::exchange(health_timer_, 0));
+    }
+    {
+        std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+        health_options_ = options;
+    }
+    reconnect_wait_ms_.store(options.wait_timeout.count(), std::memory_order_relaxed);
+    reconnect_wait_.store(options.policy == ReconnectPolicy::kWait, std::memory_order_relaxed);
+    health_timer_ = core::Executor::Shared().PostEvery(
+        options.probe_interval, [this] { CheckDeviceHealth(); }, options.probe_interval);
+    return core::Result<void>::Ok();
+}
+
+void DeviceManager::StopHealthSupervisor() {
+    std::lock_guard<std::mutex> timer_lock(health_timer_mutex_);
+    if (health_timer_ == 0) {
+        return;
+    }
+    core::Executor::Shared().Cancel(std::exchange(health_timer_, 0));
+
+    // Nobody will bring the devices back now; release waiting lookups.
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+    for (const auto& entry : CurrentSnapshot().entries) {
+        if (entry.lazy->reconnecting.load(std::memory_order_acquire)) {
+            EndOutage(*entry.lazy, false);
+        }
+    }
+}
+
+bool DeviceManager::IsHealthSupervisorRunning() const {
+    std::lock_guard<std::mutex> timer_lock(health_timer_mutex_);
+    return health_timer_ != 0;
+}
+
+std::size_t DeviceManager::CheckDeviceHealth() {
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);  // keeps Reset() out
+    const auto& options = health_options_;
+    std::size_t reconnected = 0;
+    for (const auto& entry : CurrentSnapshot().entries) {
+        auto* state = entry.lazy;
+        auto* device = entry.device;
+        // A device being opened or closed right now is checked next tick.
+        std::unique_lock<std::mutex> state_lock(state->mutex, std::try_to_lock);
+        if (!state_lock.owns_lock() || state->removed.load(std::memory_order_relaxed) ||
+            state->retired.load(std::memory_order_relaxed)) {
+            continue;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (!state->reconnecting.load(std::memory_order_relaxed)) {
+            auto current = device->GetState();
+            if (current == DeviceState::kOpen && (!options.probe || options.probe(*device))) {
+                continue;
+            }
+            if (current != DeviceState::kOpen && current != DeviceState::kError) {
+                continue;  // closed on purpose or never opened
+            }
+            std::lock_guard<std::mutex> health_lock(state->health_mutex);
+            state->down_since = now;
+            state->next_attempt = now + options.initial_backoff;
+            state->backoff = options.initial_backoff;
+            ++state->health.disconnects;
+            state->reconnecting.store(true, std::memory_order_release);
+            PLAS_LOG_WARN("DeviceManager: '" + entry.name + "' is unhealthy, reconnecting");
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> health_lock(state->health_mutex);
+            if (now < state->next_attempt) {
+                continue;
+            }
+        }
+        if (ReconnectLocked(entry, options)) {
+            EndOutage(*state, true);
+            PLAS_LOG_INFO("DeviceManager: '" + entry.name + "' reconnected");
+            ++reconnected;
+            continue;
+        }
+        std::lock_guard<std::mutex> health_lock(state->health_mutex);
+        ++state->health.failed_attempts;
+        state->backoff = std::min(state->backoff * 2, options.max_backoff);
+        state->next_attempt = std::chrono::steady_clock::now() + state->backoff;
+    }
+    return reconnected;
+}
+
+bool DeviceManager::ReconnectLocked(const Snapshot::Entry& entry,
+                                    const HealthSupervisorOptions& options) {
+    auto* device = entry.device;
+    auto reset = device->Reset();
+    if (reset.IsError()) {
+        PLAS_LOG_DEBUG("DeviceManager: Reset() of '" + entry.name +
+                       "' failed: " + reset.Error().message());
+        return false;
+    }
+    if (device->GetState() != DeviceState::kInitialized) {
+        auto init = device->Init();
+        if (init.IsError()) {
+            return false;
+        }
+    }
+    auto open = device->Open();
+    if (open.IsError()) {
+        PLAS_LOG_DEBUG("DeviceManager: reopen of '" + entry.name +
+                       "' failed: " + open.Error().message());
+        return false;
+    }
+    return !options.probe || options.probe(*device);
+}
+
+void DeviceManager::EndOutage(LazyState& state, bool reconnected) {
+    {
+        std::lock_guard<std::mutex> health_lock(state.health_mutex);
+        auto outage = std::chrono::steady_clock::now() - state.down_since;
+        state.health.downtime += outage;
+        if (reconnected) {
+            ++state.health.reconnects;
+            state.health.longest_outage = std::max(
+                state.health.longest_outage,
+                std::chrono::duration_cast<std::chrono::nanoseconds>(outage));
+        }
+        state.reconnecting.store(false, std::memory_order_release);
+    }
+    state.reconnected.notify_all();
+}
+
+bool DeviceManager::WaitForReconnect(LazyState& lazy) {
+    if (!reconnect_wait_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    auto* state = &lazy;
+    auto until = core::Deadline::Current().Clamp(
+        std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(reconnect_wait_ms_.load(std::memory_order_relaxed)));
+    std::unique_lock<std::mutex> health_lock(state->health_mutex);
+    return state->reconnected.wait_until(
+        health_lock, until,
+        [state] { return !state->reconnecting.load(std::memory_order_relaxed); });
+}
+
+std::vector<DeviceHealth> DeviceManager::GetHealthReport() const {
+    SnapshotGuard guard(*this);
+    const auto& snapshot = *guard;
+    std::vector<DeviceHealth> report;
+    report.reserve(snapshot.entries.size());
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& entry : snapshot.entries) {
+        auto* state = entry.lazy;
+        std::lock_guard<std::mutex> health_lock(state->health_mutex);
+        auto& health = report.emplace_back(state->health);
+        health.nickname = entry.name;
+        health.reconnecting = state->reconnecting.load(std::memory_order_relaxed);
+        if (health.reconnecting) {
+            health.downtime += now - state->down_since;
+        }
+    }
+    return report;
+}
+
+// ---------------------------------------------------------------------------
+// Memory accounting
+// ---------------------------------------------------------------------------
+
+namespace {
+
+/// One std::map node keyed by `key`, without what the mapped value owns.
+template <typename Map>
+std::size_t MapNodeBytes(const std::string& key) {
+    return sizeof(typename Map::value_type) + core::kTreeNodeOverhead + core::HeapBytes(key);
+}
+
+std::size_t EntryHeapBytes(const config::DeviceEntry& entry) {
+    std::size_t bytes = core::HeapBytes(entry.nickname) + core::HeapBytes(entry.uri) +
+                        core::HeapBytes(entry.driver) + core::TreeNodeBytes(entry.args);
+    for (const auto& [key, value] : entry.args) {
+        bytes += core::HeapBytes(key) + core::HeapBytes(value);
+    }
+    return bytes;
+}
+
+}  // namespace
+
+std::size_t DeviceManager::SnapshotSharedBytes(const Snapshot& snapshot) {
+    std::size_t bytes = sizeof(Snapshot) +
+                        (snapshot.entries.capacity() - snapshot.entries.size()) *
+                            sizeof(Snapshot::Entry) +
+                        snapshot.index.bucket_count() * sizeof(void*) +
+                        core::TreeNodeBytes(snapshot.groups);
+    for (const auto& members : snapshot.by_interface) {
+        bytes += core::HeapBytes(members);
+    }
+    for (const auto& [group, members] : snapshot.groups) {
+        bytes += core::HeapBytes(group) + core::HeapBytes(members);
+    }
+    return bytes;
+}
+
+MemoryReport DeviceManager::GetMemoryReport() const {
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
+    // Entry struct, index node and both copies of the name.
+    auto snapshot_entry_bytes = [](const Snapshot::Entry& entry) {
+        return sizeof(Snapshot::Entry) + 2 * core::HeapBytes(entry.name) +
+               sizeof(std::pair<const std::string, std::size_t>) + 2 * sizeof(void*);
+    };
+
+    MemoryReport report;
+    report.devices.reserve(devices_.size());
+    for (const auto& [name, device] : devices_) {
+        auto& usage = report.devices.emplace_back();
+        usage.nickname = name;
+        usage.driver = device->GetDriverName();
+        usage.device_bytes = device->MemoryUsage();
+
+        auto entry_it = config_entries_.find(name);
+        if (entry_it != config_entries_.end()) {
+            usage.config_bytes = MapNodeBytes<decltype(config_entries_)>(name) +
+                                 EntryHeapBytes(entry_it->second);
+        }
+
+        usage.registry_bytes = MapNodeBytes<decltype(devices_)>(name) +
+                               MapNodeBytes<decltype(lazy_states_)>(name) + sizeof(LazyState) +
+                               core::HeapBytes(name) +
+                               MapNodeBytes<decltype(interface_tables_)>(name);
+        if (const auto* entry = CurrentSnapshot().Find(name)) {
+            usage.registry_bytes += snapshot_entry_bytes(*entry);
+        }
+
+        if (coalescing_layers_.count(name) != 0) {
+            usage.layer_bytes += MapNodeBytes<decltype(coalescing_layers_)>(name) +
+                                 sizeof(ReadCoalescingLayer);
+        }
+        if (coalescing_overrides_.count(name) != 0) {
+            usage.layer_bytes += MapNodeBytes<decltype(coalescing_overrides_)>(name);
+        }
+        if (interceptor_chains_.count(name) != 0) {
+            usage.layer_bytes += MapNodeBytes<decltype(interceptor_chains_)>(name) +
+                                 sizeof(InterceptorChain);
+        }
+        auto override_it = interceptor_overrides_.find(name);
+        if (override_it != interceptor_overrides_.end()) {
+            usage.layer_bytes += MapNodeBytes<decltype(interceptor_overrides_)>(name) +
+                                 core::HeapBytes(override_it->second);
+            for (const auto& interceptor : override_it->second) {
+                usage.layer_bytes += core::HeapBytes(interceptor);
+            }
+        }
+
+        report.drivers[usage.driver] += usage.device_bytes;
+        report.device_bytes += usage.device_bytes;
+        report.config_bytes += usage.config_bytes;
+        report.registry_bytes += usage.registry_bytes;
+        report.layer_bytes += usage.layer_bytes;
+    }
+
+    report.registry_bytes += core::TreeNodeBytes(group_members_);
+    for (const auto& [group, members] : group_members_) {
+        report.registry_bytes += core::HeapBytes(group) + core::TreeNodeBytes(members);
+        for (const auto& member : members) {
+            report.registry_bytes += core::HeapBytes(member);
+        }
+    }
+
+    report.registry_bytes +=
+        SnapshotSharedBytes(CurrentSnapshot()) + core::HeapBytes(retired_snapshots_);
+    report.retained_bytes = core::HeapBytes(retired_devices_) +
+                            core::HeapBytes(retired_states_) +
+                            core::HeapBytes(retired_layers_) + core::HeapBytes(retired_chains_) +
+                            retired_states_.size() * sizeof(LazyState) +
+                            retired_layers_.size() * sizeof(ReadCoalescingLayer) +
+                            retired_chains_.size() * sizeof(InterceptorChain);
+    for (const auto& retired : retired_snapshots_) {
+        report.retained_bytes += SnapshotSharedBytes(*retired.snapshot);
+        for (const auto& entry : retired.snapshot->entries) {
+            report.retained_bytes += snapshot_entry_bytes(entry);
+        }
+    }
+    for (const auto& state : retired_states_) {
+        report.retained_bytes += core::HeapBytes(state->name);
+    }
+    for (const auto& device : retired_devices_) {
+        report.retained_bytes += device->MemoryUsage();
+    }
+    return report;
+}
+
+void DeviceManager::SetMetricsEnabled(bool enabled) {
+    MetricsRegistry::GetInstance().SetEnabled(enabled);
+}
+
+bool DeviceManager::IsMetricsEnabled() const {
+    return MetricsRegistry::GetInstance().IsEnabled();
+}
+
+MetricsSnapshot DeviceManager::GetMetricsSnapshot() const {
+    return MetricsRegistry::GetInstance().Snapshot(DeviceNames());
+}
+
+void DeviceManager::ResetMetrics() {
+    MetricsRegistry::GetInstance().Reset();
 }
 
 void DeviceManager::Reset() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<core::InstrumentedMutex> lock(mutex_);
     for (auto& [_, device] : devices_) {
         if (device->GetState() == DeviceState::kOpen) {
             device->Close();
         }
     }
+    // Invalidate DeviceHandles and publish the empty registry before
+    // freeing the devices and the superseded snapshots that still point at
+    // them.
+    generation_.fetch_add(1, std::memory_order_acq_rel);
+    auto current_snapshot = std::move(current_snapshot_);
+    auto retired_snapshots = std::move(retired_snapshots_);
+    auto retired_devices = std::move(devices_);
+    auto retired_states = std::move(lazy_states_);
+    auto replaced_devices = std::move(retired_devices_);
+    auto replaced_states = std::move(retired_states_);
+    auto layers = std::move(coalescing_layers_);
+    auto replaced_layers = std::move(retired_layers_);
+    auto chains = std::move(interceptor_chains_);
+    auto replaced_chains = std::move(retired_chains_);
+    retired_snapshots_.clear();
     devices_.clear();
+    lazy_states_.clear();
+    retired_devices_.clear();
+    retired_states_.clear();
+    coalescing_layers_.clear();
+    retired_layers_.clear();
+    interceptor_chains_.clear();
+    retired_chains_.clear();
+    interceptor_overrides_.clear();
+    coalescing_overrides_.clear();
+    interface_tables_.clear();
+    config_entries_.clear();
+    group_members_.clear();
+    PublishLocked();
 }
 
 }  // namespace plas::hal
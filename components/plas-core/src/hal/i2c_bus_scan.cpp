@@ -0,0 +1,184 @@
+#include "plas/hal/i2c_bus_scan.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "plas/core/error.h"
+#include "plas/hal/device_manager.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/log/logger.h"
+
+namespace plas::hal {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BusMembers {
+    std::string bus;
+    std::vector<std::pair<std::string, I2c*>> devices;
+};
+
+struct CacheEntry {
+    I2cBusScan scan;
+    Clock::time_point at;
+};
+
+}  // namespace
+
+bool I2cBusScan::Responds(core::Address addr) const {
+    return std::binary_search(addresses.begin(), addresses.end(), addr);
+}
+
+struct I2cBusScanner::Impl {
+    DeviceManager& manager;
+    I2cScanOptions options;
+
+    std::mutex scan_mutex;  // serializes ScanAll/Scan
+    mutable std::mutex cache_mutex;
+    std::map<std::string, CacheEntry> cache;
+
+    Impl(DeviceManager& m, I2cScanOptions o) : manager(m), options(o) {}
+
+    std::vector<BusMembers> Buses() {
+        std::vector<BusMembers> buses;
+        std::map<std::string, std::size_t> index;
+        for (auto& [name, i2c] : manager.GetDevicesByInterface<I2c>()) {
+            std::string uri;
+            if (auto* device = i2c->GetDevice()) {
+                uri = device->GetUri();
+            }
+            // A device without a URI is a bus of its own.
+            auto bus = uri.empty() ? name : BusOf(uri);
+            auto [it, inserted] = index.emplace(bus, buses.size());
+            if (inserted) {
+                buses.push_back({bus, {}});
+            }
+            buses[it->second].devices.emplace_back(name, i2c);
+        }
+        std::sort(buses.begin(), buses.end(),
+                  [](const BusMembers& a, const BusMembers& b) { return a.bus < b.bus; });
+        return buses;
+    }
+
+    bool Lookup(const std::string& bus, I2cBusScan& out) const {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = cache.find(bus);
+        if (it == cache.end()) {
+            return false;
+        }
+        if (options.cache_ttl.count() > 0 && Clock::now() - it->second.at > options.cache_ttl) {
+            return false;
+        }
+        out = it->second.scan;
+        out.cached = true;
+        return true;
+    }
+
+    I2cBusScan ScanBus(const BusMembers& members) {
+        I2cBusScan scan;
+        bool hit = Lookup(members.bus, scan);
+        scan.bus = members.bus;
+        scan.devices.clear();
+        for (const auto& member : members.devices) {
+            scan.devices.push_back(member.first);
+        }
+        if (hit) {
+            return scan;
+        }
+
+        auto start = Clock::now();
+        auto found = members.devices.front().second->Scan(options.first, options.last,
+                                                          options.probe_timeout);
+        scan.duration =
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+        if (found.IsError()) {
+            scan.error = found.Error();
+            PLAS_LOG_WARN("I2cBusScanner: scan of " + members.bus + " via '" +
+                          members.devices.front().first + "' failed: " + scan.error.message());
+            return scan;
+        }
+        scan.addresses = std::move(found).Value();
+
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        cache[members.bus] = {scan, Clock::now()};
+        return scan;
+    }
+};
+
+I2cBusScanner::I2cBusScanner(DeviceManager& manager, I2cScanOptions options)
+    : impl_(std::make_unique<Impl>(manager, options)) {}
+
+I2cBusScanner::~I2cBusScanner() = default;
+
+std::vector<I2cBusScan> I2cBusScanner::ScanAll() {
+    std::lock_guard<std::mutex> lock(impl_->scan_mutex);
+    auto buses = impl_->Buses();
+    std::vector<I2cBusScan> scans(buses.size());
+    auto body = [this, &buses, &scans](std::size_t i) { scans[i] = impl_->ScanBus(buses[i]); };
+
+    // Scans wait on the adapters, not the CPU, so they get their own
+    // threads rather than the core-sized shared executor.
+    std::size_t workers = std::min(impl_->options.workers, buses.size());
+    std::atomic<std::size_t> next{0};
+    auto drain = [&next, &buses, &body] {
+        for (std::size_t i = next++; i < buses.size(); i = next++) {
+            body(i);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < workers; ++t) {
+        threads.emplace_back(drain);
+    }
+    drain();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return scans;
+}
+
+core::Result<I2cBusScan> I2cBusScanner::Scan(const std::string& nickname) {
+    std::lock_guard<std::mutex> lock(impl_->scan_mutex);
+    for (const auto& members : impl_->Buses()) {
+        for (const auto& member : members.devices) {
+            if (member.first == nickname) {
+                return core::Result<I2cBusScan>::Ok(impl_->ScanBus(members));
+            }
+        }
+    }
+    return core::Result<I2cBusScan>::Err(core::ErrorCode::kNotFound);
+}
+
+core::Result<I2cBusScan> I2cBusScanner::Cached(const std::string& bus) const {
+    I2cBusScan scan;
+    if (!impl_->Lookup(bus, scan)) {
+        return core::Result<I2cBusScan>::Err(core::ErrorCode::kNotFound);
+    }
+    return core::Result<I2cBusScan>::Ok(std::move(scan));
+}
+
+void I2cBusScanner::Invalidate(const std::string& bus) {
+    std::lock_guard<std::mutex> lock(impl_->cache_mutex);
+    impl_->cache.erase(bus);
+}
+
+void I2cBusScanner::InvalidateAll() {
+    std::lock_guard<std::mutex> lock(impl_->cache_mutex);
+    impl_->cache.clear();
+}
+
+std::string I2cBusScanner::BusOf(const std::string& uri) {
+    auto colon = uri.rfind(':');
+    auto scheme_end = uri.find("://");
+    if (colon == std::string::npos || scheme_end == std::string::npos ||
+        colon <= scheme_end) {
+        return uri;
+    }
+    return uri.substr(0, colon);
+}
+
+}  // namespace plas::hal
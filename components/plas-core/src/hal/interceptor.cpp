@@ -0,0 +1,306 @@
+#include "plas/hal/interceptor.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+
+#include "plas/core/error.h"
+#include "plas/hal/metrics.h"
+#include "plas/log/logger.h"
+#include "plas/log/trace.h"
+
+namespace plas::hal {
+
+namespace {
+
+std::optional<MetricOp> MetricOpOf(const CallInfo& info) {
+    switch (info.interface) {
+    case InterfaceKind::kI2c:
+        switch (info.kind) {
+        case CallKind::kRead: return MetricOp::kI2cRead;
+        case CallKind::kWrite: return MetricOp::kI2cWrite;
+        case CallKind::kWriteRead:
+        case CallKind::kExchange: return MetricOp::kI2cWriteRead;
+        default: return std::nullopt;
+        }
+    case InterfaceKind::kPciConfig:
+        switch (info.kind) {
+        case CallKind::kRead: return MetricOp::kPciConfigRead;
+        case CallKind::kWrite: return MetricOp::kPciConfigWrite;
+        default: return std::nullopt;
+        }
+    case InterfaceKind::kPciDoe:
+        if (info.kind == CallKind::kExchange) return MetricOp::kDoeExchange;
+        return std::nullopt;
+    case InterfaceKind::kPciBar:
+        switch (info.kind) {
+        case CallKind::kRead: return MetricOp::kBarRead;
+        case CallKind::kWrite: return MetricOp::kBarWrite;
+        default: return std::nullopt;
+        }
+    default:
+        return std::nullopt;
+    }
+}
+
+log::TraceInterface TraceInterfaceOf(InterfaceKind kind) {
+    switch (kind) {
+    case InterfaceKind::kI2c: return log::TraceInterface::kI2c;
+    case InterfaceKind::kPciConfig: return log::TraceInterface::kPciConfig;
+    case InterfaceKind::kPciDoe: return log::TraceInterface::kPciDoe;
+    case InterfaceKind::kPciBar: return log::TraceInterface::kPciBar;
+    default: return log::TraceInterface::kUnknown;
+    }
+}
+
+log::TraceOp TraceOpOf(CallKind kind) {
+    switch (kind) {
+    case CallKind::kRead: return log::TraceOp::kRead;
+    case CallKind::kWrite: return log::TraceOp::kWrite;
+    case CallKind::kWriteRead: return log::TraceOp::kWriteRead;
+    case CallKind::kExchange: return log::TraceOp::kExchange;
+    default: return log::TraceOp::kUnknown;
+    }
+}
+
+class MetricsInterceptor : public InterceptorBase<MetricsInterceptor> {
+public:
+    explicit MetricsInterceptor(const config::DeviceEntry& entry)
+        : metrics_(MetricsRegistry::GetInstance().GetDeviceMetrics(entry.nickname)) {}
+
+    template <typename Call>
+    auto Around(const CallInfo& info, Call&& call) -> decltype(call()) {
+        auto op = MetricOpOf(info);
+        if (!op) {
+            return call();
+        }
+        MetricsTimer timer(metrics_, *op, info.bytes);
+        auto result = call();
+        if (CallFailed(result)) {
+            timer.SetError();
+        }
+        return result;
+    }
+
+private:
+    DeviceMetrics* metrics_;
+};
+
+class TraceInterceptor : public InterceptorBase<TraceInterceptor> {
+public:
+    explicit TraceInterceptor(const config::DeviceEntry& entry)
+        : trace_id_(log::Tracer::GetInstance().RegisterDevice(entry.nickname)) {}
+
+    template <typename Call>
+    auto Around(const CallInfo& info, Call&& call) -> decltype(call()) {
+        auto iface = TraceInterfaceOf(info.interface);
+        auto op = TraceOpOf(info.kind);
+        if (iface == log::TraceInterface::kUnknown || op == log::TraceOp::kUnknown) {
+            return call();
+        }
+        log::TraceSpan span(trace_id_, iface, op, info.address, info.bytes, info.target,
+                            info.extra);
+        auto result = call();
+        if (CallFailed(result)) {
+            SetStatus(span, result);
+        }
+        return result;
+    }
+
+private:
+    template <typename T>
+    static void SetStatus(log::TraceSpan& span, const core::Result<T>& result) {
+        span.SetStatus(result.Error());
+    }
+    template <typename T>
+    static void SetStatus(log::TraceSpan&, const T&) {}
+
+    uint16_t trace_id_;
+};
+
+class RetryInterceptor : public InterceptorBase<RetryInterceptor> {
+public:
+    explicit RetryInterceptor(const config::DeviceEntry& entry)
+        : policy_(RetryPolicyFromArgs(entry).value_or(core::RetryPolicy{})),
+          metrics_(MetricsRegistry::GetInstance().GetDeviceMetrics(entry.nickname)) {}
+
+    template <typename Call>
+    auto Around(const CallInfo&, Call&& call) -> decltype(call()) {
+        if (!policy_.Enabled()) {
+            return call();
+        }
+        core::RetryOutcome outcome;
+        auto result = core::RetryCall(
+            policy_, call,
+            [this](const auto& r) { return IsTransientFailure(policy_, r); }, &outcome);
+        metrics_->RecordRetry(outcome);
+        return result;
+    }
+
+private:
+    core::RetryPolicy policy_;
+    DeviceMetrics* metrics_;
+};
+
+bool ParseErrorName(const std::string& name, core::ErrorCode& out) {
+    static const std::pair<const char*, core::ErrorCode> kNames[] = {
+        {"busy", core::ErrorCode::kBusy},
+        {"timeout", core::ErrorCode::kTimeout},
+        {"io", core::ErrorCode::kIOError},
+        {"resource_exhausted", core::ErrorCode::kResourceExhausted},
+        {"data_loss", core::ErrorCode::kDataLoss},
+    };
+    for (const auto& [text, code] : kNames) {
+        if (name == text) {
+            out = code;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WarnBadArg(const config::DeviceEntry& entry, const char* key, const std::string& value) {
+    PLAS_LOG_WARN("InterceptorRegistry: ignoring " + std::string(key) + " '" + value +
+                  "' of '" + entry.nickname + "'");
+}
+
+/// Non-negative integer arg `key` into `out`; false (with a warning) if
+/// present but malformed.
+bool ParseCount(const config::DeviceEntry& entry, const char* key, long long& out) {
+    auto it = entry.args.find(key);
+    if (it == entry.args.end()) {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    long long value = std::strtoll(it->second.c_str(), &end, 10);
+    if (it->second.empty() || *end != '\0' || errno != 0 || value < 0) {
+        WarnBadArg(entry, key, it->second);
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+struct Registry {
+    std::mutex mutex;
+    std::map<std::string, InterceptorRegistry::CreatorFunc, std::less<>> creators;
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+InterceptorRegistry::CreatorFunc FindCreator(std::string_view name) {
+    auto& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = registry.creators.find(name);
+    if (it != registry.creators.end()) {
+        return it->second;
+    }
+    if (name == "metrics") {
+        return [](const config::DeviceEntry& entry) -> std::unique_ptr<Interceptor> {
+            return std::make_unique<MetricsInterceptor>(entry);
+        };
+    }
+    if (name == "trace") {
+        return [](const config::DeviceEntry& entry) -> std::unique_ptr<Interceptor> {
+            return std::make_unique<TraceInterceptor>(entry);
+        };
+    }
+    if (name == "retry") {
+        return [](const config::DeviceEntry& entry) -> std::unique_ptr<Interceptor> {
+            return std::make_unique<RetryInterceptor>(entry);
+        };
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+void InterceptorRegistry::Register(const std::string& name, CreatorFunc creator) {
+    auto& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.creators[name] = std::move(creator);
+}
+
+bool InterceptorRegistry::Has(std::string_view name) {
+    return FindCreator(name) != nullptr;
+}
+
+std::unique_ptr<Interceptor> InterceptorRegistry::Create(std::string_view name,
+                                                         const config::DeviceEntry& entry) {
+    auto creator = FindCreator(name);
+    return creator ? creator(entry) : nullptr;
+}
+
+std::optional<core::RetryPolicy> RetryPolicyFromArgs(const config::DeviceEntry& entry) {
+    long long value = 0;
+    if (!ParseCount(entry, config::kRetryAttemptsArg, value)) {
+        return std::nullopt;
+    }
+    core::RetryPolicy policy;
+    policy.max_attempts = static_cast<uint32_t>(std::clamp<long long>(value, 1, 1000));
+    if (ParseCount(entry, config::kRetryBackoffArg, value)) {
+        policy.initial_backoff = std::chrono::microseconds(value);
+    }
+    if (ParseCount(entry, config::kRetryMaxBackoffArg, value)) {
+        policy.max_backoff = std::chrono::microseconds(value);
+    }
+    auto jitter = entry.args.find(config::kRetryJitterArg);
+    if (jitter != entry.args.end()) {
+        char* end = nullptr;
+        double fraction = std::strtod(jitter->second.c_str(), &end);
+        if (jitter->second.empty() || *end != '\0' || !(fraction >= 0.0 && fraction <= 1.0)) {
+            WarnBadArg(entry, config::kRetryJitterArg, jitter->second);
+        } else {
+            policy.jitter = fraction;
+        }
+    }
+    auto retry_on = entry.args.find(config::kRetryOnArg);
+    if (retry_on != entry.args.end()) {
+        uint32_t mask = 0;
+        bool ok = true;
+        const std::string& list = retry_on->second;
+        std::size_t begin = 0;
+        while (ok && begin <= list.size()) {
+            auto end = std::min(list.find(',', begin), list.size());
+            auto first = list.find_first_not_of(" \t", begin);
+            if (first < end) {
+                auto last = list.find_last_not_of(" \t", end - 1);
+                core::ErrorCode code = core::ErrorCode::kUnknown;
+                ok = ParseErrorName(list.substr(first, last - first + 1), code);
+                mask |= core::RetryPolicy::RetryMask({code});
+            }
+            begin = end + 1;
+        }
+        if (ok) {
+            policy.retry_on = mask;
+        } else {
+            WarnBadArg(entry, config::kRetryOnArg, list);
+        }
+    }
+    return policy;
+}
+
+InterceptorChain::InterceptorChain(const config::DeviceEntry& entry,
+                                   const std::vector<std::string>& names,
+                                   const InterfaceTable& inner)
+    : inner_(inner), outer_(inner) {
+    // Wrap innermost first, so the first name ends up outermost.
+    for (auto it = names.rbegin(); it != names.rend(); ++it) {
+        auto interceptor = InterceptorRegistry::Create(*it, entry);
+        if (!interceptor) {
+            continue;
+        }
+        interceptor->Wrap(outer_);
+        interceptors_.push_back(std::move(interceptor));
+        names_.push_back(*it);
+    }
+    std::reverse(names_.begin(), names_.end());
+}
+
+}  // namespace plas::hal
@@ -0,0 +1,52 @@
+#include "plas/hal/interface/device.h"
+
+#include "plas/hal/interface/gpio.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/i3c.h"
+#include "plas/hal/interface/pci/cxl.h"
+#include "plas/hal/interface/pci/cxl_mailbox.h"
+#include "plas/hal/interface/pci/pci_bar.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/interface/power_control.h"
+#include "plas/hal/interface/serial.h"
+#include "plas/hal/interface/smbus.h"
+#include "plas/hal/interface/spi.h"
+#include "plas/hal/interface/ssd_gpio.h"
+#include "plas/hal/interface/uart.h"
+
+namespace plas::hal {
+
+namespace {
+
+template <typename T>
+void* Probe(Device* device) {
+    return static_cast<void*>(dynamic_cast<T*>(device));
+}
+
+}  // namespace
+
+void* Device::QueryInterface(InterfaceKind kind) {
+    // Fallback for devices without an InterfaceList (test doubles,
+    // out-of-tree drivers).
+    switch (kind) {
+        case InterfaceKind::kI2c:          return Probe<I2c>(this);
+        case InterfaceKind::kI3c:          return Probe<I3c>(this);
+        case InterfaceKind::kSerial:       return Probe<Serial>(this);
+        case InterfaceKind::kUart:         return Probe<Uart>(this);
+        case InterfaceKind::kPowerControl: return Probe<PowerControl>(this);
+        case InterfaceKind::kSsdGpio:      return Probe<SsdGpio>(this);
+        case InterfaceKind::kPciConfig:    return Probe<pci::PciConfig>(this);
+        case InterfaceKind::kPciDoe:       return Probe<pci::PciDoe>(this);
+        case InterfaceKind::kPciBar:       return Probe<pci::PciBar>(this);
+        case InterfaceKind::kCxl:          return Probe<pci::Cxl>(this);
+        case InterfaceKind::kCxlMailbox:   return Probe<pci::CxlMailbox>(this);
+        case InterfaceKind::kSmBus:        return Probe<SmBus>(this);
+        case InterfaceKind::kSpi:          return Probe<Spi>(this);
+        case InterfaceKind::kGpio:         return Probe<Gpio>(this);
+        case InterfaceKind::kCount:        break;
+    }
+    return nullptr;
+}
+
+}  // namespace plas::hal
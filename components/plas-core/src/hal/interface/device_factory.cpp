@@ -1,19 +1,68 @@
 #include "plas/hal/interface/device_factory.h"
 
+#include <atomic>
+#include <deque>
+#include <unordered_map>
+
 #include "plas/core/error.h"
 
 namespace plas::hal {
 
+namespace {
+
+/// Hashed by driver name; keys view `names`, whose elements never move.
+struct DriverRegistry {
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, DeviceFactory::UriCreatorFunc> creators;
+};
+
+DriverRegistry& Registry() {
+    static DriverRegistry registry;
+    return registry;
+}
+
+// Atomic because concurrent Bootstrap::Init() calls (isolated tenants)
+// each install the same table while others look drivers up.
+std::atomic<const DeviceFactory::BuiltinDriver*> builtin_drivers{nullptr};
+std::atomic<std::size_t> builtin_driver_count{0};
+
+}  // namespace
+
+const DeviceFactory::UriCreatorFunc* DeviceFactory::FindCreator(
+    std::string_view driver_name) {
+    auto& creators = Registry().creators;
+    auto it = creators.find(driver_name);
+    return it == creators.end() ? nullptr : &it->second;
+}
+
+DeviceFactory::DriverCreateFn DeviceFactory::FindBuiltin(std::string_view driver_name) {
+    const auto* table = builtin_drivers.load(std::memory_order_acquire);
+    const std::size_t count = builtin_driver_count.load(std::memory_order_acquire);
+    for (std::size_t i = 0; table != nullptr && i < count; ++i) {
+        if (table[i].name == driver_name) {
+            return table[i].create;
+        }
+    }
+    return nullptr;
+}
+
 core::Result<std::unique_ptr<Device>> DeviceFactory::CreateFromConfig(
     const config::DeviceEntry& entry) {
-    auto& registry = GetRegistry();
-    auto it = registry.find(entry.driver);
-    if (it == registry.end()) {
+    return CreateFromConfig(entry, config::DeviceUri::Parse(entry.uri));
+}
+
+core::Result<std::unique_ptr<Device>> DeviceFactory::CreateFromConfig(
+    const config::DeviceEntry& entry, const config::DeviceUri& uri) {
+    // An unparsable URI is still handed over: drivers report it from Init().
+    std::unique_ptr<Device> device;
+    if (const auto* creator = FindCreator(entry.driver)) {
+        device = (*creator)(entry, uri);
+    } else if (auto create = FindBuiltin(entry.driver)) {
+        device = create(entry, uri);
+    } else {
         return core::Result<std::unique_ptr<Device>>::Err(
             core::ErrorCode::kNotFound);
     }
-
-    auto device = it->second(entry);
     if (!device) {
         return core::Result<std::unique_ptr<Device>>::Err(
             core::ErrorCode::kInternalError);
@@ -22,15 +71,43 @@ core::Result<std::unique_ptr<Device>> DeviceFactory::CreateFromConfig(
     return core::Result<std::unique_ptr<Device>>::Ok(std::move(device));
 }
 
+core::Result<std::unique_ptr<Device>> DeviceFactory::CreateFromConfig(
+    const config::DeviceEntryView& entry) {
+    if (!HasDriver(entry.Driver())) {
+        return core::Result<std::unique_ptr<Device>>::Err(
+            core::ErrorCode::kNotFound);
+    }
+    return CreateFromConfig(entry.ToEntry());
+}
+
 void DeviceFactory::RegisterDriver(const std::string& driver_name,
                                    CreatorFunc creator) {
-    GetRegistry()[driver_name] = std::move(creator);
+    RegisterDriver(driver_name,
+                   [creator = std::move(creator)](const config::DeviceEntry& entry,
+                                                  const config::DeviceUri&) {
+                       return creator(entry);
+                   });
 }
 
-std::map<std::string, DeviceFactory::CreatorFunc>&
-DeviceFactory::GetRegistry() {
-    static std::map<std::string, CreatorFunc> registry;
-    return registry;
+void DeviceFactory::RegisterDriver(const std::string& driver_name,
+                                   UriCreatorFunc creator) {
+    auto& registry = Registry();
+    auto it = registry.creators.find(driver_name);
+    if (it != registry.creators.end()) {
+        it->second = std::move(creator);
+        return;
+    }
+    const auto& name = registry.names.emplace_back(driver_name);
+    registry.creators.emplace(name, std::move(creator));
+}
+
+void DeviceFactory::SetBuiltinDrivers(const BuiltinDriver* table, std::size_t count) {
+    builtin_drivers.store(table, std::memory_order_release);
+    builtin_driver_count.store(table ? count : 0, std::memory_order_release);
+}
+
+bool DeviceFactory::HasDriver(std::string_view driver_name) {
+    return FindCreator(driver_name) != nullptr || FindBuiltin(driver_name) != nullptr;
 }
 
 }  // namespace plas::hal
@@ -0,0 +1,288 @@
+#include "plas/hal/interface/i2c_eeprom.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/core/error.h"
+
+namespace plas::hal {
+
+namespace {
+
+bool IsPowerOfTwo(std::size_t value) {
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+/// How backends report an address NACK (see I2c::Probe).
+bool IsNack(const std::error_code& error) {
+    return error == core::make_error_code(core::ErrorCode::kIOError) ||
+           error == core::make_error_code(core::ErrorCode::kTimeout);
+}
+
+}  // namespace
+
+core::Result<I2cEepromGeometry> I2cEepromGeometry::FromPart(std::string_view part) {
+    std::string name;
+    for (char c : part) {
+        name.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+    }
+    // at24c256, m24c64, 24lc16, 24aa512: vendor prefix, "24", family letters.
+    if (name.rfind("at", 0) == 0) {
+        name.erase(0, 2);
+    } else if (name.rfind("m", 0) == 0) {
+        name.erase(0, 1);
+    }
+    if (name.rfind("24", 0) != 0) {
+        return core::Result<I2cEepromGeometry>::Err(core::ErrorCode::kNotFound);
+    }
+    std::size_t pos = 2;
+    while (pos < name.size() && std::isalpha(static_cast<unsigned char>(name[pos]))) {
+        ++pos;
+    }
+    std::string kbit = name.substr(pos);
+
+    struct Part {
+        const char* kbit;
+        I2cEepromGeometry geometry;
+    };
+    static const Part kParts[] = {
+        {"02", {256, 8, 1}},       {"04", {512, 16, 1}},     {"08", {1024, 16, 1}},
+        {"16", {2048, 16, 1}},     {"32", {4096, 32, 2}},    {"64", {8192, 32, 2}},
+        {"128", {16384, 64, 2}},   {"256", {32768, 64, 2}},  {"512", {65536, 128, 2}},
+        {"1024", {131072, 256, 2}},
+    };
+    for (const auto& known : kParts) {
+        if (kbit == known.kbit) {
+            return core::Result<I2cEepromGeometry>::Ok(known.geometry);
+        }
+    }
+    return core::Result<I2cEepromGeometry>::Err(core::ErrorCode::kNotFound);
+}
+
+I2cEeprom::I2cEeprom(I2c& bus, core::Address addr, I2cEepromGeometry geometry,
+                     I2cEepromOptions options)
+    : bus_(bus), addr_(addr), geometry_(geometry), options_(options) {}
+
+bool I2cEeprom::ValidGeometry() const {
+    if (!IsPowerOfTwo(geometry_.size) || !IsPowerOfTwo(geometry_.page_size) ||
+        geometry_.page_size > geometry_.size ||
+        (geometry_.address_bytes != 1 && geometry_.address_bytes != 2)) {
+        return false;
+    }
+    // The block-select bits must stay within the 7-bit device address.
+    std::size_t blocks = geometry_.size > BlockSize() ? geometry_.size / BlockSize() : 1;
+    return addr_ + (blocks - 1) <= 0x7F && (addr_ & (blocks - 1)) == 0;
+}
+
+std::size_t I2cEeprom::BlockSize() const {
+    return std::size_t{1} << (8 * geometry_.address_bytes);
+}
+
+core::Address I2cEeprom::DeviceFor(std::size_t offset) const {
+    return addr_ | static_cast<core::Address>(offset / BlockSize());
+}
+
+core::Result<void> I2cEeprom::CheckRange(std::size_t offset, const void* data,
+                                         std::size_t length) const {
+    if (!ValidGeometry() || (data == nullptr && length > 0)) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (offset > geometry_.size || length > geometry_.size - offset) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+    return core::Result<void>::Ok();
+}
+
+void I2cEeprom::Pause() const {
+    if (options_.poll_interval.count() > 0) {
+        std::this_thread::sleep_for(options_.poll_interval);
+    }
+}
+
+core::Result<void> I2cEeprom::Read(std::size_t offset, core::Byte* data, std::size_t length) {
+    auto range = CheckRange(offset, data, length);
+    if (range.IsError() || length == 0) {
+        return range;
+    }
+    // The part NACKs everything until its write cycle is over.
+    if (write_pending_) {
+        auto ready = WaitReady();
+        if (ready.IsError()) {
+            return ready;
+        }
+    }
+
+    std::size_t chunk = options_.max_read_chunk == 0 ? length : options_.max_read_chunk;
+    std::size_t pieces = 0;
+    for (std::size_t pos = 0; pos < length; ++pieces) {
+        std::size_t at = offset + pos;
+        std::size_t block_end = (at / BlockSize() + 1) * BlockSize();
+        pos += std::min({length - pos, chunk, block_end - at});
+    }
+
+    // Pointer bytes must not move once the messages point at them.
+    std::vector<std::array<core::Byte, 2>> pointers(pieces);
+    std::vector<I2cMessage> msgs;
+    msgs.reserve(2 * pieces);
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < pieces; ++i) {
+        std::size_t at = offset + pos;
+        std::size_t block_end = (at / BlockSize() + 1) * BlockSize();
+        std::size_t n = std::min({length - pos, chunk, block_end - at});
+        std::size_t mem = at & (BlockSize() - 1);
+        if (geometry_.address_bytes == 2) {
+            pointers[i] = {static_cast<core::Byte>(mem >> 8), static_cast<core::Byte>(mem)};
+        } else {
+            pointers[i] = {static_cast<core::Byte>(mem), 0};
+        }
+        core::Address dev = DeviceFor(at);
+        I2cMessage pointer;
+        pointer.addr = dev;
+        pointer.data = pointers[i].data();
+        pointer.length = geometry_.address_bytes;
+        I2cMessage read;
+        read.addr = dev;
+        read.data = data + pos;
+        read.length = n;
+        read.read = true;
+        read.stop = true;
+        msgs.push_back(pointer);
+        msgs.push_back(read);
+        pos += n;
+    }
+
+    auto result = bus_.Transfer(msgs.data(), msgs.size());
+    stats_.read_transfers++;
+    if (result.IsError()) {
+        return core::Result<void>::Err(result.Error());
+    }
+    for (std::size_t i = 1; i < msgs.size(); i += 2) {
+        if (msgs[i].transferred != msgs[i].length) {
+            return core::Result<void>::Err(core::ErrorCode::kDataLoss);
+        }
+    }
+    stats_.bytes_read += length;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> I2cEeprom::WritePage(std::size_t offset, const core::Byte* data,
+                                        std::size_t length) {
+    std::vector<core::Byte> frame(geometry_.address_bytes + length);
+    std::size_t mem = offset & (BlockSize() - 1);
+    if (geometry_.address_bytes == 2) {
+        frame[0] = static_cast<core::Byte>(mem >> 8);
+        frame[1] = static_cast<core::Byte>(mem);
+    } else {
+        frame[0] = static_cast<core::Byte>(mem);
+    }
+    std::memcpy(frame.data() + geometry_.address_bytes, data, length);
+
+    // While the previous page is still being programmed the part NACKs its
+    // address, so the write doubles as the ACK poll.
+    core::Address dev = DeviceFor(offset);
+    for (;;) {
+        auto result = bus_.Write(dev, frame.data(), frame.size());
+        if (result.IsOk()) {
+            break;
+        }
+        if (!write_pending_ || !IsNack(result.Error())) {
+            return core::Result<void>::Err(result.Error());
+        }
+        if (Clock::now() - last_write_ > options_.write_timeout) {
+            return core::Result<void>::Err(core::ErrorCode::kTimeout);
+        }
+        stats_.ack_polls++;
+        Pause();
+    }
+    last_write_ = Clock::now();
+    write_pending_ = true;
+    stats_.pages_written++;
+    stats_.bytes_written += length;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> I2cEeprom::Write(std::size_t offset, const core::Byte* data,
+                                    std::size_t length) {
+    auto range = CheckRange(offset, data, length);
+    if (range.IsError() || length == 0) {
+        return range;
+    }
+
+    std::vector<core::Byte> current;
+    if (options_.skip_unchanged) {
+        current.resize(length);
+        auto read = Read(offset, current.data(), length);
+        if (read.IsError()) {
+            return read;
+        }
+    }
+
+    for (std::size_t pos = 0; pos < length;) {
+        std::size_t at = offset + pos;
+        std::size_t n = std::min(length - pos, geometry_.page_size - at % geometry_.page_size);
+        if (options_.skip_unchanged &&
+            std::equal(data + pos, data + pos + n, current.data() + pos)) {
+            stats_.pages_skipped++;
+        } else {
+            auto page = WritePage(at, data + pos, n);
+            if (page.IsError()) {
+                return page;
+            }
+        }
+        pos += n;
+    }
+
+    if (write_pending_) {
+        auto ready = WaitReady();
+        if (ready.IsError()) {
+            return ready;
+        }
+    }
+    if (options_.verify) {
+        return Verify(offset, data, length);
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> I2cEeprom::Verify(std::size_t offset, const core::Byte* data,
+                                     std::size_t length) {
+    auto range = CheckRange(offset, data, length);
+    if (range.IsError() || length == 0) {
+        return range;
+    }
+    std::vector<core::Byte> readback(length);
+    auto read = Read(offset, readback.data(), length);
+    if (read.IsError()) {
+        return read;
+    }
+    if (!std::equal(readback.begin(), readback.end(), data)) {
+        return core::Result<void>::Err(core::ErrorCode::kDataLoss);
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> I2cEeprom::WaitReady() {
+    auto since = write_pending_ ? last_write_ : Clock::now();
+    for (;;) {
+        auto present = bus_.Probe(addr_);
+        if (present.IsError()) {
+            return core::Result<void>::Err(present.Error());
+        }
+        if (present.Value()) {
+            write_pending_ = false;
+            return core::Result<void>::Ok();
+        }
+        if (Clock::now() - since > options_.write_timeout) {
+            return core::Result<void>::Err(core::ErrorCode::kTimeout);
+        }
+        stats_.ack_polls++;
+        Pause();
+    }
+}
+
+}  // namespace plas::hal
@@ -0,0 +1,608 @@
+#include "plas/hal/interface/i2c_register_map.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <mutex>
+#include <system_error>
+#include <utility>
+
+#include "plas/core/error.h"
+#include "plas/core/executor.h"
+
+namespace plas::hal {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kMaxRegisterSize = 8;
+
+std::string_view Trim(std::string_view text) {
+    const char* space = " \t\r\n";
+    auto first = text.find_first_not_of(space);
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    auto last = text.find_last_not_of(space);
+    return text.substr(first, last - first + 1);
+}
+
+/// Split on `sep`, trimming each piece.
+std::vector<std::string_view> Split(std::string_view text, char sep) {
+    std::vector<std::string_view> parts;
+    while (true) {
+        auto pos = text.find(sep);
+        parts.push_back(Trim(text.substr(0, pos)));
+        if (pos == std::string_view::npos) {
+            return parts;
+        }
+        text = text.substr(pos + 1);
+    }
+}
+
+bool ParseNumber(std::string_view text, uint64_t& value) {
+    int base = 10;
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        text.remove_prefix(2);
+        base = 16;
+    }
+    if (text.empty()) {
+        return false;
+    }
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value, base);
+    return ec == std::errc() && end == text.data() + text.size();
+}
+
+bool ParsePeriod(std::string_view text, std::chrono::milliseconds& period) {
+    uint64_t value = 0;
+    if (text.size() > 2 && text.substr(text.size() - 2) == "ms") {
+        if (!ParseNumber(text.substr(0, text.size() - 2), value)) {
+            return false;
+        }
+        period = std::chrono::milliseconds(static_cast<int64_t>(value));
+        return true;
+    }
+    if (text.size() > 1 && text.back() == 's' &&
+        ParseNumber(text.substr(0, text.size() - 1), value)) {
+        period = std::chrono::seconds(static_cast<int64_t>(value));
+        return true;
+    }
+    return false;
+}
+
+bool ParseRegister(std::string_view text, I2cRegister& reg) {
+    auto eq = text.find('=');
+    if (eq == std::string_view::npos) {
+        return false;
+    }
+    reg.name = std::string(Trim(text.substr(0, eq)));
+    auto fields = Split(text.substr(eq + 1), '/');
+    uint64_t offset = 0;
+    if (reg.name.empty() || !ParseNumber(fields[0], offset) || offset > UINT16_MAX) {
+        return false;
+    }
+    reg.offset = static_cast<uint16_t>(offset);
+    for (std::size_t i = 1; i < fields.size(); ++i) {
+        uint64_t size = 0;
+        if (fields[i] == "le") {
+            reg.little_endian = true;
+        } else if (fields[i] == "const") {
+            reg.constant = true;
+        } else if (ParseNumber(fields[i], size)) {
+            if (size == 0 || size > kMaxRegisterSize) {
+                return false;
+            }
+            reg.size = static_cast<uint8_t>(size);
+        } else if (!ParsePeriod(fields[i], reg.period)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ParseDevice(std::string_view text, I2cRegisterDevice& device) {
+    auto colon = text.find(':');
+    if (colon == std::string_view::npos) {
+        return false;
+    }
+    auto head = Trim(text.substr(0, colon));
+    auto at = head.find('@');
+    if (at == std::string_view::npos) {
+        return false;
+    }
+    device.name = std::string(Trim(head.substr(0, at)));
+    auto fields = Split(head.substr(at + 1), '/');
+    uint64_t addr = 0;
+    if (device.name.empty() || !ParseNumber(fields[0], addr) || addr > 0x7F) {
+        return false;
+    }
+    device.addr = static_cast<core::Address>(addr);
+    for (std::size_t i = 1; i < fields.size(); ++i) {
+        if (fields[i] == "a16") {
+            device.offset_width = 2;
+        } else if (fields[i] == "noinc") {
+            device.auto_increment = false;
+        } else {
+            return false;
+        }
+    }
+    for (auto item : Split(text.substr(colon + 1), ',')) {
+        I2cRegister reg;
+        if (!ParseRegister(item, reg)) {
+            return false;
+        }
+        device.registers.push_back(std::move(reg));
+    }
+    return true;
+}
+
+uint64_t Decode(const core::Byte* data, const I2cRegister& reg) {
+    uint64_t value = 0;
+    for (std::size_t i = 0; i < reg.size; ++i) {
+        std::size_t byte = reg.little_endian ? reg.size - 1 - i : i;
+        value = (value << 8) | data[byte];
+    }
+    return value;
+}
+
+/// Register pointer bytes of `offset`, MSB first.
+std::size_t EncodePointer(uint16_t offset, uint8_t width, core::Byte* out) {
+    if (width == 2) {
+        out[0] = static_cast<core::Byte>(offset >> 8);
+        out[1] = static_cast<core::Byte>(offset);
+        return 2;
+    }
+    out[0] = static_cast<core::Byte>(offset);
+    return 1;
+}
+
+}  // namespace
+
+core::Result<std::vector<I2cRegisterDevice>> ParseI2cRegisterMap(std::string_view text) {
+    using R = core::Result<std::vector<I2cRegisterDevice>>;
+    std::vector<I2cRegisterDevice> devices;
+    for (auto item : Split(text, ';')) {
+        if (item.empty()) {
+            continue;  // trailing ';'
+        }
+        I2cRegisterDevice device;
+        if (!ParseDevice(item, device)) {
+            return R::Err(core::ErrorCode::kInvalidArgument);
+        }
+        devices.push_back(std::move(device));
+    }
+    return R::Ok(std::move(devices));
+}
+
+struct I2cRegisterMap::Impl {
+    struct Reg {
+        I2cRegister def;
+        uint32_t device = 0;
+        uint64_t value = 0;
+        bool valid = false;            ///< value holds a successful read
+        std::error_code error;         ///< of the last attempt, if it failed
+        Clock::time_point last_read;   ///< of the last successful read
+    };
+
+    struct Dev {
+        I2cRegisterDevice def;  ///< registers moved to `regs`
+        std::vector<I2cRegisterId> by_offset;
+    };
+
+    /// A planned block and the registers it covers.
+    struct Block {
+        I2cReadBlock read;
+        std::vector<I2cRegisterId> regs;
+    };
+
+    I2c& bus;
+    I2cRegisterMapOptions options;
+
+    mutable std::mutex mutex;  // devices, registers, stats
+    std::vector<Dev> devices;
+    std::vector<Reg> regs;
+    I2cRegisterMapStats stats;
+
+    std::mutex poll_mutex;  // one Poll() at a time
+
+    mutable std::mutex control_mutex;  // Start/Stop/AddDevice
+    core::Executor::TimerId timer = 0;  // guarded by control_mutex; 0: stopped
+
+    Impl(I2c& b, I2cRegisterMapOptions opts) : bus(b), options(opts) {
+        options.max_block = std::max<std::size_t>(options.max_block, 1);
+    }
+
+    static bool Valid(const I2cRegisterDevice& device) {
+        if (device.name.empty() || device.addr > 0x7F ||
+            (device.offset_width != 1 && device.offset_width != 2)) {
+            return false;
+        }
+        const std::size_t space = device.offset_width == 1 ? 0x100 : 0x10000;
+        for (std::size_t i = 0; i < device.registers.size(); ++i) {
+            const auto& reg = device.registers[i];
+            if (reg.name.empty() || reg.size == 0 || reg.size > kMaxRegisterSize ||
+                std::size_t{reg.offset} + reg.size > space) {
+                return false;
+            }
+            for (std::size_t j = 0; j < i; ++j) {
+                if (device.registers[j].name == reg.name) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool HasDevice(const std::string& name) const {
+        return std::any_of(devices.begin(), devices.end(),
+                           [&](const Dev& dev) { return dev.def.name == name; });
+    }
+
+    /// Append a validated device; returns its index. Caller holds `mutex`.
+    uint32_t Add(I2cRegisterDevice device) {
+        const auto index = static_cast<uint32_t>(devices.size());
+        Dev dev;
+        for (auto& reg : device.registers) {
+            dev.by_offset.push_back(static_cast<I2cRegisterId>(regs.size()));
+            Reg entry;
+            entry.def = std::move(reg);
+            entry.device = index;
+            regs.push_back(std::move(entry));
+        }
+        std::stable_sort(dev.by_offset.begin(), dev.by_offset.end(),
+                         [this](I2cRegisterId a, I2cRegisterId b) {
+                             return regs[a].def.offset < regs[b].def.offset;
+                         });
+        device.registers.clear();
+        dev.def = std::move(device);
+        devices.push_back(std::move(dev));
+        return index;
+    }
+
+    bool Due(const Reg& reg, Clock::time_point now) const {
+        if (!reg.valid) {
+            return true;
+        }
+        if (reg.def.constant) {
+            return false;
+        }
+        return reg.def.period.count() == 0 || now - reg.last_read >= reg.def.period;
+    }
+
+    std::vector<Block> Plan(Clock::time_point now) const {
+        std::vector<Block> blocks;
+        for (uint32_t d = 0; d < devices.size(); ++d) {
+            const auto& dev = devices[d];
+            Block* open = nullptr;
+            std::size_t end = 0;
+            for (auto id : dev.by_offset) {
+                const auto& reg = regs[id];
+                if (!Due(reg, now)) {
+                    continue;
+                }
+                const std::size_t start = reg.def.offset;
+                const std::size_t stop = start + reg.def.size;
+                if (open && dev.def.auto_increment && start <= end + options.max_gap &&
+                    std::max(end, stop) - open->read.offset <= options.max_block) {
+                    end = std::max(end, stop);
+                    open->read.length = static_cast<uint16_t>(end - open->read.offset);
+                    open->regs.push_back(id);
+                    continue;
+                }
+                blocks.push_back(Block{{d, reg.def.offset, reg.def.size}, {id}});
+                open = &blocks.back();
+                end = stop;
+            }
+        }
+        return blocks;
+    }
+
+    /// Record a read of `reg` from `data` (nullptr with `error` on failure).
+    void Update(Reg& reg, const core::Byte* data, std::error_code error, Clock::time_point at) {
+        if (data) {
+            reg.value = Decode(data, reg.def);
+            reg.valid = true;
+            reg.error.clear();
+            reg.last_read = at;
+            ++stats.registers_read;
+        } else {
+            reg.error = error;
+        }
+    }
+
+    core::Result<void> Poll() {
+        const auto now = Clock::now();
+        std::vector<Block> blocks;
+        std::vector<uint8_t> widths;
+        std::vector<core::Address> addrs;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++stats.polls;
+            blocks = Plan(now);
+            for (const auto& block : blocks) {
+                widths.push_back(devices[block.read.device].def.offset_width);
+                addrs.push_back(devices[block.read.device].def.addr);
+            }
+        }
+        if (blocks.empty()) {
+            return core::Result<void>::Ok();
+        }
+
+        // One pointer write + read pair per block, all in one Transfer.
+        std::vector<std::array<core::Byte, 2>> pointers(blocks.size());
+        std::vector<std::size_t> starts(blocks.size());
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            starts[i] = total;
+            total += blocks[i].read.length;
+        }
+        std::vector<core::Byte> data(total);
+        std::vector<I2cMessage> msgs;
+        msgs.reserve(blocks.size() * 2);
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            const auto& read = blocks[i].read;
+            std::size_t n = EncodePointer(read.offset, widths[i], pointers[i].data());
+            msgs.push_back(I2cMessage{addrs[i], pointers[i].data(), n, false, false, 0});
+            msgs.push_back(
+                I2cMessage{addrs[i], data.data() + starts[i], read.length, true, true, 0});
+        }
+
+        std::vector<std::error_code> errors(blocks.size());
+        auto batch = bus.Transfer(msgs.data(), msgs.size());
+        if (batch.IsOk()) {
+            for (std::size_t i = 0; i < blocks.size(); ++i) {
+                if (msgs[2 * i + 1].transferred != blocks[i].read.length) {
+                    errors[i] = core::make_error_code(core::ErrorCode::kIOError);
+                }
+            }
+        } else {
+            // Find the failing block(s): retry one at a time.
+            for (std::size_t i = 0; i < blocks.size(); ++i) {
+                const auto& read = blocks[i].read;
+                auto r = bus.WriteRead(addrs[i], pointers[i].data(), msgs[2 * i].length,
+                                       data.data() + starts[i], read.length);
+                if (r.IsError()) {
+                    errors[i] = r.Error();
+                } else if (r.Value() != read.length) {
+                    errors[i] = core::make_error_code(core::ErrorCode::kIOError);
+                }
+            }
+        }
+
+        std::error_code first;
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.transfers += blocks.size();
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            const auto& block = blocks[i];
+            if (errors[i]) {
+                ++stats.errors;
+                if (!first) {
+                    first = errors[i];
+                }
+            } else {
+                stats.bytes_read += block.read.length;
+            }
+            for (auto id : block.regs) {
+                auto& reg = regs[id];
+                const core::Byte* at =
+                    data.data() + starts[i] + (reg.def.offset - block.read.offset);
+                Update(reg, errors[i] ? nullptr : at, errors[i], now);
+            }
+        }
+        if (first) {
+            return core::Result<void>::Err(first);
+        }
+        return core::Result<void>::Ok();
+    }
+};
+
+I2cRegisterMap::I2cRegisterMap(I2c& bus, I2cRegisterMapOptions options)
+    : impl_(std::make_unique<Impl>(bus, options)) {}
+
+I2cRegisterMap::~I2cRegisterMap() {
+    Stop();
+}
+
+core::Result<uint32_t> I2cRegisterMap::AddDevice(I2cRegisterDevice device) {
+    using R = core::Result<uint32_t>;
+    std::lock_guard<std::mutex> control(impl_->control_mutex);
+    if (impl_->timer != 0) {
+        return R::Err(core::ErrorCode::kBusy);
+    }
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (!impl_->Valid(device) || impl_->HasDevice(device.name)) {
+        return R::Err(core::ErrorCode::kInvalidArgument);
+    }
+    return R::Ok(impl_->Add(std::move(device)));
+}
+
+core::Result<void> I2cRegisterMap::AddDevices(std::string_view text) {
+    auto parsed = ParseI2cRegisterMap(text);
+    if (parsed.IsError()) {
+        return core::Result<void>::Err(parsed.Error());
+    }
+    auto& devices = parsed.Value();
+    std::lock_guard<std::mutex> control(impl_->control_mutex);
+    if (impl_->timer != 0) {
+        return core::Result<void>::Err(core::ErrorCode::kBusy);
+    }
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    for (std::size_t i = 0; i < devices.size(); ++i) {
+        bool repeated = std::any_of(devices.begin(), devices.begin() + static_cast<long>(i),
+                                    [&](const auto& d) { return d.name == devices[i].name; });
+        if (!impl_->Valid(devices[i]) || impl_->HasDevice(devices[i].name) || repeated) {
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        }
+    }
+    for (auto& device : devices) {
+        impl_->Add(std::move(device));
+    }
+    return core::Result<void>::Ok();
+}
+
+std::size_t I2cRegisterMap::DeviceCount() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->devices.size();
+}
+
+core::Result<I2cRegisterId> I2cRegisterMap::Find(std::string_view device,
+                                                 std::string_view reg) const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    for (const auto& dev : impl_->devices) {
+        if (dev.def.name != device) {
+            continue;
+        }
+        for (auto id : dev.by_offset) {
+            if (impl_->regs[id].def.name == reg) {
+                return core::Result<I2cRegisterId>::Ok(id);
+            }
+        }
+        break;
+    }
+    return core::Result<I2cRegisterId>::Err(core::ErrorCode::kNotFound);
+}
+
+core::Result<uint64_t> I2cRegisterMap::Read(I2cRegisterId id) {
+    using R = core::Result<uint64_t>;
+    I2cRegister def;
+    core::Address addr = 0;
+    uint8_t width = 1;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        if (id >= impl_->regs.size()) {
+            return R::Err(core::ErrorCode::kNotFound);
+        }
+        const auto& reg = impl_->regs[id];
+        if (reg.def.constant && reg.valid) {
+            ++impl_->stats.cache_hits;
+            return R::Ok(reg.value);
+        }
+        def = reg.def;
+        addr = impl_->devices[reg.device].def.addr;
+        width = impl_->devices[reg.device].def.offset_width;
+    }
+
+    std::array<core::Byte, 2> pointer{};
+    std::array<core::Byte, kMaxRegisterSize> data{};
+    std::size_t n = EncodePointer(def.offset, width, pointer.data());
+    const auto now = Clock::now();
+    auto r = impl_->bus.WriteRead(addr, pointer.data(), n, data.data(), def.size);
+    std::error_code error;
+    if (r.IsError()) {
+        error = r.Error();
+    } else if (r.Value() != def.size) {
+        error = core::make_error_code(core::ErrorCode::kIOError);
+    }
+
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    ++impl_->stats.transfers;
+    auto& reg = impl_->regs[id];
+    if (error) {
+        ++impl_->stats.errors;
+        impl_->Update(reg, nullptr, error, now);
+        return R::Err(error);
+    }
+    impl_->stats.bytes_read += def.size;
+    impl_->Update(reg, data.data(), {}, now);
+    return R::Ok(reg.value);
+}
+
+core::Result<void> I2cRegisterMap::Write(I2cRegisterId id, uint64_t value) {
+    std::array<core::Byte, 2 + kMaxRegisterSize> buffer{};
+    std::size_t n = 0;
+    core::Address addr = 0;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        if (id >= impl_->regs.size()) {
+            return core::Result<void>::Err(core::ErrorCode::kNotFound);
+        }
+        const auto& reg = impl_->regs[id];
+        const auto& dev = impl_->devices[reg.device].def;
+        if (reg.def.constant ||
+            (reg.def.size < kMaxRegisterSize && (value >> (8 * reg.def.size)) != 0)) {
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        }
+        addr = dev.addr;
+        n = EncodePointer(reg.def.offset, dev.offset_width, buffer.data());
+        for (std::size_t i = 0; i < reg.def.size; ++i) {
+            std::size_t shift = reg.def.little_endian ? i : reg.def.size - 1 - i;
+            buffer[n + i] = static_cast<core::Byte>(value >> (8 * shift));
+        }
+        n += reg.def.size;
+    }
+    auto r = impl_->bus.Write(addr, buffer.data(), n);
+    if (r.IsError()) {
+        return core::Result<void>::Err(r.Error());
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<uint64_t> I2cRegisterMap::Value(I2cRegisterId id) const {
+    using R = core::Result<uint64_t>;
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (id >= impl_->regs.size()) {
+        return R::Err(core::ErrorCode::kNotFound);
+    }
+    const auto& reg = impl_->regs[id];
+    if (reg.error) {
+        return R::Err(reg.error);
+    }
+    if (!reg.valid) {
+        return R::Err(core::ErrorCode::kNotFound);
+    }
+    return R::Ok(reg.value);
+}
+
+std::vector<I2cReadBlock> I2cRegisterMap::PlanPoll() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    std::vector<I2cReadBlock> reads;
+    for (const auto& block : impl_->Plan(Clock::now())) {
+        reads.push_back(block.read);
+    }
+    return reads;
+}
+
+core::Result<void> I2cRegisterMap::Poll() {
+    std::lock_guard<std::mutex> lock(impl_->poll_mutex);
+    return impl_->Poll();
+}
+
+core::Result<void> I2cRegisterMap::Start(PollCallback callback) {
+    std::lock_guard<std::mutex> lock(impl_->control_mutex);
+    if (impl_->timer != 0) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+    }
+    auto interval = std::max(impl_->options.interval, std::chrono::milliseconds(1));
+    impl_->timer = core::Executor::Shared().PostEvery(
+        interval, [this, callback = std::move(callback)] {
+            auto result = Poll();
+            if (callback) {
+                callback(std::move(result));
+            }
+        });
+    return core::Result<void>::Ok();
+}
+
+void I2cRegisterMap::Stop() {
+    core::Executor::TimerId timer = 0;
+    {
+        std::lock_guard<std::mutex> lock(impl_->control_mutex);
+        timer = std::exchange(impl_->timer, 0);
+    }
+    if (timer != 0) {
+        core::Executor::Shared().Cancel(timer);
+    }
+}
+
+bool I2cRegisterMap::IsRunning() const {
+    std::lock_guard<std::mutex> lock(impl_->control_mutex);
+    return impl_->timer != 0;
+}
+
+I2cRegisterMapStats I2cRegisterMap::Stats() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->stats;
+}
+
+}  // namespace plas::hal
@@ -0,0 +1,206 @@
+#include "plas/hal/interface/i3c_target_table.h"
+
+#include <algorithm>
+
+#include "plas/core/error.h"
+
+namespace plas::hal {
+
+namespace {
+
+constexpr std::size_t kPidBytes = 6;
+
+uint16_t ReadBe16(const core::Byte* data) {
+    return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+void WriteBe16(uint16_t value, core::Byte* out) {
+    out[0] = static_cast<core::Byte>(value >> 8);
+    out[1] = static_cast<core::Byte>(value);
+}
+
+}  // namespace
+
+bool I3cTargetTable::IsAssignable(core::Address addr) {
+    if (addr < 0x08 || addr > 0x77) {
+        return false;
+    }
+    return addr != 0x3E && addr != 0x5E && addr != 0x6E && addr != 0x76;
+}
+
+I3cTargetInfo I3cTargetTable::FromDaaRecord(const core::Byte* record,
+                                            core::Address dynamic_address) {
+    I3cTargetInfo info;
+    info.dynamic_address = dynamic_address;
+    for (std::size_t i = 0; i < kPidBytes; ++i) {
+        info.pid = (info.pid << 8) | record[i];
+    }
+    info.bcr = record[kPidBytes];
+    info.dcr = record[kPidBytes + 1];
+    return info;
+}
+
+core::Result<void> I3cTargetTable::Add(const I3cTargetInfo& target) {
+    if (!IsAssignable(target.dynamic_address)) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::lock_guard lock(mutex_);
+    for (const auto& t : targets_) {
+        if (t.dynamic_address == target.dynamic_address || t.pid == target.pid) {
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        }
+    }
+    auto pos = std::lower_bound(
+        targets_.begin(), targets_.end(), target.dynamic_address,
+        [](const I3cTargetInfo& t, core::Address a) { return t.dynamic_address < a; });
+    targets_.insert(pos, target);
+    return core::Result<void>::Ok();
+}
+
+void I3cTargetTable::Clear() {
+    std::lock_guard lock(mutex_);
+    targets_.clear();
+}
+
+std::optional<I3cTargetInfo> I3cTargetTable::Find(core::Address dynamic_address) const {
+    std::lock_guard lock(mutex_);
+    for (const auto& t : targets_) {
+        if (t.dynamic_address == dynamic_address) {
+            return t;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<I3cTargetInfo> I3cTargetTable::FindByPid(uint64_t pid) const {
+    std::lock_guard lock(mutex_);
+    for (const auto& t : targets_) {
+        if (t.pid == pid) {
+            return t;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<I3cTargetInfo> I3cTargetTable::Targets() const {
+    std::lock_guard lock(mutex_);
+    return targets_;
+}
+
+std::size_t I3cTargetTable::Size() const {
+    std::lock_guard lock(mutex_);
+    return targets_.size();
+}
+
+core::Result<core::Address> I3cTargetTable::NextFreeAddress(core::Address from) const {
+    std::lock_guard lock(mutex_);
+    for (core::Address addr = std::max<core::Address>(from, 0x08); addr <= 0x77; ++addr) {
+        if (!IsAssignable(addr)) {
+            continue;
+        }
+        bool used = std::any_of(targets_.begin(), targets_.end(),
+                                [addr](const I3cTargetInfo& t) {
+                                    return t.dynamic_address == addr;
+                                });
+        if (!used) {
+            return core::Result<core::Address>::Ok(addr);
+        }
+    }
+    return core::Result<core::Address>::Err(core::ErrorCode::kResourceExhausted);
+}
+
+core::Result<std::size_t> I3cTargetTable::Answer(uint8_t ccc, core::Address addr,
+                                                 core::Byte* data,
+                                                 std::size_t length) const {
+    auto target = Find(addr);
+    if (!target) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kNotFound);
+    }
+
+    core::Byte reply[kPidBytes];
+    std::size_t size = 0;
+    switch (ccc) {
+        case i3c_ccc::kGetpid:
+            for (std::size_t i = 0; i < kPidBytes; ++i) {
+                reply[i] = static_cast<core::Byte>(target->pid >> (8 * (kPidBytes - 1 - i)));
+            }
+            size = kPidBytes;
+            break;
+        case i3c_ccc::kGetbcr:
+            reply[0] = target->bcr;
+            size = 1;
+            break;
+        case i3c_ccc::kGetdcr:
+            reply[0] = target->dcr;
+            size = 1;
+            break;
+        case i3c_ccc::kGetmrl:
+        case i3c_ccc::kGetmwl: {
+            uint16_t value = ccc == i3c_ccc::kGetmrl ? target->max_read_length
+                                                     : target->max_write_length;
+            if (value == 0) {
+                return core::Result<std::size_t>::Err(core::ErrorCode::kNotSupported);
+            }
+            WriteBe16(value, reply);
+            size = 2;
+            break;
+        }
+        default:
+            return core::Result<std::size_t>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    if (data == nullptr || length < size) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::copy(reply, reply + size, data);
+    return core::Result<std::size_t>::Ok(size);
+}
+
+void I3cTargetTable::Observe(uint8_t ccc, core::Address addr,
+                             const core::Byte* data, std::size_t length) {
+    std::lock_guard lock(mutex_);
+    auto apply = [&](auto&& fn) {
+        const bool broadcast = ccc < 0x80;
+        for (auto& t : targets_) {
+            if (broadcast || t.dynamic_address == addr) {
+                fn(t);
+            }
+        }
+    };
+
+    switch (ccc) {
+        case i3c_ccc::kRstdaa:
+            targets_.clear();
+            break;
+        case i3c_ccc::kSetnewda: {
+            if (data == nullptr || length < 1) {
+                break;
+            }
+            const core::Address new_addr = static_cast<core::Address>(data[0] >> 1);
+            apply([new_addr](I3cTargetInfo& t) { t.dynamic_address = new_addr; });
+            std::sort(targets_.begin(), targets_.end(),
+                      [](const I3cTargetInfo& a, const I3cTargetInfo& b) {
+                          return a.dynamic_address < b.dynamic_address;
+                      });
+            break;
+        }
+        case i3c_ccc::kSetmrl:
+        case i3c_ccc::kSetmrlAll:
+            if (data != nullptr && length >= 2) {
+                const uint16_t value = ReadBe16(data);
+                apply([value](I3cTargetInfo& t) { t.max_read_length = value; });
+            }
+            break;
+        case i3c_ccc::kSetmwl:
+        case i3c_ccc::kSetmwlAll:
+            if (data != nullptr && length >= 2) {
+                const uint16_t value = ReadBe16(data);
+                apply([value](I3cTargetInfo& t) { t.max_write_length = value; });
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+}  // namespace plas::hal
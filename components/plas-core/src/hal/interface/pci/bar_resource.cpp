@@ -0,0 +1,73 @@
+#include "plas/hal/interface/pci/bar_resource.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "plas/core/error.h"
+
+namespace plas::hal::pci {
+
+namespace {
+
+// The six BAR lines (three 18-character fields each) fit with room to
+// spare; the ROM and bridge window lines after them are not needed.
+constexpr std::size_t kResourceFileMax = 1024;
+
+}  // namespace
+
+BarResources ParseBarResources(const char* text, std::size_t length) {
+    BarResources bars{};
+    const char* p = text;
+    const char* limit = text + length;
+    for (std::size_t i = 0; i < kBarCount && p < limit; ++i) {
+        const char* eol = p;
+        while (eol < limit && *eol != '\n') {
+            ++eol;
+        }
+        // strtoull needs a terminated string; a line is at most ~60 bytes.
+        char line[128] = {};
+        std::size_t n = static_cast<std::size_t>(eol - p);
+        if (n < sizeof(line)) {
+            std::memcpy(line, p, n);
+            char* cursor = line;
+            char* next = nullptr;
+            uint64_t values[3] = {};
+            std::size_t parsed = 0;
+            for (; parsed < 3; ++parsed) {
+                values[parsed] = std::strtoull(cursor, &next, 16);
+                if (next == cursor) {
+                    break;
+                }
+                cursor = next;
+            }
+            if (parsed == 3) {
+                bars[i].start = values[0];
+                bars[i].end = values[1];
+                bars[i].flags = values[2];
+            }
+        }
+        p = eol < limit ? eol + 1 : limit;
+    }
+    return bars;
+}
+
+core::Result<BarResources> ReadBarResources(const std::string& device_path) {
+    std::string path = device_path + "/resource";
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return core::Result<BarResources>::Err(core::ErrorCode::kNotFound);
+    }
+    char buffer[kResourceFileMax];
+    auto n = ::pread(fd, buffer, sizeof(buffer), 0);
+    ::close(fd);
+    if (n < 0) {
+        return core::Result<BarResources>::Err(core::ErrorCode::kIOError);
+    }
+    return core::Result<BarResources>::Ok(
+        ParseBarResources(buffer, static_cast<std::size_t>(n)));
+}
+
+}  // namespace plas::hal::pci
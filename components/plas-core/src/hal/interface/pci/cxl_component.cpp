@@ -0,0 +1,221 @@
+#include "plas/hal/interface/pci/cxl_component.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/cxl.h"
+#include "plas/hal/interface/pci/pci_bar.h"
+
+namespace plas::hal::pci {
+
+namespace {
+
+// Component register block layout (CXL 3.1 8.2.3, 8.2.4).
+constexpr uint64_t kCacheMemOffset = 0x1000;  // within the block
+constexpr uint16_t kArraySizeShift = 24;       // CXL Capability Header [31:24]
+constexpr uint16_t kPointerShift = 20;         // element header [31:20]
+
+// HDM Decoder Capability structure (CXL 3.1 8.2.4.20).
+namespace hdm_reg {
+constexpr std::size_t kCapability = 0x00;
+constexpr std::size_t kGlobalControl = 0x04;
+constexpr std::size_t kDecoder0 = 0x10;
+constexpr std::size_t kDecoderStride = 0x20;
+constexpr std::size_t kBaseLow = 0x00;
+constexpr std::size_t kBaseHigh = 0x04;
+constexpr std::size_t kSizeLow = 0x08;
+constexpr std::size_t kSizeHigh = 0x0C;
+constexpr std::size_t kControl = 0x10;
+constexpr std::size_t kTargetLow = 0x14;
+constexpr std::size_t kTargetHigh = 0x18;
+}  // namespace hdm_reg
+
+constexpr uint32_t kHdmEnable = 1u << 1;
+constexpr uint32_t kRangeLowMask = 0xF0000000;  // Base/Size Low [31:28]
+
+constexpr uint32_t kLockOnCommit = 1u << 8;
+constexpr uint32_t kCommitted = 1u << 10;
+constexpr uint32_t kErrorNotCommitted = 1u << 11;
+constexpr uint32_t kTargetRangeType = 1u << 12;
+
+// RAS Capability structure (CXL 3.1 8.2.4.17).
+namespace ras_reg {
+constexpr std::size_t kUncorrectableStatus = 0x00;
+constexpr std::size_t kUncorrectableMask = 0x04;
+constexpr std::size_t kUncorrectableSeverity = 0x08;
+constexpr std::size_t kCorrectableStatus = 0x0C;
+constexpr std::size_t kCorrectableMask = 0x10;
+constexpr std::size_t kCapabilityControl = 0x14;
+constexpr std::size_t kHeaderLog = 0x18;
+constexpr std::size_t kLength = 0x58;
+}  // namespace ras_reg
+
+constexpr uint32_t kFirstErrorMask = 0x3F;
+
+/// Decoder Count encoding, HDM Decoder Capability [3:0].
+uint16_t DecoderCount(uint32_t encoded) {
+    if (encoded == 0) return 1;
+    if (encoded <= 8) return static_cast<uint16_t>(encoded * 2);
+    if (encoded <= 0xC) return static_cast<uint16_t>((encoded - 4) * 4);
+    return 0;  // reserved
+}
+
+/// Interleave Ways encoding, Decoder Control [7:4].
+uint16_t InterleaveWays(uint32_t encoded) {
+    if (encoded <= 4) return static_cast<uint16_t>(1u << encoded);
+    if (encoded >= 8 && encoded <= 0xA) return static_cast<uint16_t>(3u << (encoded - 8));
+    return 0;  // reserved
+}
+
+uint64_t NowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// CxlComponentSnapshot
+// ---------------------------------------------------------------------------
+core::DWord CxlComponentSnapshot::Read32(std::size_t offset) const {
+    if (offset + 4 > kSize) {
+        return 0;
+    }
+    return static_cast<core::DWord>(data[offset]) |
+           (static_cast<core::DWord>(data[offset + 1]) << 8) |
+           (static_cast<core::DWord>(data[offset + 2]) << 16) |
+           (static_cast<core::DWord>(data[offset + 3]) << 24);
+}
+
+std::optional<uint16_t> CxlComponentSnapshot::FindCapability(CxlCacheMemCapId id) const {
+    uint32_t header = Read32(0);
+    if ((header & 0xFFFF) != static_cast<uint16_t>(CxlCacheMemCapId::kCapability)) {
+        return std::nullopt;
+    }
+    uint32_t count = header >> kArraySizeShift;
+    for (uint32_t i = 1; i <= count; ++i) {
+        uint32_t element = Read32(i * 4);
+        if ((element & 0xFFFF) == static_cast<uint16_t>(id)) {
+            return static_cast<uint16_t>(element >> kPointerShift);
+        }
+    }
+    return std::nullopt;
+}
+
+core::Result<CxlHdmInfo> CxlComponentSnapshot::HdmDecoders() const {
+    auto cap = FindCapability(CxlCacheMemCapId::kHdmDecoder);
+    if (!cap) {
+        return core::Result<CxlHdmInfo>::Err(core::ErrorCode::kNotFound);
+    }
+    uint32_t capability = Read32(*cap + hdm_reg::kCapability);
+    CxlHdmInfo info{};
+    info.decoder_count = DecoderCount(capability & 0xF);
+    info.target_count = static_cast<uint8_t>((capability >> 4) & 0xF);
+    info.enabled = (Read32(*cap + hdm_reg::kGlobalControl) & kHdmEnable) != 0;
+    if (*cap + hdm_reg::kDecoder0 + info.decoder_count * hdm_reg::kDecoderStride > kSize) {
+        return core::Result<CxlHdmInfo>::Err(core::ErrorCode::kIOError);
+    }
+
+    info.decoders.reserve(info.decoder_count);
+    for (uint16_t n = 0; n < info.decoder_count; ++n) {
+        std::size_t reg = *cap + hdm_reg::kDecoder0 + n * hdm_reg::kDecoderStride;
+        uint32_t control = Read32(reg + hdm_reg::kControl);
+        CxlHdmDecoder decoder{};
+        decoder.index = static_cast<uint8_t>(n);
+        decoder.base = (static_cast<uint64_t>(Read32(reg + hdm_reg::kBaseHigh)) << 32) |
+                       (Read32(reg + hdm_reg::kBaseLow) & kRangeLowMask);
+        decoder.size = (static_cast<uint64_t>(Read32(reg + hdm_reg::kSizeHigh)) << 32) |
+                       (Read32(reg + hdm_reg::kSizeLow) & kRangeLowMask);
+        decoder.interleave_granularity = 256u << std::min<uint32_t>(control & 0xF, 16);
+        decoder.interleave_ways = InterleaveWays((control >> 4) & 0xF);
+        decoder.lock_on_commit = (control & kLockOnCommit) != 0;
+        decoder.committed = (control & kCommitted) != 0;
+        decoder.error_not_committed = (control & kErrorNotCommitted) != 0;
+        decoder.host_only = (control & kTargetRangeType) != 0;
+        decoder.target_list_or_dpa_skip =
+            (static_cast<uint64_t>(Read32(reg + hdm_reg::kTargetHigh)) << 32) |
+            Read32(reg + hdm_reg::kTargetLow);
+        decoder.control = control;
+        info.decoders.push_back(decoder);
+    }
+    return core::Result<CxlHdmInfo>::Ok(std::move(info));
+}
+
+core::Result<CxlRasStatus> CxlComponentSnapshot::Ras() const {
+    auto cap = FindCapability(CxlCacheMemCapId::kRas);
+    if (!cap) {
+        return core::Result<CxlRasStatus>::Err(core::ErrorCode::kNotFound);
+    }
+    if (*cap + ras_reg::kLength > kSize) {
+        return core::Result<CxlRasStatus>::Err(core::ErrorCode::kIOError);
+    }
+    CxlRasStatus ras{};
+    ras.uncorrectable = Read32(*cap + ras_reg::kUncorrectableStatus);
+    ras.uncorrectable_mask = Read32(*cap + ras_reg::kUncorrectableMask);
+    ras.uncorrectable_severity = Read32(*cap + ras_reg::kUncorrectableSeverity);
+    ras.correctable = Read32(*cap + ras_reg::kCorrectableStatus);
+    ras.correctable_mask = Read32(*cap + ras_reg::kCorrectableMask);
+    ras.first_error =
+        static_cast<uint8_t>(Read32(*cap + ras_reg::kCapabilityControl) & kFirstErrorMask);
+    for (std::size_t i = 0; i < ras.header_log.size(); ++i) {
+        ras.header_log[i] = Read32(*cap + ras_reg::kHeaderLog + i * 4);
+    }
+    return core::Result<CxlRasStatus>::Ok(ras);
+}
+
+// ---------------------------------------------------------------------------
+// CxlComponentRegisters
+// ---------------------------------------------------------------------------
+CxlComponentRegisters::CxlComponentRegisters(PciBar& bar, Bdf bdf,
+                                             CxlComponentLocation location)
+    : bar_(bar), bdf_(bdf), location_(location) {}
+
+core::Result<CxlComponentLocation> CxlComponentRegisters::Locate(Cxl& cxl, PciBar& bar,
+                                                                 Bdf bdf) {
+    auto blocks = cxl.GetRegisterBlocks(bdf);
+    if (blocks.IsError()) {
+        return core::Result<CxlComponentLocation>::Err(blocks.Error());
+    }
+    auto block = std::find_if(blocks.Value().begin(), blocks.Value().end(),
+                              [](const auto& entry) {
+                                  return entry.block_id ==
+                                         CxlRegisterBlockId::kComponentRegister;
+                              });
+    if (block == blocks.Value().end()) {
+        return core::Result<CxlComponentLocation>::Err(core::ErrorCode::kNotFound);
+    }
+
+    CxlComponentLocation location{block->bar_index, block->offset + kCacheMemOffset};
+    auto header = bar.BarRead32(bdf, location.bar_index, location.offset);
+    if (header.IsError()) {
+        return core::Result<CxlComponentLocation>::Err(header.Error());
+    }
+    if ((header.Value() & 0xFFFF) != static_cast<uint16_t>(CxlCacheMemCapId::kCapability)) {
+        return core::Result<CxlComponentLocation>::Err(core::ErrorCode::kNotFound);
+    }
+    return core::Result<CxlComponentLocation>::Ok(location);
+}
+
+core::Result<void> CxlComponentRegisters::Snapshot(CxlComponentSnapshot& out) {
+    auto read = bar_.BarReadBuffer(bdf_, location_.bar_index, location_.offset,
+                                   out.data.data(), out.data.size());
+    if (read.IsError()) {
+        return read;
+    }
+    out.timestamp_ns = NowNs();
+    return core::Result<void>::Ok();
+}
+
+core::Result<CxlComponentSnapshot> CxlComponentRegisters::Snapshot() {
+    CxlComponentSnapshot snapshot;
+    auto read = Snapshot(snapshot);
+    if (read.IsError()) {
+        return core::Result<CxlComponentSnapshot>::Err(read.Error());
+    }
+    return core::Result<CxlComponentSnapshot>::Ok(snapshot);
+}
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,113 @@
+#include "plas/hal/interface/pci/cxl_dvsec.h"
+
+#include <algorithm>
+
+namespace plas::hal::pci {
+
+namespace {
+
+// Offsets within a DVSEC (CXL 3.1 8.1.1 / 8.1.3 / 8.1.9).
+constexpr std::size_t kDvsecHeader1 = 0x04;
+constexpr std::size_t kDvsecHeader2 = 0x08;
+constexpr std::size_t kCxlCapability = 0x0A;       // CXL Device DVSEC
+constexpr std::size_t kRegisterBlock1 = 0x0C;      // Register Locator DVSEC
+constexpr std::size_t kRegisterBlockSize = 8;
+
+// DVSEC CXL Capability bits.
+constexpr uint16_t kCacheCapable = 1u << 0;
+constexpr uint16_t kMemCapable = 1u << 2;
+
+uint16_t Le16(const core::Byte* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t Le32(const core::Byte* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+CxlDeviceType DeviceTypeFromCapability(uint16_t capability) {
+    bool cache = (capability & kCacheCapable) != 0;
+    bool mem = (capability & kMemCapable) != 0;
+    if (cache && mem) {
+        return CxlDeviceType::kType2;
+    }
+    if (cache) {
+        return CxlDeviceType::kType1;
+    }
+    if (mem) {
+        return CxlDeviceType::kType3;
+    }
+    return CxlDeviceType::kUnknown;
+}
+
+}  // namespace
+
+std::optional<DvsecHeader> CxlDvsecIndex::Find(CxlDvsecId id) const {
+    for (const auto& header : dvsecs) {
+        if (header.dvsec_id == id) {
+            return header;
+        }
+    }
+    return std::nullopt;
+}
+
+CxlDvsecIndex CxlDvsecIndex::Parse(const core::Byte* config, std::size_t size,
+                                   const CapabilityIndex& caps) {
+    CxlDvsecIndex index;
+    if (!config) {
+        return index;
+    }
+    bool have_device_dvsec = false;
+    bool have_locator = false;
+    for (ConfigOffset offset : caps.FindAll(ExtCapabilityId::kDvsec)) {
+        if (offset + kDvsecHeader2 + 2 > size) {
+            continue;
+        }
+        const core::Byte* base = config + offset;
+        uint32_t header1 = Le32(base + kDvsecHeader1);
+        DvsecHeader header{};
+        header.offset = offset;
+        header.vendor_id = static_cast<uint16_t>(header1 & 0xFFFF);
+        header.dvsec_revision = static_cast<uint16_t>((header1 >> 16) & 0xF);
+        header.dvsec_length = static_cast<uint16_t>(header1 >> 20);
+        header.dvsec_id = static_cast<CxlDvsecId>(Le16(base + kDvsecHeader2));
+        if (header.vendor_id != cxl::kCxlVendorId) {
+            continue;
+        }
+        index.dvsecs.push_back(header);
+
+        std::size_t end = std::min<std::size_t>(
+            offset + header.dvsec_length, size);
+        if (header.dvsec_id == CxlDvsecId::kCxlDevice && !have_device_dvsec &&
+            offset + kCxlCapability + 2 <= end) {
+            have_device_dvsec = true;
+            index.device_type =
+                DeviceTypeFromCapability(Le16(base + kCxlCapability));
+        } else if (header.dvsec_id == CxlDvsecId::kRegisterLocator &&
+                   !have_locator) {
+            have_locator = true;
+            for (std::size_t entry = offset + kRegisterBlock1;
+                 entry + kRegisterBlockSize <= end;
+                 entry += kRegisterBlockSize) {
+                uint32_t low = Le32(config + entry);
+                uint32_t high = Le32(config + entry + 4);
+                auto block_id =
+                    static_cast<CxlRegisterBlockId>((low >> 8) & 0xFF);
+                if (block_id == CxlRegisterBlockId::kEmpty) {
+                    continue;
+                }
+                RegisterBlockEntry block{};
+                block.block_id = block_id;
+                block.bar_index = static_cast<uint8_t>(low & 0x7);
+                block.offset = (static_cast<uint64_t>(high) << 32) |
+                               (low & 0xFFFF0000u);
+                index.register_blocks.push_back(block);
+            }
+        }
+    }
+    return index;
+}
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,243 @@
+#include "plas/hal/interface/pci/cxl_firmware.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "plas/core/error.h"
+#include "plas/core/executor.h"
+#include "plas/core/io_queue.h"
+#include "plas/hal/interface/pci/cxl_mailbox.h"
+
+namespace plas::hal::pci {
+
+namespace {
+
+using ReturnCode = CxlMailboxReturnCode;
+using R = core::Result<ReturnCode>;
+
+constexpr uint16_t kTransferFwOpcode =
+    static_cast<uint16_t>(CxlMailboxOpcode::kTransferFw);
+
+struct TransferHeader {
+    uint8_t bytes[kCxlFwTransferHeaderSize] = {};
+
+    TransferHeader(CxlFwTransferAction action, uint8_t slot,
+                   std::size_t offset) {
+        auto units = static_cast<uint32_t>(offset / kCxlFwTransferUnit);
+        bytes[0x00] = static_cast<uint8_t>(action);
+        bytes[0x01] = slot;
+        bytes[0x04] = static_cast<uint8_t>(units);
+        bytes[0x05] = static_cast<uint8_t>(units >> 8);
+        bytes[0x06] = static_cast<uint8_t>(units >> 16);
+        bytes[0x07] = static_cast<uint8_t>(units >> 24);
+    }
+};
+
+bool IsRetryable(ReturnCode code) {
+    return code == ReturnCode::kBusy || code == ReturnCode::kRetryRequired;
+}
+
+/// Send one Transfer FW part until the device accepts or rejects it.
+R SendPart(CxlMailbox& mailbox, Bdf bdf, const TransferHeader& header,
+           const uint8_t* data, std::size_t length,
+           const CxlFwTransferOptions& options) {
+    auto deadline = std::chrono::steady_clock::now() + options.chunk_timeout;
+    auto backoff = options.backoff;
+    auto wait = [&](std::chrono::microseconds period) {
+        if (std::chrono::steady_clock::now() + period > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(period);
+        return true;
+    };
+
+    for (;;) {
+        auto result = mailbox.ExecuteCommandGather(
+            bdf, kTransferFwOpcode, header.bytes, sizeof(header.bytes), data,
+            length);
+        ReturnCode code;
+        if (result.IsError()) {
+            // The mailbox may still be finishing someone else's command.
+            if (result.Error() != core::ErrorCode::kBusy) {
+                return R::Err(result.Error());
+            }
+            code = ReturnCode::kBusy;
+        } else {
+            code = result.Value().return_code;
+        }
+
+        while (code == ReturnCode::kBackgroundCmdStarted) {
+            if (!wait(options.background_poll)) {
+                return R::Err(core::ErrorCode::kTimeout);
+            }
+            auto status = mailbox.GetBackgroundCmdStatus(bdf);
+            if (status.IsError()) {
+                return R::Err(status.Error());
+            }
+            code = status.Value().return_code;
+        }
+
+        if (!IsRetryable(code)) {
+            return R::Ok(code);
+        }
+        if (!wait(backoff)) {
+            return R::Err(core::ErrorCode::kTimeout);
+        }
+        backoff = std::min(backoff * 2, options.max_backoff);
+    }
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// CxlFirmwareImage
+// ---------------------------------------------------------------------------
+
+CxlFirmwareImage::~CxlFirmwareImage() {
+    if (data_) {
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+    }
+}
+
+CxlFirmwareImage::CxlFirmwareImage(CxlFirmwareImage&& other) noexcept
+    : data_(other.data_), size_(other.size_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+CxlFirmwareImage& CxlFirmwareImage::operator=(
+    CxlFirmwareImage&& other) noexcept {
+    if (this != &other) {
+        if (data_) {
+            ::munmap(const_cast<uint8_t*>(data_), size_);
+        }
+        data_ = other.data_;
+        size_ = other.size_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+core::Result<CxlFirmwareImage> CxlFirmwareImage::Open(
+    const std::string& path) {
+    using ImageResult = core::Result<CxlFirmwareImage>;
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return ImageResult::Err(errno == EACCES
+                                    ? core::ErrorCode::kPermissionDenied
+                                    : core::ErrorCode::kNotFound);
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        ::close(fd);
+        return ImageResult::Err(core::ErrorCode::kInvalidArgument);
+    }
+    auto size = static_cast<std::size_t>(st.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return ImageResult::Err(core::ErrorCode::kIOError);
+    }
+    // Parts are read front to back exactly once.
+    ::madvise(mapped, size, MADV_SEQUENTIAL);
+
+    CxlFirmwareImage image;
+    image.data_ = static_cast<const uint8_t*>(mapped);
+    image.size_ = size;
+    return ImageResult::Ok(std::move(image));
+}
+
+// ---------------------------------------------------------------------------
+// Transfer
+// ---------------------------------------------------------------------------
+
+core::Result<CxlMailboxReturnCode> TransferFirmware(
+    CxlMailbox& mailbox, Bdf bdf, const uint8_t* image, std::size_t size,
+    const CxlFwTransferOptions& options, const CxlFwProgressCallback& progress,
+    std::size_t target) {
+    if (!image || size == 0) {
+        return R::Err(core::ErrorCode::kInvalidArgument);
+    }
+    // Each part is its own mailbox command, so this is where control
+    // commands on the same device get their turn.
+    core::ScopedIoPriority io_priority(options.priority);
+    auto payload_size = mailbox.GetPayloadSize(bdf);
+    if (payload_size.IsError()) {
+        return R::Err(payload_size.Error());
+    }
+    std::size_t capacity = payload_size.Value();
+    if (capacity <= kCxlFwTransferHeaderSize) {
+        return R::Err(core::ErrorCode::kNotSupported);
+    }
+    std::size_t part_size = (capacity - kCxlFwTransferHeaderSize) /
+                            kCxlFwTransferUnit * kCxlFwTransferUnit;
+    if (part_size == 0) {
+        return R::Err(core::ErrorCode::kNotSupported);
+    }
+    auto report = [&](std::size_t sent) {
+        if (progress) {
+            progress(CxlFwProgress{target, sent, size});
+        }
+    };
+
+    if (size <= part_size) {
+        auto sent = SendPart(mailbox, bdf,
+                             TransferHeader(CxlFwTransferAction::kFull,
+                                            options.slot, 0),
+                             image, size, options);
+        if (sent.IsOk() && sent.Value() == ReturnCode::kSuccess) {
+            report(size);
+        }
+        return sent;
+    }
+
+    for (std::size_t offset = 0; offset < size; offset += part_size) {
+        std::size_t length = std::min(part_size, size - offset);
+        auto action = offset == 0 ? CxlFwTransferAction::kInitiate
+                      : offset + length == size ? CxlFwTransferAction::kEnd
+                                                : CxlFwTransferAction::kContinue;
+        auto sent = SendPart(mailbox, bdf,
+                             TransferHeader(action, options.slot, offset),
+                             image + offset, length, options);
+        if (sent.IsError() || sent.Value() != ReturnCode::kSuccess) {
+            // Release the device's partial image once Initiate was
+            // accepted; the original failure is what the caller needs.
+            if (offset > 0) {
+                SendPart(mailbox, bdf,
+                         TransferHeader(CxlFwTransferAction::kAbort,
+                                        options.slot, 0),
+                         nullptr, 0, options);
+            }
+            return sent;
+        }
+        report(offset + length);
+    }
+    return R::Ok(ReturnCode::kSuccess);
+}
+
+std::vector<core::Result<CxlMailboxReturnCode>> TransferFirmwareAll(
+    const std::vector<CxlFwTarget>& targets, const uint8_t* image,
+    std::size_t size, const CxlFwTransferOptions& options,
+    const CxlFwProgressCallback& progress) {
+    std::vector<R> results(targets.size(),
+                           R::Err(core::ErrorCode::kInvalidArgument));
+    core::Executor::Shared().ParallelFor(
+        targets.size(),
+        [&](std::size_t i) {
+            if (targets[i].mailbox) {
+                results[i] = TransferFirmware(*targets[i].mailbox, targets[i].bdf, image,
+                                              size, options, progress, i);
+            }
+        },
+        options.max_parallel);
+    return results;
+}
+
+}  // namespace plas::hal::pci
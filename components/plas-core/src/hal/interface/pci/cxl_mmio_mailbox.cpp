@@ -0,0 +1,424 @@
+#include "plas/hal/interface/pci/cxl_mmio_mailbox.h"
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+#include "plas/core/deadline.h"
+#include "plas/core/error.h"
+#include "plas/core/io_queue.h"
+#include "plas/hal/interface/pci/cxl.h"
+#include "plas/hal/interface/pci/pci_bar.h"
+#include "plas/hal/interface/pci/register_io.h"
+#include "plas/hal/interface/pci/regs/cxl_device.h"
+
+namespace plas::hal::pci {
+
+namespace {
+
+using regs::cxl_device::BackgroundCommandStatus;
+using regs::cxl_device::CapabilitiesArray;
+using regs::cxl_device::CapabilityHeader;
+using regs::cxl_device::Command;
+using regs::cxl_device::MailboxCapabilities;
+using regs::cxl_device::MailboxControl;
+using regs::cxl_device::MailboxStatus;
+
+// CXL Device Capabilities Array (CXL 3.1 8.2.8.1/8.2.8.2).
+constexpr uint64_t kCapArrayEntrySize = 16;
+constexpr uint16_t kCapArrayId = 0x0000;
+constexpr uint16_t kPrimaryMailboxCapId = 0x0002;
+
+// Payload registers, relative to the mailbox capability (CXL 3.1 8.2.8.4).
+constexpr uint64_t kPayload = 0x20;
+
+// Longest single sleep on doorbell_irq before the doorbell is re-read.
+constexpr std::chrono::milliseconds kIrqRecheck{10};
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Pimpl definition
+// ---------------------------------------------------------------------------
+struct CxlMmioMailbox::Impl {
+    Impl(PciBar& b, Bdf d, CxlMailboxLocation loc,
+         const CxlMmioMailboxOptions& opts)
+        : bar(b), bdf(d), location(loc), options(opts) {}
+
+    /// A mailbox register.
+    template <typename Reg>
+    core::Result<core::RegisterValue<Reg>> Read() {
+        return ReadRegister<Reg>(bar, bdf, location.bar_index, location.offset);
+    }
+    template <typename Reg>
+    core::Result<void> Write(const core::RegisterValue<Reg>& value) {
+        return WriteRegister<Reg>(bar, bdf, location.bar_index, location.offset,
+                                  value);
+    }
+
+    core::Result<uint32_t> PayloadSizeLocked() {
+        if (!payload_size) {
+            auto caps = Read<MailboxCapabilities>();
+            if (caps.IsError()) {
+                return core::Result<uint32_t>::Err(caps.Error());
+            }
+            // 2^n bytes, n = 8 (256 B) .. 20 (1 MiB).
+            uint32_t n = std::clamp<uint32_t>(
+                caps.Value().Get<MailboxCapabilities::PayloadSize>(), 8, 20);
+            payload_size = 1u << n;
+            use_irq = options.doorbell_irq &&
+                      caps.Value().Get<MailboxCapabilities::DoorbellInterruptCapable>();
+        }
+        return core::Result<uint32_t>::Ok(*payload_size);
+    }
+
+    core::Result<bool> DoorbellSet() {
+        auto control = Read<MailboxControl>();
+        if (control.IsError()) {
+            return core::Result<bool>::Err(control.Error());
+        }
+        return core::Result<bool>::Ok(
+            control.Value().Get<MailboxControl::Doorbell>());
+    }
+
+    /// Check the mailbox is free, then copy the payload (`header` followed
+    /// by `data`), write the command register and ring the doorbell.
+    core::Result<void> SubmitLocked(uint16_t opcode, const uint8_t* header,
+                                    std::size_t header_len,
+                                    const uint8_t* data,
+                                    std::size_t data_len) {
+        if (pending) {
+            return core::Result<void>::Err(core::ErrorCode::kBusy);
+        }
+        if ((header_len > 0 && !header) || (data_len > 0 && !data)) {
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        }
+        auto size = PayloadSizeLocked();
+        if (size.IsError()) {
+            return core::Result<void>::Err(size.Error());
+        }
+        std::size_t length = header_len + data_len;
+        if (length > size.Value()) {
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        }
+        auto control = Read<MailboxControl>();
+        if (control.IsError()) {
+            return core::Result<void>::Err(control.Error());
+        }
+        if (control.Value().Get<MailboxControl::Doorbell>()) {
+            return core::Result<void>::Err(core::ErrorCode::kBusy);
+        }
+        if (header_len > 0) {
+            auto written =
+                bar.BarWriteBuffer(bdf, location.bar_index,
+                                   location.offset + kPayload, header, header_len);
+            if (written.IsError()) {
+                return written;
+            }
+        }
+        if (data_len > 0) {
+            auto written = bar.BarWriteBuffer(
+                bdf, location.bar_index, location.offset + kPayload + header_len,
+                data, data_len);
+            if (written.IsError()) {
+                return written;
+            }
+        }
+        auto command = Write(core::RegisterValue<Command>()
+                                 .Set<Command::Opcode>(opcode)
+                                 .Set<Command::PayloadLength>(
+                                     static_cast<uint32_t>(length)));
+        if (command.IsError()) {
+            return command;
+        }
+        // Keep the interrupt enables as they are; only add the doorbell
+        // (and the doorbell interrupt when we wait on it).
+        auto ring = control.Value();
+        ring.Set<MailboxControl::Doorbell>(true);
+        if (use_irq) {
+            ring.Set<MailboxControl::DoorbellInterrupt>(true);
+        }
+        auto rung = Write(ring);
+        if (rung.IsError()) {
+            return rung;
+        }
+        pending = true;
+        return core::Result<void>::Ok();
+    }
+
+    /// Wait for the doorbell of the command just submitted to clear.
+    /// Short commands finish within a few MMIO reads: spin first, then back
+    /// off exponentially up to poll_interval, or sleep on doorbell_irq.
+    core::Result<void> WaitLocked() {
+        auto start = std::chrono::steady_clock::now();
+        auto deadline = core::Deadline::Current().Clamp(start + options.timeout);
+        auto interval =
+            std::min(std::chrono::microseconds(1), options.poll_interval);
+        for (;;) {
+            // Armed before the read, so an interrupt after it is not lost.
+            uint64_t token = use_irq ? options.doorbell_irq->Arm() : 0;
+            auto set = DoorbellSet();
+            if (set.IsError()) {
+                pending = false;
+                return core::Result<void>::Err(set.Error());
+            }
+            if (!set.Value()) {
+                return core::Result<void>::Ok();
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                // The device still owns the mailbox; IsReady() reports when
+                // it lets go.
+                pending = false;
+                return core::Result<void>::Err(core::ErrorCode::kTimeout);
+            }
+            if (now - start < options.spin) {
+                continue;
+            }
+            if (use_irq) {
+                // Re-read now and then anyway: a vector shared with other
+                // sources or masked by the host would otherwise stall us
+                // until the deadline.
+                options.doorbell_irq->Wait(
+                    token, std::min(deadline, now + kIrqRecheck));
+            } else {
+                std::this_thread::sleep_for(interval);
+                interval = std::min(interval * 2, options.poll_interval);
+            }
+        }
+    }
+
+    struct Completion {
+        CxlMailboxReturnCode return_code;
+        std::size_t length;  // output payload bytes
+    };
+
+    /// Return code and output length of a completed command.
+    core::Result<Completion> FinishLocked() {
+        pending = false;
+        auto status = Read<MailboxStatus>();
+        if (status.IsError()) {
+            return core::Result<Completion>::Err(status.Error());
+        }
+        auto command = Read<Command>();
+        if (command.IsError()) {
+            return core::Result<Completion>::Err(command.Error());
+        }
+        return core::Result<Completion>::Ok(Completion{
+            status.Value().Get<MailboxStatus::ReturnCode>(),
+            std::min<std::size_t>(command.Value().Get<Command::PayloadLength>(),
+                                  *payload_size)});
+    }
+
+    core::Result<void> ReadPayloadLocked(uint8_t* out, std::size_t length) {
+        if (length == 0) {
+            return core::Result<void>::Ok();
+        }
+        return bar.BarReadBuffer(bdf, location.bar_index,
+                                 location.offset + kPayload, out, length);
+    }
+
+    /// Read return code and output payload of a completed command.
+    core::Result<CxlMailboxResult> CollectLocked() {
+        auto done = FinishLocked();
+        if (done.IsError()) {
+            return core::Result<CxlMailboxResult>::Err(done.Error());
+        }
+        CxlMailboxResult result;
+        result.return_code = done.Value().return_code;
+        result.payload.resize(done.Value().length);
+        auto read = ReadPayloadLocked(result.payload.data(),
+                                      result.payload.size());
+        if (read.IsError()) {
+            return core::Result<CxlMailboxResult>::Err(read.Error());
+        }
+        return core::Result<CxlMailboxResult>::Ok(std::move(result));
+    }
+
+    /// CollectLocked() into a pooled buffer.
+    core::Result<CxlMailboxPooledResult> CollectPooledLocked() {
+        using R = core::Result<CxlMailboxPooledResult>;
+        auto done = FinishLocked();
+        if (done.IsError()) {
+            return R::Err(done.Error());
+        }
+        CxlMailboxPooledResult result{done.Value().return_code,
+                                      core::PooledBytes(done.Value().length)};
+        auto read = ReadPayloadLocked(result.payload.Data(),
+                                      result.payload.Size());
+        if (read.IsError()) {
+            return R::Err(read.Error());
+        }
+        return R::Ok(std::move(result));
+    }
+
+    PciBar& bar;
+    Bdf bdf;
+    CxlMailboxLocation location;
+    CxlMmioMailboxOptions options;
+    std::optional<uint32_t> payload_size;
+    bool use_irq = false;  // doorbell_irq set and the mailbox can raise it
+    bool pending = false;  // Submit() rang the doorbell, TryComplete() due
+    core::IoQueue queue{"cxl_mmio.mailbox"};  // one command at a time, foreground first
+};
+
+CxlMmioMailbox::CxlMmioMailbox(PciBar& bar, Bdf bdf,
+                               CxlMailboxLocation location,
+                               CxlMmioMailboxOptions options)
+    : impl_(std::make_unique<Impl>(bar, bdf, location, options)) {}
+
+CxlMmioMailbox::~CxlMmioMailbox() = default;
+
+core::Result<CxlMailboxLocation> CxlMmioMailbox::Locate(Cxl& cxl, PciBar& bar,
+                                                        Bdf bdf) {
+    auto blocks = cxl.GetRegisterBlocks(bdf);
+    if (blocks.IsError()) {
+        return core::Result<CxlMailboxLocation>::Err(blocks.Error());
+    }
+    auto block = std::find_if(
+        blocks.Value().begin(), blocks.Value().end(), [](const auto& entry) {
+            return entry.block_id == CxlRegisterBlockId::kCxlDeviceRegister;
+        });
+    if (block == blocks.Value().end()) {
+        return core::Result<CxlMailboxLocation>::Err(
+            core::ErrorCode::kNotFound);
+    }
+
+    auto array = ReadRegister<CapabilitiesArray>(bar, bdf, block->bar_index,
+                                                 block->offset);
+    if (array.IsError()) {
+        return core::Result<CxlMailboxLocation>::Err(array.Error());
+    }
+    if (array.Value().Get<CapabilitiesArray::CapabilityId>() != kCapArrayId) {
+        return core::Result<CxlMailboxLocation>::Err(
+            core::ErrorCode::kNotFound);
+    }
+    auto count = array.Value().Get<CapabilitiesArray::CapabilitiesCount>();
+    for (uint16_t i = 1; i <= count; ++i) {
+        auto header = ReadRegister<CapabilityHeader>(
+            bar, bdf, block->bar_index, block->offset + i * kCapArrayEntrySize);
+        if (header.IsError()) {
+            return core::Result<CxlMailboxLocation>::Err(header.Error());
+        }
+        if (header.Value().Get<CapabilityHeader::CapabilityId>() ==
+            kPrimaryMailboxCapId) {
+            return core::Result<CxlMailboxLocation>::Ok(CxlMailboxLocation{
+                block->bar_index,
+                block->offset + header.Value().Get<CapabilityHeader::Offset>()});
+        }
+    }
+    return core::Result<CxlMailboxLocation>::Err(core::ErrorCode::kNotFound);
+}
+
+const CxlMailboxLocation& CxlMmioMailbox::Location() const {
+    return impl_->location;
+}
+
+core::Result<uint32_t> CxlMmioMailbox::PayloadSize() {
+    std::lock_guard<core::IoQueue> lock(impl_->queue);
+    return impl_->PayloadSizeLocked();
+}
+
+core::Result<bool> CxlMmioMailbox::IsReady() {
+    std::lock_guard<core::IoQueue> lock(impl_->queue);
+    if (impl_->pending) {
+        return core::Result<bool>::Ok(false);
+    }
+    auto set = impl_->DoorbellSet();
+    if (set.IsError()) {
+        return set;
+    }
+    return core::Result<bool>::Ok(!set.Value());
+}
+
+core::Result<CxlMailboxResult> CxlMmioMailbox::Execute(
+    uint16_t opcode, const CxlMailboxPayload& payload) {
+    return Execute(opcode, payload.data(), payload.size(), nullptr, 0);
+}
+
+core::Result<CxlMailboxResult> CxlMmioMailbox::Execute(
+    uint16_t opcode, const uint8_t* header, std::size_t header_len,
+    const uint8_t* data, std::size_t data_len) {
+    std::lock_guard<core::IoQueue> lock(impl_->queue);
+    auto submitted =
+        impl_->SubmitLocked(opcode, header, header_len, data, data_len);
+    if (submitted.IsError()) {
+        return core::Result<CxlMailboxResult>::Err(submitted.Error());
+    }
+    auto waited = impl_->WaitLocked();
+    if (waited.IsError()) {
+        return core::Result<CxlMailboxResult>::Err(waited.Error());
+    }
+    return impl_->CollectLocked();
+}
+
+core::Result<CxlMailboxPooledResult> CxlMmioMailbox::ExecutePooled(
+    uint16_t opcode, const uint8_t* payload, std::size_t length) {
+    using R = core::Result<CxlMailboxPooledResult>;
+    std::lock_guard<core::IoQueue> lock(impl_->queue);
+    auto submitted = impl_->SubmitLocked(opcode, payload, length, nullptr, 0);
+    if (submitted.IsError()) {
+        return R::Err(submitted.Error());
+    }
+    auto waited = impl_->WaitLocked();
+    if (waited.IsError()) {
+        return R::Err(waited.Error());
+    }
+    return impl_->CollectPooledLocked();
+}
+
+core::Result<void> CxlMmioMailbox::Submit(uint16_t opcode,
+                                          const CxlMailboxPayload& payload) {
+    return Submit(opcode, payload.data(), payload.size(), nullptr, 0);
+}
+
+core::Result<void> CxlMmioMailbox::Submit(uint16_t opcode,
+                                          const uint8_t* header,
+                                          std::size_t header_len,
+                                          const uint8_t* data,
+                                          std::size_t data_len) {
+    std::lock_guard<core::IoQueue> lock(impl_->queue);
+    return impl_->SubmitLocked(opcode, header, header_len, data, data_len);
+}
+
+core::Result<std::optional<CxlMailboxResult>> CxlMmioMailbox::TryComplete() {
+    using R = core::Result<std::optional<CxlMailboxResult>>;
+    std::lock_guard<core::IoQueue> lock(impl_->queue);
+    if (!impl_->pending) {
+        return R::Err(core::ErrorCode::kNotFound);
+    }
+    auto set = impl_->DoorbellSet();
+    if (set.IsError()) {
+        return R::Err(set.Error());
+    }
+    if (set.Value()) {
+        return R::Ok(std::nullopt);
+    }
+    auto result = impl_->CollectLocked();
+    if (result.IsError()) {
+        return R::Err(result.Error());
+    }
+    return R::Ok(std::move(result.Value()));
+}
+
+core::Result<CxlBackgroundStatus> CxlMmioMailbox::GetBackgroundStatus() {
+    std::lock_guard<core::IoQueue> lock(impl_->queue);
+    auto status = impl_->Read<MailboxStatus>();
+    if (status.IsError()) {
+        return core::Result<CxlBackgroundStatus>::Err(status.Error());
+    }
+    auto background = impl_->Read<BackgroundCommandStatus>();
+    if (background.IsError()) {
+        return core::Result<CxlBackgroundStatus>::Err(background.Error());
+    }
+    const auto& bg = background.Value();
+    CxlBackgroundStatus result{};
+    result.running = status.Value().Get<MailboxStatus::BackgroundOperation>();
+    result.opcode = bg.Get<BackgroundCommandStatus::Opcode>();
+    result.percent_complete = bg.Get<BackgroundCommandStatus::PercentageComplete>();
+    result.return_code = bg.Get<BackgroundCommandStatus::ReturnCode>();
+    result.raw = bg.Raw();
+    return core::Result<CxlBackgroundStatus>::Ok(result);
+}
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,167 @@
+#include "plas/hal/interface/pci/doe_inventory.h"
+
+#include <algorithm>
+#include <mutex>
+#include <utility>
+
+#include "plas/core/error.h"
+#include "plas/core/executor.h"
+#include "plas/hal/interface/pci/pci_reset.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+
+namespace plas::hal::pci {
+
+std::optional<ConfigOffset> DoeDeviceInventory::FindMailbox(DoeProtocolId protocol) const {
+    for (const auto& mailbox : mailboxes) {
+        if (std::find(mailbox.protocols.begin(), mailbox.protocols.end(), protocol) !=
+            mailbox.protocols.end()) {
+            return mailbox.offset;
+        }
+    }
+    return std::nullopt;
+}
+
+// ---------------------------------------------------------------------------
+// Pimpl definition
+// ---------------------------------------------------------------------------
+struct DoeInventory::Impl {
+    struct Entry {
+        PciConfig* config;
+        PciDoe* doe;
+        DoeDeviceInventory inventory;
+        bool valid = false;
+        uint64_t topology_generation = 0;
+        uint64_t reset_count = 0;
+    };
+
+    DoeInventoryOptions options;
+    /// Serializes discovery with readers; discovery itself fans out.
+    mutable std::mutex mutex;
+    std::vector<Entry> entries;
+
+    bool IsStaleLocked(const Entry& entry) const {
+        return !entry.valid ||
+               entry.topology_generation != PciTopology::GetTopologyGeneration() ||
+               entry.reset_count != GetResetCount(entry.inventory.bdf);
+    }
+
+    /// Rediscover `stale` entries. Caller holds `mutex`.
+    void DiscoverLocked(const std::vector<std::size_t>& stale) {
+        // Generations are sampled first, so a reset racing the discovery
+        // leaves the entry stale instead of caching pre-reset results.
+        for (auto i : stale) {
+            auto& entry = entries[i];
+            entry.topology_generation = PciTopology::GetTopologyGeneration();
+            entry.reset_count = GetResetCount(entry.inventory.bdf);
+            entry.inventory.mailboxes.clear();
+            entry.inventory.error = {};
+        }
+
+        auto& executor = core::Executor::Shared();
+        executor.ParallelFor(
+            stale.size(),
+            [&](std::size_t n) {
+                auto& entry = entries[stale[n]];
+                auto index = entry.config->GetCapabilityIndex(entry.inventory.bdf);
+                if (index.IsError()) {
+                    entry.inventory.error = index.Error();
+                    return;
+                }
+                for (auto offset : index.Value().FindAll(ExtCapabilityId::kDoe)) {
+                    entry.inventory.mailboxes.push_back(DoeMailbox{offset, {}, {}});
+                }
+            },
+            options.max_threads);
+
+        std::vector<std::pair<std::size_t, std::size_t>> mailboxes;
+        for (auto i : stale) {
+            for (std::size_t m = 0; m < entries[i].inventory.mailboxes.size(); ++m) {
+                mailboxes.emplace_back(i, m);
+            }
+        }
+        executor.ParallelFor(
+            mailboxes.size(),
+            [&](std::size_t n) {
+                auto& entry = entries[mailboxes[n].first];
+                auto& mailbox = entry.inventory.mailboxes[mailboxes[n].second];
+                auto protocols = entry.doe->DoeDiscover(entry.inventory.bdf, mailbox.offset);
+                if (protocols.IsError()) {
+                    mailbox.error = protocols.Error();
+                } else {
+                    mailbox.protocols = std::move(protocols).Value();
+                }
+            },
+            options.max_threads);
+
+        for (auto i : stale) {
+            entries[i].valid = true;
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// DoeInventory
+// ---------------------------------------------------------------------------
+DoeInventory::DoeInventory(DoeInventoryOptions options) : impl_(std::make_unique<Impl>()) {
+    impl_->options = options;
+}
+
+DoeInventory::~DoeInventory() = default;
+
+uint32_t DoeInventory::AddDevice(PciConfig& config, PciDoe& doe, Bdf bdf) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    Impl::Entry entry{&config, &doe, {}};
+    entry.inventory.bdf = bdf;
+    impl_->entries.push_back(std::move(entry));
+    return static_cast<uint32_t>(impl_->entries.size() - 1);
+}
+
+std::size_t DoeInventory::DeviceCount() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->entries.size();
+}
+
+void DoeInventory::Refresh() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    std::vector<std::size_t> stale;
+    for (std::size_t i = 0; i < impl_->entries.size(); ++i) {
+        if (impl_->IsStaleLocked(impl_->entries[i])) {
+            stale.push_back(i);
+        }
+    }
+    if (!stale.empty()) {
+        impl_->DiscoverLocked(stale);
+    }
+}
+
+core::Result<DoeDeviceInventory> DoeInventory::Get(uint32_t index) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (index >= impl_->entries.size()) {
+        return core::Result<DoeDeviceInventory>::Err(core::ErrorCode::kOutOfRange);
+    }
+    if (impl_->IsStaleLocked(impl_->entries[index])) {
+        impl_->DiscoverLocked({index});
+    }
+    return core::Result<DoeDeviceInventory>::Ok(impl_->entries[index].inventory);
+}
+
+bool DoeInventory::IsStale(uint32_t index) const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return index >= impl_->entries.size() || impl_->IsStaleLocked(impl_->entries[index]);
+}
+
+void DoeInventory::Invalidate(uint32_t index) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (index < impl_->entries.size()) {
+        impl_->entries[index].valid = false;
+    }
+}
+
+void DoeInventory::InvalidateAll() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    for (auto& entry : impl_->entries) {
+        entry.valid = false;
+    }
+}
+
+}  // namespace plas::hal::pci
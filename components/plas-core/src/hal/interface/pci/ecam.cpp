@@ -0,0 +1,96 @@
+#include "plas/hal/interface/pci/ecam.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+
+namespace plas::hal::pci {
+
+namespace {
+
+// ACPI MCFG layout: 36-byte SDT header, 8 reserved bytes, then 16-byte
+// allocation entries.
+constexpr std::size_t kSdtHeaderSize = 36;
+constexpr std::size_t kMcfgEntriesOffset = kSdtHeaderSize + 8;
+constexpr std::size_t kMcfgEntrySize = 16;
+
+uint64_t ReadLe(const uint8_t* p, std::size_t bytes) {
+    uint64_t value = 0;
+    for (std::size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(p[i]) << (8 * i);
+    }
+    return value;
+}
+
+}  // namespace
+
+std::string Ecam::memory_path_ = "/dev/mem";
+
+core::Result<std::vector<EcamRegion>> Ecam::ParseMcfg(const uint8_t* data,
+                                                      std::size_t length) {
+    if (!data || length < kMcfgEntriesOffset ||
+        std::memcmp(data, "MCFG", 4) != 0) {
+        return core::Result<std::vector<EcamRegion>>::Err(
+            core::ErrorCode::kInvalidArgument);
+    }
+    auto table_length = static_cast<std::size_t>(ReadLe(data + 4, 4));
+    if (table_length < kMcfgEntriesOffset || table_length > length) {
+        return core::Result<std::vector<EcamRegion>>::Err(
+            core::ErrorCode::kInvalidArgument);
+    }
+
+    std::vector<EcamRegion> regions;
+    for (std::size_t offset = kMcfgEntriesOffset;
+         offset + kMcfgEntrySize <= table_length; offset += kMcfgEntrySize) {
+        const uint8_t* entry = data + offset;
+        EcamRegion region;
+        region.base_address = ReadLe(entry, 8);
+        region.segment = static_cast<uint16_t>(ReadLe(entry + 8, 2));
+        region.start_bus = entry[10];
+        region.end_bus = entry[11];
+        if (region.end_bus < region.start_bus) {
+            continue;
+        }
+        regions.push_back(region);
+    }
+    return core::Result<std::vector<EcamRegion>>::Ok(std::move(regions));
+}
+
+core::Result<std::vector<EcamRegion>> Ecam::LoadRegions() {
+    std::string path =
+        PciTopology::GetSysfsRoot() + "/firmware/acpi/tables/MCFG";
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return core::Result<std::vector<EcamRegion>>::Err(
+            core::ErrorCode::kNotSupported);
+    }
+    std::vector<uint8_t> table((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+    return ParseMcfg(table.data(), table.size());
+}
+
+core::Result<EcamRegion> Ecam::FindRegion(const PciAddress& addr) {
+    auto regions = LoadRegions();
+    if (regions.IsError()) {
+        return core::Result<EcamRegion>::Err(regions.Error());
+    }
+    for (const auto& region : regions.Value()) {
+        if (region.Contains(addr)) {
+            return core::Result<EcamRegion>::Ok(region);
+        }
+    }
+    return core::Result<EcamRegion>::Err(core::ErrorCode::kNotFound);
+}
+
+void Ecam::SetMemoryPath(const std::string& path) {
+    memory_path_ = path;
+}
+
+const std::string& Ecam::GetMemoryPath() {
+    return memory_path_;
+}
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,231 @@
+#include "plas/hal/interface/pci/ide_km.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include "plas/core/buffer_pool.h"
+#include "plas/core/error.h"
+#include "plas/core/executor.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+
+namespace plas::hal::pci {
+
+namespace {
+
+constexpr uint8_t kIdeKmProtocolId = 0x00;
+constexpr std::size_t kHeaderDwords = 2;
+constexpr std::size_t kKeyProgDwords = kHeaderDwords + 8 + 2;
+
+/// DW0: ProtocolID, ObjectID. DW1: StreamID, status / reserved,
+/// KeySet [0] | RxTx [1] | SubStream [7:4], PortIndex.
+core::DWord HeaderDw0(IdeKmMessageType type) {
+    return kIdeKmProtocolId | (static_cast<core::DWord>(type) << 8);
+}
+
+core::DWord HeaderDw1(const IdeStreamId& stream, uint8_t port_index) {
+    // IdeStreamId::direction is 0 = TX; the RxTx bit is 1 = Tx.
+    uint8_t flags = static_cast<uint8_t>((stream.key_set & 1) |
+                                         ((stream.direction == 0) << 1) |
+                                         (stream.sub_stream << 4));
+    return stream.stream_id | (static_cast<core::DWord>(flags) << 16) |
+           (static_cast<core::DWord>(port_index) << 24);
+}
+
+bool ValidStream(const IdeStreamId& stream) {
+    return stream.key_set <= 1 && stream.direction <= 1 &&
+           stream.sub_stream <= 0xF;
+}
+
+/// Zeroes key material when the batch is done, whichever way it ends.
+class Wiper {
+public:
+    explicit Wiper(core::PooledBuffer<core::DWord>& buffer)
+        : buffer_(buffer) {}
+    ~Wiper() {
+        volatile core::DWord* words = buffer_.Data();
+        for (std::size_t i = 0; i < buffer_.Size(); ++i) {
+            words[i] = 0;
+        }
+    }
+
+private:
+    core::PooledBuffer<core::DWord>& buffer_;
+};
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Pimpl definition
+// ---------------------------------------------------------------------------
+struct IdeKmProgrammer::Impl {
+    using Key = std::pair<const PciDoe*, uint16_t>;
+
+    /// Send one IDE_KM request and check that the answer is `ack` for the
+    /// same stream and port. Returns the ack's status byte.
+    static core::Result<uint8_t> Exchange(PciDoe& doe, Bdf bdf,
+                                          ConfigOffset offset,
+                                          const core::DWord* request,
+                                          std::size_t length,
+                                          IdeKmMessageType ack) {
+        std::array<core::DWord, 4> response{};
+        auto written = doe.DoeExchangeInto(bdf, offset, kIdeKmProtocol,
+                                           request, length, response.data(),
+                                           response.size());
+        if (written.IsError()) {
+            return core::Result<uint8_t>::Err(written.Error());
+        }
+        if (written.Value() < kHeaderDwords ||
+            response[0] != HeaderDw0(ack) ||
+            (response[1] & 0xFFFF00FFu) != (request[1] & 0xFFFF00FFu)) {
+            return core::Result<uint8_t>::Err(core::ErrorCode::kIOError);
+        }
+        return core::Result<uint8_t>::Ok(
+            static_cast<uint8_t>(response[1] >> 8));
+    }
+
+    IdeKmOptions options;
+    std::mutex mutex;  // offsets, generation
+    std::map<Key, ConfigOffset> offsets;
+    uint64_t generation = 0;
+};
+
+IdeKmProgrammer::IdeKmProgrammer(IdeKmOptions options)
+    : impl_(std::make_unique<Impl>()) {
+    impl_->options = options;
+    impl_->generation = PciTopology::GetTopologyGeneration();
+}
+
+IdeKmProgrammer::~IdeKmProgrammer() = default;
+
+core::Result<ConfigOffset> IdeKmProgrammer::Locate(PciConfig& config,
+                                                   PciDoe& doe, Bdf bdf) {
+    using R = core::Result<ConfigOffset>;
+    Impl::Key key{&doe, bdf.Pack()};
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        uint64_t generation = PciTopology::GetTopologyGeneration();
+        if (impl_->generation != generation) {
+            impl_->offsets.clear();
+            impl_->generation = generation;
+        }
+        auto it = impl_->offsets.find(key);
+        if (it != impl_->offsets.end()) {
+            return R::Ok(it->second);
+        }
+    }
+
+    auto index = config.GetCapabilityIndex(bdf);
+    if (index.IsError()) {
+        return R::Err(index.Error());
+    }
+    for (ConfigOffset offset : index.Value().FindAll(ExtCapabilityId::kDoe)) {
+        auto protocols = doe.DoeDiscover(bdf, offset);
+        if (protocols.IsError()) {
+            continue;
+        }
+        for (const auto& protocol : protocols.Value()) {
+            if (protocol.vendor_id == kIdeKmProtocol.vendor_id &&
+                protocol.data_object_type == kIdeKmProtocol.data_object_type) {
+                std::lock_guard<std::mutex> lock(impl_->mutex);
+                impl_->offsets[key] = offset;
+                return R::Ok(offset);
+            }
+        }
+    }
+    return R::Err(core::ErrorCode::kNotSupported);
+}
+
+core::Result<IdeKmBatchResult> IdeKmProgrammer::Program(
+    const IdeKmBatch& batch) {
+    using R = core::Result<IdeKmBatchResult>;
+    if (!batch.doe || !batch.config) {
+        return R::Err(core::ErrorCode::kInvalidArgument);
+    }
+    for (const auto& key : batch.keys) {
+        if (!ValidStream(key.stream)) {
+            return R::Err(core::ErrorCode::kInvalidArgument);
+        }
+    }
+    auto located = Locate(*batch.config, *batch.doe, batch.bdf);
+    if (located.IsError()) {
+        return R::Err(located.Error());
+    }
+    ConfigOffset offset = located.Value();
+    PciDoe& doe = *batch.doe;
+    auto fail = [&](std::error_code error) {
+        // The mailbox may be gone (reset, hot remove): locate it again.
+        Forget(batch.doe, batch.bdf);
+        return R::Err(error);
+    };
+
+    IdeKmBatchResult out;
+    out.status.reserve(batch.keys.size());
+    bool all_ok = true;
+    {
+        core::PooledBuffer<core::DWord> requests(batch.keys.size() *
+                                                 kKeyProgDwords);
+        Wiper wiper(requests);
+        core::DWord* p = requests.Data();
+        for (const auto& key : batch.keys) {
+            *p++ = HeaderDw0(IdeKmMessageType::kKeyProg);
+            *p++ = HeaderDw1(key.stream, batch.port_index);
+            p = std::copy(key.key.begin(), key.key.end(), p);
+            p = std::copy(key.iv.begin(), key.iv.end(), p);
+        }
+
+        for (std::size_t i = 0; i < batch.keys.size(); ++i) {
+            auto status = Impl::Exchange(
+                doe, batch.bdf, offset, requests.Data() + i * kKeyProgDwords,
+                kKeyProgDwords, IdeKmMessageType::kKeyProgAck);
+            if (status.IsError()) {
+                return fail(status.Error());
+            }
+            out.status.push_back(static_cast<IdeKmStatus>(status.Value()));
+            all_ok = all_ok && status.Value() == 0;
+        }
+    }
+
+    if (!batch.set_go || !all_ok || batch.keys.empty()) {
+        return R::Ok(std::move(out));
+    }
+    for (const auto& key : batch.keys) {
+        const core::DWord request[kHeaderDwords] = {
+            HeaderDw0(IdeKmMessageType::kKeySetGo),
+            HeaderDw1(key.stream, batch.port_index)};
+        auto ack = Impl::Exchange(doe, batch.bdf, offset, request,
+                                  kHeaderDwords,
+                                  IdeKmMessageType::kKeySetGoAck);
+        if (ack.IsError()) {
+            return fail(ack.Error());
+        }
+    }
+    out.activated = true;
+    return R::Ok(std::move(out));
+}
+
+std::vector<core::Result<IdeKmBatchResult>> IdeKmProgrammer::ProgramAll(
+    const std::vector<IdeKmBatch>& batches) {
+    using R = core::Result<IdeKmBatchResult>;
+    std::vector<R> results(batches.size(),
+                           R::Err(core::ErrorCode::kInvalidArgument));
+    core::Executor::Shared().ParallelFor(
+        batches.size(), [&](std::size_t i) { results[i] = Program(batches[i]); },
+        impl_->options.max_parallel);
+    return results;
+}
+
+void IdeKmProgrammer::Forget(const PciDoe* doe, Bdf bdf) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->offsets.erase(Impl::Key{doe, bdf.Pack()});
+}
+
+void IdeKmProgrammer::Clear() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->offsets.clear();
+}
+
+}  // namespace plas::hal::pci
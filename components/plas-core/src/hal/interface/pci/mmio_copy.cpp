@@ -0,0 +1,249 @@
+#include "plas/hal/interface/pci/mmio_copy.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "plas/core/error.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PLAS_MMIO_HAS_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace plas::hal::pci {
+
+namespace {
+
+// Scalar copies: one volatile access of sizeof(T) per element. The plain
+// memory side goes through memcpy so it may be unaligned.
+
+template <typename T>
+void ReadScalar(const volatile uint8_t* src, uint8_t* dst,
+                std::size_t length) {
+    for (std::size_t i = 0; i < length; i += sizeof(T)) {
+        T value = *reinterpret_cast<const volatile T*>(src + i);
+        std::memcpy(dst + i, &value, sizeof(T));
+    }
+}
+
+template <typename T>
+void WriteScalar(volatile uint8_t* dst, const uint8_t* src,
+                 std::size_t length) {
+    for (std::size_t i = 0; i < length; i += sizeof(T)) {
+        T value;
+        std::memcpy(&value, src + i, sizeof(T));
+        *reinterpret_cast<volatile T*>(dst + i) = value;
+    }
+}
+
+#ifdef PLAS_MMIO_HAS_SIMD
+
+__attribute__((target("sse4.1"))) void Read128(const volatile uint8_t* src,
+                                                uint8_t* dst,
+                                                std::size_t length) {
+    auto* from = const_cast<uint8_t*>(src);
+    for (std::size_t i = 0; i < length; i += 16) {
+        __m128i v = _mm_stream_load_si128(
+            reinterpret_cast<__m128i*>(from + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+    }
+}
+
+__attribute__((target("sse4.1"))) void Write128(volatile uint8_t* dst,
+                                                 const uint8_t* src,
+                                                 std::size_t length) {
+    auto* to = const_cast<uint8_t*>(dst);
+    for (std::size_t i = 0; i < length; i += 16) {
+        __m128i v =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(to + i), v);
+    }
+    _mm_sfence();
+}
+
+__attribute__((target("avx2"))) void Read256(const volatile uint8_t* src,
+                                              uint8_t* dst,
+                                              std::size_t length) {
+    auto* from = const_cast<uint8_t*>(src);
+    for (std::size_t i = 0; i < length; i += 32) {
+        __m256i v = _mm256_stream_load_si256(
+            reinterpret_cast<__m256i*>(from + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+    }
+}
+
+__attribute__((target("avx2"))) void Write256(volatile uint8_t* dst,
+                                               const uint8_t* src,
+                                               std::size_t length) {
+    auto* to = const_cast<uint8_t*>(dst);
+    for (std::size_t i = 0; i < length; i += 32) {
+        __m256i v =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(to + i), v);
+    }
+    _mm_sfence();
+}
+
+#endif  // PLAS_MMIO_HAS_SIMD
+
+/// Width of the widest naturally aligned access at `address` that fits in
+/// `remaining`, capped at 8 bytes.
+std::size_t EdgeWidth(uintptr_t address, std::size_t remaining) {
+    for (std::size_t width = 8; width > 1; width /= 2) {
+        if (address % width == 0 && remaining >= width) {
+            return width;
+        }
+    }
+    return 1;
+}
+
+core::Result<void> CheckFixedWidth(uintptr_t address, std::size_t length,
+                                   MmioWidth width) {
+    auto bytes = static_cast<std::size_t>(width);
+    if (!IsMmioWidthSupported(width)) {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    if (address % bytes != 0 || length % bytes != 0) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    return core::Result<void>::Ok();
+}
+
+}  // namespace
+
+bool IsMmioWidthSupported(MmioWidth width) {
+    switch (width) {
+        case MmioWidth::kAuto:
+        case MmioWidth::k8:
+        case MmioWidth::k16:
+        case MmioWidth::k32:
+        case MmioWidth::k64:
+            return true;
+#ifdef PLAS_MMIO_HAS_SIMD
+        case MmioWidth::k128: {
+            static const bool supported = __builtin_cpu_supports("sse4.1");
+            return supported;
+        }
+        case MmioWidth::k256: {
+            static const bool supported = __builtin_cpu_supports("avx2");
+            return supported;
+        }
+#else
+        case MmioWidth::k128:
+        case MmioWidth::k256:
+            return false;
+#endif
+    }
+    return false;
+}
+
+core::Result<void> MmioRead(const volatile void* src, void* dst,
+                            std::size_t length, MmioWidth width) {
+    if (length == 0) {
+        return core::Result<void>::Ok();
+    }
+    if (!src || !dst) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    auto* from = static_cast<const volatile uint8_t*>(src);
+    auto* to = static_cast<uint8_t*>(dst);
+    auto address = reinterpret_cast<uintptr_t>(src);
+
+    if (width == MmioWidth::kAuto) {
+        std::size_t done = 0;
+        while (done < length) {
+            std::size_t step = EdgeWidth(address + done, length - done);
+            if (step == 8) {
+                // Aligned bulk.
+                std::size_t bulk = (length - done) & ~std::size_t{7};
+                ReadScalar<uint64_t>(from + done, to + done, bulk);
+                done += bulk;
+                continue;
+            }
+            switch (step) {
+                case 4: ReadScalar<uint32_t>(from + done, to + done, 4); break;
+                case 2: ReadScalar<uint16_t>(from + done, to + done, 2); break;
+                default: ReadScalar<uint8_t>(from + done, to + done, 1); break;
+            }
+            done += step;
+        }
+        return core::Result<void>::Ok();
+    }
+
+    auto check = CheckFixedWidth(address, length, width);
+    if (check.IsError()) {
+        return check;
+    }
+    switch (width) {
+        case MmioWidth::k8:  ReadScalar<uint8_t>(from, to, length); break;
+        case MmioWidth::k16: ReadScalar<uint16_t>(from, to, length); break;
+        case MmioWidth::k32: ReadScalar<uint32_t>(from, to, length); break;
+        case MmioWidth::k64: ReadScalar<uint64_t>(from, to, length); break;
+#ifdef PLAS_MMIO_HAS_SIMD
+        case MmioWidth::k128: Read128(from, to, length); break;
+        case MmioWidth::k256: Read256(from, to, length); break;
+#endif
+        default: break;
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> MmioWrite(volatile void* dst, const void* src,
+                             std::size_t length, MmioWidth width) {
+    if (length == 0) {
+        return core::Result<void>::Ok();
+    }
+    if (!src || !dst) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    auto* to = static_cast<volatile uint8_t*>(dst);
+    auto* from = static_cast<const uint8_t*>(src);
+    auto address = reinterpret_cast<uintptr_t>(dst);
+
+    if (width == MmioWidth::kAuto) {
+        std::size_t done = 0;
+        while (done < length) {
+            std::size_t step = EdgeWidth(address + done, length - done);
+            if (step == 8) {
+                std::size_t bulk = (length - done) & ~std::size_t{7};
+                WriteScalar<uint64_t>(to + done, from + done, bulk);
+                done += bulk;
+                continue;
+            }
+            switch (step) {
+                case 4: WriteScalar<uint32_t>(to + done, from + done, 4); break;
+                case 2: WriteScalar<uint16_t>(to + done, from + done, 2); break;
+                default: WriteScalar<uint8_t>(to + done, from + done, 1); break;
+            }
+            done += step;
+        }
+        return core::Result<void>::Ok();
+    }
+
+    auto check = CheckFixedWidth(address, length, width);
+    if (check.IsError()) {
+        return check;
+    }
+    switch (width) {
+        case MmioWidth::k8:  WriteScalar<uint8_t>(to, from, length); break;
+        case MmioWidth::k16: WriteScalar<uint16_t>(to, from, length); break;
+        case MmioWidth::k32: WriteScalar<uint32_t>(to, from, length); break;
+        case MmioWidth::k64: WriteScalar<uint64_t>(to, from, length); break;
+#ifdef PLAS_MMIO_HAS_SIMD
+        case MmioWidth::k128: Write128(to, from, length); break;
+        case MmioWidth::k256: Write256(to, from, length); break;
+#endif
+        default: break;
+    }
+    return core::Result<void>::Ok();
+}
+
+void MmioFlush() {
+#ifdef PLAS_MMIO_HAS_SIMD
+    _mm_sfence();
+#else
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+}
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,355 @@
+#include "plas/hal/interface/pci/pci_aer.h"
+
+#include <array>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/core/spsc_ring.h"
+#include "plas/hal/interface/pci/pci_device.h"
+#include "plas/hal/interface/pci/regs/aer.h"
+#include "plas/hal/interface/pci/regs/pcie_cap.h"
+#include "plas/log/logger.h"
+
+namespace plas::hal::pci {
+
+namespace {
+
+using regs::aer::CapabilitiesControl;
+using regs::aer::CorrectableErrorStatus;
+using regs::aer::ErrorSourceIdentification;
+using regs::aer::RootErrorStatus;
+using regs::aer::UncorrectableErrorSeverity;
+using regs::aer::UncorrectableErrorStatus;
+
+// Header Log, relative to the AER capability (PCIe 6.0 7.8.4.8).
+constexpr ConfigOffset kHeaderLog = 0x1C;
+constexpr std::size_t kAerLength = 0x2C;      // through the Header Log
+constexpr std::size_t kAerRootLength = 0x38;  // plus the root port registers
+
+uint32_t Le32(const core::Byte* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+/// Register `Reg` out of the AER block read from the capability start.
+template <typename Reg>
+core::RegisterValue<Reg> FromBlock(const core::Byte* block) {
+    return core::RegisterValue<Reg>(Le32(block + Reg::kOffset));
+}
+
+template <typename Reg>
+ConfigOffset At(ConfigOffset aer) {
+    return static_cast<ConfigOffset>(aer + Reg::kOffset);
+}
+
+uint64_t NowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+constexpr const char* kUncorrectableNames[32] = {
+    nullptr, nullptr, nullptr, nullptr,
+    "DataLinkProtocol", "SurpriseDown", nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr,
+    "PoisonedTLP", "FlowControlProtocol", "CompletionTimeout", "CompleterAbort",
+    "UnexpectedCompletion", "ReceiverOverflow", "MalformedTLP", "ECRC",
+    "UnsupportedRequest", "ACSViolation", "UncorrectableInternal", "MCBlockedTLP",
+    "AtomicOpEgressBlocked", "TLPPrefixBlocked", "PoisonedTLPEgressBlocked",
+    "DMWrReqEgressBlocked", "IDECheck", "MisroutedIDETLP", "PCRCCheck",
+    "TLPTranslationEgressBlocked",
+};
+
+constexpr const char* kCorrectableNames[32] = {
+    "ReceiverError", nullptr, nullptr, nullptr,
+    nullptr, nullptr, "BadTLP", "BadDLLP",
+    "ReplayNumRollover", nullptr, nullptr, nullptr,
+    "ReplayTimerTimeout", "AdvisoryNonFatal", "CorrectedInternal", "HeaderLogOverflow",
+};
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Pimpl definition
+// ---------------------------------------------------------------------------
+struct PciAerCollector::Impl {
+    using ReadBlock =
+        std::function<core::Result<void>(ConfigOffset, core::Byte*, std::size_t)>;
+    using WriteBatch =
+        std::function<std::size_t(const ConfigWrite*, std::size_t, std::error_code*)>;
+
+    struct Target {
+        std::string name;
+        ReadBlock read_block;
+        WriteBatch write_batch;
+        ConfigOffset aer = 0;
+        bool root = false;  // root port or RCEC: Root Error registers exist
+
+        // Guarded by poll_mutex.
+        PciAerCounters counters;
+        std::array<uint32_t, 32> pending_uncorrectable{};  // since last report
+        std::array<uint32_t, 32> pending_correctable{};
+        uint64_t pending_records = 0;
+        bool pending_fatal = false;
+        std::chrono::steady_clock::time_point last_report{};
+    };
+
+    explicit Impl(const PciAerCollectorOptions& opts)
+        : options(opts), ring(opts.ring_capacity) {}
+
+    template <typename GetIndex>
+    core::Result<uint32_t> Add(std::string name, GetIndex get_index, ReadBlock read_block,
+                               WriteBatch write_batch) {
+        core::Result<CapabilityIndex> index = get_index();
+        if (index.IsError()) {
+            return core::Result<uint32_t>::Err(index.Error());
+        }
+        auto aer = index.Value().Find(ExtCapabilityId::kAer);
+        if (!aer) {
+            return core::Result<uint32_t>::Err(core::ErrorCode::kNotSupported);
+        }
+        Target target;
+        target.name = std::move(name);
+        target.aer = *aer;
+        if (auto pcie = index.Value().Find(CapabilityId::kPciExpress)) {
+            core::Byte flags[2];
+            if (read_block(static_cast<ConfigOffset>(*pcie + 0x02), flags, sizeof(flags))
+                    .IsOk()) {
+                auto type = regs::pcie::Capabilities::PortType::Get(
+                    static_cast<uint16_t>(flags[0] | (flags[1] << 8)));
+                target.root = type == PciePortType::kRootPort ||
+                              type == PciePortType::kRcEventCollector;
+            }
+        }
+        target.read_block = std::move(read_block);
+        target.write_batch = std::move(write_batch);
+
+        std::lock_guard<std::mutex> lock(poll_mutex);
+        targets.push_back(std::move(target));
+        return core::Result<uint32_t>::Ok(static_cast<uint32_t>(targets.size() - 1));
+    }
+
+    /// Snapshot one device; on any status bit, record, clear and count it.
+    bool PollLocked(uint32_t index, Target& target) {
+        core::Byte block[kAerRootLength];
+        std::size_t length = target.root ? kAerRootLength : kAerLength;
+        if (target.read_block(target.aer, block, length).IsError()) {
+            ++target.counters.read_errors;
+            return false;
+        }
+        PciAerRecord record{};
+        record.uncorrectable = FromBlock<UncorrectableErrorStatus>(block).Raw();
+        record.correctable = FromBlock<CorrectableErrorStatus>(block).Raw();
+        if (target.root) {
+            // Bits 31:27 are the interrupt message number, not events.
+            record.root_status =
+                FromBlock<RootErrorStatus>(block).Raw() & RootErrorStatus::kW1cMask;
+            record.source_id = FromBlock<ErrorSourceIdentification>(block).Raw();
+        }
+        if (record.uncorrectable == 0 && record.correctable == 0 && record.root_status == 0) {
+            return false;
+        }
+        // All ones: the function is gone, not reporting every error at once.
+        if (record.uncorrectable == ~0u && record.correctable == ~0u) {
+            ++target.counters.read_errors;
+            return false;
+        }
+        record.timestamp_ns = NowNs();
+        record.device = index;
+        record.uncorrectable_severity = FromBlock<UncorrectableErrorSeverity>(block).Raw();
+        record.first_error = FromBlock<CapabilitiesControl>(block)
+                                 .Get<CapabilitiesControl::FirstErrorPointer>();
+        for (int i = 0; i < 4; ++i) {
+            record.header_log[i] = Le32(block + kHeaderLog + 4 * i);
+        }
+        ring.Push(record);
+
+        // RW1C: write back exactly the bits read, so an error that arrives
+        // in between stays set for the next poll.
+        ConfigWrite clears[3];
+        std::size_t count = 0;
+        if (record.uncorrectable) {
+            clears[count++] = {At<UncorrectableErrorStatus>(target.aer), 4,
+                               record.uncorrectable};
+        }
+        if (record.correctable) {
+            clears[count++] = {At<CorrectableErrorStatus>(target.aer), 4,
+                               record.correctable};
+        }
+        if (record.root_status) {
+            clears[count++] = {At<RootErrorStatus>(target.aer), 4,
+                               record.root_status};
+        }
+        target.write_batch(clears, count, nullptr);
+
+        auto& counters = target.counters;
+        ++counters.records;
+        counters.correctable += static_cast<uint64_t>(__builtin_popcount(record.correctable));
+        counters.nonfatal += static_cast<uint64_t>(__builtin_popcount(record.NonFatal()));
+        counters.fatal += static_cast<uint64_t>(__builtin_popcount(record.Fatal()));
+        for (unsigned bit = 0; bit < 32; ++bit) {
+            target.pending_uncorrectable[bit] += (record.uncorrectable >> bit) & 1u;
+            target.pending_correctable[bit] += (record.correctable >> bit) & 1u;
+        }
+        ++target.pending_records;
+        target.pending_fatal |= record.Fatal() != 0;
+        return true;
+    }
+
+    static void AppendCounts(std::string& line, const std::array<uint32_t, 32>& counts,
+                             const char* (*name_of)(unsigned)) {
+        bool first = true;
+        for (unsigned bit = 0; bit < 32; ++bit) {
+            if (counts[bit] == 0) continue;
+            line += first ? " " : ", ";
+            first = false;
+            const char* name = name_of(bit);
+            line += name ? name : "bit" + std::to_string(bit);
+            line += " x" + std::to_string(counts[bit]);
+        }
+    }
+
+    /// Log and reset `target`'s pending summary if it has one and, unless
+    /// `force`, its report_interval has passed.
+    void ReportLocked(Target& target, std::chrono::steady_clock::time_point now, bool force) {
+        if (options.report_interval.count() == 0 || target.pending_records == 0) {
+            return;
+        }
+        if (!force && target.last_report != std::chrono::steady_clock::time_point{} &&
+            now - target.last_report < options.report_interval) {
+            return;
+        }
+        bool uncorrectable = false;
+        for (auto count : target.pending_uncorrectable) {
+            uncorrectable |= count != 0;
+        }
+        std::string line = "PciAerCollector: " + target.name + " " +
+                           std::to_string(target.pending_records) + " AER event(s)";
+        if (uncorrectable) {
+            line += target.pending_fatal ? "; uncorrectable (fatal):" : "; uncorrectable:";
+            AppendCounts(line, target.pending_uncorrectable, &PciAerCollector::UncorrectableName);
+        }
+        bool correctable = false;
+        for (auto count : target.pending_correctable) {
+            correctable |= count != 0;
+        }
+        if (correctable) {
+            line += "; correctable:";
+            AppendCounts(line, target.pending_correctable, &PciAerCollector::CorrectableName);
+        }
+        if (uncorrectable) {
+            PLAS_LOG_ERROR(line);
+        } else {
+            PLAS_LOG_WARN(line);
+        }
+        target.pending_uncorrectable.fill(0);
+        target.pending_correctable.fill(0);
+        target.pending_records = 0;
+        target.pending_fatal = false;
+        target.last_report = now;
+    }
+
+    void ReportDropsLocked() {
+        uint64_t dropped = ring.Dropped();
+        if (options.report_interval.count() != 0 && dropped != reported_drops) {
+            PLAS_LOG_WARN("PciAerCollector: " + std::to_string(dropped - reported_drops) +
+                          " record(s) dropped, ring full");
+            reported_drops = dropped;
+        }
+    }
+
+    PciAerCollectorOptions options;
+    core::SpscRing<PciAerRecord> ring;
+
+    mutable std::mutex poll_mutex;  // the ring's producer side; targets
+    std::vector<Target> targets;
+    uint64_t reported_drops = 0;
+};
+
+PciAerCollector::PciAerCollector(PciAerCollectorOptions options)
+    : impl_(std::make_unique<Impl>(options)) {}
+
+PciAerCollector::~PciAerCollector() = default;
+
+core::Result<uint32_t> PciAerCollector::AddDevice(PciConfig& config, Bdf bdf) {
+    char name[Bdf::kStringLength];
+    return impl_->Add(
+        std::string(name, bdf.ToChars(name)), [&config, bdf] { return config.GetCapabilityIndex(bdf); },
+        [&config, bdf](ConfigOffset offset, core::Byte* buffer, std::size_t length) {
+            return config.ReadConfigBlock(bdf, offset, buffer, length);
+        },
+        [&config, bdf](const ConfigWrite* writes, std::size_t count, std::error_code* status) {
+            return config.WriteConfigBatch(bdf, writes, count, status);
+        });
+}
+
+core::Result<uint32_t> PciAerCollector::AddDevice(PciDevice& device) {
+    return impl_->Add(
+        device.AddressString(), [&device] { return device.GetCapabilityIndex(); },
+        [&device](ConfigOffset offset, core::Byte* buffer, std::size_t length) {
+            return device.ReadConfigBlock(offset, buffer, length);
+        },
+        [&device](const ConfigWrite* writes, std::size_t count, std::error_code* status) {
+            return device.WriteConfigBatch(writes, count, status);
+        });
+}
+
+std::size_t PciAerCollector::DeviceCount() const {
+    std::lock_guard<std::mutex> lock(impl_->poll_mutex);
+    return impl_->targets.size();
+}
+
+std::size_t PciAerCollector::Poll() {
+    std::lock_guard<std::mutex> lock(impl_->poll_mutex);
+    std::size_t records = 0;
+    for (std::size_t i = 0; i < impl_->targets.size(); ++i) {
+        records += impl_->PollLocked(static_cast<uint32_t>(i), impl_->targets[i]) ? 1u : 0u;
+    }
+    auto now = std::chrono::steady_clock::now();
+    for (auto& target : impl_->targets) {
+        impl_->ReportLocked(target, now, false);
+    }
+    impl_->ReportDropsLocked();
+    return records;
+}
+
+void PciAerCollector::FlushReports() {
+    std::lock_guard<std::mutex> lock(impl_->poll_mutex);
+    auto now = std::chrono::steady_clock::now();
+    for (auto& target : impl_->targets) {
+        impl_->ReportLocked(target, now, true);
+    }
+    impl_->ReportDropsLocked();
+}
+
+std::size_t PciAerCollector::Pop(PciAerRecord* out, std::size_t max) {
+    return impl_->ring.Pop(out, max);
+}
+
+uint64_t PciAerCollector::Dropped() const {
+    return impl_->ring.Dropped();
+}
+
+core::Result<PciAerCounters> PciAerCollector::GetCounters(uint32_t device) const {
+    std::lock_guard<std::mutex> lock(impl_->poll_mutex);
+    if (device >= impl_->targets.size()) {
+        return core::Result<PciAerCounters>::Err(core::ErrorCode::kOutOfRange);
+    }
+    return core::Result<PciAerCounters>::Ok(impl_->targets[device].counters);
+}
+
+const char* PciAerCollector::UncorrectableName(unsigned bit) {
+    return bit < 32 ? kUncorrectableNames[bit] : nullptr;
+}
+
+const char* PciAerCollector::CorrectableName(unsigned bit) {
+    return bit < 32 ? kCorrectableNames[bit] : nullptr;
+}
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,116 @@
+#include "plas/hal/interface/pci/pci_config_batch.h"
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/pci_device.h"
+
+namespace plas::hal::pci {
+
+PciConfigBatch::PciConfigBatch(PciConfig& config, Bdf bdf)
+    : write_([&config, bdf](const ConfigWrite* writes, std::size_t count,
+                            std::error_code* status) {
+          return config.WriteConfigBatch(bdf, writes, count, status);
+      }),
+      read_([&config, bdf](ConfigOffset offset) { return config.ReadConfig32(bdf, offset); }) {}
+
+PciConfigBatch::PciConfigBatch(PciDevice& device)
+    : write_([&device](const ConfigWrite* writes, std::size_t count, std::error_code* status) {
+          return device.WriteConfigBatch(writes, count, status);
+      }),
+      read_([&device](ConfigOffset offset) { return device.ReadConfig32(offset); }) {}
+
+std::size_t PciConfigBatch::Queue(ConfigOffset offset, uint8_t width, core::DWord value,
+                                  bool read) {
+    Op op;
+    op.access = ConfigWrite{offset, width, value};
+    op.read = read;
+    op.status = core::make_error_code(core::ErrorCode::kBusy);
+    ops_.push_back(op);
+    return ops_.size() - 1;
+}
+
+std::size_t PciConfigBatch::Write8(ConfigOffset offset, core::Byte value) {
+    return Queue(offset, 1, value, false);
+}
+
+std::size_t PciConfigBatch::Write16(ConfigOffset offset, core::Word value) {
+    return Queue(offset, 2, value, false);
+}
+
+std::size_t PciConfigBatch::Write32(ConfigOffset offset, core::DWord value) {
+    return Queue(offset, 4, value, false);
+}
+
+std::size_t PciConfigBatch::Read32(ConfigOffset offset) {
+    return Queue(offset, 4, 0, true);
+}
+
+core::Result<void> PciConfigBatch::Flush() {
+    std::error_code failure;
+    std::size_t i = flushed_;
+    while (i < ops_.size() && !failure) {
+        if (ops_[i].read) {
+            auto r = read_(ops_[i].access.offset);
+            if (r.IsError()) {
+                failure = r.Error();
+                ops_[i].status = failure;
+            } else {
+                ops_[i].status = {};
+                ops_[i].value = r.Value();
+            }
+            ++i;
+            continue;
+        }
+
+        std::size_t end = i;
+        run_.clear();
+        while (end < ops_.size() && !ops_[end].read) {
+            run_.push_back(ops_[end].access);
+            ++end;
+        }
+        run_status_.assign(run_.size(), std::error_code{});
+        std::size_t done = write_(run_.data(), run_.size(), run_status_.data());
+        for (std::size_t k = 0; k < run_.size(); ++k) {
+            ops_[i + k].status = run_status_[k];
+        }
+        if (done < run_.size()) {
+            failure = run_status_[done];
+        }
+        i = end;
+    }
+    for (; i < ops_.size(); ++i) {
+        ops_[i].status = core::make_error_code(core::ErrorCode::kCancelled);
+    }
+    flushed_ = ops_.size();
+    if (failure) {
+        return core::Result<void>::Err(failure);
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> PciConfigBatch::Status(std::size_t index) const {
+    if (index >= ops_.size()) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+    if (ops_[index].status) {
+        return core::Result<void>::Err(ops_[index].status);
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<core::DWord> PciConfigBatch::Value(std::size_t index) const {
+    auto status = Status(index);
+    if (status.IsError()) {
+        return core::Result<core::DWord>::Err(status.Error());
+    }
+    if (!ops_[index].read) {
+        return core::Result<core::DWord>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    return core::Result<core::DWord>::Ok(ops_[index].value);
+}
+
+void PciConfigBatch::Clear() {
+    ops_.clear();
+    flushed_ = 0;
+}
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,470 @@
+#include "plas/hal/interface/pci/pci_config_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "plas/core/error.h"
+
+namespace plas::hal::pci {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kDWords = kConfigSpaceSize / 4;
+
+ConfigOffset AlignDown(std::size_t offset) {
+    return static_cast<ConfigOffset>(offset & ~std::size_t{3});
+}
+
+}  // namespace
+
+struct PciConfigCache::Impl {
+    struct Entry {
+        core::DWord value;
+        Clock::time_point fetched;
+    };
+
+    struct Function {
+        std::unordered_map<uint16_t, Entry> dwords;  ///< by DWord index
+        std::map<CapabilityId, std::optional<ConfigOffset>> capabilities;
+        std::map<ExtCapabilityId, std::optional<ConfigOffset>> ext_capabilities;
+        std::optional<CapabilityIndex> index;
+        /// Bumped by every write and invalidation, so a read that raced
+        /// one does not store what it fetched before it.
+        uint64_t generation = 0;
+    };
+
+    mutable std::mutex mutex;
+    std::vector<CacheRange> ranges;
+    /// Index into `ranges` of the range governing each byte; -1 = kNever.
+    std::array<int16_t, kConfigSpaceSize> slot;
+    std::unordered_map<uint16_t, Function> functions;  ///< by Bdf::Pack()
+    PciConfigCacheStats stats;
+
+    explicit Impl(std::vector<CacheRange> initial) {
+        slot.fill(-1);
+        for (auto& range : initial) {
+            AddRange(range);
+        }
+    }
+
+    bool AddRange(const CacheRange& range) {
+        if (range.offset >= kConfigSpaceSize ||
+            range.length > kConfigSpaceSize - range.offset || ranges.size() >= INT16_MAX) {
+            return false;
+        }
+        ranges.push_back(range);
+        auto index = static_cast<int16_t>(ranges.size() - 1);
+        for (std::size_t i = range.offset; i < range.offset + range.length; ++i) {
+            slot[i] = range.policy == CachePolicy::kNever ? int16_t{-1} : index;
+        }
+        return true;
+    }
+
+    const CacheRange* RangeAt(std::size_t offset) const {
+        return slot[offset] < 0 ? nullptr : &ranges[static_cast<std::size_t>(slot[offset])];
+    }
+
+    bool Cacheable(std::size_t offset) const { return slot[offset] >= 0; }
+
+    /// Any byte of the DWord at `dword` cacheable.
+    bool DWordCacheable(std::size_t dword) const {
+        for (std::size_t i = dword * 4; i < dword * 4 + 4; ++i) {
+            if (Cacheable(i)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool DWordUntilWrite(std::size_t dword) const {
+        for (std::size_t i = dword * 4; i < dword * 4 + 4; ++i) {
+            const auto* range = RangeAt(i);
+            if (range && range->policy == CachePolicy::kUntilWrite) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// The cached DWord holding `offset`, if still valid for the policy of
+    /// each byte in [offset, offset + length).
+    const Entry* Lookup(const Function& fn, std::size_t offset, std::size_t length,
+                        Clock::time_point now) const {
+        auto it = fn.dwords.find(static_cast<uint16_t>(offset / 4));
+        if (it == fn.dwords.end()) {
+            return nullptr;
+        }
+        for (std::size_t i = offset; i < offset + length; ++i) {
+            const auto* range = RangeAt(i);
+            if (!range) {
+                return nullptr;
+            }
+            if (range->policy == CachePolicy::kTtl && now - it->second.fetched >= range->ttl) {
+                return nullptr;
+            }
+        }
+        return &it->second;
+    }
+
+    void Store(uint16_t bdf, uint64_t generation, std::size_t dword, core::DWord value,
+               Clock::time_point fetched) {
+        auto& fn = functions[bdf];
+        if (fn.generation == generation) {
+            fn.dwords[static_cast<uint16_t>(dword)] = Entry{value, fetched};
+        }
+    }
+
+    /// Whether a typed read of `width` bytes at `offset` goes to the cache;
+    /// counts it as bypassed if not. Takes the lock.
+    bool Routed(std::size_t offset, std::size_t width) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (std::size_t i = offset; i < offset + width; ++i) {
+            if (!Cacheable(i)) {
+                ++stats.bypassed;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Drop(Function& fn) {
+        stats.invalidations += fn.dwords.size();
+        fn.dwords.clear();
+        fn.capabilities.clear();
+        fn.ext_capabilities.clear();
+        fn.index.reset();
+        ++fn.generation;
+    }
+};
+
+std::vector<CacheRange> PciConfigCache::DefaultRanges() {
+    return {
+        {0x00, 4, CachePolicy::kImmutable},   // Vendor ID, Device ID
+        {0x08, 4, CachePolicy::kImmutable},   // Revision ID, Class Code
+        {0x0E, 1, CachePolicy::kImmutable},   // Header Type
+        {0x10, 24, CachePolicy::kUntilWrite}, // BAR0-5 (type 1: BAR0-1, bus numbers, I/O)
+        {0x2C, 4, CachePolicy::kImmutable},   // Subsystem Vendor ID, Subsystem ID
+        {0x34, 1, CachePolicy::kImmutable},   // Capabilities Pointer
+    };
+}
+
+PciConfigCache::PciConfigCache(PciConfig& backend, std::vector<CacheRange> ranges)
+    : backend_(backend), impl_(std::make_unique<Impl>(std::move(ranges))) {}
+
+PciConfigCache::~PciConfigCache() = default;
+
+core::Result<void> PciConfigCache::SetPolicy(CacheRange range) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (!impl_->AddRange(range)) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+    if (range.policy == CachePolicy::kNever && range.length > 0) {
+        for (auto& [bdf, fn] : impl_->functions) {
+            for (std::size_t d = range.offset / 4; d <= (range.offset + range.length - 1u) / 4;
+                 ++d) {
+                if (!impl_->DWordCacheable(d)) {
+                    impl_->stats.invalidations += fn.dwords.erase(static_cast<uint16_t>(d));
+                }
+            }
+        }
+    }
+    return core::Result<void>::Ok();
+}
+
+void PciConfigCache::Invalidate(Bdf bdf) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto it = impl_->functions.find(bdf.Pack());
+    if (it != impl_->functions.end()) {
+        impl_->Drop(it->second);
+    }
+}
+
+void PciConfigCache::InvalidateAll() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    for (auto& entry : impl_->functions) {
+        impl_->Drop(entry.second);
+    }
+}
+
+PciConfigCacheStats PciConfigCache::Stats() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->stats;
+}
+
+void PciConfigCache::ResetStats() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->stats = {};
+}
+
+// ---------------------------------------------------------------------------
+// Reads
+// ---------------------------------------------------------------------------
+
+core::Result<core::DWord> PciConfigCache::ReadDWord(Bdf bdf, ConfigOffset offset,
+                                                   std::size_t width) {
+    const uint16_t key = bdf.Pack();
+    const ConfigOffset aligned = AlignDown(offset);
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        auto& fn = impl_->functions[key];
+        if (const auto* entry = impl_->Lookup(fn, offset, width, Clock::now())) {
+            ++impl_->stats.hits;
+            return core::Result<core::DWord>::Ok(entry->value);
+        }
+        ++impl_->stats.misses;
+        generation = fn.generation;
+    }
+    const auto fetched = Clock::now();
+    auto r = backend_.ReadConfig32(bdf, aligned);
+    if (r.IsOk()) {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        impl_->Store(key, generation, aligned / 4u, r.Value(), fetched);
+    }
+    return r;
+}
+
+// Accesses that are out of range or cross a DWord are left to the backend
+// to reject.
+
+core::Result<core::Byte> PciConfigCache::ReadConfig8(Bdf bdf, ConfigOffset offset) {
+    if (offset >= kConfigSpaceSize || !impl_->Routed(offset, 1)) {
+        return backend_.ReadConfig8(bdf, offset);
+    }
+    auto r = ReadDWord(bdf, offset, 1);
+    if (r.IsError()) {
+        return core::Result<core::Byte>::Err(r.Error());
+    }
+    return core::Result<core::Byte>::Ok(static_cast<core::Byte>(r.Value() >> (8 * (offset & 3))));
+}
+
+core::Result<core::Word> PciConfigCache::ReadConfig16(Bdf bdf, ConfigOffset offset) {
+    if ((offset & 1) != 0 || offset >= kConfigSpaceSize || !impl_->Routed(offset, 2)) {
+        return backend_.ReadConfig16(bdf, offset);
+    }
+    auto r = ReadDWord(bdf, offset, 2);
+    if (r.IsError()) {
+        return core::Result<core::Word>::Err(r.Error());
+    }
+    return core::Result<core::Word>::Ok(static_cast<core::Word>(r.Value() >> (8 * (offset & 3))));
+}
+
+core::Result<core::DWord> PciConfigCache::ReadConfig32(Bdf bdf, ConfigOffset offset) {
+    if ((offset & 3) != 0 || offset >= kConfigSpaceSize || !impl_->Routed(offset, 4)) {
+        return backend_.ReadConfig32(bdf, offset);
+    }
+    return ReadDWord(bdf, offset, 4);
+}
+
+core::Result<void> PciConfigCache::ReadConfigBlock(Bdf bdf, ConfigOffset offset,
+                                                   core::Byte* buffer, std::size_t length) {
+    if (length == 0) {
+        return core::Result<void>::Ok();
+    }
+    if (!buffer) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (offset >= kConfigSpaceSize || length > kConfigSpaceSize - offset) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+
+    const uint16_t key = bdf.Pack();
+    const std::size_t end = std::size_t{offset} + length;
+    const std::size_t first = offset / 4u;
+    const std::size_t last = (end - 1) / 4;
+
+    // Copy what the cache holds; note the DWords that must be fetched.
+    std::vector<bool> fetch(last - first + 1, false);
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        auto& fn = impl_->functions[key];
+        generation = fn.generation;
+        const auto now = Clock::now();
+        for (std::size_t d = first; d <= last; ++d) {
+            const std::size_t lo = std::max(d * 4, std::size_t{offset});
+            const std::size_t hi = std::min(d * 4 + 4, end);
+            if (const auto* entry = impl_->Lookup(fn, lo, hi - lo, now)) {
+                ++impl_->stats.hits;
+                for (std::size_t i = lo; i < hi; ++i) {
+                    buffer[i - offset] = static_cast<core::Byte>(entry->value >> (8 * (i & 3)));
+                }
+            } else {
+                fetch[d - first] = true;
+                ++(impl_->DWordCacheable(d) ? impl_->stats.misses : impl_->stats.bypassed);
+            }
+        }
+    }
+
+    // One backend block read per run of missing DWords.
+    for (std::size_t d = first; d <= last;) {
+        if (!fetch[d - first]) {
+            ++d;
+            continue;
+        }
+        std::size_t run_end = d;
+        while (run_end <= last && fetch[run_end - first]) {
+            ++run_end;
+        }
+        const std::size_t lo = std::max(d * 4, std::size_t{offset});
+        const std::size_t hi = std::min(run_end * 4, end);
+        const auto fetched = Clock::now();
+        auto r = backend_.ReadConfigBlock(bdf, static_cast<ConfigOffset>(lo),
+                                          buffer + (lo - offset), hi - lo);
+        if (r.IsError()) {
+            return r;
+        }
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        for (std::size_t k = d; k < run_end; ++k) {
+            if (k * 4 < lo || k * 4 + 4 > hi || !impl_->DWordCacheable(k)) {
+                continue;  // partially read or never cached
+            }
+            const core::Byte* bytes = buffer + (k * 4 - offset);
+            core::DWord value = static_cast<core::DWord>(bytes[0]) |
+                                (static_cast<core::DWord>(bytes[1]) << 8) |
+                                (static_cast<core::DWord>(bytes[2]) << 16) |
+                                (static_cast<core::DWord>(bytes[3]) << 24);
+            impl_->Store(key, generation, k, value, fetched);
+        }
+        d = run_end;
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<std::optional<ConfigOffset>> PciConfigCache::FindCapability(Bdf bdf,
+                                                                         CapabilityId id) {
+    using R = core::Result<std::optional<ConfigOffset>>;
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        auto& fn = impl_->functions[bdf.Pack()];
+        auto it = fn.capabilities.find(id);
+        if (it != fn.capabilities.end()) {
+            ++impl_->stats.hits;
+            return R::Ok(it->second);
+        }
+        ++impl_->stats.misses;
+        generation = fn.generation;
+    }
+    auto r = backend_.FindCapability(bdf, id);
+    if (r.IsOk()) {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        auto& fn = impl_->functions[bdf.Pack()];
+        if (fn.generation == generation) {
+            fn.capabilities[id] = r.Value();
+        }
+    }
+    return r;
+}
+
+core::Result<std::optional<ConfigOffset>> PciConfigCache::FindExtCapability(
+    Bdf bdf, ExtCapabilityId id) {
+    using R = core::Result<std::optional<ConfigOffset>>;
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        auto& fn = impl_->functions[bdf.Pack()];
+        auto it = fn.ext_capabilities.find(id);
+        if (it != fn.ext_capabilities.end()) {
+            ++impl_->stats.hits;
+            return R::Ok(it->second);
+        }
+        ++impl_->stats.misses;
+        generation = fn.generation;
+    }
+    auto r = backend_.FindExtCapability(bdf, id);
+    if (r.IsOk()) {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        auto& fn = impl_->functions[bdf.Pack()];
+        if (fn.generation == generation) {
+            fn.ext_capabilities[id] = r.Value();
+        }
+    }
+    return r;
+}
+
+core::Result<CapabilityIndex> PciConfigCache::GetCapabilityIndex(Bdf bdf) {
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        auto& fn = impl_->functions[bdf.Pack()];
+        if (fn.index) {
+            ++impl_->stats.hits;
+            return core::Result<CapabilityIndex>::Ok(*fn.index);
+        }
+        ++impl_->stats.misses;
+        generation = fn.generation;
+    }
+    auto r = backend_.GetCapabilityIndex(bdf);
+    if (r.IsOk()) {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        auto& fn = impl_->functions[bdf.Pack()];
+        if (fn.generation == generation) {
+            fn.index = r.Value();
+        }
+    }
+    return r;
+}
+
+// ---------------------------------------------------------------------------
+// Writes
+// ---------------------------------------------------------------------------
+
+void PciConfigCache::AfterWrite(Bdf bdf, ConfigOffset offset, std::size_t length) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto it = impl_->functions.find(bdf.Pack());
+    if (it == impl_->functions.end()) {
+        return;
+    }
+    auto& fn = it->second;
+    ++fn.generation;
+    const std::size_t first = offset / 4u;
+    const std::size_t last = std::min((std::size_t{offset} + length - 1) / 4, kDWords - 1);
+    for (auto d = fn.dwords.begin(); d != fn.dwords.end();) {
+        if ((d->first >= first && d->first <= last) || impl_->DWordUntilWrite(d->first)) {
+            d = fn.dwords.erase(d);
+            ++impl_->stats.invalidations;
+        } else {
+            ++d;
+        }
+    }
+}
+
+core::Result<void> PciConfigCache::WriteConfig8(Bdf bdf, ConfigOffset offset,
+                                                core::Byte value) {
+    auto r = backend_.WriteConfig8(bdf, offset, value);
+    AfterWrite(bdf, offset, 1);
+    return r;
+}
+
+core::Result<void> PciConfigCache::WriteConfig16(Bdf bdf, ConfigOffset offset,
+                                                 core::Word value) {
+    auto r = backend_.WriteConfig16(bdf, offset, value);
+    AfterWrite(bdf, offset, 2);
+    return r;
+}
+
+core::Result<void> PciConfigCache::WriteConfig32(Bdf bdf, ConfigOffset offset,
+                                                 core::DWord value) {
+    auto r = backend_.WriteConfig32(bdf, offset, value);
+    AfterWrite(bdf, offset, 4);
+    return r;
+}
+
+std::size_t PciConfigCache::WriteConfigBatch(Bdf bdf, const ConfigWrite* writes,
+                                             std::size_t count, std::error_code* status) {
+    std::size_t done = backend_.WriteConfigBatch(bdf, writes, count, status);
+    // The failed write may have reached the device too.
+    for (std::size_t i = 0; i < std::min(done + 1, count); ++i) {
+        AfterWrite(bdf, writes[i].offset, std::max<std::size_t>(writes[i].width, 1));
+    }
+    return done;
+}
+
+}  // namespace plas::hal::pci
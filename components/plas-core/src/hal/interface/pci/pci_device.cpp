@@ -1,16 +1,17 @@
 #include "plas/hal/interface/pci/pci_device.h"
 
+#include <array>
 #include <cstring>
-#include <fstream>
-#include <sstream>
-#include <unordered_map>
 
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include "plas/core/batch_io.h"
 #include "plas/core/error.h"
+#include "plas/hal/interface/pci/ecam.h"
 
 namespace plas::hal::pci {
 
@@ -22,17 +23,27 @@ struct MappedBar {
     int fd = -1;
     void* base = nullptr;
     uint64_t size = 0;
+    BarMapping mapping = BarMapping::kUncached;
 };
 
+
 struct PciDevice::Impl {
     PciDeviceNode info;
     int config_fd = -1;
-    std::unordered_map<uint8_t, MappedBar> mapped_bars;
+    volatile uint8_t* ecam = nullptr;  // 4 KiB ECAM window (ConfigAccess::kEcam)
+    std::array<MappedBar, kBarCount> mapped_bars{};  // base == nullptr: not mapped
+    std::array<BarMapping, kBarCount> bar_mappings{};  // default kUncached
+    std::optional<BarResources> bar_resources;
+    uint64_t bar_resources_generation = 0;  // PciTopology generation at read
+    std::optional<CapabilityIndex> cap_index;
+    std::optional<CxlDvsecIndex> cxl_index;  // built with cap_index
+    uint64_t cap_index_generation = 0;  // PciTopology generation at build time
 
     explicit Impl(PciDeviceNode&& node) : info(std::move(node)) {}
 
     ~Impl() {
         UnmapAllBars();
+        UnmapEcam();
         CloseConfigFd();
     }
 
@@ -65,45 +76,174 @@ struct PciDevice::Impl {
         }
     }
 
-    // -- BAR mmap --
+    // -- ECAM --
+
+    core::Result<void> MapEcam() {
+        auto region = Ecam::FindRegion(info.address);
+        if (region.IsError()) {
+            return core::Result<void>::Err(region.Error());
+        }
+        int fd = ::open(Ecam::GetMemoryPath().c_str(), O_RDWR | O_SYNC);
+        if (fd < 0) {
+            return core::Result<void>::Err(core::ErrorCode::kPermissionDenied);
+        }
+        void* base = ::mmap(
+            nullptr, kConfigSpaceSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+            static_cast<off_t>(region.Value().ConfigAddress(info.address)));
+        ::close(fd);  // the mapping keeps its own reference
+        if (base == MAP_FAILED) {
+            return core::Result<void>::Err(core::ErrorCode::kIOError);
+        }
+        ecam = static_cast<volatile uint8_t*>(base);
+        return core::Result<void>::Ok();
+    }
+
+    void UnmapEcam() {
+        if (ecam) {
+            ::munmap(const_cast<uint8_t*>(ecam), kConfigSpaceSize);
+            ecam = nullptr;
+        }
+    }
+
+    // ECAM requires naturally aligned accesses; anything else returns false
+    // and the caller falls back to sysfs.
+    template <typename T>
+    bool EcamRead(ConfigOffset offset, T& value) const {
+        if (!ecam || offset % sizeof(T) != 0 ||
+            offset + sizeof(T) > kConfigSpaceSize) {
+            return false;
+        }
+        value = *reinterpret_cast<const volatile T*>(ecam + offset);
+        return true;
+    }
 
-    uint64_t GetBarSize(uint8_t bar_index) {
-        std::ifstream resource(info.sysfs_path + "/resource");
-        if (!resource.is_open()) {
-            return 0;
+    template <typename T>
+    bool EcamWrite(ConfigOffset offset, T value) {
+        if (!ecam || offset % sizeof(T) != 0 ||
+            offset + sizeof(T) > kConfigSpaceSize) {
+            return false;
         }
-        std::string line;
-        for (uint8_t i = 0; i <= bar_index; ++i) {
-            if (!std::getline(resource, line)) {
-                return 0;
+        *reinterpret_cast<volatile T*>(ecam + offset) = value;
+        return true;
+    }
+
+    /// Copy [offset, offset + length) out of the window; caller checked the
+    /// range. Uses dword loads when the range is dword aligned.
+    void EcamReadBlock(std::size_t offset, core::Byte* buffer,
+                       std::size_t length) const {
+        if (offset % 4 == 0 && length % 4 == 0) {
+            for (std::size_t i = 0; i < length; i += 4) {
+                uint32_t dword =
+                    *reinterpret_cast<const volatile uint32_t*>(ecam + offset + i);
+                std::memcpy(buffer + i, &dword, sizeof(dword));
             }
+            return;
+        }
+        for (std::size_t i = 0; i < length; ++i) {
+            buffer[i] = ecam[offset + i];
+        }
+    }
+
+    core::Result<std::vector<core::Byte>> ReadSnapshot() {
+        if (ecam) {
+            std::vector<core::Byte> data(kConfigSpaceSize);
+            EcamReadBlock(0, data.data(), data.size());
+            return core::Result<std::vector<core::Byte>>::Ok(std::move(data));
+        }
+        auto fd_result = EnsureConfigFd();
+        if (fd_result.IsError()) {
+            return core::Result<std::vector<core::Byte>>::Err(
+                fd_result.Error());
+        }
+        std::vector<core::Byte> data(kConfigSpaceSize);
+        auto n = ::pread(config_fd, data.data(), data.size(), 0);
+        if (n <= 0) {
+            return core::Result<std::vector<core::Byte>>::Err(
+                core::ErrorCode::kIOError);
+        }
+        data.resize(static_cast<std::size_t>(n));
+        return core::Result<std::vector<core::Byte>>::Ok(std::move(data));
+    }
+
+    // -- capability index --
+
+    core::Result<const CapabilityIndex*> EnsureCapabilityIndex() {
+        uint64_t generation = PciTopology::GetTopologyGeneration();
+        if (cap_index && cap_index_generation == generation) {
+            return core::Result<const CapabilityIndex*>::Ok(&*cap_index);
+        }
+        auto snapshot = ReadSnapshot();
+        if (snapshot.IsError()) {
+            return core::Result<const CapabilityIndex*>::Err(
+                snapshot.Error());
+        }
+        const auto& data = snapshot.Value();
+        // Unprivileged sysfs reads stop at 64 bytes; an index built from
+        // that would silently miss every capability.
+        if (data.size() < kLegacyConfigSpaceSize) {
+            return core::Result<const CapabilityIndex*>::Err(
+                core::ErrorCode::kIOError);
         }
-        uint64_t start = 0, end = 0, flags = 0;
-        std::istringstream iss(line);
-        iss >> std::hex >> start >> end >> flags;
-        if (end == 0 || end < start) {
-            return 0;
+        cap_index = CapabilityIndex::Parse(data.data(), data.size());
+        cxl_index = CxlDvsecIndex::Parse(data.data(), data.size(), *cap_index);
+        cap_index_generation = generation;
+        return core::Result<const CapabilityIndex*>::Ok(&*cap_index);
+    }
+
+    /// CXL DVSECs, parsed from the same snapshot as the capability index.
+    core::Result<const CxlDvsecIndex*> EnsureCxlDvsecIndex() {
+        auto index_result = EnsureCapabilityIndex();
+        if (index_result.IsError()) {
+            return core::Result<const CxlDvsecIndex*>::Err(
+                index_result.Error());
+        }
+        return core::Result<const CxlDvsecIndex*>::Ok(&*cxl_index);
+    }
+
+    // -- BAR mmap --
+
+    /// The device's parsed sysfs `resource` file, read once and re-read
+    /// only after a PciTopology remove/rescan. All zero if unreadable.
+    const BarResources& GetBarResources() {
+        uint64_t generation = PciTopology::GetTopologyGeneration();
+        if (!bar_resources || bar_resources_generation != generation) {
+            auto result = ReadBarResources(info.sysfs_path);
+            bar_resources = result.IsOk() ? result.Value() : BarResources{};
+            bar_resources_generation = generation;
         }
-        return end - start + 1;
+        return *bar_resources;
+    }
+
+    std::string BarResourcePath(uint8_t bar_index, BarMapping mapping) const {
+        std::string path =
+            info.sysfs_path + "/resource" + std::to_string(bar_index);
+        if (mapping == BarMapping::kWriteCombining) {
+            path += "_wc";
+        }
+        return path;
+    }
+
+    BarMapping RequestedMapping(uint8_t bar_index) const {
+        return bar_index < kBarCount ? bar_mappings[bar_index] : BarMapping::kUncached;
     }
 
     core::Result<MappedBar*> EnsureBarMapped(uint8_t bar_index) {
-        if (bar_index > 5) {
+        if (bar_index >= kBarCount) {
             return core::Result<MappedBar*>::Err(
                 core::ErrorCode::kInvalidArgument);
         }
-        auto it = mapped_bars.find(bar_index);
-        if (it != mapped_bars.end()) {
-            return core::Result<MappedBar*>::Ok(&it->second);
+        MappedBar& slot = mapped_bars[bar_index];
+        if (slot.base != nullptr) {
+            return core::Result<MappedBar*>::Ok(&slot);
         }
 
-        uint64_t size = GetBarSize(bar_index);
+        uint64_t size = GetBarResources()[bar_index].Size();
         if (size == 0) {
             return core::Result<MappedBar*>::Err(core::ErrorCode::kNotFound);
         }
 
-        std::string resource_path =
-            info.sysfs_path + "/resource" + std::to_string(bar_index);
+        BarMapping mapping = RequestedMapping(bar_index);
+        std::string resource_path = BarResourcePath(bar_index, mapping);
         int fd = ::open(resource_path.c_str(), O_RDWR | O_SYNC);
         if (fd < 0) {
             return core::Result<MappedBar*>::Err(
@@ -117,24 +257,33 @@ struct PciDevice::Impl {
             return core::Result<MappedBar*>::Err(core::ErrorCode::kIOError);
         }
 
-        MappedBar bar;
-        bar.fd = fd;
-        bar.base = base;
-        bar.size = size;
-        auto [inserted, _] = mapped_bars.emplace(bar_index, bar);
-        return core::Result<MappedBar*>::Ok(&inserted->second);
+        slot.fd = fd;
+        slot.base = base;
+        slot.size = size;
+        slot.mapping = mapping;
+        return core::Result<MappedBar*>::Ok(&slot);
+    }
+
+    static void UnmapBar(MappedBar& bar) {
+        if (bar.base && bar.base != MAP_FAILED) {
+            ::munmap(bar.base, static_cast<std::size_t>(bar.size));
+        }
+        if (bar.fd >= 0) {
+            ::close(bar.fd);
+        }
+    }
+
+    void UnmapBar(uint8_t bar_index) {
+        if (bar_index < kBarCount && mapped_bars[bar_index].base != nullptr) {
+            UnmapBar(mapped_bars[bar_index]);
+            mapped_bars[bar_index] = MappedBar{};
+        }
     }
 
     void UnmapAllBars() {
-        for (auto& [idx, bar] : mapped_bars) {
-            if (bar.base && bar.base != MAP_FAILED) {
-                ::munmap(bar.base, static_cast<std::size_t>(bar.size));
-            }
-            if (bar.fd >= 0) {
-                ::close(bar.fd);
-            }
+        for (uint8_t i = 0; i < kBarCount; ++i) {
+            UnmapBar(i);
         }
-        mapped_bars.clear();
     }
 };
 
@@ -155,21 +304,29 @@ PciDevice& PciDevice::operator=(PciDevice&& other) noexcept = default;
 // Factory
 // ---------------------------------------------------------------------------
 
-core::Result<PciDevice> PciDevice::Open(const PciAddress& addr) {
+core::Result<PciDevice> PciDevice::Open(const PciAddress& addr,
+                                        ConfigAccess access) {
     auto info_result = PciTopology::GetDeviceInfo(addr);
     if (info_result.IsError()) {
         return core::Result<PciDevice>::Err(info_result.Error());
     }
-    return core::Result<PciDevice>::Ok(
-        PciDevice(std::move(info_result.Value())));
+    PciDevice device(std::move(info_result.Value()));
+    if (access != ConfigAccess::kSysfs) {
+        auto ecam_result = device.impl_->MapEcam();
+        if (ecam_result.IsError() && access == ConfigAccess::kEcam) {
+            return core::Result<PciDevice>::Err(ecam_result.Error());
+        }
+    }
+    return core::Result<PciDevice>::Ok(std::move(device));
 }
 
-core::Result<PciDevice> PciDevice::Open(const std::string& addr_str) {
+core::Result<PciDevice> PciDevice::Open(const std::string& addr_str,
+                                        ConfigAccess access) {
     auto addr_result = PciAddress::FromString(addr_str);
     if (addr_result.IsError()) {
         return core::Result<PciDevice>::Err(addr_result.Error());
     }
-    return Open(addr_result.Value());
+    return Open(addr_result.Value(), access);
 }
 
 // ---------------------------------------------------------------------------
@@ -196,16 +353,44 @@ const std::string& PciDevice::SysfsPath() const {
     return impl_->info.sysfs_path;
 }
 
+ConfigAccess PciDevice::GetConfigAccess() const {
+    return impl_->ecam ? ConfigAccess::kEcam : ConfigAccess::kSysfs;
+}
+
+int PciDevice::NumaNode() const {
+    return impl_->info.numa_node;
+}
+
+const std::vector<int>& PciDevice::LocalCpus() const {
+    return impl_->info.local_cpus;
+}
+
+core::Executor& PciDevice::LocalExecutor() const {
+    return core::Executor::ForCpus(impl_->info.local_cpus);
+}
+
+core::Result<core::NumaBuffer> PciDevice::AllocateLocalBuffer(std::size_t bytes,
+                                                              bool huge_pages) const {
+    return core::NumaBuffer::Allocate(bytes, impl_->info.numa_node, huge_pages);
+}
+
+core::Result<core::NumaBufferLease> PciDevice::AcquireLocalBuffer(std::size_t bytes) const {
+    return core::NumaBufferPool::Shared().Acquire(bytes, impl_->info.numa_node);
+}
+
 // ---------------------------------------------------------------------------
 // Config Space — reads
 // ---------------------------------------------------------------------------
 
 core::Result<core::Byte> PciDevice::ReadConfig8(ConfigOffset offset) {
+    core::Byte val = 0;
+    if (impl_->EcamRead(offset, val)) {
+        return core::Result<core::Byte>::Ok(val);
+    }
     auto fd_result = impl_->EnsureConfigFd();
     if (fd_result.IsError()) {
         return core::Result<core::Byte>::Err(fd_result.Error());
     }
-    core::Byte val = 0;
     auto n = ::pread(impl_->config_fd, &val, sizeof(val), offset);
     if (n != sizeof(val)) {
         return core::Result<core::Byte>::Err(core::ErrorCode::kIOError);
@@ -214,11 +399,14 @@ core::Result<core::Byte> PciDevice::ReadConfig8(ConfigOffset offset) {
 }
 
 core::Result<core::Word> PciDevice::ReadConfig16(ConfigOffset offset) {
+    core::Word val = 0;
+    if (impl_->EcamRead(offset, val)) {
+        return core::Result<core::Word>::Ok(val);
+    }
     auto fd_result = impl_->EnsureConfigFd();
     if (fd_result.IsError()) {
         return core::Result<core::Word>::Err(fd_result.Error());
     }
-    core::Word val = 0;
     auto n = ::pread(impl_->config_fd, &val, sizeof(val), offset);
     if (n != sizeof(val)) {
         return core::Result<core::Word>::Err(core::ErrorCode::kIOError);
@@ -227,11 +415,14 @@ core::Result<core::Word> PciDevice::ReadConfig16(ConfigOffset offset) {
 }
 
 core::Result<core::DWord> PciDevice::ReadConfig32(ConfigOffset offset) {
+    core::DWord val = 0;
+    if (impl_->EcamRead(offset, val)) {
+        return core::Result<core::DWord>::Ok(val);
+    }
     auto fd_result = impl_->EnsureConfigFd();
     if (fd_result.IsError()) {
         return core::Result<core::DWord>::Err(fd_result.Error());
     }
-    core::DWord val = 0;
     auto n = ::pread(impl_->config_fd, &val, sizeof(val), offset);
     if (n != sizeof(val)) {
         return core::Result<core::DWord>::Err(core::ErrorCode::kIOError);
@@ -239,12 +430,97 @@ core::Result<core::DWord> PciDevice::ReadConfig32(ConfigOffset offset) {
     return core::Result<core::DWord>::Ok(val);
 }
 
+core::Result<void> PciDevice::ReadConfigBlock(ConfigOffset offset,
+                                              core::Byte* buffer,
+                                              std::size_t length) {
+    if (length == 0) {
+        return core::Result<void>::Ok();
+    }
+    if (!buffer) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (offset >= kConfigSpaceSize || length > kConfigSpaceSize - offset) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+    if (impl_->ecam) {
+        impl_->EcamReadBlock(offset, buffer, length);
+        return core::Result<void>::Ok();
+    }
+    auto fd_result = impl_->EnsureConfigFd();
+    if (fd_result.IsError()) {
+        return core::Result<void>::Err(fd_result.Error());
+    }
+    auto n = ::pread(impl_->config_fd, buffer, length, offset);
+    if (n < 0 || static_cast<std::size_t>(n) != length) {
+        return core::Result<void>::Err(core::ErrorCode::kIOError);
+    }
+    return core::Result<void>::Ok();
+}
+
+std::vector<core::Result<void>> PciDevice::ReadConfigBlocks(
+    const PciConfigBlockRead* reads, std::size_t count) {
+    std::vector<core::Result<void>> results(count, core::Result<void>::Ok());
+    std::vector<core::BatchRead> batch;
+    std::vector<std::size_t> owners;  // index into reads of batch[k]
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& read = reads[i];
+        if (!read.device) {
+            results[i] = core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+            continue;
+        }
+        if (read.length == 0) {
+            continue;
+        }
+        if (!read.buffer) {
+            results[i] = core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+            continue;
+        }
+        if (read.offset >= kConfigSpaceSize ||
+            read.length > kConfigSpaceSize - read.offset) {
+            results[i] = core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+            continue;
+        }
+        auto& impl = *read.device->impl_;
+        if (impl.ecam) {
+            impl.EcamReadBlock(read.offset, read.buffer, read.length);
+            continue;
+        }
+        auto fd_result = impl.EnsureConfigFd();
+        if (fd_result.IsError()) {
+            results[i] = fd_result;
+            continue;
+        }
+        core::BatchRead entry;
+        entry.fd = impl.config_fd;
+        entry.offset = read.offset;
+        entry.buffer = read.buffer;
+        entry.length = read.length;
+        batch.push_back(std::move(entry));
+        owners.push_back(i);
+    }
+
+    core::BatchReader::ForThisThread().Read(batch);
+    for (std::size_t k = 0; k < batch.size(); ++k) {
+        if (batch[k].error || batch[k].transferred != batch[k].length) {
+            results[owners[k]] = core::Result<void>::Err(core::ErrorCode::kIOError);
+        }
+    }
+    return results;
+}
+
+core::Result<std::vector<core::Byte>> PciDevice::SnapshotConfig() {
+    return impl_->ReadSnapshot();
+}
+
 // ---------------------------------------------------------------------------
 // Config Space — writes
 // ---------------------------------------------------------------------------
 
 core::Result<void> PciDevice::WriteConfig8(ConfigOffset offset,
                                            core::Byte value) {
+    if (impl_->EcamWrite(offset, value)) {
+        return core::Result<void>::Ok();
+    }
     auto fd_result = impl_->EnsureConfigFd();
     if (fd_result.IsError()) {
         return core::Result<void>::Err(fd_result.Error());
@@ -258,6 +534,9 @@ core::Result<void> PciDevice::WriteConfig8(ConfigOffset offset,
 
 core::Result<void> PciDevice::WriteConfig16(ConfigOffset offset,
                                             core::Word value) {
+    if (impl_->EcamWrite(offset, value)) {
+        return core::Result<void>::Ok();
+    }
     auto fd_result = impl_->EnsureConfigFd();
     if (fd_result.IsError()) {
         return core::Result<void>::Err(fd_result.Error());
@@ -271,6 +550,9 @@ core::Result<void> PciDevice::WriteConfig16(ConfigOffset offset,
 
 core::Result<void> PciDevice::WriteConfig32(ConfigOffset offset,
                                             core::DWord value) {
+    if (impl_->EcamWrite(offset, value)) {
+        return core::Result<void>::Ok();
+    }
     auto fd_result = impl_->EnsureConfigFd();
     if (fd_result.IsError()) {
         return core::Result<void>::Err(fd_result.Error());
@@ -282,82 +564,277 @@ core::Result<void> PciDevice::WriteConfig32(ConfigOffset offset,
     return core::Result<void>::Ok();
 }
 
+namespace {
+
+/// Longest run of DWord writes submitted as one pwritev.
+constexpr std::size_t kMaxWriteRun = 64;
+
+bool IsAlignedDWord(const ConfigWrite& w) {
+    return w.width == 4 && w.offset % 4 == 0 &&
+           w.offset + 4u <= kConfigSpaceSize;
+}
+
+}  // namespace
+
+std::size_t PciDevice::WriteConfigBatch(const ConfigWrite* writes,
+                                        std::size_t count,
+                                        std::error_code* status) {
+    auto report = [status](std::size_t i, std::error_code ec) {
+        if (status) {
+            status[i] = ec;
+        }
+    };
+
+    std::size_t done = 0;
+    std::error_code failure;
+    while (done < count && !failure) {
+        std::size_t run = 1;
+        if (!impl_->ecam && IsAlignedDWord(writes[done])) {
+            while (done + run < count && run < kMaxWriteRun &&
+                   IsAlignedDWord(writes[done + run]) &&
+                   writes[done + run].offset ==
+                       writes[done].offset + 4 * run) {
+                ++run;
+            }
+        }
+
+        if (run > 1) {
+            auto fd_result = impl_->EnsureConfigFd();
+            if (fd_result.IsError()) {
+                failure = fd_result.Error();
+                report(done, failure);
+                break;
+            }
+            std::array<iovec, kMaxWriteRun> iov{};
+            for (std::size_t i = 0; i < run; ++i) {
+                iov[i].iov_base =
+                    const_cast<core::DWord*>(&writes[done + i].value);
+                iov[i].iov_len = sizeof(core::DWord);
+            }
+            auto n = ::pwritev(impl_->config_fd, iov.data(),
+                               static_cast<int>(run), writes[done].offset);
+            std::size_t written =
+                n < 0 ? 0 : static_cast<std::size_t>(n) / sizeof(core::DWord);
+            for (std::size_t i = 0; i < written; ++i) {
+                report(done + i, {});
+            }
+            done += written;
+            if (written < run) {
+                failure = core::make_error_code(core::ErrorCode::kIOError);
+                report(done, failure);
+            }
+            continue;
+        }
+
+        const auto& w = writes[done];
+        core::Result<void> r = core::Result<void>::Ok();
+        switch (w.width) {
+        case 1:
+            r = WriteConfig8(w.offset, static_cast<core::Byte>(w.value));
+            break;
+        case 2:
+            r = WriteConfig16(w.offset, static_cast<core::Word>(w.value));
+            break;
+        case 4:
+            r = WriteConfig32(w.offset, w.value);
+            break;
+        default:
+            r = core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+            break;
+        }
+        if (r.IsError()) {
+            failure = r.Error();
+            report(done, failure);
+            break;
+        }
+        report(done++, {});
+    }
+
+    for (std::size_t i = done + 1; i < count; ++i) {
+        report(i, core::make_error_code(core::ErrorCode::kCancelled));
+    }
+    return done;
+}
+
 // ---------------------------------------------------------------------------
 // Capability walking
 // ---------------------------------------------------------------------------
 
 core::Result<std::optional<ConfigOffset>> PciDevice::FindCapability(
     CapabilityId id) {
-    // Check Status register bit 4 (capabilities list)
-    auto status_result = ReadConfig16(0x06);
-    if (status_result.IsError()) {
+    auto index_result = impl_->EnsureCapabilityIndex();
+    if (index_result.IsError()) {
         return core::Result<std::optional<ConfigOffset>>::Err(
-            status_result.Error());
-    }
-    if (!(status_result.Value() & (1u << 4))) {
-        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+            index_result.Error());
     }
+    return core::Result<std::optional<ConfigOffset>>::Ok(
+        index_result.Value()->Find(id));
+}
 
-    // Read capability pointer
-    auto cap_ptr_result = ReadConfig8(0x34);
-    if (cap_ptr_result.IsError()) {
+core::Result<std::optional<ConfigOffset>> PciDevice::FindExtCapability(
+    ExtCapabilityId id) {
+    auto index_result = impl_->EnsureCapabilityIndex();
+    if (index_result.IsError()) {
         return core::Result<std::optional<ConfigOffset>>::Err(
-            cap_ptr_result.Error());
+            index_result.Error());
     }
-    uint8_t offset = cap_ptr_result.Value() & 0xFC;
+    return core::Result<std::optional<ConfigOffset>>::Ok(
+        index_result.Value()->Find(id));
+}
 
-    constexpr int kMaxCaps = 48;
-    for (int i = 0; i < kMaxCaps && offset != 0; ++i) {
-        auto cap_id_result = ReadConfig8(offset);
-        if (cap_id_result.IsError()) {
-            return core::Result<std::optional<ConfigOffset>>::Err(
-                cap_id_result.Error());
-        }
-        if (cap_id_result.Value() == static_cast<uint8_t>(id)) {
-            return core::Result<std::optional<ConfigOffset>>::Ok(
-                static_cast<ConfigOffset>(offset));
-        }
-        auto next_result = ReadConfig8(offset + 1);
-        if (next_result.IsError()) {
-            return core::Result<std::optional<ConfigOffset>>::Err(
-                next_result.Error());
-        }
-        offset = next_result.Value() & 0xFC;
+core::Result<CapabilityIndex> PciDevice::GetCapabilityIndex() {
+    auto index_result = impl_->EnsureCapabilityIndex();
+    if (index_result.IsError()) {
+        return core::Result<CapabilityIndex>::Err(index_result.Error());
     }
+    return core::Result<CapabilityIndex>::Ok(*index_result.Value());
+}
+
+// ---------------------------------------------------------------------------
+// CXL DVSECs
+// ---------------------------------------------------------------------------
 
-    return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+core::Result<std::vector<DvsecHeader>> PciDevice::EnumerateCxlDvsecs() {
+    auto index_result = impl_->EnsureCxlDvsecIndex();
+    if (index_result.IsError()) {
+        return core::Result<std::vector<DvsecHeader>>::Err(
+            index_result.Error());
+    }
+    return core::Result<std::vector<DvsecHeader>>::Ok(
+        index_result.Value()->dvsecs);
 }
 
-core::Result<std::optional<ConfigOffset>> PciDevice::FindExtCapability(
-    ExtCapabilityId id) {
-    ConfigOffset offset = 0x100;
-    constexpr int kMaxExtCaps = 256;
-
-    for (int i = 0; i < kMaxExtCaps && offset != 0; ++i) {
-        auto header_result = ReadConfig32(offset);
-        if (header_result.IsError()) {
-            return core::Result<std::optional<ConfigOffset>>::Err(
-                header_result.Error());
-        }
-        auto header = header_result.Value();
-        uint16_t cap_id = header & 0xFFFF;
-        if (cap_id == static_cast<uint16_t>(id)) {
-            return core::Result<std::optional<ConfigOffset>>::Ok(offset);
-        }
-        uint16_t next = (header >> 20) & 0xFFC;
-        if (next == 0 || next <= offset) {
-            break;
-        }
-        offset = next;
+core::Result<std::optional<DvsecHeader>> PciDevice::FindCxlDvsec(
+    CxlDvsecId dvsec_id) {
+    auto index_result = impl_->EnsureCxlDvsecIndex();
+    if (index_result.IsError()) {
+        return core::Result<std::optional<DvsecHeader>>::Err(
+            index_result.Error());
+    }
+    return core::Result<std::optional<DvsecHeader>>::Ok(
+        index_result.Value()->Find(dvsec_id));
+}
+
+core::Result<CxlDeviceType> PciDevice::GetCxlDeviceType() {
+    auto index_result = impl_->EnsureCxlDvsecIndex();
+    if (index_result.IsError()) {
+        return core::Result<CxlDeviceType>::Err(index_result.Error());
+    }
+    return core::Result<CxlDeviceType>::Ok(index_result.Value()->device_type);
+}
+
+core::Result<std::vector<RegisterBlockEntry>> PciDevice::GetRegisterBlocks() {
+    auto index_result = impl_->EnsureCxlDvsecIndex();
+    if (index_result.IsError()) {
+        return core::Result<std::vector<RegisterBlockEntry>>::Err(
+            index_result.Error());
     }
+    return core::Result<std::vector<RegisterBlockEntry>>::Ok(
+        index_result.Value()->register_blocks);
+}
+
+core::Result<core::DWord> PciDevice::ReadDvsecRegister(ConfigOffset dvsec_offset,
+                                                       uint16_t reg_offset) {
+    std::size_t offset = std::size_t{dvsec_offset} + reg_offset;
+    if (offset + sizeof(core::DWord) > kConfigSpaceSize) {
+        return core::Result<core::DWord>::Err(core::ErrorCode::kOutOfRange);
+    }
+    return ReadConfig32(static_cast<ConfigOffset>(offset));
+}
 
-    return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+core::Result<void> PciDevice::WriteDvsecRegister(ConfigOffset dvsec_offset,
+                                                 uint16_t reg_offset,
+                                                 core::DWord value) {
+    std::size_t offset = std::size_t{dvsec_offset} + reg_offset;
+    if (offset + sizeof(core::DWord) > kConfigSpaceSize) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+    return WriteConfig32(static_cast<ConfigOffset>(offset), value);
 }
 
 // ---------------------------------------------------------------------------
 // BAR MMIO
 // ---------------------------------------------------------------------------
 
+core::Result<BarResource> PciDevice::GetBarResource(uint8_t bar_index) {
+    if (bar_index >= kBarCount) {
+        return core::Result<BarResource>::Err(
+            core::ErrorCode::kInvalidArgument);
+    }
+    return core::Result<BarResource>::Ok(
+        impl_->GetBarResources()[bar_index]);
+}
+
+core::Result<bool> PciDevice::IsBarPrefetchable(uint8_t bar_index) {
+    auto resource = GetBarResource(bar_index);
+    if (resource.IsError()) {
+        return core::Result<bool>::Err(resource.Error());
+    }
+    if (!resource.Value().IsImplemented()) {
+        return core::Result<bool>::Err(core::ErrorCode::kNotFound);
+    }
+    return core::Result<bool>::Ok(resource.Value().IsPrefetchable());
+}
+
+core::Result<void> PciDevice::MapAllBars() {
+    const auto& resources = impl_->GetBarResources();
+    for (uint8_t i = 0; i < kBarCount; ++i) {
+        // I/O port BARs have no mmap-able resourceN.
+        if (!resources[i].IsImplemented() || !resources[i].IsMemory()) {
+            continue;
+        }
+        auto bar = impl_->EnsureBarMapped(i);
+        if (bar.IsError()) {
+            return core::Result<void>::Err(bar.Error());
+        }
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> PciDevice::SetBarMapping(uint8_t bar_index,
+                                            BarMapping mapping) {
+    if (bar_index > 5) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (mapping == BarMapping::kWriteCombining) {
+        auto prefetchable = IsBarPrefetchable(bar_index);
+        if (prefetchable.IsError()) {
+            return core::Result<void>::Err(prefetchable.Error());
+        }
+        std::string wc_path = impl_->BarResourcePath(bar_index, mapping);
+        if (!prefetchable.Value() || ::access(wc_path.c_str(), F_OK) != 0) {
+            return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+        }
+    }
+    if (mapping == impl_->RequestedMapping(bar_index)) {
+        return core::Result<void>::Ok();
+    }
+    impl_->UnmapBar(bar_index);
+    impl_->bar_mappings[bar_index] = mapping;
+    return core::Result<void>::Ok();
+}
+
+BarMapping PciDevice::GetBarMapping(uint8_t bar_index) const {
+    return impl_->RequestedMapping(bar_index);
+}
+
+core::Result<void> PciDevice::BarFlush(uint8_t bar_index) {
+    if (bar_index > 5) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    MmioFlush();
+    return core::Result<void>::Ok();
+}
+
+core::Result<MmioWindow> PciDevice::GetBarWindow(uint8_t bar_index) {
+    auto bar = impl_->EnsureBarMapped(bar_index);
+    if (bar.IsError()) {
+        return core::Result<MmioWindow>::Err(bar.Error());
+    }
+    return core::Result<MmioWindow>::Ok(
+        MmioWindow(bar.Value()->base, bar.Value()->size));
+}
+
 core::Result<core::DWord> PciDevice::BarRead32(uint8_t bar_index,
                                                uint64_t offset) {
     auto bar_result = impl_->EnsureBarMapped(bar_index);
@@ -421,8 +898,8 @@ core::Result<void> PciDevice::BarWrite64(uint8_t bar_index, uint64_t offset,
 }
 
 core::Result<void> PciDevice::BarReadBuffer(uint8_t bar_index, uint64_t offset,
-                                            void* buffer,
-                                            std::size_t length) {
+                                            void* buffer, std::size_t length,
+                                            MmioWidth width) {
     if (!buffer || length == 0) {
         return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
     }
@@ -435,14 +912,14 @@ core::Result<void> PciDevice::BarReadBuffer(uint8_t bar_index, uint64_t offset,
         return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
     }
     auto* src = static_cast<uint8_t*>(bar->base) + offset;
-    std::memcpy(buffer, src, length);
-    return core::Result<void>::Ok();
+    return MmioRead(src, buffer, length, width);
 }
 
 core::Result<void> PciDevice::BarWriteBuffer(uint8_t bar_index,
                                              uint64_t offset,
                                              const void* buffer,
-                                             std::size_t length) {
+                                             std::size_t length,
+                                             MmioWidth width) {
     if (!buffer || length == 0) {
         return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
     }
@@ -455,8 +932,11 @@ core::Result<void> PciDevice::BarWriteBuffer(uint8_t bar_index,
         return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
     }
     auto* dst = static_cast<uint8_t*>(bar->base) + offset;
-    std::memcpy(dst, buffer, length);
-    return core::Result<void>::Ok();
+    auto result = MmioWrite(dst, buffer, length, width);
+    if (result.IsOk() && bar->mapping == BarMapping::kWriteCombining) {
+        MmioFlush();
+    }
+    return result;
 }
 
 // ---------------------------------------------------------------------------
@@ -511,6 +991,59 @@ core::Result<std::vector<PciDeviceNode>> PciDevice::GetPathToRoot() {
     return PciTopology::GetPathToRoot(impl_->info.address);
 }
 
+core::Result<std::optional<PciDevice>> PciDevice::FindParent(
+    const PciTopologySnapshot& snapshot) {
+    auto parent_result = snapshot.FindParent(impl_->info.address);
+    if (parent_result.IsError()) {
+        return core::Result<std::optional<PciDevice>>::Err(
+            parent_result.Error());
+    }
+    if (!parent_result.Value().has_value()) {
+        return core::Result<std::optional<PciDevice>>::Ok(std::nullopt);
+    }
+    auto node_result = snapshot.GetDeviceInfo(parent_result.Value().value());
+    if (node_result.IsError()) {
+        return core::Result<std::optional<PciDevice>>::Err(
+            node_result.Error());
+    }
+    return core::Result<std::optional<PciDevice>>::Ok(
+        PciDevice(std::move(node_result.Value())));
+}
+
+core::Result<std::vector<PciDevice>> PciDevice::FindChildren(
+    const PciTopologySnapshot& snapshot) {
+    auto children_result = snapshot.FindChildren(impl_->info.address);
+    if (children_result.IsError()) {
+        return core::Result<std::vector<PciDevice>>::Err(
+            children_result.Error());
+    }
+    std::vector<PciDevice> devices;
+    devices.reserve(children_result.Value().size());
+    for (const auto& addr : children_result.Value()) {
+        auto node_result = snapshot.GetDeviceInfo(addr);
+        if (node_result.IsError()) {
+            return core::Result<std::vector<PciDevice>>::Err(
+                node_result.Error());
+        }
+        devices.push_back(PciDevice(std::move(node_result.Value())));
+    }
+    return core::Result<std::vector<PciDevice>>::Ok(std::move(devices));
+}
+
+core::Result<PciDevice> PciDevice::FindRootPort(
+    const PciTopologySnapshot& snapshot) {
+    auto root_result = snapshot.FindRootPort(impl_->info.address);
+    if (root_result.IsError()) {
+        return core::Result<PciDevice>::Err(root_result.Error());
+    }
+    auto node_result = snapshot.GetDeviceInfo(root_result.Value());
+    if (node_result.IsError()) {
+        return core::Result<PciDevice>::Err(node_result.Error());
+    }
+    return core::Result<PciDevice>::Ok(
+        PciDevice(std::move(node_result.Value())));
+}
+
 // ---------------------------------------------------------------------------
 // Lifecycle
 // ---------------------------------------------------------------------------
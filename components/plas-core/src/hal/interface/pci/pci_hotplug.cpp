@@ -0,0 +1,185 @@
+#include "plas/hal/interface/pci/pci_hotplug.h"
+
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <fcntl.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+
+namespace plas::hal::pci {
+
+namespace {
+
+// Multicast group of uevents sent by the kernel itself (group 2 carries
+// udevd's re-broadcasts, in libudev's binary format).
+constexpr uint32_t kKernelUeventGroup = 1;
+
+// Kernel uevents are capped at UEVENT_BUFFER_SIZE (2 KiB); leave headroom.
+constexpr std::size_t kUeventBufferSize = 8192;
+
+}  // namespace
+
+std::optional<PciHotplugEvent> ParseUevent(const char* data,
+                                           std::size_t length) {
+    if (!data) {
+        return std::nullopt;
+    }
+    std::optional<PciHotplugAction> action;
+    std::optional<PciAddress> address;
+    bool is_pci = false;
+
+    // NUL-separated fields; the first is the "ACTION@DEVPATH" summary.
+    std::size_t pos = 0;
+    while (pos < length) {
+        const char* field = data + pos;
+        std::size_t field_length = ::strnlen(field, length - pos);
+        std::string_view kv(field, field_length);
+        pos += field_length + 1;
+
+        if (kv == "ACTION=add") {
+            action = PciHotplugAction::kAdd;
+        } else if (kv == "ACTION=remove") {
+            action = PciHotplugAction::kRemove;
+        } else if (kv == "SUBSYSTEM=pci") {
+            is_pci = true;
+        } else if (kv.rfind("PCI_SLOT_NAME=", 0) == 0) {
+            PciAddress parsed{};
+            if (PciAddress::Parse(kv.substr(std::strlen("PCI_SLOT_NAME=")), parsed) ==
+                core::ErrorCode::kSuccess) {
+                address = parsed;
+            }
+        }
+    }
+
+    if (!is_pci || !action || !address) {
+        return std::nullopt;
+    }
+    return PciHotplugEvent{*action, *address};
+}
+
+// ---------------------------------------------------------------------------
+// Pimpl definition
+// ---------------------------------------------------------------------------
+struct PciHotplugMonitor::Impl {
+    std::mutex mutex;  // Start/Stop
+    std::thread thread;
+    Callback callback;
+    int socket_fd = -1;
+    int wake_fds[2] = {-1, -1};  // pipe: Stop() writes, the thread polls
+
+    void Run(PciHotplugMonitor* self) {
+        char buffer[kUeventBufferSize];
+        pollfd fds[2] = {{socket_fd, POLLIN, 0}, {wake_fds[0], POLLIN, 0}};
+        for (;;) {
+            if (::poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            if (fds[1].revents != 0) {
+                return;
+            }
+            if ((fds[0].revents & POLLIN) == 0) {
+                continue;
+            }
+            auto n = ::recv(socket_fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (n <= 0) {
+                // ENOBUFS: the kernel dropped events on overflow. Nothing
+                // names the lost devices, so tell everyone the topology is
+                // unknown.
+                if (n < 0 && errno == ENOBUFS) {
+                    PciTopology::NotifyTopologyChanged();
+                }
+                continue;
+            }
+            auto event = ParseUevent(buffer, static_cast<std::size_t>(n));
+            if (event) {
+                self->Dispatch(*event);
+            }
+        }
+    }
+
+    void CloseFds() {
+        for (int* fd : {&socket_fd, &wake_fds[0], &wake_fds[1]}) {
+            if (*fd >= 0) {
+                ::close(*fd);
+                *fd = -1;
+            }
+        }
+    }
+};
+
+PciHotplugMonitor::PciHotplugMonitor() : impl_(std::make_unique<Impl>()) {}
+
+PciHotplugMonitor::~PciHotplugMonitor() {
+    Stop();
+}
+
+core::Result<void> PciHotplugMonitor::Start(Callback callback) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (impl_->thread.joinable()) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+    }
+
+    auto fail = [this](int err) {
+        impl_->CloseFds();
+        return core::Result<void>::Err(err == EACCES || err == EPERM
+                                           ? core::ErrorCode::kPermissionDenied
+                                           : core::ErrorCode::kIOError);
+    };
+    impl_->socket_fd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC,
+                                NETLINK_KOBJECT_UEVENT);
+    if (impl_->socket_fd < 0) {
+        return fail(errno);
+    }
+    sockaddr_nl addr{};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = kKernelUeventGroup;
+    if (::bind(impl_->socket_fd, reinterpret_cast<sockaddr*>(&addr),
+               sizeof(addr)) < 0) {
+        return fail(errno);
+    }
+    if (::pipe2(impl_->wake_fds, O_CLOEXEC) < 0) {
+        return fail(errno);
+    }
+
+    impl_->callback = std::move(callback);
+    impl_->thread = std::thread([this] { impl_->Run(this); });
+    return core::Result<void>::Ok();
+}
+
+void PciHotplugMonitor::Stop() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (!impl_->thread.joinable()) {
+        return;
+    }
+    char wake = 0;
+    while (::write(impl_->wake_fds[1], &wake, 1) < 0 && errno == EINTR) {
+    }
+    impl_->thread.join();
+    impl_->CloseFds();
+    impl_->callback = nullptr;
+}
+
+bool PciHotplugMonitor::IsRunning() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->thread.joinable();
+}
+
+void PciHotplugMonitor::Dispatch(const PciHotplugEvent& event) {
+    PciTopology::NotifyTopologyChanged();
+    if (impl_->callback) {
+        impl_->callback(event);
+    }
+}
+
+}  // namespace plas::hal::pci
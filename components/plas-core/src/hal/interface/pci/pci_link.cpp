@@ -0,0 +1,286 @@
+#include "plas/hal/interface/pci/pci_link.h"
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "plas/core/deadline.h"
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/pci_device.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+#include "plas/hal/interface/pci/regs/pcie_cap.h"
+
+namespace plas::hal::pci {
+
+namespace {
+
+using regs::pcie::LinkCapabilities;
+using regs::pcie::LinkCapabilities2;
+using regs::pcie::LinkControl;
+using regs::pcie::LinkControl2;
+using regs::pcie::LinkStatus;
+using PcieFlags = regs::pcie::Capabilities;
+
+PciLinkSpeed SpeedOf(uint32_t field) {
+    field &= 0xF;
+    return field >= 1 && field <= 6 ? static_cast<PciLinkSpeed>(field)
+                                    : PciLinkSpeed::kUnknown;
+}
+
+template <typename Reg>
+ConfigOffset At(ConfigOffset pcie_cap) {
+    return static_cast<ConfigOffset>(pcie_cap + Reg::kOffset);
+}
+
+}  // namespace
+
+PciLinkState PciLinkState::Decode(uint16_t link_status) {
+    core::RegisterValue<LinkStatus> status(link_status);
+    return PciLinkState{SpeedOf(status.Get<LinkStatus::CurrentLinkSpeed>()),
+                        status.Get<LinkStatus::NegotiatedLinkWidth>(),
+                        status.Get<LinkStatus::LinkTraining>(),
+                        status.Get<LinkStatus::DataLinkLayerLinkActive>(), link_status};
+}
+
+bool PciLinkCapabilities::Supports(PciLinkSpeed speed) const {
+    auto gen = static_cast<uint8_t>(speed);
+    return gen >= 1 && gen <= 7 && ((supported_speeds >> (gen - 1)) & 1u);
+}
+
+bool PciLinkCapabilities::CanRetrain() const {
+    return port_type == PciePortType::kRootPort ||
+           port_type == PciePortType::kDownstreamPort;
+}
+
+// ---------------------------------------------------------------------------
+// Pimpl definition
+// ---------------------------------------------------------------------------
+struct PciLink::Impl {
+    std::function<core::Result<CapabilityIndex>()> get_index;
+    std::function<core::Result<core::Word>(ConfigOffset)> read16;
+    std::function<core::Result<core::DWord>(ConfigOffset)> read32;
+    std::function<core::Result<void>(ConfigOffset, core::Word)> write16;
+    PciLinkOptions options;
+
+    std::mutex mutex;
+    std::optional<PciLinkCapabilities> caps;  // guarded by mutex
+    uint64_t caps_generation = 0;             // PciTopology generation at read
+
+    core::Result<PciLinkCapabilities> CapabilitiesLocked() {
+        auto generation = PciTopology::GetTopologyGeneration();
+        if (caps && caps_generation == generation) {
+            return core::Result<PciLinkCapabilities>::Ok(*caps);
+        }
+        auto index = get_index();
+        if (index.IsError()) {
+            return core::Result<PciLinkCapabilities>::Err(index.Error());
+        }
+        auto pcie = index.Value().Find(CapabilityId::kPciExpress);
+        if (!pcie) {
+            return core::Result<PciLinkCapabilities>::Err(
+                core::ErrorCode::kNotSupported);
+        }
+        auto flags_raw = read16(At<PcieFlags>(*pcie));
+        if (flags_raw.IsError()) {
+            return core::Result<PciLinkCapabilities>::Err(flags_raw.Error());
+        }
+        auto link_caps_raw = read32(At<LinkCapabilities>(*pcie));
+        if (link_caps_raw.IsError()) {
+            return core::Result<PciLinkCapabilities>::Err(link_caps_raw.Error());
+        }
+        core::RegisterValue<PcieFlags> flags(flags_raw.Value());
+        core::RegisterValue<LinkCapabilities> link_caps(link_caps_raw.Value());
+
+        PciLinkCapabilities result{};
+        result.pcie_cap = *pcie;
+        result.port_type = flags.Get<PcieFlags::PortType>();
+        result.max_speed = SpeedOf(link_caps.Get<LinkCapabilities::MaxLinkSpeed>());
+        result.max_width = link_caps.Get<LinkCapabilities::MaximumLinkWidth>();
+        result.dll_active_reporting =
+            link_caps.Get<LinkCapabilities::DataLinkLayerLinkActiveReportingCapable>();
+        // Link Capabilities 2 exists from capability version 2 on; ports
+        // that leave its speed vector zero are described by max_speed.
+        if (flags.Get<PcieFlags::Version>() >= 2) {
+            auto link_caps2 = read32(At<LinkCapabilities2>(*pcie));
+            if (link_caps2.IsError()) {
+                return core::Result<PciLinkCapabilities>::Err(link_caps2.Error());
+            }
+            result.supported_speeds = LinkCapabilities2::SupportedLinkSpeedsVector::Get(
+                link_caps2.Value());
+        }
+        if (result.supported_speeds == 0 && result.max_speed != PciLinkSpeed::kUnknown) {
+            result.supported_speeds = static_cast<uint8_t>(
+                (1u << static_cast<uint8_t>(result.max_speed)) - 1);
+        }
+        caps = result;
+        caps_generation = generation;
+        return core::Result<PciLinkCapabilities>::Ok(result);
+    }
+
+    core::Result<PciLinkState> ReadState(const PciLinkCapabilities& link) {
+        auto status = read16(At<LinkStatus>(link.pcie_cap));
+        if (status.IsError()) {
+            return core::Result<PciLinkState>::Err(status.Error());
+        }
+        return core::Result<PciLinkState>::Ok(PciLinkState::Decode(status.Value()));
+    }
+
+    bool Settled(const PciLinkCapabilities& link, const PciLinkState& state) const {
+        if (state.training) {
+            return false;
+        }
+        return !options.wait_for_dll_active || !link.dll_active_reporting ||
+               state.dll_active;
+    }
+
+    /// Poll Link Status until Settled() or `deadline`: re-read without
+    /// sleeping for options.spin, then back off exponentially.
+    core::Result<PciLinkState> WaitSettled(const PciLinkCapabilities& link,
+                                           std::chrono::steady_clock::time_point deadline,
+                                           PciLinkTransition* transition) {
+        auto start = std::chrono::steady_clock::now();
+        auto interval = std::min(std::chrono::microseconds(1), options.poll_interval);
+        for (;;) {
+            auto state = ReadState(link);
+            if (state.IsError()) {
+                return state;
+            }
+            if (transition) {
+                ++transition->polls;
+                transition->observed_training |= state.Value().training;
+            }
+            if (Settled(link, state.Value())) {
+                return state;
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                return core::Result<PciLinkState>::Err(core::ErrorCode::kTimeout);
+            }
+            if (now - start >= options.spin) {
+                std::this_thread::sleep_for(interval);
+                interval = std::min(interval * 2, options.poll_interval);
+            }
+        }
+    }
+
+    core::Result<PciLinkTransition> RetrainLocked(const PciLinkCapabilities& link) {
+        if (!link.CanRetrain()) {
+            return core::Result<PciLinkTransition>::Err(core::ErrorCode::kNotSupported);
+        }
+        auto deadline = core::Deadline::Current().Clamp(std::chrono::steady_clock::now() +
+                                                        options.timeout);
+        PciLinkTransition transition{};
+        // A retrain requested while one is in progress may be lost.
+        auto before = WaitSettled(link, deadline, nullptr);
+        if (before.IsError()) {
+            return core::Result<PciLinkTransition>::Err(before.Error());
+        }
+        transition.before = before.Value();
+
+        auto control_offset = At<LinkControl>(link.pcie_cap);
+        auto control = read16(control_offset);
+        if (control.IsError()) {
+            return core::Result<PciLinkTransition>::Err(control.Error());
+        }
+        auto start = std::chrono::steady_clock::now();
+        auto written = write16(control_offset,
+                               core::RegisterValue<LinkControl>(control.Value())
+                                   .Set<LinkControl::RetrainLink>(true)
+                                   .ForWrite());
+        if (written.IsError()) {
+            return core::Result<PciLinkTransition>::Err(written.Error());
+        }
+        auto after = WaitSettled(link, deadline, &transition);
+        if (after.IsError()) {
+            return core::Result<PciLinkTransition>::Err(after.Error());
+        }
+        transition.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+        transition.after = after.Value();
+        return core::Result<PciLinkTransition>::Ok(transition);
+    }
+};
+
+PciLink::PciLink(PciConfig& config, Bdf bdf, PciLinkOptions options)
+    : impl_(std::make_unique<Impl>()) {
+    impl_->get_index = [&config, bdf] { return config.GetCapabilityIndex(bdf); };
+    impl_->read16 = [&config, bdf](ConfigOffset offset) {
+        return config.ReadConfig16(bdf, offset);
+    };
+    impl_->read32 = [&config, bdf](ConfigOffset offset) {
+        return config.ReadConfig32(bdf, offset);
+    };
+    impl_->write16 = [&config, bdf](ConfigOffset offset, core::Word value) {
+        return config.WriteConfig16(bdf, offset, value);
+    };
+    impl_->options = options;
+}
+
+PciLink::PciLink(PciDevice& device, PciLinkOptions options)
+    : impl_(std::make_unique<Impl>()) {
+    impl_->get_index = [&device] { return device.GetCapabilityIndex(); };
+    impl_->read16 = [&device](ConfigOffset offset) { return device.ReadConfig16(offset); };
+    impl_->read32 = [&device](ConfigOffset offset) { return device.ReadConfig32(offset); };
+    impl_->write16 = [&device](ConfigOffset offset, core::Word value) {
+        return device.WriteConfig16(offset, value);
+    };
+    impl_->options = options;
+}
+
+PciLink::~PciLink() = default;
+
+core::Result<PciLinkCapabilities> PciLink::GetCapabilities() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->CapabilitiesLocked();
+}
+
+core::Result<PciLinkState> PciLink::GetState() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto link = impl_->CapabilitiesLocked();
+    if (link.IsError()) {
+        return core::Result<PciLinkState>::Err(link.Error());
+    }
+    return impl_->ReadState(link.Value());
+}
+
+core::Result<PciLinkTransition> PciLink::Retrain() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto link = impl_->CapabilitiesLocked();
+    if (link.IsError()) {
+        return core::Result<PciLinkTransition>::Err(link.Error());
+    }
+    return impl_->RetrainLocked(link.Value());
+}
+
+core::Result<PciLinkTransition> PciLink::SetTargetSpeed(PciLinkSpeed speed) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto link = impl_->CapabilitiesLocked();
+    if (link.IsError()) {
+        return core::Result<PciLinkTransition>::Err(link.Error());
+    }
+    if (!link.Value().CanRetrain()) {
+        return core::Result<PciLinkTransition>::Err(core::ErrorCode::kNotSupported);
+    }
+    if (!link.Value().Supports(speed)) {
+        return core::Result<PciLinkTransition>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    auto control2_offset = At<LinkControl2>(link.Value().pcie_cap);
+    auto control2 = impl_->read16(control2_offset);
+    if (control2.IsError()) {
+        return core::Result<PciLinkTransition>::Err(control2.Error());
+    }
+    auto target = core::RegisterValue<LinkControl2>(control2.Value())
+                      .Set<LinkControl2::TargetLinkSpeed>(static_cast<uint8_t>(speed))
+                      .ForWrite();
+    if (target != control2.Value()) {
+        auto written = impl_->write16(control2_offset, target);
+        if (written.IsError()) {
+            return core::Result<PciLinkTransition>::Err(written.Error());
+        }
+    }
+    return impl_->RetrainLocked(link.Value());
+}
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,326 @@
+#include "plas/hal/interface/pci/pci_link_monitor.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/core/executor.h"
+#include "plas/hal/interface/pci/pci_device.h"
+
+namespace plas::hal::pci {
+
+namespace {
+
+// Register blocks read per device: PCIe Device Status (+0x0A) through Link
+// Status (+0x12), and AER Uncorrectable (+0x04) through Correctable (+0x10)
+// Error Status.
+constexpr ConfigOffset kPcieStatusOffset = 0x0A;
+constexpr std::size_t kPcieStatusLength = 10;
+constexpr ConfigOffset kAerStatusOffset = 0x04;
+constexpr std::size_t kAerStatusLength = 16;
+
+uint16_t Le16(const core::Byte* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t Le32(const core::Byte* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t NowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+std::size_t RoundUpPow2(std::size_t n) {
+    std::size_t capacity = 1;
+    while (capacity < n) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Pimpl definition
+// ---------------------------------------------------------------------------
+struct PciLinkMonitor::Impl {
+    using ReadBlock =
+        std::function<core::Result<void>(ConfigOffset, core::Byte*,
+                                          std::size_t)>;
+
+    struct Target {
+        ReadBlock read_block;
+        std::optional<ConfigOffset> pcie;
+        std::optional<ConfigOffset> aer;
+
+        // Debounce state, touched only under sample_mutex.
+        bool has_baseline = false;
+        PciLinkSample reported{};
+        bool pending = false;
+        PciLinkSample pending_sample{};
+    };
+
+    /// One ring entry under a per-slot sequence lock: seq is 2p+1 while
+    /// position p is being written and 2p+2 once it is complete. The sample
+    /// is stored as three words so readers may race with the writer without
+    /// a data race; a torn copy is detected by re-checking seq.
+    struct Slot {
+        std::atomic<uint64_t> seq{0};
+        std::array<std::atomic<uint64_t>, 3> words{};
+    };
+
+    explicit Impl(const PciLinkMonitorOptions& opts)
+        : options(opts),
+          capacity(RoundUpPow2(opts.ring_capacity)),
+          slots(new Slot[capacity]),
+          executor(core::Executor::ForCpus(opts.cpus)) {}
+
+    /// Register a device: resolve its capability offsets once.
+    template <typename GetIndex>
+    core::Result<uint32_t> Add(GetIndex get_index, ReadBlock read_block) {
+        std::lock_guard<std::mutex> lock(control_mutex);
+        if (timer != 0) {
+            return core::Result<uint32_t>::Err(core::ErrorCode::kBusy);
+        }
+        core::Result<CapabilityIndex> index = get_index();
+        if (index.IsError()) {
+            return core::Result<uint32_t>::Err(index.Error());
+        }
+        Target target;
+        target.read_block = std::move(read_block);
+        target.pcie = index.Value().Find(CapabilityId::kPciExpress);
+        target.aer = index.Value().Find(ExtCapabilityId::kAer);
+
+        std::lock_guard<std::mutex> sample_lock(sample_mutex);
+        targets.push_back(std::move(target));
+        return core::Result<uint32_t>::Ok(
+            static_cast<uint32_t>(targets.size() - 1));
+    }
+
+    PciLinkSample Sample(uint32_t index, Target& target) {
+        PciLinkSample sample{};
+        sample.timestamp_ns = NowNs();
+        sample.device = index;
+        if (target.pcie) {
+            core::Byte status[kPcieStatusLength];
+            auto read = target.read_block(
+                static_cast<ConfigOffset>(*target.pcie + kPcieStatusOffset),
+                status, sizeof(status));
+            sample.device_status = read.IsOk() ? Le16(status) : 0xFFFF;
+            sample.link_status = read.IsOk() ? Le16(status + 8) : 0xFFFF;
+        }
+        if (target.aer) {
+            core::Byte status[kAerStatusLength];
+            auto read = target.read_block(
+                static_cast<ConfigOffset>(*target.aer + kAerStatusOffset),
+                status, sizeof(status));
+            sample.aer_uncorrectable = read.IsOk() ? Le32(status) : ~0u;
+            sample.aer_correctable = read.IsOk() ? Le32(status + 12) : ~0u;
+        }
+        return sample;
+    }
+
+    void Push(const PciLinkSample& sample) {
+        uint64_t position = head.load(std::memory_order_relaxed);
+        auto& slot = slots[position & (capacity - 1)];
+        slot.seq.store(2 * position + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.words[0].store(sample.timestamp_ns, std::memory_order_relaxed);
+        slot.words[1].store(static_cast<uint64_t>(sample.device) |
+                                (static_cast<uint64_t>(sample.device_status)
+                                 << 32) |
+                                (static_cast<uint64_t>(sample.link_status)
+                                 << 48),
+                            std::memory_order_relaxed);
+        slot.words[2].store(static_cast<uint64_t>(sample.aer_uncorrectable) |
+                                (static_cast<uint64_t>(sample.aer_correctable)
+                                 << 32),
+                            std::memory_order_relaxed);
+        slot.seq.store(2 * position + 2, std::memory_order_release);
+        head.store(position + 1, std::memory_order_release);
+    }
+
+    /// Copy position `position` out of the ring; false if it was
+    /// overwritten (or is being overwritten) by a newer sample.
+    bool Load(uint64_t position, PciLinkSample& out) const {
+        const auto& slot = slots[position & (capacity - 1)];
+        uint64_t expected = 2 * position + 2;
+        if (slot.seq.load(std::memory_order_acquire) != expected) {
+            return false;
+        }
+        uint64_t w0 = slot.words[0].load(std::memory_order_relaxed);
+        uint64_t w1 = slot.words[1].load(std::memory_order_relaxed);
+        uint64_t w2 = slot.words[2].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != expected) {
+            return false;
+        }
+        out.timestamp_ns = w0;
+        out.device = static_cast<uint32_t>(w1);
+        out.device_status = static_cast<uint16_t>(w1 >> 32);
+        out.link_status = static_cast<uint16_t>(w1 >> 48);
+        out.aer_uncorrectable = static_cast<uint32_t>(w2);
+        out.aer_correctable = static_cast<uint32_t>(w2 >> 32);
+        return true;
+    }
+
+    /// Debounce: report a new state once it has held for options.debounce.
+    void Debounce(Target& target, const PciLinkSample& sample) {
+        if (!target.has_baseline) {
+            target.reported = sample;
+            target.has_baseline = true;
+            return;
+        }
+        if (!sample.StateDiffers(target.reported)) {
+            target.pending = false;
+            return;
+        }
+        if (!target.pending || sample.StateDiffers(target.pending_sample)) {
+            target.pending = true;
+            target.pending_sample = sample;
+        }
+        auto held = std::chrono::nanoseconds(
+            sample.timestamp_ns - target.pending_sample.timestamp_ns);
+        if (held < options.debounce) {
+            return;
+        }
+        auto previous = target.reported;
+        target.reported = sample;
+        target.pending = false;
+        if (callback) {
+            callback(previous, sample);
+        }
+    }
+
+    PciLinkMonitorOptions options;
+    std::size_t capacity;
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> head{0};
+    core::Executor& executor;
+
+    std::vector<Target> targets;  // fixed while running
+    ChangeCallback callback;
+    std::mutex sample_mutex;  // SampleOnce vs the timer
+
+    mutable std::mutex control_mutex;  // Start/Stop/registration
+    core::Executor::TimerId timer = 0;  // guarded by control_mutex; 0: stopped
+};
+
+PciLinkMonitor::PciLinkMonitor(PciLinkMonitorOptions options)
+    : impl_(std::make_unique<Impl>(options)) {}
+
+PciLinkMonitor::~PciLinkMonitor() {
+    Stop();
+}
+
+core::Result<uint32_t> PciLinkMonitor::AddDevice(PciConfig& config, Bdf bdf) {
+    return impl_->Add(
+        [&config, bdf] { return config.GetCapabilityIndex(bdf); },
+        [&config, bdf](ConfigOffset offset, core::Byte* buffer,
+                       std::size_t length) {
+            return config.ReadConfigBlock(bdf, offset, buffer, length);
+        });
+}
+
+core::Result<uint32_t> PciLinkMonitor::AddDevice(PciDevice& device) {
+    return impl_->Add(
+        [&device] { return device.GetCapabilityIndex(); },
+        [&device](ConfigOffset offset, core::Byte* buffer,
+                  std::size_t length) {
+            return device.ReadConfigBlock(offset, buffer, length);
+        });
+}
+
+std::size_t PciLinkMonitor::DeviceCount() const {
+    std::lock_guard<std::mutex> lock(impl_->control_mutex);
+    return impl_->targets.size();
+}
+
+core::Result<void> PciLinkMonitor::SetChangeCallback(ChangeCallback callback) {
+    std::lock_guard<std::mutex> lock(impl_->control_mutex);
+    if (impl_->timer != 0) {
+        return core::Result<void>::Err(core::ErrorCode::kBusy);
+    }
+    std::lock_guard<std::mutex> sample_lock(impl_->sample_mutex);
+    impl_->callback = std::move(callback);
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> PciLinkMonitor::Start() {
+    std::lock_guard<std::mutex> lock(impl_->control_mutex);
+    if (impl_->timer != 0) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+    }
+    auto interval = std::max(impl_->options.interval, std::chrono::milliseconds(1));
+    impl_->timer = impl_->executor.PostEvery(interval, [this] { SampleOnce(); });
+    return core::Result<void>::Ok();
+}
+
+void PciLinkMonitor::Stop() {
+    core::Executor::TimerId timer = 0;
+    {
+        std::lock_guard<std::mutex> lock(impl_->control_mutex);
+        timer = std::exchange(impl_->timer, 0);
+    }
+    if (timer != 0) {
+        impl_->executor.Cancel(timer);
+    }
+}
+
+bool PciLinkMonitor::IsRunning() const {
+    std::lock_guard<std::mutex> lock(impl_->control_mutex);
+    return impl_->timer != 0;
+}
+
+void PciLinkMonitor::SampleOnce() {
+    std::lock_guard<std::mutex> lock(impl_->sample_mutex);
+    for (std::size_t i = 0; i < impl_->targets.size(); ++i) {
+        auto& target = impl_->targets[i];
+        auto sample = impl_->Sample(static_cast<uint32_t>(i), target);
+        impl_->Push(sample);
+        impl_->Debounce(target, sample);
+    }
+}
+
+uint64_t PciLinkMonitor::WritePosition() const {
+    return impl_->head.load(std::memory_order_acquire);
+}
+
+std::size_t PciLinkMonitor::Read(uint64_t& cursor, PciLinkSample* out,
+                                 std::size_t max, uint64_t* lost) const {
+    std::size_t count = 0;
+    uint64_t dropped = 0;
+    while (count < max) {
+        uint64_t head = impl_->head.load(std::memory_order_acquire);
+        if (cursor >= head) {
+            break;
+        }
+        if (head - cursor > impl_->capacity) {
+            dropped += head - impl_->capacity - cursor;
+            cursor = head - impl_->capacity;
+        }
+        if (impl_->Load(cursor, out[count])) {
+            ++count;
+        } else {
+            ++dropped;  // overwritten while we were reading it
+        }
+        ++cursor;
+    }
+    if (lost) {
+        *lost += dropped;
+    }
+    return count;
+}
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,284 @@
+#include "plas/hal/interface/pci/pci_msix.h"
+
+#include <functional>
+#include <mutex>
+#include <optional>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/pci_device.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+
+namespace plas::hal::pci {
+
+namespace {
+
+// Registers relative to the MSI-X capability (PCIe 6.0 7.7.2).
+constexpr ConfigOffset kMessageControl = 0x02;
+constexpr ConfigOffset kTableOffset = 0x04;
+constexpr ConfigOffset kPbaOffset = 0x08;
+
+constexpr uint16_t kTableSizeMask = 0x07FF;  // Message Control, N - 1
+constexpr uint16_t kFunctionMask = 1u << 14;
+constexpr uint16_t kMsixEnable = 1u << 15;
+constexpr uint32_t kBirMask = 0x7;
+
+constexpr uint64_t kVectorControl = 12;  // within an entry
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Pimpl definition
+// ---------------------------------------------------------------------------
+struct PciMsix::Impl {
+    std::function<core::Result<CapabilityIndex>()> get_index;
+    std::function<core::Result<core::Word>(ConfigOffset)> read16;
+    std::function<core::Result<core::DWord>(ConfigOffset)> read32;
+    std::function<core::Result<void>(ConfigOffset, core::Word)> write16;
+    std::function<core::Result<void>(uint8_t, uint64_t, void*, std::size_t)> bar_read;
+    std::function<core::Result<void>(uint8_t, uint64_t, const void*, std::size_t)> bar_write;
+    std::function<core::Result<void>(uint8_t, uint64_t, core::DWord)> bar_write32;
+
+    std::mutex mutex;
+    std::optional<PciMsixLocation> location;  // guarded by mutex
+    uint64_t location_generation = 0;         // PciTopology generation at read
+
+    core::Result<PciMsixLocation> LocationLocked() {
+        auto generation = PciTopology::GetTopologyGeneration();
+        if (location && location_generation == generation) {
+            return core::Result<PciMsixLocation>::Ok(*location);
+        }
+        auto index = get_index();
+        if (index.IsError()) {
+            return core::Result<PciMsixLocation>::Err(index.Error());
+        }
+        auto cap = index.Value().Find(CapabilityId::kMsix);
+        if (!cap) {
+            return core::Result<PciMsixLocation>::Err(core::ErrorCode::kNotSupported);
+        }
+        auto control = read16(static_cast<ConfigOffset>(*cap + kMessageControl));
+        if (control.IsError()) {
+            return core::Result<PciMsixLocation>::Err(control.Error());
+        }
+        auto table = read32(static_cast<ConfigOffset>(*cap + kTableOffset));
+        if (table.IsError()) {
+            return core::Result<PciMsixLocation>::Err(table.Error());
+        }
+        auto pba = read32(static_cast<ConfigOffset>(*cap + kPbaOffset));
+        if (pba.IsError()) {
+            return core::Result<PciMsixLocation>::Err(pba.Error());
+        }
+
+        PciMsixLocation result{};
+        result.cap = *cap;
+        result.table_size = static_cast<uint16_t>((control.Value() & kTableSizeMask) + 1);
+        result.table_bar = static_cast<uint8_t>(table.Value() & kBirMask);
+        result.table_offset = table.Value() & ~kBirMask;
+        result.pba_bar = static_cast<uint8_t>(pba.Value() & kBirMask);
+        result.pba_offset = pba.Value() & ~kBirMask;
+        if (result.table_bar > 5 || result.pba_bar > 5) {
+            return core::Result<PciMsixLocation>::Err(core::ErrorCode::kIOError);
+        }
+        location = result;
+        location_generation = generation;
+        return core::Result<PciMsixLocation>::Ok(result);
+    }
+
+    core::Result<PciMsixLocation> RangeLocked(uint16_t first, std::size_t count) {
+        auto loc = LocationLocked();
+        if (loc.IsOk() && first + count > loc.Value().table_size) {
+            return core::Result<PciMsixLocation>::Err(core::ErrorCode::kOutOfRange);
+        }
+        return loc;
+    }
+
+    static uint64_t EntryOffset(const PciMsixLocation& loc, std::size_t vector) {
+        return loc.table_offset + vector * sizeof(PciMsixEntry);
+    }
+
+    core::Result<bool> ControlBit(uint16_t bit) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto loc = LocationLocked();
+        if (loc.IsError()) {
+            return core::Result<bool>::Err(loc.Error());
+        }
+        auto control = read16(static_cast<ConfigOffset>(loc.Value().cap + kMessageControl));
+        if (control.IsError()) {
+            return core::Result<bool>::Err(control.Error());
+        }
+        return core::Result<bool>::Ok((control.Value() & bit) != 0);
+    }
+
+    core::Result<void> SetControlBit(uint16_t bit, bool set) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto loc = LocationLocked();
+        if (loc.IsError()) {
+            return core::Result<void>::Err(loc.Error());
+        }
+        auto offset = static_cast<ConfigOffset>(loc.Value().cap + kMessageControl);
+        auto control = read16(offset);
+        if (control.IsError()) {
+            return core::Result<void>::Err(control.Error());
+        }
+        auto value = static_cast<core::Word>(set ? control.Value() | bit
+                                                 : control.Value() & ~bit);
+        if (value == control.Value()) {
+            return core::Result<void>::Ok();
+        }
+        return write16(offset, value);
+    }
+};
+
+PciMsix::PciMsix(PciConfig& config, PciBar& bar, Bdf bdf)
+    : impl_(std::make_unique<Impl>()) {
+    impl_->get_index = [&config, bdf] { return config.GetCapabilityIndex(bdf); };
+    impl_->read16 = [&config, bdf](ConfigOffset offset) {
+        return config.ReadConfig16(bdf, offset);
+    };
+    impl_->read32 = [&config, bdf](ConfigOffset offset) {
+        return config.ReadConfig32(bdf, offset);
+    };
+    impl_->write16 = [&config, bdf](ConfigOffset offset, core::Word value) {
+        return config.WriteConfig16(bdf, offset, value);
+    };
+    impl_->bar_read = [&bar, bdf](uint8_t index, uint64_t offset, void* buffer,
+                                  std::size_t length) {
+        return bar.BarReadBuffer(bdf, index, offset, buffer, length);
+    };
+    impl_->bar_write = [&bar, bdf](uint8_t index, uint64_t offset, const void* buffer,
+                                   std::size_t length) {
+        return bar.BarWriteBuffer(bdf, index, offset, buffer, length);
+    };
+    impl_->bar_write32 = [&bar, bdf](uint8_t index, uint64_t offset, core::DWord value) {
+        return bar.BarWrite32(bdf, index, offset, value);
+    };
+}
+
+PciMsix::PciMsix(PciDevice& device) : impl_(std::make_unique<Impl>()) {
+    impl_->get_index = [&device] { return device.GetCapabilityIndex(); };
+    impl_->read16 = [&device](ConfigOffset offset) { return device.ReadConfig16(offset); };
+    impl_->read32 = [&device](ConfigOffset offset) { return device.ReadConfig32(offset); };
+    impl_->write16 = [&device](ConfigOffset offset, core::Word value) {
+        return device.WriteConfig16(offset, value);
+    };
+    // The table takes DWord and aligned QWord accesses (PCIe 6.0 6.1.4.2).
+    impl_->bar_read = [&device](uint8_t index, uint64_t offset, void* buffer,
+                                std::size_t length) {
+        return device.BarReadBuffer(index, offset, buffer, length, MmioWidth::k64);
+    };
+    impl_->bar_write = [&device](uint8_t index, uint64_t offset, const void* buffer,
+                                 std::size_t length) {
+        return device.BarWriteBuffer(index, offset, buffer, length, MmioWidth::k64);
+    };
+    impl_->bar_write32 = [&device](uint8_t index, uint64_t offset, core::DWord value) {
+        return device.BarWrite32(index, offset, value);
+    };
+}
+
+PciMsix::~PciMsix() = default;
+
+core::Result<PciMsixLocation> PciMsix::GetLocation() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->LocationLocked();
+}
+
+core::Result<bool> PciMsix::IsEnabled() {
+    return impl_->ControlBit(kMsixEnable);
+}
+
+core::Result<void> PciMsix::SetEnabled(bool enabled) {
+    return impl_->SetControlBit(kMsixEnable, enabled);
+}
+
+core::Result<bool> PciMsix::IsFunctionMasked() {
+    return impl_->ControlBit(kFunctionMask);
+}
+
+core::Result<void> PciMsix::SetFunctionMasked(bool masked) {
+    return impl_->SetControlBit(kFunctionMask, masked);
+}
+
+core::Result<void> PciMsix::ReadEntries(uint16_t first, PciMsixEntry* entries,
+                                        std::size_t count) {
+    if (count == 0) {
+        return core::Result<void>::Ok();
+    }
+    if (!entries) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto loc = impl_->RangeLocked(first, count);
+    if (loc.IsError()) {
+        return core::Result<void>::Err(loc.Error());
+    }
+    return impl_->bar_read(loc.Value().table_bar, Impl::EntryOffset(loc.Value(), first),
+                           entries, count * sizeof(PciMsixEntry));
+}
+
+core::Result<void> PciMsix::WriteEntries(uint16_t first, const PciMsixEntry* entries,
+                                         std::size_t count) {
+    if (count == 0) {
+        return core::Result<void>::Ok();
+    }
+    if (!entries) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto loc = impl_->RangeLocked(first, count);
+    if (loc.IsError()) {
+        return core::Result<void>::Err(loc.Error());
+    }
+    return impl_->bar_write(loc.Value().table_bar, Impl::EntryOffset(loc.Value(), first),
+                            entries, count * sizeof(PciMsixEntry));
+}
+
+core::Result<std::size_t> PciMsix::SetMasked(uint16_t first, std::size_t count,
+                                             bool masked) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto loc = impl_->RangeLocked(first, count);
+    if (loc.IsError()) {
+        return core::Result<std::size_t>::Err(loc.Error());
+    }
+    if (count == 0) {
+        return core::Result<std::size_t>::Ok(0);
+    }
+    // Reserved and TPH bits of Vector Control must be preserved.
+    std::vector<PciMsixEntry> entries(count);
+    auto read = impl_->bar_read(loc.Value().table_bar, Impl::EntryOffset(loc.Value(), first),
+                                entries.data(), count * sizeof(PciMsixEntry));
+    if (read.IsError()) {
+        return core::Result<std::size_t>::Err(read.Error());
+    }
+    std::size_t changed = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (entries[i].Masked() == masked) {
+            continue;
+        }
+        auto control = masked ? entries[i].vector_control | PciMsixEntry::kMask
+                              : entries[i].vector_control & ~PciMsixEntry::kMask;
+        auto written = impl_->bar_write32(
+            loc.Value().table_bar, Impl::EntryOffset(loc.Value(), first + i) + kVectorControl,
+            control);
+        if (written.IsError()) {
+            return core::Result<std::size_t>::Err(written.Error());
+        }
+        ++changed;
+    }
+    return core::Result<std::size_t>::Ok(changed);
+}
+
+core::Result<std::vector<uint64_t>> PciMsix::ReadPendingBits() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto loc = impl_->LocationLocked();
+    if (loc.IsError()) {
+        return core::Result<std::vector<uint64_t>>::Err(loc.Error());
+    }
+    std::vector<uint64_t> bits((static_cast<std::size_t>(loc.Value().table_size) + 63) / 64);
+    auto read = impl_->bar_read(loc.Value().pba_bar, loc.Value().pba_offset, bits.data(),
+                                bits.size() * sizeof(uint64_t));
+    if (read.IsError()) {
+        return core::Result<std::vector<uint64_t>>::Err(read.Error());
+    }
+    return core::Result<std::vector<uint64_t>>::Ok(std::move(bits));
+}
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,435 @@
+#include "plas/hal/interface/pci/pci_reset.h"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+#include "plas/core/deadline.h"
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/pci_device.h"
+
+namespace plas::hal::pci {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Type 0/1 header registers.
+constexpr ConfigOffset kVendorId = 0x00;
+constexpr ConfigOffset kStatus = 0x06;
+constexpr ConfigOffset kHeaderType = 0x0E;
+constexpr ConfigOffset kSecondaryBus = 0x18;    // Primary | Secondary << 8
+constexpr ConfigOffset kSubordinateBus = 0x1A;  // low byte
+constexpr ConfigOffset kBridgeControl = 0x3E;
+
+// Registers relative to the PCIe capability.
+constexpr ConfigOffset kDeviceCapabilities = 0x04;
+constexpr ConfigOffset kDeviceControl = 0x08;
+constexpr ConfigOffset kDeviceStatus = 0x0A;
+constexpr ConfigOffset kLinkCapabilities = 0x0C;
+constexpr ConfigOffset kLinkStatus = 0x12;
+constexpr ConfigOffset kDeviceCapabilities2 = 0x24;
+constexpr ConfigOffset kLinkCapabilities2 = 0x2C;
+
+// Registers relative to the Readiness Time Reporting capability.
+constexpr ConfigOffset kReadinessTime1 = 0x04;
+constexpr ConfigOffset kReadinessTime2 = 0x08;
+
+constexpr uint16_t kImmediateReadiness = 1u << 0;      // Status
+constexpr uint16_t kSecondaryBusReset = 1u << 6;       // Bridge Control
+constexpr uint32_t kFlrCapable = 1u << 28;             // Device Capabilities
+constexpr uint16_t kInitiateFlr = 1u << 15;            // Device Control
+constexpr uint16_t kTransactionsPending = 1u << 5;     // Device Status
+constexpr uint32_t kDllActiveReporting = 1u << 20;     // Link Capabilities
+constexpr uint16_t kDllLinkActive = 1u << 13;          // Link Status
+constexpr uint32_t kFrsSupported = 1u << 31;           // Device Capabilities 2
+constexpr uint32_t kDrsSupported = 1u << 31;           // Link Capabilities 2
+constexpr uint32_t kReadinessTimeValid = 1u << 31;     // Readiness Time 1
+
+constexpr uint16_t kNoResponse = 0xFFFF;
+constexpr uint16_t kRequestRetry = 0x0001;  // Vendor ID under RRS visibility
+
+/// PCIe spec limit on Transactions Pending before an FLR is issued anyway.
+constexpr std::chrono::milliseconds kPendingTransactionsWait{100};
+
+/// Config access to one function, over PciConfig + Bdf or a PciDevice.
+struct Function {
+    Bdf bdf;
+    std::function<core::Result<core::Word>(ConfigOffset)> read16;
+    std::function<core::Result<core::DWord>(ConfigOffset)> read32;
+    std::function<core::Result<void>(ConfigOffset, core::Word)> write16;
+    std::function<core::Result<CapabilityIndex>()> get_index;
+};
+
+Function Access(PciConfig& config, Bdf bdf) {
+    return Function{
+        bdf,
+        [&config, bdf](ConfigOffset offset) { return config.ReadConfig16(bdf, offset); },
+        [&config, bdf](ConfigOffset offset) { return config.ReadConfig32(bdf, offset); },
+        [&config, bdf](ConfigOffset offset, core::Word value) {
+            return config.WriteConfig16(bdf, offset, value);
+        },
+        [&config, bdf] { return config.GetCapabilityIndex(bdf); }};
+}
+
+Function Access(PciDevice& device) {
+    return Function{
+        device.Address().bdf,
+        [&device](ConfigOffset offset) { return device.ReadConfig16(offset); },
+        [&device](ConfigOffset offset) { return device.ReadConfig32(offset); },
+        [&device](ConfigOffset offset, core::Word value) {
+            return device.WriteConfig16(offset, value);
+        },
+        [&device] { return device.GetCapabilityIndex(); }};
+}
+
+/// Resets issued so far: per function (FLR) and per bus (SBR).
+struct ResetCounts {
+    std::mutex mutex;
+    std::unordered_map<uint16_t, uint64_t> functions;  // by Bdf::Pack()
+    std::array<uint64_t, 256> buses{};
+};
+
+ResetCounts& Counts() {
+    static ResetCounts counts;
+    return counts;
+}
+
+void CountFunctionReset(Bdf function) {
+    auto& counts = Counts();
+    std::lock_guard<std::mutex> lock(counts.mutex);
+    ++counts.functions[function.Pack()];
+}
+
+void CountBusReset(uint8_t first, uint8_t last) {
+    auto& counts = Counts();
+    std::lock_guard<std::mutex> lock(counts.mutex);
+    for (unsigned bus = first; bus <= last; ++bus) {
+        ++counts.buses[bus];
+    }
+}
+
+ConfigOffset At(ConfigOffset base, ConfigOffset offset) {
+    return static_cast<ConfigOffset>(base + offset);
+}
+
+/// Readiness Time Reporting field: value in bits 8:0, scale in 11:9,
+/// time = value * 32^scale ns.
+std::chrono::nanoseconds DecodeReadinessTime(uint32_t field) {
+    uint64_t value = field & 0x1FF;
+    uint32_t scale = (field >> 9) & 0x7;
+    for (uint32_t i = 0; i < std::min<uint32_t>(scale, 5); ++i) {
+        value *= 32;
+    }
+    return std::chrono::nanoseconds(value);
+}
+
+/// How long a function needs before its first config read after a reset,
+/// and why; read before the reset.
+struct Readiness {
+    PciReadinessSource source = PciReadinessSource::kDefaultWait;
+    std::chrono::nanoseconds wait{0};
+};
+
+enum class ResetKind : uint8_t { kConventional, kFlr };
+
+core::Result<Readiness> ReadReadiness(const Function& function, ResetKind kind,
+                                      bool bridge_drs, const PciResetOptions& options) {
+    Readiness readiness;
+    auto status = function.read16(kStatus);
+    if (status.IsError()) {
+        return core::Result<Readiness>::Err(status.Error());
+    }
+    if (status.Value() & kImmediateReadiness) {
+        readiness.source = PciReadinessSource::kImmediate;
+        return core::Result<Readiness>::Ok(readiness);
+    }
+    auto index = function.get_index();
+    if (index.IsError()) {
+        return core::Result<Readiness>::Err(index.Error());
+    }
+    if (auto rtr = index.Value().Find(ExtCapabilityId::kReadinessTimeReporting)) {
+        auto time1 = function.read32(At(*rtr, kReadinessTime1));
+        auto time2 = function.read32(At(*rtr, kReadinessTime2));
+        if (time1.IsOk() && time2.IsOk() && (time1.Value() & kReadinessTimeValid)) {
+            auto field = kind == ResetKind::kFlr ? time2.Value() : time1.Value();
+            readiness.source = PciReadinessSource::kReadinessTime;
+            readiness.wait = std::min<std::chrono::nanoseconds>(
+                DecodeReadinessTime(field & 0xFFF), options.min_wait);
+            return core::Result<Readiness>::Ok(readiness);
+        }
+    }
+    if (kind == ResetKind::kConventional && bridge_drs) {
+        readiness.source = PciReadinessSource::kDrs;
+        return core::Result<Readiness>::Ok(readiness);
+    }
+    if (kind == ResetKind::kFlr) {
+        if (auto pcie = index.Value().Find(CapabilityId::kPciExpress)) {
+            auto caps2 = function.read32(At(*pcie, kDeviceCapabilities2));
+            if (caps2.IsOk() && (caps2.Value() & kFrsSupported)) {
+                readiness.source = PciReadinessSource::kFrs;
+                return core::Result<Readiness>::Ok(readiness);
+            }
+        }
+    }
+    readiness.wait = options.min_wait;
+    return core::Result<Readiness>::Ok(readiness);
+}
+
+/// Poll `done` with exponential backoff from 10 us up to poll_interval
+/// until it returns true, an error, or `deadline` passes (kTimeout).
+template <typename Done>
+core::Result<void> PollUntil(Done done, Clock::time_point deadline,
+                             std::chrono::microseconds poll_interval) {
+    auto interval = std::min(std::chrono::microseconds(10), poll_interval);
+    for (;;) {
+        auto result = done();
+        if (result.IsError()) {
+            return core::Result<void>::Err(result.Error());
+        }
+        if (result.Value()) {
+            return core::Result<void>::Ok();
+        }
+        if (Clock::now() >= deadline) {
+            return core::Result<void>::Err(core::ErrorCode::kTimeout);
+        }
+        std::this_thread::sleep_for(interval);
+        interval = std::min(interval * 2, poll_interval);
+    }
+}
+
+/// Wait for every function: the longest required wait counted from
+/// `ready_from`, then Vendor ID polling. `elapsed` counts from `start`, the
+/// end of the reset.
+core::Result<PciResetResult> WaitReady(const std::vector<Function>& functions,
+                                       const std::vector<Readiness>& readiness,
+                                       Clock::time_point start, Clock::time_point ready_from,
+                                       Clock::time_point deadline,
+                                       const PciResetOptions& options) {
+    PciResetResult result{};
+    result.source = PciReadinessSource::kImmediate;
+    std::chrono::nanoseconds wait{0};
+    for (const auto& r : readiness) {
+        wait = std::max(wait, r.wait);
+        // Report the slowest rule in effect.
+        result.source = std::max(result.source, r.source);
+    }
+    if (wait > std::chrono::nanoseconds(0)) {
+        if (ready_from + wait > deadline) {
+            return core::Result<PciResetResult>::Err(core::ErrorCode::kTimeout);
+        }
+        std::this_thread::sleep_until(ready_from + wait);
+        result.waited = std::chrono::duration_cast<std::chrono::microseconds>(wait);
+    }
+    for (const auto& function : functions) {
+        auto ready = PollUntil(
+            [&]() -> core::Result<bool> {
+                auto vendor = function.read16(kVendorId);
+                ++result.polls;
+                if (vendor.IsError()) {
+                    // A function in reset may fail the read outright.
+                    if (vendor.Error() == core::ErrorCode::kIOError) {
+                        return core::Result<bool>::Ok(false);
+                    }
+                    return core::Result<bool>::Err(vendor.Error());
+                }
+                if (vendor.Value() == kRequestRetry) {
+                    ++result.rrs_polls;
+                }
+                return core::Result<bool>::Ok(vendor.Value() != kNoResponse &&
+                                              vendor.Value() != kRequestRetry);
+            },
+            deadline, options.poll_interval);
+        if (ready.IsError()) {
+            return core::Result<PciResetResult>::Err(ready.Error());
+        }
+    }
+    result.elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+    return core::Result<PciResetResult>::Ok(result);
+}
+
+core::Result<PciResetResult> DoFunctionLevelReset(const Function& function,
+                                                  const PciResetOptions& options) {
+    auto index = function.get_index();
+    if (index.IsError()) {
+        return core::Result<PciResetResult>::Err(index.Error());
+    }
+    auto pcie = index.Value().Find(CapabilityId::kPciExpress);
+    if (!pcie) {
+        return core::Result<PciResetResult>::Err(core::ErrorCode::kNotSupported);
+    }
+    auto caps = function.read32(At(*pcie, kDeviceCapabilities));
+    if (caps.IsError()) {
+        return core::Result<PciResetResult>::Err(caps.Error());
+    }
+    if (!(caps.Value() & kFlrCapable)) {
+        return core::Result<PciResetResult>::Err(core::ErrorCode::kNotSupported);
+    }
+    auto readiness = ReadReadiness(function, ResetKind::kFlr, false, options);
+    if (readiness.IsError()) {
+        return core::Result<PciResetResult>::Err(readiness.Error());
+    }
+
+    // Outstanding requests are lost by the FLR; give them a chance to
+    // complete, then reset regardless.
+    auto pending = PollUntil(
+        [&]() -> core::Result<bool> {
+            auto status = function.read16(At(*pcie, kDeviceStatus));
+            if (status.IsError()) {
+                return core::Result<bool>::Err(status.Error());
+            }
+            return core::Result<bool>::Ok(!(status.Value() & kTransactionsPending));
+        },
+        Clock::now() + kPendingTransactionsWait, options.poll_interval);
+    if (pending.IsError() && pending.Error() != core::ErrorCode::kTimeout) {
+        return core::Result<PciResetResult>::Err(pending.Error());
+    }
+
+    auto control = function.read16(At(*pcie, kDeviceControl));
+    if (control.IsError()) {
+        return core::Result<PciResetResult>::Err(control.Error());
+    }
+    auto written = function.write16(At(*pcie, kDeviceControl),
+                                    static_cast<core::Word>(control.Value() | kInitiateFlr));
+    if (written.IsError()) {
+        return core::Result<PciResetResult>::Err(written.Error());
+    }
+    CountFunctionReset(function.bdf);
+    auto start = Clock::now();
+    auto deadline = core::Deadline::Current().Clamp(start + options.timeout);
+    return WaitReady({function}, {readiness.Value()}, start, start, deadline, options);
+}
+
+core::Result<PciResetResult> DoSecondaryBusReset(const Function& bridge,
+                                                 const std::vector<Function>& functions,
+                                                 const PciResetOptions& options) {
+    auto header = bridge.read16(kHeaderType);  // Header Type is the low byte
+    if (header.IsError()) {
+        return core::Result<PciResetResult>::Err(header.Error());
+    }
+    if ((header.Value() & 0x7F) != 0x01) {
+        return core::Result<PciResetResult>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    auto secondary = bridge.read16(kSecondaryBus);
+    if (secondary.IsError()) {
+        return core::Result<PciResetResult>::Err(secondary.Error());
+    }
+    auto subordinate = bridge.read16(kSubordinateBus);
+    if (subordinate.IsError()) {
+        return core::Result<PciResetResult>::Err(subordinate.Error());
+    }
+
+    // DRS and DLL Link Active reporting of the bridge's (downstream) link.
+    bool drs = false;
+    std::optional<ConfigOffset> link_status;
+    auto index = bridge.get_index();
+    if (index.IsError()) {
+        return core::Result<PciResetResult>::Err(index.Error());
+    }
+    if (auto pcie = index.Value().Find(CapabilityId::kPciExpress)) {
+        auto caps = bridge.read32(At(*pcie, kLinkCapabilities));
+        auto caps2 = bridge.read32(At(*pcie, kLinkCapabilities2));
+        if (caps.IsOk() && (caps.Value() & kDllActiveReporting)) {
+            link_status = At(*pcie, kLinkStatus);
+        }
+        drs = caps2.IsOk() && (caps2.Value() & kDrsSupported);
+    }
+    std::vector<Readiness> readiness;
+    for (const auto& function : functions) {
+        auto r = ReadReadiness(function, ResetKind::kConventional, drs, options);
+        if (r.IsError()) {
+            return core::Result<PciResetResult>::Err(r.Error());
+        }
+        readiness.push_back(r.Value());
+    }
+
+    auto control = bridge.read16(kBridgeControl);
+    if (control.IsError()) {
+        return core::Result<PciResetResult>::Err(control.Error());
+    }
+    auto asserted = bridge.write16(
+        kBridgeControl, static_cast<core::Word>(control.Value() | kSecondaryBusReset));
+    if (asserted.IsError()) {
+        return core::Result<PciResetResult>::Err(asserted.Error());
+    }
+    CountBusReset(static_cast<uint8_t>(secondary.Value() >> 8),
+                  static_cast<uint8_t>(subordinate.Value() & 0xFF));
+    std::this_thread::sleep_for(options.reset_hold);
+    auto released = bridge.write16(
+        kBridgeControl, static_cast<core::Word>(control.Value() & ~kSecondaryBusReset));
+    if (released.IsError()) {
+        return core::Result<PciResetResult>::Err(released.Error());
+    }
+    auto start = Clock::now();
+    auto deadline = core::Deadline::Current().Clamp(start + options.timeout);
+
+    // Readiness times count from link up where the bridge can tell.
+    auto ready_from = start;
+    if (link_status && !functions.empty()) {
+        auto up = PollUntil(
+            [&]() -> core::Result<bool> {
+                auto status = bridge.read16(*link_status);
+                if (status.IsError()) {
+                    return core::Result<bool>::Err(status.Error());
+                }
+                return core::Result<bool>::Ok((status.Value() & kDllLinkActive) != 0);
+            },
+            deadline, options.poll_interval);
+        if (up.IsError()) {
+            return core::Result<PciResetResult>::Err(up.Error());
+        }
+        ready_from = Clock::now();
+    }
+    return WaitReady(functions, readiness, start, ready_from, deadline, options);
+}
+
+}  // namespace
+
+uint64_t GetResetCount(Bdf function) {
+    auto& counts = Counts();
+    std::lock_guard<std::mutex> lock(counts.mutex);
+    auto it = counts.functions.find(function.Pack());
+    return (it == counts.functions.end() ? 0 : it->second) + counts.buses[function.bus];
+}
+
+core::Result<PciResetResult> FunctionLevelReset(PciConfig& config, Bdf function,
+                                                const PciResetOptions& options) {
+    return DoFunctionLevelReset(Access(config, function), options);
+}
+
+core::Result<PciResetResult> FunctionLevelReset(PciDevice& function,
+                                                const PciResetOptions& options) {
+    return DoFunctionLevelReset(Access(function), options);
+}
+
+core::Result<PciResetResult> SecondaryBusReset(PciConfig& config, Bdf bridge,
+                                               const std::vector<Bdf>& functions,
+                                               const PciResetOptions& options) {
+    std::vector<Function> access;
+    access.reserve(functions.size());
+    for (auto bdf : functions) {
+        access.push_back(Access(config, bdf));
+    }
+    return DoSecondaryBusReset(Access(config, bridge), access, options);
+}
+
+core::Result<PciResetResult> SecondaryBusReset(PciDevice& bridge,
+                                               const std::vector<PciDevice*>& functions,
+                                               const PciResetOptions& options) {
+    std::vector<Function> access;
+    access.reserve(functions.size());
+    for (auto* function : functions) {
+        if (!function) {
+            return core::Result<PciResetResult>::Err(core::ErrorCode::kInvalidArgument);
+        }
+        access.push_back(Access(*function));
+    }
+    return DoSecondaryBusReset(Access(bridge), access, options);
+}
+
+}  // namespace plas::hal::pci
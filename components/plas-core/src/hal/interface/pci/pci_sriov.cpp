@@ -0,0 +1,479 @@
+#include "plas/hal/interface/pci/pci_sriov.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "plas/core/error.h"
+#include "plas/core/executor.h"
+#include "plas/hal/interface/pci/ecam.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+
+namespace plas::hal::pci {
+
+namespace {
+
+// Registers relative to the SR-IOV capability (PCIe 6.0 9.3.3).
+constexpr ConfigOffset kSriovControl = 0x08;
+constexpr ConfigOffset kInitialVfs = 0x0C;
+constexpr ConfigOffset kTotalVfs = 0x0E;
+constexpr ConfigOffset kNumVfs = 0x10;
+constexpr ConfigOffset kFirstVfOffset = 0x14;
+constexpr ConfigOffset kVfStride = 0x16;
+constexpr ConfigOffset kVfDeviceId = 0x1A;
+constexpr std::size_t kSriovRegisters = 0x1C;  // header through VF Device ID
+
+constexpr uint16_t kVfEnable = 1u << 0;  // SR-IOV Control
+
+uint16_t Get16(const core::Byte* data, std::size_t offset) {
+    return static_cast<uint16_t>(data[offset] | (data[offset + 1] << 8));
+}
+
+/// Write a decimal value to a sysfs attribute; the kernel's errno decides
+/// the error code.
+core::Result<void> WriteAttribute(const std::string& path, unsigned value) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_TRUNC);
+    if (fd < 0) {
+        return core::Result<void>::Err(errno == EACCES || errno == EPERM
+                                           ? core::ErrorCode::kPermissionDenied
+                                           : core::ErrorCode::kIOError);
+    }
+    std::string text = std::to_string(value);
+    auto n = ::write(fd, text.data(), text.size());
+    int error = errno;
+    ::close(fd);
+    if (n != static_cast<ssize_t>(text.size())) {
+        return core::Result<void>::Err(error == EPERM
+                                           ? core::ErrorCode::kPermissionDenied
+                                           : core::ErrorCode::kIOError);
+    }
+    return core::Result<void>::Ok();
+}
+
+/// PciConfig over the enabled VFs of one PF. VF n sits n * stride routing
+/// IDs past the first VF, so a Bdf maps to its slot arithmetically.
+class VfConfigPool final : public PciConfig {
+public:
+    ~VfConfigPool() override { Reset(); }
+
+    std::string InterfaceName() const override { return "PciSriovVfConfig"; }
+    plas::hal::Device* GetDevice() override { return nullptr; }
+
+    /// Close every fd and unmap the ECAM span; no VF is reachable after.
+    void Reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int fd : fds_) {
+            if (fd >= 0) ::close(fd);
+        }
+        fds_.clear();
+        if (ecam_) {
+            ::munmap(const_cast<uint8_t*>(ecam_), ecam_length_);
+            ecam_ = nullptr;
+            ecam_length_ = 0;
+        }
+        vfs_.clear();
+    }
+
+    /// Serve `vfs` (in VF order, `stride` routing IDs apart). Unless
+    /// `access` is kSysfs, one mapping of the ECAM window covers them all;
+    /// if that fails, kEcam is an error and kAuto uses sysfs.
+    core::Result<void> Attach(std::vector<PciAddress> vfs, uint16_t stride,
+                              ConfigAccess access) {
+        Reset();
+        std::lock_guard<std::mutex> lock(mutex_);
+        vfs_ = std::move(vfs);
+        stride_ = stride;
+        fds_.assign(vfs_.size(), -1);
+        if (vfs_.empty() || access == ConfigAccess::kSysfs) {
+            return core::Result<void>::Ok();
+        }
+        auto mapped = MapEcamLocked();
+        if (mapped.IsError() && access == ConfigAccess::kEcam) {
+            vfs_.clear();
+            fds_.clear();
+            return mapped;
+        }
+        return core::Result<void>::Ok();
+    }
+
+    core::Result<core::Byte> ReadConfig8(Bdf bdf, ConfigOffset offset) override {
+        return Read<core::Byte>(bdf, offset);
+    }
+    core::Result<core::Word> ReadConfig16(Bdf bdf, ConfigOffset offset) override {
+        return Read<core::Word>(bdf, offset);
+    }
+    core::Result<core::DWord> ReadConfig32(Bdf bdf, ConfigOffset offset) override {
+        return Read<core::DWord>(bdf, offset);
+    }
+    core::Result<void> WriteConfig8(Bdf bdf, ConfigOffset offset, core::Byte value) override {
+        return Write(bdf, offset, value);
+    }
+    core::Result<void> WriteConfig16(Bdf bdf, ConfigOffset offset, core::Word value) override {
+        return Write(bdf, offset, value);
+    }
+    core::Result<void> WriteConfig32(Bdf bdf, ConfigOffset offset, core::DWord value) override {
+        return Write(bdf, offset, value);
+    }
+
+    core::Result<std::optional<ConfigOffset>> FindCapability(Bdf bdf,
+                                                             CapabilityId id) override {
+        auto index = GetCapabilityIndex(bdf);
+        if (index.IsError()) {
+            return core::Result<std::optional<ConfigOffset>>::Err(index.Error());
+        }
+        return core::Result<std::optional<ConfigOffset>>::Ok(index.Value().Find(id));
+    }
+    core::Result<std::optional<ConfigOffset>> FindExtCapability(Bdf bdf,
+                                                                ExtCapabilityId id) override {
+        auto index = GetCapabilityIndex(bdf);
+        if (index.IsError()) {
+            return core::Result<std::optional<ConfigOffset>>::Err(index.Error());
+        }
+        return core::Result<std::optional<ConfigOffset>>::Ok(index.Value().Find(id));
+    }
+
+    core::Result<void> ReadConfigBlock(Bdf bdf, ConfigOffset offset, core::Byte* buffer,
+                                       std::size_t length) override {
+        if (length == 0) {
+            return core::Result<void>::Ok();
+        }
+        if (!buffer) {
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        }
+        if (offset >= kConfigSpaceSize || length > kConfigSpaceSize - offset) {
+            return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+        }
+        auto slot = Slot(bdf);
+        if (!slot) {
+            return core::Result<void>::Err(core::ErrorCode::kNotFound);
+        }
+        if (ecam_) {
+            const volatile uint8_t* window = Window(*slot);
+            if (offset % 4 == 0 && length % 4 == 0) {
+                for (std::size_t i = 0; i < length; i += 4) {
+                    uint32_t dword =
+                        *reinterpret_cast<const volatile uint32_t*>(window + offset + i);
+                    std::memcpy(buffer + i, &dword, sizeof(dword));
+                }
+            } else {
+                for (std::size_t i = 0; i < length; ++i) {
+                    buffer[i] = window[offset + i];
+                }
+            }
+            return core::Result<void>::Ok();
+        }
+        auto fd = Fd(*slot);
+        if (fd.IsError()) {
+            return core::Result<void>::Err(fd.Error());
+        }
+        auto n = ::pread(fd.Value(), buffer, length, offset);
+        if (n < 0 || static_cast<std::size_t>(n) != length) {
+            return core::Result<void>::Err(core::ErrorCode::kIOError);
+        }
+        return core::Result<void>::Ok();
+    }
+
+private:
+    std::optional<std::size_t> Slot(Bdf bdf) const {
+        if (vfs_.empty()) {
+            return std::nullopt;
+        }
+        int distance = bdf.Pack() - vfs_.front().bdf.Pack();
+        if (distance < 0 || (stride_ == 0 && distance != 0) ||
+            (stride_ != 0 && distance % stride_ != 0)) {
+            return std::nullopt;
+        }
+        std::size_t slot = stride_ == 0 ? 0 : static_cast<std::size_t>(distance / stride_);
+        return slot < vfs_.size() ? std::optional<std::size_t>(slot) : std::nullopt;
+    }
+
+    const volatile uint8_t* Window(std::size_t slot) const {
+        return ecam_ + slot * stride_ * kConfigSpaceSize;
+    }
+    volatile uint8_t* Window(std::size_t slot) {
+        return ecam_ + slot * stride_ * kConfigSpaceSize;
+    }
+
+    core::Result<int> Fd(std::size_t slot) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fds_[slot] >= 0) {
+            return core::Result<int>::Ok(fds_[slot]);
+        }
+        std::string path = PciTopology::GetSysfsPath(vfs_[slot]) + "/config";
+        int fd = ::open(path.c_str(), O_RDWR | O_SYNC);
+        if (fd < 0) {
+            return core::Result<int>::Err(errno == ENOENT ? core::ErrorCode::kNotFound
+                                                          : core::ErrorCode::kPermissionDenied);
+        }
+        fds_[slot] = fd;
+        return core::Result<int>::Ok(fd);
+    }
+
+    core::Result<void> MapEcamLocked() {
+        auto region = Ecam::FindRegion(vfs_.front());
+        if (region.IsError()) {
+            return core::Result<void>::Err(region.Error());
+        }
+        if (!region.Value().Contains(vfs_.back())) {
+            return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+        }
+        int fd = ::open(Ecam::GetMemoryPath().c_str(), O_RDWR | O_SYNC);
+        if (fd < 0) {
+            return core::Result<void>::Err(core::ErrorCode::kPermissionDenied);
+        }
+        auto first = region.Value().ConfigAddress(vfs_.front());
+        auto length = static_cast<std::size_t>(region.Value().ConfigAddress(vfs_.back()) -
+                                               first) + kConfigSpaceSize;
+        void* base = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                            static_cast<off_t>(first));
+        ::close(fd);  // the mapping keeps its own reference
+        if (base == MAP_FAILED) {
+            return core::Result<void>::Err(core::ErrorCode::kIOError);
+        }
+        ecam_ = static_cast<volatile uint8_t*>(base);
+        ecam_length_ = length;
+        return core::Result<void>::Ok();
+    }
+
+    // ECAM needs naturally aligned accesses; the rest go through sysfs.
+    template <typename T>
+    bool InEcam(ConfigOffset offset) const {
+        return ecam_ && offset % sizeof(T) == 0 && offset + sizeof(T) <= kConfigSpaceSize;
+    }
+
+    template <typename T>
+    core::Result<T> Read(Bdf bdf, ConfigOffset offset) {
+        auto slot = Slot(bdf);
+        if (!slot) {
+            return core::Result<T>::Err(core::ErrorCode::kNotFound);
+        }
+        if (InEcam<T>(offset)) {
+            return core::Result<T>::Ok(
+                *reinterpret_cast<const volatile T*>(Window(*slot) + offset));
+        }
+        auto fd = Fd(*slot);
+        if (fd.IsError()) {
+            return core::Result<T>::Err(fd.Error());
+        }
+        T value = 0;
+        if (::pread(fd.Value(), &value, sizeof(value), offset) != sizeof(value)) {
+            return core::Result<T>::Err(core::ErrorCode::kIOError);
+        }
+        return core::Result<T>::Ok(value);
+    }
+
+    template <typename T>
+    core::Result<void> Write(Bdf bdf, ConfigOffset offset, T value) {
+        auto slot = Slot(bdf);
+        if (!slot) {
+            return core::Result<void>::Err(core::ErrorCode::kNotFound);
+        }
+        if (InEcam<T>(offset)) {
+            *reinterpret_cast<volatile T*>(Window(*slot) + offset) = value;
+            return core::Result<void>::Ok();
+        }
+        auto fd = Fd(*slot);
+        if (fd.IsError()) {
+            return core::Result<void>::Err(fd.Error());
+        }
+        if (::pwrite(fd.Value(), &value, sizeof(value), offset) != sizeof(value)) {
+            return core::Result<void>::Err(core::ErrorCode::kIOError);
+        }
+        return core::Result<void>::Ok();
+    }
+
+    std::vector<PciAddress> vfs_;  // fixed between Attach/Reset
+    uint16_t stride_ = 0;
+    volatile uint8_t* ecam_ = nullptr;
+    std::size_t ecam_length_ = 0;
+    std::mutex mutex_;      // guards fds_ entries
+    std::vector<int> fds_;  // per VF, -1 until first sysfs access
+};
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Pimpl definition
+// ---------------------------------------------------------------------------
+struct PciSriov::Impl {
+    std::optional<PciDevice> pf;
+    ConfigAccess access = ConfigAccess::kSysfs;
+    ConfigOffset cap = 0;
+    std::vector<PciAddress> vfs;
+    VfConfigPool pool;
+
+    core::Result<PciSriovInfo> ReadInfo() {
+        core::Byte regs[kSriovRegisters];
+        auto read = pf->ReadConfigBlock(cap, regs, sizeof(regs));
+        if (read.IsError()) {
+            return core::Result<PciSriovInfo>::Err(read.Error());
+        }
+        if (Get16(regs, 0) != static_cast<uint16_t>(ExtCapabilityId::kSriov)) {
+            return core::Result<PciSriovInfo>::Err(core::ErrorCode::kIOError);
+        }
+        PciSriovInfo info{};
+        info.offset = cap;
+        info.initial_vfs = Get16(regs, kInitialVfs);
+        info.total_vfs = Get16(regs, kTotalVfs);
+        info.num_vfs = Get16(regs, kNumVfs);
+        info.enabled = (Get16(regs, kSriovControl) & kVfEnable) != 0;
+        info.first_vf_offset = Get16(regs, kFirstVfOffset);
+        info.vf_stride = Get16(regs, kVfStride);
+        info.vf_device_id = Get16(regs, kVfDeviceId);
+        return core::Result<PciSriovInfo>::Ok(info);
+    }
+
+    /// Point the pool at `count` VFs laid out as the capability says now
+    /// (First VF Offset and VF Stride follow NumVFs).
+    core::Result<void> Attach(const PciSriovInfo& info, uint16_t count) {
+        vfs.clear();
+        auto addresses = ComputeVfAddresses(pf->Address(), info.first_vf_offset,
+                                            info.vf_stride, count);
+        if (addresses.IsError()) {
+            pool.Reset();
+            return core::Result<void>::Err(addresses.Error());
+        }
+        auto attached = pool.Attach(addresses.Value(), info.vf_stride, access);
+        if (attached.IsError()) {
+            return attached;
+        }
+        vfs = std::move(addresses.Value());
+        return core::Result<void>::Ok();
+    }
+};
+
+PciSriov::PciSriov() : impl_(std::make_unique<Impl>()) {}
+
+PciSriov::~PciSriov() = default;
+
+PciSriov::PciSriov(PciSriov&& other) noexcept = default;
+
+PciSriov& PciSriov::operator=(PciSriov&& other) noexcept = default;
+
+core::Result<PciSriov> PciSriov::Open(const PciAddress& pf, ConfigAccess access) {
+    auto device = PciDevice::Open(pf, access);
+    if (device.IsError()) {
+        return core::Result<PciSriov>::Err(device.Error());
+    }
+    auto cap = device.Value().FindExtCapability(ExtCapabilityId::kSriov);
+    if (cap.IsError()) {
+        return core::Result<PciSriov>::Err(cap.Error());
+    }
+    if (!cap.Value()) {
+        return core::Result<PciSriov>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    PciSriov sriov;
+    sriov.impl_->pf.emplace(std::move(device.Value()));
+    sriov.impl_->access = access;
+    sriov.impl_->cap = *cap.Value();
+    auto info = sriov.impl_->ReadInfo();
+    if (info.IsError()) {
+        return core::Result<PciSriov>::Err(info.Error());
+    }
+    auto attached = sriov.impl_->Attach(info.Value(),
+                                        info.Value().enabled ? info.Value().num_vfs : 0);
+    if (attached.IsError()) {
+        return core::Result<PciSriov>::Err(attached.Error());
+    }
+    return core::Result<PciSriov>::Ok(std::move(sriov));
+}
+
+PciDevice& PciSriov::Pf() {
+    return *impl_->pf;
+}
+
+core::Result<PciSriovInfo> PciSriov::GetInfo() {
+    return impl_->ReadInfo();
+}
+
+core::Result<void> PciSriov::Enable(uint16_t num_vfs) {
+    auto info = impl_->ReadInfo();
+    if (info.IsError()) {
+        return core::Result<void>::Err(info.Error());
+    }
+    if (num_vfs > info.Value().total_vfs) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    uint16_t current = info.Value().enabled ? info.Value().num_vfs : 0;
+    if (current != num_vfs) {
+        // The VFs about to go away must not be held open.
+        impl_->pool.Reset();
+        impl_->vfs.clear();
+        std::string path = impl_->pf->SysfsPath() + "/sriov_numvfs";
+        if (current != 0 && num_vfs != 0) {
+            auto disabled = WriteAttribute(path, 0);
+            PciTopology::NotifyTopologyChanged();
+            if (disabled.IsError()) {
+                return disabled;
+            }
+        }
+        auto written = WriteAttribute(path, num_vfs);
+        PciTopology::NotifyTopologyChanged();
+        if (written.IsError()) {
+            return written;
+        }
+        info = impl_->ReadInfo();
+        if (info.IsError()) {
+            return core::Result<void>::Err(info.Error());
+        }
+    }
+    return impl_->Attach(info.Value(), num_vfs);
+}
+
+core::Result<void> PciSriov::Disable() {
+    return Enable(0);
+}
+
+const std::vector<PciAddress>& PciSriov::VfAddresses() const {
+    return impl_->vfs;
+}
+
+std::size_t PciSriov::NumVfs() const {
+    return impl_->vfs.size();
+}
+
+PciConfig& PciSriov::VfConfig() {
+    return impl_->pool;
+}
+
+std::vector<core::Result<void>> PciSriov::ForEachVf(
+    const std::function<core::Result<void>(PciConfig&, Bdf)>& body, std::size_t workers) {
+    const auto& vfs = impl_->vfs;
+    std::vector<core::Result<void>> results(vfs.size(), core::Result<void>::Ok());
+    core::Executor::Shared().ParallelFor(
+        vfs.size(), [&](std::size_t i) { results[i] = body(impl_->pool, vfs[i].bdf); },
+        workers);
+    return results;
+}
+
+core::Result<std::vector<PciAddress>> PciSriov::ComputeVfAddresses(
+    const PciAddress& pf, uint16_t first_vf_offset, uint16_t vf_stride, uint16_t count) {
+    std::vector<PciAddress> vfs;
+    if (count == 0) {
+        return core::Result<std::vector<PciAddress>>::Ok(std::move(vfs));
+    }
+    if (first_vf_offset == 0 || (vf_stride == 0 && count > 1)) {
+        return core::Result<std::vector<PciAddress>>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    uint32_t last = pf.bdf.Pack() + first_vf_offset +
+                    static_cast<uint32_t>(count - 1) * vf_stride;
+    if (last > 0xFFFF) {
+        return core::Result<std::vector<PciAddress>>::Err(core::ErrorCode::kOutOfRange);
+    }
+    vfs.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        auto routing_id = static_cast<uint16_t>(pf.bdf.Pack() + first_vf_offset + i * vf_stride);
+        vfs.push_back(PciAddress{pf.domain, Bdf::FromPacked(routing_id)});
+    }
+    return core::Result<std::vector<PciAddress>>::Ok(std::move(vfs));
+}
+
+}  // namespace plas::hal::pci
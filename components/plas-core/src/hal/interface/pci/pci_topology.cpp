@@ -1,56 +1,151 @@
 #include "plas/hal/interface/pci/pci_topology.h"
 
+#include <algorithm>
+#include <array>
 #include <climits>
-#include <cstdio>
+#include <condition_variable>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
-#include <regex>
-#include <sstream>
+#include <mutex>
+#include <unordered_map>
 
 #include <dirent.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
+#include "plas/core/batch_io.h"
+#include "plas/core/deadline.h"
 #include "plas/core/error.h"
+#include "plas/core/executor.h"
+#include "plas/core/numa.h"
+#include "plas/hal/interface/pci/pci_hotplug.h"
 
 namespace plas::hal::pci {
 
+namespace {
+
+PciePortType PortTypeFromCode(uint8_t code) {
+    switch (code) {
+        case 0x00: return PciePortType::kEndpoint;
+        case 0x01: return PciePortType::kLegacyEndpoint;
+        case 0x04: return PciePortType::kRootPort;
+        case 0x05: return PciePortType::kUpstreamPort;
+        case 0x06: return PciePortType::kDownstreamPort;
+        case 0x07: return PciePortType::kPcieToPciBridge;
+        case 0x08: return PciePortType::kPciToPcieBridge;
+        case 0x09: return PciePortType::kRcIntegratedEndpoint;
+        case 0x0A: return PciePortType::kRcEventCollector;
+        default: return PciePortType::kUnknown;
+    }
+}
+
+// Config reads of one function for EnumerateAll.
+struct FunctionHeader {
+    uint16_t vendor_id = 0xFFFF;
+    uint16_t device_id = 0xFFFF;
+    uint32_t class_code = 0;
+    uint8_t header_type = 0;
+    PciePortType port_type = PciePortType::kUnknown;
+    uint16_t link_status = 0;
+};
+
+uint16_t ReadLe16(const core::Byte* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+}  // namespace
+
 // --- PciAddress implementation ---
 
 std::string PciAddress::ToString() const {
-    char buf[16];
-    std::snprintf(buf, sizeof(buf), "%04x:%02x:%02x.%x", domain, bdf.bus,
-                  bdf.device & 0x1F, bdf.function & 0x07);
-    return buf;
+    char buf[kStringLength];
+    return std::string(buf, ToChars(buf));
+}
+
+core::Result<PciAddress> PciAddress::FromString(std::string_view str) {
+    PciAddress addr{};
+    auto status = Parse(str, addr);
+    if (status != core::ErrorCode::kSuccess) {
+        return core::Result<PciAddress>::Err(status);
+    }
+    return core::Result<PciAddress>::Ok(addr);
 }
 
-core::Result<PciAddress> PciAddress::FromString(const std::string& str) {
-    unsigned int domain_val = 0;
-    unsigned int bus_val = 0;
-    unsigned int dev_val = 0;
-    unsigned int func_val = 0;
+// --- CapabilityIndex implementation ---
 
-    if (std::sscanf(str.c_str(), "%x:%x:%x.%x", &domain_val, &bus_val,
-                    &dev_val, &func_val) != 4) {
-        return core::Result<PciAddress>::Err(core::ErrorCode::kInvalidArgument);
+std::optional<ConfigOffset> CapabilityIndex::Find(CapabilityId id) const {
+    auto it = capabilities.find(static_cast<uint8_t>(id));
+    if (it == capabilities.end() || it->second.empty()) {
+        return std::nullopt;
     }
+    return it->second.front();
+}
 
-    if (domain_val > 0xFFFF || bus_val > 0xFF || dev_val > 0x1F ||
-        func_val > 0x07) {
-        return core::Result<PciAddress>::Err(core::ErrorCode::kOutOfRange);
+std::optional<ConfigOffset> CapabilityIndex::Find(ExtCapabilityId id) const {
+    auto it = ext_capabilities.find(static_cast<uint16_t>(id));
+    if (it == ext_capabilities.end() || it->second.empty()) {
+        return std::nullopt;
     }
+    return it->second.front();
+}
 
-    PciAddress addr{};
-    addr.domain = static_cast<uint16_t>(domain_val);
-    addr.bdf.bus = static_cast<uint8_t>(bus_val);
-    addr.bdf.device = static_cast<uint8_t>(dev_val);
-    addr.bdf.function = static_cast<uint8_t>(func_val);
-    return core::Result<PciAddress>::Ok(addr);
+std::vector<ConfigOffset> CapabilityIndex::FindAll(ExtCapabilityId id) const {
+    auto it = ext_capabilities.find(static_cast<uint16_t>(id));
+    if (it == ext_capabilities.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+CapabilityIndex CapabilityIndex::Parse(const core::Byte* config,
+                                       std::size_t size) {
+    CapabilityIndex index;
+    if (!config || size < 0x40) {
+        return index;
+    }
+
+    // Standard chain: Status bit 4 gates the pointer at 0x34.
+    uint16_t status = static_cast<uint16_t>(config[0x06] | (config[0x07] << 8));
+    if (status & (1u << 4)) {
+        std::size_t offset = config[0x34] & 0xFC;
+        constexpr int kMaxCaps = 48;  // guard against loops
+        for (int i = 0; i < kMaxCaps && offset >= 0x40 && offset + 1 < size;
+             ++i) {
+            index.capabilities[config[offset]].push_back(
+                static_cast<ConfigOffset>(offset));
+            offset = config[offset + 1] & 0xFC;
+        }
+    }
+
+    // Extended chain starts at 0x100 and only exists in PCIe config space.
+    std::size_t offset = 0x100;
+    constexpr int kMaxExtCaps = 256;  // guard against loops
+    for (int i = 0; i < kMaxExtCaps && offset + 4 <= size; ++i) {
+        uint32_t header = static_cast<uint32_t>(config[offset]) |
+                          (static_cast<uint32_t>(config[offset + 1]) << 8) |
+                          (static_cast<uint32_t>(config[offset + 2]) << 16) |
+                          (static_cast<uint32_t>(config[offset + 3]) << 24);
+        if (header == 0 || header == 0xFFFFFFFF) {
+            break;
+        }
+        index.ext_capabilities[static_cast<uint16_t>(header & 0xFFFF)]
+            .push_back(static_cast<ConfigOffset>(offset));
+        std::size_t next = (header >> 20) & 0xFFC;
+        if (next == 0 || next <= offset) {
+            break;
+        }
+        offset = next;
+    }
+
+    return index;
 }
 
 // --- PciTopology static member ---
 
 std::string PciTopology::sysfs_root_ = "/sys";
+std::atomic<uint64_t> PciTopology::topology_generation_{0};
 
 // --- Private helpers ---
 
@@ -81,121 +176,95 @@ core::Result<void> PciTopology::WriteSysfsFile(const std::string& path,
 }
 
 PciePortType PciTopology::ReadPortType(const std::string& sysfs_device_path) {
-    // Read PCI config space binary from sysfs
-    std::string config_path = sysfs_device_path + "/config";
-    std::ifstream config(config_path, std::ios::binary);
-    if (!config.is_open()) {
-        return PciePortType::kUnknown;
-    }
+    PciePortType port_type = PciePortType::kUnknown;
+    bool is_bridge = false;
+    ReadHeaderInfo(sysfs_device_path, port_type, is_bridge);
+    return port_type;
+}
 
-    // Check Status register (offset 0x06) for capabilities list bit
-    config.seekg(0x06);
-    uint16_t status = 0;
-    config.read(reinterpret_cast<char*>(&status), sizeof(status));
-    if (!config.good()) {
-        return PciePortType::kUnknown;
-    }
+void PciTopology::ReadHeaderInfo(const std::string& sysfs_device_path,
+                                 PciePortType& port_type, bool& is_bridge) {
+    port_type = PciePortType::kUnknown;
+    is_bridge = false;
 
-    // Bit 4 of Status register: Capabilities List
-    if (!(status & (1 << 4))) {
-        return PciePortType::kUnknown;
+    // Read the conventional header in one go and walk it in memory
+    std::string config_path = sysfs_device_path + "/config";
+    int fd = ::open(config_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
     }
-
-    // Read capability pointer (offset 0x34)
-    config.seekg(0x34);
-    uint8_t cap_ptr = 0;
-    config.read(reinterpret_cast<char*>(&cap_ptr), sizeof(cap_ptr));
-    if (!config.good()) {
-        return PciePortType::kUnknown;
+    core::Byte data[kLegacyConfigSpaceSize];
+    auto n = ::pread(fd, data, sizeof(data), 0);
+    ::close(fd);
+    if (n <= 0) {
+        return;
     }
+    ParseHeaderInfo(data, static_cast<std::size_t>(n), port_type, is_bridge);
+}
 
-    // Walk capability chain looking for PCI Express (ID=0x10)
-    int max_caps = 48;  // Safety limit
-    while (cap_ptr >= 0x40 && max_caps-- > 0) {
-        // Align to dword boundary
-        cap_ptr &= 0xFC;
-
-        config.seekg(cap_ptr);
-        uint8_t cap_id = 0;
-        config.read(reinterpret_cast<char*>(&cap_id), sizeof(cap_id));
-        if (!config.good()) {
-            return PciePortType::kUnknown;
-        }
+void PciTopology::ParseHeaderInfo(const core::Byte* data, std::size_t size,
+                                  PciePortType& port_type, bool& is_bridge) {
+    port_type = PciePortType::kUnknown;
+    is_bridge = false;
 
-        if (cap_id == static_cast<uint8_t>(CapabilityId::kPciExpress)) {
-            // PCIe Capabilities Register is at cap_ptr + 0x02
-            config.seekg(cap_ptr + 0x02);
-            uint16_t pcie_caps = 0;
-            config.read(reinterpret_cast<char*>(&pcie_caps), sizeof(pcie_caps));
-            if (!config.good()) {
-                return PciePortType::kUnknown;
-            }
-            // Bits [7:4] = Device/Port Type
-            uint8_t port_type = (pcie_caps >> 4) & 0x0F;
-            switch (port_type) {
-                case 0x00: return PciePortType::kEndpoint;
-                case 0x01: return PciePortType::kLegacyEndpoint;
-                case 0x04: return PciePortType::kRootPort;
-                case 0x05: return PciePortType::kUpstreamPort;
-                case 0x06: return PciePortType::kDownstreamPort;
-                case 0x07: return PciePortType::kPcieToPciBridge;
-                case 0x08: return PciePortType::kPciToPcieBridge;
-                case 0x09: return PciePortType::kRcIntegratedEndpoint;
-                case 0x0A: return PciePortType::kRcEventCollector;
-                default: return PciePortType::kUnknown;
-            }
-        }
+    // Header Type register at offset 0x0E; bits [6:0] = header type (mask
+    // out multi-function bit 7)
+    if (size > 0x0E) {
+        is_bridge = (data[0x0E] & 0x7F) == 0x01;
+    }
 
-        // Next capability: offset + 1
-        config.seekg(cap_ptr + 1);
-        config.read(reinterpret_cast<char*>(&cap_ptr), sizeof(cap_ptr));
-        if (!config.good()) {
-            return PciePortType::kUnknown;
-        }
+    auto pcie_cap =
+        CapabilityIndex::Parse(data, size).Find(CapabilityId::kPciExpress);
+    if (!pcie_cap || *pcie_cap + 0x03u >= size) {
+        return;
     }
 
-    return PciePortType::kUnknown;
+    // PCIe Capabilities Register is at cap_ptr + 0x02; bits [7:4] = port type
+    port_type = PortTypeFromCode((data[*pcie_cap + 0x02u] >> 4) & 0x0F);
 }
 
-bool PciTopology::ReadIsBridge(const std::string& sysfs_device_path) {
-    std::string config_path = sysfs_device_path + "/config";
-    std::ifstream config(config_path, std::ios::binary);
-    if (!config.is_open()) {
-        return false;
-    }
+void PciTopology::ReadNumaInfo(const std::string& sysfs_device_path,
+                               PciDeviceNode& node) {
+    auto numa_node = ReadSysfsFile(sysfs_device_path + "/numa_node");
+    auto cpulist = ReadSysfsFile(sysfs_device_path + "/local_cpulist");
+    ParseNumaInfo(numa_node.IsOk() ? numa_node.Value() : std::string(),
+                  cpulist.IsOk() ? cpulist.Value() : std::string(), node);
+}
 
-    // Header Type register at offset 0x0E
-    config.seekg(0x0E);
-    uint8_t header_type = 0;
-    config.read(reinterpret_cast<char*>(&header_type), sizeof(header_type));
-    if (!config.good()) {
-        return false;
+void PciTopology::ParseNumaInfo(std::string_view numa_node,
+                                std::string_view local_cpulist,
+                                PciDeviceNode& node) {
+    if (!numa_node.empty()) {
+        std::string text(numa_node);
+        char* end = nullptr;
+        long value = std::strtol(text.c_str(), &end, 10);
+        if (end != text.c_str() && value >= -1 && value < 1024) {
+            node.numa_node = static_cast<int>(value);
+        }
+    }
+    if (!local_cpulist.empty()) {
+        auto cpus = core::ParseCpuList(local_cpulist.substr(
+            0, local_cpulist.find('\n')));
+        if (cpus.IsOk()) {
+            node.local_cpus = std::move(cpus.Value());
+        }
     }
-
-    // Bits [6:0] = header type (mask out multi-function bit 7)
-    return (header_type & 0x7F) == 0x01;
 }
 
 core::Result<std::vector<PciAddress>> PciTopology::ParseTopologyPath(
     const std::string& real_path) {
-    // Pattern: DDDD:BB:DD.F
-    static const std::regex bdf_pattern(
-        "[0-9a-f]{4}:[0-9a-f]{2}:[0-9a-f]{2}\\.[0-7]",
-        std::regex::icase);
-
     std::vector<PciAddress> addresses;
 
-    // Split path by '/'
-    std::istringstream stream(real_path);
-    std::string segment;
-    while (std::getline(stream, segment, '/')) {
-        if (segment.empty()) continue;
-        if (std::regex_match(segment, bdf_pattern)) {
-            auto result = PciAddress::FromString(segment);
-            if (result.IsOk()) {
-                addresses.push_back(result.Value());
-            }
+    // Every '/'-separated segment that is a DDDD:BB:DD.F address
+    std::string_view path(real_path);
+    while (!path.empty()) {
+        auto slash = path.find('/');
+        auto segment = path.substr(0, slash);
+        PciAddress addr{};
+        if (PciAddress::Parse(segment, addr) == core::ErrorCode::kSuccess) {
+            addresses.push_back(addr);
         }
+        path.remove_prefix(slash == std::string_view::npos ? path.size() : slash + 1);
     }
 
     if (addresses.empty()) {
@@ -216,6 +285,14 @@ const std::string& PciTopology::GetSysfsRoot() {
     return sysfs_root_;
 }
 
+uint64_t PciTopology::GetTopologyGeneration() {
+    return topology_generation_.load(std::memory_order_acquire);
+}
+
+void PciTopology::NotifyTopologyChanged() {
+    topology_generation_.fetch_add(1, std::memory_order_acq_rel);
+}
+
 std::string PciTopology::GetSysfsPath(const PciAddress& addr) {
     return sysfs_root_ + "/bus/pci/devices/" + addr.ToString();
 }
@@ -236,8 +313,8 @@ core::Result<PciDeviceNode> PciTopology::GetDeviceInfo(
     PciDeviceNode node{};
     node.address = addr;
     node.sysfs_path = sysfs_path;
-    node.port_type = ReadPortType(sysfs_path);
-    node.is_bridge = ReadIsBridge(sysfs_path);
+    ReadHeaderInfo(sysfs_path, node.port_type, node.is_bridge);
+    ReadNumaInfo(sysfs_path, node);
     return core::Result<PciDeviceNode>::Ok(std::move(node));
 }
 
@@ -281,11 +358,6 @@ core::Result<std::vector<PciAddress>> PciTopology::FindChildren(
             core::ErrorCode::kNotFound);
     }
 
-    // Pattern: DDDD:BB:DD.F
-    static const std::regex bdf_pattern(
-        "[0-9a-f]{4}:[0-9a-f]{2}:[0-9a-f]{2}\\.[0-7]",
-        std::regex::icase);
-
     std::vector<PciAddress> children;
 
     DIR* dir = ::opendir(sysfs_path.c_str());
@@ -296,12 +368,9 @@ core::Result<std::vector<PciAddress>> PciTopology::FindChildren(
 
     struct dirent* entry = nullptr;
     while ((entry = ::readdir(dir)) != nullptr) {
-        std::string name(entry->d_name);
-        if (std::regex_match(name, bdf_pattern)) {
-            auto result = PciAddress::FromString(name);
-            if (result.IsOk()) {
-                children.push_back(result.Value());
-            }
+        PciAddress child{};
+        if (PciAddress::Parse(entry->d_name, child) == core::ErrorCode::kSuccess) {
+            children.push_back(child);
         }
     }
     ::closedir(dir);
@@ -367,27 +436,280 @@ core::Result<std::vector<PciDeviceNode>> PciTopology::GetPathToRoot(
         PciDeviceNode node{};
         node.address = *it;
         node.sysfs_path = dev_sysfs;
-        node.port_type = ReadPortType(dev_sysfs);
-        node.is_bridge = ReadIsBridge(dev_sysfs);
+        ReadHeaderInfo(dev_sysfs, node.port_type, node.is_bridge);
+        ReadNumaInfo(dev_sysfs, node);
         nodes.push_back(std::move(node));
     }
 
     return core::Result<std::vector<PciDeviceNode>>::Ok(std::move(nodes));
 }
 
+core::Result<PciInventory> PciTopology::EnumerateAll(std::size_t workers) {
+    std::string devices_dir = sysfs_root_ + "/bus/pci/devices";
+    DIR* dir = ::opendir(devices_dir.c_str());
+    if (dir == nullptr) {
+        return core::Result<PciInventory>::Err(core::ErrorCode::kNotFound);
+    }
+    std::vector<PciAddress> addresses;
+    struct dirent* entry = nullptr;
+    while ((entry = ::readdir(dir)) != nullptr) {
+        if (entry->d_name[0] == '.') continue;
+        PciAddress addr{};
+        if (PciAddress::Parse(entry->d_name, addr) == core::ErrorCode::kSuccess) {
+            addresses.push_back(addr);
+        }
+    }
+    ::closedir(dir);
+    std::sort(addresses.begin(), addresses.end(),
+              [](const PciAddress& a, const PciAddress& b) {
+                  return a.domain != b.domain ? a.domain < b.domain
+                                              : a.bdf.Pack() < b.bdf.Pack();
+              });
+
+    // Each function fills its own slot, so the threads share no state.
+    // Every ParallelFor item is one batch of config reads.
+    constexpr std::size_t kBatch = 64;
+    std::vector<FunctionHeader> headers(addresses.size());
+    auto scan = [&](std::size_t chunk) {
+        std::size_t first = chunk * kBatch;
+        std::size_t count = std::min(kBatch, addresses.size() - first);
+        std::vector<std::array<core::Byte, kLegacyConfigSpaceSize>> data(count);
+        std::vector<core::BatchRead> reads(count);
+        for (std::size_t k = 0; k < count; ++k) {
+            reads[k].path = GetSysfsPath(addresses[first + k]) + "/config";
+            reads[k].buffer = data[k].data();
+            reads[k].length = data[k].size();
+        }
+        core::BatchReader::ForThisThread().Read(reads);
+
+        for (std::size_t k = 0; k < count; ++k) {
+            if (reads[k].error || reads[k].transferred < 0x10) continue;
+            const core::Byte* config = data[k].data();
+            std::size_t size = reads[k].transferred;
+
+            auto& header = headers[first + k];
+            header.vendor_id = ReadLe16(config + 0x00);
+            header.device_id = ReadLe16(config + 0x02);
+            header.class_code = (static_cast<uint32_t>(config[0x0B]) << 16) |
+                                (static_cast<uint32_t>(config[0x0A]) << 8) |
+                                config[0x09];
+            header.header_type = config[0x0E] & 0x7F;
+            auto pcie_cap = CapabilityIndex::Parse(config, size)
+                                .Find(CapabilityId::kPciExpress);
+            if (pcie_cap && *pcie_cap + 0x13u < size) {
+                header.port_type =
+                    PortTypeFromCode((config[*pcie_cap + 0x02u] >> 4) & 0x0F);
+                header.link_status = ReadLe16(config + *pcie_cap + 0x12u);
+            }
+        }
+    };
+    core::Executor::Shared().ParallelFor((addresses.size() + kBatch - 1) / kBatch,
+                                         scan, workers);
+
+    PciInventory inventory;
+    std::size_t count = addresses.size();
+    inventory.vendor_ids.reserve(count);
+    inventory.device_ids.reserve(count);
+    inventory.class_codes.reserve(count);
+    inventory.header_types.reserve(count);
+    inventory.port_types.reserve(count);
+    inventory.link_status.reserve(count);
+    for (const auto& header : headers) {
+        inventory.vendor_ids.push_back(header.vendor_id);
+        inventory.device_ids.push_back(header.device_id);
+        inventory.class_codes.push_back(header.class_code);
+        inventory.header_types.push_back(header.header_type);
+        inventory.port_types.push_back(header.port_type);
+        inventory.link_status.push_back(header.link_status);
+    }
+    inventory.addresses = std::move(addresses);
+    return core::Result<PciInventory>::Ok(std::move(inventory));
+}
+
 core::Result<void> PciTopology::RemoveDevice(const PciAddress& addr) {
     std::string remove_path = GetSysfsPath(addr) + "/remove";
-    return WriteSysfsFile(remove_path, "1");
+    auto result = WriteSysfsFile(remove_path, "1");
+    if (result.IsOk()) {
+        topology_generation_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    return result;
 }
 
 core::Result<void> PciTopology::RescanBridge(const PciAddress& bridge_addr) {
     std::string rescan_path = GetSysfsPath(bridge_addr) + "/rescan";
-    return WriteSysfsFile(rescan_path, "1");
+    auto result = WriteSysfsFile(rescan_path, "1");
+    if (result.IsOk()) {
+        topology_generation_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    return result;
 }
 
 core::Result<void> PciTopology::RescanAll() {
     std::string rescan_path = sysfs_root_ + "/bus/pci/rescan";
-    return WriteSysfsFile(rescan_path, "1");
+    auto result = WriteSysfsFile(rescan_path, "1");
+    if (result.IsOk()) {
+        topology_generation_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    return result;
+}
+
+std::vector<core::Result<PciRescanTiming>> PciTopology::RemoveAndRescan(
+    const std::vector<PciAddress>& devices, const PciRescanOptions& options) {
+    using Clock = std::chrono::steady_clock;
+    auto since = [](Clock::time_point start, Clock::time_point end) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    };
+
+    // One sysfs write and its outcome.
+    struct Step {
+        std::optional<PciAddress> target;  // rescan: nullopt = RescanAll
+        std::error_code error;
+        Clock::time_point start;
+        std::chrono::microseconds took{0};
+    };
+    // The work under one device on a root bus (key), or on the root buses
+    // themselves (nullopt key).
+    struct Group {
+        std::optional<PciAddress> key;
+        std::vector<Step> removes;
+        std::vector<Step> rescans;
+    };
+    struct Target {
+        std::error_code error;  // set if the device was not found
+        std::size_t group = 0, remove = 0, rescan = 0;
+        std::optional<Clock::time_point> back;
+    };
+    auto step_of = [](std::vector<Step>& steps, const std::optional<PciAddress>& target) {
+        for (std::size_t i = 0; i < steps.size(); ++i) {
+            if (steps[i].target == target) return i;
+        }
+        steps.push_back(Step{target, {}, {}, {}});
+        return steps.size() - 1;
+    };
+
+    // Root-to-device path of every device that exists.
+    std::unordered_map<PciAddress, std::vector<PciAddress>> paths;
+    for (const auto& addr : devices) {
+        char resolved[PATH_MAX];
+        if (::realpath(GetSysfsPath(addr).c_str(), resolved) == nullptr) {
+            continue;
+        }
+        auto path = ParseTopologyPath(resolved);
+        if (path.IsOk() && !path.Value().empty()) {
+            paths.emplace(addr, std::move(path.Value()));
+        }
+    }
+
+    std::vector<Target> targets(devices.size());
+    std::vector<Group> groups;
+    for (std::size_t i = 0; i < devices.size(); ++i) {
+        auto it = paths.find(devices[i]);
+        if (it == paths.end()) {
+            targets[i].error = core::make_error_code(core::ErrorCode::kNotFound);
+            continue;
+        }
+        // The topmost member of the set on the path is what gets removed.
+        const auto& path = it->second;
+        std::size_t top = 0;
+        while (paths.count(path[top]) == 0) {
+            ++top;
+        }
+        std::optional<PciAddress> parent;
+        std::optional<PciAddress> key;
+        if (top > 0) {
+            parent = path[top - 1];
+            key = path[0];
+        }
+        auto group = std::find_if(groups.begin(), groups.end(),
+                                  [&](const Group& g) { return g.key == key; });
+        if (group == groups.end()) {
+            groups.push_back(Group{key, {}, {}});
+            group = groups.end() - 1;
+        }
+        targets[i].group = static_cast<std::size_t>(group - groups.begin());
+        targets[i].remove = step_of(group->removes, path[top]);
+        targets[i].rescan = step_of(group->rescans, parent);
+    }
+
+    // Listen before removing anything, so no add event can be missed.
+    std::mutex mutex;
+    std::condition_variable changed;
+    uint64_t events = 0;
+    PciHotplugMonitor monitor;
+    auto listening = monitor.Start([&](const PciHotplugEvent& event) {
+        if (event.action != PciHotplugAction::kAdd) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        ++events;
+        changed.notify_all();
+    });
+    (void)listening;  // without uevents, poll_interval alone paces the wait
+
+    // Independent subtrees concurrently; within one, all removes first.
+    core::Executor::Shared().ParallelFor(
+        groups.size(),
+        [&](std::size_t g) {
+            for (auto& step : groups[g].removes) {
+                step.start = Clock::now();
+                auto removed = RemoveDevice(*step.target);
+                step.took = since(step.start, Clock::now());
+                if (removed.IsError()) step.error = removed.Error();
+            }
+            for (auto& step : groups[g].rescans) {
+                step.start = Clock::now();
+                auto rescanned = step.target ? RescanBridge(*step.target) : RescanAll();
+                step.took = since(step.start, Clock::now());
+                if (rescanned.IsError()) step.error = rescanned.Error();
+            }
+        },
+        options.workers);
+
+    auto deadline = core::Deadline::Current().Clamp(Clock::now() + options.timeout);
+    auto failed = [&](const Target& target) -> std::error_code {
+        if (target.error) return target.error;
+        const auto& group = groups[target.group];
+        if (group.removes[target.remove].error) return group.removes[target.remove].error;
+        return group.rescans[target.rescan].error;
+    };
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            bool pending = false;
+            for (std::size_t i = 0; i < devices.size(); ++i) {
+                if (targets[i].back || failed(targets[i])) continue;
+                if (DeviceExists(devices[i])) {
+                    targets[i].back = Clock::now();
+                } else {
+                    pending = true;
+                }
+            }
+            auto now = Clock::now();
+            if (!pending || now >= deadline) break;
+            uint64_t seen = events;
+            changed.wait_until(lock, std::min(deadline, now + options.poll_interval),
+                               [&] { return events != seen; });
+        }
+    }
+    monitor.Stop();
+
+    std::vector<core::Result<PciRescanTiming>> results;
+    results.reserve(devices.size());
+    for (std::size_t i = 0; i < devices.size(); ++i) {
+        const auto& target = targets[i];
+        if (auto error = failed(target)) {
+            results.push_back(core::Result<PciRescanTiming>::Err(error));
+            continue;
+        }
+        if (!target.back) {
+            results.push_back(core::Result<PciRescanTiming>::Err(core::ErrorCode::kTimeout));
+            continue;
+        }
+        const auto& group = groups[target.group];
+        const auto& rescan = group.rescans[target.rescan];
+        results.push_back(core::Result<PciRescanTiming>::Ok(
+            PciRescanTiming{devices[i], group.removes[target.remove].took, rescan.took,
+                            since(rescan.start, *target.back)}));
+    }
+    return results;
 }
 
 }  // namespace plas::hal::pci
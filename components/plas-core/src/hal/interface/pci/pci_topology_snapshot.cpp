@@ -0,0 +1,316 @@
+#include "plas/hal/interface/pci/pci_topology_snapshot.h"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include <dirent.h>
+
+#include "plas/core/batch_io.h"
+#include "plas/core/error.h"
+
+namespace plas::hal::pci {
+
+core::Result<PciTopologySnapshot> PciTopologySnapshot::Build() {
+    // Read the generation first, so a change during the scan leaves the
+    // snapshot stale rather than silently missing it.
+    PciTopologySnapshot snapshot;
+    snapshot.generation_ = PciTopology::GetTopologyGeneration();
+
+    std::string devices_dir = PciTopology::GetSysfsRoot() + "/bus/pci/devices";
+    DIR* dir = ::opendir(devices_dir.c_str());
+    if (dir == nullptr) {
+        return core::Result<PciTopologySnapshot>::Err(
+            core::ErrorCode::kNotFound);
+    }
+    std::vector<PciAddress> addresses;
+    struct dirent* entry = nullptr;
+    while ((entry = ::readdir(dir)) != nullptr) {
+        if (entry->d_name[0] == '.') continue;
+        PciAddress addr{};
+        if (PciAddress::Parse(entry->d_name, addr) == core::ErrorCode::kSuccess) {
+            addresses.push_back(addr);
+        }
+    }
+    ::closedir(dir);
+    std::sort(addresses.begin(), addresses.end(),
+              [](const PciAddress& a, const PciAddress& b) {
+                  return Key(a) < Key(b);
+              });
+
+    snapshot.nodes_.resize(addresses.size());
+    snapshot.links_.resize(addresses.size());
+    for (std::size_t i = 0; i < addresses.size(); ++i) {
+        ReadLinks(addresses[i], snapshot.nodes_[i], snapshot.links_[i]);
+    }
+    ReadAttributes(snapshot.nodes_.data(), snapshot.nodes_.size());
+    snapshot.Relink();
+
+    return core::Result<PciTopologySnapshot>::Ok(std::move(snapshot));
+}
+
+void PciTopologySnapshot::ReadDevice(const PciAddress& addr,
+                                     PciDeviceNode& node, Links& links) {
+    ReadLinks(addr, node, links);
+    ReadAttributes(&node, 1);
+}
+
+void PciTopologySnapshot::ReadLinks(const PciAddress& addr,
+                                    PciDeviceNode& node, Links& links) {
+    node.address = addr;
+    node.sysfs_path = PciTopology::GetSysfsPath(addr);
+
+    char resolved[PATH_MAX];
+    if (::realpath(node.sysfs_path.c_str(), resolved) != nullptr) {
+        auto path = PciTopology::ParseTopologyPath(resolved);
+        if (path.IsOk()) {
+            links.path = std::move(path.Value());
+        }
+    }
+    if (links.path.empty()) {
+        links.path.push_back(addr);
+    }
+}
+
+void PciTopologySnapshot::ReadAttributes(PciDeviceNode* nodes,
+                                         std::size_t count) {
+    // Same files and parsing as PciTopology::ReadHeaderInfo/ReadNumaInfo.
+    constexpr std::size_t kBatch = 64;  // devices per batch
+    struct Files {
+        std::array<core::Byte, kLegacyConfigSpaceSize> config;
+        std::array<char, 16> numa_node;
+        std::array<char, 4096> local_cpulist;  // sysfs caps it at a page
+    };
+    std::vector<Files> files(std::min(kBatch, count));
+    std::vector<core::BatchRead> reads;
+    auto add = [&](const std::string& path, void* buffer, std::size_t length) {
+        core::BatchRead read;
+        read.path = path;
+        read.buffer = buffer;
+        read.length = length;
+        reads.push_back(std::move(read));
+    };
+
+    for (std::size_t first = 0; first < count; first += kBatch) {
+        std::size_t n = std::min(kBatch, count - first);
+        reads.clear();
+        for (std::size_t k = 0; k < n; ++k) {
+            const auto& path = nodes[first + k].sysfs_path;
+            auto& f = files[k];
+            add(path + "/config", f.config.data(), f.config.size());
+            add(path + "/numa_node", f.numa_node.data(), f.numa_node.size());
+            add(path + "/local_cpulist", f.local_cpulist.data(),
+                f.local_cpulist.size());
+        }
+        core::BatchReader::ForThisThread().Read(reads);
+
+        auto text = [&](std::size_t i) {
+            const auto& read = reads[i];
+            return read.error ? std::string_view()
+                              : std::string_view(
+                                    static_cast<const char*>(read.buffer),
+                                    read.transferred);
+        };
+        for (std::size_t k = 0; k < n; ++k) {
+            auto& node = nodes[first + k];
+            const auto& config = reads[3 * k];
+            node.port_type = PciePortType::kUnknown;
+            node.is_bridge = false;
+            if (!config.error && config.transferred > 0) {
+                PciTopology::ParseHeaderInfo(files[k].config.data(),
+                                             config.transferred,
+                                             node.port_type, node.is_bridge);
+            }
+            PciTopology::ParseNumaInfo(text(3 * k + 1), text(3 * k + 2), node);
+        }
+    }
+}
+
+void PciTopologySnapshot::Relink() {
+    index_.clear();
+    index_.reserve(nodes_.size());
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        index_.emplace(Key(nodes_[i].address), i);
+        links_[i].children.clear();
+        links_[i].root_port.reset();
+    }
+
+    // Child lists and root ports, now that every port type is known. Root
+    // port rule as in PciTopology::FindRootPort.
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        auto& links = links_[i];
+        if (links.path.size() < 2) {
+            continue;
+        }
+        auto parent = IndexOf(links.path[links.path.size() - 2]);
+        if (parent) {
+            links_[*parent].children.push_back(i);
+        }
+        for (std::size_t k = 0; k + 1 < links.path.size(); ++k) {
+            auto ancestor = IndexOf(links.path[k]);
+            if (ancestor &&
+                nodes_[*ancestor].port_type == PciePortType::kRootPort) {
+                links.root_port = links.path[k];
+                break;
+            }
+        }
+        if (!links.root_port) {
+            links.root_port = links.path.front();
+        }
+    }
+}
+
+core::Result<void> PciTopologySnapshot::Apply(const PciHotplugEvent& event) {
+    // As in Build(): read the generation before touching sysfs.
+    auto generation = PciTopology::GetTopologyGeneration();
+    const auto& addr = event.address;
+
+    if (event.action == PciHotplugAction::kAdd) {
+        if (!PciTopology::DeviceExists(addr)) {
+            return core::Result<void>::Err(core::ErrorCode::kNotFound);
+        }
+        PciDeviceNode node{};
+        Links links;
+        ReadDevice(addr, node, links);
+        auto at = std::lower_bound(
+            nodes_.begin(), nodes_.end(), Key(addr),
+            [](const PciDeviceNode& n, uint32_t key) {
+                return Key(n.address) < key;
+            });
+        auto i = static_cast<std::size_t>(at - nodes_.begin());
+        if (at != nodes_.end() && at->address == addr) {
+            nodes_[i] = std::move(node);
+            links_[i] = std::move(links);
+        } else {
+            nodes_.insert(at, std::move(node));
+            links_.insert(links_.begin() + static_cast<std::ptrdiff_t>(i),
+                          std::move(links));
+        }
+    } else {
+        // The device and everything whose path runs through it.
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < nodes_.size(); ++i) {
+            const auto& path = links_[i].path;
+            if (std::find(path.begin(), path.end(), addr) != path.end()) {
+                continue;
+            }
+            if (kept != i) {
+                nodes_[kept] = std::move(nodes_[i]);
+                links_[kept] = std::move(links_[i]);
+            }
+            ++kept;
+        }
+        nodes_.resize(kept);
+        links_.resize(kept);
+    }
+
+    Relink();
+    generation_ = generation;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> PciTopologySnapshot::Refresh() {
+    auto rebuilt = Build();
+    if (rebuilt.IsError()) {
+        return core::Result<void>::Err(rebuilt.Error());
+    }
+    *this = std::move(rebuilt.Value());
+    return core::Result<void>::Ok();
+}
+
+bool PciTopologySnapshot::IsStale() const {
+    return generation_ != PciTopology::GetTopologyGeneration();
+}
+
+std::optional<std::size_t> PciTopologySnapshot::IndexOf(
+    const PciAddress& addr) const {
+    auto it = index_.find(Key(addr));
+    if (it == index_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+bool PciTopologySnapshot::Contains(const PciAddress& addr) const {
+    return index_.count(Key(addr)) != 0;
+}
+
+core::Result<PciDeviceNode> PciTopologySnapshot::GetDeviceInfo(
+    const PciAddress& addr) const {
+    auto index = IndexOf(addr);
+    if (!index) {
+        return core::Result<PciDeviceNode>::Err(core::ErrorCode::kNotFound);
+    }
+    return core::Result<PciDeviceNode>::Ok(nodes_[*index]);
+}
+
+core::Result<std::optional<PciAddress>> PciTopologySnapshot::FindParent(
+    const PciAddress& addr) const {
+    auto index = IndexOf(addr);
+    if (!index) {
+        return core::Result<std::optional<PciAddress>>::Err(
+            core::ErrorCode::kNotFound);
+    }
+    const auto& path = links_[*index].path;
+    if (path.size() < 2) {
+        return core::Result<std::optional<PciAddress>>::Ok(std::nullopt);
+    }
+    return core::Result<std::optional<PciAddress>>::Ok(path[path.size() - 2]);
+}
+
+core::Result<std::vector<PciAddress>> PciTopologySnapshot::FindChildren(
+    const PciAddress& bridge_addr) const {
+    auto index = IndexOf(bridge_addr);
+    if (!index) {
+        return core::Result<std::vector<PciAddress>>::Err(
+            core::ErrorCode::kNotFound);
+    }
+    std::vector<PciAddress> children;
+    children.reserve(links_[*index].children.size());
+    for (auto child : links_[*index].children) {
+        children.push_back(nodes_[child].address);
+    }
+    return core::Result<std::vector<PciAddress>>::Ok(std::move(children));
+}
+
+core::Result<PciAddress> PciTopologySnapshot::FindRootPort(
+    const PciAddress& addr) const {
+    auto index = IndexOf(addr);
+    if (!index || !links_[*index].root_port) {
+        return core::Result<PciAddress>::Err(core::ErrorCode::kNotFound);
+    }
+    return core::Result<PciAddress>::Ok(*links_[*index].root_port);
+}
+
+core::Result<std::vector<PciDeviceNode>> PciTopologySnapshot::GetPathToRoot(
+    const PciAddress& addr) const {
+    auto index = IndexOf(addr);
+    if (!index) {
+        return core::Result<std::vector<PciDeviceNode>>::Err(
+            core::ErrorCode::kNotFound);
+    }
+    const auto& path = links_[*index].path;
+    std::vector<PciDeviceNode> nodes;
+    nodes.reserve(path.size());
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        auto ancestor = IndexOf(*it);
+        if (ancestor) {
+            nodes.push_back(nodes_[*ancestor]);
+            continue;
+        }
+        // Not listed under bus/pci/devices (should not happen on a live
+        // system); report what the path tells us.
+        PciDeviceNode node{};
+        node.address = *it;
+        node.port_type = PciePortType::kUnknown;
+        node.is_bridge = false;
+        node.sysfs_path = PciTopology::GetSysfsPath(*it);
+        nodes.push_back(std::move(node));
+    }
+    return core::Result<std::vector<PciDeviceNode>>::Ok(std::move(nodes));
+}
+
+}  // namespace plas::hal::pci
@@ -0,0 +1,601 @@
+#include "plas/hal/interface/pci/spdm.h"
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <tuple>
+
+#include "plas/core/error.h"
+#include "plas/core/executor.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+
+namespace plas::hal::pci::spdm {
+
+namespace {
+
+constexpr uint8_t kVersion10 = 0x10;
+constexpr std::size_t kMaxMessageDwords = kMaxMessageSize / sizeof(core::DWord);
+constexpr std::size_t kNonceSize = 32;
+constexpr uint16_t kCertPortion = 0x400;
+constexpr uint8_t kMeasSpecDmtf = 0x01;
+
+// Everything the engine can carry; it never verifies signatures itself.
+constexpr uint32_t kOfferedAsym = 0x1FF;
+constexpr uint32_t kOfferedHash =
+    hash_algo::kSha256 | hash_algo::kSha384 | hash_algo::kSha512;
+
+/// SPDM request assembled straight into DOE payload DWords.
+struct Request {
+    std::array<core::DWord, 16> words{};
+    std::size_t size = 0;  // bytes
+
+    Request(uint8_t version, RequestCode code, uint8_t param1,
+            uint8_t param2) {
+        Put(version);
+        Put(static_cast<uint8_t>(code));
+        Put(param1);
+        Put(param2);
+    }
+
+    void Put(uint8_t byte) {
+        words[size / 4] |= static_cast<core::DWord>(byte) << (8 * (size % 4));
+        ++size;
+    }
+    void Put16(uint16_t value) {
+        Put(static_cast<uint8_t>(value));
+        Put(static_cast<uint8_t>(value >> 8));
+    }
+    void Put32(uint32_t value) {
+        Put16(static_cast<uint16_t>(value));
+        Put16(static_cast<uint16_t>(value >> 16));
+    }
+    void PutZeros(std::size_t count) { size += count; }
+
+    uint8_t At(std::size_t i) const {
+        return static_cast<uint8_t>(words[i / 4] >> (8 * (i % 4)));
+    }
+    std::size_t Dwords() const { return (size + 3) / 4; }
+};
+
+/// Read-only byte view of a response held in DOE payload DWords. Valid
+/// until the session's next exchange.
+struct Message {
+    const core::DWord* words = nullptr;
+    std::size_t size = 0;  // bytes, DOE padding included
+
+    uint8_t At(std::size_t i) const {
+        return static_cast<uint8_t>(words[i / 4] >> (8 * (i % 4)));
+    }
+    uint16_t Le16(std::size_t i) const {
+        return static_cast<uint16_t>(At(i) | (At(i + 1) << 8));
+    }
+    uint32_t Le24(std::size_t i) const {
+        return At(i) | (static_cast<uint32_t>(At(i + 1)) << 8) |
+               (static_cast<uint32_t>(At(i + 2)) << 16);
+    }
+    uint32_t Le32(std::size_t i) const {
+        return Le16(i) | (static_cast<uint32_t>(Le16(i + 2)) << 16);
+    }
+    void Copy(std::size_t i, std::size_t length,
+              std::vector<uint8_t>& out) const {
+        out.reserve(out.size() + length);
+        for (std::size_t k = 0; k < length; ++k) {
+            out.push_back(At(i + k));
+        }
+    }
+};
+
+core::ErrorCode MapError(SpdmError error) {
+    switch (error) {
+        case SpdmError::kUnsupportedRequest:
+        case SpdmError::kVersionMismatch:
+            return core::ErrorCode::kNotSupported;
+        case SpdmError::kBusy:
+        case SpdmError::kResponseNotReady:
+            return core::ErrorCode::kTimeout;
+        default:
+            return core::ErrorCode::kIOError;
+    }
+}
+
+/// One requester conversation with one responder.
+class Session {
+public:
+    Session(PciDoe& doe, Bdf bdf, ConfigOffset doe_offset,
+            const EngineOptions& options)
+        : doe_(doe), bdf_(bdf), doe_offset_(doe_offset), options_(options) {}
+
+    /// Send `request` and return the `expected` response, retrying Busy and
+    /// following ResponseNotReady with RESPOND_IF_READY.
+    core::Result<Message> Exchange(const Request& request,
+                                   ResponseCode expected) {
+        auto deadline =
+            std::chrono::steady_clock::now() + options_.retry_timeout;
+        auto backoff = options_.backoff;
+        auto wait = [&](std::chrono::microseconds period) {
+            if (std::chrono::steady_clock::now() + period > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(period);
+            return true;
+        };
+
+        Request current = request;
+        for (;;) {
+            auto response = doe_.DoeExchangePooled(
+                bdf_, doe_offset_, kCmaProtocol, current.words.data(),
+                current.Dwords(), kMaxMessageDwords);
+            if (response.IsError()) {
+                return core::Result<Message>::Err(response.Error());
+            }
+            response_ = std::move(response.Value());
+            Message message{response_.Data(),
+                            response_.Size() * sizeof(core::DWord)};
+            if (message.size < 4) {
+                return core::Result<Message>::Err(core::ErrorCode::kIOError);
+            }
+
+            auto code = static_cast<ResponseCode>(message.At(1));
+            if (code == expected) {
+                // VERSION always answers in 1.0; the rest echo the request.
+                if (code != ResponseCode::kVersion &&
+                    message.At(0) != request.At(0)) {
+                    return core::Result<Message>::Err(
+                        core::ErrorCode::kIOError);
+                }
+                last_error_ = SpdmError::kNone;
+                return core::Result<Message>::Ok(message);
+            }
+            if (code != ResponseCode::kError) {
+                return core::Result<Message>::Err(core::ErrorCode::kIOError);
+            }
+
+            last_error_ = static_cast<SpdmError>(message.At(2));
+            if (last_error_ == SpdmError::kBusy) {
+                if (!wait(backoff)) {
+                    return core::Result<Message>::Err(
+                        core::ErrorCode::kTimeout);
+                }
+                backoff *= 2;
+                current = request;
+                continue;
+            }
+            if (last_error_ == SpdmError::kResponseNotReady &&
+                message.size >= 8) {
+                // Extended data: RDTExponent, RequestCode, Token, RDTM.
+                auto rdt = std::chrono::microseconds(
+                    uint64_t{1} << std::min<uint8_t>(message.At(4), 20));
+                if (!wait(std::max(rdt, options_.backoff))) {
+                    return core::Result<Message>::Err(
+                        core::ErrorCode::kTimeout);
+                }
+                current = Request(request.At(0), RequestCode::kRespondIfReady,
+                                  message.At(5), message.At(6));
+                continue;
+            }
+            return core::Result<Message>::Err(MapError(last_error_));
+        }
+    }
+
+    /// The responder no longer holds the negotiated connection.
+    bool NeedsResync() const {
+        return last_error_ == SpdmError::kUnexpectedRequest ||
+               last_error_ == SpdmError::kRequestResynch;
+    }
+
+private:
+    PciDoe& doe_;
+    Bdf bdf_;
+    ConfigOffset doe_offset_;
+    const EngineOptions& options_;
+    DoePooledPayload response_;
+    SpdmError last_error_ = SpdmError::kNone;
+};
+
+core::Result<Connection> Negotiate(Session& session,
+                                   const EngineOptions& options) {
+    using R = core::Result<Connection>;
+    Connection connection;
+
+    auto version = session.Exchange(
+        Request(kVersion10, RequestCode::kGetVersion, 0, 0),
+        ResponseCode::kVersion);
+    if (version.IsError()) {
+        return R::Err(version.Error());
+    }
+    const auto& v = version.Value();
+    if (v.size < 6 || v.size < 6u + 2u * v.At(5)) {
+        return R::Err(core::ErrorCode::kIOError);
+    }
+    for (std::size_t i = 0; i < v.At(5); ++i) {
+        auto entry = static_cast<uint8_t>(v.Le16(6 + 2 * i) >> 8);
+        if (entry >= kVersion10 && entry <= options.max_version &&
+            entry > connection.version) {
+            connection.version = entry;
+        }
+    }
+    if (connection.version == 0) {
+        return R::Err(core::ErrorCode::kNotSupported);
+    }
+    uint8_t ver = connection.version;
+
+    Request caps(ver, RequestCode::kGetCapabilities, 0, 0);
+    if (ver >= 0x11) {
+        caps.PutZeros(4);  // reserved, CTExponent 0, reserved
+        caps.Put32(0);     // requester flags: no mutual authentication
+    }
+    if (ver >= 0x12) {
+        caps.Put32(kMaxMessageSize);  // DataTransferSize
+        caps.Put32(kMaxMessageSize);  // MaxSPDMmsgSize
+    }
+    auto capabilities = session.Exchange(caps, ResponseCode::kCapabilities);
+    if (capabilities.IsError()) {
+        return R::Err(capabilities.Error());
+    }
+    const auto& c = capabilities.Value();
+    if (c.size < 12) {
+        return R::Err(core::ErrorCode::kIOError);
+    }
+    connection.capabilities.ct_exponent = c.At(5);
+    connection.capabilities.flags = c.Le32(8);
+    if (ver >= 0x12 && c.size >= 20) {
+        connection.capabilities.data_transfer_size = c.Le32(12);
+        connection.capabilities.max_message_size = c.Le32(16);
+    }
+
+    Request algorithms(ver, RequestCode::kNegotiateAlgorithms, 0, 0);
+    algorithms.Put16(32);  // Length: no extended algorithms, no AlgStructs
+    algorithms.Put(kMeasSpecDmtf);
+    algorithms.Put(0);     // OtherParamsSupport
+    algorithms.Put32(kOfferedAsym);
+    algorithms.Put32(kOfferedHash);
+    algorithms.PutZeros(16);  // reserved, ExtAsymCount, ExtHashCount
+    auto selected = session.Exchange(algorithms, ResponseCode::kAlgorithms);
+    if (selected.IsError()) {
+        return R::Err(selected.Error());
+    }
+    const auto& a = selected.Value();
+    if (a.size < 20) {
+        return R::Err(core::ErrorCode::kIOError);
+    }
+    connection.algorithms.measurement_spec = a.At(6);
+    connection.algorithms.measurement_hash = a.Le32(8);
+    connection.algorithms.base_asym = a.Le32(12);
+    connection.algorithms.base_hash = a.Le32(16);
+    // Certificates and signatures need exactly one known algorithm of each.
+    bool signs = connection.capabilities.flags &
+                 (cap_flag::kCert | cap_flag::kChal | cap_flag::kMeasSig);
+    if (signs && (SignatureSize(connection.algorithms.base_asym) == 0 ||
+                  HashSize(connection.algorithms.base_hash) == 0)) {
+        return R::Err(core::ErrorCode::kNotSupported);
+    }
+    return R::Ok(connection);
+}
+
+/// GET_DIGESTS, then GET_CERTIFICATE unless `cached` has the same digest.
+/// Returns true if `cached` was reused.
+core::Result<bool> FetchCertificate(Session& session,
+                                    const Connection& connection,
+                                    uint8_t slot,
+                                    std::optional<CertificateChain>& cached) {
+    using R = core::Result<bool>;
+    uint8_t ver = connection.version;
+    std::size_t hash_size = HashSize(connection.algorithms.base_hash);
+
+    auto digests = session.Exchange(
+        Request(ver, RequestCode::kGetDigests, 0, 0), ResponseCode::kDigests);
+    if (digests.IsError()) {
+        return R::Err(digests.Error());
+    }
+    const auto& d = digests.Value();
+    uint8_t mask = d.At(3);
+    if (slot > 7 || !(mask & (1u << slot))) {
+        return R::Err(core::ErrorCode::kNotFound);
+    }
+    std::size_t index = static_cast<std::size_t>(
+        __builtin_popcount(mask & ((1u << slot) - 1)));
+    if (d.size < 4 + (index + 1) * hash_size) {
+        return R::Err(core::ErrorCode::kIOError);
+    }
+    std::vector<uint8_t> digest;
+    d.Copy(4 + index * hash_size, hash_size, digest);
+    if (cached && cached->slot == slot && cached->digest == digest) {
+        return R::Ok(true);
+    }
+
+    CertificateChain chain;
+    chain.slot = slot;
+    chain.digest = std::move(digest);
+    for (;;) {
+        Request request(ver, RequestCode::kGetCertificate, slot, 0);
+        request.Put16(static_cast<uint16_t>(chain.chain.size()));
+        request.Put16(kCertPortion);
+        auto portion =
+            session.Exchange(request, ResponseCode::kCertificate);
+        if (portion.IsError()) {
+            return R::Err(portion.Error());
+        }
+        const auto& p = portion.Value();
+        if (p.size < 8) {
+            return R::Err(core::ErrorCode::kIOError);
+        }
+        uint16_t length = p.Le16(4);
+        uint16_t remainder = p.Le16(6);
+        if (p.size < 8u + length ||
+            (length == 0 && remainder != 0) ||
+            chain.chain.size() + length + remainder > 0xFFFF) {
+            return R::Err(core::ErrorCode::kIOError);
+        }
+        p.Copy(8, length, chain.chain);
+        if (remainder == 0) {
+            break;
+        }
+    }
+    cached = std::move(chain);
+    return R::Ok(false);
+}
+
+core::Result<Measurements> GetMeasurements(Session& session,
+                                           const Connection& connection,
+                                           const EngineOptions& options) {
+    using R = core::Result<Measurements>;
+    uint8_t ver = connection.version;
+    bool sign = options.signed_measurements;
+    std::size_t sig_size =
+        sign ? SignatureSize(connection.algorithms.base_asym) : 0;
+
+    Request request(ver, RequestCode::kGetMeasurements, sign ? 1 : 0,
+                    options.measurement_operation);
+    if (sign) {
+        std::random_device random;
+        for (std::size_t i = 0; i < kNonceSize; ++i) {
+            request.Put(static_cast<uint8_t>(random()));
+        }
+        if (ver >= 0x11) {
+            request.Put(options.cert_slot);
+        }
+    }
+    auto response = session.Exchange(request, ResponseCode::kMeasurements);
+    if (response.IsError()) {
+        return R::Err(response.Error());
+    }
+    const auto& m = response.Value();
+    if (m.size < 8) {
+        return R::Err(core::ErrorCode::kIOError);
+    }
+
+    Measurements out;
+    if (options.measurement_operation == 0) {
+        out.total_indices = m.At(2);
+    }
+    std::size_t end = 8 + m.Le24(5);
+    if (end > m.size) {
+        return R::Err(core::ErrorCode::kIOError);
+    }
+    for (std::size_t p = 8; p < end;) {
+        if (p + 4 > end || p + 4u + m.Le16(p + 2) > end) {
+            return R::Err(core::ErrorCode::kIOError);
+        }
+        MeasurementBlock block;
+        block.index = m.At(p);
+        block.spec = m.At(p + 1);
+        m.Copy(p + 4, m.Le16(p + 2), block.data);
+        p += 4 + block.data.size();
+        out.blocks.push_back(std::move(block));
+    }
+    if (out.blocks.size() != m.At(4)) {
+        return R::Err(core::ErrorCode::kIOError);
+    }
+
+    // Nonce and opaque data follow from 1.1 on, and on 1.0 when signed.
+    std::size_t p = end;
+    if (ver >= 0x11 || sign) {
+        if (p + kNonceSize + 2 > m.size) {
+            return R::Err(core::ErrorCode::kIOError);
+        }
+        m.Copy(p, kNonceSize, out.nonce);
+        p += kNonceSize;
+        std::size_t opaque = m.Le16(p);
+        p += 2;
+        if (p + opaque > m.size) {
+            return R::Err(core::ErrorCode::kIOError);
+        }
+        m.Copy(p, opaque, out.opaque);
+        p += opaque;
+    }
+    if (sign) {
+        if (sig_size == 0 || p + sig_size > m.size) {
+            return R::Err(core::ErrorCode::kIOError);
+        }
+        for (std::size_t i = 0; i < request.size; ++i) {
+            out.transcript.push_back(request.At(i));
+        }
+        m.Copy(0, p, out.transcript);
+        m.Copy(p, sig_size, out.signature);
+    }
+    return R::Ok(std::move(out));
+}
+
+}  // namespace
+
+std::size_t HashSize(uint32_t base_hash_algo) {
+    switch (base_hash_algo) {
+        case 1u << 0: return 32;  // SHA-256
+        case 1u << 1: return 48;  // SHA-384
+        case 1u << 2: return 64;  // SHA-512
+        case 1u << 3: return 32;  // SHA3-256
+        case 1u << 4: return 48;  // SHA3-384
+        case 1u << 5: return 64;  // SHA3-512
+        default: return 0;
+    }
+}
+
+std::size_t SignatureSize(uint32_t base_asym_algo) {
+    switch (base_asym_algo) {
+        case 1u << 0:             // RSASSA-2048
+        case 1u << 1: return 256;  // RSAPSS-2048
+        case 1u << 2:             // RSASSA-3072
+        case 1u << 3: return 384;  // RSAPSS-3072
+        case 1u << 4: return 64;   // ECDSA P-256
+        case 1u << 5:             // RSASSA-4096
+        case 1u << 6: return 512;  // RSAPSS-4096
+        case 1u << 7: return 96;   // ECDSA P-384
+        case 1u << 8: return 132;  // ECDSA P-521
+        default: return 0;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Pimpl definition
+// ---------------------------------------------------------------------------
+struct Engine::Impl {
+    /// What is remembered about one responder. `mutex` is held for a whole
+    /// Attest(), so one responder never sees interleaved SPDM sequences.
+    struct Entry {
+        std::mutex mutex;
+        uint64_t generation = 0;
+        std::optional<Connection> connection;
+        std::optional<CertificateChain> certificate;
+    };
+
+    using Key = std::tuple<const PciDoe*, uint16_t, ConfigOffset>;
+
+    static Key KeyOf(const Target& target) {
+        return Key{target.doe, target.bdf.Pack(), target.doe_offset};
+    }
+
+    std::shared_ptr<Entry> GetEntry(const Target& target) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& entry = entries[KeyOf(target)];
+        if (!entry) {
+            entry = std::make_shared<Entry>();
+        }
+        return entry;
+    }
+
+    EngineOptions options;
+    mutable std::mutex mutex;  // entries
+    std::map<Key, std::shared_ptr<Entry>> entries;
+};
+
+Engine::Engine(EngineOptions options) : impl_(std::make_unique<Impl>()) {
+    impl_->options = options;
+}
+
+Engine::~Engine() = default;
+
+core::Result<Attestation> Engine::Attest(const Target& target) {
+    using R = core::Result<Attestation>;
+    if (!target.doe) {
+        return R::Err(core::ErrorCode::kInvalidArgument);
+    }
+    const auto& options = impl_->options;
+    auto entry = impl_->GetEntry(target);
+    std::lock_guard<std::mutex> lock(entry->mutex);
+
+    uint64_t generation = PciTopology::GetTopologyGeneration();
+    if (entry->generation != generation) {
+        entry->connection.reset();
+        entry->certificate.reset();
+        entry->generation = generation;
+    }
+
+    Session session(*target.doe, target.bdf, target.doe_offset, options);
+    for (;;) {
+        Attestation out;
+        out.reused_connection = entry->connection.has_value();
+        if (!entry->connection) {
+            auto connection = Negotiate(session, options);
+            if (connection.IsError()) {
+                return R::Err(connection.Error());
+            }
+            entry->connection = connection.Value();
+        }
+        const Connection& connection = *entry->connection;
+        uint32_t flags = connection.capabilities.flags;
+
+        std::error_code error;
+        if (options.fetch_certificate && (flags & cap_flag::kCert)) {
+            auto reused = FetchCertificate(session, connection,
+                                           options.cert_slot,
+                                           entry->certificate);
+            if (reused.IsOk()) {
+                out.reused_certificate = reused.Value();
+                out.certificate = entry->certificate;
+            } else {
+                error = reused.Error();
+            }
+        }
+        if (!error && (flags & (cap_flag::kMeasNoSig | cap_flag::kMeasSig))) {
+            if (options.signed_measurements && !(flags & cap_flag::kMeasSig)) {
+                return R::Err(core::ErrorCode::kNotSupported);
+            }
+            auto measurements = GetMeasurements(session, connection, options);
+            if (measurements.IsOk()) {
+                out.measurements = std::move(measurements.Value());
+            } else {
+                error = measurements.Error();
+            }
+        } else if (!error && options.signed_measurements) {
+            return R::Err(core::ErrorCode::kNotSupported);
+        }
+
+        if (!error) {
+            out.connection = connection;
+            return R::Ok(std::move(out));
+        }
+        // A reset responder rejects requests of the cached connection:
+        // negotiate again, once.
+        entry->connection.reset();
+        if (!out.reused_connection || !session.NeedsResync()) {
+            return R::Err(error);
+        }
+    }
+}
+
+std::vector<core::Result<Attestation>> Engine::AttestAll(
+    const std::vector<Target>& targets) {
+    using R = core::Result<Attestation>;
+    std::vector<R> results(targets.size(),
+                           R::Err(core::ErrorCode::kInvalidArgument));
+    core::Executor::Shared().ParallelFor(
+        targets.size(), [&](std::size_t i) { results[i] = Attest(targets[i]); },
+        impl_->options.max_parallel);
+    return results;
+}
+
+std::optional<Connection> Engine::CachedConnection(
+    const Target& target) const {
+    std::shared_ptr<Impl::Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        auto it = impl_->entries.find(Impl::KeyOf(target));
+        if (it == impl_->entries.end()) {
+            return std::nullopt;
+        }
+        entry = it->second;
+    }
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    if (entry->generation != PciTopology::GetTopologyGeneration()) {
+        return std::nullopt;
+    }
+    return entry->connection;
+}
+
+void Engine::Forget(const Target& target) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->entries.erase(Impl::KeyOf(target));
+}
+
+void Engine::Clear() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->entries.clear();
+}
+
+}  // namespace plas::hal::pci::spdm
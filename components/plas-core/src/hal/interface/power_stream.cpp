@@ -0,0 +1,136 @@
+#include "plas/hal/interface/power_stream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "plas/core/error.h"
+
+namespace plas::hal {
+
+namespace {
+
+constexpr uint64_t kNsPerSecond = 1'000'000'000;
+
+uint64_t NowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+/// Offset of sample `index` at `rate_hz`, exact and without overflowing
+/// index * 1e9.
+uint64_t SampleOffsetNs(uint64_t index, uint32_t rate_hz) {
+    return (index / rate_hz) * kNsPerSecond +
+           (index % rate_hz) * kNsPerSecond / rate_hz;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// PowerCapture
+// ---------------------------------------------------------------------------
+
+struct PowerCapture::Impl {
+    std::mutex control;  // serializes Start/Stop
+    std::thread thread;
+    std::error_code error;  // written by the thread, read after join
+    std::atomic<bool> running{false};
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> samples{0};
+
+    void Run(PowerSamplingOptions options, PowerSampleRing& ring,
+             BlockReader reader) {
+        std::vector<PowerSample> block(options.block_samples);
+        const uint64_t start_ns = NowNs();
+        uint64_t index = 0;
+        while (!stop.load(std::memory_order_acquire)) {
+            auto result = reader(block.data(), block.size());
+            if (result.IsError()) {
+                error = result.Error();
+                return;
+            }
+            std::size_t n = std::min(result.Value(), block.size());
+            for (std::size_t i = 0; i < n; ++i) {
+                block[i].timestamp_ns =
+                    start_ns + SampleOffsetNs(index + i, options.rate_hz);
+            }
+            index += n;
+            ring.Push(block.data(), n);
+            samples.fetch_add(n, std::memory_order_relaxed);
+            if (n > 0 && options.on_block) {
+                options.on_block(n);
+            }
+        }
+    }
+};
+
+PowerCapture::PowerCapture() : impl_(std::make_unique<Impl>()) {}
+
+PowerCapture::~PowerCapture() {
+    Stop();
+}
+
+core::Result<void> PowerCapture::Validate(const PowerSamplingOptions& options,
+                                          const PowerSampleRing& ring) {
+    if (options.rate_hz == 0 || options.block_samples == 0 ||
+        ring.Capacity() < options.block_samples) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> PowerCapture::Start(PowerSamplingOptions options,
+                                       PowerSampleRing& ring,
+                                       BlockReader reader) {
+    auto valid = Validate(options, ring);
+    if (valid.IsError()) {
+        return valid;
+    }
+    if (!reader) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::lock_guard lock(impl_->control);
+    if (impl_->thread.joinable()) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+    }
+    impl_->stop.store(false, std::memory_order_relaxed);
+    impl_->error = {};
+    impl_->samples.store(0, std::memory_order_relaxed);
+    impl_->thread = std::thread(
+        [impl = impl_.get(), options = std::move(options), &ring,
+         reader = std::move(reader)]() mutable {
+            impl->Run(std::move(options), ring, std::move(reader));
+        });
+    impl_->running.store(true, std::memory_order_relaxed);
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> PowerCapture::Stop() {
+    std::lock_guard lock(impl_->control);
+    if (!impl_->thread.joinable()) {
+        return core::Result<void>::Ok();
+    }
+    impl_->stop.store(true, std::memory_order_release);
+    impl_->thread.join();
+    impl_->running.store(false, std::memory_order_relaxed);
+    if (impl_->error) {
+        return core::Result<void>::Err(impl_->error);
+    }
+    return core::Result<void>::Ok();
+}
+
+bool PowerCapture::IsRunning() const {
+    return impl_->running.load(std::memory_order_relaxed);
+}
+
+uint64_t PowerCapture::SampleCount() const {
+    return impl_->samples.load(std::memory_order_relaxed);
+}
+
+}  // namespace plas::hal
@@ -0,0 +1,523 @@
+#include "plas/hal/interface/serial_log_capture.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "plas/core/error.h"
+#include "plas/core/spsc_ring.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PLAS_LOG_CAPTURE_HAS_SIMD 1
+#include <emmintrin.h>
+#endif
+
+namespace plas::hal {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t kNoState = ~uint32_t{0};
+constexpr size_t kChunkBytes = 512;
+constexpr auto kIdleWait = std::chrono::milliseconds(10);
+
+/// One bulk read, stamped when read() returned.
+struct RxChunk {
+    uint64_t timestamp_ns = 0;
+    uint32_t length = 0;
+    std::array<core::Byte, kChunkBytes> data{};
+};
+
+/// Append-only text file rotated by size: path -> path.1 -> path.2 ...
+class RotatingFile {
+public:
+    ~RotatingFile() { Close(); }
+
+    bool Open(const std::string& path, size_t max_bytes, size_t max_files) {
+        path_ = path;
+        max_bytes_ = max_bytes;
+        max_files_ = max_files;
+        failed_ = false;
+        file_ = std::fopen(path_.c_str(), "a");
+        if (file_ == nullptr) {
+            return false;
+        }
+        std::setvbuf(file_, nullptr, _IOFBF, 64 * 1024);
+        std::fseek(file_, 0, SEEK_END);
+        long pos = std::ftell(file_);
+        size_ = pos > 0 ? static_cast<size_t>(pos) : 0;
+        return true;
+    }
+
+    bool IsOpen() const { return file_ != nullptr; }
+    bool Failed() const { return failed_; }
+
+    void Write(const char* header, size_t header_len, std::string_view text) {
+        if (file_ == nullptr) {
+            return;
+        }
+        const size_t record = header_len + text.size() + 1;
+        if (size_ > 0 && size_ + record > max_bytes_) {
+            Rotate();
+            if (file_ == nullptr) {
+                return;
+            }
+        }
+        if (std::fwrite(header, 1, header_len, file_) != header_len ||
+            std::fwrite(text.data(), 1, text.size(), file_) != text.size() ||
+            std::fputc('\n', file_) == EOF) {
+            failed_ = true;
+        }
+        size_ += record;
+    }
+
+    void Flush() {
+        if (file_ != nullptr && std::fflush(file_) != 0) {
+            failed_ = true;
+        }
+    }
+
+    void Close() {
+        if (file_ != nullptr) {
+            if (std::fclose(file_) != 0) {
+                failed_ = true;
+            }
+            file_ = nullptr;
+        }
+    }
+
+private:
+    std::string Numbered(size_t index) const {
+        return index == 0 ? path_ : path_ + "." + std::to_string(index);
+    }
+
+    void Rotate() {
+        Close();
+        for (size_t i = max_files_ - 1; i > 0; --i) {
+            std::rename(Numbered(i - 1).c_str(), Numbered(i).c_str());
+        }
+        file_ = std::fopen(path_.c_str(), "w");  // max_files == 1: truncate
+        if (file_ == nullptr) {
+            failed_ = true;
+            return;
+        }
+        std::setvbuf(file_, nullptr, _IOFBF, 64 * 1024);
+        size_ = 0;
+    }
+
+    std::string path_;
+    size_t max_bytes_ = 0;
+    size_t max_files_ = 1;
+    std::FILE* file_ = nullptr;
+    size_t size_ = 0;
+    bool failed_ = false;
+};
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// LinePatternMatcher
+// ---------------------------------------------------------------------------
+
+LinePatternMatcher::LinePatternMatcher(const std::vector<std::string>& patterns)
+    : pattern_count_(patterns.size()) {
+    auto add_state = [this] {
+        next_.resize(next_.size() + 256, kNoState);
+        fail_.push_back(0);
+        output_.emplace_back();
+        return static_cast<uint32_t>(fail_.size() - 1);
+    };
+    add_state();  // root
+
+    // Trie of all patterns
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        if (patterns[i].empty()) {
+            continue;
+        }
+        uint32_t state = 0;
+        for (char ch : patterns[i]) {
+            const size_t slot = size_t{state} * 256 + static_cast<unsigned char>(ch);
+            if (next_[slot] == kNoState) {
+                const uint32_t created = add_state();
+                next_[slot] = created;
+            }
+            state = next_[slot];
+        }
+        output_[state].push_back(static_cast<uint32_t>(i));
+    }
+
+    // Breadth-first: resolve failure links and turn missing edges into
+    // DFA transitions, so Match() never follows a failure chain.
+    std::deque<uint32_t> queue;
+    for (size_t c = 0; c < 256; ++c) {
+        uint32_t& to = next_[c];
+        if (to == kNoState) {
+            to = 0;
+        } else {
+            fail_[to] = 0;
+            queue.push_back(to);
+        }
+    }
+    while (!queue.empty()) {
+        const uint32_t state = queue.front();
+        queue.pop_front();
+        const size_t base = size_t{state} * 256;
+        const size_t fail_base = size_t{fail_[state]} * 256;
+        for (size_t c = 0; c < 256; ++c) {
+            const uint32_t via_fail = next_[fail_base + c];
+            uint32_t& to = next_[base + c];
+            if (to == kNoState) {
+                to = via_fail;
+            } else {
+                fail_[to] = via_fail;
+                output_[to].insert(output_[to].end(), output_[via_fail].begin(),
+                                   output_[via_fail].end());
+                queue.push_back(to);
+            }
+        }
+    }
+    for (auto& out : output_) {
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    }
+}
+
+size_t LinePatternMatcher::Match(std::string_view text, std::vector<uint32_t>& hits) const {
+    hits.clear();
+    if (next_.empty()) {
+        return 0;
+    }
+    uint32_t state = 0;
+    for (char ch : text) {
+        state = next_[size_t{state} * 256 + static_cast<unsigned char>(ch)];
+        const auto& out = output_[state];
+        if (!out.empty()) {
+            hits.insert(hits.end(), out.begin(), out.end());
+        }
+    }
+    if (hits.size() > 1) {
+        std::sort(hits.begin(), hits.end());
+        hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+    }
+    return hits.size();
+}
+
+// ---------------------------------------------------------------------------
+// Pimpl definition
+// ---------------------------------------------------------------------------
+struct SerialLogCapture::Impl {
+    std::mutex control;  // serializes Start/Stop
+    SerialLogCaptureOptions options;
+    Reader reader;
+    LinePatternMatcher matcher;
+    std::unique_ptr<core::SpscRing<RxChunk>> ring;
+    RotatingFile file;
+    Clock::time_point start;
+
+    std::thread rx_thread;
+    std::thread match_thread;
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> stop{false};     // receive thread
+    std::atomic<bool> rx_done{false};  // matcher drains and exits
+
+    std::atomic<uint64_t> bytes_received{0};
+    std::atomic<uint64_t> bytes_dropped{0};
+    std::atomic<uint64_t> lines{0};
+    std::atomic<uint64_t> truncated_lines{0};
+    std::atomic<uint64_t> trigger_lines{0};
+    std::atomic<uint64_t> read_errors{0};
+    std::unique_ptr<std::atomic<uint64_t>[]> trigger_counts;
+
+    // Matcher thread only
+    LogLine line;
+    bool line_open = false;
+
+    void Receive() {
+        RxChunk chunk;
+        while (!stop.load(std::memory_order_acquire)) {
+            auto result = reader(chunk.data.data(), kChunkBytes, options.read_timeout);
+            if (result.IsError()) {
+                if (result.Error() != core::make_error_code(core::ErrorCode::kTimeout)) {
+                    read_errors.fetch_add(1, std::memory_order_relaxed);
+                    std::this_thread::sleep_for(options.read_timeout);
+                }
+                continue;
+            }
+            const size_t n = std::min(result.Value(), kChunkBytes);
+            if (n == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            chunk.timestamp_ns = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start)
+                    .count());
+            chunk.length = static_cast<uint32_t>(n);
+            bytes_received.fetch_add(n, std::memory_order_relaxed);
+            if (!ring->Push(chunk)) {
+                bytes_dropped.fetch_add(n, std::memory_order_relaxed);
+            }
+            wake.notify_one();
+        }
+    }
+
+    void MatchLoop() {
+        RxChunk batch[8];
+        for (;;) {
+            size_t n = ring->Pop(batch, 8);
+            if (n == 0) {
+                if (rx_done.load(std::memory_order_acquire)) {
+                    n = ring->Pop(batch, 8);  // last chunks after the final push
+                    if (n == 0) {
+                        break;
+                    }
+                } else {
+                    std::unique_lock lock(wake_mutex);
+                    wake.wait_for(lock, kIdleWait);
+                    continue;
+                }
+            }
+            for (size_t i = 0; i < n; ++i) {
+                Consume(batch[i]);
+            }
+        }
+        if (line_open) {
+            Emit(false);
+        }
+        file.Flush();
+    }
+
+    void Consume(const RxChunk& chunk) {
+        const core::Byte* p = chunk.data.data();
+        const core::Byte* end = p + chunk.length;
+        const size_t max_line = options.max_line_length;
+        while (p < end) {
+            if (!line_open) {
+                line.timestamp_ns = chunk.timestamp_ns;
+                line.text.clear();
+                line_open = true;
+            }
+            const core::Byte* nl = FindNewline(p, end);
+            size_t segment = static_cast<size_t>(nl - p);
+            while (line.text.size() + segment > max_line) {
+                const size_t room = max_line - line.text.size();
+                line.text.append(reinterpret_cast<const char*>(p), room);
+                p += room;
+                segment -= room;
+                Emit(true);
+                line.timestamp_ns = chunk.timestamp_ns;
+                line.text.clear();
+                line_open = true;
+            }
+            line.text.append(reinterpret_cast<const char*>(p), segment);
+            p = nl;
+            if (p < end) {
+                ++p;  // consume '\n'
+                Emit(false);
+            }
+        }
+    }
+
+    void Emit(bool truncated) {
+        line_open = false;
+        if (!truncated && !line.text.empty() && line.text.back() == '\r') {
+            line.text.pop_back();
+        }
+        line.truncated = truncated;
+        line.sequence = lines.fetch_add(1, std::memory_order_relaxed);
+        if (truncated) {
+            truncated_lines.fetch_add(1, std::memory_order_relaxed);
+        }
+        matcher.Match(line.text, line.triggers);
+
+        if (file.IsOpen()) {
+            char header[32];
+            const uint64_t us = line.timestamp_ns / 1000;
+            int len = std::snprintf(header, sizeof(header), "[%llu.%06llu] ",
+                                    static_cast<unsigned long long>(us / 1000000),
+                                    static_cast<unsigned long long>(us % 1000000));
+            file.Write(header, static_cast<size_t>(len), line.text);
+        }
+        if (options.on_line) {
+            options.on_line(line);
+        }
+        if (!line.triggers.empty()) {
+            trigger_lines.fetch_add(1, std::memory_order_relaxed);
+            for (uint32_t index : line.triggers) {
+                trigger_counts[index].fetch_add(1, std::memory_order_relaxed);
+            }
+            file.Flush();  // a PANIC line must reach the disk
+            if (options.on_trigger) {
+                options.on_trigger(line);
+            }
+        }
+    }
+};
+
+SerialLogCapture::SerialLogCapture() : impl_(std::make_unique<Impl>()) {}
+
+SerialLogCapture::~SerialLogCapture() {
+    Stop();
+}
+
+const core::Byte* SerialLogCapture::FindNewline(const core::Byte* begin,
+                                                const core::Byte* end) {
+    const core::Byte* p = begin;
+#ifdef PLAS_LOG_CAPTURE_HAS_SIMD
+    // SSE2 is baseline on x86-64: compare 16 bytes at a time.
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, newline));
+        if (mask != 0) {
+            return p + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+        p += 16;
+    }
+#endif
+    const void* hit = std::memchr(p, '\n', static_cast<size_t>(end - p));
+    return hit != nullptr ? static_cast<const core::Byte*>(hit) : end;
+}
+
+core::Result<void> SerialLogCapture::Validate(const SerialLogCaptureOptions& options) {
+    for (const auto& trigger : options.triggers) {
+        if (trigger.empty()) {
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        }
+    }
+    if (options.ring_bytes == 0 || options.max_line_length == 0 ||
+        options.max_file_bytes == 0 || options.max_files == 0) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> SerialLogCapture::Start(Serial& serial, SerialLogCaptureOptions options) {
+    return StartWith(
+        [&serial, buffered = true](core::Byte* data, size_t length,
+                                   std::chrono::milliseconds timeout) mutable {
+            if (buffered) {
+                auto result = serial.ReadFor(data, length, timeout);
+                if (result.IsOk() ||
+                    result.Error() != core::make_error_code(core::ErrorCode::kNotSupported)) {
+                    return result;
+                }
+                buffered = false;  // unbuffered backend: plain Read() from now on
+            }
+            return serial.Read(data, length);
+        },
+        std::move(options));
+}
+
+core::Result<void> SerialLogCapture::Start(Uart& uart, SerialLogCaptureOptions options) {
+    return StartWith(
+        [&uart, buffered = true](core::Byte* data, size_t length,
+                                 std::chrono::milliseconds timeout) mutable {
+            if (buffered) {
+                auto result = uart.ReadFor(data, length, timeout);
+                if (result.IsOk() ||
+                    result.Error() != core::make_error_code(core::ErrorCode::kNotSupported)) {
+                    return result;
+                }
+                buffered = false;
+            }
+            return uart.Read(data, length);
+        },
+        std::move(options));
+}
+
+core::Result<void> SerialLogCapture::StartWith(Reader reader,
+                                               SerialLogCaptureOptions options) {
+    std::lock_guard lock(impl_->control);
+    if (impl_->running.load(std::memory_order_acquire)) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+    }
+    auto valid = Validate(options);
+    if (valid.IsError()) {
+        return valid;
+    }
+
+    auto& impl = *impl_;
+    if (!options.file_path.empty() &&
+        !impl.file.Open(options.file_path, options.max_file_bytes, options.max_files)) {
+        return core::Result<void>::Err(core::ErrorCode::kIOError);
+    }
+
+    impl.matcher = LinePatternMatcher(options.triggers);
+    impl.trigger_counts =
+        std::make_unique<std::atomic<uint64_t>[]>(options.triggers.size());
+    for (size_t i = 0; i < options.triggers.size(); ++i) {
+        impl.trigger_counts[i].store(0, std::memory_order_relaxed);
+    }
+    impl.ring = std::make_unique<core::SpscRing<RxChunk>>(
+        std::max<size_t>(1, options.ring_bytes / kChunkBytes));
+    impl.options = std::move(options);
+    impl.reader = std::move(reader);
+    impl.line = LogLine();
+    impl.line_open = false;
+    for (auto* counter : {&impl.bytes_received, &impl.bytes_dropped, &impl.lines,
+                          &impl.truncated_lines, &impl.trigger_lines, &impl.read_errors}) {
+        counter->store(0, std::memory_order_relaxed);
+    }
+
+    impl.stop.store(false, std::memory_order_release);
+    impl.rx_done.store(false, std::memory_order_release);
+    impl.start = Clock::now();
+    impl.match_thread = std::thread([&impl] { impl.MatchLoop(); });
+    impl.rx_thread = std::thread([&impl] { impl.Receive(); });
+    impl.running.store(true, std::memory_order_release);
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> SerialLogCapture::Stop() {
+    std::lock_guard lock(impl_->control);
+    if (!impl_->running.load(std::memory_order_acquire)) {
+        return core::Result<void>::Ok();
+    }
+    impl_->stop.store(true, std::memory_order_release);
+    impl_->rx_thread.join();
+    impl_->rx_done.store(true, std::memory_order_release);
+    impl_->wake.notify_one();
+    impl_->match_thread.join();
+    impl_->file.Close();
+    impl_->running.store(false, std::memory_order_release);
+    if (impl_->file.Failed()) {
+        return core::Result<void>::Err(core::ErrorCode::kIOError);
+    }
+    return core::Result<void>::Ok();
+}
+
+bool SerialLogCapture::IsRunning() const {
+    return impl_->running.load(std::memory_order_acquire);
+}
+
+SerialLogCaptureStats SerialLogCapture::Stats() const {
+    SerialLogCaptureStats stats;
+    stats.bytes_received = impl_->bytes_received.load(std::memory_order_relaxed);
+    stats.bytes_dropped = impl_->bytes_dropped.load(std::memory_order_relaxed);
+    stats.lines = impl_->lines.load(std::memory_order_relaxed);
+    stats.truncated_lines = impl_->truncated_lines.load(std::memory_order_relaxed);
+    stats.trigger_lines = impl_->trigger_lines.load(std::memory_order_relaxed);
+    stats.read_errors = impl_->read_errors.load(std::memory_order_relaxed);
+    return stats;
+}
+
+uint64_t SerialLogCapture::TriggerCount(size_t index) const {
+    // No lock: callable from on_trigger while Stop() waits for that thread.
+    if (!impl_->trigger_counts || index >= impl_->matcher.PatternCount()) {
+        return 0;
+    }
+    return impl_->trigger_counts[index].load(std::memory_order_relaxed);
+}
+
+}  // namespace plas::hal
@@ -0,0 +1,253 @@
+#include "plas/hal/interface/smbus.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "plas/core/error.h"
+
+namespace plas::hal {
+
+namespace {
+
+constexpr std::array<uint8_t, 256> MakePecTable() {
+    std::array<uint8_t, 256> table{};
+    for (size_t i = 0; i < table.size(); ++i) {
+        auto crc = static_cast<uint8_t>(i);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = static_cast<uint8_t>((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr auto kPecTable = MakePecTable();
+
+/// Command code, byte count, block, PEC.
+using Frame = std::array<core::Byte, 2 + SmBus::kMaxBlock + 1>;
+
+core::Byte AddrWrite(core::Address addr) { return static_cast<core::Byte>(addr << 1); }
+core::Byte AddrRead(core::Address addr) { return static_cast<core::Byte>((addr << 1) | 1); }
+
+/// PEC of `frame` written to `addr`, appended; returns the new length.
+size_t AppendPec(core::Address addr, Frame& frame, size_t length) {
+    core::Byte a = AddrWrite(addr);
+    frame[length] = SmBusPec(frame.data(), length, SmBusPec(&a, 1));
+    return length + 1;
+}
+
+/// True if the last byte of `read` is the PEC of the whole transaction:
+/// address+W, `write`, address+R, the rest of `read`.
+bool PecMatches(core::Address addr, const core::Byte* write, size_t write_len,
+                const core::Byte* read, size_t read_len) {
+    core::Byte aw = AddrWrite(addr);
+    core::Byte ar = AddrRead(addr);
+    uint8_t crc = SmBusPec(&aw, 1);
+    crc = SmBusPec(write, write_len, crc);
+    crc = SmBusPec(&ar, 1, crc);
+    crc = SmBusPec(read, read_len - 1, crc);
+    return crc == read[read_len - 1];
+}
+
+/// Run a fixed-length read of `length` data bytes (plus PEC) after `write`.
+core::Result<void> ReadFixed(SmBus& bus, core::Address addr, const core::Byte* write,
+                             size_t write_len, core::Byte* out, size_t length, bool pec) {
+    std::array<core::Byte, 3> buf{};
+    size_t want = length + (pec ? 1 : 0);
+    auto result = bus.Transact(addr, write, write_len, buf.data(), want, false, pec);
+    if (result.IsError()) {
+        return core::Result<void>::Err(result.Error());
+    }
+    if (result.Value() != want) {
+        return core::Result<void>::Err(core::ErrorCode::kIOError);
+    }
+    if (pec && !PecMatches(addr, write, write_len, buf.data(), want)) {
+        return core::Result<void>::Err(core::ErrorCode::kDataLoss);
+    }
+    std::memcpy(out, buf.data(), length);
+    return core::Result<void>::Ok();
+}
+
+/// Block read after `write`; returns the block length.
+core::Result<size_t> ReadBlock(SmBus& bus, core::Address addr, const core::Byte* write,
+                               size_t write_len, core::Byte* data, size_t capacity, bool pec) {
+    if (data == nullptr && capacity > 0) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    Frame buf{};
+    size_t trailer = pec ? 1 : 0;
+    size_t read_len = 1 + std::min(capacity, SmBus::kMaxBlock) + trailer;
+    auto result = bus.Transact(addr, write, write_len, buf.data(), read_len, true, pec);
+    if (result.IsError()) {
+        return result;
+    }
+    size_t count = buf[0];
+    if (result.Value() != 1 + count + trailer) {
+        return core::Result<size_t>::Err(core::ErrorCode::kIOError);
+    }
+    if (pec && !PecMatches(addr, write, write_len, buf.data(), result.Value())) {
+        return core::Result<size_t>::Err(core::ErrorCode::kDataLoss);
+    }
+    if (count > capacity) {
+        return core::Result<size_t>::Err(core::ErrorCode::kOverflow);
+    }
+    if (count > 0) {
+        std::memcpy(data, buf.data() + 1, count);
+    }
+    return core::Result<size_t>::Ok(count);
+}
+
+core::Result<void> WriteFrame(SmBus& bus, core::Address addr, Frame& frame, size_t length,
+                              bool pec) {
+    if (pec) {
+        length = AppendPec(addr, frame, length);
+    }
+    auto result = bus.Transact(addr, frame.data(), length, nullptr, 0, false, pec);
+    if (result.IsError()) {
+        return core::Result<void>::Err(result.Error());
+    }
+    return core::Result<void>::Ok();
+}
+
+}  // namespace
+
+uint8_t SmBusPec(const core::Byte* data, size_t length, uint8_t crc) {
+    for (size_t i = 0; i < length; ++i) {
+        crc = kPecTable[crc ^ data[i]];
+    }
+    return crc;
+}
+
+// ---------------------------------------------------------------------------
+// SmBus protocol
+// ---------------------------------------------------------------------------
+
+core::Result<uint8_t> SmBus::ReadByteData(core::Address addr, uint8_t command, bool pec) {
+    core::Byte value = 0;
+    auto result = ReadFixed(*this, addr, &command, 1, &value, 1, pec);
+    if (result.IsError()) {
+        return core::Result<uint8_t>::Err(result.Error());
+    }
+    return core::Result<uint8_t>::Ok(value);
+}
+
+core::Result<void> SmBus::WriteByteData(core::Address addr, uint8_t command, uint8_t value,
+                                        bool pec) {
+    Frame frame{};
+    frame[0] = command;
+    frame[1] = value;
+    return WriteFrame(*this, addr, frame, 2, pec);
+}
+
+core::Result<uint16_t> SmBus::ReadWordData(core::Address addr, uint8_t command, bool pec) {
+    std::array<core::Byte, 2> word{};
+    auto result = ReadFixed(*this, addr, &command, 1, word.data(), word.size(), pec);
+    if (result.IsError()) {
+        return core::Result<uint16_t>::Err(result.Error());
+    }
+    return core::Result<uint16_t>::Ok(static_cast<uint16_t>(word[0] | (word[1] << 8)));
+}
+
+core::Result<void> SmBus::WriteWordData(core::Address addr, uint8_t command, uint16_t value,
+                                        bool pec) {
+    Frame frame{};
+    frame[0] = command;
+    frame[1] = static_cast<core::Byte>(value & 0xFF);
+    frame[2] = static_cast<core::Byte>(value >> 8);
+    return WriteFrame(*this, addr, frame, 3, pec);
+}
+
+core::Result<uint16_t> SmBus::ProcessCall(core::Address addr, uint8_t command, uint16_t value,
+                                          bool pec) {
+    std::array<core::Byte, 3> write = {command, static_cast<core::Byte>(value & 0xFF),
+                                       static_cast<core::Byte>(value >> 8)};
+    std::array<core::Byte, 2> word{};
+    auto result = ReadFixed(*this, addr, write.data(), write.size(), word.data(), word.size(),
+                            pec);
+    if (result.IsError()) {
+        return core::Result<uint16_t>::Err(result.Error());
+    }
+    return core::Result<uint16_t>::Ok(static_cast<uint16_t>(word[0] | (word[1] << 8)));
+}
+
+core::Result<size_t> SmBus::BlockRead(core::Address addr, uint8_t command, core::Byte* data,
+                                      size_t capacity, bool pec) {
+    return ReadBlock(*this, addr, &command, 1, data, capacity, pec);
+}
+
+core::Result<void> SmBus::BlockWrite(core::Address addr, uint8_t command,
+                                     const core::Byte* data, size_t length, bool pec) {
+    if (length > kMaxBlock || (data == nullptr && length > 0)) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    Frame frame{};
+    frame[0] = command;
+    frame[1] = static_cast<core::Byte>(length);
+    if (length > 0) {
+        std::memcpy(frame.data() + 2, data, length);
+    }
+    return WriteFrame(*this, addr, frame, 2 + length, pec);
+}
+
+core::Result<size_t> SmBus::BlockProcessCall(core::Address addr, uint8_t command,
+                                             const core::Byte* write, size_t write_len,
+                                             core::Byte* read, size_t capacity, bool pec) {
+    if (write_len > kMaxBlock || (write == nullptr && write_len > 0)) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    Frame frame{};
+    frame[0] = command;
+    frame[1] = static_cast<core::Byte>(write_len);
+    if (write_len > 0) {
+        std::memcpy(frame.data() + 2, write, write_len);
+    }
+    return ReadBlock(*this, addr, frame.data(), 2 + write_len, read, capacity, pec);
+}
+
+// ---------------------------------------------------------------------------
+// I2cSmBus
+// ---------------------------------------------------------------------------
+
+I2cSmBus::I2cSmBus(I2c& bus, size_t read_ahead)
+    : bus_(bus), read_ahead_(std::min(read_ahead, kMaxBlock)) {}
+
+core::Result<size_t> I2cSmBus::Transact(core::Address addr, const core::Byte* write,
+                                        size_t write_len, core::Byte* read, size_t read_len,
+                                        bool block, bool pec) {
+    if (write == nullptr || write_len == 0 || (read == nullptr && read_len > 0)) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (read_len == 0) {
+        return bus_.Write(addr, write, write_len);
+    }
+    if (!block) {
+        return bus_.WriteRead(addr, write, write_len, read, read_len);
+    }
+
+    size_t trailer = pec ? 1 : 0;
+    size_t first = std::min(read_len, 1 + read_ahead_ + trailer);
+    auto result = bus_.WriteRead(addr, write, write_len, read, first);
+    if (result.IsError()) {
+        return result;
+    }
+    if (result.Value() == 0) {
+        return core::Result<size_t>::Err(core::ErrorCode::kIOError);
+    }
+    size_t need = 1 + read[0] + trailer;
+    if (need > read_len) {
+        return core::Result<size_t>::Err(core::ErrorCode::kOverflow);
+    }
+    if (need > first) {
+        result = bus_.WriteRead(addr, write, write_len, read, need);
+        if (result.IsError()) {
+            return result;
+        }
+        if (read[0] + 1 + trailer != need) {  // the block changed in between
+            return core::Result<size_t>::Err(core::ErrorCode::kIOError);
+        }
+    }
+    return core::Result<size_t>::Ok(std::min(result.Value(), need));
+}
+
+}  // namespace plas::hal
@@ -0,0 +1,54 @@
+#include "plas/hal/interface/spi.h"
+
+#include <array>
+
+#include "plas/core/error.h"
+
+namespace plas::hal {
+
+core::Result<size_t> EncodeSpiCommandHeader(const SpiCommand& command,
+                                            core::Byte* header) {
+    bool lines_ok = command.lines == SpiLines::kSingle ||
+                    command.lines == SpiLines::kDual ||
+                    command.lines == SpiLines::kQuad;
+    bool address_ok = command.address_bytes == 0 || command.address_bytes == 3 ||
+                      command.address_bytes == 4;
+    bool data_ok = command.length == 0
+                       ? command.write == nullptr && command.read == nullptr
+                       : (command.write == nullptr) != (command.read == nullptr);
+    if (!lines_ok || !address_ok || !data_ok || header == nullptr) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    size_t n = 0;
+    header[n++] = command.opcode;
+    for (int i = command.address_bytes - 1; i >= 0; --i) {
+        header[n++] = static_cast<core::Byte>(command.address >> (8 * i));
+    }
+    for (uint8_t i = 0; i < command.dummy_bytes; ++i) {
+        header[n++] = 0xFF;
+    }
+    return core::Result<size_t>::Ok(n);
+}
+
+core::Result<size_t> Spi::Command(const SpiCommand& command) {
+    std::array<core::Byte, kSpiMaxCommandHeader> header;
+    auto header_len = EncodeSpiCommandHeader(command, header.data());
+    if (header_len.IsError()) {
+        return header_len;
+    }
+    if (command.lines != SpiLines::kSingle) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    auto sent = Exchange(header.data(), nullptr, header_len.Value(), command.length == 0);
+    if (sent.IsError()) {
+        return sent;
+    }
+    if (command.length == 0) {
+        return core::Result<size_t>::Ok(0);
+    }
+    return Exchange(command.write, command.read, command.length, true);
+}
+
+}  // namespace plas::hal
@@ -0,0 +1,480 @@
+#include "plas/hal/interface/spi_flash.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+#include "plas/core/deadline.h"
+#include "plas/core/error.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PLAS_CRC32C_SSE42 1
+#include <immintrin.h>
+#endif
+
+namespace plas::hal {
+
+namespace {
+
+// SPI-NOR opcodes: 3-byte address form, 4-byte address form.
+constexpr uint8_t kWriteEnable = 0x06;
+constexpr uint8_t kReadStatus = 0x05;
+constexpr uint8_t kReadJedecId = 0x9F;
+constexpr uint8_t kFastRead[2] = {0x0B, 0x0C};
+constexpr uint8_t kFastReadDual[2] = {0x3B, 0x3C};
+constexpr uint8_t kFastReadQuad[2] = {0x6B, 0x6C};
+constexpr uint8_t kPageProgram[2] = {0x02, 0x12};
+constexpr uint8_t kPageProgramQuad[2] = {0x32, 0x34};
+constexpr uint8_t kSectorErase[2] = {0x20, 0x21};
+
+constexpr uint8_t kStatusBusy = 0x01;  // WIP
+
+bool IsPowerOfTwo(std::size_t value) {
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+constexpr std::array<uint32_t, 256> MakeCrc32cTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < table.size(); ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78u : crc >> 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr auto kCrc32cTable = MakeCrc32cTable();
+
+uint32_t Crc32cTable(const core::Byte* data, size_t length, uint32_t crc) {
+    for (size_t i = 0; i < length; ++i) {
+        crc = kCrc32cTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#ifdef PLAS_CRC32C_SSE42
+__attribute__((target("sse4.2"))) uint32_t Crc32cSse42(const core::Byte* data,
+                                                        size_t length,
+                                                        uint32_t crc) {
+    uint64_t crc64 = crc;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    auto crc32 = static_cast<uint32_t>(crc64);
+    for (; i < length; ++i) {
+        crc32 = _mm_crc32_u8(crc32, data[i]);
+    }
+    return crc32;
+}
+#endif
+
+/// True if programming `wanted` over `current` would need a 0 bit to
+/// become 1, which only an erase does.
+bool NeedsErase(const core::Byte* current, const core::Byte* wanted, std::size_t length) {
+    std::size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t cur;
+        uint64_t want;
+        std::memcpy(&cur, current + i, sizeof(cur));
+        std::memcpy(&want, wanted + i, sizeof(want));
+        if ((want & ~cur) != 0) {
+            return true;
+        }
+    }
+    for (; i < length; ++i) {
+        if ((wanted[i] & ~current[i]) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IsErased(const core::Byte* data, std::size_t length) {
+    return std::all_of(data, data + length, [](core::Byte b) { return b == 0xFF; });
+}
+
+/// Read-only, sequential mapping of an image file.
+class MappedImage {
+public:
+    MappedImage() = default;
+    MappedImage(const MappedImage&) = delete;
+    MappedImage& operator=(const MappedImage&) = delete;
+    ~MappedImage() {
+        if (data_ != nullptr) {
+            ::munmap(const_cast<core::Byte*>(data_), size_);
+        }
+    }
+
+    core::Result<void> Open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return core::Result<void>::Err(errno == EACCES ? core::ErrorCode::kPermissionDenied
+                                                           : core::ErrorCode::kNotFound);
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+            ::close(fd);
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        }
+        auto size = static_cast<std::size_t>(st.st_size);
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            return core::Result<void>::Err(core::ErrorCode::kIOError);
+        }
+        // Read front to back once while programming, once more to verify.
+        ::madvise(mapped, size, MADV_SEQUENTIAL);
+        data_ = static_cast<const core::Byte*>(mapped);
+        size_ = size;
+        return core::Result<void>::Ok();
+    }
+
+    const core::Byte* Data() const { return data_; }
+    std::size_t Size() const { return size_; }
+
+private:
+    const core::Byte* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+}  // namespace
+
+uint32_t Crc32c(const core::Byte* data, size_t length, uint32_t crc) {
+    crc = ~crc;
+#ifdef PLAS_CRC32C_SSE42
+    static const bool hardware = __builtin_cpu_supports("sse4.2");
+    if (hardware) {
+        return ~Crc32cSse42(data, length, crc);
+    }
+#endif
+    return ~Crc32cTable(data, length, crc);
+}
+
+core::Result<SpiFlashGeometry> SpiFlashGeometry::FromJedecId(uint32_t jedec_id) {
+    jedec_id &= 0xFFFFFF;
+    uint8_t capacity = jedec_id & 0xFF;
+    if (jedec_id == 0 || jedec_id == 0xFFFFFF) {
+        return core::Result<SpiFlashGeometry>::Err(core::ErrorCode::kNotFound);
+    }
+    unsigned log2_size = 0;
+    if (capacity >= 0x10 && capacity <= 0x1F) {
+        log2_size = capacity;
+    } else if (capacity >= 0x20 && capacity <= 0x22) {
+        log2_size = capacity - 6u;  // 0x20 = 512 Mbit
+    } else {
+        return core::Result<SpiFlashGeometry>::Err(core::ErrorCode::kNotFound);
+    }
+    SpiFlashGeometry geometry;
+    geometry.size = std::size_t{1} << log2_size;
+    geometry.address_bytes = geometry.size > (std::size_t{1} << 24) ? 4 : 3;
+    return core::Result<SpiFlashGeometry>::Ok(geometry);
+}
+
+SpiFlash::SpiFlash(Spi& spi, SpiFlashGeometry geometry, SpiFlashOptions options)
+    : spi_(spi), geometry_(geometry), options_(std::move(options)) {}
+
+core::Result<uint32_t> SpiFlash::ReadJedecId(Spi& spi) {
+    std::array<core::Byte, 3> id{};
+    SpiCommand command;
+    command.opcode = kReadJedecId;
+    command.read = id.data();
+    command.length = id.size();
+    auto result = spi.Command(command);
+    if (result.IsError()) {
+        return core::Result<uint32_t>::Err(result.Error());
+    }
+    return core::Result<uint32_t>::Ok(static_cast<uint32_t>(id[0]) << 16 |
+                                      static_cast<uint32_t>(id[1]) << 8 | id[2]);
+}
+
+bool SpiFlash::ValidGeometry() const {
+    return IsPowerOfTwo(geometry_.size) && IsPowerOfTwo(geometry_.page_size) &&
+           IsPowerOfTwo(geometry_.sector_size) &&
+           geometry_.page_size <= geometry_.sector_size &&
+           geometry_.sector_size <= geometry_.size &&
+           (geometry_.address_bytes == 4 ||
+            (geometry_.address_bytes == 3 && geometry_.size <= (std::size_t{1} << 24)));
+}
+
+core::Result<void> SpiFlash::CheckRange(std::size_t offset, const void* data,
+                                        std::size_t length) const {
+    if (!ValidGeometry() || (data == nullptr && length > 0)) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (offset > geometry_.size || length > geometry_.size - offset) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+    return core::Result<void>::Ok();
+}
+
+SpiCommand SpiFlash::MakeCommand(uint8_t opcode3, uint8_t opcode4,
+                                 std::size_t offset) const {
+    SpiCommand command;
+    command.opcode = geometry_.address_bytes == 4 ? opcode4 : opcode3;
+    command.address = static_cast<uint32_t>(offset);
+    command.address_bytes = geometry_.address_bytes;
+    return command;
+}
+
+core::Result<void> SpiFlash::WriteEnable() {
+    SpiCommand command;
+    command.opcode = kWriteEnable;
+    auto result = spi_.Command(command);
+    if (result.IsError()) {
+        return core::Result<void>::Err(result.Error());
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> SpiFlash::WaitReady(std::chrono::milliseconds timeout) {
+    auto deadline = core::Deadline::Current().Clamp(std::chrono::steady_clock::now() + timeout);
+    SpiCommand command;
+    command.opcode = kReadStatus;
+    core::Byte status = 0;
+    command.read = &status;
+    command.length = 1;
+    for (;;) {
+        auto result = spi_.Command(command);
+        if (result.IsError()) {
+            return core::Result<void>::Err(result.Error());
+        }
+        if ((status & kStatusBusy) == 0) {
+            program_pending_ = false;
+            return core::Result<void>::Ok();
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return core::Result<void>::Err(core::ErrorCode::kTimeout);
+        }
+        stats_.status_polls++;
+        if (options_.poll_interval.count() > 0) {
+            std::this_thread::sleep_for(options_.poll_interval);
+        }
+    }
+}
+
+core::Result<void> SpiFlash::Finish() {
+    if (!program_pending_) {
+        return core::Result<void>::Ok();
+    }
+    return WaitReady(options_.program_timeout);
+}
+
+core::Result<void> SpiFlash::Read(std::size_t offset, core::Byte* data, std::size_t length) {
+    auto range = CheckRange(offset, data, length);
+    if (range.IsError() || length == 0) {
+        return range;
+    }
+    // The part ignores reads while a program cycle runs.
+    auto ready = Finish();
+    if (ready.IsError()) {
+        return ready;
+    }
+
+    const uint8_t* opcodes = options_.read_lines == SpiLines::kQuad   ? kFastReadQuad
+                             : options_.read_lines == SpiLines::kDual ? kFastReadDual
+                                                                      : kFastRead;
+    std::size_t chunk = options_.read_chunk == 0 ? length : options_.read_chunk;
+    for (std::size_t pos = 0; pos < length;) {
+        std::size_t n = std::min(length - pos, chunk);
+        auto command = MakeCommand(opcodes[0], opcodes[1], offset + pos);
+        command.dummy_bytes = 1;
+        command.lines = options_.read_lines;
+        command.read = data + pos;
+        command.length = n;
+        auto result = spi_.Command(command);
+        if (result.IsError()) {
+            return core::Result<void>::Err(result.Error());
+        }
+        if (result.Value() != n) {
+            return core::Result<void>::Err(core::ErrorCode::kDataLoss);
+        }
+        stats_.bytes_read += n;
+        pos += n;
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> SpiFlash::EraseSector(std::size_t offset) {
+    auto range = CheckRange(offset, this, 1);
+    if (range.IsError()) {
+        return range;
+    }
+    auto ready = Finish();
+    if (ready.IsError()) {
+        return ready;
+    }
+    auto enable = WriteEnable();
+    if (enable.IsError()) {
+        return enable;
+    }
+    auto command = MakeCommand(kSectorErase[0], kSectorErase[1],
+                               offset & ~(geometry_.sector_size - 1));
+    auto result = spi_.Command(command);
+    if (result.IsError()) {
+        return core::Result<void>::Err(result.Error());
+    }
+    stats_.sectors_erased++;
+    return WaitReady(options_.erase_timeout);
+}
+
+core::Result<void> SpiFlash::ProgramPage(std::size_t offset, const core::Byte* data) {
+    // The previous page has been programming while the caller looked for
+    // this one; only now wait for it.
+    auto ready = Finish();
+    if (ready.IsError()) {
+        return ready;
+    }
+    auto enable = WriteEnable();
+    if (enable.IsError()) {
+        return enable;
+    }
+    const uint8_t* opcodes = options_.quad_program ? kPageProgramQuad : kPageProgram;
+    auto command = MakeCommand(opcodes[0], opcodes[1], offset);
+    command.lines = options_.quad_program ? SpiLines::kQuad : SpiLines::kSingle;
+    command.write = data;
+    command.length = geometry_.page_size;
+    auto result = spi_.Command(command);
+    if (result.IsError()) {
+        return core::Result<void>::Err(result.Error());
+    }
+    program_pending_ = true;
+    stats_.pages_programmed++;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> SpiFlash::UpdateSector(std::size_t sector, const core::Byte* current,
+                                          const core::Byte* wanted) {
+    std::size_t pages = geometry_.sector_size / geometry_.page_size;
+    bool erase = current == nullptr;
+    if (!erase) {
+        if (std::memcmp(current, wanted, geometry_.sector_size) == 0) {
+            stats_.pages_skipped += pages;
+            return core::Result<void>::Ok();
+        }
+        erase = NeedsErase(current, wanted, geometry_.sector_size);
+    }
+    if (erase) {
+        auto erased = EraseSector(sector);
+        if (erased.IsError()) {
+            return erased;
+        }
+    }
+
+    for (std::size_t p = 0; p < geometry_.sector_size; p += geometry_.page_size) {
+        const core::Byte* page = wanted + p;
+        bool unchanged = erase ? IsErased(page, geometry_.page_size)
+                               : std::memcmp(current + p, page, geometry_.page_size) == 0;
+        if (unchanged) {
+            stats_.pages_skipped++;
+            continue;
+        }
+        auto programmed = ProgramPage(sector + p, page);
+        if (programmed.IsError()) {
+            return programmed;
+        }
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> SpiFlash::Program(std::size_t offset, const core::Byte* data,
+                                     std::size_t length) {
+    auto range = CheckRange(offset, data, length);
+    if (range.IsError() || length == 0) {
+        return range;
+    }
+
+    const std::size_t sector = geometry_.sector_size;
+    const std::size_t chunk = std::max(sector, options_.read_chunk / sector * sector);
+    const std::size_t end = offset + length;
+    const std::size_t first = offset & ~(sector - 1);
+    const std::size_t last = (end + sector - 1) & ~(sector - 1);
+    current_.resize(chunk);
+    wanted_.resize(chunk);
+
+    for (std::size_t base = first; base < last;) {
+        std::size_t n = std::min(chunk, last - base);
+        std::size_t lo = std::max(base, offset);
+        std::size_t hi = std::min(base + n, end);
+        // Without skip_unchanged only partial sectors at the ends of the
+        // range are read, for the bytes the erase must keep.
+        bool read = options_.skip_unchanged || lo != base || hi != base + n;
+        if (read) {
+            auto contents = Read(base, current_.data(), n);
+            if (contents.IsError()) {
+                return contents;
+            }
+            std::memcpy(wanted_.data(), current_.data(), n);
+        }
+        std::memcpy(wanted_.data() + (lo - base), data + (lo - offset), hi - lo);
+
+        for (std::size_t s = 0; s < n; s += sector) {
+            const core::Byte* current = options_.skip_unchanged ? current_.data() + s : nullptr;
+            auto updated = UpdateSector(base + s, current, wanted_.data() + s);
+            if (updated.IsError()) {
+                return updated;
+            }
+        }
+        if (options_.progress) {
+            options_.progress(hi - offset, length);
+        }
+        base += n;
+    }
+
+    auto ready = Finish();
+    if (ready.IsError()) {
+        return ready;
+    }
+    if (options_.verify) {
+        return Verify(offset, data, length);
+    }
+    stats_.crc32c = Crc32c(data, length);
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> SpiFlash::ProgramFile(const std::string& path, std::size_t offset) {
+    MappedImage image;
+    auto opened = image.Open(path);
+    if (opened.IsError()) {
+        return opened;
+    }
+    return Program(offset, image.Data(), image.Size());
+}
+
+core::Result<void> SpiFlash::Verify(std::size_t offset, const core::Byte* data,
+                                    std::size_t length) {
+    auto range = CheckRange(offset, data, length);
+    if (range.IsError() || length == 0) {
+        return range;
+    }
+    std::size_t chunk = std::min(length, options_.read_chunk == 0 ? length : options_.read_chunk);
+    current_.resize(std::max(current_.size(), chunk));
+    uint32_t crc = 0;
+    for (std::size_t pos = 0; pos < length;) {
+        std::size_t n = std::min(length - pos, chunk);
+        auto read = Read(offset + pos, current_.data(), n);
+        if (read.IsError()) {
+            return read;
+        }
+        if (Crc32c(current_.data(), n) != Crc32c(data + pos, n)) {
+            return core::Result<void>::Err(core::ErrorCode::kDataLoss);
+        }
+        crc = Crc32c(data + pos, n, crc);
+        pos += n;
+    }
+    stats_.crc32c = crc;
+    return core::Result<void>::Ok();
+}
+
+}  // namespace plas::hal
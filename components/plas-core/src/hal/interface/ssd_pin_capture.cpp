@@ -0,0 +1,214 @@
+#include "plas/hal/interface/ssd_pin_capture.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "plas/core/error.h"
+
+namespace plas::hal {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint8_t kPinBits[] = {SsdPinState::kPerst, SsdPinState::kClkReq,
+                                SsdPinState::kDualPort};
+
+uint64_t ToNs(Clock::time_point t) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch())
+            .count());
+}
+
+bool RaisePriority(int priority) {
+#ifndef _WIN32
+    if (priority > 0) {
+        sched_param param{};
+        param.sched_priority = priority;
+        return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+    }
+#else
+    (void)priority;
+#endif
+    return false;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Pimpl definition
+// ---------------------------------------------------------------------------
+struct SsdPinEventCapture::Impl {
+    std::mutex control;  // serializes Start/Stop
+    SsdGpio* gpio = nullptr;
+    SsdPinEventOptions sink;  // caller's callback/queue
+    std::thread thread;
+    std::error_code error;  // written by the poll thread, read after join
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> polling{false};
+    std::atomic<bool> realtime{false};
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> events{0};
+
+    void Emit(const SsdPinEvent& event) {
+        if (sink.queue != nullptr) {
+            sink.queue->Push(event);
+        }
+        if (sink.callback) {
+            sink.callback(event);
+        }
+        events.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Poll(uint8_t previous, Clock::time_point previous_time) {
+        realtime.store(RaisePriority(sink.realtime_priority), std::memory_order_relaxed);
+        const auto interval = sink.poll_interval;
+        auto next = previous_time;
+        while (!stop.load(std::memory_order_acquire)) {
+            next += interval;
+            auto now = Clock::now();
+            if (next > now) {
+                std::this_thread::sleep_until(next);
+            } else {
+                next = now;  // fell behind: skip the missed polls
+            }
+
+            auto result = gpio->GetPinState();
+            const auto when = Clock::now();
+            if (result.IsError()) {
+                error = result.Error();
+                return;
+            }
+            const uint8_t current = result.Value().values;
+            const uint8_t changed =
+                static_cast<uint8_t>((previous ^ current) & sink.pins);
+            for (uint8_t bit : kPinBits) {
+                if ((changed & bit) == 0) {
+                    continue;
+                }
+                SsdPinEvent event;
+                event.timestamp_ns = ToNs(when);
+                event.window_ns = static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        when - previous_time)
+                        .count());
+                event.pin = bit;
+                event.level = (current & bit) != 0;
+                event.state = result.Value();
+                event.clock = SsdEventClock::kHost;
+                Emit(event);
+            }
+            previous = current;
+            previous_time = when;
+        }
+    }
+};
+
+SsdPinEventCapture::SsdPinEventCapture() : impl_(std::make_unique<Impl>()) {}
+
+SsdPinEventCapture::~SsdPinEventCapture() {
+    Stop();
+}
+
+core::Result<void> SsdPinEventCapture::Validate(const SsdPinEventOptions& options) {
+    if (options.pins == 0 || (options.pins & ~SsdPinState::kAll) != 0 ||
+        (!options.callback && options.queue == nullptr) ||
+        options.poll_interval.count() <= 0) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> SsdPinEventCapture::Start(SsdGpio& gpio, SsdPinEventOptions options) {
+    auto valid = Validate(options);
+    if (valid.IsError()) {
+        return valid;
+    }
+    std::lock_guard lock(impl_->control);
+    if (impl_->running.load(std::memory_order_relaxed)) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+    }
+    impl_->gpio = &gpio;
+    impl_->sink = std::move(options);
+    impl_->error = {};
+    impl_->stop.store(false, std::memory_order_relaxed);
+    impl_->realtime.store(false, std::memory_order_relaxed);
+    impl_->events.store(0, std::memory_order_relaxed);
+
+    // Hardware capture: the backend timestamps, we only fan out.
+    SsdPinEventOptions hardware = impl_->sink;
+    hardware.callback = [impl = impl_.get()](const SsdPinEvent& event) {
+        impl->Emit(event);
+    };
+    hardware.queue = nullptr;
+    auto started = gpio.StartPinEvents(hardware);
+    if (started.IsOk()) {
+        impl_->running.store(true, std::memory_order_relaxed);
+        return started;
+    }
+    if (started.Error() != core::make_error_code(core::ErrorCode::kNotSupported)) {
+        return started;
+    }
+
+    // Polling fallback; the first read is the baseline, not an edge.
+    auto baseline = gpio.GetPinState();
+    if (baseline.IsError()) {
+        return core::Result<void>::Err(baseline.Error());
+    }
+    const auto baseline_time = Clock::now();
+    impl_->thread = std::thread(
+        [impl = impl_.get(), values = baseline.Value().values, baseline_time] {
+            impl->Poll(values, baseline_time);
+        });
+    impl_->polling.store(true, std::memory_order_relaxed);
+    impl_->running.store(true, std::memory_order_relaxed);
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> SsdPinEventCapture::Stop() {
+    std::lock_guard lock(impl_->control);
+    if (!impl_->running.load(std::memory_order_relaxed)) {
+        return core::Result<void>::Ok();
+    }
+    auto result = core::Result<void>::Ok();
+    if (impl_->polling.load(std::memory_order_relaxed)) {
+        impl_->stop.store(true, std::memory_order_release);
+        impl_->thread.join();
+        if (impl_->error) {
+            result = core::Result<void>::Err(impl_->error);
+        }
+    } else {
+        result = impl_->gpio->StopPinEvents();
+    }
+    impl_->polling.store(false, std::memory_order_relaxed);
+    impl_->running.store(false, std::memory_order_relaxed);
+    return result;
+}
+
+bool SsdPinEventCapture::IsRunning() const {
+    return impl_->running.load(std::memory_order_relaxed);
+}
+
+bool SsdPinEventCapture::IsPolling() const {
+    return impl_->polling.load(std::memory_order_relaxed);
+}
+
+bool SsdPinEventCapture::IsRealtime() const {
+    return impl_->realtime.load(std::memory_order_relaxed);
+}
+
+uint64_t SsdPinEventCapture::EventCount() const {
+    return impl_->events.load(std::memory_order_relaxed);
+}
+
+}  // namespace plas::hal
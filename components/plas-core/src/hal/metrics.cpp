@@ -0,0 +1,324 @@
+#include "plas/hal/metrics.h"
+
+#include <algorithm>
+
+namespace plas::hal {
+
+namespace {
+
+int MostSignificantBit(uint64_t value) {
+    int msb = 0;
+    while (value >>= 1) {
+        ++msb;
+    }
+    return msb;
+}
+
+void StoreMin(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value < current &&
+           !target.compare_exchange_weak(current, value,
+                                         std::memory_order_relaxed)) {
+    }
+}
+
+void StoreMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current &&
+           !target.compare_exchange_weak(current, value,
+                                         std::memory_order_relaxed)) {
+    }
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// LatencyHistogram
+// ---------------------------------------------------------------------------
+std::size_t LatencyHistogram::BucketIndex(uint64_t value_ns) {
+    if (value_ns < kSubBuckets) {
+        return static_cast<std::size_t>(value_ns);
+    }
+    int msb = MostSignificantBit(value_ns);
+    int shift = msb - static_cast<int>(kSubBucketBits);
+    auto sub = static_cast<std::size_t>((value_ns >> shift) & (kSubBuckets - 1));
+    return static_cast<std::size_t>(shift + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::BucketLowerBound(std::size_t index) {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    std::size_t shift = index / kSubBuckets - 1;
+    uint64_t sub = index % kSubBuckets;
+    return (kSubBuckets + sub) << shift;
+}
+
+void LatencyHistogram::Reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// OperationStats / MetricsSnapshot
+// ---------------------------------------------------------------------------
+uint64_t OperationStats::PercentileNs(double p) const {
+    if (count == 0 || histogram.empty()) {
+        return 0;
+    }
+    p = std::clamp(p, 0.0, 100.0);
+    uint64_t total = 0;
+    for (auto c : histogram) {
+        total += c;
+    }
+    auto rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < histogram.size(); ++i) {
+        seen += histogram[i];
+        if (seen >= rank) {
+            return std::clamp(LatencyHistogram::BucketLowerBound(i), min_ns,
+                              max_ns);
+        }
+    }
+    return max_ns;
+}
+
+double OperationStats::BytesPerSecond() const {
+    if (total_ns == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(bytes) * 1e9 / static_cast<double>(total_ns);
+}
+
+const OperationStats* MetricsSnapshot::Find(const std::string& device,
+                                            MetricOp op) const {
+    for (const auto& stats : operations) {
+        if (stats.device == device && stats.op == op) {
+            return &stats;
+        }
+    }
+    return nullptr;
+}
+
+const core::LockStats* MetricsSnapshot::FindLock(const std::string& name) const {
+    for (const auto& stats : locks) {
+        if (stats.name == name) {
+            return &stats;
+        }
+    }
+    return nullptr;
+}
+
+const RetryStats* MetricsSnapshot::FindRetries(const std::string& device) const {
+    for (const auto& stats : retries) {
+        if (stats.device == device) {
+            return &stats;
+        }
+    }
+    return nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// DeviceMetrics
+// ---------------------------------------------------------------------------
+void DeviceMetrics::Record(MetricOp op, uint64_t duration_ns,
+                           std::size_t bytes, bool ok) {
+    auto index = static_cast<std::size_t>(op);
+    if (index >= kMetricOpCount) {
+        return;
+    }
+    auto& c = ops_[index];
+    c.count.fetch_add(1, std::memory_order_relaxed);
+    if (!ok) {
+        c.errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    c.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    c.total_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+    StoreMin(c.min_ns, duration_ns);
+    StoreMax(c.max_ns, duration_ns);
+    c.histogram.Record(duration_ns);
+}
+
+void DeviceMetrics::RecordRetry(const core::RetryOutcome& outcome) {
+    if (outcome.attempts > 1) {
+        retried_calls_.fetch_add(1, std::memory_order_relaxed);
+        retries_.fetch_add(outcome.attempts - 1, std::memory_order_relaxed);
+        backoff_us_.fetch_add(static_cast<uint64_t>(outcome.slept.count()),
+                              std::memory_order_relaxed);
+        if (!outcome.exhausted) {
+            recovered_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (outcome.exhausted) {
+        exhausted_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void DeviceMetrics::Reset() {
+    for (auto& c : ops_) {
+        c.count.store(0, std::memory_order_relaxed);
+        c.errors.store(0, std::memory_order_relaxed);
+        c.bytes.store(0, std::memory_order_relaxed);
+        c.total_ns.store(0, std::memory_order_relaxed);
+        c.min_ns.store(UINT64_MAX, std::memory_order_relaxed);
+        c.max_ns.store(0, std::memory_order_relaxed);
+        c.histogram.Reset();
+    }
+    retried_calls_.store(0, std::memory_order_relaxed);
+    retries_.store(0, std::memory_order_relaxed);
+    recovered_.store(0, std::memory_order_relaxed);
+    exhausted_.store(0, std::memory_order_relaxed);
+    backoff_us_.store(0, std::memory_order_relaxed);
+}
+
+void DeviceMetrics::AppendTo(const std::string& device,
+                             std::vector<OperationStats>& out) const {
+    for (std::size_t i = 0; i < kMetricOpCount; ++i) {
+        const auto& c = ops_[i];
+        uint64_t count = c.count.load(std::memory_order_relaxed);
+        if (count == 0) {
+            continue;
+        }
+        OperationStats stats;
+        stats.device = device;
+        stats.op = static_cast<MetricOp>(i);
+        stats.count = count;
+        stats.errors = c.errors.load(std::memory_order_relaxed);
+        stats.bytes = c.bytes.load(std::memory_order_relaxed);
+        stats.total_ns = c.total_ns.load(std::memory_order_relaxed);
+        stats.min_ns = c.min_ns.load(std::memory_order_relaxed);
+        stats.max_ns = c.max_ns.load(std::memory_order_relaxed);
+        if (stats.min_ns > stats.max_ns) {
+            stats.min_ns = stats.max_ns;  // raced with a concurrent Record()
+        }
+        stats.histogram.resize(LatencyHistogram::kBucketCount);
+        for (std::size_t b = 0; b < LatencyHistogram::kBucketCount; ++b) {
+            stats.histogram[b] = c.histogram.BucketCount(b);
+        }
+        out.push_back(std::move(stats));
+    }
+}
+
+void DeviceMetrics::AppendRetriesTo(const std::string& device,
+                                    std::vector<RetryStats>& out) const {
+    RetryStats stats;
+    stats.retried_calls = retried_calls_.load(std::memory_order_relaxed);
+    stats.exhausted = exhausted_.load(std::memory_order_relaxed);
+    if (stats.retried_calls == 0 && stats.exhausted == 0) {
+        return;
+    }
+    stats.device = device;
+    stats.retries = retries_.load(std::memory_order_relaxed);
+    stats.recovered = recovered_.load(std::memory_order_relaxed);
+    stats.backoff_us = backoff_us_.load(std::memory_order_relaxed);
+    out.push_back(std::move(stats));
+}
+
+// ---------------------------------------------------------------------------
+// MetricsDeferScope
+// ---------------------------------------------------------------------------
+namespace {
+thread_local MetricsDeferScope* t_defer_scope = nullptr;
+}  // namespace
+
+MetricsDeferScope::MetricsDeferScope(std::size_t capacity)
+    : samples_(capacity), previous_(t_defer_scope) {
+    t_defer_scope = this;
+}
+
+MetricsDeferScope::~MetricsDeferScope() {
+    t_defer_scope = previous_;
+    for (std::size_t i = 0; i < used_; ++i) {
+        const auto& sample = samples_[i];
+        sample.metrics->Record(sample.op, sample.duration_ns, sample.bytes, sample.ok);
+    }
+}
+
+bool MetricsDeferScope::Hold(DeviceMetrics* metrics, MetricOp op, uint64_t duration_ns,
+                             std::size_t bytes, bool ok) {
+    MetricsDeferScope* scope = t_defer_scope;
+    if (scope == nullptr || scope->used_ == scope->samples_.size()) {
+        return false;
+    }
+    auto& sample = scope->samples_[scope->used_++];
+    sample.metrics = metrics;
+    sample.op = op;
+    sample.ok = ok;
+    sample.duration_ns = duration_ns;
+    sample.bytes = bytes;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// MetricsRegistry
+// ---------------------------------------------------------------------------
+MetricsRegistry& MetricsRegistry::GetInstance() {
+    static MetricsRegistry instance;
+    return instance;
+}
+
+DeviceMetrics* MetricsRegistry::GetDeviceMetrics(const std::string& nickname) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = devices_[nickname];
+    if (!slot) {
+        slot = std::make_unique<DeviceMetrics>();
+    }
+    return slot.get();
+}
+
+MetricsSnapshot MetricsRegistry::Snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    MetricsSnapshot snapshot;
+    for (const auto& [name, metrics] : devices_) {
+        metrics->AppendTo(name, snapshot.operations);
+        metrics->AppendRetriesTo(name, snapshot.retries);
+    }
+    snapshot.locks = core::LockStatsSnapshot();
+    return snapshot;
+}
+
+MetricsSnapshot MetricsRegistry::Snapshot(
+    const std::vector<std::string>& devices) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    MetricsSnapshot snapshot;
+    for (const auto& [name, metrics] : devices_) {
+        if (std::find(devices.begin(), devices.end(), name) != devices.end()) {
+            metrics->AppendTo(name, snapshot.operations);
+            metrics->AppendRetriesTo(name, snapshot.retries);
+        }
+    }
+    snapshot.locks = core::LockStatsSnapshot();  // not per device
+    return snapshot;
+}
+
+void MetricsRegistry::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [_, metrics] : devices_) {
+        metrics->Reset();
+    }
+    core::ResetLockStats();
+}
+
+// ---------------------------------------------------------------------------
+// Enum names
+// ---------------------------------------------------------------------------
+const char* ToString(MetricOp op) {
+    switch (op) {
+        case MetricOp::kI2cRead:         return "i2c-read";
+        case MetricOp::kI2cWrite:        return "i2c-write";
+        case MetricOp::kI2cWriteRead:    return "i2c-write-read";
+        case MetricOp::kPciConfigRead:   return "pci-config-read";
+        case MetricOp::kPciConfigWrite:  return "pci-config-write";
+        case MetricOp::kDoeExchange:     return "doe-exchange";
+        case MetricOp::kBarRead:         return "bar-read";
+        case MetricOp::kBarWrite:        return "bar-write";
+        case MetricOp::kSpiRead:         return "spi-read";
+        case MetricOp::kSpiWrite:        return "spi-write";
+        case MetricOp::kCount:           break;
+    }
+    return "unknown";
+}
+
+}  // namespace plas::hal
@@ -0,0 +1,340 @@
+#include "plas/hal/power_sequencer.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+#include "plas/core/deadline.h"
+#include "plas/core/error.h"
+#include "plas/core/io_queue.h"
+#include "plas/core/realtime.h"
+#include "plas/hal/device_manager.h"
+#include "plas/hal/interface/power_control.h"
+#include "plas/hal/interface/ssd_gpio.h"
+#include "plas/hal/metrics.h"
+#include "plas/log/logger.h"
+
+namespace plas::hal {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Lead time between spawning the slot threads and the common start, so
+/// every thread is waiting before the first deadline.
+constexpr std::chrono::milliseconds kStartLead{2};
+/// Same in real-time mode, which also sets up scheduling, the stack and the
+/// deferral buffers first.
+constexpr std::chrono::milliseconds kRealtimeStartLead{20};
+
+uint64_t SinceNs(Clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start)
+            .count());
+}
+
+/// Schedule clock of the normal mode: sleep, then yield to the deadline.
+class SteadyTimer {
+public:
+    SteadyTimer(Clock::time_point start, std::chrono::microseconds spin)
+        : start_(start), spin_(spin) {}
+
+    void WaitUntil(std::chrono::nanoseconds at) const {
+        const auto deadline = start_ + at;
+        if (deadline - Clock::now() > spin_) {
+            std::this_thread::sleep_until(deadline - spin_);
+        }
+        while (Clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+    }
+
+    uint64_t NowNs() const { return SinceNs(start_); }
+
+private:
+    Clock::time_point start_;
+    std::chrono::microseconds spin_;
+};
+
+/// Schedule clock of the real-time mode: sleep, then busy-wait on the
+/// cycle counter, and timestamp from it.
+class TscTimer {
+public:
+    TscTimer(Clock::time_point start, std::chrono::microseconds spin)
+        : clock_(core::TscClock::Get()), start_(start), spin_(spin) {
+        const auto lead = start - Clock::now();
+        const uint64_t now = clock_.Ticks();
+        start_ticks_ = lead.count() > 0 ? now + clock_.FromNs(static_cast<uint64_t>(
+                                                    std::chrono::duration_cast<
+                                                        std::chrono::nanoseconds>(lead)
+                                                        .count()))
+                                        : now;
+    }
+
+    void WaitUntil(std::chrono::nanoseconds at) const {
+        const auto deadline = start_ + at;
+        if (deadline - Clock::now() > spin_) {
+            std::this_thread::sleep_until(deadline - spin_);
+        }
+        clock_.SpinUntil(start_ticks_ + clock_.FromNs(static_cast<uint64_t>(at.count())));
+    }
+
+    uint64_t NowNs() const {
+        const uint64_t now = clock_.Ticks();
+        return now > start_ticks_ ? clock_.ToNs(now - start_ticks_) : 0;
+    }
+
+private:
+    const core::TscClock& clock_;
+    Clock::time_point start_;
+    std::chrono::microseconds spin_;
+    uint64_t start_ticks_ = 0;
+};
+
+std::error_code ErrorOf(const core::Result<void>& result) {
+    return result.IsError() ? result.Error() : std::error_code();
+}
+
+std::size_t CountActionSteps(const std::vector<PowerStep>& timeline) {
+    return static_cast<std::size_t>(
+        std::count_if(timeline.begin(), timeline.end(), [](const PowerStep& step) {
+            return step.action != PowerStepAction::kDelay;
+        }));
+}
+
+/// Run `timeline` on one slot, writing the timing of each issued step to
+/// `out` (room for every action step); returns how many were written.
+/// Allocates nothing.
+template <typename Timer>
+std::size_t RunSlot(const std::vector<PowerStep>& timeline, const PowerSequenceTarget& target,
+                    const PowerSequencer::Options& options, Clock::time_point start,
+                    const Timer& timer, std::chrono::nanoseconds offset, PowerStepTiming* out,
+                    PowerSlotReport& report) {
+    std::size_t count = 0;
+    std::chrono::nanoseconds at = offset;
+    for (std::size_t i = 0; i < timeline.size(); ++i) {
+        const auto& step = timeline[i];
+        if (step.action == PowerStepAction::kDelay) {
+            at += step.delay;
+            continue;
+        }
+        if (start + at > core::Deadline::Current().When()) {
+            // Neither this step nor any later one can be issued in time.
+            report.error = core::make_error_code(core::ErrorCode::kTimeout);
+            return count;
+        }
+        timer.WaitUntil(at);
+
+        PowerStepTiming& timing = out[count++];
+        timing.step = i;
+        timing.action = step.action;
+        timing.scheduled_ns = static_cast<uint64_t>(at.count());
+        timing.start_ns = std::max(timer.NowNs(), timing.scheduled_ns);
+        timing.error = ExecutePowerStep(step, target);
+        timing.end_ns = timer.NowNs();
+
+        if (timing.error) {
+            if (!report.error) {
+                report.error = timing.error;
+            }
+            if (options.stop_on_error) {
+                return count;
+            }
+        }
+    }
+    report.completed = !report.error;
+    return count;
+}
+
+}  // namespace
+
+std::error_code ExecutePowerStep(const PowerStep& step, const PowerSequenceTarget& target) {
+    switch (step.action) {
+        case PowerStepAction::kPowerOn:
+            return ErrorOf(target.power->PowerOn());
+        case PowerStepAction::kPowerOff:
+            return ErrorOf(target.power->PowerOff());
+        case PowerStepAction::kSetVoltage:
+            return ErrorOf(target.power->SetVoltage(core::Voltage(step.value)));
+        case PowerStepAction::kSetCurrent:
+            return ErrorOf(target.power->SetCurrent(core::Current(step.value)));
+        case PowerStepAction::kPerst:
+            return ErrorOf(target.gpio->SetPerst(step.active));
+        case PowerStepAction::kClkReq:
+            return ErrorOf(target.gpio->SetClkReq(step.active));
+        case PowerStepAction::kDualPort:
+            return ErrorOf(target.gpio->SetDualPort(step.active));
+        case PowerStepAction::kPins:
+            return ErrorOf(target.gpio->SetPinState(step.pin_mask, step.pin_values));
+        case PowerStepAction::kDelay:
+            break;
+    }
+    return {};
+}
+
+const char* ToString(PowerStepAction action) {
+    switch (action) {
+        case PowerStepAction::kPowerOn:    return "PowerOn";
+        case PowerStepAction::kPowerOff:   return "PowerOff";
+        case PowerStepAction::kSetVoltage: return "SetVoltage";
+        case PowerStepAction::kSetCurrent: return "SetCurrent";
+        case PowerStepAction::kPerst:      return "Perst";
+        case PowerStepAction::kClkReq:     return "ClkReq";
+        case PowerStepAction::kDualPort:   return "DualPort";
+        case PowerStepAction::kPins:       return "Pins";
+        case PowerStepAction::kDelay:      return "Delay";
+    }
+    return "Unknown";
+}
+
+// ---------------------------------------------------------------------------
+// PowerSequenceReport
+// ---------------------------------------------------------------------------
+
+bool PowerSequenceReport::Ok() const {
+    return std::all_of(slots.begin(), slots.end(),
+                       [](const PowerSlotReport& slot) { return slot.completed; });
+}
+
+core::JitterStats PowerSequenceReport::Jitter() const {
+    std::vector<uint64_t> lateness;
+    for (const auto& slot : slots) {
+        for (const auto& step : slot.steps) {
+            lateness.push_back(step.LatenessNs());
+        }
+    }
+    return core::JitterStats::FromSamples(std::move(lateness));
+}
+
+uint64_t PowerSequenceReport::MaxLatenessNs() const {
+    uint64_t worst = 0;
+    for (const auto& slot : slots) {
+        for (const auto& step : slot.steps) {
+            worst = std::max(worst, step.LatenessNs());
+        }
+    }
+    return worst;
+}
+
+// ---------------------------------------------------------------------------
+// PowerSequencer
+// ---------------------------------------------------------------------------
+
+PowerSequencer::PowerSequencer(std::vector<PowerStep> timeline)
+    : timeline_(std::move(timeline)) {}
+
+std::chrono::microseconds PowerSequencer::Duration() const {
+    std::chrono::microseconds total{0};
+    for (const auto& step : timeline_) {
+        if (step.action == PowerStepAction::kDelay) {
+            total += step.delay;
+        }
+    }
+    return total;
+}
+
+core::Result<PowerSequenceReport> PowerSequencer::Run(
+    const std::vector<PowerSequenceTarget>& targets, const Options& options) const {
+    const bool needs_power = std::any_of(
+        timeline_.begin(), timeline_.end(), [](const PowerStep& step) {
+            return step.action != PowerStepAction::kDelay && !step.NeedsGpio();
+        });
+    const bool needs_gpio = std::any_of(timeline_.begin(), timeline_.end(),
+                                        [](const PowerStep& step) { return step.NeedsGpio(); });
+    if (targets.empty()) {
+        return core::Result<PowerSequenceReport>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    for (const auto& target : targets) {
+        if ((needs_power && target.power == nullptr) ||
+            (needs_gpio && target.gpio == nullptr)) {
+            return core::Result<PowerSequenceReport>::Err(core::ErrorCode::kInvalidArgument);
+        }
+    }
+
+    const std::size_t action_steps = CountActionSteps(timeline_);
+    core::RealtimeArena arena;
+    std::vector<PowerStepTiming*> buffers(targets.size(), nullptr);
+    std::vector<int> cpus;
+    if (options.realtime) {
+        // Every slot's timings in one locked mapping, carved up here so the
+        // slot threads never allocate.
+        auto created = core::RealtimeArena::Create(
+            std::max<std::size_t>(1, targets.size() * action_steps) * sizeof(PowerStepTiming) +
+            targets.size() * alignof(PowerStepTiming));
+        if (created.IsError()) {
+            return core::Result<PowerSequenceReport>::Err(created.Error());
+        }
+        arena = std::move(created).Value();
+        for (auto& buffer : buffers) {
+            buffer = arena.AllocateArray<PowerStepTiming>(action_steps);
+        }
+        cpus = options.realtime_cpus.empty() ? core::IsolatedCpus() : options.realtime_cpus;
+        core::TscClock::Get();  // calibrate before the clock starts running
+    }
+
+    PowerSequenceReport report;
+    report.slots.resize(targets.size());
+    const auto start = Clock::now() + (options.realtime ? kRealtimeStartLead : kStartLead);
+    const auto deadline = core::Deadline::Current();
+    const auto priority = core::CurrentIoPriority();
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(targets.size());
+        for (std::size_t i = 0; i < targets.size(); ++i) {
+            const auto offset = options.stagger * static_cast<int64_t>(i);
+            threads.emplace_back([this, &targets, &options, &report, &arena, &buffers, &cpus,
+                                  action_steps, start, offset, i, deadline, priority] {
+                core::ScopedDeadline scope(deadline);
+                core::ScopedIoPriority io_priority(priority);
+                auto& slot = report.slots[i];
+                slot.name = targets[i].name;
+                if (!options.realtime) {
+                    slot.steps.resize(action_steps);
+                    slot.steps.resize(RunSlot(timeline_, targets[i], options, start,
+                                              SteadyTimer(start, options.spin), offset,
+                                              slot.steps.data(), slot));
+                    return;
+                }
+                auto realtime_options = options.realtime_options;
+                if (!cpus.empty()) {
+                    realtime_options.cpu = cpus[i % cpus.size()];
+                }
+                slot.realtime = core::EnterRealtime(realtime_options);
+                slot.realtime.memory_locked = arena.IsLocked();
+                std::size_t count = 0;
+                {
+                    log::Logger::DeferScope deferred_log;
+                    MetricsDeferScope deferred_metrics;
+                    count = RunSlot(timeline_, targets[i], options, start,
+                                    TscTimer(start, options.spin), offset, buffers[i], slot);
+                }
+                slot.steps.assign(buffers[i], buffers[i] + count);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    report.duration_ns = SinceNs(start);
+    return core::Result<PowerSequenceReport>::Ok(std::move(report));
+}
+
+core::Result<std::vector<PowerSequenceTarget>> PowerSequencer::ResolveTargets(
+    DeviceManager& manager, const std::vector<std::string>& names) {
+    std::vector<PowerSequenceTarget> targets;
+    targets.reserve(names.size());
+    for (const auto& name : names) {
+        PowerSequenceTarget target;
+        target.name = name;
+        target.power = manager.GetInterface<PowerControl>(name);
+        target.gpio = manager.GetInterface<SsdGpio>(name);
+        if (target.power == nullptr && target.gpio == nullptr) {
+            return core::Result<std::vector<PowerSequenceTarget>>::Err(
+                core::ErrorCode::kNotFound);
+        }
+        targets.push_back(std::move(target));
+    }
+    return core::Result<std::vector<PowerSequenceTarget>>::Ok(std::move(targets));
+}
+
+}  // namespace plas::hal
@@ -0,0 +1,393 @@
+#include "plas/hal/read_coalescing.h"
+
+#include <cstring>
+
+#include "plas/core/deadline.h"
+#include "plas/core/error.h"
+#include "plas/hal/interface/device.h"
+
+namespace plas::hal {
+
+namespace {
+
+/// Completed flights kept past their window are swept once the table
+/// reaches this size.
+constexpr std::size_t kSweepThreshold = 64;
+
+template <typename V>
+void Put(std::string& key, V value) {
+    key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void PutBytes(std::string& key, const void* data, std::size_t length) {
+    Put(key, length);
+    if (length > 0) {
+        key.append(static_cast<const char*>(data), length);
+    }
+}
+
+using Bytes = std::vector<core::Byte>;
+
+core::Result<size_t> CopyOut(const core::Result<Bytes>& result, core::Byte* out) {
+    if (result.IsError()) {
+        return core::Result<size_t>::Err(result.Error());
+    }
+    const auto& bytes = result.Value();
+    if (!bytes.empty()) {
+        std::memcpy(out, bytes.data(), bytes.size());
+    }
+    return core::Result<size_t>::Ok(bytes.size());
+}
+
+/// Run `read` (returning Result<size_t>) into a buffer of `length` bytes.
+template <typename Read>
+core::Result<Bytes> ReadInto(std::size_t length, Read&& read) {
+    Bytes bytes(length);
+    auto result = read(bytes.data());
+    if (result.IsError()) {
+        return core::Result<Bytes>::Err(result.Error());
+    }
+    bytes.resize(result.Value());
+    return core::Result<Bytes>::Ok(std::move(bytes));
+}
+
+bool Succeeded(const pci::CxlMailboxResult& result) {
+    return result.return_code == pci::CxlMailboxReturnCode::kSuccess;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// ReadCoalescer
+// ---------------------------------------------------------------------------
+
+std::shared_ptr<ReadCoalescer::Flight> ReadCoalescer::Join(const std::string& key,
+                                                           bool& leader) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = flights_.find(key);
+    if (it != flights_.end()) {
+        auto flight = it->second;
+        if (!flight->done) {
+            ++stats_.joined;
+            auto deadline = core::Deadline::Current();
+            if (deadline.IsSet()) {
+                if (!done_.wait_until(lock, deadline.When(), [&] { return flight->done; })) {
+                    return nullptr;
+                }
+            } else {
+                done_.wait(lock, [&] { return flight->done; });
+            }
+            return flight;
+        }
+        if (Clock::now() - flight->finished < freshness_) {
+            ++stats_.fresh_hits;
+            return flight;
+        }
+        flights_.erase(it);
+    }
+
+    if (flights_.size() >= kSweepThreshold) {
+        auto now = Clock::now();
+        for (auto sweep = flights_.begin(); sweep != flights_.end();) {
+            if (sweep->second->done && now - sweep->second->finished >= freshness_) {
+                sweep = flights_.erase(sweep);
+            } else {
+                ++sweep;
+            }
+        }
+    }
+    leader = true;
+    ++stats_.reads;
+    auto flight = std::make_shared<Flight>();
+    flights_.emplace(key, flight);
+    return flight;
+}
+
+void ReadCoalescer::Finish(const std::string& key, const std::shared_ptr<Flight>& flight,
+                           std::shared_ptr<const void> result, bool reusable) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flight->result = std::move(result);
+        flight->finished = Clock::now();
+        flight->done = true;
+        // Gone already if Invalidate() ran while the read was in flight.
+        auto it = flights_.find(key);
+        if (it != flights_.end() && it->second == flight &&
+            (!reusable || freshness_.count() <= 0)) {
+            flights_.erase(it);
+        }
+    }
+    done_.notify_all();
+}
+
+void ReadCoalescer::Invalidate() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flights_.clear();
+    ++stats_.invalidations;
+}
+
+ReadCoalescingStats ReadCoalescer::Stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+// ---------------------------------------------------------------------------
+// CoalescingI2c
+// ---------------------------------------------------------------------------
+
+core::Result<size_t> CoalescingI2c::Read(core::Address addr, core::Byte* data,
+                                         size_t length, bool stop) {
+    // Without STOP the read is one step of a caller-driven sequence.
+    if (!stop || (data == nullptr && length > 0)) {
+        return backend_.Read(addr, data, length, stop);
+    }
+    std::string key(1, 'r');
+    Put(key, addr);
+    Put(key, length);
+    return CopyOut(coalescer_.Run<Bytes>(key, [&] {
+                       return ReadInto(length, [&](core::Byte* buf) {
+                           return backend_.Read(addr, buf, length, true);
+                       });
+                   }),
+                   data);
+}
+
+core::Result<size_t> CoalescingI2c::Write(core::Address addr, const core::Byte* data,
+                                          size_t length, bool stop) {
+    auto result = backend_.Write(addr, data, length, stop);
+    coalescer_.Invalidate();
+    return result;
+}
+
+core::Result<size_t> CoalescingI2c::WriteRead(core::Address addr,
+                                              const core::Byte* write_data,
+                                              size_t write_len, core::Byte* read_data,
+                                              size_t read_len) {
+    if ((write_data == nullptr && write_len > 0) || (read_data == nullptr && read_len > 0)) {
+        return backend_.WriteRead(addr, write_data, write_len, read_data, read_len);
+    }
+    std::string key(1, 'w');
+    Put(key, addr);
+    Put(key, read_len);
+    PutBytes(key, write_data, write_len);
+    return CopyOut(coalescer_.Run<Bytes>(key, [&] {
+                       return ReadInto(read_len, [&](core::Byte* buf) {
+                           return backend_.WriteRead(addr, write_data, write_len, buf,
+                                                     read_len);
+                       });
+                   }),
+                   read_data);
+}
+
+core::Result<size_t> CoalescingI2c::Transfer(I2cMessage* msgs, size_t count) {
+    auto result = backend_.Transfer(msgs, count);
+    coalescer_.Invalidate();
+    return result;
+}
+
+core::Result<void> CoalescingI2c::SetBitrate(uint32_t bitrate) {
+    auto result = backend_.SetBitrate(bitrate);
+    coalescer_.Invalidate();
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// CoalescingSmBus
+// ---------------------------------------------------------------------------
+
+core::Result<size_t> CoalescingSmBus::Transact(core::Address addr, const core::Byte* write,
+                                               size_t write_len, core::Byte* read,
+                                               size_t read_len, bool block, bool pec) {
+    // Only a command code followed by a read; process calls send data.
+    if (write_len != 1 || write == nullptr || read_len == 0 || read == nullptr) {
+        auto result = backend_.Transact(addr, write, write_len, read, read_len, block, pec);
+        coalescer_.Invalidate();
+        return result;
+    }
+    std::string key(1, 's');
+    Put(key, addr);
+    Put(key, write[0]);
+    Put(key, read_len);
+    Put(key, block);
+    Put(key, pec);
+    return CopyOut(coalescer_.Run<Bytes>(key, [&] {
+                       return ReadInto(read_len, [&](core::Byte* buf) {
+                           return backend_.Transact(addr, write, 1, buf, read_len, block,
+                                                    pec);
+                       });
+                   }),
+                   read);
+}
+
+// ---------------------------------------------------------------------------
+// CoalescingPciConfig
+// ---------------------------------------------------------------------------
+
+namespace {
+
+std::string ConfigKey(char tag, pci::Bdf bdf, pci::ConfigOffset offset) {
+    std::string key(1, tag);
+    Put(key, bdf.Pack());
+    Put(key, offset);
+    return key;
+}
+
+}  // namespace
+
+core::Result<core::Byte> CoalescingPciConfig::ReadConfig8(pci::Bdf bdf,
+                                                          pci::ConfigOffset offset) {
+    return coalescer_.Run<core::Byte>(ConfigKey('1', bdf, offset),
+                                      [&] { return backend_.ReadConfig8(bdf, offset); });
+}
+
+core::Result<core::Word> CoalescingPciConfig::ReadConfig16(pci::Bdf bdf,
+                                                           pci::ConfigOffset offset) {
+    return coalescer_.Run<core::Word>(ConfigKey('2', bdf, offset),
+                                      [&] { return backend_.ReadConfig16(bdf, offset); });
+}
+
+core::Result<core::DWord> CoalescingPciConfig::ReadConfig32(pci::Bdf bdf,
+                                                            pci::ConfigOffset offset) {
+    return coalescer_.Run<core::DWord>(ConfigKey('4', bdf, offset),
+                                       [&] { return backend_.ReadConfig32(bdf, offset); });
+}
+
+core::Result<void> CoalescingPciConfig::WriteConfig8(pci::Bdf bdf, pci::ConfigOffset offset,
+                                                     core::Byte value) {
+    auto result = backend_.WriteConfig8(bdf, offset, value);
+    coalescer_.Invalidate();
+    return result;
+}
+
+core::Result<void> CoalescingPciConfig::WriteConfig16(pci::Bdf bdf, pci::ConfigOffset offset,
+                                                      core::Word value) {
+    auto result = backend_.WriteConfig16(bdf, offset, value);
+    coalescer_.Invalidate();
+    return result;
+}
+
+core::Result<void> CoalescingPciConfig::WriteConfig32(pci::Bdf bdf, pci::ConfigOffset offset,
+                                                      core::DWord value) {
+    auto result = backend_.WriteConfig32(bdf, offset, value);
+    coalescer_.Invalidate();
+    return result;
+}
+
+std::size_t CoalescingPciConfig::WriteConfigBatch(pci::Bdf bdf,
+                                                  const pci::ConfigWrite* writes,
+                                                  std::size_t count, std::error_code* status) {
+    auto done = backend_.WriteConfigBatch(bdf, writes, count, status);
+    coalescer_.Invalidate();
+    return done;
+}
+
+core::Result<void> CoalescingPciConfig::ReadConfigBlock(pci::Bdf bdf,
+                                                        pci::ConfigOffset offset,
+                                                        core::Byte* buffer,
+                                                        std::size_t length) {
+    if (length == 0 || buffer == nullptr) {
+        return backend_.ReadConfigBlock(bdf, offset, buffer, length);
+    }
+    auto key = ConfigKey('k', bdf, offset);
+    Put(key, length);
+    auto result = coalescer_.Run<Bytes>(key, [&] {
+        Bytes bytes(length);
+        auto r = backend_.ReadConfigBlock(bdf, offset, bytes.data(), length);
+        if (r.IsError()) {
+            return core::Result<Bytes>::Err(r.Error());
+        }
+        return core::Result<Bytes>::Ok(std::move(bytes));
+    });
+    if (result.IsError()) {
+        return core::Result<void>::Err(result.Error());
+    }
+    std::memcpy(buffer, result.Value().data(), length);
+    return core::Result<void>::Ok();
+}
+
+// ---------------------------------------------------------------------------
+// CoalescingCxlMailbox
+// ---------------------------------------------------------------------------
+
+bool CoalescingCxlMailbox::IsReadOnlyCommand(uint16_t raw_opcode) {
+    switch (static_cast<pci::CxlMailboxOpcode>(raw_opcode)) {
+    case pci::CxlMailboxOpcode::kIdentify:
+    case pci::CxlMailboxOpcode::kGetSupportedLogs:
+    case pci::CxlMailboxOpcode::kGetLog:
+    case pci::CxlMailboxOpcode::kGetSupportedFeatures:
+    case pci::CxlMailboxOpcode::kGetFeature:
+    case pci::CxlMailboxOpcode::kGetFwInfo:
+    case pci::CxlMailboxOpcode::kGetTimestamp:
+    case pci::CxlMailboxOpcode::kIdentifyMemoryDevice:
+    case pci::CxlMailboxOpcode::kGetHealthInfo:
+    case pci::CxlMailboxOpcode::kGetAlertConfig:
+    case pci::CxlMailboxOpcode::kGetPoisonList:
+        return true;
+    default:
+        return false;
+    }
+}
+
+core::Result<pci::CxlMailboxResult> CoalescingCxlMailbox::ExecuteCommand(
+    pci::Bdf bdf, uint16_t raw_opcode, const pci::CxlMailboxPayload& payload) {
+    if (!IsReadOnlyCommand(raw_opcode)) {
+        auto result = backend_.ExecuteCommand(bdf, raw_opcode, payload);
+        coalescer_.Invalidate();
+        return result;
+    }
+    std::string key(1, 'c');
+    Put(key, bdf.Pack());
+    Put(key, raw_opcode);
+    PutBytes(key, payload.data(), payload.size());
+    return coalescer_.Run<pci::CxlMailboxResult>(
+        key, [&] { return backend_.ExecuteCommand(bdf, raw_opcode, payload); }, &Succeeded);
+}
+
+core::Result<pci::CxlMailboxResult> CoalescingCxlMailbox::ExecuteCommandGather(
+    pci::Bdf bdf, uint16_t raw_opcode, const uint8_t* header, std::size_t header_len,
+    const uint8_t* data, std::size_t data_len) {
+    if (!IsReadOnlyCommand(raw_opcode)) {
+        auto result =
+            backend_.ExecuteCommandGather(bdf, raw_opcode, header, header_len, data, data_len);
+        coalescer_.Invalidate();
+        return result;
+    }
+    // Read-only commands take small inputs; gather into one key payload.
+    return CxlMailbox::ExecuteCommandGather(bdf, raw_opcode, header, header_len, data,
+                                            data_len);
+}
+
+core::Result<pci::CxlMailboxPooledResult> CoalescingCxlMailbox::ExecuteCommandPooled(
+    pci::Bdf bdf, uint16_t raw_opcode, const uint8_t* payload, std::size_t length) {
+    if (!IsReadOnlyCommand(raw_opcode)) {
+        auto result = backend_.ExecuteCommandPooled(bdf, raw_opcode, payload, length);
+        coalescer_.Invalidate();
+        return result;
+    }
+    return CxlMailbox::ExecuteCommandPooled(bdf, raw_opcode, payload, length);
+}
+
+// ---------------------------------------------------------------------------
+// ReadCoalescingLayer
+// ---------------------------------------------------------------------------
+
+ReadCoalescingLayer::ReadCoalescingLayer(Device& device,
+                                         const ReadCoalescingOptions& options)
+    : options_(options), coalescer_(options.freshness) {
+    if (auto* i2c = InterfaceCast<I2c>(&device)) {
+        i2c_ = std::make_unique<CoalescingI2c>(*i2c, coalescer_);
+    }
+    if (auto* smbus = InterfaceCast<SmBus>(&device)) {
+        smbus_ = std::make_unique<CoalescingSmBus>(*smbus, coalescer_);
+    }
+    if (auto* config = InterfaceCast<pci::PciConfig>(&device)) {
+        pci_config_ = std::make_unique<CoalescingPciConfig>(*config, coalescer_);
+    }
+    if (auto* mailbox = InterfaceCast<pci::CxlMailbox>(&device)) {
+        cxl_mailbox_ = std::make_unique<CoalescingCxlMailbox>(*mailbox, coalescer_);
+    }
+}
+
+ReadCoalescingLayer::~ReadCoalescingLayer() = default;
+
+}  // namespace plas::hal
@@ -0,0 +1,527 @@
+#include <algorithm>
+#include <array>
+#include <type_traits>
+#include <utility>
+
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_interfaces.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/pci/pci_bar.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/transaction_trace.h"
+
+namespace plas::hal {
+
+namespace {
+
+core::ErrorCode CodeOf(const std::error_code& error) {
+    if (error.category() == core::PlasErrorCategory::Instance()) {
+        return static_cast<core::ErrorCode>(error.value());
+    }
+    return core::ErrorCode::kUnknown;
+}
+
+uint64_t PackProtocol(pci::DoeProtocolId protocol) {
+    return protocol.vendor_id | (static_cast<uint64_t>(protocol.data_object_type) << 16);
+}
+
+/// Device half of a recording wrapper: owns the wrapped device, forwards
+/// its lifecycle and stamps records.
+class RecordingBase : public Device {
+public:
+    RecordingBase(std::unique_ptr<Device> inner, std::shared_ptr<TraceWriter> writer,
+                  uint32_t id)
+        : inner_(std::move(inner)), writer_(std::move(writer)), id_(id) {}
+
+    core::Result<void> Init() override { return inner_->Init(); }
+    core::Result<void> Open() override { return inner_->Open(); }
+    core::Result<void> Close() override { return inner_->Close(); }
+    core::Result<void> Reset() override { return inner_->Reset(); }
+    DeviceState GetState() const override { return inner_->GetState(); }
+    std::string GetName() const override { return inner_->GetName(); }
+    std::string GetUri() const override { return inner_->GetUri(); }
+    std::string GetDriverName() const override { return inner_->GetDriverName(); }
+
+    Device* Inner() { return inner_.get(); }
+
+    TraceRecord Begin(TraceOp op, uint64_t target, uint64_t offset = 0, uint64_t arg = 0) {
+        TraceRecord record;
+        record.device = id_;
+        record.op = op;
+        record.target = target;
+        record.offset = offset;
+        record.arg = arg;
+        record.start_ns = writer_->Now();
+        return record;
+    }
+
+    /// Close the timing of `record` from `result`; true if it succeeded, in
+    /// which case the caller fills in the outputs before Commit().
+    template <typename R>
+    bool Finish(TraceRecord& record, const R& result) {
+        record.duration_ns = writer_->Now() - record.start_ns;
+        if (result.IsError()) {
+            record.error = CodeOf(result.Error());
+            return false;
+        }
+        return true;
+    }
+
+    void Commit(const TraceRecord& record) { writer_->Write(record); }
+
+private:
+    std::unique_ptr<Device> inner_;
+    std::shared_ptr<TraceWriter> writer_;
+    uint32_t id_;
+};
+
+/// Placeholder base for an interface the wrapped device does not have.
+template <int kSlot>
+struct Absent {
+    explicit Absent(RecordingBase&) {}
+};
+
+// ---------------------------------------------------------------------------
+// I2c
+// ---------------------------------------------------------------------------
+
+class RecordingI2c : public I2c {
+public:
+    explicit RecordingI2c(RecordingBase& owner)
+        : owner_(owner), inner_(dynamic_cast<I2c*>(owner.Inner())) {}
+
+    Device* GetDevice() override { return &owner_; }
+
+    core::Result<size_t> Read(core::Address addr, core::Byte* data, size_t length,
+                              bool stop) override {
+        auto record = owner_.Begin(TraceOp::kI2cRead, addr, 0, stop);
+        record.length = length;
+        auto result = inner_->Read(addr, data, length, stop);
+        if (owner_.Finish(record, result)) {
+            record.value = result.Value();
+            record.response.assign(data, data + std::min(result.Value(), length));
+        }
+        owner_.Commit(record);
+        return result;
+    }
+
+    core::Result<size_t> Write(core::Address addr, const core::Byte* data, size_t length,
+                               bool stop) override {
+        auto record = owner_.Begin(TraceOp::kI2cWrite, addr, 0, stop);
+        record.request.assign(data, data + length);
+        auto result = inner_->Write(addr, data, length, stop);
+        if (owner_.Finish(record, result)) {
+            record.value = result.Value();
+        }
+        owner_.Commit(record);
+        return result;
+    }
+
+    core::Result<size_t> WriteRead(core::Address addr, const core::Byte* write_data,
+                                   size_t write_len, core::Byte* read_data,
+                                   size_t read_len) override {
+        auto record = owner_.Begin(TraceOp::kI2cWriteRead, addr);
+        record.request.assign(write_data, write_data + write_len);
+        record.length = read_len;
+        auto result = inner_->WriteRead(addr, write_data, write_len, read_data, read_len);
+        if (owner_.Finish(record, result)) {
+            record.value = result.Value();
+            record.response.assign(read_data,
+                                   read_data + std::min(result.Value(), read_len));
+        }
+        owner_.Commit(record);
+        return result;
+    }
+
+    /// Forwarded whole so the backend keeps the bus for the batch; each
+    /// message is recorded as the Read/Write the default Transfer would
+    /// make, sharing the batch time. After a failure the first message that
+    /// moved nothing carries the error and the rest are not recorded.
+    core::Result<size_t> Transfer(I2cMessage* msgs, size_t count) override {
+        auto batch = owner_.Begin(TraceOp::kI2cRead, 0);
+        auto result = inner_->Transfer(msgs, count);
+        owner_.Finish(batch, result);
+        if (msgs == nullptr) {
+            return result;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            auto& msg = msgs[i];
+            bool stop = msg.stop || i + 1 == count;
+            auto record = owner_.Begin(msg.read ? TraceOp::kI2cRead : TraceOp::kI2cWrite,
+                                       msg.addr, 0, stop);
+            record.start_ns = batch.start_ns;
+            record.duration_ns = batch.duration_ns / count;
+            if (!msg.read) {
+                record.request.assign(msg.data, msg.data + msg.length);
+            } else {
+                record.length = msg.length;
+            }
+            if (result.IsError() && msg.transferred == 0) {
+                record.error = batch.error;
+                owner_.Commit(record);
+                break;
+            }
+            record.value = msg.transferred;
+            if (msg.read) {
+                record.response.assign(msg.data,
+                                       msg.data + std::min(msg.transferred, msg.length));
+            }
+            owner_.Commit(record);
+        }
+        return result;
+    }
+
+    core::Result<void> SetBitrate(uint32_t bitrate) override {
+        auto record = owner_.Begin(TraceOp::kI2cSetBitrate, 0);
+        record.value = bitrate;
+        auto result = inner_->SetBitrate(bitrate);
+        owner_.Finish(record, result);
+        owner_.Commit(record);
+        return result;
+    }
+    uint32_t GetBitrate() const override { return inner_->GetBitrate(); }
+
+private:
+    RecordingBase& owner_;
+    I2c* inner_;
+};
+
+// ---------------------------------------------------------------------------
+// PciConfig
+// ---------------------------------------------------------------------------
+
+class RecordingPciConfig : public pci::PciConfig {
+public:
+    explicit RecordingPciConfig(RecordingBase& owner)
+        : owner_(owner), inner_(dynamic_cast<pci::PciConfig*>(owner.Inner())) {}
+
+    Device* GetDevice() override { return &owner_; }
+
+    core::Result<core::Byte> ReadConfig8(pci::Bdf bdf, pci::ConfigOffset offset) override {
+        return Read<core::Byte>(TraceOp::kConfigRead8, bdf, offset,
+                    [&] { return inner_->ReadConfig8(bdf, offset); });
+    }
+    core::Result<core::Word> ReadConfig16(pci::Bdf bdf, pci::ConfigOffset offset) override {
+        return Read<core::Word>(TraceOp::kConfigRead16, bdf, offset,
+                    [&] { return inner_->ReadConfig16(bdf, offset); });
+    }
+    core::Result<core::DWord> ReadConfig32(pci::Bdf bdf, pci::ConfigOffset offset) override {
+        return Read<core::DWord>(TraceOp::kConfigRead32, bdf, offset,
+                    [&] { return inner_->ReadConfig32(bdf, offset); });
+    }
+
+    core::Result<void> WriteConfig8(pci::Bdf bdf, pci::ConfigOffset offset,
+                                    core::Byte value) override {
+        return Write(TraceOp::kConfigWrite8, bdf, offset, value,
+                     [&] { return inner_->WriteConfig8(bdf, offset, value); });
+    }
+    core::Result<void> WriteConfig16(pci::Bdf bdf, pci::ConfigOffset offset,
+                                     core::Word value) override {
+        return Write(TraceOp::kConfigWrite16, bdf, offset, value,
+                     [&] { return inner_->WriteConfig16(bdf, offset, value); });
+    }
+    core::Result<void> WriteConfig32(pci::Bdf bdf, pci::ConfigOffset offset,
+                                     core::DWord value) override {
+        return Write(TraceOp::kConfigWrite32, bdf, offset, value,
+                     [&] { return inner_->WriteConfig32(bdf, offset, value); });
+    }
+
+    core::Result<std::optional<pci::ConfigOffset>> FindCapability(
+        pci::Bdf bdf, pci::CapabilityId id) override {
+        return Find(TraceOp::kFindCapability, bdf, static_cast<uint64_t>(id),
+                    [&] { return inner_->FindCapability(bdf, id); });
+    }
+    core::Result<std::optional<pci::ConfigOffset>> FindExtCapability(
+        pci::Bdf bdf, pci::ExtCapabilityId id) override {
+        return Find(TraceOp::kFindExtCapability, bdf, static_cast<uint64_t>(id),
+                    [&] { return inner_->FindExtCapability(bdf, id); });
+    }
+
+    core::Result<void> ReadConfigBlock(pci::Bdf bdf, pci::ConfigOffset offset,
+                                       core::Byte* buffer, std::size_t length) override {
+        auto record = owner_.Begin(TraceOp::kConfigReadBlock, bdf.Pack(), offset);
+        record.length = length;
+        auto result = inner_->ReadConfigBlock(bdf, offset, buffer, length);
+        if (owner_.Finish(record, result) && buffer != nullptr) {
+            record.response.assign(buffer, buffer + length);
+        }
+        owner_.Commit(record);
+        return result;
+    }
+
+private:
+    template <typename T, typename Fn>
+    core::Result<T> Read(TraceOp op, pci::Bdf bdf, pci::ConfigOffset offset, Fn&& call) {
+        auto record = owner_.Begin(op, bdf.Pack(), offset);
+        auto result = call();
+        if (owner_.Finish(record, result)) {
+            record.value = result.Value();
+        }
+        owner_.Commit(record);
+        return result;
+    }
+
+    template <typename Fn>
+    core::Result<void> Write(TraceOp op, pci::Bdf bdf, pci::ConfigOffset offset,
+                             uint64_t value, Fn&& call) {
+        auto record = owner_.Begin(op, bdf.Pack(), offset);
+        record.value = value;
+        auto result = call();
+        owner_.Finish(record, result);
+        owner_.Commit(record);
+        return result;
+    }
+
+    template <typename Fn>
+    core::Result<std::optional<pci::ConfigOffset>> Find(TraceOp op, pci::Bdf bdf,
+                                                        uint64_t id, Fn&& call) {
+        auto record = owner_.Begin(op, bdf.Pack(), 0, id);
+        auto result = call();
+        if (owner_.Finish(record, result)) {
+            record.value = result.Value() ? *result.Value() : kTraceNoCapability;
+        }
+        owner_.Commit(record);
+        return result;
+    }
+
+    RecordingBase& owner_;
+    pci::PciConfig* inner_;
+};
+
+// ---------------------------------------------------------------------------
+// PciDoe
+// ---------------------------------------------------------------------------
+
+class RecordingPciDoe : public pci::PciDoe {
+public:
+    explicit RecordingPciDoe(RecordingBase& owner)
+        : owner_(owner), inner_(dynamic_cast<pci::PciDoe*>(owner.Inner())) {}
+
+    Device* GetDevice() override { return &owner_; }
+
+    core::Result<std::vector<pci::DoeProtocolId>> DoeDiscover(
+        pci::Bdf bdf, pci::ConfigOffset doe_offset) override {
+        auto record = owner_.Begin(TraceOp::kDoeDiscover, bdf.Pack(), doe_offset);
+        auto result = inner_->DoeDiscover(bdf, doe_offset);
+        if (owner_.Finish(record, result)) {
+            std::vector<core::DWord> packed;
+            for (const auto& protocol : result.Value()) {
+                packed.push_back(static_cast<core::DWord>(PackProtocol(protocol)));
+            }
+            record.response = EncodeTraceDWords(packed.data(), packed.size());
+        }
+        owner_.Commit(record);
+        return result;
+    }
+
+    core::Result<pci::DoePayload> DoeExchange(pci::Bdf bdf, pci::ConfigOffset doe_offset,
+                                              pci::DoeProtocolId protocol,
+                                              const pci::DoePayload& request) override {
+        auto record = owner_.Begin(TraceOp::kDoeExchange, bdf.Pack(), doe_offset,
+                                   PackProtocol(protocol));
+        record.request = EncodeTraceDWords(request.data(), request.size());
+        auto result = inner_->DoeExchange(bdf, doe_offset, protocol, request);
+        if (owner_.Finish(record, result)) {
+            record.response = EncodeTraceDWords(result.Value().data(), result.Value().size());
+        }
+        owner_.Commit(record);
+        return result;
+    }
+
+    /// Forwarded so zero-copy backends stay zero-copy; recorded as a
+    /// DoeExchange.
+    core::Result<std::size_t> DoeExchangeInto(pci::Bdf bdf, pci::ConfigOffset doe_offset,
+                                              pci::DoeProtocolId protocol,
+                                              const core::DWord* request,
+                                              std::size_t request_len,
+                                              core::DWord* response,
+                                              std::size_t response_capacity) override {
+        auto record = owner_.Begin(TraceOp::kDoeExchange, bdf.Pack(), doe_offset,
+                                   PackProtocol(protocol));
+        if (request != nullptr) {
+            record.request = EncodeTraceDWords(request, request_len);
+        }
+        auto result = inner_->DoeExchangeInto(bdf, doe_offset, protocol, request,
+                                              request_len, response, response_capacity);
+        if (owner_.Finish(record, result)) {
+            record.response = EncodeTraceDWords(response, result.Value());
+        }
+        owner_.Commit(record);
+        return result;
+    }
+
+private:
+    RecordingBase& owner_;
+    pci::PciDoe* inner_;
+};
+
+// ---------------------------------------------------------------------------
+// PciBar
+// ---------------------------------------------------------------------------
+
+class RecordingPciBar : public pci::PciBar {
+public:
+    explicit RecordingPciBar(RecordingBase& owner)
+        : owner_(owner), inner_(dynamic_cast<pci::PciBar*>(owner.Inner())) {}
+
+    Device* GetDevice() override { return &owner_; }
+
+    core::Result<core::DWord> BarRead32(pci::Bdf bdf, uint8_t bar_index,
+                                        uint64_t offset) override {
+        return Read<core::DWord>(TraceOp::kBarRead32, bdf, bar_index, offset,
+                    [&] { return inner_->BarRead32(bdf, bar_index, offset); });
+    }
+    core::Result<core::QWord> BarRead64(pci::Bdf bdf, uint8_t bar_index,
+                                        uint64_t offset) override {
+        return Read<core::QWord>(TraceOp::kBarRead64, bdf, bar_index, offset,
+                    [&] { return inner_->BarRead64(bdf, bar_index, offset); });
+    }
+
+    core::Result<void> BarWrite32(pci::Bdf bdf, uint8_t bar_index, uint64_t offset,
+                                  core::DWord value) override {
+        auto record = owner_.Begin(TraceOp::kBarWrite32, bdf.Pack(), offset, bar_index);
+        record.value = value;
+        auto result = inner_->BarWrite32(bdf, bar_index, offset, value);
+        owner_.Finish(record, result);
+        owner_.Commit(record);
+        return result;
+    }
+    core::Result<void> BarWrite64(pci::Bdf bdf, uint8_t bar_index, uint64_t offset,
+                                  core::QWord value) override {
+        auto record = owner_.Begin(TraceOp::kBarWrite64, bdf.Pack(), offset, bar_index);
+        record.value = value;
+        auto result = inner_->BarWrite64(bdf, bar_index, offset, value);
+        owner_.Finish(record, result);
+        owner_.Commit(record);
+        return result;
+    }
+
+    core::Result<void> BarReadBuffer(pci::Bdf bdf, uint8_t bar_index, uint64_t offset,
+                                     void* buffer, std::size_t length) override {
+        auto record = owner_.Begin(TraceOp::kBarReadBuffer, bdf.Pack(), offset, bar_index);
+        record.length = length;
+        auto result = inner_->BarReadBuffer(bdf, bar_index, offset, buffer, length);
+        if (owner_.Finish(record, result) && buffer != nullptr) {
+            const auto* bytes = static_cast<const core::Byte*>(buffer);
+            record.response.assign(bytes, bytes + length);
+        }
+        owner_.Commit(record);
+        return result;
+    }
+    core::Result<void> BarWriteBuffer(pci::Bdf bdf, uint8_t bar_index, uint64_t offset,
+                                      const void* buffer, std::size_t length) override {
+        auto record = owner_.Begin(TraceOp::kBarWriteBuffer, bdf.Pack(), offset, bar_index);
+        if (buffer != nullptr) {
+            const auto* bytes = static_cast<const core::Byte*>(buffer);
+            record.request.assign(bytes, bytes + length);
+        }
+        auto result = inner_->BarWriteBuffer(bdf, bar_index, offset, buffer, length);
+        owner_.Finish(record, result);
+        owner_.Commit(record);
+        return result;
+    }
+
+    core::Result<void> SetBarMapping(pci::Bdf bdf, uint8_t bar_index,
+                                     pci::BarMapping mapping) override {
+        return inner_->SetBarMapping(bdf, bar_index, mapping);
+    }
+    core::Result<void> BarFlush(pci::Bdf bdf, uint8_t bar_index) override {
+        return inner_->BarFlush(bdf, bar_index);
+    }
+
+private:
+    template <typename T, typename Fn>
+    core::Result<T> Read(TraceOp op, pci::Bdf bdf, uint8_t bar_index, uint64_t offset,
+                         Fn&& call) {
+        auto record = owner_.Begin(op, bdf.Pack(), offset, bar_index);
+        auto result = call();
+        if (owner_.Finish(record, result)) {
+            record.value = result.Value();
+        }
+        owner_.Commit(record);
+        return result;
+    }
+
+    RecordingBase& owner_;
+    pci::PciBar* inner_;
+};
+
+// ---------------------------------------------------------------------------
+// Wrapper assembly
+// ---------------------------------------------------------------------------
+
+template <unsigned kMask>
+using RecordingI2cPart = std::conditional_t<(kMask & 1u) != 0, RecordingI2c, Absent<0>>;
+template <unsigned kMask>
+using RecordingPciConfigPart = std::conditional_t<(kMask & 2u) != 0, RecordingPciConfig, Absent<1>>;
+template <unsigned kMask>
+using RecordingPciDoePart = std::conditional_t<(kMask & 4u) != 0, RecordingPciDoe, Absent<2>>;
+template <unsigned kMask>
+using RecordingPciBarPart = std::conditional_t<(kMask & 8u) != 0, RecordingPciBar, Absent<3>>;
+
+/// Wrapper with one recording base per interface bit in `kMask`
+/// (1: I2c, 2: PciConfig, 4: PciDoe, 8: PciBar).
+template <unsigned kMask>
+class RecordingDevice final : public RecordingBase,
+                              public RecordingI2cPart<kMask>,
+                              public RecordingPciConfigPart<kMask>,
+                              public RecordingPciDoePart<kMask>,
+                              public RecordingPciBarPart<kMask> {
+public:
+    // The casts select the mixin constructors rather than their copy constructors.
+    RecordingDevice(std::unique_ptr<Device> inner, std::shared_ptr<TraceWriter> writer,
+                    uint32_t id)
+        : RecordingBase(std::move(inner), std::move(writer), id),
+          RecordingI2cPart<kMask>(static_cast<RecordingBase&>(*this)),
+          RecordingPciConfigPart<kMask>(static_cast<RecordingBase&>(*this)),
+          RecordingPciDoePart<kMask>(static_cast<RecordingBase&>(*this)),
+          RecordingPciBarPart<kMask>(static_cast<RecordingBase&>(*this)) {}
+
+    void* QueryInterface(InterfaceKind kind) override {
+        return QueryInterfaceOf(this, kind, ImplementedInterfaces<RecordingDevice>{});
+    }
+};
+
+using Maker = std::unique_ptr<Device> (*)(std::unique_ptr<Device>,
+                                          std::shared_ptr<TraceWriter>, uint32_t);
+
+template <unsigned kMask>
+std::unique_ptr<Device> Make(std::unique_ptr<Device> inner,
+                             std::shared_ptr<TraceWriter> writer, uint32_t id) {
+    return std::make_unique<RecordingDevice<kMask>>(std::move(inner), std::move(writer), id);
+}
+
+template <std::size_t... kMasks>
+constexpr std::array<Maker, sizeof...(kMasks)> MakeTable(std::index_sequence<kMasks...>) {
+    return {&Make<static_cast<unsigned>(kMasks)>...};
+}
+
+}  // namespace
+
+std::unique_ptr<Device> RecordTransactions(std::unique_ptr<Device> device,
+                                           std::shared_ptr<TraceWriter> writer) {
+    if (!device || !writer) {
+        return device;
+    }
+    unsigned mask = 0;
+    TraceDevice info{device->GetName(), device->GetUri(), device->GetDriverName(), 0};
+    auto add = [&](bool has, unsigned bit, InterfaceKind kind) {
+        if (has) {
+            mask |= bit;
+            info.interfaces |= 1u << static_cast<uint32_t>(kind);
+        }
+    };
+    add(InterfaceCast<I2c>(device.get()) != nullptr, 1u, InterfaceKind::kI2c);
+    add(InterfaceCast<pci::PciConfig>(device.get()) != nullptr, 2u, InterfaceKind::kPciConfig);
+    add(InterfaceCast<pci::PciDoe>(device.get()) != nullptr, 4u, InterfaceKind::kPciDoe);
+    add(InterfaceCast<pci::PciBar>(device.get()) != nullptr, 8u, InterfaceKind::kPciBar);
+    if (mask == 0) {
+        return device;
+    }
+    static constexpr auto kMakers = MakeTable(std::make_index_sequence<16>());
+    uint32_t id = writer->AddDevice(info);
+    return kMakers[mask](std::move(device), std::move(writer), id);
+}
+
+}  // namespace plas::hal
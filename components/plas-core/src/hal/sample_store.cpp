@@ -0,0 +1,591 @@
+#include "plas/hal/sample_store.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "plas/core/error.h"
+
+namespace plas::hal {
+
+// A block's size is published last with a release store into the mapping,
+// so it is accessed as an atomic in place.
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) &&
+                  alignof(std::atomic<uint32_t>) == alignof(uint32_t),
+              "atomic<uint32_t> must overlay a plain uint32_t");
+static_assert(offsetof(SampleBlockHeader, size) == 0, "size must lead the block header");
+
+namespace {
+
+constexpr std::size_t kMaxBytesPerSample = 10 + 10 + 5;  // varint64 x2, varint32
+constexpr std::size_t kDrainBatch = 256;
+
+std::size_t MaxBlockBytes(std::size_t samples) {
+    return sizeof(SampleBlockHeader) + samples * kMaxBytesPerSample + 8;
+}
+
+uint64_t NowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+}
+
+std::size_t PageSize() {
+    static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return page;
+}
+
+/// Signal names become file names with every byte outside [A-Za-z0-9._:-]
+/// (and a leading '.') escaped as %XX, so distinct names never collide.
+std::string FileNameFor(const std::string& signal) {
+    static const char* kHex = "0123456789ABCDEF";
+    std::string name;
+    for (std::size_t i = 0; i < signal.size(); ++i) {
+        auto c = static_cast<unsigned char>(signal[i]);
+        bool plain = std::isalnum(c) || c == '_' || c == ':' || c == '-' ||
+                     (c == '.' && i != 0);
+        if (plain) {
+            name += static_cast<char>(c);
+        } else {
+            name += '%';
+            name += kHex[c >> 4];
+            name += kHex[c & 0xF];
+        }
+    }
+    return name + kSampleFileExtension;
+}
+
+void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool GetVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t ZigZag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t UnZigZag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+uint64_t Bits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double FromBits(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/// Encode `samples` as one block (header included) into `out`.
+void EncodeBlock(const std::vector<Sample>& samples, std::vector<uint8_t>& out) {
+    SampleBlockHeader header{};
+    header.count = static_cast<uint32_t>(samples.size());
+    header.min_ns = samples.front().timestamp_ns;
+    header.max_ns = samples.front().timestamp_ns;
+    for (const auto& sample : samples) {
+        header.min_ns = std::min(header.min_ns, sample.timestamp_ns);
+        header.max_ns = std::max(header.max_ns, sample.timestamp_ns);
+    }
+
+    out.assign(sizeof(header), 0);
+    uint64_t previous = header.min_ns;
+    for (const auto& sample : samples) {
+        PutVarint(out, ZigZag(static_cast<int64_t>(sample.timestamp_ns - previous)));
+        previous = sample.timestamp_ns;
+    }
+    header.timestamp_bytes = static_cast<uint32_t>(out.size() - sizeof(header));
+
+    std::size_t mark = out.size();
+    uint64_t previous_bits = 0;
+    for (const auto& sample : samples) {
+        uint64_t bits = Bits(sample.value);
+        PutVarint(out, bits ^ previous_bits);
+        previous_bits = bits;
+    }
+    header.value_bytes = static_cast<uint32_t>(out.size() - mark);
+
+    mark = out.size();
+    for (const auto& sample : samples) {
+        PutVarint(out, static_cast<uint32_t>(sample.error.value()));
+        header.error_count += sample.error ? 1u : 0u;
+    }
+    header.error_bytes = static_cast<uint32_t>(out.size() - mark);
+
+    out.resize((out.size() + 7) & ~std::size_t{7}, 0);
+    header.size = static_cast<uint32_t>(out.size());
+    std::memcpy(out.data(), &header, sizeof(header));
+}
+
+/// Decode the samples of `header` within [from_ns, to_ns] into `out`.
+bool DecodeBlock(const SampleBlockHeader& header, const uint8_t* columns, uint64_t from_ns,
+                 uint64_t to_ns, std::vector<Sample>& out) {
+    const uint8_t* ts = columns;
+    const uint8_t* ts_end = ts + header.timestamp_bytes;
+    const uint8_t* value = ts_end;
+    const uint8_t* value_end = value + header.value_bytes;
+    const uint8_t* error = value_end;
+    const uint8_t* error_end = error + header.error_bytes;
+
+    uint64_t timestamp = header.min_ns;
+    uint64_t bits = 0;
+    for (uint32_t i = 0; i < header.count; ++i) {
+        uint64_t delta = 0;
+        uint64_t xored = 0;
+        uint64_t code = 0;
+        if (!GetVarint(ts, ts_end, delta) || !GetVarint(value, value_end, xored) ||
+            !GetVarint(error, error_end, code)) {
+            return false;
+        }
+        timestamp += static_cast<uint64_t>(UnZigZag(delta));
+        bits ^= xored;
+        if (timestamp < from_ns || timestamp > to_ns) {
+            continue;
+        }
+        Sample sample;
+        sample.timestamp_ns = timestamp;
+        sample.value = FromBits(bits);
+        if (code != 0) {
+            sample.error = core::make_error_code(static_cast<core::ErrorCode>(code));
+        }
+        out.push_back(sample);
+    }
+    return true;
+}
+
+/// A signal file mapped read-only for the reader.
+class MappedFile {
+public:
+    ~MappedFile() {
+        if (base_ && base_ != MAP_FAILED) {
+            ::munmap(base_, size_);
+        }
+    }
+
+    core::Result<void> Open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return core::Result<void>::Err(core::ErrorCode::kNotFound);
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) <
+                                         sizeof(SampleFileHeader)) {
+            ::close(fd);
+            return core::Result<void>::Err(core::ErrorCode::kDataLoss);
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        base_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base_ == MAP_FAILED) {
+            return core::Result<void>::Err(core::ErrorCode::kIOError);
+        }
+        const auto* header = static_cast<const SampleFileHeader*>(base_);
+        if (std::memcmp(header->magic, kSampleFileMagic, sizeof(header->magic)) != 0 ||
+            header->version != kSampleFileVersion) {
+            return core::Result<void>::Err(core::ErrorCode::kTypeMismatch);
+        }
+        return core::Result<void>::Ok();
+    }
+
+    /// Calls fn(header, columns) for each complete block; false on a block
+    /// that overruns the file.
+    template <typename Fn>
+    bool ForEachBlock(Fn&& fn) const {
+        const auto* data = static_cast<const uint8_t*>(base_);
+        std::size_t offset = sizeof(SampleFileHeader);
+        while (offset + sizeof(SampleBlockHeader) <= size_) {
+            auto size = reinterpret_cast<const std::atomic<uint32_t>*>(data + offset)
+                            ->load(std::memory_order_acquire);
+            if (size == 0) {
+                break;
+            }
+            SampleBlockHeader header;
+            std::memcpy(&header, data + offset, sizeof(header));
+            std::size_t columns = std::size_t{header.timestamp_bytes} + header.value_bytes +
+                                  header.error_bytes;
+            if (size < sizeof(header) + columns || offset + size > size_) {
+                return false;
+            }
+            fn(header, data + offset + sizeof(header));
+            offset += size;
+        }
+        return true;
+    }
+
+private:
+    void* base_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// SampleStore
+// ---------------------------------------------------------------------------
+struct SampleStore::Impl {
+    /// One signal's file: the append offset, the mapped window around it,
+    /// and the samples not yet written as a block.
+    struct SignalFile {
+        int fd = -1;
+        uint64_t end = 0;  // offset of the next block
+        uint64_t file_size = 0;
+        uint8_t* window = nullptr;
+        uint64_t window_offset = 0;
+        std::size_t window_size = 0;
+        std::vector<Sample> pending;
+    };
+
+    explicit Impl(SampleStoreOptions opts) : options(opts) {}
+
+    SampleStoreOptions options;
+    mutable std::mutex mutex;
+    std::string directory;
+    bool open = false;
+    std::unordered_map<std::string, std::unique_ptr<SignalFile>> files;
+    std::vector<uint8_t> scratch;  // encoded block
+
+    core::Result<SignalFile*> FileLocked(const std::string& signal) {
+        auto it = files.find(signal);
+        if (it != files.end()) {
+            return core::Result<SignalFile*>::Ok(it->second.get());
+        }
+
+        auto path = directory + "/" + FileNameFor(signal);
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            return core::Result<SignalFile*>::Err(core::ErrorCode::kPermissionDenied);
+        }
+        auto file = std::make_unique<SignalFile>();
+        file->fd = fd;
+        auto scanned = ScanOrCreate(*file, signal);
+        if (scanned.IsError()) {
+            ::close(fd);
+            return core::Result<SignalFile*>::Err(scanned.Error());
+        }
+        file->pending.reserve(options.block_samples);
+        auto* raw = file.get();
+        files.emplace(signal, std::move(file));
+        return core::Result<SignalFile*>::Ok(raw);
+    }
+
+    /// Write the header of a new file, or find the end of an existing one.
+    core::Result<void> ScanOrCreate(SignalFile& file, const std::string& signal) {
+        struct stat st {};
+        if (::fstat(file.fd, &st) != 0) {
+            return core::Result<void>::Err(core::ErrorCode::kIOError);
+        }
+        if (st.st_size == 0) {
+            SampleFileHeader header{};
+            std::memcpy(header.magic, kSampleFileMagic, sizeof(header.magic));
+            header.version = kSampleFileVersion;
+            header.header_size = sizeof(header);
+            std::memcpy(header.signal, signal.data(), signal.size());
+            header.created_ns = NowNs();
+            if (::pwrite(file.fd, &header, sizeof(header), 0) !=
+                static_cast<ssize_t>(sizeof(header))) {
+                return core::Result<void>::Err(core::ErrorCode::kIOError);
+            }
+            file.end = file.file_size = sizeof(header);
+            return core::Result<void>::Ok();
+        }
+
+        SampleFileHeader header{};
+        if (::pread(file.fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+            std::memcmp(header.magic, kSampleFileMagic, sizeof(header.magic)) != 0 ||
+            header.version != kSampleFileVersion) {
+            return core::Result<void>::Err(core::ErrorCode::kTypeMismatch);
+        }
+        file.file_size = static_cast<uint64_t>(st.st_size);
+        uint64_t offset = sizeof(header);
+        SampleBlockHeader block{};
+        while (offset + sizeof(block) <= file.file_size &&
+               ::pread(file.fd, &block, sizeof(block), static_cast<off_t>(offset)) ==
+                   static_cast<ssize_t>(sizeof(block)) &&
+               block.size >= sizeof(block) && offset + block.size <= file.file_size) {
+            offset += block.size;
+        }
+        file.end = offset;
+        return core::Result<void>::Ok();
+    }
+
+    /// Map the window holding [end, end + bytes), growing the file first.
+    core::Result<void> MapLocked(SignalFile& file, std::size_t bytes) {
+        if (file.window && file.end + bytes <= file.window_offset + file.window_size) {
+            return core::Result<void>::Ok();
+        }
+        if (file.window) {
+            ::munmap(file.window, file.window_size);
+            file.window = nullptr;
+        }
+        std::size_t page = PageSize();
+        file.window_offset = file.end & ~static_cast<uint64_t>(page - 1);
+        file.window_size = (options.map_window + page - 1) / page * page + page;
+        uint64_t needed = file.window_offset + file.window_size;
+        if (file.file_size < needed) {
+            if (::ftruncate(file.fd, static_cast<off_t>(needed)) != 0) {
+                return core::Result<void>::Err(core::ErrorCode::kIOError);
+            }
+            file.file_size = needed;
+        }
+        void* base = ::mmap(nullptr, file.window_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                            file.fd, static_cast<off_t>(file.window_offset));
+        if (base == MAP_FAILED) {
+            return core::Result<void>::Err(core::ErrorCode::kIOError);
+        }
+        file.window = static_cast<uint8_t*>(base);
+        return core::Result<void>::Ok();
+    }
+
+    core::Result<void> SealLocked(SignalFile& file) {
+        if (file.pending.empty()) {
+            return core::Result<void>::Ok();
+        }
+        EncodeBlock(file.pending, scratch);
+        auto mapped = MapLocked(file, scratch.size());
+        if (mapped.IsError()) {
+            return mapped;
+        }
+        // Columns first, then the size that makes the block visible.
+        uint8_t* block = file.window + (file.end - file.window_offset);
+        std::memcpy(block + sizeof(uint32_t), scratch.data() + sizeof(uint32_t),
+                    scratch.size() - sizeof(uint32_t));
+        reinterpret_cast<std::atomic<uint32_t>*>(block)->store(
+            static_cast<uint32_t>(scratch.size()), std::memory_order_release);
+        file.end += scratch.size();
+        file.pending.clear();
+        return core::Result<void>::Ok();
+    }
+
+    void CloseFileLocked(SignalFile& file) {
+        SealLocked(file);
+        if (file.window) {
+            ::msync(file.window, file.window_size, MS_ASYNC);
+            ::munmap(file.window, file.window_size);
+            file.window = nullptr;
+        }
+        // Drop the zero tail left by the last window.
+        if (::ftruncate(file.fd, static_cast<off_t>(file.end)) == 0) {
+            file.file_size = file.end;
+        }
+        ::close(file.fd);
+        file.fd = -1;
+    }
+};
+
+SampleStore::SampleStore(SampleStoreOptions options)
+    : impl_(std::make_unique<Impl>(options)) {}
+
+SampleStore::~SampleStore() {
+    Close();
+}
+
+core::Result<void> SampleStore::Open(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (impl_->open) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+    }
+    const auto& options = impl_->options;
+    if (directory.empty() || options.block_samples == 0 ||
+        options.map_window < MaxBlockBytes(options.block_samples)) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (!std::filesystem::is_directory(directory, ec)) {
+        return core::Result<void>::Err(core::ErrorCode::kPermissionDenied);
+    }
+    impl_->directory = directory;
+    impl_->open = true;
+    return core::Result<void>::Ok();
+}
+
+void SampleStore::Close() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (!impl_->open) {
+        return;
+    }
+    for (auto& [name, file] : impl_->files) {
+        impl_->CloseFileLocked(*file);
+    }
+    impl_->files.clear();
+    impl_->open = false;
+}
+
+bool SampleStore::IsOpen() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->open;
+}
+
+core::Result<void> SampleStore::Append(const std::string& signal, const Sample* samples,
+                                       std::size_t count) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (!impl_->open) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (signal.empty() || signal.size() >= kSampleSignalNameSize) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    auto file = impl_->FileLocked(signal);
+    if (file.IsError()) {
+        return core::Result<void>::Err(file.Error());
+    }
+    auto& f = *file.Value();
+    for (std::size_t i = 0; i < count; ++i) {
+        f.pending.push_back(samples[i]);
+        if (f.pending.size() >= impl_->options.block_samples) {
+            auto sealed = impl_->SealLocked(f);
+            if (sealed.IsError()) {
+                return sealed;
+            }
+        }
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<std::size_t> SampleStore::Drain(Sampler& sampler) {
+    Sample batch[kDrainBatch];
+    std::size_t moved = 0;
+    std::size_t signals = sampler.SignalCount();
+    for (SignalId id = 0; id < signals; ++id) {
+        std::string name = sampler.GetSignalName(id);
+        std::size_t n;
+        while ((n = sampler.Read(id, batch, kDrainBatch)) > 0) {
+            auto appended = Append(name, batch, n);
+            if (appended.IsError()) {
+                return core::Result<std::size_t>::Err(appended.Error());
+            }
+            moved += n;
+        }
+    }
+    return core::Result<std::size_t>::Ok(moved);
+}
+
+core::Result<void> SampleStore::Flush() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (!impl_->open) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    for (auto& [name, file] : impl_->files) {
+        auto sealed = impl_->SealLocked(*file);
+        if (sealed.IsError()) {
+            return sealed;
+        }
+    }
+    return core::Result<void>::Ok();
+}
+
+std::string SampleStore::GetDirectory() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->directory;
+}
+
+// ---------------------------------------------------------------------------
+// SampleStoreReader
+// ---------------------------------------------------------------------------
+SampleStoreReader::SampleStoreReader(std::string directory)
+    : directory_(std::move(directory)) {}
+
+core::Result<std::vector<std::string>> SampleStoreReader::ListSignals() const {
+    std::error_code ec;
+    std::filesystem::directory_iterator it(directory_, ec);
+    if (ec) {
+        return core::Result<std::vector<std::string>>::Err(core::ErrorCode::kNotFound);
+    }
+    std::vector<std::string> signals;
+    for (const auto& entry : it) {
+        if (entry.path().extension() != kSampleFileExtension) {
+            continue;
+        }
+        int fd = ::open(entry.path().c_str(), O_RDONLY);
+        if (fd < 0) {
+            continue;
+        }
+        SampleFileHeader header{};
+        bool valid = ::pread(fd, &header, sizeof(header), 0) ==
+                         static_cast<ssize_t>(sizeof(header)) &&
+                     std::memcmp(header.magic, kSampleFileMagic, sizeof(header.magic)) == 0;
+        ::close(fd);
+        if (valid) {
+            header.signal[kSampleSignalNameSize - 1] = '\0';
+            signals.emplace_back(header.signal);
+        }
+    }
+    std::sort(signals.begin(), signals.end());
+    return core::Result<std::vector<std::string>>::Ok(std::move(signals));
+}
+
+core::Result<SampleRange> SampleStoreReader::GetRange(const std::string& signal) const {
+    MappedFile file;
+    auto opened = file.Open(directory_ + "/" + FileNameFor(signal));
+    if (opened.IsError()) {
+        return core::Result<SampleRange>::Err(opened.Error());
+    }
+    SampleRange range;
+    bool intact = file.ForEachBlock([&](const SampleBlockHeader& header, const uint8_t*) {
+        range.first_ns = range.blocks == 0 ? header.min_ns
+                                           : std::min(range.first_ns, header.min_ns);
+        range.last_ns = std::max(range.last_ns, header.max_ns);
+        range.count += header.count;
+        range.errors += header.error_count;
+        ++range.blocks;
+    });
+    if (!intact) {
+        return core::Result<SampleRange>::Err(core::ErrorCode::kDataLoss);
+    }
+    return core::Result<SampleRange>::Ok(range);
+}
+
+core::Result<std::size_t> SampleStoreReader::Query(const std::string& signal,
+                                                   uint64_t from_ns, uint64_t to_ns,
+                                                   std::vector<Sample>& out) const {
+    MappedFile file;
+    auto opened = file.Open(directory_ + "/" + FileNameFor(signal));
+    if (opened.IsError()) {
+        return core::Result<std::size_t>::Err(opened.Error());
+    }
+    std::size_t before = out.size();
+    bool decoded = true;
+    bool intact = file.ForEachBlock([&](const SampleBlockHeader& header,
+                                        const uint8_t* columns) {
+        if (!decoded || header.max_ns < from_ns || header.min_ns > to_ns) {
+            return;
+        }
+        decoded = DecodeBlock(header, columns, from_ns, to_ns, out);
+    });
+    if (!intact || !decoded) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kDataLoss);
+    }
+    return core::Result<std::size_t>::Ok(out.size() - before);
+}
+
+}  // namespace plas::hal
@@ -0,0 +1,554 @@
+#include "plas/hal/sampler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/core/executor.h"
+#include "plas/core/spsc_ring.h"
+#include "plas/hal/device_manager.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/power_control.h"
+
+namespace plas::hal {
+
+namespace {
+
+uint64_t NowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+std::string Trim(const std::string& s) {
+    auto begin = s.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return {};
+    }
+    auto end = s.find_last_not_of(" \t");
+    return s.substr(begin, end - begin + 1);
+}
+
+std::vector<std::string> Split(const std::string& s, char separator) {
+    std::vector<std::string> parts;
+    std::size_t begin = 0;
+    for (;;) {
+        auto end = s.find(separator, begin);
+        parts.push_back(Trim(s.substr(begin, end - begin)));
+        if (end == std::string::npos) {
+            return parts;
+        }
+        begin = end + 1;
+    }
+}
+
+/// "250us", "100ms", "2s".
+std::optional<std::chrono::microseconds> ParsePeriod(const std::string& text) {
+    std::size_t digits = 0;
+    while (digits < text.size() && text[digits] >= '0' && text[digits] <= '9') {
+        ++digits;
+    }
+    if (digits == 0 || digits > 12) {
+        return std::nullopt;
+    }
+    auto count = static_cast<int64_t>(std::stoll(text.substr(0, digits)));
+    auto unit = text.substr(digits);
+    if (unit == "us") return std::chrono::microseconds(count);
+    if (unit == "ms") return std::chrono::milliseconds(count);
+    if (unit == "s") return std::chrono::seconds(count);
+    return std::nullopt;
+}
+
+std::optional<unsigned long> ParseNumber(const std::string& text, unsigned long max) {
+    if (text.empty()) {
+        return std::nullopt;
+    }
+    try {
+        std::size_t used = 0;
+        unsigned long value = std::stoul(text, &used, 0);
+        if (used != text.size() || value > max) {
+            return std::nullopt;
+        }
+        return value;
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Pimpl definition
+// ---------------------------------------------------------------------------
+struct Sampler::Impl {
+    struct Signal {
+        std::string name;
+        std::chrono::microseconds period;
+        uint32_t group = 0;
+        uint32_t tag = 0;
+        std::function<core::Result<double>()> read;
+        core::SpscRing<Sample> ring;
+
+        std::atomic<uint64_t> samples{0};
+        std::atomic<uint64_t> errors{0};
+        std::atomic<uint64_t> skipped{0};
+
+        // Timer wheel state, touched only by Start() and Tick().
+        uint64_t period_ticks = 1;
+        uint64_t next_tick = 0;
+
+        explicit Signal(std::size_t capacity) : ring(capacity) {}
+    };
+
+    struct Group {
+        std::string key;
+        SampleBatchReader reader;
+        /// Set by Tick() when it posts the group's task, cleared by the
+        /// task. `due` belongs to Tick() while clear, to the task while set.
+        std::atomic<bool> busy{false};
+        std::vector<SignalId> due;
+        std::vector<uint32_t> tags;  // task scratch
+        std::vector<Sample> out;
+    };
+
+    /// A signal declared with the `sample` config arg.
+    struct ConfigRead {
+        enum class Kind { kVoltage, kCurrent, kI2c } kind;
+        PowerControl* power = nullptr;
+        I2c* i2c = nullptr;
+        core::Byte addr = 0;
+        core::Byte reg = 0;
+        std::size_t length = 0;
+    };
+
+    explicit Impl(const SamplerOptions& opts)
+        : options(opts),
+          executor(opts.executor ? *opts.executor : core::Executor::Shared()) {
+        if (options.tick.count() <= 0) {
+            options.tick = std::chrono::microseconds(1);
+        }
+        options.wheel_slots = std::max<std::size_t>(options.wheel_slots, 1);
+    }
+
+    uint32_t GroupLocked(const std::string& key) {
+        auto it = group_index.find(key);
+        if (it != group_index.end()) {
+            return it->second;
+        }
+        auto group = std::make_unique<Group>();
+        group->key = key;
+        groups.push_back(std::move(group));
+        auto index = static_cast<uint32_t>(groups.size() - 1);
+        group_index.emplace(key, index);
+        return index;
+    }
+
+    core::Result<SignalId> AddLocked(SamplerSignal signal) {
+        if (timer != 0) {
+            return core::Result<SignalId>::Err(core::ErrorCode::kBusy);
+        }
+        if (signal.name.empty() || signal.period.count() <= 0 ||
+            names.count(signal.name) != 0) {
+            return core::Result<SignalId>::Err(core::ErrorCode::kInvalidArgument);
+        }
+        auto entry = std::make_unique<Signal>(options.ring_capacity);
+        entry->name = signal.name;
+        entry->period = signal.period;
+        entry->group = GroupLocked(signal.batch_key.empty() ? signal.name : signal.batch_key);
+        entry->tag = signal.tag;
+        entry->read = std::move(signal.read);
+        signals.push_back(std::move(entry));
+        auto id = static_cast<SignalId>(signals.size() - 1);
+        names.emplace(signal.name, id);
+        return core::Result<SignalId>::Ok(id);
+    }
+
+    /// One timer tick: take every signal due by now off the wheel, put it
+    /// back at its next period and post one task per batch key.
+    void Tick() {
+        auto now_tick = static_cast<uint64_t>((std::chrono::steady_clock::now() - start) /
+                                              options.tick);
+        if (now_tick <= last_tick) {
+            return;
+        }
+        // Everything due in (last_tick, now_tick] sits in these slots; after
+        // a stall longer than one turn that is every slot.
+        auto slots = wheel.size();
+        auto span = std::min<uint64_t>(now_tick - last_tick, slots);
+        for (uint64_t k = 1; k <= span; ++k) {
+            auto& entries = wheel[(last_tick + k) % slots];
+            for (std::size_t i = 0; i < entries.size();) {
+                SignalId id = entries[i];
+                auto& signal = *signals[id];
+                if (signal.next_tick > now_tick) {
+                    ++i;  // a later turn of the wheel
+                    continue;
+                }
+                entries[i] = entries.back();
+                entries.pop_back();
+
+                uint64_t missed = (now_tick - signal.next_tick) / signal.period_ticks;
+                signal.next_tick += (missed + 1) * signal.period_ticks;
+                wheel[signal.next_tick % slots].push_back(id);
+                if (missed) {
+                    signal.skipped.fetch_add(missed, std::memory_order_relaxed);
+                }
+
+                auto& group = *groups[signal.group];
+                if (group.busy.load(std::memory_order_acquire)) {
+                    signal.skipped.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                if (group.due.empty()) {
+                    due_groups.push_back(signal.group);
+                }
+                group.due.push_back(id);
+            }
+        }
+        last_tick = now_tick;
+
+        for (uint32_t index : due_groups) {
+            groups[index]->busy.store(true, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lock(flight_mutex);
+                ++in_flight;
+            }
+            executor.Post([this, index] { RunGroup(index); });
+        }
+        due_groups.clear();
+    }
+
+    void RunGroup(uint32_t index) {
+        auto& group = *groups[index];
+        std::size_t count = group.due.size();
+        group.out.assign(count, Sample{});
+        if (group.reader) {
+            group.tags.clear();
+            uint64_t now = NowNs();
+            for (std::size_t i = 0; i < count; ++i) {
+                group.tags.push_back(signals[group.due[i]]->tag);
+                group.out[i].timestamp_ns = now;
+            }
+            group.reader(group.tags.data(), count, group.out.data());
+        } else {
+            for (std::size_t i = 0; i < count; ++i) {
+                auto& sample = group.out[i];
+                sample.timestamp_ns = NowNs();
+                auto value = signals[group.due[i]]->read();
+                if (value.IsOk()) {
+                    sample.value = value.Value();
+                } else {
+                    sample.error = value.Error();
+                }
+            }
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            auto& signal = *signals[group.due[i]];
+            signal.ring.Push(group.out[i]);
+            signal.samples.fetch_add(1, std::memory_order_relaxed);
+            if (!group.out[i].Ok()) {
+                signal.errors.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        group.due.clear();
+        group.busy.store(false, std::memory_order_release);
+
+        std::lock_guard<std::mutex> lock(flight_mutex);
+        if (--in_flight == 0) {
+            idle.notify_all();
+        }
+    }
+
+    /// Batch reader of one device's config signals: PowerControl reads one
+    /// by one, then every I2C register read in a single Transfer.
+    void ReadConfigBatch(const uint32_t* tags, std::size_t count, Sample* out) {
+        std::vector<I2cMessage> messages;
+        std::vector<core::Byte> buffer;
+        std::vector<std::size_t> i2c_samples;
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto& read = config_reads[tags[i]];
+            switch (read.kind) {
+            case ConfigRead::Kind::kVoltage: {
+                auto volts = read.power->GetVoltage();
+                if (volts.IsOk()) {
+                    out[i].value = volts.Value().Value();
+                } else {
+                    out[i].error = volts.Error();
+                }
+                break;
+            }
+            case ConfigRead::Kind::kCurrent: {
+                auto amps = read.power->GetCurrent();
+                if (amps.IsOk()) {
+                    out[i].value = amps.Value().Value();
+                } else {
+                    out[i].error = amps.Error();
+                }
+                break;
+            }
+            case ConfigRead::Kind::kI2c:
+                i2c_samples.push_back(i);
+                break;
+            }
+        }
+        if (i2c_samples.empty()) {
+            return;
+        }
+
+        // Per read: the register byte, then up to 4 data bytes.
+        buffer.resize(i2c_samples.size() * 5);
+        messages.reserve(i2c_samples.size() * 2);
+        for (std::size_t n = 0; n < i2c_samples.size(); ++n) {
+            const auto& read = config_reads[tags[i2c_samples[n]]];
+            core::Byte* slot = &buffer[n * 5];
+            slot[0] = read.reg;
+            messages.push_back({read.addr, slot, 1, false, false});
+            messages.push_back({read.addr, slot + 1, read.length, true, true});
+        }
+        I2c* i2c = config_reads[tags[i2c_samples[0]]].i2c;
+        auto done = i2c->Transfer(messages.data(), messages.size());
+        for (std::size_t n = 0; n < i2c_samples.size(); ++n) {
+            auto& sample = out[i2c_samples[n]];
+            if (done.IsError()) {
+                sample.error = done.Error();
+                continue;
+            }
+            const auto& read = config_reads[tags[i2c_samples[n]]];
+            uint32_t value = 0;
+            for (std::size_t b = 0; b < read.length; ++b) {
+                value = (value << 8) | buffer[n * 5 + 1 + b];
+            }
+            sample.value = value;
+        }
+    }
+
+    SamplerOptions options;
+    core::Executor& executor;
+
+    mutable std::mutex control_mutex;  // registration, Start/Stop
+    std::vector<std::unique_ptr<Signal>> signals;  // fixed while running
+    std::vector<std::unique_ptr<Group>> groups;
+    std::map<std::string, uint32_t> group_index;
+    std::unordered_map<std::string, SignalId> names;
+    std::vector<ConfigRead> config_reads;
+    core::Executor::TimerId timer = 0;  // 0: stopped
+
+    // Timer wheel; Tick() runs are serialized by the executor.
+    std::vector<std::vector<SignalId>> wheel;
+    std::chrono::steady_clock::time_point start;
+    uint64_t last_tick = 0;
+    std::vector<uint32_t> due_groups;
+
+    std::mutex flight_mutex;
+    std::condition_variable idle;
+    std::size_t in_flight = 0;  // group tasks posted and not finished
+};
+
+Sampler::Sampler(SamplerOptions options) : impl_(std::make_unique<Impl>(options)) {}
+
+Sampler::~Sampler() {
+    Stop();
+}
+
+core::Result<SignalId> Sampler::AddSignal(SamplerSignal signal) {
+    std::lock_guard<std::mutex> lock(impl_->control_mutex);
+    return impl_->AddLocked(std::move(signal));
+}
+
+core::Result<void> Sampler::SetBatchReader(const std::string& batch_key,
+                                           SampleBatchReader reader) {
+    std::lock_guard<std::mutex> lock(impl_->control_mutex);
+    if (impl_->timer != 0) {
+        return core::Result<void>::Err(core::ErrorCode::kBusy);
+    }
+    impl_->groups[impl_->GroupLocked(batch_key)]->reader = std::move(reader);
+    return core::Result<void>::Ok();
+}
+
+core::Result<std::size_t> Sampler::AddFromConfig(DeviceManager& manager) {
+    using Kind = Impl::ConfigRead::Kind;
+    struct Pending {
+        SamplerSignal signal;
+        Impl::ConfigRead read;
+    };
+    std::vector<Pending> pending;
+    for (const auto& entry : manager.LoadedEntries()) {
+        auto arg = entry.args.find(config::kSampleArg);
+        if (arg == entry.args.end()) {
+            continue;
+        }
+        for (const auto& item : Split(arg->second, ',')) {
+            auto at = item.rfind('@');
+            if (at == std::string::npos) {
+                return core::Result<std::size_t>::Err(core::ErrorCode::kInvalidArgument);
+            }
+            auto kind = Trim(item.substr(0, at));
+            auto period = ParsePeriod(Trim(item.substr(at + 1)));
+            if (!period || period->count() <= 0) {
+                return core::Result<std::size_t>::Err(core::ErrorCode::kInvalidArgument);
+            }
+
+            Impl::ConfigRead read{};
+            if (kind == "voltage" || kind == "current") {
+                read.kind = kind == "voltage" ? Kind::kVoltage : Kind::kCurrent;
+                read.power = manager.GetInterface<PowerControl>(entry.nickname);
+                if (!read.power) {
+                    return core::Result<std::size_t>::Err(core::ErrorCode::kNotFound);
+                }
+            } else if (kind.compare(0, 4, "i2c:") == 0) {
+                auto fields = Split(kind.substr(4), ':');
+                auto addr = fields.size() >= 2 ? ParseNumber(fields[0], 0x7F) : std::nullopt;
+                auto reg = fields.size() >= 2 ? ParseNumber(fields[1], 0xFF) : std::nullopt;
+                auto length = fields.size() == 3 ? ParseNumber(fields[2], 4)
+                                                 : std::optional<unsigned long>(1);
+                if (fields.size() > 3 || !addr || !reg || !length || *length == 0) {
+                    return core::Result<std::size_t>::Err(core::ErrorCode::kInvalidArgument);
+                }
+                read.kind = Kind::kI2c;
+                read.addr = static_cast<core::Byte>(*addr);
+                read.reg = static_cast<core::Byte>(*reg);
+                read.length = *length;
+                read.i2c = manager.GetInterface<I2c>(entry.nickname);
+                if (!read.i2c) {
+                    return core::Result<std::size_t>::Err(core::ErrorCode::kNotFound);
+                }
+            } else {
+                return core::Result<std::size_t>::Err(core::ErrorCode::kInvalidArgument);
+            }
+
+            SamplerSignal signal;
+            signal.name = entry.nickname + "." + kind;
+            signal.period = *period;
+            signal.batch_key = entry.nickname;
+            pending.push_back({std::move(signal), read});
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(impl_->control_mutex);
+    if (impl_->timer != 0) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kBusy);
+    }
+    for (std::size_t i = 0; i < pending.size(); ++i) {
+        const auto& name = pending[i].signal.name;
+        bool duplicate = impl_->names.count(name) != 0;
+        for (std::size_t j = 0; j < i && !duplicate; ++j) {
+            duplicate = pending[j].signal.name == name;
+        }
+        if (duplicate) {
+            return core::Result<std::size_t>::Err(core::ErrorCode::kInvalidArgument);
+        }
+    }
+    Impl* impl = impl_.get();
+    for (auto& p : pending) {
+        p.signal.tag = static_cast<uint32_t>(impl->config_reads.size());
+        impl->config_reads.push_back(p.read);
+        impl->groups[impl->GroupLocked(p.signal.batch_key)]->reader =
+            [impl](const uint32_t* tags, std::size_t count, Sample* out) {
+                impl->ReadConfigBatch(tags, count, out);
+            };
+        impl->AddLocked(std::move(p.signal));
+    }
+    return core::Result<std::size_t>::Ok(pending.size());
+}
+
+std::optional<SignalId> Sampler::FindSignal(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(impl_->control_mutex);
+    auto it = impl_->names.find(name);
+    if (it == impl_->names.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::string Sampler::GetSignalName(SignalId id) const {
+    std::lock_guard<std::mutex> lock(impl_->control_mutex);
+    if (id >= impl_->signals.size()) {
+        return {};
+    }
+    return impl_->signals[id]->name;
+}
+
+std::size_t Sampler::SignalCount() const {
+    std::lock_guard<std::mutex> lock(impl_->control_mutex);
+    return impl_->signals.size();
+}
+
+core::Result<void> Sampler::Start() {
+    std::lock_guard<std::mutex> lock(impl_->control_mutex);
+    if (impl_->timer != 0) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+    }
+    if (impl_->signals.empty()) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    for (const auto& signal : impl_->signals) {
+        if (!signal->read && !impl_->groups[signal->group]->reader) {
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        }
+    }
+    auto tick = impl_->options.tick;
+    impl_->wheel.assign(impl_->options.wheel_slots, {});
+    for (SignalId id = 0; id < impl_->signals.size(); ++id) {
+        auto& signal = *impl_->signals[id];
+        auto ticks = (signal.period + tick - std::chrono::microseconds(1)) / tick;
+        signal.period_ticks = std::max<uint64_t>(1, static_cast<uint64_t>(ticks));
+        signal.next_tick = 1;
+        impl_->wheel[1 % impl_->wheel.size()].push_back(id);
+    }
+    impl_->start = std::chrono::steady_clock::now();
+    impl_->last_tick = 0;
+    impl_->timer = impl_->executor.PostEvery(tick, [this] { impl_->Tick(); }, tick);
+    return core::Result<void>::Ok();
+}
+
+void Sampler::Stop() {
+    core::Executor::TimerId timer = 0;
+    {
+        std::lock_guard<std::mutex> lock(impl_->control_mutex);
+        timer = impl_->timer;
+    }
+    if (timer == 0) {
+        return;
+    }
+    impl_->executor.Cancel(timer);
+    {
+        std::unique_lock<std::mutex> lock(impl_->flight_mutex);
+        impl_->idle.wait(lock, [this] { return impl_->in_flight == 0; });
+    }
+    std::lock_guard<std::mutex> lock(impl_->control_mutex);
+    impl_->timer = 0;
+}
+
+bool Sampler::IsRunning() const {
+    std::lock_guard<std::mutex> lock(impl_->control_mutex);
+    return impl_->timer != 0;
+}
+
+std::size_t Sampler::Read(SignalId id, Sample* out, std::size_t max) {
+    if (id >= impl_->signals.size()) {
+        return 0;
+    }
+    return impl_->signals[id]->ring.Pop(out, max);
+}
+
+core::Result<SignalStats> Sampler::GetStats(SignalId id) const {
+    if (id >= impl_->signals.size()) {
+        return core::Result<SignalStats>::Err(core::ErrorCode::kOutOfRange);
+    }
+    const auto& signal = *impl_->signals[id];
+    SignalStats stats;
+    stats.samples = signal.samples.load(std::memory_order_relaxed);
+    stats.errors = signal.errors.load(std::memory_order_relaxed);
+    stats.skipped = signal.skipped.load(std::memory_order_relaxed);
+    stats.dropped = signal.ring.Dropped();
+    return core::Result<SignalStats>::Ok(stats);
+}
+
+}  // namespace plas::hal
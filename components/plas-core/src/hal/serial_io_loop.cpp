@@ -0,0 +1,464 @@
+#include "plas/hal/serial_io_loop.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/core/spsc_ring.h"
+
+namespace plas::hal {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kChunk = 4096;          // bytes per read(2)/write(2)
+constexpr uint64_t kWakeTag = ~uint64_t{0};  // epoll tag of the eventfd
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Port — one served fd
+// ---------------------------------------------------------------------------
+struct SerialPort {
+    SerialPort(int fd_in, const SerialPortOptions& options)
+        : fd(fd_in), rx(options.rx_capacity), tx(options.tx_capacity),
+          on_readable(options.on_readable) {}
+
+    int fd;
+    core::SpscRing<core::Byte> rx;  // loop thread -> reader
+    core::SpscRing<core::Byte> tx;  // writer -> loop thread
+
+    std::mutex io_mutex;  // held by the loop while it touches fd/callback
+    bool removed = false;
+
+    std::mutex rx_mutex;  // one reader at a time (single consumer)
+    std::mutex tx_mutex;  // one writer at a time (single producer)
+
+    std::mutex wait_mutex;  // readers/writers/drainers sleep on cv
+    std::condition_variable cv;
+
+    std::mutex cb_mutex;
+    std::function<void()> on_readable;
+
+    // Loop thread only: bytes popped from tx not yet accepted by the fd.
+    std::vector<core::Byte> tx_pending;
+    std::size_t tx_offset = 0;
+    bool out_armed = false;
+
+    std::atomic<uint64_t> tx_queued{0};
+    std::atomic<uint64_t> tx_written{0};
+    std::atomic<bool> hangup{false};
+
+    void Notify() {
+        { std::lock_guard lock(wait_mutex); }
+        cv.notify_all();
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Pimpl definition
+// ---------------------------------------------------------------------------
+struct SerialIoLoop::Impl {
+    mutable std::mutex ports_mutex;
+    std::unordered_map<PortId, std::shared_ptr<SerialPort>> ports;
+    std::vector<PortId> tx_dirty;  // ports with newly queued TX bytes
+    PortId next_id = 1;
+
+    int epoll_fd = -1;
+    int wake_fd = -1;
+    std::thread thread;
+    std::atomic<bool> stop{false};
+
+    std::shared_ptr<SerialPort> Find(PortId id) const {
+        std::lock_guard lock(ports_mutex);
+        auto it = ports.find(id);
+        return it == ports.end() ? nullptr : it->second;
+    }
+
+#ifdef __linux__
+    void Wake() {
+        uint64_t one = 1;
+        ssize_t rc = ::write(wake_fd, &one, sizeof(one));
+        (void)rc;  // counter saturation still leaves the fd readable
+    }
+
+    void SetOut(SerialPort& port, PortId id, bool armed) {
+        if (port.out_armed == armed) {
+            return;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN | (armed ? EPOLLOUT : 0u);
+        ev.data.u64 = id;
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_MOD, port.fd, &ev);
+        port.out_armed = armed;
+    }
+
+    void HangUp(SerialPort& port) {
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, port.fd, nullptr);
+        port.tx_pending.clear();
+        port.hangup.store(true, std::memory_order_release);
+    }
+
+    // Caller holds port.io_mutex.
+    void ReadIn(SerialPort& port) {
+        core::Byte buf[kChunk];
+        std::size_t pushed = 0;
+        for (;;) {
+            ssize_t n = ::read(port.fd, buf, sizeof(buf));
+            if (n > 0) {
+                pushed += port.rx.Push(buf, static_cast<std::size_t>(n));
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                HangUp(port);
+            }
+            break;
+        }
+        if (pushed > 0 || port.hangup.load(std::memory_order_relaxed)) {
+            port.Notify();
+        }
+        if (pushed > 0) {
+            std::lock_guard lock(port.cb_mutex);
+            if (port.on_readable) {
+                port.on_readable();
+            }
+        }
+    }
+
+    // Caller holds port.io_mutex.
+    void WriteOut(SerialPort& port, PortId id) {
+        if (port.hangup.load(std::memory_order_relaxed)) {
+            return;
+        }
+        core::Byte buf[kChunk];
+        bool progressed = false;
+        for (;;) {
+            if (port.tx_offset == port.tx_pending.size()) {
+                std::size_t n = port.tx.Pop(buf, sizeof(buf));
+                if (n == 0) {
+                    break;
+                }
+                port.tx_pending.assign(buf, buf + n);
+                port.tx_offset = 0;
+            }
+            ssize_t w = ::write(port.fd, port.tx_pending.data() + port.tx_offset,
+                                port.tx_pending.size() - port.tx_offset);
+            if (w > 0) {
+                port.tx_offset += static_cast<std::size_t>(w);
+                port.tx_written.fetch_add(static_cast<uint64_t>(w),
+                                          std::memory_order_release);
+                progressed = true;
+                continue;
+            }
+            if (w < 0 && errno == EINTR) {
+                continue;
+            }
+            if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                SetOut(port, id, true);  // resume on EPOLLOUT
+                if (progressed) {
+                    port.Notify();
+                }
+                return;
+            }
+            HangUp(port);
+            port.Notify();
+            return;
+        }
+        SetOut(port, id, false);
+        port.Notify();
+    }
+
+    void Run() {
+        epoll_event events[64];
+        while (!stop.load(std::memory_order_acquire)) {
+            int n = ::epoll_wait(epoll_fd, events, 64, -1);
+            if (n < 0) {
+                continue;  // EINTR
+            }
+            for (int i = 0; i < n; ++i) {
+                if (events[i].data.u64 == kWakeTag) {
+                    uint64_t count = 0;
+                    ssize_t rc = ::read(wake_fd, &count, sizeof(count));
+                    (void)rc;
+                    std::vector<PortId> dirty;
+                    {
+                        std::lock_guard lock(ports_mutex);
+                        dirty.swap(tx_dirty);
+                    }
+                    for (PortId id : dirty) {
+                        if (auto port = Find(id)) {
+                            std::lock_guard io(port->io_mutex);
+                            if (!port->removed) {
+                                WriteOut(*port, id);
+                            }
+                        }
+                    }
+                    continue;
+                }
+                const auto id = static_cast<PortId>(events[i].data.u64);
+                auto port = Find(id);
+                if (!port) {
+                    continue;
+                }
+                std::lock_guard io(port->io_mutex);
+                if (port->removed || port->hangup.load(std::memory_order_relaxed)) {
+                    continue;
+                }
+                if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0) {
+                    ReadIn(*port);
+                }
+                if ((events[i].events & EPOLLOUT) != 0) {
+                    WriteOut(*port, id);
+                }
+            }
+        }
+    }
+#endif
+};
+
+SerialIoLoop::SerialIoLoop() : impl_(std::make_unique<Impl>()) {
+#ifdef __linux__
+    impl_->epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    impl_->wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (impl_->epoll_fd >= 0 && impl_->wake_fd >= 0) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = kWakeTag;
+        ::epoll_ctl(impl_->epoll_fd, EPOLL_CTL_ADD, impl_->wake_fd, &ev);
+    }
+#endif
+}
+
+SerialIoLoop::~SerialIoLoop() {
+#ifdef __linux__
+    if (impl_->thread.joinable()) {
+        impl_->stop.store(true, std::memory_order_release);
+        impl_->Wake();
+        impl_->thread.join();
+    }
+    if (impl_->wake_fd >= 0) {
+        ::close(impl_->wake_fd);
+    }
+    if (impl_->epoll_fd >= 0) {
+        ::close(impl_->epoll_fd);
+    }
+#endif
+}
+
+SerialIoLoop& SerialIoLoop::Shared() {
+    // Never destroyed: devices held by other singletons (DeviceManager) may
+    // still Close() during static destruction.
+    static SerialIoLoop* loop = new SerialIoLoop();
+    return *loop;
+}
+
+core::Result<SerialIoLoop::PortId> SerialIoLoop::AddPort(int fd, SerialPortOptions options) {
+#ifdef __linux__
+    if (fd < 0 || options.rx_capacity == 0 || options.tx_capacity == 0) {
+        return core::Result<PortId>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (impl_->epoll_fd < 0 || impl_->wake_fd < 0) {
+        return core::Result<PortId>::Err(core::ErrorCode::kIOError);
+    }
+    int flags = ::fcntl(fd, F_GETFL);
+    if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        return core::Result<PortId>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    auto port = std::make_shared<SerialPort>(fd, options);
+    std::lock_guard lock(impl_->ports_mutex);
+    const PortId id = impl_->next_id++;
+    impl_->ports.emplace(id, port);
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = id;
+    if (::epoll_ctl(impl_->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        impl_->ports.erase(id);
+        return core::Result<PortId>::Err(core::ErrorCode::kIOError);
+    }
+    if (!impl_->thread.joinable()) {
+        impl_->thread = std::thread([impl = impl_.get()] { impl->Run(); });
+    }
+    return core::Result<PortId>::Ok(id);
+#else
+    (void)fd;
+    (void)options;
+    return core::Result<PortId>::Err(core::ErrorCode::kNotSupported);
+#endif
+}
+
+core::Result<void> SerialIoLoop::RemovePort(PortId id) {
+    std::shared_ptr<SerialPort> port;
+    {
+        std::lock_guard lock(impl_->ports_mutex);
+        auto it = impl_->ports.find(id);
+        if (it == impl_->ports.end()) {
+            return core::Result<void>::Err(core::ErrorCode::kNotFound);
+        }
+        port = std::move(it->second);
+        impl_->ports.erase(it);
+    }
+    {
+        std::lock_guard io(port->io_mutex);  // waits out an in-flight event
+#ifdef __linux__
+        if (!port->hangup.load(std::memory_order_relaxed)) {
+            ::epoll_ctl(impl_->epoll_fd, EPOLL_CTL_DEL, port->fd, nullptr);
+        }
+#endif
+        port->removed = true;
+    }
+    port->Notify();  // release waiting readers/writers
+    return core::Result<void>::Ok();
+}
+
+core::Result<std::size_t> SerialIoLoop::Read(PortId id, core::Byte* data,
+                                             std::size_t length,
+                                             std::chrono::milliseconds timeout) {
+    auto port = impl_->Find(id);
+    if (!port) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kNotFound);
+    }
+    if (data == nullptr && length > 0) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (length == 0) {
+        return core::Result<std::size_t>::Ok(0);
+    }
+
+    std::lock_guard reader(port->rx_mutex);
+    {
+        std::unique_lock lock(port->wait_mutex);
+        port->cv.wait_for(lock, timeout, [&] {
+            return port->rx.Size() > 0 || port->hangup.load(std::memory_order_acquire) ||
+                   port->removed;
+        });
+    }
+    std::size_t n = port->rx.Pop(data, length);
+    if (n > 0) {
+        return core::Result<std::size_t>::Ok(n);
+    }
+    if (port->hangup.load(std::memory_order_acquire)) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kIOError);
+    }
+    return core::Result<std::size_t>::Err(core::ErrorCode::kTimeout);
+}
+
+core::Result<std::size_t> SerialIoLoop::Write(PortId id, const core::Byte* data,
+                                              std::size_t length,
+                                              std::chrono::milliseconds timeout) {
+    auto port = impl_->Find(id);
+    if (!port) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kNotFound);
+    }
+    if (data == nullptr && length > 0) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    std::lock_guard writer(port->tx_mutex);
+    const auto deadline = Clock::now() + timeout;
+    std::size_t total = 0;
+    while (total < length) {
+        if (port->hangup.load(std::memory_order_acquire)) {
+            break;
+        }
+        // Only push what fits: a full TX ring waits, it does not drop.
+        const std::size_t room = port->tx.Capacity() - port->tx.Size();
+        const std::size_t n = port->tx.Push(data + total, std::min(room, length - total));
+        if (n > 0) {
+            total += n;
+            port->tx_queued.fetch_add(n, std::memory_order_release);
+#ifdef __linux__
+            {
+                std::lock_guard lock(impl_->ports_mutex);
+                impl_->tx_dirty.push_back(id);
+            }
+            impl_->Wake();
+#endif
+            continue;
+        }
+        std::unique_lock lock(port->wait_mutex);
+        if (!port->cv.wait_until(lock, deadline, [&] {
+                return port->tx.Size() < port->tx.Capacity() ||
+                       port->hangup.load(std::memory_order_acquire) || port->removed;
+            })) {
+            break;
+        }
+        if (port->removed) {
+            break;
+        }
+    }
+
+    if (total == 0 && length > 0) {
+        return core::Result<std::size_t>::Err(
+            port->hangup.load(std::memory_order_acquire) ? core::ErrorCode::kIOError
+                                                         : core::ErrorCode::kTimeout);
+    }
+    return core::Result<std::size_t>::Ok(total);
+}
+
+core::Result<void> SerialIoLoop::Drain(PortId id, std::chrono::milliseconds timeout) {
+    auto port = impl_->Find(id);
+    if (!port) {
+        return core::Result<void>::Err(core::ErrorCode::kNotFound);
+    }
+    std::unique_lock lock(port->wait_mutex);
+    bool done = port->cv.wait_for(lock, timeout, [&] {
+        return port->tx_written.load(std::memory_order_acquire) ==
+                   port->tx_queued.load(std::memory_order_acquire) ||
+               port->hangup.load(std::memory_order_acquire);
+    });
+    if (port->hangup.load(std::memory_order_acquire)) {
+        return core::Result<void>::Err(core::ErrorCode::kIOError);
+    }
+    if (!done) {
+        return core::Result<void>::Err(core::ErrorCode::kTimeout);
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> SerialIoLoop::SetReadyCallback(PortId id,
+                                                  std::function<void()> callback) {
+    auto port = impl_->Find(id);
+    if (!port) {
+        return core::Result<void>::Err(core::ErrorCode::kNotFound);
+    }
+    std::lock_guard lock(port->cb_mutex);
+    port->on_readable = std::move(callback);
+    return core::Result<void>::Ok();
+}
+
+std::size_t SerialIoLoop::Available(PortId id) const {
+    auto port = impl_->Find(id);
+    return port ? port->rx.Size() : 0;
+}
+
+uint64_t SerialIoLoop::RxDropped(PortId id) const {
+    auto port = impl_->Find(id);
+    return port ? port->rx.Dropped() : 0;
+}
+
+std::size_t SerialIoLoop::PortCount() const {
+    std::lock_guard lock(impl_->ports_mutex);
+    return impl_->ports.size();
+}
+
+}  // namespace plas::hal
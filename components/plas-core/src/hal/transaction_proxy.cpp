@@ -0,0 +1,486 @@
+#include "plas/hal/transaction_proxy.h"
+
+#include <algorithm>
+
+namespace plas::hal {
+
+namespace {
+
+uint64_t PackProtocol(pci::DoeProtocolId protocol) {
+    return protocol.vendor_id | (static_cast<uint64_t>(protocol.data_object_type) << 16);
+}
+
+pci::DoeProtocolId UnpackProtocol(uint64_t packed) {
+    return {static_cast<uint16_t>(packed), static_cast<uint8_t>(packed >> 16)};
+}
+
+core::ErrorCode CodeOf(const std::error_code& error) {
+    if (error.category() == core::PlasErrorCategory::Instance()) {
+        return static_cast<core::ErrorCode>(error.value());
+    }
+    return core::ErrorCode::kUnknown;
+}
+
+template <typename T>
+core::Result<T> Failed(const core::Result<void>& result) {
+    return core::Result<T>::Err(result.Error());
+}
+
+/// Store a call's outcome: `value` on success, the error otherwise.
+template <typename T, typename Fn>
+core::Result<void> Into(const core::Result<T>& result, Fn&& store) {
+    if (result.IsError()) {
+        return core::Result<void>::Err(result.Error());
+    }
+    store(result.Value());
+    return core::Result<void>::Ok();
+}
+
+TraceRecord Call(TraceOp op, uint64_t target, uint64_t offset = 0, uint64_t arg = 0) {
+    TraceRecord call;
+    call.op = op;
+    call.target = target;
+    call.offset = offset;
+    call.arg = arg;
+    return call;
+}
+
+void CopyResponse(const TraceRecord& call, void* out, std::size_t capacity) {
+    if (out != nullptr) {
+        std::copy_n(call.response.begin(), std::min(call.response.size(), capacity),
+                    static_cast<core::Byte*>(out));
+    }
+}
+
+core::Result<void> ExecuteI2c(I2c& i2c, TraceRecord& call) {
+    const auto addr = static_cast<core::Address>(call.target);
+    const auto length = static_cast<std::size_t>(call.length);
+    switch (call.op) {
+        case TraceOp::kI2cRead: {
+            call.response.resize(length);
+            auto r = i2c.Read(addr, call.response.data(), length, call.arg != 0);
+            if (r.IsError()) call.response.clear();
+            return Into(r, [&](std::size_t n) {
+                call.value = n;
+                call.response.resize(std::min(n, length));
+            });
+        }
+        case TraceOp::kI2cWrite: {
+            auto r = i2c.Write(addr, call.request.data(), call.request.size(), call.arg != 0);
+            return Into(r, [&](std::size_t n) { call.value = n; });
+        }
+        case TraceOp::kI2cWriteRead: {
+            call.response.resize(length);
+            auto r = i2c.WriteRead(addr, call.request.data(), call.request.size(),
+                                   call.response.data(), length);
+            if (r.IsError()) call.response.clear();
+            return Into(r, [&](std::size_t n) {
+                call.value = n;
+                call.response.resize(std::min(n, length));
+            });
+        }
+        case TraceOp::kI2cSetBitrate:
+            return i2c.SetBitrate(static_cast<uint32_t>(call.value));
+        default:
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+}
+
+core::Result<void> ExecuteConfig(pci::PciConfig& config, TraceRecord& call) {
+    const auto bdf = pci::Bdf::FromPacked(static_cast<uint16_t>(call.target));
+    const auto offset = static_cast<pci::ConfigOffset>(call.offset);
+    auto store = [&](auto value) { call.value = value; };
+    auto capability = [&](const std::optional<pci::ConfigOffset>& found) {
+        call.value = found ? *found : kTraceNoCapability;
+    };
+    switch (call.op) {
+        case TraceOp::kConfigRead8:
+            return Into(config.ReadConfig8(bdf, offset), store);
+        case TraceOp::kConfigRead16:
+            return Into(config.ReadConfig16(bdf, offset), store);
+        case TraceOp::kConfigRead32:
+            return Into(config.ReadConfig32(bdf, offset), store);
+        case TraceOp::kConfigWrite8:
+            return config.WriteConfig8(bdf, offset, static_cast<core::Byte>(call.value));
+        case TraceOp::kConfigWrite16:
+            return config.WriteConfig16(bdf, offset, static_cast<core::Word>(call.value));
+        case TraceOp::kConfigWrite32:
+            return config.WriteConfig32(bdf, offset, static_cast<core::DWord>(call.value));
+        case TraceOp::kConfigReadBlock: {
+            call.response.resize(static_cast<std::size_t>(call.length));
+            auto r = config.ReadConfigBlock(bdf, offset, call.response.data(),
+                                            call.response.size());
+            if (r.IsError()) call.response.clear();
+            return r;
+        }
+        case TraceOp::kFindCapability:
+            return Into(config.FindCapability(bdf, static_cast<pci::CapabilityId>(call.arg)),
+                        capability);
+        case TraceOp::kFindExtCapability:
+            return Into(
+                config.FindExtCapability(bdf, static_cast<pci::ExtCapabilityId>(call.arg)),
+                capability);
+        default:
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+}
+
+core::Result<void> ExecuteDoe(pci::PciDoe& doe, TraceRecord& call) {
+    const auto bdf = pci::Bdf::FromPacked(static_cast<uint16_t>(call.target));
+    const auto offset = static_cast<pci::ConfigOffset>(call.offset);
+    if (call.op == TraceOp::kDoeDiscover) {
+        return Into(doe.DoeDiscover(bdf, offset),
+                    [&](const std::vector<pci::DoeProtocolId>& protocols) {
+                        std::vector<core::DWord> packed;
+                        for (const auto& protocol : protocols) {
+                            packed.push_back(static_cast<core::DWord>(PackProtocol(protocol)));
+                        }
+                        call.response = EncodeTraceDWords(packed.data(), packed.size());
+                    });
+    }
+    return Into(doe.DoeExchange(bdf, offset, UnpackProtocol(call.arg),
+                                DecodeTraceDWords(call.request)),
+                [&](const pci::DoePayload& payload) {
+                    call.response = EncodeTraceDWords(payload.data(), payload.size());
+                });
+}
+
+core::Result<void> ExecuteBar(pci::PciBar& bar, TraceRecord& call) {
+    const auto bdf = pci::Bdf::FromPacked(static_cast<uint16_t>(call.target));
+    const auto index = static_cast<uint8_t>(call.arg);
+    auto store = [&](auto value) { call.value = value; };
+    switch (call.op) {
+        case TraceOp::kBarRead32:
+            return Into(bar.BarRead32(bdf, index, call.offset), store);
+        case TraceOp::kBarRead64:
+            return Into(bar.BarRead64(bdf, index, call.offset), store);
+        case TraceOp::kBarWrite32:
+            return bar.BarWrite32(bdf, index, call.offset, static_cast<core::DWord>(call.value));
+        case TraceOp::kBarWrite64:
+            return bar.BarWrite64(bdf, index, call.offset, call.value);
+        case TraceOp::kBarReadBuffer: {
+            call.response.resize(static_cast<std::size_t>(call.length));
+            auto r = bar.BarReadBuffer(bdf, index, call.offset, call.response.data(),
+                                       call.response.size());
+            if (r.IsError()) call.response.clear();
+            return r;
+        }
+        case TraceOp::kBarWriteBuffer:
+            return bar.BarWriteBuffer(bdf, index, call.offset, call.request.data(),
+                                      call.request.size());
+        default:
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// TransactionPort
+// ---------------------------------------------------------------------------
+
+core::Result<void> TransactionPort::ExecuteBatch(TraceRecord* calls, std::size_t count) {
+    bool failed = false;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (failed) {
+            calls[i].error = core::ErrorCode::kCancelled;
+            continue;
+        }
+        auto result = Execute(calls[i]);
+        calls[i].error = result.IsError() ? CodeOf(result.Error()) : core::ErrorCode::kSuccess;
+        failed = result.IsError();
+    }
+    return core::Result<void>::Ok();
+}
+
+// ---------------------------------------------------------------------------
+// Device side
+// ---------------------------------------------------------------------------
+
+uint32_t TransactionInterfaces(Device& device) {
+    uint32_t bits = 0;
+    auto add = [&](bool has, InterfaceKind kind) {
+        if (has) bits |= 1u << static_cast<uint32_t>(kind);
+    };
+    add(InterfaceCast<I2c>(&device) != nullptr, InterfaceKind::kI2c);
+    add(InterfaceCast<pci::PciConfig>(&device) != nullptr, InterfaceKind::kPciConfig);
+    add(InterfaceCast<pci::PciDoe>(&device) != nullptr, InterfaceKind::kPciDoe);
+    add(InterfaceCast<pci::PciBar>(&device) != nullptr, InterfaceKind::kPciBar);
+    return bits;
+}
+
+core::Result<void> ExecuteTransaction(Device& device, TraceRecord& call) {
+    call.value = 0;
+    call.response.clear();
+    switch (call.op) {
+        case TraceOp::kI2cRead:
+        case TraceOp::kI2cWrite:
+        case TraceOp::kI2cWriteRead:
+        case TraceOp::kI2cSetBitrate:
+            if (auto* i2c = InterfaceCast<I2c>(&device)) return ExecuteI2c(*i2c, call);
+            break;
+        case TraceOp::kConfigRead8:
+        case TraceOp::kConfigRead16:
+        case TraceOp::kConfigRead32:
+        case TraceOp::kConfigWrite8:
+        case TraceOp::kConfigWrite16:
+        case TraceOp::kConfigWrite32:
+        case TraceOp::kConfigReadBlock:
+        case TraceOp::kFindCapability:
+        case TraceOp::kFindExtCapability:
+            if (auto* config = InterfaceCast<pci::PciConfig>(&device)) {
+                return ExecuteConfig(*config, call);
+            }
+            break;
+        case TraceOp::kDoeDiscover:
+        case TraceOp::kDoeExchange:
+            if (auto* doe = InterfaceCast<pci::PciDoe>(&device)) return ExecuteDoe(*doe, call);
+            break;
+        case TraceOp::kBarRead32:
+        case TraceOp::kBarRead64:
+        case TraceOp::kBarWrite32:
+        case TraceOp::kBarWrite64:
+        case TraceOp::kBarReadBuffer:
+        case TraceOp::kBarWriteBuffer:
+            if (auto* bar = InterfaceCast<pci::PciBar>(&device)) return ExecuteBar(*bar, call);
+            break;
+        case TraceOp::kCount:
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+}
+
+namespace detail {
+
+// ---------------------------------------------------------------------------
+// ProxyI2c
+// ---------------------------------------------------------------------------
+
+core::Result<size_t> ProxyI2c::Read(core::Address addr, core::Byte* data, size_t length,
+                                    bool stop) {
+    auto call = Call(TraceOp::kI2cRead, addr, 0, stop);
+    call.length = length;
+    auto r = port_.Execute(call);
+    if (r.IsError()) return Failed<size_t>(r);
+    CopyResponse(call, data, length);
+    return core::Result<size_t>::Ok(static_cast<size_t>(call.value));
+}
+
+core::Result<size_t> ProxyI2c::Write(core::Address addr, const core::Byte* data,
+                                     size_t length, bool stop) {
+    auto call = Call(TraceOp::kI2cWrite, addr, 0, stop);
+    if (data != nullptr) call.request.assign(data, data + length);
+    auto r = port_.Execute(call);
+    if (r.IsError()) return Failed<size_t>(r);
+    return core::Result<size_t>::Ok(static_cast<size_t>(call.value));
+}
+
+core::Result<size_t> ProxyI2c::WriteRead(core::Address addr, const core::Byte* write_data,
+                                         size_t write_len, core::Byte* read_data,
+                                         size_t read_len) {
+    auto call = Call(TraceOp::kI2cWriteRead, addr);
+    call.length = read_len;
+    if (write_data != nullptr) call.request.assign(write_data, write_data + write_len);
+    auto r = port_.Execute(call);
+    if (r.IsError()) return Failed<size_t>(r);
+    CopyResponse(call, read_data, read_len);
+    return core::Result<size_t>::Ok(static_cast<size_t>(call.value));
+}
+
+core::Result<size_t> ProxyI2c::Transfer(I2cMessage* msgs, size_t count) {
+    if (msgs == nullptr && count > 0) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::vector<TraceRecord> calls(count);
+    for (size_t i = 0; i < count; ++i) {
+        const auto& msg = msgs[i];
+        bool stop = msg.stop || i + 1 == count;
+        calls[i] = Call(msg.read ? TraceOp::kI2cRead : TraceOp::kI2cWrite, msg.addr, 0, stop);
+        if (msg.read) {
+            calls[i].length = msg.length;
+        } else if (msg.data != nullptr) {
+            calls[i].request.assign(msg.data, msg.data + msg.length);
+        }
+    }
+    auto r = port_.ExecuteBatch(calls.data(), count);
+    if (r.IsError()) return Failed<size_t>(r);
+    for (size_t i = 0; i < count; ++i) {
+        if (calls[i].error != core::ErrorCode::kSuccess) {
+            return core::Result<size_t>::Err(calls[i].error);
+        }
+        msgs[i].transferred = static_cast<size_t>(calls[i].value);
+        if (msgs[i].read) CopyResponse(calls[i], msgs[i].data, msgs[i].length);
+    }
+    return core::Result<size_t>::Ok(count);
+}
+
+core::Result<void> ProxyI2c::SetBitrate(uint32_t bitrate) {
+    auto call = Call(TraceOp::kI2cSetBitrate, 0);
+    call.value = bitrate;
+    auto r = port_.Execute(call);
+    if (r.IsOk()) bitrate_ = bitrate;
+    return r;
+}
+
+uint32_t ProxyI2c::GetBitrate() const {
+    return bitrate_;
+}
+
+// ---------------------------------------------------------------------------
+// ProxyPciConfig
+// ---------------------------------------------------------------------------
+
+namespace {
+
+template <typename T>
+core::Result<T> ReadValue(TransactionPort& port, TraceRecord call) {
+    auto r = port.Execute(call);
+    if (r.IsError()) return Failed<T>(r);
+    return core::Result<T>::Ok(static_cast<T>(call.value));
+}
+
+core::Result<void> WriteValue(TransactionPort& port, TraceRecord call, uint64_t value) {
+    call.value = value;
+    return port.Execute(call);
+}
+
+core::Result<std::optional<pci::ConfigOffset>> FindValue(TransactionPort& port,
+                                                          TraceRecord call) {
+    using R = core::Result<std::optional<pci::ConfigOffset>>;
+    auto r = port.Execute(call);
+    if (r.IsError()) return Failed<std::optional<pci::ConfigOffset>>(r);
+    if (call.value == kTraceNoCapability) return R::Ok(std::nullopt);
+    return R::Ok(static_cast<pci::ConfigOffset>(call.value));
+}
+
+}  // namespace
+
+core::Result<core::Byte> ProxyPciConfig::ReadConfig8(pci::Bdf bdf, pci::ConfigOffset offset) {
+    return ReadValue<core::Byte>(port_, Call(TraceOp::kConfigRead8, bdf.Pack(), offset));
+}
+
+core::Result<core::Word> ProxyPciConfig::ReadConfig16(pci::Bdf bdf, pci::ConfigOffset offset) {
+    return ReadValue<core::Word>(port_, Call(TraceOp::kConfigRead16, bdf.Pack(), offset));
+}
+
+core::Result<core::DWord> ProxyPciConfig::ReadConfig32(pci::Bdf bdf,
+                                                       pci::ConfigOffset offset) {
+    return ReadValue<core::DWord>(port_, Call(TraceOp::kConfigRead32, bdf.Pack(), offset));
+}
+
+core::Result<void> ProxyPciConfig::WriteConfig8(pci::Bdf bdf, pci::ConfigOffset offset,
+                                                core::Byte value) {
+    return WriteValue(port_, Call(TraceOp::kConfigWrite8, bdf.Pack(), offset), value);
+}
+
+core::Result<void> ProxyPciConfig::WriteConfig16(pci::Bdf bdf, pci::ConfigOffset offset,
+                                                 core::Word value) {
+    return WriteValue(port_, Call(TraceOp::kConfigWrite16, bdf.Pack(), offset), value);
+}
+
+core::Result<void> ProxyPciConfig::WriteConfig32(pci::Bdf bdf, pci::ConfigOffset offset,
+                                                 core::DWord value) {
+    return WriteValue(port_, Call(TraceOp::kConfigWrite32, bdf.Pack(), offset), value);
+}
+
+core::Result<std::optional<pci::ConfigOffset>> ProxyPciConfig::FindCapability(
+    pci::Bdf bdf, pci::CapabilityId id) {
+    return FindValue(port_,
+                     Call(TraceOp::kFindCapability, bdf.Pack(), 0, static_cast<uint64_t>(id)));
+}
+
+core::Result<std::optional<pci::ConfigOffset>> ProxyPciConfig::FindExtCapability(
+    pci::Bdf bdf, pci::ExtCapabilityId id) {
+    return FindValue(
+        port_, Call(TraceOp::kFindExtCapability, bdf.Pack(), 0, static_cast<uint64_t>(id)));
+}
+
+core::Result<void> ProxyPciConfig::ReadConfigBlock(pci::Bdf bdf, pci::ConfigOffset offset,
+                                                   core::Byte* buffer, std::size_t length) {
+    auto call = Call(TraceOp::kConfigReadBlock, bdf.Pack(), offset);
+    call.length = length;
+    auto r = port_.Execute(call);
+    if (r.IsOk()) CopyResponse(call, buffer, length);
+    return r;
+}
+
+// ---------------------------------------------------------------------------
+// ProxyPciDoe
+// ---------------------------------------------------------------------------
+
+core::Result<std::vector<pci::DoeProtocolId>> ProxyPciDoe::DoeDiscover(
+    pci::Bdf bdf, pci::ConfigOffset doe_offset) {
+    using R = core::Result<std::vector<pci::DoeProtocolId>>;
+    auto call = Call(TraceOp::kDoeDiscover, bdf.Pack(), doe_offset);
+    auto r = port_.Execute(call);
+    if (r.IsError()) return Failed<std::vector<pci::DoeProtocolId>>(r);
+    std::vector<pci::DoeProtocolId> protocols;
+    for (core::DWord packed : DecodeTraceDWords(call.response)) {
+        protocols.push_back(UnpackProtocol(packed));
+    }
+    return R::Ok(std::move(protocols));
+}
+
+core::Result<pci::DoePayload> ProxyPciDoe::DoeExchange(pci::Bdf bdf,
+                                                       pci::ConfigOffset doe_offset,
+                                                       pci::DoeProtocolId protocol,
+                                                       const pci::DoePayload& request) {
+    auto call = Call(TraceOp::kDoeExchange, bdf.Pack(), doe_offset, PackProtocol(protocol));
+    call.request = EncodeTraceDWords(request.data(), request.size());
+    auto r = port_.Execute(call);
+    if (r.IsError()) return Failed<pci::DoePayload>(r);
+    return core::Result<pci::DoePayload>::Ok(DecodeTraceDWords(call.response));
+}
+
+// ---------------------------------------------------------------------------
+// ProxyPciBar
+// ---------------------------------------------------------------------------
+
+core::Result<core::DWord> ProxyPciBar::BarRead32(pci::Bdf bdf, uint8_t bar_index,
+                                                 uint64_t offset) {
+    return ReadValue<core::DWord>(port_,
+                                  Call(TraceOp::kBarRead32, bdf.Pack(), offset, bar_index));
+}
+
+core::Result<core::QWord> ProxyPciBar::BarRead64(pci::Bdf bdf, uint8_t bar_index,
+                                                 uint64_t offset) {
+    return ReadValue<core::QWord>(port_,
+                                  Call(TraceOp::kBarRead64, bdf.Pack(), offset, bar_index));
+}
+
+core::Result<void> ProxyPciBar::BarWrite32(pci::Bdf bdf, uint8_t bar_index, uint64_t offset,
+                                           core::DWord value) {
+    return WriteValue(port_, Call(TraceOp::kBarWrite32, bdf.Pack(), offset, bar_index),
+                      value);
+}
+
+core::Result<void> ProxyPciBar::BarWrite64(pci::Bdf bdf, uint8_t bar_index, uint64_t offset,
+                                           core::QWord value) {
+    return WriteValue(port_, Call(TraceOp::kBarWrite64, bdf.Pack(), offset, bar_index),
+                      value);
+}
+
+core::Result<void> ProxyPciBar::BarReadBuffer(pci::Bdf bdf, uint8_t bar_index,
+                                              uint64_t offset, void* buffer,
+                                              std::size_t length) {
+    auto call = Call(TraceOp::kBarReadBuffer, bdf.Pack(), offset, bar_index);
+    call.length = length;
+    auto r = port_.Execute(call);
+    if (r.IsOk()) CopyResponse(call, buffer, length);
+    return r;
+}
+
+core::Result<void> ProxyPciBar::BarWriteBuffer(pci::Bdf bdf, uint8_t bar_index,
+                                               uint64_t offset, const void* buffer,
+                                               std::size_t length) {
+    auto call = Call(TraceOp::kBarWriteBuffer, bdf.Pack(), offset, bar_index);
+    if (buffer != nullptr) {
+        const auto* bytes = static_cast<const core::Byte*>(buffer);
+        call.request.assign(bytes, bytes + length);
+    }
+    return port_.Execute(call);
+}
+
+}  // namespace detail
+
+}  // namespace plas::hal
@@ -0,0 +1,305 @@
+#include "plas/hal/transaction_trace.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace plas::hal {
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'L', 'A', 'S', 'T', 'R', 'C', '\0'};
+constexpr uint8_t kDeviceTag = 'D';
+constexpr uint8_t kRecordTag = 'R';
+constexpr std::size_t kFlushThreshold = 64 * 1024;
+
+void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void PutBytes(std::vector<uint8_t>& out, const uint8_t* data, std::size_t size) {
+    PutVarint(out, size);
+    out.insert(out.end(), data, data + size);
+}
+
+void PutString(std::vector<uint8_t>& out, const std::string& text) {
+    PutBytes(out, reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+uint64_t ZigZag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t UnZigZag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/// Bounds-checked cursor over the file contents.
+class Decoder {
+public:
+    Decoder(const uint8_t* data, std::size_t size) : pos_(data), end_(data + size) {}
+
+    bool Byte(uint8_t& out) {
+        if (pos_ == end_) return false;
+        out = *pos_++;
+        return true;
+    }
+
+    bool Varint(uint64_t& out) {
+        out = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            uint8_t b = 0;
+            if (!Byte(b)) return false;
+            out |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+    bool Bytes(std::vector<uint8_t>& out) {
+        uint64_t size = 0;
+        if (!Varint(size) || size > static_cast<uint64_t>(end_ - pos_)) return false;
+        out.assign(pos_, pos_ + size);
+        pos_ += size;
+        return true;
+    }
+
+    bool String(std::string& out) {
+        uint64_t size = 0;
+        if (!Varint(size) || size > static_cast<uint64_t>(end_ - pos_)) return false;
+        out.assign(reinterpret_cast<const char*>(pos_), static_cast<std::size_t>(size));
+        pos_ += size;
+        return true;
+    }
+
+private:
+    const uint8_t* pos_;
+    const uint8_t* end_;
+};
+
+}  // namespace
+
+const char* ToString(TraceOp op) {
+    switch (op) {
+        case TraceOp::kI2cRead:           return "i2c-read";
+        case TraceOp::kI2cWrite:          return "i2c-write";
+        case TraceOp::kI2cWriteRead:      return "i2c-write-read";
+        case TraceOp::kConfigRead8:       return "config-read8";
+        case TraceOp::kConfigRead16:      return "config-read16";
+        case TraceOp::kConfigRead32:      return "config-read32";
+        case TraceOp::kConfigWrite8:      return "config-write8";
+        case TraceOp::kConfigWrite16:     return "config-write16";
+        case TraceOp::kConfigWrite32:     return "config-write32";
+        case TraceOp::kConfigReadBlock:   return "config-read-block";
+        case TraceOp::kFindCapability:    return "find-capability";
+        case TraceOp::kFindExtCapability: return "find-ext-capability";
+        case TraceOp::kDoeDiscover:       return "doe-discover";
+        case TraceOp::kDoeExchange:       return "doe-exchange";
+        case TraceOp::kBarRead32:         return "bar-read32";
+        case TraceOp::kBarRead64:         return "bar-read64";
+        case TraceOp::kBarWrite32:        return "bar-write32";
+        case TraceOp::kBarWrite64:        return "bar-write64";
+        case TraceOp::kBarReadBuffer:     return "bar-read-buffer";
+        case TraceOp::kBarWriteBuffer:    return "bar-write-buffer";
+        case TraceOp::kI2cSetBitrate:     return "i2c-set-bitrate";
+        case TraceOp::kCount:             break;
+    }
+    return "unknown";
+}
+
+std::vector<core::Byte> EncodeTraceDWords(const core::DWord* data, std::size_t count) {
+    std::vector<core::Byte> bytes;
+    bytes.reserve(count * 4);
+    for (std::size_t i = 0; i < count; ++i) {
+        for (int b = 0; b < 4; ++b) {
+            bytes.push_back(static_cast<core::Byte>(data[i] >> (8 * b)));
+        }
+    }
+    return bytes;
+}
+
+std::vector<core::DWord> DecodeTraceDWords(const std::vector<core::Byte>& bytes) {
+    std::vector<core::DWord> dwords(bytes.size() / 4);
+    for (std::size_t i = 0; i < dwords.size(); ++i) {
+        for (std::size_t b = 0; b < 4; ++b) {
+            dwords[i] |= static_cast<core::DWord>(bytes[i * 4 + b]) << (8 * b);
+        }
+    }
+    return dwords;
+}
+
+// ---------------------------------------------------------------------------
+// TraceWriter
+// ---------------------------------------------------------------------------
+
+core::Result<std::shared_ptr<TraceWriter>> TraceWriter::Open(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return core::Result<std::shared_ptr<TraceWriter>>::Err(core::ErrorCode::kIOError);
+    }
+    return core::Result<std::shared_ptr<TraceWriter>>::Ok(
+        std::shared_ptr<TraceWriter>(new TraceWriter(file)));
+}
+
+TraceWriter::TraceWriter(std::FILE* file)
+    : file_(file), epoch_(std::chrono::steady_clock::now()) {
+    buffer_.reserve(kFlushThreshold * 2);
+    buffer_.insert(buffer_.end(), std::begin(kMagic), std::end(kMagic));
+    PutVarint(buffer_, kFormatVersion);
+}
+
+TraceWriter::~TraceWriter() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FlushLocked();
+    std::fclose(file_);
+}
+
+uint32_t TraceWriter::AddDevice(const TraceDevice& device) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t index = device_count_++;
+    buffer_.push_back(kDeviceTag);
+    PutVarint(buffer_, index);
+    PutString(buffer_, device.name);
+    PutString(buffer_, device.uri);
+    PutString(buffer_, device.driver);
+    PutVarint(buffer_, device.interfaces);
+    return index;
+}
+
+void TraceWriter::Write(const TraceRecord& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer_.push_back(kRecordTag);
+    PutVarint(buffer_, record.device);
+    buffer_.push_back(static_cast<uint8_t>(record.op));
+    PutVarint(buffer_, static_cast<uint64_t>(record.error));
+    // Records are written as calls complete, so start times from concurrent
+    // callers can go backwards.
+    PutVarint(buffer_, ZigZag(static_cast<int64_t>(record.start_ns - last_start_ns_)));
+    last_start_ns_ = record.start_ns;
+    PutVarint(buffer_, record.duration_ns);
+    PutVarint(buffer_, record.target);
+    PutVarint(buffer_, record.offset);
+    PutVarint(buffer_, record.arg);
+    PutVarint(buffer_, record.length);
+    PutVarint(buffer_, record.value);
+    PutBytes(buffer_, record.request.data(), record.request.size());
+    PutBytes(buffer_, record.response.data(), record.response.size());
+    ++record_count_;
+    if (buffer_.size() >= kFlushThreshold) {
+        FlushLocked();
+    }
+}
+
+uint64_t TraceWriter::Now() const {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now() - epoch_)
+                                     .count());
+}
+
+core::Result<void> TraceWriter::Flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FlushLocked();
+    if (!failed_ && std::fflush(file_) != 0) {
+        failed_ = true;
+    }
+    return failed_ ? core::Result<void>::Err(core::ErrorCode::kIOError)
+                   : core::Result<void>::Ok();
+}
+
+uint64_t TraceWriter::RecordCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return record_count_;
+}
+
+void TraceWriter::FlushLocked() {
+    if (!failed_ && !buffer_.empty() &&
+        std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) {
+        failed_ = true;
+    }
+    buffer_.clear();
+}
+
+// ---------------------------------------------------------------------------
+// TraceFile
+// ---------------------------------------------------------------------------
+
+core::Result<TraceFile> TraceFile::Load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return core::Result<TraceFile>::Err(core::ErrorCode::kNotFound);
+    }
+    std::vector<uint8_t> bytes{std::istreambuf_iterator<char>(file),
+                               std::istreambuf_iterator<char>()};
+    if (bytes.size() < sizeof(kMagic) ||
+        std::memcmp(bytes.data(), kMagic, sizeof(kMagic)) != 0) {
+        return core::Result<TraceFile>::Err(core::ErrorCode::kDataLoss);
+    }
+    Decoder in(bytes.data() + sizeof(kMagic), bytes.size() - sizeof(kMagic));
+    uint64_t version = 0;
+    if (!in.Varint(version) || version != TraceWriter::kFormatVersion) {
+        return core::Result<TraceFile>::Err(core::ErrorCode::kDataLoss);
+    }
+
+    TraceFile trace;
+    uint64_t start_ns = 0;
+    uint8_t tag = 0;
+    while (in.Byte(tag)) {
+        if (tag == kDeviceTag) {
+            TraceDevice device;
+            uint64_t index = 0;
+            uint64_t interfaces = 0;
+            if (!in.Varint(index) || !in.String(device.name) || !in.String(device.uri) ||
+                !in.String(device.driver) || !in.Varint(interfaces)) {
+                break;  // truncated tail
+            }
+            if (index != trace.devices.size()) {
+                return core::Result<TraceFile>::Err(core::ErrorCode::kDataLoss);
+            }
+            device.interfaces = static_cast<uint32_t>(interfaces);
+            trace.devices.push_back(std::move(device));
+        } else if (tag == kRecordTag) {
+            TraceRecord record;
+            uint64_t device = 0;
+            uint8_t op = 0;
+            uint64_t error = 0;
+            uint64_t delta = 0;
+            if (!in.Varint(device) || !in.Byte(op) || !in.Varint(error) ||
+                !in.Varint(delta) || !in.Varint(record.duration_ns) ||
+                !in.Varint(record.target) || !in.Varint(record.offset) ||
+                !in.Varint(record.arg) || !in.Varint(record.length) ||
+                !in.Varint(record.value) || !in.Bytes(record.request) ||
+                !in.Bytes(record.response)) {
+                break;
+            }
+            if (device >= trace.devices.size() ||
+                op >= static_cast<uint8_t>(TraceOp::kCount) ||
+                error > static_cast<uint64_t>(core::ErrorCode::kUnknown)) {
+                return core::Result<TraceFile>::Err(core::ErrorCode::kDataLoss);
+            }
+            start_ns += static_cast<uint64_t>(UnZigZag(delta));
+            record.device = static_cast<uint32_t>(device);
+            record.op = static_cast<TraceOp>(op);
+            record.error = static_cast<core::ErrorCode>(error);
+            record.start_ns = start_ns;
+            trace.records.push_back(std::move(record));
+        } else {
+            return core::Result<TraceFile>::Err(core::ErrorCode::kDataLoss);
+        }
+    }
+    return core::Result<TraceFile>::Ok(std::move(trace));
+}
+
+int TraceFile::FindDevice(const std::string& name) const {
+    for (std::size_t i = 0; i < devices.size(); ++i) {
+        if (devices[i].name == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+}  // namespace plas::hal
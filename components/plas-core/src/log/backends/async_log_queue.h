@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace plas::log {
+
+/// Bounded lock-free queue (Vyukov's array-based MPMC design).
+///
+/// Producers never take a lock. The consumer side is also safe for more
+/// than one thread, which the drop-oldest policy relies on: a producer that
+/// finds the queue full pops the oldest entry itself.
+template <typename T>
+class AsyncLogQueue {
+public:
+    /// `capacity` is rounded up to a power of two (minimum 2).
+    explicit AsyncLogQueue(std::size_t capacity)
+        : mask_(RoundUpPow2(capacity) - 1),
+          cells_(std::make_unique<Cell[]>(mask_ + 1)) {
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    AsyncLogQueue(const AsyncLogQueue&) = delete;
+    AsyncLogQueue& operator=(const AsyncLogQueue&) = delete;
+
+    std::size_t Capacity() const { return mask_ + 1; }
+
+    /// Returns false (leaving `value` untouched) if the queue is full.
+    bool TryPush(T& value) {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) -
+                        static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Returns false if the queue is empty.
+    bool TryPop(T& out) {
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) -
+                        static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+                    out = std::move(cell.value);
+                    cell.sequence.store(pos + mask_ + 1,
+                                        std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence{0};
+        T value{};
+    };
+
+    static std::size_t RoundUpPow2(std::size_t n) {
+        std::size_t p = 2;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+    const std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+};
+
+}  // namespace plas::log
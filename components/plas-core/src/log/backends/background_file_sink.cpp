@@ -0,0 +1,215 @@
+#include "background_file_sink.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <utility>
+
+#include <spdlog/details/os.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+
+namespace plas::log {
+
+namespace {
+
+constexpr auto kWriteInterval = std::chrono::milliseconds(100);
+constexpr std::size_t kMaxBuffersBehind = 4;
+
+std::string RotatedName(const std::string& base, std::size_t index) {
+    return spdlog::sinks::rotating_file_sink_mt::calc_filename(base, index);
+}
+
+int OpenLogFile(const std::string& path, int extra_flags) {
+    return ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | extra_flags,
+                  0644);
+}
+
+}  // namespace
+
+BackgroundFileSink::BackgroundFileSink(std::string base_path, std::size_t max_file_size,
+                                       std::size_t max_files, std::size_t buffer_size)
+    : base_path_(std::move(base_path)),
+      next_path_(base_path_ + ".next"),
+      max_file_size_(std::max<std::size_t>(max_file_size, 1)),
+      max_files_(max_files),
+      buffer_size_(std::max<std::size_t>(buffer_size, 4096)) {
+    spdlog::details::os::create_dir(spdlog::details::os::dir_name(base_path_));
+    fd_ = OpenLogFile(base_path_, 0);
+    if (fd_ < 0) {
+        spdlog::throw_spdlog_ex("Failed opening file " + base_path_ + " for writing", errno);
+    }
+    struct stat st {};
+    if (::fstat(fd_, &st) == 0) {
+        file_size_ = static_cast<std::size_t>(st.st_size);
+    }
+    PrepareNext();
+
+    pending_.reserve(buffer_size_);
+    writer_ = std::thread(&BackgroundFileSink::WriterLoop, this);
+}
+
+BackgroundFileSink::~BackgroundFileSink() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_one();
+    space_cv_.notify_all();
+    writer_.join();
+
+    // Give back the preallocated space; nothing else will use it.
+    if (fd_ >= 0) {
+        (void)::ftruncate(fd_, static_cast<off_t>(file_size_));
+        ::close(fd_);
+    }
+    if (next_fd_ >= 0) {
+        ::close(next_fd_);
+        ::unlink(next_path_.c_str());
+    }
+}
+
+void BackgroundFileSink::sink_it_(const spdlog::details::log_msg& msg) {
+    spdlog::memory_buf_t formatted;
+    formatter_->format(msg, formatted);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    space_cv_.wait(lock, [this] {
+        return stopping_ || pending_.size() < kMaxBuffersBehind * buffer_size_;
+    });
+    pending_.append(formatted.data(), formatted.size());
+    queued_ += formatted.size();
+    // Warnings go out right away, as flush_on(warn) does for the other
+    // sinks, but without the caller waiting for the write.
+    if (msg.level >= spdlog::level::warn || pending_.size() >= buffer_size_) {
+        write_now_ = true;
+        work_cv_.notify_one();
+    }
+}
+
+void BackgroundFileSink::flush_() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const uint64_t target = queued_;
+    if (written_ >= target) {
+        return;
+    }
+    write_now_ = true;
+    work_cv_.notify_one();
+    done_cv_.wait(lock, [this, target] { return written_ >= target; });
+}
+
+// ---------------------------------------------------------------------------
+// Writer thread
+// ---------------------------------------------------------------------------
+
+void BackgroundFileSink::WriterLoop() {
+    std::string batch;
+    batch.reserve(buffer_size_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        work_cv_.wait_for(lock, kWriteInterval, [this] { return stopping_ || write_now_; });
+        write_now_ = false;
+        if (pending_.empty()) {
+            if (stopping_) {
+                break;
+            }
+            continue;
+        }
+        // Swap rather than copy: both buffers keep their capacity.
+        batch.swap(pending_);
+        space_cv_.notify_all();
+        lock.unlock();
+        WriteOut(batch);
+        lock.lock();
+        // Counted even if the write failed, so flush() cannot hang.
+        written_ += batch.size();
+        batch.clear();
+        done_cv_.notify_all();
+    }
+}
+
+void BackgroundFileSink::WriteOut(const std::string& data) {
+    std::size_t pos = 0;
+    while (pos < data.size()) {
+        // Longest run of whole lines that still fits in the current file.
+        const std::size_t room = file_size_ < max_file_size_ ? max_file_size_ - file_size_ : 0;
+        std::size_t end = data.size();
+        if (end - pos > room) {
+            auto nl = room == 0 ? std::string::npos : data.rfind('\n', pos + room - 1);
+            end = (nl == std::string::npos || nl < pos) ? pos : nl + 1;
+        }
+        if (end == pos) {
+            if (file_size_ > 0) {
+                Rotate();
+                continue;
+            }
+            // A line longer than max_file_size gets a file of its own.
+            auto nl = data.find('\n', pos);
+            end = nl == std::string::npos ? data.size() : nl + 1;
+        }
+        WriteAll(data.data() + pos, end - pos);
+        pos = end;
+    }
+}
+
+void BackgroundFileSink::WriteAll(const char* data, std::size_t size) {
+    if (fd_ < 0) {
+        return;
+    }
+    while (size > 0) {
+        auto n = ::write(fd_, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;  // dropped, as spdlog's default error handler would
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+        file_size_ += static_cast<std::size_t>(n);
+    }
+}
+
+void BackgroundFileSink::Rotate() {
+    if (next_fd_ < 0) {
+        PrepareNext();
+    }
+    if (fd_ >= 0) {
+        (void)::ftruncate(fd_, static_cast<off_t>(file_size_));
+        ::close(fd_);
+    }
+    for (std::size_t i = max_files_; i > 0; --i) {
+        auto src = RotatedName(base_path_, i - 1);
+        if (spdlog::details::os::path_exists(src)) {
+            (void)::rename(src.c_str(), RotatedName(base_path_, i).c_str());
+        }
+    }
+    if (next_fd_ >= 0 && ::rename(next_path_.c_str(), base_path_.c_str()) == 0) {
+        fd_ = next_fd_;
+    } else {
+        if (next_fd_ >= 0) {
+            ::close(next_fd_);
+        }
+        fd_ = OpenLogFile(base_path_, O_TRUNC);
+    }
+    next_fd_ = -1;
+    file_size_ = 0;
+    PrepareNext();
+}
+
+void BackgroundFileSink::PrepareNext() {
+    next_fd_ = OpenLogFile(next_path_, O_TRUNC);
+#ifdef __linux__
+    // Reserve the blocks without changing the size, so readers of base.log
+    // never see preallocated zeros. Best effort: not every filesystem can.
+    if (next_fd_ >= 0) {
+        (void)::fallocate(next_fd_, FALLOC_FL_KEEP_SIZE, 0,
+                          static_cast<off_t>(max_file_size_));
+    }
+#endif
+}
+
+}  // namespace plas::log
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <spdlog/sinks/base_sink.h>
+
+namespace plas::log {
+
+/// Size-rotated log file written and rotated by its own thread.
+///
+/// A logging call only formats the message into an in-memory buffer. The
+/// writer thread writes the buffer out when it holds `buffer_size` bytes, on
+/// a warning or worse, on flush() and every 100 ms. When the next line would
+/// take the file past `max_file_size` it rotates with the same names as
+/// spdlog's rotating_file_sink (base.log → base.1.log → …, `max_files`
+/// kept). The file that becomes base.log was created and preallocated after
+/// the previous rotation (`<base>.next`), so a rotation is a few renames.
+///
+/// Callers never wait for the disk unless the writer falls four buffers
+/// behind; flush() waits until everything logged before it is written.
+class BackgroundFileSink final : public spdlog::sinks::base_sink<std::mutex> {
+public:
+    /// Opens (appending to) `base_path`. Throws spdlog::spdlog_ex if it
+    /// cannot be opened, like rotating_file_sink.
+    BackgroundFileSink(std::string base_path, std::size_t max_file_size,
+                       std::size_t max_files, std::size_t buffer_size);
+    ~BackgroundFileSink() override;
+
+    BackgroundFileSink(const BackgroundFileSink&) = delete;
+    BackgroundFileSink& operator=(const BackgroundFileSink&) = delete;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override;
+    void flush_() override;
+
+private:
+    // Writer thread only
+    void WriterLoop();
+    void WriteOut(const std::string& data);
+    void WriteAll(const char* data, std::size_t size);
+    void Rotate();
+    void PrepareNext();
+
+    const std::string base_path_;
+    const std::string next_path_;
+    const std::size_t max_file_size_;
+    const std::size_t max_files_;
+    const std::size_t buffer_size_;
+
+    int fd_ = -1;
+    int next_fd_ = -1;
+    std::size_t file_size_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;   // writer waits for data
+    std::condition_variable space_cv_;  // callers wait for buffer space
+    std::condition_variable done_cv_;   // flush() waits for the writer
+    std::string pending_;
+    bool write_now_ = false;
+    bool stopping_ = false;
+    uint64_t queued_ = 0;   // bytes appended to pending_
+    uint64_t written_ = 0;  // bytes the writer took out of pending_ and wrote
+    std::thread writer_;
+};
+
+}  // namespace plas::log
@@ -0,0 +1,24 @@
+#include "lttng_backend.h"
+
+#define LTTNG_UST_TRACEPOINT_CREATE_PROBES
+#define LTTNG_UST_TRACEPOINT_DEFINE
+#include "lttng_tp.h"
+
+namespace plas::log {
+
+bool LttngBackend::IsActive() {
+    return lttng_ust_tracepoint_enabled(plas, transaction_begin);
+}
+
+void LttngBackend::Begin(const char* device, const TraceRecord& record) {
+    lttng_ust_tracepoint(plas, transaction_begin, device,
+                         ToString(static_cast<TraceInterface>(record.interface)),
+                         ToString(static_cast<TraceOp>(record.op)), record.address,
+                         record.length, record.target);
+}
+
+void LttngBackend::End(const char* device, const TraceRecord& record) {
+    lttng_ust_tracepoint(plas, transaction_end, device, record.status, record.length);
+}
+
+}  // namespace plas::log
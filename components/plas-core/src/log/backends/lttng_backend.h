@@ -0,0 +1,21 @@
+#pragma once
+
+#include "plas/log/trace.h"
+
+namespace plas::log {
+
+/// SystemTrace backend on LTTng-UST (PLAS_SYSTEM_TRACE=LTTNG): tracepoints
+/// plas:transaction_begin / plas:transaction_end, e.g.
+///   lttng enable-event -u 'plas:*'
+class LttngBackend {
+public:
+    /// Nothing to do: probes register when the library loads.
+    static void Initialize() {}
+
+    static bool IsActive();
+
+    static void Begin(const char* device, const TraceRecord& record);
+    static void End(const char* device, const TraceRecord& record);
+};
+
+}  // namespace plas::log
@@ -0,0 +1,40 @@
+// LTTng-UST tracepoint provider "plas" (PLAS_SYSTEM_TRACE=LTTNG). Read
+// several times by <lttng/tracepoint-event.h>, hence the guard shape.
+
+#undef LTTNG_UST_TRACEPOINT_PROVIDER
+#define LTTNG_UST_TRACEPOINT_PROVIDER plas
+
+#undef LTTNG_UST_TRACEPOINT_INCLUDE
+#define LTTNG_UST_TRACEPOINT_INCLUDE "lttng_tp.h"
+
+#if !defined(PLAS_LTTNG_TP_H) || defined(LTTNG_UST_TRACEPOINT_HEADER_MULTI_READ)
+#define PLAS_LTTNG_TP_H
+
+#include <stdint.h>
+
+#include <lttng/tracepoint.h>
+
+LTTNG_UST_TRACEPOINT_EVENT(
+    plas, transaction_begin,
+    LTTNG_UST_TP_ARGS(const char*, device, const char*, interface_name,
+                      const char*, op_name, uint64_t, address, uint32_t, length,
+                      uint16_t, target),
+    LTTNG_UST_TP_FIELDS(
+        lttng_ust_field_string(device, device)
+        lttng_ust_field_string(interface, interface_name)
+        lttng_ust_field_string(op, op_name)
+        lttng_ust_field_integer_hex(uint64_t, address, address)
+        lttng_ust_field_integer(uint32_t, length, length)
+        lttng_ust_field_integer_hex(uint16_t, target, target)))
+
+LTTNG_UST_TRACEPOINT_EVENT(
+    plas, transaction_end,
+    LTTNG_UST_TP_ARGS(const char*, device, uint16_t, status, uint32_t, length),
+    LTTNG_UST_TP_FIELDS(
+        lttng_ust_field_string(device, device)
+        lttng_ust_field_integer(uint16_t, status, status)
+        lttng_ust_field_integer(uint32_t, length, length)))
+
+#endif  // PLAS_LTTNG_TP_H
+
+#include <lttng/tracepoint-event.h>
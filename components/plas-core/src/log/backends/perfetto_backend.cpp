@@ -0,0 +1,30 @@
+#include "perfetto_backend.h"
+
+PERFETTO_TRACK_EVENT_STATIC_STORAGE();
+
+namespace plas::log {
+
+void PerfettoBackend::Initialize() {
+    perfetto::TracingInitArgs args;
+    args.backends = perfetto::kSystemBackend;
+    perfetto::Tracing::Initialize(args);
+    perfetto::TrackEvent::Register();
+}
+
+void PerfettoBackend::Begin(const char* device, const TraceRecord& record) {
+    // ToString() returns literals, so the name needs no interning copy.
+    TRACE_EVENT_BEGIN("plas",
+                      perfetto::StaticString{
+                          ToString(static_cast<TraceInterface>(record.interface))},
+                      "device", device,
+                      "op", ToString(static_cast<TraceOp>(record.op)),
+                      "address", record.address,
+                      "bytes", record.length,
+                      "target", record.target);
+}
+
+void PerfettoBackend::End(const char* /*device*/, const TraceRecord& record) {
+    TRACE_EVENT_END("plas", "status", record.status, "bytes", record.length);
+}
+
+}  // namespace plas::log
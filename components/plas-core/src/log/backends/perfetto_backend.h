@@ -0,0 +1,25 @@
+#pragma once
+
+#include <perfetto.h>
+
+#include "plas/log/trace.h"
+
+PERFETTO_DEFINE_CATEGORIES(
+    perfetto::Category("plas").SetDescription("plas HAL transactions"));
+
+namespace plas::log {
+
+/// SystemTrace backend on the Perfetto SDK (PLAS_SYSTEM_TRACE=PERFETTO).
+/// Events go to the system `traced` service; enable category "plas" in the
+/// trace config to record them.
+class PerfettoBackend {
+public:
+    static void Initialize();
+
+    static bool IsActive() { return TRACE_EVENT_CATEGORY_ENABLED("plas"); }
+
+    static void Begin(const char* device, const TraceRecord& record);
+    static void End(const char* device, const TraceRecord& record);
+};
+
+}  // namespace plas::log
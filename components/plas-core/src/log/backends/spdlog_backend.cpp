@@ -1,30 +1,52 @@
 #include "spdlog_backend.h"
 
+#include <chrono>
 #include <vector>
 
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
+#include "background_file_sink.h"
+
 namespace plas::log {
 
 SpdlogBackend::SpdlogBackend() = default;
 
 SpdlogBackend::~SpdlogBackend() {
-    if (logger_) {
+    StopWriter();
+    DropRegistered();
+}
+
+void SpdlogBackend::DropRegistered() {
+    if (logger_ && spdlog::get(logger_->name()) == logger_) {
         spdlog::drop(logger_->name());
     }
 }
 
 void SpdlogBackend::Initialize(const LogConfig& config) {
+    StopWriter();
+    DropRegistered();
+    logger_.reset();
+    enqueued_ = 0;
+    written_ = 0;
+    dropped_oldest_ = 0;
+    dropped_newest_ = 0;
+
     // Build the full log file path: <log_dir>/<file_prefix>.log
     log_file_path_ = config.log_dir + "/" + config.file_prefix + ".log";
 
     std::vector<spdlog::sink_ptr> sinks;
 
     // Rotating file sink
-    auto file_sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
-        log_file_path_, config.max_file_size, config.max_files);
-    sinks.push_back(file_sink);
+    const bool background_file = config.file_mode == LogFileMode::kBackground;
+    if (background_file) {
+        sinks.push_back(std::make_shared<BackgroundFileSink>(
+            log_file_path_, config.max_file_size, config.max_files,
+            config.file_buffer_size));
+    } else {
+        sinks.push_back(std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+            log_file_path_, config.max_file_size, config.max_files));
+    }
 
     // Optional stdout color sink
     if (config.console_enabled) {
@@ -37,15 +59,142 @@ void SpdlogBackend::Initialize(const LogConfig& config) {
         "plas", sinks.begin(), sinks.end());
     logger_->set_level(ToSpdlogLevel(config.level));
     logger_->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%l] %v");
-    logger_->flush_on(spdlog::level::warn);
+    // BackgroundFileSink writes warnings out on its own thread; flushing
+    // on them would make the caller wait for that write.
+    logger_->flush_on(background_file ? spdlog::level::off : spdlog::level::warn);
+
+    // Only the first live logger gets the registry name; further Logger
+    // instances stay unregistered instead of colliding on "plas".
+    try {
+        spdlog::register_logger(logger_);
+    } catch (const spdlog::spdlog_ex&) {
+    }
 
-    spdlog::register_logger(logger_);
+    // Async mode: the writer thread owns all sink I/O (including the
+    // flush_on(warn) disk flush), so callers only pay for the enqueue.
+    if (config.async_enabled) {
+        queue_ = std::make_unique<AsyncLogQueue<QueuedMessage>>(
+            config.async_queue_size);
+        overflow_policy_ = config.overflow_policy;
+        stopping_ = false;
+        writer_ = std::thread(&SpdlogBackend::WriterLoop, this);
+    }
 }
 
 void SpdlogBackend::Log(LogLevel level, const std::string& msg) {
-    if (logger_) {
+    if (!logger_) {
+        return;
+    }
+    if (!queue_) {
         logger_->log(ToSpdlogLevel(level), msg);
+        return;
+    }
+
+    QueuedMessage item{level, msg};
+    enqueued_.fetch_add(1);
+    if (!queue_->TryPush(item)) {
+        switch (overflow_policy_) {
+            case LogOverflowPolicy::kDropNewest:
+                enqueued_.fetch_sub(1);
+                dropped_newest_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            case LogOverflowPolicy::kDropOldest:
+                do {
+                    QueuedMessage victim;
+                    if (queue_->TryPop(victim)) {
+                        dropped_oldest_.fetch_add(1);
+                    }
+                } while (!queue_->TryPush(item));
+                break;
+            case LogOverflowPolicy::kBlock:
+            default:
+                for (int spins = 0; !queue_->TryPush(item); ++spins) {
+                    WakeWriter();
+                    if (spins < 64) {
+                        std::this_thread::yield();
+                    } else {
+                        std::this_thread::sleep_for(
+                            std::chrono::microseconds(50));
+                    }
+                }
+                break;
+        }
+    }
+    WakeWriter();
+}
+
+void SpdlogBackend::Flush() {
+    if (queue_) {
+        const uint64_t target = enqueued_.load();
+        while (written_.load() + dropped_oldest_.load() < target) {
+            WakeWriter();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+    if (logger_) {
+        logger_->flush();
+    }
+}
+
+uint64_t SpdlogBackend::DroppedOldest() const {
+    return dropped_oldest_.load(std::memory_order_relaxed);
+}
+
+uint64_t SpdlogBackend::DroppedNewest() const {
+    return dropped_newest_.load(std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// Async writer
+// ---------------------------------------------------------------------------
+
+bool SpdlogBackend::HasPending() const {
+    return written_.load() + dropped_oldest_.load() < enqueued_.load();
+}
+
+void SpdlogBackend::WakeWriter() {
+    if (writer_idle_.load()) {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_cv_.notify_one();
+    }
+}
+
+void SpdlogBackend::WriterLoop() {
+    QueuedMessage item;
+    for (;;) {
+        if (queue_->TryPop(item)) {
+            logger_->log(ToSpdlogLevel(item.level), item.msg);
+            written_.fetch_add(1);
+            continue;
+        }
+        if (stopping_.load()) {
+            break;  // queue drained
+        }
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        writer_idle_ = true;
+        // Producers check writer_idle_ after publishing, and we check
+        // HasPending() after raising it, so no wake-up is lost. The timeout
+        // is only a safety net.
+        wake_cv_.wait_for(lock, std::chrono::milliseconds(50), [this] {
+            return stopping_.load() || HasPending();
+        });
+        writer_idle_ = false;
+    }
+    logger_->flush();
+}
+
+void SpdlogBackend::StopWriter() {
+    if (!writer_.joinable()) {
+        queue_.reset();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_ = true;
     }
+    wake_cv_.notify_one();
+    writer_.join();
+    queue_.reset();
 }
 
 void SpdlogBackend::SetLevel(LogLevel level) {
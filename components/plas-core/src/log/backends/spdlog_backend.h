@@ -1,10 +1,16 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 #include <spdlog/spdlog.h>
 
+#include "async_log_queue.h"
 #include "plas/log/log_config.h"
 #include "plas/log/log_level.h"
 
@@ -16,9 +22,10 @@ public:
     ~SpdlogBackend();
 
     /// Create spdlog sinks and logger from the given configuration.
+    /// Re-initializing stops (and drains) a running async writer first.
     void Initialize(const LogConfig& config);
 
-    /// Forward a log message to spdlog.
+    /// Forward a log message to spdlog, or to the async queue when enabled.
     void Log(LogLevel level, const std::string& msg);
 
     /// Update the minimum log level on the spdlog logger.
@@ -27,12 +34,45 @@ public:
     /// Return the path to the current (base) log file.
     std::string GetCurrentLogFile() const;
 
+    /// Wait until everything queued so far is written, then flush sinks.
+    void Flush();
+
+    uint64_t DroppedOldest() const;
+    uint64_t DroppedNewest() const;
+
 private:
+    struct QueuedMessage {
+        LogLevel level = LogLevel::kInfo;
+        std::string msg;
+    };
+
     /// Convert plas::log::LogLevel to spdlog::level::level_enum.
     static spdlog::level::level_enum ToSpdlogLevel(LogLevel level);
 
+    void WriterLoop();
+    void StopWriter();
+    /// Remove logger_ from spdlog's registry if it is the one registered.
+    void DropRegistered();
+    void WakeWriter();
+    bool HasPending() const;
+
     std::shared_ptr<spdlog::logger> logger_;
     std::string log_file_path_;
+
+    // Async mode (queue_ == nullptr in sync mode)
+    std::unique_ptr<AsyncLogQueue<QueuedMessage>> queue_;
+    LogOverflowPolicy overflow_policy_ = LogOverflowPolicy::kBlock;
+    std::thread writer_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> writer_idle_{false};
+    // enqueued_ is reserved before a push, so the writer is done once
+    // written_ + dropped_oldest_ catches up with it.
+    std::atomic<uint64_t> enqueued_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_oldest_{0};
+    std::atomic<uint64_t> dropped_newest_{0};
 };
 
 }  // namespace plas::log
@@ -1,9 +1,31 @@
 #include "plas/log/logger.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+
 #include "backends/spdlog_backend.h"
 
 namespace plas::log {
 
+static_assert(static_cast<int>(LogLevel::kTrace) == PLAS_LOG_LEVEL_TRACE &&
+                  static_cast<int>(LogLevel::kDebug) == PLAS_LOG_LEVEL_DEBUG &&
+                  static_cast<int>(LogLevel::kInfo) == PLAS_LOG_LEVEL_INFO &&
+                  static_cast<int>(LogLevel::kWarn) == PLAS_LOG_LEVEL_WARN &&
+                  static_cast<int>(LogLevel::kError) == PLAS_LOG_LEVEL_ERROR &&
+                  static_cast<int>(LogLevel::kCritical) ==
+                      PLAS_LOG_LEVEL_CRITICAL &&
+                  static_cast<int>(LogLevel::kOff) == PLAS_LOG_LEVEL_OFF,
+              "PLAS_LOG_LEVEL_* must match LogLevel");
+
 // ---------------------------------------------------------------------------
 // Pimpl definition
 // ---------------------------------------------------------------------------
@@ -11,6 +33,103 @@ struct Logger::Impl {
     SpdlogBackend backend;
     LogLevel level = LogLevel::kInfo;
     bool initialized = false;
+
+    // --- Per-device levels ---
+    struct DeviceLevels {
+        std::optional<LogLevel> level;
+        std::map<std::string, LogLevel, std::less<>> interfaces;
+    };
+    /// Checked first, so loggers without device levels skip the lock.
+    std::atomic<bool> has_device_levels{false};
+    mutable std::shared_mutex device_mutex;
+    std::map<std::string, DeviceLevels, std::less<>> device_levels;
+
+    LogLevel DeviceLevel(std::string_view device, std::string_view interface_name) const {
+        if (!has_device_levels.load(std::memory_order_acquire)) {
+            return level;
+        }
+        std::shared_lock<std::shared_mutex> lock(device_mutex);
+        auto it = device_levels.find(device);
+        if (it == device_levels.end()) {
+            return level;
+        }
+        if (!interface_name.empty()) {
+            auto iface = it->second.interfaces.find(interface_name);
+            if (iface != it->second.interfaces.end()) {
+                return iface->second;
+            }
+        }
+        return it->second.level.value_or(level);
+    }
+
+    /// The spdlog logger filters too, so it runs at the lowest level any
+    /// device may log at.
+    void ApplyBackendLevel() {
+        LogLevel lowest = level;
+        {
+            std::shared_lock<std::shared_mutex> lock(device_mutex);
+            for (const auto& [name, device] : device_levels) {
+                lowest = std::min(lowest, device.level.value_or(lowest));
+                for (const auto& [iface, iface_level] : device.interfaces) {
+                    lowest = std::min(lowest, iface_level);
+                }
+            }
+            has_device_levels.store(!device_levels.empty(), std::memory_order_release);
+        }
+        backend.SetLevel(lowest);
+    }
+
+    // --- Repeat sampling ---
+    /// Direct-mapped table of recent messages; a colliding message takes
+    /// the slot over and starts a new run.
+    struct RepeatSlot {
+        std::mutex mutex;
+        std::size_t hash = 0;
+        uint64_t seen = 0;        // in the current run
+        uint64_t suppressed = 0;  // since the last copy logged
+        std::chrono::steady_clock::time_point last;
+    };
+    static constexpr std::size_t kRepeatSlots = 1024;
+    std::size_t repeat_every = 0;
+    std::chrono::milliseconds repeat_window{0};
+    std::unique_ptr<std::array<RepeatSlot, kRepeatSlots>> repeat_slots;
+    std::atomic<uint64_t> suppressed_repeats{0};
+
+    /// False if `msg` is a repeat to suppress. Otherwise `note` is set to
+    /// the suppressed count, if any.
+    bool SampleRepeat(LogLevel msg_level, const std::string& msg, std::string& note) {
+        if (!repeat_slots) {
+            return true;
+        }
+        const auto hash = std::hash<std::string>{}(msg) ^ static_cast<std::size_t>(msg_level);
+        auto& slot = (*repeat_slots)[hash % kRepeatSlots];
+        const auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        if (slot.seen == 0 || slot.hash != hash || now - slot.last > repeat_window) {
+            slot.hash = hash;
+            slot.seen = 0;
+            slot.suppressed = 0;
+        }
+        slot.last = now;
+        if (slot.seen++ % repeat_every != 0) {
+            ++slot.suppressed;
+            suppressed_repeats.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (slot.suppressed > 0) {
+            note = " [" + std::to_string(slot.suppressed) + " identical suppressed]";
+            slot.suppressed = 0;
+        }
+        return true;
+    }
+
+    void Write(LogLevel msg_level, const std::string& msg) {
+        std::string note;
+        if (!SampleRepeat(msg_level, msg, note)) {
+            return;
+        }
+        backend.Log(msg_level, note.empty() ? msg : msg + note);
+    }
 };
 
 // ---------------------------------------------------------------------------
@@ -21,6 +140,51 @@ Logger& Logger::GetInstance() {
     return instance;
 }
 
+namespace {
+thread_local Logger* t_current_logger = nullptr;
+}  // namespace
+
+Logger& Logger::Current() {
+    Logger* logger = t_current_logger;
+    return logger != nullptr ? *logger : GetInstance();
+}
+
+Logger::ScopedCurrent::ScopedCurrent(Logger& logger) : previous_(t_current_logger) {
+    t_current_logger = &logger;
+}
+
+Logger::ScopedCurrent::~ScopedCurrent() { t_current_logger = previous_; }
+
+namespace {
+thread_local Logger::DeferScope* t_defer_scope = nullptr;
+}  // namespace
+
+Logger::DeferScope::DeferScope(std::size_t capacity, std::size_t reserve_chars)
+    : entries_(capacity), previous_(t_defer_scope) {
+    for (auto& entry : entries_) {
+        entry.text.reserve(reserve_chars);
+    }
+    t_defer_scope = this;
+}
+
+Logger::DeferScope::~DeferScope() {
+    t_defer_scope = previous_;
+    for (std::size_t i = 0; i < used_; ++i) {
+        entries_[i].logger->impl_->Write(entries_[i].level, entries_[i].text);
+    }
+}
+
+bool Logger::DeferScope::Hold(Logger& logger, LogLevel level, const std::string& text) {
+    if (used_ == entries_.size() || text.size() > entries_[used_].text.capacity()) {
+        return false;
+    }
+    auto& entry = entries_[used_++];
+    entry.logger = &logger;
+    entry.level = level;
+    entry.text.assign(text);  // fits the reserved capacity: no allocation
+    return true;
+}
+
 // ---------------------------------------------------------------------------
 // Construction / destruction
 // ---------------------------------------------------------------------------
@@ -34,12 +198,21 @@ Logger::~Logger() = default;
 void Logger::Init(const LogConfig& config) {
     impl_->backend.Initialize(config);
     impl_->level = config.level;
+    impl_->repeat_every = config.repeat_sample_every;
+    impl_->repeat_window = std::chrono::milliseconds(config.repeat_window_ms);
+    if (config.repeat_sample_every > 1) {
+        impl_->repeat_slots = std::make_unique<std::array<Impl::RepeatSlot, Impl::kRepeatSlots>>();
+    } else {
+        impl_->repeat_slots.reset();
+    }
+    impl_->suppressed_repeats = 0;
+    impl_->ApplyBackendLevel();
     impl_->initialized = true;
 }
 
 void Logger::SetLevel(LogLevel level) {
     impl_->level = level;
-    impl_->backend.SetLevel(level);
+    impl_->ApplyBackendLevel();
 }
 
 LogLevel Logger::GetLevel() const {
@@ -50,14 +223,131 @@ std::string Logger::GetCurrentLogFile() const {
     return impl_->backend.GetCurrentLogFile();
 }
 
+bool Logger::ShouldLog(LogLevel level) const {
+    return impl_->initialized && level >= impl_->level;
+}
+
 void Logger::Log(LogLevel level, const std::string& msg) {
-    if (!impl_->initialized) {
+    if (!ShouldLog(level)) {
         return;
     }
-    if (level < impl_->level) {
+    if (t_defer_scope != nullptr && t_defer_scope->Hold(*this, level, msg)) {
         return;
     }
-    impl_->backend.Log(level, msg);
+    impl_->Write(level, msg);
+}
+
+// ---------------------------------------------------------------------------
+// Per-device levels
+// ---------------------------------------------------------------------------
+void Logger::SetDeviceLevel(const std::string& device, LogLevel level,
+                            const std::string& interface_name) {
+    {
+        std::unique_lock<std::shared_mutex> lock(impl_->device_mutex);
+        auto& entry = impl_->device_levels[device];
+        if (interface_name.empty()) {
+            entry.level = level;
+        } else {
+            entry.interfaces[interface_name] = level;
+        }
+    }
+    impl_->ApplyBackendLevel();
+}
+
+void Logger::ClearDeviceLevel(const std::string& device, const std::string& interface_name) {
+    {
+        std::unique_lock<std::shared_mutex> lock(impl_->device_mutex);
+        auto it = impl_->device_levels.find(device);
+        if (it == impl_->device_levels.end()) {
+            return;
+        }
+        if (interface_name.empty()) {
+            it->second.level.reset();
+        } else {
+            it->second.interfaces.erase(interface_name);
+        }
+        if (!it->second.level && it->second.interfaces.empty()) {
+            impl_->device_levels.erase(it);
+        }
+    }
+    impl_->ApplyBackendLevel();
+}
+
+void Logger::ClearDeviceLevels() {
+    {
+        std::unique_lock<std::shared_mutex> lock(impl_->device_mutex);
+        impl_->device_levels.clear();
+    }
+    impl_->ApplyBackendLevel();
+}
+
+LogLevel Logger::GetDeviceLevel(std::string_view device, std::string_view interface_name) const {
+    return impl_->DeviceLevel(device, interface_name);
+}
+
+bool Logger::ShouldLog(LogLevel level, std::string_view device,
+                       std::string_view interface_name) const {
+    return impl_->initialized && level >= impl_->DeviceLevel(device, interface_name);
+}
+
+void Logger::Log(LogLevel level, std::string_view device, std::string_view interface_name,
+                 const std::string& msg) {
+    if (!ShouldLog(level, device, interface_name)) {
+        return;
+    }
+    std::string line;
+    line.reserve(device.size() + interface_name.size() + msg.size() + 5);
+    line.append("[").append(device).append("]");
+    if (!interface_name.empty()) {
+        line.append("[").append(interface_name).append("]");
+    }
+    line.append(" ").append(msg);
+    if (t_defer_scope != nullptr && t_defer_scope->Hold(*this, level, line)) {
+        return;
+    }
+    impl_->Write(level, line);
+}
+
+void Logger::Flush() {
+    if (impl_->initialized) {
+        impl_->backend.Flush();
+    }
+}
+
+LogDropStats Logger::GetDropStats() const {
+    LogDropStats stats;
+    stats.dropped_oldest = impl_->backend.DroppedOldest();
+    stats.dropped_newest = impl_->backend.DroppedNewest();
+    stats.suppressed_repeats = impl_->suppressed_repeats.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::string Logger::Format(const char* fmt, ...) {
+    if (fmt == nullptr) {
+        return {};
+    }
+
+    char stack_buf[256];
+    va_list args;
+    va_start(args, fmt);
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int needed = std::vsnprintf(stack_buf, sizeof(stack_buf), fmt, args);
+    va_end(args);
+
+    std::string out;
+    if (needed < 0) {
+        va_end(args_copy);
+        return out;
+    }
+    if (static_cast<size_t>(needed) < sizeof(stack_buf)) {
+        out.assign(stack_buf, static_cast<size_t>(needed));
+    } else {
+        out.resize(static_cast<size_t>(needed));
+        std::vsnprintf(&out[0], out.size() + 1, fmt, args_copy);
+    }
+    va_end(args_copy);
+    return out;
 }
 
 void Logger::Trace(const std::string& msg) {
@@ -0,0 +1,96 @@
+#include "plas/log/system_trace.h"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+
+#include "plas/log/trace.h"
+
+#if PLAS_SYSTEM_TRACE == 1
+#include "backends/perfetto_backend.h"
+#elif PLAS_SYSTEM_TRACE == 2
+#include "backends/lttng_backend.h"
+#endif
+
+namespace plas::log {
+
+namespace {
+
+#if PLAS_SYSTEM_TRACE == 1
+using SelectedBackend = PerfettoBackend;
+#elif PLAS_SYSTEM_TRACE == 2
+using SelectedBackend = LttngBackend;
+#endif
+
+// Indexed by Tracer device id (0 = unregistered). A slot is written once,
+// before the driver that owns the id can trace with it.
+using DeviceName = std::array<char, kTraceDeviceNameSize>;
+std::array<DeviceName, kTraceMaxDevices + 1> g_device_names{};
+std::mutex g_names_mutex;
+
+#if PLAS_SYSTEM_TRACE
+const char* DeviceNameOf(uint16_t id) {
+    return id <= kTraceMaxDevices && g_device_names[id][0] != '\0'
+               ? g_device_names[id].data()
+               : "?";
+}
+#endif
+
+}  // namespace
+
+const char* SystemTrace::Backend() {
+#if PLAS_SYSTEM_TRACE == 1
+    return "perfetto";
+#elif PLAS_SYSTEM_TRACE == 2
+    return "lttng";
+#else
+    return "none";
+#endif
+}
+
+void SystemTrace::Initialize() {
+#if PLAS_SYSTEM_TRACE
+    static std::once_flag once;
+    std::call_once(once, [] { SelectedBackend::Initialize(); });
+#endif
+}
+
+bool SystemTrace::IsActive() {
+#if PLAS_SYSTEM_TRACE
+    return SelectedBackend::IsActive();
+#else
+    return false;
+#endif
+}
+
+void SystemTrace::NameDevice(uint16_t id, const std::string& name) {
+    if (id == 0 || id > kTraceMaxDevices) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_names_mutex);
+        auto& slot = g_device_names[id];
+        auto n = std::min(name.size(), slot.size() - 1);
+        std::copy_n(name.data(), n, slot.data());
+        slot[n] = '\0';
+    }
+    Initialize();
+}
+
+void SystemTrace::Begin(const TraceRecord& record) {
+#if PLAS_SYSTEM_TRACE
+    SelectedBackend::Begin(DeviceNameOf(record.device_id), record);
+#else
+    (void)record;
+#endif
+}
+
+void SystemTrace::End(const TraceRecord& record) {
+#if PLAS_SYSTEM_TRACE
+    SelectedBackend::End(DeviceNameOf(record.device_id), record);
+#else
+    (void)record;
+#endif
+}
+
+}  // namespace plas::log
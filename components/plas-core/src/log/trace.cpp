@@ -0,0 +1,253 @@
+#include "plas/log/trace.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "plas/core/error.h"
+
+namespace plas::log {
+
+// The header's write_index is shared by every writer (and read by live
+// decoders), so it is accessed as an atomic in place inside the mapping.
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t) &&
+                  alignof(std::atomic<uint64_t>) == alignof(uint64_t),
+              "atomic<uint64_t> must overlay a plain uint64_t");
+static_assert(offsetof(TraceFileHeader, write_index) % 8 == 0,
+              "write_index must be 8-byte aligned");
+
+namespace {
+
+uint64_t NowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+}
+
+void CopyDeviceName(TraceFileHeader* header, std::size_t index,
+                    const std::string& name) {
+    char* slot = header->device_names[index];
+    std::size_t n = std::min(name.size(), kTraceDeviceNameSize - 1);
+    std::memcpy(slot, name.data(), n);
+    slot[n] = '\0';
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Pimpl definition
+// ---------------------------------------------------------------------------
+struct Tracer::Impl {
+    std::mutex mutex;  // Open/Close/RegisterDevice
+    std::vector<std::string> devices;
+    std::string path;
+    int fd = -1;
+    void* base = nullptr;
+    std::size_t map_size = 0;
+
+    // Valid while enabled_ is set.
+    TraceFileHeader* header = nullptr;
+    TraceRecord* records = nullptr;
+    uint64_t capacity = 0;
+
+    std::atomic<uint64_t>& WriteIndex() {
+        return *reinterpret_cast<std::atomic<uint64_t>*>(&header->write_index);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Singleton
+// ---------------------------------------------------------------------------
+Tracer& Tracer::GetInstance() {
+    static Tracer instance;
+    return instance;
+}
+
+Tracer::Tracer() : impl_(std::make_unique<Impl>()) {}
+
+Tracer::~Tracer() {
+    Close();
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+core::Result<void> Tracer::Open(const TraceConfig& config) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (impl_->base) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+    }
+    if (config.capacity == 0 || config.path.empty()) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    std::error_code ec;
+    auto parent = std::filesystem::path(config.path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+
+    std::size_t map_size =
+        sizeof(TraceFileHeader) + config.capacity * sizeof(TraceRecord);
+    int fd = ::open(config.path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return core::Result<void>::Err(core::ErrorCode::kPermissionDenied);
+    }
+    if (::ftruncate(fd, static_cast<off_t>(map_size)) != 0) {
+        ::close(fd);
+        return core::Result<void>::Err(core::ErrorCode::kIOError);
+    }
+    void* base = ::mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                        fd, 0);
+    if (base == MAP_FAILED) {
+        ::close(fd);
+        return core::Result<void>::Err(core::ErrorCode::kIOError);
+    }
+
+    // ftruncate zero-fills, so every slot starts with sequence 0 (empty).
+    auto* header = static_cast<TraceFileHeader*>(base);
+    std::memcpy(header->magic, kTraceMagic, sizeof(header->magic));
+    header->version = kTraceFormatVersion;
+    header->record_size = sizeof(TraceRecord);
+    header->capacity = config.capacity;
+    header->start_time_ns = NowNs();
+    for (std::size_t i = 0; i < impl_->devices.size(); ++i) {
+        CopyDeviceName(header, i, impl_->devices[i]);
+    }
+    header->device_count = static_cast<uint32_t>(impl_->devices.size());
+
+    impl_->fd = fd;
+    impl_->base = base;
+    impl_->map_size = map_size;
+    impl_->path = config.path;
+    impl_->header = header;
+    impl_->records = reinterpret_cast<TraceRecord*>(header + 1);
+    impl_->capacity = config.capacity;
+    new (&header->write_index) std::atomic<uint64_t>(0);
+
+    enabled_.store(true);
+    return core::Result<void>::Ok();
+}
+
+void Tracer::Close() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (!impl_->base) {
+        return;
+    }
+    // Record() bumps writers_ before checking enabled_ (both seq_cst), so
+    // once writers_ drains to zero no one can still touch the mapping.
+    enabled_.store(false);
+    while (writers_.load() != 0) {
+        std::this_thread::yield();
+    }
+
+    ::msync(impl_->base, impl_->map_size, MS_ASYNC);
+    ::munmap(impl_->base, impl_->map_size);
+    ::close(impl_->fd);
+    impl_->fd = -1;
+    impl_->base = nullptr;
+    impl_->map_size = 0;
+    impl_->header = nullptr;
+    impl_->records = nullptr;
+    impl_->capacity = 0;
+}
+
+uint16_t Tracer::RegisterDevice(const std::string& name) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto& devices = impl_->devices;
+    for (std::size_t i = 0; i < devices.size(); ++i) {
+        if (devices[i] == name) {
+            return static_cast<uint16_t>(i + 1);
+        }
+    }
+    if (devices.size() >= kTraceMaxDevices) {
+        return 0;
+    }
+    devices.push_back(name);
+    if (impl_->header) {
+        CopyDeviceName(impl_->header, devices.size() - 1, name);
+        impl_->header->device_count = static_cast<uint32_t>(devices.size());
+    }
+    auto id = static_cast<uint16_t>(devices.size());
+    if constexpr (kSystemTraceCompiled) {
+        SystemTrace::NameDevice(id, name);
+    }
+    return id;
+}
+
+void Tracer::Record(const TraceRecord& record) {
+    writers_.fetch_add(1);
+    if (!enabled_.load()) {
+        writers_.fetch_sub(1);
+        return;
+    }
+
+    uint64_t index =
+        impl_->WriteIndex().fetch_add(1, std::memory_order_relaxed);
+    TraceRecord& slot = impl_->records[index % impl_->capacity];
+
+    // Mark the slot as in progress, fill it, then publish the sequence so a
+    // live reader never accepts a half-written record.
+    slot.sequence = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(reinterpret_cast<char*>(&slot) + sizeof(slot.sequence),
+                reinterpret_cast<const char*>(&record) + sizeof(record.sequence),
+                sizeof(TraceRecord) - sizeof(record.sequence));
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.sequence = index + 1;
+
+    writers_.fetch_sub(1, std::memory_order_release);
+}
+
+uint64_t Tracer::GetRecordCount() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (!impl_->header) {
+        return 0;
+    }
+    return impl_->WriteIndex().load(std::memory_order_relaxed);
+}
+
+std::string Tracer::GetPath() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->path;
+}
+
+// ---------------------------------------------------------------------------
+// Enum names
+// ---------------------------------------------------------------------------
+const char* ToString(TraceInterface iface) {
+    switch (iface) {
+        case TraceInterface::kI2c:       return "i2c";
+        case TraceInterface::kI3c:       return "i3c";
+        case TraceInterface::kSpi:       return "spi";
+        case TraceInterface::kUart:      return "uart";
+        case TraceInterface::kPciConfig: return "pci-config";
+        case TraceInterface::kPciBar:    return "pci-bar";
+        case TraceInterface::kPciDoe:    return "pci-doe";
+        case TraceInterface::kUnknown:   break;
+    }
+    return "unknown";
+}
+
+const char* ToString(TraceOp op) {
+    switch (op) {
+        case TraceOp::kRead:      return "read";
+        case TraceOp::kWrite:     return "write";
+        case TraceOp::kWriteRead: return "write-read";
+        case TraceOp::kExchange:  return "exchange";
+        case TraceOp::kUnknown:   break;
+    }
+    return "unknown";
+}
+
+}  // namespace plas::log
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+#include "plas/coro/schedule.h"
+#include "plas/coro/task.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/pci/cxl_mailbox.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/interface/power_control.h"
+#include "plas/hal/power_sequencer.h"
+
+/// co_await-able wrappers for HAL calls.
+///
+/// Each wrapper runs the blocking call on `where` (a worker of an executor,
+/// or a device's strand so calls to one device queue instead of contending
+/// for its lock) and resumes the caller with the result. The call itself
+/// still occupies a worker while it runs; what a coroutine saves is the
+/// time between calls — waits and delays hold no thread, so one executor
+/// can drive many devices' sequences at once.
+///
+/// Pointer and reference arguments must stay valid until the task
+/// finishes; payloads are taken by value.
+namespace plas::coro {
+
+// I2c
+Task<core::Result<std::size_t>> Transfer(hal::I2c& i2c, hal::I2cMessage* msgs,
+                                         std::size_t count, Where where = {});
+Task<core::Result<std::size_t>> Read(hal::I2c& i2c, core::Address addr, core::Byte* data,
+                                     std::size_t length, Where where = {});
+Task<core::Result<std::size_t>> Write(hal::I2c& i2c, core::Address addr,
+                                      const core::Byte* data, std::size_t length,
+                                      Where where = {});
+Task<core::Result<std::size_t>> WriteRead(hal::I2c& i2c, core::Address addr,
+                                          const core::Byte* write_data, std::size_t write_len,
+                                          core::Byte* read_data, std::size_t read_len,
+                                          Where where = {});
+
+// PCI DOE / CXL mailbox
+Task<core::Result<hal::pci::DoePayload>> DoeExchange(hal::pci::PciDoe& doe, hal::pci::Bdf bdf,
+                                                     hal::pci::ConfigOffset doe_offset,
+                                                     hal::pci::DoeProtocolId protocol,
+                                                     hal::pci::DoePayload request,
+                                                     Where where = {});
+Task<core::Result<hal::pci::CxlMailboxResult>> ExecuteCommand(
+    hal::pci::CxlMailbox& mailbox, hal::pci::Bdf bdf, hal::pci::CxlMailboxOpcode opcode,
+    hal::pci::CxlMailboxPayload payload, Where where = {});
+Task<core::Result<hal::pci::CxlMailboxResult>> ExecuteCommand(
+    hal::pci::CxlMailbox& mailbox, hal::pci::Bdf bdf, uint16_t raw_opcode,
+    hal::pci::CxlMailboxPayload payload, Where where = {});
+
+// PowerControl
+Task<core::Result<void>> PowerOn(hal::PowerControl& power, Where where = {});
+Task<core::Result<void>> PowerOff(hal::PowerControl& power, Where where = {});
+Task<core::Result<void>> SetVoltage(hal::PowerControl& power, core::Voltage voltage,
+                                    Where where = {});
+Task<core::Result<void>> SetCurrent(hal::PowerControl& power, core::Current current,
+                                    Where where = {});
+
+/// Run a PowerSequencer timeline on one slot: steps are issued on `where`
+/// at their absolute offsets from the first step (so call latency does not
+/// push later steps back), and the delays between them are executor
+/// timers. Timing is to timer resolution — PowerSequencer's spinning slot
+/// threads remain the tool for tight cross-slot alignment; this is for
+/// running many slots without a thread each. A timeline step the target
+/// has no interface for fails the report with kInvalidArgument before
+/// anything runs.
+Task<hal::PowerSlotReport> RunPowerTimeline(std::vector<hal::PowerStep> timeline,
+                                            hal::PowerSequenceTarget target,
+                                            Where where = {}, bool stop_on_error = true);
+
+}  // namespace plas::coro
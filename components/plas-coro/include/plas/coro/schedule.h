@@ -0,0 +1,162 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "plas/core/executor.h"
+#include "plas/coro/task.h"
+
+namespace plas::coro {
+
+/// Where a coroutine step runs: on any worker of an executor, or on a
+/// strand (one device's calls, one at a time). Converts implicitly from
+/// both; the default is core::Executor::Shared().
+class Where {
+public:
+    Where() : Where(core::Executor::Shared()) {}
+    Where(core::Executor& executor) : executor_(&executor) {}  // NOLINT: implicit
+    Where(core::Strand& strand)                                // NOLINT: implicit
+        : executor_(&strand.GetExecutor()), strand_(&strand) {}
+
+    core::Executor& GetExecutor() const { return *executor_; }
+    core::Strand* GetStrand() const { return strand_; }
+
+    void Post(core::Executor::Task task) const {
+        if (strand_ != nullptr) {
+            strand_->Post(std::move(task));
+        } else {
+            executor_->Post(std::move(task));
+        }
+    }
+
+private:
+    core::Executor* executor_;
+    core::Strand* strand_ = nullptr;
+};
+
+/// `co_await Schedule(where)`: continue on `where`.
+inline auto Schedule(Where where) {
+    struct Awaiter {
+        Where where;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) const {
+            where.Post([handle] { handle.resume(); });
+        }
+        void await_resume() const noexcept {}
+    };
+    return Awaiter{where};
+}
+
+/// `co_await SleepUntil(deadline)`: continue on a worker of `executor` at
+/// `deadline`. The wait is an executor timer; no thread is held.
+inline auto SleepUntil(std::chrono::steady_clock::time_point deadline,
+                       core::Executor& executor = core::Executor::Shared()) {
+    struct Awaiter {
+        std::chrono::steady_clock::time_point deadline;
+        core::Executor* executor;
+        bool await_ready() const noexcept {
+            return deadline <= std::chrono::steady_clock::now();
+        }
+        void await_suspend(std::coroutine_handle<> handle) const {
+            executor->PostAfter(deadline - std::chrono::steady_clock::now(),
+                                [handle] { handle.resume(); });
+        }
+        void await_resume() const noexcept {}
+    };
+    return Awaiter{deadline, &executor};
+}
+
+inline auto SleepFor(std::chrono::nanoseconds delay,
+                     core::Executor& executor = core::Executor::Shared()) {
+    return SleepUntil(std::chrono::steady_clock::now() + delay, executor);
+}
+
+/// `co_await Offload(where, fn)`: run the blocking call `fn` on `where` and
+/// continue with its result. On a strand, only `fn` holds the strand: the
+/// coroutine continues on the strand's executor, so the next device call
+/// queued on the strand does not wait for the rest of this coroutine.
+template <typename F>
+class OffloadAwaiter {
+public:
+    using Result = std::invoke_result_t<F&>;
+    static_assert(!std::is_void_v<Result>, "Offload needs a call that returns a value");
+
+    OffloadAwaiter(Where where, F fn) : where_(where), fn_(std::move(fn)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        // Nothing may touch *this once posted: the coroutine can be resumed
+        // (and the awaiter destroyed) before Post returns.
+        where_.Post([this, handle] {
+            result_.emplace(fn_());
+            if (where_.GetStrand() != nullptr) {
+                where_.GetExecutor().Post([handle] { handle.resume(); });
+            } else {
+                handle.resume();
+            }
+        });
+    }
+
+    Result await_resume() { return std::move(*result_); }
+
+private:
+    Where where_;
+    F fn_;
+    std::optional<Result> result_;
+};
+
+template <typename F>
+OffloadAwaiter<std::decay_t<F>> Offload(Where where, F&& fn) {
+    return OffloadAwaiter<std::decay_t<F>>(where, std::forward<F>(fn));
+}
+
+namespace detail {
+
+/// Fire-and-forget coroutine: starts eagerly, frees itself when done.
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+template <typename T>
+Detached RunDetached(Where where, Task<T> task, std::promise<T> promise) {
+    co_await Schedule(where);
+    if constexpr (std::is_void_v<T>) {
+        co_await task;
+        promise.set_value();
+    } else {
+        promise.set_value(co_await task);
+    }
+}
+
+}  // namespace detail
+
+/// Start `task` on `where` and get its result through a future.
+template <typename T>
+std::future<T> Spawn(Task<T> task, Where where = {}) {
+    std::promise<T> promise;
+    auto future = promise.get_future();
+    detail::RunDetached(where, std::move(task), std::move(promise));
+    return future;
+}
+
+/// Run `task` on `where` and block the calling thread until it finishes.
+/// Not from a worker of that executor: with every worker blocked here the
+/// task could never run.
+template <typename T>
+T SyncWait(Task<T> task, Where where = {}) {
+    return Spawn(std::move(task), where).get();
+}
+
+}  // namespace plas::coro
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace plas::coro {
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+struct PromiseBase {
+    /// Resumed when the task finishes: the coroutine awaiting it.
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> self) noexcept {
+            return self.promise().continuation;
+        }
+        void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    // The library is built without exceptions; nothing to carry across.
+    void unhandled_exception() noexcept { std::terminate(); }
+};
+
+template <typename T>
+struct Promise : PromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& result) {
+        value.emplace(std::forward<U>(result));
+    }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    Task<void> get_return_object() noexcept;
+    void return_void() noexcept {}
+};
+
+}  // namespace detail
+
+/// A lazily started coroutine producing a T.
+///
+/// Nothing runs until the task is co_awaited; it then runs on the awaiting
+/// thread up to its first suspension, and its completion resumes the
+/// awaiting coroutine directly (symmetric transfer: in optimized builds,
+/// long chains of synchronously completing tasks do not grow the stack;
+/// -O0 builds do not turn the transfer into a tail call). Use Spawn or
+/// SyncWait (plas/coro/schedule.h) to start one from plain code.
+template <typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::Promise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+
+    T await_resume() {
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(*handle_.promise().value);
+        }
+    }
+
+private:
+    friend struct detail::Promise<T>;
+    explicit Task(Handle handle) noexcept : handle_(handle) {}
+
+    Handle handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> Promise<T>::get_return_object() noexcept {
+    return Task<T>(Task<T>::Handle::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object() noexcept {
+    return Task<void>(Task<void>::Handle::from_promise(*this));
+}
+
+}  // namespace detail
+
+}  // namespace plas::coro
@@ -0,0 +1,154 @@
+#include "plas/coro/hal.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/ssd_gpio.h"
+
+namespace plas::coro {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t SinceNs(Clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start)
+            .count());
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// I2c
+// ---------------------------------------------------------------------------
+
+Task<core::Result<std::size_t>> Transfer(hal::I2c& i2c, hal::I2cMessage* msgs,
+                                         std::size_t count, Where where) {
+    co_return co_await Offload(where, [&i2c, msgs, count] { return i2c.Transfer(msgs, count); });
+}
+
+Task<core::Result<std::size_t>> Read(hal::I2c& i2c, core::Address addr, core::Byte* data,
+                                     std::size_t length, Where where) {
+    co_return co_await Offload(
+        where, [&i2c, addr, data, length] { return i2c.Read(addr, data, length); });
+}
+
+Task<core::Result<std::size_t>> Write(hal::I2c& i2c, core::Address addr,
+                                      const core::Byte* data, std::size_t length,
+                                      Where where) {
+    co_return co_await Offload(
+        where, [&i2c, addr, data, length] { return i2c.Write(addr, data, length); });
+}
+
+Task<core::Result<std::size_t>> WriteRead(hal::I2c& i2c, core::Address addr,
+                                          const core::Byte* write_data, std::size_t write_len,
+                                          core::Byte* read_data, std::size_t read_len,
+                                          Where where) {
+    co_return co_await Offload(where, [&i2c, addr, write_data, write_len, read_data, read_len] {
+        return i2c.WriteRead(addr, write_data, write_len, read_data, read_len);
+    });
+}
+
+// ---------------------------------------------------------------------------
+// PCI DOE / CXL mailbox
+// ---------------------------------------------------------------------------
+
+Task<core::Result<hal::pci::DoePayload>> DoeExchange(hal::pci::PciDoe& doe, hal::pci::Bdf bdf,
+                                                     hal::pci::ConfigOffset doe_offset,
+                                                     hal::pci::DoeProtocolId protocol,
+                                                     hal::pci::DoePayload request,
+                                                     Where where) {
+    co_return co_await Offload(where, [&doe, bdf, doe_offset, protocol, &request] {
+        return doe.DoeExchange(bdf, doe_offset, protocol, request);
+    });
+}
+
+Task<core::Result<hal::pci::CxlMailboxResult>> ExecuteCommand(
+    hal::pci::CxlMailbox& mailbox, hal::pci::Bdf bdf, hal::pci::CxlMailboxOpcode opcode,
+    hal::pci::CxlMailboxPayload payload, Where where) {
+    co_return co_await Offload(where, [&mailbox, bdf, opcode, &payload] {
+        return mailbox.ExecuteCommand(bdf, opcode, payload);
+    });
+}
+
+Task<core::Result<hal::pci::CxlMailboxResult>> ExecuteCommand(
+    hal::pci::CxlMailbox& mailbox, hal::pci::Bdf bdf, uint16_t raw_opcode,
+    hal::pci::CxlMailboxPayload payload, Where where) {
+    co_return co_await Offload(where, [&mailbox, bdf, raw_opcode, &payload] {
+        return mailbox.ExecuteCommand(bdf, raw_opcode, payload);
+    });
+}
+
+// ---------------------------------------------------------------------------
+// PowerControl
+// ---------------------------------------------------------------------------
+
+Task<core::Result<void>> PowerOn(hal::PowerControl& power, Where where) {
+    co_return co_await Offload(where, [&power] { return power.PowerOn(); });
+}
+
+Task<core::Result<void>> PowerOff(hal::PowerControl& power, Where where) {
+    co_return co_await Offload(where, [&power] { return power.PowerOff(); });
+}
+
+Task<core::Result<void>> SetVoltage(hal::PowerControl& power, core::Voltage voltage,
+                                    Where where) {
+    co_return co_await Offload(where, [&power, voltage] { return power.SetVoltage(voltage); });
+}
+
+Task<core::Result<void>> SetCurrent(hal::PowerControl& power, core::Current current,
+                                    Where where) {
+    co_return co_await Offload(where, [&power, current] { return power.SetCurrent(current); });
+}
+
+Task<hal::PowerSlotReport> RunPowerTimeline(std::vector<hal::PowerStep> timeline,
+                                            hal::PowerSequenceTarget target, Where where,
+                                            bool stop_on_error) {
+    hal::PowerSlotReport report;
+    report.name = target.name;
+    for (const auto& step : timeline) {
+        if (step.action == hal::PowerStepAction::kDelay) {
+            continue;
+        }
+        if (step.NeedsGpio() ? target.gpio == nullptr : target.power == nullptr) {
+            report.error = make_error_code(core::ErrorCode::kInvalidArgument);
+            co_return report;
+        }
+    }
+
+    const auto start = Clock::now();
+    std::chrono::nanoseconds at{0};
+    for (std::size_t i = 0; i < timeline.size(); ++i) {
+        const auto& step = timeline[i];
+        if (step.action == hal::PowerStepAction::kDelay) {
+            at += step.delay;
+            continue;
+        }
+        co_await SleepUntil(start + at, where.GetExecutor());
+
+        hal::PowerStepTiming timing;
+        timing.step = i;
+        timing.action = step.action;
+        timing.scheduled_ns = static_cast<uint64_t>(at.count());
+        timing.start_ns = std::max(SinceNs(start), timing.scheduled_ns);
+        timing.error = co_await Offload(
+            where, [&step, &target] { return hal::ExecutePowerStep(step, target); });
+        timing.end_ns = SinceNs(start);
+        report.steps.push_back(timing);
+
+        if (timing.error) {
+            if (!report.error) {
+                report.error = timing.error;
+            }
+            if (stop_on_error) {
+                co_return report;
+            }
+        }
+    }
+    report.completed = !report.error;
+    co_return report;
+}
+
+}  // namespace plas::coro
@@ -1,20 +1,132 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_interfaces.h"
+#include "plas/hal/interface/gpio.h"
 #include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/smbus.h"
+#include "plas/hal/interface/spi.h"
+#include "plas/hal/metrics.h"
 #include "plas/config/device_entry.h"
+#include "plas/config/device_uri.h"
 
 namespace plas::hal::driver {
 
 struct AardvarkBusState;  // defined in aardvark_device.cpp
 
-class AardvarkDevice : public Device, public I2c {
+/// Total Phase Aardvark I2C/SPI host adapter.
+///
+/// Optional DeviceEntry args:
+///   bitrate        — I2C bitrate in Hz (default 100000)
+///   pullup         — enable pull-ups (default true)
+///   bus_timeout_ms — SDK bus timeout (default 200)
+///   async          — queue transactions on the shared bus worker
+///                    (default false)
+///   priority       — bus scheduling class: high / normal / low
+///                    (default normal); background callers
+///                    (core::ScopedIoPriority) rank below all of them
+///   max_wait_ms    — longest a transaction waits for the bus before
+///                    failing with kTimeout; 0 = no limit (default 0).
+///                    The caller's core::Deadline also ends the wait
+///   target_bitrates — per-target clock profile, e.g.
+///                    "0x50=400000,0x48=100000"; other targets run at
+///                    `bitrate`
+///   probe_bitrate  — run ProbeMaxBitrate() on Open for the URI target and
+///                    every profiled target not yet probed (default false)
+///   spi_bitrate    — SPI master clock in Hz, 125 kHz-8 MHz (default 1000000)
+///   spi_mode       — SPI mode 0-3 (CPOL/CPHA, default 0)
+///   gpio_pins      — pins this device drives through Gpio, a mask of
+///                    kGpioScl..kGpioSs (default kSpiPins)
+///
+/// The bus clock follows the target of each transaction: it is switched
+/// only when the next transaction needs a different rate, so a slow
+/// sensor no longer drags every other target on the port down to its speed.
+///
+/// SmBus block reads use the adapter's sized read (AA_I2C_SIZED_READ): the
+/// Aardvark reads the byte count and then exactly that many bytes, plus
+/// PEC, without a second transaction for the data.
+///
+/// Spi and Gpio share the port's handle and bus scheduler with I2c. The
+/// adapter runs I2C and SPI side by side, but a pin used as GPIO takes its
+/// function off the bus, so each transaction enables only the functions it
+/// needs (ApplyModeLocked) and the adapter is reconfigured only when the
+/// current mode does not already allow it. With `async` the worker groups
+/// queued transactions by mode as it does by clock. The bus opens with
+/// I2C only and the SPI pins as GPIO, as before SPI support; the first SPI
+/// transaction adds SPI. The adapter asserts SS for one SDK call only, so
+/// an Exchange() with `end = false` is held back and sent with the next
+/// one; it cannot read, and one chip select covers at most 65535 bytes.
+class AardvarkDevice final : public Device, public I2c, public SmBus, public Spi, public Gpio {
 public:
+    /// Bus scheduling class. Devices sharing a port are granted the bus
+    /// highest class first, first come first served within a class.
+    enum class Priority : int { kHigh = 0, kNormal = 1, kLow = 2 };
+
+    /// Adapter functions (the SDK's AA_CONFIG_SPI_MASK / AA_CONFIG_I2C_MASK).
+    static constexpr uint8_t kModeSpi = 0x01;
+    static constexpr uint8_t kModeI2c = 0x02;
+
+    /// GPIO pin bits (the SDK's AA_GPIO_*), and the pins of each function.
+    static constexpr uint32_t kGpioScl = 0x01;
+    static constexpr uint32_t kGpioSda = 0x02;
+    static constexpr uint32_t kGpioMiso = 0x04;
+    static constexpr uint32_t kGpioSck = 0x08;
+    static constexpr uint32_t kGpioMosi = 0x10;
+    static constexpr uint32_t kGpioSs = 0x20;
+    static constexpr uint32_t kI2cPins = kGpioScl | kGpioSda;
+    static constexpr uint32_t kSpiPins = kGpioMiso | kGpioSck | kGpioMosi | kGpioSs;
+
+    /// Longest SPI transfer under one chip select (16-bit SDK length).
+    static constexpr size_t kSpiMaxTransfer = 0xFFFF;
+    /// SPI master clock range of the adapter.
+    static constexpr uint32_t kSpiMinBitrate = 125000;
+    static constexpr uint32_t kSpiMaxBitrate = 8000000;
+
+    /// Time this device spent waiting for the shared bus.
+    struct BusWaitStats {
+        uint64_t acquisitions = 0;  ///< transactions granted the bus
+        uint64_t timeouts = 0;      ///< transactions past max_wait_ms or the deadline
+        uint64_t last_us = 0;
+        uint64_t max_us = 0;
+        uint64_t total_us = 0;
+        uint64_t bitrate_switches = 0;  ///< bus clock changes before a transaction
+        uint64_t mode_switches = 0;     ///< adapter reconfigurations (I2C/SPI/GPIO)
+    };
+
+    /// A queued async transaction as seen by PlanBatch().
+    struct QueuedOp {
+        int priority;       ///< Priority value
+        const void* owner;  ///< submitting device; its ops keep their order
+        uint32_t bitrate;   ///< clock the op runs at; 0 = any
+        uint8_t mode_on = 0;   ///< functions the op needs enabled (kMode*)
+        uint8_t mode_off = 0;  ///< functions whose pins it uses as GPIO
+    };
+
+    /// Order in which the async worker runs a drained batch, as indices into
+    /// `ops`: priority classes highest first; within a class each owner's
+    /// ops stay in submission order, and the next op is the earliest one
+    /// that can run at the current clock and adapter mode, switching only
+    /// when none can. `active_bitrate` and `active_mode` are the bus state
+    /// before the batch.
+    static std::vector<std::size_t> PlanBatch(const std::vector<QueuedOp>& ops,
+                                              uint32_t active_bitrate,
+                                              uint8_t active_mode = kModeI2c);
+
     explicit AardvarkDevice(const config::DeviceEntry& entry);
+    /// `uri` is entry.uri already parsed (see DeviceFactory).
+    AardvarkDevice(const config::DeviceEntry& entry, const config::DeviceUri& uri);
     ~AardvarkDevice() override;
 
     // Device interface
@@ -27,7 +139,12 @@ public:
     std::string GetUri() const override;
     std::string GetDriverName() const override;
 
-    // I2c interface — GetDevice()
+    using Interfaces = InterfaceList<I2c, SmBus, Spi, Gpio>;
+    void* QueryInterface(InterfaceKind kind) override {
+        return QueryInterfaceOf(this, kind, Interfaces{});
+    }
+
+    // I2c / SmBus / Spi / Gpio interface — GetDevice()
     Device* GetDevice() override;
 
     // I2c interface
@@ -39,9 +156,85 @@ public:
                                    const core::Byte* write_data,
                                    size_t write_len, core::Byte* read_data,
                                    size_t read_len) override;
+    core::Result<size_t> Transfer(I2cMessage* msgs, size_t count) override;
+    /// Zero-length write: only the address byte goes on the bus.
+    core::Result<bool> Probe(core::Address addr) override;
+    /// All probes in one bus turn at GetBitrate(), with the SDK bus timeout
+    /// lowered to `timeout` for the scan.
+    core::Result<std::vector<core::Address>> Scan(
+        core::Address first, core::Address last,
+        std::chrono::milliseconds timeout = std::chrono::milliseconds{0}) override;
     core::Result<void> SetBitrate(uint32_t bitrate) override;
     uint32_t GetBitrate() const override;
 
+    // SmBus interface; queued like WriteRead() with `async`.
+    core::Result<size_t> Transact(core::Address addr, const core::Byte* write,
+                                  size_t write_len, core::Byte* read,
+                                  size_t read_len, bool block,
+                                  bool pec) override;
+
+    // Spi interface; queued like I2c transactions with `async`.
+    core::Result<size_t> Exchange(const core::Byte* write, core::Byte* read,
+                                  size_t length, bool end = true) override;
+    /// Header and data in one SDK transfer; single-line only.
+    core::Result<size_t> Command(const SpiCommand& command) override;
+    core::Result<void> SetClock(core::Frequency freq) override;
+    core::Frequency GetClock() const override;
+    core::Result<void> SetMode(SpiMode mode) override;
+
+    // Gpio interface, over the `gpio_pins` pins. The direction and output
+    // registers are shared by every device on the port.
+    uint32_t PinMask() const override;
+    core::Result<void> SetDirection(uint32_t mask, uint32_t outputs) override;
+    core::Result<void> WritePins(uint32_t mask, uint32_t values) override;
+    core::Result<uint32_t> ReadPins() override;
+
+    // -- Per-target clock ----------------------------------------------------
+
+    /// Rate transactions to `addr` run at: its probed rate, else its
+    /// target_bitrates entry, else GetBitrate().
+    uint32_t GetTargetBitrate(core::Address addr) const;
+
+    /// Find the fastest rate `addr` reads reliably at: from its
+    /// target_bitrates entry (or 800 kHz) down through 400 and 100 kHz, the
+    /// first rate at which kProbeReads one-byte reads all succeed. The bus
+    /// is held for the whole probe. The result is kept for the port, shared
+    /// with every device on it, until the bus closes. The error of the last
+    /// read if no rate works (kNotSupported without the SDK).
+    core::Result<uint32_t> ProbeMaxBitrate(core::Address addr);
+
+    static constexpr int kProbeReads = 3;
+
+    // -- Asynchronous submission ---------------------------------------------
+    //
+    // With `async: true` every transaction on this device is queued on the
+    // port's shared worker, which drains the queue back to back under a single
+    // bus lock. Requests complete in submission order, so per-device ordering
+    // is preserved; the blocking Read/Write/WriteRead/Transfer calls go
+    // through the same queue. Buffers must stay valid until the future is
+    // ready. Without `async` these run synchronously and return a ready future.
+    // A queued transaction keeps the submitter's core::Deadline.
+
+    std::future<core::Result<size_t>> ReadAsync(core::Address addr,
+                                                core::Byte* data,
+                                                size_t length,
+                                                bool stop = true);
+    std::future<core::Result<size_t>> WriteAsync(core::Address addr,
+                                                 const core::Byte* data,
+                                                 size_t length,
+                                                 bool stop = true);
+    std::future<core::Result<size_t>> WriteReadAsync(
+        core::Address addr, const core::Byte* write_data, size_t write_len,
+        core::Byte* read_data, size_t read_len);
+
+    bool IsAsyncEnabled() const;
+
+    Priority GetPriority() const;
+
+    /// Snapshot of the bus wait counters since Open() or ResetBusWaitStats().
+    BusWaitStats GetBusWaitStats() const;
+    void ResetBusWaitStats();
+
     /// Register this driver with the DeviceFactory.
     static void Register();
 
@@ -49,17 +242,110 @@ public:
     static void ResetBusRegistry();
 
 private:
-    static bool ParseUri(const std::string& uri, uint16_t& port,
+    static bool ParseUri(const config::DeviceUri& uri, uint16_t& port,
                          uint16_t& addr);
 
+    /// Join or open the port's bus state; Open() adds the bitrate probe.
+    core::Result<void> OpenBus();
+
+    // SDK calls; caller owns the bus (AcquireBus). Stub builds return
+    // kNotSupported.
+    core::Result<size_t> ReadLocked(core::Address addr, core::Byte* data,
+                                    size_t length, bool stop);
+    core::Result<size_t> WriteLocked(core::Address addr,
+                                     const core::Byte* data, size_t length,
+                                     bool stop);
+    core::Result<size_t> WriteReadLocked(core::Address addr,
+                                         const core::Byte* write_data,
+                                         size_t write_len,
+                                         core::Byte* read_data,
+                                         size_t read_len);
+    core::Result<size_t> TransferLocked(I2cMessage* msgs, size_t count);
+    /// Command write (no STOP) + sized read, one bus transaction.
+    core::Result<size_t> BlockReadLocked(core::Address addr,
+                                         const core::Byte* write,
+                                         size_t write_len, core::Byte* read,
+                                         size_t read_len, bool pec);
+    /// One SS-framed transfer: `head` (held Exchange bytes, a command
+    /// header), then `length` bytes of `write` (null = 0xFF filler), with
+    /// the bytes clocked in during the latter into `read` (null = discard).
+    core::Result<size_t> SpiTransferLocked(const core::Byte* head, size_t head_len,
+                                           const core::Byte* write,
+                                           core::Byte* read, size_t length);
+    /// Set a GPIO register (direction or outputs) bits in `mask` to
+    /// `values`, keeping the other bits.
+    core::Result<size_t> GpioUpdateLocked(bool direction, uint32_t mask, uint32_t values);
+    core::Result<size_t> GpioReadLocked();
+    /// Quick-write every address of [first, last] into `found`.
+    core::Result<size_t> ScanLocked(core::Address first, core::Address last,
+                                    std::chrono::milliseconds timeout,
+                                    std::vector<core::Address>& found);
+
+    /// Wait for a bus turn at this device's priority, counting from
+    /// `since`. A caller under core::IoPriority::kBackground queues behind
+    /// every foreground one. Returns false (and records a timeout) if max_wait_ms or the
+    /// current core::Deadline passes.
+    bool AcquireBus(std::chrono::steady_clock::time_point since);
+    void ReleaseBus();
+
+    /// Run `op` while owning the bus; kTimeout if the turn never comes.
+    core::Result<size_t> RunOnBus(
+        std::chrono::steady_clock::time_point since,
+        const std::function<core::Result<size_t>()>& op);
+
+    /// Queue `op` on the shared bus worker, which runs it via RunOnBus.
+    /// `bitrate` groups it with other ops at the same clock.
+    std::future<core::Result<size_t>> Submit(
+        uint32_t bitrate, std::function<core::Result<size_t>()> op);
+    /// Submit() for a transaction needing `mode_on` / `mode_off` (I2C
+    /// transactions need kModeI2c).
+    std::future<core::Result<size_t>> Submit(
+        uint32_t bitrate, uint8_t mode_on, uint8_t mode_off,
+        std::function<core::Result<size_t>()> op);
+
+    /// Run an SPI or GPIO transaction: queued with `async`, else on the bus.
+    core::Result<size_t> RunOp(uint8_t mode_on, uint8_t mode_off,
+                               const std::function<core::Result<size_t>()>& op);
+
+    /// Switch the bus clock to `bitrate` unless it is already there; caller
+    /// owns the bus. Enables I2C first (ApplyModeLocked).
+    core::Result<void> ApplyBitrateLocked(uint32_t bitrate);
+
+    /// Enable `on` and disable `off` (kMode* bits), keeping the other
+    /// function as it is; aa_configure only if that changes the mode.
+    /// Caller owns the bus.
+    core::Result<void> ApplyModeLocked(uint8_t on, uint8_t off);
+
+    /// Enable SPI and bring the port's SPI clock and mode to this device's.
+    core::Result<void> ApplySpiLocked();
+
+    /// Functions (kMode*) whose pins overlap `pins`.
+    static uint8_t ModesOfPins(uint32_t pins);
+
     std::string name_;
     std::string uri_;
+    bool uri_valid_ = false;
     DeviceState state_;
-    uint32_t bitrate_;
+    std::atomic<uint32_t> bitrate_;
+    std::map<uint16_t, uint32_t> target_bitrates_;  // target_bitrates arg
+    bool probe_bitrate_;
     uint16_t port_;
     uint16_t default_addr_;
     bool pullup_enabled_;
     uint16_t bus_timeout_ms_;
+    bool async_enabled_;
+    Priority priority_;
+    uint32_t max_wait_ms_;
+    std::atomic<uint32_t> spi_bitrate_;
+    std::atomic<SpiMode> spi_mode_;
+    uint32_t gpio_pins_;  // gpio_pins arg
+    // Exchange(end = false) bytes waiting for the transfer that ends the
+    // chip select; not thread-safe, like a held chip select.
+    std::vector<core::Byte> spi_pending_;
+    uint16_t trace_id_;  // log::Tracer device id, assigned in Open()
+    DeviceMetrics* metrics_;  // MetricsRegistry entry, assigned in Open()
+    BusWaitStats wait_stats_;
+    mutable std::mutex wait_stats_mutex_;
     std::shared_ptr<AardvarkBusState> bus_state_;  // valid after Open()
 };
 
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <type_traits>
+
+#include "plas/hal/interface/device.h"
+
+namespace plas::hal::driver {
+
+/// `device` as the concrete driver class `Driver`, or nullptr if it is
+/// another driver or a wrapper (RecordTransactions). Driver classes are
+/// final, so calls through the result bind statically — no vtable load,
+/// and inline members such as MmioWindow accessors inline fully:
+///
+///   auto* dev = DriverCast<PciUtilsDevice>(dm.GetDevice("nvme0"));
+///   auto bar0 = dev->GetBarWindow(0);        // once, checked
+///   while ((bar0.Value().Read32(kCsts) & 1) == 0) {}
+///
+/// This is a dynamic_cast: resolve once, outside the hot loop.
+template <typename Driver>
+Driver* DriverCast(Device* device) {
+    static_assert(std::is_base_of_v<Device, Driver>, "Driver must be a Device");
+    static_assert(std::is_final_v<Driver>,
+                  "DriverCast is for final driver classes, whose calls devirtualize");
+    return dynamic_cast<Driver*>(device);
+}
+
+}  // namespace plas::hal::driver
@@ -1,18 +1,96 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "plas/core/io_queue.h"
 #include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_interfaces.h"
 #include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/smbus.h"
+#include "plas/hal/interface/spi.h"
+#include "plas/hal/metrics.h"
 #include "plas/config/device_entry.h"
+#include "plas/config/device_uri.h"
 
 namespace plas::hal::driver {
 
-class Ft4222hDevice : public Device, public I2c {
+struct Ft4222hRxEvent;  // defined in ft4222h_device.cpp
+
+/// One entry of the FTDI D2XX device list (FT_GetDeviceInfoList).
+struct FtdiDeviceInfo {
+    uint32_t index = 0;     ///< position in the list (FT_Open index)
+    uint32_t flags = 0;
+    uint32_t type = 0;
+    uint32_t id = 0;        ///< USB VID << 16 | PID
+    uint32_t location = 0;  ///< FT_OPEN_BY_LOCATION id (0 if the platform has none)
+    std::string serial;     ///< per interface, e.g. "FT5ZK1A" / "FT5ZK1B"
+    std::string description;
+};
+
+/// USB parameters of the FT4222H interfaces: D2XX FT_SetLatencyTimer,
+/// FT_SetUSBParameters (IN and OUT) and FT_SetTimeouts (read and write).
+/// 0 leaves the SDK's value.
+struct Ft4222hUsbTuning {
+    uint8_t latency_ms = 0;      ///< 2-255
+    uint32_t transfer_size = 0;  ///< USB request size, 64-65536, multiple of 64
+    uint32_t timeout_ms = 0;
+};
+
+/// Transfer mix of an Ft4222hDevice, the input of SelectUsbTuning().
+struct Ft4222hWorkload {
+    uint64_t small_transfers = 0;  ///< up to Ft4222hDevice::kSmallTransferBytes
+    uint64_t bulk_transfers = 0;
+    uint64_t bulk_bytes = 0;
+    uint64_t max_bytes = 0;  ///< largest single transfer
+};
+
+/// FTDI FT4222H: master writes on one interface, target responses received
+/// on the slave interface.
+///
+/// URI: ft4222h://<master>:<slave>, each a D2XX list index, `sn=<serial>`
+/// or `loc=<location id>`. Serial numbers and location ids survive
+/// reboots and other adapters coming and going; indices do not. Every
+/// interface is opened with FT_OpenEx: by serial or location directly, and
+/// an index through the location id in ListDevices(), which is enumerated
+/// once per process and shared by all instances rather than once per
+/// FT_Open.
+///
+/// SmBus block reads take the byte count and the block from the slave RX
+/// FIFO as they arrive, so a block read is one command write and one FIFO
+/// drain rather than a count read followed by a second command and read.
+///
+/// With the `spi_index` arg a third FT4222H interface is opened as SPI
+/// master (`spi_clock` Hz, `spi_mode` 0-3, `spi_cs` 0-3); without it the
+/// Spi calls fail with kNotSupported. Long transfers go out in
+/// kSpiChunkSize pieces under one chip select, straight from the caller's
+/// buffer, so the chip's USB endpoint buffers stay full. Dual/quad data
+/// phases run as SDK multi-I/O transactions; a multi-line read longer than
+/// one chunk is split into consecutive commands at advancing addresses.
+///
+/// Every interface gets its USB parameters right after it is opened. The
+/// `usb_tuning` arg picks a profile: `register` (default: 2 ms latency
+/// timer, so a short response is not held for the D2XX default 16 ms),
+/// `bulk` (16 ms, 64 KiB requests) or `default` (leave the SDK's values).
+/// `usb_latency_ms`, `usb_transfer_size` and `usb_timeout_ms` override
+/// single values and stay fixed across CalibrateUsb().
+class Ft4222hDevice final : public Device, public I2c, public SmBus, public Spi {
 public:
+    /// Bytes per SDK SPI call: 127 USB 2.0 high-speed bulk packets, the
+    /// most that fits the SDK's 16-bit transfer length.
+    static constexpr size_t kSpiChunkSize = 127 * 512;
+    /// Longest single-line phase of a multi-I/O transaction (SDK limit).
+    static constexpr size_t kSpiMaxMultiHeader = 15;
+    /// Transfers up to this many bytes count as register accesses.
+    static constexpr size_t kSmallTransferBytes = 64;
+
     explicit Ft4222hDevice(const config::DeviceEntry& entry);
+    /// `uri` is entry.uri already parsed (see DeviceFactory).
+    Ft4222hDevice(const config::DeviceEntry& entry, const config::DeviceUri& uri);
     ~Ft4222hDevice() override;
 
     // Device interface
@@ -25,7 +103,12 @@ public:
     std::string GetUri() const override;
     std::string GetDriverName() const override;
 
-    // I2c interface — GetDevice()
+    using Interfaces = InterfaceList<I2c, SmBus, Spi>;
+    void* QueryInterface(InterfaceKind kind) override {
+        return QueryInterfaceOf(this, kind, Interfaces{});
+    }
+
+    // I2c / SmBus / Spi interface — GetDevice()
     Device* GetDevice() override;
 
     // I2c interface
@@ -37,24 +120,111 @@ public:
                                    const core::Byte* write_data,
                                    size_t write_len, core::Byte* read_data,
                                    size_t read_len) override;
+    core::Result<size_t> Transfer(I2cMessage* msgs, size_t count) override;
     core::Result<void> SetBitrate(uint32_t bitrate) override;
     uint32_t GetBitrate() const override;
 
+    // SmBus interface
+    core::Result<size_t> Transact(core::Address addr, const core::Byte* write,
+                                  size_t write_len, core::Byte* read,
+                                  size_t read_len, bool block,
+                                  bool pec) override;
+
+    // Spi interface
+    core::Result<size_t> Exchange(const core::Byte* write, core::Byte* read,
+                                  size_t length, bool end = true) override;
+    core::Result<size_t> Command(const SpiCommand& command) override;
+    core::Result<void> SetClock(core::Frequency freq) override;
+    core::Frequency GetClock() const override;
+    core::Result<void> SetMode(SpiMode mode) override;
+
+    /// True while the slave RX wait is driven by SDK event notification
+    /// rather than polling (set by Open() when `rx_event` is enabled and the
+    /// SDK accepts FT4222_SetEventNotification).
+    bool IsRxEventActive() const;
+
     /// Register this driver with the DeviceFactory.
     static void Register();
 
+    /// The FTDI device list, enumerated on first use and shared by every
+    /// Ft4222hDevice; `refresh` enumerates again (e.g. after hot-plug).
+    /// kNotSupported without the SDK.
+    static core::Result<std::vector<FtdiDeviceInfo>> ListDevices(bool refresh = false);
+
+    /// FT_CreateDeviceInfoList calls made by ListDevices() so far.
+    static uint64_t EnumerationCount();
+
+    /// USB parameters suited to `mix` at I2C `bitrate`: the shortest latency
+    /// timer once register accesses are a tenth of the transfers, requests
+    /// sized to the average bulk transfer, and a timeout of 100 ms plus four
+    /// times the largest transfer's time on the I2C wire.
+    static Ft4222hUsbTuning SelectUsbTuning(const Ft4222hWorkload& mix, uint32_t bitrate);
+
+    /// USB parameters in effect (or applied by the next Open()).
+    Ft4222hUsbTuning GetUsbTuning() const;
+
+    /// Transfers made since Open() (SDK builds only).
+    Ft4222hWorkload GetWorkload() const;
+
+    /// Retune for `mix` (e.g. GetWorkload() after a representative run),
+    /// keeping values set by args, and apply the result to the open
+    /// interfaces between transfers. Returns the tuning now in effect.
+    core::Result<Ft4222hUsbTuning> CalibrateUsb(const Ft4222hWorkload& mix);
+
 private:
-    static bool ParseUri(const std::string& uri, uint16_t& master_idx,
-                         uint16_t& slave_idx);
+    /// One FT4222H interface, as named in the URI or `spi_index`.
+    struct Selector {
+        enum class Kind { kIndex, kSerial, kLocation };
+        Kind kind = Kind::kIndex;
+        uint32_t value = 0;  ///< list index or location id
+        std::string serial;
+
+        bool operator==(const Selector& other) const {
+            return kind == other.kind && value == other.value && serial == other.serial;
+        }
+        std::string ToString() const;
+    };
+
+    /// "<index>", "sn=<serial>" (1-15 chars) or "loc=<id>" (C number rules).
+    static bool ParseSelector(std::string_view text, Selector& out);
+    static bool ParseUri(const config::DeviceUri& uri, Selector& master, Selector& slave);
+
+    /// FT_OpenEx the interface; returns the FT_HANDLE (SDK builds only).
+    static core::Result<void*> OpenInterface(const Selector& selector);
+    /// FT_SetLatencyTimer / FT_SetUSBParameters / FT_SetTimeouts (SDK builds only).
+    static core::Result<void> ApplyUsbTuning(void* handle, const Ft4222hUsbTuning& tuning);
+
+    void CountTransfer(size_t bytes);
 
     core::Result<uint16_t> PollSlaveRx(size_t expected_len);
 
+    // SDK calls; caller holds i2c_queue_ (SDK builds only).
+    core::Result<size_t> MasterWriteLocked(core::Address addr,
+                                           const core::Byte* data,
+                                           size_t length, uint8_t flag);
+    core::Result<size_t> SlaveReadLocked(core::Byte* data, size_t length);
+    /// Count byte, then 1 + count (+ PEC) bytes in all, from the slave FIFO.
+    core::Result<size_t> SlaveBlockReadLocked(core::Byte* data, size_t capacity,
+                                              bool pec);
+
+    // SPI master; caller holds spi_queue_ (SDK builds only).
+    core::Result<void> SpiInitLocked();
+    core::Result<void> SpiSetLinesLocked(SpiLines lines);
+    core::Result<size_t> SpiExchangeLocked(const core::Byte* write,
+                                           core::Byte* read, size_t length,
+                                           bool end);
+    core::Result<size_t> SpiMultiReadLocked(const SpiCommand& command);
+    core::Result<size_t> SpiMultiWriteLocked(const SpiCommand& command,
+                                             const core::Byte* header,
+                                             size_t header_len);
+
     std::string name_;
     std::string uri_;
+    bool uri_valid_ = false;
     DeviceState state_;
 
-    uint16_t master_idx_;
-    uint16_t slave_idx_;
+    Selector master_;
+    Selector slave_;
 
     void* master_handle_;
     void* slave_handle_;
@@ -64,7 +234,25 @@ private:
     uint32_t sys_clock_;
     uint32_t rx_timeout_ms_;
     uint32_t rx_poll_interval_us_;
-    std::mutex i2c_mutex_;
+    bool rx_event_enabled_;
+    Ft4222hUsbTuning usb_tuning_;      // in effect
+    Ft4222hUsbTuning usb_pinned_;      // set by args; nonzero values win
+    mutable std::mutex workload_mutex_;
+    Ft4222hWorkload workload_;
+    std::unique_ptr<Ft4222hRxEvent> rx_event_;  // null = polling fallback
+    core::IoQueue i2c_queue_{"ft4222h.i2c"};  // one transaction at a time, foreground first
+
+    bool spi_enabled_ = false;  // `spi_index` configured
+    Selector spi_;
+    void* spi_handle_ = nullptr;
+    uint8_t spi_clock_div_ = 1;  // SDK FT4222_SPIClock: sys clock / 2^div
+    SpiMode spi_mode_ = SpiMode::kMode0;
+    uint8_t spi_cs_ = 0;
+    SpiLines spi_lines_ = SpiLines::kSingle;  // lines the chip is set to
+    std::vector<core::Byte> spi_staging_;     // multi-I/O write: header + data
+    core::IoQueue spi_queue_{"ft4222h.spi"};
+    DeviceMetrics* metrics_;  // MetricsRegistry entry, assigned in Open()
+    uint16_t trace_id_;       // log::Tracer device id, assigned in Open()
 };
 
 }  // namespace plas::hal::driver
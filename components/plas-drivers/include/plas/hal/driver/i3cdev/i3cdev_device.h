@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_interfaces.h"
+#include "plas/hal/interface/i3c.h"
+#include "plas/hal/interface/i3c_target_table.h"
+#include "plas/config/device_entry.h"
+#include "plas/config/device_uri.h"
+
+namespace plas::hal::driver {
+
+/// I3C controller driven by the Linux I3C subsystem. The kernel controller
+/// driver runs ENTDAA when the bus comes up; Open() reads the resulting
+/// dynamic address table (PID/BCR/DCR per target) from sysfs once and
+/// answers GETPID/GETBCR/GETDCR from that cache. Private SDR transfers go
+/// through the i3cdev character devices (built only when
+/// <linux/i3c/i3cdev.h> is available, kNotSupported otherwise).
+///
+/// URI: i3cdev://bus:target — `bus` is the kernel bus number, `target`
+/// is `all` or one 48-bit PID in hex to expose a single target.
+///
+/// Optional DeviceEntry args:
+///   sysfs_root — I3C sysfs device directory (default /sys/bus/i3c/devices)
+///   dev_root   — i3cdev node directory (default /dev/bus/i3c)
+class I3cDevDevice final : public Device, public I3c {
+public:
+    explicit I3cDevDevice(const config::DeviceEntry& entry);
+    /// `uri` is entry.uri already parsed (see DeviceFactory).
+    I3cDevDevice(const config::DeviceEntry& entry, const config::DeviceUri& uri);
+    ~I3cDevDevice() override;
+
+    // Device interface
+    core::Result<void> Init() override;
+    core::Result<void> Open() override;
+    core::Result<void> Close() override;
+    core::Result<void> Reset() override;
+    DeviceState GetState() const override;
+    std::string GetName() const override;
+    std::string GetUri() const override;
+    std::string GetDriverName() const override;
+
+    using Interfaces = InterfaceList<I3c>;
+    void* QueryInterface(InterfaceKind kind) override {
+        return QueryInterfaceOf(this, kind, Interfaces{});
+    }
+
+    // I3c interface — GetDevice()
+    Device* GetDevice() override;
+
+    // I3c interface. A Write() with stop=false is held and sent together
+    // with the next transfer to the same target (repeated START).
+    core::Result<size_t> Read(core::Address addr, core::Byte* data,
+                              size_t length, bool stop = true) override;
+    core::Result<size_t> Write(core::Address addr, const core::Byte* data,
+                               size_t length, bool stop = true) override;
+    /// ENTDAA rescans sysfs for targets the kernel added since Open();
+    /// other broadcast CCCs are owned by the kernel (kNotSupported).
+    core::Result<void> SendBroadcastCcc(uint8_t ccc_id, const core::Byte* data,
+                                        size_t length) override;
+    core::Result<void> SendDirectCcc(uint8_t ccc_id, core::Address addr,
+                                     const core::Byte* data,
+                                     size_t length) override;
+    /// Answered from the target table; no bus traffic.
+    core::Result<size_t> RecvDirectCcc(uint8_t ccc_id, core::Address addr,
+                                       core::Byte* data, size_t length) override;
+    /// kNotSupported: the kernel sets the SCL rates when the bus probes.
+    core::Result<void> SetFrequency(core::Frequency freq) override;
+
+    core::Result<std::vector<I3cTargetInfo>> GetTargets() override;
+    core::Result<size_t> AssignDynamicAddresses() override;
+
+    /// SDR SCL rate the kernel reports for the bus (0 if unknown).
+    core::Frequency GetFrequency() const;
+
+    /// Register this driver with the DeviceFactory.
+    static void Register();
+
+private:
+    static bool ParseUri(const config::DeviceUri& uri, uint32_t& bus,
+                         bool& all_targets, uint64_t& pid);
+
+    /// Add targets found under sysfs_root_ that are not cached yet.
+    core::Result<size_t> ScanLocked();
+    /// Private transfer to one target, preceded by its held write if any.
+    core::Result<size_t> TransferLocked(core::Address addr, core::Byte* data,
+                                        size_t length, bool read);
+    core::Result<int> TargetFdLocked(const I3cTargetInfo& target);
+    void CloseFdsLocked();
+
+    std::string name_;
+    std::string uri_;
+    bool uri_valid_ = false;
+    DeviceState state_;
+
+    uint32_t bus_;
+    bool all_targets_;
+    uint64_t pid_;
+    std::string sysfs_root_;
+    std::string dev_root_;
+    core::Frequency frequency_;
+
+    I3cTargetTable targets_;
+    std::mutex i3c_mutex_;
+    std::map<uint64_t, int> fds_;        // PID -> open i3cdev node
+    core::Address held_addr_ = 0;         // pending stop=false write
+    std::vector<core::Byte> held_write_;
+};
+
+}  // namespace plas::hal::driver
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::driver {
+
+/// Config-space images of many PCI functions plus canned DOE responses,
+/// for analysing captured systems offline (see ConfigImageDevice). A bundle
+/// is immutable once loaded, so any number of threads may read it.
+///
+/// Two file forms are accepted:
+///
+/// - Text: `lspci -x` / `-xxx` / `-xxxx` output for any number of functions.
+///   A line starting with "[DDDD:]BB:DD.F " begins a function (domain 0 if
+///   omitted); "off: hh hh ..." rows fill its image, which is as long as
+///   its highest row. DOE responses follow their function as
+///   `doe OFF VVVV:TT REQ... -> RSP...` (hex; DOE capability offset,
+///   protocol, request and response payload DWords). Unrecognised lines
+///   are skipped and a repeated address keeps its first image.
+/// - Binary: written by Save(). Load() maps it and serves the images in
+///   place, so opening a large fleet bundle costs no parsing or copying.
+///   The format is native-endian; it is not meant to move between hosts
+///   of different byte order.
+class ConfigImageBundle {
+public:
+    /// One function's image: `size` bytes (at most kConfigSpaceSize) from
+    /// offset 0, and its canned DOE responses DoeAt(doe_begin) onwards.
+    /// Points into the bundle.
+    struct Function {
+        pci::PciAddress address{};
+        const core::Byte* config = nullptr;
+        std::size_t size = 0;
+        std::size_t doe_begin = 0;
+        std::size_t doe_count = 0;
+    };
+
+    /// A canned DOE exchange. Payloads are little-endian DWords inside the
+    /// bundle; use RequestDWord()/ResponseDWord().
+    struct DoeResponse {
+        pci::ConfigOffset doe_offset = 0;
+        pci::DoeProtocolId protocol{0, 0};
+        const core::Byte* request = nullptr;
+        std::size_t request_dwords = 0;
+        const core::Byte* response = nullptr;
+        std::size_t response_dwords = 0;
+
+        core::DWord RequestDWord(std::size_t i) const { return Load(request, i); }
+        core::DWord ResponseDWord(std::size_t i) const { return Load(response, i); }
+
+    private:
+        static core::DWord Load(const core::Byte* p, std::size_t i) {
+            p += 4 * i;
+            return static_cast<core::DWord>(p[0]) | (static_cast<core::DWord>(p[1]) << 8) |
+                   (static_cast<core::DWord>(p[2]) << 16) |
+                   (static_cast<core::DWord>(p[3]) << 24);
+        }
+    };
+
+    ~ConfigImageBundle();
+
+    ConfigImageBundle(const ConfigImageBundle&) = delete;
+    ConfigImageBundle& operator=(const ConfigImageBundle&) = delete;
+
+    /// Map a binary bundle, or parse a text one. kNotFound if the file
+    /// cannot be read, kDataLoss for a damaged binary bundle or text
+    /// without any function.
+    static core::Result<std::shared_ptr<const ConfigImageBundle>> Load(
+        const std::string& path);
+
+    /// Parse the text form. Never fails: malformed input yields whatever
+    /// functions could be recognised, possibly none.
+    static std::shared_ptr<const ConfigImageBundle> ParseText(std::string_view text);
+
+    /// Write the binary form; kIOError if the file cannot be written.
+    core::Result<void> Save(const std::string& path) const;
+
+    /// Functions in address order (domain, then Bdf::Pack()).
+    std::size_t FunctionCount() const { return function_count_; }
+    Function FunctionAt(std::size_t index) const;
+
+    /// Binary search for `address`.
+    std::optional<Function> Find(pci::PciAddress address) const;
+
+    /// Canned DOE responses of all functions; each function's are
+    /// contiguous and in file order.
+    std::size_t DoeCount() const { return doe_count_; }
+    DoeResponse DoeAt(std::size_t index) const;
+
+    /// Bytes the bundle occupies: the mapping, or the parsed buffer.
+    std::size_t SizeBytes() const { return size_; }
+
+    /// True when served from a file mapping rather than a parsed buffer.
+    bool IsMapped() const { return mapping_ != nullptr; }
+
+private:
+    struct Header;
+    struct FunctionRecord;
+    struct DoeRecord;
+
+    ConfigImageBundle() = default;
+
+    /// Check the header and every record of `size` bytes at `base` and
+    /// point the accessors at them.
+    bool Attach(const char* base, std::size_t size);
+    const FunctionRecord* FindRecord(pci::PciAddress address) const;
+    Function MakeFunction(const FunctionRecord& record) const;
+
+    std::vector<uint64_t> owned_;  // parsed text in binary form
+    void* mapping_ = nullptr;      // or a mapped binary file
+    const char* base_ = nullptr;
+    std::size_t size_ = 0;
+
+    const FunctionRecord* functions_ = nullptr;
+    std::size_t function_count_ = 0;
+    const DoeRecord* doe_records_ = nullptr;
+    std::size_t doe_count_ = 0;
+    const core::Byte* data_ = nullptr;
+};
+
+}  // namespace plas::hal::driver
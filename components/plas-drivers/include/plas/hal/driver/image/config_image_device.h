@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/config/device_uri.h"
+#include "plas/core/error.h"
+#include "plas/hal/driver/image/config_image_bundle.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_interfaces.h"
+#include "plas/hal/interface/pci/cxl.h"
+#include "plas/hal/interface/pci/cxl_dvsec.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+
+namespace plas::hal::driver {
+
+/// Read-only PCI domain served from a ConfigImageBundle, so capability,
+/// DVSEC and DOE code can run against captured systems with no hardware.
+/// Every function of the domain in the bundle is reachable by its Bdf.
+///
+/// URI: image://pci:DDDD — PCI domain (hex)
+///
+/// Required DeviceEntry args:
+///   bundle — bundle file, text or binary (shared by every device using it)
+///
+/// Reads follow SimPciDevice: misaligned or out-of-range offsets fail with
+/// kInvalidArgument, a Bdf missing from the bundle reads all-ones and bytes
+/// past a function's image read 0. Writes fail with kNotSupported. DOE
+/// exchanges answer from the canned responses whose offset, protocol and
+/// request match exactly (kNotFound otherwise); Discovery is answered from
+/// the protocols with canned responses at that offset. Cxl calls decode
+/// the image on each call.
+///
+/// Reads take no lock, so one device can be shared by any number of
+/// analysis threads.
+class ConfigImageDevice final : public Device,
+                                public pci::PciConfig,
+                                public pci::PciDoe,
+                                public pci::Cxl {
+public:
+    /// `uri` is entry.uri already parsed (see DeviceFactory). The bundle is
+    /// loaded by Init().
+    ConfigImageDevice(const config::DeviceEntry& entry, const config::DeviceUri& uri);
+
+    /// Serve `domain` of an already loaded bundle.
+    ConfigImageDevice(const config::DeviceEntry& entry,
+                      std::shared_ptr<const ConfigImageBundle> bundle, uint16_t domain);
+
+    ~ConfigImageDevice() override;
+
+    // Device interface
+    core::Result<void> Init() override;
+    core::Result<void> Open() override;
+    core::Result<void> Close() override;
+    core::Result<void> Reset() override;
+    DeviceState GetState() const override;
+    std::string GetName() const override;
+    std::string GetUri() const override;
+    std::string GetDriverName() const override;
+    std::size_t MemoryUsage() const override;
+
+    using Interfaces = InterfaceList<pci::PciConfig, pci::PciDoe, pci::Cxl>;
+    void* QueryInterface(InterfaceKind kind) override {
+        return QueryInterfaceOf(this, kind, Interfaces{});
+    }
+
+    // PciConfig / PciDoe / Cxl interface — GetDevice()
+    Device* GetDevice() override;
+
+    // PciConfig interface
+    core::Result<core::Byte> ReadConfig8(pci::Bdf bdf, pci::ConfigOffset offset) override;
+    core::Result<core::Word> ReadConfig16(pci::Bdf bdf, pci::ConfigOffset offset) override;
+    core::Result<core::DWord> ReadConfig32(pci::Bdf bdf, pci::ConfigOffset offset) override;
+    core::Result<void> WriteConfig8(pci::Bdf bdf, pci::ConfigOffset offset,
+                                    core::Byte value) override;
+    core::Result<void> WriteConfig16(pci::Bdf bdf, pci::ConfigOffset offset,
+                                     core::Word value) override;
+    core::Result<void> WriteConfig32(pci::Bdf bdf, pci::ConfigOffset offset,
+                                     core::DWord value) override;
+    core::Result<std::optional<pci::ConfigOffset>> FindCapability(
+        pci::Bdf bdf, pci::CapabilityId id) override;
+    core::Result<std::optional<pci::ConfigOffset>> FindExtCapability(
+        pci::Bdf bdf, pci::ExtCapabilityId id) override;
+    core::Result<void> ReadConfigBlock(pci::Bdf bdf, pci::ConfigOffset offset,
+                                       core::Byte* buffer, std::size_t length) override;
+    core::Result<pci::CapabilityIndex> GetCapabilityIndex(pci::Bdf bdf) override;
+
+    // PciDoe interface
+    core::Result<std::vector<pci::DoeProtocolId>> DoeDiscover(
+        pci::Bdf bdf, pci::ConfigOffset doe_offset) override;
+    core::Result<pci::DoePayload> DoeExchange(
+        pci::Bdf bdf, pci::ConfigOffset doe_offset, pci::DoeProtocolId protocol,
+        const pci::DoePayload& request) override;
+    core::Result<std::size_t> DoeExchangeInto(
+        pci::Bdf bdf, pci::ConfigOffset doe_offset, pci::DoeProtocolId protocol,
+        const core::DWord* request, std::size_t request_len, core::DWord* response,
+        std::size_t response_capacity) override;
+
+    // Cxl interface
+    core::Result<std::vector<pci::DvsecHeader>> EnumerateCxlDvsecs(pci::Bdf bdf) override;
+    core::Result<std::optional<pci::DvsecHeader>> FindCxlDvsec(
+        pci::Bdf bdf, pci::CxlDvsecId dvsec_id) override;
+    core::Result<pci::CxlDeviceType> GetCxlDeviceType(pci::Bdf bdf) override;
+    core::Result<std::vector<pci::RegisterBlockEntry>> GetRegisterBlocks(
+        pci::Bdf bdf) override;
+    core::Result<core::DWord> ReadDvsecRegister(pci::Bdf bdf, pci::ConfigOffset dvsec_offset,
+                                                uint16_t reg_offset) override;
+    core::Result<void> WriteDvsecRegister(pci::Bdf bdf, pci::ConfigOffset dvsec_offset,
+                                          uint16_t reg_offset, core::DWord value) override;
+
+    /// The bundle being served; null before Init().
+    std::shared_ptr<const ConfigImageBundle> GetBundle() const;
+    uint16_t GetDomain() const { return domain_; }
+
+private:
+    using Function = ConfigImageBundle::Function;
+
+    /// The function at `bdf` of an open device: kNotInitialized unless
+    /// open, nullopt if the bundle lacks it.
+    core::Result<std::optional<Function>> Lookup(pci::Bdf bdf) const;
+    /// Lookup() that fails with kNotFound for a missing function.
+    core::Result<Function> Require(pci::Bdf bdf) const;
+    core::Result<pci::CxlDvsecIndex> CxlIndex(pci::Bdf bdf) const;
+    /// Discovery first, then the protocols with canned responses at
+    /// `doe_offset`; kNotFound if that is neither a DOE capability nor used
+    /// by any response.
+    core::Result<std::vector<pci::DoeProtocolId>> Protocols(
+        const Function& function, pci::ConfigOffset doe_offset) const;
+    /// The answer to one exchange; a Discovery answer is built in `scratch`.
+    core::Result<ConfigImageBundle::DoeResponse> Respond(
+        pci::Bdf bdf, pci::ConfigOffset doe_offset, pci::DoeProtocolId protocol,
+        const core::DWord* request, std::size_t request_len, core::Byte (&scratch)[4]) const;
+    template <typename T>
+    core::Result<T> Read(pci::Bdf bdf, pci::ConfigOffset offset) const;
+    template <typename Id>
+    core::Result<std::optional<pci::ConfigOffset>> Find(pci::Bdf bdf, Id id) const;
+
+    const std::string name_;
+    const std::string uri_;
+    std::string bundle_path_;
+    uint16_t domain_ = 0;
+    bool uri_valid_ = false;
+
+    mutable std::mutex mutex_;  // lifecycle only; reads go through state_
+    std::atomic<DeviceState> state_{DeviceState::kUninitialized};
+    std::shared_ptr<const ConfigImageBundle> bundle_;  // set once, before the first Open()
+};
+
+}  // namespace plas::hal::driver
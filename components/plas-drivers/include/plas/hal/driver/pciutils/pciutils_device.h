@@ -1,36 +1,74 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "plas/config/device_entry.h"
+#include "plas/config/device_uri.h"
+#include "plas/core/io_queue.h"
+#include "plas/core/lock_stats.h"
 #include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_interfaces.h"
+#include "plas/hal/interface/pci/bar_resource.h"
+#include "plas/hal/interface/pci/cxl.h"
+#include "plas/hal/interface/pci/cxl_dvsec.h"
+#include "plas/hal/interface/pci/cxl_mailbox.h"
+#include "plas/hal/interface/pci/cxl_mmio_mailbox.h"
+#include "plas/hal/interface/pci/mmio_window.h"
 #include "plas/hal/interface/pci/pci_bar.h"
 #include "plas/hal/interface/pci/pci_config.h"
 #include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/metrics.h"
 
 // Forward-declare libpci types to keep the header free of pci/pci.h.
-struct pci_access;
 struct pci_dev;
 
 namespace plas::hal::driver {
 
+struct PciUtilsAccess;  // defined in pciutils_device.cpp
+
 /// PCI config-space driver backed by the system libpci (pciutils).
 ///
 /// URI format: pciutils://DDDD:BB:DD.F
 ///
+/// Devices that select the same access method share one libpci context
+/// (and its register lock), whatever their domain. The PciAddress config
+/// overloads reach any function in any domain through it, so one device
+/// can serve every PCI segment.
+///
 /// Optional DeviceEntry args:
 ///   doe_timeout_ms      — DOE mailbox timeout in milliseconds (default 1000)
-///   doe_poll_interval_us — DOE polling interval in microseconds (default 100)
-class PciUtilsDevice : public Device,
+///   doe_poll_interval_us — max DOE polling interval in microseconds (default 100)
+///   doe_spin_us         — busy-poll window before backing off (default 20)
+///   wc_bars             — comma-separated BAR indices to map write-combining
+///                         (resourceN_wc); non-prefetchable BARs stay uncached
+///   map_bars_on_open    — "true" to mmap every memory BAR in Open() instead
+///                         of on first access (default false)
+///   mailbox_timeout_ms  — CXL mailbox doorbell timeout (default 2000)
+///   scan_on_open        — "true" to run one libpci bus scan in Open() and
+///                         serve pci_dev handles, capability lookups and BAR
+///                         sizes from it (default false)
+///   access_method       — libpci access method by its libpci name, e.g.
+///                         "linux-sysfs", "ecam", "intel-conf1" (default
+///                         "auto": libpci's own choice)
+class PciUtilsDevice final : public Device,
                        public pci::PciConfig,
                        public pci::PciDoe,
-                       public pci::PciBar {
+                       public pci::PciBar,
+                       public pci::Cxl,
+                       public pci::CxlMailbox {
 public:
     explicit PciUtilsDevice(const config::DeviceEntry& entry);
+    /// `uri` is entry.uri already parsed (see DeviceFactory).
+    PciUtilsDevice(const config::DeviceEntry& entry, const config::DeviceUri& uri);
     ~PciUtilsDevice() override;
 
     // -- Device interface -----------------------------------------------------
@@ -42,8 +80,17 @@ public:
     std::string GetName() const override;
     std::string GetUri() const override;
     std::string GetDriverName() const override;
+    /// The object, its strings and lookup caches; mapped BARs are not heap.
+    /// The bus-scan table is read without a lock, as lookups read it.
+    std::size_t MemoryUsage() const override;
 
-    // PciConfig/PciDoe/PciBar interfaces — GetDevice() (one impl satisfies all)
+    using Interfaces = InterfaceList<pci::PciConfig, pci::PciDoe, pci::PciBar, pci::Cxl,
+                                     pci::CxlMailbox>;
+    void* QueryInterface(InterfaceKind kind) override {
+        return QueryInterfaceOf(this, kind, Interfaces{});
+    }
+
+    // PCI/CXL interfaces — GetDevice() (one impl satisfies all)
     plas::hal::Device* GetDevice() override;
 
     // -- PciConfig interface --------------------------------------------------
@@ -59,10 +106,42 @@ public:
                                      core::Word value) override;
     core::Result<void> WriteConfig32(pci::Bdf bdf, pci::ConfigOffset offset,
                                      core::DWord value) override;
+    /// One libpci lock acquisition for the whole batch.
+    std::size_t WriteConfigBatch(pci::Bdf bdf, const pci::ConfigWrite* writes,
+                                 std::size_t count,
+                                 std::error_code* status) override;
     core::Result<std::optional<pci::ConfigOffset>> FindCapability(
         pci::Bdf bdf, pci::CapabilityId id) override;
     core::Result<std::optional<pci::ConfigOffset>> FindExtCapability(
         pci::Bdf bdf, pci::ExtCapabilityId id) override;
+    core::Result<void> ReadConfigBlock(pci::Bdf bdf, pci::ConfigOffset offset,
+                                       core::Byte* buffer,
+                                       std::size_t length) override;
+    core::Result<std::vector<core::Byte>> SnapshotConfig(
+        pci::Bdf bdf) override;
+    core::Result<pci::CapabilityIndex> GetCapabilityIndex(
+        pci::Bdf bdf) override;
+
+    // -- Any domain -----------------------------------------------------------
+    // The PciConfig accessors for a function in any domain, through the
+    // shared libpci context. The Bdf overloads use the URI's domain.
+    core::Result<core::Byte> ReadConfig8(const pci::PciAddress& addr,
+                                         pci::ConfigOffset offset);
+    core::Result<core::Word> ReadConfig16(const pci::PciAddress& addr,
+                                          pci::ConfigOffset offset);
+    core::Result<core::DWord> ReadConfig32(const pci::PciAddress& addr,
+                                           pci::ConfigOffset offset);
+    core::Result<void> WriteConfig8(const pci::PciAddress& addr,
+                                    pci::ConfigOffset offset, core::Byte value);
+    core::Result<void> WriteConfig16(const pci::PciAddress& addr,
+                                     pci::ConfigOffset offset,
+                                     core::Word value);
+    core::Result<void> WriteConfig32(const pci::PciAddress& addr,
+                                     pci::ConfigOffset offset,
+                                     core::DWord value);
+    core::Result<void> ReadConfigBlock(const pci::PciAddress& addr,
+                                       pci::ConfigOffset offset,
+                                       core::Byte* buffer, std::size_t length);
 
     // -- PciDoe interface -----------------------------------------------------
     core::Result<std::vector<pci::DoeProtocolId>> DoeDiscover(
@@ -71,6 +150,11 @@ public:
         pci::Bdf bdf, pci::ConfigOffset doe_offset,
         pci::DoeProtocolId protocol,
         const pci::DoePayload& request) override;
+    core::Result<std::size_t> DoeExchangeInto(
+        pci::Bdf bdf, pci::ConfigOffset doe_offset,
+        pci::DoeProtocolId protocol, const core::DWord* request,
+        std::size_t request_len, core::DWord* response,
+        std::size_t response_capacity) override;
 
     // -- PciBar interface -----------------------------------------------------
     core::Result<core::DWord> BarRead32(pci::Bdf bdf, uint8_t bar_index,
@@ -89,57 +173,255 @@ public:
     core::Result<void> BarWriteBuffer(pci::Bdf bdf, uint8_t bar_index,
                                        uint64_t offset, const void* buffer,
                                        std::size_t length) override;
+    core::Result<void> SetBarMapping(pci::Bdf bdf, uint8_t bar_index,
+                                     pci::BarMapping mapping) override;
+    core::Result<void> BarFlush(pci::Bdf bdf, uint8_t bar_index) override;
+
+    // -- Cxl interface --------------------------------------------------------
+    // DVSEC headers, Register Locator entries and the device type are parsed
+    // with the capability index and cached per Bdf alongside it.
+    core::Result<std::vector<pci::DvsecHeader>> EnumerateCxlDvsecs(
+        pci::Bdf bdf) override;
+    core::Result<std::optional<pci::DvsecHeader>> FindCxlDvsec(
+        pci::Bdf bdf, pci::CxlDvsecId dvsec_id) override;
+    core::Result<pci::CxlDeviceType> GetCxlDeviceType(pci::Bdf bdf) override;
+    core::Result<std::vector<pci::RegisterBlockEntry>> GetRegisterBlocks(
+        pci::Bdf bdf) override;
+    core::Result<core::DWord> ReadDvsecRegister(
+        pci::Bdf bdf, pci::ConfigOffset dvsec_offset,
+        uint16_t reg_offset) override;
+    core::Result<void> WriteDvsecRegister(pci::Bdf bdf,
+                                          pci::ConfigOffset dvsec_offset,
+                                          uint16_t reg_offset,
+                                          core::DWord value) override;
+
+    // -- CxlMailbox interface -------------------------------------------------
+    // Primary Mailbox over this device's BARs, located once per Bdf.
+    core::Result<pci::CxlMailboxResult> ExecuteCommand(
+        pci::Bdf bdf, pci::CxlMailboxOpcode opcode,
+        const pci::CxlMailboxPayload& payload) override;
+    core::Result<pci::CxlMailboxResult> ExecuteCommand(
+        pci::Bdf bdf, uint16_t raw_opcode,
+        const pci::CxlMailboxPayload& payload) override;
+    /// Header and data are written straight into the payload registers.
+    core::Result<pci::CxlMailboxResult> ExecuteCommandGather(
+        pci::Bdf bdf, uint16_t raw_opcode, const uint8_t* header,
+        std::size_t header_len, const uint8_t* data,
+        std::size_t data_len) override;
+    /// The output payload is read straight into the pooled buffer.
+    core::Result<pci::CxlMailboxPooledResult> ExecuteCommandPooled(
+        pci::Bdf bdf, uint16_t raw_opcode, const uint8_t* payload,
+        std::size_t length) override;
+    core::Result<uint32_t> GetPayloadSize(pci::Bdf bdf) override;
+    core::Result<bool> IsReady(pci::Bdf bdf) override;
+    /// return_code is kBackgroundCmdStarted while the command runs, then
+    /// its completion code; payload holds the raw 8-byte Background Command
+    /// Status register (little endian).
+    core::Result<pci::CxlMailboxResult> GetBackgroundCmdStatus(
+        pci::Bdf bdf) override;
+
+    /// The mailbox behind the CxlMailbox calls for `bdf`, for the
+    /// non-blocking Submit()/TryComplete() and GetBackgroundStatus().
+    /// Dropped on Close and on a PciTopology generation change; the shared
+    /// pointer keeps a handed-out mailbox usable until the device closes.
+    core::Result<std::shared_ptr<pci::CxlMmioMailbox>> GetCxlMailbox(
+        pci::Bdf bdf);
+
+    /// Map every implemented memory BAR now, so the first BAR access in a
+    /// timed region does not pay for open+mmap. Returns the first error.
+    core::Result<void> MapAllBars();
+
+    /// Map `bar_index` now and return it as an MmioWindow for unchecked
+    /// inline accesses (pci/mmio_window.h). The window is invalidated by
+    /// Close(), SetBarMapping() on that BAR and a PciTopology remove or
+    /// rescan. kNotInitialized unless open.
+    core::Result<pci::MmioWindow> GetBarWindow(uint8_t bar_index);
+
+    /// One function found by the scan_on_open bus scan.
+    struct ScannedFunction {
+        pci::PciAddress address{};
+        uint16_t vendor_id = 0;
+        uint16_t device_id = 0;
+        uint16_t device_class = 0;  ///< base class << 8 | subclass
+        pci::BarResources bars{};   ///< empty if libpci had no BAR sizes
+    };
+
+    /// True while the Open() bus scan is in effect (scan_on_open set and
+    /// no PciTopology remove/rescan since).
+    bool IsScanned() const;
+
+    /// Every function in every domain from the bus scan, in libpci list
+    /// order; empty without scan_on_open or before Open().
+    std::vector<ScannedFunction> GetScannedFunctions() const;
+
+    /// DOE response latency counters, measured from GO to Data Object Ready.
+    struct DoeStats {
+        uint64_t exchanges = 0;  ///< completed exchanges (incl. discovery)
+        uint64_t timeouts = 0;   ///< exchanges past doe_timeout_ms or the deadline
+        uint64_t last_us = 0;
+        uint64_t min_us = 0;
+        uint64_t max_us = 0;
+        uint64_t total_us = 0;
+    };
+
+    /// Snapshot of the DOE latency counters since Open() or ResetDoeStats().
+    DoeStats GetDoeStats() const;
+    void ResetDoeStats();
 
     /// Self-register with DeviceFactory under driver name "pciutils".
     static void Register();
 
 private:
-    // RAII wrapper for pci_dev* obtained via pci_get_dev().
+    // Frees a pci_dev obtained via pci_get_dev(); keeps its libpci context
+    // alive until then.
     struct PciDevDeleter {
+        std::shared_ptr<PciUtilsAccess> access;
         void operator()(pci_dev* d) const;
     };
-    using PciDevPtr = std::unique_ptr<pci_dev, PciDevDeleter>;
+    using PciDevPtr = std::shared_ptr<pci_dev>;
 
-    /// Create a PciDevPtr for the given BDF within our domain.
+    /// Return the cached pci_dev for the given BDF within our domain,
+    /// creating it on first use. Hold the returned handle for the whole
+    /// access: a PciTopology remove/rescan drops the cached handles, and
+    /// each is freed once the last access through it returns. Scanned
+    /// functions come back as non-owning handles (libpci owns them).
     PciDevPtr GetPciDev(pci::Bdf bdf);
+    PciDevPtr GetPciDev(const pci::PciAddress& addr);
+
+    /// Drop all cached pci_dev handles.
+    void ClearPciDevCache();
+
+    /// Scan the bus and fill IDs, class, BARs and both capability lists for
+    /// every function, once per shared context. Called from Open() with
+    /// scan_on_open.
+    void ScanBus();
+
+    /// The scanned pci_dev for `addr`, or nullptr if there was no scan, the
+    /// function was not found, or the topology changed since. libpci owns
+    /// scanned devices; pci_cleanup() frees them.
+    pci_dev* ScannedPciDev(const pci::PciAddress& addr) const;
+
+    /// Return the cached capability index for `bdf`, building it from the
+    /// scanned capability lists if available, else from one config
+    /// snapshot on first use. Caller must hold cap_cache_mutex_.
+    core::Result<const pci::CapabilityIndex*> EnsureCapabilityIndex(
+        pci::Bdf bdf);
+
+    /// Return the cached CXL DVSEC index for `bdf` (built together with a
+    /// snapshot capability index, or from a snapshot on first use when the
+    /// index came from the scan). Caller must hold cap_cache_mutex_.
+    core::Result<const pci::CxlDvsecIndex*> EnsureCxlDvsecIndex(pci::Bdf bdf);
+
+    /// Drop all cached capability and CXL DVSEC indexes.
+    void ClearCapabilityIndexCache();
+
+    /// Drop all located CXL mailboxes.
+    void ClearCxlMailboxCache();
 
     /// Parse a "pciutils://DDDD:BB:DD.F" URI.
-    static bool ParseUri(const std::string& uri, uint16_t& domain,
+    static bool ParseUri(const config::DeviceUri& uri, uint16_t& domain,
                          uint8_t& bus, uint8_t& device, uint8_t& function);
 
     // DOE helpers
+    /// Per-(bdf, doe_offset) I/O queue, one exchange per turn with
+    /// foreground callers first; exchanges on different mailboxes run
+    /// concurrently. Entries live until the device is destroyed.
+    core::IoQueue& DoeMailboxQueue(pci::Bdf bdf, pci::ConfigOffset doe_offset);
+    uint32_t DoeReadReg(pci_dev* dev, pci::ConfigOffset offset);
+    void DoeWriteReg(pci_dev* dev, pci::ConfigOffset offset, uint32_t value);
     core::Result<void> DoeAbort(pci_dev* dev, pci::ConfigOffset doe_offset);
     core::Result<bool> DoePollReady(pci_dev* dev,
                                     pci::ConfigOffset doe_offset);
-    core::Result<void> DoeWriteMailbox(pci_dev* dev,
-                                       pci::ConfigOffset doe_offset,
-                                       const pci::DoePayload& payload);
+    void RecordDoeLatency(uint64_t latency_us);
+    core::Result<void> DoeWriteObject(pci_dev* dev,
+                                      pci::ConfigOffset doe_offset,
+                                      pci::DoeProtocolId protocol,
+                                      const core::DWord* payload,
+                                      std::size_t payload_len);
+    /// Abort-if-busy, write the request object, set GO and wait for Ready.
+    core::Result<void> DoeSubmit(pci_dev* dev, pci::ConfigOffset doe_offset,
+                                 pci::DoeProtocolId protocol,
+                                 const core::DWord* payload,
+                                 std::size_t payload_len);
+    /// Consume the 2-DWord response header; returns the payload length.
+    core::Result<std::size_t> DoeReadHeader(pci_dev* dev,
+                                            pci::ConfigOffset doe_offset);
     core::Result<pci::DoePayload> DoeReadMailbox(pci_dev* dev,
                                                   pci::ConfigOffset doe_offset);
+    core::Result<std::size_t> DoeReadMailboxInto(pci_dev* dev,
+                                                 pci::ConfigOffset doe_offset,
+                                                 core::DWord* out,
+                                                 std::size_t capacity);
 
     // BAR mmap helpers
     struct MappedBar {
         int fd = -1;
         void* base = nullptr;
         uint64_t size = 0;
+        pci::BarMapping mapping = pci::BarMapping::kUncached;
     };
+    /// Mapped BAR `bar_index`; lock-free once mapped.
     core::Result<MappedBar*> EnsureBarMapped(uint8_t bar_index);
-    uint64_t GetBarSize(uint8_t bar_index);
+    /// Map `bar_index` if not already mapped. Caller must hold bar_mutex_.
+    core::Result<MappedBar*> EnsureBarMappedLocked(uint8_t bar_index);
+    /// BAR ranges from the scan if libpci filled sizes and flags, else the
+    /// parsed sysfs `resource`, read once and re-read only after a
+    /// PciTopology remove/rescan. Caller must hold bar_mutex_.
+    const pci::BarResources& BarResourcesLocked();
+    /// Requested mapping for `bar_index`. Caller must hold bar_mutex_.
+    pci::BarMapping RequestedBarMapping(uint8_t bar_index) const;
+    /// Unpublish and unmap `bar_index`. Caller must hold bar_mutex_.
+    void UnmapBarLocked(uint8_t bar_index);
     void UnmapAllBars();
 
     std::string name_;
     std::string uri_;
+    bool uri_valid_ = false;
     DeviceState state_;
     uint16_t domain_;
     uint8_t bus_;
     uint8_t device_num_;
     uint8_t function_;
-    pci_access* pacc_;
+    std::string access_method_;
+    // Shared per access method; Close() drops this device's reference.
+    std::shared_ptr<PciUtilsAccess> access_;
+    std::unordered_map<uint32_t, PciDevPtr> dev_cache_;  // key: domain << 16 | Bdf::Pack()
+    uint64_t dev_cache_generation_;  // PciTopology generation at fill time
+    mutable std::mutex dev_cache_mutex_;
+    bool scan_on_open_;
+    // Filled by ScanBus() before the device turns kOpen, read-only until
+    // Close(), so lookups need no lock.
+    std::unordered_map<uint32_t, pci_dev*> scanned_devs_;  // same keys
+    uint64_t scan_generation_;  // PciTopology generation at scan time
+    std::unordered_map<uint16_t, pci::CapabilityIndex> cap_cache_;  // key: Bdf::Pack()
+    std::unordered_map<uint16_t, pci::CxlDvsecIndex> cxl_cache_;  // same keys
+    uint64_t cap_cache_generation_;  // PciTopology generation at fill time
+    mutable std::mutex cap_cache_mutex_;  // guards cap_cache_ and cxl_cache_
+    std::unordered_map<uint16_t, std::shared_ptr<pci::CxlMmioMailbox>>
+        cxl_mailboxes_;  // key: Bdf::Pack()
+    uint64_t cxl_mailboxes_generation_;  // PciTopology generation at fill time
+    uint32_t mailbox_timeout_ms_;
+    mutable std::mutex cxl_mailbox_mutex_;  // guards cxl_mailboxes_
     uint32_t doe_timeout_ms_;
     uint32_t doe_poll_interval_us_;
-    std::mutex doe_mutex_;
-    std::unordered_map<uint8_t, MappedBar> mapped_bars_;
-    std::mutex bar_mutex_;
+    uint32_t doe_spin_us_;
+    std::unordered_map<uint32_t, std::unique_ptr<core::IoQueue>>
+        doe_mailbox_queues_;  // key: Bdf::Pack() << 16 | doe_offset
+    mutable core::InstrumentedMutex doe_mutex_{"pciutils.doe_map"};  // guards doe_mailbox_queues_
+    DoeStats doe_stats_;
+    mutable std::mutex doe_stats_mutex_;
+    uint16_t trace_id_;  // log::Tracer device id, assigned in Open()
+    DeviceMetrics* metrics_;  // MetricsRegistry entry, assigned in Open()
+    // One slot per BAR. A slot is filled under bar_mutex_ and then published
+    // through mapped_bars_ (release), so the access path only does an
+    // acquire load once the BAR is mapped.
+    std::array<MappedBar, pci::kBarCount> bar_slots_;
+    std::array<std::atomic<MappedBar*>, pci::kBarCount> mapped_bars_{};
+    std::array<pci::BarMapping, pci::kBarCount> bar_mappings_{};  // default kUncached
+    std::optional<pci::BarResources> bar_resources_;
+    uint64_t bar_resources_generation_;  // PciTopology generation at read
+    bool map_bars_on_open_;
+    core::InstrumentedMutex bar_mutex_{"pciutils.bar"};  // serializes mapping changes to the BAR members above
 };
 
 }  // namespace plas::hal::driver
@@ -1,18 +1,22 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 #include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_interfaces.h"
 #include "plas/hal/interface/power_control.h"
+#include "plas/hal/interface/power_stream.h"
 #include "plas/hal/interface/ssd_gpio.h"
 #include "plas/config/device_entry.h"
 
 namespace plas::hal::driver {
 
-class Pmu3Device : public Device, public PowerControl, public SsdGpio {
+class Pmu3Device final : public Device, public PowerControl, public SsdGpio {
 public:
     explicit Pmu3Device(const config::DeviceEntry& entry);
-    ~Pmu3Device() override = default;
+    ~Pmu3Device() override;  // StopSampling()
 
     // Device interface
     core::Result<void> Init() override;
@@ -24,6 +28,11 @@ public:
     std::string GetUri() const override;
     std::string GetDriverName() const override;
 
+    using Interfaces = InterfaceList<PowerControl, SsdGpio>;
+    void* QueryInterface(InterfaceKind kind) override {
+        return QueryInterfaceOf(this, kind, Interfaces{});
+    }
+
     // PowerControl/SsdGpio interfaces — GetDevice() (one impl satisfies both)
     Device* GetDevice() override;
 
@@ -35,6 +44,10 @@ public:
     core::Result<void> PowerOn() override;
     core::Result<void> PowerOff() override;
     core::Result<bool> IsPowerOn() override;
+    core::Result<void> StartSampling(const PowerSamplingOptions& options,
+                                     PowerSampleRing& ring) override;
+    core::Result<void> StopSampling() override;
+    bool IsSampling() const override;
 
     // SsdGpio interface
     core::Result<void> SetPerst(bool active) override;
@@ -43,15 +56,26 @@ public:
     core::Result<bool> GetClkReq() override;
     core::Result<void> SetDualPort(bool enable) override;
     core::Result<bool> GetDualPort() override;
+    core::Result<SsdPinState> GetPinState() override;
+    core::Result<void> SetPinState(uint8_t mask, uint8_t values) override;
+    core::Result<void> StartPinEvents(const SsdPinEventOptions& options) override;
+    core::Result<void> StopPinEvents() override;
+    bool IsCapturingPinEvents() const override;
 
     /// Register this driver with the DeviceFactory.
     static void Register();
 
 private:
+    // SDK continuous capture: arm at `rate_hz`, fetch the next block, disarm.
+    core::Result<void> BeginCapture(uint32_t rate_hz);
+    core::Result<size_t> ReadCaptureBlock(PowerSample* out, size_t max);
+    void EndCapture();
+
     std::string name_;
     std::string uri_;
     DeviceState state_;
     int handle_;
+    PowerCapture capture_;  // last member: its thread stops first
 };
 
 }  // namespace plas::hal::driver
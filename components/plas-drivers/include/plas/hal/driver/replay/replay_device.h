@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/config/device_uri.h"
+#include "plas/core/error.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_interfaces.h"
+#include "plas/hal/transaction_proxy.h"
+#include "plas/hal/transaction_trace.h"
+
+namespace plas::hal::driver {
+
+/// Serves a trace captured with hal::RecordTransactions() in place of the
+/// device that was recorded, so host software can be benchmarked against
+/// real traffic without the hardware. The device implements the recorded
+/// device's I2c / PciConfig / PciDoe / PciBar interfaces.
+///
+/// URI: replay://driver:nickname — driver and nickname of the recorded device
+///
+/// Required DeviceEntry args:
+///   trace — trace file (shared by every device replaying it)
+///
+/// Optional DeviceEntry args:
+///   speed — recorded latencies are divided by this (default 1; 0 = no wait)
+///   loop  — true: continue from the first record after the last
+///
+/// Calls are matched in order against the device's records on op and every
+/// input (address, offset, written data, ...). A call that does not match
+/// the next record skips ahead to the first one that does; if none does it
+/// fails with kNotFound and the position is kept. A matched call returns
+/// the recorded outputs and error after its recorded duration / speed.
+class ReplayDevice : public Device, public TransactionPort {
+public:
+    struct Stats {
+        uint64_t matched = 0;    ///< calls served from the trace
+        uint64_t skipped = 0;    ///< records passed over to find a match
+        uint64_t unmatched = 0;  ///< calls that failed with kNotFound
+        std::size_t position = 0;  ///< index of the next record
+        std::size_t records = 0;   ///< records of this device
+    };
+
+    ~ReplayDevice() override;
+
+    // Device interface
+    core::Result<void> Init() override;
+    core::Result<void> Open() override;
+    core::Result<void> Close() override;
+    core::Result<void> Reset() override;
+    DeviceState GetState() const override;
+    std::string GetName() const override;
+    std::string GetUri() const override;
+    std::string GetDriverName() const override;
+
+    using Interfaces = InterfaceList<>;
+    void* QueryInterface(InterfaceKind kind) override {
+        return QueryInterfaceOf(this, kind, Interfaces{});
+    }
+
+    Stats GetStats() const;
+
+    /// Start again from the first record.
+    void Rewind();
+
+    /// Match a call (a record with only the inputs filled in) and wait out
+    /// its latency.
+    core::Result<const TraceRecord*> Replay(const TraceRecord& call);
+
+    /// Replay() with the matched record's outputs and error copied into
+    /// `call`; backs the device's interfaces (hal::MakeTransactionProxy).
+    core::Result<void> Execute(TraceRecord& call) override;
+
+    /// A ReplayDevice with the recorded device's interfaces. Problems with
+    /// the URI, args or trace are reported by Init().
+    static std::unique_ptr<Device> Create(const config::DeviceEntry& entry,
+                                          const config::DeviceUri& uri);
+
+    /// Register this driver with the DeviceFactory.
+    static void Register();
+
+protected:
+    ReplayDevice(const config::DeviceEntry& entry, std::shared_ptr<const TraceFile> trace,
+                 int device_index, core::ErrorCode init_error);
+
+private:
+    const config::DeviceEntry entry_;
+    std::shared_ptr<const TraceFile> trace_;
+    std::vector<const TraceRecord*> records_;
+    core::ErrorCode init_error_;
+    double speed_ = 1.0;
+    bool loop_ = false;
+
+    mutable std::mutex mutex_;
+    std::atomic<DeviceState> state_{DeviceState::kUninitialized};
+    std::size_t position_ = 0;
+    Stats stats_;
+};
+
+}  // namespace plas::hal::driver
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/config/device_uri.h"
+#include "plas/core/error.h"
+#include "plas/core/io_queue.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_interfaces.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/interface/pci/types.h"
+
+namespace plas::hal::driver {
+
+enum class SimLatency { kFixed, kUniform, kNormal, kExponential };
+
+/// Per-operation timing and failure of a simulated device. Every transfer,
+/// config access and DOE exchange draws one latency and one error roll.
+struct SimFaultModel {
+    SimLatency distribution = SimLatency::kFixed;
+    std::chrono::nanoseconds latency{0};  ///< fixed value / mean
+    std::chrono::nanoseconds jitter{0};   ///< uniform: +-jitter, normal: stddev
+    double error_rate = 0.0;              ///< probability per operation
+    core::ErrorCode error = core::ErrorCode::kIOError;
+};
+
+/// Base of the `sim` driver family: in-process devices with injectable
+/// latency and errors, for exercising DeviceManager, Bootstrap and test
+/// runners without hardware. Operations on one device are serialized (as
+/// on a real bus or function) through a core::IoQueue, foreground callers
+/// first, and the latency is spent inside that turn; separate devices run
+/// in parallel.
+///
+/// URI: sim://i2c:address            — SimI2cDevice
+///      sim://pci:DDDD:BB:dd.f       — SimPciDevice
+///
+/// Common DeviceEntry args:
+///   latency_us        — mean operation latency (default 0)
+///   latency_jitter_us — uniform half-width / normal stddev (default 0)
+///   latency_dist      — fixed (default), uniform, normal, exponential
+///   error_rate        — injected failure probability, 0..1 (default 0)
+///   error             — io (default), timeout, busy, not_found
+///   open_latency_us   — extra time spent in Open() (default 0)
+///   open_error_rate   — probability that Open() fails with kIOError
+///   seed              — RNG seed (default: hash of the nickname)
+class SimDevice : public Device {
+public:
+    ~SimDevice() override;
+
+    // Device interface
+    core::Result<void> Init() override;
+    core::Result<void> Open() override;
+    core::Result<void> Close() override;
+    core::Result<void> Reset() override;
+    DeviceState GetState() const override;
+    std::string GetName() const override;
+    std::string GetUri() const override;
+    std::string GetDriverName() const override;
+
+    /// Replace the fault model; applies from the next operation.
+    void SetFaultModel(const SimFaultModel& model);
+    SimFaultModel GetFaultModel() const;
+
+    /// Operations attempted since construction (excluding Open/Close).
+    uint64_t OperationCount() const { return operations_.load(); }
+    /// Operations failed by the fault model.
+    uint64_t InjectedErrorCount() const { return injected_errors_.load(); }
+    /// Turns and queueing time per core::IoPriority.
+    core::IoQueueStats GetIoQueueStats() const { return io_queue_.Stats(); }
+
+    /// SimI2cDevice or SimPciDevice by the URI's first field. Unknown kinds
+    /// yield a device whose Init() fails with kInvalidArgument.
+    static std::unique_ptr<Device> Create(const config::DeviceEntry& entry,
+                                          const config::DeviceUri& uri);
+
+    /// Register this driver with the DeviceFactory.
+    static void Register();
+
+protected:
+    explicit SimDevice(const config::DeviceEntry& entry);
+
+    /// Load images etc. during Init(); kind-specific.
+    virtual core::Result<void> OnInit() = 0;
+
+    /// Start of one operation, with io_queue_ held: checks the state, counts
+    /// the operation, spends the drawn latency plus `bus_time` and returns
+    /// the injected error, if any. kTimeout (after waiting until then) if
+    /// that time runs past the caller's core::Deadline.
+    core::Result<void> Simulate(std::chrono::nanoseconds bus_time = {});
+
+    /// Contents of `path`, read once per process and shared by every device
+    /// loading it. kNotFound if it cannot be read.
+    static core::Result<std::shared_ptr<const std::vector<core::Byte>>> LoadFile(
+        const std::string& path);
+
+    /// Numeric arg of `entry` in `base` no greater than `max`; flags
+    /// args_valid_.
+    void NumberArg(const config::DeviceEntry& entry, const char* key, int base,
+                   uint64_t max, uint64_t& out);
+
+    /// Heap held by the SimDevice part (name, URI, I/O queue state).
+    std::size_t BaseHeapBytes() const;
+
+    // Only what is needed after construction is kept; the args are parsed
+    // in the constructors and not copied.
+    const std::string name_;
+    const std::string uri_;
+    bool uri_valid_ = false;
+    bool args_valid_ = true;
+    mutable core::IoQueue io_queue_{"sim.io"};  // one transaction at a time, foreground first
+
+private:
+    /// SplitMix64: 8 bytes of state instead of mt19937_64's 2.5 KiB, which
+    /// dominated the footprint of a simulated device. Plenty for latency
+    /// and fault draws.
+    struct Rng {
+        using result_type = uint64_t;
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~result_type{0}; }
+        result_type operator()() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+        uint64_t state = 0;
+    };
+
+    static void Wait(std::chrono::nanoseconds duration);
+    std::chrono::nanoseconds DrawLatency();
+
+    std::atomic<DeviceState> state_{DeviceState::kUninitialized};
+    SimFaultModel fault_;
+    std::chrono::nanoseconds open_latency_{0};
+    double open_error_rate_ = 0.0;
+    Rng rng_;
+    std::atomic<uint64_t> operations_{0};
+    std::atomic<uint64_t> injected_errors_{0};
+};
+
+/// Register-map I2C target: one 7-bit address, `size` bytes of registers
+/// behind an internal pointer set by the first `addr_bytes` bytes of every
+/// write and auto-incremented (wrapping) by reads and writes, as on a
+/// 24Cxx EEPROM or a typical sensor.
+///
+/// Optional DeviceEntry args (in addition to SimDevice's):
+///   size       — register map bytes, 1..65536 (default 256)
+///   addr_bytes — register pointer width, 1 or 2 (default 1, 2 above 256)
+///   image      — raw binary file with the initial register contents
+///   fill       — value of registers not covered by `image` (default 0xFF)
+///   bitrate    — initial bus speed in Hz (default 400000)
+///   bus_time   — true: add 9 bit-times per byte at the current bitrate
+///
+/// Other addresses NACK (kIOError), like an empty bus.
+class SimI2cDevice final : public SimDevice, public I2c {
+public:
+    explicit SimI2cDevice(const config::DeviceEntry& entry);
+    /// `uri` is entry.uri already parsed (see DeviceFactory).
+    SimI2cDevice(const config::DeviceEntry& entry, const config::DeviceUri& uri);
+
+    using Interfaces = InterfaceList<I2c>;
+    void* QueryInterface(InterfaceKind kind) override {
+        return QueryInterfaceOf(this, kind, Interfaces{});
+    }
+
+    std::size_t MemoryUsage() const override;
+
+    // I2c interface
+    Device* GetDevice() override;
+    core::Result<size_t> Read(core::Address addr, core::Byte* data,
+                              size_t length, bool stop = true) override;
+    core::Result<size_t> Write(core::Address addr, const core::Byte* data,
+                               size_t length, bool stop = true) override;
+    core::Result<size_t> WriteRead(core::Address addr,
+                                   const core::Byte* write_data,
+                                   size_t write_len, core::Byte* read_data,
+                                   size_t read_len) override;
+    core::Result<void> SetBitrate(uint32_t bitrate) override;
+    uint32_t GetBitrate() const override;
+
+    /// Register contents, bypassing the bus (no latency, no faults).
+    std::vector<core::Byte> Registers() const;
+    core::Result<void> SetRegisters(size_t offset, const core::Byte* data,
+                                    size_t length);
+
+private:
+    static bool ParseUri(const config::DeviceUri& uri, uint16_t& address);
+    core::Result<void> OnInit() override;
+    std::chrono::nanoseconds BusTime(size_t bytes) const;
+    void WriteLocked(const core::Byte* data, size_t length);
+    void ReadLocked(core::Byte* data, size_t length);
+
+    uint16_t address_ = 0;
+    size_t size_ = 256;
+    size_t addr_bytes_ = 1;
+    core::Byte fill_ = 0xFF;
+    std::string image_path_;
+    std::atomic<uint32_t> bitrate_{400000};
+    bool bus_time_ = false;
+
+    std::vector<core::Byte> regs_;
+    size_t pointer_ = 0;
+};
+
+/// PCI function backed by a 4 KiB config-space image, with a DOE mailbox
+/// answered in process. Accesses to other BDFs read as all-ones, like an
+/// empty slot. Header identity (vendor/device ID, revision, class, header
+/// type) is read-only; the rest of the image is writable.
+///
+/// Optional DeviceEntry args (in addition to SimDevice's):
+///   config        — config-space dump: raw binary (sysfs `config`) or
+///                   `lspci -xxx`/`-xxxx` text; missing bytes read as 0
+///   vendor_id     — override, e.g. 0x8086 (default 0x1234 without `config`)
+///   device_id     — override (default 0x0001 without `config`)
+///   doe_protocols — comma-separated vendor:type hex pairs (default
+///                   "0001:00"); DOE Discovery is always answered
+///
+/// Without a DOE capability in the image one is placed at 0x100.
+/// DoeExchange on a protocol other than Discovery goes to the responder
+/// set with SetDoeResponder(), or echoes the request back.
+class SimPciDevice final : public SimDevice,
+                     public pci::PciConfig,
+                     public pci::PciDoe {
+public:
+    using DoeResponder = std::function<core::Result<pci::DoePayload>(
+        pci::DoeProtocolId protocol, const pci::DoePayload& request)>;
+
+    explicit SimPciDevice(const config::DeviceEntry& entry);
+    /// `uri` is entry.uri already parsed (see DeviceFactory).
+    SimPciDevice(const config::DeviceEntry& entry, const config::DeviceUri& uri);
+
+    using Interfaces = InterfaceList<pci::PciConfig, pci::PciDoe>;
+    void* QueryInterface(InterfaceKind kind) override {
+        return QueryInterfaceOf(this, kind, Interfaces{});
+    }
+
+    std::size_t MemoryUsage() const override;
+
+    // PciConfig / PciDoe interface — GetDevice()
+    Device* GetDevice() override;
+
+    // PciConfig interface
+    core::Result<core::Byte> ReadConfig8(pci::Bdf bdf, pci::ConfigOffset offset) override;
+    core::Result<core::Word> ReadConfig16(pci::Bdf bdf, pci::ConfigOffset offset) override;
+    core::Result<core::DWord> ReadConfig32(pci::Bdf bdf, pci::ConfigOffset offset) override;
+    core::Result<void> WriteConfig8(pci::Bdf bdf, pci::ConfigOffset offset,
+                                    core::Byte value) override;
+    core::Result<void> WriteConfig16(pci::Bdf bdf, pci::ConfigOffset offset,
+                                     core::Word value) override;
+    core::Result<void> WriteConfig32(pci::Bdf bdf, pci::ConfigOffset offset,
+                                     core::DWord value) override;
+    core::Result<std::optional<pci::ConfigOffset>> FindCapability(
+        pci::Bdf bdf, pci::CapabilityId id) override;
+    core::Result<std::optional<pci::ConfigOffset>> FindExtCapability(
+        pci::Bdf bdf, pci::ExtCapabilityId id) override;
+
+    // PciDoe interface
+    core::Result<std::vector<pci::DoeProtocolId>> DoeDiscover(
+        pci::Bdf bdf, pci::ConfigOffset doe_offset) override;
+    core::Result<pci::DoePayload> DoeExchange(
+        pci::Bdf bdf, pci::ConfigOffset doe_offset, pci::DoeProtocolId protocol,
+        const pci::DoePayload& request) override;
+
+    /// Answer non-Discovery DOE requests; an empty function restores echo.
+    /// Called with the device lock held.
+    void SetDoeResponder(DoeResponder responder);
+
+    pci::Bdf GetBdf() const { return bdf_; }
+    /// DOE capability offsets found in (or added to) the image at Init().
+    std::vector<pci::ConfigOffset> DoeOffsets() const;
+
+private:
+    static bool ParseUri(const config::DeviceUri& uri, pci::Bdf& bdf);
+    core::Result<void> OnInit() override;
+    template <typename T>
+    core::Result<T> ReadLocked(pci::Bdf bdf, pci::ConfigOffset offset);
+    template <typename T>
+    core::Result<void> WriteLocked(pci::Bdf bdf, pci::ConfigOffset offset, T value);
+    template <typename Id>
+    core::Result<std::optional<pci::ConfigOffset>> FindLocked(pci::Bdf bdf, Id id);
+    bool HasDoe(pci::ConfigOffset offset) const;
+
+    pci::Bdf bdf_{};
+    std::string config_path_;
+    int32_t vendor_id_ = -1;  // -1: from the image (or 0x1234 without one)
+    int32_t device_id_ = -1;
+    std::vector<pci::DoeProtocolId> protocols_;
+
+    std::array<core::Byte, pci::kConfigSpaceSize> config_{};
+    std::vector<pci::ConfigOffset> doe_offsets_;
+    DoeResponder responder_;
+};
+
+}  // namespace plas::hal::driver
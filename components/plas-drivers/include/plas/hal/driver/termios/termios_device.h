@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_interfaces.h"
+#include "plas/hal/interface/device_handoff.h"
+#include "plas/hal/interface/serial.h"
+#include "plas/hal/interface/uart.h"
+#include "plas/hal/serial_io_loop.h"
+#include "plas/config/device_entry.h"
+#include "plas/config/device_uri.h"
+
+namespace plas::hal::driver {
+
+/// POSIX tty (USB-UART bridge, on-board UART, pty) in raw mode. The fd is
+/// non-blocking and served by SerialIoLoop::Shared(): received bytes land
+/// in an RX ring in the background, so a slow caller loses nothing until
+/// the ring overflows, and writes only queue into a TX ring.
+///
+/// URI: termios://tty:baud — `tty` is the node under /dev (ttyUSB0,
+/// ttyS1, pts/3), `baud` a standard rate such as 115200.
+///
+/// Optional DeviceEntry args:
+///   parity           — none (default), odd, even
+///   rx_buffer        — RX ring bytes (default 65536)
+///   tx_buffer        — TX ring bytes (default 16384)
+///   read_timeout_ms  — how long Read() waits for the first byte (default 100)
+///   write_timeout_ms — how long Write() waits for TX ring space (default 1000)
+///
+/// Warm restart hands over the tty fd and its line settings; bytes still in
+/// the RX ring at export are lost, bytes arriving later wait in the tty.
+class TermiosDevice final : public Device, public Serial, public Uart, public DeviceHandoffSupport {
+public:
+    explicit TermiosDevice(const config::DeviceEntry& entry);
+    /// `uri` is entry.uri already parsed (see DeviceFactory).
+    TermiosDevice(const config::DeviceEntry& entry, const config::DeviceUri& uri);
+    ~TermiosDevice() override;
+
+    // Device interface
+    core::Result<void> Init() override;
+    core::Result<void> Open() override;
+    core::Result<void> Close() override;
+    core::Result<void> Reset() override;
+    DeviceState GetState() const override;
+    std::string GetName() const override;
+    std::string GetUri() const override;
+    std::string GetDriverName() const override;
+
+    using Interfaces = InterfaceList<Serial, Uart>;
+    void* QueryInterface(InterfaceKind kind) override {
+        return QueryInterfaceOf(this, kind, Interfaces{});
+    }
+
+    // Serial / Uart / DeviceHandoffSupport — GetDevice()
+    Device* GetDevice() override;
+
+    // DeviceHandoffSupport. The state is "<baud> <parity>"; Adopt reapplies
+    // the line settings only if this entry asks for different ones.
+    core::Result<DeviceHandoff> ExportHandoff() override;
+    core::Result<void> AdoptHandoff(const DeviceHandoff& handoff) override;
+
+    // Serial / Uart interface
+    core::Result<size_t> Read(core::Byte* data, size_t length) override;
+    core::Result<size_t> Write(const core::Byte* data, size_t length) override;
+    core::Result<void> SetBaudRate(uint32_t baud_rate) override;
+    uint32_t GetBaudRate() const override;
+    /// Wait for the TX ring to drain, then tcdrain() the tty.
+    core::Result<void> Flush() override;
+    core::Result<void> SetParity(Parity parity) override;
+    core::Result<size_t> ReadFor(core::Byte* data, size_t length,
+                                 std::chrono::milliseconds timeout) override;
+    size_t Available() const override;
+    core::Result<void> SetReadyCallback(std::function<void()> callback) override;
+
+    /// Received bytes lost to RX ring overflow since Open().
+    uint64_t RxDropped() const;
+
+    /// Register this driver with the DeviceFactory.
+    static void Register();
+
+private:
+    static bool ParseUri(const config::DeviceUri& uri, std::string& tty,
+                         uint32_t& baud_rate);
+
+    /// Push baud_rate_/parity_ to the open fd.
+    core::Result<void> ApplyLineSettings();
+    /// Serve fd_ from SerialIoLoop and mark the device open.
+    core::Result<void> StartIo();
+
+    std::string name_;
+    std::string uri_;
+    bool uri_valid_ = false;
+    bool args_valid_ = true;
+    DeviceState state_;
+
+    std::string tty_;
+    uint32_t baud_rate_;
+    Parity parity_;
+    size_t rx_buffer_;
+    size_t tx_buffer_;
+    std::chrono::milliseconds read_timeout_;
+    std::chrono::milliseconds write_timeout_;
+
+    int fd_ = -1;
+    SerialIoLoop::PortId port_ = 0;
+    std::mutex settings_mutex_;
+};
+
+}  // namespace plas::hal::driver
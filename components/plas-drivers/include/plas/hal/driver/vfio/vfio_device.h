@@ -0,0 +1,388 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/config/device_uri.h"
+#include "plas/core/io_queue.h"
+#include "plas/core/lock_stats.h"
+#include "plas/core/numa.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_interfaces.h"
+#include "plas/hal/interface/pci/bar_resource.h"
+#include "plas/hal/interface/pci/cxl.h"
+#include "plas/hal/interface/pci/cxl_dvsec.h"
+#include "plas/hal/interface/pci/cxl_mailbox.h"
+#include "plas/hal/interface/pci/cxl_mmio_mailbox.h"
+#include "plas/hal/interface/pci/irq_signal.h"
+#include "plas/hal/interface/pci/mmio_window.h"
+#include "plas/hal/interface/pci/pci_bar.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/metrics.h"
+
+namespace plas::hal::driver {
+
+struct VfioContainer;  // defined in vfio_device.cpp
+
+/// Host memory pinned and mapped into a VfioDevice's IOMMU domain, so the
+/// device can DMA to and from it: the device addresses it at Iova(), the
+/// host at Data(). Unmapped and freed on destruction. Move-only; holds the
+/// VFIO container open, so it may outlive the device's Close().
+class VfioDmaBuffer {
+public:
+    VfioDmaBuffer() = default;
+    ~VfioDmaBuffer();
+
+    VfioDmaBuffer(VfioDmaBuffer&& other) noexcept;
+    VfioDmaBuffer& operator=(VfioDmaBuffer&& other) noexcept;
+
+    VfioDmaBuffer(const VfioDmaBuffer&) = delete;
+    VfioDmaBuffer& operator=(const VfioDmaBuffer&) = delete;
+
+    void* Data() const { return buffer_.Data(); }
+    std::size_t Size() const { return buffer_.Size(); }
+    /// I/O virtual address of Data() as the device sees it.
+    uint64_t Iova() const { return iova_; }
+    /// Bytes mapped in the IOMMU (Size() rounded up to the page size).
+    std::size_t MappedSize() const { return buffer_.Capacity(); }
+    int Node() const { return buffer_.Node(); }
+    core::PageBacking Backing() const { return buffer_.Backing(); }
+
+private:
+    friend class VfioDevice;
+    VfioDmaBuffer(std::shared_ptr<VfioContainer> container,
+                  core::NumaBuffer buffer, uint64_t iova);
+    void Release();
+
+    std::shared_ptr<VfioContainer> container_;
+    core::NumaBuffer buffer_;
+    uint64_t iova_ = 0;
+};
+
+/// PCI/CXL driver over Linux VFIO: the function is bound to vfio-pci and
+/// driven from userspace through its VFIO device fd. Config space and BARs
+/// go through the device's VFIO regions (BARs mmap'd where vfio-pci allows
+/// it), so no sysfs resource files or root access are needed beyond the
+/// /dev/vfio group node.
+///
+/// Beyond what the sysfs/libpci backends offer:
+///   - MSI-X (else MSI) vectors are wired to eventfds and serviced by one
+///     interrupt thread. DOE exchanges and CXL mailbox commands enable
+///     their completion interrupt and sleep on it after the spin window
+///     instead of polling. Without vectors, or with interrupts=false, both
+///     poll as in PciUtilsDevice.
+///   - AllocateDmaBuffer() returns host memory on the function's NUMA node
+///     mapped into the IOMMU, so bulk data moves by device DMA instead of
+///     MMIO copies.
+///
+/// One VfioDevice per IOMMU group: the group node can be opened only once.
+/// Only this function is reachable; any other Bdf gets kNotFound.
+///
+/// URI format: vfio://DDDD:BB:DD.F
+///
+/// Optional DeviceEntry args:
+///   sysfs_root           — PCI sysfs device directory
+///                          (default /sys/bus/pci/devices)
+///   dev_root             — VFIO node directory (default /dev/vfio)
+///   interrupts           — "false" to poll instead of using MSI-X/MSI
+///                          (default true)
+///   doe_timeout_ms       — DOE response timeout (default 1000)
+///   doe_poll_interval_us — max DOE polling interval without an interrupt
+///                          (default 100)
+///   doe_spin_us          — busy-poll window before sleeping (default 20)
+///   mailbox_timeout_ms   — CXL mailbox doorbell timeout (default 2000)
+class VfioDevice final : public Device,
+                   public pci::PciConfig,
+                   public pci::PciDoe,
+                   public pci::PciBar,
+                   public pci::Cxl,
+                   public pci::CxlMailbox {
+public:
+    explicit VfioDevice(const config::DeviceEntry& entry);
+    /// `uri` is entry.uri already parsed (see DeviceFactory).
+    VfioDevice(const config::DeviceEntry& entry, const config::DeviceUri& uri);
+    ~VfioDevice() override;
+
+    // -- Device interface -----------------------------------------------------
+    core::Result<void> Init() override;
+    /// Attach the IOMMU group to a new type-1 container, get the device fd,
+    /// map the BARs, enable bus mastering and wire the interrupt vectors.
+    /// kNotFound if the function has no IOMMU group or VFIO node,
+    /// kBusy if the group is not viable (a member not bound to vfio-pci)
+    /// or already open, kNotSupported without VFIO type-1 IOMMU support.
+    core::Result<void> Open() override;
+    core::Result<void> Close() override;
+    core::Result<void> Reset() override;
+    DeviceState GetState() const override;
+    std::string GetName() const override;
+    std::string GetUri() const override;
+    std::string GetDriverName() const override;
+
+    using Interfaces = InterfaceList<pci::PciConfig, pci::PciDoe, pci::PciBar, pci::Cxl,
+                                     pci::CxlMailbox>;
+    void* QueryInterface(InterfaceKind kind) override {
+        return QueryInterfaceOf(this, kind, Interfaces{});
+    }
+
+    // PCI/CXL interfaces — GetDevice() (one impl satisfies all)
+    plas::hal::Device* GetDevice() override;
+
+    // -- PciConfig interface --------------------------------------------------
+    core::Result<core::Byte> ReadConfig8(pci::Bdf bdf,
+                                         pci::ConfigOffset offset) override;
+    core::Result<core::Word> ReadConfig16(pci::Bdf bdf,
+                                          pci::ConfigOffset offset) override;
+    core::Result<core::DWord> ReadConfig32(pci::Bdf bdf,
+                                           pci::ConfigOffset offset) override;
+    core::Result<void> WriteConfig8(pci::Bdf bdf, pci::ConfigOffset offset,
+                                    core::Byte value) override;
+    core::Result<void> WriteConfig16(pci::Bdf bdf, pci::ConfigOffset offset,
+                                     core::Word value) override;
+    core::Result<void> WriteConfig32(pci::Bdf bdf, pci::ConfigOffset offset,
+                                     core::DWord value) override;
+    core::Result<std::optional<pci::ConfigOffset>> FindCapability(
+        pci::Bdf bdf, pci::CapabilityId id) override;
+    core::Result<std::optional<pci::ConfigOffset>> FindExtCapability(
+        pci::Bdf bdf, pci::ExtCapabilityId id) override;
+    /// One pread() of the config region.
+    core::Result<void> ReadConfigBlock(pci::Bdf bdf, pci::ConfigOffset offset,
+                                       core::Byte* buffer,
+                                       std::size_t length) override;
+    core::Result<std::vector<core::Byte>> SnapshotConfig(
+        pci::Bdf bdf) override;
+    core::Result<pci::CapabilityIndex> GetCapabilityIndex(
+        pci::Bdf bdf) override;
+
+    // -- PciDoe interface -----------------------------------------------------
+    core::Result<std::vector<pci::DoeProtocolId>> DoeDiscover(
+        pci::Bdf bdf, pci::ConfigOffset doe_offset) override;
+    core::Result<pci::DoePayload> DoeExchange(
+        pci::Bdf bdf, pci::ConfigOffset doe_offset,
+        pci::DoeProtocolId protocol,
+        const pci::DoePayload& request) override;
+    core::Result<std::size_t> DoeExchangeInto(
+        pci::Bdf bdf, pci::ConfigOffset doe_offset,
+        pci::DoeProtocolId protocol, const core::DWord* request,
+        std::size_t request_len, core::DWord* response,
+        std::size_t response_capacity) override;
+
+    // -- PciBar interface -----------------------------------------------------
+    // BARs vfio-pci lets us mmap are accessed directly; the rest (I/O BARs,
+    // BARs holding the MSI-X table on older kernels) through pread/pwrite
+    // on the region.
+    core::Result<core::DWord> BarRead32(pci::Bdf bdf, uint8_t bar_index,
+                                         uint64_t offset) override;
+    core::Result<core::QWord> BarRead64(pci::Bdf bdf, uint8_t bar_index,
+                                         uint64_t offset) override;
+    core::Result<void> BarWrite32(pci::Bdf bdf, uint8_t bar_index,
+                                   uint64_t offset,
+                                   core::DWord value) override;
+    core::Result<void> BarWrite64(pci::Bdf bdf, uint8_t bar_index,
+                                   uint64_t offset,
+                                   core::QWord value) override;
+    core::Result<void> BarReadBuffer(pci::Bdf bdf, uint8_t bar_index,
+                                      uint64_t offset, void* buffer,
+                                      std::size_t length) override;
+    core::Result<void> BarWriteBuffer(pci::Bdf bdf, uint8_t bar_index,
+                                       uint64_t offset, const void* buffer,
+                                       std::size_t length) override;
+    /// vfio-pci maps BARs uncached only: kWriteCombining is kNotSupported.
+    core::Result<void> SetBarMapping(pci::Bdf bdf, uint8_t bar_index,
+                                     pci::BarMapping mapping) override;
+    core::Result<void> BarFlush(pci::Bdf bdf, uint8_t bar_index) override;
+
+    // -- Cxl interface --------------------------------------------------------
+    // Parsed once from a config snapshot together with the capability index.
+    core::Result<std::vector<pci::DvsecHeader>> EnumerateCxlDvsecs(
+        pci::Bdf bdf) override;
+    core::Result<std::optional<pci::DvsecHeader>> FindCxlDvsec(
+        pci::Bdf bdf, pci::CxlDvsecId dvsec_id) override;
+    core::Result<pci::CxlDeviceType> GetCxlDeviceType(pci::Bdf bdf) override;
+    core::Result<std::vector<pci::RegisterBlockEntry>> GetRegisterBlocks(
+        pci::Bdf bdf) override;
+    core::Result<core::DWord> ReadDvsecRegister(
+        pci::Bdf bdf, pci::ConfigOffset dvsec_offset,
+        uint16_t reg_offset) override;
+    core::Result<void> WriteDvsecRegister(pci::Bdf bdf,
+                                          pci::ConfigOffset dvsec_offset,
+                                          uint16_t reg_offset,
+                                          core::DWord value) override;
+
+    // -- CxlMailbox interface -------------------------------------------------
+    // Primary Mailbox over the BARs, completion by doorbell interrupt when
+    // the mailbox's message number has a vector.
+    core::Result<pci::CxlMailboxResult> ExecuteCommand(
+        pci::Bdf bdf, pci::CxlMailboxOpcode opcode,
+        const pci::CxlMailboxPayload& payload) override;
+    core::Result<pci::CxlMailboxResult> ExecuteCommand(
+        pci::Bdf bdf, uint16_t raw_opcode,
+        const pci::CxlMailboxPayload& payload) override;
+    core::Result<pci::CxlMailboxResult> ExecuteCommandGather(
+        pci::Bdf bdf, uint16_t raw_opcode, const uint8_t* header,
+        std::size_t header_len, const uint8_t* data,
+        std::size_t data_len) override;
+    core::Result<pci::CxlMailboxPooledResult> ExecuteCommandPooled(
+        pci::Bdf bdf, uint16_t raw_opcode, const uint8_t* payload,
+        std::size_t length) override;
+    core::Result<uint32_t> GetPayloadSize(pci::Bdf bdf) override;
+    core::Result<bool> IsReady(pci::Bdf bdf) override;
+    core::Result<pci::CxlMailboxResult> GetBackgroundCmdStatus(
+        pci::Bdf bdf) override;
+
+    /// The mailbox behind the CxlMailbox calls, for Submit()/TryComplete()
+    /// and GetBackgroundStatus(). Located on first use, dropped on Close.
+    core::Result<std::shared_ptr<pci::CxlMmioMailbox>> GetCxlMailbox(
+        pci::Bdf bdf);
+
+    /// BAR `bar_index` as an MmioWindow for unchecked inline accesses
+    /// (pci/mmio_window.h), valid until Close(). kNotInitialized unless
+    /// open, kNotFound for an unimplemented BAR, kNotSupported if vfio-pci
+    /// does not allow mmap of it (BarRead32 then falls back to pread).
+    core::Result<pci::MmioWindow> GetBarWindow(uint8_t bar_index);
+
+    // -- DMA and interrupts ---------------------------------------------------
+
+    /// `bytes` of host memory on the function's NUMA node (unplaced if
+    /// unknown), mapped read/write into the IOMMU at a fresh IOVA. With
+    /// `huge_pages` the mapping is backed by 2 MiB pages where possible, so
+    /// the IOMMU needs one entry per 2 MiB. kNotInitialized unless open,
+    /// kInvalidArgument for 0 bytes, kOutOfMemory if the memory cannot be
+    /// had or the mapping exceeds RLIMIT_MEMLOCK.
+    core::Result<VfioDmaBuffer> AllocateDmaBuffer(std::size_t bytes,
+                                                  bool huge_pages = true);
+
+    /// Interrupt vectors wired to eventfds (0: polling).
+    std::size_t InterruptVectors() const;
+    /// Wakeups on `vector` since Open() (back-to-back interrupts the
+    /// eventfd coalesced count once).
+    uint64_t InterruptCount(std::size_t vector) const;
+
+    /// Self-register with DeviceFactory under driver name "vfio".
+    static void Register();
+
+private:
+    /// One VFIO region (config space or a BAR).
+    struct Region {
+        uint64_t offset = 0;  // in the device fd
+        uint64_t size = 0;
+        uint32_t flags = 0;
+        void* map = nullptr;  // mmap of the whole region, if allowed
+    };
+
+    /// Parse a "vfio://DDDD:BB:DD.F" URI.
+    static bool ParseUri(const config::DeviceUri& uri, uint16_t& domain,
+                         uint8_t& bus, uint8_t& device, uint8_t& function);
+
+    std::string DeviceName() const;  // "DDDD:BB:DD.F"
+    /// kNotInitialized unless open, kNotFound for a Bdf other than ours.
+    core::Result<void> CheckTarget(pci::Bdf bdf) const;
+
+    core::Result<void> OpenLocked();
+    void CloseLocked();
+    core::Result<void> ReadRegions();
+    void SetupInterrupts();
+    void StopInterrupts();
+    void IrqLoop();
+    /// Signal for interrupt message `message`, or nullptr without a vector.
+    std::shared_ptr<pci::IrqSignal> Vector(uint32_t message) const;
+
+    template <typename T>
+    core::Result<T> ReadConfigValue(pci::Bdf bdf, pci::ConfigOffset offset);
+    template <typename T>
+    core::Result<void> WriteConfigValue(pci::Bdf bdf, pci::ConfigOffset offset,
+                                        T value);
+    core::Result<void> ConfigRead(pci::ConfigOffset offset, void* data,
+                                  std::size_t length);
+    core::Result<void> ConfigWrite(pci::ConfigOffset offset, const void* data,
+                                   std::size_t length);
+    core::Result<const Region*> BarRegion(uint8_t bar_index, uint64_t offset,
+                                          std::size_t length) const;
+    core::Result<void> BarRead(pci::Bdf bdf, uint8_t bar_index,
+                               uint64_t offset, void* data,
+                               std::size_t length);
+    core::Result<void> BarWrite(pci::Bdf bdf, uint8_t bar_index,
+                                uint64_t offset, const void* data,
+                                std::size_t length);
+
+    /// Capability and CXL DVSEC index, built on first use from one config
+    /// snapshot. Caller must hold cap_mutex_.
+    core::Result<void> EnsureIndexLocked();
+
+    // DOE helpers
+    core::IoQueue& DoeMailboxQueue(pci::ConfigOffset doe_offset);
+    core::Result<core::DWord> DoeReadReg(pci::ConfigOffset offset);
+    core::Result<void> DoeWriteReg(pci::ConfigOffset offset,
+                                   core::DWord value);
+    /// Vector for the mailbox's DOE Interrupt Message Number, if the
+    /// capability supports interrupts and the message has a vector.
+    std::shared_ptr<pci::IrqSignal> DoeVector(pci::ConfigOffset doe_offset);
+    core::Result<void> DoeAbort(pci::ConfigOffset doe_offset);
+    /// Abort-if-busy, write the request object, set GO (with the DOE
+    /// interrupt enabled when DoeVector() has one) and wait for Data Object
+    /// Ready.
+    core::Result<void> DoeSubmit(pci::ConfigOffset doe_offset,
+                                 pci::DoeProtocolId protocol,
+                                 const core::DWord* payload,
+                                 std::size_t payload_len);
+    core::Result<std::size_t> DoeReadHeader(pci::ConfigOffset doe_offset);
+    core::Result<std::size_t> DoeReadInto(pci::ConfigOffset doe_offset,
+                                          core::DWord* out,
+                                          std::size_t capacity);
+
+    std::string name_;
+    std::string uri_;
+    bool uri_valid_ = false;
+    DeviceState state_;
+    uint16_t domain_;
+    uint8_t bus_;
+    uint8_t device_num_;
+    uint8_t function_;
+    std::string sysfs_root_;
+    std::string dev_root_;
+    bool interrupts_;
+    uint32_t doe_timeout_ms_;
+    uint32_t doe_poll_interval_us_;
+    uint32_t doe_spin_us_;
+    uint32_t mailbox_timeout_ms_;
+    int numa_node_;
+
+    // Open() fills these before the device turns kOpen; Close() clears
+    // them after it leaves kOpen.
+    std::shared_ptr<VfioContainer> container_;
+    int device_fd_;
+    Region config_;
+    std::array<Region, pci::kBarCount> bars_;
+    std::mutex lifecycle_mutex_;  // Open/Close
+
+    // Interrupts: one eventfd per vector, one thread reading them.
+    uint32_t irq_index_;  // VFIO_PCI_MSIX_IRQ_INDEX or _MSI_IRQ_INDEX
+    std::vector<int> irq_fds_;
+    std::vector<std::shared_ptr<pci::IrqSignal>> vectors_;
+    int irq_stop_fd_;
+    std::thread irq_thread_;
+
+    std::optional<pci::CapabilityIndex> cap_index_;
+    std::optional<pci::CxlDvsecIndex> cxl_index_;
+    std::mutex cap_mutex_;  // guards cap_index_ and cxl_index_
+
+    std::shared_ptr<pci::CxlMmioMailbox> cxl_mailbox_;
+    std::mutex cxl_mailbox_mutex_;  // guards cxl_mailbox_
+
+    std::unordered_map<pci::ConfigOffset, std::unique_ptr<core::IoQueue>>
+        doe_mailbox_queues_;
+    core::InstrumentedMutex doe_mutex_{"vfio.doe_map"};  // guards doe_mailbox_queues_
+
+    uint16_t trace_id_;  // log::Tracer device id, assigned in Open()
+    DeviceMetrics* metrics_;  // MetricsRegistry entry, assigned in Open()
+};
+
+}  // namespace plas::hal::driver
@@ -1,10 +1,19 @@
 #include "plas/hal/driver/aardvark/aardvark_device.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <map>
 #include <mutex>
+#include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #ifdef PLAS_HAS_AARDVARK
 extern "C" {
@@ -12,24 +21,73 @@ extern "C" {
 }
 #endif
 
+#include "plas/core/deadline.h"
 #include "plas/core/error.h"
+#include "plas/core/io_queue.h"
+#include "plas/core/lock_stats.h"
 #include "plas/hal/interface/device_factory.h"
 #include "plas/log/logger.h"
+#include "plas/log/trace.h"
 
 // ---------------------------------------------------------------------------
-// AardvarkBusState — shared SDK handle + bus mutex per port
+// AardvarkBusState — shared SDK handle + bus scheduler per port
 // ---------------------------------------------------------------------------
 
 namespace plas::hal::driver {
 
+struct AardvarkAsyncJob {
+    int                   priority;  // AardvarkDevice::Priority value
+    const void*           owner;     // submitting AardvarkDevice
+    uint32_t              bitrate;   // clock the job runs at; 0 = any
+    uint8_t               mode_on;   // AardvarkDevice::kMode* the job enables
+    uint8_t               mode_off;  // ... and disables (GPIO pins)
+    std::function<void()> run;
+};
+
 struct AardvarkBusState {
     uint16_t   port           = 0;
     int        handle         = -1;    // aa_open() result; -1 in stub mode
-    std::mutex bus_mutex;              // serializes Read/Write/WriteRead
     uint32_t   active_bitrate = 0;    // 0 = unset (first Open records it)
     bool       active_pullup  = true;
     uint16_t   active_timeout = 200;
     int        ref_count      = 0;    // Open +1 / Close -1; aa_close at 0
+
+    // Adapter mode and the SPI/GPIO settings of the shared handle; changed
+    // only by the bus owner.
+    uint8_t    active_mode        = AardvarkDevice::kModeI2c;  // AA_CONFIG_* bits
+    uint32_t   active_spi_bitrate = 0;   // 0 = SPI not configured yet
+    int        active_spi_mode    = -1;  // SpiMode value; -1 = not configured
+    uint32_t   gpio_direction     = 0;   // aa_gpio_direction mask, 1 = output
+    uint32_t   gpio_outputs       = 0;   // aa_gpio_set value
+    std::vector<core::Byte> spi_tx;      // SPI staging: header + data out
+    std::vector<core::Byte> spi_rx;      // SPI staging: header + data in
+
+    // Bus scheduler: one owner at a time; waiters are granted in
+    // (priority, arrival) order. bus_mutex guards the fields below only,
+    // it is not held across SDK calls.
+    std::mutex                        bus_mutex;
+    std::condition_variable           bus_cv;
+    bool                              bus_owned   = false;
+    uint64_t                          next_ticket = 0;
+    std::set<std::pair<int, uint64_t>> waiters;  // (priority, ticket)
+#if PLAS_LOCK_STATS
+    // The bus turn is the contended resource, not bus_mutex; it reports
+    // as one lock.
+    core::LockCounters*               bus_stats = core::LockCounters::For("aardvark.bus");
+    std::chrono::steady_clock::time_point bus_granted_at;
+#endif
+
+    // Async submit queue, drained by `worker` (started by the first Open
+    // with async=true, joined when ref_count reaches 0).
+    std::mutex                        queue_mutex;
+    std::condition_variable           queue_cv;
+    std::deque<AardvarkAsyncJob>      queue;
+    std::thread                       worker;
+    bool                              stopping = false;
+
+    // ProbeMaxBitrate() results, target address → bitrate.
+    std::mutex                        probe_mutex;
+    std::unordered_map<uint16_t, uint32_t> probed_bitrates;
 };
 
 }  // namespace plas::hal::driver
@@ -39,7 +97,11 @@ struct AardvarkBusState {
 //
 // Two mutexes — never held simultaneously:
 //   GetRegistryMutex()      guards map CRUD (Open/Close registry section only)
-//   bus_state_->bus_mutex   guards SDK handle I/O (Read/Write/WriteRead)
+//   bus_state_->bus_mutex   guards the bus scheduler; SDK handle I/O runs
+//                           while the caller owns the bus (AcquireBusTurn)
+//
+// The async worker takes queue_mutex only to pop work and then schedules
+// each job like any other client; neither lock is held across the other.
 // ---------------------------------------------------------------------------
 
 namespace {
@@ -58,6 +120,125 @@ std::mutex& GetRegistryMutex() {
     return m;
 }
 
+using plas::hal::driver::AardvarkBusState;
+
+using Clock = std::chrono::steady_clock;
+
+// Wait for bus ownership. Returns false if `deadline` passes first.
+bool AcquireBusTurn(AardvarkBusState& state, int priority,
+                    Clock::time_point deadline) {
+#if PLAS_LOCK_STATS
+    const auto since = Clock::now();
+#endif
+    std::unique_lock<std::mutex> lock(state.bus_mutex);
+#if PLAS_LOCK_STATS
+    const bool contended = state.bus_owned || !state.waiters.empty();
+#endif
+    const auto key = std::make_pair(priority, state.next_ticket++);
+    state.waiters.insert(key);
+    auto my_turn = [&state, &key] {
+        return !state.bus_owned && *state.waiters.begin() == key;
+    };
+    if (deadline == Clock::time_point::max()) {
+        state.bus_cv.wait(lock, my_turn);
+    } else if (!state.bus_cv.wait_until(lock, deadline, my_turn)) {
+        state.waiters.erase(key);
+        // We may have been the head; let the next waiter re-check.
+        state.bus_cv.notify_all();
+        return false;
+    }
+    state.waiters.erase(key);
+    state.bus_owned = true;
+#if PLAS_LOCK_STATS
+    state.bus_granted_at = Clock::now();
+    state.bus_stats->RecordAcquire(
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  state.bus_granted_at - since)
+                                  .count()),
+        contended);
+#endif
+    return true;
+}
+
+void ReleaseBusTurn(AardvarkBusState& state) {
+    {
+        std::lock_guard<std::mutex> lock(state.bus_mutex);
+        state.bus_owned = false;
+#if PLAS_LOCK_STATS
+        state.bus_stats->RecordRelease(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                                 state.bus_granted_at)
+                .count()));
+#endif
+    }
+    state.bus_cv.notify_all();
+}
+
+// Drain the queue in batches, each run in AardvarkDevice::PlanBatch order:
+// by priority, then grouped by bitrate and adapter mode without reordering
+// any device's own jobs. Every job then competes for the bus through the
+// scheduler.
+void RunAsyncWorker(AardvarkBusState* state) {
+    uint32_t bitrate = 0;  // clock of the last job run
+    uint8_t mode = plas::hal::driver::AardvarkDevice::kModeI2c;  // mode it left
+    for (;;) {
+        std::deque<plas::hal::driver::AardvarkAsyncJob> batch;
+        {
+            std::unique_lock<std::mutex> lock(state->queue_mutex);
+            state->queue_cv.wait(lock, [state] {
+                return state->stopping || !state->queue.empty();
+            });
+            if (state->queue.empty()) {
+                return;  // stopping and fully drained
+            }
+            batch.swap(state->queue);
+        }
+        std::vector<plas::hal::driver::AardvarkDevice::QueuedOp> ops;
+        ops.reserve(batch.size());
+        for (const auto& job : batch) {
+            ops.push_back({job.priority, job.owner, job.bitrate, job.mode_on,
+                           job.mode_off});
+        }
+        for (size_t i :
+             plas::hal::driver::AardvarkDevice::PlanBatch(ops, bitrate, mode)) {
+            batch[i].run();
+            if (batch[i].bitrate != 0) {
+                bitrate = batch[i].bitrate;
+            }
+            mode = static_cast<uint8_t>((mode | batch[i].mode_on) & ~batch[i].mode_off);
+        }
+    }
+}
+
+// Caller holds GetRegistryMutex().
+void StartAsyncWorker(AardvarkBusState& state) {
+    if (state.worker.joinable()) {
+        return;
+    }
+    state.stopping = false;
+    state.worker = std::thread(RunAsyncWorker, &state);
+}
+
+// Finishes all queued work before returning.
+void StopAsyncWorker(AardvarkBusState& state) {
+    if (!state.worker.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(state.queue_mutex);
+        state.stopping = true;
+    }
+    state.queue_cv.notify_one();
+    state.worker.join();
+}
+
+std::future<plas::core::Result<size_t>> MakeReadyFuture(
+    plas::core::Result<size_t> result) {
+    std::promise<plas::core::Result<size_t>> promise;
+    promise.set_value(std::move(result));
+    return promise.get_future();
+}
+
 }  // namespace
 
 namespace plas::hal::driver {
@@ -74,6 +255,8 @@ static core::ErrorCode MapAardvarkError(int status) {
         case AA_COMMUNICATION_ERROR:
             return core::ErrorCode::kIOError;
         case AA_I2C_NOT_AVAILABLE:
+        case AA_SPI_NOT_AVAILABLE:
+        case AA_GPIO_NOT_AVAILABLE:
             return core::ErrorCode::kNotSupported;
         case AA_I2C_SLAVE_TIMEOUT:
             return core::ErrorCode::kTimeout;
@@ -91,39 +274,17 @@ static core::ErrorCode MapAardvarkError(int status) {
 // URI parsing: aardvark://port:address
 // ---------------------------------------------------------------------------
 
-bool AardvarkDevice::ParseUri(const std::string& uri, uint16_t& port,
+bool AardvarkDevice::ParseUri(const config::DeviceUri& uri, uint16_t& port,
                               uint16_t& addr) {
-    const std::string prefix = "aardvark://";
-    if (uri.size() <= prefix.size() ||
-        uri.compare(0, prefix.size(), prefix) != 0) {
-        return false;
-    }
-
-    auto body = uri.substr(prefix.size());
-    auto colon = body.find(':');
-    if (colon == std::string::npos || colon == 0 ||
-        colon == body.size() - 1) {
-        return false;
-    }
-
-    auto port_str = body.substr(0, colon);
-    auto addr_str = body.substr(colon + 1);
-
-    // Parse port (decimal)
-    char* end = nullptr;
-    unsigned long port_val = std::strtoul(port_str.c_str(), &end, 10);
-    if (end == port_str.c_str() || *end != '\0' || port_val > 65535) {
+    if (!uri.IsValid() || uri.Scheme() != "aardvark" || uri.FieldCount() != 2) {
         return false;
     }
 
-    // Parse address (hex or decimal via strtoul base 0)
-    end = nullptr;
-    unsigned long addr_val = std::strtoul(addr_str.c_str(), &end, 0);
-    if (end == addr_str.c_str() || *end != '\0' || addr_val > 0x7F) {
+    // Port is decimal; address is hex or decimal (C prefix rules)
+    uint64_t addr_val = 0;
+    if (!uri.Number(0, 10, port) || !uri.Number(1, 0, 0x7F, addr_val)) {
         return false;
     }
-
-    port = static_cast<uint16_t>(port_val);
     addr = static_cast<uint16_t>(addr_val);
     return true;
 }
@@ -133,14 +294,29 @@ bool AardvarkDevice::ParseUri(const std::string& uri, uint16_t& port,
 // ---------------------------------------------------------------------------
 
 AardvarkDevice::AardvarkDevice(const config::DeviceEntry& entry)
+    : AardvarkDevice(entry, config::DeviceUri::Parse(entry.uri)) {}
+
+AardvarkDevice::AardvarkDevice(const config::DeviceEntry& entry,
+                               const config::DeviceUri& uri)
     : name_(entry.nickname),
       uri_(entry.uri),
       state_(DeviceState::kUninitialized),
       bitrate_(100000),
+      probe_bitrate_(false),
       port_(0),
       default_addr_(0),
       pullup_enabled_(true),
-      bus_timeout_ms_(200) {
+      bus_timeout_ms_(200),
+      async_enabled_(false),
+      priority_(Priority::kNormal),
+      max_wait_ms_(0),
+      spi_bitrate_(1000000),
+      spi_mode_(SpiMode::kMode0),
+      gpio_pins_(kSpiPins),
+      trace_id_(0),
+      metrics_(nullptr) {
+    uri_valid_ = ParseUri(uri, port_, default_addr_);
+
     // Parse optional config args
     auto it = entry.args.find("bitrate");
     if (it != entry.args.end()) {
@@ -168,6 +344,107 @@ AardvarkDevice::AardvarkDevice(const config::DeviceEntry& entry)
             bus_timeout_ms_ = static_cast<uint16_t>(val);
         }
     }
+
+    it = entry.args.find("async");
+    if (it != entry.args.end()) {
+        if (it->second == "true" || it->second == "1") {
+            async_enabled_ = true;
+        } else if (it->second == "false" || it->second == "0") {
+            async_enabled_ = false;
+        }
+    }
+
+    it = entry.args.find("priority");
+    if (it != entry.args.end()) {
+        if (it->second == "high") {
+            priority_ = Priority::kHigh;
+        } else if (it->second == "normal") {
+            priority_ = Priority::kNormal;
+        } else if (it->second == "low") {
+            priority_ = Priority::kLow;
+        }
+    }
+
+    it = entry.args.find("max_wait_ms");
+    if (it != entry.args.end()) {
+        char* end = nullptr;
+        unsigned long val = std::strtoul(it->second.c_str(), &end, 10);
+        if (end != it->second.c_str() && *end == '\0' && val <= 0xFFFFFFFFul) {
+            max_wait_ms_ = static_cast<uint32_t>(val);
+        }
+    }
+
+    // "addr=bitrate,..." — malformed entries are skipped like other bad args
+    it = entry.args.find("target_bitrates");
+    if (it != entry.args.end()) {
+        const std::string& text = it->second;
+        size_t pos = 0;
+        while (pos <= text.size()) {
+            size_t comma = text.find(',', pos);
+            if (comma == std::string::npos) {
+                comma = text.size();
+            }
+            std::string item = text.substr(pos, comma - pos);
+            size_t eq = item.find('=');
+            if (eq != std::string::npos) {
+                std::string addr_text = item.substr(0, eq);
+                std::string rate_text = item.substr(eq + 1);
+                char* addr_end = nullptr;
+                char* rate_end = nullptr;
+                unsigned long addr = std::strtoul(addr_text.c_str(), &addr_end, 0);
+                unsigned long rate = std::strtoul(rate_text.c_str(), &rate_end, 10);
+                if (addr_end != addr_text.c_str() && *addr_end == '\0' &&
+                    addr <= 0x7F && rate_end != rate_text.c_str() &&
+                    *rate_end == '\0' && rate > 0 && rate <= 0xFFFFFFFFul) {
+                    target_bitrates_[static_cast<uint16_t>(addr)] =
+                        static_cast<uint32_t>(rate);
+                } else {
+                    PLAS_LOG_WARN("AardvarkDevice device='" + name_ +
+                                  "' ignoring target_bitrates entry '" + item +
+                                  "'");
+                }
+            }
+            pos = comma + 1;
+        }
+    }
+
+    it = entry.args.find("probe_bitrate");
+    if (it != entry.args.end()) {
+        if (it->second == "true" || it->second == "1") {
+            probe_bitrate_ = true;
+        } else if (it->second == "false" || it->second == "0") {
+            probe_bitrate_ = false;
+        }
+    }
+
+    it = entry.args.find("spi_bitrate");
+    if (it != entry.args.end()) {
+        char* end = nullptr;
+        unsigned long val = std::strtoul(it->second.c_str(), &end, 10);
+        if (end != it->second.c_str() && *end == '\0' && val >= kSpiMinBitrate &&
+            val <= kSpiMaxBitrate) {
+            spi_bitrate_ = static_cast<uint32_t>(val);
+        }
+    }
+
+    it = entry.args.find("spi_mode");
+    if (it != entry.args.end()) {
+        char* end = nullptr;
+        unsigned long val = std::strtoul(it->second.c_str(), &end, 10);
+        if (end != it->second.c_str() && *end == '\0' && val <= 3) {
+            spi_mode_ = static_cast<SpiMode>(val);
+        }
+    }
+
+    it = entry.args.find("gpio_pins");
+    if (it != entry.args.end()) {
+        char* end = nullptr;
+        unsigned long val = std::strtoul(it->second.c_str(), &end, 0);
+        if (end != it->second.c_str() && *end == '\0' &&
+            val <= (kI2cPins | kSpiPins)) {
+            gpio_pins_ = static_cast<uint32_t>(val);
+        }
+    }
 }
 
 AardvarkDevice::~AardvarkDevice() {
@@ -186,7 +463,7 @@ core::Result<void> AardvarkDevice::Init() {
         return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
     }
 
-    if (!ParseUri(uri_, port_, default_addr_)) {
+    if (!uri_valid_) {
         PLAS_LOG_ERROR("AardvarkDevice::Init() invalid URI: " + uri_);
         return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
     }
@@ -199,10 +476,42 @@ core::Result<void> AardvarkDevice::Init() {
 }
 
 core::Result<void> AardvarkDevice::Open() {
+    auto result = OpenBus();
+    if (result.IsError() || !probe_bitrate_) {
+        return result;
+    }
+
+    // Probe failures leave the configured rates in place.
+    std::set<uint16_t> targets{default_addr_};
+    for (const auto& [addr, rate] : target_bitrates_) {
+        targets.insert(addr);
+    }
+    for (uint16_t addr : targets) {
+        {
+            std::lock_guard<std::mutex> lock(bus_state_->probe_mutex);
+            if (bus_state_->probed_bitrates.count(addr) != 0) {
+                continue;
+            }
+        }
+        auto probed = ProbeMaxBitrate(addr);
+        if (probed.IsError()) {
+            PLAS_LOG_WARN("AardvarkDevice::Open() device='" + name_ +
+                          "' bitrate probe of addr=" + std::to_string(addr) +
+                          " failed: " + probed.Error().message());
+        }
+    }
+    return result;
+}
+
+core::Result<void> AardvarkDevice::OpenBus() {
     if (state_ != DeviceState::kInitialized) {
         return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
     }
 
+    ResetBusWaitStats();
+    trace_id_ = log::Tracer::GetInstance().RegisterDevice(name_);
+    metrics_ = MetricsRegistry::GetInstance().GetDeviceMetrics(name_);
+
     {
         std::lock_guard<std::mutex> reg_lock(GetRegistryMutex());
 
@@ -211,15 +520,9 @@ core::Result<void> AardvarkDevice::Open() {
         if (it != registry.end()) {
             auto existing = it->second.lock();
             if (existing) {
-                // Check for config conflicts and warn
+                // Check for config conflicts and warn. Bitrates may differ:
+                // each transaction switches the clock to its target's rate.
                 if (existing->active_bitrate != 0) {
-                    if (bitrate_ != existing->active_bitrate) {
-                        PLAS_LOG_WARN(
-                            "AardvarkDevice::Open() device='" + name_ +
-                            "' bitrate conflict: requested=" +
-                            std::to_string(bitrate_) + " active=" +
-                            std::to_string(existing->active_bitrate));
-                    }
                     if (pullup_enabled_ != existing->active_pullup) {
                         PLAS_LOG_WARN(
                             "AardvarkDevice::Open() device='" + name_ +
@@ -235,6 +538,9 @@ core::Result<void> AardvarkDevice::Open() {
                 }
                 bus_state_ = existing;
                 bus_state_->ref_count++;
+                if (async_enabled_) {
+                    StartAsyncWorker(*bus_state_);
+                }
                 PLAS_LOG_INFO(
                     "AardvarkDevice::Open() device='" + name_ +
                     "' joined shared bus port=" + std::to_string(port_) +
@@ -271,13 +577,16 @@ core::Result<void> AardvarkDevice::Open() {
             name_ + "'");
 #endif
 
-        new_state->active_bitrate = bitrate_;
+        new_state->active_bitrate = bitrate_.load();
         new_state->active_pullup  = pullup_enabled_;
         new_state->active_timeout = bus_timeout_ms_;
         new_state->ref_count      = 1;
 
         registry[port_] = new_state;  // store weak_ptr
         bus_state_      = new_state;  // hold strong ref
+        if (async_enabled_) {
+            StartAsyncWorker(*bus_state_);
+        }
 
         PLAS_LOG_INFO("AardvarkDevice::Open() device='" + name_ +
                       "' opened new bus port=" + std::to_string(port_) +
@@ -293,11 +602,28 @@ core::Result<void> AardvarkDevice::Close() {
         return core::Result<void>::Err(core::ErrorCode::kAlreadyClosed);
     }
 
+    // Queued jobs reference this instance; a fence queued behind them (same
+    // owner, so PlanBatch keeps it last) waits until all of this device's
+    // requests have completed.
+    if (async_enabled_) {
+        std::promise<void> drained;
+        auto fence = drained.get_future();
+        {
+            std::lock_guard<std::mutex> lock(bus_state_->queue_mutex);
+            bus_state_->queue.push_back(
+                {static_cast<int>(priority_), this, 0, 0, 0,
+                 [&drained] { drained.set_value(); }});
+        }
+        bus_state_->queue_cv.notify_one();
+        fence.wait();
+    }
+
     {
         std::lock_guard<std::mutex> reg_lock(GetRegistryMutex());
 
         bus_state_->ref_count--;
         if (bus_state_->ref_count == 0) {
+            StopAsyncWorker(*bus_state_);
 #ifdef PLAS_HAS_AARDVARK
             if (bus_state_->handle >= 0) {
                 aa_close(bus_state_->handle);
@@ -355,6 +681,283 @@ Device* AardvarkDevice::GetDevice() {
 // I2c interface
 // ---------------------------------------------------------------------------
 
+#ifdef PLAS_HAS_AARDVARK
+core::Result<size_t> AardvarkDevice::ReadLocked(core::Address addr,
+                                                core::Byte* data,
+                                                size_t length, bool stop) {
+    auto clock = ApplyBitrateLocked(GetTargetBitrate(addr));
+    if (clock.IsError()) {
+        return core::Result<size_t>::Err(clock.Error());
+    }
+    log::TraceSpan span(trace_id_, log::TraceInterface::kI2c,
+                        log::TraceOp::kRead, addr, length);
+    MetricsTimer timer(metrics_, MetricOp::kI2cRead, length);
+    auto flags = static_cast<uint16_t>(stop ? AA_I2C_NO_FLAGS : AA_I2C_NO_STOP);
+    int result = aa_i2c_read(bus_state_->handle, static_cast<uint16_t>(addr),
+                             flags, static_cast<uint16_t>(length), data);
+    if (result < 0) {
+        auto err = MapAardvarkError(result);
+        span.SetStatus(make_error_code(err));
+        timer.SetError();
+        PLAS_LOG_DEVICE_ERROR(name_, "I2c", "Read addr=" + std::to_string(addr) +
+                              " len=" + std::to_string(length) + " failed: " +
+                              make_error_code(err).message());
+        return core::Result<size_t>::Err(err);
+    }
+    span.SetLength(static_cast<size_t>(result));
+    timer.SetBytes(static_cast<size_t>(result));
+    return core::Result<size_t>::Ok(static_cast<size_t>(result));
+}
+
+core::Result<size_t> AardvarkDevice::WriteLocked(core::Address addr,
+                                                 const core::Byte* data,
+                                                 size_t length, bool stop) {
+    auto clock = ApplyBitrateLocked(GetTargetBitrate(addr));
+    if (clock.IsError()) {
+        return core::Result<size_t>::Err(clock.Error());
+    }
+    log::TraceSpan span(trace_id_, log::TraceInterface::kI2c,
+                        log::TraceOp::kWrite, addr, length);
+    MetricsTimer timer(metrics_, MetricOp::kI2cWrite, length);
+    auto flags = static_cast<uint16_t>(stop ? AA_I2C_NO_FLAGS : AA_I2C_NO_STOP);
+    int result = aa_i2c_write(bus_state_->handle, static_cast<uint16_t>(addr),
+                              flags, static_cast<uint16_t>(length), data);
+    if (result < 0) {
+        auto err = MapAardvarkError(result);
+        span.SetStatus(make_error_code(err));
+        timer.SetError();
+        PLAS_LOG_DEVICE_ERROR(name_, "I2c", "Write addr=" + std::to_string(addr) +
+                              " len=" + std::to_string(length) + " failed: " +
+                              make_error_code(err).message());
+        return core::Result<size_t>::Err(err);
+    }
+    span.SetLength(static_cast<size_t>(result));
+    timer.SetBytes(static_cast<size_t>(result));
+    return core::Result<size_t>::Ok(static_cast<size_t>(result));
+}
+
+core::Result<size_t> AardvarkDevice::WriteReadLocked(
+    core::Address addr, const core::Byte* write_data, size_t write_len,
+    core::Byte* read_data, size_t read_len) {
+    auto clock = ApplyBitrateLocked(GetTargetBitrate(addr));
+    if (clock.IsError()) {
+        return core::Result<size_t>::Err(clock.Error());
+    }
+    log::TraceSpan span(trace_id_, log::TraceInterface::kI2c,
+                        log::TraceOp::kWriteRead, addr, write_len + read_len);
+    MetricsTimer timer(metrics_, MetricOp::kI2cWriteRead, write_len + read_len);
+    int result = aa_i2c_write_read(bus_state_->handle,
+                                   static_cast<uint16_t>(addr),
+                                   AA_I2C_NO_FLAGS,
+                                   static_cast<uint16_t>(write_len),
+                                   write_data,
+                                   static_cast<uint16_t>(read_len),
+                                   read_data);
+    if (result < 0) {
+        auto err = MapAardvarkError(result);
+        span.SetStatus(make_error_code(err));
+        timer.SetError();
+        PLAS_LOG_DEVICE_ERROR(name_, "I2c", "WriteRead addr=" + std::to_string(addr) +
+                              " wlen=" + std::to_string(write_len) +
+                              " rlen=" + std::to_string(read_len) + " failed: " +
+                              make_error_code(err).message());
+        return core::Result<size_t>::Err(err);
+    }
+    return core::Result<size_t>::Ok(static_cast<size_t>(result));
+}
+
+core::Result<size_t> AardvarkDevice::BlockReadLocked(
+    core::Address addr, const core::Byte* write, size_t write_len,
+    core::Byte* read, size_t read_len, bool pec) {
+    auto clock = ApplyBitrateLocked(GetTargetBitrate(addr));
+    if (clock.IsError()) {
+        return core::Result<size_t>::Err(clock.Error());
+    }
+    log::TraceSpan span(trace_id_, log::TraceInterface::kI2c,
+                        log::TraceOp::kWriteRead, addr, write_len + read_len);
+    MetricsTimer timer(metrics_, MetricOp::kI2cWriteRead, write_len + read_len);
+    // The write leaves the bus held; the sized read follows with a repeated
+    // START, takes the byte count and stops after that many bytes (one more
+    // with EXTRA1, for PEC).
+    uint16_t written = 0;
+    uint16_t num_read = 0;
+    int status = aa_i2c_write_ext(bus_state_->handle,
+                                  static_cast<uint16_t>(addr), AA_I2C_NO_STOP,
+                                  static_cast<uint16_t>(write_len), write,
+                                  &written);
+    if (status == AA_I2C_STATUS_OK) {
+        auto flags = static_cast<uint16_t>(pec ? AA_I2C_SIZED_READ_EXTRA1
+                                               : AA_I2C_SIZED_READ);
+        status = aa_i2c_read_ext(bus_state_->handle,
+                                 static_cast<uint16_t>(addr), flags,
+                                 static_cast<uint16_t>(read_len), read,
+                                 &num_read);
+    }
+    if (status != AA_I2C_STATUS_OK) {
+        auto err = status < 0 ? MapAardvarkError(status)
+                   : status == AA_I2C_STATUS_BUS_LOCKED
+                       ? core::ErrorCode::kTimeout
+                       : core::ErrorCode::kIOError;
+        span.SetStatus(make_error_code(err));
+        timer.SetError();
+        PLAS_LOG_DEVICE_ERROR(name_, "SmBus", "BlockRead addr=" +
+                              std::to_string(addr) + " status=" +
+                              std::to_string(status) + " failed: " +
+                              make_error_code(err).message());
+        return core::Result<size_t>::Err(err);
+    }
+    if (num_read > 0 && 1u + read[0] + (pec ? 1u : 0u) > read_len) {
+        span.SetStatus(make_error_code(core::ErrorCode::kOverflow));
+        timer.SetError();
+        return core::Result<size_t>::Err(core::ErrorCode::kOverflow);
+    }
+    span.SetLength(write_len + num_read);
+    timer.SetBytes(write_len + num_read);
+    return core::Result<size_t>::Ok(static_cast<size_t>(num_read));
+}
+#else
+// The clock switch is still tracked, so scheduling can be tested without
+// an adapter.
+core::Result<size_t> AardvarkDevice::ReadLocked(core::Address addr,
+                                                core::Byte* /*data*/,
+                                                size_t /*length*/,
+                                                bool /*stop*/) {
+    ApplyBitrateLocked(GetTargetBitrate(addr));
+    return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+}
+
+core::Result<size_t> AardvarkDevice::WriteLocked(core::Address addr,
+                                                 const core::Byte* /*data*/,
+                                                 size_t /*length*/,
+                                                 bool /*stop*/) {
+    ApplyBitrateLocked(GetTargetBitrate(addr));
+    return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+}
+
+core::Result<size_t> AardvarkDevice::WriteReadLocked(
+    core::Address addr, const core::Byte* /*write_data*/,
+    size_t /*write_len*/, core::Byte* /*read_data*/, size_t /*read_len*/) {
+    ApplyBitrateLocked(GetTargetBitrate(addr));
+    return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+}
+
+core::Result<size_t> AardvarkDevice::BlockReadLocked(
+    core::Address addr, const core::Byte* /*write*/, size_t /*write_len*/,
+    core::Byte* /*read*/, size_t /*read_len*/, bool /*pec*/) {
+    ApplyBitrateLocked(GetTargetBitrate(addr));
+    return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+}
+#endif
+
+core::Result<void> AardvarkDevice::ApplyBitrateLocked(uint32_t bitrate) {
+    auto mode = ApplyModeLocked(kModeI2c, 0);
+    if (mode.IsError()) {
+        return mode;
+    }
+    if (bus_state_->active_bitrate == bitrate) {
+        return core::Result<void>::Ok();
+    }
+#ifdef PLAS_HAS_AARDVARK
+    int actual_khz = aa_i2c_bitrate(bus_state_->handle,
+                                    static_cast<int>(bitrate / 1000));
+    if (actual_khz < 0) {
+        PLAS_LOG_DEVICE_ERROR(name_, "I2c", "bitrate switch to " +
+                              std::to_string(bitrate) + " failed");
+        return core::Result<void>::Err(MapAardvarkError(actual_khz));
+    }
+#endif
+    bus_state_->active_bitrate = bitrate;
+    std::lock_guard<std::mutex> lock(wait_stats_mutex_);
+    wait_stats_.bitrate_switches++;
+    return core::Result<void>::Ok();
+}
+
+core::Result<size_t> AardvarkDevice::TransferLocked(I2cMessage* msgs,
+                                                    size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        auto& msg = msgs[i];
+        bool stop = msg.stop || i + 1 == count;
+
+        // write(no STOP) + read(STOP) to the same target maps onto a single
+        // combined aa_i2c_write_read instead of two USB round trips.
+        if (!msg.read && !stop && i + 1 < count) {
+            auto& next = msgs[i + 1];
+            bool next_stop = next.stop || i + 2 == count;
+            if (next.read && next.addr == msg.addr && next_stop) {
+                auto result = WriteReadLocked(msg.addr, msg.data, msg.length,
+                                              next.data, next.length);
+                if (result.IsError()) {
+                    return core::Result<size_t>::Err(result.Error());
+                }
+                msg.transferred = msg.length;
+                next.transferred = result.Value();
+                ++i;
+                continue;
+            }
+        }
+
+        auto result = msg.read
+                          ? ReadLocked(msg.addr, msg.data, msg.length, stop)
+                          : WriteLocked(msg.addr, msg.data, msg.length, stop);
+        if (result.IsError()) {
+            return core::Result<size_t>::Err(result.Error());
+        }
+        msg.transferred = result.Value();
+    }
+    return core::Result<size_t>::Ok(count);
+}
+
+#ifdef PLAS_HAS_AARDVARK
+core::Result<size_t> AardvarkDevice::ScanLocked(
+    core::Address first, core::Address last, std::chrono::milliseconds timeout,
+    std::vector<core::Address>& found) {
+    auto clock = ApplyBitrateLocked(bitrate_);
+    if (clock.IsError()) {
+        return core::Result<size_t>::Err(clock.Error());
+    }
+    // A NACKed probe returns at once; the bus timeout only bounds a target
+    // stretching the clock, so a short one keeps a wedged address cheap.
+    auto timeout_ms = static_cast<uint16_t>(
+        std::min<std::chrono::milliseconds::rep>(timeout.count(), 65535));
+    bool retime = timeout_ms > 0 && timeout_ms != bus_state_->active_timeout;
+    if (retime) {
+        aa_i2c_bus_timeout(bus_state_->handle, timeout_ms);
+    }
+    auto result = core::Result<size_t>::Ok(0);
+    for (core::Address addr = first; addr <= last; ++addr) {
+        uint16_t written = 0;
+        int status = aa_i2c_write_ext(bus_state_->handle,
+                                      static_cast<uint16_t>(addr),
+                                      AA_I2C_NO_FLAGS, 0, nullptr, &written);
+        if (status == AA_I2C_STATUS_OK) {
+            found.push_back(addr);
+        } else if (status < 0) {
+            result = core::Result<size_t>::Err(MapAardvarkError(status));
+            break;
+        } else if (status == AA_I2C_STATUS_BUS_LOCKED) {
+            result = core::Result<size_t>::Err(core::ErrorCode::kTimeout);
+            break;
+        }
+        // Any other status (address NACK, lost arbitration): no target.
+    }
+    if (retime) {
+        aa_i2c_bus_timeout(bus_state_->handle, bus_state_->active_timeout);
+    }
+    if (result.IsOk()) {
+        result = core::Result<size_t>::Ok(found.size());
+    }
+    return result;
+}
+#else
+core::Result<size_t> AardvarkDevice::ScanLocked(
+    core::Address /*first*/, core::Address /*last*/,
+    std::chrono::milliseconds /*timeout*/,
+    std::vector<core::Address>& /*found*/) {
+    ApplyBitrateLocked(bitrate_);
+    return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+}
+#endif
+
 core::Result<size_t> AardvarkDevice::Read(core::Address addr,
                                           core::Byte* data, size_t length,
                                           bool stop) {
@@ -368,26 +971,13 @@ core::Result<size_t> AardvarkDevice::Read(core::Address addr,
         return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
     }
 
-#ifdef PLAS_HAS_AARDVARK
-    std::lock_guard<std::mutex> lock(bus_state_->bus_mutex);
-    auto flags = static_cast<uint16_t>(stop ? AA_I2C_NO_FLAGS : AA_I2C_NO_STOP);
-    int result = aa_i2c_read(bus_state_->handle, static_cast<uint16_t>(addr),
-                             flags, static_cast<uint16_t>(length), data);
-    if (result < 0) {
-        auto err = MapAardvarkError(result);
-        PLAS_LOG_ERROR("[" + name_ + "][I2c] Read addr=" + std::to_string(addr) +
-                       " len=" + std::to_string(length) + " failed: " +
-                       make_error_code(err).message());
-        return core::Result<size_t>::Err(err);
+    if (async_enabled_) {
+        return Submit(GetTargetBitrate(addr),
+                      [=] { return ReadLocked(addr, data, length, stop); })
+            .get();
     }
-    return core::Result<size_t>::Ok(static_cast<size_t>(result));
-#else
-    (void)addr;
-    (void)data;
-    (void)length;
-    (void)stop;
-    return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
-#endif
+    return RunOnBus(std::chrono::steady_clock::now(),
+                    [=] { return ReadLocked(addr, data, length, stop); });
 }
 
 core::Result<size_t> AardvarkDevice::Write(core::Address addr,
@@ -403,26 +993,13 @@ core::Result<size_t> AardvarkDevice::Write(core::Address addr,
         return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
     }
 
-#ifdef PLAS_HAS_AARDVARK
-    std::lock_guard<std::mutex> lock(bus_state_->bus_mutex);
-    auto flags = static_cast<uint16_t>(stop ? AA_I2C_NO_FLAGS : AA_I2C_NO_STOP);
-    int result = aa_i2c_write(bus_state_->handle, static_cast<uint16_t>(addr),
-                              flags, static_cast<uint16_t>(length), data);
-    if (result < 0) {
-        auto err = MapAardvarkError(result);
-        PLAS_LOG_ERROR("[" + name_ + "][I2c] Write addr=" + std::to_string(addr) +
-                       " len=" + std::to_string(length) + " failed: " +
-                       make_error_code(err).message());
-        return core::Result<size_t>::Err(err);
+    if (async_enabled_) {
+        return Submit(GetTargetBitrate(addr),
+                      [=] { return WriteLocked(addr, data, length, stop); })
+            .get();
     }
-    return core::Result<size_t>::Ok(static_cast<size_t>(result));
-#else
-    (void)addr;
-    (void)data;
-    (void)length;
-    (void)stop;
-    return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
-#endif
+    return RunOnBus(std::chrono::steady_clock::now(),
+                    [=] { return WriteLocked(addr, data, length, stop); });
 }
 
 core::Result<size_t> AardvarkDevice::WriteRead(core::Address addr,
@@ -441,32 +1018,601 @@ core::Result<size_t> AardvarkDevice::WriteRead(core::Address addr,
         return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
     }
 
+    if (async_enabled_) {
+        return Submit(GetTargetBitrate(addr),
+                      [=] {
+                          return WriteReadLocked(addr, write_data, write_len,
+                                                 read_data, read_len);
+                      })
+            .get();
+    }
+    return RunOnBus(std::chrono::steady_clock::now(), [=] {
+        return WriteReadLocked(addr, write_data, write_len, read_data,
+                               read_len);
+    });
+}
+
+core::Result<size_t> AardvarkDevice::Transfer(I2cMessage* msgs, size_t count) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (msgs == nullptr && count > 0) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (msgs[i].data == nullptr || msgs[i].length == 0 ||
+            msgs[i].length > 0xFFFF) {
+            return core::Result<size_t>::Err(
+                core::ErrorCode::kInvalidArgument);
+        }
+    }
+
+    if (async_enabled_) {
+        uint32_t bitrate = count > 0 ? GetTargetBitrate(msgs[0].addr) : 0;
+        return Submit(bitrate, [=] { return TransferLocked(msgs, count); })
+            .get();
+    }
+    return RunOnBus(std::chrono::steady_clock::now(),
+                    [=] { return TransferLocked(msgs, count); });
+}
+
+core::Result<size_t> AardvarkDevice::Transact(core::Address addr,
+                                              const core::Byte* write,
+                                              size_t write_len,
+                                              core::Byte* read,
+                                              size_t read_len, bool block,
+                                              bool pec) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (write == nullptr || write_len == 0 ||
+        (read == nullptr && read_len > 0)) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (write_len > 0xFFFF || read_len > 0xFFFF) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    auto op = [=]() -> core::Result<size_t> {
+        if (read_len == 0) {
+            return WriteLocked(addr, write, write_len, true);
+        }
+        if (!block) {
+            return WriteReadLocked(addr, write, write_len, read, read_len);
+        }
+        return BlockReadLocked(addr, write, write_len, read, read_len, pec);
+    };
+    if (async_enabled_) {
+        return Submit(GetTargetBitrate(addr), op).get();
+    }
+    return RunOnBus(std::chrono::steady_clock::now(), op);
+}
+
+core::Result<bool> AardvarkDevice::Probe(core::Address addr) {
+    auto found = Scan(addr, addr);
+    if (found.IsError()) {
+        return core::Result<bool>::Err(found.Error());
+    }
+    return core::Result<bool>::Ok(!found.Value().empty());
+}
+
+core::Result<std::vector<core::Address>> AardvarkDevice::Scan(
+    core::Address first, core::Address last, std::chrono::milliseconds timeout) {
+    using ScanResult = core::Result<std::vector<core::Address>>;
+    if (state_ != DeviceState::kOpen) {
+        return ScanResult::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (first > last || last > 0x7F) {
+        return ScanResult::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    std::vector<core::Address> found;
+    auto op = [this, first, last, timeout, &found] {
+        return ScanLocked(first, last, timeout, found);
+    };
+    auto result = async_enabled_ ? Submit(bitrate_, op).get()
+                                 : RunOnBus(Clock::now(), op);
+    if (result.IsError()) {
+        return ScanResult::Err(result.Error());
+    }
+    return ScanResult::Ok(std::move(found));
+}
+
+// ---------------------------------------------------------------------------
+// Adapter mode
+// ---------------------------------------------------------------------------
+
+uint8_t AardvarkDevice::ModesOfPins(uint32_t pins) {
+    return static_cast<uint8_t>(((pins & kI2cPins) != 0 ? kModeI2c : 0) |
+                                ((pins & kSpiPins) != 0 ? kModeSpi : 0));
+}
+
+core::Result<void> AardvarkDevice::ApplyModeLocked(uint8_t on, uint8_t off) {
+    uint8_t mode = bus_state_->active_mode;
+    auto next = static_cast<uint8_t>((mode | on) & ~off);
+    if (next == mode) {
+        return core::Result<void>::Ok();
+    }
 #ifdef PLAS_HAS_AARDVARK
-    std::lock_guard<std::mutex> lock(bus_state_->bus_mutex);
-    int result = aa_i2c_write_read(bus_state_->handle,
-                                   static_cast<uint16_t>(addr),
-                                   AA_I2C_NO_FLAGS,
-                                   static_cast<uint16_t>(write_len),
-                                   write_data,
-                                   static_cast<uint16_t>(read_len),
-                                   read_data);
+    int result = aa_configure(bus_state_->handle, static_cast<AardvarkConfig>(next));
     if (result < 0) {
-        auto err = MapAardvarkError(result);
-        PLAS_LOG_ERROR("[" + name_ + "][I2c] WriteRead addr=" + std::to_string(addr) +
-                       " wlen=" + std::to_string(write_len) +
-                       " rlen=" + std::to_string(read_len) + " failed: " +
-                       make_error_code(err).message());
+        PLAS_LOG_ERROR("[" + name_ + "] mode switch to " + std::to_string(next) +
+                       " failed");
+        return core::Result<void>::Err(MapAardvarkError(result));
+    }
+    // Pins handed back to GPIO take the port's outputs and directions again.
+    if (bus_state_->gpio_direction != 0) {
+        aa_gpio_set(bus_state_->handle, static_cast<u08>(bus_state_->gpio_outputs));
+        aa_gpio_direction(bus_state_->handle,
+                          static_cast<u08>(bus_state_->gpio_direction));
+    }
+#endif
+    bus_state_->active_mode = next;
+    std::lock_guard<std::mutex> lock(wait_stats_mutex_);
+    wait_stats_.mode_switches++;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> AardvarkDevice::ApplySpiLocked() {
+    auto mode = ApplyModeLocked(kModeSpi, 0);
+    if (mode.IsError()) {
+        return mode;
+    }
+    auto& bus = *bus_state_;
+    uint32_t bitrate = spi_bitrate_;
+    auto spi_mode = static_cast<int>(spi_mode_.load());
+#ifdef PLAS_HAS_AARDVARK
+    if (bus.active_spi_mode != spi_mode) {
+        if (bus.active_spi_mode < 0) {
+            aa_spi_master_ss_polarity(bus.handle, AA_SPI_SS_ACTIVE_LOW);
+        }
+        int status = aa_spi_configure(bus.handle,
+                                      static_cast<AardvarkSpiPolarity>(spi_mode >> 1),
+                                      static_cast<AardvarkSpiPhase>(spi_mode & 1),
+                                      AA_SPI_BITORDER_MSB);
+        if (status < 0) {
+            PLAS_LOG_DEVICE_ERROR(name_, "Spi", "mode " + std::to_string(spi_mode) +
+                                  " failed");
+            return core::Result<void>::Err(MapAardvarkError(status));
+        }
+    }
+    if (bus.active_spi_bitrate != bitrate) {
+        int actual_khz = aa_spi_bitrate(bus.handle, static_cast<int>(bitrate / 1000));
+        if (actual_khz < 0) {
+            PLAS_LOG_DEVICE_ERROR(name_, "Spi", "bitrate switch to " +
+                                  std::to_string(bitrate) + " failed");
+            return core::Result<void>::Err(MapAardvarkError(actual_khz));
+        }
+    }
+#endif
+    bus.active_spi_mode = spi_mode;
+    bus.active_spi_bitrate = bitrate;
+    return core::Result<void>::Ok();
+}
+
+core::Result<size_t> AardvarkDevice::RunOp(
+    uint8_t mode_on, uint8_t mode_off,
+    const std::function<core::Result<size_t>()>& op) {
+    if (async_enabled_) {
+        return Submit(0, mode_on, mode_off, op).get();
+    }
+    return RunOnBus(Clock::now(), op);
+}
+
+// ---------------------------------------------------------------------------
+// Spi interface
+// ---------------------------------------------------------------------------
+
+#ifdef PLAS_HAS_AARDVARK
+core::Result<size_t> AardvarkDevice::SpiTransferLocked(const core::Byte* head,
+                                                       size_t head_len,
+                                                       const core::Byte* write,
+                                                       core::Byte* read,
+                                                       size_t length) {
+    auto spi = ApplySpiLocked();
+    if (spi.IsError()) {
+        return core::Result<size_t>::Err(spi.Error());
+    }
+    auto op = write == nullptr ? log::TraceOp::kRead
+              : read == nullptr ? log::TraceOp::kWrite
+                                : log::TraceOp::kExchange;
+    log::TraceSpan span(trace_id_, log::TraceInterface::kSpi, op, 0, length);
+    MetricsTimer timer(metrics_,
+                       read != nullptr ? MetricOp::kSpiRead : MetricOp::kSpiWrite,
+                       length);
+
+    // The adapter frames SS around one call, so the whole frame goes out
+    // from one buffer: the caller's when there is nothing in front of it.
+    size_t total = head_len + length;
+    const core::Byte* out = write;
+    if (head_len > 0 || write == nullptr) {
+        auto& tx = bus_state_->spi_tx;
+        tx.resize(total);
+        if (head_len > 0) {
+            std::memcpy(tx.data(), head, head_len);
+        }
+        if (write != nullptr) {
+            std::memcpy(tx.data() + head_len, write, length);
+        } else {
+            std::memset(tx.data() + head_len, 0xFF, length);
+        }
+        out = tx.data();
+    }
+    core::Byte* in = nullptr;
+    if (read != nullptr) {
+        if (head_len > 0) {
+            bus_state_->spi_rx.resize(total);
+            in = bus_state_->spi_rx.data();
+        } else {
+            in = read;
+        }
+    }
+
+    int result = aa_spi_write(bus_state_->handle, static_cast<u16>(total), out,
+                              static_cast<u16>(in != nullptr ? total : 0), in);
+    if (result < 0 || (in != nullptr && static_cast<size_t>(result) != total)) {
+        auto err = result < 0 ? MapAardvarkError(result) : core::ErrorCode::kIOError;
+        span.SetStatus(make_error_code(err));
+        timer.SetError();
+        PLAS_LOG_DEVICE_ERROR(name_, "Spi", "transfer len=" + std::to_string(total) +
+                              " failed: " + make_error_code(err).message());
         return core::Result<size_t>::Err(err);
     }
-    return core::Result<size_t>::Ok(static_cast<size_t>(result));
+    if (in != nullptr && in != read) {
+        std::memcpy(read, in + head_len, length);
+    }
+    return core::Result<size_t>::Ok(length);
+}
 #else
-    (void)addr;
-    (void)write_data;
-    (void)write_len;
-    (void)read_data;
-    (void)read_len;
+// The mode switch is still tracked, as the bitrate is for I2c.
+core::Result<size_t> AardvarkDevice::SpiTransferLocked(const core::Byte* /*head*/,
+                                                       size_t /*head_len*/,
+                                                       const core::Byte* /*write*/,
+                                                       core::Byte* /*read*/,
+                                                       size_t /*length*/) {
+    ApplySpiLocked();
     return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+}
 #endif
+
+core::Result<size_t> AardvarkDevice::Exchange(const core::Byte* write,
+                                              core::Byte* read, size_t length,
+                                              bool end) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if ((write == nullptr && read == nullptr) || length == 0 ||
+        spi_pending_.size() + length > kSpiMaxTransfer) {
+        spi_pending_.clear();
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (!end) {
+        // Nothing is sent until the chip select ends, so there is nothing
+        // to read yet.
+        if (read != nullptr) {
+            spi_pending_.clear();
+            return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+        }
+        spi_pending_.insert(spi_pending_.end(), write, write + length);
+        return core::Result<size_t>::Ok(length);
+    }
+
+    std::vector<core::Byte> head;
+    head.swap(spi_pending_);
+    return RunOp(kModeSpi, 0, [this, &head, write, read, length] {
+        return SpiTransferLocked(head.data(), head.size(), write, read, length);
+    });
+}
+
+core::Result<size_t> AardvarkDevice::Command(const SpiCommand& command) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+    std::vector<core::Byte> head;
+    head.swap(spi_pending_);
+    size_t held = head.size();
+    head.resize(held + kSpiMaxCommandHeader);
+    auto header_len = EncodeSpiCommandHeader(command, head.data() + held);
+    if (header_len.IsError()) {
+        return header_len;
+    }
+    if (command.lines != SpiLines::kSingle) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+    }
+    head.resize(held + header_len.Value());
+    if (head.size() + command.length > kSpiMaxTransfer) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    return RunOp(kModeSpi, 0, [this, &head, &command] {
+        return SpiTransferLocked(head.data(), head.size(), command.write,
+                                 command.read, command.length);
+    });
+}
+
+core::Result<void> AardvarkDevice::SetClock(core::Frequency freq) {
+    if (freq.Value() < kSpiMinBitrate || freq.Value() > kSpiMaxBitrate) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+    // Applied by the next SPI transaction, like a per-target I2C rate.
+    spi_bitrate_ = static_cast<uint32_t>(freq.Value());
+    return core::Result<void>::Ok();
+}
+
+core::Frequency AardvarkDevice::GetClock() const {
+    return core::Frequency(static_cast<double>(spi_bitrate_.load()));
+}
+
+core::Result<void> AardvarkDevice::SetMode(SpiMode mode) {
+    if (static_cast<uint8_t>(mode) > 3) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    spi_mode_ = mode;
+    return core::Result<void>::Ok();
+}
+
+// ---------------------------------------------------------------------------
+// Gpio interface
+// ---------------------------------------------------------------------------
+
+#ifdef PLAS_HAS_AARDVARK
+core::Result<size_t> AardvarkDevice::GpioUpdateLocked(bool direction,
+                                                      uint32_t mask,
+                                                      uint32_t values) {
+    auto mode = ApplyModeLocked(0, ModesOfPins(mask));
+    if (mode.IsError()) {
+        return core::Result<size_t>::Err(mode.Error());
+    }
+    uint32_t& reg = direction ? bus_state_->gpio_direction : bus_state_->gpio_outputs;
+    uint32_t next = (reg & ~mask) | (values & mask);
+    int status = direction
+                     ? aa_gpio_direction(bus_state_->handle, static_cast<u08>(next))
+                     : aa_gpio_set(bus_state_->handle, static_cast<u08>(next));
+    if (status < 0) {
+        auto err = MapAardvarkError(status);
+        PLAS_LOG_DEVICE_ERROR(name_, "Gpio",
+                              std::string(direction ? "SetDirection" : "WritePins") + " mask=" +
+                              std::to_string(mask) + " failed: " +
+                              make_error_code(err).message());
+        return core::Result<size_t>::Err(err);
+    }
+    reg = next;
+    return core::Result<size_t>::Ok(0);
+}
+
+core::Result<size_t> AardvarkDevice::GpioReadLocked() {
+    auto mode = ApplyModeLocked(0, ModesOfPins(gpio_pins_));
+    if (mode.IsError()) {
+        return core::Result<size_t>::Err(mode.Error());
+    }
+    int value = aa_gpio_get(bus_state_->handle);
+    if (value < 0) {
+        auto err = MapAardvarkError(value);
+        PLAS_LOG_DEVICE_ERROR(name_, "Gpio", "ReadPins failed: " +
+                              make_error_code(err).message());
+        return core::Result<size_t>::Err(err);
+    }
+    return core::Result<size_t>::Ok(static_cast<size_t>(value) & gpio_pins_);
+}
+#else
+core::Result<size_t> AardvarkDevice::GpioUpdateLocked(bool /*direction*/,
+                                                      uint32_t mask,
+                                                      uint32_t /*values*/) {
+    ApplyModeLocked(0, ModesOfPins(mask));
+    return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+}
+
+core::Result<size_t> AardvarkDevice::GpioReadLocked() {
+    ApplyModeLocked(0, ModesOfPins(gpio_pins_));
+    return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+}
+#endif
+
+uint32_t AardvarkDevice::PinMask() const {
+    return gpio_pins_;
+}
+
+core::Result<void> AardvarkDevice::SetDirection(uint32_t mask, uint32_t outputs) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if ((mask & ~gpio_pins_) != 0) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    auto result = RunOp(0, ModesOfPins(mask),
+                        [=] { return GpioUpdateLocked(true, mask, outputs); });
+    if (result.IsError()) {
+        return core::Result<void>::Err(result.Error());
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> AardvarkDevice::WritePins(uint32_t mask, uint32_t values) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if ((mask & ~gpio_pins_) != 0) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    auto result = RunOp(0, ModesOfPins(mask),
+                        [=] { return GpioUpdateLocked(false, mask, values); });
+    if (result.IsError()) {
+        return core::Result<void>::Err(result.Error());
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<uint32_t> AardvarkDevice::ReadPins() {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<uint32_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+    auto result = RunOp(0, ModesOfPins(gpio_pins_), [this] { return GpioReadLocked(); });
+    if (result.IsError()) {
+        return core::Result<uint32_t>::Err(result.Error());
+    }
+    return core::Result<uint32_t>::Ok(static_cast<uint32_t>(result.Value()));
+}
+
+// ---------------------------------------------------------------------------
+// Bus scheduling
+// ---------------------------------------------------------------------------
+
+bool AardvarkDevice::AcquireBus(std::chrono::steady_clock::time_point since) {
+    auto limit = max_wait_ms_ == 0 ? Clock::time_point::max()
+                                   : since + std::chrono::milliseconds(max_wait_ms_);
+    auto deadline = core::Deadline::Current().Clamp(limit);
+    // A transaction whose deadline has passed does not start even on an
+    // idle bus.
+    // Background callers queue behind every foreground one whatever the
+    // device priorities; within a class the device priority decides.
+    int rank = static_cast<int>(core::CurrentIoPriority()) * 3 + static_cast<int>(priority_);
+    bool granted = (deadline == limit || Clock::now() < deadline) &&
+                   AcquireBusTurn(*bus_state_, rank, deadline);
+    auto waited_us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - since)
+            .count());
+
+    std::lock_guard<std::mutex> lock(wait_stats_mutex_);
+    if (!granted) {
+        wait_stats_.timeouts++;
+        if (deadline < limit) {
+            PLAS_LOG_DEVICE_WARN(name_, "I2c", "bus not granted by the caller's deadline");
+        } else {
+            PLAS_LOG_DEVICE_WARN(name_, "I2c", "bus wait exceeded max_wait_ms=" +
+                                 std::to_string(max_wait_ms_));
+        }
+        return false;
+    }
+    wait_stats_.acquisitions++;
+    wait_stats_.last_us = waited_us;
+    wait_stats_.total_us += waited_us;
+    if (waited_us > wait_stats_.max_us) {
+        wait_stats_.max_us = waited_us;
+    }
+    return true;
+}
+
+void AardvarkDevice::ReleaseBus() {
+    ReleaseBusTurn(*bus_state_);
+}
+
+core::Result<size_t> AardvarkDevice::RunOnBus(
+    std::chrono::steady_clock::time_point since,
+    const std::function<core::Result<size_t>()>& op) {
+    if (!AcquireBus(since)) {
+        return core::Result<size_t>::Err(core::ErrorCode::kTimeout);
+    }
+    auto result = op();
+    ReleaseBus();
+    return result;
+}
+
+AardvarkDevice::Priority AardvarkDevice::GetPriority() const {
+    return priority_;
+}
+
+AardvarkDevice::BusWaitStats AardvarkDevice::GetBusWaitStats() const {
+    std::lock_guard<std::mutex> lock(wait_stats_mutex_);
+    return wait_stats_;
+}
+
+void AardvarkDevice::ResetBusWaitStats() {
+    std::lock_guard<std::mutex> lock(wait_stats_mutex_);
+    wait_stats_ = BusWaitStats{};
+}
+
+// ---------------------------------------------------------------------------
+// Asynchronous submission
+// ---------------------------------------------------------------------------
+
+std::future<core::Result<size_t>> AardvarkDevice::Submit(
+    uint32_t bitrate, std::function<core::Result<size_t>()> op) {
+    return Submit(bitrate, kModeI2c, 0, std::move(op));
+}
+
+std::future<core::Result<size_t>> AardvarkDevice::Submit(
+    uint32_t bitrate, uint8_t mode_on, uint8_t mode_off,
+    std::function<core::Result<size_t>()> op) {
+    // The wait bound counts from submission, not from when the worker
+    // reaches the job, and the submitter's deadline and I/O priority go along.
+    // std::function needs a copyable target, so share the packaged_task.
+    auto since = Clock::now();
+    auto task = std::make_shared<std::packaged_task<core::Result<size_t>()>>(
+        [this, since, deadline = core::Deadline::Current(),
+         priority = core::CurrentIoPriority(), op = std::move(op)] {
+            core::ScopedDeadline scope(deadline);
+            core::ScopedIoPriority io_priority(priority);
+            return RunOnBus(since, op);
+        });
+    auto future = task->get_future();
+    {
+        std::lock_guard<std::mutex> lock(bus_state_->queue_mutex);
+        bus_state_->queue.push_back({static_cast<int>(priority_), this, bitrate,
+                                     mode_on, mode_off, [task] { (*task)(); }});
+    }
+    bus_state_->queue_cv.notify_one();
+    return future;
+}
+
+std::future<core::Result<size_t>> AardvarkDevice::ReadAsync(
+    core::Address addr, core::Byte* data, size_t length, bool stop) {
+    if (state_ != DeviceState::kOpen) {
+        return MakeReadyFuture(
+            core::Result<size_t>::Err(core::ErrorCode::kNotInitialized));
+    }
+    if (data == nullptr || length == 0 || length > 0xFFFF) {
+        return MakeReadyFuture(
+            core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument));
+    }
+    if (!async_enabled_) {
+        return MakeReadyFuture(Read(addr, data, length, stop));
+    }
+    return Submit(GetTargetBitrate(addr),
+                  [=] { return ReadLocked(addr, data, length, stop); });
+}
+
+std::future<core::Result<size_t>> AardvarkDevice::WriteAsync(
+    core::Address addr, const core::Byte* data, size_t length, bool stop) {
+    if (state_ != DeviceState::kOpen) {
+        return MakeReadyFuture(
+            core::Result<size_t>::Err(core::ErrorCode::kNotInitialized));
+    }
+    if (data == nullptr || length == 0 || length > 0xFFFF) {
+        return MakeReadyFuture(
+            core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument));
+    }
+    if (!async_enabled_) {
+        return MakeReadyFuture(Write(addr, data, length, stop));
+    }
+    return Submit(GetTargetBitrate(addr),
+                  [=] { return WriteLocked(addr, data, length, stop); });
+}
+
+std::future<core::Result<size_t>> AardvarkDevice::WriteReadAsync(
+    core::Address addr, const core::Byte* write_data, size_t write_len,
+    core::Byte* read_data, size_t read_len) {
+    if (state_ != DeviceState::kOpen) {
+        return MakeReadyFuture(
+            core::Result<size_t>::Err(core::ErrorCode::kNotInitialized));
+    }
+    if (write_data == nullptr || write_len == 0 || write_len > 0xFFFF ||
+        read_data == nullptr || read_len == 0 || read_len > 0xFFFF) {
+        return MakeReadyFuture(
+            core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument));
+    }
+    if (!async_enabled_) {
+        return MakeReadyFuture(
+            WriteRead(addr, write_data, write_len, read_data, read_len));
+    }
+    return Submit(GetTargetBitrate(addr), [=] {
+        return WriteReadLocked(addr, write_data, write_len, read_data,
+                               read_len);
+    });
+}
+
+bool AardvarkDevice::IsAsyncEnabled() const {
+    return async_enabled_;
 }
 
 core::Result<void> AardvarkDevice::SetBitrate(uint32_t bitrate) {
@@ -477,13 +1623,18 @@ core::Result<void> AardvarkDevice::SetBitrate(uint32_t bitrate) {
 
 #ifdef PLAS_HAS_AARDVARK
     if (state_ == DeviceState::kOpen && bus_state_) {
-        std::lock_guard<std::mutex> lock(bus_state_->bus_mutex);
+        if (!AcquireBus(Clock::now())) {
+            return core::Result<void>::Err(core::ErrorCode::kTimeout);
+        }
         int actual_khz = aa_i2c_bitrate(bus_state_->handle,
-                                        static_cast<int>(bitrate_ / 1000));
+                                        static_cast<int>(bitrate / 1000));
+        if (actual_khz >= 0) {
+            bus_state_->active_bitrate = bitrate;
+        }
+        ReleaseBus();
         if (actual_khz < 0) {
             return core::Result<void>::Err(MapAardvarkError(actual_khz));
         }
-        bus_state_->active_bitrate = bitrate_;
         PLAS_LOG_INFO("AardvarkDevice::SetBitrate() actual=" +
                       std::to_string(actual_khz) + " kHz");
     }
@@ -496,14 +1647,161 @@ uint32_t AardvarkDevice::GetBitrate() const {
     return bitrate_;
 }
 
+// ---------------------------------------------------------------------------
+// Per-target clock
+// ---------------------------------------------------------------------------
+
+uint32_t AardvarkDevice::GetTargetBitrate(core::Address addr) const {
+    auto target = static_cast<uint16_t>(addr);
+    if (bus_state_) {
+        std::lock_guard<std::mutex> lock(bus_state_->probe_mutex);
+        auto it = bus_state_->probed_bitrates.find(target);
+        if (it != bus_state_->probed_bitrates.end()) {
+            return it->second;
+        }
+    }
+    auto it = target_bitrates_.find(target);
+    return it != target_bitrates_.end() ? it->second : bitrate_.load();
+}
+
+core::Result<uint32_t> AardvarkDevice::ProbeMaxBitrate(core::Address addr) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<uint32_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (addr > 0x7F) {
+        return core::Result<uint32_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    // The profile (or the adapter's 800 kHz limit) first, then the standard
+    // Fast-mode and Standard-mode rates below it.
+    auto profile = target_bitrates_.find(static_cast<uint16_t>(addr));
+    uint32_t ceiling = profile != target_bitrates_.end() ? profile->second : 800000;
+    std::vector<uint32_t> rates{ceiling};
+    for (uint32_t rate : {400000u, 100000u}) {
+        if (rate < ceiling) {
+            rates.push_back(rate);
+        }
+    }
+
+    if (!AcquireBus(Clock::now())) {
+        return core::Result<uint32_t>::Err(core::ErrorCode::kTimeout);
+    }
+    uint32_t found = 0;
+    std::error_code last_error;
+    for (uint32_t rate : rates) {
+        auto clock = ApplyBitrateLocked(rate);
+        if (clock.IsError()) {
+            last_error = clock.Error();
+            break;
+        }
+        bool stable = true;
+        for (int i = 0; i < kProbeReads && stable; ++i) {
+            core::Byte byte = 0;
+            // Read directly: ReadLocked would switch back to the target's
+            // current rate.
+#ifdef PLAS_HAS_AARDVARK
+            int result = aa_i2c_read(bus_state_->handle,
+                                     static_cast<uint16_t>(addr),
+                                     AA_I2C_NO_FLAGS, 1, &byte);
+            if (result != 1) {
+                last_error = core::make_error_code(
+                    result < 0 ? MapAardvarkError(result)
+                               : core::ErrorCode::kDataLoss);
+                stable = false;
+            }
+#else
+            (void)byte;
+            last_error = core::make_error_code(core::ErrorCode::kNotSupported);
+            stable = false;
+#endif
+        }
+        if (stable) {
+            found = rate;
+            break;
+        }
+    }
+    ReleaseBus();
+
+    if (found == 0) {
+        return core::Result<uint32_t>::Err(last_error);
+    }
+    {
+        std::lock_guard<std::mutex> lock(bus_state_->probe_mutex);
+        bus_state_->probed_bitrates[static_cast<uint16_t>(addr)] = found;
+    }
+    PLAS_LOG_INFO("AardvarkDevice::ProbeMaxBitrate() device='" + name_ +
+                  "' addr=" + std::to_string(addr) +
+                  " bitrate=" + std::to_string(found));
+    return core::Result<uint32_t>::Ok(found);
+}
+
+std::vector<std::size_t> AardvarkDevice::PlanBatch(
+    const std::vector<QueuedOp>& ops, uint32_t active_bitrate,
+    uint8_t active_mode) {
+    // Per-owner FIFOs in order of first appearance, one set per class.
+    std::map<int, std::vector<std::deque<std::size_t>>> classes;
+    std::map<std::pair<int, const void*>, std::size_t> fifo_of;
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        auto key = std::make_pair(ops[i].priority, ops[i].owner);
+        auto& fifos = classes[ops[i].priority];
+        auto it = fifo_of.find(key);
+        if (it == fifo_of.end()) {
+            it = fifo_of.emplace(key, fifos.size()).first;
+            fifos.emplace_back();
+        }
+        fifos[it->second].push_back(i);
+    }
+
+    std::vector<std::size_t> order;
+    order.reserve(ops.size());
+    uint32_t bitrate = active_bitrate;
+    uint8_t mode = active_mode;
+    for (auto& [priority, fifos] : classes) {
+        for (;;) {
+            // Earliest head overall, and earliest one runnable at `bitrate`.
+            std::deque<std::size_t>* first = nullptr;
+            std::deque<std::size_t>* same = nullptr;
+            for (auto& fifo : fifos) {
+                if (fifo.empty()) {
+                    continue;
+                }
+                std::size_t head = fifo.front();
+                if (first == nullptr || head < first->front()) {
+                    first = &fifo;
+                }
+                uint32_t rate = ops[head].bitrate;
+                bool mode_ok = (mode & ops[head].mode_on) == ops[head].mode_on &&
+                               (mode & ops[head].mode_off) == 0;
+                if ((rate == 0 || rate == bitrate) && mode_ok &&
+                    (same == nullptr || head < same->front())) {
+                    same = &fifo;
+                }
+            }
+            if (first == nullptr) {
+                break;
+            }
+            auto* next = same != nullptr ? same : first;
+            std::size_t index = next->front();
+            next->pop_front();
+            if (ops[index].bitrate != 0) {
+                bitrate = ops[index].bitrate;
+            }
+            mode = static_cast<uint8_t>((mode | ops[index].mode_on) & ~ops[index].mode_off);
+            order.push_back(index);
+        }
+    }
+    return order;
+}
+
 // ---------------------------------------------------------------------------
 // Self-registration
 // ---------------------------------------------------------------------------
 
 void AardvarkDevice::Register() {
     DeviceFactory::RegisterDriver(
-        "aardvark", [](const config::DeviceEntry& entry) {
-            return std::make_unique<AardvarkDevice>(entry);
+        "aardvark", [](const config::DeviceEntry& entry,
+                       const config::DeviceUri& uri) {
+            return std::make_unique<AardvarkDevice>(entry, uri);
         });
 }
 
@@ -1,10 +1,16 @@
 #include "plas/hal/driver/ft4222h/ft4222h_device.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 #include <string>
 #include <thread>
+#include <utility>
 
 #ifdef PLAS_HAS_FT4222H
 extern "C" {
@@ -13,9 +19,18 @@ extern "C" {
 }
 #endif
 
+// The D2XX event object is a pthread condvar/mutex pair on Linux and macOS
+// (EVENT_HANDLE in WinTypes.h); Windows builds keep the polling wait.
+#if defined(PLAS_HAS_FT4222H) && !defined(_WIN32)
+#define PLAS_FT4222H_RX_EVENT 1
+#include <pthread.h>
+#endif
+
+#include "plas/core/deadline.h"
 #include "plas/core/error.h"
 #include "plas/hal/interface/device_factory.h"
 #include "plas/log/logger.h"
+#include "plas/log/trace.h"
 
 namespace plas::hal::driver {
 
@@ -71,38 +86,370 @@ static core::ErrorCode MapFt4222Status(FT4222_STATUS status) {
 #endif
 
 // ---------------------------------------------------------------------------
-// URI parsing: ft4222h://master_idx:slave_idx
+// SPI clock: system clock (`sys_clock` arg) divided by 2^div, div 1-9
 // ---------------------------------------------------------------------------
 
-bool Ft4222hDevice::ParseUri(const std::string& uri, uint16_t& master_idx,
-                             uint16_t& slave_idx) {
-    const std::string prefix = "ft4222h://";
-    if (uri.size() <= prefix.size() ||
-        uri.compare(0, prefix.size(), prefix) != 0) {
-        return false;
+namespace {
+
+uint32_t SysClockHz(uint32_t sys_clock) {
+    static constexpr uint32_t kHz[] = {60000000, 24000000, 48000000, 80000000};
+    return sys_clock < 4 ? kHz[sys_clock] : kHz[0];
+}
+
+/// Smallest divider whose clock does not exceed `hz`; 0 if even the
+/// slowest is too fast.
+uint8_t SpiClockDivider(uint32_t sys_clock, double hz) {
+    for (uint8_t div = 1; div <= 9; ++div) {
+        if (SysClockHz(sys_clock) / (1u << div) <= hz) {
+            return div;
+        }
     }
+    return 0;
+}
 
-    auto body = uri.substr(prefix.size());
-    auto colon = body.find(':');
-    if (colon == std::string::npos || colon == 0 ||
-        colon == body.size() - 1) {
-        return false;
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Ft4222hRxEvent — slave RX notification object
+// ---------------------------------------------------------------------------
+
+#ifdef PLAS_FT4222H_RX_EVENT
+struct Ft4222hRxEvent {
+    EVENT_HANDLE handle;
+
+    Ft4222hRxEvent() {
+        pthread_mutex_init(&handle.eMutex, nullptr);
+        pthread_cond_init(&handle.eCondVar, nullptr);
+        handle.iVar = 0;
+    }
+
+    ~Ft4222hRxEvent() {
+        pthread_cond_destroy(&handle.eCondVar);
+        pthread_mutex_destroy(&handle.eMutex);
+    }
+
+    Ft4222hRxEvent(const Ft4222hRxEvent&) = delete;
+    Ft4222hRxEvent& operator=(const Ft4222hRxEvent&) = delete;
+
+    /// Block until the SDK signals RX or `timeout` elapses. A signal raised
+    /// before we started waiting is not latched, so callers bound the wait
+    /// and re-check the RX status after every wake-up.
+    void WaitFor(std::chrono::microseconds timeout) {
+        timespec abs{};
+        clock_gettime(CLOCK_REALTIME, &abs);  // pthread_cond default clock
+        auto ns = static_cast<long long>(abs.tv_nsec) +
+                  static_cast<long long>(timeout.count()) * 1000;
+        abs.tv_sec += static_cast<time_t>(ns / 1000000000LL);
+        abs.tv_nsec = static_cast<long>(ns % 1000000000LL);
+
+        pthread_mutex_lock(&handle.eMutex);
+        pthread_cond_timedwait(&handle.eCondVar, &handle.eMutex, &abs);
+        pthread_mutex_unlock(&handle.eMutex);
+    }
+};
+#else
+struct Ft4222hRxEvent {};
+#endif
+
+// ---------------------------------------------------------------------------
+// Shared FTDI device list
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct FtdiDeviceList {
+    std::mutex mutex;
+    bool valid = false;
+    std::vector<FtdiDeviceInfo> devices;
+    std::atomic<uint64_t> enumerations{0};
+};
+
+FtdiDeviceList& SharedDeviceList() {
+    static FtdiDeviceList list;
+    return list;
+}
+
+}  // namespace
+
+core::Result<std::vector<FtdiDeviceInfo>> Ft4222hDevice::ListDevices(bool refresh) {
+#ifdef PLAS_HAS_FT4222H
+    auto& list = SharedDeviceList();
+    std::lock_guard<std::mutex> lock(list.mutex);
+    if (!list.valid || refresh) {
+        list.valid = false;
+        list.enumerations.fetch_add(1, std::memory_order_relaxed);
+        DWORD count = 0;
+        FT_STATUS status = FT_CreateDeviceInfoList(&count);
+        if (status != FT_OK) {
+            return core::Result<std::vector<FtdiDeviceInfo>>::Err(MapFtStatus(status));
+        }
+        std::vector<FT_DEVICE_LIST_INFO_NODE> nodes(count);
+        if (count > 0) {
+            status = FT_GetDeviceInfoList(nodes.data(), &count);
+            if (status != FT_OK) {
+                return core::Result<std::vector<FtdiDeviceInfo>>::Err(MapFtStatus(status));
+            }
+        }
+        list.devices.clear();
+        for (DWORD i = 0; i < count && i < nodes.size(); ++i) {
+            const auto& node = nodes[i];
+            list.devices.push_back(FtdiDeviceInfo{
+                static_cast<uint32_t>(i), static_cast<uint32_t>(node.Flags),
+                static_cast<uint32_t>(node.Type), static_cast<uint32_t>(node.ID),
+                static_cast<uint32_t>(node.LocId),
+                std::string(node.SerialNumber, strnlen(node.SerialNumber, sizeof(node.SerialNumber))),
+                std::string(node.Description, strnlen(node.Description, sizeof(node.Description)))});
+        }
+        list.valid = true;
+    }
+    return core::Result<std::vector<FtdiDeviceInfo>>::Ok(list.devices);
+#else
+    (void)refresh;
+    return core::Result<std::vector<FtdiDeviceInfo>>::Err(core::ErrorCode::kNotSupported);
+#endif
+}
+
+uint64_t Ft4222hDevice::EnumerationCount() {
+    return SharedDeviceList().enumerations.load(std::memory_order_relaxed);
+}
+
+core::Result<void*> Ft4222hDevice::OpenInterface(const Selector& selector) {
+#ifdef PLAS_HAS_FT4222H
+    FT_HANDLE handle = nullptr;
+    FT_STATUS status = FT_DEVICE_NOT_FOUND;
+    switch (selector.kind) {
+        case Selector::Kind::kSerial:
+            status = FT_OpenEx(const_cast<char*>(selector.serial.c_str()),
+                               FT_OPEN_BY_SERIAL_NUMBER, &handle);
+            break;
+        case Selector::Kind::kLocation:
+            status = FT_OpenEx(reinterpret_cast<PVOID>(static_cast<uintptr_t>(selector.value)),
+                               FT_OPEN_BY_LOCATION, &handle);
+            break;
+        case Selector::Kind::kIndex:
+            // Through the shared list: FT_Open(index) would enumerate the
+            // bus again for every interface. A list gone stale (adapter
+            // unplugged since) is enumerated once more.
+            for (int attempt = 0; attempt < 2 && status == FT_DEVICE_NOT_FOUND; ++attempt) {
+                auto devices = ListDevices(attempt > 0);
+                if (devices.IsError()) {
+                    return core::Result<void*>::Err(devices.Error());
+                }
+                if (selector.value >= devices.Value().size()) {
+                    continue;
+                }
+                const auto& info = devices.Value()[selector.value];
+                status = info.location != 0
+                             ? FT_OpenEx(reinterpret_cast<PVOID>(
+                                             static_cast<uintptr_t>(info.location)),
+                                         FT_OPEN_BY_LOCATION, &handle)
+                             : FT_Open(static_cast<int>(selector.value), &handle);
+            }
+            break;
+    }
+    if (status != FT_OK) {
+        return core::Result<void*>::Err(MapFtStatus(status));
+    }
+    return core::Result<void*>::Ok(handle);
+#else
+    (void)selector;
+    return core::Result<void*>::Err(core::ErrorCode::kNotSupported);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// USB tuning
+// ---------------------------------------------------------------------------
+
+namespace {
+
+constexpr uint8_t kShortLatencyMs = 2;     // D2XX minimum
+constexpr uint8_t kDefaultLatencyMs = 16;  // D2XX default
+constexpr uint32_t kUsbPacketSize = 512;   // USB 2.0 high-speed bulk packet
+constexpr uint32_t kMaxTransferSize = 65536;
+constexpr uint32_t kMinTimeoutMs = 100;
+constexpr uint32_t kMaxTimeoutMs = 60000;
+
+constexpr Ft4222hUsbTuning kRegisterProfile{kShortLatencyMs, 4096, 0};
+constexpr Ft4222hUsbTuning kBulkProfile{kDefaultLatencyMs, kMaxTransferSize, 0};
+
+/// `tuning` with the nonzero values of `pinned` in its place.
+Ft4222hUsbTuning WithPinned(Ft4222hUsbTuning tuning, const Ft4222hUsbTuning& pinned) {
+    if (pinned.latency_ms != 0) {
+        tuning.latency_ms = pinned.latency_ms;
+    }
+    if (pinned.transfer_size != 0) {
+        tuning.transfer_size = pinned.transfer_size;
+    }
+    if (pinned.timeout_ms != 0) {
+        tuning.timeout_ms = pinned.timeout_ms;
+    }
+    return tuning;
+}
+
+std::string UsbTuningToString(const Ft4222hUsbTuning& tuning) {
+    return "latency=" + std::to_string(tuning.latency_ms) +
+           "ms transfer_size=" + std::to_string(tuning.transfer_size) +
+           " timeout=" + std::to_string(tuning.timeout_ms) + "ms";
+}
+
+}  // namespace
+
+Ft4222hUsbTuning Ft4222hDevice::SelectUsbTuning(const Ft4222hWorkload& mix,
+                                                uint32_t bitrate) {
+    Ft4222hUsbTuning tuning = kRegisterProfile;
+    uint64_t total = mix.small_transfers + mix.bulk_transfers;
+    if (total == 0) {
+        return tuning;
+    }
+
+    // The chip sends a response shorter than the USB request when the
+    // latency timer expires, so every register access waits for it; a
+    // stream that fills its requests never does and keeps the default.
+    tuning.latency_ms = mix.small_transfers * 10 >= total ? kShortLatencyMs : kDefaultLatencyMs;
+
+    // A request much larger than the typical bulk transfer is only ever
+    // completed by the latency timer; one much smaller splits it up.
+    if (mix.bulk_transfers > 0) {
+        uint64_t average = mix.bulk_bytes / mix.bulk_transfers;
+        uint64_t size = (average + kUsbPacketSize - 1) / kUsbPacketSize * kUsbPacketSize;
+        tuning.transfer_size = static_cast<uint32_t>(
+            std::clamp<uint64_t>(size, kUsbPacketSize, kMaxTransferSize));
+    }
+
+    // 9 bit times per I2C byte; SPI is faster, so this covers it too.
+    if (mix.max_bytes > 0 && bitrate > 0) {
+        uint64_t wire_ms = mix.max_bytes * 9 * 1000 / bitrate + 1;
+        tuning.timeout_ms = static_cast<uint32_t>(
+            std::min<uint64_t>(kMinTimeoutMs + 4 * wire_ms, kMaxTimeoutMs));
+    }
+    return tuning;
+}
+
+Ft4222hUsbTuning Ft4222hDevice::GetUsbTuning() const {
+    return usb_tuning_;
+}
+
+Ft4222hWorkload Ft4222hDevice::GetWorkload() const {
+    std::lock_guard<std::mutex> lock(workload_mutex_);
+    return workload_;
+}
+
+void Ft4222hDevice::CountTransfer(size_t bytes) {
+    std::lock_guard<std::mutex> lock(workload_mutex_);
+    if (bytes <= kSmallTransferBytes) {
+        ++workload_.small_transfers;
+    } else {
+        ++workload_.bulk_transfers;
+        workload_.bulk_bytes += bytes;
+    }
+    workload_.max_bytes = std::max<uint64_t>(workload_.max_bytes, bytes);
+}
+
+core::Result<void> Ft4222hDevice::ApplyUsbTuning(void* handle,
+                                                 const Ft4222hUsbTuning& tuning) {
+#ifdef PLAS_HAS_FT4222H
+    auto h = static_cast<FT_HANDLE>(handle);
+    FT_STATUS status = FT_OK;
+    if (tuning.latency_ms != 0) {
+        status = FT_SetLatencyTimer(h, static_cast<UCHAR>(tuning.latency_ms));
+    }
+    if (status == FT_OK && tuning.transfer_size != 0) {
+        status = FT_SetUSBParameters(h, tuning.transfer_size, tuning.transfer_size);
+    }
+    if (status == FT_OK && tuning.timeout_ms != 0) {
+        status = FT_SetTimeouts(h, tuning.timeout_ms, tuning.timeout_ms);
+    }
+    if (status != FT_OK) {
+        return core::Result<void>::Err(MapFtStatus(status));
+    }
+    return core::Result<void>::Ok();
+#else
+    (void)handle;
+    (void)tuning;
+    return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+#endif
+}
+
+core::Result<Ft4222hUsbTuning> Ft4222hDevice::CalibrateUsb(const Ft4222hWorkload& mix) {
+    auto tuning = WithPinned(SelectUsbTuning(mix, bitrate_), usb_pinned_);
+
+#ifdef PLAS_HAS_FT4222H
+    if (state_ == DeviceState::kOpen) {
+        // Between transfers on every interface
+        std::scoped_lock lock(i2c_queue_, spi_queue_);
+        for (void* handle : {master_handle_, slave_handle_, spi_handle_}) {
+            if (handle == nullptr) {
+                continue;
+            }
+            auto result = ApplyUsbTuning(handle, tuning);
+            if (result.IsError()) {
+                PLAS_LOG_ERROR("Ft4222hDevice::CalibrateUsb() device='" + name_ +
+                               "' failed: " + result.Error().message());
+                return core::Result<Ft4222hUsbTuning>::Err(result.Error());
+            }
+        }
+    }
+#endif
+
+    usb_tuning_ = tuning;
+    PLAS_LOG_INFO("Ft4222hDevice::CalibrateUsb() device='" + name_ + "' " +
+                  UsbTuningToString(tuning));
+    return core::Result<Ft4222hUsbTuning>::Ok(tuning);
+}
+
+// ---------------------------------------------------------------------------
+// URI parsing: ft4222h://<master>:<slave>, each <index>, sn=<serial> or
+// loc=<location id>
+// ---------------------------------------------------------------------------
+
+std::string Ft4222hDevice::Selector::ToString() const {
+    switch (kind) {
+        case Kind::kSerial:
+            return "sn=" + serial;
+        case Kind::kLocation:
+            return "loc=" + std::to_string(value);
+        case Kind::kIndex:
+        default:
+            return std::to_string(value);
     }
+}
 
-    auto master_str = body.substr(0, colon);
-    auto slave_str = body.substr(colon + 1);
+bool Ft4222hDevice::ParseSelector(std::string_view text, Selector& out) {
+    Selector selector;
+    uint64_t value = 0;
+    if (text.substr(0, 3) == "sn=") {
+        // D2XX serial numbers are at most 15 characters.
+        auto serial = text.substr(3);
+        if (serial.empty() || serial.size() > 15) {
+            return false;
+        }
+        selector.kind = Selector::Kind::kSerial;
+        selector.serial = std::string(serial);
+    } else if (text.substr(0, 4) == "loc=") {
+        if (!config::DeviceUri::ParseNumber(text.substr(4), 0, 0xFFFFFFFF, value)) {
+            return false;
+        }
+        selector.kind = Selector::Kind::kLocation;
+        selector.value = static_cast<uint32_t>(value);
+    } else {
+        if (!config::DeviceUri::ParseNumber(text, 10, 0xFFFF, value)) {
+            return false;
+        }
+        selector.value = static_cast<uint32_t>(value);
+    }
+    out = std::move(selector);
+    return true;
+}
 
-    // Parse master index (decimal only)
-    char* end = nullptr;
-    unsigned long master_val = std::strtoul(master_str.c_str(), &end, 10);
-    if (end == master_str.c_str() || *end != '\0' || master_val > 65535) {
+bool Ft4222hDevice::ParseUri(const config::DeviceUri& uri, Selector& master, Selector& slave) {
+    if (!uri.IsValid() || uri.Scheme() != "ft4222h" || uri.FieldCount() != 2) {
         return false;
     }
 
-    // Parse slave index (decimal only)
-    end = nullptr;
-    unsigned long slave_val = std::strtoul(slave_str.c_str(), &end, 10);
-    if (end == slave_str.c_str() || *end != '\0' || slave_val > 65535) {
+    Selector master_val;
+    Selector slave_val;
+    if (!ParseSelector(uri.Field(0), master_val) || !ParseSelector(uri.Field(1), slave_val)) {
         return false;
     }
 
@@ -111,8 +458,8 @@ bool Ft4222hDevice::ParseUri(const std::string& uri, uint16_t& master_idx,
         return false;
     }
 
-    master_idx = static_cast<uint16_t>(master_val);
-    slave_idx = static_cast<uint16_t>(slave_val);
+    master = std::move(master_val);
+    slave = std::move(slave_val);
     return true;
 }
 
@@ -121,18 +468,26 @@ bool Ft4222hDevice::ParseUri(const std::string& uri, uint16_t& master_idx,
 // ---------------------------------------------------------------------------
 
 Ft4222hDevice::Ft4222hDevice(const config::DeviceEntry& entry)
+    : Ft4222hDevice(entry, config::DeviceUri::Parse(entry.uri)) {}
+
+Ft4222hDevice::Ft4222hDevice(const config::DeviceEntry& entry,
+                             const config::DeviceUri& uri)
     : name_(entry.nickname),
       uri_(entry.uri),
       state_(DeviceState::kUninitialized),
-      master_idx_(0),
-      slave_idx_(0),
       master_handle_(nullptr),
       slave_handle_(nullptr),
       bitrate_(400000),
       slave_addr_(0x40),
       sys_clock_(0),
       rx_timeout_ms_(1000),
-      rx_poll_interval_us_(100) {
+      rx_poll_interval_us_(100),
+      rx_event_enabled_(true),
+      usb_tuning_(kRegisterProfile),
+      metrics_(nullptr),
+      trace_id_(0) {
+    uri_valid_ = ParseUri(uri, master_, slave_);
+
     // Parse optional config args
     auto it = entry.args.find("bitrate");
     if (it != entry.args.end()) {
@@ -182,6 +537,92 @@ Ft4222hDevice::Ft4222hDevice(const config::DeviceEntry& entry)
             rx_poll_interval_us_ = static_cast<uint32_t>(val);
         }
     }
+
+    it = entry.args.find("rx_event");
+    if (it != entry.args.end()) {
+        if (it->second == "false" || it->second == "0") {
+            rx_event_enabled_ = false;
+        } else if (it->second == "true" || it->second == "1") {
+            rx_event_enabled_ = true;
+        }
+    }
+
+    it = entry.args.find("spi_index");
+    if (it != entry.args.end()) {
+        spi_enabled_ = ParseSelector(it->second, spi_);
+    }
+
+    it = entry.args.find("usb_tuning");
+    if (it != entry.args.end()) {
+        if (it->second == "register") {
+            usb_tuning_ = kRegisterProfile;
+        } else if (it->second == "bulk") {
+            usb_tuning_ = kBulkProfile;
+        } else if (it->second == "default") {
+            usb_tuning_ = Ft4222hUsbTuning{};
+        }
+    }
+
+    it = entry.args.find("usb_latency_ms");
+    if (it != entry.args.end()) {
+        char* end = nullptr;
+        unsigned long val = std::strtoul(it->second.c_str(), &end, 10);
+        if (end != it->second.c_str() && *end == '\0' && val >= 2 && val <= 255) {
+            usb_pinned_.latency_ms = static_cast<uint8_t>(val);
+        }
+    }
+
+    it = entry.args.find("usb_transfer_size");
+    if (it != entry.args.end()) {
+        char* end = nullptr;
+        unsigned long val = std::strtoul(it->second.c_str(), &end, 10);
+        if (end != it->second.c_str() && *end == '\0' && val >= 64 &&
+            val <= kMaxTransferSize && val % 64 == 0) {
+            usb_pinned_.transfer_size = static_cast<uint32_t>(val);
+        }
+    }
+
+    it = entry.args.find("usb_timeout_ms");
+    if (it != entry.args.end()) {
+        char* end = nullptr;
+        unsigned long val = std::strtoul(it->second.c_str(), &end, 10);
+        if (end != it->second.c_str() && *end == '\0' && val > 0) {
+            usb_pinned_.timeout_ms = static_cast<uint32_t>(val);
+        }
+    }
+    usb_tuning_ = WithPinned(usb_tuning_, usb_pinned_);
+
+    // Default: the fastest rate up to 30 MHz
+    spi_clock_div_ = SpiClockDivider(sys_clock_, 30000000);
+    it = entry.args.find("spi_clock");
+    if (it != entry.args.end()) {
+        char* end = nullptr;
+        unsigned long val = std::strtoul(it->second.c_str(), &end, 10);
+        if (end != it->second.c_str() && *end == '\0') {
+            uint8_t div = SpiClockDivider(sys_clock_, static_cast<double>(val));
+            if (div != 0) {
+                spi_clock_div_ = div;
+            }
+        }
+    }
+
+    it = entry.args.find("spi_mode");
+    if (it != entry.args.end()) {
+        char* end = nullptr;
+        unsigned long val = std::strtoul(it->second.c_str(), &end, 10);
+        if (end != it->second.c_str() && *end == '\0' && val <= 3) {
+            spi_mode_ = static_cast<SpiMode>(val);
+        }
+    }
+
+    it = entry.args.find("spi_cs");
+    if (it != entry.args.end()) {
+        char* end = nullptr;
+        unsigned long val = std::strtoul(it->second.c_str(), &end, 10);
+        if (end != it->second.c_str() && *end == '\0' && val <= 3) {
+            spi_cs_ = static_cast<uint8_t>(val);
+        }
+    }
 }
 
 Ft4222hDevice::~Ft4222hDevice() {
@@ -200,14 +641,19 @@ core::Result<void> Ft4222hDevice::Init() {
         return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
     }
 
-    if (!ParseUri(uri_, master_idx_, slave_idx_)) {
+    if (!uri_valid_) {
         PLAS_LOG_ERROR("Ft4222hDevice::Init() invalid URI: " + uri_);
         return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
     }
 
-    PLAS_LOG_INFO("Ft4222hDevice::Init() master=" +
-                  std::to_string(master_idx_) + " slave=" +
-                  std::to_string(slave_idx_) + " device='" + name_ + "'");
+    if (spi_enabled_ && (spi_ == master_ || spi_ == slave_)) {
+        PLAS_LOG_ERROR("Ft4222hDevice::Init() spi_index " + spi_.ToString() +
+                       " is already the I2C master or slave: " + uri_);
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    PLAS_LOG_INFO("Ft4222hDevice::Init() master=" + master_.ToString() +
+                  " slave=" + slave_.ToString() + " device='" + name_ + "'");
     state_ = DeviceState::kInitialized;
     return core::Result<void>::Ok();
 }
@@ -219,23 +665,35 @@ core::Result<void> Ft4222hDevice::Open() {
 
 #ifdef PLAS_HAS_FT4222H
     // Open master FT device
-    FT_HANDLE master_h = nullptr;
-    FT_STATUS ft_status = FT_Open(master_idx_, &master_h);
-    if (ft_status != FT_OK) {
-        PLAS_LOG_ERROR("Ft4222hDevice::Open() FT_Open(master) failed: " +
-                       std::to_string(ft_status));
-        return core::Result<void>::Err(MapFtStatus(ft_status));
+    auto master_open = OpenInterface(master_);
+    if (master_open.IsError()) {
+        PLAS_LOG_ERROR("Ft4222hDevice::Open() open master " + master_.ToString() +
+                       " failed: " + master_open.Error().message());
+        return core::Result<void>::Err(master_open.Error());
     }
+    auto master_h = static_cast<FT_HANDLE>(master_open.Value());
 
     // Open slave FT device
-    FT_HANDLE slave_h = nullptr;
-    ft_status = FT_Open(slave_idx_, &slave_h);
-    if (ft_status != FT_OK) {
-        PLAS_LOG_ERROR("Ft4222hDevice::Open() FT_Open(slave) failed: " +
-                       std::to_string(ft_status));
+    auto slave_open = OpenInterface(slave_);
+    if (slave_open.IsError()) {
+        PLAS_LOG_ERROR("Ft4222hDevice::Open() open slave " + slave_.ToString() +
+                       " failed: " + slave_open.Error().message());
         FT_Close(master_h);
-        return core::Result<void>::Err(MapFtStatus(ft_status));
+        return core::Result<void>::Err(slave_open.Error());
     }
+    auto slave_h = static_cast<FT_HANDLE>(slave_open.Value());
+
+    // USB parameters are per interface. Not fatal: the SDK defaults work,
+    // only more slowly.
+    auto tune = [this](FT_HANDLE handle, const char* role) {
+        auto tuned = ApplyUsbTuning(handle, usb_tuning_);
+        if (tuned.IsError()) {
+            PLAS_LOG_WARN("Ft4222hDevice::Open() device='" + name_ + "' " + role +
+                          " USB tuning failed: " + tuned.Error().message());
+        }
+    };
+    tune(master_h, "master");
+    tune(slave_h, "slave");
 
     // Set system clock
     FT4222_STATUS status = FT4222_SetClock(
@@ -284,13 +742,74 @@ core::Result<void> Ft4222hDevice::Open() {
     master_handle_ = master_h;
     slave_handle_ = slave_h;
 
-    PLAS_LOG_INFO("Ft4222hDevice::Open() device='" + name_ + "'");
+    if (spi_enabled_) {
+        auto spi_open = OpenInterface(spi_);
+        if (spi_open.IsError()) {
+            PLAS_LOG_ERROR("Ft4222hDevice::Open() open spi " + spi_.ToString() +
+                           " failed: " + spi_open.Error().message());
+            FT4222_UnInitialize(slave_h);
+            FT4222_UnInitialize(master_h);
+            FT_Close(slave_h);
+            FT_Close(master_h);
+            master_handle_ = nullptr;
+            slave_handle_ = nullptr;
+            return core::Result<void>::Err(spi_open.Error());
+        }
+        auto spi_h = static_cast<FT_HANDLE>(spi_open.Value());
+        spi_handle_ = spi_h;
+        tune(spi_h, "spi");
+
+        status = FT4222_SetClock(spi_h, static_cast<FT4222_ClockRate>(sys_clock_));
+        auto spi_result = status == FT4222_OK
+                              ? SpiInitLocked()
+                              : core::Result<void>::Err(MapFt4222Status(status));
+        if (spi_result.IsError()) {
+            PLAS_LOG_ERROR("Ft4222hDevice::Open() SPI master setup failed: " +
+                           spi_result.Error().message());
+            FT4222_UnInitialize(spi_h);
+            FT4222_UnInitialize(slave_h);
+            FT4222_UnInitialize(master_h);
+            FT_Close(spi_h);
+            FT_Close(slave_h);
+            FT_Close(master_h);
+            master_handle_ = nullptr;
+            slave_handle_ = nullptr;
+            spi_handle_ = nullptr;
+            return spi_result;
+        }
+    }
+
+#ifdef PLAS_FT4222H_RX_EVENT
+    // Optional: wake PollSlaveRx on RX instead of sleeping between polls.
+    // Any failure here just leaves the polling fallback in place.
+    if (rx_event_enabled_) {
+        auto event = std::make_unique<Ft4222hRxEvent>();
+        status = FT4222_SetEventNotification(slave_h, FT4222_EVENT_RXCHAR,
+                                             &event->handle);
+        if (status == FT4222_OK) {
+            rx_event_ = std::move(event);
+        } else {
+            PLAS_LOG_WARN("Ft4222hDevice::Open() device='" + name_ +
+                          "' RX event notification unavailable (" +
+                          std::to_string(status) + "), polling");
+        }
+    }
+#endif
+
+    PLAS_LOG_INFO("Ft4222hDevice::Open() device='" + name_ + "' USB " +
+                  UsbTuningToString(usb_tuning_));
 #else
     PLAS_LOG_WARN(
         "Ft4222hDevice::Open() [stub — SDK not available] device='" + name_ +
         "'");
 #endif
 
+    {
+        std::lock_guard<std::mutex> lock(workload_mutex_);
+        workload_ = Ft4222hWorkload{};
+    }
+    metrics_ = MetricsRegistry::GetInstance().GetDeviceMetrics(name_);
+    trace_id_ = log::Tracer::GetInstance().RegisterDevice(name_);
     state_ = DeviceState::kOpen;
     return core::Result<void>::Ok();
 }
@@ -301,6 +820,10 @@ core::Result<void> Ft4222hDevice::Close() {
     }
 
 #ifdef PLAS_HAS_FT4222H
+    if (spi_handle_ != nullptr) {
+        FT4222_UnInitialize(static_cast<FT_HANDLE>(spi_handle_));
+        FT_Close(static_cast<FT_HANDLE>(spi_handle_));
+    }
     if (slave_handle_ != nullptr) {
         FT4222_UnInitialize(static_cast<FT_HANDLE>(slave_handle_));
         FT_Close(static_cast<FT_HANDLE>(slave_handle_));
@@ -316,6 +839,8 @@ core::Result<void> Ft4222hDevice::Close() {
 
     master_handle_ = nullptr;
     slave_handle_ = nullptr;
+    spi_handle_ = nullptr;
+    rx_event_.reset();  // SDK no longer references it once the slave closed
     state_ = DeviceState::kClosed;
     return core::Result<void>::Ok();
 }
@@ -330,6 +855,7 @@ core::Result<void> Ft4222hDevice::Reset() {
     state_ = DeviceState::kUninitialized;
     master_handle_ = nullptr;
     slave_handle_ = nullptr;
+    spi_handle_ = nullptr;
     return Init();
 }
 
@@ -357,6 +883,118 @@ Device* Ft4222hDevice::GetDevice() {
 // I2c interface
 // ---------------------------------------------------------------------------
 
+#ifdef PLAS_HAS_FT4222H
+core::Result<size_t> Ft4222hDevice::MasterWriteLocked(core::Address addr,
+                                                      const core::Byte* data,
+                                                      size_t length,
+                                                      uint8_t flag) {
+    log::TraceSpan span(trace_id_, log::TraceInterface::kI2c,
+                        log::TraceOp::kWrite, addr, length);
+    MetricsTimer timer(metrics_, MetricOp::kI2cWrite, length);
+    uint16 transferred = 0;
+    FT4222_STATUS status = FT4222_I2CMaster_WriteEx(
+        static_cast<FT_HANDLE>(master_handle_),
+        static_cast<uint16>(addr),
+        flag,
+        const_cast<uint8*>(data),
+        static_cast<uint16>(length),
+        &transferred);
+    if (status != FT4222_OK) {
+        auto err = MapFt4222Status(status);
+        span.SetStatus(make_error_code(err));
+        timer.SetError();
+        PLAS_LOG_DEVICE_ERROR(name_, "I2c", "Write addr=" + std::to_string(addr) +
+                              " len=" + std::to_string(length) + " failed: " +
+                              make_error_code(err).message());
+        return core::Result<size_t>::Err(err);
+    }
+    span.SetLength(transferred);
+    timer.SetBytes(transferred);
+    CountTransfer(transferred);
+    return core::Result<size_t>::Ok(static_cast<size_t>(transferred));
+}
+
+core::Result<size_t> Ft4222hDevice::SlaveReadLocked(core::Byte* data,
+                                                    size_t length) {
+    log::TraceSpan span(trace_id_, log::TraceInterface::kI2c,
+                        log::TraceOp::kRead, slave_addr_, length);
+    MetricsTimer timer(metrics_, MetricOp::kI2cRead, length);
+    // Poll slave RX buffer until enough data is available
+    auto poll_result = PollSlaveRx(length);
+    if (poll_result.IsError()) {
+        span.SetStatus(poll_result.Error());
+        timer.SetError();
+        PLAS_LOG_DEVICE_ERROR(name_, "I2c", "Read len=" + std::to_string(length) +
+                              " poll failed: " + poll_result.Error().message());
+        return core::Result<size_t>::Err(poll_result.Error());
+    }
+
+    uint16 transferred = 0;
+    FT4222_STATUS status = FT4222_I2CSlave_Read(
+        static_cast<FT_HANDLE>(slave_handle_),
+        data,
+        static_cast<uint16>(length),
+        &transferred);
+    if (status != FT4222_OK) {
+        auto err = MapFt4222Status(status);
+        span.SetStatus(make_error_code(err));
+        timer.SetError();
+        PLAS_LOG_DEVICE_ERROR(name_, "I2c", "Read len=" + std::to_string(length) +
+                              " failed: " + make_error_code(err).message());
+        return core::Result<size_t>::Err(err);
+    }
+    span.SetLength(transferred);
+    timer.SetBytes(transferred);
+    CountTransfer(transferred);
+    return core::Result<size_t>::Ok(static_cast<size_t>(transferred));
+}
+
+core::Result<size_t> Ft4222hDevice::SlaveBlockReadLocked(core::Byte* data,
+                                                         size_t capacity,
+                                                         bool pec) {
+    log::TraceSpan span(trace_id_, log::TraceInterface::kI2c,
+                        log::TraceOp::kRead, slave_addr_, capacity);
+    MetricsTimer timer(metrics_, MetricOp::kI2cRead, capacity);
+    auto fail = [&](std::error_code err) {
+        span.SetStatus(err);
+        timer.SetError();
+        PLAS_LOG_DEVICE_ERROR(name_, "SmBus", "BlockRead failed: " +
+                              err.message());
+        return core::Result<size_t>::Err(err);
+    };
+
+    // Take whatever has arrived (at least the count byte) in one read; most
+    // blocks are complete by then. Poll again only for the remainder.
+    size_t got = 0;
+    size_t need = capacity;
+    while (got < need) {
+        auto poll_result = PollSlaveRx(got == 0 ? 1 : need - got);
+        if (poll_result.IsError()) {
+            return fail(poll_result.Error());
+        }
+        size_t chunk = std::min<size_t>(poll_result.Value(), need - got);
+        uint16 transferred = 0;
+        FT4222_STATUS status = FT4222_I2CSlave_Read(
+            static_cast<FT_HANDLE>(slave_handle_), data + got,
+            static_cast<uint16>(chunk), &transferred);
+        if (status != FT4222_OK) {
+            return fail(make_error_code(MapFt4222Status(status)));
+        }
+        if (got == 0 && transferred > 0) {
+            need = 1 + data[0] + (pec ? 1u : 0u);
+            if (need > capacity) {
+                return fail(make_error_code(core::ErrorCode::kOverflow));
+            }
+        }
+        got += transferred;
+    }
+    span.SetLength(need);
+    timer.SetBytes(need);
+    CountTransfer(need);
+    return core::Result<size_t>::Ok(need);
+}
+#endif
+
 core::Result<size_t> Ft4222hDevice::Write(core::Address addr,
                                           const core::Byte* data,
                                           size_t length, bool stop) {
@@ -371,25 +1009,10 @@ core::Result<size_t> Ft4222hDevice::Write(core::Address addr,
     }
 
 #ifdef PLAS_HAS_FT4222H
-    std::lock_guard<std::mutex> lock(i2c_mutex_);
-    uint16 transferred = 0;
+    std::lock_guard<core::IoQueue> lock(i2c_queue_);
     // START_AND_STOP (0x06) = normal transfer; START (0x02) = no STOP (Repeated START possible)
     uint8 flag = stop ? START_AND_STOP : START;
-    FT4222_STATUS status = FT4222_I2CMaster_WriteEx(
-        static_cast<FT_HANDLE>(master_handle_),
-        static_cast<uint16>(addr),
-        flag,
-        const_cast<uint8*>(data),
-        static_cast<uint16>(length),
-        &transferred);
-    if (status != FT4222_OK) {
-        auto err = MapFt4222Status(status);
-        PLAS_LOG_ERROR("[" + name_ + "][I2c] Write addr=" + std::to_string(addr) +
-                       " len=" + std::to_string(length) + " failed: " +
-                       make_error_code(err).message());
-        return core::Result<size_t>::Err(err);
-    }
-    return core::Result<size_t>::Ok(static_cast<size_t>(transferred));
+    return MasterWriteLocked(addr, data, length, flag);
 #else
     (void)addr;
     (void)data;
@@ -415,29 +1038,8 @@ core::Result<size_t> Ft4222hDevice::Read(core::Address addr, core::Byte* data,
     (void)stop;
 
 #ifdef PLAS_HAS_FT4222H
-    std::lock_guard<std::mutex> lock(i2c_mutex_);
-
-    // Poll slave RX buffer until enough data is available
-    auto poll_result = PollSlaveRx(length);
-    if (poll_result.IsError()) {
-        PLAS_LOG_ERROR("[" + name_ + "][I2c] Read len=" + std::to_string(length) +
-                       " poll failed: " + poll_result.Error().message());
-        return core::Result<size_t>::Err(poll_result.Error());
-    }
-
-    uint16 transferred = 0;
-    FT4222_STATUS status = FT4222_I2CSlave_Read(
-        static_cast<FT_HANDLE>(slave_handle_),
-        data,
-        static_cast<uint16>(length),
-        &transferred);
-    if (status != FT4222_OK) {
-        auto err = MapFt4222Status(status);
-        PLAS_LOG_ERROR("[" + name_ + "][I2c] Read len=" + std::to_string(length) +
-                       " failed: " + make_error_code(err).message());
-        return core::Result<size_t>::Err(err);
-    }
-    return core::Result<size_t>::Ok(static_cast<size_t>(transferred));
+    std::lock_guard<core::IoQueue> lock(i2c_queue_);
+    return SlaveReadLocked(data, length);
 #else
     (void)data;
     (void)length;
@@ -462,66 +1064,398 @@ core::Result<size_t> Ft4222hDevice::WriteRead(core::Address addr,
     }
 
 #ifdef PLAS_HAS_FT4222H
-    std::lock_guard<std::mutex> lock(i2c_mutex_);
+    std::lock_guard<core::IoQueue> lock(i2c_queue_);
 
     // Master write without STOP — Repeated START follows for the slave read.
-    uint16 write_transferred = 0;
-    FT4222_STATUS status = FT4222_I2CMaster_WriteEx(
-        static_cast<FT_HANDLE>(master_handle_),
-        static_cast<uint16>(addr),
-        START,
-        const_cast<uint8*>(write_data),
-        static_cast<uint16>(write_len),
-        &write_transferred);
+    auto write_result = MasterWriteLocked(addr, write_data, write_len, START);
+    if (write_result.IsError()) {
+        return write_result;
+    }
+    return SlaveReadLocked(read_data, read_len);
+#else
+    (void)addr;
+    (void)write_data;
+    (void)write_len;
+    (void)read_data;
+    (void)read_len;
+    return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+#endif
+}
+
+core::Result<size_t> Ft4222hDevice::Transfer(I2cMessage* msgs, size_t count) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (msgs == nullptr && count > 0) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (msgs[i].data == nullptr || msgs[i].length == 0 ||
+            msgs[i].length > 0xFFFF) {
+            return core::Result<size_t>::Err(
+                core::ErrorCode::kInvalidArgument);
+        }
+    }
+
+#ifdef PLAS_HAS_FT4222H
+    std::lock_guard<core::IoQueue> lock(i2c_queue_);
+    bool bus_open = false;  // previous master write left the bus without STOP
+    for (size_t i = 0; i < count; ++i) {
+        auto& msg = msgs[i];
+        bool stop = msg.stop || i + 1 == count;
+
+        core::Result<size_t> result = core::Result<size_t>::Ok(0);
+        if (msg.read) {
+            // Slave-mode receive, as in Read(): addr/stop are DUT-controlled.
+            result = SlaveReadLocked(msg.data, msg.length);
+        } else {
+            uint8 flag = static_cast<uint8>(
+                (bus_open ? Repeated_START : START) | (stop ? STOP : 0));
+            result = MasterWriteLocked(msg.addr, msg.data, msg.length, flag);
+            bus_open = !stop;
+        }
+        if (result.IsError()) {
+            return core::Result<size_t>::Err(result.Error());
+        }
+        msg.transferred = result.Value();
+    }
+    return core::Result<size_t>::Ok(count);
+#else
+    return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// SmBus interface
+// ---------------------------------------------------------------------------
+
+core::Result<size_t> Ft4222hDevice::Transact(core::Address addr,
+                                             const core::Byte* write,
+                                             size_t write_len, core::Byte* read,
+                                             size_t read_len, bool block,
+                                             bool pec) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (write == nullptr || write_len == 0 ||
+        (read == nullptr && read_len > 0)) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (write_len > 0xFFFF || read_len > 0xFFFF) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+#ifdef PLAS_HAS_FT4222H
+    std::lock_guard<core::IoQueue> lock(i2c_queue_);
+    if (read_len == 0) {
+        return MasterWriteLocked(addr, write, write_len, START_AND_STOP);
+    }
+    // Command without STOP; the response arrives on the slave interface.
+    auto write_result = MasterWriteLocked(addr, write, write_len, START);
+    if (write_result.IsError()) {
+        return write_result;
+    }
+    return block ? SlaveBlockReadLocked(read, read_len, pec)
+                 : SlaveReadLocked(read, read_len);
+#else
+    (void)addr;
+    (void)block;
+    (void)pec;
+    return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Spi interface
+//
+// Single-line transfers are cut into kSpiChunkSize SDK calls that keep chip
+// select asserted until the last one, read from and written to the
+// caller's buffers directly. Dual/quad phases use FT4222_SPIMaster_
+// MultiReadWrite, which takes the single-line header and the data as one
+// buffer and ends the transaction itself.
+// ---------------------------------------------------------------------------
+
+#ifdef PLAS_HAS_FT4222H
+core::Result<void> Ft4222hDevice::SpiInitLocked() {
+    auto mode = static_cast<uint8_t>(spi_mode_);
+    FT4222_STATUS status = FT4222_SPIMaster_Init(
+        static_cast<FT_HANDLE>(spi_handle_), SPI_IO_SINGLE,
+        static_cast<FT4222_SPIClock>(spi_clock_div_),
+        (mode & 0x2) ? CLK_IDLE_HIGH : CLK_IDLE_LOW,
+        (mode & 0x1) ? CLK_TRAILING : CLK_LEADING,
+        static_cast<uint8>(1u << spi_cs_));
     if (status != FT4222_OK) {
-        auto err = MapFt4222Status(status);
-        PLAS_LOG_ERROR("[" + name_ + "][I2c] WriteRead addr=" + std::to_string(addr) +
-                       " write phase failed: " + make_error_code(err).message());
-        return core::Result<size_t>::Err(err);
+        return core::Result<void>::Err(MapFt4222Status(status));
     }
+    spi_lines_ = SpiLines::kSingle;
+    return core::Result<void>::Ok();
+}
 
-    // Poll slave RX buffer
-    auto poll_result = PollSlaveRx(read_len);
-    if (poll_result.IsError()) {
-        PLAS_LOG_ERROR("[" + name_ + "][I2c] WriteRead addr=" + std::to_string(addr) +
-                       " poll failed: " + poll_result.Error().message());
-        return core::Result<size_t>::Err(poll_result.Error());
+core::Result<void> Ft4222hDevice::SpiSetLinesLocked(SpiLines lines) {
+    if (lines == spi_lines_) {
+        return core::Result<void>::Ok();
+    }
+    FT4222_STATUS status = FT4222_SPIMaster_SetLines(
+        static_cast<FT_HANDLE>(spi_handle_),
+        static_cast<FT4222_SPIMode>(static_cast<uint8_t>(lines)));
+    if (status != FT4222_OK) {
+        return core::Result<void>::Err(MapFt4222Status(status));
     }
+    spi_lines_ = lines;
+    return core::Result<void>::Ok();
+}
 
-    // Slave read
-    uint16 read_transferred = 0;
-    status = FT4222_I2CSlave_Read(
-        static_cast<FT_HANDLE>(slave_handle_),
-        read_data,
-        static_cast<uint16>(read_len),
-        &read_transferred);
+core::Result<size_t> Ft4222hDevice::SpiExchangeLocked(const core::Byte* write,
+                                                      core::Byte* read,
+                                                      size_t length, bool end) {
+    auto op = write == nullptr ? log::TraceOp::kRead
+              : read == nullptr ? log::TraceOp::kWrite
+                                : log::TraceOp::kExchange;
+    log::TraceSpan span(trace_id_, log::TraceInterface::kSpi, op, 0, length);
+    MetricsTimer timer(metrics_,
+                       read != nullptr ? MetricOp::kSpiRead : MetricOp::kSpiWrite,
+                       length);
+    auto handle = static_cast<FT_HANDLE>(spi_handle_);
+
+    size_t done = 0;
+    while (done < length) {
+        auto chunk = static_cast<uint16>(std::min(length - done, kSpiChunkSize));
+        BOOL last = (end && done + chunk == length) ? TRUE : FALSE;
+        uint16 transferred = 0;
+        FT4222_STATUS status;
+        if (write != nullptr && read != nullptr) {
+            status = FT4222_SPIMaster_SingleReadWrite(
+                handle, read + done, const_cast<uint8*>(write + done), chunk,
+                &transferred, last);
+        } else if (write != nullptr) {
+            status = FT4222_SPIMaster_SingleWrite(
+                handle, const_cast<uint8*>(write + done), chunk, &transferred,
+                last);
+        } else {
+            status = FT4222_SPIMaster_SingleRead(handle, read + done, chunk,
+                                                 &transferred, last);
+        }
+        if (status != FT4222_OK || transferred != chunk) {
+            auto err = status != FT4222_OK ? MapFt4222Status(status)
+                                           : core::ErrorCode::kIOError;
+            span.SetStatus(make_error_code(err));
+            timer.SetError();
+            PLAS_LOG_DEVICE_ERROR(name_, "Spi", "Exchange len=" +
+                                  std::to_string(length) + " failed at " +
+                                  std::to_string(done + transferred) + ": " +
+                                  make_error_code(err).message());
+            return core::Result<size_t>::Err(err);
+        }
+        done += chunk;
+    }
+    CountTransfer(length);
+    return core::Result<size_t>::Ok(length);
+}
+
+core::Result<size_t> Ft4222hDevice::SpiMultiReadLocked(const SpiCommand& command) {
+    log::TraceSpan span(trace_id_, log::TraceInterface::kSpi,
+                        log::TraceOp::kRead, command.address, command.length);
+    MetricsTimer timer(metrics_, MetricOp::kSpiRead, command.length);
+
+    // The SDK ends the transaction after each call, so a read longer than
+    // one chunk continues as a new command at the next address.
+    std::array<core::Byte, kSpiMaxCommandHeader> header;
+    SpiCommand part = command;
+    size_t done = 0;
+    while (done < command.length) {
+        size_t chunk = std::min(command.length - done, kSpiChunkSize);
+        part.address = command.address + static_cast<uint32_t>(done);
+        auto header_len = EncodeSpiCommandHeader(part, header.data()).Value();
+        uint32 size_read = 0;
+        FT4222_STATUS status = FT4222_SPIMaster_MultiReadWrite(
+            static_cast<FT_HANDLE>(spi_handle_), command.read + done,
+            header.data(), static_cast<uint8>(header_len), 0,
+            static_cast<uint16>(chunk), &size_read);
+        if (status != FT4222_OK || size_read != chunk) {
+            auto err = status != FT4222_OK ? MapFt4222Status(status)
+                                           : core::ErrorCode::kIOError;
+            span.SetStatus(make_error_code(err));
+            timer.SetError();
+            PLAS_LOG_DEVICE_ERROR(name_, "Spi", "Command opcode=" +
+                                  std::to_string(command.opcode) + " read len=" +
+                                  std::to_string(command.length) + " failed: " +
+                                  make_error_code(err).message());
+            return core::Result<size_t>::Err(err);
+        }
+        done += chunk;
+    }
+    CountTransfer(command.length);
+    return core::Result<size_t>::Ok(command.length);
+}
+
+core::Result<size_t> Ft4222hDevice::SpiMultiWriteLocked(const SpiCommand& command,
+                                                        const core::Byte* header,
+                                                        size_t header_len) {
+    log::TraceSpan span(trace_id_, log::TraceInterface::kSpi,
+                        log::TraceOp::kWrite, command.address, command.length);
+    MetricsTimer timer(metrics_, MetricOp::kSpiWrite, command.length);
+
+    // Header and data go out from one buffer; the staging vector keeps its
+    // capacity, so page programs after the first do not allocate.
+    spi_staging_.resize(header_len + command.length);
+    std::memcpy(spi_staging_.data(), header, header_len);
+    if (command.length > 0) {
+        std::memcpy(spi_staging_.data() + header_len, command.write, command.length);
+    }
+    uint32 size_read = 0;
+    FT4222_STATUS status = FT4222_SPIMaster_MultiReadWrite(
+        static_cast<FT_HANDLE>(spi_handle_), nullptr, spi_staging_.data(),
+        static_cast<uint8>(header_len), static_cast<uint16>(command.length), 0,
+        &size_read);
     if (status != FT4222_OK) {
         auto err = MapFt4222Status(status);
-        PLAS_LOG_ERROR("[" + name_ + "][I2c] WriteRead addr=" + std::to_string(addr) +
-                       " read phase failed: " + make_error_code(err).message());
+        span.SetStatus(make_error_code(err));
+        timer.SetError();
+        PLAS_LOG_DEVICE_ERROR(name_, "Spi", "Command opcode=" +
+                              std::to_string(command.opcode) + " write len=" +
+                              std::to_string(command.length) + " failed: " +
+                              make_error_code(err).message());
         return core::Result<size_t>::Err(err);
     }
-    return core::Result<size_t>::Ok(static_cast<size_t>(read_transferred));
+    CountTransfer(header_len + command.length);
+    return core::Result<size_t>::Ok(command.length);
+}
+#endif
+
+core::Result<size_t> Ft4222hDevice::Exchange(const core::Byte* write,
+                                             core::Byte* read, size_t length,
+                                             bool end) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if ((write == nullptr && read == nullptr) || length == 0) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+#ifdef PLAS_HAS_FT4222H
+    if (spi_handle_ == nullptr) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+    }
+    std::lock_guard<core::IoQueue> lock(spi_queue_);
+    auto lines = SpiSetLinesLocked(SpiLines::kSingle);
+    if (lines.IsError()) {
+        return core::Result<size_t>::Err(lines.Error());
+    }
+    return SpiExchangeLocked(write, read, length, end);
 #else
-    (void)addr;
-    (void)write_data;
-    (void)write_len;
-    (void)read_data;
-    (void)read_len;
+    (void)end;
     return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
 #endif
 }
 
+core::Result<size_t> Ft4222hDevice::Command(const SpiCommand& command) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+    std::array<core::Byte, kSpiMaxCommandHeader> header;
+    auto header_len = EncodeSpiCommandHeader(command, header.data());
+    if (header_len.IsError()) {
+        return header_len;
+    }
+    bool multi = command.lines != SpiLines::kSingle;
+    if (multi && (header_len.Value() > kSpiMaxMultiHeader ||
+                  (command.write != nullptr && command.length > 0xFFFF) ||
+                  (command.read != nullptr && command.length > kSpiChunkSize &&
+                   command.address_bytes == 0))) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+#ifdef PLAS_HAS_FT4222H
+    if (spi_handle_ == nullptr) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+    }
+    std::lock_guard<core::IoQueue> lock(spi_queue_);
+    auto lines = SpiSetLinesLocked(command.lines);
+    if (lines.IsError()) {
+        return core::Result<size_t>::Err(lines.Error());
+    }
+    if (multi) {
+        return command.read != nullptr
+                   ? SpiMultiReadLocked(command)
+                   : SpiMultiWriteLocked(command, header.data(), header_len.Value());
+    }
+    auto sent = SpiExchangeLocked(header.data(), nullptr, header_len.Value(),
+                                  command.length == 0);
+    if (sent.IsError()) {
+        return sent;
+    }
+    if (command.length == 0) {
+        return core::Result<size_t>::Ok(0);
+    }
+    return SpiExchangeLocked(command.write, command.read, command.length, true);
+#else
+    return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+#endif
+}
+
+core::Result<void> Ft4222hDevice::SetClock(core::Frequency freq) {
+    uint8_t div = SpiClockDivider(sys_clock_, freq.Value());
+    if (div == 0) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+    spi_clock_div_ = div;
+
+#ifdef PLAS_HAS_FT4222H
+    if (state_ == DeviceState::kOpen && spi_handle_ != nullptr) {
+        std::lock_guard<core::IoQueue> lock(spi_queue_);
+        auto result = SpiInitLocked();
+        if (result.IsError()) {
+            return result;
+        }
+        PLAS_LOG_INFO("Ft4222hDevice::SetClock() SPI " +
+                      std::to_string(GetClock().Value()) + " Hz");
+    }
+#endif
+
+    return core::Result<void>::Ok();
+}
+
+core::Frequency Ft4222hDevice::GetClock() const {
+    return core::Frequency(static_cast<double>(SysClockHz(sys_clock_) >> spi_clock_div_));
+}
+
+core::Result<void> Ft4222hDevice::SetMode(SpiMode mode) {
+    if (static_cast<uint8_t>(mode) > 3) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    spi_mode_ = mode;
+
+#ifdef PLAS_HAS_FT4222H
+    if (state_ == DeviceState::kOpen && spi_handle_ != nullptr) {
+        std::lock_guard<core::IoQueue> lock(spi_queue_);
+        return SpiInitLocked();
+    }
+#endif
+
+    return core::Result<void>::Ok();
+}
+
 // ---------------------------------------------------------------------------
-// PollSlaveRx — deadline-based polling
+// PollSlaveRx — deadline-based RX wait
+//
+// The wait ends after rx_timeout_ms or at the caller's core::Deadline,
+// whichever comes first.
+//
+// With RX events the wait blocks on the SDK notification, re-checking the
+// FIFO at least every rx_poll_interval_us to cover a signal that fired
+// before we started waiting. Without events it polls with an interval that
+// starts short and doubles up to rx_poll_interval_us, so fast responses are
+// not held back by a full interval.
 // ---------------------------------------------------------------------------
 
 core::Result<uint16_t> Ft4222hDevice::PollSlaveRx(size_t expected_len) {
 #ifdef PLAS_HAS_FT4222H
-    auto deadline = std::chrono::steady_clock::now() +
-                    std::chrono::milliseconds(rx_timeout_ms_);
+    constexpr uint32_t kInitialBackoffUs = 5;
+    auto deadline = core::Deadline::Current().Clamp(
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(rx_timeout_ms_));
+    uint32_t backoff_us = std::min(kInitialBackoffUs, rx_poll_interval_us_);
 
-    while (std::chrono::steady_clock::now() < deadline) {
+    for (;;) {
         uint16 rx_size = 0;
         FT4222_STATUS status = FT4222_I2CSlave_GetRxStatus(
             static_cast<FT_HANDLE>(slave_handle_), &rx_size);
@@ -531,8 +1465,25 @@ core::Result<uint16_t> Ft4222hDevice::PollSlaveRx(size_t expected_len) {
         if (rx_size >= static_cast<uint16>(expected_len)) {
             return core::Result<uint16_t>::Ok(rx_size);
         }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            break;
+        }
+        auto remaining =
+            std::chrono::duration_cast<std::chrono::microseconds>(deadline -
+                                                                  now);
+
+#ifdef PLAS_FT4222H_RX_EVENT
+        if (rx_event_) {
+            rx_event_->WaitFor(std::min(
+                remaining, std::chrono::microseconds(rx_poll_interval_us_)));
+            continue;
+        }
+#endif
         std::this_thread::sleep_for(
-            std::chrono::microseconds(rx_poll_interval_us_));
+            std::min(remaining, std::chrono::microseconds(backoff_us)));
+        backoff_us = std::min(backoff_us * 2, rx_poll_interval_us_);
     }
 
     return core::Result<uint16_t>::Err(core::ErrorCode::kTimeout);
@@ -542,6 +1493,10 @@ core::Result<uint16_t> Ft4222hDevice::PollSlaveRx(size_t expected_len) {
 #endif
 }
 
+bool Ft4222hDevice::IsRxEventActive() const {
+    return rx_event_ != nullptr;
+}
+
 // ---------------------------------------------------------------------------
 // Bitrate
 // ---------------------------------------------------------------------------
@@ -577,8 +1532,9 @@ uint32_t Ft4222hDevice::GetBitrate() const {
 
 void Ft4222hDevice::Register() {
     DeviceFactory::RegisterDriver(
-        "ft4222h", [](const config::DeviceEntry& entry) {
-            return std::make_unique<Ft4222hDevice>(entry);
+        "ft4222h", [](const config::DeviceEntry& entry,
+                      const config::DeviceUri& uri) {
+            return std::make_unique<Ft4222hDevice>(entry, uri);
         });
 }
 
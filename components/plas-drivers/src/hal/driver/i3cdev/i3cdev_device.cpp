@@ -0,0 +1,524 @@
+#include "plas/hal/driver/i3cdev/i3cdev_device.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// The i3cdev uapi header only exists on kernels carrying the i3cdev
+// patches; without it the driver still caches the target table but has no
+// private-transfer path.
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/i3c/i3cdev.h>)
+#define PLAS_I3CDEV_XFER 1
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <linux/i3c/i3cdev.h>
+#endif
+#endif
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/device_factory.h"
+#include "plas/log/logger.h"
+
+namespace plas::hal::driver {
+
+namespace {
+
+/// One sysfs attribute as an unsigned number in `base`.
+bool ReadSysfsNumber(const std::filesystem::path& path, int base, uint64_t& out) {
+    std::ifstream in(path);
+    std::string text;
+    if (!in || !std::getline(in, text)) {
+        return false;
+    }
+    while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) {
+        text.pop_back();
+    }
+    return config::DeviceUri::ParseNumber(text, base, ~uint64_t{0}, out);
+}
+
+std::string PidHex(uint64_t pid) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%llx", static_cast<unsigned long long>(pid));
+    return buf;
+}
+
+#ifdef PLAS_I3CDEV_XFER
+core::ErrorCode MapErrno(int err) {
+    switch (err) {
+        case ENOENT:
+        case ENODEV:
+        case ENXIO:
+            return core::ErrorCode::kNotFound;
+        case EACCES:
+        case EPERM:
+            return core::ErrorCode::kPermissionDenied;
+        case ETIMEDOUT:
+            return core::ErrorCode::kTimeout;
+        case EBUSY:
+            return core::ErrorCode::kBusy;
+        case EINVAL:
+            return core::ErrorCode::kInvalidArgument;
+        case ENOMEM:
+            return core::ErrorCode::kOutOfMemory;
+        case EOPNOTSUPP:
+            return core::ErrorCode::kNotSupported;
+        default:
+            return core::ErrorCode::kIOError;
+    }
+}
+#endif
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// URI parsing: i3cdev://bus:target
+// ---------------------------------------------------------------------------
+
+bool I3cDevDevice::ParseUri(const config::DeviceUri& uri, uint32_t& bus,
+                            bool& all_targets, uint64_t& pid) {
+    if (!uri.IsValid() || uri.Scheme() != "i3cdev" || uri.FieldCount() != 2) {
+        return false;
+    }
+
+    uint32_t bus_val = 0;
+    if (!uri.Number(0, 10, bus_val)) {
+        return false;
+    }
+
+    // Either every target on the bus or one 48-bit PID (hex)
+    uint64_t pid_val = 0;
+    const bool all = uri.Field(1) == "all";
+    if (!all && !uri.Number(1, 16, (uint64_t{1} << 48) - 1, pid_val)) {
+        return false;
+    }
+
+    bus = bus_val;
+    all_targets = all;
+    pid = pid_val;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Constructor / Destructor
+// ---------------------------------------------------------------------------
+
+I3cDevDevice::I3cDevDevice(const config::DeviceEntry& entry)
+    : I3cDevDevice(entry, config::DeviceUri::Parse(entry.uri)) {}
+
+I3cDevDevice::I3cDevDevice(const config::DeviceEntry& entry,
+                           const config::DeviceUri& uri)
+    : name_(entry.nickname),
+      uri_(entry.uri),
+      state_(DeviceState::kUninitialized),
+      bus_(0),
+      all_targets_(true),
+      pid_(0),
+      sysfs_root_("/sys/bus/i3c/devices"),
+      dev_root_("/dev/bus/i3c"),
+      frequency_(0.0) {
+    uri_valid_ = ParseUri(uri, bus_, all_targets_, pid_);
+
+    // Parse optional config args
+    auto it = entry.args.find("sysfs_root");
+    if (it != entry.args.end() && !it->second.empty()) {
+        sysfs_root_ = it->second;
+    }
+
+    it = entry.args.find("dev_root");
+    if (it != entry.args.end() && !it->second.empty()) {
+        dev_root_ = it->second;
+    }
+}
+
+I3cDevDevice::~I3cDevDevice() {
+    if (state_ == DeviceState::kOpen) {
+        Close();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Device interface
+// ---------------------------------------------------------------------------
+
+core::Result<void> I3cDevDevice::Init() {
+    if (state_ != DeviceState::kUninitialized &&
+        state_ != DeviceState::kClosed) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    if (!uri_valid_) {
+        PLAS_LOG_ERROR("I3cDevDevice::Init() invalid URI: " + uri_);
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    PLAS_LOG_INFO("I3cDevDevice::Init() bus=" + std::to_string(bus_) +
+                  " device='" + name_ + "'");
+    state_ = DeviceState::kInitialized;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> I3cDevDevice::Open() {
+    if (state_ != DeviceState::kInitialized) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+
+    const auto bus_dir =
+        std::filesystem::path(sysfs_root_) / ("i3c-" + std::to_string(bus_));
+    std::error_code ec;
+    if (!std::filesystem::is_directory(bus_dir, ec)) {
+        PLAS_LOG_ERROR("I3cDevDevice::Open() no I3C bus at " + bus_dir.string());
+        return core::Result<void>::Err(core::ErrorCode::kNotFound);
+    }
+
+    uint64_t hz = 0;
+    frequency_ = core::Frequency(
+        ReadSysfsNumber(bus_dir / "i3c_scl_frequency", 10, hz) ? static_cast<double>(hz)
+                                                               : 0.0);
+
+    std::lock_guard lock(i3c_mutex_);
+    targets_.Clear();
+    auto scanned = ScanLocked();
+    if (scanned.IsError()) {
+        return core::Result<void>::Err(scanned.Error());
+    }
+    if (!all_targets_ && targets_.Size() == 0) {
+        PLAS_LOG_ERROR("I3cDevDevice::Open() target " + PidHex(pid_) +
+                       " not on bus " + std::to_string(bus_));
+        return core::Result<void>::Err(core::ErrorCode::kNotFound);
+    }
+
+#ifndef PLAS_I3CDEV_XFER
+    PLAS_LOG_WARN("I3cDevDevice::Open() [no i3cdev support] device='" + name_ +
+                  "' private transfers unavailable");
+#endif
+    PLAS_LOG_INFO("I3cDevDevice::Open() device='" + name_ + "' targets=" +
+                  std::to_string(targets_.Size()));
+    state_ = DeviceState::kOpen;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> I3cDevDevice::Close() {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyClosed);
+    }
+
+    std::lock_guard lock(i3c_mutex_);
+    CloseFdsLocked();
+    held_write_.clear();
+    targets_.Clear();
+    PLAS_LOG_INFO("I3cDevDevice::Close() device='" + name_ + "'");
+    state_ = DeviceState::kClosed;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> I3cDevDevice::Reset() {
+    if (state_ == DeviceState::kOpen) {
+        auto result = Close();
+        if (result.IsError()) {
+            return result;
+        }
+    }
+    state_ = DeviceState::kUninitialized;
+    return Init();
+}
+
+DeviceState I3cDevDevice::GetState() const {
+    return state_;
+}
+
+std::string I3cDevDevice::GetName() const {
+    return name_;
+}
+
+std::string I3cDevDevice::GetUri() const {
+    return uri_;
+}
+
+std::string I3cDevDevice::GetDriverName() const {
+    return "i3cdev";
+}
+
+Device* I3cDevDevice::GetDevice() {
+    return this;
+}
+
+// ---------------------------------------------------------------------------
+// Target table
+// ---------------------------------------------------------------------------
+
+core::Result<size_t> I3cDevDevice::ScanLocked() {
+    // Targets are "<bus>-<pid>" entries carrying the attributes the kernel
+    // recorded during DAA.
+    const std::string prefix = std::to_string(bus_) + "-";
+    std::error_code ec;
+    std::filesystem::directory_iterator dir(sysfs_root_, ec);
+    if (ec) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotFound);
+    }
+
+    size_t added = 0;
+    for (const auto& entry : dir) {
+        const std::string name = entry.path().filename().string();
+        if (name.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        uint64_t pid = 0;
+        uint64_t bcr = 0;
+        uint64_t dcr = 0;
+        uint64_t addr = 0;
+        if (!ReadSysfsNumber(entry.path() / "pid", 16, pid) ||
+            !ReadSysfsNumber(entry.path() / "bcr", 16, bcr) ||
+            !ReadSysfsNumber(entry.path() / "dcr", 16, dcr) ||
+            !ReadSysfsNumber(entry.path() / "dynamic_address", 16, addr)) {
+            PLAS_LOG_WARN("I3cDevDevice: skipping unreadable target " + name);
+            continue;
+        }
+        if ((!all_targets_ && pid != pid_) || targets_.FindByPid(pid)) {
+            continue;
+        }
+
+        I3cTargetInfo info;
+        info.pid = pid;
+        info.bcr = static_cast<uint8_t>(bcr);
+        info.dcr = static_cast<uint8_t>(dcr);
+        info.dynamic_address = static_cast<core::Address>(addr);
+        if (targets_.Add(info).IsOk()) {
+            ++added;
+        }
+    }
+    return core::Result<size_t>::Ok(added);
+}
+
+core::Result<std::vector<I3cTargetInfo>> I3cDevDevice::GetTargets() {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<std::vector<I3cTargetInfo>>::Err(
+            core::ErrorCode::kNotInitialized);
+    }
+    return core::Result<std::vector<I3cTargetInfo>>::Ok(targets_.Targets());
+}
+
+core::Result<size_t> I3cDevDevice::AssignDynamicAddresses() {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+    std::lock_guard lock(i3c_mutex_);
+    return ScanLocked();
+}
+
+// ---------------------------------------------------------------------------
+// Private transfers
+// ---------------------------------------------------------------------------
+
+core::Result<int> I3cDevDevice::TargetFdLocked(const I3cTargetInfo& target) {
+#ifdef PLAS_I3CDEV_XFER
+    auto it = fds_.find(target.pid);
+    if (it != fds_.end()) {
+        return core::Result<int>::Ok(it->second);
+    }
+    const std::string path =
+        dev_root_ + "/" + std::to_string(bus_) + "-" + PidHex(target.pid);
+    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        auto err = MapErrno(errno);
+        PLAS_LOG_DEVICE_ERROR(name_, "I3c", "open " + path + " failed: " +
+                              std::strerror(errno));
+        return core::Result<int>::Err(err);
+    }
+    fds_.emplace(target.pid, fd);
+    return core::Result<int>::Ok(fd);
+#else
+    (void)target;
+    return core::Result<int>::Err(core::ErrorCode::kNotSupported);
+#endif
+}
+
+void I3cDevDevice::CloseFdsLocked() {
+#ifdef PLAS_I3CDEV_XFER
+    for (const auto& [pid, fd] : fds_) {
+        ::close(fd);
+    }
+#endif
+    fds_.clear();
+}
+
+core::Result<size_t> I3cDevDevice::TransferLocked(core::Address addr,
+                                                  core::Byte* data,
+                                                  size_t length, bool read) {
+    auto target = targets_.Find(addr);
+    if (!target) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotFound);
+    }
+    // Lengths the target reported (GETMRL/GETMWL) bound every transfer.
+    const uint16_t limit = read ? target->max_read_length : target->max_write_length;
+    if (length == 0 || length > 0xFFFF || (limit != 0 && length > limit)) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    auto fd = TargetFdLocked(*target);
+    if (fd.IsError()) {
+        return core::Result<size_t>::Err(fd.Error());
+    }
+
+    std::vector<core::Byte> held;
+    if (held_addr_ == addr) {
+        held.swap(held_write_);
+    }
+
+#ifdef PLAS_I3CDEV_XFER
+    i3c_ioc_priv_xfer xfers[2];
+    std::memset(xfers, 0, sizeof(xfers));
+    unsigned count = 0;
+    if (!held.empty()) {
+        xfers[count].data = reinterpret_cast<uintptr_t>(held.data());
+        xfers[count].len = static_cast<uint16_t>(held.size());
+        xfers[count].rnw = 0;
+        ++count;
+    }
+    xfers[count].data = reinterpret_cast<uintptr_t>(data);
+    xfers[count].len = static_cast<uint16_t>(length);
+    xfers[count].rnw = read ? 1 : 0;
+    ++count;
+
+    int rc = ::ioctl(fd.Value(), I3C_IOC_PRIV_XFER(count), xfers);
+    if (rc < 0) {
+        auto err = MapErrno(errno);
+        PLAS_LOG_DEVICE_ERROR(name_, "I3c", std::string(read ? "Read" : "Write") +
+                              " addr=" + std::to_string(addr) + " len=" +
+                              std::to_string(length) + " failed: " + std::strerror(errno));
+        return core::Result<size_t>::Err(err);
+    }
+    return core::Result<size_t>::Ok(length);
+#else
+    (void)data;
+    return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+#endif
+}
+
+core::Result<size_t> I3cDevDevice::Read(core::Address addr, core::Byte* data,
+                                        size_t length, bool stop) {
+    (void)stop;  // a read always ends the transfer
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (data == nullptr) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    std::lock_guard lock(i3c_mutex_);
+    if (!held_write_.empty() && held_addr_ != addr) {
+        std::vector<core::Byte> held;
+        held.swap(held_write_);
+        auto flushed = TransferLocked(held_addr_, held.data(), held.size(), false);
+        if (flushed.IsError()) {
+            return flushed;
+        }
+    }
+    return TransferLocked(addr, data, length, true);
+}
+
+core::Result<size_t> I3cDevDevice::Write(core::Address addr,
+                                         const core::Byte* data, size_t length,
+                                         bool stop) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (data == nullptr) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    std::lock_guard lock(i3c_mutex_);
+    if (!held_write_.empty() && held_addr_ != addr) {
+        std::vector<core::Byte> held;
+        held.swap(held_write_);
+        auto flushed = TransferLocked(held_addr_, held.data(), held.size(), false);
+        if (flushed.IsError()) {
+            return flushed;
+        }
+    }
+    if (!stop) {
+        if (!targets_.Find(addr)) {
+            return core::Result<size_t>::Err(core::ErrorCode::kNotFound);
+        }
+        // Held until the next transfer so both go out under one ioctl.
+        held_addr_ = addr;
+        held_write_.insert(held_write_.end(), data, data + length);
+        return core::Result<size_t>::Ok(length);
+    }
+    std::vector<core::Byte> buf(data, data + length);  // ioctl takes non-const
+    return TransferLocked(addr, buf.data(), buf.size(), false);
+}
+
+// ---------------------------------------------------------------------------
+// CCCs
+// ---------------------------------------------------------------------------
+
+core::Result<void> I3cDevDevice::SendBroadcastCcc(uint8_t ccc_id,
+                                                  const core::Byte* data,
+                                                  size_t length) {
+    (void)data;
+    (void)length;
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (ccc_id == i3c_ccc::kEntdaa) {
+        auto added = AssignDynamicAddresses();
+        if (added.IsError()) {
+            return core::Result<void>::Err(added.Error());
+        }
+        return core::Result<void>::Ok();
+    }
+    return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+}
+
+core::Result<void> I3cDevDevice::SendDirectCcc(uint8_t ccc_id,
+                                               core::Address addr,
+                                               const core::Byte* data,
+                                               size_t length) {
+    (void)ccc_id;
+    (void)addr;
+    (void)data;
+    (void)length;
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+}
+
+core::Result<size_t> I3cDevDevice::RecvDirectCcc(uint8_t ccc_id,
+                                                 core::Address addr,
+                                                 core::Byte* data,
+                                                 size_t length) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+    return targets_.Answer(ccc_id, addr, data, length);
+}
+
+core::Result<void> I3cDevDevice::SetFrequency(core::Frequency freq) {
+    (void)freq;
+    return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+}
+
+core::Frequency I3cDevDevice::GetFrequency() const {
+    return frequency_;
+}
+
+// ---------------------------------------------------------------------------
+// Self-registration
+// ---------------------------------------------------------------------------
+
+void I3cDevDevice::Register() {
+    DeviceFactory::RegisterDriver(
+        "i3cdev", [](const config::DeviceEntry& entry,
+                     const config::DeviceUri& uri) {
+            return std::make_unique<I3cDevDevice>(entry, uri);
+        });
+}
+
+}  // namespace plas::hal::driver
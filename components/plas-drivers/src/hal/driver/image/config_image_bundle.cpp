@@ -0,0 +1,459 @@
+#include "plas/hal/driver/image/config_image_bundle.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "plas/config/device_uri.h"
+
+namespace plas::hal::driver {
+
+// ---------------------------------------------------------------------------
+// Binary layout: Header, FunctionRecord[function_count] sorted by key,
+// DoeRecord[doe_count], then data_bytes of images and DOE payloads.
+// ---------------------------------------------------------------------------
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'L', 'A', 'S', 'C', 'F', 'G', 'I'};
+constexpr uint32_t kFormatVersion = 1;
+
+/// Sort key: domain, then the packed Bdf.
+uint32_t KeyOf(pci::PciAddress address) {
+    return (static_cast<uint32_t>(address.domain) << 16) | address.bdf.Pack();
+}
+
+pci::PciAddress AddressOf(uint32_t key) {
+    return pci::PciAddress{static_cast<uint16_t>(key >> 16),
+                           pci::Bdf::FromPacked(static_cast<uint16_t>(key))};
+}
+
+}  // namespace
+
+struct ConfigImageBundle::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t function_count;
+    uint32_t doe_count;
+    uint32_t reserved;
+    uint64_t data_bytes;
+};
+
+struct ConfigImageBundle::FunctionRecord {
+    uint32_t key;
+    uint32_t size;    // image bytes, at most kConfigSpaceSize
+    uint64_t offset;  // into data
+    uint32_t doe_begin;
+    uint32_t doe_count;
+};
+
+struct ConfigImageBundle::DoeRecord {
+    uint16_t doe_offset;
+    uint16_t vendor_id;
+    uint8_t data_object_type;
+    uint8_t reserved[3];
+    uint32_t request_dwords;
+    uint32_t response_dwords;
+    uint64_t payload;  // into data: request, then response
+};
+
+ConfigImageBundle::~ConfigImageBundle() {
+    if (mapping_ != nullptr) {
+        ::munmap(mapping_, size_);
+    }
+}
+
+bool ConfigImageBundle::Attach(const char* base, std::size_t size) {
+    static_assert(sizeof(Header) == 32 && sizeof(FunctionRecord) == 24 &&
+                      sizeof(DoeRecord) == 24,
+                  "bundle records are 8-byte multiples so every section stays aligned");
+    if (size < sizeof(Header)) {
+        return false;
+    }
+    Header header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kFormatVersion || header.data_bytes > size) {
+        return false;
+    }
+    const uint64_t functions_bytes =
+        static_cast<uint64_t>(header.function_count) * sizeof(FunctionRecord);
+    const uint64_t does_bytes = static_cast<uint64_t>(header.doe_count) * sizeof(DoeRecord);
+    if (sizeof(Header) + functions_bytes + does_bytes + header.data_bytes != size) {
+        return false;
+    }
+
+    const auto* functions = reinterpret_cast<const FunctionRecord*>(base + sizeof(Header));
+    const auto* does = reinterpret_cast<const DoeRecord*>(
+        base + sizeof(Header) + functions_bytes);
+    const uint64_t data_bytes = header.data_bytes;
+    for (uint32_t i = 0; i < header.function_count; ++i) {
+        const auto& f = functions[i];
+        if ((i > 0 && f.key <= functions[i - 1].key) || f.size > pci::kConfigSpaceSize ||
+            f.offset > data_bytes || f.size > data_bytes - f.offset ||
+            f.doe_begin > header.doe_count || f.doe_count > header.doe_count - f.doe_begin) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header.doe_count; ++i) {
+        const auto& d = does[i];
+        const uint64_t payload_bytes =
+            4 * (static_cast<uint64_t>(d.request_dwords) + d.response_dwords);
+        if (d.payload > data_bytes || payload_bytes > data_bytes - d.payload) {
+            return false;
+        }
+    }
+
+    base_ = base;
+    size_ = size;
+    functions_ = functions;
+    function_count_ = header.function_count;
+    doe_records_ = does;
+    doe_count_ = header.doe_count;
+    data_ = reinterpret_cast<const core::Byte*>(base + size - data_bytes);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Lookup
+// ---------------------------------------------------------------------------
+
+ConfigImageBundle::Function ConfigImageBundle::MakeFunction(
+    const FunctionRecord& record) const {
+    return Function{AddressOf(record.key), data_ + record.offset, record.size,
+                    record.doe_begin, record.doe_count};
+}
+
+ConfigImageBundle::Function ConfigImageBundle::FunctionAt(std::size_t index) const {
+    return MakeFunction(functions_[index]);
+}
+
+const ConfigImageBundle::FunctionRecord* ConfigImageBundle::FindRecord(
+    pci::PciAddress address) const {
+    const uint32_t key = KeyOf(address);
+    const FunctionRecord* end = functions_ + function_count_;
+    const FunctionRecord* it = std::lower_bound(
+        functions_, end, key,
+        [](const FunctionRecord& record, uint32_t k) { return record.key < k; });
+    return it != end && it->key == key ? it : nullptr;
+}
+
+std::optional<ConfigImageBundle::Function> ConfigImageBundle::Find(
+    pci::PciAddress address) const {
+    const FunctionRecord* record = FindRecord(address);
+    if (record == nullptr) {
+        return std::nullopt;
+    }
+    return MakeFunction(*record);
+}
+
+ConfigImageBundle::DoeResponse ConfigImageBundle::DoeAt(std::size_t index) const {
+    const DoeRecord& record = doe_records_[index];
+    const core::Byte* request = data_ + record.payload;
+    return DoeResponse{record.doe_offset,
+                       pci::DoeProtocolId{record.vendor_id, record.data_object_type},
+                       request,
+                       record.request_dwords,
+                       request + 4 * std::size_t{record.request_dwords},
+                       record.response_dwords};
+}
+
+// ---------------------------------------------------------------------------
+// Text form
+// ---------------------------------------------------------------------------
+
+namespace {
+
+int HexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/// Next space-separated token of `line`, consumed.
+std::string_view NextToken(std::string_view& line) {
+    size_t start = line.find_first_not_of(' ');
+    if (start == std::string_view::npos) {
+        line = std::string_view();
+        return line;
+    }
+    line.remove_prefix(start);
+    size_t end = line.find(' ');
+    std::string_view token = line.substr(0, end);
+    line = end == std::string_view::npos ? std::string_view() : line.substr(end);
+    return token;
+}
+
+/// A function as parsed, before the bundle is laid out.
+struct ParsedFunction {
+    uint32_t key = 0;
+    std::size_t offset = 0;  // into the staging image buffer
+    std::size_t size = 0;
+    std::size_t doe_begin = 0;  // into the staging DOE list
+    std::size_t doe_count = 0;
+};
+
+struct ParsedDoe {
+    pci::ConfigOffset doe_offset = 0;
+    pci::DoeProtocolId protocol{0, 0};
+    std::size_t request_dwords = 0;
+    std::vector<core::DWord> payload;  // request, then response
+};
+
+/// "doe OFF VVVV:TT REQ... -> RSP..." (after "doe").
+bool ParseDoeLine(std::string_view line, ParsedDoe& out) {
+    uint64_t offset = 0;
+    uint64_t vendor = 0;
+    uint64_t type = 0;
+    if (!config::DeviceUri::ParseNumber(NextToken(line), 16, pci::kConfigSpaceSize - 4,
+                                        offset)) {
+        return false;
+    }
+    std::string_view protocol = NextToken(line);
+    size_t colon = protocol.find(':');
+    if (colon == std::string_view::npos ||
+        !config::DeviceUri::ParseNumber(protocol.substr(0, colon), 16, 0xFFFF, vendor) ||
+        !config::DeviceUri::ParseNumber(protocol.substr(colon + 1), 16, 0xFF, type)) {
+        return false;
+    }
+    out.doe_offset = static_cast<pci::ConfigOffset>(offset);
+    out.protocol = {static_cast<uint16_t>(vendor), static_cast<uint8_t>(type)};
+
+    bool arrow = false;
+    for (std::string_view token = NextToken(line); !token.empty(); token = NextToken(line)) {
+        if (token == "->") {
+            if (arrow) {
+                return false;
+            }
+            arrow = true;
+            out.request_dwords = out.payload.size();
+            continue;
+        }
+        uint64_t dword = 0;
+        if (!config::DeviceUri::ParseNumber(token, 16, 0xFFFFFFFF, dword)) {
+            return false;
+        }
+        out.payload.push_back(static_cast<core::DWord>(dword));
+    }
+    return arrow;
+}
+
+/// "off: hh hh ..." into `config`; returns the end of the last byte
+/// written, or 0 if the line is not a row.
+std::size_t ParseRow(std::string_view line, core::Byte* config) {
+    size_t colon = line.find(": ");
+    uint64_t offset = 0;
+    if (colon == std::string_view::npos || colon == 0 ||
+        !config::DeviceUri::ParseNumber(line.substr(0, colon), 16,
+                                        pci::kConfigSpaceSize - 1, offset)) {
+        return 0;
+    }
+    std::size_t end = 0;
+    size_t pos = colon + 2;
+    while (pos + 1 < line.size() && offset < pci::kConfigSpaceSize) {
+        int hi = HexDigit(line[pos]);
+        int lo = HexDigit(line[pos + 1]);
+        if (hi < 0 || lo < 0) {
+            break;
+        }
+        config[offset++] = static_cast<core::Byte>((hi << 4) | lo);
+        end = offset;
+        pos += 3;
+    }
+    return end;
+}
+
+/// "[DDDD:]BB:DD.F" at the start of a device title line.
+bool ParseTitle(std::string_view line, pci::PciAddress& address) {
+    std::string_view token = line.substr(0, line.find(' '));
+    if (pci::PciAddress::Parse(token, address) == core::ErrorCode::kSuccess) {
+        return true;
+    }
+    pci::Bdf bdf{};
+    if (pci::Bdf::Parse(token, bdf) == core::ErrorCode::kSuccess) {
+        address = pci::PciAddress{0, bdf};
+        return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+std::shared_ptr<const ConfigImageBundle> ConfigImageBundle::ParseText(std::string_view text) {
+    std::vector<ParsedFunction> functions;
+    std::vector<ParsedDoe> does;
+    std::vector<core::Byte> images;
+    core::Byte image[pci::kConfigSpaceSize];
+    bool open = false;
+
+    auto finish = [&] {
+        if (open) {
+            auto& f = functions.back();
+            f.offset = images.size();
+            f.doe_count = does.size() - f.doe_begin;
+            images.insert(images.end(), image, image + f.size);
+        }
+    };
+
+    while (!text.empty()) {
+        size_t eol = text.find('\n');
+        std::string_view line = text.substr(0, eol);
+        text = eol == std::string_view::npos ? std::string_view() : text.substr(eol + 1);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        pci::PciAddress address{};
+        if (ParseTitle(line, address)) {
+            finish();
+            std::memset(image, 0, sizeof(image));
+            ParsedFunction f;
+            f.key = KeyOf(address);
+            f.doe_begin = does.size();
+            functions.push_back(f);
+            open = true;
+        } else if (!open) {
+            continue;
+        } else if (line.substr(0, 4) == "doe ") {
+            ParsedDoe doe;
+            if (ParseDoeLine(line.substr(4), doe)) {
+                does.push_back(std::move(doe));
+            }
+        } else {
+            functions.back().size = std::max(functions.back().size, ParseRow(line, image));
+        }
+    }
+    finish();
+
+    // Address order; the first of repeated addresses wins.
+    std::stable_sort(functions.begin(), functions.end(),
+                     [](const ParsedFunction& a, const ParsedFunction& b) {
+                         return a.key < b.key;
+                     });
+    functions.erase(std::unique(functions.begin(), functions.end(),
+                                [](const ParsedFunction& a, const ParsedFunction& b) {
+                                    return a.key == b.key;
+                                }),
+                    functions.end());
+
+    // Lay the kept functions out in the binary form.
+    std::size_t doe_count = 0;
+    std::size_t data_bytes = 0;
+    for (const auto& f : functions) {
+        data_bytes += f.size;
+        doe_count += f.doe_count;
+        for (std::size_t i = 0; i < f.doe_count; ++i) {
+            data_bytes += 4 * does[f.doe_begin + i].payload.size();
+        }
+    }
+    const std::size_t size = sizeof(Header) + functions.size() * sizeof(FunctionRecord) +
+                             doe_count * sizeof(DoeRecord) + data_bytes;
+
+    std::shared_ptr<ConfigImageBundle> bundle(new ConfigImageBundle());
+    bundle->owned_.assign((size + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+    char* base = reinterpret_cast<char*>(bundle->owned_.data());
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.function_count = static_cast<uint32_t>(functions.size());
+    header.doe_count = static_cast<uint32_t>(doe_count);
+    header.data_bytes = data_bytes;
+    std::memcpy(base, &header, sizeof(header));
+
+    char* records = base + sizeof(Header);
+    char* doe_records = records + functions.size() * sizeof(FunctionRecord);
+    core::Byte* data = reinterpret_cast<core::Byte*>(base + size - data_bytes);
+    std::size_t data_pos = 0;
+    std::size_t doe_index = 0;
+    for (std::size_t i = 0; i < functions.size(); ++i) {
+        const auto& f = functions[i];
+        FunctionRecord record{f.key, static_cast<uint32_t>(f.size), data_pos,
+                              static_cast<uint32_t>(doe_index),
+                              static_cast<uint32_t>(f.doe_count)};
+        std::memcpy(records + i * sizeof(FunctionRecord), &record, sizeof(record));
+        std::copy_n(images.data() + f.offset, f.size, data + data_pos);
+        data_pos += f.size;
+
+        for (std::size_t j = 0; j < f.doe_count; ++j, ++doe_index) {
+            const auto& doe = does[f.doe_begin + j];
+            DoeRecord out{};
+            out.doe_offset = doe.doe_offset;
+            out.vendor_id = doe.protocol.vendor_id;
+            out.data_object_type = doe.protocol.data_object_type;
+            out.request_dwords = static_cast<uint32_t>(doe.request_dwords);
+            out.response_dwords =
+                static_cast<uint32_t>(doe.payload.size() - doe.request_dwords);
+            out.payload = data_pos;
+            std::memcpy(doe_records + doe_index * sizeof(DoeRecord), &out, sizeof(out));
+            for (core::DWord dword : doe.payload) {
+                for (int b = 0; b < 4; ++b) {
+                    data[data_pos++] = static_cast<core::Byte>(dword >> (8 * b));
+                }
+            }
+        }
+    }
+
+    bundle->Attach(base, size);
+    return bundle;
+}
+
+// ---------------------------------------------------------------------------
+// Files
+// ---------------------------------------------------------------------------
+
+core::Result<std::shared_ptr<const ConfigImageBundle>> ConfigImageBundle::Load(
+    const std::string& path) {
+    using ResultType = core::Result<std::shared_ptr<const ConfigImageBundle>>;
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return ResultType::Err(core::ErrorCode::kNotFound);
+    }
+    struct stat st {};
+    void* mapping = MAP_FAILED;
+    std::size_t size = 0;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        size = static_cast<std::size_t>(st.st_size);
+        mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return ResultType::Err(size == 0 ? core::ErrorCode::kDataLoss
+                                         : core::ErrorCode::kNotFound);
+    }
+
+    const char* base = static_cast<const char*>(mapping);
+    if (size >= sizeof(kMagic) && std::memcmp(base, kMagic, sizeof(kMagic)) == 0) {
+        std::shared_ptr<ConfigImageBundle> bundle(new ConfigImageBundle());
+        if (!bundle->Attach(base, size)) {
+            ::munmap(mapping, size);
+            return ResultType::Err(core::ErrorCode::kDataLoss);
+        }
+        bundle->mapping_ = mapping;
+        return ResultType::Ok(std::move(bundle));
+    }
+
+    auto bundle = ParseText(std::string_view(base, size));
+    ::munmap(mapping, size);
+    if (bundle->FunctionCount() == 0) {
+        return ResultType::Err(core::ErrorCode::kDataLoss);
+    }
+    return ResultType::Ok(std::move(bundle));
+}
+
+core::Result<void> ConfigImageBundle::Save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(base_, static_cast<std::streamsize>(size_));
+    out.close();
+    return out ? core::Result<void>::Ok()
+               : core::Result<void>::Err(core::ErrorCode::kIOError);
+}
+
+}  // namespace plas::hal::driver
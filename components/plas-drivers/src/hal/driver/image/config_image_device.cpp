@@ -0,0 +1,501 @@
+#include "plas/hal/driver/image/config_image_device.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <utility>
+
+#include "plas/core/memory_usage.h"
+#include "plas/log/logger.h"
+
+namespace plas::hal::driver {
+
+namespace {
+
+constexpr pci::DoeProtocolId kDiscovery{pci::doe_vendor::kPciSig,
+                                        pci::doe_type::kDoeDiscovery};
+
+/// Bundles are loaded once per process while any device uses them.
+core::Result<std::shared_ptr<const ConfigImageBundle>> LoadBundle(const std::string& path) {
+    using Bundle = std::shared_ptr<const ConfigImageBundle>;
+    static std::mutex cache_mutex;
+    static std::map<std::string, std::weak_ptr<const ConfigImageBundle>> cache;
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    if (auto cached = cache[path].lock()) {
+        return core::Result<Bundle>::Ok(std::move(cached));
+    }
+    auto loaded = ConfigImageBundle::Load(path);
+    if (loaded.IsError()) {
+        PLAS_LOG_ERROR("ConfigImageDevice: cannot load bundle " + path);
+        return loaded;
+    }
+    cache[path] = loaded.Value();
+    return loaded;
+}
+
+/// image://pci:DDDD
+bool ParseUri(const config::DeviceUri& uri, uint16_t& domain) {
+    if (!uri.IsValid() || uri.Scheme() != "image" || uri.FieldCount() != 2 ||
+        uri.Field(0) != "pci") {
+        return false;
+    }
+    uint64_t value = 0;
+    if (!uri.Number(1, 16, 0xFFFF, value)) {
+        return false;
+    }
+    domain = static_cast<uint16_t>(value);
+    return true;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Constructor / Destructor
+// ---------------------------------------------------------------------------
+
+ConfigImageDevice::ConfigImageDevice(const config::DeviceEntry& entry,
+                                     const config::DeviceUri& uri)
+    : name_(entry.nickname), uri_(entry.uri) {
+    uri_valid_ = ParseUri(uri, domain_);
+    auto it = entry.args.find("bundle");
+    if (it != entry.args.end()) {
+        bundle_path_ = it->second;
+    }
+}
+
+ConfigImageDevice::ConfigImageDevice(const config::DeviceEntry& entry,
+                                     std::shared_ptr<const ConfigImageBundle> bundle,
+                                     uint16_t domain)
+    : name_(entry.nickname),
+      uri_(entry.uri),
+      domain_(domain),
+      uri_valid_(bundle != nullptr),
+      bundle_(std::move(bundle)) {}
+
+ConfigImageDevice::~ConfigImageDevice() = default;
+
+// ---------------------------------------------------------------------------
+// Device interface
+// ---------------------------------------------------------------------------
+
+core::Result<void> ConfigImageDevice::Init() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != DeviceState::kUninitialized && state_ != DeviceState::kClosed) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (!uri_valid_ || (!bundle_ && bundle_path_.empty())) {
+        PLAS_LOG_ERROR("ConfigImageDevice::Init() failed for device='" + name_ +
+                       "' uri=" + uri_);
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (!bundle_) {
+        auto loaded = LoadBundle(bundle_path_);
+        if (loaded.IsError()) {
+            return core::Result<void>::Err(loaded.Error());
+        }
+        bundle_ = std::move(loaded).Value();
+    }
+    state_ = DeviceState::kInitialized;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> ConfigImageDevice::Open() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != DeviceState::kInitialized && state_ != DeviceState::kClosed) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    state_ = DeviceState::kOpen;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> ConfigImageDevice::Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyClosed);
+    }
+    state_ = DeviceState::kClosed;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> ConfigImageDevice::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ == DeviceState::kUninitialized) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    state_ = DeviceState::kInitialized;
+    return core::Result<void>::Ok();
+}
+
+DeviceState ConfigImageDevice::GetState() const {
+    return state_;
+}
+
+std::string ConfigImageDevice::GetName() const {
+    return name_;
+}
+
+std::string ConfigImageDevice::GetUri() const {
+    return uri_;
+}
+
+std::string ConfigImageDevice::GetDriverName() const {
+    return "image";
+}
+
+std::size_t ConfigImageDevice::MemoryUsage() const {
+    // The bundle is shared between devices and not counted here.
+    return sizeof(*this) + core::HeapBytes(name_) + core::HeapBytes(uri_) +
+           core::HeapBytes(bundle_path_);
+}
+
+std::shared_ptr<const ConfigImageBundle> ConfigImageDevice::GetBundle() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bundle_;
+}
+
+Device* ConfigImageDevice::GetDevice() {
+    return this;
+}
+
+// ---------------------------------------------------------------------------
+// Lookup
+// ---------------------------------------------------------------------------
+
+core::Result<std::optional<ConfigImageDevice::Function>> ConfigImageDevice::Lookup(
+    pci::Bdf bdf) const {
+    using R = core::Result<std::optional<Function>>;
+    if (state_ != DeviceState::kOpen) {
+        return R::Err(core::ErrorCode::kNotInitialized);
+    }
+    return R::Ok(bundle_->Find(pci::PciAddress{domain_, bdf}));
+}
+
+core::Result<ConfigImageDevice::Function> ConfigImageDevice::Require(pci::Bdf bdf) const {
+    auto function = Lookup(bdf);
+    if (function.IsError()) {
+        return core::Result<Function>::Err(function.Error());
+    }
+    if (!function.Value()) {
+        return core::Result<Function>::Err(core::ErrorCode::kNotFound);
+    }
+    return core::Result<Function>::Ok(*function.Value());
+}
+
+// ---------------------------------------------------------------------------
+// PciConfig interface
+// ---------------------------------------------------------------------------
+
+template <typename T>
+core::Result<T> ConfigImageDevice::Read(pci::Bdf bdf, pci::ConfigOffset offset) const {
+    if (offset % sizeof(T) != 0 || offset + sizeof(T) > pci::kConfigSpaceSize) {
+        return core::Result<T>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    auto function = Lookup(bdf);
+    if (function.IsError()) {
+        return core::Result<T>::Err(function.Error());
+    }
+    if (!function.Value()) {
+        return core::Result<T>::Ok(static_cast<T>(~T(0)));
+    }
+    const Function& f = *function.Value();
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T) && offset + i < f.size; ++i) {
+        value = static_cast<T>(value | (static_cast<T>(f.config[offset + i]) << (8 * i)));
+    }
+    return core::Result<T>::Ok(value);
+}
+
+core::Result<core::Byte> ConfigImageDevice::ReadConfig8(pci::Bdf bdf,
+                                                        pci::ConfigOffset offset) {
+    return Read<core::Byte>(bdf, offset);
+}
+
+core::Result<core::Word> ConfigImageDevice::ReadConfig16(pci::Bdf bdf,
+                                                         pci::ConfigOffset offset) {
+    return Read<core::Word>(bdf, offset);
+}
+
+core::Result<core::DWord> ConfigImageDevice::ReadConfig32(pci::Bdf bdf,
+                                                          pci::ConfigOffset offset) {
+    return Read<core::DWord>(bdf, offset);
+}
+
+core::Result<void> ConfigImageDevice::WriteConfig8(pci::Bdf, pci::ConfigOffset, core::Byte) {
+    return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+}
+
+core::Result<void> ConfigImageDevice::WriteConfig16(pci::Bdf, pci::ConfigOffset, core::Word) {
+    return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+}
+
+core::Result<void> ConfigImageDevice::WriteConfig32(pci::Bdf, pci::ConfigOffset,
+                                                    core::DWord) {
+    return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+}
+
+core::Result<void> ConfigImageDevice::ReadConfigBlock(pci::Bdf bdf, pci::ConfigOffset offset,
+                                                      core::Byte* buffer,
+                                                      std::size_t length) {
+    if (length == 0) {
+        return core::Result<void>::Ok();
+    }
+    if (!buffer) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (offset >= pci::kConfigSpaceSize || length > pci::kConfigSpaceSize - offset) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+    auto function = Lookup(bdf);
+    if (function.IsError()) {
+        return core::Result<void>::Err(function.Error());
+    }
+    if (!function.Value()) {
+        std::memset(buffer, 0xFF, length);
+        return core::Result<void>::Ok();
+    }
+    const Function& f = *function.Value();
+    const std::size_t copied = offset < f.size ? std::min(length, f.size - offset) : 0;
+    std::copy_n(f.config + offset, copied, buffer);
+    std::memset(buffer + copied, 0, length - copied);
+    return core::Result<void>::Ok();
+}
+
+core::Result<pci::CapabilityIndex> ConfigImageDevice::GetCapabilityIndex(pci::Bdf bdf) {
+    auto function = Lookup(bdf);
+    if (function.IsError()) {
+        return core::Result<pci::CapabilityIndex>::Err(function.Error());
+    }
+    if (!function.Value()) {
+        return core::Result<pci::CapabilityIndex>::Ok(pci::CapabilityIndex{});
+    }
+    const Function& f = *function.Value();
+    return core::Result<pci::CapabilityIndex>::Ok(
+        pci::CapabilityIndex::Parse(f.config, f.size));
+}
+
+template <typename Id>
+core::Result<std::optional<pci::ConfigOffset>> ConfigImageDevice::Find(pci::Bdf bdf,
+                                                                       Id id) const {
+    using R = core::Result<std::optional<pci::ConfigOffset>>;
+    auto function = Lookup(bdf);
+    if (function.IsError()) {
+        return R::Err(function.Error());
+    }
+    if (!function.Value()) {
+        return R::Ok(std::nullopt);
+    }
+    const Function& f = *function.Value();
+    return R::Ok(pci::CapabilityIndex::Parse(f.config, f.size).Find(id));
+}
+
+core::Result<std::optional<pci::ConfigOffset>> ConfigImageDevice::FindCapability(
+    pci::Bdf bdf, pci::CapabilityId id) {
+    return Find(bdf, id);
+}
+
+core::Result<std::optional<pci::ConfigOffset>> ConfigImageDevice::FindExtCapability(
+    pci::Bdf bdf, pci::ExtCapabilityId id) {
+    return Find(bdf, id);
+}
+
+// ---------------------------------------------------------------------------
+// PciDoe interface
+// ---------------------------------------------------------------------------
+
+core::Result<std::vector<pci::DoeProtocolId>> ConfigImageDevice::Protocols(
+    const Function& function, pci::ConfigOffset doe_offset) const {
+    using ResultType = core::Result<std::vector<pci::DoeProtocolId>>;
+    std::vector<pci::DoeProtocolId> protocols{kDiscovery};
+    bool used = false;
+    for (std::size_t i = 0; i < function.doe_count; ++i) {
+        auto doe = bundle_->DoeAt(function.doe_begin + i);
+        if (doe.doe_offset != doe_offset) {
+            continue;
+        }
+        used = true;
+        if (std::find(protocols.begin(), protocols.end(), doe.protocol) == protocols.end()) {
+            protocols.push_back(doe.protocol);
+        }
+    }
+    if (!used) {
+        auto does = pci::CapabilityIndex::Parse(function.config, function.size)
+                        .FindAll(pci::ExtCapabilityId::kDoe);
+        if (std::find(does.begin(), does.end(), doe_offset) == does.end()) {
+            return ResultType::Err(core::ErrorCode::kNotFound);
+        }
+    }
+    return ResultType::Ok(std::move(protocols));
+}
+
+core::Result<std::vector<pci::DoeProtocolId>> ConfigImageDevice::DoeDiscover(
+    pci::Bdf bdf, pci::ConfigOffset doe_offset) {
+    auto function = Require(bdf);
+    if (function.IsError()) {
+        return core::Result<std::vector<pci::DoeProtocolId>>::Err(function.Error());
+    }
+    return Protocols(function.Value(), doe_offset);
+}
+
+core::Result<ConfigImageBundle::DoeResponse> ConfigImageDevice::Respond(
+    pci::Bdf bdf, pci::ConfigOffset doe_offset, pci::DoeProtocolId protocol,
+    const core::DWord* request, std::size_t request_len, core::Byte (&scratch)[4]) const {
+    using ResultType = core::Result<ConfigImageBundle::DoeResponse>;
+    auto function = Require(bdf);
+    if (function.IsError()) {
+        return ResultType::Err(function.Error());
+    }
+    const Function& f = function.Value();
+    for (std::size_t i = 0; i < f.doe_count; ++i) {
+        auto doe = bundle_->DoeAt(f.doe_begin + i);
+        if (doe.doe_offset != doe_offset || doe.protocol != protocol ||
+            doe.request_dwords != request_len) {
+            continue;
+        }
+        std::size_t j = 0;
+        while (j < request_len && doe.RequestDWord(j) == request[j]) {
+            ++j;
+        }
+        if (j == request_len) {
+            return ResultType::Ok(doe);
+        }
+    }
+
+    auto protocols = Protocols(f, doe_offset);
+    if (protocols.IsError()) {
+        return ResultType::Err(protocols.Error());
+    }
+    const auto& list = protocols.Value();
+    if (std::find(list.begin(), list.end(), protocol) == list.end()) {
+        return ResultType::Err(core::ErrorCode::kNotSupported);
+    }
+    if (protocol != kDiscovery) {
+        return ResultType::Err(core::ErrorCode::kNotFound);
+    }
+    // Discovery: DW0[7:0] is the index; answer vendor | type | next.
+    if (request_len == 0) {
+        return ResultType::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::size_t index = request[0] & 0xFF;
+    if (index >= list.size()) {
+        return ResultType::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::size_t next = index + 1 < list.size() ? index + 1 : 0;
+    const core::DWord answer = static_cast<core::DWord>(list[index].vendor_id) |
+                               (static_cast<core::DWord>(list[index].data_object_type) << 16) |
+                               (static_cast<core::DWord>(next) << 24);
+    for (int i = 0; i < 4; ++i) {
+        scratch[i] = static_cast<core::Byte>(answer >> (8 * i));
+    }
+    ConfigImageBundle::DoeResponse response;
+    response.doe_offset = doe_offset;
+    response.protocol = protocol;
+    response.response = scratch;
+    response.response_dwords = 1;
+    return ResultType::Ok(response);
+}
+
+core::Result<pci::DoePayload> ConfigImageDevice::DoeExchange(
+    pci::Bdf bdf, pci::ConfigOffset doe_offset, pci::DoeProtocolId protocol,
+    const pci::DoePayload& request) {
+    core::Byte scratch[4];
+    auto answer = Respond(bdf, doe_offset, protocol, request.data(), request.size(), scratch);
+    if (answer.IsError()) {
+        return core::Result<pci::DoePayload>::Err(answer.Error());
+    }
+    const auto& doe = answer.Value();
+    pci::DoePayload response(doe.response_dwords);
+    for (std::size_t i = 0; i < response.size(); ++i) {
+        response[i] = doe.ResponseDWord(i);
+    }
+    return core::Result<pci::DoePayload>::Ok(std::move(response));
+}
+
+core::Result<std::size_t> ConfigImageDevice::DoeExchangeInto(
+    pci::Bdf bdf, pci::ConfigOffset doe_offset, pci::DoeProtocolId protocol,
+    const core::DWord* request, std::size_t request_len, core::DWord* response,
+    std::size_t response_capacity) {
+    if ((request_len > 0 && !request) || (response_capacity > 0 && !response)) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    core::Byte scratch[4];
+    auto answer = Respond(bdf, doe_offset, protocol, request, request_len, scratch);
+    if (answer.IsError()) {
+        return core::Result<std::size_t>::Err(answer.Error());
+    }
+    const auto& doe = answer.Value();
+    if (doe.response_dwords > response_capacity) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kOverflow);
+    }
+    for (std::size_t i = 0; i < doe.response_dwords; ++i) {
+        response[i] = doe.ResponseDWord(i);
+    }
+    return core::Result<std::size_t>::Ok(doe.response_dwords);
+}
+
+// ---------------------------------------------------------------------------
+// Cxl interface — decoded from the image on each call
+// ---------------------------------------------------------------------------
+
+core::Result<pci::CxlDvsecIndex> ConfigImageDevice::CxlIndex(pci::Bdf bdf) const {
+    auto function = Require(bdf);
+    if (function.IsError()) {
+        return core::Result<pci::CxlDvsecIndex>::Err(function.Error());
+    }
+    const Function& f = function.Value();
+    return core::Result<pci::CxlDvsecIndex>::Ok(pci::CxlDvsecIndex::Parse(
+        f.config, f.size, pci::CapabilityIndex::Parse(f.config, f.size)));
+}
+
+core::Result<std::vector<pci::DvsecHeader>> ConfigImageDevice::EnumerateCxlDvsecs(
+    pci::Bdf bdf) {
+    auto index = CxlIndex(bdf);
+    if (index.IsError()) {
+        return core::Result<std::vector<pci::DvsecHeader>>::Err(index.Error());
+    }
+    return core::Result<std::vector<pci::DvsecHeader>>::Ok(
+        std::move(index).Value().dvsecs);
+}
+
+core::Result<std::optional<pci::DvsecHeader>> ConfigImageDevice::FindCxlDvsec(
+    pci::Bdf bdf, pci::CxlDvsecId dvsec_id) {
+    auto index = CxlIndex(bdf);
+    if (index.IsError()) {
+        return core::Result<std::optional<pci::DvsecHeader>>::Err(index.Error());
+    }
+    return core::Result<std::optional<pci::DvsecHeader>>::Ok(index.Value().Find(dvsec_id));
+}
+
+core::Result<pci::CxlDeviceType> ConfigImageDevice::GetCxlDeviceType(pci::Bdf bdf) {
+    auto index = CxlIndex(bdf);
+    if (index.IsError()) {
+        return core::Result<pci::CxlDeviceType>::Err(index.Error());
+    }
+    return core::Result<pci::CxlDeviceType>::Ok(index.Value().device_type);
+}
+
+core::Result<std::vector<pci::RegisterBlockEntry>> ConfigImageDevice::GetRegisterBlocks(
+    pci::Bdf bdf) {
+    auto index = CxlIndex(bdf);
+    if (index.IsError()) {
+        return core::Result<std::vector<pci::RegisterBlockEntry>>::Err(index.Error());
+    }
+    return core::Result<std::vector<pci::RegisterBlockEntry>>::Ok(
+        std::move(index).Value().register_blocks);
+}
+
+core::Result<core::DWord> ConfigImageDevice::ReadDvsecRegister(
+    pci::Bdf bdf, pci::ConfigOffset dvsec_offset, uint16_t reg_offset) {
+    std::size_t offset = std::size_t{dvsec_offset} + reg_offset;
+    if (offset + sizeof(core::DWord) > pci::kConfigSpaceSize) {
+        return core::Result<core::DWord>::Err(core::ErrorCode::kOutOfRange);
+    }
+    return Read<core::DWord>(bdf, static_cast<pci::ConfigOffset>(offset));
+}
+
+core::Result<void> ConfigImageDevice::WriteDvsecRegister(pci::Bdf, pci::ConfigOffset,
+                                                         uint16_t, core::DWord) {
+    return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+}
+
+}  // namespace plas::hal::driver
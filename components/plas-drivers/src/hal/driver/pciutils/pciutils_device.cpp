@@ -1,9 +1,9 @@
 #include "plas/hal/driver/pciutils/pciutils_device.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdio>
 #include <cstring>
-#include <fstream>
 #include <sstream>
 #include <thread>
 
@@ -15,15 +15,40 @@ extern "C" {
 #include <pci/pci.h>
 }
 
+#include "plas/core/deadline.h"
 #include "plas/core/error.h"
+#include "plas/core/memory_usage.h"
 #include "plas/hal/interface/device_factory.h"
+#include "plas/hal/interface/pci/mmio_copy.h"
+#include "plas/hal/interface/pci/pci_topology.h"
 #include "plas/log/logger.h"
+#include "plas/log/trace.h"
 
 namespace plas::hal::driver {
 
 // ---------------------------------------------------------------------------
 // DOE register offsets (relative to DOE extended capability base)
 // ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+// PciUtilsAccess — one libpci context per access method, shared by every
+// PciUtilsDevice that selects it (all domains)
+// ---------------------------------------------------------------------------
+
+struct PciUtilsAccess {
+    pci_access* pacc = nullptr;
+    int method = 0;
+    // Serializes register access and the bus scan, foreground first.
+    core::IoQueue io_queue{"pciutils.config"};
+    bool scanned = false;  // pci_scan_bus ran (it appends, so only once)
+    uint64_t scan_generation = 0;  // PciTopology generation at scan time
+
+    ~PciUtilsAccess() {
+        if (pacc) {
+            pci_cleanup(pacc);
+        }
+    }
+};
+
 namespace doe_reg {
 constexpr pci::ConfigOffset kControl = 0x08;
 constexpr pci::ConfigOffset kStatus = 0x0C;
@@ -42,6 +67,133 @@ constexpr uint32_t kError = 1u << 2;
 constexpr uint32_t kReady = 1u << 31;
 }  // namespace doe_status
 
+namespace {
+
+/// DOE wait strategy: re-read status without sleeping for the spin window
+/// (small exchanges complete within a few config reads), then sleep with
+/// exponential backoff from 1 us up to the configured poll interval.
+class DoeBackoff {
+public:
+    DoeBackoff(uint32_t spin_us, uint32_t max_interval_us)
+        : start_(std::chrono::steady_clock::now()),
+          spin_(spin_us),
+          max_interval_(max_interval_us),
+          interval_(std::min<uint32_t>(1, max_interval_us)) {}
+
+    void Wait() {
+        if (std::chrono::steady_clock::now() - start_ < spin_) {
+            return;
+        }
+        std::this_thread::sleep_for(interval_);
+        interval_ = std::min(interval_ * 2, max_interval_);
+    }
+
+    uint64_t ElapsedUs() const {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start_)
+                .count());
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::microseconds spin_;
+    std::chrono::microseconds max_interval_;
+    std::chrono::microseconds interval_;
+};
+
+/// Trace record `extra` field for DOE: vendor id << 8 | object type.
+uint32_t DoeTraceProtocol(pci::DoeProtocolId protocol) {
+    return static_cast<uint32_t>(protocol.vendor_id) << 8 |
+           protocol.data_object_type;
+}
+
+/// Fields ScanBus() asks libpci for. PCI_FILL_IO_FLAGS (resource flags per
+/// BAR) needs pciutils 3.6; older versions leave BAR sizes to sysfs.
+#ifdef PCI_FILL_IO_FLAGS
+constexpr int kScanFillIoFlags = PCI_FILL_IO_FLAGS;
+#else
+constexpr int kScanFillIoFlags = 0;
+#endif
+constexpr int kScanFill = PCI_FILL_IDENT | PCI_FILL_CLASS | PCI_FILL_BASES |
+                          PCI_FILL_SIZES | kScanFillIoFlags | PCI_FILL_CAPS |
+                          PCI_FILL_EXT_CAPS;
+
+/// BAR ranges of a scanned device, in the layout of sysfs `resource`.
+/// Empty unless libpci filled bases, sizes and resource flags.
+std::optional<pci::BarResources> ScannedBars(const pci_dev* dev) {
+#ifndef PCI_FILL_IO_FLAGS
+    (void)dev;
+    return std::nullopt;
+#else
+    constexpr unsigned kNeeded =
+        PCI_FILL_BASES | PCI_FILL_SIZES | PCI_FILL_IO_FLAGS;
+    if ((dev->known_fields & kNeeded) != kNeeded) {
+        return std::nullopt;
+    }
+    pci::BarResources bars{};
+    for (std::size_t i = 0; i < pci::kBarCount; ++i) {
+        auto flags = static_cast<uint64_t>(dev->flags[i]);
+        auto size = static_cast<uint64_t>(dev->size[i]);
+        if (size == 0) {
+            continue;
+        }
+        // base_addr keeps the BAR type bits in its low bits.
+        uint64_t start = (flags & pci::BarResource::kFlagIo)
+                             ? dev->base_addr[i] & PCI_ADDR_IO_MASK
+                             : dev->base_addr[i] & PCI_ADDR_MEM_MASK;
+        bars[i] = pci::BarResource{start, start + size - 1, flags};
+    }
+    return bars;
+#endif
+}
+
+using AccessRegistry =
+    std::unordered_map<int, std::weak_ptr<PciUtilsAccess>>;
+
+std::mutex& GetAccessRegistryMutex() {
+    static std::mutex m;
+    return m;
+}
+
+/// The shared context for `method`, created and initialized on first use.
+/// nullptr if pci_alloc fails.
+std::shared_ptr<PciUtilsAccess> AcquireAccess(int method) {
+    static AccessRegistry registry;
+    std::lock_guard<std::mutex> lock(GetAccessRegistryMutex());
+    auto it = registry.find(method);
+    if (it != registry.end()) {
+        if (auto existing = it->second.lock()) {
+            return existing;
+        }
+        registry.erase(it);  // weak_ptr expired
+    }
+    auto access = std::make_shared<PciUtilsAccess>();
+    access->pacc = pci_alloc();
+    if (!access->pacc) {
+        return nullptr;
+    }
+    access->method = method;
+    access->pacc->method = static_cast<unsigned int>(method);
+    pci_init(access->pacc);
+    registry[method] = access;
+    return access;
+}
+
+/// Handle cache key: domain in the upper half.
+uint32_t DevKey(const pci::PciAddress& addr) {
+    return (static_cast<uint32_t>(addr.domain) << 16) | addr.bdf.Pack();
+}
+
+pci::PciAddress ScannedAddress(const pci_dev* dev) {
+    return pci::PciAddress{static_cast<uint16_t>(dev->domain),
+                           pci::Bdf{static_cast<uint8_t>(dev->bus),
+                                    static_cast<uint8_t>(dev->dev),
+                                    static_cast<uint8_t>(dev->func)}};
+}
+
+}  // namespace
+
 // ---------------------------------------------------------------------------
 // PciDevDeleter
 // ---------------------------------------------------------------------------
@@ -56,23 +208,23 @@ void PciUtilsDevice::PciDevDeleter::operator()(pci_dev* d) const {
 // URI parsing
 // ---------------------------------------------------------------------------
 
-bool PciUtilsDevice::ParseUri(const std::string& uri, uint16_t& domain,
+bool PciUtilsDevice::ParseUri(const config::DeviceUri& uri, uint16_t& domain,
                                uint8_t& bus, uint8_t& device,
                                uint8_t& function) {
-    const std::string prefix = "pciutils://";
-    if (uri.size() <= prefix.size() ||
-        uri.compare(0, prefix.size(), prefix) != 0) {
+    // pciutils://DDDD:BB:dd.f, all hex
+    if (!uri.IsValid() || uri.Scheme() != "pciutils" || uri.FieldCount() != 3) {
         return false;
     }
-
-    const std::string bdf_str = uri.substr(prefix.size());
-
-    unsigned d, b, dev, f;
-    if (std::sscanf(bdf_str.c_str(), "%x:%x:%x.%x", &d, &b, &dev, &f) != 4) {
+    auto devfn = uri.Field(2);
+    auto dot = devfn.find('.');
+    if (dot == std::string_view::npos) {
         return false;
     }
 
-    if (d > 0xFFFF || b > 0xFF || dev > 0x1F || f > 0x07) {
+    uint64_t d = 0, b = 0, dev = 0, f = 0;
+    if (!uri.Number(0, 16, 0xFFFF, d) || !uri.Number(1, 16, 0xFF, b) ||
+        !config::DeviceUri::ParseNumber(devfn.substr(0, dot), 16, 0x1F, dev) ||
+        !config::DeviceUri::ParseNumber(devfn.substr(dot + 1), 16, 0x07, f)) {
         return false;
     }
 
@@ -88,6 +240,10 @@ bool PciUtilsDevice::ParseUri(const std::string& uri, uint16_t& domain,
 // ---------------------------------------------------------------------------
 
 PciUtilsDevice::PciUtilsDevice(const config::DeviceEntry& entry)
+    : PciUtilsDevice(entry, config::DeviceUri::Parse(entry.uri)) {}
+
+PciUtilsDevice::PciUtilsDevice(const config::DeviceEntry& entry,
+                               const config::DeviceUri& uri)
     : name_(entry.nickname),
       uri_(entry.uri),
       state_(DeviceState::kUninitialized),
@@ -95,9 +251,22 @@ PciUtilsDevice::PciUtilsDevice(const config::DeviceEntry& entry)
       bus_(0),
       device_num_(0),
       function_(0),
-      pacc_(nullptr),
+      access_method_("auto"),
+      dev_cache_generation_(0),
+      scan_on_open_(false),
+      scan_generation_(0),
+      cap_cache_generation_(0),
+      cxl_mailboxes_generation_(0),
+      mailbox_timeout_ms_(2000),
       doe_timeout_ms_(1000),
-      doe_poll_interval_us_(100) {
+      doe_poll_interval_us_(100),
+      doe_spin_us_(20),
+      trace_id_(0),
+      metrics_(nullptr),
+      bar_resources_generation_(0),
+      map_bars_on_open_(false) {
+    uri_valid_ = ParseUri(uri, domain_, bus_, device_num_, function_);
+
     // Parse optional DOE args.
     auto it = entry.args.find("doe_timeout_ms");
     if (it != entry.args.end()) {
@@ -116,14 +285,59 @@ PciUtilsDevice::PciUtilsDevice(const config::DeviceEntry& entry)
             // keep default
         }
     }
+    it = entry.args.find("doe_spin_us");
+    if (it != entry.args.end()) {
+        try {
+            doe_spin_us_ = static_cast<uint32_t>(std::stoul(it->second));
+        } catch (...) {
+            // keep default
+        }
+    }
+    it = entry.args.find("mailbox_timeout_ms");
+    if (it != entry.args.end()) {
+        try {
+            mailbox_timeout_ms_ = static_cast<uint32_t>(std::stoul(it->second));
+        } catch (...) {
+            // keep default
+        }
+    }
+    it = entry.args.find("wc_bars");
+    if (it != entry.args.end()) {
+        std::istringstream list(it->second);
+        std::string item;
+        while (std::getline(list, item, ',')) {
+            try {
+                auto index = std::stoul(item);
+                if (index < pci::kBarCount) {
+                    bar_mappings_[static_cast<uint8_t>(index)] =
+                        pci::BarMapping::kWriteCombining;
+                }
+            } catch (...) {
+                // skip malformed entry
+            }
+        }
+    }
+    it = entry.args.find("map_bars_on_open");
+    if (it != entry.args.end()) {
+        map_bars_on_open_ = it->second == "true" || it->second == "1";
+    }
+    it = entry.args.find("access_method");
+    if (it != entry.args.end() && !it->second.empty()) {
+        access_method_ = it->second;
+    }
+    it = entry.args.find("scan_on_open");
+    if (it != entry.args.end()) {
+        scan_on_open_ = it->second == "true" || it->second == "1";
+    }
 }
 
 PciUtilsDevice::~PciUtilsDevice() {
+    ClearCxlMailboxCache();
     UnmapAllBars();
-    if (pacc_) {
-        pci_cleanup(pacc_);
-        pacc_ = nullptr;
-    }
+    ClearCapabilityIndexCache();
+    ClearPciDevCache();
+    scanned_devs_.clear();
+    access_.reset();
 }
 
 // ---------------------------------------------------------------------------
@@ -136,7 +350,7 @@ core::Result<void> PciUtilsDevice::Init() {
         return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
     }
 
-    if (!ParseUri(uri_, domain_, bus_, device_num_, function_)) {
+    if (!uri_valid_) {
         PLAS_LOG_ERROR("PciUtilsDevice::Init() invalid URI: " + uri_);
         state_ = DeviceState::kError;
         return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
@@ -152,17 +366,42 @@ core::Result<void> PciUtilsDevice::Open() {
         return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
     }
 
-    pacc_ = pci_alloc();
-    if (!pacc_) {
+    int method = PCI_ACCESS_AUTO;
+    if (access_method_ != "auto") {
+        std::string method_name = access_method_;  // pci_lookup_method takes char*
+        method = pci_lookup_method(method_name.data());
+        if (method < 0) {
+            PLAS_LOG_ERROR("PciUtilsDevice::Open() " + name_ +
+                           ": unknown access_method '" + access_method_ + "'");
+            state_ = DeviceState::kError;
+            return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+        }
+    }
+
+    access_ = AcquireAccess(method);
+    if (!access_) {
         PLAS_LOG_ERROR("PciUtilsDevice::Open() pci_alloc failed");
         state_ = DeviceState::kError;
         return core::Result<void>::Err(core::ErrorCode::kOutOfMemory);
     }
 
-    pci_init(pacc_);
+    if (scan_on_open_) {
+        ScanBus();
+    }
 
     PLAS_LOG_INFO("PciUtilsDevice::Open() " + name_);
+    ResetDoeStats();
+    trace_id_ = log::Tracer::GetInstance().RegisterDevice(name_);
+    metrics_ = MetricsRegistry::GetInstance().GetDeviceMetrics(name_);
     state_ = DeviceState::kOpen;
+    if (map_bars_on_open_) {
+        auto mapped = MapAllBars();
+        if (mapped.IsError()) {
+            PLAS_LOG_WARN("PciUtilsDevice::Open() " + name_ +
+                          ": BAR pre-mapping failed: " +
+                          mapped.Error().message());
+        }
+    }
     return core::Result<void>::Ok();
 }
 
@@ -171,12 +410,12 @@ core::Result<void> PciUtilsDevice::Close() {
         return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
     }
 
+    ClearCxlMailboxCache();
     UnmapAllBars();
-
-    if (pacc_) {
-        pci_cleanup(pacc_);
-        pacc_ = nullptr;
-    }
+    ClearCapabilityIndexCache();
+    ClearPciDevCache();
+    scanned_devs_.clear();
+    access_.reset();
 
     PLAS_LOG_INFO("PciUtilsDevice::Close() " + name_);
     state_ = DeviceState::kClosed;
@@ -210,21 +449,232 @@ std::string PciUtilsDevice::GetDriverName() const {
     return "pciutils";
 }
 
+std::size_t PciUtilsDevice::MemoryUsage() const {
+    std::size_t bytes = sizeof(*this) + core::HeapBytes(name_) + core::HeapBytes(uri_) +
+                        core::HeapBytes(access_method_) + core::HashNodeBytes(scanned_devs_);
+    {
+        std::lock_guard<std::mutex> lock(dev_cache_mutex_);
+        bytes += core::HashNodeBytes(dev_cache_);
+    }
+    {
+        std::lock_guard<std::mutex> lock(cap_cache_mutex_);
+        bytes += core::HashNodeBytes(cap_cache_) + core::HashNodeBytes(cxl_cache_);
+    }
+    {
+        std::lock_guard<std::mutex> lock(cxl_mailbox_mutex_);
+        bytes += core::HashNodeBytes(cxl_mailboxes_) +
+                 cxl_mailboxes_.size() * sizeof(pci::CxlMmioMailbox);
+    }
+    {
+        std::lock_guard<core::InstrumentedMutex> lock(doe_mutex_);
+        bytes += core::HashNodeBytes(doe_mailbox_queues_) +
+                 doe_mailbox_queues_.size() * sizeof(core::IoQueue);
+    }
+    return bytes;
+}
+
 plas::hal::Device* PciUtilsDevice::GetDevice() {
     return this;
 }
 
 // ---------------------------------------------------------------------------
-// PciDevPtr helper
+// pci_dev handle cache
 // ---------------------------------------------------------------------------
 
 PciUtilsDevice::PciDevPtr PciUtilsDevice::GetPciDev(pci::Bdf bdf) {
-    if (!pacc_) {
+    return GetPciDev(pci::PciAddress{domain_, bdf});
+}
+
+PciUtilsDevice::PciDevPtr PciUtilsDevice::GetPciDev(const pci::PciAddress& addr) {
+    if (auto* scanned = ScannedPciDev(addr)) {
+        return PciDevPtr(PciDevPtr(), scanned);  // non-owning
+    }
+
+    std::lock_guard<std::mutex> lock(dev_cache_mutex_);
+    if (!access_) {
+        return nullptr;
+    }
+
+    // A remove/rescan may have re-enumerated the bus: stop handing out the
+    // old handles. Accesses still using one hold their own reference.
+    auto generation = pci::PciTopology::GetTopologyGeneration();
+    if (generation != dev_cache_generation_) {
+        dev_cache_.clear();
+        dev_cache_generation_ = generation;
+    }
+
+    auto key = DevKey(addr);
+    auto it = dev_cache_.find(key);
+    if (it != dev_cache_.end()) {
+        return it->second;
+    }
+
+    pci_dev* dev = pci_get_dev(access_->pacc, addr.domain, addr.bdf.bus,
+                               addr.bdf.device, addr.bdf.function);
+    if (!dev) {
         return nullptr;
     }
-    pci_dev* dev =
-        pci_get_dev(pacc_, domain_, bdf.bus, bdf.device, bdf.function);
-    return PciDevPtr(dev);
+    PciDevPtr handle(dev, PciDevDeleter{access_});
+    dev_cache_.emplace(key, handle);
+    return handle;
+}
+
+void PciUtilsDevice::ClearPciDevCache() {
+    std::lock_guard<std::mutex> lock(dev_cache_mutex_);
+    dev_cache_.clear();
+}
+
+// ---------------------------------------------------------------------------
+// Bus scan
+// ---------------------------------------------------------------------------
+
+void PciUtilsDevice::ScanBus() {
+    scanned_devs_.clear();
+    std::lock_guard<core::IoQueue> io_lock(access_->io_queue);
+    auto generation = pci::PciTopology::GetTopologyGeneration();
+    if (!access_->scanned) {
+        pci_scan_bus(access_->pacc);
+        for (pci_dev* dev = access_->pacc->devices; dev; dev = dev->next) {
+            pci_fill_info(dev, kScanFill);
+        }
+        access_->scanned = true;
+        access_->scan_generation = generation;
+    } else if (access_->scan_generation != generation) {
+        // libpci cannot rescan a context; keep the lazy paths.
+        PLAS_LOG_WARN("PciUtilsDevice::Open() " + name_ +
+                      ": shared libpci scan predates a topology change, "
+                      "not using it");
+        return;
+    }
+    scan_generation_ = access_->scan_generation;
+    for (pci_dev* dev = access_->pacc->devices; dev; dev = dev->next) {
+        scanned_devs_.emplace(DevKey(ScannedAddress(dev)), dev);
+    }
+    PLAS_LOG_INFO("PciUtilsDevice::Open() " + name_ + ": scanned " +
+                  std::to_string(scanned_devs_.size()) + " functions");
+}
+
+pci_dev* PciUtilsDevice::ScannedPciDev(const pci::PciAddress& addr) const {
+    if (scanned_devs_.empty() ||
+        pci::PciTopology::GetTopologyGeneration() != scan_generation_) {
+        return nullptr;
+    }
+    auto it = scanned_devs_.find(DevKey(addr));
+    return it != scanned_devs_.end() ? it->second : nullptr;
+}
+
+bool PciUtilsDevice::IsScanned() const {
+    return !scanned_devs_.empty() &&
+           pci::PciTopology::GetTopologyGeneration() == scan_generation_;
+}
+
+std::vector<PciUtilsDevice::ScannedFunction>
+PciUtilsDevice::GetScannedFunctions() const {
+    std::vector<ScannedFunction> functions;
+    if (!IsScanned()) {
+        return functions;
+    }
+    functions.reserve(scanned_devs_.size());
+    for (pci_dev* dev = access_->pacc->devices; dev; dev = dev->next) {
+        ScannedFunction function;
+        function.address = ScannedAddress(dev);
+        function.vendor_id = dev->vendor_id;
+        function.device_id = dev->device_id;
+        function.device_class = dev->device_class;
+        if (auto bars = ScannedBars(dev)) {
+            function.bars = *bars;
+        }
+        functions.push_back(function);
+    }
+    return functions;
+}
+
+// ---------------------------------------------------------------------------
+// Capability index cache
+// ---------------------------------------------------------------------------
+
+core::Result<const pci::CapabilityIndex*>
+PciUtilsDevice::EnsureCapabilityIndex(pci::Bdf bdf) {
+    auto generation = pci::PciTopology::GetTopologyGeneration();
+    if (generation != cap_cache_generation_) {
+        cap_cache_.clear();
+        cxl_cache_.clear();
+        cap_cache_generation_ = generation;
+    }
+
+    auto key = bdf.Pack();
+    auto it = cap_cache_.find(key);
+    if (it != cap_cache_.end()) {
+        return core::Result<const pci::CapabilityIndex*>::Ok(&it->second);
+    }
+
+    // The scan already walked both chains; no config reads needed. libpci
+    // prepends each capability, so restore chain order afterwards.
+    const pci_dev* scanned = ScannedPciDev(pci::PciAddress{domain_, bdf});
+    constexpr unsigned kCaps = PCI_FILL_CAPS | PCI_FILL_EXT_CAPS;
+    if (scanned && (scanned->known_fields & kCaps) == kCaps) {
+        pci::CapabilityIndex index;
+        for (const pci_cap* cap = scanned->first_cap; cap; cap = cap->next) {
+            auto offset = static_cast<pci::ConfigOffset>(cap->addr);
+            if (cap->type == PCI_CAP_EXTENDED) {
+                index.ext_capabilities[cap->id].push_back(offset);
+            } else {
+                index.capabilities[static_cast<uint8_t>(cap->id)].push_back(
+                    offset);
+            }
+        }
+        for (auto& [id, offsets] : index.capabilities) {
+            std::reverse(offsets.begin(), offsets.end());
+        }
+        for (auto& [id, offsets] : index.ext_capabilities) {
+            std::reverse(offsets.begin(), offsets.end());
+        }
+        auto [inserted, _] = cap_cache_.emplace(key, std::move(index));
+        return core::Result<const pci::CapabilityIndex*>::Ok(&inserted->second);
+    }
+
+    auto snapshot = SnapshotConfig(bdf);
+    if (snapshot.IsError()) {
+        return core::Result<const pci::CapabilityIndex*>::Err(
+            snapshot.Error());
+    }
+    const auto& data = snapshot.Value();
+    auto [inserted, _] = cap_cache_.emplace(
+        key, pci::CapabilityIndex::Parse(data.data(), data.size()));
+    cxl_cache_[key] =
+        pci::CxlDvsecIndex::Parse(data.data(), data.size(), inserted->second);
+    return core::Result<const pci::CapabilityIndex*>::Ok(&inserted->second);
+}
+
+core::Result<const pci::CxlDvsecIndex*>
+PciUtilsDevice::EnsureCxlDvsecIndex(pci::Bdf bdf) {
+    auto index_result = EnsureCapabilityIndex(bdf);
+    if (index_result.IsError()) {
+        return core::Result<const pci::CxlDvsecIndex*>::Err(
+            index_result.Error());
+    }
+    auto key = bdf.Pack();
+    auto it = cxl_cache_.find(key);
+    if (it != cxl_cache_.end()) {
+        return core::Result<const pci::CxlDvsecIndex*>::Ok(&it->second);
+    }
+
+    // Index came from the scan: the DVSEC bodies still need a snapshot.
+    auto snapshot = SnapshotConfig(bdf);
+    if (snapshot.IsError()) {
+        return core::Result<const pci::CxlDvsecIndex*>::Err(snapshot.Error());
+    }
+    const auto& data = snapshot.Value();
+    auto [inserted, _] = cxl_cache_.emplace(
+        key, pci::CxlDvsecIndex::Parse(data.data(), data.size(),
+                                       *index_result.Value()));
+    return core::Result<const pci::CxlDvsecIndex*>::Ok(&inserted->second);
+}
+
+void PciUtilsDevice::ClearCapabilityIndexCache() {
+    std::lock_guard<std::mutex> lock(cap_cache_mutex_);
+    cap_cache_.clear();
+    cxl_cache_.clear();
 }
 
 // ---------------------------------------------------------------------------
@@ -233,50 +683,145 @@ PciUtilsDevice::PciDevPtr PciUtilsDevice::GetPciDev(pci::Bdf bdf) {
 
 core::Result<core::Byte> PciUtilsDevice::ReadConfig8(
     pci::Bdf bdf, pci::ConfigOffset offset) {
+    return ReadConfig8(pci::PciAddress{domain_, bdf}, offset);
+}
+
+core::Result<core::Byte> PciUtilsDevice::ReadConfig8(
+    const pci::PciAddress& addr, pci::ConfigOffset offset) {
     if (state_ != DeviceState::kOpen) {
         return core::Result<core::Byte>::Err(core::ErrorCode::kNotInitialized);
     }
-    auto dev = GetPciDev(bdf);
+    auto handle = GetPciDev(addr);
+    auto* dev = handle.get();
     if (!dev) {
-        PLAS_LOG_ERROR("[" + name_ + "][PciConfig] ReadConfig8 offset=" +
-                       std::to_string(offset) + " failed: GetPciDev returned null");
+        PLAS_LOG_DEVICE_ERROR(name_, "PciConfig", "ReadConfig8 offset=" +
+                              std::to_string(offset) + " failed: GetPciDev returned null");
         return core::Result<core::Byte>::Err(core::ErrorCode::kIOError);
     }
-    auto val = pci_read_byte(dev.get(), offset);
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciConfig,
+                        log::TraceOp::kRead, offset, 1, addr.bdf.Pack());
+    MetricsTimer timer(metrics_, MetricOp::kPciConfigRead, 1);
+    std::lock_guard<core::IoQueue> io_lock(access_->io_queue);
+    auto val = pci_read_byte(dev, offset);
     return core::Result<core::Byte>::Ok(val);
 }
 
 core::Result<core::Word> PciUtilsDevice::ReadConfig16(
     pci::Bdf bdf, pci::ConfigOffset offset) {
+    return ReadConfig16(pci::PciAddress{domain_, bdf}, offset);
+}
+
+core::Result<core::Word> PciUtilsDevice::ReadConfig16(
+    const pci::PciAddress& addr, pci::ConfigOffset offset) {
     if (state_ != DeviceState::kOpen) {
         return core::Result<core::Word>::Err(core::ErrorCode::kNotInitialized);
     }
-    auto dev = GetPciDev(bdf);
+    auto handle = GetPciDev(addr);
+    auto* dev = handle.get();
     if (!dev) {
-        PLAS_LOG_ERROR("[" + name_ + "][PciConfig] ReadConfig16 offset=" +
-                       std::to_string(offset) + " failed: GetPciDev returned null");
+        PLAS_LOG_DEVICE_ERROR(name_, "PciConfig", "ReadConfig16 offset=" +
+                              std::to_string(offset) + " failed: GetPciDev returned null");
         return core::Result<core::Word>::Err(core::ErrorCode::kIOError);
     }
-    auto val = pci_read_word(dev.get(), offset);
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciConfig,
+                        log::TraceOp::kRead, offset, 2, addr.bdf.Pack());
+    MetricsTimer timer(metrics_, MetricOp::kPciConfigRead, 2);
+    std::lock_guard<core::IoQueue> io_lock(access_->io_queue);
+    auto val = pci_read_word(dev, offset);
     return core::Result<core::Word>::Ok(val);
 }
 
 core::Result<core::DWord> PciUtilsDevice::ReadConfig32(
     pci::Bdf bdf, pci::ConfigOffset offset) {
+    return ReadConfig32(pci::PciAddress{domain_, bdf}, offset);
+}
+
+core::Result<core::DWord> PciUtilsDevice::ReadConfig32(
+    const pci::PciAddress& addr, pci::ConfigOffset offset) {
     if (state_ != DeviceState::kOpen) {
         return core::Result<core::DWord>::Err(
             core::ErrorCode::kNotInitialized);
     }
-    auto dev = GetPciDev(bdf);
+    auto handle = GetPciDev(addr);
+    auto* dev = handle.get();
     if (!dev) {
-        PLAS_LOG_ERROR("[" + name_ + "][PciConfig] ReadConfig32 offset=" +
-                       std::to_string(offset) + " failed: GetPciDev returned null");
+        PLAS_LOG_DEVICE_ERROR(name_, "PciConfig", "ReadConfig32 offset=" +
+                              std::to_string(offset) + " failed: GetPciDev returned null");
         return core::Result<core::DWord>::Err(core::ErrorCode::kIOError);
     }
-    auto val = pci_read_long(dev.get(), offset);
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciConfig,
+                        log::TraceOp::kRead, offset, 4, addr.bdf.Pack());
+    MetricsTimer timer(metrics_, MetricOp::kPciConfigRead, 4);
+    std::lock_guard<core::IoQueue> io_lock(access_->io_queue);
+    auto val = pci_read_long(dev, offset);
     return core::Result<core::DWord>::Ok(val);
 }
 
+core::Result<void> PciUtilsDevice::ReadConfigBlock(pci::Bdf bdf,
+                                                   pci::ConfigOffset offset,
+                                                   core::Byte* buffer,
+                                                   std::size_t length) {
+    return ReadConfigBlock(pci::PciAddress{domain_, bdf}, offset, buffer,
+                           length);
+}
+
+core::Result<void> PciUtilsDevice::ReadConfigBlock(const pci::PciAddress& addr,
+                                                   pci::ConfigOffset offset,
+                                                   core::Byte* buffer,
+                                                   std::size_t length) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (length == 0) {
+        return core::Result<void>::Ok();
+    }
+    if (!buffer) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (offset >= pci::kConfigSpaceSize ||
+        length > pci::kConfigSpaceSize - offset) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+    auto handle = GetPciDev(addr);
+    auto* dev = handle.get();
+    if (!dev) {
+        PLAS_LOG_DEVICE_ERROR(name_, "PciConfig", "ReadConfigBlock offset=" +
+                              std::to_string(offset) + " failed: GetPciDev returned null");
+        return core::Result<void>::Err(core::ErrorCode::kIOError);
+    }
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciConfig,
+                        log::TraceOp::kRead, offset, length, addr.bdf.Pack());
+    MetricsTimer timer(metrics_, MetricOp::kPciConfigRead, length);
+    std::unique_lock<core::IoQueue> io_lock(access_->io_queue);
+    int ok = pci_read_block(dev, offset, buffer, static_cast<int>(length));
+    io_lock.unlock();
+    if (!ok) {
+        span.SetStatus(core::make_error_code(core::ErrorCode::kIOError));
+        timer.SetError();
+        PLAS_LOG_DEVICE_ERROR(name_, "PciConfig", "ReadConfigBlock offset=" +
+                              std::to_string(offset) + " length=" +
+                              std::to_string(length) + " failed");
+        return core::Result<void>::Err(core::ErrorCode::kIOError);
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<std::vector<core::Byte>> PciUtilsDevice::SnapshotConfig(
+    pci::Bdf bdf) {
+    std::vector<core::Byte> data(pci::kConfigSpaceSize);
+    auto result = ReadConfigBlock(bdf, 0, data.data(), data.size());
+    if (result.IsError() &&
+        result.Error() == core::make_error_code(core::ErrorCode::kIOError)) {
+        // Conventional PCI functions only expose 256 bytes.
+        data.resize(pci::kLegacyConfigSpaceSize);
+        result = ReadConfigBlock(bdf, 0, data.data(), data.size());
+    }
+    if (result.IsError()) {
+        return core::Result<std::vector<core::Byte>>::Err(result.Error());
+    }
+    return core::Result<std::vector<core::Byte>>::Ok(std::move(data));
+}
+
 // ---------------------------------------------------------------------------
 // PciConfig — typed writes
 // ---------------------------------------------------------------------------
@@ -284,51 +829,146 @@ core::Result<core::DWord> PciUtilsDevice::ReadConfig32(
 core::Result<void> PciUtilsDevice::WriteConfig8(pci::Bdf bdf,
                                                  pci::ConfigOffset offset,
                                                  core::Byte value) {
+    return WriteConfig8(pci::PciAddress{domain_, bdf}, offset, value);
+}
+
+core::Result<void> PciUtilsDevice::WriteConfig8(const pci::PciAddress& addr,
+                                                pci::ConfigOffset offset,
+                                                core::Byte value) {
     if (state_ != DeviceState::kOpen) {
         return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
     }
-    auto dev = GetPciDev(bdf);
+    auto handle = GetPciDev(addr);
+    auto* dev = handle.get();
     if (!dev) {
-        PLAS_LOG_ERROR("[" + name_ + "][PciConfig] WriteConfig8 offset=" +
-                       std::to_string(offset) + " failed: GetPciDev returned null");
+        PLAS_LOG_DEVICE_ERROR(name_, "PciConfig", "WriteConfig8 offset=" +
+                              std::to_string(offset) + " failed: GetPciDev returned null");
         return core::Result<void>::Err(core::ErrorCode::kIOError);
     }
-    pci_write_byte(dev.get(), offset, value);
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciConfig,
+                        log::TraceOp::kWrite, offset, 1, addr.bdf.Pack());
+    MetricsTimer timer(metrics_, MetricOp::kPciConfigWrite, 1);
+    std::lock_guard<core::IoQueue> io_lock(access_->io_queue);
+    pci_write_byte(dev, offset, value);
     return core::Result<void>::Ok();
 }
 
 core::Result<void> PciUtilsDevice::WriteConfig16(pci::Bdf bdf,
                                                   pci::ConfigOffset offset,
                                                   core::Word value) {
+    return WriteConfig16(pci::PciAddress{domain_, bdf}, offset, value);
+}
+
+core::Result<void> PciUtilsDevice::WriteConfig16(const pci::PciAddress& addr,
+                                                 pci::ConfigOffset offset,
+                                                 core::Word value) {
     if (state_ != DeviceState::kOpen) {
         return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
     }
-    auto dev = GetPciDev(bdf);
+    auto handle = GetPciDev(addr);
+    auto* dev = handle.get();
     if (!dev) {
-        PLAS_LOG_ERROR("[" + name_ + "][PciConfig] WriteConfig16 offset=" +
-                       std::to_string(offset) + " failed: GetPciDev returned null");
+        PLAS_LOG_DEVICE_ERROR(name_, "PciConfig", "WriteConfig16 offset=" +
+                              std::to_string(offset) + " failed: GetPciDev returned null");
         return core::Result<void>::Err(core::ErrorCode::kIOError);
     }
-    pci_write_word(dev.get(), offset, value);
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciConfig,
+                        log::TraceOp::kWrite, offset, 2, addr.bdf.Pack());
+    MetricsTimer timer(metrics_, MetricOp::kPciConfigWrite, 2);
+    std::lock_guard<core::IoQueue> io_lock(access_->io_queue);
+    pci_write_word(dev, offset, value);
     return core::Result<void>::Ok();
 }
 
 core::Result<void> PciUtilsDevice::WriteConfig32(pci::Bdf bdf,
                                                   pci::ConfigOffset offset,
                                                   core::DWord value) {
+    return WriteConfig32(pci::PciAddress{domain_, bdf}, offset, value);
+}
+
+core::Result<void> PciUtilsDevice::WriteConfig32(const pci::PciAddress& addr,
+                                                 pci::ConfigOffset offset,
+                                                 core::DWord value) {
     if (state_ != DeviceState::kOpen) {
         return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
     }
-    auto dev = GetPciDev(bdf);
+    auto handle = GetPciDev(addr);
+    auto* dev = handle.get();
     if (!dev) {
-        PLAS_LOG_ERROR("[" + name_ + "][PciConfig] WriteConfig32 offset=" +
-                       std::to_string(offset) + " failed: GetPciDev returned null");
+        PLAS_LOG_DEVICE_ERROR(name_, "PciConfig", "WriteConfig32 offset=" +
+                              std::to_string(offset) + " failed: GetPciDev returned null");
         return core::Result<void>::Err(core::ErrorCode::kIOError);
     }
-    pci_write_long(dev.get(), offset, value);
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciConfig,
+                        log::TraceOp::kWrite, offset, 4, addr.bdf.Pack());
+    MetricsTimer timer(metrics_, MetricOp::kPciConfigWrite, 4);
+    std::lock_guard<core::IoQueue> io_lock(access_->io_queue);
+    pci_write_long(dev, offset, value);
     return core::Result<void>::Ok();
 }
 
+std::size_t PciUtilsDevice::WriteConfigBatch(pci::Bdf bdf,
+                                             const pci::ConfigWrite* writes,
+                                             std::size_t count,
+                                             std::error_code* status) {
+    if (count == 0) {
+        return 0;
+    }
+    std::error_code failure;
+    if (state_ != DeviceState::kOpen) {
+        failure = core::make_error_code(core::ErrorCode::kNotInitialized);
+    }
+    PciDevPtr handle = failure ? nullptr : GetPciDev(bdf);
+    pci_dev* dev = handle.get();
+    if (!failure && !dev) {
+        PLAS_LOG_DEVICE_ERROR(name_, "PciConfig", "WriteConfigBatch failed: "
+                              "GetPciDev returned null");
+        failure = core::make_error_code(core::ErrorCode::kIOError);
+    }
+
+    std::size_t done = 0;
+    if (!failure) {
+        std::size_t bytes = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            bytes += writes[i].width;
+        }
+        log::TraceSpan span(trace_id_, log::TraceInterface::kPciConfig,
+                            log::TraceOp::kWrite, writes[0].offset, bytes,
+                            bdf.Pack());
+        MetricsTimer timer(metrics_, MetricOp::kPciConfigWrite, bytes);
+        std::lock_guard<core::IoQueue> io_lock(access_->io_queue);
+        for (; done < count; ++done) {
+            const auto& w = writes[done];
+            if (w.width == 1) {
+                pci_write_byte(dev, w.offset, static_cast<core::Byte>(w.value));
+            } else if (w.width == 2) {
+                pci_write_word(dev, w.offset, static_cast<core::Word>(w.value));
+            } else if (w.width == 4) {
+                pci_write_long(dev, w.offset, w.value);
+            } else {
+                failure =
+                    core::make_error_code(core::ErrorCode::kInvalidArgument);
+                span.SetStatus(failure);
+                timer.SetError();
+                break;
+            }
+            if (status) {
+                status[done] = {};
+            }
+        }
+    }
+
+    if (status) {
+        if (done < count) {
+            status[done] = failure;
+        }
+        for (std::size_t i = done + 1; i < count; ++i) {
+            status[i] = core::make_error_code(core::ErrorCode::kCancelled);
+        }
+    }
+    return done;
+}
+
 // ---------------------------------------------------------------------------
 // PciConfig — capability walking
 // ---------------------------------------------------------------------------
@@ -339,31 +979,14 @@ PciUtilsDevice::FindCapability(pci::Bdf bdf, pci::CapabilityId id) {
         return core::Result<std::optional<pci::ConfigOffset>>::Err(
             core::ErrorCode::kNotInitialized);
     }
-    auto dev = GetPciDev(bdf);
-    if (!dev) {
+    std::lock_guard<std::mutex> lock(cap_cache_mutex_);
+    auto index_result = EnsureCapabilityIndex(bdf);
+    if (index_result.IsError()) {
         return core::Result<std::optional<pci::ConfigOffset>>::Err(
-            core::ErrorCode::kIOError);
+            index_result.Error());
     }
-
-    // Check if device has capabilities (Status register bit 4).
-    auto status = pci_read_word(dev.get(), 0x06);
-    if (!(status & (1u << 4))) {
-        return core::Result<std::optional<pci::ConfigOffset>>::Ok(
-            std::nullopt);
-    }
-
-    uint8_t offset = pci_read_byte(dev.get(), 0x34) & 0xFC;
-    constexpr int kMaxCaps = 48;  // guard against loops
-    for (int i = 0; i < kMaxCaps && offset != 0; ++i) {
-        auto cap_id = pci_read_byte(dev.get(), offset);
-        if (cap_id == static_cast<uint8_t>(id)) {
-            return core::Result<std::optional<pci::ConfigOffset>>::Ok(
-                static_cast<pci::ConfigOffset>(offset));
-        }
-        offset = pci_read_byte(dev.get(), offset + 1) & 0xFC;
-    }
-
-    return core::Result<std::optional<pci::ConfigOffset>>::Ok(std::nullopt);
+    return core::Result<std::optional<pci::ConfigOffset>>::Ok(
+        index_result.Value()->Find(id));
 }
 
 core::Result<std::optional<pci::ConfigOffset>>
@@ -372,108 +995,232 @@ PciUtilsDevice::FindExtCapability(pci::Bdf bdf, pci::ExtCapabilityId id) {
         return core::Result<std::optional<pci::ConfigOffset>>::Err(
             core::ErrorCode::kNotInitialized);
     }
-    auto dev = GetPciDev(bdf);
-    if (!dev) {
+    std::lock_guard<std::mutex> lock(cap_cache_mutex_);
+    auto index_result = EnsureCapabilityIndex(bdf);
+    if (index_result.IsError()) {
         return core::Result<std::optional<pci::ConfigOffset>>::Err(
-            core::ErrorCode::kIOError);
+            index_result.Error());
     }
+    return core::Result<std::optional<pci::ConfigOffset>>::Ok(
+        index_result.Value()->Find(id));
+}
 
-    pci::ConfigOffset offset = 0x100;
-    constexpr int kMaxExtCaps = 256;  // guard against loops
-    for (int i = 0; i < kMaxExtCaps && offset != 0; ++i) {
-        auto header = pci_read_long(dev.get(), offset);
-        uint16_t cap_id = header & 0xFFFF;
-        if (cap_id == static_cast<uint16_t>(id)) {
-            return core::Result<std::optional<pci::ConfigOffset>>::Ok(offset);
-        }
-        uint16_t next = (header >> 20) & 0xFFC;
-        if (next == 0 || next <= offset) {
-            break;
-        }
-        offset = next;
+core::Result<pci::CapabilityIndex> PciUtilsDevice::GetCapabilityIndex(
+    pci::Bdf bdf) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<pci::CapabilityIndex>::Err(
+            core::ErrorCode::kNotInitialized);
     }
-
-    return core::Result<std::optional<pci::ConfigOffset>>::Ok(std::nullopt);
+    std::lock_guard<std::mutex> lock(cap_cache_mutex_);
+    auto index_result = EnsureCapabilityIndex(bdf);
+    if (index_result.IsError()) {
+        return core::Result<pci::CapabilityIndex>::Err(index_result.Error());
+    }
+    return core::Result<pci::CapabilityIndex>::Ok(*index_result.Value());
 }
 
 // ---------------------------------------------------------------------------
 // DOE helpers
 // ---------------------------------------------------------------------------
 
+core::IoQueue& PciUtilsDevice::DoeMailboxQueue(pci::Bdf bdf,
+                                               pci::ConfigOffset doe_offset) {
+    std::lock_guard<core::InstrumentedMutex> lock(doe_mutex_);
+    auto key = (static_cast<uint32_t>(bdf.Pack()) << 16) | doe_offset;
+    auto& queue = doe_mailbox_queues_[key];
+    if (!queue) {
+        queue = std::make_unique<core::IoQueue>("pciutils.doe");
+    }
+    return *queue;
+}
+
+uint32_t PciUtilsDevice::DoeReadReg(pci_dev* dev, pci::ConfigOffset offset) {
+    std::lock_guard<core::IoQueue> lock(access_->io_queue);
+    return pci_read_long(dev, offset);
+}
+
+void PciUtilsDevice::DoeWriteReg(pci_dev* dev, pci::ConfigOffset offset,
+                                 uint32_t value) {
+    std::lock_guard<core::IoQueue> lock(access_->io_queue);
+    pci_write_long(dev, offset, value);
+}
+
 core::Result<void> PciUtilsDevice::DoeAbort(pci_dev* dev,
                                              pci::ConfigOffset doe_offset) {
-    pci_write_long(dev, doe_offset + doe_reg::kControl, doe_ctrl::kAbort);
+    DoeWriteReg(dev, doe_offset + doe_reg::kControl, doe_ctrl::kAbort);
 
     // Poll until abort completes (Busy clears).
     auto deadline =
         std::chrono::steady_clock::now() +
         std::chrono::milliseconds(doe_timeout_ms_);
+    DoeBackoff backoff(doe_spin_us_, doe_poll_interval_us_);
     while (std::chrono::steady_clock::now() < deadline) {
-        auto status = pci_read_long(dev, doe_offset + doe_reg::kStatus);
+        auto status = DoeReadReg(dev, doe_offset + doe_reg::kStatus);
         if (!(status & doe_status::kBusy)) {
             return core::Result<void>::Ok();
         }
-        std::this_thread::sleep_for(
-            std::chrono::microseconds(doe_poll_interval_us_));
+        backoff.Wait();
     }
     return core::Result<void>::Err(core::ErrorCode::kTimeout);
 }
 
 core::Result<bool> PciUtilsDevice::DoePollReady(
     pci_dev* dev, pci::ConfigOffset doe_offset) {
-    auto deadline =
-        std::chrono::steady_clock::now() +
-        std::chrono::milliseconds(doe_timeout_ms_);
+    // The caller's deadline may cut the wait short; the mailbox is then
+    // left busy and the next DoeSubmit aborts it.
+    auto timeout = std::chrono::steady_clock::now() +
+                   std::chrono::milliseconds(doe_timeout_ms_);
+    auto deadline = core::Deadline::Current().Clamp(timeout);
+    DoeBackoff backoff(doe_spin_us_, doe_poll_interval_us_);
     while (std::chrono::steady_clock::now() < deadline) {
-        auto status = pci_read_long(dev, doe_offset + doe_reg::kStatus);
+        auto status = DoeReadReg(dev, doe_offset + doe_reg::kStatus);
         if (status & doe_status::kError) {
             return core::Result<bool>::Err(core::ErrorCode::kIOError);
         }
         if (status & doe_status::kReady) {
+            RecordDoeLatency(backoff.ElapsedUs());
             return core::Result<bool>::Ok(true);
         }
-        std::this_thread::sleep_for(
-            std::chrono::microseconds(doe_poll_interval_us_));
+        backoff.Wait();
+    }
+    {
+        std::lock_guard<std::mutex> lock(doe_stats_mutex_);
+        ++doe_stats_.timeouts;
+    }
+    if (deadline < timeout) {
+        PLAS_LOG_DEVICE_WARN(name_, "PciDoe", "response not ready by the caller's deadline");
+    } else {
+        PLAS_LOG_DEVICE_WARN(name_, "PciDoe", "response timed out after " +
+                             std::to_string(doe_timeout_ms_) + " ms");
     }
     return core::Result<bool>::Err(core::ErrorCode::kTimeout);
 }
 
-core::Result<void> PciUtilsDevice::DoeWriteMailbox(
-    pci_dev* dev, pci::ConfigOffset doe_offset,
-    const pci::DoePayload& payload) {
-    for (auto dw : payload) {
-        pci_write_long(dev, doe_offset + doe_reg::kWriteMailbox, dw);
+void PciUtilsDevice::RecordDoeLatency(uint64_t latency_us) {
+    {
+        std::lock_guard<std::mutex> lock(doe_stats_mutex_);
+        auto& st = doe_stats_;
+        st.min_us = st.exchanges == 0 ? latency_us
+                                      : std::min(st.min_us, latency_us);
+        st.max_us = std::max(st.max_us, latency_us);
+        st.last_us = latency_us;
+        st.total_us += latency_us;
+        ++st.exchanges;
+    }
+    PLAS_LOG_DEVICE_DEBUG(name_, "PciDoe", "response ready in " +
+                          std::to_string(latency_us) + " us");
+}
+
+PciUtilsDevice::DoeStats PciUtilsDevice::GetDoeStats() const {
+    std::lock_guard<std::mutex> lock(doe_stats_mutex_);
+    return doe_stats_;
+}
+
+void PciUtilsDevice::ResetDoeStats() {
+    std::lock_guard<std::mutex> lock(doe_stats_mutex_);
+    doe_stats_ = DoeStats{};
+}
+
+core::Result<void> PciUtilsDevice::DoeWriteObject(
+    pci_dev* dev, pci::ConfigOffset doe_offset, pci::DoeProtocolId protocol,
+    const core::DWord* payload, std::size_t payload_len) {
+    // Data object length includes the 2-DWord header; 2^18 encodes as 0.
+    if (payload_len > (1u << 18) - 2) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    // DW0: [15:0]=VendorID, [23:16]=DataObjectType
+    uint32_t dw0 = (static_cast<uint32_t>(protocol.data_object_type) << 16) |
+                   protocol.vendor_id;
+    // DW1: [17:0]=Length (header + payload, in DWords)
+    uint32_t dw1 = static_cast<uint32_t>(2 + payload_len) & 0x0003FFFF;
+
+    DoeWriteReg(dev, doe_offset + doe_reg::kWriteMailbox, dw0);
+    DoeWriteReg(dev, doe_offset + doe_reg::kWriteMailbox, dw1);
+    for (std::size_t i = 0; i < payload_len; ++i) {
+        DoeWriteReg(dev, doe_offset + doe_reg::kWriteMailbox, payload[i]);
     }
     return core::Result<void>::Ok();
 }
 
-core::Result<pci::DoePayload> PciUtilsDevice::DoeReadMailbox(
-    pci_dev* dev, pci::ConfigOffset doe_offset) {
-    pci::DoePayload result;
+core::Result<void> PciUtilsDevice::DoeSubmit(pci_dev* dev,
+                                              pci::ConfigOffset doe_offset,
+                                              pci::DoeProtocolId protocol,
+                                              const core::DWord* payload,
+                                              std::size_t payload_len) {
+    // Check busy.
+    auto status = DoeReadReg(dev, doe_offset + doe_reg::kStatus);
+    if (status & doe_status::kBusy) {
+        auto abort_res = DoeAbort(dev, doe_offset);
+        if (abort_res.IsError()) {
+            return abort_res;
+        }
+    }
 
-    // Read first two DWORDs (DOE header) to determine payload length.
-    auto dw0 = pci_read_long(dev, doe_offset + doe_reg::kReadMailbox);
-    result.push_back(dw0);
-    // Reading the mailbox register advances the internal pointer.
+    // Write request to mailbox.
+    auto wr = DoeWriteObject(dev, doe_offset, protocol, payload, payload_len);
+    if (wr.IsError()) {
+        return wr;
+    }
 
-    auto dw1 = pci_read_long(dev, doe_offset + doe_reg::kReadMailbox);
-    result.push_back(dw1);
+    // Set GO bit.
+    DoeWriteReg(dev, doe_offset + doe_reg::kControl, doe_ctrl::kGo);
+
+    // Poll for response ready.
+    auto ready = DoePollReady(dev, doe_offset);
+    if (ready.IsError()) {
+        return core::Result<void>::Err(ready.Error());
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<std::size_t> PciUtilsDevice::DoeReadHeader(
+    pci_dev* dev, pci::ConfigOffset doe_offset) {
+    // Reading the mailbox register advances the internal pointer.
+    DoeReadReg(dev, doe_offset + doe_reg::kReadMailbox);
+    auto dw1 = DoeReadReg(dev, doe_offset + doe_reg::kReadMailbox);
 
     // Length field: bits [17:0] of DW1. 0 means 2^18.
     uint32_t length = dw1 & 0x0003FFFF;
     if (length == 0) {
         length = (1u << 18);
     }
+    // length includes the 2-DWord header.
+    if (length < 2) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kDataLoss);
+    }
+    return core::Result<std::size_t>::Ok(length - 2);
+}
 
-    // length includes the 2-DWord header, so remaining = length - 2.
-    if (length > 2) {
-        for (uint32_t i = 0; i < length - 2; ++i) {
-            auto dw = pci_read_long(dev, doe_offset + doe_reg::kReadMailbox);
-            result.push_back(dw);
-        }
+core::Result<pci::DoePayload> PciUtilsDevice::DoeReadMailbox(
+    pci_dev* dev, pci::ConfigOffset doe_offset) {
+    auto len = DoeReadHeader(dev, doe_offset);
+    if (len.IsError()) {
+        return core::Result<pci::DoePayload>::Err(len.Error());
     }
+    pci::DoePayload payload(len.Value());
+    for (auto& dw : payload) {
+        dw = DoeReadReg(dev, doe_offset + doe_reg::kReadMailbox);
+    }
+    return core::Result<pci::DoePayload>::Ok(std::move(payload));
+}
 
-    return core::Result<pci::DoePayload>::Ok(std::move(result));
+core::Result<std::size_t> PciUtilsDevice::DoeReadMailboxInto(
+    pci_dev* dev, pci::ConfigOffset doe_offset, core::DWord* out,
+    std::size_t capacity) {
+    auto len = DoeReadHeader(dev, doe_offset);
+    if (len.IsError()) {
+        return len;
+    }
+    if (len.Value() > capacity) {
+        // Leave the mailbox idle for the next exchange.
+        DoeAbort(dev, doe_offset);
+        return core::Result<std::size_t>::Err(core::ErrorCode::kOverflow);
+    }
+    for (std::size_t i = 0; i < len.Value(); ++i) {
+        out[i] = DoeReadReg(dev, doe_offset + doe_reg::kReadMailbox);
+    }
+    return len;
 }
 
 // ---------------------------------------------------------------------------
@@ -482,82 +1229,49 @@ core::Result<pci::DoePayload> PciUtilsDevice::DoeReadMailbox(
 
 core::Result<std::vector<pci::DoeProtocolId>>
 PciUtilsDevice::DoeDiscover(pci::Bdf bdf, pci::ConfigOffset doe_offset) {
-    std::lock_guard<std::mutex> lock(doe_mutex_);
+    std::lock_guard<core::IoQueue> lock(DoeMailboxQueue(bdf, doe_offset));
 
     if (state_ != DeviceState::kOpen) {
         return core::Result<std::vector<pci::DoeProtocolId>>::Err(
             core::ErrorCode::kNotInitialized);
     }
-    auto dev = GetPciDev(bdf);
+    auto handle = GetPciDev(bdf);
+    auto* dev = handle.get();
     if (!dev) {
         return core::Result<std::vector<pci::DoeProtocolId>>::Err(
             core::ErrorCode::kIOError);
     }
 
+    const pci::DoeProtocolId discovery{pci::doe_vendor::kPciSig,
+                                       pci::doe_type::kDoeDiscovery};
     std::vector<pci::DoeProtocolId> protocols;
     uint8_t discovery_index = 0;
 
     while (true) {
-        // Build discovery request:
-        //   DW0 (header): VendorID=0x0001, Type=0x00
-        //   DW1 (header): Length=3 (2 header + 1 payload)
-        //   DW2 (payload): discovery_index in bits [7:0]
-        pci::DoePayload request;
-        request.push_back(
-            (static_cast<uint32_t>(pci::doe_type::kDoeDiscovery) << 16) |
-            pci::doe_vendor::kPciSig);
-        request.push_back(3);  // length in DWords
-        request.push_back(static_cast<uint32_t>(discovery_index));
-
-        // Check busy.
-        auto status = pci_read_long(dev.get(),
-                                    doe_offset + doe_reg::kStatus);
-        if (status & doe_status::kBusy) {
-            auto abort_res = DoeAbort(dev.get(), doe_offset);
-            if (abort_res.IsError()) {
-                return core::Result<std::vector<pci::DoeProtocolId>>::Err(
-                    abort_res.Error());
-            }
-        }
-
-        // Write request.
-        auto wr = DoeWriteMailbox(dev.get(), doe_offset, request);
-        if (wr.IsError()) {
+        // Discovery request payload: index in bits [7:0].
+        core::DWord request = discovery_index;
+        auto submit = DoeSubmit(dev, doe_offset, discovery, &request, 1);
+        if (submit.IsError()) {
             return core::Result<std::vector<pci::DoeProtocolId>>::Err(
-                wr.Error());
+                submit.Error());
         }
 
-        // Set GO bit.
-        pci_write_long(dev.get(), doe_offset + doe_reg::kControl,
-                       doe_ctrl::kGo);
-
-        // Poll for ready.
-        auto ready = DoePollReady(dev.get(), doe_offset);
-        if (ready.IsError()) {
-            return core::Result<std::vector<pci::DoeProtocolId>>::Err(
-                ready.Error());
-        }
-
-        // Read response.
-        auto resp = DoeReadMailbox(dev.get(), doe_offset);
+        core::DWord response = 0;
+        auto resp = DoeReadMailboxInto(dev, doe_offset, &response, 1);
         if (resp.IsError()) {
             return core::Result<std::vector<pci::DoeProtocolId>>::Err(
                 resp.Error());
         }
-
-        auto& payload = resp.Value();
-        // Response: DW0=header, DW1=length, DW2=discovery response
-        if (payload.size() < 3) {
+        if (resp.Value() < 1) {
             return core::Result<std::vector<pci::DoeProtocolId>>::Err(
                 core::ErrorCode::kDataLoss);
         }
 
-        uint32_t disc_dw = payload[2];
         pci::DoeProtocolId proto;
-        proto.vendor_id = static_cast<uint16_t>(disc_dw & 0xFFFF);
+        proto.vendor_id = static_cast<uint16_t>(response & 0xFFFF);
         proto.data_object_type =
-            static_cast<uint8_t>((disc_dw >> 16) & 0xFF);
-        uint8_t next_index = static_cast<uint8_t>((disc_dw >> 24) & 0xFF);
+            static_cast<uint8_t>((response >> 16) & 0xFF);
+        uint8_t next_index = static_cast<uint8_t>((response >> 24) & 0xFF);
 
         protocols.push_back(proto);
 
@@ -578,73 +1292,83 @@ PciUtilsDevice::DoeDiscover(pci::Bdf bdf, pci::ConfigOffset doe_offset) {
 core::Result<pci::DoePayload> PciUtilsDevice::DoeExchange(
     pci::Bdf bdf, pci::ConfigOffset doe_offset,
     pci::DoeProtocolId protocol, const pci::DoePayload& request) {
-    std::lock_guard<std::mutex> lock(doe_mutex_);
+    std::lock_guard<core::IoQueue> lock(DoeMailboxQueue(bdf, doe_offset));
 
     if (state_ != DeviceState::kOpen) {
         return core::Result<pci::DoePayload>::Err(
             core::ErrorCode::kNotInitialized);
     }
-    auto dev = GetPciDev(bdf);
+    auto handle = GetPciDev(bdf);
+    auto* dev = handle.get();
     if (!dev) {
-        PLAS_LOG_ERROR("[" + name_ + "][PciDoe] DoeExchange failed: GetPciDev returned null");
+        PLAS_LOG_DEVICE_ERROR(name_, "PciDoe", "DoeExchange failed: GetPciDev returned null");
         return core::Result<pci::DoePayload>::Err(core::ErrorCode::kIOError);
     }
 
-    // Build full DOE data object: 2-DWord header + payload.
-    pci::DoePayload full_request;
-
-    // DW0: [15:0]=VendorID, [23:16]=DataObjectType
-    uint32_t dw0 = (static_cast<uint32_t>(protocol.data_object_type) << 16) |
-                   protocol.vendor_id;
-    full_request.push_back(dw0);
-
-    // DW1: [17:0]=Length (header + payload, in DWords)
-    uint32_t length = static_cast<uint32_t>(2 + request.size());
-    full_request.push_back(length);
-
-    // Append user payload.
-    full_request.insert(full_request.end(), request.begin(), request.end());
-
-    // Check busy.
-    auto status = pci_read_long(dev.get(), doe_offset + doe_reg::kStatus);
-    if (status & doe_status::kBusy) {
-        auto abort_res = DoeAbort(dev.get(), doe_offset);
-        if (abort_res.IsError()) {
-            return core::Result<pci::DoePayload>::Err(abort_res.Error());
-        }
-    }
-
-    // Write request to mailbox.
-    auto wr = DoeWriteMailbox(dev.get(), doe_offset, full_request);
-    if (wr.IsError()) {
-        return core::Result<pci::DoePayload>::Err(wr.Error());
-    }
-
-    // Set GO bit.
-    pci_write_long(dev.get(), doe_offset + doe_reg::kControl, doe_ctrl::kGo);
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciDoe,
+                        log::TraceOp::kExchange, doe_offset, request.size(),
+                        bdf.Pack(), DoeTraceProtocol(protocol));
+    MetricsTimer timer(metrics_, MetricOp::kDoeExchange);
+    auto submit = DoeSubmit(dev, doe_offset, protocol, request.data(),
+                            request.size());
+    if (submit.IsError()) {
+        span.SetStatus(submit.Error());
+        timer.SetError();
+        return core::Result<pci::DoePayload>::Err(submit.Error());
+    }
+    auto response_result = DoeReadMailbox(dev, doe_offset);
+    if (response_result.IsError()) {
+        span.SetStatus(response_result.Error());
+        timer.SetError();
+    } else {
+        timer.SetBytes((request.size() + response_result.Value().size()) *
+                       sizeof(core::DWord));
+    }
+    return response_result;
+}
 
-    // Poll for response ready.
-    auto ready = DoePollReady(dev.get(), doe_offset);
-    if (ready.IsError()) {
-        return core::Result<pci::DoePayload>::Err(ready.Error());
+core::Result<std::size_t> PciUtilsDevice::DoeExchangeInto(
+    pci::Bdf bdf, pci::ConfigOffset doe_offset, pci::DoeProtocolId protocol,
+    const core::DWord* request, std::size_t request_len,
+    core::DWord* response, std::size_t response_capacity) {
+    if ((request_len > 0 && !request) || (response_capacity > 0 && !response)) {
+        return core::Result<std::size_t>::Err(
+            core::ErrorCode::kInvalidArgument);
     }
 
-    // Read response from mailbox.
-    auto resp = DoeReadMailbox(dev.get(), doe_offset);
-    if (resp.IsError()) {
-        return core::Result<pci::DoePayload>::Err(resp.Error());
-    }
+    std::lock_guard<core::IoQueue> lock(DoeMailboxQueue(bdf, doe_offset));
 
-    // Strip the 2-DWord header, return only payload.
-    auto& full_response = resp.Value();
-    if (full_response.size() < 2) {
-        return core::Result<pci::DoePayload>::Err(
-            core::ErrorCode::kDataLoss);
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<std::size_t>::Err(
+            core::ErrorCode::kNotInitialized);
     }
-
-    pci::DoePayload payload(full_response.begin() + 2,
-                            full_response.end());
-    return core::Result<pci::DoePayload>::Ok(std::move(payload));
+    auto handle = GetPciDev(bdf);
+    auto* dev = handle.get();
+    if (!dev) {
+        PLAS_LOG_DEVICE_ERROR(name_, "PciDoe", "DoeExchangeInto failed: GetPciDev returned null");
+        return core::Result<std::size_t>::Err(core::ErrorCode::kIOError);
+    }
+
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciDoe,
+                        log::TraceOp::kExchange, doe_offset, request_len,
+                        bdf.Pack(), DoeTraceProtocol(protocol));
+    MetricsTimer timer(metrics_, MetricOp::kDoeExchange);
+    auto submit = DoeSubmit(dev, doe_offset, protocol, request, request_len);
+    if (submit.IsError()) {
+        span.SetStatus(submit.Error());
+        timer.SetError();
+        return core::Result<std::size_t>::Err(submit.Error());
+    }
+    auto response_result =
+        DoeReadMailboxInto(dev, doe_offset, response, response_capacity);
+    if (response_result.IsError()) {
+        span.SetStatus(response_result.Error());
+        timer.SetError();
+    } else {
+        timer.SetBytes((request_len + response_result.Value()) *
+                       sizeof(core::DWord));
+    }
+    return response_result;
 }
 
 // ---------------------------------------------------------------------------
@@ -659,28 +1383,30 @@ std::string FormatSysfsPath(uint16_t domain, uint8_t bus, uint8_t device,
     return buf;
 }
 
-uint64_t PciUtilsDevice::GetBarSize(uint8_t bar_index) {
-    auto sysfs = FormatSysfsPath(domain_, bus_, device_num_, function_);
-    std::ifstream resource(sysfs + "/resource");
-    if (!resource.is_open()) {
-        return 0;
-    }
-
-    std::string line;
-    for (uint8_t i = 0; i <= bar_index; ++i) {
-        if (!std::getline(resource, line)) {
-            return 0;
+const pci::BarResources& PciUtilsDevice::BarResourcesLocked() {
+    uint64_t generation = pci::PciTopology::GetTopologyGeneration();
+    if (!bar_resources_ || bar_resources_generation_ != generation) {
+        bar_resources_generation_ = generation;
+        const pci_dev* scanned =
+            ScannedPciDev(pci::PciAddress{
+                domain_, pci::Bdf{bus_, device_num_, function_}});
+        if (scanned) {
+            bar_resources_ = ScannedBars(scanned);
+            if (bar_resources_) {
+                return *bar_resources_;
+            }
         }
+        auto result = pci::ReadBarResources(
+            FormatSysfsPath(domain_, bus_, device_num_, function_));
+        bar_resources_ = result.IsOk() ? result.Value() : pci::BarResources{};
+        bar_resources_generation_ = generation;
     }
+    return *bar_resources_;
+}
 
-    // Each line: start_addr end_addr flags (hex)
-    uint64_t start = 0, end = 0, flags = 0;
-    std::istringstream iss(line);
-    iss >> std::hex >> start >> end >> flags;
-    if (end == 0 || end < start) {
-        return 0;
-    }
-    return end - start + 1;
+pci::BarMapping PciUtilsDevice::RequestedBarMapping(uint8_t bar_index) const {
+    return bar_index < pci::kBarCount ? bar_mappings_[bar_index]
+                                      : pci::BarMapping::kUncached;
 }
 
 core::Result<PciUtilsDevice::MappedBar*>
@@ -689,28 +1415,49 @@ PciUtilsDevice::EnsureBarMapped(uint8_t bar_index) {
         return core::Result<MappedBar*>::Err(core::ErrorCode::kInvalidArgument);
     }
 
-    std::lock_guard<std::mutex> lock(bar_mutex_);
+    MappedBar* mapped = mapped_bars_[bar_index].load(std::memory_order_acquire);
+    if (mapped) {
+        return core::Result<MappedBar*>::Ok(mapped);
+    }
+
+    std::lock_guard<core::InstrumentedMutex> lock(bar_mutex_);
+    return EnsureBarMappedLocked(bar_index);
+}
 
-    auto it = mapped_bars_.find(bar_index);
-    if (it != mapped_bars_.end()) {
-        return core::Result<MappedBar*>::Ok(&it->second);
+core::Result<PciUtilsDevice::MappedBar*>
+PciUtilsDevice::EnsureBarMappedLocked(uint8_t bar_index) {
+    MappedBar* mapped = mapped_bars_[bar_index].load(std::memory_order_relaxed);
+    if (mapped) {
+        return core::Result<MappedBar*>::Ok(mapped);
     }
 
-    uint64_t size = GetBarSize(bar_index);
-    if (size == 0) {
+    const auto& resource = BarResourcesLocked()[bar_index];
+    if (!resource.IsImplemented()) {
         return core::Result<MappedBar*>::Err(core::ErrorCode::kNotFound);
     }
 
     auto sysfs = FormatSysfsPath(domain_, bus_, device_num_, function_);
     std::string resource_path = sysfs + "/resource" + std::to_string(bar_index);
 
+    auto mapping = RequestedBarMapping(bar_index);
+    if (mapping == pci::BarMapping::kWriteCombining) {
+        if (resource.IsPrefetchable() &&
+            ::access((resource_path + "_wc").c_str(), F_OK) == 0) {
+            resource_path += "_wc";
+        } else {
+            PLAS_LOG_WARN("PciUtilsDevice: BAR" + std::to_string(bar_index) +
+                          " is not prefetchable, mapping uncached");
+            mapping = pci::BarMapping::kUncached;
+        }
+    }
+
     int fd = ::open(resource_path.c_str(), O_RDWR | O_SYNC);
     if (fd < 0) {
         PLAS_LOG_ERROR("PciUtilsDevice: cannot open " + resource_path);
         return core::Result<MappedBar*>::Err(core::ErrorCode::kPermissionDenied);
     }
 
-    void* base = ::mmap(nullptr, static_cast<std::size_t>(size),
+    void* base = ::mmap(nullptr, static_cast<std::size_t>(resource.Size()),
                         PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
     if (base == MAP_FAILED) {
         PLAS_LOG_ERROR("PciUtilsDevice: mmap failed for " + resource_path);
@@ -718,24 +1465,36 @@ PciUtilsDevice::EnsureBarMapped(uint8_t bar_index) {
         return core::Result<MappedBar*>::Err(core::ErrorCode::kIOError);
     }
 
-    MappedBar bar;
+    MappedBar& bar = bar_slots_[bar_index];
     bar.fd = fd;
     bar.base = base;
-    bar.size = size;
-    auto [inserted, _] = mapped_bars_.emplace(bar_index, bar);
-    return core::Result<MappedBar*>::Ok(&inserted->second);
+    bar.size = resource.Size();
+    bar.mapping = mapping;
+    mapped_bars_[bar_index].store(&bar, std::memory_order_release);
+    return core::Result<MappedBar*>::Ok(&bar);
+}
+
+void PciUtilsDevice::UnmapBarLocked(uint8_t bar_index) {
+    MappedBar* bar =
+        mapped_bars_[bar_index].exchange(nullptr, std::memory_order_acq_rel);
+    if (!bar) {
+        return;
+    }
+    if (bar->base && bar->base != MAP_FAILED) {
+        ::munmap(bar->base, static_cast<std::size_t>(bar->size));
+    }
+    if (bar->fd >= 0) {
+        ::close(bar->fd);
+    }
+    *bar = MappedBar{};
 }
 
 void PciUtilsDevice::UnmapAllBars() {
-    for (auto& [idx, bar] : mapped_bars_) {
-        if (bar.base && bar.base != MAP_FAILED) {
-            ::munmap(bar.base, static_cast<std::size_t>(bar.size));
-        }
-        if (bar.fd >= 0) {
-            ::close(bar.fd);
-        }
+    std::lock_guard<core::InstrumentedMutex> lock(bar_mutex_);
+    for (uint8_t i = 0; i < pci::kBarCount; ++i) {
+        UnmapBarLocked(i);
     }
-    mapped_bars_.clear();
+    bar_resources_.reset();
 }
 
 // ---------------------------------------------------------------------------
@@ -749,16 +1508,20 @@ core::Result<core::DWord> PciUtilsDevice::BarRead32(
     }
     auto bar_result = EnsureBarMapped(bar_index);
     if (bar_result.IsError()) {
-        PLAS_LOG_ERROR("[" + name_ + "][PciBar] BarRead32 bar=" +
-                       std::to_string(bar_index) + " offset=" +
-                       std::to_string(offset) + " failed: " +
-                       make_error_code(bar_result.Error()).message());
+        PLAS_LOG_DEVICE_ERROR(name_, "PciBar", "BarRead32 bar=" +
+                              std::to_string(bar_index) + " offset=" +
+                              std::to_string(offset) + " failed: " +
+                              bar_result.Error().message());
         return core::Result<core::DWord>::Err(bar_result.Error());
     }
     auto* bar = bar_result.Value();
     if (offset + sizeof(core::DWord) > bar->size) {
         return core::Result<core::DWord>::Err(core::ErrorCode::kOutOfRange);
     }
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciBar,
+                        log::TraceOp::kRead, offset, sizeof(core::DWord),
+                        bdf.Pack(), bar_index);
+    MetricsTimer timer(metrics_, MetricOp::kBarRead, sizeof(core::DWord));
     auto* ptr = reinterpret_cast<volatile uint32_t*>(
         static_cast<uint8_t*>(bar->base) + offset);
     return core::Result<core::DWord>::Ok(*ptr);
@@ -771,16 +1534,20 @@ core::Result<core::QWord> PciUtilsDevice::BarRead64(
     }
     auto bar_result = EnsureBarMapped(bar_index);
     if (bar_result.IsError()) {
-        PLAS_LOG_ERROR("[" + name_ + "][PciBar] BarRead64 bar=" +
-                       std::to_string(bar_index) + " offset=" +
-                       std::to_string(offset) + " failed: " +
-                       make_error_code(bar_result.Error()).message());
+        PLAS_LOG_DEVICE_ERROR(name_, "PciBar", "BarRead64 bar=" +
+                              std::to_string(bar_index) + " offset=" +
+                              std::to_string(offset) + " failed: " +
+                              bar_result.Error().message());
         return core::Result<core::QWord>::Err(bar_result.Error());
     }
     auto* bar = bar_result.Value();
     if (offset + sizeof(core::QWord) > bar->size) {
         return core::Result<core::QWord>::Err(core::ErrorCode::kOutOfRange);
     }
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciBar,
+                        log::TraceOp::kRead, offset, sizeof(core::QWord),
+                        bdf.Pack(), bar_index);
+    MetricsTimer timer(metrics_, MetricOp::kBarRead, sizeof(core::QWord));
     auto* ptr = reinterpret_cast<volatile uint64_t*>(
         static_cast<uint8_t*>(bar->base) + offset);
     return core::Result<core::QWord>::Ok(*ptr);
@@ -793,16 +1560,20 @@ core::Result<void> PciUtilsDevice::BarWrite32(
     }
     auto bar_result = EnsureBarMapped(bar_index);
     if (bar_result.IsError()) {
-        PLAS_LOG_ERROR("[" + name_ + "][PciBar] BarWrite32 bar=" +
-                       std::to_string(bar_index) + " offset=" +
-                       std::to_string(offset) + " failed: " +
-                       make_error_code(bar_result.Error()).message());
+        PLAS_LOG_DEVICE_ERROR(name_, "PciBar", "BarWrite32 bar=" +
+                              std::to_string(bar_index) + " offset=" +
+                              std::to_string(offset) + " failed: " +
+                              bar_result.Error().message());
         return core::Result<void>::Err(bar_result.Error());
     }
     auto* bar = bar_result.Value();
     if (offset + sizeof(core::DWord) > bar->size) {
         return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
     }
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciBar,
+                        log::TraceOp::kWrite, offset, sizeof(core::DWord),
+                        bdf.Pack(), bar_index);
+    MetricsTimer timer(metrics_, MetricOp::kBarWrite, sizeof(core::DWord));
     auto* ptr = reinterpret_cast<volatile uint32_t*>(
         static_cast<uint8_t*>(bar->base) + offset);
     *ptr = value;
@@ -816,16 +1587,20 @@ core::Result<void> PciUtilsDevice::BarWrite64(
     }
     auto bar_result = EnsureBarMapped(bar_index);
     if (bar_result.IsError()) {
-        PLAS_LOG_ERROR("[" + name_ + "][PciBar] BarWrite64 bar=" +
-                       std::to_string(bar_index) + " offset=" +
-                       std::to_string(offset) + " failed: " +
-                       make_error_code(bar_result.Error()).message());
+        PLAS_LOG_DEVICE_ERROR(name_, "PciBar", "BarWrite64 bar=" +
+                              std::to_string(bar_index) + " offset=" +
+                              std::to_string(offset) + " failed: " +
+                              bar_result.Error().message());
         return core::Result<void>::Err(bar_result.Error());
     }
     auto* bar = bar_result.Value();
     if (offset + sizeof(core::QWord) > bar->size) {
         return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
     }
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciBar,
+                        log::TraceOp::kWrite, offset, sizeof(core::QWord),
+                        bdf.Pack(), bar_index);
+    MetricsTimer timer(metrics_, MetricOp::kBarWrite, sizeof(core::QWord));
     auto* ptr = reinterpret_cast<volatile uint64_t*>(
         static_cast<uint8_t*>(bar->base) + offset);
     *ptr = value;
@@ -849,9 +1624,16 @@ core::Result<void> PciUtilsDevice::BarReadBuffer(
     if (offset + length > bar->size) {
         return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
     }
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciBar,
+                        log::TraceOp::kRead, offset, length, bdf.Pack(),
+                        bar_index);
+    MetricsTimer timer(metrics_, MetricOp::kBarRead, length);
     auto* src = static_cast<uint8_t*>(bar->base) + offset;
-    std::memcpy(buffer, src, length);
-    return core::Result<void>::Ok();
+    auto result = pci::MmioRead(src, buffer, length);
+    if (result.IsError()) {
+        timer.SetError();
+    }
+    return result;
 }
 
 core::Result<void> PciUtilsDevice::BarWriteBuffer(
@@ -871,19 +1653,318 @@ core::Result<void> PciUtilsDevice::BarWriteBuffer(
     if (offset + length > bar->size) {
         return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
     }
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciBar,
+                        log::TraceOp::kWrite, offset, length, bdf.Pack(),
+                        bar_index);
+    MetricsTimer timer(metrics_, MetricOp::kBarWrite, length);
     auto* dst = static_cast<uint8_t*>(bar->base) + offset;
-    std::memcpy(dst, buffer, length);
+    auto result = pci::MmioWrite(dst, buffer, length);
+    if (result.IsError()) {
+        timer.SetError();
+    } else if (bar->mapping == pci::BarMapping::kWriteCombining) {
+        pci::MmioFlush();
+    }
+    return result;
+}
+
+core::Result<void> PciUtilsDevice::SetBarMapping(pci::Bdf /*bdf*/,
+                                                 uint8_t bar_index,
+                                                 pci::BarMapping mapping) {
+    if (bar_index > 5) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::lock_guard<core::InstrumentedMutex> lock(bar_mutex_);
+    if (mapping == pci::BarMapping::kWriteCombining) {
+        const auto& resource = BarResourcesLocked()[bar_index];
+        if (!resource.IsImplemented()) {
+            return core::Result<void>::Err(core::ErrorCode::kNotFound);
+        }
+        auto wc_path = FormatSysfsPath(domain_, bus_, device_num_, function_) +
+                       "/resource" + std::to_string(bar_index) + "_wc";
+        if (!resource.IsPrefetchable() ||
+            ::access(wc_path.c_str(), F_OK) != 0) {
+            return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+        }
+    }
+
+    if (mapping == RequestedBarMapping(bar_index)) {
+        return core::Result<void>::Ok();
+    }
+    UnmapBarLocked(bar_index);
+    bar_mappings_[bar_index] = mapping;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> PciUtilsDevice::BarFlush(pci::Bdf /*bdf*/,
+                                            uint8_t bar_index) {
+    if (bar_index > 5) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    pci::MmioFlush();
     return core::Result<void>::Ok();
 }
 
+core::Result<pci::MmioWindow> PciUtilsDevice::GetBarWindow(uint8_t bar_index) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<pci::MmioWindow>::Err(core::ErrorCode::kNotInitialized);
+    }
+    auto bar = EnsureBarMapped(bar_index);
+    if (bar.IsError()) {
+        return core::Result<pci::MmioWindow>::Err(bar.Error());
+    }
+    return core::Result<pci::MmioWindow>::Ok(
+        pci::MmioWindow(bar.Value()->base, bar.Value()->size));
+}
+
+core::Result<void> PciUtilsDevice::MapAllBars() {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    std::lock_guard<core::InstrumentedMutex> lock(bar_mutex_);
+    const auto resources = BarResourcesLocked();
+    for (uint8_t i = 0; i < pci::kBarCount; ++i) {
+        // I/O port BARs have no mmap-able resourceN.
+        if (!resources[i].IsImplemented() || !resources[i].IsMemory()) {
+            continue;
+        }
+        auto bar = EnsureBarMappedLocked(i);
+        if (bar.IsError()) {
+            return core::Result<void>::Err(bar.Error());
+        }
+    }
+    return core::Result<void>::Ok();
+}
+
+// ---------------------------------------------------------------------------
+// Cxl — DVSEC lookups (served from the per-Bdf index)
+// ---------------------------------------------------------------------------
+
+core::Result<std::vector<pci::DvsecHeader>> PciUtilsDevice::EnumerateCxlDvsecs(
+    pci::Bdf bdf) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<std::vector<pci::DvsecHeader>>::Err(
+            core::ErrorCode::kNotInitialized);
+    }
+    std::lock_guard<std::mutex> lock(cap_cache_mutex_);
+    auto index_result = EnsureCxlDvsecIndex(bdf);
+    if (index_result.IsError()) {
+        return core::Result<std::vector<pci::DvsecHeader>>::Err(
+            index_result.Error());
+    }
+    return core::Result<std::vector<pci::DvsecHeader>>::Ok(
+        index_result.Value()->dvsecs);
+}
+
+core::Result<std::optional<pci::DvsecHeader>> PciUtilsDevice::FindCxlDvsec(
+    pci::Bdf bdf, pci::CxlDvsecId dvsec_id) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<std::optional<pci::DvsecHeader>>::Err(
+            core::ErrorCode::kNotInitialized);
+    }
+    std::lock_guard<std::mutex> lock(cap_cache_mutex_);
+    auto index_result = EnsureCxlDvsecIndex(bdf);
+    if (index_result.IsError()) {
+        return core::Result<std::optional<pci::DvsecHeader>>::Err(
+            index_result.Error());
+    }
+    return core::Result<std::optional<pci::DvsecHeader>>::Ok(
+        index_result.Value()->Find(dvsec_id));
+}
+
+core::Result<pci::CxlDeviceType> PciUtilsDevice::GetCxlDeviceType(
+    pci::Bdf bdf) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<pci::CxlDeviceType>::Err(
+            core::ErrorCode::kNotInitialized);
+    }
+    std::lock_guard<std::mutex> lock(cap_cache_mutex_);
+    auto index_result = EnsureCxlDvsecIndex(bdf);
+    if (index_result.IsError()) {
+        return core::Result<pci::CxlDeviceType>::Err(index_result.Error());
+    }
+    return core::Result<pci::CxlDeviceType>::Ok(
+        index_result.Value()->device_type);
+}
+
+core::Result<std::vector<pci::RegisterBlockEntry>>
+PciUtilsDevice::GetRegisterBlocks(pci::Bdf bdf) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<std::vector<pci::RegisterBlockEntry>>::Err(
+            core::ErrorCode::kNotInitialized);
+    }
+    std::lock_guard<std::mutex> lock(cap_cache_mutex_);
+    auto index_result = EnsureCxlDvsecIndex(bdf);
+    if (index_result.IsError()) {
+        return core::Result<std::vector<pci::RegisterBlockEntry>>::Err(
+            index_result.Error());
+    }
+    return core::Result<std::vector<pci::RegisterBlockEntry>>::Ok(
+        index_result.Value()->register_blocks);
+}
+
+core::Result<core::DWord> PciUtilsDevice::ReadDvsecRegister(
+    pci::Bdf bdf, pci::ConfigOffset dvsec_offset, uint16_t reg_offset) {
+    std::size_t offset = std::size_t{dvsec_offset} + reg_offset;
+    if (offset + sizeof(core::DWord) > pci::kConfigSpaceSize) {
+        return core::Result<core::DWord>::Err(core::ErrorCode::kOutOfRange);
+    }
+    return ReadConfig32(bdf, static_cast<pci::ConfigOffset>(offset));
+}
+
+core::Result<void> PciUtilsDevice::WriteDvsecRegister(
+    pci::Bdf bdf, pci::ConfigOffset dvsec_offset, uint16_t reg_offset,
+    core::DWord value) {
+    std::size_t offset = std::size_t{dvsec_offset} + reg_offset;
+    if (offset + sizeof(core::DWord) > pci::kConfigSpaceSize) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+    return WriteConfig32(bdf, static_cast<pci::ConfigOffset>(offset), value);
+}
+
+// ---------------------------------------------------------------------------
+// CxlMailbox — Primary Mailbox over PciBar
+// ---------------------------------------------------------------------------
+
+core::Result<std::shared_ptr<pci::CxlMmioMailbox>>
+PciUtilsDevice::GetCxlMailbox(pci::Bdf bdf) {
+    using R = core::Result<std::shared_ptr<pci::CxlMmioMailbox>>;
+    if (state_ != DeviceState::kOpen) {
+        return R::Err(core::ErrorCode::kNotInitialized);
+    }
+    std::lock_guard<std::mutex> lock(cxl_mailbox_mutex_);
+    auto generation = pci::PciTopology::GetTopologyGeneration();
+    if (generation != cxl_mailboxes_generation_) {
+        cxl_mailboxes_.clear();
+        cxl_mailboxes_generation_ = generation;
+    }
+    auto key = bdf.Pack();
+    auto it = cxl_mailboxes_.find(key);
+    if (it != cxl_mailboxes_.end()) {
+        return R::Ok(it->second);
+    }
+
+    auto location = pci::CxlMmioMailbox::Locate(*this, *this, bdf);
+    if (location.IsError()) {
+        PLAS_LOG_DEVICE_ERROR(name_, "CxlMailbox", "no primary mailbox: " +
+                              location.Error().message());
+        return R::Err(location.Error());
+    }
+    pci::CxlMmioMailboxOptions options;
+    options.timeout = std::chrono::milliseconds(mailbox_timeout_ms_);
+    auto mailbox = std::make_shared<pci::CxlMmioMailbox>(
+        *this, bdf, location.Value(), options);
+    cxl_mailboxes_.emplace(key, mailbox);
+    return R::Ok(std::move(mailbox));
+}
+
+void PciUtilsDevice::ClearCxlMailboxCache() {
+    std::lock_guard<std::mutex> lock(cxl_mailbox_mutex_);
+    cxl_mailboxes_.clear();
+}
+
+core::Result<pci::CxlMailboxResult> PciUtilsDevice::ExecuteCommand(
+    pci::Bdf bdf, pci::CxlMailboxOpcode opcode,
+    const pci::CxlMailboxPayload& payload) {
+    return ExecuteCommand(bdf, static_cast<uint16_t>(opcode), payload);
+}
+
+core::Result<pci::CxlMailboxResult> PciUtilsDevice::ExecuteCommand(
+    pci::Bdf bdf, uint16_t raw_opcode, const pci::CxlMailboxPayload& payload) {
+    auto mailbox = GetCxlMailbox(bdf);
+    if (mailbox.IsError()) {
+        return core::Result<pci::CxlMailboxResult>::Err(mailbox.Error());
+    }
+    auto result = mailbox.Value()->Execute(raw_opcode, payload);
+    if (result.IsError()) {
+        PLAS_LOG_DEVICE_ERROR(name_, "CxlMailbox", "opcode=" +
+                              std::to_string(raw_opcode) + " failed: " +
+                              result.Error().message());
+    }
+    return result;
+}
+
+core::Result<pci::CxlMailboxResult> PciUtilsDevice::ExecuteCommandGather(
+    pci::Bdf bdf, uint16_t raw_opcode, const uint8_t* header,
+    std::size_t header_len, const uint8_t* data, std::size_t data_len) {
+    auto mailbox = GetCxlMailbox(bdf);
+    if (mailbox.IsError()) {
+        return core::Result<pci::CxlMailboxResult>::Err(mailbox.Error());
+    }
+    auto result = mailbox.Value()->Execute(raw_opcode, header, header_len,
+                                           data, data_len);
+    if (result.IsError()) {
+        PLAS_LOG_DEVICE_ERROR(name_, "CxlMailbox", "opcode=" +
+                              std::to_string(raw_opcode) + " failed: " +
+                              result.Error().message());
+    }
+    return result;
+}
+
+core::Result<pci::CxlMailboxPooledResult>
+PciUtilsDevice::ExecuteCommandPooled(pci::Bdf bdf, uint16_t raw_opcode,
+                                     const uint8_t* payload,
+                                     std::size_t length) {
+    auto mailbox = GetCxlMailbox(bdf);
+    if (mailbox.IsError()) {
+        return core::Result<pci::CxlMailboxPooledResult>::Err(mailbox.Error());
+    }
+    auto result = mailbox.Value()->ExecutePooled(raw_opcode, payload, length);
+    if (result.IsError()) {
+        PLAS_LOG_DEVICE_ERROR(name_, "CxlMailbox", "opcode=" +
+                              std::to_string(raw_opcode) + " failed: " +
+                              result.Error().message());
+    }
+    return result;
+}
+
+core::Result<uint32_t> PciUtilsDevice::GetPayloadSize(pci::Bdf bdf) {
+    auto mailbox = GetCxlMailbox(bdf);
+    if (mailbox.IsError()) {
+        return core::Result<uint32_t>::Err(mailbox.Error());
+    }
+    return mailbox.Value()->PayloadSize();
+}
+
+core::Result<bool> PciUtilsDevice::IsReady(pci::Bdf bdf) {
+    auto mailbox = GetCxlMailbox(bdf);
+    if (mailbox.IsError()) {
+        return core::Result<bool>::Err(mailbox.Error());
+    }
+    return mailbox.Value()->IsReady();
+}
+
+core::Result<pci::CxlMailboxResult> PciUtilsDevice::GetBackgroundCmdStatus(
+    pci::Bdf bdf) {
+    auto mailbox = GetCxlMailbox(bdf);
+    if (mailbox.IsError()) {
+        return core::Result<pci::CxlMailboxResult>::Err(mailbox.Error());
+    }
+    auto status = mailbox.Value()->GetBackgroundStatus();
+    if (status.IsError()) {
+        return core::Result<pci::CxlMailboxResult>::Err(status.Error());
+    }
+    pci::CxlMailboxResult result;
+    result.return_code =
+        status.Value().running
+            ? pci::CxlMailboxReturnCode::kBackgroundCmdStarted
+            : status.Value().return_code;
+    result.payload.resize(sizeof(uint64_t));
+    for (std::size_t i = 0; i < result.payload.size(); ++i) {
+        result.payload[i] =
+            static_cast<uint8_t>(status.Value().raw >> (8 * i));
+    }
+    return core::Result<pci::CxlMailboxResult>::Ok(std::move(result));
+}
+
 // ---------------------------------------------------------------------------
 // Self-registration
 // ---------------------------------------------------------------------------
 
 void PciUtilsDevice::Register() {
     DeviceFactory::RegisterDriver(
-        "pciutils", [](const config::DeviceEntry& entry) {
-            return std::make_unique<PciUtilsDevice>(entry);
+        "pciutils", [](const config::DeviceEntry& entry,
+                       const config::DeviceUri& uri) {
+            return std::make_unique<PciUtilsDevice>(entry, uri);
         });
 }
 
@@ -11,6 +11,10 @@ Pmu3Device::Pmu3Device(const config::DeviceEntry& entry)
       state_(DeviceState::kUninitialized),
       handle_(-1) {}
 
+Pmu3Device::~Pmu3Device() {
+    StopSampling();
+}
+
 // ---------------------------------------------------------------------------
 // Device interface
 // ---------------------------------------------------------------------------
@@ -29,6 +33,7 @@ core::Result<void> Pmu3Device::Open() {
 
 core::Result<void> Pmu3Device::Close() {
     PLAS_LOG_INFO("Pmu3Device::Close() [stub] for device '" + name_ + "'");
+    StopSampling();
     handle_ = -1;
     state_ = DeviceState::kClosed;
     return core::Result<void>::Ok();
@@ -104,6 +109,58 @@ core::Result<bool> Pmu3Device::IsPowerOn() {
     return core::Result<bool>::Err(core::ErrorCode::kNotSupported);
 }
 
+core::Result<void> Pmu3Device::StartSampling(const PowerSamplingOptions& options,
+                                             PowerSampleRing& ring) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (capture_.IsRunning()) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+    }
+    auto valid = PowerCapture::Validate(options, ring);
+    if (valid.IsError()) {
+        return valid;
+    }
+    auto begin = BeginCapture(options.rate_hz);
+    if (begin.IsError()) {
+        return begin;
+    }
+    auto result = capture_.Start(options, ring, [this](PowerSample* out, size_t max) {
+        return ReadCaptureBlock(out, max);
+    });
+    if (result.IsError()) {
+        EndCapture();
+    }
+    return result;
+}
+
+core::Result<void> Pmu3Device::StopSampling() {
+    if (!capture_.IsRunning()) {
+        return core::Result<void>::Ok();
+    }
+    auto result = capture_.Stop();
+    EndCapture();
+    return result;
+}
+
+bool Pmu3Device::IsSampling() const {
+    return capture_.IsRunning();
+}
+
+core::Result<void> Pmu3Device::BeginCapture(uint32_t rate_hz) {
+    PLAS_LOG_WARN("PMU3 driver not yet implemented");
+    (void)rate_hz;
+    return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+}
+
+core::Result<size_t> Pmu3Device::ReadCaptureBlock(PowerSample* out, size_t max) {
+    (void)out;
+    (void)max;
+    return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+}
+
+void Pmu3Device::EndCapture() {}
+
 // ---------------------------------------------------------------------------
 // SsdGpio interface
 // ---------------------------------------------------------------------------
@@ -141,6 +198,42 @@ core::Result<bool> Pmu3Device::GetDualPort() {
     return core::Result<bool>::Err(core::ErrorCode::kNotSupported);
 }
 
+// All sideband pins share one SDK GPIO register transaction, so PERST# and
+// CLKREQ# change together rather than one round trip apart.
+core::Result<SsdPinState> Pmu3Device::GetPinState() {
+    PLAS_LOG_WARN("PMU3 driver not yet implemented");
+    return core::Result<SsdPinState>::Err(core::ErrorCode::kNotSupported);
+}
+
+core::Result<void> Pmu3Device::SetPinState(uint8_t mask, uint8_t values) {
+    if ((mask & ~SsdPinState::kAll) != 0) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    PLAS_LOG_WARN("PMU3 driver not yet implemented");
+    (void)values;
+    return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+}
+
+// Edge capture runs on the PMU's GPIO capture timer, so events carry
+// SsdEventClock::kHardware timestamps; SsdPinEventCapture falls back to
+// polling GetPinState() while this reports kNotSupported.
+core::Result<void> Pmu3Device::StartPinEvents(const SsdPinEventOptions& options) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    PLAS_LOG_WARN("PMU3 driver not yet implemented");
+    (void)options;
+    return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+}
+
+core::Result<void> Pmu3Device::StopPinEvents() {
+    return core::Result<void>::Ok();
+}
+
+bool Pmu3Device::IsCapturingPinEvents() const {
+    return false;
+}
+
 // ---------------------------------------------------------------------------
 // Self-registration
 // ---------------------------------------------------------------------------
@@ -0,0 +1,275 @@
+#include "plas/hal/driver/replay/replay_device.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <thread>
+#include <utility>
+
+#include "plas/hal/interface/device_factory.h"
+#include "plas/hal/transaction_proxy.h"
+#include "plas/log/logger.h"
+
+namespace plas::hal::driver {
+
+namespace {
+
+bool IsWrite(TraceOp op) {
+    switch (op) {
+        case TraceOp::kConfigWrite8:
+        case TraceOp::kConfigWrite16:
+        case TraceOp::kConfigWrite32:
+        case TraceOp::kBarWrite32:
+        case TraceOp::kBarWrite64:
+        case TraceOp::kI2cSetBitrate:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// Same op and inputs; `value` is an input only for scalar writes.
+bool Matches(const TraceRecord& record, const TraceRecord& call) {
+    return record.op == call.op && record.target == call.target &&
+           record.offset == call.offset && record.arg == call.arg &&
+           record.length == call.length && record.request == call.request &&
+           (!IsWrite(call.op) || record.value == call.value);
+}
+
+void Wait(std::chrono::nanoseconds duration) {
+    if (duration.count() <= 0) {
+        return;
+    }
+    // As in SimDevice: sleep for the bulk, spin the last stretch.
+    constexpr std::chrono::microseconds kSpin(100);
+    auto deadline = std::chrono::steady_clock::now() + duration;
+    if (duration > 2 * kSpin) {
+        std::this_thread::sleep_for(duration - kSpin);
+    }
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+/// Traces are loaded once per process while any device uses them.
+core::Result<std::shared_ptr<const TraceFile>> LoadTrace(const std::string& path) {
+    using Trace = std::shared_ptr<const TraceFile>;
+    static std::mutex cache_mutex;
+    static std::map<std::string, std::weak_ptr<const TraceFile>> cache;
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    if (auto cached = cache[path].lock()) {
+        return core::Result<Trace>::Ok(std::move(cached));
+    }
+    auto loaded = TraceFile::Load(path);
+    if (loaded.IsError()) {
+        PLAS_LOG_ERROR("ReplayDevice: cannot load trace " + path);
+        return core::Result<Trace>::Err(loaded.Error());
+    }
+    Trace trace = std::make_shared<const TraceFile>(std::move(loaded).Value());
+    cache[path] = trace;
+    return core::Result<Trace>::Ok(std::move(trace));
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Constructor / Destructor
+// ---------------------------------------------------------------------------
+
+ReplayDevice::ReplayDevice(const config::DeviceEntry& entry,
+                           std::shared_ptr<const TraceFile> trace, int device_index,
+                           core::ErrorCode init_error)
+    : entry_(entry), trace_(std::move(trace)), init_error_(init_error) {
+    auto it = entry.args.find("speed");
+    if (it != entry.args.end()) {
+        char* end = nullptr;
+        speed_ = std::strtod(it->second.c_str(), &end);
+        if (it->second.empty() || *end != '\0' || !(speed_ >= 0.0)) {
+            init_error_ = core::ErrorCode::kInvalidArgument;
+        }
+    }
+    it = entry.args.find("loop");
+    if (it != entry.args.end()) {
+        if (it->second == "true") {
+            loop_ = true;
+        } else if (it->second != "false") {
+            init_error_ = core::ErrorCode::kInvalidArgument;
+        }
+    }
+    if (trace_ && device_index >= 0) {
+        for (const auto& record : trace_->records) {
+            if (record.device == static_cast<uint32_t>(device_index)) {
+                records_.push_back(&record);
+            }
+        }
+    }
+    stats_.records = records_.size();
+}
+
+ReplayDevice::~ReplayDevice() = default;
+
+// ---------------------------------------------------------------------------
+// Device interface
+// ---------------------------------------------------------------------------
+
+core::Result<void> ReplayDevice::Init() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != DeviceState::kUninitialized && state_ != DeviceState::kClosed) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (init_error_ != core::ErrorCode::kSuccess) {
+        PLAS_LOG_ERROR("ReplayDevice::Init() failed for device='" + entry_.nickname +
+                       "' uri=" + entry_.uri);
+        return core::Result<void>::Err(init_error_);
+    }
+    state_ = DeviceState::kInitialized;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> ReplayDevice::Open() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != DeviceState::kInitialized && state_ != DeviceState::kClosed) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    state_ = DeviceState::kOpen;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> ReplayDevice::Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyClosed);
+    }
+    state_ = DeviceState::kClosed;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> ReplayDevice::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ == DeviceState::kUninitialized) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    state_ = DeviceState::kInitialized;
+    return core::Result<void>::Ok();
+}
+
+DeviceState ReplayDevice::GetState() const {
+    return state_;
+}
+
+std::string ReplayDevice::GetName() const {
+    return entry_.nickname;
+}
+
+std::string ReplayDevice::GetUri() const {
+    return entry_.uri;
+}
+
+std::string ReplayDevice::GetDriverName() const {
+    return "replay";
+}
+
+// ---------------------------------------------------------------------------
+// Replay
+// ---------------------------------------------------------------------------
+
+ReplayDevice::Stats ReplayDevice::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.position = position_;
+    return stats;
+}
+
+void ReplayDevice::Rewind() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    position_ = 0;
+}
+
+core::Result<const TraceRecord*> ReplayDevice::Replay(const TraceRecord& call) {
+    const TraceRecord* record = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ != DeviceState::kOpen) {
+            return core::Result<const TraceRecord*>::Err(core::ErrorCode::kNotInitialized);
+        }
+        const std::size_t count = records_.size();
+        const std::size_t span = loop_ ? count : count - std::min(position_, count);
+        for (std::size_t step = 0; step < span; ++step) {
+            std::size_t index = (position_ + step) % count;
+            if (Matches(*records_[index], call)) {
+                record = records_[index];
+                stats_.skipped += step;
+                ++stats_.matched;
+                position_ = index + 1;
+                if (loop_ && position_ == count) {
+                    position_ = 0;
+                }
+                break;
+            }
+        }
+        if (record == nullptr) {
+            ++stats_.unmatched;
+            return core::Result<const TraceRecord*>::Err(core::ErrorCode::kNotFound);
+        }
+    }
+    if (speed_ > 0.0) {
+        Wait(std::chrono::nanoseconds(
+            static_cast<int64_t>(static_cast<double>(record->duration_ns) / speed_)));
+    }
+    return core::Result<const TraceRecord*>::Ok(record);
+}
+
+core::Result<void> ReplayDevice::Execute(TraceRecord& call) {
+    auto matched = Replay(call);
+    if (matched.IsError()) {
+        return core::Result<void>::Err(matched.Error());
+    }
+    const TraceRecord& record = *matched.Value();
+    if (record.error != core::ErrorCode::kSuccess) {
+        return core::Result<void>::Err(record.error);
+    }
+    call.value = record.value;
+    call.response = record.response;
+    return core::Result<void>::Ok();
+}
+
+// ---------------------------------------------------------------------------
+// Factory
+// ---------------------------------------------------------------------------
+
+std::unique_ptr<Device> ReplayDevice::Create(const config::DeviceEntry& entry,
+                                             const config::DeviceUri& uri) {
+    auto it = entry.args.find("trace");
+    if (!uri.IsValid() || uri.Scheme() != "replay" || uri.FieldCount() != 2 ||
+        it == entry.args.end()) {
+        return MakeTransactionProxy<ReplayDevice>(0, entry, nullptr, -1,
+                                                  core::ErrorCode::kInvalidArgument);
+    }
+    auto trace = LoadTrace(it->second);
+    if (trace.IsError()) {
+        return MakeTransactionProxy<ReplayDevice>(
+            0, entry, nullptr, -1, static_cast<core::ErrorCode>(trace.Error().value()));
+    }
+    const auto& file = *trace.Value();
+    int index = file.FindDevice(std::string(uri.Field(1)));
+    if (index < 0 || file.devices[static_cast<std::size_t>(index)].driver != uri.Field(0)) {
+        PLAS_LOG_ERROR("ReplayDevice: no device " + std::string(uri.Authority()) +
+                       " in trace " + it->second);
+        return MakeTransactionProxy<ReplayDevice>(0, entry, nullptr, -1,
+                                                  core::ErrorCode::kNotFound);
+    }
+    uint32_t interfaces = file.devices[static_cast<std::size_t>(index)].interfaces;
+    return MakeTransactionProxy<ReplayDevice>(interfaces, entry, std::move(trace).Value(),
+                                              index, core::ErrorCode::kSuccess);
+}
+
+void ReplayDevice::Register() {
+    DeviceFactory::RegisterDriver(
+        "replay", [](const config::DeviceEntry& entry, const config::DeviceUri& uri) {
+            return Create(entry, uri);
+        });
+}
+
+}  // namespace plas::hal::driver
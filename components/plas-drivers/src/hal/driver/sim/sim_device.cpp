@@ -0,0 +1,326 @@
+#include "plas/hal/driver/sim/sim_device.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <thread>
+
+#include "plas/core/deadline.h"
+#include "plas/core/memory_usage.h"
+#include "plas/hal/interface/device_factory.h"
+#include "plas/log/logger.h"
+
+namespace plas::hal::driver {
+
+namespace {
+
+/// FNV-1a, so default seeds are the same on every platform.
+uint64_t HashName(const std::string& text) {
+    uint64_t hash = 1469598103934665603ull;
+    for (char c : text) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+bool ParseDistribution(const std::string& text, SimLatency& out) {
+    if (text == "fixed") {
+        out = SimLatency::kFixed;
+    } else if (text == "uniform") {
+        out = SimLatency::kUniform;
+    } else if (text == "normal") {
+        out = SimLatency::kNormal;
+    } else if (text == "exponential") {
+        out = SimLatency::kExponential;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ParseError(const std::string& text, core::ErrorCode& out) {
+    if (text == "io") {
+        out = core::ErrorCode::kIOError;
+    } else if (text == "timeout") {
+        out = core::ErrorCode::kTimeout;
+    } else if (text == "busy") {
+        out = core::ErrorCode::kBusy;
+    } else if (text == "not_found") {
+        out = core::ErrorCode::kNotFound;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/// Probability in [0, 1]; the whole string must be consumed.
+bool ParseProbability(const std::string& text, double& out) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    if (*end != '\0' || !(value >= 0.0 && value <= 1.0)) {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Constructor / Destructor
+// ---------------------------------------------------------------------------
+
+SimDevice::SimDevice(const config::DeviceEntry& entry)
+    : name_(entry.nickname), uri_(entry.uri) {
+    auto it = entry.args.find("latency_dist");
+    if (it != entry.args.end() && !ParseDistribution(it->second, fault_.distribution)) {
+        args_valid_ = false;
+    }
+    it = entry.args.find("error");
+    if (it != entry.args.end() && !ParseError(it->second, fault_.error)) {
+        args_valid_ = false;
+    }
+    it = entry.args.find("error_rate");
+    if (it != entry.args.end() && !ParseProbability(it->second, fault_.error_rate)) {
+        args_valid_ = false;
+    }
+    it = entry.args.find("open_error_rate");
+    if (it != entry.args.end() && !ParseProbability(it->second, open_error_rate_)) {
+        args_valid_ = false;
+    }
+
+    constexpr uint64_t kMaxLatencyUs = 3600ull * 1000 * 1000;
+    uint64_t latency_us = 0;
+    uint64_t jitter_us = 0;
+    uint64_t open_latency_us = 0;
+    uint64_t seed = HashName(entry.nickname);
+    NumberArg(entry, "latency_us", 10, kMaxLatencyUs, latency_us);
+    NumberArg(entry, "latency_jitter_us", 10, kMaxLatencyUs, jitter_us);
+    NumberArg(entry, "open_latency_us", 10, kMaxLatencyUs, open_latency_us);
+    NumberArg(entry, "seed", 0, ~uint64_t{0}, seed);
+    fault_.latency = std::chrono::microseconds(latency_us);
+    fault_.jitter = std::chrono::microseconds(jitter_us);
+    open_latency_ = std::chrono::microseconds(open_latency_us);
+    rng_.state = seed;
+}
+
+SimDevice::~SimDevice() = default;
+
+void SimDevice::NumberArg(const config::DeviceEntry& entry, const char* key, int base,
+                          uint64_t max, uint64_t& out) {
+    auto it = entry.args.find(key);
+    if (it != entry.args.end() &&
+        !config::DeviceUri::ParseNumber(it->second, base, max, out)) {
+        args_valid_ = false;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Device interface
+// ---------------------------------------------------------------------------
+
+core::Result<void> SimDevice::Init() {
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    if (state_ != DeviceState::kUninitialized && state_ != DeviceState::kClosed) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (!uri_valid_) {
+        PLAS_LOG_ERROR("SimDevice::Init() invalid URI: " + uri_);
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (!args_valid_) {
+        PLAS_LOG_ERROR("SimDevice::Init() invalid args for device='" +
+                       name_ + "'");
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    auto loaded = OnInit();
+    if (loaded.IsError()) {
+        return loaded;
+    }
+    state_ = DeviceState::kInitialized;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> SimDevice::Open() {
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    if (state_ != DeviceState::kInitialized && state_ != DeviceState::kClosed) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    Wait(open_latency_);
+    if (open_error_rate_ > 0.0 &&
+        std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < open_error_rate_) {
+        return core::Result<void>::Err(core::ErrorCode::kIOError);
+    }
+    state_ = DeviceState::kOpen;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> SimDevice::Close() {
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyClosed);
+    }
+    state_ = DeviceState::kClosed;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> SimDevice::Reset() {
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    if (state_ == DeviceState::kUninitialized) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    state_ = DeviceState::kInitialized;
+    return core::Result<void>::Ok();
+}
+
+DeviceState SimDevice::GetState() const {
+    return state_;
+}
+
+std::string SimDevice::GetName() const {
+    return name_;
+}
+
+std::string SimDevice::GetUri() const {
+    return uri_;
+}
+
+std::string SimDevice::GetDriverName() const {
+    return "sim";
+}
+
+std::size_t SimDevice::BaseHeapBytes() const {
+    return core::HeapBytes(name_) + core::HeapBytes(uri_);
+}
+
+// ---------------------------------------------------------------------------
+// Fault model
+// ---------------------------------------------------------------------------
+
+void SimDevice::SetFaultModel(const SimFaultModel& model) {
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    fault_ = model;
+}
+
+SimFaultModel SimDevice::GetFaultModel() const {
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    return fault_;
+}
+
+std::chrono::nanoseconds SimDevice::DrawLatency() {
+    const double mean = static_cast<double>(fault_.latency.count());
+    const double jitter = static_cast<double>(fault_.jitter.count());
+    double ns = mean;
+    switch (fault_.distribution) {
+        case SimLatency::kFixed:
+            break;
+        case SimLatency::kUniform:
+            if (jitter > 0) {
+                ns = std::uniform_real_distribution<double>(mean - jitter,
+                                                            mean + jitter)(rng_);
+            }
+            break;
+        case SimLatency::kNormal:
+            if (jitter > 0) {
+                ns = std::normal_distribution<double>(mean, jitter)(rng_);
+            }
+            break;
+        case SimLatency::kExponential:
+            if (mean > 0) {
+                ns = std::exponential_distribution<double>(1.0 / mean)(rng_);
+            }
+            break;
+    }
+    return std::chrono::nanoseconds(ns > 0 ? static_cast<int64_t>(ns) : 0);
+}
+
+void SimDevice::Wait(std::chrono::nanoseconds duration) {
+    if (duration.count() <= 0) {
+        return;
+    }
+    // Sleep for the bulk, spin the last stretch: sleep_for alone overshoots
+    // short latencies by a scheduler tick.
+    constexpr std::chrono::microseconds kSpin(100);
+    auto deadline = std::chrono::steady_clock::now() + duration;
+    if (duration > 2 * kSpin) {
+        std::this_thread::sleep_for(duration - kSpin);
+    }
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+core::Result<void> SimDevice::Simulate(std::chrono::nanoseconds bus_time) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    operations_.fetch_add(1, std::memory_order_relaxed);
+    auto duration = DrawLatency() + bus_time;
+    auto deadline = core::Deadline::Current();
+    if (deadline.IsSet() && duration > deadline.Remaining()) {
+        // A real transfer would still be on the bus when the caller gives up.
+        Wait(deadline.Remaining());
+        return core::Result<void>::Err(core::ErrorCode::kTimeout);
+    }
+    Wait(duration);
+    if (fault_.error_rate > 0.0 &&
+        std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < fault_.error_rate) {
+        injected_errors_.fetch_add(1, std::memory_order_relaxed);
+        return core::Result<void>::Err(fault_.error);
+    }
+    return core::Result<void>::Ok();
+}
+
+// ---------------------------------------------------------------------------
+// Images
+// ---------------------------------------------------------------------------
+
+core::Result<std::shared_ptr<const std::vector<core::Byte>>> SimDevice::LoadFile(
+    const std::string& path) {
+    using Image = std::shared_ptr<const std::vector<core::Byte>>;
+    // Thousands of simulated devices typically share a handful of dumps.
+    static std::mutex cache_mutex;
+    static std::map<std::string, Image> cache;
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = cache.find(path);
+    if (it != cache.end()) {
+        return core::Result<Image>::Ok(it->second);
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        PLAS_LOG_ERROR("SimDevice: cannot open image " + path);
+        return core::Result<Image>::Err(core::ErrorCode::kNotFound);
+    }
+    auto bytes = std::make_shared<std::vector<core::Byte>>(
+        std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    Image image = std::move(bytes);
+    cache.emplace(path, image);
+    return core::Result<Image>::Ok(std::move(image));
+}
+
+// ---------------------------------------------------------------------------
+// Factory
+// ---------------------------------------------------------------------------
+
+std::unique_ptr<Device> SimDevice::Create(const config::DeviceEntry& entry,
+                                          const config::DeviceUri& uri) {
+    if (uri.IsValid() && uri.Field(0) == "pci") {
+        return std::make_unique<SimPciDevice>(entry, uri);
+    }
+    return std::make_unique<SimI2cDevice>(entry, uri);
+}
+
+void SimDevice::Register() {
+    DeviceFactory::RegisterDriver(
+        "sim", [](const config::DeviceEntry& entry, const config::DeviceUri& uri) {
+            return Create(entry, uri);
+        });
+}
+
+}  // namespace plas::hal::driver
@@ -0,0 +1,228 @@
+#include "plas/hal/driver/sim/sim_device.h"
+
+#include <algorithm>
+
+#include "plas/core/memory_usage.h"
+#include "plas/log/logger.h"
+
+namespace plas::hal::driver {
+
+// ---------------------------------------------------------------------------
+// URI parsing: sim://i2c:address
+// ---------------------------------------------------------------------------
+
+bool SimI2cDevice::ParseUri(const config::DeviceUri& uri, uint16_t& address) {
+    if (!uri.IsValid() || uri.Scheme() != "sim" || uri.FieldCount() != 2 ||
+        uri.Field(0) != "i2c") {
+        return false;
+    }
+    uint64_t value = 0;
+    if (!uri.Number(1, 0, 0x7F, value)) {
+        return false;
+    }
+    address = static_cast<uint16_t>(value);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Constructor
+// ---------------------------------------------------------------------------
+
+SimI2cDevice::SimI2cDevice(const config::DeviceEntry& entry)
+    : SimI2cDevice(entry, config::DeviceUri::Parse(entry.uri)) {}
+
+SimI2cDevice::SimI2cDevice(const config::DeviceEntry& entry,
+                           const config::DeviceUri& uri)
+    : SimDevice(entry) {
+    uri_valid_ = ParseUri(uri, address_);
+
+    uint64_t size = size_;
+    NumberArg(entry, "size", 0, 65536, size);
+    uint64_t addr_bytes = size > 256 ? 2 : 1;
+    NumberArg(entry, "addr_bytes", 10, 2, addr_bytes);
+    uint64_t fill = fill_;
+    NumberArg(entry, "fill", 0, 0xFF, fill);
+    uint64_t bitrate = bitrate_;
+    NumberArg(entry, "bitrate", 10, 100000000, bitrate);
+    if (size == 0 || addr_bytes == 0 || bitrate == 0) {
+        args_valid_ = false;
+    }
+    size_ = static_cast<size_t>(size);
+    addr_bytes_ = static_cast<size_t>(addr_bytes);
+    fill_ = static_cast<core::Byte>(fill);
+    bitrate_ = static_cast<uint32_t>(bitrate);
+
+    auto it = entry.args.find("image");
+    if (it != entry.args.end()) {
+        image_path_ = it->second;
+    }
+    it = entry.args.find("bus_time");
+    if (it != entry.args.end()) {
+        if (it->second == "true") {
+            bus_time_ = true;
+        } else if (it->second != "false") {
+            args_valid_ = false;
+        }
+    }
+}
+
+core::Result<void> SimI2cDevice::OnInit() {
+    regs_.assign(size_, fill_);
+    pointer_ = 0;
+    if (image_path_.empty()) {
+        return core::Result<void>::Ok();
+    }
+    auto image = LoadFile(image_path_);
+    if (image.IsError()) {
+        return core::Result<void>::Err(image.Error());
+    }
+    const auto& bytes = *image.Value();
+    if (bytes.size() > size_) {
+        PLAS_LOG_ERROR("SimI2cDevice: image " + image_path_ + " exceeds size=" +
+                       std::to_string(size_));
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::copy(bytes.begin(), bytes.end(), regs_.begin());
+    return core::Result<void>::Ok();
+}
+
+// ---------------------------------------------------------------------------
+// I2c interface
+// ---------------------------------------------------------------------------
+
+Device* SimI2cDevice::GetDevice() {
+    return this;
+}
+
+std::chrono::nanoseconds SimI2cDevice::BusTime(size_t bytes) const {
+    if (!bus_time_) {
+        return std::chrono::nanoseconds(0);
+    }
+    // 8 data bits + ACK per byte; the address byte is included by callers.
+    uint64_t bits = static_cast<uint64_t>(bytes) * 9;
+    return std::chrono::nanoseconds(bits * 1000000000ull / bitrate_.load());
+}
+
+void SimI2cDevice::WriteLocked(const core::Byte* data, size_t length) {
+    if (length < addr_bytes_) {
+        return;  // pointer not fully sent: no effect
+    }
+    size_t pointer = 0;
+    for (size_t i = 0; i < addr_bytes_; ++i) {
+        pointer = (pointer << 8) | data[i];
+    }
+    pointer_ = pointer % size_;
+    for (size_t i = addr_bytes_; i < length; ++i) {
+        regs_[pointer_] = data[i];
+        pointer_ = (pointer_ + 1) % size_;
+    }
+}
+
+void SimI2cDevice::ReadLocked(core::Byte* data, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        data[i] = regs_[pointer_];
+        pointer_ = (pointer_ + 1) % size_;
+    }
+}
+
+core::Result<size_t> SimI2cDevice::Read(core::Address addr, core::Byte* data,
+                                        size_t length, bool /*stop*/) {
+    if (data == nullptr && length > 0) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    auto sim = Simulate(BusTime(length + 1));
+    if (sim.IsError()) {
+        return core::Result<size_t>::Err(sim.Error());
+    }
+    if (addr != address_) {
+        return core::Result<size_t>::Err(core::ErrorCode::kIOError);
+    }
+    ReadLocked(data, length);
+    return core::Result<size_t>::Ok(length);
+}
+
+core::Result<size_t> SimI2cDevice::Write(core::Address addr,
+                                         const core::Byte* data, size_t length,
+                                         bool /*stop*/) {
+    if (data == nullptr && length > 0) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    auto sim = Simulate(BusTime(length + 1));
+    if (sim.IsError()) {
+        return core::Result<size_t>::Err(sim.Error());
+    }
+    if (addr != address_) {
+        return core::Result<size_t>::Err(core::ErrorCode::kIOError);
+    }
+    WriteLocked(data, length);
+    return core::Result<size_t>::Ok(length);
+}
+
+core::Result<size_t> SimI2cDevice::WriteRead(core::Address addr,
+                                             const core::Byte* write_data,
+                                             size_t write_len,
+                                             core::Byte* read_data,
+                                             size_t read_len) {
+    if ((write_data == nullptr && write_len > 0) ||
+        (read_data == nullptr && read_len > 0)) {
+        return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    // Two address bytes: START and repeated START.
+    auto sim = Simulate(BusTime(write_len + read_len + 2));
+    if (sim.IsError()) {
+        return core::Result<size_t>::Err(sim.Error());
+    }
+    if (addr != address_) {
+        return core::Result<size_t>::Err(core::ErrorCode::kIOError);
+    }
+    WriteLocked(write_data, write_len);
+    ReadLocked(read_data, read_len);
+    return core::Result<size_t>::Ok(read_len);
+}
+
+core::Result<void> SimI2cDevice::SetBitrate(uint32_t bitrate) {
+    if (bitrate == 0) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    bitrate_ = bitrate;
+    return core::Result<void>::Ok();
+}
+
+uint32_t SimI2cDevice::GetBitrate() const {
+    return bitrate_;
+}
+
+// ---------------------------------------------------------------------------
+// Backdoor access
+// ---------------------------------------------------------------------------
+
+std::size_t SimI2cDevice::MemoryUsage() const {
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    return sizeof(*this) + BaseHeapBytes() + core::HeapBytes(image_path_) +
+           core::HeapBytes(regs_);
+}
+
+std::vector<core::Byte> SimI2cDevice::Registers() const {
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    return regs_;
+}
+
+core::Result<void> SimI2cDevice::SetRegisters(size_t offset,
+                                              const core::Byte* data,
+                                              size_t length) {
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    if (regs_.empty()) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if ((data == nullptr && length > 0) || offset > regs_.size() ||
+        length > regs_.size() - offset) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+    std::copy(data, data + length, regs_.begin() + static_cast<std::ptrdiff_t>(offset));
+    return core::Result<void>::Ok();
+}
+
+}  // namespace plas::hal::driver
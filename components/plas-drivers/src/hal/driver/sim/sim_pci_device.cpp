@@ -0,0 +1,379 @@
+#include "plas/hal/driver/sim/sim_device.h"
+
+#include <algorithm>
+#include <string_view>
+
+#include "plas/core/memory_usage.h"
+#include "plas/log/logger.h"
+
+namespace plas::hal::driver {
+
+namespace {
+
+constexpr pci::ConfigOffset kDefaultDoeOffset = 0x100;
+constexpr uint16_t kDefaultVendorId = 0x1234;
+constexpr uint16_t kDefaultDeviceId = 0x0001;
+
+/// Header bytes the device owns: IDs, revision + class code, header type.
+bool IsReadOnly(size_t offset) {
+    return offset < 0x04 || (offset >= 0x08 && offset < 0x0C) || offset == 0x0E;
+}
+
+/// Text dumps are all printable; binary config images practically never are.
+bool IsText(const std::vector<core::Byte>& bytes) {
+    return !bytes.empty() &&
+           std::all_of(bytes.begin(), bytes.end(), [](core::Byte b) {
+               return b == '\n' || b == '\r' || b == '\t' || (b >= 0x20 && b < 0x7F);
+           });
+}
+
+int HexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/// `lspci -xxx` / `-xxxx` rows ("1a0: 00 11 ..."); other lines, such as the
+/// device title, are skipped.
+void ParseLspci(std::string_view text, core::Byte* config, size_t size) {
+    while (!text.empty()) {
+        size_t eol = text.find('\n');
+        std::string_view line = text.substr(0, eol);
+        text = eol == std::string_view::npos ? std::string_view() : text.substr(eol + 1);
+
+        size_t colon = line.find(": ");
+        uint64_t offset = 0;
+        if (colon == std::string_view::npos || colon == 0 ||
+            !config::DeviceUri::ParseNumber(line.substr(0, colon), 16, size - 1, offset)) {
+            continue;
+        }
+        size_t pos = colon + 2;
+        while (pos + 1 < line.size() && offset < size) {
+            int hi = HexDigit(line[pos]);
+            int lo = HexDigit(line[pos + 1]);
+            if (hi < 0 || lo < 0) {
+                break;
+            }
+            config[offset++] = static_cast<core::Byte>((hi << 4) | lo);
+            pos += 3;
+        }
+    }
+}
+
+bool ParseProtocols(const std::string& text, std::vector<pci::DoeProtocolId>& out) {
+    std::string_view rest(text);
+    while (!rest.empty()) {
+        size_t comma = rest.find(',');
+        std::string_view item = rest.substr(0, comma);
+        rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+        size_t colon = item.find(':');
+        uint64_t vendor = 0;
+        uint64_t type = 0;
+        if (colon == std::string_view::npos ||
+            !config::DeviceUri::ParseNumber(item.substr(0, colon), 16, 0xFFFF, vendor) ||
+            !config::DeviceUri::ParseNumber(item.substr(colon + 1), 16, 0xFF, type)) {
+            return false;
+        }
+        out.push_back({static_cast<uint16_t>(vendor), static_cast<uint8_t>(type)});
+    }
+    return true;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// URI parsing: sim://pci:DDDD:BB:dd.f
+// ---------------------------------------------------------------------------
+
+bool SimPciDevice::ParseUri(const config::DeviceUri& uri, pci::Bdf& bdf) {
+    if (!uri.IsValid() || uri.Scheme() != "sim" || uri.FieldCount() != 4 ||
+        uri.Field(0) != "pci") {
+        return false;
+    }
+    auto devfn = uri.Field(3);
+    auto dot = devfn.find('.');
+    if (dot == std::string_view::npos) {
+        return false;
+    }
+    uint64_t domain = 0, bus = 0, dev = 0, fn = 0;
+    if (!uri.Number(1, 16, 0xFFFF, domain) || !uri.Number(2, 16, 0xFF, bus) ||
+        !config::DeviceUri::ParseNumber(devfn.substr(0, dot), 16, 0x1F, dev) ||
+        !config::DeviceUri::ParseNumber(devfn.substr(dot + 1), 16, 0x07, fn)) {
+        return false;
+    }
+    bdf.bus = static_cast<uint8_t>(bus);
+    bdf.device = static_cast<uint8_t>(dev);
+    bdf.function = static_cast<uint8_t>(fn);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Constructor
+// ---------------------------------------------------------------------------
+
+SimPciDevice::SimPciDevice(const config::DeviceEntry& entry)
+    : SimPciDevice(entry, config::DeviceUri::Parse(entry.uri)) {}
+
+SimPciDevice::SimPciDevice(const config::DeviceEntry& entry,
+                           const config::DeviceUri& uri)
+    : SimDevice(entry) {
+    uri_valid_ = ParseUri(uri, bdf_);
+
+    auto it = entry.args.find("config");
+    if (it != entry.args.end()) {
+        config_path_ = it->second;
+    }
+    uint64_t id = 0;
+    if (entry.args.count("vendor_id") != 0) {
+        NumberArg(entry, "vendor_id", 0, 0xFFFF, id);
+        vendor_id_ = static_cast<int32_t>(id);
+    }
+    if (entry.args.count("device_id") != 0) {
+        NumberArg(entry, "device_id", 0, 0xFFFF, id);
+        device_id_ = static_cast<int32_t>(id);
+    }
+
+    it = entry.args.find("doe_protocols");
+    if (it != entry.args.end() && !ParseProtocols(it->second, protocols_)) {
+        args_valid_ = false;
+    }
+    // Discovery is always first, as index 0 of the Discovery walk.
+    const pci::DoeProtocolId discovery{pci::doe_vendor::kPciSig,
+                                       pci::doe_type::kDoeDiscovery};
+    protocols_.erase(std::remove(protocols_.begin(), protocols_.end(), discovery),
+                     protocols_.end());
+    protocols_.insert(protocols_.begin(), discovery);
+}
+
+core::Result<void> SimPciDevice::OnInit() {
+    config_.fill(0);
+    if (!config_path_.empty()) {
+        auto image = LoadFile(config_path_);
+        if (image.IsError()) {
+            return core::Result<void>::Err(image.Error());
+        }
+        const auto& bytes = *image.Value();
+        if (IsText(bytes)) {
+            ParseLspci(std::string_view(reinterpret_cast<const char*>(bytes.data()),
+                                        bytes.size()),
+                       config_.data(), config_.size());
+        } else {
+            std::copy_n(bytes.begin(), std::min(bytes.size(), config_.size()),
+                        config_.begin());
+        }
+    }
+
+    uint16_t vendor = vendor_id_ >= 0 ? static_cast<uint16_t>(vendor_id_)
+                      : config_path_.empty() ? kDefaultVendorId
+                                             : static_cast<uint16_t>(config_[0] | (config_[1] << 8));
+    uint16_t device = device_id_ >= 0 ? static_cast<uint16_t>(device_id_)
+                      : config_path_.empty() ? kDefaultDeviceId
+                                             : static_cast<uint16_t>(config_[2] | (config_[3] << 8));
+    config_[0] = static_cast<core::Byte>(vendor);
+    config_[1] = static_cast<core::Byte>(vendor >> 8);
+    config_[2] = static_cast<core::Byte>(device);
+    config_[3] = static_cast<core::Byte>(device >> 8);
+
+    doe_offsets_ = pci::CapabilityIndex::Parse(config_.data(), config_.size())
+                       .FindAll(pci::ExtCapabilityId::kDoe);
+    if (doe_offsets_.empty()) {
+        auto* header = &config_[kDefaultDoeOffset];
+        if (std::all_of(header, header + 4, [](core::Byte b) { return b == 0; })) {
+            // ID 0x002E, version 1, no next capability.
+            const uint32_t cap = static_cast<uint32_t>(pci::ExtCapabilityId::kDoe) |
+                                 (1u << 16);
+            for (int i = 0; i < 4; ++i) {
+                header[i] = static_cast<core::Byte>(cap >> (8 * i));
+            }
+            doe_offsets_.push_back(kDefaultDoeOffset);
+        } else {
+            PLAS_LOG_WARN("SimPciDevice: no room for a DOE capability in " +
+                          config_path_ + "; DOE disabled");
+        }
+    }
+    return core::Result<void>::Ok();
+}
+
+std::size_t SimPciDevice::MemoryUsage() const {
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    return sizeof(*this) + BaseHeapBytes() + core::HeapBytes(config_path_) +
+           core::HeapBytes(protocols_) + core::HeapBytes(doe_offsets_);
+}
+
+// ---------------------------------------------------------------------------
+// PciConfig interface
+// ---------------------------------------------------------------------------
+
+Device* SimPciDevice::GetDevice() {
+    return this;
+}
+
+template <typename T>
+core::Result<T> SimPciDevice::ReadLocked(pci::Bdf bdf, pci::ConfigOffset offset) {
+    if (offset % sizeof(T) != 0 || offset + sizeof(T) > config_.size()) {
+        return core::Result<T>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    auto sim = Simulate();
+    if (sim.IsError()) {
+        return core::Result<T>::Err(sim.Error());
+    }
+    if (bdf != bdf_) {
+        return core::Result<T>::Ok(static_cast<T>(~T(0)));
+    }
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value = static_cast<T>(value | (static_cast<T>(config_[offset + i]) << (8 * i)));
+    }
+    return core::Result<T>::Ok(value);
+}
+
+template <typename T>
+core::Result<void> SimPciDevice::WriteLocked(pci::Bdf bdf, pci::ConfigOffset offset,
+                                             T value) {
+    if (offset % sizeof(T) != 0 || offset + sizeof(T) > config_.size()) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    auto sim = Simulate();
+    if (sim.IsError() || bdf != bdf_) {
+        return sim;  // writes to an empty slot are dropped
+    }
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        if (!IsReadOnly(offset + i)) {
+            config_[offset + i] = static_cast<core::Byte>(value >> (8 * i));
+        }
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<core::Byte> SimPciDevice::ReadConfig8(pci::Bdf bdf, pci::ConfigOffset offset) {
+    return ReadLocked<core::Byte>(bdf, offset);
+}
+
+core::Result<core::Word> SimPciDevice::ReadConfig16(pci::Bdf bdf, pci::ConfigOffset offset) {
+    return ReadLocked<core::Word>(bdf, offset);
+}
+
+core::Result<core::DWord> SimPciDevice::ReadConfig32(pci::Bdf bdf, pci::ConfigOffset offset) {
+    return ReadLocked<core::DWord>(bdf, offset);
+}
+
+core::Result<void> SimPciDevice::WriteConfig8(pci::Bdf bdf, pci::ConfigOffset offset,
+                                              core::Byte value) {
+    return WriteLocked(bdf, offset, value);
+}
+
+core::Result<void> SimPciDevice::WriteConfig16(pci::Bdf bdf, pci::ConfigOffset offset,
+                                               core::Word value) {
+    return WriteLocked(bdf, offset, value);
+}
+
+core::Result<void> SimPciDevice::WriteConfig32(pci::Bdf bdf, pci::ConfigOffset offset,
+                                               core::DWord value) {
+    return WriteLocked(bdf, offset, value);
+}
+
+/// One operation for the whole walk, as a backend with a capability cache
+/// would take.
+template <typename Id>
+core::Result<std::optional<pci::ConfigOffset>> SimPciDevice::FindLocked(pci::Bdf bdf,
+                                                                        Id id) {
+    using R = core::Result<std::optional<pci::ConfigOffset>>;
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    auto sim = Simulate();
+    if (sim.IsError()) {
+        return R::Err(sim.Error());
+    }
+    if (bdf != bdf_) {
+        return R::Ok(std::nullopt);
+    }
+    return R::Ok(pci::CapabilityIndex::Parse(config_.data(), config_.size()).Find(id));
+}
+
+core::Result<std::optional<pci::ConfigOffset>> SimPciDevice::FindCapability(
+    pci::Bdf bdf, pci::CapabilityId id) {
+    return FindLocked(bdf, id);
+}
+
+core::Result<std::optional<pci::ConfigOffset>> SimPciDevice::FindExtCapability(
+    pci::Bdf bdf, pci::ExtCapabilityId id) {
+    return FindLocked(bdf, id);
+}
+
+// ---------------------------------------------------------------------------
+// PciDoe interface
+// ---------------------------------------------------------------------------
+
+bool SimPciDevice::HasDoe(pci::ConfigOffset offset) const {
+    return std::find(doe_offsets_.begin(), doe_offsets_.end(), offset) !=
+           doe_offsets_.end();
+}
+
+core::Result<std::vector<pci::DoeProtocolId>> SimPciDevice::DoeDiscover(
+    pci::Bdf bdf, pci::ConfigOffset doe_offset) {
+    using ResultType = core::Result<std::vector<pci::DoeProtocolId>>;
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    // One Discovery exchange per protocol, as the hardware walk does.
+    for (size_t i = 0; i < protocols_.size(); ++i) {
+        auto sim = Simulate();
+        if (sim.IsError()) {
+            return ResultType::Err(sim.Error());
+        }
+    }
+    if (bdf != bdf_ || !HasDoe(doe_offset)) {
+        return ResultType::Err(core::ErrorCode::kNotFound);
+    }
+    return ResultType::Ok(protocols_);
+}
+
+core::Result<pci::DoePayload> SimPciDevice::DoeExchange(
+    pci::Bdf bdf, pci::ConfigOffset doe_offset, pci::DoeProtocolId protocol,
+    const pci::DoePayload& request) {
+    using ResultType = core::Result<pci::DoePayload>;
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    auto sim = Simulate();
+    if (sim.IsError()) {
+        return ResultType::Err(sim.Error());
+    }
+    if (bdf != bdf_ || !HasDoe(doe_offset)) {
+        return ResultType::Err(core::ErrorCode::kNotFound);
+    }
+    if (std::find(protocols_.begin(), protocols_.end(), protocol) == protocols_.end()) {
+        return ResultType::Err(core::ErrorCode::kNotSupported);
+    }
+
+    if (protocol == protocols_.front()) {
+        // Discovery: DW0[7:0] is the index; answer vendor | type | next.
+        if (request.empty()) {
+            return ResultType::Err(core::ErrorCode::kInvalidArgument);
+        }
+        size_t index = request[0] & 0xFF;
+        if (index >= protocols_.size()) {
+            return ResultType::Err(core::ErrorCode::kInvalidArgument);
+        }
+        const auto& entry = protocols_[index];
+        size_t next = index + 1 < protocols_.size() ? index + 1 : 0;
+        return ResultType::Ok(pci::DoePayload{
+            static_cast<core::DWord>(entry.vendor_id) |
+            (static_cast<core::DWord>(entry.data_object_type) << 16) |
+            (static_cast<core::DWord>(next) << 24)});
+    }
+    if (responder_) {
+        return responder_(protocol, request);
+    }
+    return ResultType::Ok(request);
+}
+
+void SimPciDevice::SetDoeResponder(DoeResponder responder) {
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    responder_ = std::move(responder);
+}
+
+std::vector<pci::ConfigOffset> SimPciDevice::DoeOffsets() const {
+    std::lock_guard<core::IoQueue> lock(io_queue_);
+    return doe_offsets_;
+}
+
+}  // namespace plas::hal::driver
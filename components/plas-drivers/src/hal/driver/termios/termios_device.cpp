@@ -0,0 +1,470 @@
+#include "plas/hal/driver/termios/termios_device.h"
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <string>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/device_factory.h"
+#include "plas/log/logger.h"
+
+namespace plas::hal::driver {
+
+namespace {
+
+/// termios speed constant for a standard rate; B0 if there is none.
+speed_t SpeedFor(uint32_t baud_rate) {
+    switch (baud_rate) {
+        case 1200: return B1200;
+        case 2400: return B2400;
+        case 4800: return B4800;
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+#ifdef B460800
+        case 460800: return B460800;
+#endif
+#ifdef B921600
+        case 921600: return B921600;
+#endif
+#ifdef B1000000
+        case 1000000: return B1000000;
+#endif
+#ifdef B1500000
+        case 1500000: return B1500000;
+#endif
+#ifdef B2000000
+        case 2000000: return B2000000;
+#endif
+#ifdef B3000000
+        case 3000000: return B3000000;
+#endif
+        default: return B0;
+    }
+}
+
+bool ParseParity(const std::string& text, Parity& out) {
+    if (text == "none") {
+        out = Parity::kNone;
+    } else if (text == "odd") {
+        out = Parity::kOdd;
+    } else if (text == "even") {
+        out = Parity::kEven;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+core::ErrorCode MapErrno(int err) {
+    switch (err) {
+        case ENOENT:
+        case ENODEV:
+        case ENXIO:
+            return core::ErrorCode::kNotFound;
+        case EACCES:
+        case EPERM:
+            return core::ErrorCode::kPermissionDenied;
+        case EBUSY:
+            return core::ErrorCode::kBusy;
+        default:
+            return core::ErrorCode::kIOError;
+    }
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// URI parsing: termios://tty:baud
+// ---------------------------------------------------------------------------
+
+bool TermiosDevice::ParseUri(const config::DeviceUri& uri, std::string& tty,
+                             uint32_t& baud_rate) {
+    if (!uri.IsValid() || uri.Scheme() != "termios" || uri.FieldCount() != 2) {
+        return false;
+    }
+
+    // Node under /dev; no climbing out of it
+    const std::string node(uri.Field(0));
+    if (node.front() == '/' || node.find("..") != std::string::npos) {
+        return false;
+    }
+
+    uint32_t baud = 0;
+    if (!uri.Number(1, 10, baud) || SpeedFor(baud) == B0) {
+        return false;
+    }
+
+    tty = "/dev/" + node;
+    baud_rate = baud;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Constructor / Destructor
+// ---------------------------------------------------------------------------
+
+TermiosDevice::TermiosDevice(const config::DeviceEntry& entry)
+    : TermiosDevice(entry, config::DeviceUri::Parse(entry.uri)) {}
+
+TermiosDevice::TermiosDevice(const config::DeviceEntry& entry,
+                             const config::DeviceUri& uri)
+    : name_(entry.nickname),
+      uri_(entry.uri),
+      state_(DeviceState::kUninitialized),
+      baud_rate_(0),
+      parity_(Parity::kNone),
+      rx_buffer_(64 * 1024),
+      tx_buffer_(16 * 1024),
+      read_timeout_(100),
+      write_timeout_(1000) {
+    uri_valid_ = ParseUri(uri, tty_, baud_rate_);
+
+    // Parse optional config args
+    auto it = entry.args.find("parity");
+    if (it != entry.args.end() && !ParseParity(it->second, parity_)) {
+        args_valid_ = false;
+    }
+
+    auto number = [&](const char* key, uint64_t max, uint64_t& out) {
+        auto arg = entry.args.find(key);
+        if (arg != entry.args.end() &&
+            !config::DeviceUri::ParseNumber(arg->second, 10, max, out)) {
+            args_valid_ = false;
+        }
+    };
+    uint64_t rx = rx_buffer_;
+    uint64_t tx = tx_buffer_;
+    uint64_t read_ms = static_cast<uint64_t>(read_timeout_.count());
+    uint64_t write_ms = static_cast<uint64_t>(write_timeout_.count());
+    number("rx_buffer", uint64_t{1} << 30, rx);
+    number("tx_buffer", uint64_t{1} << 30, tx);
+    number("read_timeout_ms", 3600000, read_ms);
+    number("write_timeout_ms", 3600000, write_ms);
+    if (rx == 0 || tx == 0) {
+        args_valid_ = false;
+    }
+    rx_buffer_ = static_cast<size_t>(rx);
+    tx_buffer_ = static_cast<size_t>(tx);
+    read_timeout_ = std::chrono::milliseconds(read_ms);
+    write_timeout_ = std::chrono::milliseconds(write_ms);
+}
+
+TermiosDevice::~TermiosDevice() {
+    if (state_ == DeviceState::kOpen) {
+        Close();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Device interface
+// ---------------------------------------------------------------------------
+
+core::Result<void> TermiosDevice::Init() {
+    if (state_ != DeviceState::kUninitialized &&
+        state_ != DeviceState::kClosed) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    if (!uri_valid_) {
+        PLAS_LOG_ERROR("TermiosDevice::Init() invalid URI: " + uri_);
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (!args_valid_) {
+        PLAS_LOG_ERROR("TermiosDevice::Init() invalid args for device='" + name_ + "'");
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    PLAS_LOG_INFO("TermiosDevice::Init() tty=" + tty_ +
+                  " baud=" + std::to_string(baud_rate_) +
+                  " device='" + name_ + "'");
+    state_ = DeviceState::kInitialized;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> TermiosDevice::Open() {
+    if (state_ != DeviceState::kInitialized) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+
+    int fd = ::open(tty_.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        const int err = errno;
+        PLAS_LOG_ERROR("TermiosDevice::Open() cannot open " + tty_);
+        return core::Result<void>::Err(MapErrno(err));
+    }
+    fd_ = fd;
+
+    auto applied = ApplyLineSettings();
+    if (applied.IsError()) {
+        ::close(fd_);
+        fd_ = -1;
+        return applied;
+    }
+    ::tcflush(fd_, TCIOFLUSH);  // drop whatever queued before we owned it
+
+    auto started = StartIo();
+    if (started.IsError()) {
+        ::close(fd_);
+        fd_ = -1;
+        return started;
+    }
+    PLAS_LOG_INFO("TermiosDevice::Open() device='" + name_ + "'");
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> TermiosDevice::StartIo() {
+    SerialPortOptions options;
+    options.rx_capacity = rx_buffer_;
+    options.tx_capacity = tx_buffer_;
+    auto port = SerialIoLoop::Shared().AddPort(fd_, std::move(options));
+    if (port.IsError()) {
+        return core::Result<void>::Err(port.Error());
+    }
+    port_ = port.Value();
+    state_ = DeviceState::kOpen;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> TermiosDevice::Close() {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyClosed);
+    }
+
+    // Give queued output a moment to leave; a hung-up tty just fails fast.
+    SerialIoLoop::Shared().Drain(port_, write_timeout_);
+    SerialIoLoop::Shared().RemovePort(port_);
+    ::close(fd_);
+    fd_ = -1;
+    port_ = 0;
+    PLAS_LOG_INFO("TermiosDevice::Close() device='" + name_ + "'");
+    state_ = DeviceState::kClosed;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> TermiosDevice::Reset() {
+    if (state_ == DeviceState::kOpen) {
+        auto result = Close();
+        if (result.IsError()) {
+            return result;
+        }
+    }
+    state_ = DeviceState::kUninitialized;
+    return Init();
+}
+
+DeviceState TermiosDevice::GetState() const {
+    return state_;
+}
+
+std::string TermiosDevice::GetName() const {
+    return name_;
+}
+
+std::string TermiosDevice::GetUri() const {
+    return uri_;
+}
+
+std::string TermiosDevice::GetDriverName() const {
+    return "termios";
+}
+
+Device* TermiosDevice::GetDevice() {
+    return this;
+}
+
+// ---------------------------------------------------------------------------
+// Warm restart
+// ---------------------------------------------------------------------------
+
+core::Result<DeviceHandoff> TermiosDevice::ExportHandoff() {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<DeviceHandoff>::Err(core::ErrorCode::kNotInitialized);
+    }
+    std::lock_guard lock(settings_mutex_);
+    SerialIoLoop::Shared().Drain(port_, write_timeout_);
+    SerialIoLoop::Shared().RemovePort(port_);
+
+    DeviceHandoff handoff;
+    handoff.fds.push_back(fd_);
+    handoff.state = std::to_string(baud_rate_) + " " +
+                    std::to_string(static_cast<int>(parity_));
+    fd_ = -1;
+    port_ = 0;
+    PLAS_LOG_INFO("TermiosDevice::ExportHandoff() device='" + name_ + "'");
+    state_ = DeviceState::kClosed;
+    return core::Result<DeviceHandoff>::Ok(std::move(handoff));
+}
+
+core::Result<void> TermiosDevice::AdoptHandoff(const DeviceHandoff& handoff) {
+    if (state_ != DeviceState::kInitialized) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    unsigned long baud = 0;
+    int parity = 0;
+    if (handoff.fds.size() != 1 ||
+        std::sscanf(handoff.state.c_str(), "%lu %d", &baud, &parity) != 2) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    termios tio{};
+    const int fd = handoff.fds[0];
+    if (::tcgetattr(fd, &tio) != 0 || ::fcntl(fd, F_SETFD, FD_CLOEXEC) != 0) {
+        PLAS_LOG_ERROR("TermiosDevice::AdoptHandoff() fd is not a usable tty");
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    std::lock_guard lock(settings_mutex_);
+    fd_ = fd;
+    if (baud != baud_rate_ || parity != static_cast<int>(parity_)) {
+        auto applied = ApplyLineSettings();
+        if (applied.IsError()) {
+            fd_ = -1;
+            return applied;
+        }
+    }
+    auto started = StartIo();
+    if (started.IsError()) {
+        fd_ = -1;
+        return started;
+    }
+    PLAS_LOG_INFO("TermiosDevice::AdoptHandoff() device='" + name_ + "'");
+    return core::Result<void>::Ok();
+}
+
+// ---------------------------------------------------------------------------
+// Serial / Uart interface
+// ---------------------------------------------------------------------------
+
+core::Result<size_t> TermiosDevice::Read(core::Byte* data, size_t length) {
+    return ReadFor(data, length, read_timeout_);
+}
+
+core::Result<size_t> TermiosDevice::ReadFor(core::Byte* data, size_t length,
+                                            std::chrono::milliseconds timeout) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+    return SerialIoLoop::Shared().Read(port_, data, length, timeout);
+}
+
+core::Result<size_t> TermiosDevice::Write(const core::Byte* data, size_t length) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotInitialized);
+    }
+    return SerialIoLoop::Shared().Write(port_, data, length, write_timeout_);
+}
+
+core::Result<void> TermiosDevice::SetBaudRate(uint32_t baud_rate) {
+    if (SpeedFor(baud_rate) == B0) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::lock_guard lock(settings_mutex_);
+    const uint32_t previous = baud_rate_;
+    baud_rate_ = baud_rate;
+    if (state_ == DeviceState::kOpen) {
+        auto applied = ApplyLineSettings();
+        if (applied.IsError()) {
+            baud_rate_ = previous;
+            return applied;
+        }
+    }
+    return core::Result<void>::Ok();
+}
+
+uint32_t TermiosDevice::GetBaudRate() const {
+    return baud_rate_;
+}
+
+core::Result<void> TermiosDevice::SetParity(Parity parity) {
+    std::lock_guard lock(settings_mutex_);
+    const Parity previous = parity_;
+    parity_ = parity;
+    if (state_ == DeviceState::kOpen) {
+        auto applied = ApplyLineSettings();
+        if (applied.IsError()) {
+            parity_ = previous;
+            return applied;
+        }
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> TermiosDevice::Flush() {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    auto drained = SerialIoLoop::Shared().Drain(port_, write_timeout_);
+    if (drained.IsError()) {
+        return drained;
+    }
+    if (::tcdrain(fd_) != 0 && errno != ENOTTY) {
+        return core::Result<void>::Err(core::ErrorCode::kIOError);
+    }
+    return core::Result<void>::Ok();
+}
+
+size_t TermiosDevice::Available() const {
+    return state_ == DeviceState::kOpen ? SerialIoLoop::Shared().Available(port_) : 0;
+}
+
+core::Result<void> TermiosDevice::SetReadyCallback(std::function<void()> callback) {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    return SerialIoLoop::Shared().SetReadyCallback(port_, std::move(callback));
+}
+
+uint64_t TermiosDevice::RxDropped() const {
+    return state_ == DeviceState::kOpen ? SerialIoLoop::Shared().RxDropped(port_) : 0;
+}
+
+core::Result<void> TermiosDevice::ApplyLineSettings() {
+    termios tio{};
+    if (::tcgetattr(fd_, &tio) != 0) {
+        PLAS_LOG_ERROR("TermiosDevice: " + tty_ + " is not a tty");
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    // Raw 8-bit, no flow control. VMIN=1 so an empty O_NONBLOCK read fails
+    // with EAGAIN; with VMIN=0 it returns 0, which the loop takes for EOF.
+    ::cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~static_cast<tcflag_t>(CSTOPB | CRTSCTS | PARENB | PARODD);
+    if (parity_ != Parity::kNone) {
+        tio.c_cflag |= PARENB;
+        if (parity_ == Parity::kOdd) {
+            tio.c_cflag |= PARODD;
+        }
+    }
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+
+    const speed_t speed = SpeedFor(baud_rate_);
+    if (::cfsetispeed(&tio, speed) != 0 || ::cfsetospeed(&tio, speed) != 0 ||
+        ::tcsetattr(fd_, TCSANOW, &tio) != 0) {
+        PLAS_LOG_ERROR("TermiosDevice: cannot configure " + tty_);
+        return core::Result<void>::Err(core::ErrorCode::kIOError);
+    }
+    return core::Result<void>::Ok();
+}
+
+// ---------------------------------------------------------------------------
+// Registration
+// ---------------------------------------------------------------------------
+
+void TermiosDevice::Register() {
+    DeviceFactory::RegisterDriver(
+        "termios", [](const config::DeviceEntry& entry,
+                      const config::DeviceUri& uri) {
+            return std::make_unique<TermiosDevice>(entry, uri);
+        });
+}
+
+}  // namespace plas::hal::driver
@@ -0,0 +1,1746 @@
+#include "plas/hal/driver/vfio/vfio_device.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Without the VFIO uapi header the driver still builds, but Open() reports
+// kNotSupported.
+#if defined(__has_include)
+#if __has_include(<linux/vfio.h>)
+#define PLAS_VFIO_UAPI 1
+#include <linux/vfio.h>
+#endif
+#endif
+
+#include "plas/core/deadline.h"
+#include "plas/core/error.h"
+#include "plas/hal/interface/device_factory.h"
+#include "plas/hal/interface/pci/mmio_copy.h"
+#include "plas/log/logger.h"
+#include "plas/log/trace.h"
+
+namespace plas::hal::driver {
+
+// ---------------------------------------------------------------------------
+// DOE register offsets (relative to DOE extended capability base)
+// ---------------------------------------------------------------------------
+
+namespace {
+
+namespace doe_reg {
+constexpr pci::ConfigOffset kCapabilities = 0x04;
+constexpr pci::ConfigOffset kControl = 0x08;
+constexpr pci::ConfigOffset kStatus = 0x0C;
+constexpr pci::ConfigOffset kWriteMailbox = 0x10;
+constexpr pci::ConfigOffset kReadMailbox = 0x14;
+}  // namespace doe_reg
+
+namespace doe_cap {
+constexpr uint32_t kInterruptSupport = 1u << 0;
+constexpr uint32_t kMessageShift = 1;  // Interrupt Message Number [11:1]
+constexpr uint32_t kMessageMask = 0x7FF;
+}  // namespace doe_cap
+
+namespace doe_ctrl {
+constexpr uint32_t kAbort = 1u << 0;
+constexpr uint32_t kInterruptEnable = 1u << 1;
+constexpr uint32_t kGo = 1u << 31;
+}  // namespace doe_ctrl
+
+namespace doe_status {
+constexpr uint32_t kBusy = 1u << 0;
+constexpr uint32_t kInterrupt = 1u << 1;  // RW1C
+constexpr uint32_t kError = 1u << 2;
+constexpr uint32_t kReady = 1u << 31;
+}  // namespace doe_status
+
+// Mailbox Capabilities (CXL 3.1 8.2.8.4.3).
+constexpr uint32_t kMailboxIrqCapable = 1u << 5;
+constexpr uint32_t kMailboxMessageShift = 7;  // Interrupt Message Number [10:7]
+constexpr uint32_t kMailboxMessageMask = 0xF;
+
+constexpr pci::ConfigOffset kCommandRegister = 0x04;
+constexpr core::Word kBusMasterEnable = 1u << 2;
+
+/// Vectors wired at most; DOE and mailbox message numbers are small.
+constexpr uint32_t kMaxVectors = 32;
+
+/// Longest single sleep on an interrupt before the status is re-read, in
+/// case the vector is shared or the interrupt was lost.
+constexpr std::chrono::milliseconds kIrqRecheck{10};
+
+/// DMA buffers are mapped from here up. IOVAs are never reused; 2^39 bytes
+/// of allocations fit even the narrowest IOMMU.
+constexpr uint64_t kIovaBase = uint64_t{1} << 32;
+
+/// DOE wait strategy: re-read status without sleeping for the spin window,
+/// then sleep on the completion interrupt if there is one, else with
+/// exponential backoff from 1 us up to the configured poll interval.
+class CompletionWait {
+public:
+    CompletionWait(std::shared_ptr<pci::IrqSignal> irq, uint32_t spin_us,
+                   uint32_t max_interval_us)
+        : irq_(std::move(irq)),
+          start_(std::chrono::steady_clock::now()),
+          spin_(spin_us),
+          max_interval_(max_interval_us),
+          interval_(std::min<uint32_t>(1, max_interval_us)) {}
+
+    /// Call before each status read, so an interrupt raised after the read
+    /// ends the next Wait() at once.
+    void Arm() {
+        if (irq_) {
+            token_ = irq_->Arm();
+        }
+    }
+
+    void Wait(std::chrono::steady_clock::time_point deadline) {
+        auto now = std::chrono::steady_clock::now();
+        if (now - start_ < spin_) {
+            return;
+        }
+        if (irq_) {
+            irq_->Wait(token_, std::min(deadline, now + kIrqRecheck));
+            return;
+        }
+        std::this_thread::sleep_for(interval_);
+        interval_ = std::min(interval_ * 2, max_interval_);
+    }
+
+private:
+    std::shared_ptr<pci::IrqSignal> irq_;
+    uint64_t token_ = 0;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::microseconds spin_;
+    std::chrono::microseconds max_interval_;
+    std::chrono::microseconds interval_;
+};
+
+/// Trace record `extra` field for DOE: vendor id << 8 | object type.
+uint32_t DoeTraceProtocol(pci::DoeProtocolId protocol) {
+    return static_cast<uint32_t>(protocol.vendor_id) << 8 |
+           protocol.data_object_type;
+}
+
+core::ErrorCode MapErrno(int err) {
+    switch (err) {
+        case ENOENT:
+        case ENODEV:
+        case ENXIO:
+            return core::ErrorCode::kNotFound;
+        case EACCES:
+        case EPERM:
+            return core::ErrorCode::kPermissionDenied;
+        case EBUSY:
+            return core::ErrorCode::kBusy;
+        case EINVAL:
+            return core::ErrorCode::kInvalidArgument;
+        case ENOMEM:
+        case ENOSPC:
+            return core::ErrorCode::kOutOfMemory;
+        case ENOTTY:
+        case EOPNOTSUPP:
+            return core::ErrorCode::kNotSupported;
+        default:
+            return core::ErrorCode::kIOError;
+    }
+}
+
+uint32_t ParseU32Arg(const config::DeviceEntry& entry, const char* key,
+                     uint32_t fallback) {
+    auto it = entry.args.find(key);
+    if (it == entry.args.end()) {
+        return fallback;
+    }
+    try {
+        return static_cast<uint32_t>(std::stoul(it->second));
+    } catch (...) {
+        return fallback;  // keep default
+    }
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// VfioContainer — the IOMMU container and group fds, shared with every
+// VfioDmaBuffer mapped in it
+// ---------------------------------------------------------------------------
+
+struct VfioContainer {
+    int container_fd = -1;
+    int group_fd = -1;
+    std::mutex iova_mutex;
+    uint64_t next_iova = kIovaBase;
+
+    ~VfioContainer() {
+        if (group_fd >= 0) {
+            ::close(group_fd);
+        }
+        if (container_fd >= 0) {
+            ::close(container_fd);
+        }
+    }
+
+    uint64_t ReserveIova(uint64_t size, uint64_t align) {
+        std::lock_guard<std::mutex> lock(iova_mutex);
+        uint64_t iova = (next_iova + align - 1) & ~(align - 1);
+        next_iova = iova + size;
+        return iova;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// VfioDmaBuffer
+// ---------------------------------------------------------------------------
+
+VfioDmaBuffer::VfioDmaBuffer(std::shared_ptr<VfioContainer> container,
+                             core::NumaBuffer buffer, uint64_t iova)
+    : container_(std::move(container)),
+      buffer_(std::move(buffer)),
+      iova_(iova) {}
+
+VfioDmaBuffer::~VfioDmaBuffer() {
+    Release();
+}
+
+VfioDmaBuffer::VfioDmaBuffer(VfioDmaBuffer&& other) noexcept
+    : container_(std::move(other.container_)),
+      buffer_(std::move(other.buffer_)),
+      iova_(std::exchange(other.iova_, 0)) {}
+
+VfioDmaBuffer& VfioDmaBuffer::operator=(VfioDmaBuffer&& other) noexcept {
+    if (this != &other) {
+        Release();
+        container_ = std::move(other.container_);
+        buffer_ = std::move(other.buffer_);
+        iova_ = std::exchange(other.iova_, 0);
+    }
+    return *this;
+}
+
+void VfioDmaBuffer::Release() {
+    if (!container_) {
+        return;
+    }
+#ifdef PLAS_VFIO_UAPI
+    // The device must lose access before the pages go back to the system.
+    vfio_iommu_type1_dma_unmap unmap{};
+    unmap.argsz = sizeof(unmap);
+    unmap.iova = iova_;
+    unmap.size = buffer_.Capacity();
+    if (::ioctl(container_->container_fd, VFIO_IOMMU_UNMAP_DMA, &unmap) < 0) {
+        PLAS_LOG_WARN("VfioDmaBuffer: unmap of IOVA " + std::to_string(iova_) +
+                      " failed: " + std::strerror(errno));
+    }
+#endif
+    buffer_ = core::NumaBuffer();
+    container_.reset();
+    iova_ = 0;
+}
+
+// ---------------------------------------------------------------------------
+// URI parsing
+// ---------------------------------------------------------------------------
+
+bool VfioDevice::ParseUri(const config::DeviceUri& uri, uint16_t& domain,
+                          uint8_t& bus, uint8_t& device, uint8_t& function) {
+    // vfio://DDDD:BB:dd.f, all hex
+    if (!uri.IsValid() || uri.Scheme() != "vfio" || uri.FieldCount() != 3) {
+        return false;
+    }
+    auto devfn = uri.Field(2);
+    auto dot = devfn.find('.');
+    if (dot == std::string_view::npos) {
+        return false;
+    }
+
+    uint64_t d = 0, b = 0, dev = 0, f = 0;
+    if (!uri.Number(0, 16, 0xFFFF, d) || !uri.Number(1, 16, 0xFF, b) ||
+        !config::DeviceUri::ParseNumber(devfn.substr(0, dot), 16, 0x1F, dev) ||
+        !config::DeviceUri::ParseNumber(devfn.substr(dot + 1), 16, 0x07, f)) {
+        return false;
+    }
+
+    domain = static_cast<uint16_t>(d);
+    bus = static_cast<uint8_t>(b);
+    device = static_cast<uint8_t>(dev);
+    function = static_cast<uint8_t>(f);
+    return true;
+}
+
+std::string VfioDevice::DeviceName() const {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%04x:%02x:%02x.%x", domain_, bus_,
+                  device_num_, function_);
+    return buf;
+}
+
+// ---------------------------------------------------------------------------
+// Constructor / Destructor
+// ---------------------------------------------------------------------------
+
+VfioDevice::VfioDevice(const config::DeviceEntry& entry)
+    : VfioDevice(entry, config::DeviceUri::Parse(entry.uri)) {}
+
+VfioDevice::VfioDevice(const config::DeviceEntry& entry,
+                       const config::DeviceUri& uri)
+    : name_(entry.nickname),
+      uri_(entry.uri),
+      state_(DeviceState::kUninitialized),
+      domain_(0),
+      bus_(0),
+      device_num_(0),
+      function_(0),
+      sysfs_root_("/sys/bus/pci/devices"),
+      dev_root_("/dev/vfio"),
+      interrupts_(true),
+      doe_timeout_ms_(ParseU32Arg(entry, "doe_timeout_ms", 1000)),
+      doe_poll_interval_us_(ParseU32Arg(entry, "doe_poll_interval_us", 100)),
+      doe_spin_us_(ParseU32Arg(entry, "doe_spin_us", 20)),
+      mailbox_timeout_ms_(ParseU32Arg(entry, "mailbox_timeout_ms", 2000)),
+      numa_node_(-1),
+      device_fd_(-1),
+      irq_index_(0),
+      irq_stop_fd_(-1),
+      trace_id_(0),
+      metrics_(nullptr) {
+    uri_valid_ = ParseUri(uri, domain_, bus_, device_num_, function_);
+
+    auto it = entry.args.find("sysfs_root");
+    if (it != entry.args.end() && !it->second.empty()) {
+        sysfs_root_ = it->second;
+    }
+    it = entry.args.find("dev_root");
+    if (it != entry.args.end() && !it->second.empty()) {
+        dev_root_ = it->second;
+    }
+    it = entry.args.find("interrupts");
+    if (it != entry.args.end()) {
+        interrupts_ = !(it->second == "false" || it->second == "0");
+    }
+}
+
+VfioDevice::~VfioDevice() {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    CloseLocked();
+}
+
+// ---------------------------------------------------------------------------
+// Device lifecycle
+// ---------------------------------------------------------------------------
+
+core::Result<void> VfioDevice::Init() {
+    if (state_ != DeviceState::kUninitialized &&
+        state_ != DeviceState::kClosed) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+    }
+
+    if (!uri_valid_) {
+        PLAS_LOG_ERROR("VfioDevice::Init() invalid URI: " + uri_);
+        state_ = DeviceState::kError;
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    PLAS_LOG_INFO("VfioDevice::Init() " + name_ + " → " + uri_);
+    state_ = DeviceState::kInitialized;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> VfioDevice::Open() {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    if (state_ != DeviceState::kInitialized) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+
+    auto opened = OpenLocked();
+    if (opened.IsError()) {
+        CloseLocked();
+        state_ = DeviceState::kError;
+        return opened;
+    }
+
+    PLAS_LOG_INFO("VfioDevice::Open() " + name_ + ": " +
+                  std::to_string(vectors_.size()) + " interrupt vectors");
+    trace_id_ = log::Tracer::GetInstance().RegisterDevice(name_);
+    metrics_ = MetricsRegistry::GetInstance().GetDeviceMetrics(name_);
+    state_ = DeviceState::kOpen;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> VfioDevice::OpenLocked() {
+#ifndef PLAS_VFIO_UAPI
+    PLAS_LOG_ERROR("VfioDevice::Open() " + name_ +
+                   ": built without <linux/vfio.h>");
+    return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+#else
+    namespace fs = std::filesystem;
+    auto sysfs = fs::path(sysfs_root_) / DeviceName();
+
+    // iommu_group -> .../kernel/iommu_groups/<N>; /dev/vfio/<N> is its node.
+    std::error_code ec;
+    auto group_link = fs::read_symlink(sysfs / "iommu_group", ec);
+    if (ec) {
+        PLAS_LOG_ERROR("VfioDevice::Open() " + name_ + ": " + DeviceName() +
+                       " has no IOMMU group (IOMMU off, or no such function)");
+        return core::Result<void>::Err(core::ErrorCode::kNotFound);
+    }
+    auto group = group_link.filename().string();
+
+    auto container = std::make_shared<VfioContainer>();
+    auto container_path = dev_root_ + "/vfio";
+    container->container_fd = ::open(container_path.c_str(), O_RDWR | O_CLOEXEC);
+    if (container->container_fd < 0) {
+        auto err = MapErrno(errno);
+        PLAS_LOG_ERROR("VfioDevice::Open() cannot open " + container_path +
+                       ": " + std::strerror(errno));
+        return core::Result<void>::Err(err);
+    }
+    if (::ioctl(container->container_fd, VFIO_GET_API_VERSION) !=
+            VFIO_API_VERSION ||
+        ::ioctl(container->container_fd, VFIO_CHECK_EXTENSION,
+                VFIO_TYPE1v2_IOMMU) <= 0) {
+        PLAS_LOG_ERROR("VfioDevice::Open() " + name_ +
+                       ": no VFIO type-1 v2 IOMMU support");
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    auto group_path = dev_root_ + "/" + group;
+    container->group_fd = ::open(group_path.c_str(), O_RDWR | O_CLOEXEC);
+    if (container->group_fd < 0) {
+        auto err = MapErrno(errno);
+        PLAS_LOG_ERROR("VfioDevice::Open() cannot open " + group_path + ": " +
+                       std::strerror(errno) +
+                       " (is the function bound to vfio-pci?)");
+        return core::Result<void>::Err(err);
+    }
+    vfio_group_status status{};
+    status.argsz = sizeof(status);
+    if (::ioctl(container->group_fd, VFIO_GROUP_GET_STATUS, &status) < 0 ||
+        !(status.flags & VFIO_GROUP_FLAGS_VIABLE)) {
+        PLAS_LOG_ERROR("VfioDevice::Open() " + name_ + ": IOMMU group " +
+                       group + " is not viable; bind every function in it "
+                       "to vfio-pci");
+        return core::Result<void>::Err(core::ErrorCode::kBusy);
+    }
+    if (::ioctl(container->group_fd, VFIO_GROUP_SET_CONTAINER,
+                &container->container_fd) < 0 ||
+        ::ioctl(container->container_fd, VFIO_SET_IOMMU, VFIO_TYPE1v2_IOMMU) <
+            0) {
+        auto err = MapErrno(errno);
+        PLAS_LOG_ERROR("VfioDevice::Open() " + name_ +
+                       ": cannot set up the IOMMU container: " +
+                       std::strerror(errno));
+        return core::Result<void>::Err(err);
+    }
+
+    auto device_name = DeviceName();
+    device_fd_ = ::ioctl(container->group_fd, VFIO_GROUP_GET_DEVICE_FD,
+                         device_name.c_str());
+    if (device_fd_ < 0) {
+        auto err = MapErrno(errno);
+        PLAS_LOG_ERROR("VfioDevice::Open() " + name_ + ": no VFIO device " +
+                       device_name + ": " + std::strerror(errno));
+        return core::Result<void>::Err(err);
+    }
+    container_ = std::move(container);
+
+    auto regions = ReadRegions();
+    if (regions.IsError()) {
+        return regions;
+    }
+
+    // MSI/MSI-X messages and DMA are both memory writes by the function.
+    core::Word command = 0;
+    auto read = ConfigRead(kCommandRegister, &command, sizeof(command));
+    if (read.IsError()) {
+        return read;
+    }
+    if (!(command & kBusMasterEnable)) {
+        command |= kBusMasterEnable;
+        auto written = ConfigWrite(kCommandRegister, &command, sizeof(command));
+        if (written.IsError()) {
+            return written;
+        }
+    }
+
+    std::ifstream numa(sysfs / "numa_node");
+    if (!(numa >> numa_node_)) {
+        numa_node_ = -1;
+    }
+
+    if (interrupts_) {
+        SetupInterrupts();
+    }
+    return core::Result<void>::Ok();
+#endif
+}
+
+core::Result<void> VfioDevice::ReadRegions() {
+#ifdef PLAS_VFIO_UAPI
+    auto read_info = [this](uint32_t index, Region& region) {
+        vfio_region_info info{};
+        info.argsz = sizeof(info);
+        info.index = index;
+        if (::ioctl(device_fd_, VFIO_DEVICE_GET_REGION_INFO, &info) < 0) {
+            return core::Result<void>::Err(MapErrno(errno));
+        }
+        region = Region{info.offset, info.size, info.flags, nullptr};
+        return core::Result<void>::Ok();
+    };
+
+    auto config = read_info(VFIO_PCI_CONFIG_REGION_INDEX, config_);
+    if (config.IsError()) {
+        return config;
+    }
+    for (uint32_t i = 0; i < pci::kBarCount; ++i) {
+        auto& bar = bars_[i];
+        auto info = read_info(VFIO_PCI_BAR0_REGION_INDEX + i, bar);
+        if (info.IsError()) {
+            return info;
+        }
+        if (bar.size == 0 || !(bar.flags & VFIO_REGION_INFO_FLAG_MMAP)) {
+            continue;
+        }
+        // Kernels before 4.16 refuse to mmap a BAR holding the MSI-X
+        // table; that BAR then goes through pread/pwrite.
+        void* map = ::mmap(nullptr, static_cast<std::size_t>(bar.size),
+                           PROT_READ | PROT_WRITE, MAP_SHARED, device_fd_,
+                           static_cast<off_t>(bar.offset));
+        if (map != MAP_FAILED) {
+            bar.map = map;
+        } else {
+            PLAS_LOG_DEVICE_DEBUG(name_, "PciBar", "BAR" + std::to_string(i) +
+                                  " not mmap-able, using region reads/writes");
+        }
+    }
+#endif
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> VfioDevice::Close() {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    state_ = DeviceState::kClosed;
+    CloseLocked();
+    PLAS_LOG_INFO("VfioDevice::Close() " + name_);
+    return core::Result<void>::Ok();
+}
+
+void VfioDevice::CloseLocked() {
+    StopInterrupts();
+    {
+        std::lock_guard<std::mutex> lock(cxl_mailbox_mutex_);
+        cxl_mailbox_.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(cap_mutex_);
+        cap_index_.reset();
+        cxl_index_.reset();
+    }
+    for (auto& bar : bars_) {
+        if (bar.map) {
+            ::munmap(bar.map, static_cast<std::size_t>(bar.size));
+        }
+        bar = Region{};
+    }
+    config_ = Region{};
+    if (device_fd_ >= 0) {
+        ::close(device_fd_);
+        device_fd_ = -1;
+    }
+    // DMA buffers still out keep the container (and its mappings) alive.
+    container_.reset();
+}
+
+core::Result<void> VfioDevice::Reset() {
+    PLAS_LOG_INFO("VfioDevice::Reset() " + name_);
+    if (state_ == DeviceState::kOpen) {
+        auto result = Close();
+        if (result.IsError()) {
+            return result;
+        }
+    }
+    return Init();
+}
+
+DeviceState VfioDevice::GetState() const {
+    return state_;
+}
+
+std::string VfioDevice::GetName() const {
+    return name_;
+}
+
+std::string VfioDevice::GetUri() const {
+    return uri_;
+}
+
+std::string VfioDevice::GetDriverName() const {
+    return "vfio";
+}
+
+plas::hal::Device* VfioDevice::GetDevice() {
+    return this;
+}
+
+core::Result<void> VfioDevice::CheckTarget(pci::Bdf bdf) const {
+    if (state_ != DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (!(bdf == pci::Bdf{bus_, device_num_, function_})) {
+        return core::Result<void>::Err(core::ErrorCode::kNotFound);
+    }
+    return core::Result<void>::Ok();
+}
+
+// ---------------------------------------------------------------------------
+// Interrupts — MSI-X/MSI vectors on eventfds
+// ---------------------------------------------------------------------------
+
+void VfioDevice::SetupInterrupts() {
+#ifdef PLAS_VFIO_UAPI
+    for (uint32_t index : {static_cast<uint32_t>(VFIO_PCI_MSIX_IRQ_INDEX),
+                           static_cast<uint32_t>(VFIO_PCI_MSI_IRQ_INDEX)}) {
+        vfio_irq_info info{};
+        info.argsz = sizeof(info);
+        info.index = index;
+        if (::ioctl(device_fd_, VFIO_DEVICE_GET_IRQ_INFO, &info) < 0 ||
+            info.count == 0 || !(info.flags & VFIO_IRQ_INFO_EVENTFD)) {
+            continue;
+        }
+        uint32_t count = std::min(info.count, kMaxVectors);
+
+        std::vector<int> fds;
+        for (uint32_t i = 0; i < count; ++i) {
+            int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (fd < 0) {
+                break;
+            }
+            fds.push_back(fd);
+        }
+        std::vector<char> buffer(sizeof(vfio_irq_set) +
+                                 fds.size() * sizeof(int32_t));
+        auto* set = reinterpret_cast<vfio_irq_set*>(buffer.data());
+        set->argsz = static_cast<uint32_t>(buffer.size());
+        set->flags = VFIO_IRQ_SET_DATA_EVENTFD | VFIO_IRQ_SET_ACTION_TRIGGER;
+        set->index = index;
+        set->start = 0;
+        set->count = static_cast<uint32_t>(fds.size());
+        std::memcpy(set->data, fds.data(), fds.size() * sizeof(int32_t));
+        if (fds.size() != count ||
+            ::ioctl(device_fd_, VFIO_DEVICE_SET_IRQS, set) < 0) {
+            PLAS_LOG_WARN("[" + name_ + "] cannot enable " +
+                          (index == VFIO_PCI_MSIX_IRQ_INDEX ? "MSI-X" : "MSI") +
+                          ": " + std::strerror(errno));
+            for (int fd : fds) {
+                ::close(fd);
+            }
+            continue;
+        }
+
+        irq_index_ = index;
+        irq_fds_ = std::move(fds);
+        for (std::size_t i = 0; i < irq_fds_.size(); ++i) {
+            vectors_.push_back(std::make_shared<pci::IrqSignal>());
+        }
+        irq_stop_fd_ = ::eventfd(0, EFD_CLOEXEC);
+        irq_thread_ = std::thread(&VfioDevice::IrqLoop, this);
+        return;
+    }
+    PLAS_LOG_INFO("[" + name_ + "] no MSI-X/MSI vectors, polling for completion");
+#endif
+}
+
+void VfioDevice::StopInterrupts() {
+    if (irq_thread_.joinable()) {
+        uint64_t one = 1;
+        if (::write(irq_stop_fd_, &one, sizeof(one)) != sizeof(one)) {
+            PLAS_LOG_WARN("[" + name_ + "] cannot wake the interrupt thread");
+        }
+        irq_thread_.join();
+    }
+#ifdef PLAS_VFIO_UAPI
+    if (!irq_fds_.empty() && device_fd_ >= 0) {
+        vfio_irq_set set{};
+        set.argsz = sizeof(set);
+        set.flags = VFIO_IRQ_SET_DATA_NONE | VFIO_IRQ_SET_ACTION_TRIGGER;
+        set.index = irq_index_;
+        set.start = 0;
+        set.count = 0;  // disable every vector of this index
+        ::ioctl(device_fd_, VFIO_DEVICE_SET_IRQS, &set);
+    }
+#endif
+    for (int fd : irq_fds_) {
+        ::close(fd);
+    }
+    irq_fds_.clear();
+    vectors_.clear();
+    if (irq_stop_fd_ >= 0) {
+        ::close(irq_stop_fd_);
+        irq_stop_fd_ = -1;
+    }
+}
+
+void VfioDevice::IrqLoop() {
+    std::vector<pollfd> fds;
+    for (int fd : irq_fds_) {
+        fds.push_back(pollfd{fd, POLLIN, 0});
+    }
+    fds.push_back(pollfd{irq_stop_fd_, POLLIN, 0});
+
+    for (;;) {
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            PLAS_LOG_ERROR("[" + name_ + "] interrupt poll failed: " +
+                           std::strerror(errno));
+            return;
+        }
+        if (fds.back().revents) {
+            return;
+        }
+        for (std::size_t i = 0; i + 1 < fds.size(); ++i) {
+            if (!(fds[i].revents & POLLIN)) {
+                continue;
+            }
+            uint64_t count = 0;
+            if (::read(fds[i].fd, &count, sizeof(count)) == sizeof(count)) {
+                vectors_[i]->Notify();
+            }
+        }
+    }
+}
+
+std::shared_ptr<pci::IrqSignal> VfioDevice::Vector(uint32_t message) const {
+    return message < vectors_.size() ? vectors_[message] : nullptr;
+}
+
+std::size_t VfioDevice::InterruptVectors() const {
+    return vectors_.size();
+}
+
+uint64_t VfioDevice::InterruptCount(std::size_t vector) const {
+    return vector < vectors_.size() ? vectors_[vector]->Count() : 0;
+}
+
+// ---------------------------------------------------------------------------
+// DMA buffers
+// ---------------------------------------------------------------------------
+
+core::Result<VfioDmaBuffer> VfioDevice::AllocateDmaBuffer(std::size_t bytes,
+                                                          bool huge_pages) {
+    using R = core::Result<VfioDmaBuffer>;
+    if (state_ != DeviceState::kOpen) {
+        return R::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (bytes == 0) {
+        return R::Err(core::ErrorCode::kInvalidArgument);
+    }
+#ifndef PLAS_VFIO_UAPI
+    (void)huge_pages;
+    return R::Err(core::ErrorCode::kNotSupported);
+#else
+    auto buffer = core::NumaBuffer::Allocate(bytes, numa_node_, huge_pages);
+    if (buffer.IsError()) {
+        return R::Err(buffer.Error());
+    }
+    uint64_t size = buffer.Value().Capacity();
+    // Keep huge pages huge in the IOMMU too: one entry per 2 MiB.
+    uint64_t align = buffer.Value().Backing() == core::PageBacking::kNormal
+                         ? static_cast<uint64_t>(::sysconf(_SC_PAGESIZE))
+                         : core::kHugePageSize;
+    uint64_t iova = container_->ReserveIova(size, align);
+
+    vfio_iommu_type1_dma_map map{};
+    map.argsz = sizeof(map);
+    map.flags = VFIO_DMA_MAP_FLAG_READ | VFIO_DMA_MAP_FLAG_WRITE;
+    map.vaddr = reinterpret_cast<uint64_t>(buffer.Value().Data());
+    map.iova = iova;
+    map.size = size;
+    if (::ioctl(container_->container_fd, VFIO_IOMMU_MAP_DMA, &map) < 0) {
+        auto err = MapErrno(errno);
+        PLAS_LOG_ERROR("[" + name_ + "] IOMMU mapping of " +
+                       std::to_string(size) + " bytes failed: " +
+                       std::strerror(errno));
+        return R::Err(err);
+    }
+    return R::Ok(VfioDmaBuffer(container_, std::move(buffer.Value()), iova));
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// PciConfig — config region access
+// ---------------------------------------------------------------------------
+
+core::Result<void> VfioDevice::ConfigRead(pci::ConfigOffset offset, void* data,
+                                          std::size_t length) {
+    if (offset + length > config_.size) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+    auto n = ::pread(device_fd_, data, length,
+                     static_cast<off_t>(config_.offset + offset));
+    if (n != static_cast<ssize_t>(length)) {
+        return core::Result<void>::Err(n < 0 ? MapErrno(errno)
+                                             : core::ErrorCode::kIOError);
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> VfioDevice::ConfigWrite(pci::ConfigOffset offset,
+                                           const void* data,
+                                           std::size_t length) {
+    if (offset + length > config_.size) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+    auto n = ::pwrite(device_fd_, data, length,
+                      static_cast<off_t>(config_.offset + offset));
+    if (n != static_cast<ssize_t>(length)) {
+        return core::Result<void>::Err(n < 0 ? MapErrno(errno)
+                                             : core::ErrorCode::kIOError);
+    }
+    return core::Result<void>::Ok();
+}
+
+template <typename T>
+core::Result<T> VfioDevice::ReadConfigValue(pci::Bdf bdf,
+                                            pci::ConfigOffset offset) {
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return core::Result<T>::Err(target.Error());
+    }
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciConfig,
+                        log::TraceOp::kRead, offset, sizeof(T), bdf.Pack());
+    MetricsTimer timer(metrics_, MetricOp::kPciConfigRead, sizeof(T));
+    T value{};
+    auto read = ConfigRead(offset, &value, sizeof(T));
+    if (read.IsError()) {
+        span.SetStatus(read.Error());
+        timer.SetError();
+        return core::Result<T>::Err(read.Error());
+    }
+    return core::Result<T>::Ok(value);
+}
+
+template <typename T>
+core::Result<void> VfioDevice::WriteConfigValue(pci::Bdf bdf,
+                                                pci::ConfigOffset offset,
+                                                T value) {
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return target;
+    }
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciConfig,
+                        log::TraceOp::kWrite, offset, sizeof(T), bdf.Pack());
+    MetricsTimer timer(metrics_, MetricOp::kPciConfigWrite, sizeof(T));
+    auto written = ConfigWrite(offset, &value, sizeof(T));
+    if (written.IsError()) {
+        span.SetStatus(written.Error());
+        timer.SetError();
+    }
+    return written;
+}
+
+core::Result<core::Byte> VfioDevice::ReadConfig8(pci::Bdf bdf,
+                                                 pci::ConfigOffset offset) {
+    return ReadConfigValue<core::Byte>(bdf, offset);
+}
+
+core::Result<core::Word> VfioDevice::ReadConfig16(pci::Bdf bdf,
+                                                  pci::ConfigOffset offset) {
+    return ReadConfigValue<core::Word>(bdf, offset);
+}
+
+core::Result<core::DWord> VfioDevice::ReadConfig32(pci::Bdf bdf,
+                                                   pci::ConfigOffset offset) {
+    return ReadConfigValue<core::DWord>(bdf, offset);
+}
+
+core::Result<void> VfioDevice::WriteConfig8(pci::Bdf bdf,
+                                            pci::ConfigOffset offset,
+                                            core::Byte value) {
+    return WriteConfigValue(bdf, offset, value);
+}
+
+core::Result<void> VfioDevice::WriteConfig16(pci::Bdf bdf,
+                                             pci::ConfigOffset offset,
+                                             core::Word value) {
+    return WriteConfigValue(bdf, offset, value);
+}
+
+core::Result<void> VfioDevice::WriteConfig32(pci::Bdf bdf,
+                                             pci::ConfigOffset offset,
+                                             core::DWord value) {
+    return WriteConfigValue(bdf, offset, value);
+}
+
+core::Result<void> VfioDevice::ReadConfigBlock(pci::Bdf bdf,
+                                               pci::ConfigOffset offset,
+                                               core::Byte* buffer,
+                                               std::size_t length) {
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return target;
+    }
+    if (length == 0) {
+        return core::Result<void>::Ok();
+    }
+    if (!buffer) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (offset >= pci::kConfigSpaceSize ||
+        length > pci::kConfigSpaceSize - offset) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciConfig,
+                        log::TraceOp::kRead, offset, length, bdf.Pack());
+    MetricsTimer timer(metrics_, MetricOp::kPciConfigRead, length);
+    auto read = ConfigRead(offset, buffer, length);
+    if (read.IsError()) {
+        span.SetStatus(read.Error());
+        timer.SetError();
+    }
+    return read;
+}
+
+core::Result<std::vector<core::Byte>> VfioDevice::SnapshotConfig(
+    pci::Bdf bdf) {
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return core::Result<std::vector<core::Byte>>::Err(target.Error());
+    }
+    // The config region is 256 bytes for conventional PCI functions.
+    std::vector<core::Byte> data(static_cast<std::size_t>(
+        std::min<uint64_t>(config_.size, pci::kConfigSpaceSize)));
+    auto result = ReadConfigBlock(bdf, 0, data.data(), data.size());
+    if (result.IsError()) {
+        return core::Result<std::vector<core::Byte>>::Err(result.Error());
+    }
+    return core::Result<std::vector<core::Byte>>::Ok(std::move(data));
+}
+
+// ---------------------------------------------------------------------------
+// PciConfig — capability index (one snapshot, cached until Close)
+// ---------------------------------------------------------------------------
+
+core::Result<void> VfioDevice::EnsureIndexLocked() {
+    if (cap_index_) {
+        return core::Result<void>::Ok();
+    }
+    auto snapshot = SnapshotConfig(pci::Bdf{bus_, device_num_, function_});
+    if (snapshot.IsError()) {
+        return core::Result<void>::Err(snapshot.Error());
+    }
+    const auto& data = snapshot.Value();
+    cap_index_ = pci::CapabilityIndex::Parse(data.data(), data.size());
+    cxl_index_ =
+        pci::CxlDvsecIndex::Parse(data.data(), data.size(), *cap_index_);
+    return core::Result<void>::Ok();
+}
+
+core::Result<std::optional<pci::ConfigOffset>> VfioDevice::FindCapability(
+    pci::Bdf bdf, pci::CapabilityId id) {
+    using R = core::Result<std::optional<pci::ConfigOffset>>;
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return R::Err(target.Error());
+    }
+    std::lock_guard<std::mutex> lock(cap_mutex_);
+    auto index = EnsureIndexLocked();
+    if (index.IsError()) {
+        return R::Err(index.Error());
+    }
+    return R::Ok(cap_index_->Find(id));
+}
+
+core::Result<std::optional<pci::ConfigOffset>> VfioDevice::FindExtCapability(
+    pci::Bdf bdf, pci::ExtCapabilityId id) {
+    using R = core::Result<std::optional<pci::ConfigOffset>>;
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return R::Err(target.Error());
+    }
+    std::lock_guard<std::mutex> lock(cap_mutex_);
+    auto index = EnsureIndexLocked();
+    if (index.IsError()) {
+        return R::Err(index.Error());
+    }
+    return R::Ok(cap_index_->Find(id));
+}
+
+core::Result<pci::CapabilityIndex> VfioDevice::GetCapabilityIndex(
+    pci::Bdf bdf) {
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return core::Result<pci::CapabilityIndex>::Err(target.Error());
+    }
+    std::lock_guard<std::mutex> lock(cap_mutex_);
+    auto index = EnsureIndexLocked();
+    if (index.IsError()) {
+        return core::Result<pci::CapabilityIndex>::Err(index.Error());
+    }
+    return core::Result<pci::CapabilityIndex>::Ok(*cap_index_);
+}
+
+// ---------------------------------------------------------------------------
+// DOE helpers
+// ---------------------------------------------------------------------------
+
+core::IoQueue& VfioDevice::DoeMailboxQueue(pci::ConfigOffset doe_offset) {
+    std::lock_guard<core::InstrumentedMutex> lock(doe_mutex_);
+    auto& queue = doe_mailbox_queues_[doe_offset];
+    if (!queue) {
+        queue = std::make_unique<core::IoQueue>("vfio.doe");
+    }
+    return *queue;
+}
+
+core::Result<core::DWord> VfioDevice::DoeReadReg(pci::ConfigOffset offset) {
+    core::DWord value = 0;
+    auto read = ConfigRead(offset, &value, sizeof(value));
+    if (read.IsError()) {
+        return core::Result<core::DWord>::Err(read.Error());
+    }
+    return core::Result<core::DWord>::Ok(value);
+}
+
+core::Result<void> VfioDevice::DoeWriteReg(pci::ConfigOffset offset,
+                                           core::DWord value) {
+    return ConfigWrite(offset, &value, sizeof(value));
+}
+
+std::shared_ptr<pci::IrqSignal> VfioDevice::DoeVector(
+    pci::ConfigOffset doe_offset) {
+    if (vectors_.empty()) {
+        return nullptr;
+    }
+    auto caps = DoeReadReg(doe_offset + doe_reg::kCapabilities);
+    if (caps.IsError() || !(caps.Value() & doe_cap::kInterruptSupport)) {
+        return nullptr;
+    }
+    return Vector((caps.Value() >> doe_cap::kMessageShift) &
+                  doe_cap::kMessageMask);
+}
+
+core::Result<void> VfioDevice::DoeAbort(pci::ConfigOffset doe_offset) {
+    auto aborted = DoeWriteReg(doe_offset + doe_reg::kControl, doe_ctrl::kAbort);
+    if (aborted.IsError()) {
+        return aborted;
+    }
+
+    // Poll until abort completes (Busy clears).
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(doe_timeout_ms_);
+    CompletionWait wait(nullptr, doe_spin_us_, doe_poll_interval_us_);
+    while (std::chrono::steady_clock::now() < deadline) {
+        auto status = DoeReadReg(doe_offset + doe_reg::kStatus);
+        if (status.IsError()) {
+            return core::Result<void>::Err(status.Error());
+        }
+        if (!(status.Value() & doe_status::kBusy)) {
+            return core::Result<void>::Ok();
+        }
+        wait.Wait(deadline);
+    }
+    return core::Result<void>::Err(core::ErrorCode::kTimeout);
+}
+
+core::Result<void> VfioDevice::DoeSubmit(pci::ConfigOffset doe_offset,
+                                         pci::DoeProtocolId protocol,
+                                         const core::DWord* payload,
+                                         std::size_t payload_len) {
+    // Data object length includes the 2-DWord header; 2^18 encodes as 0.
+    if (payload_len > (1u << 18) - 2) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    auto status = DoeReadReg(doe_offset + doe_reg::kStatus);
+    if (status.IsError()) {
+        return core::Result<void>::Err(status.Error());
+    }
+    if (status.Value() & doe_status::kBusy) {
+        auto aborted = DoeAbort(doe_offset);
+        if (aborted.IsError()) {
+            return aborted;
+        }
+    }
+
+    // DW0: [15:0]=VendorID, [23:16]=DataObjectType; DW1: [17:0]=Length.
+    core::DWord header[2] = {
+        (static_cast<uint32_t>(protocol.data_object_type) << 16) |
+            protocol.vendor_id,
+        static_cast<uint32_t>(2 + payload_len) & 0x0003FFFF};
+    for (core::DWord dw : header) {
+        auto written = DoeWriteReg(doe_offset + doe_reg::kWriteMailbox, dw);
+        if (written.IsError()) {
+            return written;
+        }
+    }
+    for (std::size_t i = 0; i < payload_len; ++i) {
+        auto written =
+            DoeWriteReg(doe_offset + doe_reg::kWriteMailbox, payload[i]);
+        if (written.IsError()) {
+            return written;
+        }
+    }
+
+    auto irq = DoeVector(doe_offset);
+    auto go = DoeWriteReg(doe_offset + doe_reg::kControl,
+                          doe_ctrl::kGo |
+                              (irq ? doe_ctrl::kInterruptEnable : 0));
+    if (go.IsError()) {
+        return go;
+    }
+
+    // The caller's deadline may cut the wait short; the mailbox is then
+    // left busy and the next DoeSubmit aborts it.
+    auto timeout = std::chrono::steady_clock::now() +
+                   std::chrono::milliseconds(doe_timeout_ms_);
+    auto deadline = core::Deadline::Current().Clamp(timeout);
+    CompletionWait wait(irq, doe_spin_us_, doe_poll_interval_us_);
+    for (;;) {
+        wait.Arm();
+        auto st = DoeReadReg(doe_offset + doe_reg::kStatus);
+        if (st.IsError()) {
+            return core::Result<void>::Err(st.Error());
+        }
+        if (st.Value() & doe_status::kError) {
+            return core::Result<void>::Err(core::ErrorCode::kIOError);
+        }
+        if (st.Value() & doe_status::kReady) {
+            if (irq) {
+                // Clear Interrupt Status so the next object raises one.
+                DoeWriteReg(doe_offset + doe_reg::kStatus,
+                            doe_status::kInterrupt);
+            }
+            return core::Result<void>::Ok();
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+        wait.Wait(deadline);
+    }
+    if (deadline < timeout) {
+        PLAS_LOG_DEVICE_WARN(name_, "PciDoe", "response not ready by the caller's deadline");
+    } else {
+        PLAS_LOG_DEVICE_WARN(name_, "PciDoe", "response timed out after " +
+                             std::to_string(doe_timeout_ms_) + " ms");
+    }
+    return core::Result<void>::Err(core::ErrorCode::kTimeout);
+}
+
+core::Result<std::size_t> VfioDevice::DoeReadHeader(
+    pci::ConfigOffset doe_offset) {
+    // Each DWord is read, then acknowledged by a write to the Read Data
+    // Mailbox, which advances the device to the next one.
+    core::DWord dw1 = 0;
+    for (int i = 0; i < 2; ++i) {
+        auto dw = DoeReadReg(doe_offset + doe_reg::kReadMailbox);
+        if (dw.IsError()) {
+            return core::Result<std::size_t>::Err(dw.Error());
+        }
+        dw1 = dw.Value();
+        DoeWriteReg(doe_offset + doe_reg::kReadMailbox, 0);
+    }
+
+    // Length field: bits [17:0] of DW1, header included. 0 means 2^18.
+    uint32_t length = dw1 & 0x0003FFFF;
+    if (length == 0) {
+        length = (1u << 18);
+    }
+    if (length < 2) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kDataLoss);
+    }
+    return core::Result<std::size_t>::Ok(length - 2);
+}
+
+core::Result<std::size_t> VfioDevice::DoeReadInto(pci::ConfigOffset doe_offset,
+                                                  core::DWord* out,
+                                                  std::size_t capacity) {
+    auto len = DoeReadHeader(doe_offset);
+    if (len.IsError()) {
+        return len;
+    }
+    if (len.Value() > capacity) {
+        // Leave the mailbox idle for the next exchange.
+        DoeAbort(doe_offset);
+        return core::Result<std::size_t>::Err(core::ErrorCode::kOverflow);
+    }
+    for (std::size_t i = 0; i < len.Value(); ++i) {
+        auto dw = DoeReadReg(doe_offset + doe_reg::kReadMailbox);
+        if (dw.IsError()) {
+            return core::Result<std::size_t>::Err(dw.Error());
+        }
+        out[i] = dw.Value();
+        DoeWriteReg(doe_offset + doe_reg::kReadMailbox, 0);
+    }
+    return len;
+}
+
+// ---------------------------------------------------------------------------
+// PciDoe
+// ---------------------------------------------------------------------------
+
+core::Result<std::vector<pci::DoeProtocolId>> VfioDevice::DoeDiscover(
+    pci::Bdf bdf, pci::ConfigOffset doe_offset) {
+    using R = core::Result<std::vector<pci::DoeProtocolId>>;
+    std::lock_guard<core::IoQueue> lock(DoeMailboxQueue(doe_offset));
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return R::Err(target.Error());
+    }
+
+    const pci::DoeProtocolId discovery{pci::doe_vendor::kPciSig,
+                                       pci::doe_type::kDoeDiscovery};
+    std::vector<pci::DoeProtocolId> protocols;
+    uint8_t discovery_index = 0;
+    while (true) {
+        // Discovery request payload: index in bits [7:0].
+        core::DWord request = discovery_index;
+        auto submit = DoeSubmit(doe_offset, discovery, &request, 1);
+        if (submit.IsError()) {
+            return R::Err(submit.Error());
+        }
+        core::DWord response = 0;
+        auto resp = DoeReadInto(doe_offset, &response, 1);
+        if (resp.IsError()) {
+            return R::Err(resp.Error());
+        }
+        if (resp.Value() < 1) {
+            return R::Err(core::ErrorCode::kDataLoss);
+        }
+
+        pci::DoeProtocolId proto;
+        proto.vendor_id = static_cast<uint16_t>(response & 0xFFFF);
+        proto.data_object_type = static_cast<uint8_t>((response >> 16) & 0xFF);
+        protocols.push_back(proto);
+
+        auto next_index = static_cast<uint8_t>((response >> 24) & 0xFF);
+        if (next_index == 0) {
+            break;  // last entry
+        }
+        discovery_index = next_index;
+    }
+    return R::Ok(std::move(protocols));
+}
+
+core::Result<pci::DoePayload> VfioDevice::DoeExchange(
+    pci::Bdf bdf, pci::ConfigOffset doe_offset, pci::DoeProtocolId protocol,
+    const pci::DoePayload& request) {
+    using R = core::Result<pci::DoePayload>;
+    std::lock_guard<core::IoQueue> lock(DoeMailboxQueue(doe_offset));
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return R::Err(target.Error());
+    }
+
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciDoe,
+                        log::TraceOp::kExchange, doe_offset, request.size(),
+                        bdf.Pack(), DoeTraceProtocol(protocol));
+    MetricsTimer timer(metrics_, MetricOp::kDoeExchange);
+    auto submit =
+        DoeSubmit(doe_offset, protocol, request.data(), request.size());
+    if (submit.IsError()) {
+        span.SetStatus(submit.Error());
+        timer.SetError();
+        return R::Err(submit.Error());
+    }
+    auto len = DoeReadHeader(doe_offset);
+    if (len.IsError()) {
+        span.SetStatus(len.Error());
+        timer.SetError();
+        return R::Err(len.Error());
+    }
+    pci::DoePayload response(len.Value());
+    for (auto& dw : response) {
+        auto value = DoeReadReg(doe_offset + doe_reg::kReadMailbox);
+        if (value.IsError()) {
+            span.SetStatus(value.Error());
+            timer.SetError();
+            return R::Err(value.Error());
+        }
+        dw = value.Value();
+        DoeWriteReg(doe_offset + doe_reg::kReadMailbox, 0);
+    }
+    timer.SetBytes((request.size() + response.size()) * sizeof(core::DWord));
+    return R::Ok(std::move(response));
+}
+
+core::Result<std::size_t> VfioDevice::DoeExchangeInto(
+    pci::Bdf bdf, pci::ConfigOffset doe_offset, pci::DoeProtocolId protocol,
+    const core::DWord* request, std::size_t request_len,
+    core::DWord* response, std::size_t response_capacity) {
+    if ((request_len > 0 && !request) || (response_capacity > 0 && !response)) {
+        return core::Result<std::size_t>::Err(
+            core::ErrorCode::kInvalidArgument);
+    }
+    std::lock_guard<core::IoQueue> lock(DoeMailboxQueue(doe_offset));
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return core::Result<std::size_t>::Err(target.Error());
+    }
+
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciDoe,
+                        log::TraceOp::kExchange, doe_offset, request_len,
+                        bdf.Pack(), DoeTraceProtocol(protocol));
+    MetricsTimer timer(metrics_, MetricOp::kDoeExchange);
+    auto submit = DoeSubmit(doe_offset, protocol, request, request_len);
+    if (submit.IsError()) {
+        span.SetStatus(submit.Error());
+        timer.SetError();
+        return core::Result<std::size_t>::Err(submit.Error());
+    }
+    auto response_result = DoeReadInto(doe_offset, response, response_capacity);
+    if (response_result.IsError()) {
+        span.SetStatus(response_result.Error());
+        timer.SetError();
+    } else {
+        timer.SetBytes((request_len + response_result.Value()) *
+                       sizeof(core::DWord));
+    }
+    return response_result;
+}
+
+// ---------------------------------------------------------------------------
+// PciBar — mmap'd BARs directly, the rest through the region
+// ---------------------------------------------------------------------------
+
+core::Result<const VfioDevice::Region*> VfioDevice::BarRegion(
+    uint8_t bar_index, uint64_t offset, std::size_t length) const {
+    if (bar_index >= pci::kBarCount) {
+        return core::Result<const Region*>::Err(
+            core::ErrorCode::kInvalidArgument);
+    }
+    const Region& bar = bars_[bar_index];
+    if (bar.size == 0) {
+        return core::Result<const Region*>::Err(core::ErrorCode::kNotFound);
+    }
+    if (offset > bar.size || length > bar.size - offset) {
+        return core::Result<const Region*>::Err(core::ErrorCode::kOutOfRange);
+    }
+    return core::Result<const Region*>::Ok(&bar);
+}
+
+core::Result<pci::MmioWindow> VfioDevice::GetBarWindow(uint8_t bar_index) {
+    auto target = CheckTarget(pci::Bdf{bus_, device_num_, function_});
+    if (target.IsError()) {
+        return core::Result<pci::MmioWindow>::Err(target.Error());
+    }
+    auto region = BarRegion(bar_index, 0, 0);
+    if (region.IsError()) {
+        return core::Result<pci::MmioWindow>::Err(region.Error());
+    }
+    const Region* bar = region.Value();
+    if (!bar->map) {
+        return core::Result<pci::MmioWindow>::Err(core::ErrorCode::kNotSupported);
+    }
+    return core::Result<pci::MmioWindow>::Ok(pci::MmioWindow(bar->map, bar->size));
+}
+
+core::Result<void> VfioDevice::BarRead(pci::Bdf bdf, uint8_t bar_index,
+                                       uint64_t offset, void* data,
+                                       std::size_t length) {
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return target;
+    }
+    auto region = BarRegion(bar_index, offset, length);
+    if (region.IsError()) {
+        PLAS_LOG_DEVICE_ERROR(name_, "PciBar", "read bar=" +
+                              std::to_string(bar_index) + " offset=" +
+                              std::to_string(offset) + " failed: " +
+                              region.Error().message());
+        return core::Result<void>::Err(region.Error());
+    }
+    const Region* bar = region.Value();
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciBar,
+                        log::TraceOp::kRead, offset, length, bdf.Pack(),
+                        bar_index);
+    MetricsTimer timer(metrics_, MetricOp::kBarRead, length);
+    if (bar->map) {
+        auto* src = static_cast<uint8_t*>(bar->map) + offset;
+        if (length == sizeof(uint32_t)) {
+            auto value = *reinterpret_cast<volatile uint32_t*>(src);
+            std::memcpy(data, &value, sizeof(value));
+        } else if (length == sizeof(uint64_t)) {
+            auto value = *reinterpret_cast<volatile uint64_t*>(src);
+            std::memcpy(data, &value, sizeof(value));
+        } else {
+            auto read = pci::MmioRead(src, data, length);
+            if (read.IsError()) {
+                timer.SetError();
+            }
+            return read;
+        }
+        return core::Result<void>::Ok();
+    }
+    auto n = ::pread(device_fd_, data, length,
+                     static_cast<off_t>(bar->offset + offset));
+    if (n != static_cast<ssize_t>(length)) {
+        auto err = n < 0 ? MapErrno(errno) : core::ErrorCode::kIOError;
+        span.SetStatus(core::make_error_code(err));
+        timer.SetError();
+        return core::Result<void>::Err(err);
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> VfioDevice::BarWrite(pci::Bdf bdf, uint8_t bar_index,
+                                        uint64_t offset, const void* data,
+                                        std::size_t length) {
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return target;
+    }
+    auto region = BarRegion(bar_index, offset, length);
+    if (region.IsError()) {
+        PLAS_LOG_DEVICE_ERROR(name_, "PciBar", "write bar=" +
+                              std::to_string(bar_index) + " offset=" +
+                              std::to_string(offset) + " failed: " +
+                              region.Error().message());
+        return core::Result<void>::Err(region.Error());
+    }
+    const Region* bar = region.Value();
+    log::TraceSpan span(trace_id_, log::TraceInterface::kPciBar,
+                        log::TraceOp::kWrite, offset, length, bdf.Pack(),
+                        bar_index);
+    MetricsTimer timer(metrics_, MetricOp::kBarWrite, length);
+    if (bar->map) {
+        auto* dst = static_cast<uint8_t*>(bar->map) + offset;
+        if (length == sizeof(uint32_t)) {
+            uint32_t value;
+            std::memcpy(&value, data, sizeof(value));
+            *reinterpret_cast<volatile uint32_t*>(dst) = value;
+        } else if (length == sizeof(uint64_t)) {
+            uint64_t value;
+            std::memcpy(&value, data, sizeof(value));
+            *reinterpret_cast<volatile uint64_t*>(dst) = value;
+        } else {
+            auto written = pci::MmioWrite(dst, data, length);
+            if (written.IsError()) {
+                timer.SetError();
+            }
+            return written;
+        }
+        return core::Result<void>::Ok();
+    }
+    auto n = ::pwrite(device_fd_, data, length,
+                      static_cast<off_t>(bar->offset + offset));
+    if (n != static_cast<ssize_t>(length)) {
+        auto err = n < 0 ? MapErrno(errno) : core::ErrorCode::kIOError;
+        span.SetStatus(core::make_error_code(err));
+        timer.SetError();
+        return core::Result<void>::Err(err);
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<core::DWord> VfioDevice::BarRead32(pci::Bdf bdf,
+                                                uint8_t bar_index,
+                                                uint64_t offset) {
+    core::DWord value = 0;
+    auto read = BarRead(bdf, bar_index, offset, &value, sizeof(value));
+    if (read.IsError()) {
+        return core::Result<core::DWord>::Err(read.Error());
+    }
+    return core::Result<core::DWord>::Ok(value);
+}
+
+core::Result<core::QWord> VfioDevice::BarRead64(pci::Bdf bdf,
+                                                uint8_t bar_index,
+                                                uint64_t offset) {
+    core::QWord value = 0;
+    auto read = BarRead(bdf, bar_index, offset, &value, sizeof(value));
+    if (read.IsError()) {
+        return core::Result<core::QWord>::Err(read.Error());
+    }
+    return core::Result<core::QWord>::Ok(value);
+}
+
+core::Result<void> VfioDevice::BarWrite32(pci::Bdf bdf, uint8_t bar_index,
+                                          uint64_t offset, core::DWord value) {
+    return BarWrite(bdf, bar_index, offset, &value, sizeof(value));
+}
+
+core::Result<void> VfioDevice::BarWrite64(pci::Bdf bdf, uint8_t bar_index,
+                                          uint64_t offset, core::QWord value) {
+    return BarWrite(bdf, bar_index, offset, &value, sizeof(value));
+}
+
+core::Result<void> VfioDevice::BarReadBuffer(pci::Bdf bdf, uint8_t bar_index,
+                                             uint64_t offset, void* buffer,
+                                             std::size_t length) {
+    if (!buffer || length == 0) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    return BarRead(bdf, bar_index, offset, buffer, length);
+}
+
+core::Result<void> VfioDevice::BarWriteBuffer(pci::Bdf bdf, uint8_t bar_index,
+                                              uint64_t offset,
+                                              const void* buffer,
+                                              std::size_t length) {
+    if (!buffer || length == 0) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    return BarWrite(bdf, bar_index, offset, buffer, length);
+}
+
+core::Result<void> VfioDevice::SetBarMapping(pci::Bdf bdf, uint8_t bar_index,
+                                             pci::BarMapping mapping) {
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return target;
+    }
+    if (bar_index >= pci::kBarCount) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (mapping == pci::BarMapping::kWriteCombining) {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> VfioDevice::BarFlush(pci::Bdf /*bdf*/, uint8_t bar_index) {
+    if (bar_index >= pci::kBarCount) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    pci::MmioFlush();
+    return core::Result<void>::Ok();
+}
+
+// ---------------------------------------------------------------------------
+// Cxl — DVSEC lookups (served from the cached index)
+// ---------------------------------------------------------------------------
+
+core::Result<std::vector<pci::DvsecHeader>> VfioDevice::EnumerateCxlDvsecs(
+    pci::Bdf bdf) {
+    using R = core::Result<std::vector<pci::DvsecHeader>>;
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return R::Err(target.Error());
+    }
+    std::lock_guard<std::mutex> lock(cap_mutex_);
+    auto index = EnsureIndexLocked();
+    if (index.IsError()) {
+        return R::Err(index.Error());
+    }
+    return R::Ok(cxl_index_->dvsecs);
+}
+
+core::Result<std::optional<pci::DvsecHeader>> VfioDevice::FindCxlDvsec(
+    pci::Bdf bdf, pci::CxlDvsecId dvsec_id) {
+    using R = core::Result<std::optional<pci::DvsecHeader>>;
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return R::Err(target.Error());
+    }
+    std::lock_guard<std::mutex> lock(cap_mutex_);
+    auto index = EnsureIndexLocked();
+    if (index.IsError()) {
+        return R::Err(index.Error());
+    }
+    return R::Ok(cxl_index_->Find(dvsec_id));
+}
+
+core::Result<pci::CxlDeviceType> VfioDevice::GetCxlDeviceType(pci::Bdf bdf) {
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return core::Result<pci::CxlDeviceType>::Err(target.Error());
+    }
+    std::lock_guard<std::mutex> lock(cap_mutex_);
+    auto index = EnsureIndexLocked();
+    if (index.IsError()) {
+        return core::Result<pci::CxlDeviceType>::Err(index.Error());
+    }
+    return core::Result<pci::CxlDeviceType>::Ok(cxl_index_->device_type);
+}
+
+core::Result<std::vector<pci::RegisterBlockEntry>>
+VfioDevice::GetRegisterBlocks(pci::Bdf bdf) {
+    using R = core::Result<std::vector<pci::RegisterBlockEntry>>;
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return R::Err(target.Error());
+    }
+    std::lock_guard<std::mutex> lock(cap_mutex_);
+    auto index = EnsureIndexLocked();
+    if (index.IsError()) {
+        return R::Err(index.Error());
+    }
+    return R::Ok(cxl_index_->register_blocks);
+}
+
+core::Result<core::DWord> VfioDevice::ReadDvsecRegister(
+    pci::Bdf bdf, pci::ConfigOffset dvsec_offset, uint16_t reg_offset) {
+    std::size_t offset = std::size_t{dvsec_offset} + reg_offset;
+    if (offset + sizeof(core::DWord) > pci::kConfigSpaceSize) {
+        return core::Result<core::DWord>::Err(core::ErrorCode::kOutOfRange);
+    }
+    return ReadConfig32(bdf, static_cast<pci::ConfigOffset>(offset));
+}
+
+core::Result<void> VfioDevice::WriteDvsecRegister(
+    pci::Bdf bdf, pci::ConfigOffset dvsec_offset, uint16_t reg_offset,
+    core::DWord value) {
+    std::size_t offset = std::size_t{dvsec_offset} + reg_offset;
+    if (offset + sizeof(core::DWord) > pci::kConfigSpaceSize) {
+        return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+    }
+    return WriteConfig32(bdf, static_cast<pci::ConfigOffset>(offset), value);
+}
+
+// ---------------------------------------------------------------------------
+// CxlMailbox — Primary Mailbox over the BARs, doorbell interrupt if wired
+// ---------------------------------------------------------------------------
+
+core::Result<std::shared_ptr<pci::CxlMmioMailbox>> VfioDevice::GetCxlMailbox(
+    pci::Bdf bdf) {
+    using R = core::Result<std::shared_ptr<pci::CxlMmioMailbox>>;
+    auto target = CheckTarget(bdf);
+    if (target.IsError()) {
+        return R::Err(target.Error());
+    }
+    std::lock_guard<std::mutex> lock(cxl_mailbox_mutex_);
+    if (cxl_mailbox_) {
+        return R::Ok(cxl_mailbox_);
+    }
+
+    auto location = pci::CxlMmioMailbox::Locate(*this, *this, bdf);
+    if (location.IsError()) {
+        PLAS_LOG_DEVICE_ERROR(name_, "CxlMailbox", "no primary mailbox: " +
+                              location.Error().message());
+        return R::Err(location.Error());
+    }
+    pci::CxlMmioMailboxOptions options;
+    options.timeout = std::chrono::milliseconds(mailbox_timeout_ms_);
+    auto caps = BarRead32(bdf, location.Value().bar_index,
+                          location.Value().offset);
+    if (caps.IsOk() && (caps.Value() & kMailboxIrqCapable)) {
+        options.doorbell_irq =
+            Vector((caps.Value() >> kMailboxMessageShift) & kMailboxMessageMask);
+    }
+    cxl_mailbox_ = std::make_shared<pci::CxlMmioMailbox>(
+        *this, bdf, location.Value(), options);
+    return R::Ok(cxl_mailbox_);
+}
+
+core::Result<pci::CxlMailboxResult> VfioDevice::ExecuteCommand(
+    pci::Bdf bdf, pci::CxlMailboxOpcode opcode,
+    const pci::CxlMailboxPayload& payload) {
+    return ExecuteCommand(bdf, static_cast<uint16_t>(opcode), payload);
+}
+
+core::Result<pci::CxlMailboxResult> VfioDevice::ExecuteCommand(
+    pci::Bdf bdf, uint16_t raw_opcode, const pci::CxlMailboxPayload& payload) {
+    auto mailbox = GetCxlMailbox(bdf);
+    if (mailbox.IsError()) {
+        return core::Result<pci::CxlMailboxResult>::Err(mailbox.Error());
+    }
+    auto result = mailbox.Value()->Execute(raw_opcode, payload);
+    if (result.IsError()) {
+        PLAS_LOG_DEVICE_ERROR(name_, "CxlMailbox", "opcode=" +
+                              std::to_string(raw_opcode) + " failed: " +
+                              result.Error().message());
+    }
+    return result;
+}
+
+core::Result<pci::CxlMailboxResult> VfioDevice::ExecuteCommandGather(
+    pci::Bdf bdf, uint16_t raw_opcode, const uint8_t* header,
+    std::size_t header_len, const uint8_t* data, std::size_t data_len) {
+    auto mailbox = GetCxlMailbox(bdf);
+    if (mailbox.IsError()) {
+        return core::Result<pci::CxlMailboxResult>::Err(mailbox.Error());
+    }
+    auto result = mailbox.Value()->Execute(raw_opcode, header, header_len,
+                                           data, data_len);
+    if (result.IsError()) {
+        PLAS_LOG_DEVICE_ERROR(name_, "CxlMailbox", "opcode=" +
+                              std::to_string(raw_opcode) + " failed: " +
+                              result.Error().message());
+    }
+    return result;
+}
+
+core::Result<pci::CxlMailboxPooledResult> VfioDevice::ExecuteCommandPooled(
+    pci::Bdf bdf, uint16_t raw_opcode, const uint8_t* payload,
+    std::size_t length) {
+    auto mailbox = GetCxlMailbox(bdf);
+    if (mailbox.IsError()) {
+        return core::Result<pci::CxlMailboxPooledResult>::Err(mailbox.Error());
+    }
+    auto result = mailbox.Value()->ExecutePooled(raw_opcode, payload, length);
+    if (result.IsError()) {
+        PLAS_LOG_DEVICE_ERROR(name_, "CxlMailbox", "opcode=" +
+                              std::to_string(raw_opcode) + " failed: " +
+                              result.Error().message());
+    }
+    return result;
+}
+
+core::Result<uint32_t> VfioDevice::GetPayloadSize(pci::Bdf bdf) {
+    auto mailbox = GetCxlMailbox(bdf);
+    if (mailbox.IsError()) {
+        return core::Result<uint32_t>::Err(mailbox.Error());
+    }
+    return mailbox.Value()->PayloadSize();
+}
+
+core::Result<bool> VfioDevice::IsReady(pci::Bdf bdf) {
+    auto mailbox = GetCxlMailbox(bdf);
+    if (mailbox.IsError()) {
+        return core::Result<bool>::Err(mailbox.Error());
+    }
+    return mailbox.Value()->IsReady();
+}
+
+core::Result<pci::CxlMailboxResult> VfioDevice::GetBackgroundCmdStatus(
+    pci::Bdf bdf) {
+    auto mailbox = GetCxlMailbox(bdf);
+    if (mailbox.IsError()) {
+        return core::Result<pci::CxlMailboxResult>::Err(mailbox.Error());
+    }
+    auto status = mailbox.Value()->GetBackgroundStatus();
+    if (status.IsError()) {
+        return core::Result<pci::CxlMailboxResult>::Err(status.Error());
+    }
+    pci::CxlMailboxResult result;
+    result.return_code =
+        status.Value().running
+            ? pci::CxlMailboxReturnCode::kBackgroundCmdStarted
+            : status.Value().return_code;
+    result.payload.resize(sizeof(uint64_t));
+    for (std::size_t i = 0; i < result.payload.size(); ++i) {
+        result.payload[i] =
+            static_cast<uint8_t>(status.Value().raw >> (8 * i));
+    }
+    return core::Result<pci::CxlMailboxResult>::Ok(std::move(result));
+}
+
+// ---------------------------------------------------------------------------
+// Self-registration
+// ---------------------------------------------------------------------------
+
+void VfioDevice::Register() {
+    DeviceFactory::RegisterDriver(
+        "vfio", [](const config::DeviceEntry& entry,
+                   const config::DeviceUri& uri) {
+            return std::make_unique<VfioDevice>(entry, uri);
+        });
+}
+
+}  // namespace plas::hal::driver
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+#include "plas/mctp/packet_pool.h"
+
+namespace plas::mctp {
+
+/// Physical (medium) address of an endpoint: the 7-bit target address on
+/// SMBus, the bus/device/function on PCIe VDM.
+using MctpPhysAddr = uint32_t;
+
+/// Carries MCTP packets over one physical medium (DSP0237 SMBus, DSP0238
+/// PCIe VDM, ...). A packet is the 4-byte transport header plus payload;
+/// the binding adds and strips the medium framing.
+class MctpBinding {
+public:
+    virtual ~MctpBinding() = default;
+
+    virtual std::string Name() const = 0;
+
+    /// Largest payload per packet (after the transport header) this binding
+    /// sends; at least kBaselineMtu.
+    virtual std::size_t Mtu() const = 0;
+
+    /// Send one packet to the endpoint at `dest`.
+    virtual core::Result<void> Send(MctpPhysAddr dest, const core::Byte* packet,
+                                    std::size_t length) = 0;
+
+    /// Wait up to `timeout` for the next inbound packet and copy it into
+    /// `out`; returns its length and sets `source`. kTimeout if none
+    /// arrived, kOverflow (packet dropped) if it exceeds `capacity`.
+    virtual core::Result<std::size_t> Receive(core::Byte* out, std::size_t capacity,
+                                              MctpPhysAddr& source,
+                                              std::chrono::milliseconds timeout) = 0;
+};
+
+}  // namespace plas::mctp
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+#include "plas/mctp/binding.h"
+#include "plas/mctp/framing.h"
+#include "plas/mctp/packet_pool.h"
+
+namespace plas::mctp {
+
+struct MctpEndpointOptions {
+    Eid eid = 0x08;                  ///< our own endpoint ID
+    std::size_t pool_packets = 256;  ///< receive packets, allocated once
+    /// Requests outstanding per destination EID (1-8, one message tag
+    /// each); Submit() returns kBusy beyond that.
+    std::size_t window = 8;
+    MctpReassemblerOptions reassembly;
+    /// Longest the receive thread waits in MctpBinding::Receive(); bounds
+    /// how long Stop() takes.
+    std::chrono::milliseconds poll{10};
+};
+
+/// An outstanding request, from Submit().
+struct MctpRequest {
+    Eid destination = kNullEid;
+    uint8_t tag = 0;
+    uint32_t id = 0;
+};
+
+/// MCTP endpoint (DSP0236) on one binding.
+///
+/// A receive thread pulls packets from the binding into a fixed packet
+/// pool, reassembles them and routes each message: responses (tag owner
+/// clear) to the request waiting on that source EID and tag, requests to
+/// the request handler. Each destination EID has its own set of eight
+/// message tags, so up to `window` requests per endpoint, and any number
+/// of endpoints, are in flight at once instead of one request/response
+/// round trip at a time:
+///
+///     std::vector<MctpRequest> batch;
+///     for (Eid ssd : fleet) batch.push_back(endpoint.Submit(ssd, ...).Value());
+///     for (auto& r : batch) auto reply = endpoint.Wait(r, 100ms);
+///
+/// Routes map EIDs to physical addresses; the source of every received
+/// packet is learned as a route. Messages returned by Wait() and passed to
+/// the handler hold pool packets and must not outlive the endpoint.
+class MctpEndpoint {
+public:
+    /// Runs on the receive thread; `request` is an inbound message with
+    /// the tag owner bit set. Answer it with Respond().
+    using RequestHandler = std::function<void(MctpMessage request)>;
+
+    struct Stats {
+        uint64_t requests = 0;        ///< Submit() calls that were sent
+        uint64_t responses = 0;       ///< matched to a waiting request
+        uint64_t timeouts = 0;        ///< Wait() calls that gave up
+        uint64_t unmatched = 0;       ///< responses nobody waits for (late)
+        uint64_t handled = 0;         ///< requests passed to the handler
+        uint64_t unhandled = 0;       ///< requests dropped, no handler
+        uint64_t misaddressed = 0;    ///< packets for another EID
+        uint64_t receive_errors = 0;  ///< binding errors other than kTimeout
+        uint64_t pool_exhausted = 0;  ///< receive loop found no free packet
+    };
+
+    explicit MctpEndpoint(MctpBinding& binding, MctpEndpointOptions options = {});
+    ~MctpEndpoint();
+
+    MctpEndpoint(const MctpEndpoint&) = delete;
+    MctpEndpoint& operator=(const MctpEndpoint&) = delete;
+
+    void AddRoute(Eid eid, MctpPhysAddr addr);
+    /// kNotFound if `eid` has no route yet.
+    core::Result<MctpPhysAddr> Route(Eid eid) const;
+
+    /// kBusy while running.
+    core::Result<void> SetRequestHandler(RequestHandler handler);
+
+    /// Start the receive thread. kAlreadyOpen if running.
+    core::Result<void> Start();
+    /// Stop the receive thread; waiting requests fail with kCancelled.
+    void Stop();
+    bool IsRunning() const;
+
+    /// Send a request and return at once. kNotInitialized if not running,
+    /// kNotFound without a route, kBusy when `dest` already has `window`
+    /// requests outstanding, kResourceExhausted if the pool is empty,
+    /// otherwise the binding's send error.
+    core::Result<MctpRequest> Submit(Eid dest, uint8_t type, const core::Byte* body,
+                                     std::size_t length);
+
+    /// The response to `request`. kTimeout after `timeout`, kCancelled if
+    /// the endpoint stops, kNotFound for a request already waited for or
+    /// cancelled. The tag is released in every case.
+    core::Result<MctpMessage> Wait(const MctpRequest& request, std::chrono::milliseconds timeout);
+
+    /// Give up on `request` without waiting; a late response is dropped.
+    void Cancel(const MctpRequest& request);
+
+    /// Submit() + Wait().
+    core::Result<MctpMessage> Request(Eid dest, uint8_t type, const core::Byte* body,
+                                      std::size_t length, std::chrono::milliseconds timeout);
+
+    /// Answer `request` (from the handler): same tag, tag owner clear.
+    core::Result<void> Respond(const MctpMessage& request, uint8_t type, const core::Byte* body,
+                               std::size_t length);
+
+    /// Requests outstanding to `dest`.
+    std::size_t Outstanding(Eid dest) const;
+
+    Stats GetStats() const;
+    MctpReassembler::Stats ReassemblyStats() const;
+    MctpPacketPool::Stats PoolStats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::mctp
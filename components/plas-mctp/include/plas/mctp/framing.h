@@ -0,0 +1,141 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+#include "plas/mctp/packet_pool.h"
+
+namespace plas::mctp {
+
+/// Message types (DSP0239) carried in the first payload byte.
+enum class MctpMessageType : uint8_t {
+    kControl = 0x00,
+    kPldm = 0x01,
+    kNcsi = 0x02,
+    kEthernet = 0x03,
+    kNvmeMi = 0x04,
+    kSpdm = 0x05,
+    kVendorPci = 0x7E,
+    kVendorIana = 0x7F,
+};
+
+/// Integrity-check flag of the message type byte.
+inline constexpr uint8_t kIntegrityCheckBit = 0x80;
+
+/// MCTP transport header (DSP0236 8.1).
+struct MctpHeader {
+    static constexpr uint8_t kVersion = 0x01;
+
+    uint8_t version = kVersion;
+    Eid destination = kNullEid;
+    Eid source = kNullEid;
+    bool som = false;        ///< start of message
+    bool eom = false;        ///< end of message
+    uint8_t sequence = 0;    ///< packet sequence number, modulo 4
+    bool tag_owner = false;  ///< set on requests, clear on responses
+    uint8_t tag = 0;         ///< message tag, 0-7
+
+    void Encode(core::Byte* out) const;
+    /// kInvalidArgument if `length` < kHeaderSize, kNotSupported for a
+    /// header version other than 1.
+    static core::Result<MctpHeader> Decode(const core::Byte* data, std::size_t length);
+};
+
+/// Splits one message into packets of at most `mtu` payload bytes,
+/// writing each straight into a caller buffer (a pool packet or a binding's
+/// frame): SOM on the first, EOM on the last, the sequence number counting
+/// up from 0. The message type byte leads the first packet's payload.
+class MctpFragmenter {
+public:
+    /// `header` supplies the addressing and tag; its SOM/EOM/sequence are
+    /// overwritten. `body` must outlive the fragmenter.
+    MctpFragmenter(const MctpHeader& header, uint8_t type, const core::Byte* body,
+                   std::size_t length, std::size_t mtu = kBaselineMtu);
+
+    std::size_t PacketCount() const;
+    bool Done() const { return offset_ >= total_; }
+
+    /// Write the next packet to `out` (at least kHeaderSize + mtu bytes);
+    /// returns its length, 0 once every packet has been written.
+    std::size_t Next(core::Byte* out);
+
+private:
+    MctpHeader header_;
+    uint8_t type_;
+    const core::Byte* body_;
+    std::size_t mtu_;
+    std::size_t total_;       ///< payload bytes including the type byte
+    std::size_t offset_ = 0;  ///< into the type byte + body
+    uint8_t sequence_ = 0;
+};
+
+struct MctpReassemblerOptions {
+    /// Largest message accepted, type byte included; longer ones are
+    /// dropped.
+    std::size_t max_message = 4096;
+    /// Messages assembled at once (one per source EID, tag and tag owner).
+    std::size_t contexts = 32;
+    /// A message whose next packet does not arrive in time is dropped
+    /// (DSP0236 reassembly timeout).
+    std::chrono::milliseconds timeout{100};
+};
+
+/// Rebuilds messages from packets of any number of interleaved senders.
+///
+/// Packets are chained into their message rather than copied, so an
+/// MctpMessage holds the pool packets it arrived in. A message is dropped
+/// (and counted) on a sequence gap, a packet without a message in
+/// progress, a second SOM for the same key, an oversize message or the
+/// reassembly timeout. Not thread-safe.
+class MctpReassembler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        uint64_t packets = 0;
+        uint64_t messages = 0;
+        uint64_t dropped_packets = 0;   ///< not part of any message in progress
+        uint64_t dropped_messages = 0;  ///< abandoned part-way
+    };
+
+    explicit MctpReassembler(MctpReassemblerOptions options = {});
+    ~MctpReassembler();
+
+    MctpReassembler(const MctpReassembler&) = delete;
+    MctpReassembler& operator=(const MctpReassembler&) = delete;
+
+    /// Take one received packet. Returns true and fills `out` when it
+    /// completes a message. A packet with a malformed header is dropped.
+    bool Push(MctpPacket packet, MctpMessage& out, Clock::time_point now = Clock::now());
+
+    /// Drop messages whose reassembly timed out; Push() does this too.
+    void Expire(Clock::time_point now = Clock::now());
+
+    std::size_t InProgress() const;
+    Stats GetStats() const { return stats_; }
+
+private:
+    struct Context {
+        bool active = false;
+        Eid source = kNullEid;
+        uint8_t tag = 0;
+        bool tag_owner = false;
+        uint8_t next_sequence = 0;
+        Clock::time_point last_packet{};
+        MctpMessage message;
+    };
+
+    Context* Find(Eid source, uint8_t tag, bool tag_owner);
+    Context* Free();
+    void Drop(Context& context);
+
+    MctpReassemblerOptions options_;
+    std::vector<Context> contexts_;
+    Stats stats_;
+};
+
+}  // namespace plas::mctp
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+
+namespace plas::mctp {
+
+/// Endpoint ID (DSP0236 8.2).
+using Eid = uint8_t;
+inline constexpr Eid kNullEid = 0x00;
+inline constexpr Eid kBroadcastEid = 0xFF;
+
+/// Transport header bytes at the front of every packet.
+inline constexpr std::size_t kHeaderSize = 4;
+/// Payload bytes per packet every binding must carry (baseline MTU).
+inline constexpr std::size_t kBaselineMtu = 64;
+
+class MctpPacketPool;
+
+/// One packet slot of an MctpPacketPool (transport header + payload).
+/// Move-only; the slot goes back to the pool when the handle is destroyed.
+class MctpPacket {
+public:
+    MctpPacket() = default;
+    ~MctpPacket() { Release(); }
+
+    MctpPacket(MctpPacket&& other) noexcept;
+    MctpPacket& operator=(MctpPacket&& other) noexcept;
+    MctpPacket(const MctpPacket&) = delete;
+    MctpPacket& operator=(const MctpPacket&) = delete;
+
+    bool Valid() const { return pool_ != nullptr; }
+    core::Byte* Data();
+    const core::Byte* Data() const;
+    std::size_t Size() const;
+    std::size_t Capacity() const;
+    /// Set the used length; clamped to Capacity().
+    void Resize(std::size_t size);
+
+    void Release();
+
+private:
+    friend class MctpPacketPool;
+    friend class MctpMessage;
+
+    MctpPacket(MctpPacketPool* pool, uint32_t slot) : pool_(pool), slot_(slot) {}
+    uint32_t Detach();
+
+    MctpPacketPool* pool_ = nullptr;
+    uint32_t slot_ = 0;
+};
+
+/// A reassembled message: the packets it arrived in, chained in order
+/// through the pool, so the payload is never copied into a separate
+/// buffer. Move-only; the packets go back to the pool with it.
+class MctpMessage {
+public:
+    MctpMessage() = default;
+    ~MctpMessage() { Clear(); }
+
+    MctpMessage(MctpMessage&& other) noexcept;
+    MctpMessage& operator=(MctpMessage&& other) noexcept;
+    MctpMessage(const MctpMessage&) = delete;
+    MctpMessage& operator=(const MctpMessage&) = delete;
+
+    bool Empty() const { return packets_ == 0; }
+    Eid Source() const { return source_; }
+    Eid Destination() const { return destination_; }
+    uint8_t Tag() const { return tag_; }
+    bool TagOwner() const { return tag_owner_; }
+
+    /// Message type (first payload byte, without the IC bit).
+    uint8_t Type() const;
+    /// Integrity-check bit of the message type byte.
+    bool IntegrityCheck() const;
+
+    /// Body bytes, i.e. everything after the message type byte.
+    std::size_t Size() const { return size_ > 0 ? size_ - 1 : 0; }
+    std::size_t PacketCount() const { return packets_; }
+
+    /// Copy up to `capacity` body bytes starting at `offset`; returns the
+    /// number copied.
+    std::size_t CopyTo(core::Byte* out, std::size_t capacity, std::size_t offset = 0) const;
+    std::vector<core::Byte> ToVector() const;
+
+    /// Call `fn(const core::Byte*, std::size_t)` for each packet's share of
+    /// the body, in order.
+    template <typename Fn>
+    void ForEachFragment(Fn&& fn) const;
+
+    /// Append the payload of `packet` (header already parsed by the
+    /// caller). The first packet must come from the same pool as the rest.
+    void Append(MctpPacket packet);
+    void SetAddressing(Eid source, Eid destination, uint8_t tag, bool tag_owner) {
+        source_ = source;
+        destination_ = destination;
+        tag_ = tag;
+        tag_owner_ = tag_owner;
+    }
+
+    void Clear();
+
+private:
+    MctpPacketPool* pool_ = nullptr;
+    uint32_t head_ = 0;
+    uint32_t tail_ = 0;
+    std::size_t packets_ = 0;
+    std::size_t size_ = 0;  ///< payload bytes including the type byte
+    Eid source_ = kNullEid;
+    Eid destination_ = kNullEid;
+    uint8_t tag_ = 0;
+    bool tag_owner_ = false;
+};
+
+/// Fixed set of equally sized packet buffers, allocated once. Acquire()
+/// and release never touch the heap, so the receive path of an endpoint
+/// runs allocation-free however many messages pass through it.
+///
+/// Thread-safe. The pool must outlive every packet and message taken
+/// from it.
+class MctpPacketPool {
+public:
+    struct Stats {
+        uint64_t acquired = 0;
+        uint64_t exhausted = 0;   ///< Acquire() calls that found the pool empty
+        std::size_t in_use = 0;
+        std::size_t high_water = 0;
+    };
+
+    /// `count` packets of `packet_size` bytes (header included; at least
+    /// kHeaderSize + 1).
+    MctpPacketPool(std::size_t count, std::size_t packet_size = kHeaderSize + kBaselineMtu);
+
+    MctpPacketPool(const MctpPacketPool&) = delete;
+    MctpPacketPool& operator=(const MctpPacketPool&) = delete;
+
+    /// kResourceExhausted when every packet is in use.
+    core::Result<MctpPacket> Acquire();
+
+    std::size_t PacketSize() const { return packet_size_; }
+    std::size_t Capacity() const { return lengths_.size(); }
+    std::size_t Available() const;
+    Stats GetStats() const;
+
+private:
+    friend class MctpPacket;
+    friend class MctpMessage;
+
+    static constexpr uint32_t kNoSlot = UINT32_MAX;
+
+    core::Byte* SlotData(uint32_t slot) { return slab_.data() + slot * packet_size_; }
+    const core::Byte* SlotData(uint32_t slot) const {
+        return slab_.data() + slot * packet_size_;
+    }
+    void Release(uint32_t slot);
+
+    std::size_t packet_size_;
+    std::vector<core::Byte> slab_;
+    std::vector<uint32_t> lengths_;  ///< used bytes per slot
+    std::vector<uint32_t> next_;     ///< message chain link per slot
+    mutable std::mutex mutex_;
+    std::vector<uint32_t> free_;     ///< stack of free slots
+    Stats stats_;
+};
+
+template <typename Fn>
+void MctpMessage::ForEachFragment(Fn&& fn) const {
+    bool first = true;
+    for (uint32_t slot = head_, n = 0; n < packets_; slot = pool_->next_[slot], ++n) {
+        const core::Byte* payload = pool_->SlotData(slot) + kHeaderSize;
+        std::size_t length = pool_->lengths_[slot] - kHeaderSize;
+        if (first) {
+            // The type byte is not part of the body.
+            payload++;
+            length--;
+            first = false;
+        }
+        if (length > 0) {
+            fn(payload, length);
+        }
+    }
+}
+
+}  // namespace plas::mctp
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+#include "plas/mctp/binding.h"
+
+namespace plas::hal {
+class I2c;
+}
+
+namespace plas::mctp {
+
+struct MctpSmbusOptions {
+    /// Payload bytes per packet; DSP0237 allows up to 250 (byte count 255).
+    std::size_t mtu = kBaselineMtu;
+    /// Append and check the SMBus PEC byte.
+    bool pec = true;
+    /// Inbound frames buffered between Deliver() and Receive(); further
+    /// frames are dropped.
+    std::size_t inbound_depth = 16;
+};
+
+/// MCTP over SMBus/I2C (DSP0237).
+///
+/// Send() writes each packet as one SMBus block write to the destination:
+/// command code 0x0F, byte count, source target address, the packet and
+/// PEC. The medium has no request/response cycle: the endpoint answers by
+/// writing to our own target address, which the I2c interface cannot
+/// receive. Whatever listens there (an adapter in target mode, a Linux
+/// i2c-slave-mqueue node) hands each received write to Deliver(), and
+/// Receive() returns the packets from that queue.
+class MctpSmbusBinding : public MctpBinding {
+public:
+    struct Stats {
+        uint64_t sent = 0;
+        uint64_t delivered = 0;
+        uint64_t rejected = 0;  ///< bad command code, length or PEC
+        uint64_t overflows = 0; ///< inbound queue full
+    };
+
+    /// `own_addr` is the 7-bit target address this host answers on.
+    MctpSmbusBinding(hal::I2c& bus, core::Address own_addr, MctpSmbusOptions options = {});
+    ~MctpSmbusBinding() override;
+
+    MctpSmbusBinding(const MctpSmbusBinding&) = delete;
+    MctpSmbusBinding& operator=(const MctpSmbusBinding&) = delete;
+
+    std::string Name() const override { return "smbus"; }
+    std::size_t Mtu() const override;
+    core::Result<void> Send(MctpPhysAddr dest, const core::Byte* packet,
+                            std::size_t length) override;
+    core::Result<std::size_t> Receive(core::Byte* out, std::size_t capacity,
+                                      MctpPhysAddr& source,
+                                      std::chrono::milliseconds timeout) override;
+
+    /// Queue one SMBus write received on `own_addr`, starting at the
+    /// command code (the address byte itself is not included).
+    /// kInvalidArgument for a frame that is not MCTP or is truncated,
+    /// kDataLoss on a PEC mismatch, kResourceExhausted if the queue is
+    /// full.
+    core::Result<void> Deliver(const core::Byte* frame, std::size_t length);
+
+    Stats GetStats() const;
+
+    /// SMBus PEC from initial value `crc` (hal::SmBusPec).
+    static uint8_t Pec(const core::Byte* data, std::size_t length, uint8_t crc = 0);
+
+    static constexpr uint8_t kCommandCode = 0x0F;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::mctp
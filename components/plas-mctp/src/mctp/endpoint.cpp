@@ -0,0 +1,347 @@
+#include "plas/mctp/endpoint.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "plas/core/error.h"
+
+namespace plas::mctp {
+
+namespace {
+
+constexpr std::size_t kTags = 8;
+constexpr std::size_t kEids = 256;
+
+}  // namespace
+
+struct MctpEndpoint::Impl {
+    /// One (destination EID, tag) pair of our own requests.
+    struct Pending {
+        bool active = false;
+        bool done = false;
+        uint32_t id = 0;
+        MctpMessage response;
+    };
+
+    Impl(MctpBinding& b, MctpEndpointOptions opts)
+        : binding(b),
+          options(opts),
+          pool(std::max<std::size_t>(opts.pool_packets, 1),
+               kHeaderSize + std::max(b.Mtu(), kBaselineMtu)),
+          reassembler(opts.reassembly),
+          pending(kEids * kTags) {
+        options.window = std::clamp<std::size_t>(options.window, 1, kTags);
+    }
+
+    Pending& Slot(Eid eid, uint8_t tag) { return pending[eid * kTags + tag]; }
+
+    /// Caller holds `mutex`.
+    void ReleaseLocked(Eid eid, Pending& slot) {
+        slot.active = false;
+        slot.done = false;
+        slot.response.Clear();
+        outstanding[eid]--;
+    }
+
+    core::Result<void> SendMessage(Eid dest, bool tag_owner, uint8_t tag, uint8_t type,
+                                   const core::Byte* body, std::size_t length);
+    void ReceiveLoop();
+    void Dispatch(MctpMessage message);
+
+    MctpBinding& binding;
+    MctpEndpointOptions options;
+    // Declared first: messages below hold its packets.
+    MctpPacketPool pool;
+    MctpReassembler reassembler;  ///< receive thread only
+    RequestHandler handler;
+
+    mutable std::mutex mutex;
+    std::condition_variable completed;
+    std::vector<Pending> pending;  ///< kEids x kTags, allocated once
+    std::array<uint8_t, kEids> outstanding{};
+    std::array<uint8_t, kEids> next_tag{};
+    std::array<MctpPhysAddr, kEids> routes{};
+    std::bitset<kEids> routed;
+    uint32_t next_id = 0;
+    Stats stats;
+    MctpReassembler::Stats reassembly_stats;
+
+    std::atomic<bool> running{false};
+    std::thread receiver;
+};
+
+core::Result<void> MctpEndpoint::Impl::SendMessage(Eid dest, bool tag_owner, uint8_t tag,
+                                                   uint8_t type, const core::Byte* body,
+                                                   std::size_t length) {
+    MctpPhysAddr addr = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!routed[dest]) {
+            return core::Result<void>::Err(core::ErrorCode::kNotFound);
+        }
+        addr = routes[dest];
+    }
+    // One pool packet is reused for every fragment.
+    auto scratch = pool.Acquire();
+    if (scratch.IsError()) {
+        return core::Result<void>::Err(scratch.Error());
+    }
+    MctpHeader header;
+    header.destination = dest;
+    header.source = options.eid;
+    header.tag_owner = tag_owner;
+    header.tag = tag;
+    MctpFragmenter fragmenter(header, type, body, length, binding.Mtu());
+    core::Byte* out = scratch.Value().Data();
+    while (std::size_t n = fragmenter.Next(out)) {
+        auto sent = binding.Send(addr, out, n);
+        if (sent.IsError()) {
+            return sent;
+        }
+    }
+    return core::Result<void>::Ok();
+}
+
+void MctpEndpoint::Impl::Dispatch(MctpMessage message) {
+    if (message.TagOwner()) {
+        if (handler) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stats.handled++;
+            }
+            handler(std::move(message));
+        } else {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.unhandled++;
+        }
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = Slot(message.Source(), message.Tag());
+    if (!slot.active || slot.done) {
+        stats.unmatched++;
+        return;
+    }
+    slot.response = std::move(message);
+    slot.done = true;
+    stats.responses++;
+    completed.notify_all();
+}
+
+void MctpEndpoint::Impl::ReceiveLoop() {
+    while (running.load(std::memory_order_acquire)) {
+        auto acquired = pool.Acquire();
+        if (acquired.IsError()) {
+            // Every packet is held by a message nobody has collected yet.
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stats.pool_exhausted++;
+            }
+            reassembler.Expire();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        MctpPacket packet = std::move(acquired.Value());
+        MctpPhysAddr source = 0;
+        auto received = binding.Receive(packet.Data(), packet.Capacity(), source, options.poll);
+        if (received.IsError()) {
+            if (received.Error() != core::make_error_code(core::ErrorCode::kTimeout)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                stats.receive_errors++;
+            }
+            reassembler.Expire();
+            continue;
+        }
+        packet.Resize(received.Value());
+
+        auto header = MctpHeader::Decode(packet.Data(), packet.Size());
+        if (header.IsOk()) {
+            Eid dest = header.Value().destination;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (dest != options.eid && dest != kNullEid && dest != kBroadcastEid) {
+                stats.misaddressed++;
+                continue;
+            }
+            Eid from = header.Value().source;
+            if (!routed[from] && from != kNullEid && from != kBroadcastEid) {
+                routes[from] = source;
+                routed[from] = true;
+            }
+        }
+
+        MctpMessage message;
+        bool complete = reassembler.Push(std::move(packet), message);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            reassembly_stats = reassembler.GetStats();
+        }
+        if (complete) {
+            Dispatch(std::move(message));
+        }
+    }
+}
+
+MctpEndpoint::MctpEndpoint(MctpBinding& binding, MctpEndpointOptions options)
+    : impl_(std::make_unique<Impl>(binding, options)) {}
+
+MctpEndpoint::~MctpEndpoint() { Stop(); }
+
+void MctpEndpoint::AddRoute(Eid eid, MctpPhysAddr addr) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->routes[eid] = addr;
+    impl_->routed[eid] = true;
+}
+
+core::Result<MctpPhysAddr> MctpEndpoint::Route(Eid eid) const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (!impl_->routed[eid]) {
+        return core::Result<MctpPhysAddr>::Err(core::ErrorCode::kNotFound);
+    }
+    return core::Result<MctpPhysAddr>::Ok(impl_->routes[eid]);
+}
+
+core::Result<void> MctpEndpoint::SetRequestHandler(RequestHandler handler) {
+    if (IsRunning()) {
+        return core::Result<void>::Err(core::ErrorCode::kBusy);
+    }
+    impl_->handler = std::move(handler);
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> MctpEndpoint::Start() {
+    if (impl_->running.exchange(true)) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+    }
+    impl_->receiver = std::thread([this] { impl_->ReceiveLoop(); });
+    return core::Result<void>::Ok();
+}
+
+void MctpEndpoint::Stop() {
+    if (!impl_->running.exchange(false)) {
+        return;
+    }
+    if (impl_->receiver.joinable()) {
+        impl_->receiver.join();
+    }
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->completed.notify_all();
+}
+
+bool MctpEndpoint::IsRunning() const { return impl_->running.load(std::memory_order_acquire); }
+
+core::Result<MctpRequest> MctpEndpoint::Submit(Eid dest, uint8_t type, const core::Byte* body,
+                                               std::size_t length) {
+    if (!IsRunning()) {
+        return core::Result<MctpRequest>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (body == nullptr && length > 0) {
+        return core::Result<MctpRequest>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    MctpRequest request;
+    request.destination = dest;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        if (!impl_->routed[dest]) {
+            return core::Result<MctpRequest>::Err(core::ErrorCode::kNotFound);
+        }
+        if (impl_->outstanding[dest] >= impl_->options.window) {
+            return core::Result<MctpRequest>::Err(core::ErrorCode::kBusy);
+        }
+        // Rotate through the tags so a tag that just timed out is reused
+        // last, after any late response to it has had time to arrive.
+        uint8_t tag = impl_->next_tag[dest];
+        while (impl_->Slot(dest, tag).active) {
+            tag = static_cast<uint8_t>((tag + 1) % kTags);
+        }
+        impl_->next_tag[dest] = static_cast<uint8_t>((tag + 1) % kTags);
+        auto& slot = impl_->Slot(dest, tag);
+        slot.active = true;
+        slot.done = false;
+        slot.id = ++impl_->next_id;
+        impl_->outstanding[dest]++;
+        request.tag = tag;
+        request.id = slot.id;
+    }
+
+    auto sent = impl_->SendMessage(dest, true, request.tag, type, body, length);
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (sent.IsError()) {
+        impl_->ReleaseLocked(dest, impl_->Slot(dest, request.tag));
+        return core::Result<MctpRequest>::Err(sent.Error());
+    }
+    impl_->stats.requests++;
+    return core::Result<MctpRequest>::Ok(request);
+}
+
+core::Result<MctpMessage> MctpEndpoint::Wait(const MctpRequest& request,
+                                             std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(impl_->mutex);
+    auto& slot = impl_->Slot(request.destination, request.tag & 0x07);
+    if (!slot.active || slot.id != request.id) {
+        return core::Result<MctpMessage>::Err(core::ErrorCode::kNotFound);
+    }
+    impl_->completed.wait_for(lock, timeout, [&] { return slot.done || !IsRunning(); });
+    if (slot.done) {
+        MctpMessage response = std::move(slot.response);
+        impl_->ReleaseLocked(request.destination, slot);
+        return core::Result<MctpMessage>::Ok(std::move(response));
+    }
+    impl_->ReleaseLocked(request.destination, slot);
+    if (!IsRunning()) {
+        return core::Result<MctpMessage>::Err(core::ErrorCode::kCancelled);
+    }
+    impl_->stats.timeouts++;
+    return core::Result<MctpMessage>::Err(core::ErrorCode::kTimeout);
+}
+
+void MctpEndpoint::Cancel(const MctpRequest& request) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto& slot = impl_->Slot(request.destination, request.tag & 0x07);
+    if (slot.active && slot.id == request.id) {
+        impl_->ReleaseLocked(request.destination, slot);
+    }
+}
+
+core::Result<MctpMessage> MctpEndpoint::Request(Eid dest, uint8_t type, const core::Byte* body,
+                                                std::size_t length,
+                                                std::chrono::milliseconds timeout) {
+    auto request = Submit(dest, type, body, length);
+    if (request.IsError()) {
+        return core::Result<MctpMessage>::Err(request.Error());
+    }
+    return Wait(request.Value(), timeout);
+}
+
+core::Result<void> MctpEndpoint::Respond(const MctpMessage& request, uint8_t type,
+                                         const core::Byte* body, std::size_t length) {
+    if (request.Empty() || !request.TagOwner() || (body == nullptr && length > 0)) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    return impl_->SendMessage(request.Source(), false, request.Tag(), type, body, length);
+}
+
+std::size_t MctpEndpoint::Outstanding(Eid dest) const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->outstanding[dest];
+}
+
+MctpEndpoint::Stats MctpEndpoint::GetStats() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->stats;
+}
+
+MctpReassembler::Stats MctpEndpoint::ReassemblyStats() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->reassembly_stats;
+}
+
+MctpPacketPool::Stats MctpEndpoint::PoolStats() const { return impl_->pool.GetStats(); }
+
+}  // namespace plas::mctp
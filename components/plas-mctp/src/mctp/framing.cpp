@@ -0,0 +1,199 @@
+#include "plas/mctp/framing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "plas/core/error.h"
+
+namespace plas::mctp {
+
+namespace {
+
+constexpr uint8_t kSom = 0x80;
+constexpr uint8_t kEom = 0x40;
+constexpr uint8_t kTagOwner = 0x08;
+
+}  // namespace
+
+// --- MctpHeader --------------------------------------------------------------
+
+void MctpHeader::Encode(core::Byte* out) const {
+    out[0] = static_cast<core::Byte>(version & 0x0F);
+    out[1] = destination;
+    out[2] = source;
+    out[3] = static_cast<core::Byte>((som ? kSom : 0) | (eom ? kEom : 0) |
+                                     ((sequence & 0x03) << 4) | (tag_owner ? kTagOwner : 0) |
+                                     (tag & 0x07));
+}
+
+core::Result<MctpHeader> MctpHeader::Decode(const core::Byte* data, std::size_t length) {
+    if (data == nullptr || length < kHeaderSize) {
+        return core::Result<MctpHeader>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    MctpHeader header;
+    header.version = data[0] & 0x0F;
+    if (header.version != kVersion) {
+        return core::Result<MctpHeader>::Err(core::ErrorCode::kNotSupported);
+    }
+    header.destination = data[1];
+    header.source = data[2];
+    header.som = (data[3] & kSom) != 0;
+    header.eom = (data[3] & kEom) != 0;
+    header.sequence = (data[3] >> 4) & 0x03;
+    header.tag_owner = (data[3] & kTagOwner) != 0;
+    header.tag = data[3] & 0x07;
+    return core::Result<MctpHeader>::Ok(header);
+}
+
+// --- MctpFragmenter ----------------------------------------------------------
+
+MctpFragmenter::MctpFragmenter(const MctpHeader& header, uint8_t type,
+                               const core::Byte* body, std::size_t length, std::size_t mtu)
+    : header_(header),
+      type_(type),
+      body_(body),
+      mtu_(std::max<std::size_t>(mtu, 1)),
+      total_(1 + (body ? length : 0)) {}
+
+std::size_t MctpFragmenter::PacketCount() const { return (total_ + mtu_ - 1) / mtu_; }
+
+std::size_t MctpFragmenter::Next(core::Byte* out) {
+    if (Done()) {
+        return 0;
+    }
+    std::size_t n = std::min(mtu_, total_ - offset_);
+    header_.som = offset_ == 0;
+    header_.eom = offset_ + n == total_;
+    header_.sequence = sequence_;
+    header_.Encode(out);
+
+    core::Byte* payload = out + kHeaderSize;
+    std::size_t pos = offset_;
+    std::size_t left = n;
+    if (pos == 0) {
+        *payload++ = type_;
+        pos++;
+        left--;
+    }
+    if (left > 0) {
+        std::memcpy(payload, body_ + (pos - 1), left);
+    }
+    offset_ += n;
+    sequence_ = static_cast<uint8_t>((sequence_ + 1) & 0x03);
+    return kHeaderSize + n;
+}
+
+// --- MctpReassembler ---------------------------------------------------------
+
+MctpReassembler::MctpReassembler(MctpReassemblerOptions options)
+    : options_(options), contexts_(std::max<std::size_t>(options.contexts, 1)) {}
+
+MctpReassembler::~MctpReassembler() = default;
+
+MctpReassembler::Context* MctpReassembler::Find(Eid source, uint8_t tag, bool tag_owner) {
+    for (auto& context : contexts_) {
+        if (context.active && context.source == source && context.tag == tag &&
+            context.tag_owner == tag_owner) {
+            return &context;
+        }
+    }
+    return nullptr;
+}
+
+MctpReassembler::Context* MctpReassembler::Free() {
+    for (auto& context : contexts_) {
+        if (!context.active) {
+            return &context;
+        }
+    }
+    return nullptr;
+}
+
+void MctpReassembler::Drop(Context& context) {
+    context.active = false;
+    context.message.Clear();
+    stats_.dropped_messages++;
+}
+
+void MctpReassembler::Expire(Clock::time_point now) {
+    for (auto& context : contexts_) {
+        if (context.active && now - context.last_packet > options_.timeout) {
+            Drop(context);
+        }
+    }
+}
+
+std::size_t MctpReassembler::InProgress() const {
+    return static_cast<std::size_t>(std::count_if(
+        contexts_.begin(), contexts_.end(), [](const Context& c) { return c.active; }));
+}
+
+bool MctpReassembler::Push(MctpPacket packet, MctpMessage& out, Clock::time_point now) {
+    stats_.packets++;
+    Expire(now);
+
+    auto decoded = MctpHeader::Decode(packet.Data(), packet.Size());
+    std::size_t payload = packet.Size() > kHeaderSize ? packet.Size() - kHeaderSize : 0;
+    if (decoded.IsError() || payload == 0) {
+        stats_.dropped_packets++;
+        return false;
+    }
+    const MctpHeader& header = decoded.Value();
+    Context* context = Find(header.source, header.tag, header.tag_owner);
+
+    if (header.som) {
+        if (context) {
+            Drop(*context);  // restarted before its EOM
+        }
+        if (payload > options_.max_message) {
+            stats_.dropped_packets++;
+            return false;
+        }
+        if (header.eom) {
+            out = MctpMessage();
+            out.SetAddressing(header.source, header.destination, header.tag, header.tag_owner);
+            out.Append(std::move(packet));
+            stats_.messages++;
+            return true;
+        }
+        context = Free();
+        if (context == nullptr) {
+            stats_.dropped_packets++;
+            return false;
+        }
+        context->active = true;
+        context->source = header.source;
+        context->tag = header.tag;
+        context->tag_owner = header.tag_owner;
+        context->next_sequence = static_cast<uint8_t>((header.sequence + 1) & 0x03);
+        context->last_packet = now;
+        context->message.SetAddressing(header.source, header.destination, header.tag,
+                                       header.tag_owner);
+        context->message.Append(std::move(packet));
+        return false;
+    }
+
+    if (context == nullptr) {
+        stats_.dropped_packets++;
+        return false;
+    }
+    if (header.sequence != context->next_sequence ||
+        1 + context->message.Size() + payload > options_.max_message) {
+        Drop(*context);
+        stats_.dropped_packets++;
+        return false;
+    }
+    context->next_sequence = static_cast<uint8_t>((header.sequence + 1) & 0x03);
+    context->last_packet = now;
+    context->message.Append(std::move(packet));
+    if (!header.eom) {
+        return false;
+    }
+    out = std::move(context->message);
+    context->active = false;
+    stats_.messages++;
+    return true;
+}
+
+}  // namespace plas::mctp
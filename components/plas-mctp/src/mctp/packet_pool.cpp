@@ -0,0 +1,185 @@
+#include "plas/mctp/packet_pool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "plas/core/error.h"
+
+namespace plas::mctp {
+
+// --- MctpPacket --------------------------------------------------------------
+
+MctpPacket::MctpPacket(MctpPacket&& other) noexcept
+    : pool_(std::exchange(other.pool_, nullptr)), slot_(other.slot_) {}
+
+MctpPacket& MctpPacket::operator=(MctpPacket&& other) noexcept {
+    if (this != &other) {
+        Release();
+        pool_ = std::exchange(other.pool_, nullptr);
+        slot_ = other.slot_;
+    }
+    return *this;
+}
+
+core::Byte* MctpPacket::Data() { return pool_ ? pool_->SlotData(slot_) : nullptr; }
+
+const core::Byte* MctpPacket::Data() const {
+    return pool_ ? pool_->SlotData(slot_) : nullptr;
+}
+
+std::size_t MctpPacket::Size() const { return pool_ ? pool_->lengths_[slot_] : 0; }
+
+std::size_t MctpPacket::Capacity() const { return pool_ ? pool_->packet_size_ : 0; }
+
+void MctpPacket::Resize(std::size_t size) {
+    if (pool_) {
+        pool_->lengths_[slot_] = static_cast<uint32_t>(std::min(size, pool_->packet_size_));
+    }
+}
+
+void MctpPacket::Release() {
+    if (pool_) {
+        pool_->Release(slot_);
+        pool_ = nullptr;
+    }
+}
+
+uint32_t MctpPacket::Detach() {
+    pool_ = nullptr;
+    return slot_;
+}
+
+// --- MctpMessage -------------------------------------------------------------
+
+MctpMessage::MctpMessage(MctpMessage&& other) noexcept
+    : pool_(std::exchange(other.pool_, nullptr)),
+      head_(other.head_),
+      tail_(other.tail_),
+      packets_(std::exchange(other.packets_, 0)),
+      size_(std::exchange(other.size_, 0)),
+      source_(other.source_),
+      destination_(other.destination_),
+      tag_(other.tag_),
+      tag_owner_(other.tag_owner_) {}
+
+MctpMessage& MctpMessage::operator=(MctpMessage&& other) noexcept {
+    if (this != &other) {
+        Clear();
+        pool_ = std::exchange(other.pool_, nullptr);
+        head_ = other.head_;
+        tail_ = other.tail_;
+        packets_ = std::exchange(other.packets_, 0);
+        size_ = std::exchange(other.size_, 0);
+        source_ = other.source_;
+        destination_ = other.destination_;
+        tag_ = other.tag_;
+        tag_owner_ = other.tag_owner_;
+    }
+    return *this;
+}
+
+uint8_t MctpMessage::Type() const {
+    return packets_ > 0 ? pool_->SlotData(head_)[kHeaderSize] & 0x7F : 0;
+}
+
+bool MctpMessage::IntegrityCheck() const {
+    return packets_ > 0 && (pool_->SlotData(head_)[kHeaderSize] & 0x80) != 0;
+}
+
+std::size_t MctpMessage::CopyTo(core::Byte* out, std::size_t capacity,
+                                std::size_t offset) const {
+    std::size_t copied = 0;
+    ForEachFragment([&](const core::Byte* data, std::size_t length) {
+        if (offset >= length) {
+            offset -= length;
+            return;
+        }
+        std::size_t n = std::min(length - offset, capacity - copied);
+        std::memcpy(out + copied, data + offset, n);
+        copied += n;
+        offset = 0;
+    });
+    return copied;
+}
+
+std::vector<core::Byte> MctpMessage::ToVector() const {
+    std::vector<core::Byte> body(Size());
+    CopyTo(body.data(), body.size());
+    return body;
+}
+
+void MctpMessage::Append(MctpPacket packet) {
+    std::size_t min = packets_ == 0 ? kHeaderSize + 1 : kHeaderSize;
+    if (!packet.Valid() || packet.Size() < min || (pool_ && packet.pool_ != pool_)) {
+        return;
+    }
+    std::size_t length = packet.Size();
+    MctpPacketPool* pool = packet.pool_;
+    uint32_t slot = packet.Detach();
+    pool->next_[slot] = MctpPacketPool::kNoSlot;
+    if (packets_ == 0) {
+        pool_ = pool;
+        head_ = slot;
+    } else {
+        pool_->next_[tail_] = slot;
+    }
+    tail_ = slot;
+    packets_++;
+    size_ += length - kHeaderSize;
+}
+
+void MctpMessage::Clear() {
+    for (uint32_t slot = head_; packets_ > 0; --packets_) {
+        uint32_t next = pool_->next_[slot];
+        pool_->Release(slot);
+        slot = next;
+    }
+    size_ = 0;
+}
+
+// --- MctpPacketPool ----------------------------------------------------------
+
+MctpPacketPool::MctpPacketPool(std::size_t count, std::size_t packet_size)
+    : packet_size_(std::max(packet_size, kHeaderSize + 1)),
+      slab_(count * packet_size_),
+      lengths_(count, 0),
+      next_(count, kNoSlot) {
+    free_.reserve(count);
+    for (std::size_t i = count; i > 0; --i) {
+        free_.push_back(static_cast<uint32_t>(i - 1));
+    }
+}
+
+core::Result<MctpPacket> MctpPacketPool::Acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty()) {
+        stats_.exhausted++;
+        return core::Result<MctpPacket>::Err(core::ErrorCode::kResourceExhausted);
+    }
+    uint32_t slot = free_.back();
+    free_.pop_back();
+    lengths_[slot] = 0;
+    stats_.acquired++;
+    stats_.in_use++;
+    stats_.high_water = std::max(stats_.high_water, stats_.in_use);
+    return core::Result<MctpPacket>::Ok(MctpPacket(this, slot));
+}
+
+void MctpPacketPool::Release(uint32_t slot) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(slot);
+    stats_.in_use--;
+}
+
+std::size_t MctpPacketPool::Available() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_.size();
+}
+
+MctpPacketPool::Stats MctpPacketPool::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+}  // namespace plas::mctp
@@ -0,0 +1,156 @@
+#include "plas/mctp/smbus_binding.h"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/smbus.h"
+
+namespace plas::mctp {
+
+namespace {
+
+/// Byte count covers the source address, the header and the payload, and
+/// is itself one byte.
+constexpr std::size_t kMaxByteCount = 255;
+constexpr std::size_t kMaxPacket = kMaxByteCount - 1;
+constexpr std::size_t kMaxMtu = kMaxPacket - kHeaderSize;
+/// Command code, byte count, source address ... PEC.
+constexpr std::size_t kMaxFrame = 3 + kMaxPacket + 1;
+
+}  // namespace
+
+struct MctpSmbusBinding::Impl {
+    struct Slot {
+        std::array<core::Byte, kMaxPacket> packet;
+        std::size_t length = 0;
+        MctpPhysAddr source = 0;
+    };
+
+    Impl(hal::I2c& b, core::Address addr, MctpSmbusOptions opts)
+        : bus(b),
+          own_addr(addr),
+          options(opts),
+          inbound(std::max<std::size_t>(opts.inbound_depth, 1)) {
+        options.mtu = std::clamp(options.mtu, kBaselineMtu, kMaxMtu);
+    }
+
+    hal::I2c& bus;
+    core::Address own_addr;
+    MctpSmbusOptions options;
+
+    std::mutex send_mutex;  ///< frame below is reused for every send
+    std::array<core::Byte, kMaxFrame> frame{};
+
+    mutable std::mutex mutex;
+    std::condition_variable ready;
+    std::vector<Slot> inbound;  ///< ring, allocated once
+    std::size_t head = 0;
+    std::size_t count = 0;
+    Stats stats;
+};
+
+MctpSmbusBinding::MctpSmbusBinding(hal::I2c& bus, core::Address own_addr,
+                                   MctpSmbusOptions options)
+    : impl_(std::make_unique<Impl>(bus, own_addr, options)) {}
+
+MctpSmbusBinding::~MctpSmbusBinding() = default;
+
+std::size_t MctpSmbusBinding::Mtu() const { return impl_->options.mtu; }
+
+uint8_t MctpSmbusBinding::Pec(const core::Byte* data, std::size_t length, uint8_t crc) {
+    return hal::SmBusPec(data, length, crc);
+}
+
+core::Result<void> MctpSmbusBinding::Send(MctpPhysAddr dest, const core::Byte* packet,
+                                          std::size_t length) {
+    if (packet == nullptr || length < kHeaderSize || length > kHeaderSize + impl_->options.mtu ||
+        dest > 0x7F) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::lock_guard<std::mutex> lock(impl_->send_mutex);
+    auto& frame = impl_->frame;
+    frame[0] = kCommandCode;
+    frame[1] = static_cast<core::Byte>(1 + length);
+    frame[2] = static_cast<core::Byte>((impl_->own_addr << 1) | 1);
+    std::memcpy(frame.data() + 3, packet, length);
+    std::size_t size = 3 + length;
+    if (impl_->options.pec) {
+        core::Byte addr = static_cast<core::Byte>(dest << 1);
+        frame[size] = Pec(frame.data(), size, Pec(&addr, 1));
+        size++;
+    }
+    auto result = impl_->bus.Write(dest, frame.data(), size);
+    if (result.IsError()) {
+        return core::Result<void>::Err(result.Error());
+    }
+    std::lock_guard<std::mutex> stats_lock(impl_->mutex);
+    impl_->stats.sent++;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> MctpSmbusBinding::Deliver(const core::Byte* frame, std::size_t length) {
+    std::size_t trailer = impl_->options.pec ? 1 : 0;
+    auto reject = [&](core::ErrorCode code) {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        impl_->stats.rejected++;
+        return core::Result<void>::Err(code);
+    };
+    if (frame == nullptr || length < 3 + kHeaderSize + trailer || frame[0] != kCommandCode ||
+        frame[1] != length - 2 - trailer) {
+        return reject(core::ErrorCode::kInvalidArgument);
+    }
+    if (impl_->options.pec) {
+        core::Byte addr = static_cast<core::Byte>(impl_->own_addr << 1);
+        if (Pec(frame, length - 1, Pec(&addr, 1)) != frame[length - 1]) {
+            return reject(core::ErrorCode::kDataLoss);
+        }
+    }
+
+    std::size_t packet = frame[1] - 1u;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        if (impl_->count == impl_->inbound.size()) {
+            impl_->stats.overflows++;
+            return core::Result<void>::Err(core::ErrorCode::kResourceExhausted);
+        }
+        auto& slot = impl_->inbound[(impl_->head + impl_->count) % impl_->inbound.size()];
+        std::memcpy(slot.packet.data(), frame + 3, packet);
+        slot.length = packet;
+        slot.source = frame[2] >> 1;
+        impl_->count++;
+        impl_->stats.delivered++;
+    }
+    impl_->ready.notify_one();
+    return core::Result<void>::Ok();
+}
+
+core::Result<std::size_t> MctpSmbusBinding::Receive(core::Byte* out, std::size_t capacity,
+                                                    MctpPhysAddr& source,
+                                                    std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(impl_->mutex);
+    if (!impl_->ready.wait_for(lock, timeout, [this] { return impl_->count > 0; })) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kTimeout);
+    }
+    auto& slot = impl_->inbound[impl_->head];
+    impl_->head = (impl_->head + 1) % impl_->inbound.size();
+    impl_->count--;
+    if (out == nullptr || slot.length > capacity) {
+        return core::Result<std::size_t>::Err(core::ErrorCode::kOverflow);
+    }
+    std::memcpy(out, slot.packet.data(), slot.length);
+    source = slot.source;
+    return core::Result<std::size_t>::Ok(slot.length);
+}
+
+MctpSmbusBinding::Stats MctpSmbusBinding::GetStats() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->stats;
+}
+
+}  // namespace plas::mctp
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/config/device_uri.h"
+#include "plas/core/error.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_interfaces.h"
+#include "plas/hal/transaction_proxy.h"
+#include "plas/hal/transaction_trace.h"
+
+namespace plas::remote {
+
+namespace detail {
+class RemoteConnection;
+
+/// Where a RemoteDevice's calls go (parsed URI and args).
+struct RemoteEndpoint {
+    std::string host;
+    uint16_t port = 0;
+    std::string nickname;
+    int timeout_ms = 5000;
+    int connect_timeout_ms = 3000;
+};
+}  // namespace detail
+
+/// A device served by a RemoteServer on another host. It implements the
+/// remote device's I2c / PciConfig / PciDoe / PciBar interfaces; each call
+/// is one request on a TCP connection shared by all devices of that server.
+///
+/// URI: remote://host[:port]/nickname — server (port default 7700) and the
+///      nickname of the device in the server's DeviceManager
+///
+/// Optional DeviceEntry args:
+///   timeout_ms         — per-request reply timeout (default 5000)
+///   connect_timeout_ms — TCP connect timeout (default 3000)
+///
+/// The server is contacted when the device is created, to learn its
+/// interfaces; if it cannot be reached the device has none and Init()
+/// reports the error. Requests carry ids, so calls from several threads
+/// are pipelined on the connection rather than waiting for each other's
+/// round trips; I2c::Transfer() sends its messages as one batch, and
+/// ExecuteBatch()/Submit() do the same for any calls. A lost connection
+/// fails outstanding and later calls with kIOError until Open() or Reset()
+/// reconnects.
+class RemoteDevice : public hal::Device, public hal::TransactionPort {
+public:
+    ~RemoteDevice() override;
+
+    // Device interface
+    core::Result<void> Init() override;
+    core::Result<void> Open() override;
+    core::Result<void> Close() override;
+    core::Result<void> Reset() override;
+    hal::DeviceState GetState() const override;
+    std::string GetName() const override;
+    std::string GetUri() const override;
+    std::string GetDriverName() const override;
+
+    using Interfaces = hal::InterfaceList<>;
+    void* QueryInterface(hal::InterfaceKind kind) override {
+        return hal::QueryInterfaceOf(this, kind, Interfaces{});
+    }
+
+    /// Driver of the device on the server (e.g. "aardvark").
+    std::string GetRemoteDriverName() const;
+
+    core::Result<void> Execute(hal::TraceRecord& call) override;
+
+    /// One request for the whole batch (split above 65536 calls).
+    core::Result<void> ExecuteBatch(hal::TraceRecord* calls, std::size_t count) override;
+
+    /// Send `calls` as one request without waiting. The future yields the
+    /// calls with their outputs and per-call errors (as ExecuteBatch), or
+    /// the request's error; it is not bounded by timeout_ms. Keep several
+    /// in flight to hide the round trip.
+    std::future<core::Result<std::vector<hal::TraceRecord>>> Submit(
+        std::vector<hal::TraceRecord> calls);
+
+    /// A RemoteDevice with the remote device's interfaces. Problems with
+    /// the URI, args or server are reported by Init().
+    static std::unique_ptr<hal::Device> Create(const config::DeviceEntry& entry,
+                                               const config::DeviceUri& uri);
+
+    /// Register this driver with the DeviceFactory.
+    static void Register();
+
+protected:
+    RemoteDevice(const config::DeviceEntry& entry, detail::RemoteEndpoint endpoint,
+                 std::shared_ptr<detail::RemoteConnection> connection, uint64_t handle,
+                 std::string remote_driver, core::ErrorCode init_error);
+
+private:
+    /// Connect and attach again if the connection was lost. Caller holds
+    /// mutex_.
+    core::Result<void> ReconnectLocked();
+
+    const config::DeviceEntry entry_;
+    const detail::RemoteEndpoint endpoint_;
+    const std::string remote_driver_;
+    const core::ErrorCode init_error_;
+
+    mutable std::mutex mutex_;
+    std::shared_ptr<detail::RemoteConnection> connection_;  // guarded by mutex_
+    uint64_t handle_ = 0;                                   // guarded by mutex_
+    std::atomic<hal::DeviceState> state_{hal::DeviceState::kUninitialized};
+};
+
+}  // namespace plas::remote
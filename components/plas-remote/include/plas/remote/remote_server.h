@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "plas/core/result.h"
+#include "plas/hal/device_manager.h"
+
+namespace plas::remote {
+
+/// Default TCP port of RemoteServer and the remote:// driver.
+inline constexpr uint16_t kDefaultPort = 7700;
+
+struct RemoteServerOptions {
+    /// Loopback only by default: the server has no authentication, so
+    /// serving other hosts takes an explicit lab-internal address.
+    std::string bind_address = "127.0.0.1";
+    uint16_t port = kDefaultPort;  ///< 0 = any free port (see Port())
+    std::size_t workers = 4;       ///< threads running device calls
+};
+
+/// Serves the I2c / PciConfig / PciDoe / PciBar interfaces of a
+/// DeviceManager's devices to remote:// clients (RemoteDevice) over TCP.
+///
+/// Each connection has a reader thread that decodes requests; a client may
+/// pipeline any number of them and each may carry a batch of calls. Calls
+/// for one device go through that device's queue and run one batch at a
+/// time in arrival order, on a pool of `workers` threads, so different
+/// devices proceed in parallel while each device sees its calls serialized.
+/// Devices are looked up by nickname per batch (with the manager's lazy
+/// open, if enabled), so a reloaded device is picked up by the next batch.
+///
+/// There is no authentication: it listens on loopback unless given a
+/// lab-internal interface to bind. A connection holds one handle per
+/// attached device; attaching the same device again reuses it.
+class RemoteServer {
+public:
+    struct Stats {
+        uint64_t connections = 0;  ///< accepted since Start()
+        uint64_t attachments = 0;  ///< device handles handed out (re-attaches reuse one)
+        uint64_t requests = 0;     ///< Call frames served
+        uint64_t calls = 0;        ///< HAL calls run
+        uint64_t errors = 0;       ///< protocol errors (connection dropped)
+    };
+
+    explicit RemoteServer(hal::DeviceManager& manager = hal::DeviceManager::GetInstance());
+    ~RemoteServer();
+
+    RemoteServer(const RemoteServer&) = delete;
+    RemoteServer& operator=(const RemoteServer&) = delete;
+
+    /// Listen and start serving. kAlreadyOpen if running, kInvalidArgument
+    /// for a bad address or zero workers, kIOError if bind/listen fails.
+    core::Result<void> Start(const RemoteServerOptions& options = {});
+
+    /// Close the listener and every connection; waits for running batches.
+    void Stop();
+
+    bool IsRunning() const;
+
+    /// The bound port (the chosen one when started with port 0).
+    uint16_t Port() const;
+
+    Stats GetStats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::remote
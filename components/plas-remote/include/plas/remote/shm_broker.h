@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "plas/core/result.h"
+#include "plas/hal/device_manager.h"
+
+namespace plas::remote {
+
+/// Broker name used by ShmBroker and the shm:// driver when none is given.
+inline constexpr const char* kDefaultBrokerName = "plas";
+
+struct ShmBrokerOptions {
+    std::string name = kDefaultBrokerName;  ///< letters, digits, '-', '_'
+    uint32_t slots = 16;                    ///< client devices attached at once
+    std::size_t ring_bytes = 256 * 1024;    ///< per direction per slot; largest
+                                            ///< request or reply frame
+};
+
+/// Serves the I2c / PciConfig / PciDoe / PciBar interfaces of a
+/// DeviceManager's devices to shm:// clients (ShmDevice) in other processes
+/// on the same host, through shared memory.
+///
+/// The process that owns an adapter handle (Aardvark, FT4222H, ...) runs
+/// the broker; tools that need the same adapter at the same time attach to
+/// it instead of opening the hardware. The region holds `slots` pairs of
+/// lock-free request/reply rings, one pair per attached client device,
+/// each served by its own broker thread; an idle side sleeps on a futex,
+/// so a round trip costs microseconds rather than a TCP exchange. Calls of
+/// one batch run back to back under a per-device lock, so batches from
+/// different clients never interleave on a device. Slots of client
+/// processes that die are reclaimed.
+///
+/// Linux only. Access is governed by the shared-memory object's mode
+/// (owner only); clients must run as the same user.
+class ShmBroker {
+public:
+    struct Stats {
+        uint64_t attaches = 0;   ///< devices attached since Start()
+        uint64_t requests = 0;   ///< Call frames served
+        uint64_t calls = 0;      ///< HAL calls run
+        uint64_t reclaimed = 0;  ///< slots freed after their client died
+        uint64_t errors = 0;     ///< malformed or undeliverable frames
+    };
+
+    explicit ShmBroker(hal::DeviceManager& manager = hal::DeviceManager::GetInstance());
+    ~ShmBroker();
+
+    ShmBroker(const ShmBroker&) = delete;
+    ShmBroker& operator=(const ShmBroker&) = delete;
+
+    /// Create the shared-memory region and start serving. kAlreadyOpen if
+    /// running or another live broker has the name, kInvalidArgument for a
+    /// bad name, slot count or ring size, kPermissionDenied / kIOError if
+    /// the region cannot be created.
+    core::Result<void> Start(const ShmBrokerOptions& options = {});
+
+    /// Stop serving and remove the region; waits for running batches.
+    /// Attached clients fail with kIOError until the broker is back and
+    /// they Reset().
+    void Stop();
+
+    bool IsRunning() const;
+
+    Stats GetStats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace plas::remote
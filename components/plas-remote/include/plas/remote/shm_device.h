@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "plas/config/device_entry.h"
+#include "plas/config/device_uri.h"
+#include "plas/core/error.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_interfaces.h"
+#include "plas/hal/transaction_proxy.h"
+#include "plas/hal/transaction_trace.h"
+
+namespace plas::remote {
+
+namespace detail {
+class ShmClient;
+
+/// Where a ShmDevice's calls go (parsed URI and args).
+struct ShmEndpoint {
+    std::string broker;
+    std::string nickname;
+    int timeout_ms = 5000;
+};
+}  // namespace detail
+
+/// A device served by a ShmBroker in another process on this host. It
+/// implements the brokered device's I2c / PciConfig / PciDoe / PciBar
+/// interfaces; each call is one round trip through the device's own pair
+/// of shared-memory rings.
+///
+/// URI: shm://broker:nickname — ShmBroker name and the nickname of the
+///      device in the broker's DeviceManager
+///
+/// Optional DeviceEntry args:
+///   timeout_ms — per-request reply timeout (default 5000)
+///
+/// The broker is contacted when the device is created, to claim a slot and
+/// learn the interfaces; if it is not running the device has none and
+/// Init() reports the error. I2c::Transfer() and ExecuteBatch() send their
+/// calls as one request, which the broker runs without interleaving other
+/// clients' calls on that device. A request or reply larger than the
+/// broker's ring_bytes fails with kOverflow. Once the broker stops, calls
+/// fail with kIOError until Open() or Reset() attaches again. Linux only.
+class ShmDevice : public hal::Device, public hal::TransactionPort {
+public:
+    ~ShmDevice() override;
+
+    // Device interface
+    core::Result<void> Init() override;
+    core::Result<void> Open() override;
+    core::Result<void> Close() override;
+    core::Result<void> Reset() override;
+    hal::DeviceState GetState() const override;
+    std::string GetName() const override;
+    std::string GetUri() const override;
+    std::string GetDriverName() const override;
+
+    using Interfaces = hal::InterfaceList<>;
+    void* QueryInterface(hal::InterfaceKind kind) override {
+        return hal::QueryInterfaceOf(this, kind, Interfaces{});
+    }
+
+    /// Driver of the device in the broker (e.g. "aardvark").
+    std::string GetRemoteDriverName() const;
+
+    core::Result<void> Execute(hal::TraceRecord& call) override;
+
+    /// One request for the whole batch.
+    core::Result<void> ExecuteBatch(hal::TraceRecord* calls, std::size_t count) override;
+
+    /// A ShmDevice with the brokered device's interfaces. Problems with the
+    /// URI, args or broker are reported by Init().
+    static std::unique_ptr<hal::Device> Create(const config::DeviceEntry& entry,
+                                               const config::DeviceUri& uri);
+
+    /// Register this driver with the DeviceFactory.
+    static void Register();
+
+protected:
+    ShmDevice(const config::DeviceEntry& entry, detail::ShmEndpoint endpoint,
+              std::unique_ptr<detail::ShmClient> client, uint64_t handle,
+              std::string remote_driver, core::ErrorCode init_error);
+
+private:
+    /// Claim a slot and attach again if the broker was restarted. Caller
+    /// holds mutex_.
+    core::Result<void> ReconnectLocked();
+
+    const config::DeviceEntry entry_;
+    const detail::ShmEndpoint endpoint_;
+    const std::string remote_driver_;
+    const core::ErrorCode init_error_;
+
+    mutable std::mutex mutex_;  // one request in flight per slot
+    std::unique_ptr<detail::ShmClient> client_;  // guarded by mutex_
+    uint64_t handle_ = 0;                        // guarded by mutex_
+    std::atomic<hal::DeviceState> state_{hal::DeviceState::kUninitialized};
+};
+
+}  // namespace plas::remote
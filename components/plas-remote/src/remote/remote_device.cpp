@@ -0,0 +1,430 @@
+#include "plas/remote/remote_device.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "plas/hal/interface/device_factory.h"
+#include "plas/log/logger.h"
+#include "plas/remote/remote_server.h"
+#include "remote/remote_protocol.h"
+
+namespace plas::remote {
+
+using detail::FrameReader;
+using detail::FrameType;
+using detail::FrameWriter;
+
+namespace detail {
+
+/// One TCP connection to a RemoteServer, shared by the RemoteDevices of
+/// that server. Requests are matched to replies by id on a reader thread.
+class RemoteConnection {
+public:
+    /// Called with the reply (positioned after the header), or with
+    /// nullptr if the connection was lost first.
+    using Callback = std::function<void(FrameReader*)>;
+
+    /// The open connection to host:port, connecting if there is none.
+    static core::Result<std::shared_ptr<RemoteConnection>> Get(const RemoteEndpoint& endpoint);
+
+    explicit RemoteConnection(int fd)
+        : channel_(fd), reader_([this] { ReadLoop(); }) {}
+
+    ~RemoteConnection() {
+        channel_.Shutdown();
+        reader_.join();
+    }
+
+    RemoteConnection(const RemoteConnection&) = delete;
+    RemoteConnection& operator=(const RemoteConnection&) = delete;
+
+    bool IsOpen() const { return channel_.IsOpen(); }
+
+    uint64_t NextId() { return next_id_.fetch_add(1, std::memory_order_relaxed); }
+
+    /// Send `frame` (built with request id `id`); `callback` runs on the
+    /// reader thread. False (callback not called) if the connection is lost.
+    bool Request(uint64_t id, std::vector<uint8_t> frame, Callback callback) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!IsOpen()) return false;
+            pending_.emplace(id, std::move(callback));
+        }
+        if (!channel_.Send(std::move(frame))) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // The reader may have failed it already.
+            return pending_.erase(id) == 0;
+        }
+        return true;
+    }
+
+private:
+    void ReadLoop() {
+        std::vector<uint8_t> payload;
+        while (channel_.Receive(payload)) {
+            FrameReader in(payload);
+            FrameType type{};
+            uint64_t id = 0;
+            if (!in.Header(type, id)) break;
+            Callback callback;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = pending_.find(id);
+                if (it == pending_.end()) continue;  // abandoned by a timeout
+                callback = std::move(it->second);
+                pending_.erase(it);
+            }
+            callback(&in);
+        }
+        channel_.Shutdown();
+        std::unordered_map<uint64_t, Callback> lost;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            lost.swap(pending_);
+        }
+        for (auto& [id, callback] : lost) {
+            callback(nullptr);
+        }
+    }
+
+    FrameChannel channel_;
+    std::atomic<uint64_t> next_id_{1};
+    std::mutex mutex_;
+    std::unordered_map<uint64_t, Callback> pending_;  // guarded by mutex_
+    std::thread reader_;
+};
+
+core::Result<std::shared_ptr<RemoteConnection>> RemoteConnection::Get(
+    const RemoteEndpoint& endpoint) {
+    using Shared = std::shared_ptr<RemoteConnection>;
+    static std::mutex pool_mutex;
+    static std::map<std::string, std::weak_ptr<RemoteConnection>> pool;
+
+    const std::string key = endpoint.host + ":" + std::to_string(endpoint.port);
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (auto shared = pool[key].lock(); shared && shared->IsOpen()) {
+        return core::Result<Shared>::Ok(std::move(shared));
+    }
+    core::ErrorCode error = core::ErrorCode::kSuccess;
+    int fd = ConnectTcp(endpoint.host, endpoint.port, endpoint.connect_timeout_ms, error);
+    if (fd < 0) {
+        PLAS_LOG_ERROR("RemoteDevice: cannot connect to " + key);
+        return core::Result<Shared>::Err(error);
+    }
+    auto shared = std::make_shared<RemoteConnection>(fd);
+    pool[key] = shared;
+    return core::Result<Shared>::Ok(std::move(shared));
+}
+
+}  // namespace detail
+
+namespace {
+
+using detail::Attachment;
+using detail::RemoteConnection;
+using detail::RemoteEndpoint;
+
+/// Wait for `future` at most `timeout_ms`.
+template <typename T>
+core::Result<T> Await(std::future<core::Result<T>>& future, int timeout_ms) {
+    if (future.wait_for(std::chrono::milliseconds(timeout_ms)) != std::future_status::ready) {
+        return core::Result<T>::Err(core::ErrorCode::kTimeout);
+    }
+    return future.get();
+}
+
+/// Look up the endpoint's nickname on the server.
+core::Result<Attachment> Attach(RemoteConnection& connection, const RemoteEndpoint& endpoint) {
+    auto promise = std::make_shared<std::promise<core::Result<Attachment>>>();
+    auto future = promise->get_future();
+    const uint64_t id = connection.NextId();
+    FrameWriter frame(FrameType::kAttach, id);
+    frame.Varint(detail::kProtocolVersion);
+    frame.String(endpoint.nickname);
+    bool sent = connection.Request(id, frame.Finish(), [promise](FrameReader* in) {
+        Attachment attachment;
+        auto status = in != nullptr ? detail::GetAttachReply(*in, attachment)
+                                    : core::ErrorCode::kIOError;
+        if (status != core::ErrorCode::kSuccess) {
+            promise->set_value(core::Result<Attachment>::Err(status));
+        } else {
+            promise->set_value(core::Result<Attachment>::Ok(std::move(attachment)));
+        }
+    });
+    if (!sent) {
+        return core::Result<Attachment>::Err(core::ErrorCode::kIOError);
+    }
+    return Await(future, endpoint.timeout_ms);
+}
+
+/// "host[:port]/nickname" plus the timeout args.
+bool ParseEndpoint(const config::DeviceEntry& entry, const config::DeviceUri& uri,
+                   RemoteEndpoint& endpoint) {
+    if (!uri.IsValid() || uri.Scheme() != "remote") {
+        return false;
+    }
+    std::string_view authority = uri.Authority();
+    auto slash = authority.find('/');
+    if (slash == std::string_view::npos || slash + 1 == authority.size()) {
+        return false;
+    }
+    endpoint.nickname = std::string(authority.substr(slash + 1));
+    std::string_view host = authority.substr(0, slash);
+    endpoint.port = kDefaultPort;
+    auto colon = host.find(':');
+    if (colon != std::string_view::npos) {
+        uint64_t port = 0;
+        if (!config::DeviceUri::ParseNumber(host.substr(colon + 1), 10, 65535, port) ||
+            port == 0) {
+            return false;
+        }
+        endpoint.port = static_cast<uint16_t>(port);
+        host = host.substr(0, colon);
+    }
+    endpoint.host = std::string(host);
+    return !endpoint.host.empty() &&
+           detail::ParseTimeoutArg(entry, "timeout_ms", endpoint.timeout_ms) &&
+           detail::ParseTimeoutArg(entry, "connect_timeout_ms", endpoint.connect_timeout_ms);
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Constructor / Destructor
+// ---------------------------------------------------------------------------
+
+RemoteDevice::RemoteDevice(const config::DeviceEntry& entry, detail::RemoteEndpoint endpoint,
+                           std::shared_ptr<detail::RemoteConnection> connection,
+                           uint64_t handle, std::string remote_driver,
+                           core::ErrorCode init_error)
+    : entry_(entry),
+      endpoint_(std::move(endpoint)),
+      remote_driver_(std::move(remote_driver)),
+      init_error_(init_error),
+      connection_(std::move(connection)),
+      handle_(handle) {}
+
+RemoteDevice::~RemoteDevice() = default;
+
+// ---------------------------------------------------------------------------
+// Device interface
+// ---------------------------------------------------------------------------
+
+core::Result<void> RemoteDevice::Init() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != hal::DeviceState::kUninitialized && state_ != hal::DeviceState::kClosed) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (init_error_ != core::ErrorCode::kSuccess) {
+        PLAS_LOG_ERROR("RemoteDevice::Init() failed for device='" + entry_.nickname +
+                       "' uri=" + entry_.uri);
+        return core::Result<void>::Err(init_error_);
+    }
+    state_ = hal::DeviceState::kInitialized;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> RemoteDevice::Open() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != hal::DeviceState::kInitialized && state_ != hal::DeviceState::kClosed) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    auto connected = ReconnectLocked();
+    if (connected.IsError()) {
+        return connected;
+    }
+    state_ = hal::DeviceState::kOpen;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> RemoteDevice::Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != hal::DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyClosed);
+    }
+    state_ = hal::DeviceState::kClosed;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> RemoteDevice::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ == hal::DeviceState::kUninitialized) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    return ReconnectLocked();
+}
+
+hal::DeviceState RemoteDevice::GetState() const {
+    return state_;
+}
+
+std::string RemoteDevice::GetName() const {
+    return entry_.nickname;
+}
+
+std::string RemoteDevice::GetUri() const {
+    return entry_.uri;
+}
+
+std::string RemoteDevice::GetDriverName() const {
+    return "remote";
+}
+
+std::string RemoteDevice::GetRemoteDriverName() const {
+    return remote_driver_;
+}
+
+core::Result<void> RemoteDevice::ReconnectLocked() {
+    if (connection_ && connection_->IsOpen()) {
+        return core::Result<void>::Ok();
+    }
+    auto connection = RemoteConnection::Get(endpoint_);
+    if (connection.IsError()) {
+        return core::Result<void>::Err(connection.Error());
+    }
+    auto attached = Attach(*connection.Value(), endpoint_);
+    if (attached.IsError()) {
+        return core::Result<void>::Err(attached.Error());
+    }
+    connection_ = std::move(connection).Value();
+    handle_ = attached.Value().handle;
+    return core::Result<void>::Ok();
+}
+
+// ---------------------------------------------------------------------------
+// Calls
+// ---------------------------------------------------------------------------
+
+std::future<core::Result<std::vector<hal::TraceRecord>>> RemoteDevice::Submit(
+    std::vector<hal::TraceRecord> calls) {
+    using Calls = std::vector<hal::TraceRecord>;
+    struct Pending {
+        std::promise<core::Result<Calls>> promise;
+        Calls calls;
+    };
+    auto pending = std::make_shared<Pending>();
+    auto future = pending->promise.get_future();
+    auto fail = [&](core::ErrorCode error) {
+        pending->promise.set_value(core::Result<Calls>::Err(error));
+        return std::move(future);
+    };
+
+    if (state_ != hal::DeviceState::kOpen) {
+        return fail(core::ErrorCode::kNotInitialized);
+    }
+    if (calls.size() > detail::kMaxBatchCalls) {
+        return fail(core::ErrorCode::kInvalidArgument);
+    }
+    std::shared_ptr<RemoteConnection> connection;
+    uint64_t handle = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connection = connection_;
+        handle = handle_;
+    }
+    if (!connection) {
+        return fail(core::ErrorCode::kIOError);
+    }
+
+    const uint64_t id = connection->NextId();
+    FrameWriter frame(FrameType::kCall, id);
+    frame.Varint(handle);
+    frame.Varint(calls.size());
+    for (const auto& call : calls) {
+        detail::PutCall(frame, call);
+    }
+    pending->calls = std::move(calls);
+    bool sent = connection->Request(id, frame.Finish(), [pending](FrameReader* in) {
+        auto status = in != nullptr ? detail::GetCallReply(*in, pending->calls)
+                                    : core::ErrorCode::kIOError;
+        if (status != core::ErrorCode::kSuccess) {
+            pending->promise.set_value(core::Result<Calls>::Err(status));
+        } else {
+            pending->promise.set_value(core::Result<Calls>::Ok(std::move(pending->calls)));
+        }
+    });
+    if (!sent) {
+        return fail(core::ErrorCode::kIOError);
+    }
+    return future;
+}
+
+core::Result<void> RemoteDevice::ExecuteBatch(hal::TraceRecord* calls, std::size_t count) {
+    std::size_t done = 0;
+    while (done < count) {
+        const std::size_t chunk = std::min(count - done, detail::kMaxBatchCalls);
+        auto future = Submit(std::vector<hal::TraceRecord>(calls + done, calls + done + chunk));
+        auto result = Await(future, endpoint_.timeout_ms);
+        if (result.IsError()) {
+            return core::Result<void>::Err(result.Error());
+        }
+        bool failed = false;
+        for (auto& served : result.Value()) {
+            hal::TraceRecord& call = calls[done++];
+            call.value = served.value;
+            call.response = std::move(served.response);
+            call.error = served.error;
+            failed = failed || call.error != core::ErrorCode::kSuccess;
+        }
+        if (failed) {
+            for (; done < count; ++done) {
+                calls[done].error = core::ErrorCode::kCancelled;
+            }
+        }
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> RemoteDevice::Execute(hal::TraceRecord& call) {
+    auto sent = ExecuteBatch(&call, 1);
+    if (sent.IsError()) {
+        return sent;
+    }
+    if (call.error != core::ErrorCode::kSuccess) {
+        return core::Result<void>::Err(call.error);
+    }
+    return core::Result<void>::Ok();
+}
+
+// ---------------------------------------------------------------------------
+// Factory
+// ---------------------------------------------------------------------------
+
+std::unique_ptr<hal::Device> RemoteDevice::Create(const config::DeviceEntry& entry,
+                                                  const config::DeviceUri& uri) {
+    RemoteEndpoint endpoint;
+    if (!ParseEndpoint(entry, uri, endpoint)) {
+        return hal::MakeTransactionProxy<RemoteDevice>(0, entry, std::move(endpoint), nullptr,
+                                                       uint64_t{0}, "",
+                                                       core::ErrorCode::kInvalidArgument);
+    }
+    auto connection = RemoteConnection::Get(endpoint);
+    auto attached = connection.IsOk()
+                        ? Attach(*connection.Value(), endpoint)
+                        : core::Result<Attachment>::Err(connection.Error());
+    if (attached.IsError()) {
+        PLAS_LOG_ERROR("RemoteDevice: cannot attach " + endpoint.nickname + " on " +
+                       endpoint.host + ": " + attached.Error().message());
+        return hal::MakeTransactionProxy<RemoteDevice>(0, entry, std::move(endpoint), nullptr,
+                                                       uint64_t{0}, "",
+                                                       detail::CodeOf(attached.Error()));
+    }
+    Attachment attachment = std::move(attached).Value();
+    return hal::MakeTransactionProxy<RemoteDevice>(
+        attachment.interfaces, entry, std::move(endpoint), std::move(connection).Value(),
+        attachment.handle, std::move(attachment.driver), core::ErrorCode::kSuccess);
+}
+
+void RemoteDevice::Register() {
+    hal::DeviceFactory::RegisterDriver(
+        "remote", [](const config::DeviceEntry& entry, const config::DeviceUri& uri) {
+            return Create(entry, uri);
+        });
+}
+
+}  // namespace plas::remote
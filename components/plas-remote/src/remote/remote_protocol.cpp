@@ -0,0 +1,372 @@
+#include "remote/remote_protocol.h"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <utility>
+
+#include "plas/config/device_uri.h"
+#include "plas/hal/transaction_proxy.h"
+
+namespace plas::remote::detail {
+
+namespace {
+
+constexpr std::size_t kLengthSize = 4;
+constexpr std::size_t kReceiveChunk = 64 * 1024;
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// FrameWriter / FrameReader
+// ---------------------------------------------------------------------------
+
+FrameWriter::FrameWriter(FrameType type, uint64_t request_id) {
+    bytes_.resize(kLengthSize);
+    Byte(static_cast<uint8_t>(type));
+    Varint(request_id);
+}
+
+void FrameWriter::Varint(uint64_t value) {
+    while (value >= 0x80) {
+        bytes_.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes_.push_back(static_cast<uint8_t>(value));
+}
+
+void FrameWriter::Bytes(const uint8_t* data, std::size_t size) {
+    Varint(size);
+    bytes_.insert(bytes_.end(), data, data + size);
+}
+
+void FrameWriter::String(const std::string& text) {
+    Bytes(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+std::vector<uint8_t> FrameWriter::Finish() {
+    const std::size_t size = bytes_.size() - kLengthSize;
+    for (std::size_t i = 0; i < kLengthSize; ++i) {
+        bytes_[i] = static_cast<uint8_t>(size >> (8 * i));
+    }
+    return std::move(bytes_);
+}
+
+bool FrameReader::Byte(uint8_t& out) {
+    if (pos_ == end_) return false;
+    out = *pos_++;
+    return true;
+}
+
+bool FrameReader::Varint(uint64_t& out) {
+    out = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        uint8_t b = 0;
+        if (!Byte(b)) return false;
+        out |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+bool FrameReader::Bytes(std::vector<uint8_t>& out) {
+    uint64_t size = 0;
+    if (!Varint(size) || size > static_cast<uint64_t>(end_ - pos_)) return false;
+    out.assign(pos_, pos_ + size);
+    pos_ += size;
+    return true;
+}
+
+bool FrameReader::String(std::string& out) {
+    uint64_t size = 0;
+    if (!Varint(size) || size > static_cast<uint64_t>(end_ - pos_)) return false;
+    out.assign(reinterpret_cast<const char*>(pos_), static_cast<std::size_t>(size));
+    pos_ += size;
+    return true;
+}
+
+bool FrameReader::Header(FrameType& type, uint64_t& request_id) {
+    uint8_t raw = 0;
+    if (!Byte(raw) || !Varint(request_id)) return false;
+    type = static_cast<FrameType>(raw);
+    return true;
+}
+
+void PutCall(FrameWriter& out, const hal::TraceRecord& call) {
+    out.Byte(static_cast<uint8_t>(call.op));
+    out.Varint(call.target);
+    out.Varint(call.offset);
+    out.Varint(call.arg);
+    out.Varint(call.length);
+    out.Varint(call.value);
+    out.Bytes(call.request.data(), call.request.size());
+}
+
+bool GetCall(FrameReader& in, hal::TraceRecord& call) {
+    uint8_t op = 0;
+    if (!in.Byte(op) || op >= static_cast<uint8_t>(hal::TraceOp::kCount) ||
+        !in.Varint(call.target) || !in.Varint(call.offset) || !in.Varint(call.arg) ||
+        !in.Varint(call.length) || !in.Varint(call.value) || !in.Bytes(call.request)) {
+        return false;
+    }
+    // A read reply is at most as large as the frame limit allows.
+    if (call.length > kMaxFrameSize) return false;
+    call.op = static_cast<hal::TraceOp>(op);
+    return true;
+}
+
+void PutResult(FrameWriter& out, const hal::TraceRecord& call) {
+    out.Varint(static_cast<uint64_t>(call.error));
+    out.Varint(call.value);
+    out.Bytes(call.response.data(), call.response.size());
+}
+
+bool GetResult(FrameReader& in, hal::TraceRecord& call) {
+    uint64_t error = 0;
+    if (!in.Varint(error) || error > static_cast<uint64_t>(core::ErrorCode::kUnknown) ||
+        !in.Varint(call.value) || !in.Bytes(call.response)) {
+        return false;
+    }
+    call.error = static_cast<core::ErrorCode>(error);
+    return true;
+}
+
+void PutAttachReply(FrameWriter& out, core::ErrorCode status, const Attachment& attachment) {
+    out.Varint(static_cast<uint64_t>(status));
+    out.Varint(attachment.handle);
+    out.Varint(attachment.interfaces);
+    out.String(attachment.driver);
+}
+
+core::ErrorCode GetAttachReply(FrameReader& in, Attachment& attachment) {
+    uint64_t status = 0;
+    uint64_t interfaces = 0;
+    if (!in.Varint(status) || !in.Varint(attachment.handle) || !in.Varint(interfaces) ||
+        !in.String(attachment.driver) ||
+        status > static_cast<uint64_t>(core::ErrorCode::kUnknown)) {
+        return core::ErrorCode::kDataLoss;
+    }
+    attachment.interfaces = static_cast<uint32_t>(interfaces);
+    return static_cast<core::ErrorCode>(status);
+}
+
+void RunCalls(hal::Device& device, std::vector<hal::TraceRecord>& calls) {
+    bool failed = false;
+    for (auto& call : calls) {
+        if (failed) {
+            call.error = core::ErrorCode::kCancelled;
+            continue;
+        }
+        auto result = hal::ExecuteTransaction(device, call);
+        call.error = result.IsError() ? CodeOf(result.Error()) : core::ErrorCode::kSuccess;
+        failed = result.IsError();
+    }
+}
+
+void PutCallReply(FrameWriter& out, core::ErrorCode status,
+                  const std::vector<hal::TraceRecord>& calls) {
+    out.Varint(static_cast<uint64_t>(status));
+    if (status != core::ErrorCode::kSuccess) {
+        out.Varint(0);
+        return;
+    }
+    out.Varint(calls.size());
+    for (const auto& call : calls) {
+        PutResult(out, call);
+    }
+}
+
+core::ErrorCode GetCallReply(FrameReader& in, std::vector<hal::TraceRecord>& calls) {
+    uint64_t status = 0;
+    uint64_t count = 0;
+    if (!in.Varint(status) || !in.Varint(count) ||
+        status > static_cast<uint64_t>(core::ErrorCode::kUnknown)) {
+        return core::ErrorCode::kDataLoss;
+    }
+    if (status != 0) {
+        return static_cast<core::ErrorCode>(status);
+    }
+    if (count != calls.size()) {
+        return core::ErrorCode::kDataLoss;
+    }
+    for (auto& call : calls) {
+        if (!GetResult(in, call)) {
+            return core::ErrorCode::kDataLoss;
+        }
+    }
+    return core::ErrorCode::kSuccess;
+}
+
+bool ParseTimeoutArg(const config::DeviceEntry& entry, const char* key, int& out) {
+    auto it = entry.args.find(key);
+    if (it == entry.args.end()) {
+        return true;
+    }
+    uint64_t value = 0;
+    if (!config::DeviceUri::ParseNumber(it->second, 10, 3600 * 1000, value) || value == 0) {
+        return false;
+    }
+    out = static_cast<int>(value);
+    return true;
+}
+
+core::ErrorCode CodeOf(const std::error_code& error) {
+    if (error.category() == core::PlasErrorCategory::Instance()) {
+        return static_cast<core::ErrorCode>(error.value());
+    }
+    return core::ErrorCode::kUnknown;
+}
+
+// ---------------------------------------------------------------------------
+// FrameChannel
+// ---------------------------------------------------------------------------
+
+FrameChannel::FrameChannel(int fd) : fd_(fd) {}
+
+FrameChannel::~FrameChannel() {
+    ::close(fd_);
+}
+
+bool FrameChannel::Send(std::vector<uint8_t> frame) {
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        if (!IsOpen()) return false;
+        if (queued_.empty()) {
+            queued_.swap(frame);
+        } else {
+            queued_.insert(queued_.end(), frame.begin(), frame.end());
+        }
+        if (writing_) return true;  // the writing thread picks it up
+        writing_ = true;
+    }
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(send_mutex_);
+            sending_.clear();
+            sending_.swap(queued_);
+            if (sending_.empty()) {
+                writing_ = false;
+                return true;
+            }
+        }
+        std::size_t sent = 0;
+        while (sent < sending_.size()) {
+            ssize_t n = ::send(fd_, sending_.data() + sent, sending_.size() - sent,
+                               MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                std::lock_guard<std::mutex> lock(send_mutex_);
+                open_.store(false, std::memory_order_release);
+                queued_.clear();
+                writing_ = false;
+                ::shutdown(fd_, SHUT_RDWR);
+                return false;
+            }
+            sent += static_cast<std::size_t>(n);
+        }
+    }
+}
+
+bool FrameChannel::Fill(std::size_t count) {
+    if (rx_.size() - rx_pos_ >= count) {
+        return true;
+    }
+    // Drop consumed frames before reading more.
+    rx_.erase(rx_.begin(), rx_.begin() + static_cast<std::ptrdiff_t>(rx_pos_));
+    rx_pos_ = 0;
+    while (rx_.size() - rx_pos_ < count) {
+        const std::size_t old_size = rx_.size();
+        rx_.resize(old_size + kReceiveChunk);
+        ssize_t n = ::recv(fd_, rx_.data() + old_size, kReceiveChunk, 0);
+        rx_.resize(old_size + (n > 0 ? static_cast<std::size_t>(n) : 0));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+    }
+    return true;
+}
+
+bool FrameChannel::Receive(std::vector<uint8_t>& payload) {
+    if (!Fill(kLengthSize)) {
+        Shutdown();
+        return false;
+    }
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < kLengthSize; ++i) {
+        size |= static_cast<std::size_t>(rx_[rx_pos_ + i]) << (8 * i);
+    }
+    if (size == 0 || size > kMaxFrameSize || !Fill(kLengthSize + size)) {
+        Shutdown();
+        return false;
+    }
+    const auto begin = rx_.begin() + static_cast<std::ptrdiff_t>(rx_pos_ + kLengthSize);
+    payload.assign(begin, begin + static_cast<std::ptrdiff_t>(size));
+    rx_pos_ += kLengthSize + size;
+    return true;
+}
+
+void FrameChannel::Shutdown() {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    open_.store(false, std::memory_order_release);
+    queued_.clear();
+    ::shutdown(fd_, SHUT_RDWR);
+}
+
+// ---------------------------------------------------------------------------
+// ConnectTcp
+// ---------------------------------------------------------------------------
+
+int ConnectTcp(const std::string& host, uint16_t port, int timeout_ms,
+               core::ErrorCode& error) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0) {
+        error = core::ErrorCode::kNotFound;
+        return -1;
+    }
+    error = core::ErrorCode::kIOError;
+    int fd = -1;
+    for (addrinfo* ai = addresses; ai != nullptr && fd < 0; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC | SOCK_NONBLOCK,
+                      ai->ai_protocol);
+        if (fd < 0) continue;
+        int rc = ::connect(fd, ai->ai_addr, ai->ai_addrlen);
+        if (rc < 0 && errno == EINPROGRESS) {
+            pollfd pfd{fd, POLLOUT, 0};
+            rc = ::poll(&pfd, 1, timeout_ms);
+            int so_error = 0;
+            socklen_t len = sizeof(so_error);
+            if (rc == 0) {
+                error = core::ErrorCode::kTimeout;
+                rc = -1;
+            } else if (rc > 0 &&
+                       ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &so_error, &len) == 0 &&
+                       so_error == 0) {
+                rc = 0;
+            } else {
+                rc = -1;
+            }
+        }
+        if (rc != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    ::freeaddrinfo(addresses);
+    if (fd < 0) return -1;
+
+    int flags = ::fcntl(fd, F_GETFL);
+    ::fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+}  // namespace plas::remote::detail
@@ -0,0 +1,172 @@
+#pragma once
+
+// Wire protocol shared by RemoteServer / ShmBroker and RemoteDevice /
+// ShmDevice (private header).
+//
+// A stream of frames (TCP, or the rings of shm_transport.h): a 4-byte
+// little-endian payload length, then the payload — a type byte, a varint
+// request id and a type-specific body.
+// Integers in bodies are LEB128 varints; byte strings are a varint length
+// followed by the bytes. Replies carry the id of their request, so any
+// number of requests may be in flight on one connection.
+//
+//   Attach       version, nickname
+//   AttachReply  status, handle, interfaces, driver
+//   Call         handle, count, count x (op byte, target, offset, arg,
+//                length, value, request)
+//   CallReply    status, count, count x (error, value, response)
+//   Detach       (empty; shared-memory slots only, no reply)
+//
+// `status` is a core::ErrorCode for the request as a whole (unknown
+// handle, unsupported version, ...); per-call errors are in the results.
+// A Call is run in order on the device's queue and stops at the first
+// failing call; the calls after it report kCancelled.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/core/error.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/transaction_trace.h"
+
+namespace plas::remote::detail {
+
+inline constexpr uint32_t kProtocolVersion = 1;
+inline constexpr std::size_t kMaxFrameSize = std::size_t{64} << 20;
+inline constexpr std::size_t kMaxBatchCalls = 65536;
+
+enum class FrameType : uint8_t {
+    kAttach = 1,
+    kAttachReply = 2,
+    kCall = 3,
+    kCallReply = 4,
+    kDetach = 5,
+};
+
+/// Builds one frame, length prefix included.
+class FrameWriter {
+public:
+    FrameWriter(FrameType type, uint64_t request_id);
+
+    void Byte(uint8_t value) { bytes_.push_back(value); }
+    void Varint(uint64_t value);
+    void Bytes(const uint8_t* data, std::size_t size);
+    void String(const std::string& text);
+
+    /// The finished frame; the writer is empty afterwards.
+    std::vector<uint8_t> Finish();
+
+private:
+    std::vector<uint8_t> bytes_;
+};
+
+/// Bounds-checked cursor over a received payload. Starts at the type byte.
+class FrameReader {
+public:
+    explicit FrameReader(const std::vector<uint8_t>& payload)
+        : pos_(payload.data()), end_(payload.data() + payload.size()) {}
+
+    bool Byte(uint8_t& out);
+    bool Varint(uint64_t& out);
+    bool Bytes(std::vector<uint8_t>& out);
+    bool String(std::string& out);
+
+    /// Type and request id at the start of every payload.
+    bool Header(FrameType& type, uint64_t& request_id);
+
+private:
+    const uint8_t* pos_;
+    const uint8_t* end_;
+};
+
+/// Inputs of a call (Call frames) and outputs of a result (CallReply).
+void PutCall(FrameWriter& out, const hal::TraceRecord& call);
+bool GetCall(FrameReader& in, hal::TraceRecord& call);
+void PutResult(FrameWriter& out, const hal::TraceRecord& call);
+bool GetResult(FrameReader& in, hal::TraceRecord& call);
+
+/// The body of an AttachReply.
+struct Attachment {
+    uint64_t handle = 0;
+    uint32_t interfaces = 0;
+    std::string driver;
+};
+
+void PutAttachReply(FrameWriter& out, core::ErrorCode status, const Attachment& attachment);
+
+/// kDataLoss for a malformed body, else the reply's status.
+core::ErrorCode GetAttachReply(FrameReader& in, Attachment& attachment);
+
+/// Run `calls` on `device` in order, stopping at the first failing call;
+/// the calls after it get kCancelled.
+void RunCalls(hal::Device& device, std::vector<hal::TraceRecord>& calls);
+
+/// A CallReply body: `status`, then the results of `calls` if it is kSuccess.
+void PutCallReply(FrameWriter& out, core::ErrorCode status,
+                  const std::vector<hal::TraceRecord>& calls);
+
+/// Fill the outputs of `calls` from a CallReply body. kDataLoss if it is
+/// malformed or has a different number of results, else the reply's status.
+core::ErrorCode GetCallReply(FrameReader& in, std::vector<hal::TraceRecord>& calls);
+
+/// The ErrorCode of a HAL error (kUnknown if it is not one).
+core::ErrorCode CodeOf(const std::error_code& error);
+
+/// A connected stream socket carrying frames. Send() and Receive() may be
+/// used from different threads; any number of threads may Send().
+class FrameChannel {
+public:
+    /// Takes ownership of `fd`.
+    explicit FrameChannel(int fd);
+    ~FrameChannel();
+
+    FrameChannel(const FrameChannel&) = delete;
+    FrameChannel& operator=(const FrameChannel&) = delete;
+
+    /// Queue `frame` and write it out. Frames queued by other threads while
+    /// one thread is writing are written by that thread in the same
+    /// send(), so a burst of small requests or replies costs one syscall
+    /// (and, with TCP_NODELAY, one packet) instead of one each. False once
+    /// the connection has failed.
+    bool Send(std::vector<uint8_t> frame);
+
+    /// Block for the next frame's payload. False on EOF, a socket error or
+    /// an oversized frame; the channel is closed afterwards.
+    bool Receive(std::vector<uint8_t>& payload);
+
+    /// Wake a blocked Receive() and fail further sends.
+    void Shutdown();
+
+    bool IsOpen() const { return open_.load(std::memory_order_acquire); }
+
+private:
+    bool Fill(std::size_t count);
+
+    const int fd_;
+    std::atomic<bool> open_{true};
+
+    std::mutex send_mutex_;
+    std::vector<uint8_t> queued_;  // guarded by send_mutex_
+    std::vector<uint8_t> sending_;  // owned by the writing thread
+    bool writing_ = false;
+
+    std::vector<uint8_t> rx_;  // receive buffer; [rx_pos_, size) unread
+    std::size_t rx_pos_ = 0;
+};
+
+/// Read the millisecond timeout arg `key` of a client device entry into
+/// `out` (left alone if absent). False unless it is 1..3600000.
+bool ParseTimeoutArg(const config::DeviceEntry& entry, const char* key, int& out);
+
+/// Connect to host:port with TCP_NODELAY, giving up after `timeout_ms`.
+/// Returns the fd, or -1 with `error` set (kTimeout, kNotFound for an
+/// unknown host, kIOError otherwise).
+int ConnectTcp(const std::string& host, uint16_t port, int timeout_ms,
+               core::ErrorCode& error);
+
+}  // namespace plas::remote::detail
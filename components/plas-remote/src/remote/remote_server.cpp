@@ -0,0 +1,447 @@
+#include "plas/remote/remote_server.h"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "plas/hal/transaction_proxy.h"
+#include "plas/log/logger.h"
+#include "remote/remote_protocol.h"
+
+namespace plas::remote {
+
+using detail::FrameChannel;
+using detail::FrameReader;
+using detail::FrameType;
+using detail::FrameWriter;
+
+namespace {
+
+/// Batches a worker runs from one device queue before moving on, so a busy
+/// device cannot starve the others.
+constexpr int kJobsPerTurn = 16;
+
+/// One Call frame waiting on a device queue.
+struct Job {
+    std::shared_ptr<FrameChannel> channel;
+    uint64_t request_id = 0;
+    std::vector<hal::TraceRecord> calls;
+};
+
+/// The serialized queue of one device. At most one worker runs it at a time
+/// (`scheduled` is set while it is queued for or held by a worker).
+struct Strand {
+    explicit Strand(std::string name) : nickname(std::move(name)) {}
+
+    const std::string nickname;
+    std::mutex mutex;
+    std::deque<Job> jobs;     // guarded by mutex
+    bool scheduled = false;   // guarded by mutex
+};
+
+struct Connection {
+    std::shared_ptr<FrameChannel> channel;
+    std::vector<std::shared_ptr<Strand>> handles;  // reader thread only
+    std::map<std::string, std::size_t> handle_of;  // nickname -> index in handles
+    std::thread reader;
+    std::atomic<bool> done{false};
+};
+
+}  // namespace
+
+struct RemoteServer::Impl {
+    explicit Impl(hal::DeviceManager& m) : manager(m) {}
+
+    hal::DeviceManager& manager;
+
+    std::mutex lifecycle_mutex;  // serializes Start/Stop
+    std::atomic<bool> running{false};
+    int listen_fd = -1;
+    int wake_fds[2] = {-1, -1};
+    uint16_t port = 0;
+    std::thread acceptor;
+
+    std::mutex connections_mutex;
+    std::list<std::unique_ptr<Connection>> connections;  // guarded
+
+    std::mutex strands_mutex;
+    std::map<std::string, std::shared_ptr<Strand>> strands;  // guarded
+
+    std::mutex pool_mutex;
+    std::condition_variable pool_cv;
+    std::deque<std::shared_ptr<Strand>> ready;  // guarded by pool_mutex
+    bool pool_stop = false;                     // guarded by pool_mutex
+    std::vector<std::thread> workers;
+
+    std::atomic<uint64_t> accepted{0};
+    std::atomic<uint64_t> attachments{0};
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> errors{0};
+
+    void AcceptLoop();
+    void ReapLocked();
+    void ReadLoop(Connection& connection);
+    bool HandleFrame(Connection& connection, const std::vector<uint8_t>& payload);
+    std::shared_ptr<Strand> GetStrand(const std::string& nickname);
+    void Schedule(const std::shared_ptr<Strand>& strand, Job job);
+    void WorkerLoop();
+    void Run(const Strand& strand, Job& job);
+};
+
+// ---------------------------------------------------------------------------
+// Accepting connections
+// ---------------------------------------------------------------------------
+
+void RemoteServer::Impl::AcceptLoop() {
+    pollfd fds[2] = {{listen_fd, POLLIN, 0}, {wake_fds[0], POLLIN, 0}};
+    while (running.load(std::memory_order_acquire)) {
+        int rc = ::poll(fds, 2, -1);
+        if (rc < 0 && errno != EINTR) {
+            PLAS_LOG_ERROR("RemoteServer: poll failed");
+            return;
+        }
+        if (rc <= 0 || (fds[1].revents & POLLIN) != 0) {
+            continue;  // interrupted or woken by Stop()
+        }
+        int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        auto connection = std::make_unique<Connection>();
+        connection->channel = std::make_shared<FrameChannel>(fd);
+        Connection& ref = *connection;
+        std::lock_guard<std::mutex> lock(connections_mutex);
+        ReapLocked();
+        connections.push_back(std::move(connection));
+        ref.reader = std::thread([this, &ref] { ReadLoop(ref); });
+        accepted.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void RemoteServer::Impl::ReapLocked() {
+    for (auto it = connections.begin(); it != connections.end();) {
+        if ((*it)->done.load(std::memory_order_acquire)) {
+            (*it)->reader.join();
+            it = connections.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Reading requests
+// ---------------------------------------------------------------------------
+
+void RemoteServer::Impl::ReadLoop(Connection& connection) {
+    std::vector<uint8_t> payload;
+    while (connection.channel->Receive(payload)) {
+        if (!HandleFrame(connection, payload)) {
+            errors.fetch_add(1, std::memory_order_relaxed);
+            PLAS_LOG_WARN("RemoteServer: malformed frame, dropping connection");
+            break;
+        }
+    }
+    connection.channel->Shutdown();
+    connection.done.store(true, std::memory_order_release);
+}
+
+bool RemoteServer::Impl::HandleFrame(Connection& connection,
+                                     const std::vector<uint8_t>& payload) {
+    FrameReader in(payload);
+    FrameType type{};
+    uint64_t id = 0;
+    if (!in.Header(type, id)) {
+        return false;
+    }
+
+    if (type == FrameType::kAttach) {
+        uint64_t version = 0;
+        std::string nickname;
+        if (!in.Varint(version) || !in.String(nickname)) {
+            return false;
+        }
+        FrameWriter reply(FrameType::kAttachReply, id);
+        hal::Device* device =
+            version == detail::kProtocolVersion ? manager.GetDevice(nickname) : nullptr;
+        if (device == nullptr) {
+            auto status = version == detail::kProtocolVersion ? core::ErrorCode::kNotFound
+                                                              : core::ErrorCode::kNotSupported;
+            detail::PutAttachReply(reply, status, {});
+        } else {
+            // Re-attaching a device reuses its handle, so a connection holds
+            // at most one per device however often it attaches.
+            auto [it, added] = connection.handle_of.emplace(nickname, connection.handles.size());
+            if (added) {
+                connection.handles.push_back(GetStrand(nickname));
+                attachments.fetch_add(1, std::memory_order_relaxed);
+            }
+            detail::Attachment attachment;
+            attachment.handle = it->second;
+            attachment.interfaces = hal::TransactionInterfaces(*device);
+            attachment.driver = device->GetDriverName();
+            detail::PutAttachReply(reply, core::ErrorCode::kSuccess, attachment);
+        }
+        connection.channel->Send(reply.Finish());
+        return true;
+    }
+
+    if (type == FrameType::kCall) {
+        uint64_t handle = 0;
+        uint64_t count = 0;
+        if (!in.Varint(handle) || !in.Varint(count) || count > detail::kMaxBatchCalls) {
+            return false;
+        }
+        Job job;
+        job.channel = connection.channel;
+        job.request_id = id;
+        job.calls.resize(static_cast<std::size_t>(count));
+        for (auto& call : job.calls) {
+            if (!detail::GetCall(in, call)) {
+                return false;
+            }
+        }
+        if (handle >= connection.handles.size()) {
+            FrameWriter reply(FrameType::kCallReply, id);
+            detail::PutCallReply(reply, core::ErrorCode::kNotFound, {});
+            connection.channel->Send(reply.Finish());
+            return true;
+        }
+        Schedule(connection.handles[static_cast<std::size_t>(handle)], std::move(job));
+        return true;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// Device queues
+// ---------------------------------------------------------------------------
+
+std::shared_ptr<Strand> RemoteServer::Impl::GetStrand(const std::string& nickname) {
+    std::lock_guard<std::mutex> lock(strands_mutex);
+    auto& strand = strands[nickname];
+    if (!strand) {
+        strand = std::make_shared<Strand>(nickname);
+    }
+    return strand;
+}
+
+void RemoteServer::Impl::Schedule(const std::shared_ptr<Strand>& strand, Job job) {
+    {
+        std::lock_guard<std::mutex> lock(strand->mutex);
+        strand->jobs.push_back(std::move(job));
+        if (strand->scheduled) {
+            return;  // the worker holding it picks the job up
+        }
+        strand->scheduled = true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        ready.push_back(strand);
+    }
+    pool_cv.notify_one();
+}
+
+void RemoteServer::Impl::WorkerLoop() {
+    for (;;) {
+        std::shared_ptr<Strand> strand;
+        {
+            std::unique_lock<std::mutex> lock(pool_mutex);
+            pool_cv.wait(lock, [this] { return pool_stop || !ready.empty(); });
+            if (pool_stop) {
+                return;
+            }
+            strand = std::move(ready.front());
+            ready.pop_front();
+        }
+        bool more = true;
+        for (int turn = 0; turn < kJobsPerTurn && more; ++turn) {
+            Job job;
+            {
+                std::lock_guard<std::mutex> lock(strand->mutex);
+                job = std::move(strand->jobs.front());
+                strand->jobs.pop_front();
+            }
+            Run(*strand, job);
+            std::lock_guard<std::mutex> lock(strand->mutex);
+            more = !strand->jobs.empty();
+            if (!more) {
+                strand->scheduled = false;
+            }
+        }
+        if (more) {
+            // Still busy: back of the line, behind the other devices.
+            {
+                std::lock_guard<std::mutex> lock(pool_mutex);
+                ready.push_back(std::move(strand));
+            }
+            pool_cv.notify_one();
+        }
+    }
+}
+
+void RemoteServer::Impl::Run(const Strand& strand, Job& job) {
+    FrameWriter reply(FrameType::kCallReply, job.request_id);
+    hal::Device* device = manager.GetDevice(strand.nickname);
+    if (device == nullptr) {
+        detail::PutCallReply(reply, core::ErrorCode::kNotFound, {});
+    } else {
+        detail::RunCalls(*device, job.calls);
+        detail::PutCallReply(reply, core::ErrorCode::kSuccess, job.calls);
+        calls.fetch_add(job.calls.size(), std::memory_order_relaxed);
+    }
+    requests.fetch_add(1, std::memory_order_relaxed);
+    job.channel->Send(reply.Finish());
+}
+
+// ---------------------------------------------------------------------------
+// RemoteServer
+// ---------------------------------------------------------------------------
+
+RemoteServer::RemoteServer(hal::DeviceManager& manager)
+    : impl_(std::make_unique<Impl>(manager)) {}
+
+RemoteServer::~RemoteServer() {
+    Stop();
+}
+
+core::Result<void> RemoteServer::Start(const RemoteServerOptions& options) {
+    std::lock_guard<std::mutex> lifecycle(impl_->lifecycle_mutex);
+    if (impl_->running.load(std::memory_order_acquire)) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+    }
+    if (options.workers == 0) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    addrinfo* addresses = nullptr;
+    const char* host = options.bind_address.empty() ? nullptr : options.bind_address.c_str();
+    if (::getaddrinfo(host, std::to_string(options.port).c_str(), &hints, &addresses) != 0) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    int fd = -1;
+    for (addrinfo* ai = addresses; ai != nullptr && fd < 0; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) continue;
+        int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (::bind(fd, ai->ai_addr, ai->ai_addrlen) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    ::freeaddrinfo(addresses);
+    if (fd < 0 || ::pipe2(impl_->wake_fds, O_CLOEXEC) != 0) {
+        PLAS_LOG_ERROR("RemoteServer: cannot listen on " + options.bind_address + ":" +
+                       std::to_string(options.port));
+        if (fd >= 0) ::close(fd);
+        return core::Result<void>::Err(core::ErrorCode::kIOError);
+    }
+
+    sockaddr_storage bound{};
+    socklen_t length = sizeof(bound);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&bound), &length);
+    impl_->port = ntohs(bound.ss_family == AF_INET6
+                            ? reinterpret_cast<sockaddr_in6*>(&bound)->sin6_port
+                            : reinterpret_cast<sockaddr_in*>(&bound)->sin_port);
+    impl_->listen_fd = fd;
+
+    impl_->accepted = 0;
+    impl_->attachments = 0;
+    impl_->requests = 0;
+    impl_->calls = 0;
+    impl_->errors = 0;
+    impl_->pool_stop = false;
+    impl_->running.store(true, std::memory_order_release);
+    for (std::size_t i = 0; i < options.workers; ++i) {
+        impl_->workers.emplace_back([this] { impl_->WorkerLoop(); });
+    }
+    impl_->acceptor = std::thread([this] { impl_->AcceptLoop(); });
+    PLAS_LOG_INFO("RemoteServer: listening on port " + std::to_string(impl_->port));
+    return core::Result<void>::Ok();
+}
+
+void RemoteServer::Stop() {
+    std::lock_guard<std::mutex> lifecycle(impl_->lifecycle_mutex);
+    if (!impl_->running.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    const char wake = 1;
+    (void)::write(impl_->wake_fds[1], &wake, 1);
+    impl_->acceptor.join();
+
+    {
+        std::lock_guard<std::mutex> lock(impl_->connections_mutex);
+        for (auto& connection : impl_->connections) {
+            connection->channel->Shutdown();
+        }
+        for (auto& connection : impl_->connections) {
+            connection->reader.join();
+        }
+        impl_->connections.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(impl_->pool_mutex);
+        impl_->pool_stop = true;
+    }
+    impl_->pool_cv.notify_all();
+    for (auto& worker : impl_->workers) {
+        worker.join();
+    }
+    impl_->workers.clear();
+    impl_->ready.clear();
+    {
+        std::lock_guard<std::mutex> lock(impl_->strands_mutex);
+        impl_->strands.clear();
+    }
+
+    ::close(impl_->listen_fd);
+    ::close(impl_->wake_fds[0]);
+    ::close(impl_->wake_fds[1]);
+    impl_->listen_fd = -1;
+    impl_->wake_fds[0] = impl_->wake_fds[1] = -1;
+}
+
+bool RemoteServer::IsRunning() const {
+    return impl_->running.load(std::memory_order_acquire);
+}
+
+uint16_t RemoteServer::Port() const {
+    return impl_->port;
+}
+
+RemoteServer::Stats RemoteServer::GetStats() const {
+    Stats stats;
+    stats.connections = impl_->accepted.load(std::memory_order_relaxed);
+    stats.attachments = impl_->attachments.load(std::memory_order_relaxed);
+    stats.requests = impl_->requests.load(std::memory_order_relaxed);
+    stats.calls = impl_->calls.load(std::memory_order_relaxed);
+    stats.errors = impl_->errors.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace plas::remote
@@ -0,0 +1,313 @@
+#include "plas/remote/shm_broker.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "plas/hal/transaction_proxy.h"
+#include "plas/log/logger.h"
+#include "remote/remote_protocol.h"
+#include "remote/shm_transport.h"
+
+namespace plas::remote {
+
+using detail::FrameReader;
+using detail::FrameType;
+using detail::FrameWriter;
+using detail::ShmSlot;
+using detail::WaitPolicy;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// How often an idle slot thread checks that its client is still alive.
+constexpr std::chrono::milliseconds kOwnerCheckInterval{250};
+
+/// How long a reply may wait for room in the client's ring.
+constexpr std::chrono::seconds kReplyTimeout{5};
+
+/// Upper bound on the encoded size of one result beyond its data.
+constexpr std::size_t kResultOverhead = 32;
+
+/// A device attached on a slot.
+struct Handle {
+    std::string nickname;
+    std::shared_ptr<std::mutex> lock;
+};
+
+}  // namespace
+
+struct ShmBroker::Impl {
+    explicit Impl(hal::DeviceManager& m) : manager(m) {}
+
+    hal::DeviceManager& manager;
+
+    std::mutex lifecycle_mutex;  // serializes Start/Stop
+    std::atomic<bool> running{false};
+    std::unique_ptr<detail::ShmRegion> region;
+    std::vector<std::thread> threads;
+
+    std::mutex locks_mutex;
+    std::map<std::string, std::shared_ptr<std::mutex>> device_locks;  // guarded
+
+    std::atomic<uint64_t> attaches{0};
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> reclaimed{0};
+    std::atomic<uint64_t> errors{0};
+
+    void Serve(uint32_t index);
+    bool HandleFrame(ShmSlot& slot, std::vector<Handle>& handles,
+                     const std::vector<uint8_t>& payload);
+    void RunCall(const Handle& handle, std::vector<hal::TraceRecord>& batch,
+                 std::size_t capacity, FrameWriter& reply);
+    void Reply(ShmSlot& slot, const std::vector<uint8_t>& frame);
+    void Release(ShmSlot& slot, std::vector<Handle>& handles);
+    std::shared_ptr<std::mutex> DeviceLock(const std::string& nickname);
+};
+
+// ---------------------------------------------------------------------------
+// Serving a slot
+// ---------------------------------------------------------------------------
+
+void ShmBroker::Impl::Serve(uint32_t index) {
+    ShmSlot slot = region->Slot(index);
+    std::vector<Handle> handles;
+    uint32_t generation = slot.header->generation.load(std::memory_order_acquire);
+    std::vector<uint8_t> payload;
+    const auto alive = [this] { return running.load(std::memory_order_acquire); };
+
+    while (running.load(std::memory_order_acquire)) {
+        WaitPolicy idle{Clock::now() + kOwnerCheckInterval, alive, kOwnerCheckInterval};
+        auto status = slot.request.Read(payload, idle);
+        if (status == core::ErrorCode::kTimeout) {
+            const int32_t owner = slot.header->owner.load(std::memory_order_acquire);
+            if (owner != 0 && !detail::ProcessAlive(owner)) {
+                PLAS_LOG_WARN("ShmBroker: client " + std::to_string(owner) +
+                              " is gone, freeing slot " + std::to_string(index));
+                Release(slot, handles);
+                reclaimed.fetch_add(1, std::memory_order_relaxed);
+            }
+            continue;
+        }
+        if (status == core::ErrorCode::kIOError) {
+            break;  // stopping
+        }
+        if (status != core::ErrorCode::kSuccess) {
+            errors.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        // A new client claimed the slot since the last frame: its handles
+        // start over.
+        const uint32_t current = slot.header->generation.load(std::memory_order_acquire);
+        if (current != generation) {
+            handles.clear();
+            generation = current;
+        }
+        if (!HandleFrame(slot, handles, payload)) {
+            errors.fetch_add(1, std::memory_order_relaxed);
+            PLAS_LOG_WARN("ShmBroker: malformed frame on slot " + std::to_string(index));
+        }
+    }
+}
+
+bool ShmBroker::Impl::HandleFrame(ShmSlot& slot, std::vector<Handle>& handles,
+                                  const std::vector<uint8_t>& payload) {
+    FrameReader in(payload);
+    FrameType type{};
+    uint64_t id = 0;
+    if (!in.Header(type, id)) {
+        return false;
+    }
+
+    if (type == FrameType::kAttach) {
+        uint64_t version = 0;
+        std::string nickname;
+        if (!in.Varint(version) || !in.String(nickname)) {
+            return false;
+        }
+        FrameWriter reply(FrameType::kAttachReply, id);
+        hal::Device* device =
+            version == detail::kProtocolVersion ? manager.GetDevice(nickname) : nullptr;
+        if (device == nullptr) {
+            auto status = version == detail::kProtocolVersion ? core::ErrorCode::kNotFound
+                                                              : core::ErrorCode::kNotSupported;
+            detail::PutAttachReply(reply, status, {});
+        } else {
+            detail::Attachment attachment;
+            attachment.handle = handles.size();
+            attachment.interfaces = hal::TransactionInterfaces(*device);
+            attachment.driver = device->GetDriverName();
+            detail::PutAttachReply(reply, core::ErrorCode::kSuccess, attachment);
+            handles.push_back({nickname, DeviceLock(nickname)});
+            attaches.fetch_add(1, std::memory_order_relaxed);
+        }
+        Reply(slot, reply.Finish());
+        return true;
+    }
+
+    if (type == FrameType::kCall) {
+        uint64_t handle = 0;
+        uint64_t count = 0;
+        if (!in.Varint(handle) || !in.Varint(count) || count > detail::kMaxBatchCalls) {
+            return false;
+        }
+        std::vector<hal::TraceRecord> batch(static_cast<std::size_t>(count));
+        for (auto& call : batch) {
+            if (!detail::GetCall(in, call)) {
+                return false;
+            }
+        }
+        FrameWriter reply(FrameType::kCallReply, id);
+        if (handle >= handles.size()) {
+            detail::PutCallReply(reply, core::ErrorCode::kNotFound, {});
+        } else {
+            RunCall(handles[static_cast<std::size_t>(handle)], batch,
+                    static_cast<std::size_t>(slot.response.Capacity()), reply);
+        }
+        std::vector<uint8_t> frame = reply.Finish();
+        if (frame.size() > slot.response.Capacity()) {
+            // DOE responses are not bounded by the call's length.
+            FrameWriter overflow(FrameType::kCallReply, id);
+            detail::PutCallReply(overflow, core::ErrorCode::kOverflow, {});
+            frame = overflow.Finish();
+        }
+        requests.fetch_add(1, std::memory_order_relaxed);
+        Reply(slot, frame);
+        return true;
+    }
+
+    if (type == FrameType::kDetach) {
+        Release(slot, handles);
+        return true;
+    }
+    return false;
+}
+
+void ShmBroker::Impl::RunCall(const Handle& handle, std::vector<hal::TraceRecord>& batch,
+                              std::size_t capacity, FrameWriter& reply) {
+    // Refuse up front a batch whose reads cannot come back in one frame,
+    // rather than run it and lose the results.
+    std::size_t bound = kResultOverhead;
+    for (const auto& call : batch) {
+        bound += kResultOverhead + static_cast<std::size_t>(call.length);
+    }
+    if (bound > capacity) {
+        detail::PutCallReply(reply, core::ErrorCode::kOverflow, {});
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(*handle.lock);
+    hal::Device* device = manager.GetDevice(handle.nickname);
+    if (device == nullptr) {
+        detail::PutCallReply(reply, core::ErrorCode::kNotFound, {});
+        return;
+    }
+    detail::RunCalls(*device, batch);
+    detail::PutCallReply(reply, core::ErrorCode::kSuccess, batch);
+    calls.fetch_add(batch.size(), std::memory_order_relaxed);
+}
+
+void ShmBroker::Impl::Reply(ShmSlot& slot, const std::vector<uint8_t>& frame) {
+    const int32_t owner = slot.header->owner.load(std::memory_order_acquire);
+    WaitPolicy policy{Clock::now() + kReplyTimeout, [this, owner] {
+                          return running.load(std::memory_order_acquire) &&
+                                 detail::ProcessAlive(owner);
+                      }};
+    if (slot.response.Write(frame, policy) != core::ErrorCode::kSuccess) {
+        errors.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ShmBroker::Impl::Release(ShmSlot& slot, std::vector<Handle>& handles) {
+    // The client writes nothing after Detach (or is dead), so both rings
+    // are the broker's alone until the slot is free again.
+    handles.clear();
+    slot.request.Reset();
+    slot.response.Reset();
+    slot.header->owner.store(0, std::memory_order_release);
+}
+
+std::shared_ptr<std::mutex> ShmBroker::Impl::DeviceLock(const std::string& nickname) {
+    std::lock_guard<std::mutex> lock(locks_mutex);
+    auto& device_lock = device_locks[nickname];
+    if (!device_lock) {
+        device_lock = std::make_shared<std::mutex>();
+    }
+    return device_lock;
+}
+
+// ---------------------------------------------------------------------------
+// ShmBroker
+// ---------------------------------------------------------------------------
+
+ShmBroker::ShmBroker(hal::DeviceManager& manager) : impl_(std::make_unique<Impl>(manager)) {}
+
+ShmBroker::~ShmBroker() {
+    Stop();
+}
+
+core::Result<void> ShmBroker::Start(const ShmBrokerOptions& options) {
+    std::lock_guard<std::mutex> lifecycle(impl_->lifecycle_mutex);
+    if (impl_->running.load(std::memory_order_acquire)) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyOpen);
+    }
+    auto region = detail::ShmRegion::Create(options.name, options.slots, options.ring_bytes);
+    if (region.IsError()) {
+        PLAS_LOG_ERROR("ShmBroker: cannot create broker '" + options.name +
+                       "': " + region.Error().message());
+        return core::Result<void>::Err(region.Error());
+    }
+    impl_->region = std::move(region).Value();
+
+    impl_->attaches = 0;
+    impl_->requests = 0;
+    impl_->calls = 0;
+    impl_->reclaimed = 0;
+    impl_->errors = 0;
+    impl_->running.store(true, std::memory_order_release);
+    for (uint32_t i = 0; i < impl_->region->SlotCount(); ++i) {
+        impl_->threads.emplace_back([this, i] { impl_->Serve(i); });
+    }
+    PLAS_LOG_INFO("ShmBroker: serving '" + options.name + "' with " +
+                  std::to_string(options.slots) + " slots");
+    return core::Result<void>::Ok();
+}
+
+void ShmBroker::Stop() {
+    std::lock_guard<std::mutex> lifecycle(impl_->lifecycle_mutex);
+    if (!impl_->running.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    for (uint32_t i = 0; i < impl_->region->SlotCount(); ++i) {
+        impl_->region->Slot(i).request.WakeConsumer();
+    }
+    for (auto& thread : impl_->threads) {
+        thread.join();
+    }
+    impl_->threads.clear();
+    impl_->region.reset();
+    std::lock_guard<std::mutex> lock(impl_->locks_mutex);
+    impl_->device_locks.clear();
+}
+
+bool ShmBroker::IsRunning() const {
+    return impl_->running.load(std::memory_order_acquire);
+}
+
+ShmBroker::Stats ShmBroker::GetStats() const {
+    Stats stats;
+    stats.attaches = impl_->attaches.load(std::memory_order_relaxed);
+    stats.requests = impl_->requests.load(std::memory_order_relaxed);
+    stats.calls = impl_->calls.load(std::memory_order_relaxed);
+    stats.reclaimed = impl_->reclaimed.load(std::memory_order_relaxed);
+    stats.errors = impl_->errors.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace plas::remote
@@ -0,0 +1,360 @@
+#include "plas/remote/shm_device.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "plas/hal/interface/device_factory.h"
+#include "plas/log/logger.h"
+#include "remote/remote_protocol.h"
+#include "remote/shm_transport.h"
+
+namespace plas::remote {
+
+using detail::FrameReader;
+using detail::FrameType;
+using detail::FrameWriter;
+
+namespace detail {
+
+/// A slot claimed in a broker's region: this device's side of the rings.
+/// Not thread-safe; ShmDevice serializes requests.
+class ShmClient {
+public:
+    ~ShmClient() {
+        // Hand the slot back; the broker resets it. Nothing to do if the
+        // broker is gone.
+        FrameWriter detach(FrameType::kDetach, next_id_++);
+        (void)slot_.request.Write(detach.Finish(), Policy(kDetachTimeoutMs));
+    }
+
+    ShmClient(const ShmClient&) = delete;
+    ShmClient& operator=(const ShmClient&) = delete;
+
+    /// Map broker `name` and claim a free slot. kNotFound if the broker is
+    /// not running, kResourceExhausted if every slot stays taken for
+    /// kClaimWaitMs (the broker frees detached slots asynchronously).
+    static core::Result<std::unique_ptr<ShmClient>> Connect(const std::string& name) {
+        using R = core::Result<std::unique_ptr<ShmClient>>;
+        auto region = ShmRegion::Open(name);
+        if (region.IsError()) {
+            return R::Err(region.Error());
+        }
+        auto& mapped = *region.Value();
+        const auto pid = static_cast<int32_t>(::getpid());
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(kClaimWaitMs);
+        do {
+            for (uint32_t i = 0; i < mapped.SlotCount(); ++i) {
+                ShmSlot slot = mapped.Slot(i);
+                int32_t free = 0;
+                if (slot.header->owner.compare_exchange_strong(free, pid,
+                                                               std::memory_order_acq_rel)) {
+                    slot.header->generation.fetch_add(1, std::memory_order_release);
+                    return R::Ok(std::unique_ptr<ShmClient>(
+                        new ShmClient(std::move(region).Value(), slot)));
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        } while (std::chrono::steady_clock::now() < deadline);
+        return R::Err(core::ErrorCode::kResourceExhausted);
+    }
+
+    /// False once the broker that served the slot has stopped or died.
+    bool IsAlive() const {
+        return region_->BrokerPid() == broker_pid_ && ProcessAlive(broker_pid_);
+    }
+
+    /// Send `frame` (built with NextId()) and wait for the reply to it;
+    /// `payload` receives it. Replies to requests that timed out earlier
+    /// are skipped.
+    core::ErrorCode RoundTrip(uint64_t id, const std::vector<uint8_t>& frame,
+                              std::vector<uint8_t>& payload, int timeout_ms) {
+        const WaitPolicy policy = Policy(timeout_ms);
+        auto status = slot_.request.Write(frame, policy);
+        if (status == core::ErrorCode::kInvalidArgument) {
+            return core::ErrorCode::kOverflow;
+        }
+        while (status == core::ErrorCode::kSuccess) {
+            status = slot_.response.Read(payload, policy);
+            FrameReader in(payload);
+            FrameType type{};
+            uint64_t reply_id = 0;
+            if (status == core::ErrorCode::kSuccess && in.Header(type, reply_id) &&
+                reply_id == id) {
+                break;
+            }
+        }
+        return status;
+    }
+
+    uint64_t NextId() { return next_id_++; }
+
+private:
+    static constexpr int kDetachTimeoutMs = 100;
+    static constexpr int kClaimWaitMs = 100;
+
+    ShmClient(std::unique_ptr<ShmRegion> region, ShmSlot slot)
+        : region_(std::move(region)), slot_(slot), broker_pid_(region_->BrokerPid()) {}
+
+    WaitPolicy Policy(int timeout_ms) const {
+        return {std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms),
+                [this] { return IsAlive(); }};
+    }
+
+    std::unique_ptr<ShmRegion> region_;
+    ShmSlot slot_;
+    int32_t broker_pid_;
+    uint64_t next_id_ = 1;
+};
+
+}  // namespace detail
+
+namespace {
+
+using detail::Attachment;
+using detail::ShmClient;
+using detail::ShmEndpoint;
+
+/// Look up the endpoint's nickname in the broker.
+core::Result<Attachment> Attach(ShmClient& client, const ShmEndpoint& endpoint) {
+    const uint64_t id = client.NextId();
+    FrameWriter frame(FrameType::kAttach, id);
+    frame.Varint(detail::kProtocolVersion);
+    frame.String(endpoint.nickname);
+    std::vector<uint8_t> payload;
+    auto status = client.RoundTrip(id, frame.Finish(), payload, endpoint.timeout_ms);
+    Attachment attachment;
+    if (status == core::ErrorCode::kSuccess) {
+        FrameReader in(payload);
+        FrameType type{};
+        uint64_t reply_id = 0;
+        in.Header(type, reply_id);
+        status = detail::GetAttachReply(in, attachment);
+    }
+    if (status != core::ErrorCode::kSuccess) {
+        return core::Result<Attachment>::Err(status);
+    }
+    return core::Result<Attachment>::Ok(std::move(attachment));
+}
+
+/// Connect to the endpoint's broker and attach its device.
+core::Result<std::pair<std::unique_ptr<ShmClient>, Attachment>> Connect(
+    const ShmEndpoint& endpoint) {
+    using R = core::Result<std::pair<std::unique_ptr<ShmClient>, Attachment>>;
+    auto client = ShmClient::Connect(endpoint.broker);
+    if (client.IsError()) {
+        return R::Err(client.Error());
+    }
+    auto attached = Attach(*client.Value(), endpoint);
+    if (attached.IsError()) {
+        return R::Err(attached.Error());
+    }
+    return R::Ok({std::move(client).Value(), std::move(attached).Value()});
+}
+
+/// "broker:nickname" plus the timeout arg.
+bool ParseEndpoint(const config::DeviceEntry& entry, const config::DeviceUri& uri,
+                   ShmEndpoint& endpoint) {
+    if (!uri.IsValid() || uri.Scheme() != "shm" || uri.FieldCount() != 2) {
+        return false;
+    }
+    endpoint.broker = std::string(uri.Field(0));
+    endpoint.nickname = std::string(uri.Field(1));
+    return detail::IsValidBrokerName(endpoint.broker) && !endpoint.nickname.empty() &&
+           detail::ParseTimeoutArg(entry, "timeout_ms", endpoint.timeout_ms);
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Constructor / Destructor
+// ---------------------------------------------------------------------------
+
+ShmDevice::ShmDevice(const config::DeviceEntry& entry, detail::ShmEndpoint endpoint,
+                     std::unique_ptr<detail::ShmClient> client, uint64_t handle,
+                     std::string remote_driver, core::ErrorCode init_error)
+    : entry_(entry),
+      endpoint_(std::move(endpoint)),
+      remote_driver_(std::move(remote_driver)),
+      init_error_(init_error),
+      client_(std::move(client)),
+      handle_(handle) {}
+
+ShmDevice::~ShmDevice() = default;
+
+// ---------------------------------------------------------------------------
+// Device interface
+// ---------------------------------------------------------------------------
+
+core::Result<void> ShmDevice::Init() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != hal::DeviceState::kUninitialized && state_ != hal::DeviceState::kClosed) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    if (init_error_ != core::ErrorCode::kSuccess) {
+        PLAS_LOG_ERROR("ShmDevice::Init() failed for device='" + entry_.nickname +
+                       "' uri=" + entry_.uri);
+        return core::Result<void>::Err(init_error_);
+    }
+    state_ = hal::DeviceState::kInitialized;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> ShmDevice::Open() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != hal::DeviceState::kInitialized && state_ != hal::DeviceState::kClosed) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    auto connected = ReconnectLocked();
+    if (connected.IsError()) {
+        return connected;
+    }
+    state_ = hal::DeviceState::kOpen;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> ShmDevice::Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != hal::DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kAlreadyClosed);
+    }
+    state_ = hal::DeviceState::kClosed;
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> ShmDevice::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ == hal::DeviceState::kUninitialized) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    return ReconnectLocked();
+}
+
+hal::DeviceState ShmDevice::GetState() const {
+    return state_;
+}
+
+std::string ShmDevice::GetName() const {
+    return entry_.nickname;
+}
+
+std::string ShmDevice::GetUri() const {
+    return entry_.uri;
+}
+
+std::string ShmDevice::GetDriverName() const {
+    return "shm";
+}
+
+std::string ShmDevice::GetRemoteDriverName() const {
+    return remote_driver_;
+}
+
+core::Result<void> ShmDevice::ReconnectLocked() {
+    if (client_ && client_->IsAlive()) {
+        return core::Result<void>::Ok();
+    }
+    client_.reset();  // give the old slot back first
+    auto connected = Connect(endpoint_);
+    if (connected.IsError()) {
+        return core::Result<void>::Err(connected.Error());
+    }
+    client_ = std::move(connected.Value().first);
+    handle_ = connected.Value().second.handle;
+    return core::Result<void>::Ok();
+}
+
+// ---------------------------------------------------------------------------
+// Calls
+// ---------------------------------------------------------------------------
+
+core::Result<void> ShmDevice::ExecuteBatch(hal::TraceRecord* calls, std::size_t count) {
+    if (state_ != hal::DeviceState::kOpen) {
+        return core::Result<void>::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (count > detail::kMaxBatchCalls) {
+        return core::Result<void>::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::vector<hal::TraceRecord> batch(calls, calls + count);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!client_) {
+            return core::Result<void>::Err(core::ErrorCode::kIOError);
+        }
+        const uint64_t id = client_->NextId();
+        FrameWriter frame(FrameType::kCall, id);
+        frame.Varint(handle_);
+        frame.Varint(batch.size());
+        for (const auto& call : batch) {
+            detail::PutCall(frame, call);
+        }
+        std::vector<uint8_t> payload;
+        auto status = client_->RoundTrip(id, frame.Finish(), payload, endpoint_.timeout_ms);
+        if (status == core::ErrorCode::kSuccess) {
+            FrameReader in(payload);
+            FrameType type{};
+            uint64_t reply_id = 0;
+            in.Header(type, reply_id);
+            status = detail::GetCallReply(in, batch);
+        }
+        if (status != core::ErrorCode::kSuccess) {
+            return core::Result<void>::Err(status);
+        }
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        calls[i].value = batch[i].value;
+        calls[i].response = std::move(batch[i].response);
+        calls[i].error = batch[i].error;
+    }
+    return core::Result<void>::Ok();
+}
+
+core::Result<void> ShmDevice::Execute(hal::TraceRecord& call) {
+    auto sent = ExecuteBatch(&call, 1);
+    if (sent.IsError()) {
+        return sent;
+    }
+    if (call.error != core::ErrorCode::kSuccess) {
+        return core::Result<void>::Err(call.error);
+    }
+    return core::Result<void>::Ok();
+}
+
+// ---------------------------------------------------------------------------
+// Factory
+// ---------------------------------------------------------------------------
+
+std::unique_ptr<hal::Device> ShmDevice::Create(const config::DeviceEntry& entry,
+                                               const config::DeviceUri& uri) {
+    ShmEndpoint endpoint;
+    if (!ParseEndpoint(entry, uri, endpoint)) {
+        return hal::MakeTransactionProxy<ShmDevice>(0, entry, std::move(endpoint), nullptr,
+                                                    uint64_t{0}, "",
+                                                    core::ErrorCode::kInvalidArgument);
+    }
+    auto connected = Connect(endpoint);
+    if (connected.IsError()) {
+        PLAS_LOG_ERROR("ShmDevice: cannot attach " + endpoint.nickname + " on broker '" +
+                       endpoint.broker + "': " + connected.Error().message());
+        return hal::MakeTransactionProxy<ShmDevice>(0, entry, std::move(endpoint), nullptr,
+                                                    uint64_t{0}, "",
+                                                    detail::CodeOf(connected.Error()));
+    }
+    auto [client, attachment] = std::move(connected).Value();
+    return hal::MakeTransactionProxy<ShmDevice>(
+        attachment.interfaces, entry, std::move(endpoint), std::move(client), attachment.handle,
+        std::move(attachment.driver), core::ErrorCode::kSuccess);
+}
+
+void ShmDevice::Register() {
+    hal::DeviceFactory::RegisterDriver(
+        "shm", [](const config::DeviceEntry& entry, const config::DeviceUri& uri) {
+            return Create(entry, uri);
+        });
+}
+
+}  // namespace plas::remote
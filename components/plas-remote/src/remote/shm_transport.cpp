@@ -0,0 +1,402 @@
+#include "remote/shm_transport.h"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <thread>
+
+namespace plas::remote::detail {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr char kShmMagic[8] = {'P', 'L', 'A', 'S', 'B', 'R', 'K', '\0'};
+constexpr std::size_t kLengthSize = 4;
+
+/// How long a waiter polls before sleeping. Round trips of a busy client
+/// complete inside it without a syscall on either side.
+constexpr auto kSpinTime = std::chrono::microseconds(50);
+
+struct alignas(64) RegionHeader {
+    char magic[8];                 ///< kShmMagic
+    uint32_t format;               ///< kShmFormatVersion
+    uint32_t slots;
+    uint64_t ring_bytes;           ///< per ring, power of two
+    std::atomic<int32_t> broker;   ///< broker pid; 0 once stopped
+    std::atomic<uint32_t> ready;   ///< set last by Create()
+};
+
+std::size_t SlotStride(std::size_t ring_bytes) {
+    return sizeof(SlotHeader) + 2 * ring_bytes;
+}
+
+std::size_t RegionSize(uint32_t slots, std::size_t ring_bytes) {
+    return sizeof(RegionHeader) + std::size_t{slots} * SlotStride(ring_bytes);
+}
+
+std::string ShmName(const std::string& name) {
+    return "/plas-broker-" + name;
+}
+
+core::ErrorCode ShmError(int err) {
+    switch (err) {
+        case ENOENT:       return core::ErrorCode::kNotFound;
+        case EEXIST:       return core::ErrorCode::kAlreadyOpen;
+        case EACCES:       return core::ErrorCode::kPermissionDenied;
+        case EINVAL:
+        case ENAMETOOLONG: return core::ErrorCode::kInvalidArgument;
+        default:           return core::ErrorCode::kIOError;
+    }
+}
+
+uint32_t* FutexWord(std::atomic<uint32_t>& word) {
+    return reinterpret_cast<uint32_t*>(&word);
+}
+
+void FutexWait(std::atomic<uint32_t>& word, uint32_t expected, Clock::duration timeout) {
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count();
+    timespec ts{};
+    ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+    ts.tv_nsec = static_cast<long>(ns % 1000000000);
+    // Shared (not FUTEX_PRIVATE) ops: the word lives in another process too.
+    ::syscall(SYS_futex, FutexWord(word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+}
+
+void FutexWakeAll(std::atomic<uint32_t>& word) {
+    ::syscall(SYS_futex, FutexWord(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+/// Bump `seq` and wake its sleepers, if any. Pairs with Await(): both
+/// sides use seq_cst, so either the waiter sees the new state before it
+/// sleeps or the signaller sees the waiter and wakes it.
+void Signal(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiters) {
+    seq.fetch_add(1, std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_seq_cst) != 0) {
+        FutexWakeAll(seq);
+    }
+}
+
+/// Wait until `ready()`: spin for kSpinTime, then sleep on `seq`.
+template <typename Ready>
+core::ErrorCode Await(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiters, Ready ready,
+                      const WaitPolicy& policy) {
+    const auto spin_until = Clock::now() + kSpinTime;
+    do {
+        if (ready()) return core::ErrorCode::kSuccess;
+        std::this_thread::yield();
+    } while (Clock::now() < spin_until);
+
+    for (;;) {
+        const uint32_t observed = seq.load(std::memory_order_seq_cst);
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        if (!ready()) {
+            const auto left = policy.deadline - Clock::now();
+            if (left > Clock::duration::zero()) {
+                FutexWait(seq, observed,
+                          std::min<Clock::duration>(left, policy.check_interval));
+            }
+        }
+        waiters.fetch_sub(1, std::memory_order_seq_cst);
+        if (ready()) return core::ErrorCode::kSuccess;
+        if (policy.alive && !policy.alive()) return core::ErrorCode::kIOError;
+        if (Clock::now() >= policy.deadline) return core::ErrorCode::kTimeout;
+    }
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// ShmRing
+// ---------------------------------------------------------------------------
+
+void ShmRing::CopyIn(uint64_t position, const uint8_t* bytes, std::size_t size) {
+    const auto offset = static_cast<std::size_t>(position & (capacity_ - 1));
+    const std::size_t first = std::min<std::size_t>(size, capacity_ - offset);
+    std::memcpy(data_ + offset, bytes, first);
+    std::memcpy(data_, bytes + first, size - first);
+}
+
+void ShmRing::CopyOut(uint64_t position, uint8_t* bytes, std::size_t size) const {
+    const auto offset = static_cast<std::size_t>(position & (capacity_ - 1));
+    const std::size_t first = std::min<std::size_t>(size, capacity_ - offset);
+    std::memcpy(bytes, data_ + offset, first);
+    std::memcpy(bytes + first, data_, size - first);
+}
+
+bool ShmRing::TryWrite(const std::vector<uint8_t>& frame) {
+    const uint64_t head = control_->head.load(std::memory_order_relaxed);
+    const uint64_t tail = control_->tail.load(std::memory_order_seq_cst);
+    if (capacity_ - (head - tail) < frame.size()) {
+        return false;
+    }
+    CopyIn(head, frame.data(), frame.size());
+    control_->head.store(head + frame.size(), std::memory_order_seq_cst);
+    Signal(control_->data_seq, control_->data_waiters);
+    return true;
+}
+
+bool ShmRing::TryRead(std::vector<uint8_t>& payload, core::ErrorCode& error) {
+    const uint64_t tail = control_->tail.load(std::memory_order_relaxed);
+    const uint64_t head = control_->head.load(std::memory_order_seq_cst);
+    if (head == tail) {
+        return false;
+    }
+    uint8_t prefix[kLengthSize];
+    uint64_t size = 0;
+    if (head - tail >= kLengthSize) {
+        CopyOut(tail, prefix, kLengthSize);
+        for (std::size_t i = 0; i < kLengthSize; ++i) {
+            size |= uint64_t{prefix[i]} << (8 * i);
+        }
+    }
+    if (head - tail < kLengthSize || size > head - tail - kLengthSize) {
+        // Frames are published whole, so this is a corrupt producer: drop
+        // what it wrote rather than resynchronize on garbage.
+        control_->tail.store(head, std::memory_order_seq_cst);
+        Signal(control_->space_seq, control_->space_waiters);
+        error = core::ErrorCode::kDataLoss;
+        return false;
+    }
+    payload.resize(static_cast<std::size_t>(size));
+    CopyOut(tail + kLengthSize, payload.data(), payload.size());
+    control_->tail.store(tail + kLengthSize + size, std::memory_order_seq_cst);
+    Signal(control_->space_seq, control_->space_waiters);
+    return true;
+}
+
+core::ErrorCode ShmRing::Write(const std::vector<uint8_t>& frame, const WaitPolicy& policy) {
+    if (frame.size() > capacity_) {
+        return core::ErrorCode::kInvalidArgument;
+    }
+    while (!TryWrite(frame)) {
+        auto status = Await(
+            control_->space_seq, control_->space_waiters,
+            [&] {
+                return capacity_ - (control_->head.load(std::memory_order_relaxed) -
+                                    control_->tail.load(std::memory_order_seq_cst)) >=
+                       frame.size();
+            },
+            policy);
+        if (status != core::ErrorCode::kSuccess) {
+            return status;
+        }
+    }
+    return core::ErrorCode::kSuccess;
+}
+
+core::ErrorCode ShmRing::Read(std::vector<uint8_t>& payload, const WaitPolicy& policy) {
+    for (;;) {
+        core::ErrorCode error = core::ErrorCode::kSuccess;
+        if (TryRead(payload, error)) {
+            return core::ErrorCode::kSuccess;
+        }
+        if (error != core::ErrorCode::kSuccess) {
+            return error;
+        }
+        auto status = Await(
+            control_->data_seq, control_->data_waiters,
+            [&] {
+                return control_->head.load(std::memory_order_seq_cst) !=
+                       control_->tail.load(std::memory_order_relaxed);
+            },
+            policy);
+        if (status != core::ErrorCode::kSuccess) {
+            return status;
+        }
+    }
+}
+
+void ShmRing::WakeConsumer() {
+    control_->data_seq.fetch_add(1, std::memory_order_seq_cst);
+    FutexWakeAll(control_->data_seq);
+}
+
+void ShmRing::Reset() {
+    control_->head.store(0, std::memory_order_seq_cst);
+    control_->tail.store(0, std::memory_order_seq_cst);
+}
+
+// ---------------------------------------------------------------------------
+// ShmRegion
+// ---------------------------------------------------------------------------
+
+ShmRegion::~ShmRegion() {
+    if (base_ == nullptr) {
+        return;
+    }
+    if (owner_) {
+        // Clients blocked on a reply notice the broker is gone right away.
+        static_cast<RegionHeader*>(base_)->broker.store(0, std::memory_order_seq_cst);
+        for (uint32_t i = 0; i < SlotCount(); ++i) {
+            Slot(i).response.WakeConsumer();
+        }
+    }
+    ::munmap(base_, map_size_);
+    if (owner_) {
+        ::shm_unlink(shm_name_.c_str());
+    }
+}
+
+core::Result<std::unique_ptr<ShmRegion>> ShmRegion::Create(const std::string& name,
+                                                           uint32_t slots,
+                                                           std::size_t ring_bytes) {
+    using R = core::Result<std::unique_ptr<ShmRegion>>;
+    if (!IsValidBrokerName(name) || slots == 0 || slots > kMaxSlots ||
+        ring_bytes < kMinRingBytes || ring_bytes > kMaxRingBytes) {
+        return R::Err(core::ErrorCode::kInvalidArgument);
+    }
+    std::size_t capacity = kMinRingBytes;
+    while (capacity < ring_bytes) {
+        capacity <<= 1;
+    }
+
+    const std::string shm_name = ShmName(name);
+    int fd = ::shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        // Left behind by a broker that did not stop cleanly?
+        auto existing = Open(name);
+        if (existing.IsOk()) {
+            return R::Err(core::ErrorCode::kAlreadyOpen);
+        }
+        ::shm_unlink(shm_name.c_str());
+        fd = ::shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    }
+    if (fd < 0) {
+        return R::Err(ShmError(errno));
+    }
+    const std::size_t map_size = RegionSize(slots, capacity);
+    void* base = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(map_size)) == 0) {
+        base = ::mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        ::shm_unlink(shm_name.c_str());
+        return R::Err(core::ErrorCode::kIOError);
+    }
+
+    // ftruncate zero-fills: every slot starts free with empty rings.
+    auto* header = static_cast<RegionHeader*>(base);
+    std::memcpy(header->magic, kShmMagic, sizeof(header->magic));
+    header->format = kShmFormatVersion;
+    header->slots = slots;
+    header->ring_bytes = capacity;
+    new (&header->broker) std::atomic<int32_t>(static_cast<int32_t>(::getpid()));
+    new (&header->ready) std::atomic<uint32_t>(0);
+    auto* bytes = static_cast<uint8_t*>(base);
+    for (uint32_t i = 0; i < slots; ++i) {
+        new (bytes + sizeof(RegionHeader) + i * SlotStride(capacity)) SlotHeader{};
+    }
+    header->ready.store(1, std::memory_order_release);
+
+    std::unique_ptr<ShmRegion> region(new ShmRegion());
+    region->shm_name_ = shm_name;
+    region->base_ = base;
+    region->map_size_ = map_size;
+    region->owner_ = true;
+    return R::Ok(std::move(region));
+}
+
+core::Result<std::unique_ptr<ShmRegion>> ShmRegion::Open(const std::string& name) {
+    using R = core::Result<std::unique_ptr<ShmRegion>>;
+    if (!IsValidBrokerName(name)) {
+        return R::Err(core::ErrorCode::kInvalidArgument);
+    }
+    const std::string shm_name = ShmName(name);
+    int fd = ::shm_open(shm_name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        return R::Err(ShmError(errno));
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(RegionHeader))) {
+        ::close(fd);
+        return R::Err(core::ErrorCode::kDataLoss);
+    }
+    const auto map_size = static_cast<std::size_t>(st.st_size);
+    void* base = ::mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        return R::Err(core::ErrorCode::kIOError);
+    }
+
+    std::unique_ptr<ShmRegion> region(new ShmRegion());
+    region->shm_name_ = shm_name;
+    region->base_ = base;
+    region->map_size_ = map_size;
+    const auto* header = static_cast<const RegionHeader*>(base);
+    if (header->ready.load(std::memory_order_acquire) != 1) {
+        return R::Err(core::ErrorCode::kNotInitialized);
+    }
+    if (std::memcmp(header->magic, kShmMagic, sizeof(kShmMagic)) != 0 ||
+        header->format != kShmFormatVersion || header->slots == 0 ||
+        header->slots > kMaxSlots || header->ring_bytes < kMinRingBytes ||
+        header->ring_bytes > kMaxRingBytes ||
+        (header->ring_bytes & (header->ring_bytes - 1)) != 0 ||
+        RegionSize(header->slots, static_cast<std::size_t>(header->ring_bytes)) != map_size) {
+        return R::Err(core::ErrorCode::kDataLoss);
+    }
+    if (!ProcessAlive(region->BrokerPid())) {
+        return R::Err(core::ErrorCode::kNotFound);
+    }
+    return R::Ok(std::move(region));
+}
+
+uint32_t ShmRegion::SlotCount() const {
+    return static_cast<const RegionHeader*>(base_)->slots;
+}
+
+std::size_t ShmRegion::RingBytes() const {
+    return static_cast<std::size_t>(static_cast<const RegionHeader*>(base_)->ring_bytes);
+}
+
+ShmSlot ShmRegion::Slot(uint32_t index) const {
+    const std::size_t ring_bytes = RingBytes();
+    auto* bytes = static_cast<uint8_t*>(base_) + sizeof(RegionHeader) +
+                  index * SlotStride(ring_bytes);
+    auto* header = reinterpret_cast<SlotHeader*>(bytes);
+    uint8_t* data = bytes + sizeof(SlotHeader);
+    ShmSlot slot;
+    slot.header = header;
+    slot.request = ShmRing(&header->request, data, ring_bytes);
+    slot.response = ShmRing(&header->response, data + ring_bytes, ring_bytes);
+    return slot;
+}
+
+int32_t ShmRegion::BrokerPid() const {
+    return static_cast<const RegionHeader*>(base_)->broker.load(std::memory_order_seq_cst);
+}
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+bool IsValidBrokerName(const std::string& name) {
+    if (name.empty() || name.size() > 64) {
+        return false;
+    }
+    return std::all_of(name.begin(), name.end(), [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               c == '-' || c == '_';
+    });
+}
+
+bool ProcessAlive(int32_t pid) {
+    if (pid <= 0) {
+        return false;
+    }
+    return ::kill(pid, 0) == 0 || errno == EPERM;
+}
+
+}  // namespace plas::remote::detail
@@ -0,0 +1,157 @@
+#pragma once
+
+// Shared-memory transport shared by ShmBroker and ShmDevice (private header,
+// Linux only).
+//
+// One POSIX shared-memory object per broker ("/plas-broker-<name>"):
+//
+//   RegionHeader
+//   slots x (SlotHeader, request ring data, response ring data)
+//
+// A slot belongs to one client device at a time (SlotHeader::owner holds
+// its pid). Its two rings are single-producer / single-consumer byte rings
+// carrying the frames of remote_protocol.h, length prefix included: the
+// client writes requests and reads replies, the broker's thread for that
+// slot does the opposite. Head and tail only grow; a side that finds its
+// ring empty (or full) spins briefly and then sleeps on a futex word that
+// the other side bumps and wakes after each frame, so an idle slot costs
+// nothing and a busy one no syscalls.
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/core/result.h"
+
+namespace plas::remote::detail {
+
+inline constexpr uint32_t kShmFormatVersion = 1;
+inline constexpr std::size_t kMinRingBytes = 4096;
+inline constexpr std::size_t kMaxRingBytes = std::size_t{64} << 20;
+inline constexpr uint32_t kMaxSlots = 1024;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<uint32_t>::is_always_lock_free &&
+                  std::atomic<int32_t>::is_always_lock_free,
+              "shared-memory atomics must be address-free");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "futex words must be plain 32-bit integers");
+
+/// Control block of one ring. Producer and consumer fields are on separate
+/// cache lines.
+struct alignas(64) RingControl {
+    std::atomic<uint64_t> head;           ///< bytes written (producer)
+    std::atomic<uint32_t> data_seq;       ///< futex: bumped after each write
+    std::atomic<uint32_t> data_waiters;   ///< consumers asleep on data_seq
+    alignas(64) std::atomic<uint64_t> tail;   ///< bytes read (consumer)
+    std::atomic<uint32_t> space_seq;      ///< futex: bumped after each read
+    std::atomic<uint32_t> space_waiters;  ///< producers asleep on space_seq
+};
+
+struct alignas(64) SlotHeader {
+    std::atomic<int32_t> owner;        ///< client pid; 0 = free
+    std::atomic<uint32_t> generation;  ///< bumped by every claim
+    RingControl request;               ///< client -> broker
+    RingControl response;              ///< broker -> client
+};
+
+/// How long a blocked ring operation may wait: until `deadline`, checking
+/// `alive` every `check_interval` while asleep; it fails with kIOError once
+/// `alive` returns false (peer gone, broker stopping).
+struct WaitPolicy {
+    std::chrono::steady_clock::time_point deadline;
+    std::function<bool()> alive;
+    std::chrono::milliseconds check_interval{20};
+};
+
+/// One direction of a slot.
+class ShmRing {
+public:
+    ShmRing() = default;
+    ShmRing(RingControl* control, uint8_t* data, uint64_t capacity)
+        : control_(control), data_(data), capacity_(capacity) {}
+
+    /// Largest frame (length prefix included) that fits.
+    uint64_t Capacity() const { return capacity_; }
+
+    /// Write one whole frame (as built by FrameWriter). Producer only.
+    /// kInvalidArgument if it can never fit, kTimeout / kIOError per
+    /// `policy` while the ring stays full.
+    core::ErrorCode Write(const std::vector<uint8_t>& frame, const WaitPolicy& policy);
+
+    /// Read the next frame's payload (without the length prefix).
+    /// Consumer only. kTimeout / kIOError per `policy` while it is empty;
+    /// kDataLoss for a corrupt length.
+    core::ErrorCode Read(std::vector<uint8_t>& payload, const WaitPolicy& policy);
+
+    /// Wake a consumer blocked in Read() so it re-checks its policy.
+    void WakeConsumer();
+
+    /// Drop everything in the ring. Only while neither side is using it.
+    void Reset();
+
+private:
+    bool TryWrite(const std::vector<uint8_t>& frame);
+    bool TryRead(std::vector<uint8_t>& payload, core::ErrorCode& error);
+    void CopyIn(uint64_t position, const uint8_t* bytes, std::size_t size);
+    void CopyOut(uint64_t position, uint8_t* bytes, std::size_t size) const;
+
+    RingControl* control_ = nullptr;
+    uint8_t* data_ = nullptr;
+    uint64_t capacity_ = 0;  // power of two
+};
+
+/// A slot's header and rings, as seen from either side.
+struct ShmSlot {
+    SlotHeader* header = nullptr;
+    ShmRing request;
+    ShmRing response;
+};
+
+/// A mapped broker region.
+class ShmRegion {
+public:
+    ~ShmRegion();
+
+    ShmRegion(const ShmRegion&) = delete;
+    ShmRegion& operator=(const ShmRegion&) = delete;
+
+    /// Create the region of broker `name` for this process. A region left
+    /// behind by a broker that died is replaced; kAlreadyOpen if its broker
+    /// is still running. The region is unlinked when this object goes.
+    static core::Result<std::unique_ptr<ShmRegion>> Create(const std::string& name,
+                                                           uint32_t slots,
+                                                           std::size_t ring_bytes);
+
+    /// Map the region of a running broker. kNotFound if there is none.
+    static core::Result<std::unique_ptr<ShmRegion>> Open(const std::string& name);
+
+    uint32_t SlotCount() const;
+    std::size_t RingBytes() const;
+    ShmSlot Slot(uint32_t index) const;
+
+    /// Pid of the broker serving the region; 0 once it has stopped.
+    int32_t BrokerPid() const;
+
+private:
+    ShmRegion() = default;
+
+    std::string shm_name_;
+    void* base_ = nullptr;
+    std::size_t map_size_ = 0;
+    bool owner_ = false;
+};
+
+/// Letters, digits, '-' and '_', 1..64 characters.
+bool IsValidBrokerName(const std::string& name);
+
+/// True while process `pid` exists.
+bool ProcessAlive(int32_t pid);
+
+}  // namespace plas::remote::detail
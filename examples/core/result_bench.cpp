@@ -0,0 +1,111 @@
+/// @file result_bench.cpp
+/// @brief Microbenchmark: compact Result<DWord> vs. a variant-based layout.
+///
+/// Demonstrates how to:
+///  1. Compare the size of Result<DWord> with std::variant<DWord, error_code>
+///  2. Time a non-inlined "register read" returning each layout
+///  3. Time the error path, where Error() builds the std::error_code
+///
+/// Usage: result_bench [iterations]  (default 100000000)
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <system_error>
+#include <variant>
+
+#include "plas/core/result.h"
+#include "plas/core/types.h"
+
+namespace {
+
+using plas::core::DWord;
+using plas::core::ErrorCode;
+using plas::core::Result;
+
+/// The layout Result<DWord> had before the compact representation.
+class VariantResult {
+public:
+    static VariantResult Ok(DWord value) {
+        VariantResult r;
+        r.storage_.emplace<0>(value);
+        return r;
+    }
+    static VariantResult Err(ErrorCode code) {
+        VariantResult r;
+        r.storage_.emplace<1>(make_error_code(code));
+        return r;
+    }
+    bool IsOk() const { return storage_.index() == 0; }
+    DWord Value() const { return *std::get_if<0>(&storage_); }
+    std::error_code Error() const { return *std::get_if<1>(&storage_); }
+
+private:
+    std::variant<DWord, std::error_code> storage_;
+};
+
+volatile DWord g_register[256];
+
+/// Non-inlined reads, like a virtual ReadConfig32 across a library boundary.
+/// Offsets with bit 0 set fail.
+[[gnu::noinline]] Result<DWord> ReadCompact(uint32_t offset) {
+    if (offset & 1) {
+        return Result<DWord>::Err(ErrorCode::kIOError);
+    }
+    return Result<DWord>::Ok(g_register[offset & 0xFF]);
+}
+
+[[gnu::noinline]] VariantResult ReadVariant(uint32_t offset) {
+    if (offset & 1) {
+        return VariantResult::Err(ErrorCode::kIOError);
+    }
+    return VariantResult::Ok(g_register[offset & 0xFF]);
+}
+
+template <typename Read>
+double NsPerCall(Read read, uint64_t iterations, uint32_t stride,
+                 uint64_t& checksum) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        auto r = read(static_cast<uint32_t>(i * stride));
+        sum += r.IsOk() ? r.Value()
+                        : static_cast<uint64_t>(r.Error().value());
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    checksum += sum;
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           static_cast<double>(iterations);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint64_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 0)
+                                   : 100000000ull;
+    for (uint32_t i = 0; i < 256; ++i) {
+        g_register[i] = i * 0x01010101u;
+    }
+
+    std::printf("[*] sizeof(Result<DWord>)                   = %zu\n",
+                sizeof(Result<DWord>));
+    std::printf("[*] sizeof(variant<DWord, std::error_code>) = %zu\n",
+                sizeof(VariantResult));
+
+    uint64_t checksum = 0;
+    // Even strides: every read succeeds. Stride 1: half of them fail.
+    double compact_ok = NsPerCall(ReadCompact, iterations, 2, checksum);
+    double variant_ok = NsPerCall(ReadVariant, iterations, 2, checksum);
+    double compact_mixed = NsPerCall(ReadCompact, iterations, 1, checksum);
+    double variant_mixed = NsPerCall(ReadVariant, iterations, 1, checksum);
+
+    std::printf("[*] %llu reads per run (checksum %llu)\n",
+                static_cast<unsigned long long>(iterations),
+                static_cast<unsigned long long>(checksum));
+    std::printf("    all ok      compact %.2f ns  variant %.2f ns\n",
+                compact_ok, variant_ok);
+    std::printf("    half error  compact %.2f ns  variant %.2f ns\n",
+                compact_mixed, variant_mixed);
+    return 0;
+}
@@ -0,0 +1,133 @@
+/// @file trace_decode.cpp
+/// @brief Example: record a binary bus trace and decode it.
+///
+/// Demonstrates how to:
+///  1. Open the memory-mapped trace ring with Tracer::Open()
+///  2. Record transactions with TraceSpan (what the drivers do internally)
+///  3. Decode a trace file: validate the header, then walk the ring from
+///     the oldest surviving record to the newest
+///
+/// Usage:
+///   trace_decode              write a small demo trace, then decode it
+///   trace_decode FILE         decode an existing trace (e.g. logs/plas.trace)
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "plas/log/trace.h"
+
+using namespace plas::log;
+
+namespace {
+
+void WriteDemoTrace(const std::string& path) {
+    auto& tracer = Tracer::GetInstance();
+    uint16_t eeprom = tracer.RegisterDevice("eeprom0");
+    uint16_t nvme = tracer.RegisterDevice("nvme0");
+
+    TraceConfig config;
+    config.path = path;
+    config.capacity = 16;
+    auto result = tracer.Open(config);
+    if (result.IsError()) {
+        std::printf("[!] Tracer::Open failed: %s\n",
+                    result.Error().message().c_str());
+        return;
+    }
+
+    // 20 records into a 16-slot ring: the first 4 are overwritten.
+    for (uint64_t i = 0; i < 20; ++i) {
+        TraceSpan span(eeprom, TraceInterface::kI2c, TraceOp::kRead, 0x50, 8);
+    }
+    {
+        TraceSpan span(nvme, TraceInterface::kPciConfig, TraceOp::kRead, 0x00,
+                       4, 0x0100);
+    }
+    tracer.Close();
+    std::printf("[*] Wrote demo trace: %s\n\n", path.c_str());
+}
+
+std::string FormatTime(uint64_t ns) {
+    std::time_t secs = static_cast<std::time_t>(ns / 1000000000ull);
+    std::tm tm{};
+    gmtime_r(&secs, &tm);
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%02d:%02d:%02d.%09" PRIu64, tm.tm_hour,
+                  tm.tm_min, tm.tm_sec, static_cast<uint64_t>(ns % 1000000000u));
+    return buf;
+}
+
+int Decode(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    TraceFileHeader header{};
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        std::printf("[!] %s: cannot read header\n", path.c_str());
+        return 1;
+    }
+    if (std::memcmp(header.magic, kTraceMagic, sizeof(header.magic)) != 0 ||
+        header.version != kTraceFormatVersion ||
+        header.record_size != sizeof(TraceRecord)) {
+        std::printf("[!] %s: not a PLAS trace (or unsupported version)\n",
+                    path.c_str());
+        return 1;
+    }
+
+    std::vector<TraceRecord> slots(header.capacity);
+    in.read(reinterpret_cast<char*>(slots.data()),
+            static_cast<std::streamsize>(slots.size() * sizeof(TraceRecord)));
+
+    uint64_t end = header.write_index;
+    uint64_t begin = end > header.capacity ? end - header.capacity : 0;
+    std::printf("[*] %" PRIu64 " records written, %" PRIu64
+                " kept (capacity %" PRIu64 ")\n",
+                end, end - begin, header.capacity);
+    std::printf("%-8s %-18s %-10s %-10s %-10s %-8s %10s %6s %8s %6s\n", "seq",
+                "time(UTC)", "device", "iface", "op", "target", "address",
+                "len", "dur(ns)", "status");
+
+    for (uint64_t n = begin; n < end; ++n) {
+        const TraceRecord& rec = slots[n % header.capacity];
+        if (rec.sequence != n + 1) {
+            continue;  // slot was mid-write when the file was captured
+        }
+        const char* device = "?";
+        if (rec.device_id > 0 && rec.device_id <= header.device_count &&
+            rec.device_id <= kTraceMaxDevices) {
+            device = header.device_names[rec.device_id - 1];
+        }
+        auto iface = static_cast<TraceInterface>(rec.interface);
+        char target[16] = "-";
+        if (iface == TraceInterface::kPciConfig ||
+            iface == TraceInterface::kPciBar ||
+            iface == TraceInterface::kPciDoe) {
+            std::snprintf(target, sizeof(target), "%02x:%02x.%x",
+                          rec.target >> 8, (rec.target >> 3) & 0x1F,
+                          rec.target & 0x7);
+        }
+        std::printf("%-8" PRIu64 " %-18s %-10s %-10s %-10s %-8s %#10" PRIx64
+                    " %6u %8u %6u\n",
+                    rec.sequence, FormatTime(rec.timestamp_ns).c_str(), device,
+                    ToString(iface),
+                    ToString(static_cast<TraceOp>(rec.op)), target,
+                    rec.address, rec.length, rec.duration_ns, rec.status);
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string path;
+    if (argc > 1) {
+        path = argv[1];
+    } else {
+        path = "plas_demo.trace";
+        WriteDemoTrace(path);
+    }
+    return Decode(path);
+}
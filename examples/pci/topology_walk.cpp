@@ -6,8 +6,10 @@
 ///  2. Query device info from sysfs
 ///  3. Walk up the topology to find parent bridges and root port
 ///  4. Display the full path from endpoint to root port
+///  5. List every function in the system in one parallel scan (--all)
 ///
 /// Usage: ./topology_walk <DDDD:BB:DD.F>
+///        ./topology_walk --all
 /// Example: ./topology_walk 0000:41:00.0
 ///
 /// Requires Linux sysfs (runs on real hardware only).
@@ -44,15 +46,46 @@ static const char* PortTypeName(plas::hal::pci::PciePortType type) {
     }
 }
 
+static int ListAll() {
+    using namespace plas::hal::pci;
+
+    auto inventory_result = PciTopology::EnumerateAll();
+    if (inventory_result.IsError()) {
+        std::printf("Error: EnumerateAll failed: %s\n",
+                    inventory_result.Error().message().c_str());
+        return 1;
+    }
+
+    const auto& inv = inventory_result.Value();
+    std::printf("[*] %zu PCI functions:\n", inv.Size());
+    for (size_t i = 0; i < inv.Size(); ++i) {
+        std::printf("    %s  %04x:%04x  class %06x  %-22s",
+                    inv.addresses[i].ToString().c_str(), inv.vendor_ids[i],
+                    inv.device_ids[i], inv.class_codes[i],
+                    PortTypeName(inv.port_types[i]));
+        if (inv.link_status[i] != 0) {
+            // Link Status: current speed [3:0] (Gen), width [9:4]
+            std::printf("  Gen%u x%u", inv.link_status[i] & 0x0F,
+                        (inv.link_status[i] >> 4) & 0x3F);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     using namespace plas::hal::pci;
 
     if (argc < 2) {
-        std::printf("Usage: %s <DDDD:BB:DD.F>\n", argv[0]);
+        std::printf("Usage: %s <DDDD:BB:DD.F> | --all\n", argv[0]);
         std::printf("Example: %s 0000:41:00.0\n", argv[0]);
         return 1;
     }
 
+    if (std::string(argv[1]) == "--all") {
+        return ListAll();
+    }
+
     // --- Parse PCI address ---
     auto addr_result = PciAddress::FromString(argv[1]);
     if (addr_result.IsError()) {
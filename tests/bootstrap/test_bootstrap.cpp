@@ -1,14 +1,29 @@
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "plas/bootstrap/bootstrap.h"
+#include "plas/config/config.h"
 #include "plas/config/config_node.h"
 #include "plas/config/property_manager.h"
 #include "plas/core/error.h"
 #include "plas/core/properties.h"
 #include "plas/hal/device_manager.h"
 #include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_factory.h"
 #include "plas/hal/interface/i2c.h"
 #include "plas/hal/interface/power_control.h"
+#include "plas/log/logger.h"
 
 using plas::bootstrap::Bootstrap;
 using plas::bootstrap::BootstrapConfig;
@@ -621,6 +636,267 @@ TEST_F(BootstrapTest, DumpDevicesEmpty) {
     EXPECT_NE(dump.find("Devices (0)"), std::string::npos);
 }
 
+// ===========================================================================
+// Parallel open
+// ===========================================================================
+
+namespace {
+
+/// Device whose Open() always fails; registered as driver "failopen".
+class FailOpenDevice : public Device {
+public:
+    explicit FailOpenDevice(const plas::config::DeviceEntry& entry)
+        : name_(entry.nickname), uri_(entry.uri) {}
+
+    plas::core::Result<void> Init() override {
+        state_ = DeviceState::kInitialized;
+        return plas::core::Result<void>::Ok();
+    }
+    plas::core::Result<void> Open() override {
+        return plas::core::Result<void>::Err(ErrorCode::kIOError);
+    }
+    plas::core::Result<void> Close() override {
+        return plas::core::Result<void>::Ok();
+    }
+    plas::core::Result<void> Reset() override {
+        return plas::core::Result<void>::Ok();
+    }
+    DeviceState GetState() const override { return state_; }
+    std::string GetName() const override { return name_; }
+    std::string GetUri() const override { return uri_; }
+    std::string GetDriverName() const override { return "failopen"; }
+
+private:
+    std::string name_;
+    std::string uri_;
+    DeviceState state_ = DeviceState::kUninitialized;
+};
+
+void RegisterFailOpenDriver() {
+    plas::hal::DeviceFactory::RegisterDriver(
+        "failopen", [](const plas::config::DeviceEntry& entry) {
+            return std::make_unique<FailOpenDevice>(entry);
+        });
+}
+
+}  // namespace
+
+TEST_F(BootstrapTest, ParallelOpenOpensAllDevices) {
+    Bootstrap bs;
+    BootstrapConfig cfg;
+    cfg.device_config_path = FixturePath("bootstrap_basic_config.yaml");
+    cfg.open_workers = 4;
+    auto result = bs.Init(cfg);
+    ASSERT_TRUE(result.IsOk()) << result.Error().message();
+    EXPECT_EQ(result.Value().devices_opened, 2u);
+    for (const auto& name : bs.DeviceNames()) {
+        EXPECT_EQ(bs.GetDevice(name)->GetState(), DeviceState::kOpen) << name;
+    }
+}
+
+TEST_F(BootstrapTest, ParallelOpenReportsSameFailuresAsSequential) {
+    RegisterFailOpenDriver();
+
+    auto run = [&](std::size_t workers) {
+        Bootstrap bs;
+        BootstrapConfig cfg;
+        cfg.device_config_path = FixturePath("bootstrap_parallel_config.yaml");
+        cfg.open_workers = workers;
+        auto result = bs.Init(cfg);
+        EXPECT_TRUE(result.IsOk());
+        return result.IsOk() ? result.Value() : BootstrapResult{};
+    };
+
+    auto sequential = run(1);
+    auto parallel = run(8);
+
+    EXPECT_EQ(sequential.devices_opened, 4u);
+    EXPECT_EQ(sequential.devices_failed, 2u);
+    EXPECT_EQ(parallel.devices_opened, sequential.devices_opened);
+    EXPECT_EQ(parallel.devices_failed, sequential.devices_failed);
+    ASSERT_EQ(parallel.failures.size(), sequential.failures.size());
+    for (std::size_t i = 0; i < parallel.failures.size(); ++i) {
+        const auto& p = parallel.failures[i];
+        const auto& s = sequential.failures[i];
+        EXPECT_EQ(p.nickname, s.nickname);
+        EXPECT_EQ(p.uri, s.uri);
+        EXPECT_EQ(p.error, s.error);
+        EXPECT_EQ(p.phase, s.phase);
+        EXPECT_EQ(p.detail, s.detail);
+    }
+    EXPECT_EQ(parallel.failures[0].nickname, "flaky0");
+    EXPECT_EQ(parallel.failures[0].phase, "open");
+}
+
+TEST_F(BootstrapTest, ParallelOpenHardFailureRollsBack) {
+    RegisterFailOpenDriver();
+
+    Bootstrap bs;
+    BootstrapConfig cfg;
+    cfg.device_config_path = FixturePath("bootstrap_parallel_config.yaml");
+    cfg.open_workers = 4;
+    cfg.skip_device_failures = false;
+    auto result = bs.Init(cfg);
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), plas::core::make_error_code(ErrorCode::kIOError));
+    EXPECT_FALSE(bs.IsInitialized());
+    EXPECT_EQ(DeviceManager::GetInstance().DeviceCount(), 0u);
+}
+
+// ===========================================================================
+// Lazy open
+// ===========================================================================
+
+TEST_F(BootstrapTest, LazyOpenDefersUntilFirstLookup) {
+    Bootstrap bs;
+    BootstrapConfig cfg;
+    cfg.device_config_path = FixturePath("bootstrap_basic_config.yaml");
+    cfg.lazy_open_devices = true;
+    auto result = bs.Init(cfg);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value().devices_opened, 2u);
+
+    auto& dm = DeviceManager::GetInstance();
+    EXPECT_EQ(dm.PeekDevice("aardvark0")->GetState(),
+              DeviceState::kUninitialized);
+    EXPECT_NE(bs.DumpDevices().find("uninitialized"), std::string::npos);
+
+    auto* i2c = bs.GetInterface<I2c>("aardvark0");
+    ASSERT_NE(i2c, nullptr);
+    EXPECT_EQ(dm.PeekDevice("aardvark0")->GetState(), DeviceState::kOpen);
+    EXPECT_EQ(dm.PeekDevice("aardvark1")->GetState(),
+              DeviceState::kUninitialized);
+
+    bs.Deinit();
+    EXPECT_FALSE(dm.IsLazyOpen());
+}
+
+// ===========================================================================
+// Metrics
+// ===========================================================================
+
+TEST_F(BootstrapTest, EnableMetricsTurnsOnCollection) {
+    auto& registry = plas::hal::MetricsRegistry::GetInstance();
+    registry.SetEnabled(false);
+
+    Bootstrap bs;
+    BootstrapConfig cfg;
+    cfg.device_config_path = FixturePath("bootstrap_basic_config.yaml");
+    cfg.enable_metrics = true;
+    ASSERT_TRUE(bs.Init(cfg).IsOk());
+    EXPECT_TRUE(registry.IsEnabled());
+
+    registry.GetDeviceMetrics("aardvark0")
+        ->Record(plas::hal::MetricOp::kI2cRead, 2000, 8, true);
+    auto snapshot = bs.GetMetricsSnapshot();
+    EXPECT_NE(snapshot.Find("aardvark0", plas::hal::MetricOp::kI2cRead),
+              nullptr);
+
+    auto dump = bs.DumpMetrics();
+    EXPECT_NE(dump.find("aardvark0"), std::string::npos);
+    EXPECT_NE(dump.find("i2c-read"), std::string::npos);
+
+    registry.SetEnabled(false);
+    registry.Reset();
+}
+
+// ===========================================================================
+// Startup timing
+// ===========================================================================
+
+TEST_F(BootstrapTest, InitReportsPhaseAndDeviceTimings) {
+    Bootstrap bs;
+    BootstrapConfig cfg;
+    cfg.device_config_path = FixturePath("bootstrap_basic_config.yaml");
+    auto result = bs.Init(cfg);
+    ASSERT_TRUE(result.IsOk()) << result.Error().message();
+
+    const auto& timing = result.Value().timing;
+    EXPECT_GT(timing.total.wall.count(), 0);
+    EXPECT_GE(timing.total.wall, timing.parse.wall + timing.create.wall + timing.open.wall);
+    ASSERT_EQ(timing.devices.size(), 2u);
+    for (const auto& device : timing.devices) {
+        EXPECT_FALSE(device.nickname.empty());
+        EXPECT_GT(device.open.wall.count(), 0) << device.nickname;
+        EXPECT_GE(device.open.start, device.init.start + device.init.wall);
+    }
+}
+
+TEST_F(BootstrapTest, StartupTraceIsWrittenAsChromeTrace) {
+    const std::string path = "bootstrap_startup_trace.json";
+    Bootstrap bs;
+    BootstrapConfig cfg;
+    cfg.device_config_path = FixturePath("bootstrap_basic_config.yaml");
+    cfg.startup_trace_path = path;
+    ASSERT_TRUE(bs.Init(cfg).IsOk());
+
+    std::ifstream in(path);
+    ASSERT_TRUE(in.is_open());
+    std::string trace((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(trace.find("\"name\":\"parse\""), std::string::npos);
+    EXPECT_NE(trace.find("\"name\":\"open aardvark0\""), std::string::npos);
+    std::remove(path.c_str());
+}
+
+// ===========================================================================
+// Warm restart
+// ===========================================================================
+
+TEST_F(BootstrapTest, PrepareWarmRestartRequiresInit) {
+    Bootstrap bs;
+    EXPECT_EQ(bs.PrepareWarmRestart().Error(),
+              plas::core::make_error_code(ErrorCode::kNotInitialized));
+}
+
+TEST_F(BootstrapTest, WarmRestartReopensDevicesWithoutHandoffSupport) {
+    BootstrapConfig cfg;
+    cfg.device_config_path = FixturePath("bootstrap_basic_config.yaml");
+    {
+        Bootstrap before;
+        ASSERT_TRUE(before.Init(cfg).IsOk());
+        auto handed = before.PrepareWarmRestart();
+        ASSERT_TRUE(handed.IsOk()) << handed.Error().message();
+        EXPECT_EQ(handed.Value(), 0u);  // Aardvark handles stay in-process
+        EXPECT_NE(std::getenv(Bootstrap::kWarmRestartEnv), nullptr);
+        EXPECT_EQ(before.GetDevice("aardvark0")->GetState(), DeviceState::kOpen);
+    }
+
+    Bootstrap after;
+    cfg.warm_restart = true;
+    auto result = after.Init(cfg);
+    ASSERT_TRUE(result.IsOk()) << result.Error().message();
+    EXPECT_EQ(result.Value().devices_opened, 2u);
+    EXPECT_EQ(result.Value().devices_adopted, 0u);
+    EXPECT_EQ(std::getenv(Bootstrap::kWarmRestartEnv), nullptr);
+}
+
+#ifdef __linux__
+TEST_F(BootstrapTest, WarmRestartClosesDescriptorsOfMalformedRecords) {
+    int pipe_fds[2];
+    ASSERT_EQ(::pipe(pipe_fds), 0);
+    ::close(pipe_fds[1]);
+    // Odd-length state: the record is dropped, its descriptor must not leak.
+    const std::string blob = "plas-warm-restart 1\naardvark0\taardvark\taardvark://0:0x50\t" +
+                             std::to_string(pipe_fds[0]) + "\tabc\n";
+    FILE* state = std::tmpfile();
+    ASSERT_NE(state, nullptr);
+    ASSERT_EQ(std::fwrite(blob.data(), 1, blob.size(), state), blob.size());
+    std::fflush(state);
+    ::setenv(Bootstrap::kWarmRestartEnv, std::to_string(::dup(::fileno(state))).c_str(), 1);
+    std::fclose(state);
+
+    BootstrapConfig cfg;
+    cfg.device_config_path = FixturePath("bootstrap_basic_config.yaml");
+    cfg.warm_restart = true;
+    Bootstrap bs;
+    auto result = bs.Init(cfg);
+    ASSERT_TRUE(result.IsOk()) << result.Error().message();
+    EXPECT_EQ(result.Value().devices_adopted, 0u);
+    EXPECT_EQ(::fcntl(pipe_fds[0], F_GETFD), -1);
+}
+#endif
+
 // ===========================================================================
 // ValidateUri
 // ===========================================================================
@@ -630,6 +906,9 @@ TEST_F(BootstrapTest, ValidateUriValid) {
     EXPECT_TRUE(Bootstrap::ValidateUri("ft4222h://0:1"));
     EXPECT_TRUE(Bootstrap::ValidateUri("pciutils://0000:03:00.0"));
     EXPECT_TRUE(Bootstrap::ValidateUri("pmu3://usb:PMU3-001"));
+    EXPECT_TRUE(Bootstrap::ValidateUri("remote://lab-07/eeprom"));
+    EXPECT_TRUE(Bootstrap::ValidateUri("remote://lab-07:7701/eeprom"));
+    EXPECT_TRUE(Bootstrap::ValidateUri("shm://plas:eeprom"));
 }
 
 TEST_F(BootstrapTest, ValidateUriMissingScheme) {
@@ -796,3 +1075,222 @@ TEST_F(BootstrapTest, InitNeitherPathNorNode) {
     EXPECT_EQ(result.Error(),
               plas::core::make_error_code(ErrorCode::kInvalidArgument));
 }
+
+// ===========================================================================
+// Reload
+// ===========================================================================
+
+namespace {
+
+const char* kReloadBase = R"(devices:
+  - nickname: keep
+    driver: aardvark
+    uri: "aardvark://0:0x50"
+  - nickname: edit
+    driver: aardvark
+    uri: "aardvark://1:0x48"
+  - nickname: drop
+    driver: aardvark
+    uri: "aardvark://2:0x48"
+)";
+
+const char* kReloadUpdated = R"(devices:
+  - nickname: keep
+    driver: aardvark
+    uri: "aardvark://0:0x50"
+  - nickname: edit
+    driver: aardvark
+    uri: "aardvark://1:0x49"
+  - nickname: added
+    driver: aardvark
+    uri: "aardvark://3:0x48"
+)";
+
+struct TempConfig {
+    explicit TempConfig(const char* content) { Write(content); }
+    ~TempConfig() { std::remove(path.c_str()); }
+    void Write(const char* content) { std::ofstream(path) << content; }
+    std::string path = "bootstrap_reload_test.yaml";
+};
+
+}  // namespace
+
+TEST_F(BootstrapTest, ReloadBeforeInitFails) {
+    Bootstrap bs;
+    auto result = bs.Reload();
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              plas::core::make_error_code(ErrorCode::kNotInitialized));
+}
+
+TEST_F(BootstrapTest, ReloadReplacesOnlyChangedDevices) {
+    TempConfig file(kReloadBase);
+    Bootstrap bs;
+    BootstrapConfig cfg;
+    cfg.device_config_path = file.path;
+    ASSERT_TRUE(bs.Init(cfg).IsOk());
+    auto* keep = bs.GetDevice("keep");
+    auto* edit = bs.GetDevice("edit");
+    ASSERT_EQ(keep->GetState(), DeviceState::kOpen);
+
+    file.Write(kReloadUpdated);
+    auto result = bs.Reload();
+    ASSERT_TRUE(result.IsOk()) << result.Error().message();
+    EXPECT_EQ(result.Value().devices_added, 1u);
+    EXPECT_EQ(result.Value().devices_changed, 1u);
+    EXPECT_EQ(result.Value().devices_removed, 1u);
+    EXPECT_EQ(result.Value().devices_unchanged, 1u);
+
+    EXPECT_EQ(bs.GetDevice("keep"), keep);
+    EXPECT_EQ(keep->GetState(), DeviceState::kOpen);
+    EXPECT_EQ(edit->GetState(), DeviceState::kClosed);
+    ASSERT_NE(bs.GetDevice("edit"), edit);
+    EXPECT_EQ(bs.GetDevice("edit")->GetState(), DeviceState::kOpen);
+    EXPECT_EQ(bs.GetDevice("edit")->GetUri(), "aardvark://1:0x49");
+    EXPECT_EQ(bs.GetDevice("drop"), nullptr);
+    ASSERT_NE(bs.GetDevice("added"), nullptr);
+    EXPECT_EQ(bs.GetDevice("added")->GetState(), DeviceState::kOpen);
+
+    auto again = bs.Reload();
+    ASSERT_TRUE(again.IsOk());
+    EXPECT_EQ(again.Value().devices_unchanged, 3u);
+    EXPECT_EQ(again.Value().devices_added + again.Value().devices_changed +
+                  again.Value().devices_removed,
+              0u);
+}
+
+TEST_F(BootstrapTest, ReloadSkipsUnknownDriverAndKeepsOldDevice) {
+    TempConfig file(kReloadBase);
+    Bootstrap bs;
+    BootstrapConfig cfg;
+    cfg.device_config_path = file.path;
+    ASSERT_TRUE(bs.Init(cfg).IsOk());
+    auto* edit = bs.GetDevice("edit");
+
+    file.Write(R"(devices:
+  - nickname: keep
+    driver: aardvark
+    uri: "aardvark://0:0x50"
+  - nickname: edit
+    driver: no_such_driver
+    uri: "no_such_driver://1:0x48"
+  - nickname: drop
+    driver: aardvark
+    uri: "aardvark://2:0x48"
+)");
+    auto result = bs.Reload();
+    ASSERT_TRUE(result.IsOk()) << result.Error().message();
+    EXPECT_EQ(result.Value().devices_changed, 0u);
+    EXPECT_EQ(result.Value().devices_skipped, 1u);
+    ASSERT_EQ(bs.GetFailures().size(), 1u);
+    EXPECT_EQ(bs.GetFailures()[0].nickname, "edit");
+    EXPECT_EQ(bs.GetDevice("edit"), edit);
+    EXPECT_EQ(edit->GetState(), DeviceState::kOpen);
+}
+
+TEST_F(BootstrapTest, ReloadStrictFailureLeavesDevicesUntouched) {
+    TempConfig file(kReloadBase);
+    Bootstrap bs;
+    BootstrapConfig cfg;
+    cfg.device_config_path = file.path;
+    cfg.skip_unknown_drivers = false;
+    ASSERT_TRUE(bs.Init(cfg).IsOk());
+    auto names = bs.DeviceNames();
+
+    auto updated = plas::config::Config::LoadFromFile(file.path);
+    ASSERT_TRUE(updated.IsOk());
+    file.Write(R"(devices:
+  - nickname: other
+    driver: no_such_driver
+    uri: "no_such_driver://1:0x48"
+)");
+    auto result = bs.Reload();
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(bs.DeviceNames(), names);
+    EXPECT_EQ(bs.GetDevice("keep")->GetState(), DeviceState::kOpen);
+
+    // An explicit Config works too: the original one is a no-op.
+    auto same = bs.Reload(updated.Value());
+    ASSERT_TRUE(same.IsOk());
+    EXPECT_EQ(same.Value().devices_unchanged, 3u);
+}
+
+// ===========================================================================
+// Isolated contexts
+// ===========================================================================
+
+TEST_F(BootstrapTest, IsolatedInitUsesOwnContexts) {
+    Bootstrap bs;
+    BootstrapConfig cfg;
+    cfg.device_config_path = FixturePath("bootstrap_basic_config.yaml");
+    cfg.properties_config_path = FixturePath("bootstrap_properties_config.yaml");
+    cfg.validation_mode = plas::configspec::ValidationMode::kStrict;
+    cfg.isolated = true;
+
+    auto result = bs.Init(cfg);
+    ASSERT_TRUE(result.IsOk()) << result.Error().message();
+    EXPECT_EQ(result.Value().devices_opened, 2u);
+
+    EXPECT_NE(bs.GetDeviceManager(), &DeviceManager::GetInstance());
+    EXPECT_NE(bs.GetPropertyManager(), &plas::config::PropertyManager::GetInstance());
+    EXPECT_EQ(bs.GetDeviceManager()->DeviceCount(), 2u);
+    EXPECT_EQ(DeviceManager::GetInstance().DeviceCount(), 0u);
+    EXPECT_NE(bs.GetInterface<I2c>("aardvark0"), nullptr);
+
+    EXPECT_TRUE(bs.GetPropertyManager()->HasSession("session_a"));
+    EXPECT_EQ(bs.GetPropertyManager()->Session("session_a").Get<int64_t>("key2").Value(), 42);
+    EXPECT_FALSE(plas::core::Properties::HasSession("session_a"));
+
+    bs.Deinit();
+    EXPECT_EQ(bs.GetDeviceManager()->DeviceCount(), 0u);
+    EXPECT_FALSE(bs.GetPropertyManager()->HasSession("session_a"));
+}
+
+TEST_F(BootstrapTest, IsolatedBootstrapsRunInParallel) {
+    constexpr std::size_t kTenants = 4;
+    std::vector<Bootstrap> tenants(kTenants);
+    std::vector<plas::core::Result<BootstrapResult>> results(
+        kTenants, plas::core::Result<BootstrapResult>::Err(ErrorCode::kNotInitialized));
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < kTenants; ++i) {
+        threads.emplace_back([&, i] {
+            BootstrapConfig cfg;
+            cfg.device_config_path = FixturePath("bootstrap_basic_config.yaml");
+            cfg.properties_config_path = FixturePath("bootstrap_properties_config.yaml");
+            cfg.isolated = true;
+            results[i] = tenants[i].Init(cfg);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    for (std::size_t i = 0; i < kTenants; ++i) {
+        ASSERT_TRUE(results[i].IsOk()) << results[i].Error().message();
+        EXPECT_EQ(results[i].Value().devices_opened, 2u);
+        // Same nicknames, separate devices.
+        for (std::size_t j = 0; j < i; ++j) {
+            EXPECT_NE(tenants[i].GetDevice("aardvark0"), tenants[j].GetDevice("aardvark0"));
+        }
+    }
+    EXPECT_EQ(DeviceManager::GetInstance().DeviceCount(), 0u);
+
+    tenants[0].GetPropertyManager()->Session("session_a").Set("key2", int64_t{7});
+    tenants[0].Deinit();
+    EXPECT_EQ(tenants[1].GetPropertyManager()->Session("session_a").Get<int64_t>("key2").Value(), 42);
+    EXPECT_EQ(tenants[1].GetDevice("aardvark1")->GetState(), DeviceState::kOpen);
+}
+
+TEST_F(BootstrapTest, IsolatedLogConfigGetsOwnLogger) {
+    Bootstrap bs;
+    BootstrapConfig cfg;
+    cfg.device_config_path = FixturePath("bootstrap_basic_config.yaml");
+    cfg.log_config = plas::log::LogConfig{};
+    cfg.log_config->console_enabled = false;
+    cfg.log_config->file_prefix = "isolated_tenant";
+    cfg.isolated = true;
+
+    auto result = bs.Init(cfg);
+    ASSERT_TRUE(result.IsOk()) << result.Error().message();
+    ASSERT_NE(bs.GetLogger(), &plas::log::Logger::GetInstance());
+    EXPECT_EQ(bs.GetLogger()->GetCurrentLogFile(), "logs/isolated_tenant.log");
+}
@@ -0,0 +1,241 @@
+// Scale budgets for Bootstrap + DeviceManager, with simulated I2C devices
+// bootstrapped from generated configs of 10 to 10,000 entries.
+//
+// Labelled "scale" in CTest: run it with `ctest -L scale` (nightly) and
+// leave it out of quick runs with `ctest -LE scale`. The budgets are about
+// 10x what a release build on a developer machine needs, so a failure is a
+// regression rather than noise; $PLAS_SCALE_BUDGET_FACTOR scales all of
+// them (e.g. 5 for sanitizer builds).
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "plas/bootstrap/bootstrap.h"
+#include "plas/config/property_manager.h"
+#include "plas/core/properties.h"
+#include "plas/hal/device_manager.h"
+#include "plas/hal/interface/i2c.h"
+
+using plas::bootstrap::Bootstrap;
+using plas::bootstrap::BootstrapConfig;
+using plas::hal::DeviceManager;
+using plas::hal::I2c;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr std::size_t kLookupThreads = 64;
+constexpr std::size_t kLookupsPerThread = 20000;
+
+struct ScaleBudget {
+    std::size_t devices;
+    double init_ms;
+    double kib_per_device;  // heap added by Init(), per device
+    double lookup_p99_ns;   // GetInterface<I2c> with kLookupThreads threads
+    double deinit_ms;
+};
+
+// Init and Deinit grow linearly (parsing the config dominates Init); the
+// 10-device budgets cover driver registration and the logger. A lookup
+// reads an immutable registry snapshot without a lock, so its budget does
+// not grow with the device count.
+constexpr ScaleBudget kBudgets[] = {
+    {10, 50, 64, 5000, 20},
+    {100, 100, 24, 5000, 20},
+    {1000, 600, 24, 5000, 50},
+    {10000, 6000, 24, 5000, 200},
+};
+
+double BudgetFactor() {
+    const char* env = std::getenv("PLAS_SCALE_BUDGET_FACTOR");
+    double factor = env != nullptr ? std::atof(env) : 0.0;
+    return factor > 0.0 ? factor : 1.0;
+}
+
+/// Heap in use, in KiB; 0 where it cannot be read. (Resident set size
+/// would not do: memory freed by a previous case is reused, not returned.)
+double HeapInUseKib() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    auto info = mallinfo2();
+    return static_cast<double>(info.uordblks + info.hblkhd) / 1024.0;
+#else
+    return 0.0;
+#endif
+}
+
+double Millis(Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+std::string Nickname(std::size_t i) {
+    return "sim" + std::to_string(i);
+}
+
+/// `count` sim I2C devices. Addresses repeat across devices; that is fine
+/// for the simulator and keeps every URI valid.
+std::string WriteConfig(std::size_t count) {
+    std::string path = "scale_" + std::to_string(count) + "_devices.yaml";
+    std::ofstream out(path, std::ios::trunc);
+    out << "devices:\n";
+    char addr[8];
+    for (std::size_t i = 0; i < count; ++i) {
+        std::snprintf(addr, sizeof(addr), "0x%02zx", 0x08 + i % 0x70);
+        out << "  - nickname: " << Nickname(i) << "\n"
+            << "    driver: sim\n"
+            << "    uri: \"sim://i2c:" << addr << "\"\n"
+            << "    args:\n"
+            << "      size: \"16\"\n";
+    }
+    return path;
+}
+
+class BootstrapScaleTest : public ::testing::TestWithParam<ScaleBudget> {
+protected:
+    void SetUp() override { ResetAll(); }
+
+    void TearDown() override {
+        ResetAll();
+        std::remove(config_path_.c_str());
+    }
+
+    static void ResetAll() {
+        DeviceManager::GetInstance().Reset();
+        plas::config::PropertyManager::GetInstance().Reset();
+        plas::core::Properties::DestroyAll();
+    }
+
+    std::string config_path_;
+};
+
+TEST_P(BootstrapScaleTest, StaysWithinBudget) {
+    const auto& budget = GetParam();
+    const double factor = BudgetFactor();
+    const std::size_t n = budget.devices;
+    config_path_ = WriteConfig(n);
+
+    std::vector<std::string> nicknames;
+    nicknames.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        nicknames.push_back(Nickname(i));
+    }
+
+    // --- Init ---
+    Bootstrap bs;
+    BootstrapConfig cfg;
+    cfg.device_config_path = config_path_;
+    const double heap_before = HeapInUseKib();
+    auto start = Clock::now();
+    auto result = bs.Init(cfg);
+    const double init_ms = Millis(Clock::now() - start);
+    const double heap_after = HeapInUseKib();
+    ASSERT_TRUE(result.IsOk()) << result.Error().message();
+    ASSERT_EQ(result.Value().devices_opened, n);
+    // The estimate leaves out allocator overhead and what Init() holds
+    // outside the registry, so it stays below the measured heap.
+    const auto report = DeviceManager::GetInstance().GetMemoryReport();
+    ASSERT_EQ(report.devices.size(), n);
+    const double estimated_kib_per_device =
+        static_cast<double>(report.TotalBytes()) / 1024.0 / static_cast<double>(n);
+
+    // --- GetInterface under contention ---
+    std::vector<std::vector<uint32_t>> samples(kLookupThreads);
+    std::atomic<std::size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<std::size_t> misses{0};
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < kLookupThreads; ++t) {
+        threads.emplace_back([&, t] {
+            auto& mine = samples[t];
+            mine.reserve(kLookupsPerThread);
+            auto& manager = DeviceManager::GetInstance();
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            // Each thread walks the devices with its own stride and offset.
+            std::size_t index = t % n;
+            const std::size_t stride = (2 * t + 1) % n == 0 ? 1 : (2 * t + 1) % n;
+            for (std::size_t i = 0; i < kLookupsPerThread; ++i) {
+                auto begin = Clock::now();
+                auto* i2c = manager.GetInterface<I2c>(nicknames[index]);
+                auto end = Clock::now();
+                if (i2c == nullptr) {
+                    misses.fetch_add(1, std::memory_order_relaxed);
+                }
+                mine.push_back(static_cast<uint32_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
+                        .count()));
+                index = (index + stride) % n;
+            }
+        });
+    }
+    while (ready.load() < kLookupThreads) {
+        std::this_thread::yield();
+    }
+    go.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(misses.load(), 0u);
+
+    std::vector<uint32_t> all;
+    all.reserve(kLookupThreads * kLookupsPerThread);
+    for (const auto& mine : samples) {
+        all.insert(all.end(), mine.begin(), mine.end());
+    }
+    auto percentile = [&all](double p) {
+        auto k = static_cast<std::size_t>(p * static_cast<double>(all.size() - 1));
+        std::nth_element(all.begin(), all.begin() + static_cast<std::ptrdiff_t>(k), all.end());
+        return static_cast<double>(all[k]);
+    };
+    const double lookup_p50_ns = percentile(0.50);
+    const double lookup_p99_ns = percentile(0.99);
+
+    // --- Deinit ---
+    start = Clock::now();
+    bs.Deinit();
+    const double deinit_ms = Millis(Clock::now() - start);
+    EXPECT_EQ(DeviceManager::GetInstance().DeviceCount(), 0u);
+
+    const double kib_per_device =
+        heap_before > 0.0 ? std::max(heap_after - heap_before, 0.0) / static_cast<double>(n)
+                          : 0.0;
+    std::printf("[scale] devices=%zu init=%.1f ms mem=%.1f KiB/device (estimated %.1f) "
+                "lookup p50=%.0f ns p99=%.0f ns deinit=%.1f ms\n",
+                n, init_ms, kib_per_device, estimated_kib_per_device, lookup_p50_ns,
+                lookup_p99_ns, deinit_ms);
+    RecordProperty("init_ms", std::to_string(init_ms));
+    RecordProperty("kib_per_device", std::to_string(kib_per_device));
+    RecordProperty("lookup_p99_ns", std::to_string(lookup_p99_ns));
+    RecordProperty("deinit_ms", std::to_string(deinit_ms));
+
+    EXPECT_LE(init_ms, budget.init_ms * factor);
+    EXPECT_LE(kib_per_device, budget.kib_per_device * factor);
+    if (heap_before > 0.0) {
+        EXPECT_LE(estimated_kib_per_device, kib_per_device);
+    }
+    EXPECT_LE(lookup_p99_ns, budget.lookup_p99_ns * factor);
+    EXPECT_LE(deinit_ms, budget.deinit_ms * factor);
+}
+
+INSTANTIATE_TEST_SUITE_P(Devices, BootstrapScaleTest, ::testing::ValuesIn(kBudgets),
+                         [](const ::testing::TestParamInfo<ScaleBudget>& info) {
+                             return "N" + std::to_string(info.param.devices);
+                         });
+
+}  // namespace
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "plas/config/config.h"
+#include "plas/config/config_cache.h"
+#include "plas/config/property_manager.h"
+#include "plas/core/error.h"
+#include "plas/core/properties.h"
+
+using plas::config::Config;
+using plas::config::ConfigCache;
+using plas::config::DeviceEntry;
+using plas::config::PropertyManager;
+using plas::core::Properties;
+
+namespace fs = std::filesystem;
+
+class ConfigCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() /
+               ("plas_config_cache_" + std::to_string(::getpid()));
+        fs::remove_all(dir_);
+        ConfigCache::SetDirectory(dir_.string());
+        ConfigCache::ResetStats();
+        PropertyManager::GetInstance().Reset();
+        Properties::DestroyAll();
+    }
+
+    void TearDown() override {
+        ConfigCache::SetDirectory("");
+        PropertyManager::GetInstance().Reset();
+        Properties::DestroyAll();
+        fs::remove_all(dir_);
+        for (const auto& path : temp_files_) {
+            fs::remove(path);
+        }
+    }
+
+    std::string FixturePath(const std::string& filename) {
+        return "fixtures/" + filename;
+    }
+
+    std::string WriteTemp(const std::string& name, const std::string& content) {
+        std::ofstream(name) << content;
+        temp_files_.push_back(name);
+        return name;
+    }
+
+    std::vector<fs::path> CacheFiles() const {
+        std::vector<fs::path> files;
+        if (fs::exists(dir_)) {
+            for (const auto& entry : fs::directory_iterator(dir_)) {
+                files.push_back(entry.path());
+            }
+        }
+        return files;
+    }
+
+    static void ExpectSameDevices(const std::vector<DeviceEntry>& a,
+                                  const std::vector<DeviceEntry>& b) {
+        ASSERT_EQ(a.size(), b.size());
+        for (size_t i = 0; i < a.size(); ++i) {
+            EXPECT_EQ(a[i].nickname, b[i].nickname);
+            EXPECT_EQ(a[i].uri, b[i].uri);
+            EXPECT_EQ(a[i].driver, b[i].driver);
+            EXPECT_EQ(a[i].args, b[i].args);
+        }
+    }
+
+    fs::path dir_;
+    std::vector<std::string> temp_files_;
+};
+
+TEST_F(ConfigCacheTest, DisabledWithoutDirectory) {
+    ConfigCache::SetDirectory("");
+    auto result = Config::LoadFromFile(FixturePath("test_config.yaml"));
+    ASSERT_TRUE(result.IsOk());
+    auto stats = ConfigCache::GetStats();
+    EXPECT_EQ(stats.hits + stats.misses + stats.writes, 0u);
+    EXPECT_TRUE(CacheFiles().empty());
+}
+
+TEST_F(ConfigCacheTest, SecondLoadHitsCompiledFile) {
+    auto first = Config::LoadFromFile(FixturePath("test_config.yaml"));
+    ASSERT_TRUE(first.IsOk());
+    EXPECT_EQ(ConfigCache::GetStats().misses, 1u);
+    EXPECT_EQ(ConfigCache::GetStats().writes, 1u);
+    EXPECT_EQ(CacheFiles().size(), 1u);
+
+    auto second = Config::LoadFromFile(FixturePath("test_config.yaml"));
+    ASSERT_TRUE(second.IsOk());
+    EXPECT_EQ(ConfigCache::GetStats().hits, 1u);
+    ExpectSameDevices(first.Value().GetDevices(), second.Value().GetDevices());
+}
+
+TEST_F(ConfigCacheTest, EditedSourceMisses) {
+    std::string path = WriteTemp("cache_edit_test.json",
+        R"({"devices":[{"nickname":"a","uri":"aardvark://0:0x50","driver":"aardvark"}]})");
+    ASSERT_TRUE(Config::LoadFromFile(path).IsOk());
+
+    WriteTemp(path,
+        R"({"devices":[{"nickname":"b","uri":"aardvark://0:0x51","driver":"aardvark"}]})");
+    auto result = Config::LoadFromFile(path);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(ConfigCache::GetStats().hits, 0u);
+    ASSERT_EQ(result.Value().GetDevices().size(), 1u);
+    EXPECT_EQ(result.Value().GetDevices()[0].nickname, "b");
+}
+
+TEST_F(ConfigCacheTest, CorruptFileIsRecompiled) {
+    auto first = Config::LoadFromFile(FixturePath("test_config.json"));
+    ASSERT_TRUE(first.IsOk());
+    auto files = CacheFiles();
+    ASSERT_EQ(files.size(), 1u);
+    fs::resize_file(files[0], fs::file_size(files[0]) - 1);
+
+    auto second = Config::LoadFromFile(FixturePath("test_config.json"));
+    ASSERT_TRUE(second.IsOk());
+    EXPECT_EQ(ConfigCache::GetStats().hits, 0u);
+    EXPECT_EQ(ConfigCache::GetStats().writes, 2u);
+    ExpectSameDevices(first.Value().GetDevices(), second.Value().GetDevices());
+
+    ASSERT_TRUE(Config::LoadFromFile(FixturePath("test_config.json")).IsOk());
+    EXPECT_EQ(ConfigCache::GetStats().hits, 1u);
+}
+
+TEST_F(ConfigCacheTest, FailedParseIsNotCached) {
+    EXPECT_TRUE(Config::LoadFromFile(FixturePath("invalid.yaml")).IsError());
+    EXPECT_TRUE(Config::LoadFromFile(FixturePath("invalid.yaml")).IsError());
+    EXPECT_EQ(ConfigCache::GetStats().writes, 0u);
+    EXPECT_TRUE(CacheFiles().empty());
+}
+
+TEST_F(ConfigCacheTest, DeviceTableSharesCompiledDevices) {
+    auto config = Config::LoadFromFile(FixturePath("test_config.yaml"));
+    ASSERT_TRUE(config.IsOk());
+
+    auto table = Config::LoadDeviceTable(FixturePath("test_config.yaml"));
+    ASSERT_TRUE(table.IsOk());
+    EXPECT_EQ(ConfigCache::GetStats().hits, 1u);
+    ExpectSameDevices(config.Value().GetDevices(), table.Value().ToEntries());
+}
+
+TEST_F(ConfigCacheTest, KeyPathCachedSeparately) {
+    auto nested = Config::LoadFromFile(FixturePath("nested_config.yaml"),
+                                       "plas.devices");
+    ASSERT_TRUE(nested.IsOk());
+    EXPECT_TRUE(Config::LoadFromFile(FixturePath("nested_config.yaml"),
+                                     "libnvme").IsError());
+
+    auto again = Config::LoadFromFile(FixturePath("nested_config.yaml"),
+                                      "plas.devices");
+    ASSERT_TRUE(again.IsOk());
+    EXPECT_EQ(ConfigCache::GetStats().hits, 1u);
+    ExpectSameDevices(nested.Value().GetDevices(), again.Value().GetDevices());
+}
+
+TEST_F(ConfigCacheTest, PropertySessionsKeepTypes) {
+    auto& pm = PropertyManager::GetInstance();
+    ASSERT_TRUE(pm.LoadFromFile(FixturePath("types_test.yaml")).IsOk());
+    pm.Reset();
+    Properties::DestroyAll();
+
+    ASSERT_TRUE(pm.LoadFromFile(FixturePath("types_test.yaml")).IsOk());
+    EXPECT_EQ(ConfigCache::GetStats().hits, 1u);
+
+    auto& props = pm.Session("types");
+    EXPECT_EQ(props.Get<int64_t>("int_val").Value(), 42);
+    EXPECT_EQ(props.Get<int64_t>("neg_int").Value(), -10);
+    EXPECT_DOUBLE_EQ(props.Get<double>("float_val").Value(), 3.14);
+    EXPECT_TRUE(props.Get<bool>("bool_true").Value());
+    EXPECT_FALSE(props.Get<bool>("bool_false").Value());
+    EXPECT_EQ(props.Get<std::string>("str_val").Value(), "hello");
+    EXPECT_EQ(props.Get<std::string>("nested.deep").Value(), "value");
+    EXPECT_TRUE(props.Get<std::string>("array_val").IsOk());
+    EXPECT_FALSE(props.Has("null_val"));
+}
+
+TEST_F(ConfigCacheTest, SingleSessionCachedSeparately) {
+    auto& pm = PropertyManager::GetInstance();
+    ASSERT_TRUE(pm.LoadFromFile(FixturePath("multi_session.yaml")).IsOk());
+    ASSERT_TRUE(pm.LoadFromFile(FixturePath("multi_session.yaml"), "all").IsOk());
+    ASSERT_TRUE(pm.LoadFromFile(FixturePath("multi_session.yaml"), "again").IsOk());
+    EXPECT_EQ(ConfigCache::GetStats().hits, 1u);
+    EXPECT_EQ(CacheFiles().size(), 2u);
+
+    EXPECT_EQ(pm.Session("again").Get<std::string>("global.app_name").Value(),
+              "my_app");
+    EXPECT_EQ(pm.Session("again").Get<int64_t>("device_config.advanced.retry_count")
+                  .Value(),
+              3);
+}
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "plas/config/config_diff.h"
+#include "plas/config/device_entry.h"
+
+using plas::config::DeviceEntry;
+using plas::config::DiffDevices;
+
+namespace {
+
+DeviceEntry Entry(const std::string& nickname, const std::string& uri) {
+    return {nickname, uri, "aardvark", {}};
+}
+
+}  // namespace
+
+TEST(ConfigDiffTest, IdenticalListsAreEmpty) {
+    std::vector<DeviceEntry> devices = {Entry("a", "aardvark://0:0x50"),
+                                        Entry("b", "aardvark://0:0x51")};
+    auto diff = DiffDevices(devices, devices);
+    EXPECT_TRUE(diff.Empty());
+    EXPECT_EQ(diff.unchanged, 2u);
+}
+
+TEST(ConfigDiffTest, ClassifiesByNickname) {
+    std::vector<DeviceEntry> current = {Entry("a", "aardvark://0:0x50"),
+                                        Entry("b", "aardvark://0:0x51"),
+                                        Entry("c", "aardvark://0:0x52")};
+    std::vector<DeviceEntry> updated = {Entry("d", "aardvark://0:0x53"),
+                                        Entry("b", "aardvark://0:0x61"),
+                                        Entry("a", "aardvark://0:0x50")};
+    auto diff = DiffDevices(current, updated);
+    ASSERT_EQ(diff.added.size(), 1u);
+    EXPECT_EQ(diff.added[0].nickname, "d");
+    ASSERT_EQ(diff.changed.size(), 1u);
+    EXPECT_EQ(diff.changed[0].uri, "aardvark://0:0x61");
+    ASSERT_EQ(diff.removed.size(), 1u);
+    EXPECT_EQ(diff.removed[0], "c");
+    EXPECT_EQ(diff.unchanged, 1u);
+}
+
+TEST(ConfigDiffTest, DriverAndArgsCountAsChanges) {
+    std::vector<DeviceEntry> current = {Entry("a", "aardvark://0:0x50"),
+                                        Entry("b", "aardvark://0:0x51")};
+    auto updated = current;
+    updated[0].driver = "ft4222h";
+    updated[1].args["bitrate"] = "400";
+    auto diff = DiffDevices(current, updated);
+    EXPECT_EQ(diff.changed.size(), 2u);
+    EXPECT_EQ(diff.unchanged, 0u);
+    EXPECT_TRUE(diff.added.empty());
+    EXPECT_TRUE(diff.removed.empty());
+}
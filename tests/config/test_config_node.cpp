@@ -131,3 +131,73 @@ TEST_F(ConfigNodeTest, YamlTypePreservation) {
     ASSERT_TRUE(aardvark.IsOk());
     EXPECT_TRUE(aardvark.Value().IsArray());
 }
+
+// --- Native YAML tree ---
+
+TEST_F(ConfigNodeTest, YamlDumpMatchesJson) {
+    auto yaml = ConfigNode::LoadFromFile(FixturePath("nested_config.yaml"));
+    auto json = ConfigNode::LoadFromFile(FixturePath("nested_config.json"));
+    ASSERT_TRUE(yaml.IsOk());
+    ASSERT_TRUE(json.IsOk());
+    EXPECT_EQ(yaml.Value().Dump(), json.Value().Dump());
+
+    auto yaml_sub = yaml.Value().GetSubtree("plas.devices");
+    auto json_sub = json.Value().GetSubtree("plas.devices");
+    ASSERT_TRUE(yaml_sub.IsOk());
+    ASSERT_TRUE(json_sub.IsOk());
+    EXPECT_EQ(yaml_sub.Value().Dump(), json_sub.Value().Dump());
+}
+
+TEST_F(ConfigNodeTest, YamlSubtreeLeavesTreeUntouched) {
+    auto result = ConfigNode::LoadFromFile(FixturePath("nested_config.yaml"));
+    ASSERT_TRUE(result.IsOk());
+    const auto& root = result.Value();
+    std::string before = root.Dump();
+
+    EXPECT_TRUE(root.GetSubtree("plas.devices.aardvark").IsOk());
+    EXPECT_TRUE(root.GetSubtree("plas.missing.key").IsError());
+    EXPECT_TRUE(root.GetSubtree("plas.devices.aardvark.bitrate").IsError());
+    EXPECT_EQ(root.Dump(), before);
+}
+
+// --- Path index ---
+
+TEST_F(ConfigNodeTest, GetSubtreesResolvesEachPathInOrder) {
+    for (const char* fixture : {"nested_config.json", "nested_config.yaml"}) {
+        SCOPED_TRACE(fixture);
+        auto result = ConfigNode::LoadFromFile(FixturePath(fixture));
+        ASSERT_TRUE(result.IsOk());
+
+        auto subtrees = result.Value().GetSubtrees(
+            {"plas.devices.pmu3", "libnvme.buses", "plas.missing", "", ".plas..devices."});
+        ASSERT_EQ(subtrees.size(), 5u);
+        ASSERT_TRUE(subtrees[0].IsOk());
+        EXPECT_TRUE(subtrees[0].Value().IsArray());
+        ASSERT_TRUE(subtrees[1].IsOk());
+        EXPECT_TRUE(subtrees[1].Value().IsArray());
+        EXPECT_EQ(subtrees[2].Error(),
+                  plas::core::make_error_code(plas::core::ErrorCode::kNotFound));
+        ASSERT_TRUE(subtrees[3].IsOk());
+        EXPECT_EQ(subtrees[3].Value().Dump(), result.Value().Dump());
+        ASSERT_TRUE(subtrees[4].IsOk());
+        EXPECT_TRUE(subtrees[4].Value().IsMap());
+    }
+}
+
+TEST_F(ConfigNodeTest, SubtreeResolvesThroughRootIndexAndOutlivesRoot) {
+    for (const char* fixture : {"nested_config.json", "nested_config.yaml"}) {
+        SCOPED_TRACE(fixture);
+        ConfigNode devices;
+        {
+            auto root = ConfigNode::LoadFromFile(FixturePath(fixture));
+            ASSERT_TRUE(root.IsOk());
+            auto plas = root.Value().GetSubtree("plas");
+            ASSERT_TRUE(plas.IsOk());
+            devices = plas.Value().GetSubtree("devices").Value();
+            EXPECT_TRUE(plas.Value().GetSubtree("libnvme").IsError());
+        }
+        auto aardvark = devices.GetSubtree("aardvark");
+        ASSERT_TRUE(aardvark.IsOk());
+        EXPECT_NE(aardvark.Value().Dump().find("aardvark0"), std::string::npos);
+    }
+}
@@ -0,0 +1,261 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "plas/config/config.h"
+#include "plas/config/device_entry.h"
+#include "plas/core/error.h"
+
+using plas::config::Config;
+using plas::config::ConfigFormat;
+using plas::config::DeviceEntry;
+using plas::core::ErrorCode;
+using plas::core::Result;
+
+namespace {
+
+std::string FixturePath(const std::string& filename) {
+    return "fixtures/" + filename;
+}
+
+struct Collected {
+    Result<size_t> status = Result<size_t>::Ok(0);
+    std::vector<DeviceEntry> devices;
+};
+
+Collected Stream(const std::string& path, ConfigFormat fmt = ConfigFormat::kAuto) {
+    Collected out;
+    out.status = Config::StreamFromFile(
+        path,
+        [&out](DeviceEntry&& entry) {
+            out.devices.push_back(std::move(entry));
+            return Result<void>::Ok();
+        },
+        fmt);
+    return out;
+}
+
+// Grouped layouts stream in document order; the tree loader sorts groups.
+std::vector<DeviceEntry> SortedByNickname(std::vector<DeviceEntry> devices) {
+    std::sort(devices.begin(), devices.end(),
+              [](const DeviceEntry& a, const DeviceEntry& b) {
+                  return a.nickname < b.nickname;
+              });
+    return devices;
+}
+
+void ExpectSameDevices(std::vector<DeviceEntry> streamed,
+                       std::vector<DeviceEntry> loaded) {
+    streamed = SortedByNickname(std::move(streamed));
+    loaded = SortedByNickname(std::move(loaded));
+    ASSERT_EQ(streamed.size(), loaded.size());
+    for (size_t i = 0; i < loaded.size(); ++i) {
+        EXPECT_EQ(streamed[i].nickname, loaded[i].nickname);
+        EXPECT_EQ(streamed[i].uri, loaded[i].uri);
+        EXPECT_EQ(streamed[i].driver, loaded[i].driver);
+        EXPECT_EQ(streamed[i].args, loaded[i].args);
+    }
+}
+
+class TempFile {
+public:
+    TempFile(std::string name, const std::string& content)
+        : path_(std::move(name)) {
+        std::ofstream(path_) << content;
+    }
+    ~TempFile() { std::remove(path_.c_str()); }
+    const std::string& Path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+void ExpectErrorLike(const std::string& path) {
+    auto streamed = Stream(path);
+    auto loaded = Config::LoadFromFile(path);
+    ASSERT_TRUE(loaded.IsError()) << path;
+    ASSERT_TRUE(streamed.status.IsError()) << path;
+    EXPECT_EQ(streamed.status.Error(), loaded.Error()) << path;
+}
+
+}  // namespace
+
+// --- Parity with Config::LoadFromFile ---
+
+TEST(ConfigStreamTest, MatchesTreeLoaderOnFixtures) {
+    for (const char* name : {"test_config.json", "test_config.yaml"}) {
+        SCOPED_TRACE(name);
+        auto streamed = Stream(FixturePath(name));
+        ASSERT_TRUE(streamed.status.IsOk()) << streamed.status.Error().message();
+        auto loaded = Config::LoadFromFile(FixturePath(name));
+        ASSERT_TRUE(loaded.IsOk());
+        EXPECT_EQ(streamed.status.Value(), loaded.Value().GetDevices().size());
+        ExpectSameDevices(streamed.devices, loaded.Value().GetDevices());
+    }
+}
+
+TEST(ConfigStreamTest, GroupedStreamsInDocumentOrder) {
+    TempFile f("_stream_order.yaml",
+               "devices:\n"
+               "  pmu3:\n"
+               "    - uri: \"pmu3://usb:A\"\n"
+               "  aardvark:\n"
+               "    - uri: \"aardvark://0:0x50\"\n"
+               "    - uri: \"aardvark://1:0x50\"\n");
+    auto streamed = Stream(f.Path());
+    ASSERT_TRUE(streamed.status.IsOk());
+    ASSERT_EQ(streamed.devices.size(), 3u);
+    EXPECT_EQ(streamed.devices[0].nickname, "pmu3_0");
+    EXPECT_EQ(streamed.devices[1].nickname, "aardvark_0");
+    EXPECT_EQ(streamed.devices[2].nickname, "aardvark_1");
+
+    auto loaded = Config::LoadFromFile(f.Path());
+    ASSERT_TRUE(loaded.IsOk());
+    ExpectSameDevices(streamed.devices, loaded.Value().GetDevices());
+}
+
+TEST(ConfigStreamTest, ScalarArgsRenderedLikeTreeLoader) {
+    const std::string body =
+        "  - nickname: d0\n"
+        "    uri: \"x://0\"\n"
+        "    driver: drv\n"
+        "    args:\n"
+        "      rate: 400000\n"
+        "      scale: 1.5\n"
+        "      enabled: yes\n"
+        "      negative: -3\n"
+        "      hex: 0x10\n"
+        "      label: \"400000\"\n"
+        "      unset: ~\n";
+    TempFile yaml("_stream_scalars.yaml", "devices:\n" + body);
+    TempFile json("_stream_scalars.json",
+                  R"({"devices": [{"nickname": "d0", "uri": "x://0",
+                      "driver": "drv", "args": {"rate": 400000, "scale": 1.5,
+                      "enabled": true, "negative": -3, "unset": null,
+                      "label": "400000"}}]})");
+    for (const auto* file : {&yaml, &json}) {
+        SCOPED_TRACE(file->Path());
+        auto streamed = Stream(file->Path());
+        ASSERT_TRUE(streamed.status.IsOk());
+        auto loaded = Config::LoadFromFile(file->Path());
+        ASSERT_TRUE(loaded.IsOk());
+        ExpectSameDevices(streamed.devices, loaded.Value().GetDevices());
+        EXPECT_EQ(streamed.devices[0].args.count("unset"), 0u);
+    }
+}
+
+TEST(ConfigStreamTest, IgnoresOtherTopLevelKeys) {
+    TempFile f("_stream_other_keys.json",
+               R"({"meta": {"devices": [1, 2]}, "list": [[{}]],
+                   "devices": [{"nickname": "a", "uri": "x://0",
+                                "driver": "drv", "extra": {"deep": [1]}}],
+                   "tail": 1})");
+    auto streamed = Stream(f.Path());
+    ASSERT_TRUE(streamed.status.IsOk()) << streamed.status.Error().message();
+    ASSERT_EQ(streamed.devices.size(), 1u);
+    EXPECT_EQ(streamed.devices[0].nickname, "a");
+    EXPECT_TRUE(streamed.devices[0].args.empty());
+}
+
+// --- Errors ---
+
+TEST(ConfigStreamTest, ErrorsMatchTreeLoader) {
+    ExpectErrorLike("nonexistent.json");
+    ExpectErrorLike("nonexistent.yaml");
+    ExpectErrorLike(FixturePath("invalid.json"));
+    ExpectErrorLike(FixturePath("invalid.yaml"));
+    ExpectErrorLike(FixturePath("empty.json"));
+    ExpectErrorLike(FixturePath("scalar_top.yaml"));
+
+    TempFile missing_uri("_stream_missing_uri.json",
+                         R"({"devices": [{"nickname": "a", "driver": "d"}]})");
+    ExpectErrorLike(missing_uri.Path());
+    TempFile nested_arg("_stream_nested_arg.yaml",
+                        "devices:\n  drv:\n    - uri: x\n      opt: [1, 2]\n");
+    ExpectErrorLike(nested_arg.Path());
+    TempFile bad_group("_stream_bad_group.json",
+                       R"({"devices": {"drv": {"uri": "x"}}})");
+    ExpectErrorLike(bad_group.Path());
+}
+
+TEST(ConfigStreamTest, DevicesBeforeErrorAreDelivered) {
+    TempFile f("_stream_partial.json",
+               R"({"devices": [{"nickname": "a", "uri": "x://0", "driver": "d"},
+                               {"nickname": "b", "driver": "d"}]})");
+    auto streamed = Stream(f.Path());
+    ASSERT_TRUE(streamed.status.IsError());
+    ASSERT_EQ(streamed.devices.size(), 1u);
+    EXPECT_EQ(streamed.devices[0].nickname, "a");
+}
+
+TEST(ConfigStreamTest, SinkErrorStopsStream) {
+    for (const char* name : {"test_config.json", "test_config.yaml"}) {
+        SCOPED_TRACE(name);
+        int calls = 0;
+        auto result = Config::StreamFromFile(
+            FixturePath(name), [&calls](DeviceEntry&&) {
+                ++calls;
+                return Result<void>::Err(ErrorCode::kBusy);
+            });
+        ASSERT_TRUE(result.IsError());
+        EXPECT_EQ(result.Error(), plas::core::make_error_code(ErrorCode::kBusy));
+        EXPECT_EQ(calls, 1);
+    }
+}
+
+// --- YAML specifics ---
+
+TEST(ConfigStreamTest, YamlScalarAliasExpands) {
+    TempFile f("_stream_alias_scalar.yaml",
+               "rate: &rate 400000\n"
+               "devices:\n"
+               "  - nickname: b\n"
+               "    uri: \"aardvark://1:0x50\"\n"
+               "    driver: aardvark\n"
+               "    args: {bitrate: *rate}\n");
+    auto scalar = Stream(f.Path());
+    ASSERT_TRUE(scalar.status.IsOk()) << scalar.status.Error().message();
+    ASSERT_EQ(scalar.devices.size(), 1u);
+    EXPECT_EQ(scalar.devices[0].args.at("bitrate"), "400000");
+}
+
+TEST(ConfigStreamTest, YamlAliasedItemReplays) {
+    TempFile f("_stream_alias_item.yaml",
+               "template: &dev {nickname: t, uri: \"x://0\", driver: drv,"
+               " args: {k: v}}\n"
+               "devices:\n"
+               "  - *dev\n");
+    auto streamed = Stream(f.Path());
+    ASSERT_TRUE(streamed.status.IsOk()) << streamed.status.Error().message();
+    auto loaded = Config::LoadFromFile(f.Path());
+    ASSERT_TRUE(loaded.IsOk());
+    ExpectSameDevices(streamed.devices, loaded.Value().GetDevices());
+}
+
+TEST(ConfigStreamTest, LargeFlatConfig) {
+    std::string path = "_stream_large.json";
+    {
+        std::ofstream out(path);
+        out << "{\"devices\": [";
+        for (int i = 0; i < 20000; ++i) {
+            out << (i ? "," : "") << "{\"nickname\": \"dev" << i
+                << "\", \"uri\": \"aardvark://" << i
+                << "\", \"driver\": \"aardvark\", \"args\": {\"bitrate\": 400000}}";
+        }
+        out << "]}";
+    }
+    size_t seen = 0;
+    auto result = Config::StreamFromFile(path, [&seen](DeviceEntry&& entry) {
+        EXPECT_EQ(entry.nickname, "dev" + std::to_string(seen));
+        ++seen;
+        return Result<void>::Ok();
+    });
+    std::remove(path.c_str());
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), 20000u);
+    EXPECT_EQ(seen, 20000u);
+}
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <cstdio>
 #include <filesystem>
+#include <fstream>
 
 #include "plas/config/config.h"
 #include "plas/config/config_format.h"
@@ -133,3 +135,39 @@ TEST_F(ConfigYamlTest, GroupedJsonYamlConsistency) {
         EXPECT_EQ(jd[i].args, yd[i].args);
     }
 }
+
+TEST_F(ConfigYamlTest, GroupedDriversInNameOrder) {
+    const std::string path = "grouped_order_test.yaml";
+    std::ofstream(path) << "devices:\n"
+                           "  pmu3:\n"
+                           "    - uri: \"pmu3://usb:A\"\n"
+                           "  aardvark:\n"
+                           "    - uri: \"aardvark://0:0x50\"\n"
+                           "      bitrate: 400000\n"
+                           "      note: ~\n";
+    auto result = Config::LoadFromFile(path);
+    std::remove(path.c_str());
+    ASSERT_TRUE(result.IsOk()) << result.Error().message();
+
+    // Same order the JSON tree gives: groups sorted by driver name.
+    const auto& devices = result.Value().GetDevices();
+    ASSERT_EQ(devices.size(), 2u);
+    EXPECT_EQ(devices[0].nickname, "aardvark_0");
+    EXPECT_EQ(devices[0].args.at("bitrate"), "400000");
+    EXPECT_EQ(devices[0].args.count("note"), 0u);
+    EXPECT_EQ(devices[1].nickname, "pmu3_0");
+}
+
+TEST_F(ConfigYamlTest, NestedArgValueRejected) {
+    const std::string path = "nested_arg_test.yaml";
+    std::ofstream(path) << "devices:\n"
+                           "  - nickname: dev0\n"
+                           "    uri: \"aardvark://0:0x50\"\n"
+                           "    driver: aardvark\n"
+                           "    args:\n"
+                           "      bitrate: [1, 2]\n";
+    auto result = Config::LoadFromFile(path);
+    std::remove(path.c_str());
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), plas::core::ErrorCode::kInvalidArgument);
+}
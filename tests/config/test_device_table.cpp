@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "plas/config/config.h"
+#include "plas/config/config_node.h"
+#include "plas/config/device_table.h"
+#include "plas/core/error.h"
+
+using plas::config::Config;
+using plas::config::ConfigNode;
+using plas::config::DeviceEntry;
+using plas::config::DeviceTable;
+
+namespace {
+
+std::string FixturePath(const std::string& filename) {
+    return "fixtures/" + filename;
+}
+
+void ExpectSameEntries(const DeviceTable& table,
+                       const std::vector<DeviceEntry>& entries) {
+    ASSERT_EQ(table.Size(), entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        DeviceEntry copy = table[i].ToEntry();
+        EXPECT_EQ(copy.nickname, entries[i].nickname);
+        EXPECT_EQ(copy.uri, entries[i].uri);
+        EXPECT_EQ(copy.driver, entries[i].driver);
+        EXPECT_EQ(copy.args, entries[i].args);
+    }
+}
+
+}  // namespace
+
+// --- Loading ---
+
+TEST(DeviceTableTest, MatchesLoadFromFileJson) {
+    auto table = Config::LoadDeviceTable(FixturePath("test_config.json"));
+    ASSERT_TRUE(table.IsOk()) << table.Error().message();
+    auto config = Config::LoadFromFile(FixturePath("test_config.json"));
+    ASSERT_TRUE(config.IsOk());
+    ExpectSameEntries(table.Value(), config.Value().GetDevices());
+
+    const auto& first = table.Value()[0];
+    EXPECT_EQ(first.Nickname(), "aardvark0");
+    EXPECT_EQ(first.Driver(), "aardvark");
+    EXPECT_EQ(first.FindArg("bitrate"), std::string_view("400000"));
+}
+
+TEST(DeviceTableTest, MatchesLoadFromFileYaml) {
+    auto table = Config::LoadDeviceTable(FixturePath("test_config.yaml"));
+    ASSERT_TRUE(table.IsOk()) << table.Error().message();
+    auto config = Config::LoadFromFile(FixturePath("test_config.yaml"));
+    ASSERT_TRUE(config.IsOk());
+    ExpectSameEntries(table.Value(), config.Value().GetDevices());
+}
+
+TEST(DeviceTableTest, GroupedLayoutFromNode) {
+    auto node = ConfigNode::LoadFromFile(FixturePath("grouped_config.json"));
+    ASSERT_TRUE(node.IsOk());
+    auto table = Config::LoadDeviceTable(node.Value());
+    ASSERT_TRUE(table.IsOk()) << table.Error().message();
+    auto config = Config::LoadFromNode(node.Value());
+    ASSERT_TRUE(config.IsOk());
+    ExpectSameEntries(table.Value(), config.Value().GetDevices());
+
+    // Default nickname and a numeric arg rendered as text.
+    auto second = table.Value().Find("aardvark_1");
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second->Uri(), "aardvark://1:0x51");
+    EXPECT_EQ(table.Value().Find("aardvark0")->FindArg("bitrate"),
+              std::string_view("400000"));
+}
+
+TEST(DeviceTableTest, ErrorsMatchLoadFromFile) {
+    auto missing = Config::LoadDeviceTable("nonexistent.json");
+    ASSERT_TRUE(missing.IsError());
+    EXPECT_EQ(missing.Error(),
+              plas::core::make_error_code(plas::core::ErrorCode::kNotFound));
+
+    auto invalid = Config::LoadDeviceTable(FixturePath("invalid.json"));
+    EXPECT_TRUE(invalid.IsError());
+
+    auto no_devices = Config::LoadDeviceTable(FixturePath("empty.json"));
+    EXPECT_EQ(no_devices.IsError(),
+              Config::LoadFromFile(FixturePath("empty.json")).IsError());
+}
+
+// --- Lookup ---
+
+TEST(DeviceTableTest, FindMissingNickname) {
+    auto table = Config::LoadDeviceTable(FixturePath("test_config.json"));
+    ASSERT_TRUE(table.IsOk());
+    EXPECT_FALSE(table.Value().Find("nonexistent").has_value());
+    EXPECT_FALSE(table.Value()[0].FindArg("nonexistent").has_value());
+}
+
+// --- Builder / arena ---
+
+TEST(DeviceTableTest, ArgsSortedAndLastValueWins) {
+    DeviceTable table;
+    table.BeginEntry("dev0", "x://0", "drv");
+    table.AddArg("zeta", "1");
+    table.AddArg("alpha", "2");
+    table.AddArg("zeta", "3");
+    table.BeginEntry("dev1", "x://1", "drv");
+    table.Finish();
+
+    ASSERT_EQ(table.Size(), 2u);
+    const auto& dev0 = table[0];
+    ASSERT_EQ(dev0.ArgCount(), 2u);
+    EXPECT_EQ(dev0.ArgsBegin()[0].key, "alpha");
+    EXPECT_EQ(dev0.ArgsBegin()[1].key, "zeta");
+    EXPECT_EQ(dev0.FindArg("zeta"), std::string_view("3"));
+    EXPECT_EQ(table[1].ArgCount(), 0u);
+}
+
+TEST(DeviceTableTest, InternsDriversKeysAndValues) {
+    DeviceTable table;
+    for (int i = 0; i < 100; ++i) {
+        std::string name = "dev" + std::to_string(i);
+        table.BeginEntry(name, "aardvark://" + std::to_string(i), "aardvark");
+        table.AddArg("bitrate", "400000");
+    }
+    table.Finish();
+
+    EXPECT_EQ(table.InternedCount(), 3u);
+    EXPECT_EQ(table[0].Driver().data(), table[99].Driver().data());
+    EXPECT_EQ(table[0].ArgsBegin()->value.data(),
+              table[99].ArgsBegin()->value.data());
+    EXPECT_EQ(table[42].Nickname(), "dev42");
+}
+
+TEST(DeviceTableTest, LargeConfigUsesFewBlocks) {
+    const char* path = "device_table_large.json";
+    {
+        std::ofstream out(path);
+        out << "{\"devices\": [";
+        for (int i = 0; i < 5000; ++i) {
+            out << (i ? "," : "") << "{\"nickname\": \"dev" << i
+                << "\", \"uri\": \"aardvark://" << i
+                << ":0x50\", \"driver\": \"aardvark\", \"args\": "
+                   "{\"bitrate\": 400000, \"pullups\": true}}";
+        }
+        out << "]}";
+    }
+    auto table = Config::LoadDeviceTable(path);
+    std::remove(path);
+    ASSERT_TRUE(table.IsOk()) << table.Error().message();
+    ASSERT_EQ(table.Value().Size(), 5000u);
+
+    // ~5000 * (nickname + uri) bytes: a handful of 16 KiB blocks, not one
+    // allocation per string.
+    EXPECT_LT(table.Value().ArenaBytes(), 256u * 1024u);
+    EXPECT_EQ(table.Value().Find("dev4999")->FindArg("pullups"),
+              std::string_view("true"));
+}
+
+TEST(DeviceTableTest, OversizedStringKeepsBlockTail) {
+    DeviceTable table;
+    table.BeginEntry("a", "x://0", "drv");
+    table.AddArg("blob", std::string(64 * 1024, 'b'));
+    table.BeginEntry("b", "x://1", "drv");
+    table.Finish();
+    EXPECT_EQ(table[0].FindArg("blob")->size(), 64u * 1024u);
+    EXPECT_EQ(table[1].Uri(), "x://1");
+}
+
+TEST(DeviceTableTest, ViewsSurviveMove) {
+    auto loaded = Config::LoadDeviceTable(FixturePath("test_config.json"));
+    ASSERT_TRUE(loaded.IsOk());
+    auto nickname = loaded.Value()[1].Nickname();
+    DeviceTable moved = std::move(loaded).Value();
+    EXPECT_EQ(moved[1].Nickname().data(), nickname.data());
+    EXPECT_EQ(moved.Find("pmu3_main")->FindArg("channel"),
+              std::string_view("0"));
+}
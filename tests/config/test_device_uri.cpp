@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+
+#include "plas/config/device_uri.h"
+
+using plas::config::DeviceUri;
+
+TEST(DeviceUriTest, SplitsSchemeAndFields) {
+    std::string text = "pciutils://0000:03:00.0";
+    auto uri = DeviceUri::Parse(text);
+    ASSERT_TRUE(uri.IsValid());
+    EXPECT_EQ(uri.Scheme(), "pciutils");
+    EXPECT_EQ(uri.Authority(), "0000:03:00.0");
+    ASSERT_EQ(uri.FieldCount(), 3u);
+    EXPECT_EQ(uri.Field(0), "0000");
+    EXPECT_EQ(uri.Field(1), "03");
+    EXPECT_EQ(uri.Field(2), "00.0");
+    EXPECT_EQ(uri.Field(3), "");
+
+    // Views into the source, not copies.
+    EXPECT_EQ(uri.Scheme().data(), text.data());
+}
+
+TEST(DeviceUriTest, SingleFieldAuthority) {
+    auto uri = DeviceUri::Parse("mock://only");
+    ASSERT_TRUE(uri.IsValid());
+    EXPECT_EQ(uri.FieldCount(), 1u);
+}
+
+TEST(DeviceUriTest, RejectsMalformed) {
+    for (const char* text : {"", "0:0x50", "://0:0x50", "aardvark://",
+                             "aardvark://:0x50", "aardvark://0:", "a://0::1",
+                             "a://1:2:3:4:5"}) {
+        auto uri = DeviceUri::Parse(text);
+        EXPECT_FALSE(uri.IsValid()) << text;
+        EXPECT_EQ(uri.FieldCount(), 0u) << text;
+    }
+}
+
+TEST(DeviceUriTest, NumbersHonourBaseAndMax) {
+    auto uri = DeviceUri::Parse("aardvark://12:0x50");
+    uint16_t port = 0;
+    uint64_t addr = 0;
+    EXPECT_TRUE(uri.Number(0, 10, port));
+    EXPECT_EQ(port, 12);
+    EXPECT_TRUE(uri.Number(1, 0, 0x7F, addr));
+    EXPECT_EQ(addr, 0x50u);
+    EXPECT_FALSE(uri.Number(1, 10, 0xFF, addr));  // "0x" is not decimal
+    EXPECT_FALSE(uri.Number(1, 0, 0x4F, addr));   // above max
+    EXPECT_FALSE(uri.Number(2, 10, 0xFF, addr));  // no such field
+
+    uint64_t value = 0;
+    EXPECT_TRUE(DeviceUri::ParseNumber("017", 0, 0xFF, value));
+    EXPECT_EQ(value, 15u);  // octal
+    EXPECT_TRUE(DeviceUri::ParseNumber("1f", 16, 0x1F, value));
+    EXPECT_EQ(value, 0x1Fu);
+    EXPECT_FALSE(DeviceUri::ParseNumber("20", 16, 0x1F, value));
+    EXPECT_FALSE(DeviceUri::ParseNumber("", 10, 10, value));
+    EXPECT_FALSE(DeviceUri::ParseNumber("1 ", 10, 10, value));
+    EXPECT_TRUE(DeviceUri::ParseNumber("18446744073709551615", 10, UINT64_MAX, value));
+    EXPECT_FALSE(DeviceUri::ParseNumber("18446744073709551616", 10, UINT64_MAX, value));
+
+    uint8_t narrow = 0;
+    EXPECT_FALSE(DeviceUri::Parse("x://256:1").Number(0, 10, narrow));
+}
@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <filesystem>
+#include <fstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "plas/config/property_manager.h"
 #include "plas/core/error.h"
@@ -365,3 +369,88 @@ TEST_F(PropertyManagerTest, AutoFormatDetection) {
     EXPECT_TRUE(mgr.HasSession("s1"));
     EXPECT_TRUE(mgr.HasSession("s2"));
 }
+
+// --- Parallel loading ---
+
+namespace {
+
+/// Multi-session YAML files "<dir>/props_<i>.yaml", each setting
+/// shared.last = i and s<i>.value = i.
+std::vector<std::string> WritePropertyFiles(const std::filesystem::path& dir, int count) {
+    std::filesystem::create_directories(dir);
+    std::vector<std::string> paths;
+    for (int i = 0; i < count; ++i) {
+        auto path = dir / ("props_" + std::to_string(i) + ".yaml");
+        std::ofstream(path) << "shared:\n  last: " << i << "\ns" << i
+                            << ":\n  value: " << i << "\n";
+        paths.push_back(path.string());
+    }
+    return paths;
+}
+
+}  // namespace
+
+TEST_F(PropertyManagerTest, LoadFromFilesPublishesInPathOrder) {
+    auto dir = std::filesystem::temp_directory_path() / "plas_pm_files";
+    auto paths = WritePropertyFiles(dir, 16);
+    paths.insert(paths.begin() + 5, (dir / "missing.yaml").string());
+
+    auto& mgr = PropertyManager::GetInstance();
+    auto results = mgr.LoadFromFiles(paths);
+    ASSERT_EQ(results.size(), paths.size());
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        EXPECT_EQ(results[i].IsOk(), i != 5) << paths[i];
+    }
+
+    // The last file wins, as if loaded one by one.
+    EXPECT_EQ(Properties::GetSession("shared").Get<int64_t>("last").Value(), 15);
+    for (int i = 0; i < 16; ++i) {
+        auto name = "s" + std::to_string(i);
+        ASSERT_TRUE(mgr.HasSession(name)) << name;
+        EXPECT_EQ(Properties::GetSession(name).Get<int64_t>("value").Value(), i);
+    }
+    EXPECT_EQ(mgr.SessionNames().size(), 17u);
+    EXPECT_TRUE(mgr.LoadFromFiles({}).empty());
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(PropertyManagerTest, ConcurrentLoadFromFile) {
+    auto dir = std::filesystem::temp_directory_path() / "plas_pm_threads";
+    auto paths = WritePropertyFiles(dir, 8);
+
+    auto& mgr = PropertyManager::GetInstance();
+    std::vector<std::thread> threads;
+    for (const auto& path : paths) {
+        threads.emplace_back([&mgr, path] { EXPECT_TRUE(mgr.LoadFromFile(path).IsOk()); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_TRUE(mgr.HasSession("s" + std::to_string(i)));
+    }
+    EXPECT_TRUE(mgr.HasSession("shared"));
+    EXPECT_EQ(mgr.SessionNames().size(), 9u);
+
+    std::filesystem::remove_all(dir);
+}
+
+// --- Isolated instances ---
+
+TEST_F(PropertyManagerTest, InstancesKeepSeparateSessions) {
+    PropertyManager a;
+    PropertyManager b;
+    ASSERT_TRUE(a.LoadFromFile(FixturePath("multi_session.yaml")).IsOk());
+    ASSERT_TRUE(b.LoadFromFile(FixturePath("multi_session.yaml")).IsOk());
+
+    a.Session("global").Set("app_name", std::string("tenant_a"));
+    EXPECT_EQ(a.Session("global").Get<std::string>("app_name").Value(), "tenant_a");
+    EXPECT_EQ(b.Session("global").Get<std::string>("app_name").Value(), "my_app");
+    EXPECT_FALSE(Properties::HasSession("global"));
+    EXPECT_FALSE(PropertyManager::GetInstance().HasSession("global"));
+
+    a.Reset();
+    EXPECT_FALSE(a.HasSession("global"));
+    EXPECT_TRUE(b.HasSession("global"));
+}
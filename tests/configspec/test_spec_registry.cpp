@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <filesystem>
 #include <fstream>
+#include <string>
 
 #include "plas/configspec/spec_registry.h"
 
@@ -34,6 +36,20 @@ TEST_F(SpecRegistryTest, RegisterBuiltinSpecs) {
     EXPECT_GE(drivers.size(), 5u);
 }
 
+TEST_F(SpecRegistryTest, InstancesAreIndependent) {
+    SpecRegistry own;
+    EXPECT_FALSE(own.HasConfigSpec());
+    own.RegisterBuiltinSpecs();
+    EXPECT_TRUE(own.HasDriverSpec("aardvark"));
+    EXPECT_FALSE(SpecRegistry::GetInstance().HasDriverSpec("aardvark"));
+
+    ASSERT_TRUE(own.RegisterDriverSpec("tenant_driver", R"({"type":"object"})",
+                                       ConfigFormat::kJson)
+                    .IsOk());
+    EXPECT_TRUE(own.HasDriverSpec("tenant_driver"));
+    EXPECT_FALSE(SpecRegistry::GetInstance().HasDriverSpec("tenant_driver"));
+}
+
 TEST_F(SpecRegistryTest, RegisterBuiltinSpecsIdempotent) {
     auto& reg = SpecRegistry::GetInstance();
     reg.RegisterBuiltinSpecs();
@@ -133,6 +149,51 @@ TEST_F(SpecRegistryTest, LoadSpecsFromDirectory) {
     EXPECT_GE(result.Value(), 1u);
 }
 
+TEST_F(SpecRegistryTest, BuiltinSpecsMatchTheirSources) {
+    // The builtins are converted at build time; they must read back as the
+    // same schemas a runtime load of the source files produces.
+    auto& reg = SpecRegistry::GetInstance();
+    reg.RegisterBuiltinSpecs();
+    for (const auto& name : reg.RegisteredDrivers()) {
+        auto builtin = reg.ExportDriverSpec(name);
+        ASSERT_TRUE(builtin.IsOk()) << name;
+        auto loaded = reg.RegisterDriverSpecFromFile(
+            "source_" + name, "fixtures/schemas/" + name + ".schema.yaml");
+        ASSERT_TRUE(loaded.IsOk()) << name;
+        EXPECT_EQ(reg.ExportDriverSpec("source_" + name).Value(), builtin.Value())
+            << name;
+    }
+}
+
+TEST_F(SpecRegistryTest, LoadSpecsFromDirectoryPicksUpChangedFiles) {
+    namespace fs = std::filesystem;
+    auto dir = fs::temp_directory_path() / "plas_spec_reload";
+    fs::create_directories(dir);
+    auto write = [&](const char* property) {
+        std::ofstream(dir / "reload.schema.json")
+            << R"({"type":"object","properties":{")" << property
+            << R"(":{"type":"integer"}}})";
+    };
+    auto& reg = SpecRegistry::GetInstance();
+    auto exported = [&] { return reg.ExportDriverSpec("reload").Value(); };
+
+    write("first");
+    ASSERT_EQ(reg.LoadSpecsFromDirectory(dir.string()).Value(), 1u);
+    EXPECT_NE(exported().find("first"), std::string::npos);
+
+    write("second");
+    ASSERT_EQ(reg.LoadSpecsFromDirectory(dir.string()).Value(), 1u);
+    EXPECT_NE(exported().find("second"), std::string::npos);
+
+    // Back to content seen before (served from the cache), and after Reset.
+    write("first");
+    reg.Reset();
+    ASSERT_EQ(reg.LoadSpecsFromDirectory(dir.string()).Value(), 1u);
+    EXPECT_NE(exported().find("first"), std::string::npos);
+
+    fs::remove_all(dir);
+}
+
 TEST_F(SpecRegistryTest, LoadSpecsFromDirectoryNotFound) {
     auto& reg = SpecRegistry::GetInstance();
     auto result = reg.LoadSpecsFromDirectory("/nonexistent/path");
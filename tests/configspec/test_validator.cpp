@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <string>
+#include <vector>
+
 #include "plas/config/device_entry.h"
 #include "plas/configspec/spec_registry.h"
 #include "plas/configspec/validator.h"
@@ -69,6 +72,17 @@ TEST_F(ValidatorTest, InvalidAardvarkUnknownArg) {
     EXPECT_GE(result.Value().Errors().size(), 1u);
 }
 
+TEST_F(ValidatorTest, ManagerArgsAreNotCheckedAgainstDriverSpec) {
+    Validator v(ValidationMode::kStrict);
+    DeviceEntry entry{
+        "dev0", "aardvark://0:0x50", "aardvark",
+        {{"bitrate", "100000"}, {"group", "rack3,psu"}, {"coalesce_reads_us", "500"}}};
+
+    auto result = v.ValidateDeviceEntry(entry);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_TRUE(result.Value().valid) << result.Value().Summary();
+}
+
 TEST_F(ValidatorTest, InvalidAardvarkTypeMismatch) {
     Validator v(ValidationMode::kStrict);
     DeviceEntry entry{
@@ -229,3 +243,85 @@ TEST_F(ValidatorTest, InvalidBusTimeoutRange) {
     ASSERT_TRUE(result.IsOk());
     EXPECT_FALSE(result.Value().valid);
 }
+
+// --- Batch validation ---
+
+TEST_F(ValidatorTest, ValidateDeviceEntriesMatchesSingle) {
+    Validator v(ValidationMode::kStrict);
+    std::vector<DeviceEntry> entries;
+    for (int i = 0; i < 300; ++i) {
+        std::string name = "dev" + std::to_string(i);
+        switch (i % 3) {
+            case 0:
+                entries.push_back({name, "aardvark://0:0x50", "aardvark",
+                                   {{"bitrate", "100000"}}});
+                break;
+            case 1:
+                entries.push_back({name, "aardvark://0:0x50", "aardvark",
+                                   {{"nonexistent_arg", "42"}}});
+                break;
+            default:
+                entries.push_back({name, "unknown://0", "unknown_driver", {}});
+                break;
+        }
+    }
+
+    auto batch = v.ValidateDeviceEntries(entries, 4);
+    ASSERT_TRUE(batch.IsOk());
+    ASSERT_EQ(batch.Value().size(), entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        auto single = v.ValidateDeviceEntry(entries[i]);
+        ASSERT_TRUE(single.IsOk());
+        EXPECT_EQ(batch.Value()[i].valid, single.Value().valid) << i;
+        EXPECT_EQ(batch.Value()[i].issues.size(), single.Value().issues.size()) << i;
+    }
+    EXPECT_TRUE(batch.Value()[0].valid);
+    EXPECT_FALSE(batch.Value()[1].valid);
+    EXPECT_TRUE(batch.Value()[2].valid);
+}
+
+TEST_F(ValidatorTest, ValidateDeviceEntriesLenientAndEmpty) {
+    std::vector<DeviceEntry> entries{
+        {"dev0", "aardvark://0:0x50", "aardvark", {{"nonexistent_arg", "42"}}}};
+
+    auto lenient = Validator(ValidationMode::kLenient).ValidateDeviceEntries(entries);
+    ASSERT_TRUE(lenient.IsOk());
+    ASSERT_EQ(lenient.Value().size(), 1u);
+    EXPECT_TRUE(lenient.Value()[0].valid);
+
+    auto empty = Validator(ValidationMode::kStrict).ValidateDeviceEntries({});
+    ASSERT_TRUE(empty.IsOk());
+    EXPECT_TRUE(empty.Value().empty());
+}
+
+TEST_F(ValidatorTest, ResetDropsCompiledSpecs) {
+    Validator v(ValidationMode::kStrict);
+    DeviceEntry entry{"dev0", "aardvark://0:0x50", "aardvark",
+                      {{"nonexistent_arg", "42"}}};
+    ASSERT_FALSE(v.ValidateDeviceEntry(entry).Value().valid);
+
+    // With the spec gone the driver passes through again.
+    SpecRegistry::GetInstance().Reset();
+    EXPECT_TRUE(v.ValidateDeviceEntry(entry).Value().valid);
+}
+
+// --- Own registry ---
+
+TEST_F(ValidatorTest, ValidatesAgainstGivenRegistry) {
+    SpecRegistry own;
+    own.RegisterBuiltinSpecs();
+    ASSERT_TRUE(own.RegisterDriverSpec(
+                       "aardvark", R"({"type":"object","additionalProperties":false})",
+                       ConfigFormat::kJson)
+                    .IsOk());
+    Validator strict_own(own);
+    Validator strict_shared;
+
+    DeviceEntry entry{"dev", "aardvark://0:0x50", "aardvark", {{"bitrate", "100000"}}};
+    auto own_result = strict_own.ValidateDeviceEntry(entry);
+    auto shared_result = strict_shared.ValidateDeviceEntry(entry);
+    ASSERT_TRUE(own_result.IsOk());
+    ASSERT_TRUE(shared_result.IsOk());
+    EXPECT_FALSE(own_result.Value().valid);
+    EXPECT_TRUE(shared_result.Value().valid);
+}
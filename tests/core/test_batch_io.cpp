@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "plas/core/batch_io.h"
+#include "plas/core/error.h"
+
+namespace plas::core {
+namespace {
+
+namespace fs = std::filesystem;
+
+// Every test runs on the io_uring path (where the kernel allows it) and on
+// the open/pread/close fallback; both must give the same results.
+class BatchReaderTest : public ::testing::TestWithParam<bool> {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() /
+               ("plas_batch_io_" + std::to_string(::getpid()));
+        fs::remove_all(dir_);
+        fs::create_directories(dir_);
+    }
+
+    void TearDown() override { fs::remove_all(dir_); }
+
+    std::string Write(const std::string& name, const std::string& content) {
+        auto path = (dir_ / name).string();
+        std::ofstream(path) << content;
+        return path;
+    }
+
+    BatchReaderOptions Options(unsigned depth = 64) const {
+        BatchReaderOptions options;
+        options.depth = depth;
+        options.io_uring = GetParam();
+        return options;
+    }
+
+    fs::path dir_;
+};
+
+TEST_P(BatchReaderTest, ReadsPathsInOneBatch) {
+    BatchReader reader(Options());
+    if (!GetParam()) {
+        EXPECT_FALSE(reader.UsesIoUring());
+    }
+
+    std::vector<std::string> contents = {"8086\n", "0x060400\n", "-1\n"};
+    std::vector<BatchRead> reads(contents.size());
+    std::vector<std::vector<char>> buffers(contents.size(),
+                                           std::vector<char>(64));
+    for (std::size_t i = 0; i < contents.size(); ++i) {
+        reads[i].path = Write("attr" + std::to_string(i), contents[i]);
+        reads[i].buffer = buffers[i].data();
+        reads[i].length = buffers[i].size();
+    }
+
+    EXPECT_EQ(reader.Read(reads), contents.size());
+    for (std::size_t i = 0; i < contents.size(); ++i) {
+        ASSERT_FALSE(reads[i].error) << i;
+        EXPECT_EQ(std::string(buffers[i].data(), reads[i].transferred),
+                  contents[i]);
+    }
+}
+
+TEST_P(BatchReaderTest, ErrorsStayWithTheirRead) {
+    BatchReader reader(Options());
+    char ok[16] = {};
+    char missing[16] = {};
+    std::vector<BatchRead> reads(3);
+    reads[0].path = Write("present", "abc");
+    reads[0].buffer = ok;
+    reads[0].length = sizeof(ok);
+    reads[1].path = (dir_ / "absent").string();
+    reads[1].buffer = missing;
+    reads[1].length = sizeof(missing);
+    reads[2].path = reads[0].path;
+    reads[2].buffer = nullptr;  // rejected without touching the file
+    reads[2].length = 4;
+
+    EXPECT_EQ(reader.Read(reads), 1u);
+    EXPECT_FALSE(reads[0].error);
+    EXPECT_EQ(reads[0].transferred, 3u);
+    EXPECT_EQ(reads[1].error, make_error_code(ErrorCode::kNotFound));
+    EXPECT_EQ(reads[1].transferred, 0u);
+    EXPECT_EQ(reads[2].error, make_error_code(ErrorCode::kInvalidArgument));
+}
+
+TEST_P(BatchReaderTest, ReadsOpenFdsAtOffsets) {
+    auto path = Write("config", std::string("0123456789abcdef"));
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    ASSERT_GE(fd, 0);
+
+    BatchReader reader(Options());
+    char a[4] = {}, b[8] = {};
+    std::vector<BatchRead> reads(2);
+    reads[0].fd = fd;
+    reads[0].offset = 4;
+    reads[0].buffer = a;
+    reads[0].length = sizeof(a);
+    reads[1].fd = fd;
+    reads[1].offset = 12;  // short read: 4 bytes left
+    reads[1].buffer = b;
+    reads[1].length = sizeof(b);
+
+    EXPECT_EQ(reader.Read(reads), 2u);
+    EXPECT_EQ(std::string(a, reads[0].transferred), "4567");
+    EXPECT_EQ(std::string(b, reads[1].transferred), "cdef");
+
+    // The caller's fd stays open.
+    EXPECT_EQ(::fcntl(fd, F_GETFD), FD_CLOEXEC);
+    ::close(fd);
+}
+
+TEST_P(BatchReaderTest, MoreReadsThanDepthRunInChunks) {
+    BatchReader reader(Options(4));
+    constexpr std::size_t kFiles = 37;
+    std::vector<BatchRead> reads(kFiles);
+    std::vector<std::string> buffers(kFiles, std::string(8, '\0'));
+    for (std::size_t i = 0; i < kFiles; ++i) {
+        reads[i].path = Write("f" + std::to_string(i), std::to_string(i));
+        reads[i].buffer = buffers[i].data();
+        reads[i].length = buffers[i].size();
+    }
+
+    EXPECT_EQ(reader.Read(reads), kFiles);
+    for (std::size_t i = 0; i < kFiles; ++i) {
+        EXPECT_EQ(buffers[i].substr(0, reads[i].transferred),
+                  std::to_string(i));
+    }
+    // Reused: results are reset on every call.
+    reads.resize(1);
+    reads[0].path = (dir_ / "gone").string();
+    EXPECT_EQ(reader.Read(reads), 0u);
+    EXPECT_EQ(reads[0].transferred, 0u);
+}
+
+INSTANTIATE_TEST_SUITE_P(IoUringAndFallback, BatchReaderTest,
+                         ::testing::Bool());
+
+TEST(BatchReaderThreadTest, ForThisThreadIsPerThread) {
+    EXPECT_EQ(&BatchReader::ForThisThread(), &BatchReader::ForThisThread());
+    std::vector<BatchRead> none;
+    EXPECT_EQ(BatchReader::ForThisThread().Read(none), 0u);
+}
+
+}  // namespace
+}  // namespace plas::core
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "plas/core/buffer_pool.h"
+
+namespace plas::core {
+namespace {
+
+class BufferPoolTest : public ::testing::Test {
+protected:
+    void SetUp() override { BufferPool::TrimThreadCache(); }
+    void TearDown() override { BufferPool::TrimThreadCache(); }
+};
+
+TEST_F(BufferPoolTest, DefaultIsEmpty) {
+    PooledBytes buf;
+    EXPECT_TRUE(buf.Empty());
+    EXPECT_EQ(buf.Data(), nullptr);
+    EXPECT_EQ(buf.Capacity(), 0u);
+}
+
+TEST_F(BufferPoolTest, CapacityRoundsUpToSizeClass) {
+    PooledBytes small(1);
+    EXPECT_EQ(small.Size(), 1u);
+    EXPECT_EQ(small.Capacity(), BufferPool::kMinBlock);
+
+    PooledBytes mid(1000);
+    EXPECT_EQ(mid.Capacity(), 1024u);
+
+    PooledBuffer<uint32_t> dwords(100);
+    EXPECT_EQ(dwords.Capacity(), 128u);  // 512-byte class
+}
+
+TEST_F(BufferPoolTest, ReleasedBlockIsReused) {
+    const void* first;
+    {
+        PooledBytes buf(300);
+        first = buf.Data();
+    }
+    auto before = BufferPool::ThreadStats();
+    EXPECT_EQ(before.cached_bytes, 512u);
+
+    PooledBytes again(400);  // same 512-byte class
+    EXPECT_EQ(again.Data(), first);
+    auto after = BufferPool::ThreadStats();
+    EXPECT_EQ(after.reuses, before.reuses + 1);
+    EXPECT_EQ(after.allocations, before.allocations);
+    EXPECT_EQ(after.cached_bytes, 0u);
+}
+
+TEST_F(BufferPoolTest, SteadyStateDoesNotAllocate) {
+    { PooledBytes warm(4096); }
+    auto before = BufferPool::ThreadStats();
+    for (int i = 0; i < 1000; ++i) {
+        PooledBytes buf(4096);
+        buf[0] = static_cast<uint8_t>(i);
+    }
+    auto after = BufferPool::ThreadStats();
+    EXPECT_EQ(after.allocations, before.allocations);
+    EXPECT_EQ(after.reuses, before.reuses + 1000);
+}
+
+TEST_F(BufferPoolTest, CachePerClassIsBounded) {
+    {
+        std::vector<PooledBytes> held;
+        for (std::size_t i = 0; i < BufferPool::kMaxCachedPerClass + 4; ++i) {
+            held.emplace_back(64);
+        }
+    }
+    EXPECT_EQ(BufferPool::ThreadStats().cached_bytes,
+              BufferPool::kMaxCachedPerClass * 64);
+}
+
+TEST_F(BufferPoolTest, OversizedBlocksAreNotCached) {
+    {
+        PooledBytes big(BufferPool::kMaxPooledBlock + 1);
+        EXPECT_EQ(big.Capacity(), BufferPool::kMaxPooledBlock + 1);
+    }
+    EXPECT_EQ(BufferPool::ThreadStats().cached_bytes, 0u);
+}
+
+TEST_F(BufferPoolTest, ResizeKeepsContents) {
+    const uint8_t data[] = {1, 2, 3, 4, 5};
+    PooledBytes buf(data, sizeof(data));
+    EXPECT_TRUE(buf == (std::vector<uint8_t>{1, 2, 3, 4, 5}));
+
+    buf.Resize(200);  // moves to the 256-byte class
+    EXPECT_EQ(buf.Capacity(), 256u);
+    EXPECT_EQ(buf[4], 5);
+    buf.Resize(2);
+    EXPECT_EQ(buf.ToVector(), (std::vector<uint8_t>{1, 2}));
+}
+
+TEST_F(BufferPoolTest, MoveTransfersOwnership) {
+    PooledBytes a(10);
+    a[0] = 0x5A;
+    const void* block = a.Data();
+
+    PooledBytes b(std::move(a));
+    EXPECT_EQ(a.Data(), nullptr);
+    EXPECT_EQ(b.Data(), block);
+
+    PooledBytes c(20);
+    c = std::move(b);
+    EXPECT_EQ(c.Data(), block);
+    EXPECT_EQ(c[0], 0x5A);
+    // c's old block went back to the cache.
+    EXPECT_EQ(BufferPool::ThreadStats().cached_bytes, 64u);
+}
+
+TEST_F(BufferPoolTest, CachesArePerThread) {
+    { PooledBytes warm(128); }
+    BufferPoolStats other{};
+    std::thread([&] {
+        PooledBytes buf(128);
+        other = BufferPool::ThreadStats();
+    }).join();
+    EXPECT_EQ(other.allocations, 1u);
+    EXPECT_EQ(other.reuses, 0u);
+    EXPECT_EQ(BufferPool::ThreadStats().cached_bytes, 128u);
+}
+
+}  // namespace
+}  // namespace plas::core
@@ -2,6 +2,11 @@
 
 #include "plas/core/byte_buffer.h"
 
+#include <utility>
+#include <vector>
+
+#include "plas/core/buffer_pool.h"
+
 namespace plas::core {
 namespace {
 
@@ -141,5 +146,146 @@ TEST(ByteBufferTest, ResizeSameSize) {
     EXPECT_EQ(buf[1], 0x02);
 }
 
+// --- Inline storage ---
+
+TEST(ByteBufferTest, SmallContentsStayInline) {
+    auto before = BufferPool::ThreadStats();
+    ByteBuffer buf(ByteBuffer::kInlineCapacity);
+    EXPECT_TRUE(buf.IsInline());
+    EXPECT_EQ(buf.Capacity(), ByteBuffer::kInlineCapacity);
+    auto after = BufferPool::ThreadStats();
+    EXPECT_EQ(after.allocations, before.allocations);
+    EXPECT_EQ(after.reuses, before.reuses);
+}
+
+TEST(ByteBufferTest, GrowsPastInlineCapacity) {
+    ByteBuffer buf;
+    for (size_t i = 0; i < 200; ++i) {
+        uint8_t byte = static_cast<uint8_t>(i);
+        buf.Append(&byte, 1);
+    }
+    EXPECT_FALSE(buf.IsInline());
+    EXPECT_GE(buf.Capacity(), 200u);
+    ASSERT_EQ(buf.Size(), 200u);
+    for (size_t i = 0; i < 200; ++i) {
+        EXPECT_EQ(buf[i], static_cast<uint8_t>(i));
+    }
+}
+
+TEST(ByteBufferTest, ReserveKeepsSizeAndContents) {
+    ByteBuffer buf{0x01, 0x02};
+    buf.Reserve(1000);
+    EXPECT_GE(buf.Capacity(), 1000u);
+    EXPECT_EQ(buf.Size(), 2u);
+    EXPECT_EQ(buf[1], 0x02);
+    const uint8_t* data = buf.Data();
+    buf.Resize(1000);
+    EXPECT_EQ(buf.Data(), data);
+}
+
+TEST(ByteBufferTest, AppendUninitializedReturnsTail) {
+    ByteBuffer buf{0xAA};
+    uint8_t* tail = buf.AppendUninitialized(3);
+    EXPECT_EQ(tail, buf.Data() + 1);
+    tail[0] = 1;
+    tail[1] = 2;
+    tail[2] = 3;
+    EXPECT_EQ(buf.View(), ByteView(std::vector<uint8_t>{0xAA, 1, 2, 3}));
+}
+
+TEST(ByteBufferTest, ResizeZeroFillsAfterShrink) {
+    ByteBuffer buf{0x11, 0x22, 0x33};
+    buf.Resize(1);
+    buf.Resize(3);
+    EXPECT_EQ(buf[1], 0x00);
+    EXPECT_EQ(buf[2], 0x00);
+}
+
+TEST(ByteBufferTest, AppendSliceOfItselfAcrossGrowth) {
+    ByteBuffer buf(ByteBuffer::kInlineCapacity);
+    for (size_t i = 0; i < buf.Size(); ++i) {
+        buf[i] = static_cast<uint8_t>(i);
+    }
+    buf.Append(buf.Slice(0, 48));
+    ASSERT_EQ(buf.Size(), ByteBuffer::kInlineCapacity + 48);
+    EXPECT_EQ(buf.Slice(ByteBuffer::kInlineCapacity), buf.Slice(0, 48));
+}
+
+// --- Copy / move ---
+
+TEST(ByteBufferTest, CopyInlineAndHeap) {
+    ByteBuffer small{0x01, 0x02};
+    ByteBuffer large(300);
+    large[299] = 0x7F;
+
+    ByteBuffer small_copy(small);
+    ByteBuffer large_copy = large;
+    EXPECT_TRUE(small_copy.IsInline());
+    EXPECT_NE(large_copy.Data(), large.Data());
+    EXPECT_EQ(small_copy.View(), small.View());
+    EXPECT_EQ(large_copy.View(), large.View());
+
+    small_copy = large;
+    EXPECT_EQ(small_copy.Size(), 300u);
+    EXPECT_EQ(small_copy[299], 0x7F);
+}
+
+TEST(ByteBufferTest, MoveHeapStealsBlock) {
+    ByteBuffer large(300);
+    const uint8_t* block = large.Data();
+    ByteBuffer moved(std::move(large));
+    EXPECT_EQ(moved.Data(), block);
+    EXPECT_EQ(moved.Size(), 300u);
+    EXPECT_TRUE(large.Empty());  // NOLINT(bugprone-use-after-move)
+    EXPECT_TRUE(large.IsInline());
+}
+
+TEST(ByteBufferTest, MoveInlineCopiesBytes) {
+    ByteBuffer small{0x05, 0x06};
+    ByteBuffer moved;
+    moved = std::move(small);
+    EXPECT_TRUE(moved.IsInline());
+    EXPECT_EQ(moved.Size(), 2u);
+    EXPECT_EQ(moved[1], 0x06);
+}
+
+// --- ByteView ---
+
+TEST(ByteViewTest, SliceClampsToBounds) {
+    const uint8_t bytes[] = {1, 2, 3, 4, 5};
+    ByteView view(bytes);
+    EXPECT_EQ(view.Size(), 5u);
+    EXPECT_EQ(view.Slice(1, 2).Size(), 2u);
+    EXPECT_EQ(view.Slice(1, 2)[0], 2);
+    EXPECT_EQ(view.Slice(3).Size(), 2u);
+    EXPECT_EQ(view.Slice(4, 100).Size(), 1u);
+    EXPECT_TRUE(view.Slice(5).Empty());
+    EXPECT_TRUE(view.Slice(99, 1).Empty());
+}
+
+TEST(ByteViewTest, BufferSliceDoesNotCopy) {
+    ByteBuffer buf{0x10, 0x20, 0x30, 0x40};
+    ByteView slice = buf.Slice(2);
+    EXPECT_EQ(slice.Data(), buf.Data() + 2);
+    EXPECT_EQ(slice[1], 0x40);
+}
+
+TEST(ByteViewTest, EqualityComparesContents) {
+    const uint8_t a[] = {1, 2, 3};
+    std::vector<uint8_t> b{1, 2, 3};
+    EXPECT_EQ(ByteView(a), ByteView(b));
+    EXPECT_NE(ByteView(a), ByteView(a).Slice(1));
+    EXPECT_EQ(ByteView(), ByteView(a).Slice(3));
+}
+
+TEST(ByteViewTest, IteratesBytes) {
+    ByteBuffer buf{1, 2, 3};
+    unsigned sum = 0;
+    for (uint8_t byte : ByteView(buf)) {
+        sum += byte;
+    }
+    EXPECT_EQ(sum, 6u);
+}
+
 }  // namespace
 }  // namespace plas::core
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "plas/core/deadline.h"
+
+namespace plas::core {
+namespace {
+
+using namespace std::chrono_literals;
+
+TEST(DeadlineTest, DefaultIsNone) {
+    Deadline none;
+    EXPECT_FALSE(none.IsSet());
+    EXPECT_FALSE(none.IsExpired());
+    EXPECT_EQ(none.Remaining(), std::chrono::nanoseconds::max());
+    auto local = Deadline::Clock::now() + 1s;
+    EXPECT_EQ(none.Clamp(local), local);
+}
+
+TEST(DeadlineTest, AfterExpiresAndClamps) {
+    auto deadline = Deadline::After(5ms);
+    EXPECT_TRUE(deadline.IsSet());
+    EXPECT_FALSE(deadline.IsExpired());
+    EXPECT_LE(deadline.Remaining(), 5ms);
+    EXPECT_EQ(deadline.Clamp(Deadline::Clock::now() + 1s), deadline.When());
+
+    std::this_thread::sleep_for(6ms);
+    EXPECT_TRUE(deadline.IsExpired());
+    EXPECT_EQ(deadline.Remaining(), std::chrono::nanoseconds(0));
+}
+
+TEST(DeadlineTest, ScopesNestAndOnlyTighten) {
+    EXPECT_FALSE(Deadline::Current().IsSet());
+    auto outer = Deadline::After(1s);
+    {
+        ScopedDeadline outer_scope(outer);
+        EXPECT_EQ(Deadline::Current().When(), outer.When());
+        {
+            ScopedDeadline looser(Deadline::After(10s));
+            EXPECT_EQ(Deadline::Current().When(), outer.When());
+        }
+        auto inner = Deadline::After(10ms);
+        {
+            ScopedDeadline tighter(inner);
+            EXPECT_EQ(Deadline::Current().When(), inner.When());
+        }
+        EXPECT_EQ(Deadline::Current().When(), outer.When());
+    }
+    EXPECT_FALSE(Deadline::Current().IsSet());
+}
+
+TEST(DeadlineTest, CurrentIsPerThread) {
+    ScopedDeadline scope(Deadline::After(1s));
+    bool other_has_deadline = true;
+    std::thread([&] { other_has_deadline = Deadline::Current().IsSet(); }).join();
+    EXPECT_FALSE(other_has_deadline);
+}
+
+}  // namespace
+}  // namespace plas::core
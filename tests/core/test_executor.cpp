@@ -0,0 +1,331 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "plas/core/deadline.h"
+#include "plas/core/executor.h"
+#include "plas/core/io_queue.h"
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace plas::core {
+namespace {
+
+using namespace std::chrono_literals;
+
+ExecutorOptions Threads(std::size_t count) {
+    ExecutorOptions options;
+    options.threads = count;
+    return options;
+}
+
+TEST(ExecutorTest, DefaultsToOneWorkerPerAllowedCpu) {
+    Executor executor;
+    EXPECT_GE(executor.ThreadCount(), 1u);
+#ifdef __linux__
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    ASSERT_EQ(sched_getaffinity(0, sizeof(mask), &mask), 0);
+    EXPECT_EQ(executor.ThreadCount(), static_cast<std::size_t>(CPU_COUNT(&mask)));
+#endif
+}
+
+TEST(ExecutorTest, SubmitReturnsResult) {
+    Executor executor(Threads(2));
+    auto future = executor.Submit([] { return 42; });
+    EXPECT_EQ(future.get(), 42);
+
+    auto on_worker = executor.Submit([&] { return executor.RunningInThisThread(); });
+    EXPECT_TRUE(on_worker.get());
+    EXPECT_FALSE(executor.RunningInThisThread());
+}
+
+TEST(ExecutorTest, DestructorRunsPostedTasks) {
+    std::atomic<int> ran{0};
+    {
+        Executor executor(Threads(2));
+        for (int i = 0; i < 1000; ++i) {
+            executor.Post([&] { ran.fetch_add(1); });
+        }
+    }
+    EXPECT_EQ(ran.load(), 1000);
+}
+
+TEST(ExecutorTest, TasksPostedFromWorkersAreStolen) {
+    Executor executor(Threads(4));
+    std::atomic<int> ran{0};
+    std::promise<void> done;
+    constexpr int kTasks = 400;
+    // One worker fans out into its own deque; the others must steal.
+    executor.Post([&] {
+        for (int i = 0; i < kTasks; ++i) {
+            executor.Post([&] {
+                std::this_thread::sleep_for(50us);
+                if (ran.fetch_add(1) + 1 == kTasks) {
+                    done.set_value();
+                }
+            });
+        }
+    });
+    done.get_future().wait();
+    EXPECT_EQ(ran.load(), kTasks);
+    EXPECT_GT(executor.GetStats().stolen, 0u);
+}
+
+TEST(ExecutorTest, ParallelForVisitsEveryIndexOnce) {
+    Executor executor(Threads(3));
+    std::vector<std::atomic<int>> hits(1000);
+    executor.ParallelFor(hits.size(), [&](std::size_t i) { hits[i].fetch_add(1); });
+    for (std::size_t i = 0; i < hits.size(); ++i) {
+        EXPECT_EQ(hits[i].load(), 1) << i;
+    }
+    executor.ParallelFor(0, [](std::size_t) { FAIL(); });
+}
+
+TEST(ExecutorTest, ParallelForMaxThreadsOneStaysOnCaller) {
+    Executor executor(Threads(4));
+    auto caller = std::this_thread::get_id();
+    std::atomic<bool> elsewhere{false};
+    executor.ParallelFor(
+        64,
+        [&](std::size_t) {
+            if (std::this_thread::get_id() != caller) {
+                elsewhere = true;
+            }
+        },
+        1);
+    EXPECT_FALSE(elsewhere.load());
+}
+
+TEST(ExecutorTest, ParallelForLimitsThreads) {
+    Executor executor(Threads(4));
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    executor.ParallelFor(
+        64,
+        [&](std::size_t) {
+            std::this_thread::sleep_for(200us);
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+        },
+        2);
+    EXPECT_LE(threads.size(), 2u);
+}
+
+TEST(ExecutorTest, ParallelForCarriesCallersDeadline) {
+    Executor executor(Threads(4));
+    auto deadline = Deadline::After(10s);
+    ScopedDeadline scope(deadline);
+    std::atomic<int> seen{0};
+    executor.ParallelFor(64, [&](std::size_t) {
+        std::this_thread::sleep_for(50us);
+        if (Deadline::Current().When() == deadline.When()) {
+            seen.fetch_add(1);
+        }
+    });
+    EXPECT_EQ(seen.load(), 64);
+
+    std::promise<bool> worker_has_deadline;
+    executor.Post([&] { worker_has_deadline.set_value(Deadline::Current().IsSet()); });
+    EXPECT_FALSE(worker_has_deadline.get_future().get());
+}
+
+TEST(ExecutorTest, ParallelForCarriesCallersIoPriority) {
+    Executor executor(Threads(4));
+    ScopedIoPriority background(IoPriority::kBackground);
+    std::atomic<int> seen{0};
+    executor.ParallelFor(64, [&](std::size_t) {
+        std::this_thread::sleep_for(50us);
+        if (CurrentIoPriority() == IoPriority::kBackground) {
+            seen.fetch_add(1);
+        }
+    });
+    EXPECT_EQ(seen.load(), 64);
+
+    std::promise<IoPriority> worker_priority;
+    executor.Post([&] { worker_priority.set_value(CurrentIoPriority()); });
+    EXPECT_EQ(worker_priority.get_future().get(), IoPriority::kForeground);
+}
+
+TEST(ExecutorTest, NestedParallelForOnOneWorkerCompletes) {
+    Executor executor(Threads(1));
+    std::atomic<int> sum{0};
+    auto outer = executor.Submit([&] {
+        executor.ParallelFor(8, [&](std::size_t) {
+            executor.ParallelFor(8, [&](std::size_t j) { sum.fetch_add(static_cast<int>(j)); });
+        });
+    });
+    ASSERT_EQ(outer.wait_for(10s), std::future_status::ready);
+    EXPECT_EQ(sum.load(), 8 * 28);
+}
+
+TEST(ExecutorTest, PostAfterRunsOnceAfterDelay) {
+    Executor executor(Threads(1));
+    std::promise<std::chrono::steady_clock::time_point> fired;
+    auto start = std::chrono::steady_clock::now();
+    executor.PostAfter(20ms, [&] { fired.set_value(std::chrono::steady_clock::now()); });
+    auto when = fired.get_future().get();
+    EXPECT_GE(when - start, 20ms);
+    executor.Submit([] {}).wait();  // the one worker has finished the timer
+    EXPECT_EQ(executor.GetStats().timers_fired, 1u);
+}
+
+TEST(ExecutorTest, CancelledTimerDoesNotRun) {
+    Executor executor(Threads(1));
+    std::atomic<bool> ran{false};
+    auto id = executor.PostAfter(50ms, [&] { ran = true; });
+    EXPECT_TRUE(executor.Cancel(id));
+    EXPECT_FALSE(executor.Cancel(id));
+    std::this_thread::sleep_for(100ms);
+    EXPECT_FALSE(ran.load());
+}
+
+TEST(ExecutorTest, PeriodicTimerRepeatsUntilCancelled) {
+    Executor executor(Threads(2));
+    std::atomic<int> ticks{0};
+    std::atomic<int> running{0};
+    std::atomic<bool> overlapped{false};
+    auto id = executor.PostEvery(2ms, [&] {
+        if (running.fetch_add(1) != 0) {
+            overlapped = true;
+        }
+        std::this_thread::sleep_for(3ms);  // overruns the period
+        ticks.fetch_add(1);
+        running.fetch_sub(1);
+    });
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (ticks.load() < 5 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    ASSERT_TRUE(executor.Cancel(id));
+    // Cancel waited for a run in progress; no run starts afterwards.
+    EXPECT_EQ(running.load(), 0);
+    int after = ticks.load();
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(ticks.load(), after);
+    EXPECT_GE(after, 5);
+    EXPECT_FALSE(overlapped.load());
+}
+
+TEST(ExecutorTest, TimerCanCancelItself) {
+    Executor executor(Threads(1));
+    std::atomic<Executor::TimerId> id{0};
+    std::atomic<int> ticks{0};
+    std::promise<int> cancelled_at;
+    id = executor.PostEvery(1ms, [&] {
+        int tick = ticks.fetch_add(1) + 1;
+        auto self = id.load();
+        if (self != 0 && executor.Cancel(self)) {
+            cancelled_at.set_value(tick);
+        }
+    });
+    int last = cancelled_at.get_future().get();
+    std::this_thread::sleep_for(10ms);
+    EXPECT_EQ(ticks.load(), last);
+}
+
+TEST(StrandTest, RunsTasksInOrderOneAtATime) {
+    Executor executor(Threads(4));
+    Strand strand(executor);
+    std::vector<int> order;
+    std::atomic<int> running{0};
+    std::atomic<bool> overlapped{false};
+    for (int i = 0; i < 200; ++i) {
+        strand.Post([&, i] {
+            if (running.fetch_add(1) != 0) {
+                overlapped = true;
+            }
+            EXPECT_TRUE(strand.RunningInThisThread());
+            order.push_back(i);  // no lock: the strand serializes
+            running.fetch_sub(1);
+        });
+    }
+    strand.Submit([] {}).wait();
+    ASSERT_EQ(order.size(), 200u);
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_EQ(order[static_cast<std::size_t>(i)], i);
+    }
+    EXPECT_FALSE(overlapped.load());
+    EXPECT_FALSE(strand.RunningInThisThread());
+}
+
+TEST(StrandTest, StrandsRunConcurrently) {
+    Executor executor(Threads(2));
+    Strand a(executor);
+    Strand b(executor);
+    std::promise<void> a_started;
+    std::promise<void> b_started;
+    auto fa = a.Submit([&] {
+        a_started.set_value();
+        return b_started.get_future().wait_for(5s) == std::future_status::ready;
+    });
+    auto fb = b.Submit([&] {
+        b_started.set_value();
+        return a_started.get_future().wait_for(5s) == std::future_status::ready;
+    });
+    EXPECT_TRUE(fa.get());
+    EXPECT_TRUE(fb.get());
+}
+
+TEST(ExecutorTest, SharedIsConfigurableOnlyBeforeUse) {
+    EXPECT_TRUE(Executor::ConfigureShared(Threads(2)).IsOk());
+    auto& shared = Executor::Shared();
+    EXPECT_EQ(&shared, &Executor::Shared());
+    EXPECT_EQ(shared.ThreadCount(), 2u);
+    auto again = Executor::ConfigureShared(Threads(3));
+    ASSERT_TRUE(again.IsError());
+    EXPECT_EQ(again.Error(), make_error_code(ErrorCode::kBusy));
+}
+
+TEST(ExecutorTest, ForCpusKeepsOneExecutorPerCpuSet) {
+    EXPECT_EQ(&Executor::ForCpus({}), &Executor::Shared());
+    int cpu = 0;
+#ifdef __linux__
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    ASSERT_EQ(sched_getaffinity(0, sizeof(mask), &mask), 0);
+    while (!CPU_ISSET(static_cast<std::size_t>(cpu), &mask)) {
+        ++cpu;
+    }
+#endif
+    auto& local = Executor::ForCpus({cpu, cpu});
+    EXPECT_EQ(&local, &Executor::ForCpus({cpu}));
+    EXPECT_NE(&local, &Executor::Shared());
+    EXPECT_EQ(local.ThreadCount(), 1u);
+    EXPECT_TRUE(local.Submit([&] { return local.RunningInThisThread(); }).get());
+}
+
+#ifdef __linux__
+TEST(ExecutorTest, PinsWorkersToCpus) {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    ASSERT_EQ(sched_getaffinity(0, sizeof(mask), &mask), 0);
+    int cpu = 0;
+    while (!CPU_ISSET(static_cast<std::size_t>(cpu), &mask)) {
+        ++cpu;
+    }
+
+    ExecutorOptions options;
+    options.cpus = {cpu};
+    Executor executor(options);
+    EXPECT_EQ(executor.ThreadCount(), 1u);
+    auto pinned = executor.Submit([] {
+        cpu_set_t worker;
+        CPU_ZERO(&worker);
+        sched_getaffinity(0, sizeof(worker), &worker);
+        return CPU_COUNT(&worker);
+    });
+    EXPECT_EQ(pinned.get(), 1);
+}
+#endif
+
+}  // namespace
+}  // namespace plas::core
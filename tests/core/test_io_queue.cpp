@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "plas/core/io_queue.h"
+
+namespace plas::core {
+namespace {
+
+using namespace std::chrono_literals;
+
+// Spin until `n` callers are queued at `priority`.
+void WaitForWaiters(const IoQueue& queue, IoPriority priority, std::size_t n) {
+    auto until = std::chrono::steady_clock::now() + 5s;
+    while (queue.Waiting(priority) < n && std::chrono::steady_clock::now() < until) {
+        std::this_thread::sleep_for(100us);
+    }
+    ASSERT_EQ(queue.Waiting(priority), n);
+}
+
+TEST(IoQueueTest, PriorityScopesNestPerThread) {
+    EXPECT_EQ(CurrentIoPriority(), IoPriority::kForeground);
+    {
+        ScopedIoPriority background(IoPriority::kBackground);
+        EXPECT_EQ(CurrentIoPriority(), IoPriority::kBackground);
+        {
+            ScopedIoPriority foreground(IoPriority::kForeground);
+            EXPECT_EQ(CurrentIoPriority(), IoPriority::kForeground);
+        }
+        EXPECT_EQ(CurrentIoPriority(), IoPriority::kBackground);
+
+        IoPriority other = IoPriority::kBackground;
+        std::thread([&] { other = CurrentIoPriority(); }).join();
+        EXPECT_EQ(other, IoPriority::kForeground);
+    }
+    EXPECT_EQ(CurrentIoPriority(), IoPriority::kForeground);
+}
+
+TEST(IoQueueTest, ForegroundOvertakesQueuedBackground) {
+    IoQueue queue;
+    std::mutex order_mutex;
+    std::vector<char> order;
+    auto record = [&](char c) {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(c);
+    };
+
+    queue.lock();  // a transaction in progress
+    std::vector<std::thread> threads;
+    for (char c : {'a', 'b'}) {
+        threads.emplace_back([&, c] {
+            ScopedIoPriority background(IoPriority::kBackground);
+            std::lock_guard<IoQueue> lock(queue);
+            record(c);
+        });
+        WaitForWaiters(queue, IoPriority::kBackground, threads.size());
+    }
+    threads.emplace_back([&] {
+        std::lock_guard<IoQueue> lock(queue);
+        record('F');
+    });
+    WaitForWaiters(queue, IoPriority::kForeground, 1);
+    queue.unlock();
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // Foreground first, background in arrival order.
+    EXPECT_EQ(order, (std::vector<char>{'F', 'a', 'b'}));
+    auto stats = queue.Stats();
+    EXPECT_EQ(stats.grants[0], 2u);  // the holder and F
+    EXPECT_EQ(stats.grants[1], 2u);
+    EXPECT_GE(stats.max_wait_us[1], stats.max_wait_us[0]);
+}
+
+TEST(IoQueueTest, TryLockUntilGivesUpAndPassesTheTurnOn) {
+    IoQueue queue;
+    queue.lock();
+    EXPECT_FALSE(queue.try_lock());
+    EXPECT_FALSE(queue.try_lock_until(IoQueue::Clock::now() + 2ms));
+    EXPECT_EQ(queue.Waiting(IoPriority::kForeground), 0u);
+
+    bool got = false;
+    std::thread waiter([&] {
+        ScopedIoPriority background(IoPriority::kBackground);
+        got = queue.try_lock_until(IoQueue::Clock::now() + 5s);
+        if (got) {
+            queue.unlock();
+        }
+    });
+    WaitForWaiters(queue, IoPriority::kBackground, 1);
+    // A foreground caller that times out ahead of it does not strand it.
+    EXPECT_FALSE(queue.try_lock_until(IoQueue::Clock::now() + 2ms));
+    queue.unlock();
+    waiter.join();
+    EXPECT_TRUE(got);
+
+    EXPECT_TRUE(queue.try_lock());
+    queue.unlock();
+    queue.ResetStats();
+    EXPECT_EQ(queue.Stats().grants[0], 0u);
+}
+
+}  // namespace
+}  // namespace plas::core
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "plas/core/io_queue.h"
+#include "plas/core/lock_stats.h"
+
+namespace plas::core {
+namespace {
+
+using namespace std::chrono_literals;
+
+const LockStats* Find(const std::vector<LockStats>& all, const std::string& name) {
+    for (const auto& stats : all) {
+        if (stats.name == name) {
+            return &stats;
+        }
+    }
+    return nullptr;
+}
+
+class LockStatsTest : public ::testing::Test {
+protected:
+    void SetUp() override { ResetLockStats(); }
+    void TearDown() override { ResetLockStats(); }
+};
+
+TEST_F(LockStatsTest, RecordsHoldWaitAndContention) {
+    InstrumentedMutex mutex("test.mutex");
+    {
+        std::lock_guard<InstrumentedMutex> lock(mutex);
+        std::this_thread::sleep_for(2ms);
+    }
+    mutex.lock();
+    std::thread waiter([&] { std::lock_guard<InstrumentedMutex> lock(mutex); });
+    std::this_thread::sleep_for(5ms);
+    mutex.unlock();
+    waiter.join();
+    EXPECT_TRUE(mutex.try_lock());
+    mutex.unlock();
+
+    auto stats = Find(LockStatsSnapshot(), "test.mutex");
+    if (!kLockStatsEnabled) {
+        EXPECT_EQ(stats, nullptr);
+        return;
+    }
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->acquisitions, 4u);
+    EXPECT_GE(stats->contended, 1u);
+    EXPECT_GE(stats->max_wait_ns, 1000000u);
+    EXPECT_GE(stats->max_hold_ns, 2000000u);
+    EXPECT_GE(stats->hold_ns, stats->max_hold_ns);
+    EXPECT_GT(stats->MeanHoldNs(), 0u);
+}
+
+TEST_F(LockStatsTest, InstancesShareANameAndResetKeepsThem) {
+    InstrumentedMutex a("test.shared");
+    InstrumentedMutex b("test.shared");
+    IoQueue queue("test.queue");
+    IoQueue unnamed;
+    { std::lock_guard<InstrumentedMutex> lock(a); }
+    { std::lock_guard<InstrumentedMutex> lock(b); }
+    { std::lock_guard<IoQueue> lock(queue); }
+    { std::lock_guard<IoQueue> lock(unnamed); }
+
+    auto all = LockStatsSnapshot();
+    if (!kLockStatsEnabled) {
+        EXPECT_TRUE(all.empty());
+        return;
+    }
+    ASSERT_NE(Find(all, "test.shared"), nullptr);
+    EXPECT_EQ(Find(all, "test.shared")->acquisitions, 2u);
+    ASSERT_NE(Find(all, "test.queue"), nullptr);
+    EXPECT_EQ(Find(all, "test.queue")->acquisitions, 1u);
+    EXPECT_EQ(Find(all, "test.queue")->contended, 0u);
+
+    ResetLockStats();
+    EXPECT_EQ(Find(LockStatsSnapshot(), "test.shared"), nullptr);
+    { std::lock_guard<InstrumentedMutex> lock(a); }
+    EXPECT_EQ(Find(LockStatsSnapshot(), "test.shared")->acquisitions, 1u);
+}
+
+}  // namespace
+}  // namespace plas::core
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/core/numa.h"
+
+namespace plas::core {
+namespace {
+
+TEST(ParseCpuListTest, RangesAndSingles) {
+    auto cpus = ParseCpuList("0-3,8,10-11\n");
+    ASSERT_TRUE(cpus.IsOk());
+    EXPECT_EQ(cpus.Value(), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+}
+
+TEST(ParseCpuListTest, SortsAndDeduplicates) {
+    auto cpus = ParseCpuList(" 5,1-2,2 ");
+    ASSERT_TRUE(cpus.IsOk());
+    EXPECT_EQ(cpus.Value(), (std::vector<int>{1, 2, 5}));
+}
+
+TEST(ParseCpuListTest, EmptyListIsEmpty) {
+    auto cpus = ParseCpuList("\n");
+    ASSERT_TRUE(cpus.IsOk());
+    EXPECT_TRUE(cpus.Value().empty());
+}
+
+TEST(ParseCpuListTest, RejectsMalformedLists) {
+    for (const char* text : {"a", "1-", "-1", "3-1", "1,,2", "1 2"}) {
+        auto cpus = ParseCpuList(text);
+        ASSERT_TRUE(cpus.IsError()) << text;
+        EXPECT_EQ(cpus.Error(), make_error_code(ErrorCode::kInvalidArgument)) << text;
+    }
+}
+
+TEST(NumaBufferTest, UnplacedBufferIsZeroed) {
+    auto buffer = NumaBuffer::Allocate(10000, -1);
+    ASSERT_TRUE(buffer.IsOk());
+    EXPECT_EQ(buffer.Value().Size(), 10000u);
+    EXPECT_EQ(buffer.Value().Node(), -1);
+    const auto* bytes = static_cast<const uint8_t*>(buffer.Value().Data());
+    for (std::size_t i = 0; i < buffer.Value().Size(); i += 997) {
+        EXPECT_EQ(bytes[i], 0);
+    }
+}
+
+TEST(NumaBufferTest, NodeZeroAlwaysExists) {
+    auto buffer = NumaBuffer::Allocate(1 << 16, 0);
+    ASSERT_TRUE(buffer.IsOk());
+    // 0 when the placement was applied, -1 where mbind is unavailable.
+    EXPECT_LE(buffer.Value().Node(), 0);
+
+    NumaBuffer moved = std::move(buffer.Value());
+    EXPECT_EQ(buffer.Value().Data(), nullptr);
+    ASSERT_NE(moved.Data(), nullptr);
+    static_cast<uint8_t*>(moved.Data())[moved.Size() - 1] = 0xA5;
+}
+
+TEST(NumaBufferTest, RejectsBadArguments) {
+    auto empty = NumaBuffer::Allocate(0, -1);
+    ASSERT_TRUE(empty.IsError());
+    EXPECT_EQ(empty.Error(), make_error_code(ErrorCode::kInvalidArgument));
+    auto node = NumaBuffer::Allocate(4096, 4096);
+    ASSERT_TRUE(node.IsError());
+    EXPECT_EQ(node.Error(), make_error_code(ErrorCode::kInvalidArgument));
+}
+
+TEST(NumaBufferTest, HugePagesRoundUpToHugePageSize) {
+    auto buffer = NumaBuffer::Allocate(3 << 20, -1, true);
+    ASSERT_TRUE(buffer.IsOk());
+    EXPECT_EQ(buffer.Value().Size(), std::size_t{3} << 20);
+    EXPECT_EQ(buffer.Value().Capacity(), 2 * kHugePageSize);
+    // Whatever backs it, the mapping starts on a 2 MiB boundary.
+    auto address = reinterpret_cast<std::uintptr_t>(buffer.Value().Data());
+    EXPECT_EQ(address % kHugePageSize, 0u);
+    auto* bytes = static_cast<uint8_t*>(buffer.Value().Data());
+    EXPECT_EQ(bytes[buffer.Value().Capacity() - 1], 0);
+    bytes[buffer.Value().Capacity() - 1] = 0x5A;
+
+    auto small = NumaBuffer::Allocate(100, -1);
+    ASSERT_TRUE(small.IsOk());
+    EXPECT_EQ(small.Value().Capacity(), 100u);
+    EXPECT_EQ(small.Value().Backing(), PageBacking::kNormal);
+}
+
+TEST(NumaBufferPoolTest, ReleasedBufferIsReusedPerNodeAndSize) {
+    NumaBufferPool pool(64 << 20, false);
+    void* first = nullptr;
+    {
+        auto lease = pool.Acquire(1 << 20, -1);
+        ASSERT_TRUE(lease.IsOk());
+        EXPECT_EQ(lease.Value().Size(), std::size_t{1} << 20);
+        first = lease.Value().Data();
+        static_cast<uint8_t*>(first)[0] = 0x11;
+    }
+    EXPECT_EQ(pool.Stats().cached_bytes, kHugePageSize);
+
+    // Same size class (≤ 2 MiB) and node: the same buffer, not cleared.
+    auto again = pool.Acquire(kHugePageSize, -1);
+    ASSERT_TRUE(again.IsOk());
+    EXPECT_EQ(again.Value().Data(), first);
+    EXPECT_EQ(static_cast<uint8_t*>(again.Value().Data())[0], 0x11);
+
+    // Different class: a new mapping.
+    auto larger = pool.Acquire(kHugePageSize + 1, -1);
+    ASSERT_TRUE(larger.IsOk());
+    EXPECT_NE(larger.Value().Data(), first);
+
+    auto stats = pool.Stats();
+    EXPECT_EQ(stats.allocations, 2u);
+    EXPECT_EQ(stats.reuses, 1u);
+    EXPECT_EQ(stats.cached_bytes, 0u);
+}
+
+TEST(NumaBufferPoolTest, CacheLimitAndTrim) {
+    NumaBufferPool pool(kHugePageSize, false);
+    {
+        auto a = pool.Acquire(100, -1);
+        auto b = pool.Acquire(100, -1);
+        ASSERT_TRUE(a.IsOk());
+        ASSERT_TRUE(b.IsOk());
+    }
+    // Only one 2 MiB buffer fits under the limit; the other was unmapped.
+    EXPECT_EQ(pool.Stats().cached_bytes, kHugePageSize);
+
+    NumaBufferLease moved;
+    {
+        auto lease = pool.Acquire(100, -1);
+        ASSERT_TRUE(lease.IsOk());
+        moved = std::move(lease.Value());
+    }
+    EXPECT_EQ(pool.Stats().cached_bytes, 0u);  // still held by `moved`
+    moved = NumaBufferLease();
+    EXPECT_EQ(pool.Stats().cached_bytes, kHugePageSize);
+
+    pool.Trim();
+    EXPECT_EQ(pool.Stats().cached_bytes, 0u);
+    EXPECT_EQ(pool.Acquire(0, -1).Error(), make_error_code(ErrorCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace plas::core
@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
@@ -10,6 +13,9 @@
 
 using plas::core::ErrorCode;
 using plas::core::Properties;
+using plas::core::PropertyBatch;
+using plas::core::PropertyChange;
+using plas::core::PropertyKey;
 using plas::core::Result;
 
 // Clean up all sessions between tests
@@ -352,6 +358,304 @@ TEST_F(PropertiesTest, GetAsFloatToDouble) {
     EXPECT_DOUBLE_EQ(r.Value(), 1.5);
 }
 
+// ========================== PropertyKey ==========================
+
+TEST_F(PropertiesTest, InternReturnsSameKey) {
+    auto a = PropertyKey::Intern("interned.key");
+    auto b = PropertyKey::Intern(std::string("interned.key"));
+    EXPECT_TRUE(a.IsValid());
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.Name(), "interned.key");
+    EXPECT_NE(a, PropertyKey::Intern("interned.other"));
+}
+
+TEST_F(PropertiesTest, FindDoesNotIntern) {
+    EXPECT_FALSE(PropertyKey::Find("never.interned.key").IsValid());
+    EXPECT_FALSE(PropertyKey::Find("never.interned.key").IsValid());
+    EXPECT_EQ(PropertyKey().Name(), "");
+
+    auto& p = Properties::GetSession("test");
+    EXPECT_FALSE(p.Has("never.interned.key"));
+    EXPECT_EQ(p.Get<int>("never.interned.key").Error(),
+              plas::core::make_error_code(ErrorCode::kNotFound));
+    EXPECT_FALSE(PropertyKey::Find("never.interned.key").IsValid());
+}
+
+TEST_F(PropertiesTest, KeyAndStringApiShareValues) {
+    auto& p = Properties::GetSession("test");
+    auto key = PropertyKey::Intern("shared");
+    p.Set<int64_t>(key, 7);
+    EXPECT_EQ(p.Get<int64_t>("shared").Value(), 7);
+
+    p.Set<std::string>("shared", "text");
+    EXPECT_EQ(p.Get<std::string>(key).Value(), "text");
+    EXPECT_EQ(p.Get<int64_t>(key).Error(),
+              plas::core::make_error_code(ErrorCode::kTypeMismatch));
+
+    p.Remove(key);
+    EXPECT_FALSE(p.Has("shared"));
+    EXPECT_EQ(p.Size(), 0u);
+}
+
+TEST_F(PropertiesTest, KeysAreIndependentPerSession) {
+    auto key = PropertyKey::Intern("per_session");
+    auto& a = Properties::GetSession("a");
+    auto& b = Properties::GetSession("b");
+    a.Set<int>(key, 1);
+    EXPECT_TRUE(a.Has(key));
+    EXPECT_FALSE(b.Has(key));
+    EXPECT_TRUE(b.Keys().empty());
+}
+
+TEST_F(PropertiesTest, GetAsBoxedArithmeticExactOnly) {
+    auto& p = Properties::GetSession("test");
+    p.Set<long long>("ll", 5);
+    EXPECT_EQ(p.GetAs<long long>("ll").Value(), 5);
+    EXPECT_TRUE(p.GetAs<int>("ll").IsError());
+}
+
+TEST_F(PropertiesTest, ClearKeepsKeysUsable) {
+    auto& p = Properties::GetSession("test");
+    auto key = PropertyKey::Intern("reused");
+    p.Set<int>(key, 1);
+    p.Clear();
+    EXPECT_FALSE(p.Has(key));
+    p.Set<int>(key, 2);
+    EXPECT_EQ(p.Get<int>(key).Value(), 2);
+    EXPECT_EQ(p.Size(), 1u);
+    EXPECT_EQ(p.Keys(), (std::vector<std::string>{"reused"}));
+}
+
+// ========================== Batches / Version ==========================
+
+TEST_F(PropertiesTest, SetManyAppliesAllInOneVersionStep) {
+    auto& p = Properties::GetSession("test");
+    p.Set<int>("old", 1);
+    auto before = p.Version();
+    EXPECT_EQ(before % 2, 0u);
+
+    PropertyBatch batch;
+    batch.Set<int>("a", 1).Set<std::string>("b", "two").Remove("old");
+    p.SetMany(batch);
+
+    EXPECT_EQ(p.Version(), before + 2);
+    EXPECT_EQ(p.Get<int>("a").Value(), 1);
+    EXPECT_EQ(p.Get<std::string>("b").Value(), "two");
+    EXPECT_FALSE(p.Has("old"));
+    EXPECT_EQ(p.Size(), 2u);
+}
+
+TEST_F(PropertiesTest, NoOpWritesKeepVersion) {
+    auto& p = Properties::GetSession("test");
+    auto before = p.Version();
+    p.Remove("missing");
+    p.SetMany(PropertyBatch{});
+    p.Clear();
+    EXPECT_EQ(p.Version(), before);
+    p.Set<int>("x", 1);
+    EXPECT_GT(p.Version(), before);
+}
+
+TEST_F(PropertiesTest, UpdateIsAtomicReadModifyWrite) {
+    auto& p = Properties::GetSession("test");
+    auto key = PropertyKey::Intern("counter");
+    p.Set<int64_t>(key, 0);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 500; ++i) {
+                p.Update([&](PropertyBatch& batch) {
+                    batch.Set<int64_t>(key, p.Get<int64_t>(key).Value() + 1);
+                });
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(p.Get<int64_t>(key).Value(), 2000);
+}
+
+// ========================== Subscriptions ==========================
+
+TEST_F(PropertiesTest, SubscribersReceiveMatchingKeysOffWriterThread) {
+    auto& p = Properties::GetSession("subs");
+    std::mutex mutex;
+    std::vector<PropertyChange> changes;
+    std::thread::id callback_thread;
+    auto id = p.Subscribe("test.", [&](const PropertyChange& change) {
+        std::lock_guard lock(mutex);
+        changes.push_back(change);
+        callback_thread = std::this_thread::get_id();
+    });
+
+    p.Set<int>("other", 1);  // no match, no callback
+    p.SetMany(PropertyBatch{}.Set<int>("test.a", 1).Set<int>("other", 2)
+                             .Set<int>("test.b", 2));
+    Properties::FlushNotifications();
+    p.Unsubscribe(id);  // not under `mutex`: the callback takes it
+
+    std::lock_guard lock(mutex);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].session, "subs");
+    EXPECT_EQ(changes[0].version, p.Version());
+    EXPECT_EQ(changes[0].keys, (std::vector<std::string>{"test.a", "test.b"}));
+    EXPECT_NE(callback_thread, std::this_thread::get_id());
+}
+
+TEST_F(PropertiesTest, UnsubscribeStopsDelivery) {
+    auto& p = Properties::GetSession("subs");
+    std::atomic<int> calls{0};
+    auto id = p.Subscribe("", [&](const PropertyChange&) { ++calls; });
+    p.Set<int>("x", 1);
+    Properties::FlushNotifications();
+    EXPECT_EQ(calls.load(), 1);
+
+    p.Unsubscribe(id);
+    p.Set<int>("x", 2);
+    Properties::FlushNotifications();
+    EXPECT_EQ(calls.load(), 1);
+}
+
+TEST_F(PropertiesTest, ClearNotifiesEveryRemovedKey) {
+    auto& p = Properties::GetSession("subs");
+    p.Set<int>("a", 1);
+    p.Set<int>("b", 2);
+    std::vector<std::string> keys;
+    auto id = p.Subscribe("", [&](const PropertyChange& change) {
+        keys = change.keys;
+    });
+    p.Clear();
+    Properties::FlushNotifications();
+    std::sort(keys.begin(), keys.end());
+    EXPECT_EQ(keys, (std::vector<std::string>{"a", "b"}));
+    p.Unsubscribe(id);
+}
+
+// ========================== Forks and Snapshots ==========================
+
+TEST_F(PropertiesTest, ForkReadsThroughToBase) {
+    auto& base = Properties::GetSession("base");
+    base.Set<int>("a", 1);
+    base.Set<std::string>("s", "shared");
+
+    auto fork = Properties::ForkSession("worker", "base");
+    ASSERT_TRUE(fork.IsOk());
+    auto& w = *fork.Value();
+    EXPECT_EQ(w.Base(), &base);
+    EXPECT_EQ(w.Get<int>("a").Value(), 1);
+    EXPECT_EQ(w.Get<std::string>("s").Value(), "shared");
+    EXPECT_EQ(w.Size(), 2u);
+
+    w.Set<int>("a", 2);
+    w.Set<int>("b", 3);
+    EXPECT_EQ(w.Get<int>("a").Value(), 2);
+    EXPECT_EQ(base.Get<int>("a").Value(), 1);
+    EXPECT_FALSE(base.Has("b"));
+    EXPECT_EQ(w.Keys(), (std::vector<std::string>{"a", "b", "s"}));
+
+    // Live base: un-overridden keys follow it.
+    base.Set<std::string>("s", "changed");
+    EXPECT_EQ(w.Get<std::string>("s").Value(), "changed");
+}
+
+TEST_F(PropertiesTest, ForkRemoveHidesBaseKey) {
+    auto& base = Properties::GetSession("base");
+    base.Set<int>("a", 1);
+    base.Set<int>("b", 2);
+    auto& w = *Properties::ForkSession("worker", "base").Value();
+
+    w.Remove("a");
+    EXPECT_FALSE(w.Has("a"));
+    EXPECT_EQ(w.Get<int>("a").Error(), ErrorCode::kNotFound);
+    EXPECT_TRUE(base.Has("a"));
+    EXPECT_EQ(w.Size(), 1u);
+
+    w.Set<int>("a", 5);
+    EXPECT_EQ(w.Get<int>("a").Value(), 5);
+
+    w.Clear();
+    EXPECT_EQ(w.Size(), 0u);
+    EXPECT_TRUE(w.Keys().empty());
+    EXPECT_EQ(base.Size(), 2u);
+}
+
+TEST_F(PropertiesTest, ForkSessionErrors) {
+    Properties::GetSession("base");
+    EXPECT_EQ(Properties::ForkSession("w", "missing").Error(),
+              ErrorCode::kNotFound);
+    EXPECT_EQ(Properties::ForkSession("base", "base").Error(),
+              ErrorCode::kAlreadyOpen);
+    EXPECT_EQ(Properties::ForkSession("w", std::shared_ptr<const Properties>()).Error(),
+              ErrorCode::kInvalidArgument);
+    EXPECT_FALSE(Properties::HasSession("w"));
+}
+
+TEST_F(PropertiesTest, ForkOutlivesDestroyedBase) {
+    Properties::GetSession("base").Set<int>("a", 1);
+    auto& w = *Properties::ForkSession("worker", "base").Value();
+    Properties::DestroySession("base");
+    EXPECT_EQ(w.Get<int>("a").Value(), 1);
+}
+
+TEST_F(PropertiesTest, SnapshotIsIsolatedFromLaterWrites) {
+    auto& p = Properties::GetSession("live");
+    p.Set<int>("a", 1);
+    p.Set<std::string>("s", "before");
+    auto snapshot = p.Snapshot();
+    EXPECT_EQ(snapshot->Version(), p.Version());
+
+    p.Set<int>("a", 2);
+    p.Set<std::string>("s", "after");
+    p.Remove("a");
+    p.Set<int>("c", 3);
+    EXPECT_EQ(snapshot->Get<int>("a").Value(), 1);
+    EXPECT_EQ(snapshot->Get<std::string>("s").Value(), "before");
+    EXPECT_FALSE(snapshot->Has("c"));
+    EXPECT_EQ(snapshot->Size(), 2u);
+    EXPECT_EQ(snapshot->Keys(), (std::vector<std::string>{"a", "s"}));
+}
+
+TEST_F(PropertiesTest, ForksOfSnapshotShareIt) {
+    auto& base = Properties::GetSession("base");
+    for (int i = 0; i < 1000; ++i) {
+        base.Set<int>("key." + std::to_string(i), i);
+    }
+    auto frozen = base.Snapshot();
+    base.Set<int>("key.0", -1);  // not seen by the forks
+
+    auto& w1 = *Properties::ForkSession("w1", frozen).Value();
+    auto& w2 = *Properties::ForkSession("w2", frozen).Value();
+    w1.Set<int>("key.1", 100);
+    w2.Remove("key.2");
+    EXPECT_EQ(w1.Get<int>("key.0").Value(), 0);
+    EXPECT_EQ(w1.Get<int>("key.1").Value(), 100);
+    EXPECT_EQ(w2.Get<int>("key.1").Value(), 1);
+    EXPECT_FALSE(w2.Has("key.2"));
+    EXPECT_EQ(w1.Size(), 1000u);
+    EXPECT_EQ(w2.Size(), 999u);
+
+    // Snapshot of a fork of a snapshot keeps sharing the frozen base.
+    auto w2_snapshot = w2.Snapshot();
+    EXPECT_EQ(w2_snapshot->Base(), frozen.get());
+    w2.Set<int>("key.2", 7);
+    EXPECT_FALSE(w2_snapshot->Has("key.2"));
+    EXPECT_EQ(w2_snapshot->Get<int>("key.3").Value(), 3);
+    EXPECT_EQ(w2_snapshot->Size(), 999u);
+}
+
+TEST_F(PropertiesTest, SnapshotOfLiveForkIsFlattened) {
+    auto& base = Properties::GetSession("base");
+    base.Set<int>("a", 1);
+    auto& w = *Properties::ForkSession("worker", "base").Value();
+    w.Set<int>("b", 2);
+
+    auto snapshot = w.Snapshot();
+    EXPECT_EQ(snapshot->Base(), nullptr);
+    base.Set<int>("a", 10);
+    EXPECT_EQ(snapshot->Get<int>("a").Value(), 1);
+    EXPECT_EQ(snapshot->Get<int>("b").Value(), 2);
+}
+
 // ========================== Thread Safety ==========================
 
 TEST_F(PropertiesTest, ConcurrentSetAndGet) {
@@ -423,3 +727,39 @@ TEST_F(PropertiesTest, ConcurrentReads) {
         th.join();
     }
 }
+
+TEST_F(PropertiesTest, ReadersNeverSeeTornValues) {
+    auto& p = Properties::GetSession("torn");
+    auto num = PropertyKey::Intern("torn.num");
+    auto str = PropertyKey::Intern("torn.str");
+    const std::string kShort = "a";
+    const std::string kLong(200, 'b');
+    p.Set<uint64_t>(num, 0);
+    p.Set<std::string>(str, kShort);
+
+    std::atomic<bool> stop{false};
+    std::thread writer([&] {
+        for (uint64_t i = 1; !stop.load(); ++i) {
+            // Both halves equal: a torn read would mix two writes.
+            p.Set<uint64_t>(num, (i & 0xFFFFFFFFu) * 0x100000001ull);
+            p.Set<std::string>(str, (i & 1) ? kLong : kShort);
+        }
+    });
+
+    std::vector<std::thread> readers;
+    std::atomic<int> bad{0};
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            for (int i = 0; i < 20000; ++i) {
+                auto n = p.Get<uint64_t>(num).Value();
+                if ((n >> 32) != (n & 0xFFFFFFFFu)) ++bad;
+                auto s = p.Get<std::string>(str).Value();
+                if (s != kShort && s != kLong) ++bad;
+            }
+        });
+    }
+    for (auto& th : readers) th.join();
+    stop = true;
+    writer.join();
+    EXPECT_EQ(bad.load(), 0);
+}
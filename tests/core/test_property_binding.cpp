@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+
+#include "plas/core/properties.h"
+#include "plas/core/property_binding.h"
+
+using plas::core::Properties;
+using plas::core::PropertyBinding;
+
+namespace {
+
+struct LinkParams {
+    int32_t timeout_ms = 100;
+    double vcc = 3.3;
+    std::string mode = "gen4";
+    bool enabled = false;
+};
+
+}  // namespace
+
+namespace plas::core {
+template <>
+struct PropertyFields<LinkParams> {
+    static constexpr auto kFields = std::make_tuple(
+        Field("link.timeout_ms", &LinkParams::timeout_ms),
+        Field("link.vcc", &LinkParams::vcc),
+        Field("link.mode", &LinkParams::mode),
+        Field("link.enabled", &LinkParams::enabled));
+};
+}  // namespace plas::core
+
+namespace {
+
+class PropertyBindingTest : public ::testing::Test {
+protected:
+    void TearDown() override { Properties::DestroyAll(); }
+};
+
+TEST_F(PropertyBindingTest, ReadsFieldsAndConvertsArithmetic) {
+    auto& s = Properties::GetSession("link");
+    s.Set("link.timeout_ms", int64_t{250});  // as loaded from a config file
+    s.Set("link.vcc", 1.8);
+    s.Set("link.mode", std::string("gen5"));
+    s.Set("link.enabled", true);
+
+    PropertyBinding<LinkParams> binding(s);
+    const auto& params = binding.Get();
+    EXPECT_EQ(params.timeout_ms, 250);
+    EXPECT_DOUBLE_EQ(params.vcc, 1.8);
+    EXPECT_EQ(params.mode, "gen5");
+    EXPECT_TRUE(params.enabled);
+    EXPECT_EQ(binding.MissingFields(), 0u);
+    EXPECT_EQ(binding.Version(), s.Version());
+}
+
+TEST_F(PropertyBindingTest, MissingAndMistypedFieldsKeepDefaults) {
+    auto& s = Properties::GetSession("link");
+    s.Set("link.vcc", 1.2);
+    s.Set("link.enabled", 1);                      // bool needs an exact bool
+    s.Set("link.timeout_ms", int64_t{1} << 40);    // does not fit int32_t
+
+    PropertyBinding<LinkParams> binding(s);
+    const auto& params = binding.Get();
+    EXPECT_DOUBLE_EQ(params.vcc, 1.2);
+    EXPECT_EQ(params.timeout_ms, 100);
+    EXPECT_EQ(params.mode, "gen4");
+    EXPECT_FALSE(params.enabled);
+    EXPECT_EQ(binding.MissingFields(), 3u);
+}
+
+TEST_F(PropertyBindingTest, RefreshesOnlyWhenTheSessionChanges) {
+    auto& s = Properties::GetSession("link");
+    s.Set("link.timeout_ms", 10);
+
+    PropertyBinding<LinkParams> binding(s);
+    EXPECT_TRUE(binding.Refresh());
+    EXPECT_FALSE(binding.Refresh());
+    EXPECT_EQ(binding.Get().timeout_ms, 10);
+
+    s.Set("link.timeout_ms", 20);
+    EXPECT_EQ(binding.Cached().timeout_ms, 10);
+    EXPECT_EQ(binding.Get().timeout_ms, 20);
+    EXPECT_FALSE(binding.Refresh());
+
+    // A removed key keeps the last value read.
+    s.Remove("link.timeout_ms");
+    EXPECT_TRUE(binding.Refresh());
+    EXPECT_EQ(binding.Cached().timeout_ms, 20);
+    EXPECT_EQ(binding.MissingFields(), 4u);
+}
+
+TEST_F(PropertyBindingTest, ForkFollowsItsBase) {
+    auto& base = Properties::GetSession("base");
+    base.Set("link.mode", std::string("gen3"));
+    base.Set("link.timeout_ms", 10);
+    auto& fork = *Properties::ForkSession("worker", "base").Value();
+    fork.Set("link.timeout_ms", 30);
+
+    PropertyBinding<LinkParams> binding(fork);
+    EXPECT_EQ(binding.Get().mode, "gen3");
+    EXPECT_EQ(binding.Cached().timeout_ms, 30);
+
+    // The fork's Version() stays put; the base's does not.
+    auto version = fork.Version();
+    base.Set("link.mode", std::string("gen6"));
+    base.Set("link.timeout_ms", 40);
+    EXPECT_EQ(fork.Version(), version);
+    EXPECT_TRUE(binding.Refresh());
+    EXPECT_EQ(binding.Cached().mode, "gen6");
+    EXPECT_EQ(binding.Cached().timeout_ms, 30);
+    EXPECT_FALSE(binding.Refresh());
+}
+
+}  // namespace
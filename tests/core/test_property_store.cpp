@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/core/properties.h"
+#include "plas/core/property_store.h"
+
+using plas::core::ByteView;
+using plas::core::ErrorCode;
+using plas::core::Properties;
+using plas::core::PropertyCheckpoint;
+using plas::core::PropertyStore;
+
+namespace fs = std::filesystem;
+
+class PropertyStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Properties::DestroyAll();
+        path_ = (fs::temp_directory_path() /
+                 ("plas_props_" + std::to_string(::getpid()) + ".bin"))
+                    .string();
+        fs::remove(path_);
+    }
+
+    void TearDown() override {
+        Properties::DestroyAll();
+        fs::remove(path_);
+    }
+
+    static void Populate() {
+        auto& p = Properties::GetSession("calib");
+        p.Set<bool>("enabled", true);
+        p.Set<int8_t>("offset", -3);
+        p.Set<uint16_t>("port", 8080);
+        p.Set<int64_t>("big", -1234567890123LL);
+        p.Set<uint64_t>("mask", 0xFFFF'FFFF'FFFF'FFFFULL);
+        p.Set<float>("gain", 1.5f);
+        p.Set<double>("vref", 3.3);
+        p.Set<std::string>("label", "dut-7");
+        p.Set<std::string>("empty", "");
+        Properties::GetSession("other").Set<int>("x", 1);
+    }
+
+    std::string path_;
+};
+
+TEST_F(PropertyStoreTest, RoundTripKeepsTypes) {
+    Populate();
+    auto bytes = PropertyStore::Encode();
+    Properties::DestroyAll();
+
+    auto restored = PropertyStore::Decode(bytes);
+    ASSERT_TRUE(restored.IsOk());
+    EXPECT_EQ(restored.Value(), 2u);
+
+    auto& p = Properties::GetSession("calib");
+    EXPECT_EQ(p.Size(), 9u);
+    EXPECT_TRUE(p.Get<bool>("enabled").Value());
+    EXPECT_EQ(p.Get<int8_t>("offset").Value(), -3);
+    EXPECT_EQ(p.Get<uint16_t>("port").Value(), 8080);
+    EXPECT_EQ(p.Get<int64_t>("big").Value(), -1234567890123LL);
+    EXPECT_EQ(p.Get<uint64_t>("mask").Value(), 0xFFFF'FFFF'FFFF'FFFFULL);
+    EXPECT_FLOAT_EQ(p.Get<float>("gain").Value(), 1.5f);
+    EXPECT_DOUBLE_EQ(p.Get<double>("vref").Value(), 3.3);
+    EXPECT_EQ(p.Get<std::string>("label").Value(), "dut-7");
+    EXPECT_EQ(p.Get<std::string>("empty").Value(), "");
+    EXPECT_EQ(p.Get<int>("port").Error(), ErrorCode::kTypeMismatch);
+    EXPECT_EQ(Properties::GetSession("other").Get<int>("x").Value(), 1);
+}
+
+TEST_F(PropertyStoreTest, DecodeReplacesSessionContents) {
+    Populate();
+    auto bytes = PropertyStore::Encode({"calib"});
+    auto& p = Properties::GetSession("calib");
+    p.Set<int>("stale", 1);
+    p.Set<std::string>("label", "changed");
+    auto version = p.Version();
+
+    ASSERT_TRUE(PropertyStore::Decode(bytes).IsOk());
+    EXPECT_FALSE(p.Has("stale"));
+    EXPECT_EQ(p.Get<std::string>("label").Value(), "dut-7");
+    EXPECT_EQ(p.Version(), version + 2);  // one commit
+}
+
+TEST_F(PropertyStoreTest, SkipsUnserializableValues) {
+    struct Custom {
+        int v;
+    };
+    auto& p = Properties::GetSession("s");
+    p.Set<Custom>("custom", Custom{1});
+    p.Set<int>("n", 2);
+
+    auto bytes = PropertyStore::Encode();
+    Properties::DestroyAll();
+    ASSERT_TRUE(PropertyStore::Decode(bytes).IsOk());
+    EXPECT_FALSE(Properties::GetSession("s").Has("custom"));
+    EXPECT_EQ(Properties::GetSession("s").Get<int>("n").Value(), 2);
+}
+
+TEST_F(PropertyStoreTest, RejectsCorruptInput) {
+    Populate();
+    auto bytes = PropertyStore::Encode();
+    Properties::DestroyAll();
+
+    auto flipped = bytes;
+    flipped.back() ^= 0x1;
+    EXPECT_EQ(PropertyStore::Decode(flipped).Error(), ErrorCode::kDataLoss);
+
+    auto truncated = bytes;
+    truncated.resize(truncated.size() - 3);
+    EXPECT_EQ(PropertyStore::Decode(truncated).Error(), ErrorCode::kDataLoss);
+
+    EXPECT_EQ(PropertyStore::Decode(ByteView(bytes.data(), 10)).Error(),
+              ErrorCode::kDataLoss);
+
+    auto future = bytes;
+    future[8] = 99;  // format version
+    EXPECT_EQ(PropertyStore::Decode(future).Error(), ErrorCode::kNotSupported);
+
+    EXPECT_TRUE(Properties::SessionNames().empty());  // nothing applied
+}
+
+TEST_F(PropertyStoreTest, SaveAndLoadFile) {
+    Populate();
+    ASSERT_TRUE(PropertyStore::Save(path_, {"calib"}).IsOk());
+    Properties::DestroyAll();
+
+    auto loaded = PropertyStore::Load(path_);
+    ASSERT_TRUE(loaded.IsOk());
+    EXPECT_EQ(loaded.Value(), 1u);
+    EXPECT_EQ(Properties::SessionNames(), std::vector<std::string>{"calib"});
+    EXPECT_EQ(PropertyStore::Load(path_ + ".missing").Error(),
+              ErrorCode::kNotFound);
+}
+
+TEST_F(PropertyStoreTest, ForkIsSavedFlattened) {
+    Properties::GetSession("base").Set<int>("a", 1);
+    auto& w = *Properties::ForkSession("worker", "base").Value();
+    w.Set<int>("b", 2);
+
+    auto bytes = PropertyStore::Encode({"worker"});
+    Properties::DestroyAll();
+    ASSERT_TRUE(PropertyStore::Decode(bytes).IsOk());
+    auto& restored = Properties::GetSession("worker");
+    EXPECT_EQ(restored.Base(), nullptr);
+    EXPECT_EQ(restored.Get<int>("a").Value(), 1);
+    EXPECT_EQ(restored.Get<int>("b").Value(), 2);
+}
+
+TEST_F(PropertyStoreTest, CheckpointValidatesOptions) {
+    PropertyCheckpoint checkpoint;
+    EXPECT_EQ(checkpoint.Start({}).Error(), ErrorCode::kInvalidArgument);
+    EXPECT_EQ(checkpoint.Start({path_, std::chrono::milliseconds(0), {}}).Error(),
+              ErrorCode::kInvalidArgument);
+    EXPECT_EQ(checkpoint.Flush().Error(), ErrorCode::kNotInitialized);
+
+    ASSERT_TRUE(checkpoint.Start({path_, std::chrono::hours(1), {}}).IsOk());
+    EXPECT_TRUE(checkpoint.IsRunning());
+    EXPECT_EQ(checkpoint.Start({path_, std::chrono::hours(1), {}}).Error(),
+              ErrorCode::kAlreadyOpen);
+    checkpoint.Stop();
+    EXPECT_FALSE(checkpoint.IsRunning());
+}
+
+TEST_F(PropertyStoreTest, CheckpointSavesOnlyWhenChanged) {
+    auto& p = Properties::GetSession("job");
+    p.Set<int>("step", 1);
+
+    PropertyCheckpoint checkpoint;
+    ASSERT_TRUE(checkpoint.Start({path_, std::chrono::hours(1), {"job"}}).IsOk());
+    ASSERT_TRUE(checkpoint.Flush().IsOk());
+    EXPECT_EQ(checkpoint.SaveCount(), 1u);
+    ASSERT_TRUE(checkpoint.Flush().IsOk());
+    EXPECT_EQ(checkpoint.SaveCount(), 1u);  // unchanged
+
+    p.Set<int>("step", 2);
+    checkpoint.Stop();  // final checkpoint
+    EXPECT_EQ(checkpoint.SaveCount(), 2u);
+
+    Properties::DestroyAll();
+    ASSERT_TRUE(PropertyStore::Load(path_).IsOk());
+    EXPECT_EQ(Properties::GetSession("job").Get<int>("step").Value(), 2);
+}
+
+TEST_F(PropertyStoreTest, CheckpointRunsPeriodically) {
+    auto& p = Properties::GetSession("job");
+    PropertyCheckpoint checkpoint;
+    ASSERT_TRUE(checkpoint.Start({path_, std::chrono::milliseconds(5), {}}).IsOk());
+    for (int i = 0; i < 50 && checkpoint.SaveCount() < 2; ++i) {
+        p.Set<int>("step", i);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_GE(checkpoint.SaveCount(), 2u);
+    EXPECT_EQ(checkpoint.FailureCount(), 0u);
+    EXPECT_TRUE(fs::exists(path_));
+}
+
+TEST_F(PropertyStoreTest, CheckpointCountsFailures) {
+    Properties::GetSession("job").Set<int>("step", 1);
+    PropertyCheckpoint checkpoint;
+    ASSERT_TRUE(checkpoint.Start({"/nonexistent-dir/props.bin",
+                                  std::chrono::hours(1), {}}).IsOk());
+    EXPECT_EQ(checkpoint.Flush().Error(), ErrorCode::kIOError);
+    EXPECT_EQ(checkpoint.FailureCount(), 1u);
+    EXPECT_EQ(checkpoint.SaveCount(), 0u);
+}
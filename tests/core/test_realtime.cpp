@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <sched.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/core/realtime.h"
+
+namespace plas::core {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+TEST(TscClockTest, TicksAdvanceAndConvert) {
+    const auto& clock = TscClock::Get();
+    EXPECT_EQ(&TscClock::Get(), &clock);
+    EXPECT_GT(clock.TicksPerSecond(), 0.0);
+
+    const uint64_t first = clock.Ticks();
+    const uint64_t second = clock.Ticks();
+    EXPECT_GE(second, first);
+
+    const uint64_t ns = 1'000'000;
+    EXPECT_NEAR(static_cast<double>(clock.ToNs(clock.FromNs(ns))), static_cast<double>(ns),
+                ns * 0.01);
+}
+
+TEST(TscClockTest, SpinUntilWaitsForTheDeadline) {
+    const auto& clock = TscClock::Get();
+    const auto wall_start = Clock::now();
+    clock.SpinUntil(clock.Ticks() + clock.FromNs(2'000'000));
+    const auto waited = Clock::now() - wall_start;
+    // Calibration error is well under 5%.
+    EXPECT_GE(waited, std::chrono::microseconds(1900));
+}
+
+TEST(RealtimeArenaTest, RejectsZeroBytes) {
+    auto arena = RealtimeArena::Create(0);
+    ASSERT_TRUE(arena.IsError());
+    EXPECT_EQ(arena.Error(), make_error_code(ErrorCode::kInvalidArgument));
+}
+
+TEST(RealtimeArenaTest, AllocatesAlignedUntilFull) {
+    auto created = RealtimeArena::Create(100);
+    ASSERT_TRUE(created.IsOk());
+    auto arena = std::move(created).Value();
+    EXPECT_GE(arena.Capacity(), 4096u);
+    EXPECT_EQ(arena.Used(), 0u);
+
+    auto* bytes = static_cast<unsigned char*>(arena.Allocate(3, 1));
+    ASSERT_NE(bytes, nullptr);
+    auto* words = arena.AllocateArray<uint64_t>(4);
+    ASSERT_NE(words, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(words) % alignof(uint64_t), 0u);
+    EXPECT_EQ(words[3], 0u);
+    EXPECT_EQ(arena.Used(), 8u + 4 * sizeof(uint64_t));
+
+    EXPECT_EQ(arena.Allocate(arena.Capacity()), nullptr);
+    EXPECT_EQ(arena.AllocateArray<uint64_t>(arena.Capacity()), nullptr);
+    EXPECT_EQ(arena.Allocate(8, 3), nullptr);  // not a power of two
+
+    arena.Reset();
+    EXPECT_EQ(arena.Used(), 0u);
+    EXPECT_EQ(arena.Allocate(arena.Capacity()), bytes);
+}
+
+TEST(RealtimeArenaTest, MoveTransfersTheMapping) {
+    auto created = RealtimeArena::Create(4096);
+    ASSERT_TRUE(created.IsOk());
+    RealtimeArena first = std::move(created).Value();
+    const bool locked = first.IsLocked();
+    RealtimeArena second(std::move(first));
+    EXPECT_EQ(first.Capacity(), 0u);
+    EXPECT_EQ(first.Allocate(1), nullptr);
+    EXPECT_EQ(second.IsLocked(), locked);
+    EXPECT_NE(second.Allocate(1), nullptr);
+
+    first = std::move(second);
+    EXPECT_EQ(second.Capacity(), 0u);
+    EXPECT_GE(first.Capacity(), 4096u);
+}
+
+TEST(EnterRealtimeTest, ReportsWhatTookEffect) {
+    RealtimeOptions options;
+    options.fifo_priority = 0;  // leave the test host's scheduler alone
+    auto status = EnterRealtime(options);
+    EXPECT_FALSE(status.fifo);
+    EXPECT_FALSE(status.pinned);
+    EXPECT_EQ(status.hardware_clock, TscClock::Get().IsHardware());
+
+    options.cpu = sched_getcpu();
+    ASSERT_GE(options.cpu, 0);
+    status = EnterRealtime(options);
+    EXPECT_TRUE(status.pinned);
+    EXPECT_EQ(sched_getcpu(), options.cpu);
+}
+
+TEST(IsolatedCpusTest, ListsValidCpuIds) {
+    for (int cpu : IsolatedCpus()) {
+        EXPECT_GE(cpu, 0);
+    }
+}
+
+TEST(JitterStatsTest, SummarizesLateness) {
+    std::vector<uint64_t> lateness;
+    for (uint64_t i = 1; i <= 200; ++i) {
+        lateness.push_back(i * 10);
+    }
+    auto stats = JitterStats::FromSamples(lateness);
+    EXPECT_EQ(stats.samples, 200u);
+    EXPECT_EQ(stats.min_ns, 10u);
+    EXPECT_EQ(stats.max_ns, 2000u);
+    EXPECT_EQ(stats.mean_ns, 1005u);
+    EXPECT_EQ(stats.p99_ns, 1980u);
+    EXPECT_EQ(stats.SpreadNs(), 1990u);
+}
+
+TEST(JitterStatsTest, EmptyIsZero) {
+    auto stats = JitterStats::FromSamples({});
+    EXPECT_EQ(stats.samples, 0u);
+    EXPECT_EQ(stats.max_ns, 0u);
+}
+
+}  // namespace
+}  // namespace plas::core
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "plas/core/register.h"
+
+namespace plas::core {
+namespace {
+
+enum class Mode : uint8_t { kOff = 0, kSlow = 1, kFast = 2 };
+
+struct Status : Register<uint16_t, 0x12, 0xC000> {
+    using Speed = RegisterField<Status, 0, 4, FieldAccess::kRO, uint8_t>;
+    using Width = RegisterField<Status, 4, 6, FieldAccess::kRO, uint8_t>;
+    using Training = RegisterField<Status, 11, 1, FieldAccess::kRO, bool>;
+    using Changed = RegisterField<Status, 14, 1, FieldAccess::kRW1C, bool>;
+    using Autonomous = RegisterField<Status, 15, 1, FieldAccess::kRW1C, bool>;
+};
+
+struct Control : Register<uint32_t, 0x04> {
+    using Enable = RegisterField<Control, 0, 1, FieldAccess::kRW, bool>;
+    using ModeField = RegisterField<Control, 1, 2, FieldAccess::kRW, Mode>;
+    using Count = RegisterField<Control, 8, 8, FieldAccess::kRW, uint8_t>;
+};
+
+struct Wide : Register<uint64_t, 0x08> {
+    using Low = RegisterField<Wide, 0, 16, FieldAccess::kRW, uint16_t>;
+    using Length = RegisterField<Wide, 16, 21, FieldAccess::kRW, uint32_t>;
+    using High = RegisterField<Wide, 40, 24, FieldAccess::kRW, uint32_t>;
+    using All = RegisterField<Wide, 0, 64, FieldAccess::kRW, uint64_t>;
+};
+
+// Everything folds at compile time.
+static_assert(Status::Width::kMask == 0x03F0);
+static_assert(Status::Width::Get(0x0143) == 0x14);
+static_assert(Wide::High::kMask == 0xFFFFFF0000000000ull);
+static_assert(Wide::All::kMask == ~0ull);
+static_assert(RegisterValue<Control>().Set<Control::Count>(0x5A).Raw() == 0x5A00);
+static_assert(RegisterValue<Status>(0xC000).ForWrite() == 0);
+
+TEST(RegisterTest, GetDecodesFields) {
+    RegisterValue<Status> status(0x2843);  // 8 GT/s, x4, training, no RW1C
+    EXPECT_EQ(status.Get<Status::Speed>(), 3);
+    EXPECT_EQ(status.Get<Status::Width>(), 4);
+    EXPECT_TRUE(status.Get<Status::Training>());
+    EXPECT_FALSE(status.Get<Status::Changed>());
+    EXPECT_EQ(status.Raw(), 0x2843);
+}
+
+TEST(RegisterTest, SetReplacesOnlyItsField) {
+    RegisterValue<Control> control(0xFFFF00F0u);
+    control.Set<Control::Enable>(true).Set<Control::ModeField>(Mode::kFast);
+    EXPECT_EQ(control.Raw(), 0xFFFF00F5u);
+    EXPECT_EQ(control.Get<Control::ModeField>(), Mode::kFast);
+
+    control.Set<Control::Count>(0x12);
+    EXPECT_EQ(control.Raw(), 0xFFFF12F5u);
+    EXPECT_EQ(control.ForWrite(), control.Raw());  // no RW1C bits
+}
+
+TEST(RegisterTest, SetTruncatesToTheField) {
+    RegisterValue<Control> control;
+    control.Set<Control::ModeField>(static_cast<Mode>(7));
+    EXPECT_EQ(control.Raw(), 0x6u);
+}
+
+TEST(RegisterTest, ForWriteKeepsRw1cBitsReadAsOne) {
+    // Both status bits read as 1; writing the value back must not clear them.
+    RegisterValue<Status> status(0xC043);
+    EXPECT_EQ(status.ForWrite(), 0x0043);
+
+    // Only the one asked for is cleared.
+    status.Set<Status::Changed>(true);
+    EXPECT_EQ(status.ForWrite(), 0x4043);
+    EXPECT_EQ(status.Raw(), 0xC043);
+}
+
+TEST(RegisterTest, SixtyFourBitFields) {
+    RegisterValue<Wide> wide;
+    wide.Set<Wide::Low>(0x1234).Set<Wide::Length>(0x1FFFFF).Set<Wide::High>(0xADBEEF);
+    EXPECT_EQ(wide.Raw(), 0xADBEEF1FFFFF1234ull);
+    EXPECT_EQ(wide.Get<Wide::High>(), 0xADBEEFu);
+    EXPECT_EQ(wide.Get<Wide::Length>(), 0x1FFFFFu);
+    EXPECT_EQ(wide.Get<Wide::Low>(), 0x1234u);
+    EXPECT_EQ(wide.Get<Wide::All>(), wide.Raw());
+
+    wide.Set<Wide::Length>(0x3FFFFF);  // one bit too many: truncated
+    EXPECT_EQ(wide.Get<Wide::Length>(), 0x1FFFFFu);
+    EXPECT_EQ(wide.Get<Wide::High>(), 0xADBEEFu);
+}
+
+}  // namespace
+}  // namespace plas::core
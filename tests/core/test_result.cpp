@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <cerrno>
+#include <cstdint>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "plas/core/result.h"
 
@@ -65,3 +69,142 @@ TEST(ResultVoidTest, ErrVoidFromStdErrorCode) {
     EXPECT_TRUE(result.IsError());
     EXPECT_EQ(result.Error(), ec);
 }
+
+TEST(ResultTest, ScalarResultIsCompact) {
+    static_assert(sizeof(Result<uint32_t>) == 8);
+    static_assert(sizeof(Result<uint8_t>) == 8);
+    static_assert(sizeof(Result<void>) == 8);
+    static_assert(sizeof(Result<uint64_t>) == 16);
+    static_assert(std::is_trivially_copyable_v<Result<uint32_t>>);
+    static_assert(std::is_trivially_copyable_v<Result<uint64_t>>);
+    static_assert(std::is_trivially_copyable_v<Result<void>>);
+
+    auto ok = Result<uint32_t>::Ok(0xDEADBEEF);
+    auto copy = ok;
+    EXPECT_TRUE(copy.IsOk());
+    EXPECT_EQ(copy.Value(), 0xDEADBEEFu);
+
+    auto err = Result<uint32_t>::Err(ErrorCode::kTimeout);
+    copy = err;
+    EXPECT_TRUE(copy.IsError());
+    EXPECT_EQ(copy.Error(), make_error_code(ErrorCode::kTimeout));
+}
+
+TEST(ResultTest, ErrorKeepsCategory) {
+    auto result = Result<uint16_t>::Err(std::make_error_code(std::errc::io_error));
+    EXPECT_EQ(result.Error(), std::errc::io_error);
+    EXPECT_EQ(&result.Error().category(), &std::generic_category());
+
+    auto plas = Result<void>::Err(std::error_code(ErrorCode::kBusy));
+    EXPECT_EQ(plas.Error(), make_error_code(ErrorCode::kBusy));
+
+    auto wide = Result<std::string>::Err(
+        std::error_code(EIO, std::system_category()));
+    EXPECT_EQ(wide.Error(), std::error_code(EIO, std::system_category()));
+}
+
+/// Category defined outside plas; gets its index on first use.
+class TestCategory : public std::error_category {
+public:
+    const char* name() const noexcept override { return "test"; }
+    std::string message(int) const override { return "test error"; }
+};
+
+TEST(ResultTest, ForeignCategoryRoundTrips) {
+    static const TestCategory category;
+    auto first = Result<uint32_t>::Err(std::error_code(7, category));
+    auto second = Result<void>::Err(std::error_code(9, category));
+    EXPECT_EQ(first.Error(), std::error_code(7, category));
+    EXPECT_EQ(second.Error(), std::error_code(9, category));
+    EXPECT_EQ(std::string(first.Error().category().name()), "test");
+}
+
+/// Counts copies and moves.
+struct Tracked {
+    explicit Tracked(int v) : value(v) {}
+    Tracked(const Tracked& other) : value(other.value) { ++copies; }
+    Tracked(Tracked&& other) noexcept : value(other.value) { ++moves; }
+    Tracked& operator=(const Tracked&) = default;
+    Tracked& operator=(Tracked&&) = default;
+
+    int value;
+    static inline int copies = 0;
+    static inline int moves = 0;
+};
+
+TEST(ResultTest, EmplaceConstructsInPlace) {
+    Tracked::copies = Tracked::moves = 0;
+    auto result = Result<Tracked>::Emplace(7);
+    EXPECT_EQ(result.Value().value, 7);
+    EXPECT_EQ(Tracked::copies, 0);
+    EXPECT_EQ(Tracked::moves, 0);
+
+    auto ok = Result<Tracked>::Ok(Tracked(8));
+    EXPECT_EQ(ok.Value().value, 8);
+    EXPECT_EQ(Tracked::copies, 0);
+    EXPECT_EQ(Tracked::moves, 1);
+}
+
+TEST(ResultTest, EmplaceVector) {
+    auto result = Result<std::vector<int>>::Emplace(3, 5);
+    EXPECT_EQ(result.Value(), (std::vector<int>{5, 5, 5}));
+}
+
+TEST(ResultTest, MapTransformsValue) {
+    auto doubled = Result<int>::Ok(21).Map([](int v) { return v * 2; });
+    EXPECT_EQ(doubled.Value(), 42);
+
+    auto text = Result<int>::Ok(5).Map([](int v) { return std::string(static_cast<std::size_t>(v), 'x'); });
+    EXPECT_EQ(text.Value(), "xxxxx");
+
+    auto err = Result<int>::Err(ErrorCode::kBusy).Map([](int v) { return v + 1; });
+    EXPECT_EQ(err.Error(), make_error_code(ErrorCode::kBusy));
+
+    int seen = 0;
+    Result<void> done = Result<int>::Ok(3).Map([&](int v) { seen = v; });
+    EXPECT_TRUE(done.IsOk());
+    EXPECT_EQ(seen, 3);
+}
+
+TEST(ResultTest, AndThenChainsFallibleSteps) {
+    auto half = [](int v) {
+        return v % 2 == 0 ? Result<int>::Ok(v / 2)
+                          : Result<int>::Err(ErrorCode::kInvalidArgument);
+    };
+    EXPECT_EQ(Result<int>::Ok(8).AndThen(half).AndThen(half).Value(), 2);
+
+    auto odd = Result<int>::Ok(6).AndThen(half).AndThen(half);
+    EXPECT_EQ(odd.Error(), make_error_code(ErrorCode::kInvalidArgument));
+
+    bool called = false;
+    auto skipped = Result<int>::Err(ErrorCode::kTimeout).AndThen([&](int v) {
+        called = true;
+        return half(v);
+    });
+    EXPECT_FALSE(called);
+    EXPECT_EQ(skipped.Error(), make_error_code(ErrorCode::kTimeout));
+}
+
+TEST(ResultTest, RvalueMapMovesValue) {
+    Tracked::copies = Tracked::moves = 0;
+    auto length = Result<Tracked>::Emplace(4).Map(
+        [](Tracked&& t) { return Tracked(std::move(t)).value; });
+    EXPECT_EQ(length.Value(), 4);
+    EXPECT_EQ(Tracked::copies, 0);
+
+    const auto held = Result<std::string>::Ok("abc");
+    auto size = held.Map([](const std::string& s) { return s.size(); });
+    EXPECT_EQ(size.Value(), 3u);
+    EXPECT_EQ(held.Value(), "abc");
+}
+
+TEST(ResultVoidTest, AndThenAndMap) {
+    auto next = Result<void>::Ok().AndThen([] { return Result<int>::Ok(1); });
+    EXPECT_EQ(next.Value(), 1);
+
+    auto failed = Result<void>::Err(ErrorCode::kIOError).Map([] { return 2; });
+    EXPECT_EQ(failed.Error(), make_error_code(ErrorCode::kIOError));
+
+    auto mapped = Result<void>::Ok().Map([] { return 3; });
+    EXPECT_EQ(mapped.Value(), 3);
+}
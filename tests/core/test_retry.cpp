@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "plas/core/deadline.h"
+#include "plas/core/result.h"
+#include "plas/core/retry.h"
+
+namespace plas::core {
+namespace {
+
+using namespace std::chrono_literals;
+
+bool IsTransient(const RetryPolicy& policy, const Result<int>& result) {
+    return result.IsError() && policy.IsRetryable(result.Error());
+}
+
+TEST(RetryPolicyTest, DefaultsNeverRetry) {
+    RetryPolicy policy;
+    EXPECT_FALSE(policy.Enabled());
+    EXPECT_TRUE(policy.IsRetryable(make_error_code(ErrorCode::kBusy)));
+    EXPECT_TRUE(policy.IsRetryable(make_error_code(ErrorCode::kTimeout)));
+    EXPECT_FALSE(policy.IsRetryable(make_error_code(ErrorCode::kIOError)));
+    EXPECT_FALSE(policy.IsRetryable(std::make_error_code(std::errc::device_or_resource_busy)));
+}
+
+TEST(RetryPolicyTest, BackoffDoublesUpToTheCap) {
+    RetryPolicy policy;
+    policy.initial_backoff = 100us;
+    policy.max_backoff = 500us;
+    policy.jitter = 0.0;
+    EXPECT_EQ(policy.Backoff(1), 100us);
+    EXPECT_EQ(policy.Backoff(2), 200us);
+    EXPECT_EQ(policy.Backoff(3), 400us);
+    EXPECT_EQ(policy.Backoff(4), 500us);
+    EXPECT_EQ(policy.Backoff(40), 500us);
+}
+
+TEST(RetryPolicyTest, JitterOnlyShortensTheBackoff) {
+    RetryPolicy policy;
+    policy.initial_backoff = 1000us;
+    policy.max_backoff = 1000us;
+    policy.jitter = 0.5;
+    bool varied = false;
+    for (int i = 0; i < 200; ++i) {
+        auto delay = policy.Backoff(1);
+        EXPECT_GE(delay, 500us);
+        EXPECT_LE(delay, 1000us);
+        varied = varied || delay != 1000us;
+    }
+    EXPECT_TRUE(varied);
+}
+
+TEST(RetryCallTest, RetriesTransientErrorsUntilSuccess) {
+    RetryPolicy policy;
+    policy.max_attempts = 5;
+    policy.initial_backoff = 10us;
+    int calls = 0;
+    RetryOutcome outcome;
+    auto result = RetryCall(
+        policy,
+        [&] {
+            return ++calls < 3 ? Result<int>::Err(ErrorCode::kBusy) : Result<int>::Ok(calls);
+        },
+        [&](const Result<int>& r) { return IsTransient(policy, r); }, &outcome);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), 3);
+    EXPECT_EQ(outcome.attempts, 3u);
+    EXPECT_FALSE(outcome.exhausted);
+    EXPECT_GT(outcome.slept.count(), 0);
+}
+
+TEST(RetryCallTest, StopsAtMaxAttemptsAndOnPermanentErrors) {
+    RetryPolicy policy;
+    policy.max_attempts = 3;
+    policy.initial_backoff = 1us;
+    int calls = 0;
+    RetryOutcome outcome;
+    auto busy = RetryCall(
+        policy, [&] { ++calls; return Result<int>::Err(ErrorCode::kBusy); },
+        [&](const Result<int>& r) { return IsTransient(policy, r); }, &outcome);
+    EXPECT_EQ(busy.Error(), ErrorCode::kBusy);
+    EXPECT_EQ(calls, 3);
+    EXPECT_TRUE(outcome.exhausted);
+
+    calls = 0;
+    auto io = RetryCall(
+        policy, [&] { ++calls; return Result<int>::Err(ErrorCode::kIOError); },
+        [&](const Result<int>& r) { return IsTransient(policy, r); }, &outcome);
+    EXPECT_EQ(io.Error(), ErrorCode::kIOError);
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(outcome.attempts, 1u);
+    EXPECT_FALSE(outcome.exhausted);
+}
+
+TEST(RetryCallTest, GivesUpWhenBackoffWouldPassTheDeadline) {
+    RetryPolicy policy;
+    policy.max_attempts = 10;
+    policy.initial_backoff = 50ms;
+    policy.max_backoff = 50ms;
+    policy.jitter = 0.0;
+    int calls = 0;
+    RetryOutcome outcome;
+    auto start = std::chrono::steady_clock::now();
+    {
+        ScopedDeadline scope(Deadline::After(20ms));
+        RetryCall(
+            policy, [&] { ++calls; return Result<int>::Err(ErrorCode::kTimeout); },
+            [&](const Result<int>& r) { return IsTransient(policy, r); }, &outcome);
+    }
+    EXPECT_EQ(calls, 1);
+    EXPECT_TRUE(outcome.exhausted);
+    EXPECT_EQ(outcome.slept.count(), 0);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 50ms);
+}
+
+}  // namespace
+}  // namespace plas::core
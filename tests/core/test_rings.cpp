@@ -0,0 +1,277 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "plas/core/mpsc_ring.h"
+#include "plas/core/spsc_ring.h"
+
+namespace plas::core {
+namespace {
+
+// --- SpscRing ---
+
+TEST(SpscRingTest, CapacityRoundsUpToPowerOfTwo) {
+    EXPECT_EQ(SpscRing<int>(0).Capacity(), 1u);
+    EXPECT_EQ(SpscRing<int>(5).Capacity(), 8u);
+    EXPECT_EQ(SpscRing<int>(64).Capacity(), 64u);
+}
+
+TEST(SpscRingTest, FullRingDropsNewest) {
+    SpscRing<int> ring(4);
+    int in[6] = {1, 2, 3, 4, 5, 6};
+    EXPECT_EQ(ring.Push(in, 6), 4u);
+    EXPECT_EQ(ring.Dropped(), 2u);
+    EXPECT_FALSE(ring.Push(7));
+    EXPECT_EQ(ring.Dropped(), 3u);
+    EXPECT_EQ(ring.Size(), 4u);
+
+    int out[8] = {};
+    ASSERT_EQ(ring.Pop(out, 8), 4u);
+    EXPECT_EQ(out[0], 1);
+    EXPECT_EQ(out[3], 4);
+    EXPECT_EQ(ring.Pop(out, 8), 0u);
+}
+
+TEST(SpscRingTest, BatchesWrapAroundTheEnd) {
+    SpscRing<int> ring(8);
+    int out[8] = {};
+    int next = 0;
+    int expected = 0;
+    // Batches of 5 against a ring of 8 straddle the end on most rounds.
+    for (int round = 0; round < 20; ++round) {
+        int in[5];
+        for (int& v : in) {
+            v = next++;
+        }
+        ASSERT_EQ(ring.Push(in, 5), 5u);
+        ASSERT_EQ(ring.Pop(out, 5), 5u);
+        for (int i = 0; i < 5; ++i) {
+            ASSERT_EQ(out[i], expected++);
+        }
+    }
+    EXPECT_EQ(ring.Dropped(), 0u);
+}
+
+TEST(SpscRingTest, MovesNonTrivialEntries) {
+    SpscRing<std::string> ring(2);
+    ASSERT_TRUE(ring.Push(std::string(100, 'x')));
+    std::string out;
+    ASSERT_EQ(ring.Pop(&out, 1), 1u);
+    EXPECT_EQ(out.size(), 100u);
+}
+
+TEST(SpscRingTest, TwoThreadsSeeEveryEntryInOrder) {
+    constexpr uint64_t kCount = 200000;
+    SpscRing<uint64_t> ring(256);
+    std::thread producer([&] {
+        uint64_t next = 0;
+        uint64_t batch[16];
+        while (next < kCount) {
+            std::size_t n = 0;
+            for (; n < 16 && next + n < kCount; ++n) {
+                batch[n] = next + n;
+            }
+            // Retry what did not fit instead of dropping it.
+            std::size_t pushed = 0;
+            while (pushed < n) {
+                std::size_t k = ring.Push(batch + pushed, n - pushed);
+                if (k == 0) {
+                    std::this_thread::yield();
+                }
+                pushed += k;
+            }
+            next += n;
+        }
+    });
+    uint64_t expected = 0;
+    uint64_t out[32];
+    while (expected < kCount) {
+        std::size_t n = ring.Pop(out, 32);
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(out[i], expected++);
+        }
+    }
+    producer.join();
+    EXPECT_EQ(ring.Size(), 0u);
+}
+
+// --- MpscRing ---
+
+TEST(MpscRingTest, SingleThreadBehavesLikeSpsc) {
+    MpscRing<int> ring(3);
+    EXPECT_EQ(ring.Capacity(), 4u);
+    int in[5] = {1, 2, 3, 4, 5};
+    EXPECT_EQ(ring.Push(in, 5), 4u);
+    EXPECT_EQ(ring.Dropped(), 1u);
+    int out[4] = {};
+    ASSERT_EQ(ring.Pop(out, 2), 2u);
+    EXPECT_EQ(out[1], 2);
+    EXPECT_EQ(ring.Push(in, 5), 2u);  // wraps into the freed slots
+    ASSERT_EQ(ring.Pop(out, 4), 4u);
+    EXPECT_EQ(out[0], 3);
+    EXPECT_EQ(out[2], 1);
+    EXPECT_EQ(ring.Size(), 0u);
+}
+
+TEST(MpscRingTest, ProducersKeepTheirOwnOrderAndBatchesStayContiguous) {
+    constexpr int kProducers = 4;
+    constexpr uint32_t kPerProducer = 50000;
+    constexpr uint32_t kBatch = 4;
+    MpscRing<uint64_t> ring(1024);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&ring, p] {
+            uint64_t batch[kBatch];
+            for (uint32_t i = 0; i < kPerProducer; i += kBatch) {
+                for (uint32_t k = 0; k < kBatch; ++k) {
+                    batch[k] = (static_cast<uint64_t>(p) << 32) | (i + k);
+                }
+                std::size_t pushed = 0;
+                while (pushed < kBatch) {
+                    std::size_t k = ring.Push(batch + pushed, kBatch - pushed);
+                    if (k == 0) {
+                        std::this_thread::yield();
+                    }
+                    pushed += k;
+                }
+            }
+        });
+    }
+
+    std::vector<uint32_t> next(kProducers, 0);
+    uint64_t total = 0;
+    uint64_t out[64];
+    while (total < kProducers * kPerProducer) {
+        std::size_t n = ring.Pop(out, 64);
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            auto p = static_cast<std::size_t>(out[i] >> 32);
+            auto seq = static_cast<uint32_t>(out[i]);
+            ASSERT_LT(p, next.size());
+            ASSERT_EQ(seq, next[p]++);
+        }
+        total += n;
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    EXPECT_EQ(ring.Size(), 0u);
+}
+
+// --- SharedSpscRing ---
+
+struct alignas(kCacheLineSize) AlignedBlock {
+    unsigned char bytes[kCacheLineSize];
+};
+
+std::unique_ptr<AlignedBlock[]> AllocateFor(std::size_t bytes) {
+    return std::make_unique<AlignedBlock[]>((bytes + kCacheLineSize - 1) /
+                                            kCacheLineSize);
+}
+
+TEST(SharedSpscRingTest, AttachSeesWhatCreateWrote) {
+    using Ring = SharedSpscRing<uint32_t>;
+    std::size_t bytes = Ring::BytesFor(10);
+    auto memory = AllocateFor(bytes);
+
+    auto producer = Ring::Create(memory.get(), bytes, 10);
+    ASSERT_TRUE(producer.IsOk());
+    EXPECT_EQ(producer.Value().Capacity(), 16u);
+    uint32_t in[3] = {7, 8, 9};
+    ASSERT_EQ(producer.Value().Push(in, 3), 3u);
+
+    auto consumer = Ring::Attach(memory.get(), bytes);
+    ASSERT_TRUE(consumer.IsOk());
+    EXPECT_EQ(consumer.Value().Size(), 3u);
+    uint32_t out[4] = {};
+    ASSERT_EQ(consumer.Value().Pop(out, 4), 3u);
+    EXPECT_EQ(out[2], 9u);
+    EXPECT_EQ(producer.Value().Size(), 0u);
+}
+
+TEST(SharedSpscRingTest, RejectsBadMemory) {
+    using Ring = SharedSpscRing<uint32_t>;
+    std::size_t bytes = Ring::BytesFor(16);
+    auto memory = AllocateFor(bytes + kCacheLineSize);
+
+    EXPECT_EQ(Ring::Create(nullptr, bytes, 16).Error(), ErrorCode::kInvalidArgument);
+    EXPECT_EQ(Ring::Create(memory[0].bytes + 8, bytes, 16).Error(),
+              ErrorCode::kInvalidArgument);
+    EXPECT_EQ(Ring::Create(memory.get(), bytes - 1, 16).Error(), ErrorCode::kOutOfRange);
+
+    // Never created: no magic.
+    EXPECT_EQ(Ring::Attach(memory.get(), bytes).Error(), ErrorCode::kDataLoss);
+
+    ASSERT_TRUE(Ring::Create(memory.get(), bytes, 16).IsOk());
+    EXPECT_EQ(Ring::Attach(memory.get(), bytes - 1).Error(), ErrorCode::kDataLoss);
+    EXPECT_EQ(SharedSpscRing<uint64_t>::Attach(memory.get(), bytes).Error(),
+              ErrorCode::kDataLoss);  // slot size differs
+}
+
+#ifdef __linux__
+TEST(SharedSpscRingTest, CarriesEntriesBetweenProcesses) {
+    using Ring = SharedSpscRing<uint64_t>;
+    constexpr uint64_t kCount = 100000;
+    std::size_t bytes = Ring::BytesFor(128);
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(memory, MAP_FAILED);
+    ASSERT_TRUE(Ring::Create(memory, bytes, 128).IsOk());
+
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        auto ring = Ring::Attach(memory, bytes);
+        if (ring.IsError()) {
+            _exit(2);
+        }
+        for (uint64_t i = 0; i < kCount;) {
+            if (ring.Value().Push(i)) {
+                ++i;
+            } else {
+                sched_yield();
+            }
+        }
+        _exit(0);
+    }
+
+    auto ring = Ring::Attach(memory, bytes);
+    ASSERT_TRUE(ring.IsOk());
+    uint64_t expected = 0;
+    uint64_t out[32];
+    while (expected < kCount) {
+        std::size_t n = ring.Value().Pop(out, 32);
+        if (n == 0) {
+            sched_yield();
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(out[i], expected++);
+        }
+    }
+    int status = 0;
+    ASSERT_EQ(waitpid(child, &status, 0), child);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    munmap(memory, bytes);
+}
+#endif
+
+}  // namespace
+}  // namespace plas::core
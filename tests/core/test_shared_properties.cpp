@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/core/properties.h"
+#include "plas/core/shared_properties.h"
+
+using plas::core::ErrorCode;
+using plas::core::PropertyBatch;
+using plas::core::SharedProperties;
+
+class SharedPropertiesTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        name_ = "/plas_test_props_" + std::to_string(::getpid());
+        SharedProperties::Unlink(name_);
+    }
+
+    void TearDown() override { SharedProperties::Unlink(name_); }
+
+    std::unique_ptr<SharedProperties> CreateRegion(
+        SharedProperties::Options options = {}) {
+        auto created = SharedProperties::Create(name_, options);
+        EXPECT_TRUE(created.IsOk());
+        return created.IsOk() ? std::move(created.Value()) : nullptr;
+    }
+
+    std::string name_;
+};
+
+TEST_F(SharedPropertiesTest, ReaderSeesWriterValues) {
+    auto writer = CreateRegion();
+    ASSERT_TRUE(writer);
+    EXPECT_TRUE(writer->IsWriter());
+    ASSERT_TRUE(writer->Set<int32_t>("timeout_ms", 500).IsOk());
+    ASSERT_TRUE(writer->Set<double>("vref", 3.3).IsOk());
+    ASSERT_TRUE(writer->Set<bool>("enabled", true).IsOk());
+    ASSERT_TRUE(writer->Set<std::string>("label", "dut-7").IsOk());
+
+    auto opened = SharedProperties::Open(name_);
+    ASSERT_TRUE(opened.IsOk());
+    auto& reader = *opened.Value();
+    EXPECT_FALSE(reader.IsWriter());
+    EXPECT_EQ(reader.Get<int32_t>("timeout_ms").Value(), 500);
+    EXPECT_DOUBLE_EQ(reader.Get<double>("vref").Value(), 3.3);
+    EXPECT_TRUE(reader.Get<bool>("enabled").Value());
+    EXPECT_EQ(reader.Get<std::string>("label").Value(), "dut-7");
+    EXPECT_EQ(reader.Size(), 4u);
+    EXPECT_EQ(reader.Keys(),
+              (std::vector<std::string>{"enabled", "label", "timeout_ms", "vref"}));
+
+    // Same typing rules as Properties.
+    EXPECT_EQ(reader.Get<int64_t>("timeout_ms").Error(), ErrorCode::kTypeMismatch);
+    EXPECT_EQ(reader.GetAs<int64_t>("timeout_ms").Value(), 500);
+    EXPECT_EQ(reader.GetAs<uint8_t>("timeout_ms").Error(), ErrorCode::kTypeMismatch);
+    EXPECT_EQ(reader.GetAs<int>("label").Error(), ErrorCode::kTypeMismatch);
+    EXPECT_EQ(reader.Get<int>("missing").Error(), ErrorCode::kNotFound);
+
+    // Later updates show up without reopening.
+    ASSERT_TRUE(writer->Set<int32_t>("timeout_ms", 750).IsOk());
+    ASSERT_TRUE(writer->Remove("enabled").IsOk());
+    EXPECT_EQ(reader.Get<int32_t>("timeout_ms").Value(), 750);
+    EXPECT_FALSE(reader.Has("enabled"));
+    EXPECT_EQ(reader.Size(), 3u);
+}
+
+TEST_F(SharedPropertiesTest, ReadOnlyMappingRejectsWrites) {
+    auto writer = CreateRegion();
+    ASSERT_TRUE(writer);
+    auto reader = std::move(SharedProperties::Open(name_).Value());
+    EXPECT_EQ(reader->Set<int>("x", 1).Error(), ErrorCode::kPermissionDenied);
+    EXPECT_EQ(reader->Remove("x").Error(), ErrorCode::kPermissionDenied);
+}
+
+TEST_F(SharedPropertiesTest, CreateAndOpenErrors) {
+    EXPECT_EQ(SharedProperties::Open(name_).Error(), ErrorCode::kNotFound);
+    EXPECT_EQ(SharedProperties::Create(name_, {0, 1024}).Error(),
+              ErrorCode::kInvalidArgument);
+    auto writer = CreateRegion();
+    ASSERT_TRUE(writer);
+    EXPECT_EQ(SharedProperties::Create(name_).Error(), ErrorCode::kAlreadyOpen);
+    EXPECT_EQ(writer->Set<int>("", 1).Error(), ErrorCode::kInvalidArgument);
+    EXPECT_EQ(writer->Set<int>(std::string(SharedProperties::kMaxKeyLength + 1, 'k'), 1)
+                  .Error(),
+              ErrorCode::kInvalidArgument);
+}
+
+TEST_F(SharedPropertiesTest, CapacityAndArenaLimits) {
+    auto writer = CreateRegion({4, 16});
+    ASSERT_TRUE(writer);
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(writer->Set<int>("k" + std::to_string(i), i).IsOk());
+    }
+    EXPECT_EQ(writer->Set<int>("k4", 4).Error(), ErrorCode::kResourceExhausted);
+    ASSERT_TRUE(writer->Set<int>("k0", 10).IsOk());  // existing key still fits
+
+    ASSERT_TRUE(writer->Remove("k1").IsOk());
+    // Rewriting a string repeatedly compacts the arena instead of failing.
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_TRUE(writer->Set<std::string>("k1", "value" + std::to_string(i)).IsOk());
+    }
+    EXPECT_EQ(writer->Get<std::string>("k1").Value(), "value19");
+    EXPECT_EQ(writer->Set<std::string>("k2", std::string(17, 'x')).Error(),
+              ErrorCode::kResourceExhausted);
+}
+
+TEST_F(SharedPropertiesTest, SetManyIsOneVersionStep) {
+    auto writer = CreateRegion();
+    ASSERT_TRUE(writer);
+    auto before = writer->Version();
+    ASSERT_TRUE(writer->SetMany(PropertyBatch{}
+                                    .Set<int>("a", 1)
+                                    .Set<std::string>("b", "two")
+                                    .Set<double>("c", 3.0))
+                    .IsOk());
+    EXPECT_EQ(writer->Version(), before + 2);
+    EXPECT_EQ(writer->Size(), 3u);
+
+    ASSERT_TRUE(writer->Remove("never-set").IsOk());
+    EXPECT_EQ(writer->Version(), before + 2);  // no-op
+}
+
+TEST_F(SharedPropertiesTest, OtherProcessReads) {
+    auto writer = CreateRegion();
+    ASSERT_TRUE(writer);
+    ASSERT_TRUE(writer->Set<int64_t>("epoch", 42).IsOk());
+    ASSERT_TRUE(writer->Set<std::string>("mode", "fast").IsOk());
+
+    pid_t pid = ::fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        auto opened = SharedProperties::Open(name_);
+        bool ok = opened.IsOk() &&
+                  opened.Value()->Get<int64_t>("epoch").Value() == 42 &&
+                  opened.Value()->Get<std::string>("mode").Value() == "fast";
+        ::_exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST_F(SharedPropertiesTest, ReadersNeverSeeTornBatches) {
+    auto writer = CreateRegion();
+    ASSERT_TRUE(writer);
+    ASSERT_TRUE(writer->SetMany(PropertyBatch{}.Set<int64_t>("lo", 0)
+                                    .Set<std::string>("tag", "0"))
+                    .IsOk());
+    auto reader = std::move(SharedProperties::Open(name_).Value());
+
+    std::atomic<bool> stop{false};
+    std::thread publisher([&] {
+        for (int64_t i = 1; i < 2000; ++i) {
+            writer->SetMany(PropertyBatch{}.Set<int64_t>("lo", i)
+                                .Set<std::string>("tag", std::to_string(i)));
+        }
+        stop = true;
+    });
+
+    int mismatches = 0;
+    while (!stop) {
+        auto version = reader->Version();
+        auto lo = reader->Get<int64_t>("lo");
+        auto tag = reader->Get<std::string>("tag");
+        if (version % 2 == 0 && reader->Version() == version &&
+            std::to_string(lo.Value()) != tag.Value()) {
+            ++mismatches;
+        }
+    }
+    publisher.join();
+    EXPECT_EQ(mismatches, 0);
+    EXPECT_EQ(reader->Get<int64_t>("lo").Value(), 1999);
+}
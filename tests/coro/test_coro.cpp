@@ -0,0 +1,398 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/core/executor.h"
+#include "plas/coro/hal.h"
+#include "plas/coro/schedule.h"
+#include "plas/coro/task.h"
+#include "plas/hal/interface/ssd_gpio.h"
+
+namespace plas::coro {
+namespace {
+
+using namespace std::chrono_literals;
+using core::ErrorCode;
+using core::Result;
+
+core::ExecutorOptions Threads(std::size_t count) {
+    core::ExecutorOptions options;
+    options.threads = count;
+    return options;
+}
+
+/// Tracks how many calls overlap; each call takes `delay`.
+struct Overlap {
+    std::atomic<int> running{0};
+    std::atomic<int> max{0};
+    std::chrono::microseconds delay{0};
+
+    void Enter() {
+        int now = running.fetch_add(1) + 1;
+        int seen = max.load();
+        while (now > seen && !max.compare_exchange_weak(seen, now)) {
+        }
+        if (delay.count() > 0) {
+            std::this_thread::sleep_for(delay);
+        }
+    }
+    void Leave() { running.fetch_sub(1); }
+};
+
+class FakeI2c : public hal::I2c {
+public:
+    hal::Device* GetDevice() override { return nullptr; }
+
+    Result<size_t> Read(core::Address addr, core::Byte* data, size_t length,
+                        bool) override {
+        overlap.Enter();
+        for (size_t i = 0; i < length; ++i) {
+            data[i] = static_cast<core::Byte>(addr + i);
+        }
+        overlap.Leave();
+        return Result<size_t>::Ok(length);
+    }
+    Result<size_t> Write(core::Address, const core::Byte*, size_t length, bool) override {
+        overlap.Enter();
+        overlap.Leave();
+        return Result<size_t>::Ok(length);
+    }
+    Result<size_t> WriteRead(core::Address addr, const core::Byte*, size_t,
+                             core::Byte* read_data, size_t read_len) override {
+        return Read(addr, read_data, read_len, true);
+    }
+    Result<void> SetBitrate(uint32_t) override { return Result<void>::Ok(); }
+    uint32_t GetBitrate() const override { return 100000; }
+
+    Overlap overlap;
+};
+
+class FakeDoe : public hal::pci::PciDoe {
+public:
+    hal::Device* GetDevice() override { return nullptr; }
+    Result<std::vector<hal::pci::DoeProtocolId>> DoeDiscover(hal::pci::Bdf,
+                                                             hal::pci::ConfigOffset) override {
+        return Result<std::vector<hal::pci::DoeProtocolId>>::Ok({});
+    }
+    Result<hal::pci::DoePayload> DoeExchange(hal::pci::Bdf, hal::pci::ConfigOffset,
+                                             hal::pci::DoeProtocolId,
+                                             const hal::pci::DoePayload& request) override {
+        auto response = request;
+        for (auto& dword : response) {
+            dword = ~dword;
+        }
+        return Result<hal::pci::DoePayload>::Ok(std::move(response));
+    }
+};
+
+class FakeMailbox : public hal::pci::CxlMailbox {
+public:
+    hal::Device* GetDevice() override { return nullptr; }
+    Result<hal::pci::CxlMailboxResult> ExecuteCommand(
+        hal::pci::Bdf bdf, hal::pci::CxlMailboxOpcode opcode,
+        const hal::pci::CxlMailboxPayload& payload) override {
+        return ExecuteCommand(bdf, static_cast<uint16_t>(opcode), payload);
+    }
+    Result<hal::pci::CxlMailboxResult> ExecuteCommand(
+        hal::pci::Bdf, uint16_t raw_opcode,
+        const hal::pci::CxlMailboxPayload& payload) override {
+        if (raw_opcode == 0xFFFF) {
+            return Result<hal::pci::CxlMailboxResult>::Err(ErrorCode::kTimeout);
+        }
+        hal::pci::CxlMailboxResult result{hal::pci::CxlMailboxReturnCode::kSuccess, payload};
+        result.payload.push_back(static_cast<uint8_t>(raw_opcode));
+        return Result<hal::pci::CxlMailboxResult>::Ok(std::move(result));
+    }
+    Result<uint32_t> GetPayloadSize(hal::pci::Bdf) override {
+        return Result<uint32_t>::Ok(256);
+    }
+    Result<bool> IsReady(hal::pci::Bdf) override { return Result<bool>::Ok(true); }
+    Result<hal::pci::CxlMailboxResult> GetBackgroundCmdStatus(hal::pci::Bdf) override {
+        return Result<hal::pci::CxlMailboxResult>::Err(ErrorCode::kNotSupported);
+    }
+};
+
+class FakePower : public hal::PowerControl {
+public:
+    hal::Device* GetDevice() override { return nullptr; }
+    Result<void> SetVoltage(core::Voltage v) override {
+        return Record("volts=" + std::to_string(static_cast<int>(v.Value() * 1000)));
+    }
+    Result<core::Voltage> GetVoltage() override {
+        return Result<core::Voltage>::Ok(core::Voltage(0.0));
+    }
+    Result<void> SetCurrent(core::Current) override { return Record("amps"); }
+    Result<core::Current> GetCurrent() override {
+        return Result<core::Current>::Ok(core::Current(0.0));
+    }
+    Result<void> PowerOn() override { return Record("on"); }
+    Result<void> PowerOff() override { return Record("off"); }
+    Result<bool> IsPowerOn() override { return Result<bool>::Ok(false); }
+
+    std::vector<std::string> Ops() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ops_;
+    }
+    std::string fail_on;
+
+private:
+    Result<void> Record(const std::string& op) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ops_.push_back(op);
+        if (op == fail_on) {
+            return Result<void>::Err(ErrorCode::kIOError);
+        }
+        return Result<void>::Ok();
+    }
+
+    std::mutex mutex_;
+    std::vector<std::string> ops_;
+};
+
+Task<int> Answer() {
+    co_return 42;
+}
+
+Task<int> AddAnswers(int times) {
+    int sum = 0;
+    for (int i = 0; i < times; ++i) {
+        sum += co_await Answer();
+    }
+    co_return sum;
+}
+
+TEST(CoroTaskTest, SyncWaitReturnsValue) {
+    core::Executor executor(Threads(1));
+    EXPECT_EQ(SyncWait(Answer(), executor), 42);
+}
+
+TEST(CoroTaskTest, AwaitsNestedTasks) {
+    core::Executor executor(Threads(1));
+    EXPECT_EQ(SyncWait(AddAnswers(1000), executor), 42000);
+}
+
+TEST(CoroTaskTest, LazyUntilAwaited) {
+    core::Executor executor(Threads(1));
+    bool ran = false;
+    auto make = [&]() -> Task<void> {
+        ran = true;
+        co_return;
+    };
+    {
+        auto task = make();
+        EXPECT_FALSE(ran);
+    }  // destroyed without running
+    EXPECT_FALSE(ran);
+    SyncWait(make(), executor);
+    EXPECT_TRUE(ran);
+}
+
+TEST(CoroTaskTest, SpawnRunsOnTheExecutor) {
+    core::Executor executor(Threads(2));
+    auto on_worker = [&]() -> Task<bool> { co_return executor.RunningInThisThread(); };
+    EXPECT_TRUE(Spawn(on_worker(), executor).get());
+}
+
+TEST(CoroScheduleTest, SleepsHoldNoThread) {
+    core::Executor executor(Threads(1));
+    constexpr int kCoroutines = 200;
+    auto sleeper = [&]() -> Task<int> {
+        co_await SleepFor(20ms, executor);
+        co_return 1;
+    };
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::future<int>> futures;
+    for (int i = 0; i < kCoroutines; ++i) {
+        futures.push_back(Spawn(sleeper(), executor));
+    }
+    int done = 0;
+    for (auto& future : futures) {
+        done += future.get();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(done, kCoroutines);
+    EXPECT_GE(elapsed, 20ms);
+    // One worker sleeping through each in turn would take 4 s.
+    EXPECT_LT(elapsed, 2s);
+}
+
+TEST(CoroScheduleTest, SleepUntilPastDeadlineDoesNotSuspend) {
+    core::Executor executor(Threads(1));
+    auto task = [&]() -> Task<bool> {
+        co_await SleepUntil(std::chrono::steady_clock::now() - 1ms, executor);
+        co_return executor.RunningInThisThread();
+    };
+    EXPECT_TRUE(SyncWait(task(), executor));
+}
+
+TEST(CoroHalTest, I2cCallsOnOneStrandDoNotOverlap) {
+    core::Executor executor(Threads(4));
+    core::Strand strand(executor);
+    FakeI2c i2c;
+    i2c.overlap.delay = 200us;
+    constexpr int kReaders = 32;
+    std::vector<std::vector<core::Byte>> buffers(kReaders, std::vector<core::Byte>(4));
+
+    auto reader = [&](int i) -> Task<Result<size_t>> {
+        co_return co_await Read(i2c, static_cast<core::Address>(0x10 + i),
+                                buffers[static_cast<size_t>(i)].data(), 4, strand);
+    };
+    std::vector<std::future<Result<size_t>>> futures;
+    for (int i = 0; i < kReaders; ++i) {
+        futures.push_back(Spawn(reader(i), executor));
+    }
+    for (int i = 0; i < kReaders; ++i) {
+        auto result = futures[static_cast<size_t>(i)].get();
+        ASSERT_TRUE(result.IsOk());
+        EXPECT_EQ(result.Value(), 4u);
+        EXPECT_EQ(buffers[static_cast<size_t>(i)][3], static_cast<core::Byte>(0x10 + i + 3));
+    }
+    EXPECT_EQ(i2c.overlap.max.load(), 1);
+}
+
+TEST(CoroHalTest, I2cTransferAndWriteRead) {
+    core::Executor executor(Threads(2));
+    FakeI2c i2c;
+    core::Byte reg = 0x00;
+    core::Byte out[2] = {};
+    auto result = SyncWait(WriteRead(i2c, 0x50, &reg, 1, out, 2, executor), executor);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(out[1], 0x51);
+
+    core::Byte data[3] = {};
+    hal::I2cMessage msgs[2] = {{0x50, &reg, 1, false, false, 0}, {0x50, data, 3, true, false, 0}};
+    auto transfer = SyncWait(Transfer(i2c, msgs, 2, executor), executor);
+    ASSERT_TRUE(transfer.IsOk());
+    EXPECT_EQ(transfer.Value(), 2u);
+    EXPECT_EQ(data[2], 0x52);
+}
+
+TEST(CoroHalTest, DoeExchangeAndMailboxCommand) {
+    core::Executor executor(Threads(2));
+    FakeDoe doe;
+    FakeMailbox mailbox;
+    hal::pci::Bdf bdf{0, 0, 0};
+
+    auto flow = [&]() -> Task<Result<uint8_t>> {
+        hal::pci::DoePayload request = {0x0u, 0xFFFFFFF0u};
+        auto response = co_await DoeExchange(doe, bdf, 0x100, hal::pci::DoeProtocolId{1, 0},
+                                             request, executor);
+        if (response.IsError()) {
+            co_return Result<uint8_t>::Err(response.Error());
+        }
+        hal::pci::CxlMailboxPayload payload = {static_cast<uint8_t>(response.Value()[1])};
+        auto command = co_await ExecuteCommand(mailbox, bdf, hal::pci::CxlMailboxOpcode::kIdentify,
+                                               payload, executor);
+        if (command.IsError()) {
+            co_return Result<uint8_t>::Err(command.Error());
+        }
+        co_return Result<uint8_t>::Ok(static_cast<uint8_t>(command.Value().payload[0] +
+                                                           command.Value().payload[1]));
+    };
+    auto result = SyncWait(flow(), executor);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), 0x0F + 0x01);
+
+    auto failed = SyncWait(ExecuteCommand(mailbox, bdf, uint16_t{0xFFFF}, {}, executor), executor);
+    ASSERT_TRUE(failed.IsError());
+    EXPECT_EQ(failed.Error(), make_error_code(ErrorCode::kTimeout));
+}
+
+TEST(CoroHalTest, PowerControlWrappers) {
+    core::Executor executor(Threads(1));
+    FakePower power;
+    auto sequence = [&]() -> Task<Result<void>> {
+        auto step = co_await SetVoltage(power, core::Voltage(3.3), executor);
+        if (step.IsOk()) {
+            step = co_await PowerOn(power, executor);
+        }
+        co_return step;
+    };
+    EXPECT_TRUE(SyncWait(sequence(), executor).IsOk());
+    EXPECT_EQ(power.Ops(), (std::vector<std::string>{"volts=3300", "on"}));
+}
+
+TEST(CoroHalTest, PowerTimelineRunsStepsAtTheirOffsets) {
+    core::Executor executor(Threads(1));
+    FakePower power;
+    std::vector<hal::PowerStep> timeline = {
+        hal::PowerStep::SetVoltage(core::Voltage(12.0)),
+        hal::PowerStep::PowerOn(),
+        hal::PowerStep::Delay(std::chrono::microseconds(5000)),
+        hal::PowerStep::PowerOff(),
+    };
+    auto report = SyncWait(
+        RunPowerTimeline(timeline, hal::PowerSequenceTarget{"slot0", &power, nullptr}, executor),
+        executor);
+    EXPECT_TRUE(report.completed);
+    EXPECT_EQ(report.name, "slot0");
+    ASSERT_EQ(report.steps.size(), 3u);
+    EXPECT_EQ(report.steps[2].step, 3u);
+    EXPECT_EQ(report.steps[2].scheduled_ns, 5000000u);
+    EXPECT_GE(report.steps[2].start_ns, 5000000u);
+    EXPECT_EQ(power.Ops(), (std::vector<std::string>{"volts=12000", "on", "off"}));
+}
+
+TEST(CoroHalTest, PowerTimelinesShareOneWorker) {
+    core::Executor executor(Threads(1));
+    constexpr int kSlots = 16;
+    std::vector<FakePower> slots(kSlots);
+    std::vector<hal::PowerStep> timeline = {
+        hal::PowerStep::PowerOn(),
+        hal::PowerStep::Delay(std::chrono::microseconds(30000)),
+        hal::PowerStep::PowerOff(),
+    };
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::future<hal::PowerSlotReport>> futures;
+    for (int i = 0; i < kSlots; ++i) {
+        hal::PowerSequenceTarget target{"slot" + std::to_string(i),
+                                        &slots[static_cast<size_t>(i)], nullptr};
+        futures.push_back(Spawn(RunPowerTimeline(timeline, target, executor), executor));
+    }
+    for (auto& future : futures) {
+        EXPECT_TRUE(future.get().completed);
+    }
+    // Sixteen 30 ms timelines on one worker overlap their delays.
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 300ms);
+}
+
+TEST(CoroHalTest, PowerTimelineStopsOnError) {
+    core::Executor executor(Threads(1));
+    FakePower power;
+    power.fail_on = "on";
+    std::vector<hal::PowerStep> timeline = {hal::PowerStep::PowerOn(),
+                                            hal::PowerStep::PowerOff()};
+    hal::PowerSequenceTarget target{"slot0", &power, nullptr};
+
+    auto stopped = SyncWait(RunPowerTimeline(timeline, target, executor), executor);
+    EXPECT_FALSE(stopped.completed);
+    EXPECT_EQ(stopped.error, make_error_code(ErrorCode::kIOError));
+    EXPECT_EQ(stopped.steps.size(), 1u);
+
+    auto carried_on = SyncWait(RunPowerTimeline(timeline, target, executor, false), executor);
+    EXPECT_FALSE(carried_on.completed);
+    EXPECT_EQ(carried_on.steps.size(), 2u);
+}
+
+TEST(CoroHalTest, PowerTimelineRejectsMissingInterface) {
+    core::Executor executor(Threads(1));
+    FakePower power;
+    std::vector<hal::PowerStep> timeline = {hal::PowerStep::PowerOn(),
+                                            hal::PowerStep::Perst(false)};
+    auto report = SyncWait(
+        RunPowerTimeline(timeline, hal::PowerSequenceTarget{"slot0", &power, nullptr}, executor),
+        executor);
+    EXPECT_EQ(report.error, make_error_code(ErrorCode::kInvalidArgument));
+    EXPECT_TRUE(report.steps.empty());
+    EXPECT_TRUE(power.Ops().empty());
+}
+
+}  // namespace
+}  // namespace plas::coro
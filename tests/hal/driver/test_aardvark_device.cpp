@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
 #include <atomic>
+#include <chrono>
+#include <future>
 #include <string>
 #include <thread>
 #include <vector>
@@ -10,7 +12,10 @@
 #include "plas/hal/driver/aardvark/aardvark_device.h"
 #include "plas/hal/interface/device.h"
 #include "plas/hal/interface/device_factory.h"
+#include "plas/hal/interface/gpio.h"
 #include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/smbus.h"
+#include "plas/hal/interface/spi.h"
 
 namespace plas::hal::driver {
 namespace {
@@ -88,6 +93,24 @@ TEST(AardvarkDeviceTest, I2cInterfaceName) {
     EXPECT_EQ(i2c->InterfaceName(), "I2c");
 }
 
+TEST(AardvarkDeviceTest, SmBusInterfaceName) {
+    auto entry = MakeEntry("dev0", "aardvark://0:0x50");
+    AardvarkDevice device(entry);
+    auto* smbus = static_cast<SmBus*>(&device);
+    EXPECT_EQ(smbus->InterfaceName(), "SmBus");
+    EXPECT_EQ(smbus->GetDevice(), static_cast<Device*>(&device));
+}
+
+TEST(AardvarkDeviceTest, SpiAndGpioInterfaces) {
+    AardvarkDevice device(MakeEntry("dev0", "aardvark://0:0x50"));
+    auto* spi = static_cast<Spi*>(&device);
+    auto* gpio = static_cast<Gpio*>(&device);
+    EXPECT_EQ(spi->InterfaceName(), "Spi");
+    EXPECT_EQ(gpio->InterfaceName(), "Gpio");
+    EXPECT_EQ(spi->GetDevice(), static_cast<Device*>(&device));
+    EXPECT_EQ(gpio->GetDevice(), static_cast<Device*>(&device));
+}
+
 TEST(AardvarkDeviceTest, GetUriReturnsUri) {
     auto entry = MakeEntry("dev0", "aardvark://1:0x68");
     AardvarkDevice device(entry);
@@ -219,6 +242,37 @@ TEST(AardvarkDeviceTest, WriteReadBeforeOpenFails) {
               core::make_error_code(core::ErrorCode::kNotInitialized));
 }
 
+TEST(AardvarkDeviceTest, SmBusBlockReadBeforeOpenFails) {
+    auto entry = MakeEntry("dev0", "aardvark://0:0x50");
+    AardvarkDevice device(entry);
+    device.Init();
+    core::Byte block[32];
+    auto result = device.BlockRead(0x50, 0x20, block, sizeof(block), true);
+    EXPECT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+}
+
+TEST(AardvarkDeviceTest, TransferBeforeOpenFails) {
+    auto entry = MakeEntry("dev0", "aardvark://0:0x50");
+    AardvarkDevice device(entry);
+    device.Init();
+    core::Byte reg = 0x00;
+    core::Byte rbuf[4];
+    I2cMessage msgs[2];
+    msgs[0].addr = 0x50;
+    msgs[0].data = &reg;
+    msgs[0].length = 1;
+    msgs[1].addr = 0x50;
+    msgs[1].data = rbuf;
+    msgs[1].length = sizeof(rbuf);
+    msgs[1].read = true;
+    auto result = device.Transfer(msgs, 2);
+    EXPECT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+}
+
 TEST(AardvarkDeviceTest, CloseBeforeOpenFails) {
     auto entry = MakeEntry("dev0", "aardvark://0:0x50");
     AardvarkDevice device(entry);
@@ -270,10 +324,189 @@ TEST(AardvarkDeviceTest, InvalidArgsIgnored) {
     EXPECT_EQ(device.GetBitrate(), 100000u);
 }
 
+TEST(AardvarkDeviceTest, SpiAndGpioArgsParsed) {
+    AardvarkDevice defaults(MakeEntry("dev0", "aardvark://0:0x50"));
+    EXPECT_EQ(defaults.GetClock().Value(), 1000000.0);
+    EXPECT_EQ(defaults.PinMask(), AardvarkDevice::kSpiPins);
+
+    AardvarkDevice custom(MakeEntry("dev1", "aardvark://0:0x50",
+                                    {{"spi_bitrate", "8000000"},
+                                     {"spi_mode", "3"},
+                                     {"gpio_pins", "0x03"}}));
+    EXPECT_EQ(custom.GetClock().Value(), 8000000.0);
+    EXPECT_EQ(custom.PinMask(), AardvarkDevice::kI2cPins);
+
+    AardvarkDevice invalid(MakeEntry("dev2", "aardvark://0:0x50",
+                                     {{"spi_bitrate", "20000000"},
+                                      {"spi_mode", "4"},
+                                      {"gpio_pins", "0x40"}}));
+    EXPECT_EQ(invalid.GetClock().Value(), 1000000.0);
+    EXPECT_EQ(invalid.PinMask(), AardvarkDevice::kSpiPins);
+}
+
+TEST(AardvarkDeviceTest, SpiClockAndModeRanges) {
+    AardvarkDevice device(MakeEntry("dev0", "aardvark://0:0x50"));
+    EXPECT_EQ(device.SetClock(core::Frequency(100000)).Error(),
+              core::make_error_code(core::ErrorCode::kOutOfRange));
+    EXPECT_EQ(device.SetClock(core::Frequency(9000000)).Error(),
+              core::make_error_code(core::ErrorCode::kOutOfRange));
+    ASSERT_TRUE(device.SetClock(core::Frequency(4000000)).IsOk());
+    EXPECT_EQ(device.GetClock().Value(), 4000000.0);
+    EXPECT_TRUE(device.SetMode(SpiMode::kMode3).IsOk());
+    EXPECT_EQ(device.SetMode(static_cast<SpiMode>(4)).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
+TEST(AardvarkDeviceTest, SpiAndGpioBeforeOpenFail) {
+    AardvarkDevice device(MakeEntry("dev0", "aardvark://0:0x50"));
+    device.Init();
+    core::Byte buf[4] = {};
+    auto not_init = core::make_error_code(core::ErrorCode::kNotInitialized);
+    EXPECT_EQ(device.Exchange(buf, buf, sizeof(buf)).Error(), not_init);
+    EXPECT_EQ(device.Command(SpiCommand{}).Error(), not_init);
+    EXPECT_EQ(device.WritePins(AardvarkDevice::kGpioSs, 0).Error(), not_init);
+    EXPECT_EQ(device.ReadPins().Error(), not_init);
+}
+
+TEST(AardvarkDeviceTest, AsyncDefaultsOff) {
+    AardvarkDevice device(MakeEntry("dev0", "aardvark://0:0x50"));
+    EXPECT_FALSE(device.IsAsyncEnabled());
+}
+
+TEST(AardvarkDeviceTest, AsyncArgEnables) {
+    AardvarkDevice on(
+        MakeEntry("dev0", "aardvark://0:0x50", {{"async", "true"}}));
+    AardvarkDevice off(
+        MakeEntry("dev1", "aardvark://0:0x51", {{"async", "maybe"}}));
+    EXPECT_TRUE(on.IsAsyncEnabled());
+    EXPECT_FALSE(off.IsAsyncEnabled());
+}
+
+TEST(AardvarkDeviceTest, PriorityDefaultsNormal) {
+    AardvarkDevice device(MakeEntry("dev0", "aardvark://0:0x50"));
+    EXPECT_EQ(device.GetPriority(), AardvarkDevice::Priority::kNormal);
+}
+
+TEST(AardvarkDeviceTest, PriorityArgParsed) {
+    AardvarkDevice high(
+        MakeEntry("dev0", "aardvark://0:0x50", {{"priority", "high"}}));
+    AardvarkDevice low(
+        MakeEntry("dev1", "aardvark://0:0x51", {{"priority", "low"}}));
+    AardvarkDevice bad(
+        MakeEntry("dev2", "aardvark://0:0x52", {{"priority", "urgent"}}));
+    EXPECT_EQ(high.GetPriority(), AardvarkDevice::Priority::kHigh);
+    EXPECT_EQ(low.GetPriority(), AardvarkDevice::Priority::kLow);
+    EXPECT_EQ(bad.GetPriority(), AardvarkDevice::Priority::kNormal);
+}
+
+TEST(AardvarkDeviceTest, BusWaitStatsStartEmpty) {
+    AardvarkDevice device(MakeEntry("dev0", "aardvark://0:0x50"));
+    auto stats = device.GetBusWaitStats();
+    EXPECT_EQ(stats.acquisitions, 0u);
+    EXPECT_EQ(stats.timeouts, 0u);
+    EXPECT_EQ(stats.total_us, 0u);
+}
+
+TEST(AardvarkDeviceTest, ReadAsyncBeforeOpenFails) {
+    AardvarkDevice device(
+        MakeEntry("dev0", "aardvark://0:0x50", {{"async", "true"}}));
+    device.Init();
+    core::Byte buf[4];
+    auto future = device.ReadAsync(0x50, buf, sizeof(buf));
+    auto result = future.get();
+    EXPECT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+}
+
 // ---------------------------------------------------------------------------
 // Bitrate
 // ---------------------------------------------------------------------------
 
+TEST(AardvarkDeviceTest, TargetBitratesArgParsed) {
+    AardvarkDevice device(MakeEntry(
+        "dev0", "aardvark://0:0x50",
+        {{"bitrate", "400000"},
+         {"target_bitrates", "0x48=100000,81=1000000,0x90=5,0x49=fast"}}));
+    EXPECT_EQ(device.GetTargetBitrate(0x48), 100000u);
+    EXPECT_EQ(device.GetTargetBitrate(0x51), 1000000u);
+    EXPECT_EQ(device.GetTargetBitrate(0x50), 400000u);  // not profiled
+    EXPECT_EQ(device.GetTargetBitrate(0x49), 400000u);  // malformed, skipped
+}
+
+TEST(AardvarkDeviceTest, ProbeBeforeOpenFails) {
+    AardvarkDevice device(MakeEntry("dev0", "aardvark://0:0x50"));
+    device.Init();
+    auto result = device.ProbeMaxBitrate(0x50);
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+}
+
+TEST(AardvarkDeviceTest, PlanBatchGroupsOwnersByBitrate) {
+    int a = 0;
+    int b = 0;
+    // a and b alternate between two clocks; each owner's order is kept.
+    std::vector<AardvarkDevice::QueuedOp> ops = {
+        {1, &a, 400000}, {1, &b, 100000}, {1, &a, 400000},
+        {1, &b, 100000}, {1, &a, 400000}, {1, &b, 100000},
+    };
+    auto order = AardvarkDevice::PlanBatch(ops, 100000);
+    EXPECT_EQ(order, (std::vector<size_t>{1, 3, 5, 0, 2, 4}));
+}
+
+TEST(AardvarkDeviceTest, PlanBatchKeepsOwnerOrderAcrossClocks) {
+    int mux = 0;
+    int other = 0;
+    // A mux select then a read behind it must not be swapped even though
+    // the read matches the current clock.
+    std::vector<AardvarkDevice::QueuedOp> ops = {
+        {1, &mux, 100000}, {1, &mux, 400000}, {1, &other, 100000},
+        {1, &mux, 0},  // Close() fence
+    };
+    auto order = AardvarkDevice::PlanBatch(ops, 100000);
+    EXPECT_EQ(order, (std::vector<size_t>{0, 2, 1, 3}));
+}
+
+TEST(AardvarkDeviceTest, PlanBatchRunsHigherPriorityFirst) {
+    int low = 0;
+    int high = 0;
+    std::vector<AardvarkDevice::QueuedOp> ops = {
+        {2, &low, 400000}, {0, &high, 100000}, {2, &low, 100000},
+        {0, &high, 400000},
+    };
+    auto order = AardvarkDevice::PlanBatch(ops, 400000);
+    // The low class starts at the clock the high class left the bus at.
+    EXPECT_EQ(order, (std::vector<size_t>{1, 3, 0, 2}));
+}
+
+TEST(AardvarkDeviceTest, PlanBatchGroupsByAdapterMode) {
+    int spi = 0;
+    int gpio = 0;
+    constexpr uint8_t kSpi = AardvarkDevice::kModeSpi;
+    // SPI transfers alternate with GPIO on the SPI pins, which needs SPI
+    // off; the bus is at I2C only, so the GPIO ops go first.
+    std::vector<AardvarkDevice::QueuedOp> ops = {
+        {1, &spi, 0, kSpi, 0}, {1, &gpio, 0, 0, kSpi},
+        {1, &spi, 0, kSpi, 0}, {1, &gpio, 0, 0, kSpi},
+    };
+    auto order = AardvarkDevice::PlanBatch(ops, 100000, AardvarkDevice::kModeI2c);
+    EXPECT_EQ(order, (std::vector<size_t>{1, 3, 0, 2}));
+}
+
+TEST(AardvarkDeviceTest, PlanBatchKeepsI2cWithSpi) {
+    int i2c = 0;
+    int spi = 0;
+    constexpr uint8_t kI2c = AardvarkDevice::kModeI2c;
+    constexpr uint8_t kSpi = AardvarkDevice::kModeSpi;
+    // Once SPI is on, I2C and SPI run side by side in submission order.
+    std::vector<AardvarkDevice::QueuedOp> ops = {
+        {1, &i2c, 100000, kI2c, 0}, {1, &spi, 0, kSpi, 0},
+        {1, &i2c, 100000, kI2c, 0}, {1, &spi, 0, kSpi, 0},
+    };
+    auto order = AardvarkDevice::PlanBatch(ops, 100000, kI2c | kSpi);
+    EXPECT_EQ(order, (std::vector<size_t>{0, 1, 2, 3}));
+}
+
 TEST(AardvarkDeviceTest, SetBitrateCaches) {
     auto entry = MakeEntry("dev0", "aardvark://0:0x50");
     AardvarkDevice device(entry);
@@ -483,6 +716,318 @@ TEST_F(AardvarkSharedBusTest, SetBitrateUpdatesSharedBus) {
     dev2.Close();
 }
 
+TEST_F(AardvarkSharedBusTest, ClockSwitchesOnlyBetweenTargetRates) {
+    AardvarkDevice dev(MakeEntry(
+        "dev1", "aardvark://0:0x50",
+        {{"target_bitrates", "0x50=400000,0x48=100000"}}));
+    ASSERT_TRUE(dev.Init().IsOk());
+    ASSERT_TRUE(dev.Open().IsOk());  // bus opens at bitrate = 100000
+
+    core::Byte buf[2] = {};
+    dev.Write(0x48, buf, sizeof(buf));  // already at 100 kHz
+    dev.Write(0x50, buf, sizeof(buf));  // -> 400 kHz
+    dev.Read(0x50, buf, sizeof(buf));
+    dev.WriteRead(0x48, buf, 1, buf, 1);  // -> 100 kHz
+    dev.Write(0x51, buf, sizeof(buf));    // default rate, no switch
+    EXPECT_EQ(dev.GetBusWaitStats().bitrate_switches, 2u);
+    dev.Close();
+}
+
+TEST_F(AardvarkSharedBusTest, SmBusRunsOnTheBusAtTargetRate) {
+    // SmBus transactions are scheduled like I2c ones and follow the
+    // target's clock; without the SDK they fail with kNotSupported.
+    AardvarkDevice dev(MakeEntry("dev1", "aardvark://0:0x50",
+                                 {{"target_bitrates", "0x50=400000"}}));
+    ASSERT_TRUE(dev.Init().IsOk());
+    ASSERT_TRUE(dev.Open().IsOk());
+
+    core::Byte block[SmBus::kMaxBlock];
+    auto read = dev.BlockRead(0x50, 0x20, block, sizeof(block), true);
+    ASSERT_TRUE(read.IsError());
+    EXPECT_EQ(read.Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    EXPECT_TRUE(dev.WriteWordData(0x50, 0x10, 0x1234).IsError());
+    EXPECT_EQ(dev.GetBusWaitStats().bitrate_switches, 1u);
+    EXPECT_EQ(dev.GetBusWaitStats().acquisitions, 2u);
+    dev.Close();
+}
+
+TEST_F(AardvarkSharedBusTest, DevicesWithDifferentBitratesShareBus) {
+    // Each device's transactions run at its own rate; the clock follows.
+    AardvarkDevice slow(
+        MakeEntry("slow", "aardvark://0:0x48", {{"bitrate", "100000"}}));
+    AardvarkDevice fast(
+        MakeEntry("fast", "aardvark://0:0x50", {{"bitrate", "400000"}}));
+    ASSERT_TRUE(slow.Init().IsOk());
+    ASSERT_TRUE(fast.Init().IsOk());
+    ASSERT_TRUE(slow.Open().IsOk());
+    ASSERT_TRUE(fast.Open().IsOk());
+
+    core::Byte buf[1] = {};
+    fast.Write(0x50, buf, 1);
+    fast.Write(0x50, buf, 1);
+    slow.Write(0x48, buf, 1);
+    EXPECT_EQ(fast.GetBusWaitStats().bitrate_switches, 1u);
+    EXPECT_EQ(slow.GetBusWaitStats().bitrate_switches, 1u);
+    fast.Close();
+    slow.Close();
+}
+
+TEST_F(AardvarkSharedBusTest, ProbeFailureKeepsConfiguredRate) {
+    AardvarkDevice dev(MakeEntry("dev1", "aardvark://0:0x50",
+                                 {{"target_bitrates", "0x50=400000"},
+                                  {"probe_bitrate", "true"}}));
+    ASSERT_TRUE(dev.Init().IsOk());
+    ASSERT_TRUE(dev.Open().IsOk());
+    EXPECT_EQ(dev.ProbeMaxBitrate(0x80).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    auto probed = dev.ProbeMaxBitrate(0x50);
+    if (probed.IsError()) {
+        // No adapter: nothing cached, the profile still applies.
+        EXPECT_EQ(dev.GetTargetBitrate(0x50), 400000u);
+    } else {
+        EXPECT_LE(probed.Value(), 400000u);
+        EXPECT_EQ(dev.GetTargetBitrate(0x50), probed.Value());
+    }
+    dev.Close();
+}
+
+TEST_F(AardvarkSharedBusTest, AsyncRejectsInvalidArguments) {
+    AardvarkDevice dev(
+        MakeEntry("dev1", "aardvark://0:0x50", {{"async", "true"}}));
+    ASSERT_TRUE(dev.Init().IsOk());
+    ASSERT_TRUE(dev.Open().IsOk());
+    core::Byte buf[2] = {};
+    auto r1 = dev.ReadAsync(0x50, nullptr, 2).get();
+    auto r2 = dev.WriteAsync(0x50, buf, 0).get();
+    auto r3 = dev.WriteReadAsync(0x50, buf, 1, nullptr, 1).get();
+    auto invalid = core::make_error_code(core::ErrorCode::kInvalidArgument);
+    EXPECT_EQ(r1.Error(), invalid);
+    EXPECT_EQ(r2.Error(), invalid);
+    EXPECT_EQ(r3.Error(), invalid);
+    dev.Close();
+}
+
+TEST_F(AardvarkSharedBusTest, AsyncRequestsCompleteOnSharedWorker) {
+    // Two async devices on one port feed the same queue; every future must
+    // resolve with the same outcome the blocking call gives.
+    AardvarkDevice dev1(
+        MakeEntry("dev1", "aardvark://0:0x50", {{"async", "true"}}));
+    AardvarkDevice dev2(
+        MakeEntry("dev2", "aardvark://0:0x51", {{"async", "true"}}));
+    ASSERT_TRUE(dev1.Init().IsOk());
+    ASSERT_TRUE(dev2.Init().IsOk());
+    ASSERT_TRUE(dev1.Open().IsOk());
+    ASSERT_TRUE(dev2.Open().IsOk());
+
+    core::Byte buf[4] = {};
+    auto expected = dev1.Read(0x50, buf, sizeof(buf));
+
+    std::vector<std::future<core::Result<size_t>>> futures;
+    for (int i = 0; i < 16; ++i) {
+        futures.push_back(dev1.WriteAsync(0x50, buf, sizeof(buf)));
+        futures.push_back(dev2.ReadAsync(0x51, buf, sizeof(buf)));
+    }
+    for (auto& f : futures) {
+        ASSERT_EQ(f.wait_for(std::chrono::seconds(5)),
+                  std::future_status::ready);
+        EXPECT_EQ(f.get().IsOk(), expected.IsOk());
+    }
+    dev2.Close();
+    dev1.Close();
+}
+
+TEST_F(AardvarkSharedBusTest, CloseWaitsForPendingAsyncRequests) {
+    AardvarkDevice dev(
+        MakeEntry("dev1", "aardvark://0:0x50", {{"async", "true"}}));
+    ASSERT_TRUE(dev.Init().IsOk());
+    ASSERT_TRUE(dev.Open().IsOk());
+
+    core::Byte buf[4] = {};
+    std::vector<std::future<core::Result<size_t>>> futures;
+    for (int i = 0; i < 64; ++i) {
+        futures.push_back(dev.WriteAsync(0x50, buf, sizeof(buf)));
+    }
+    ASSERT_TRUE(dev.Close().IsOk());
+    for (auto& f : futures) {
+        EXPECT_EQ(f.wait_for(std::chrono::seconds(0)),
+                  std::future_status::ready);
+    }
+}
+
+TEST_F(AardvarkSharedBusTest, AsyncDeviceJoinsSyncBus) {
+    // A sync device opens the bus first; an async device joining it later
+    // still gets a worker, and closing it leaves the sync device usable.
+    AardvarkDevice sync_dev(MakeEntry("dev1", "aardvark://0:0x50"));
+    AardvarkDevice async_dev(
+        MakeEntry("dev2", "aardvark://0:0x51", {{"async", "true"}}));
+    ASSERT_TRUE(sync_dev.Init().IsOk());
+    ASSERT_TRUE(async_dev.Init().IsOk());
+    ASSERT_TRUE(sync_dev.Open().IsOk());
+    ASSERT_TRUE(async_dev.Open().IsOk());
+
+    core::Byte buf[1] = {};
+    auto future = async_dev.WriteAsync(0x51, buf, 1);
+    EXPECT_EQ(future.wait_for(std::chrono::seconds(5)),
+              std::future_status::ready);
+    ASSERT_TRUE(async_dev.Close().IsOk());
+    EXPECT_EQ(sync_dev.GetState(), DeviceState::kOpen);
+    sync_dev.Close();
+}
+
+TEST_F(AardvarkSharedBusTest, BusWaitStatsCountTransactions) {
+    AardvarkDevice dev(MakeEntry("dev1", "aardvark://0:0x50",
+                                 {{"max_wait_ms", "1000"}}));
+    ASSERT_TRUE(dev.Init().IsOk());
+    ASSERT_TRUE(dev.Open().IsOk());
+
+    core::Byte buf[2] = {};
+    for (int i = 0; i < 5; ++i) {
+        dev.Write(0x50, buf, sizeof(buf));
+    }
+    auto stats = dev.GetBusWaitStats();
+    EXPECT_EQ(stats.acquisitions, 5u);
+    EXPECT_EQ(stats.timeouts, 0u);
+    EXPECT_GE(stats.max_us, stats.last_us);
+    EXPECT_GE(stats.total_us, stats.max_us);
+
+    dev.ResetBusWaitStats();
+    EXPECT_EQ(dev.GetBusWaitStats().acquisitions, 0u);
+    dev.Close();
+}
+
+TEST_F(AardvarkSharedBusTest, ModeSwitchesOnlyWhenFunctionsConflict) {
+    // Without the SDK the transfers fail, but the adapter mode is tracked.
+    AardvarkDevice dev(MakeEntry("dev1", "aardvark://0:0x50"));
+    AardvarkDevice pins(MakeEntry("dev2", "aardvark://0:0x51",
+                                  {{"gpio_pins", "0x03"}}));
+    ASSERT_TRUE(dev.Init().IsOk());
+    ASSERT_TRUE(pins.Init().IsOk());
+    ASSERT_TRUE(dev.Open().IsOk());  // I2C, SPI pins as GPIO
+    ASSERT_TRUE(pins.Open().IsOk());
+
+    core::Byte buf[4] = {};
+    auto not_supported = core::make_error_code(core::ErrorCode::kNotSupported);
+    dev.Write(0x50, buf, sizeof(buf));
+    EXPECT_EQ(dev.WritePins(AardvarkDevice::kGpioSs, 0).Error(), not_supported);
+    EXPECT_EQ(dev.GetBusWaitStats().mode_switches, 0u);
+
+    EXPECT_EQ(dev.Exchange(buf, buf, sizeof(buf)).Error(), not_supported);  // + SPI
+    dev.Write(0x50, buf, sizeof(buf));                                       // I2C + SPI
+    dev.WritePins(AardvarkDevice::kGpioSs, 0);                               // - SPI
+    dev.Exchange(buf, nullptr, sizeof(buf));                                 // + SPI
+    EXPECT_EQ(dev.GetBusWaitStats().mode_switches, 3u);
+
+    EXPECT_EQ(pins.ReadPins().Error(), not_supported);  // - I2C
+    EXPECT_EQ(pins.GetBusWaitStats().mode_switches, 1u);
+    dev.Exchange(buf, nullptr, sizeof(buf));  // SPI only already
+    dev.Read(0x50, buf, sizeof(buf));         // + I2C
+    EXPECT_EQ(dev.GetBusWaitStats().mode_switches, 4u);
+    pins.Close();
+    dev.Close();
+}
+
+TEST_F(AardvarkSharedBusTest, SpiFramesAndGpioPinsValidated) {
+    AardvarkDevice dev(MakeEntry("dev1", "aardvark://0:0x50"));
+    ASSERT_TRUE(dev.Init().IsOk());
+    ASSERT_TRUE(dev.Open().IsOk());
+
+    std::vector<core::Byte> big(AardvarkDevice::kSpiMaxTransfer);
+    core::Byte buf[4] = {};
+    auto invalid = core::make_error_code(core::ErrorCode::kInvalidArgument);
+    auto not_supported = core::make_error_code(core::ErrorCode::kNotSupported);
+
+    // A held chip select only buffers; nothing can be read before it ends.
+    EXPECT_EQ(dev.Exchange(buf, nullptr, sizeof(buf), false).Value(), sizeof(buf));
+    EXPECT_EQ(dev.Exchange(nullptr, buf, sizeof(buf), false).Error(), not_supported);
+    EXPECT_EQ(dev.Exchange(buf, nullptr, 2, false).Value(), 2u);
+    EXPECT_EQ(dev.Exchange(big.data(), nullptr, big.size()).Error(), invalid);
+    EXPECT_EQ(dev.GetBusWaitStats().acquisitions, 0u);
+
+    SpiCommand read;
+    read.opcode = 0x03;
+    read.address_bytes = 3;
+    read.read = big.data();
+    read.length = big.size() - 3;
+    EXPECT_EQ(dev.Command(read).Error(), invalid);  // frame over 64 KiB
+    read.length = 16;
+    read.lines = SpiLines::kDual;
+    EXPECT_EQ(dev.Command(read).Error(), not_supported);
+    read.lines = SpiLines::kSingle;
+    EXPECT_EQ(dev.Command(read).Error(), not_supported);  // no SDK
+    EXPECT_EQ(dev.GetBusWaitStats().acquisitions, 1u);
+
+    EXPECT_EQ(dev.SetDirection(AardvarkDevice::kGpioScl, 0xFF).Error(), invalid);
+    EXPECT_EQ(dev.WritePins(0x40, 0).Error(), invalid);
+    dev.Close();
+}
+
+TEST_F(AardvarkSharedBusTest, AsyncSpiAndGpioRunOnSharedWorker) {
+    AardvarkDevice dev(
+        MakeEntry("dev1", "aardvark://0:0x50", {{"async", "true"}}));
+    ASSERT_TRUE(dev.Init().IsOk());
+    ASSERT_TRUE(dev.Open().IsOk());
+    core::Byte buf[4] = {};
+    auto not_supported = core::make_error_code(core::ErrorCode::kNotSupported);
+    EXPECT_EQ(dev.Exchange(buf, buf, sizeof(buf)).Error(), not_supported);
+    EXPECT_EQ(dev.SetDirection(AardvarkDevice::kGpioSs, AardvarkDevice::kGpioSs).Error(),
+              not_supported);
+    EXPECT_EQ(dev.GetBusWaitStats().acquisitions, 2u);
+    EXPECT_EQ(dev.GetBusWaitStats().mode_switches, 2u);
+    dev.Close();
+}
+
+TEST_F(AardvarkSharedBusTest, ArgumentErrorsDoNotTakeBusTurn) {
+    AardvarkDevice dev(MakeEntry("dev1", "aardvark://0:0x50"));
+    ASSERT_TRUE(dev.Init().IsOk());
+    ASSERT_TRUE(dev.Open().IsOk());
+    dev.Read(0x50, nullptr, 4);
+    EXPECT_EQ(dev.GetBusWaitStats().acquisitions, 0u);
+    dev.Close();
+}
+
+TEST_F(AardvarkSharedBusTest, MixedPriorityClientsAllServed) {
+    // High- and low-priority clients hammering one port, sync and async,
+    // must all be granted the bus exactly once per transaction.
+    AardvarkDevice high(MakeEntry("tele", "aardvark://0:0x50",
+                                  {{"priority", "high"}}));
+    AardvarkDevice low(MakeEntry("dump", "aardvark://0:0x51",
+                                 {{"priority", "low"}, {"async", "true"}}));
+    ASSERT_TRUE(high.Init().IsOk());
+    ASSERT_TRUE(low.Init().IsOk());
+    ASSERT_TRUE(high.Open().IsOk());
+    ASSERT_TRUE(low.Open().IsOk());
+
+    const int kOps = 50;
+    std::thread bulk([&low] {
+        core::Byte buf[8] = {};
+        std::vector<std::future<core::Result<size_t>>> futures;
+        for (int i = 0; i < kOps; ++i) {
+            futures.push_back(low.WriteAsync(0x51, buf, sizeof(buf)));
+        }
+        for (auto& f : futures) {
+            f.wait();
+        }
+    });
+    std::thread telemetry([&high] {
+        core::Byte buf[2] = {};
+        for (int i = 0; i < kOps; ++i) {
+            high.Read(0x50, buf, sizeof(buf));
+        }
+    });
+    bulk.join();
+    telemetry.join();
+
+    EXPECT_EQ(high.GetBusWaitStats().acquisitions,
+              static_cast<uint64_t>(kOps));
+    EXPECT_EQ(low.GetBusWaitStats().acquisitions,
+              static_cast<uint64_t>(kOps));
+    EXPECT_EQ(high.GetBusWaitStats().timeouts, 0u);
+    EXPECT_EQ(low.GetBusWaitStats().timeouts, 0u);
+    low.Close();
+    high.Close();
+}
+
 TEST_F(AardvarkSharedBusTest, ConcurrentOpenSamePort) {
     // 8 threads simultaneously Opening devices on port 0 must not corrupt the
     // registry (no crash, all succeed via shared bus state).
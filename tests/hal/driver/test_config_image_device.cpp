@@ -0,0 +1,365 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/core/error.h"
+#include "plas/hal/driver/image/config_image_bundle.h"
+#include "plas/hal/driver/image/config_image_device.h"
+#include "plas/hal/interface/device_factory.h"
+#include "plas/hal/interface/pci/cxl.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+
+namespace plas::hal::driver {
+namespace {
+
+using Image = std::array<core::Byte, pci::kConfigSpaceSize>;
+
+constexpr pci::Bdf kCxlBdf{0x3a, 0x00, 0x0};
+constexpr pci::Bdf kNicBdf{0x01, 0x00, 0x1};
+constexpr pci::ConfigOffset kDoeOffset = 0x180;
+constexpr pci::DoeProtocolId kCma{pci::doe_vendor::kPciSig, pci::doe_type::kCma};
+
+void Put32(Image& image, std::size_t offset, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        image[offset + static_cast<std::size_t>(i)] = static_cast<core::Byte>(value >> (8 * i));
+    }
+}
+
+/// A CXL type 3 function: PCIe capability, CXL Device and Register Locator
+/// DVSECs, and a DOE mailbox.
+Image CxlImage() {
+    Image image{};
+    Put32(image, 0x00, 0x0D938086);
+    Put32(image, 0x04, 0x00100000);  // status: capabilities list
+    image[0x34] = 0x40;
+    Put32(image, 0x40, 0x00020010);                           // PCIe, no next
+    Put32(image, 0x100, 0x0023 | (1u << 16) | (0x140u << 20));  // DVSEC
+    Put32(image, 0x104, 0x1E98 | (1u << 16) | (0x38u << 20));
+    Put32(image, 0x108, 0x00040000);                          // CXL Device, mem capable
+    Put32(image, 0x140, 0x0023 | (1u << 16) | (0x180u << 20));  // DVSEC
+    Put32(image, 0x144, 0x1E98 | (0x14u << 20));
+    Put32(image, 0x148, 0x0008);                              // Register Locator
+    Put32(image, 0x14C, 0x00010100);                          // component regs, BAR 0
+    Put32(image, 0x180, 0x002E | (1u << 16));                 // DOE, no next
+    return image;
+}
+
+/// `lspci -xxx`-style dump of the first `size` bytes.
+std::string Dump(const std::string& title, const Image& image, std::size_t size) {
+    std::string text = title + "\n";
+    char buf[8];
+    for (std::size_t row = 0; row < size; row += 16) {
+        std::snprintf(buf, sizeof(buf), "%02zx:", row);
+        text += buf;
+        for (std::size_t i = 0; i < 16; ++i) {
+            std::snprintf(buf, sizeof(buf), " %02x", image[row + i]);
+            text += buf;
+        }
+        text += "\n";
+    }
+    return text;
+}
+
+std::string FleetText() {
+    Image nic{};
+    Put32(nic, 0x00, 0x15B38086);
+    return Dump("0000:3a:00.0 CXL: Intel Corporation Device 0d93", CxlImage(), 0x200) +
+           "doe 180 0001:01 00000001 00000002 -> cafe0001 cafe0002\n"
+           "doe 180 0001:01 00000003 -> 0000000a\n" +
+           Dump("01:00.1 Ethernet controller: Intel Corporation", nic, 0x40) +
+           // A second copy of a captured address is ignored.
+           Dump("0000:01:00.1 Ethernet controller: duplicate", Image{}, 0x40) +
+           Dump("0001:00:00.0 Host bridge: other domain", nic, 0x40);
+}
+
+std::string WriteFile(const std::string& name, const std::string& contents) {
+    std::string path = ::testing::TempDir() + name;
+    std::ofstream(path, std::ios::binary) << contents;
+    return path;
+}
+
+std::unique_ptr<Device> Open(const std::string& uri, const std::string& bundle) {
+    auto created = DeviceFactory::Make<ConfigImageDevice>(
+        config::DeviceEntry{"fleet", uri, "image", {{"bundle", bundle}}},
+        config::DeviceUri::Parse(uri));
+    EXPECT_TRUE(created->Init().IsOk());
+    EXPECT_TRUE(created->Open().IsOk());
+    return created;
+}
+
+TEST(ConfigImageBundleTest, ParsesLspciTextInAddressOrder) {
+    auto bundle = ConfigImageBundle::ParseText(FleetText());
+    ASSERT_EQ(bundle->FunctionCount(), 3u);
+    EXPECT_FALSE(bundle->IsMapped());
+
+    auto nic = bundle->FunctionAt(0);
+    EXPECT_EQ(nic.address, (pci::PciAddress{0, kNicBdf}));
+    EXPECT_EQ(nic.size, 0x40u);
+    EXPECT_EQ(nic.config[0], 0x86);  // the first copy, not the duplicate
+    EXPECT_EQ(bundle->FunctionAt(1).address, (pci::PciAddress{0, kCxlBdf}));
+    EXPECT_EQ(bundle->FunctionAt(2).address, (pci::PciAddress{1, pci::Bdf{0, 0, 0}}));
+
+    auto cxl = bundle->Find(pci::PciAddress{0, kCxlBdf});
+    ASSERT_TRUE(cxl.has_value());
+    EXPECT_EQ(cxl->size, 0x200u);
+    ASSERT_EQ(cxl->doe_count, 2u);
+    auto doe = bundle->DoeAt(cxl->doe_begin);
+    EXPECT_EQ(doe.doe_offset, kDoeOffset);
+    EXPECT_EQ(doe.protocol, kCma);
+    ASSERT_EQ(doe.request_dwords, 2u);
+    ASSERT_EQ(doe.response_dwords, 2u);
+    EXPECT_EQ(doe.RequestDWord(1), 0x00000002u);
+    EXPECT_EQ(doe.ResponseDWord(0), 0xCAFE0001u);
+    EXPECT_FALSE(bundle->Find(pci::PciAddress{0, pci::Bdf{0x3a, 0, 1}}).has_value());
+}
+
+TEST(ConfigImageBundleTest, BinaryBundleIsMappedAndValidated) {
+    auto parsed = ConfigImageBundle::ParseText(FleetText());
+    std::string path = ::testing::TempDir() + "fleet.plascfgi";
+    ASSERT_TRUE(parsed->Save(path).IsOk());
+
+    auto loaded = ConfigImageBundle::Load(path);
+    ASSERT_TRUE(loaded.IsOk());
+    const auto& bundle = *loaded.Value();
+    EXPECT_TRUE(bundle.IsMapped());
+    EXPECT_EQ(bundle.SizeBytes(), parsed->SizeBytes());
+    ASSERT_EQ(bundle.FunctionCount(), parsed->FunctionCount());
+    for (std::size_t i = 0; i < bundle.FunctionCount(); ++i) {
+        auto a = bundle.FunctionAt(i);
+        auto b = parsed->FunctionAt(i);
+        EXPECT_EQ(a.address, b.address);
+        EXPECT_EQ(std::string(a.config, a.config + a.size),
+                  std::string(b.config, b.config + b.size));
+    }
+    EXPECT_EQ(bundle.DoeCount(), 2u);
+
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto truncated = ConfigImageBundle::Load(
+        WriteFile("truncated.plascfgi", bytes.substr(0, bytes.size() - 1)));
+    EXPECT_EQ(truncated.Error(), core::ErrorCode::kDataLoss);
+    EXPECT_EQ(ConfigImageBundle::Load(WriteFile("empty.txt", "no devices here\n")).Error(),
+              core::ErrorCode::kDataLoss);
+    EXPECT_EQ(ConfigImageBundle::Load(::testing::TempDir() + "missing.plascfgi").Error(),
+              core::ErrorCode::kNotFound);
+}
+
+/// Mutated text and binary bundles must never crash or yield records that
+/// point outside the bundle.
+TEST(ConfigImageBundleTest, SurvivesMutatedInput) {
+    const std::string text = FleetText();
+    std::string binary;
+    {
+        std::string path = ::testing::TempDir() + "fuzz.plascfgi";
+        ASSERT_TRUE(ConfigImageBundle::ParseText(text)->Save(path).IsOk());
+        std::ifstream in(path, std::ios::binary);
+        binary.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    auto next = [&state] {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    auto check = [](const ConfigImageBundle& bundle) {
+        for (std::size_t i = 0; i < bundle.FunctionCount(); ++i) {
+            auto f = bundle.FunctionAt(i);
+            ASSERT_LE(f.size, pci::kConfigSpaceSize);
+            if (i > 0) {
+                auto prev = bundle.FunctionAt(i - 1).address;
+                ASSERT_TRUE(prev.domain < f.address.domain ||
+                            (prev.domain == f.address.domain &&
+                             prev.bdf.Pack() < f.address.bdf.Pack()));
+            }
+            for (std::size_t d = 0; d < f.doe_count; ++d) {
+                auto doe = bundle.DoeAt(f.doe_begin + d);
+                for (std::size_t j = 0; j < doe.response_dwords; ++j) {
+                    (void)doe.ResponseDWord(j);
+                }
+            }
+        }
+    };
+
+    std::string path = ::testing::TempDir() + "mutated.plascfgi";
+    for (int round = 0; round < 500; ++round) {
+        std::string t = text;
+        std::string b = binary;
+        for (int i = 0; i < 8; ++i) {
+            t[next() % t.size()] = static_cast<char>(next());
+            b[next() % b.size()] = static_cast<char>(next());
+        }
+        check(*ConfigImageBundle::ParseText(t));
+        auto loaded = ConfigImageBundle::Load(WriteFile("mutated.plascfgi", b));
+        if (loaded.IsOk()) {
+            check(*loaded.Value());
+        } else {
+            EXPECT_EQ(loaded.Error(), core::ErrorCode::kDataLoss);
+        }
+    }
+    std::remove(path.c_str());
+}
+
+TEST(ConfigImageDeviceTest, ConfigReadsFollowSimConventions) {
+    auto device = Open("image://pci:0000", WriteFile("fleet.txt", FleetText()));
+    EXPECT_EQ(device->GetDriverName(), "image");
+    auto* config = dynamic_cast<pci::PciConfig*>(device.get());
+    ASSERT_NE(config, nullptr);
+
+    EXPECT_EQ(config->ReadConfig32(kCxlBdf, 0x00).Value(), 0x0D938086u);
+    EXPECT_EQ(config->ReadConfig16(kNicBdf, 0x02).Value(), 0x15B3);
+    EXPECT_EQ(config->ReadConfig32(kNicBdf, 0x100).Value(), 0u);  // past the image
+    EXPECT_EQ(config->ReadConfig32(pci::Bdf{0x02, 0, 0}, 0x00).Value(), 0xFFFFFFFFu);
+    EXPECT_EQ(config->ReadConfig32(kCxlBdf, 0x02).Error(), core::ErrorCode::kInvalidArgument);
+    EXPECT_EQ(config->WriteConfig16(kCxlBdf, 0x04, 0x0006).Error(),
+              core::ErrorCode::kNotSupported);
+
+    auto snapshot = config->SnapshotConfig(kCxlBdf);
+    ASSERT_TRUE(snapshot.IsOk());
+    EXPECT_EQ(snapshot.Value()[0x180], 0x2E);
+    EXPECT_EQ(snapshot.Value()[0x200], 0x00);
+
+    // Domain 1 is another device.
+    auto other = Open("image://pci:0001", WriteFile("fleet.txt", FleetText()));
+    EXPECT_EQ(dynamic_cast<pci::PciConfig*>(other.get())
+                  ->ReadConfig16(pci::Bdf{0, 0, 0}, 0x02)
+                  .Value(),
+              0x15B3);
+
+    ASSERT_TRUE(device->Close().IsOk());
+    EXPECT_EQ(config->ReadConfig32(kCxlBdf, 0x00).Error(), core::ErrorCode::kNotInitialized);
+}
+
+TEST(ConfigImageDeviceTest, InitRejectsBadUriAndMissingBundle) {
+    std::string bundle = WriteFile("fleet.txt", FleetText());
+    auto bad_uri = DeviceFactory::Make<ConfigImageDevice>(
+        config::DeviceEntry{"x", "image://pci:zz", "image", {{"bundle", bundle}}},
+        config::DeviceUri::Parse("image://pci:zz"));
+    EXPECT_EQ(bad_uri->Init().Error(), core::ErrorCode::kInvalidArgument);
+
+    auto missing = DeviceFactory::Make<ConfigImageDevice>(
+        config::DeviceEntry{"x", "image://pci:0000", "image",
+                            {{"bundle", ::testing::TempDir() + "no_such_bundle"}}},
+        config::DeviceUri::Parse("image://pci:0000"));
+    EXPECT_EQ(missing->Init().Error(), core::ErrorCode::kNotFound);
+}
+
+TEST(ConfigImageDeviceTest, CapabilitiesAndCxlDvsecsComeFromTheImage) {
+    auto device = Open("image://pci:0000", WriteFile("fleet.txt", FleetText()));
+    auto* config = dynamic_cast<pci::PciConfig*>(device.get());
+    auto* cxl = dynamic_cast<pci::Cxl*>(device.get());
+    ASSERT_NE(cxl, nullptr);
+
+    EXPECT_EQ(config->FindCapability(kCxlBdf, pci::CapabilityId::kPciExpress).Value(),
+              pci::ConfigOffset{0x40});
+    EXPECT_EQ(config->FindExtCapability(kCxlBdf, pci::ExtCapabilityId::kDoe).Value(),
+              kDoeOffset);
+    EXPECT_EQ(config->GetCapabilityIndex(kCxlBdf).Value().FindAll(
+                  pci::ExtCapabilityId::kDvsec).size(),
+              2u);
+    EXPECT_FALSE(config->FindCapability(pci::Bdf{0x02, 0, 0}, pci::CapabilityId::kPciExpress)
+                     .Value()
+                     .has_value());
+
+    auto dvsecs = cxl->EnumerateCxlDvsecs(kCxlBdf);
+    ASSERT_TRUE(dvsecs.IsOk());
+    ASSERT_EQ(dvsecs.Value().size(), 2u);
+    EXPECT_EQ(dvsecs.Value()[1].dvsec_id, pci::CxlDvsecId::kRegisterLocator);
+    EXPECT_EQ(cxl->GetCxlDeviceType(kCxlBdf).Value(), pci::CxlDeviceType::kType3);
+    auto blocks = cxl->GetRegisterBlocks(kCxlBdf);
+    ASSERT_TRUE(blocks.IsOk());
+    ASSERT_EQ(blocks.Value().size(), 1u);
+    EXPECT_EQ(blocks.Value()[0].block_id, pci::CxlRegisterBlockId::kComponentRegister);
+    EXPECT_EQ(blocks.Value()[0].offset, 0x10000u);
+    EXPECT_EQ(cxl->ReadDvsecRegister(kCxlBdf, 0x100, 0x08).Value(), 0x00040000u);
+    EXPECT_EQ(cxl->ReadDvsecRegister(kCxlBdf, 0xFFC, 0x04).Error(),
+              core::ErrorCode::kOutOfRange);
+    EXPECT_EQ(cxl->WriteDvsecRegister(kCxlBdf, 0x100, 0x0C, 0).Error(),
+              core::ErrorCode::kNotSupported);
+
+    EXPECT_TRUE(cxl->EnumerateCxlDvsecs(kNicBdf).Value().empty());
+    EXPECT_EQ(cxl->GetCxlDeviceType(pci::Bdf{0x02, 0, 0}).Error(), core::ErrorCode::kNotFound);
+}
+
+TEST(ConfigImageDeviceTest, DoeAnswersFromCannedResponses) {
+    auto device = Open("image://pci:0000", WriteFile("fleet.txt", FleetText()));
+    auto* doe = dynamic_cast<pci::PciDoe*>(device.get());
+    ASSERT_NE(doe, nullptr);
+
+    auto protocols = doe->DoeDiscover(kCxlBdf, kDoeOffset);
+    ASSERT_TRUE(protocols.IsOk());
+    ASSERT_EQ(protocols.Value().size(), 2u);
+    EXPECT_EQ(protocols.Value()[1], kCma);
+    EXPECT_EQ(doe->DoeDiscover(kCxlBdf, 0x100).Error(), core::ErrorCode::kNotFound);
+    EXPECT_EQ(doe->DoeDiscover(pci::Bdf{0x02, 0, 0}, kDoeOffset).Error(),
+              core::ErrorCode::kNotFound);
+
+    auto response = doe->DoeExchange(kCxlBdf, kDoeOffset, kCma, {1, 2});
+    ASSERT_TRUE(response.IsOk());
+    EXPECT_EQ(response.Value(), (pci::DoePayload{0xCAFE0001, 0xCAFE0002}));
+    EXPECT_EQ(doe->DoeExchange(kCxlBdf, kDoeOffset, kCma, {3}).Value(),
+              pci::DoePayload{0x0A});
+    EXPECT_EQ(doe->DoeExchange(kCxlBdf, kDoeOffset, kCma, {1}).Error(),
+              core::ErrorCode::kNotFound);
+    EXPECT_EQ(doe->DoeExchange(kCxlBdf, kDoeOffset, {0x1E98, 0x02}, {1}).Error(),
+              core::ErrorCode::kNotSupported);
+
+    // Discovery walk: index 1 is CMA, last entry.
+    const pci::DoeProtocolId discovery{pci::doe_vendor::kPciSig, pci::doe_type::kDoeDiscovery};
+    EXPECT_EQ(doe->DoeExchange(kCxlBdf, kDoeOffset, discovery, {1}).Value(),
+              pci::DoePayload{0x00010001});
+
+    core::DWord out[1];
+    const core::DWord request[] = {1, 2};
+    EXPECT_EQ(doe->DoeExchangeInto(kCxlBdf, kDoeOffset, kCma, request, 2, out, 1).Error(),
+              core::ErrorCode::kOverflow);
+    EXPECT_EQ(doe->DoeExchangeInto(kCxlBdf, kDoeOffset, kCma, request, 1, out, 1).Error(),
+              core::ErrorCode::kNotFound);
+}
+
+TEST(ConfigImageDeviceTest, ServesAnInMemoryBundleToParallelReaders) {
+    auto bundle = ConfigImageBundle::ParseText(FleetText());
+    ConfigImageDevice device(config::DeviceEntry{"fleet", "image://pci:0000", "image", {}},
+                             bundle, 0);
+    ASSERT_TRUE(device.Init().IsOk());
+    ASSERT_TRUE(device.Open().IsOk());
+    EXPECT_EQ(device.GetBundle(), bundle);
+
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(4, 0);
+    for (std::size_t t = 0; t < mismatches.size(); ++t) {
+        threads.emplace_back([&device, &mismatches, t] {
+            for (int i = 0; i < 2000; ++i) {
+                auto type = device.GetCxlDeviceType(kCxlBdf);
+                auto id = device.ReadConfig32(kCxlBdf, 0x00);
+                if (type.IsError() || type.Value() != pci::CxlDeviceType::kType3 ||
+                    id.IsError() || id.Value() != 0x0D938086u) {
+                    ++mismatches[t];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int count : mismatches) {
+        EXPECT_EQ(count, 0);
+    }
+}
+
+}  // namespace
+}  // namespace plas::hal::driver
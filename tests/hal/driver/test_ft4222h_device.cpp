@@ -6,6 +6,8 @@
 #include "plas/hal/interface/device.h"
 #include "plas/hal/interface/device_factory.h"
 #include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/smbus.h"
+#include "plas/hal/interface/spi.h"
 
 namespace plas::hal::driver {
 namespace {
@@ -83,6 +85,14 @@ TEST(Ft4222hDeviceTest, I2cInterfaceName) {
     EXPECT_EQ(i2c->InterfaceName(), "I2c");
 }
 
+TEST(Ft4222hDeviceTest, SmBusInterfaceName) {
+    auto entry = MakeEntry("dev0", "ft4222h://0:1");
+    Ft4222hDevice device(entry);
+    auto* smbus = static_cast<SmBus*>(&device);
+    EXPECT_EQ(smbus->InterfaceName(), "SmBus");
+    EXPECT_EQ(smbus->GetDevice(), static_cast<Device*>(&device));
+}
+
 TEST(Ft4222hDeviceTest, GetUriReturnsUri) {
     auto entry = MakeEntry("dev0", "ft4222h://2:3");
     Ft4222hDevice device(entry);
@@ -186,6 +196,38 @@ TEST(Ft4222hDeviceTest, InitFailsWithOverflowIndex) {
     EXPECT_TRUE(result.IsError());
 }
 
+TEST(Ft4222hDeviceTest, InitSucceedsWithSerialNumbersAndLocations) {
+    for (const char* uri : {"ft4222h://sn=FT5ZK1A:sn=FT5ZK1B", "ft4222h://loc=0x1011:loc=0x1012",
+                            "ft4222h://sn=FT5ZK1A:4114", "ft4222h://0:loc=0"}) {
+        Ft4222hDevice device(MakeEntry("dev0", uri));
+        EXPECT_TRUE(device.Init().IsOk()) << uri;
+    }
+}
+
+TEST(Ft4222hDeviceTest, InitFailsWithBadSelectors) {
+    for (const char* uri : {"ft4222h://sn=FT5ZK1A:sn=FT5ZK1A", "ft4222h://loc=16:loc=0x10",
+                            "ft4222h://sn=:1", "ft4222h://sn=0123456789ABCDEF:1",
+                            "ft4222h://loc=zz:1", "ft4222h://loc=0x100000000:1",
+                            "ft4222h://serial=FT5ZK1A:1"}) {
+        Ft4222hDevice device(MakeEntry("dev0", uri));
+        EXPECT_EQ(device.Init().Error(), core::ErrorCode::kInvalidArgument) << uri;
+    }
+}
+
+TEST(Ft4222hDeviceTest, ListDevicesNeedsTheSdk) {
+#ifndef PLAS_HAS_FT4222H
+    EXPECT_EQ(Ft4222hDevice::ListDevices().Error(), core::ErrorCode::kNotSupported);
+    EXPECT_EQ(Ft4222hDevice::EnumerationCount(), 0u);
+#else
+    // Enumerated once, then shared.
+    auto first = Ft4222hDevice::ListDevices();
+    auto count = Ft4222hDevice::EnumerationCount();
+    auto second = Ft4222hDevice::ListDevices();
+    EXPECT_EQ(Ft4222hDevice::EnumerationCount(), count);
+    EXPECT_EQ(first.IsOk(), second.IsOk());
+#endif
+}
+
 // ---------------------------------------------------------------------------
 // State transitions
 // ---------------------------------------------------------------------------
@@ -234,6 +276,37 @@ TEST(Ft4222hDeviceTest, WriteReadBeforeOpenFails) {
               core::make_error_code(core::ErrorCode::kNotInitialized));
 }
 
+TEST(Ft4222hDeviceTest, SmBusBlockReadBeforeOpenFails) {
+    auto entry = MakeEntry("dev0", "ft4222h://0:1");
+    Ft4222hDevice device(entry);
+    device.Init();
+    core::Byte block[32];
+    auto result = device.BlockRead(0x50, 0x20, block, sizeof(block), true);
+    EXPECT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+}
+
+TEST(Ft4222hDeviceTest, TransferBeforeOpenFails) {
+    auto entry = MakeEntry("dev0", "ft4222h://0:1");
+    Ft4222hDevice device(entry);
+    device.Init();
+    core::Byte reg = 0x00;
+    core::Byte rbuf[4];
+    I2cMessage msgs[2];
+    msgs[0].addr = 0x50;
+    msgs[0].data = &reg;
+    msgs[0].length = 1;
+    msgs[1].addr = 0x50;
+    msgs[1].data = rbuf;
+    msgs[1].length = sizeof(rbuf);
+    msgs[1].read = true;
+    auto result = device.Transfer(msgs, 2);
+    EXPECT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+}
+
 TEST(Ft4222hDeviceTest, CloseBeforeOpenFails) {
     auto entry = MakeEntry("dev0", "ft4222h://0:1");
     Ft4222hDevice device(entry);
@@ -291,6 +364,19 @@ TEST(Ft4222hDeviceTest, InvalidArgsIgnored) {
     EXPECT_EQ(device.GetBitrate(), 400000u);
 }
 
+TEST(Ft4222hDeviceTest, RxEventInactiveBeforeOpen) {
+    Ft4222hDevice device(MakeEntry("dev0", "ft4222h://0:1"));
+    ASSERT_TRUE(device.Init().IsOk());
+    EXPECT_FALSE(device.IsRxEventActive());
+}
+
+TEST(Ft4222hDeviceTest, RxEventDisabledArgAccepted) {
+    Ft4222hDevice device(
+        MakeEntry("dev0", "ft4222h://0:1", {{"rx_event", "false"}}));
+    ASSERT_TRUE(device.Init().IsOk());
+    EXPECT_FALSE(device.IsRxEventActive());
+}
+
 // ---------------------------------------------------------------------------
 // Bitrate
 // ---------------------------------------------------------------------------
@@ -359,5 +445,136 @@ TEST(Ft4222hDeviceTest, ResetFromInitialized) {
     EXPECT_EQ(device.GetState(), DeviceState::kInitialized);
 }
 
+// ---------------------------------------------------------------------------
+// Spi
+// ---------------------------------------------------------------------------
+
+TEST(Ft4222hDeviceTest, SpiInterfaceName) {
+    Ft4222hDevice device(MakeEntry("dev0", "ft4222h://0:1"));
+    auto* spi = static_cast<Spi*>(&device);
+    EXPECT_EQ(spi->InterfaceName(), "Spi");
+    EXPECT_EQ(spi->GetDevice(), static_cast<Device*>(&device));
+}
+
+TEST(Ft4222hDeviceTest, SpiClockDefaultsToThirtyMhz) {
+    Ft4222hDevice device(MakeEntry("dev0", "ft4222h://0:1"));
+    EXPECT_EQ(device.GetClock().Value(), 30000000.0);  // 60 MHz / 2
+}
+
+TEST(Ft4222hDeviceTest, SpiClockRoundsDownToDivider) {
+    Ft4222hDevice device(MakeEntry("dev0", "ft4222h://0:1",
+                                   {{"sys_clock", "80"}, {"spi_clock", "15000000"}}));
+    EXPECT_EQ(device.GetClock().Value(), 10000000.0);  // 80 MHz / 8
+
+    ASSERT_TRUE(device.SetClock(core::Frequency(25000000)).IsOk());
+    EXPECT_EQ(device.GetClock().Value(), 20000000.0);
+    EXPECT_EQ(device.SetClock(core::Frequency(100000)).Error(),
+              core::ErrorCode::kOutOfRange);  // below 80 MHz / 512
+    EXPECT_EQ(device.GetClock().Value(), 20000000.0);
+}
+
+TEST(Ft4222hDeviceTest, SpiIndexMustDifferFromI2cIndices) {
+    Ft4222hDevice device(MakeEntry("dev0", "ft4222h://0:1", {{"spi_index", "1"}}));
+    EXPECT_EQ(device.Init().Error(), core::ErrorCode::kInvalidArgument);
+
+    Ft4222hDevice ok(MakeEntry("dev0", "ft4222h://0:1", {{"spi_index", "2"}}));
+    EXPECT_TRUE(ok.Init().IsOk());
+
+    Ft4222hDevice same_serial(MakeEntry("dev0", "ft4222h://sn=FT5ZK1A:sn=FT5ZK1B",
+                                        {{"spi_index", "sn=FT5ZK1B"}}));
+    EXPECT_EQ(same_serial.Init().Error(), core::ErrorCode::kInvalidArgument);
+
+    Ft4222hDevice by_serial(MakeEntry("dev0", "ft4222h://sn=FT5ZK1A:sn=FT5ZK1B",
+                                      {{"spi_index", "sn=FT5ZK1C"}}));
+    EXPECT_TRUE(by_serial.Init().IsOk());
+}
+
+TEST(Ft4222hDeviceTest, SpiBeforeOpenFails) {
+    Ft4222hDevice device(MakeEntry("dev0", "ft4222h://0:1", {{"spi_index", "2"}}));
+    ASSERT_TRUE(device.Init().IsOk());
+    core::Byte buf[4] = {};
+    EXPECT_EQ(device.Exchange(buf, buf, sizeof(buf)).Error(),
+              core::ErrorCode::kNotInitialized);
+
+    SpiCommand read;
+    read.opcode = 0x03;
+    read.address_bytes = 3;
+    read.read = buf;
+    read.length = sizeof(buf);
+    EXPECT_EQ(device.Command(read).Error(), core::ErrorCode::kNotInitialized);
+}
+
+TEST(Ft4222hDeviceTest, SpiModeArgAndSetMode) {
+    Ft4222hDevice device(MakeEntry("dev0", "ft4222h://0:1", {{"spi_mode", "3"}}));
+    EXPECT_TRUE(device.SetMode(SpiMode::kMode0).IsOk());
+    EXPECT_EQ(device.SetMode(static_cast<SpiMode>(4)).Error(),
+              core::ErrorCode::kInvalidArgument);
+}
+
+TEST(Ft4222hDeviceTest, SpiChunkIsWholeUsbPackets) {
+    EXPECT_EQ(Ft4222hDevice::kSpiChunkSize % 512, 0u);
+    EXPECT_LE(Ft4222hDevice::kSpiChunkSize, 0xFFFFu);
+}
+
+// ---------------------------------------------------------------------------
+// USB tuning
+// ---------------------------------------------------------------------------
+
+TEST(Ft4222hDeviceTest, UsbTuningProfilesAndPinnedArgs) {
+    Ft4222hDevice plain(MakeEntry("dev0", "ft4222h://0:1"));
+    EXPECT_EQ(plain.GetUsbTuning().latency_ms, 2u);  // register profile
+    EXPECT_EQ(plain.GetUsbTuning().transfer_size, 4096u);
+
+    Ft4222hDevice untouched(MakeEntry("dev0", "ft4222h://0:1", {{"usb_tuning", "default"}}));
+    EXPECT_EQ(untouched.GetUsbTuning().latency_ms, 0u);
+    EXPECT_EQ(untouched.GetUsbTuning().transfer_size, 0u);
+
+    Ft4222hDevice bulk(MakeEntry("dev0", "ft4222h://0:1",
+                                 {{"usb_tuning", "bulk"},
+                                  {"usb_latency_ms", "4"},
+                                  {"usb_transfer_size", "1000"},  // not a multiple of 64
+                                  {"usb_timeout_ms", "250"}}));
+    EXPECT_EQ(bulk.GetUsbTuning().latency_ms, 4u);
+    EXPECT_EQ(bulk.GetUsbTuning().transfer_size, 65536u);
+    EXPECT_EQ(bulk.GetUsbTuning().timeout_ms, 250u);
+}
+
+TEST(Ft4222hDeviceTest, SelectUsbTuningFollowsTheMix) {
+    auto idle = Ft4222hDevice::SelectUsbTuning({}, 400000);
+    EXPECT_EQ(idle.latency_ms, 2u);
+    EXPECT_EQ(idle.timeout_ms, 0u);
+
+    // Register reads: shortest latency timer.
+    Ft4222hWorkload registers{1000, 5, 5 * 256, 256};
+    auto small = Ft4222hDevice::SelectUsbTuning(registers, 400000);
+    EXPECT_EQ(small.latency_ms, 2u);
+    EXPECT_EQ(small.transfer_size, 512u);
+    EXPECT_EQ(small.timeout_ms, 100u + 4u * (256u * 9u * 1000u / 400000u + 1u));
+
+    // Streaming: default latency, requests sized to the transfers.
+    Ft4222hWorkload stream{1, 100, 100 * 20000, 20000};
+    auto bulk = Ft4222hDevice::SelectUsbTuning(stream, 1000000);
+    EXPECT_EQ(bulk.latency_ms, 16u);
+    EXPECT_EQ(bulk.transfer_size, 20480u);
+    EXPECT_EQ(bulk.transfer_size % 64, 0u);
+
+    Ft4222hWorkload huge{0, 1, 1u << 20, 1u << 20};
+    EXPECT_EQ(Ft4222hDevice::SelectUsbTuning(huge, 100000).transfer_size, 65536u);
+    EXPECT_EQ(Ft4222hDevice::SelectUsbTuning(huge, 1).timeout_ms, 60000u);
+}
+
+TEST(Ft4222hDeviceTest, CalibrateUsbKeepsPinnedValues) {
+    Ft4222hDevice device(MakeEntry("dev0", "ft4222h://0:1", {{"usb_timeout_ms", "500"}}));
+    Ft4222hWorkload stream{0, 10, 10 * 4000, 4000};
+    auto result = device.CalibrateUsb(stream);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value().latency_ms, 16u);
+    EXPECT_EQ(result.Value().transfer_size, 4096u);
+    EXPECT_EQ(result.Value().timeout_ms, 500u);
+    EXPECT_EQ(device.GetUsbTuning().transfer_size, 4096u);
+
+    EXPECT_EQ(device.GetWorkload().small_transfers, 0u);
+}
+
 }  // namespace
 }  // namespace plas::hal::driver
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "plas/config/device_entry.h"
+#include "plas/core/error.h"
+#include "plas/hal/driver/i3cdev/i3cdev_device.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_factory.h"
+#include "plas/hal/interface/i3c.h"
+
+namespace plas::hal::driver {
+namespace {
+
+namespace fs = std::filesystem;
+
+// Helper to build a DeviceEntry for the i3cdev driver.
+config::DeviceEntry MakeEntry(
+    const std::string& nickname, const std::string& uri,
+    const std::map<std::string, std::string>& args = {}) {
+    return config::DeviceEntry{nickname, uri, "i3cdev", args};
+}
+
+// ---------------------------------------------------------------------------
+// Fake sysfs tree: bus i3c-0 with two targets, as left by the kernel's DAA
+// ---------------------------------------------------------------------------
+
+class I3cDevSysfsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root_ = fs::temp_directory_path() /
+                ("plas_i3cdev_" + std::to_string(::getpid()));
+        fs::remove_all(root_);
+        fs::create_directories(root_ / "i3c-0");
+        WriteAttr("i3c-0", "i3c_scl_frequency", "12500000");
+        AddTarget("0-4cc51180000", "4cc51180000", "7", "51", "08");
+        AddTarget("0-4cc51180001", "4cc51180001", "27", "51", "09");
+        AddTarget("1-4cc51180002", "4cc51180002", "7", "51", "08");  // bus 1
+    }
+
+    void TearDown() override { fs::remove_all(root_); }
+
+    void WriteAttr(const std::string& dir, const std::string& name,
+                   const std::string& value) {
+        std::ofstream(root_ / dir / name) << value << "\n";
+    }
+
+    void AddTarget(const std::string& dir, const std::string& pid,
+                   const std::string& bcr, const std::string& dcr,
+                   const std::string& addr) {
+        fs::create_directories(root_ / dir);
+        WriteAttr(dir, "pid", pid);
+        WriteAttr(dir, "bcr", bcr);
+        WriteAttr(dir, "dcr", dcr);
+        WriteAttr(dir, "dynamic_address", addr);
+    }
+
+    config::DeviceEntry Entry(const std::string& uri) {
+        return MakeEntry("hub", uri, {{"sysfs_root", root_.string()},
+                                      {"dev_root", (root_ / "dev").string()}});
+    }
+
+    fs::path root_;
+};
+
+TEST(I3cDevFactoryTest, CreateFromConfig) {
+    I3cDevDevice::Register();
+    auto result = DeviceFactory::CreateFromConfig(MakeEntry("hub", "i3cdev://0:all"));
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_NE(dynamic_cast<I3c*>(result.Value().get()), nullptr);
+    EXPECT_EQ(result.Value()->GetDriverName(), "i3cdev");
+}
+
+TEST(I3cDevDeviceTest, RejectsBadUris) {
+    for (const char* uri : {"i3cdev://0", "i3cdev://x:all", "i3cdev://0:zz",
+                            "i3cdev://0:1000000000000", "aardvark://0:all"}) {
+        I3cDevDevice device(MakeEntry("hub", uri));
+        EXPECT_TRUE(device.Init().IsError()) << uri;
+    }
+    I3cDevDevice device(MakeEntry("hub", "i3cdev://0:4cc51180000"));
+    EXPECT_TRUE(device.Init().IsOk());
+}
+
+TEST(I3cDevDeviceTest, OperationsRequireOpen) {
+    I3cDevDevice device(MakeEntry("hub", "i3cdev://0:all"));
+    core::Byte buf[2] = {};
+    EXPECT_EQ(device.Read(0x08, buf, 2).Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    EXPECT_EQ(device.RecvDirectCcc(i3c_ccc::kGetbcr, 0x08, buf, 1).Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    EXPECT_EQ(device.GetTargets().Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    EXPECT_EQ(device.Open().Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+}
+
+TEST_F(I3cDevSysfsTest, OpenCachesBusTargetTable) {
+    I3cDevDevice device(Entry("i3cdev://0:all"));
+    ASSERT_TRUE(device.Init().IsOk());
+    ASSERT_TRUE(device.Open().IsOk());
+    EXPECT_EQ(device.GetFrequency(), core::Frequency(12500000.0));
+
+    auto targets = device.GetTargets();
+    ASSERT_TRUE(targets.IsOk());
+    ASSERT_EQ(targets.Value().size(), 2u);  // bus 1 target excluded
+    EXPECT_EQ(targets.Value()[0].dynamic_address, 0x08u);
+    EXPECT_EQ(targets.Value()[0].pid, 0x4cc51180000ull);
+    EXPECT_EQ(targets.Value()[1].bcr, 0x27);
+    EXPECT_TRUE(targets.Value()[1].HdrCapable());
+
+    // GET CCCs come from the cache, even after sysfs changes.
+    WriteAttr("0-4cc51180001", "bcr", "0");
+    core::Byte buf[6] = {};
+    auto bcr = device.RecvDirectCcc(i3c_ccc::kGetbcr, 0x09, buf, sizeof(buf));
+    ASSERT_TRUE(bcr.IsOk());
+    EXPECT_EQ(bcr.Value(), 1u);
+    EXPECT_EQ(buf[0], 0x27);
+    auto pid = device.RecvDirectCcc(i3c_ccc::kGetpid, 0x08, buf, sizeof(buf));
+    ASSERT_TRUE(pid.IsOk());
+    EXPECT_EQ(buf[0], 0x04);
+    EXPECT_EQ(buf[1], 0xcc);
+    EXPECT_EQ(device.RecvDirectCcc(i3c_ccc::kGetdcr, 0x0A, buf, 1).Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+
+    EXPECT_EQ(device.SendDirectCcc(i3c_ccc::kSetmrl, 0x08, buf, 2).Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    EXPECT_EQ(device.SetFrequency(core::Frequency(1e6)).Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    EXPECT_TRUE(device.Close().IsOk());
+}
+
+TEST_F(I3cDevSysfsTest, EntdaaPicksUpHotJoinedTargets) {
+    I3cDevDevice device(Entry("i3cdev://0:all"));
+    ASSERT_TRUE(device.Init().IsOk());
+    ASSERT_TRUE(device.Open().IsOk());
+
+    AddTarget("0-4cc51180005", "4cc51180005", "6", "51", "0a");
+    auto added = device.AssignDynamicAddresses();
+    ASSERT_TRUE(added.IsOk());
+    EXPECT_EQ(added.Value(), 1u);
+    EXPECT_EQ(device.AssignDynamicAddresses().Value(), 0u);  // already cached
+
+    AddTarget("0-4cc51180006", "4cc51180006", "6", "51", "0b");
+    ASSERT_TRUE(device.SendBroadcastCcc(i3c_ccc::kEntdaa, nullptr, 0).IsOk());
+    EXPECT_EQ(device.GetTargets().Value().size(), 4u);
+    EXPECT_EQ(device.SendBroadcastCcc(i3c_ccc::kRstdaa, nullptr, 0).Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+}
+
+TEST_F(I3cDevSysfsTest, SingleTargetUri) {
+    I3cDevDevice device(Entry("i3cdev://0:4cc51180001"));
+    ASSERT_TRUE(device.Init().IsOk());
+    ASSERT_TRUE(device.Open().IsOk());
+    auto targets = device.GetTargets().Value();
+    ASSERT_EQ(targets.size(), 1u);
+    EXPECT_EQ(targets[0].dynamic_address, 0x09u);
+
+    I3cDevDevice missing(Entry("i3cdev://0:4cc511800ff"));
+    ASSERT_TRUE(missing.Init().IsOk());
+    EXPECT_EQ(missing.Open().Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+}
+
+TEST_F(I3cDevSysfsTest, MissingBusFailsOpen) {
+    I3cDevDevice device(Entry("i3cdev://3:all"));
+    ASSERT_TRUE(device.Init().IsOk());
+    EXPECT_EQ(device.Open().Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+    EXPECT_EQ(device.GetState(), DeviceState::kInitialized);
+}
+
+TEST_F(I3cDevSysfsTest, TransfersValidateTarget) {
+    I3cDevDevice device(Entry("i3cdev://0:all"));
+    ASSERT_TRUE(device.Init().IsOk());
+    ASSERT_TRUE(device.Open().IsOk());
+    core::Byte buf[4] = {};
+    EXPECT_EQ(device.Read(0x30, buf, 4).Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+    EXPECT_EQ(device.Write(0x30, buf, 4, false).Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+    EXPECT_EQ(device.Read(0x08, buf, 0).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    // A held write is accepted without touching the bus.
+    auto held = device.Write(0x08, buf, 2, false);
+    ASSERT_TRUE(held.IsOk());
+    EXPECT_EQ(held.Value(), 2u);
+    // No i3cdev node in the fake tree: the transfer itself fails.
+    EXPECT_TRUE(device.Read(0x08, buf, 4).IsError());
+}
+
+TEST_F(I3cDevSysfsTest, HdrAndIbiAreNotExposed) {
+    I3cDevDevice device(Entry("i3cdev://0:all"));
+    ASSERT_TRUE(device.Init().IsOk());
+    ASSERT_TRUE(device.Open().IsOk());
+    core::Byte buf[4] = {};
+    EXPECT_EQ(device.HdrDdrRead(0x09, 0x80, buf, 4).Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    I3cIbiQueue queue(4);
+    I3cIbiOptions options;
+    options.queue = &queue;
+    EXPECT_EQ(device.StartIbi(options).Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    EXPECT_FALSE(device.IsIbiActive());
+}
+
+}  // namespace
+}  // namespace plas::hal::driver
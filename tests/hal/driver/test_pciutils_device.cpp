@@ -5,6 +5,8 @@
 #include "plas/hal/driver/pciutils/pciutils_device.h"
 #include "plas/hal/interface/device.h"
 #include "plas/hal/interface/device_factory.h"
+#include "plas/hal/interface/pci/cxl.h"
+#include "plas/hal/interface/pci/cxl_mailbox.h"
 #include "plas/hal/interface/pci/pci_bar.h"
 #include "plas/hal/interface/pci/pci_config.h"
 #include "plas/hal/interface/pci/pci_doe.h"
@@ -51,6 +53,22 @@ TEST_F(PciUtilsFactoryTest, SupportsPciDoeInterface) {
     EXPECT_NE(pci_doe, nullptr);
 }
 
+TEST_F(PciUtilsFactoryTest, SupportsCxlInterface) {
+    auto entry = MakeEntry("cxl0", "pciutils://0000:03:00.0");
+    auto result = DeviceFactory::CreateFromConfig(entry);
+    ASSERT_TRUE(result.IsOk());
+    auto* cxl = dynamic_cast<pci::Cxl*>(result.Value().get());
+    EXPECT_NE(cxl, nullptr);
+}
+
+TEST_F(PciUtilsFactoryTest, SupportsCxlMailboxInterface) {
+    auto entry = MakeEntry("cxl0", "pciutils://0000:03:00.0");
+    auto result = DeviceFactory::CreateFromConfig(entry);
+    ASSERT_TRUE(result.IsOk());
+    auto* mailbox = dynamic_cast<pci::CxlMailbox*>(result.Value().get());
+    EXPECT_NE(mailbox, nullptr);
+}
+
 // ---------------------------------------------------------------------------
 // Initial state
 // ---------------------------------------------------------------------------
@@ -172,6 +190,67 @@ TEST(PciUtilsDeviceTest, ReadConfigBeforeOpenFails) {
               core::make_error_code(core::ErrorCode::kNotInitialized));
 }
 
+TEST(PciUtilsDeviceTest, ReadConfigBlockBeforeOpenFails) {
+    auto entry = MakeEntry("dev0", "pciutils://0000:03:00.0");
+    PciUtilsDevice device(entry);
+    device.Init();
+    pci::Bdf bdf{0x03, 0x00, 0x00};
+    auto result = device.SnapshotConfig(bdf);
+    EXPECT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+}
+
+TEST(PciUtilsDeviceTest, DoeExchangeIntoBeforeOpenFails) {
+    auto entry = MakeEntry("dev0", "pciutils://0000:03:00.0");
+    PciUtilsDevice device(entry);
+    device.Init();
+    pci::Bdf bdf{0x03, 0x00, 0x00};
+    core::DWord response[4] = {};
+    auto result = device.DoeExchangeInto(bdf, 0x150, {0x0001, 0x01}, nullptr,
+                                         0, response, 4);
+    EXPECT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+}
+
+TEST(PciUtilsDeviceTest, CxlBeforeOpenFails) {
+    auto entry = MakeEntry("dev0", "pciutils://0000:03:00.0");
+    PciUtilsDevice device(entry);
+    device.Init();
+    pci::Bdf bdf{0x03, 0x00, 0x00};
+    auto dvsecs = device.EnumerateCxlDvsecs(bdf);
+    EXPECT_TRUE(dvsecs.IsError());
+    EXPECT_EQ(dvsecs.Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    auto type = device.GetCxlDeviceType(bdf);
+    EXPECT_TRUE(type.IsError());
+    EXPECT_EQ(type.Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    // Range is checked before anything touches config space.
+    auto reg = device.ReadDvsecRegister(bdf, 0xFF0, 0x0C + 4);
+    EXPECT_TRUE(reg.IsError());
+    EXPECT_EQ(reg.Error(),
+              core::make_error_code(core::ErrorCode::kOutOfRange));
+}
+
+TEST(PciUtilsDeviceTest, CxlMailboxBeforeOpenFails) {
+    auto entry = MakeEntry("dev0", "pciutils://0000:03:00.0",
+                           {{"mailbox_timeout_ms", "50"}});
+    PciUtilsDevice device(entry);
+    device.Init();
+    pci::Bdf bdf{0x03, 0x00, 0x00};
+    auto result = device.ExecuteCommand(
+        bdf, pci::CxlMailboxOpcode::kGetHealthInfo, {});
+    EXPECT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    auto mailbox = device.GetCxlMailbox(bdf);
+    EXPECT_TRUE(mailbox.IsError());
+    EXPECT_EQ(mailbox.Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+}
+
 TEST(PciUtilsDeviceTest, OpenBeforeInitFails) {
     auto entry = MakeEntry("dev0", "pciutils://0000:03:00.0");
     PciUtilsDevice device(entry);
@@ -181,6 +260,33 @@ TEST(PciUtilsDeviceTest, OpenBeforeInitFails) {
               core::make_error_code(core::ErrorCode::kNotInitialized));
 }
 
+TEST(PciUtilsDeviceTest, BarAccessBeforeOpenFails) {
+    auto entry = MakeEntry("dev0", "pciutils://0000:03:00.0");
+    PciUtilsDevice device(entry);
+    device.Init();
+    pci::Bdf bdf{0x03, 0x00, 0x00};
+    auto read = device.BarRead32(bdf, 0, 0x00);
+    EXPECT_TRUE(read.IsError());
+    EXPECT_EQ(read.Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    auto map_all = device.MapAllBars();
+    EXPECT_TRUE(map_all.IsError());
+    EXPECT_EQ(map_all.Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+}
+
+TEST(PciUtilsDeviceTest, SetBarMappingRejectsBadIndex) {
+    auto entry = MakeEntry("dev0", "pciutils://0000:03:00.0");
+    PciUtilsDevice device(entry);
+    device.Init();
+    pci::Bdf bdf{0x03, 0x00, 0x00};
+    auto result =
+        device.SetBarMapping(bdf, 6, pci::BarMapping::kWriteCombining);
+    EXPECT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
 // ---------------------------------------------------------------------------
 // DOE args parsing
 // ---------------------------------------------------------------------------
@@ -210,6 +316,71 @@ TEST(PciUtilsDeviceTest, InvalidDoeArgsIgnored) {
     EXPECT_EQ(device.GetState(), DeviceState::kUninitialized);
 }
 
+TEST(PciUtilsDeviceTest, DoeSpinArgAccepted) {
+    auto entry = MakeEntry("dev0", "pciutils://0000:03:00.0",
+                           {{"doe_spin_us", "0"},
+                            {"doe_poll_interval_us", "50"}});
+    PciUtilsDevice device(entry);
+    EXPECT_EQ(device.GetState(), DeviceState::kUninitialized);
+}
+
+TEST(PciUtilsDeviceTest, BarMappingArgsAccepted) {
+    auto entry = MakeEntry("dev0", "pciutils://0000:03:00.0",
+                           {{"wc_bars", "2,x,9,4"},
+                            {"map_bars_on_open", "true"}});
+    PciUtilsDevice device(entry);
+    EXPECT_EQ(device.GetState(), DeviceState::kUninitialized);
+}
+
+TEST(PciUtilsDeviceTest, ScanOnOpenArgAccepted) {
+    auto entry = MakeEntry("dev0", "pciutils://0000:03:00.0",
+                           {{"scan_on_open", "true"}});
+    PciUtilsDevice device(entry);
+    EXPECT_EQ(device.GetState(), DeviceState::kUninitialized);
+}
+
+TEST(PciUtilsDeviceTest, NotScannedBeforeOpen) {
+    auto entry = MakeEntry("dev0", "pciutils://0000:03:00.0",
+                           {{"scan_on_open", "1"}});
+    PciUtilsDevice device(entry);
+    ASSERT_TRUE(device.Init().IsOk());
+    EXPECT_FALSE(device.IsScanned());
+    EXPECT_TRUE(device.GetScannedFunctions().empty());
+}
+
+TEST(PciUtilsDeviceTest, UnknownAccessMethodFailsOpen) {
+    auto entry = MakeEntry("dev0", "pciutils://0000:03:00.0",
+                           {{"access_method", "no-such-method"}});
+    PciUtilsDevice device(entry);
+    ASSERT_TRUE(device.Init().IsOk());
+    auto result = device.Open();
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
+TEST(PciUtilsDeviceTest, AnyDomainConfigBeforeOpenFails) {
+    auto entry = MakeEntry("dev0", "pciutils://0000:03:00.0");
+    PciUtilsDevice device(entry);
+    pci::PciAddress other{0x0001, pci::Bdf{0x80, 0, 0}};
+    auto read = device.ReadConfig32(other, 0x00);
+    ASSERT_TRUE(read.IsError());
+    EXPECT_EQ(read.Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    EXPECT_TRUE(device.WriteConfig16(other, 0x04, 0).IsError());
+}
+
+TEST(PciUtilsDeviceTest, DoeStatsStartEmpty) {
+    auto entry = MakeEntry("dev0", "pciutils://0000:03:00.0");
+    PciUtilsDevice device(entry);
+    auto stats = device.GetDoeStats();
+    EXPECT_EQ(stats.exchanges, 0u);
+    EXPECT_EQ(stats.timeouts, 0u);
+    EXPECT_EQ(stats.total_us, 0u);
+    device.ResetDoeStats();
+    EXPECT_EQ(device.GetDoeStats().max_us, 0u);
+}
+
 // ---------------------------------------------------------------------------
 // URI edge cases
 // ---------------------------------------------------------------------------
@@ -1,12 +1,17 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "plas/config/device_entry.h"
 #include "plas/hal/driver/pciutils/pciutils_device.h"
 #include "plas/hal/interface/pci/pci_config.h"
 #include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/interface/pci/pci_topology.h"
 #include "plas/hal/interface/pci/types.h"
 
 namespace plas::hal::driver {
@@ -73,6 +78,41 @@ TEST_F(PciUtilsIntegrationTest, ReadVendorAndDeviceId) {
                 device_id.Value());
 }
 
+TEST_F(PciUtilsIntegrationTest, ReadsStayValidAcrossConcurrentRescans) {
+    auto expected = device_->ReadConfig16(bdf_, 0x00);
+    ASSERT_TRUE(expected.IsOk());
+
+    // Every topology change drops the cached pci_dev handles while the
+    // readers may be mid-access through them (run under ASan to see a
+    // use-after-free if one were freed too early). Dropped handles are
+    // freed as the accesses finish, so the cache does not grow.
+    const auto baseline = device_->MemoryUsage();
+    std::atomic<bool> stop{false};
+    std::thread rescanner([&] {
+        while (!stop.load()) {
+            pci::PciTopology::NotifyTopologyChanged();
+            std::this_thread::yield();
+        }
+    });
+    std::vector<std::thread> readers;
+    std::atomic<int> mismatches{0};
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            for (int i = 0; i < 2000; ++i) {
+                auto vendor = device_->ReadConfig16(bdf_, 0x00);
+                if (vendor.IsError() || vendor.Value() != expected.Value()) {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+    for (auto& reader : readers) reader.join();
+    stop = true;
+    rescanner.join();
+    EXPECT_EQ(mismatches.load(), 0);
+    EXPECT_EQ(device_->MemoryUsage(), baseline);
+}
+
 TEST_F(PciUtilsIntegrationTest, ReadConfig32_ClassCode) {
     auto rev_class = device_->ReadConfig32(bdf_, 0x08);
     ASSERT_TRUE(rev_class.IsOk());
@@ -134,5 +174,36 @@ TEST_F(PciUtilsIntegrationTest, DoeDiscover) {
     EXPECT_FALSE(protocols.Value().empty());
 }
 
+TEST_F(PciUtilsIntegrationTest, ScanOnOpenMatchesSnapshot) {
+    config::DeviceEntry entry{"integ_scan", uri_, "pciutils",
+                              {{"scan_on_open", "true"}}};
+    PciUtilsDevice scanned(entry);
+    ASSERT_TRUE(scanned.Init().IsOk());
+    ASSERT_TRUE(scanned.Open().IsOk());
+    ASSERT_TRUE(scanned.IsScanned());
+
+    auto functions = scanned.GetScannedFunctions();
+    std::printf("  Functions scanned: %zu\n", functions.size());
+    auto self = std::find_if(functions.begin(), functions.end(),
+                             [&](const auto& f) {
+                                 return f.address.bdf == bdf_;
+                             });
+    ASSERT_NE(self, functions.end());
+
+    auto vendor = device_->ReadConfig16(bdf_, 0x00);
+    ASSERT_TRUE(vendor.IsOk());
+    EXPECT_EQ(self->vendor_id, vendor.Value());
+
+    auto from_scan = scanned.GetCapabilityIndex(bdf_);
+    auto from_snapshot = device_->GetCapabilityIndex(bdf_);
+    ASSERT_TRUE(from_scan.IsOk());
+    ASSERT_TRUE(from_snapshot.IsOk());
+    EXPECT_EQ(from_scan.Value().capabilities,
+              from_snapshot.Value().capabilities);
+    EXPECT_EQ(from_scan.Value().ext_capabilities,
+              from_snapshot.Value().ext_capabilities);
+    scanned.Close();
+}
+
 }  // namespace
 }  // namespace plas::hal::driver
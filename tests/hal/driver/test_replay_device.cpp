@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/core/error.h"
+#include "plas/hal/driver/replay/replay_device.h"
+#include "plas/hal/driver/sim/sim_device.h"
+#include "plas/hal/interface/device_factory.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/pci/pci_bar.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/transaction_trace.h"
+
+namespace plas::hal::driver {
+namespace {
+
+config::DeviceEntry MakeEntry(const std::string& nickname, const std::string& uri,
+                              const std::string& driver,
+                              const std::map<std::string, std::string>& args = {}) {
+    return config::DeviceEntry{nickname, uri, driver, args};
+}
+
+constexpr pci::Bdf kBdf{0x03, 0x00, 0x0};
+
+/// Records a short session against sim devices: an EEPROM (with a 2 ms
+/// latency) and a PCI function with a DOE mailbox.
+class ReplayDeviceTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        ReplayDevice::Register();
+        path_ = ::testing::TempDir() + "replay_session.plastrace";
+        auto writer = TraceWriter::Open(path_).Value();
+
+        auto eeprom = RecordTransactions(
+            std::make_unique<SimI2cDevice>(
+                MakeEntry("eeprom", "sim://i2c:0x50", "sim", {{"latency_us", "2000"}})),
+            writer);
+        ASSERT_TRUE(eeprom->Init().IsOk());
+        ASSERT_TRUE(eeprom->Open().IsOk());
+        auto* i2c = dynamic_cast<I2c*>(eeprom.get());
+        const core::Byte write[] = {0x00, 0x11, 0x22, 0x33};
+        ASSERT_TRUE(i2c->Write(0x50, write, sizeof(write)).IsOk());
+        const core::Byte reg = 0x00;
+        core::Byte buf[3] = {};
+        ASSERT_TRUE(i2c->WriteRead(0x50, &reg, 1, buf, 3).IsOk());
+        ASSERT_TRUE(i2c->Read(0x51, buf, 1).IsError());  // NACK
+
+        auto nvme = RecordTransactions(
+            std::make_unique<SimPciDevice>(MakeEntry("nvme", "sim://pci:0000:03:00.0", "sim",
+                                                     {{"vendor_id", "0x144d"},
+                                                      {"doe_protocols", "0001:01"}})),
+            writer);
+        ASSERT_TRUE(nvme->Init().IsOk());
+        ASSERT_TRUE(nvme->Open().IsOk());
+        auto* config = dynamic_cast<pci::PciConfig*>(nvme.get());
+        auto* doe = dynamic_cast<pci::PciDoe*>(nvme.get());
+        ASSERT_TRUE(config->ReadConfig32(kBdf, 0x00).IsOk());
+        ASSERT_TRUE(config->WriteConfig16(kBdf, 0x04, 0x0006).IsOk());
+        ASSERT_TRUE(config->FindExtCapability(kBdf, pci::ExtCapabilityId::kDoe).IsOk());
+        ASSERT_TRUE(doe->DoeDiscover(kBdf, 0x100).IsOk());
+        ASSERT_TRUE(doe->DoeExchange(kBdf, 0x100, {0x0001, 0x01}, {0xCAFE}).IsOk());
+        ASSERT_TRUE(config->SnapshotConfig(kBdf).IsOk());
+    }
+
+    static std::unique_ptr<Device> Open(const std::string& uri,
+                                        std::map<std::string, std::string> args = {}) {
+        args.emplace("trace", path_);
+        auto created = DeviceFactory::CreateFromConfig(MakeEntry("dut", uri, "replay", args));
+        EXPECT_TRUE(created.IsOk());
+        auto device = std::move(created).Value();
+        EXPECT_TRUE(device->Init().IsOk());
+        EXPECT_TRUE(device->Open().IsOk());
+        return device;
+    }
+
+    static std::string path_;
+};
+
+std::string ReplayDeviceTest::path_;
+
+TEST_F(ReplayDeviceTest, ExposesRecordedInterfaces) {
+    auto eeprom = Open("replay://sim:eeprom");
+    EXPECT_NE(dynamic_cast<I2c*>(eeprom.get()), nullptr);
+    EXPECT_EQ(dynamic_cast<pci::PciConfig*>(eeprom.get()), nullptr);
+    EXPECT_EQ(eeprom->GetDriverName(), "replay");
+
+    auto nvme = Open("replay://sim:nvme", {{"speed", "0"}});
+    EXPECT_EQ(dynamic_cast<I2c*>(nvme.get()), nullptr);
+    EXPECT_NE(dynamic_cast<pci::PciConfig*>(nvme.get()), nullptr);
+    EXPECT_NE(dynamic_cast<pci::PciDoe*>(nvme.get()), nullptr);
+    EXPECT_EQ(dynamic_cast<pci::PciBar*>(nvme.get()), nullptr);
+}
+
+TEST_F(ReplayDeviceTest, ServesI2cSessionWithRecordedTiming) {
+    auto device = Open("replay://sim:eeprom");
+    auto* i2c = dynamic_cast<I2c*>(device.get());
+    const core::Byte write[] = {0x00, 0x11, 0x22, 0x33};
+    ASSERT_TRUE(i2c->Write(0x50, write, sizeof(write)).IsOk());
+
+    const core::Byte reg = 0x00;
+    core::Byte buf[3] = {};
+    auto start = std::chrono::steady_clock::now();
+    auto n = i2c->WriteRead(0x50, &reg, 1, buf, 3);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_TRUE(n.IsOk());
+    EXPECT_EQ(n.Value(), 3u);
+    EXPECT_EQ(buf[0], 0x11);
+    EXPECT_EQ(buf[2], 0x33);
+    EXPECT_GE(elapsed, std::chrono::microseconds(2000));
+
+    EXPECT_EQ(i2c->Read(0x51, buf, 1).Error(),
+              core::make_error_code(core::ErrorCode::kIOError));
+
+    // Past the end of the trace.
+    EXPECT_EQ(i2c->Read(0x51, buf, 1).Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+    auto stats = dynamic_cast<ReplayDevice*>(device.get())->GetStats();
+    EXPECT_EQ(stats.matched, 3u);
+    EXPECT_EQ(stats.unmatched, 1u);
+    EXPECT_EQ(stats.records, 3u);
+}
+
+TEST_F(ReplayDeviceTest, SkipsAheadAndLoops) {
+    auto device = Open("replay://sim:eeprom", {{"speed", "0"}, {"loop", "true"}});
+    auto* i2c = dynamic_cast<I2c*>(device.get());
+    auto* replay = dynamic_cast<ReplayDevice*>(device.get());
+    core::Byte buf[3] = {};
+
+    // An unrecorded call fails without moving the position.
+    EXPECT_EQ(i2c->Read(0x52, buf, 1).Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+    EXPECT_EQ(replay->GetStats().position, 0u);
+
+    // Jump straight to the NACK (skipping two records), then wrap around.
+    EXPECT_TRUE(i2c->Read(0x51, buf, 1).IsError());
+    EXPECT_EQ(replay->GetStats().skipped, 2u);
+    const core::Byte write[] = {0x00, 0x11, 0x22, 0x33};
+    EXPECT_TRUE(i2c->Write(0x50, write, sizeof(write)).IsOk());
+    EXPECT_EQ(replay->GetStats().position, 1u);
+
+    replay->Rewind();
+    EXPECT_EQ(replay->GetStats().position, 0u);
+}
+
+TEST_F(ReplayDeviceTest, ServesPciSession) {
+    auto device = Open("replay://sim:nvme", {{"speed", "0"}});
+    auto* config = dynamic_cast<pci::PciConfig*>(device.get());
+    auto* doe = dynamic_cast<pci::PciDoe*>(device.get());
+
+    EXPECT_EQ(config->ReadConfig32(kBdf, 0x00).Value(), 0x0001144Du);
+    EXPECT_TRUE(config->WriteConfig16(kBdf, 0x04, 0x0006).IsOk());
+    EXPECT_EQ(config->FindExtCapability(kBdf, pci::ExtCapabilityId::kDoe).Value(),
+              std::optional<pci::ConfigOffset>(0x100));
+
+    auto protocols = doe->DoeDiscover(kBdf, 0x100);
+    ASSERT_TRUE(protocols.IsOk());
+    ASSERT_EQ(protocols.Value().size(), 2u);
+    EXPECT_EQ(protocols.Value()[1], (pci::DoeProtocolId{0x0001, 0x01}));
+    auto echo = doe->DoeExchange(kBdf, 0x100, {0x0001, 0x01}, {0xCAFE});
+    ASSERT_TRUE(echo.IsOk());
+    EXPECT_EQ(echo.Value(), (pci::DoePayload{0xCAFE}));
+
+    auto snapshot = config->SnapshotConfig(kBdf);
+    ASSERT_TRUE(snapshot.IsOk());
+    EXPECT_EQ(snapshot.Value()[0], 0x4D);
+    EXPECT_EQ(snapshot.Value()[4], 0x06);
+}
+
+TEST_F(ReplayDeviceTest, InitReportsBadConfiguration) {
+    for (const auto& [uri, args] : std::vector<std::pair<std::string, std::map<std::string, std::string>>>{
+             {"replay://sim:missing", {{"trace", path_}}},
+             {"replay://aardvark:eeprom", {{"trace", path_}}},
+             {"replay://sim:eeprom", {}},
+             {"replay://sim:eeprom", {{"trace", path_}, {"speed", "-1"}}},
+             {"replay://sim:eeprom", {{"trace", path_}, {"loop", "yes"}}},
+             {"replay://eeprom", {{"trace", path_}}}}) {
+        auto device = ReplayDevice::Create(MakeEntry("dut", uri, "replay", args),
+                                           config::DeviceUri::Parse(uri));
+        EXPECT_TRUE(device->Init().IsError()) << uri;
+    }
+    auto device = ReplayDevice::Create(
+        MakeEntry("dut", "replay://sim:eeprom", "replay", {{"trace", path_ + ".none"}}),
+        config::DeviceUri::Parse("replay://sim:eeprom"));
+    EXPECT_EQ(device->Init().Error(), core::make_error_code(core::ErrorCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace plas::hal::driver
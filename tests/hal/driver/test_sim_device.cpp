@@ -0,0 +1,432 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/core/deadline.h"
+#include "plas/core/error.h"
+#include "plas/core/io_queue.h"
+#include "plas/hal/device_manager.h"
+#include "plas/hal/driver/sim/sim_device.h"
+#include "plas/hal/interface/device_factory.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+
+namespace plas::hal::driver {
+namespace {
+
+using std::chrono::milliseconds;
+
+// Helper to build a DeviceEntry for the sim driver.
+config::DeviceEntry MakeEntry(
+    const std::string& nickname, const std::string& uri,
+    const std::map<std::string, std::string>& args = {}) {
+    return config::DeviceEntry{nickname, uri, "sim", args};
+}
+
+std::string WriteTempFile(const std::string& name, const std::string& contents) {
+    std::string path = ::testing::TempDir() + name;
+    std::ofstream file(path, std::ios::binary);
+    file << contents;
+    return path;
+}
+
+template <typename T>
+void OpenDevice(T& device) {
+    ASSERT_TRUE(device.Init().IsOk());
+    ASSERT_TRUE(device.Open().IsOk());
+}
+
+constexpr pci::Bdf kBdf{0x03, 0x00, 0x0};
+
+// ---------------------------------------------------------------------------
+// Factory
+// ---------------------------------------------------------------------------
+
+TEST(SimFactoryTest, DispatchesOnUriKind) {
+    SimDevice::Register();
+    auto i2c = DeviceFactory::CreateFromConfig(MakeEntry("eeprom", "sim://i2c:0x50"));
+    ASSERT_TRUE(i2c.IsOk());
+    EXPECT_NE(dynamic_cast<I2c*>(i2c.Value().get()), nullptr);
+    EXPECT_EQ(dynamic_cast<pci::PciConfig*>(i2c.Value().get()), nullptr);
+    EXPECT_EQ(i2c.Value()->GetDriverName(), "sim");
+
+    auto pci = DeviceFactory::CreateFromConfig(MakeEntry("nvme", "sim://pci:0000:03:00.0"));
+    ASSERT_TRUE(pci.IsOk());
+    EXPECT_NE(dynamic_cast<pci::PciConfig*>(pci.Value().get()), nullptr);
+    EXPECT_NE(dynamic_cast<pci::PciDoe*>(pci.Value().get()), nullptr);
+    EXPECT_EQ(dynamic_cast<I2c*>(pci.Value().get()), nullptr);
+}
+
+TEST(SimFactoryTest, RejectsBadUrisAndArgs) {
+    for (const char* uri : {"sim://i2c:0x80", "sim://i2c", "sim://spi:0x50",
+                            "sim://pci:0000:03:00", "sim://pci:0000:03:20.0",
+                            "aardvark://0:0x50"}) {
+        auto device = SimDevice::Create(MakeEntry("dev", uri), config::DeviceUri::Parse(uri));
+        EXPECT_EQ(device->Init().Error(),
+                  core::make_error_code(core::ErrorCode::kInvalidArgument)) << uri;
+    }
+    for (auto args : std::vector<std::map<std::string, std::string>>{
+             {{"latency_dist", "pareto"}}, {{"error_rate", "1.5"}},
+             {{"error", "nack"}}, {{"size", "0"}}, {{"addr_bytes", "3"}},
+             {{"bus_time", "yes"}}}) {
+        SimI2cDevice device(MakeEntry("dev", "sim://i2c:0x50", args));
+        EXPECT_TRUE(device.Init().IsError()) << args.begin()->first;
+    }
+    SimPciDevice pci(MakeEntry("dev", "sim://pci:0000:03:00.0", {{"doe_protocols", "1"}}));
+    EXPECT_TRUE(pci.Init().IsError());
+}
+
+// ---------------------------------------------------------------------------
+// I2C register map
+// ---------------------------------------------------------------------------
+
+TEST(SimI2cDeviceTest, RegisterPointerAutoIncrements) {
+    SimI2cDevice device(MakeEntry("eeprom", "sim://i2c:0x50", {{"size", "16"}}));
+    core::Byte buf[4] = {};
+    EXPECT_EQ(device.Read(0x50, buf, 1).Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    OpenDevice(device);
+
+    const core::Byte write[] = {0x0E, 0xA0, 0xA1, 0xA2};  // pointer 0x0E, wraps
+    ASSERT_TRUE(device.Write(0x50, write, sizeof(write)).IsOk());
+    auto regs = device.Registers();
+    EXPECT_EQ(regs[0x0E], 0xA0);
+    EXPECT_EQ(regs[0x0F], 0xA1);
+    EXPECT_EQ(regs[0x00], 0xA2);
+    EXPECT_EQ(regs[0x01], 0xFF);
+
+    const core::Byte reg = 0x0F;
+    auto n = device.WriteRead(0x50, &reg, 1, buf, 3);
+    ASSERT_TRUE(n.IsOk());
+    EXPECT_EQ(n.Value(), 3u);
+    EXPECT_EQ(buf[0], 0xA1);
+    EXPECT_EQ(buf[1], 0xA2);
+    EXPECT_EQ(buf[2], 0xFF);
+
+    // Current-address read continues from where the last access stopped.
+    ASSERT_TRUE(device.Read(0x50, buf, 1).IsOk());
+    EXPECT_EQ(buf[0], 0xFF);
+
+    // Other addresses NACK.
+    EXPECT_EQ(device.Read(0x51, buf, 1).Error(),
+              core::make_error_code(core::ErrorCode::kIOError));
+    EXPECT_EQ(device.OperationCount(), 4u);
+}
+
+TEST(SimI2cDeviceTest, LoadsImageAndTwoBytePointer) {
+    const std::string path = WriteTempFile("sim_i2c_image.bin", std::string("\x12\x34\x56", 3));
+    SimI2cDevice device(MakeEntry("eeprom", "sim://i2c:0x57",
+                                  {{"size", "1024"}, {"image", path}, {"fill", "0"}}));
+    OpenDevice(device);
+
+    const core::Byte pointer[] = {0x00, 0x01};
+    core::Byte buf[3] = {};
+    ASSERT_TRUE(device.WriteRead(0x57, pointer, sizeof(pointer), buf, sizeof(buf)).IsOk());
+    EXPECT_EQ(buf[0], 0x34);
+    EXPECT_EQ(buf[1], 0x56);
+    EXPECT_EQ(buf[2], 0x00);
+
+    const core::Byte high[] = {0x03, 0xFF, 0x77};
+    ASSERT_TRUE(device.Write(0x57, high, sizeof(high)).IsOk());
+    EXPECT_EQ(device.Registers()[0x3FF], 0x77);
+
+    const core::Byte patch[] = {0xAB};
+    EXPECT_TRUE(device.SetRegisters(0x3FF, patch, 1).IsOk());
+    EXPECT_EQ(device.SetRegisters(0x3FF, patch, 2).Error(),
+              core::make_error_code(core::ErrorCode::kOutOfRange));
+
+    SimI2cDevice missing(MakeEntry("eeprom", "sim://i2c:0x57", {{"image", path + ".none"}}));
+    EXPECT_EQ(missing.Init().Error(), core::make_error_code(core::ErrorCode::kNotFound));
+    SimI2cDevice small(MakeEntry("eeprom", "sim://i2c:0x57", {{"image", path}, {"size", "2"}}));
+    EXPECT_EQ(small.Init().Error(), core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
+TEST(SimI2cDeviceTest, LatencyAndBusTime) {
+    SimI2cDevice device(MakeEntry("sensor", "sim://i2c:0x48",
+                                  {{"latency_us", "2000"}, {"bus_time", "true"},
+                                   {"bitrate", "100000"}}));
+    OpenDevice(device);
+    core::Byte buf[100] = {};
+
+    // 2 ms latency + 101 bytes * 9 bits at 100 kHz = 9.09 ms bus time.
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(device.Read(0x48, buf, sizeof(buf)).IsOk());
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, std::chrono::microseconds(11000));
+
+    ASSERT_TRUE(device.SetBitrate(1000000).IsOk());
+    EXPECT_EQ(device.GetBitrate(), 1000000u);
+    EXPECT_EQ(device.SetBitrate(0).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
+TEST(SimI2cDeviceTest, StopsAtCallersDeadline) {
+    SimI2cDevice device(MakeEntry("slow", "sim://i2c:0x48", {{"latency_us", "200000"}}));
+    OpenDevice(device);
+    core::Byte b = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        core::ScopedDeadline scope(core::Deadline::After(milliseconds(5)));
+        EXPECT_EQ(device.Read(0x48, &b, 1).Error(),
+                  core::make_error_code(core::ErrorCode::kTimeout));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, milliseconds(5));
+    EXPECT_LT(elapsed, milliseconds(150));
+
+    core::ScopedDeadline scope(core::Deadline::After(std::chrono::seconds(10)));
+    EXPECT_TRUE(device.Read(0x48, &b, 1).IsOk());
+}
+
+TEST(SimI2cDeviceTest, ForegroundReadOvertakesBackgroundLoop) {
+    SimI2cDevice device(MakeEntry("eeprom", "sim://i2c:0x50", {{"latency_us", "2000"}}));
+    OpenDevice(device);
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> chunks{0};
+    std::thread bulk([&] {
+        core::ScopedIoPriority background(core::IoPriority::kBackground);
+        core::Byte chunk[16];
+        while (!stop.load()) {
+            EXPECT_TRUE(device.Read(0x50, chunk, sizeof(chunk)).IsOk());
+            chunks.fetch_add(1);
+        }
+    });
+    while (chunks.load() < 2) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    // Waits out at most the chunk in progress, not the rest of the loop.
+    core::Byte b = 0;
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(device.Read(0x50, &b, 1).IsOk());
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    stop = true;
+    bulk.join();
+    EXPECT_LT(elapsed, milliseconds(50));
+
+    auto stats = device.GetIoQueueStats();
+    EXPECT_GE(stats.grants[0], 1u);
+    EXPECT_GE(stats.grants[1], 2u);
+}
+
+TEST(SimI2cDeviceTest, ErrorInjectionIsSeededAndAdjustable) {
+    auto run = [](const std::string& seed) {
+        SimI2cDevice device(MakeEntry("flaky", "sim://i2c:0x50",
+                                      {{"error_rate", "0.25"}, {"error", "timeout"},
+                                       {"seed", seed}}));
+        EXPECT_TRUE(device.Init().IsOk());
+        EXPECT_TRUE(device.Open().IsOk());
+        std::vector<bool> outcome;
+        core::Byte b = 0;
+        for (int i = 0; i < 400; ++i) {
+            auto r = device.Read(0x50, &b, 1);
+            if (r.IsError()) {
+                EXPECT_EQ(r.Error(), core::make_error_code(core::ErrorCode::kTimeout));
+            }
+            outcome.push_back(r.IsOk());
+        }
+        EXPECT_EQ(device.OperationCount(), 400u);
+        EXPECT_GT(device.InjectedErrorCount(), 50u);
+        EXPECT_LT(device.InjectedErrorCount(), 150u);
+        return outcome;
+    };
+    EXPECT_EQ(run("7"), run("7"));
+    EXPECT_NE(run("7"), run("8"));
+
+    SimI2cDevice device(MakeEntry("flaky", "sim://i2c:0x50", {{"error_rate", "1"}}));
+    OpenDevice(device);
+    core::Byte b = 0;
+    EXPECT_TRUE(device.Read(0x50, &b, 1).IsError());
+    SimFaultModel healthy = device.GetFaultModel();
+    healthy.error_rate = 0.0;
+    device.SetFaultModel(healthy);
+    EXPECT_TRUE(device.Read(0x50, &b, 1).IsOk());
+    EXPECT_EQ(device.InjectedErrorCount(), 1u);
+}
+
+TEST(SimI2cDeviceTest, OpenFaults) {
+    SimI2cDevice device(MakeEntry("dead", "sim://i2c:0x50", {{"open_error_rate", "1"}}));
+    ASSERT_TRUE(device.Init().IsOk());
+    EXPECT_EQ(device.Open().Error(), core::make_error_code(core::ErrorCode::kIOError));
+    EXPECT_EQ(device.GetState(), DeviceState::kInitialized);
+}
+
+// ---------------------------------------------------------------------------
+// PCI config space + DOE
+// ---------------------------------------------------------------------------
+
+TEST(SimI2cDeviceTest, MemoryUsageCountsRegistersNotArgs) {
+    SimI2cDevice small(MakeEntry("small", "sim://i2c:0x50", {{"size", "16"}}));
+    SimI2cDevice large(MakeEntry("large", "sim://i2c:0x50",
+                                 {{"size", "4096"}, {"note", std::string(1000, 'x')}}));
+    EXPECT_GE(small.MemoryUsage(), sizeof(SimI2cDevice));
+    // The args are parsed, not kept: a simulated device is a few hundred
+    // bytes plus its registers.
+    EXPECT_LT(small.MemoryUsage(), 1024u);
+    EXPECT_EQ(large.MemoryUsage(), small.MemoryUsage());
+
+    OpenDevice(small);
+    OpenDevice(large);
+    EXPECT_GE(large.MemoryUsage() - small.MemoryUsage(), 4096u - 16u);
+}
+
+TEST(SimPciDeviceTest, DefaultImageAndReadOnlyHeader) {
+    SimPciDevice device(MakeEntry("nvme", "sim://pci:0000:03:00.0", {{"vendor_id", "0x8086"}}));
+    OpenDevice(device);
+
+    EXPECT_EQ(device.ReadConfig16(kBdf, 0x00).Value(), 0x8086);
+    EXPECT_EQ(device.ReadConfig16(kBdf, 0x02).Value(), 0x0001);
+    ASSERT_TRUE(device.WriteConfig32(kBdf, 0x00, 0xDEADBEEF).IsOk());
+    EXPECT_EQ(device.ReadConfig32(kBdf, 0x00).Value(), 0x00018086u);
+
+    ASSERT_TRUE(device.WriteConfig16(kBdf, 0x04, 0x0406).IsOk());
+    EXPECT_EQ(device.ReadConfig16(kBdf, 0x04).Value(), 0x0406);
+    ASSERT_TRUE(device.WriteConfig8(kBdf, 0x3C, 0x0B).IsOk());
+    EXPECT_EQ(device.ReadConfig8(kBdf, 0x3C).Value(), 0x0B);
+
+    // Empty slot, misaligned and out-of-range accesses.
+    EXPECT_EQ(device.ReadConfig32({0x04, 0x00, 0x0}, 0x00).Value(), 0xFFFFFFFFu);
+    EXPECT_EQ(device.ReadConfig32(kBdf, 0x02).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    EXPECT_EQ(device.ReadConfig32(kBdf, 0x1000).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+
+    ASSERT_EQ(device.DoeOffsets().size(), 1u);
+    EXPECT_EQ(device.DoeOffsets()[0], 0x100);
+    EXPECT_EQ(device.ReadConfig32(kBdf, 0x100).Value() & 0xFFFF, 0x002Eu);
+    auto doe = device.FindExtCapability(kBdf, pci::ExtCapabilityId::kDoe);
+    ASSERT_TRUE(doe.IsOk());
+    EXPECT_EQ(doe.Value(), std::optional<pci::ConfigOffset>(0x100));
+    EXPECT_FALSE(device.FindExtCapability({0x04, 0x00, 0x0}, pci::ExtCapabilityId::kDoe)
+                     .Value()
+                     .has_value());
+}
+
+TEST(SimPciDeviceTest, LoadsLspciDump) {
+    const std::string path = WriteTempFile(
+        "sim_pci_lspci.txt",
+        "03:00.0 Non-Volatile memory controller: Example Corp Device a808\n"
+        "00: 4d 14 08 a8 06 04 10 00 00 02 08 01 00 00 00 00\n"
+        "10: 04 00 10 fc 00 00 00 00 00 00 00 00 00 00 00 00\n"
+        "\n");
+    SimPciDevice device(MakeEntry("nvme", "sim://pci:0000:03:00.0", {{"config", path}}));
+    OpenDevice(device);
+    EXPECT_EQ(device.ReadConfig32(kBdf, 0x00).Value(), 0xA808144Du);
+    EXPECT_EQ(device.ReadConfig32(kBdf, 0x08).Value(), 0x01080200u);
+    EXPECT_EQ(device.ReadConfig32(kBdf, 0x10).Value(), 0xFC100004u);
+
+    // A second device on the same dump shares the cached file.
+    SimPciDevice twin(MakeEntry("nvme1", "sim://pci:0000:04:00.0",
+                                {{"config", path}, {"device_id", "0xa809"}}));
+    OpenDevice(twin);
+    EXPECT_EQ(twin.ReadConfig32({0x04, 0x00, 0x0}, 0x00).Value(), 0xA809144Du);
+}
+
+TEST(SimPciDeviceTest, LoadsBinaryDump) {
+    std::string image(256, '\0');
+    image[0] = '\x86';
+    image[1] = '\x80';
+    image[2] = '\x53';
+    image[3] = '\x09';
+    const std::string path = WriteTempFile("sim_pci_config.bin", image);
+    SimPciDevice device(MakeEntry("nic", "sim://pci:0000:03:00.0", {{"config", path}}));
+    OpenDevice(device);
+    EXPECT_EQ(device.ReadConfig32(kBdf, 0x00).Value(), 0x09538086u);
+}
+
+TEST(SimPciDeviceTest, DoeDiscoveryEchoAndResponder) {
+    SimPciDevice device(MakeEntry("cxl", "sim://pci:0000:03:00.0",
+                                  {{"doe_protocols", "0001:01,1e98:02"}}));
+    OpenDevice(device);
+
+    auto protocols = device.DoeDiscover(kBdf, 0x100);
+    ASSERT_TRUE(protocols.IsOk());
+    ASSERT_EQ(protocols.Value().size(), 3u);
+    EXPECT_EQ(protocols.Value()[0], (pci::DoeProtocolId{0x0001, 0x00}));
+    EXPECT_EQ(protocols.Value()[2], (pci::DoeProtocolId{0x1E98, 0x02}));
+    EXPECT_EQ(device.DoeDiscover(kBdf, 0x200).Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+
+    // Discovery object: vendor | type << 16 | next index << 24.
+    auto entry = device.DoeExchange(kBdf, 0x100, {0x0001, 0x00}, {2});
+    ASSERT_TRUE(entry.IsOk());
+    EXPECT_EQ(entry.Value(), (pci::DoePayload{0x00021E98}));
+
+    auto echo = device.DoeExchange(kBdf, 0x100, {0x0001, 0x01}, {1, 2, 3});
+    ASSERT_TRUE(echo.IsOk());
+    EXPECT_EQ(echo.Value(), (pci::DoePayload{1, 2, 3}));
+
+    device.SetDoeResponder([](pci::DoeProtocolId protocol, const pci::DoePayload& request) {
+        return core::Result<pci::DoePayload>::Ok(
+            {protocol.data_object_type, static_cast<core::DWord>(request.size())});
+    });
+    core::DWord request[2] = {7, 8};
+    core::DWord response[4] = {};
+    auto n = device.DoeExchangeInto(kBdf, 0x100, {0x1E98, 0x02}, request, 2, response, 4);
+    ASSERT_TRUE(n.IsOk());
+    ASSERT_EQ(n.Value(), 2u);
+    EXPECT_EQ(response[0], 0x02u);
+    EXPECT_EQ(response[1], 2u);
+
+    EXPECT_EQ(device.DoeExchange(kBdf, 0x100, {0x0001, 0x02}, {}).Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+}
+
+// ---------------------------------------------------------------------------
+// Scale: the reason the driver exists
+// ---------------------------------------------------------------------------
+
+TEST(SimScaleTest, ThousandDevicesThroughDeviceManager) {
+    SimDevice::Register();
+    auto& mgr = DeviceManager::GetInstance();
+    mgr.Reset();
+    constexpr int kDevices = 1000;
+    for (int i = 0; i < kDevices; ++i) {
+        std::string uri = i % 2 == 0
+                              ? "sim://i2c:0x50"
+                              : "sim://pci:0000:" + std::to_string(10 + i % 80) + ":00.0";
+        auto created = DeviceFactory::CreateFromConfig(
+            MakeEntry("sim" + std::to_string(i), uri, {{"latency_us", "50"}}));
+        ASSERT_TRUE(created.IsOk());
+        ASSERT_TRUE(created.Value()->Init().IsOk());
+        ASSERT_TRUE(created.Value()->Open().IsOk());
+        ASSERT_TRUE(mgr.AddDevice("sim" + std::to_string(i), std::move(created.Value())).IsOk());
+    }
+    EXPECT_EQ(mgr.DeviceCount(), static_cast<size_t>(kDevices));
+
+    // Each device has its own lock, so callers on different devices do not
+    // wait for one another.
+    std::vector<std::thread> workers;
+    std::atomic<int> ok{0};
+    for (int t = 0; t < 8; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < 25; ++i) {
+                auto* i2c = mgr.GetInterface<I2c>("sim" + std::to_string((t * 25 + i) * 2));
+                core::Byte b = 0;
+                if (i2c != nullptr && i2c->Read(0x50, &b, 1).IsOk()) {
+                    ok++;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    EXPECT_EQ(ok.load(), 200);
+    mgr.Reset();
+}
+
+}  // namespace
+}  // namespace plas::hal::driver
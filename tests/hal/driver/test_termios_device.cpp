@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "plas/config/device_entry.h"
+#include "plas/core/error.h"
+#include "plas/hal/driver/termios/termios_device.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_handoff.h"
+#include "plas/hal/interface/device_factory.h"
+#include "plas/hal/interface/serial.h"
+#include "plas/hal/interface/uart.h"
+
+namespace plas::hal::driver {
+namespace {
+
+using std::chrono::milliseconds;
+
+// Helper to build a DeviceEntry for the termios driver.
+config::DeviceEntry MakeEntry(
+    const std::string& nickname, const std::string& uri,
+    const std::map<std::string, std::string>& args = {}) {
+    return config::DeviceEntry{nickname, uri, "termios", args};
+}
+
+// ---------------------------------------------------------------------------
+// Pseudo-terminal: the driver opens the slave, the test plays the remote
+// UART on the master.
+// ---------------------------------------------------------------------------
+
+class TermiosPtyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        master_ = ::posix_openpt(O_RDWR | O_NOCTTY);
+        ASSERT_GE(master_, 0);
+        ASSERT_EQ(::grantpt(master_), 0);
+        ASSERT_EQ(::unlockpt(master_), 0);
+        const std::string slave = ::ptsname(master_);
+        ASSERT_EQ(slave.compare(0, 5, "/dev/"), 0);
+        node_ = slave.substr(5);
+
+        // Keep the master raw too so bytes pass through unchanged.
+        termios tio{};
+        ASSERT_EQ(::tcgetattr(master_, &tio), 0);
+        ::cfmakeraw(&tio);
+        ASSERT_EQ(::tcsetattr(master_, TCSANOW, &tio), 0);
+        ASSERT_EQ(::fcntl(master_, F_SETFL, ::fcntl(master_, F_GETFL) | O_NONBLOCK), 0);
+    }
+
+    void TearDown() override {
+        if (master_ >= 0) {
+            ::close(master_);
+        }
+    }
+
+    std::string Uri(uint32_t baud = 115200) const {
+        return "termios://" + node_ + ":" + std::to_string(baud);
+    }
+
+    void RemoteSend(const std::string& text) {
+        ASSERT_EQ(::write(master_, text.data(), text.size()),
+                  static_cast<ssize_t>(text.size()));
+    }
+
+    std::string RemoteReceive(size_t length) {
+        std::string got;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        char buf[256];
+        while (got.size() < length && std::chrono::steady_clock::now() < deadline) {
+            ssize_t n = ::read(master_, buf, sizeof(buf));
+            if (n > 0) {
+                got.append(buf, static_cast<size_t>(n));
+            } else {
+                std::this_thread::sleep_for(milliseconds(1));
+            }
+        }
+        return got;
+    }
+
+    int master_ = -1;
+    std::string node_;  // e.g. "pts/3"
+};
+
+TEST(TermiosFactoryTest, CreateFromConfig) {
+    TermiosDevice::Register();
+    auto result = DeviceFactory::CreateFromConfig(MakeEntry("console", "termios://ttyUSB0:115200"));
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_NE(dynamic_cast<Serial*>(result.Value().get()), nullptr);
+    EXPECT_NE(dynamic_cast<Uart*>(result.Value().get()), nullptr);
+    EXPECT_EQ(result.Value()->GetDriverName(), "termios");
+}
+
+TEST(TermiosDeviceTest, RejectsBadUrisAndArgs) {
+    for (const char* uri : {"termios://ttyUSB0", "termios://ttyUSB0:12345",
+                            "termios://ttyUSB0:fast", "termios://../etc/passwd:9600",
+                            "aardvark://ttyUSB0:9600"}) {
+        TermiosDevice device(MakeEntry("console", uri));
+        EXPECT_TRUE(device.Init().IsError()) << uri;
+    }
+    TermiosDevice parity(MakeEntry("console", "termios://ttyS0:9600", {{"parity", "mark"}}));
+    EXPECT_TRUE(parity.Init().IsError());
+    TermiosDevice ring(MakeEntry("console", "termios://ttyS0:9600", {{"rx_buffer", "0"}}));
+    EXPECT_TRUE(ring.Init().IsError());
+
+    TermiosDevice device(MakeEntry("console", "termios://pts/0:921600",
+                                   {{"parity", "even"}, {"read_timeout_ms", "5"}}));
+    EXPECT_TRUE(device.Init().IsOk());
+    EXPECT_EQ(device.GetBaudRate(), 921600u);
+}
+
+TEST(TermiosDeviceTest, OperationsRequireOpen) {
+    TermiosDevice device(MakeEntry("console", "termios://ttyUSB0:115200"));
+    core::Byte buf[2] = {};
+    EXPECT_EQ(device.Read(buf, 2).Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    EXPECT_EQ(device.Write(buf, 2).Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    EXPECT_EQ(device.Open().Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    EXPECT_EQ(device.Available(), 0u);
+}
+
+TEST(TermiosDeviceTest, MissingTtyFailsOpen) {
+    TermiosDevice device(MakeEntry("console", "termios://plas-no-such-tty:115200"));
+    ASSERT_TRUE(device.Init().IsOk());
+    EXPECT_EQ(device.Open().Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+    EXPECT_EQ(device.GetState(), DeviceState::kInitialized);
+}
+
+TEST_F(TermiosPtyTest, ReceivesInBackground) {
+    TermiosDevice device(MakeEntry("console", Uri()));
+    ASSERT_TRUE(device.Init().IsOk());
+    ASSERT_TRUE(device.Open().IsOk());
+
+    std::atomic<int> ready{0};
+    ASSERT_TRUE(device.SetReadyCallback([&] { ready++; }).IsOk());
+    RemoteSend("boot ok\n");
+
+    core::Byte buf[64];
+    std::string got;
+    while (got.size() < 8) {
+        auto n = device.ReadFor(buf, sizeof(buf), milliseconds(5000));
+        ASSERT_TRUE(n.IsOk());
+        got.append(reinterpret_cast<char*>(buf), n.Value());
+    }
+    EXPECT_EQ(got, "boot ok\n");
+    EXPECT_GE(ready.load(), 1);
+    EXPECT_EQ(device.Available(), 0u);
+    EXPECT_EQ(device.ReadFor(buf, sizeof(buf), milliseconds(10)).Error(),
+              core::make_error_code(core::ErrorCode::kTimeout));
+    EXPECT_EQ(device.RxDropped(), 0u);
+    EXPECT_TRUE(device.Close().IsOk());
+}
+
+TEST_F(TermiosPtyTest, TransmitsAndFlushes) {
+    TermiosDevice device(MakeEntry("console", Uri()));
+    ASSERT_TRUE(device.Init().IsOk());
+    ASSERT_TRUE(device.Open().IsOk());
+
+    const std::string command = "reboot\r\n";
+    auto n = device.Write(reinterpret_cast<const core::Byte*>(command.data()),
+                          command.size());
+    ASSERT_TRUE(n.IsOk());
+    EXPECT_EQ(n.Value(), command.size());
+    EXPECT_TRUE(device.Flush().IsOk());
+    EXPECT_EQ(RemoteReceive(command.size()), command);
+    EXPECT_TRUE(device.Close().IsOk());
+}
+
+TEST_F(TermiosPtyTest, LineSettingsApplyWhileOpen) {
+    TermiosDevice device(MakeEntry("console", Uri(9600)));
+    ASSERT_TRUE(device.Init().IsOk());
+    ASSERT_TRUE(device.Open().IsOk());
+    EXPECT_TRUE(device.SetBaudRate(115200).IsOk());
+    EXPECT_EQ(device.GetBaudRate(), 115200u);
+    EXPECT_EQ(device.SetBaudRate(12345).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    EXPECT_EQ(device.GetBaudRate(), 115200u);
+    EXPECT_TRUE(device.SetParity(Parity::kOdd).IsOk());
+    EXPECT_TRUE(device.Close().IsOk());
+    EXPECT_TRUE(device.Reset().IsOk());
+    EXPECT_EQ(device.GetState(), DeviceState::kInitialized);
+}
+
+TEST_F(TermiosPtyTest, HandoffKeepsTheTtyOpenAcrossDevices) {
+    TermiosDevice before(MakeEntry("console", Uri(9600), {{"parity", "even"}}));
+    ASSERT_TRUE(before.Init().IsOk());
+    ASSERT_TRUE(before.Open().IsOk());
+    auto handoff = before.ExportHandoff();
+    ASSERT_TRUE(handoff.IsOk());
+    EXPECT_EQ(before.GetState(), DeviceState::kClosed);
+    ASSERT_EQ(handoff.Value().fds.size(), 1u);
+    const int fd = handoff.Value().fds[0];
+    EXPECT_GE(::fcntl(fd, F_GETFD), 0);  // released, not closed
+
+    // Sent while nobody serves the tty; the adopter must still see it.
+    RemoteSend("still here\n");
+
+    TermiosDevice after(MakeEntry("console", Uri(9600), {{"parity", "even"}}));
+    ASSERT_TRUE(after.Init().IsOk());
+    ASSERT_TRUE(after.AdoptHandoff(handoff.Value()).IsOk());
+    EXPECT_EQ(after.GetState(), DeviceState::kOpen);
+    core::Byte buf[64];
+    std::string got;
+    while (got.size() < 11) {
+        auto n = after.ReadFor(buf, sizeof(buf), milliseconds(5000));
+        ASSERT_TRUE(n.IsOk());
+        got.append(reinterpret_cast<char*>(buf), n.Value());
+    }
+    EXPECT_EQ(got, "still here\n");
+    EXPECT_TRUE(after.Close().IsOk());
+    EXPECT_EQ(::fcntl(fd, F_GETFD), -1);
+}
+
+TEST_F(TermiosPtyTest, HandoffRequiresOpenAndInitializedDevices) {
+    TermiosDevice device(MakeEntry("console", Uri()));
+    EXPECT_EQ(device.ExportHandoff().Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    DeviceHandoff handoff;
+    handoff.fds.push_back(master_);
+    handoff.state = "115200 0";
+    EXPECT_EQ(device.AdoptHandoff(handoff).Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+
+    ASSERT_TRUE(device.Init().IsOk());
+    handoff.state = "garbage";
+    EXPECT_EQ(device.AdoptHandoff(handoff).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    EXPECT_EQ(device.GetState(), DeviceState::kInitialized);
+}
+
+}  // namespace
+}  // namespace plas::hal::driver
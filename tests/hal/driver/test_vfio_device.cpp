@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <filesystem>
+
+#include "plas/config/device_entry.h"
+#include "plas/core/error.h"
+#include "plas/hal/driver/vfio/vfio_device.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/device_factory.h"
+#include "plas/hal/interface/pci/cxl.h"
+#include "plas/hal/interface/pci/cxl_mailbox.h"
+#include "plas/hal/interface/pci/pci_bar.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+
+namespace plas::hal::driver {
+namespace {
+
+namespace fs = std::filesystem;
+
+// Helper to build a DeviceEntry for the vfio driver.
+config::DeviceEntry MakeEntry(
+    const std::string& nickname, const std::string& uri,
+    const std::map<std::string, std::string>& args = {}) {
+    return config::DeviceEntry{nickname, uri, "vfio", args};
+}
+
+// ---------------------------------------------------------------------------
+// Fake sysfs tree: function 0000:3a:00.0, optionally in IOMMU group 17
+// ---------------------------------------------------------------------------
+
+class VfioSysfsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root_ = fs::temp_directory_path() /
+                ("plas_vfio_" + std::to_string(::getpid()));
+        fs::remove_all(root_);
+        fs::create_directories(root_ / "devices" / "0000:3a:00.0");
+        fs::create_directories(root_ / "iommu_groups" / "17");
+        fs::create_directories(root_ / "dev");
+    }
+
+    void TearDown() override { fs::remove_all(root_); }
+
+    void JoinGroup() {
+        fs::create_directory_symlink(root_ / "iommu_groups" / "17",
+                                     root_ / "devices" / "0000:3a:00.0" /
+                                         "iommu_group");
+    }
+
+    config::DeviceEntry Entry() {
+        return MakeEntry("cxl0", "vfio://0000:3a:00.0",
+                         {{"sysfs_root", (root_ / "devices").string()},
+                          {"dev_root", (root_ / "dev").string()}});
+    }
+
+    fs::path root_;
+};
+
+TEST(VfioFactoryTest, CreateFromConfig) {
+    VfioDevice::Register();
+    auto result =
+        DeviceFactory::CreateFromConfig(MakeEntry("cxl0", "vfio://0000:3a:00.0"));
+    ASSERT_TRUE(result.IsOk());
+    auto* device = result.Value().get();
+    EXPECT_NE(dynamic_cast<pci::PciConfig*>(device), nullptr);
+    EXPECT_NE(dynamic_cast<pci::PciDoe*>(device), nullptr);
+    EXPECT_NE(dynamic_cast<pci::PciBar*>(device), nullptr);
+    EXPECT_NE(dynamic_cast<pci::Cxl*>(device), nullptr);
+    EXPECT_NE(dynamic_cast<pci::CxlMailbox*>(device), nullptr);
+    EXPECT_EQ(device->GetDriverName(), "vfio");
+}
+
+TEST(VfioDeviceTest, RejectsBadUris) {
+    for (const char* uri :
+         {"vfio://0000:3a:00", "vfio://0000:3a:20.0", "vfio://0000:3a:00.8",
+          "vfio://10000:3a:00.0", "vfio://0000:3a", "pciutils://0000:3a:00.0"}) {
+        VfioDevice device(MakeEntry("cxl0", uri));
+        EXPECT_EQ(device.Init().Error(),
+                  core::make_error_code(core::ErrorCode::kInvalidArgument))
+            << uri;
+    }
+    VfioDevice device(MakeEntry("cxl0", "vfio://0000:3a:00.0"));
+    EXPECT_TRUE(device.Init().IsOk());
+    EXPECT_EQ(device.GetState(), DeviceState::kInitialized);
+}
+
+TEST(VfioDeviceTest, OperationsRequireOpen) {
+    VfioDevice device(MakeEntry("cxl0", "vfio://0000:3a:00.0"));
+    EXPECT_EQ(device.Open().Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    ASSERT_TRUE(device.Init().IsOk());
+
+    pci::Bdf bdf{0x3a, 0, 0};
+    EXPECT_EQ(device.ReadConfig32(bdf, pci::ConfigOffset{0}).Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    EXPECT_EQ(device.BarRead32(bdf, 0, 0).Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    EXPECT_EQ(device.GetBarWindow(0).Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    EXPECT_EQ(device.AllocateDmaBuffer(4096).Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    EXPECT_EQ(device.InterruptVectors(), 0u);
+    EXPECT_EQ(device.InterruptCount(0), 0u);
+}
+
+TEST_F(VfioSysfsTest, OpenWithoutIommuGroupIsNotFound) {
+    VfioDevice device(Entry());
+    ASSERT_TRUE(device.Init().IsOk());
+    EXPECT_EQ(device.Open().Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+    EXPECT_EQ(device.GetState(), DeviceState::kError);
+}
+
+TEST_F(VfioSysfsTest, OpenWithoutVfioNodeIsNotFound) {
+    JoinGroup();
+    VfioDevice device(Entry());
+    ASSERT_TRUE(device.Init().IsOk());
+    EXPECT_EQ(device.Open().Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+    EXPECT_EQ(device.GetState(), DeviceState::kError);
+}
+
+TEST(VfioDmaBufferTest, DefaultIsEmpty) {
+    VfioDmaBuffer buffer;
+    EXPECT_EQ(buffer.Data(), nullptr);
+    EXPECT_EQ(buffer.Size(), 0u);
+    EXPECT_EQ(buffer.Iova(), 0u);
+
+    VfioDmaBuffer moved(std::move(buffer));
+    EXPECT_EQ(moved.Size(), 0u);
+}
+
+}  // namespace
+}  // namespace plas::hal::driver
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/bar_resource.h"
+
+namespace plas::hal::pci {
+namespace {
+
+BarResources Parse(const std::string& text) {
+    return ParseBarResources(text.data(), text.size());
+}
+
+TEST(BarResourceTest, ParsesSysfsLines) {
+    auto bars = Parse(
+        "0x00000000fb000000 0x00000000fbffffff 0x0000000000040200\n"
+        "0x0000000000000000 0x0000000000000000 0x0000000000000000\n"
+        "0x000000e000000000 0x000000e00fffffff 0x000000000014220c\n"
+        "0x0000000000000000 0x0000000000000000 0x0000000000000000\n"
+        "0x000000000000e000 0x000000000000e07f 0x0000000000040101\n"
+        "0x0000000000000000 0x0000000000000000 0x0000000000000000\n"
+        "0x00000000fc000000 0x00000000fc07ffff 0x0000000000046200\n");
+
+    EXPECT_EQ(bars[0].start, 0xfb000000u);
+    EXPECT_EQ(bars[0].Size(), 0x1000000u);
+    EXPECT_TRUE(bars[0].IsMemory());
+    EXPECT_FALSE(bars[0].IsPrefetchable());
+
+    EXPECT_FALSE(bars[1].IsImplemented());
+    EXPECT_EQ(bars[1].Size(), 0u);
+
+    EXPECT_EQ(bars[2].Size(), 0x10000000u);
+    EXPECT_TRUE(bars[2].IsPrefetchable());
+    EXPECT_TRUE(bars[2].flags & BarResource::kFlagMem64);
+
+    EXPECT_EQ(bars[4].Size(), 0x80u);
+    EXPECT_FALSE(bars[4].IsMemory());
+    EXPECT_TRUE(bars[4].flags & BarResource::kFlagIo);
+}
+
+TEST(BarResourceTest, ShortFileLeavesRestUnimplemented) {
+    auto bars = Parse("0x1000 0x1fff 0x200");
+    EXPECT_EQ(bars[0].Size(), 0x1000u);
+    for (std::size_t i = 1; i < kBarCount; ++i) {
+        EXPECT_FALSE(bars[i].IsImplemented()) << i;
+    }
+    EXPECT_FALSE(Parse("")[0].IsImplemented());
+}
+
+TEST(BarResourceTest, MalformedLineIsUnimplemented) {
+    auto bars = Parse("0x1000 0x1fff\n0x2000 0x2fff 0x200\n");
+    EXPECT_FALSE(bars[0].IsImplemented());
+    EXPECT_EQ(bars[1].Size(), 0x1000u);
+}
+
+TEST(BarResourceTest, EndBeforeStartIsUnimplemented) {
+    auto bars = Parse("0x2000 0x1000 0x200\n");
+    EXPECT_FALSE(bars[0].IsImplemented());
+}
+
+TEST(BarResourceTest, MissingFileIsNotFound) {
+    auto result = ReadBarResources("/nonexistent/plas/device");
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/cxl.h"
+#include "plas/hal/interface/pci/cxl_component.h"
+#include "plas/hal/interface/pci/pci_bar.h"
+
+namespace plas::hal::pci {
+namespace {
+
+constexpr uint8_t kBar = 0;
+constexpr uint64_t kBlockOffset = 0x20000;           // component registers
+constexpr uint64_t kCacheMem = kBlockOffset + 0x1000;
+constexpr uint64_t kRas = kCacheMem + 0x100;
+constexpr uint64_t kHdm = kCacheMem + 0x200;
+
+const Bdf kBdf{0x0D, 0x00, 0x00};
+
+/// BAR 0 as plain memory with a component register block holding a CXL
+/// Capability Header, RAS and HDM Decoder capabilities. Counts BAR calls.
+class FakeCxlFunction : public PciBar, public Cxl {
+public:
+    FakeCxlFunction() : bar_(0x30000, 0) {
+        Put32(kCacheMem, 0x0001 | (1u << 16) | (1u << 20) | (2u << 24));  // 2 elements
+        Put32(kCacheMem + 0x04, 0x0002 | (2u << 16) | (0x100u << 20));     // RAS
+        Put32(kCacheMem + 0x08, 0x0005 | (3u << 16) | (0x200u << 20));     // HDM
+        blocks_ = {{CxlRegisterBlockId::kComponentRegister, kBar, kBlockOffset}};
+    }
+
+    plas::hal::Device* GetDevice() override { return nullptr; }
+
+    // -- Cxl (only the Register Locator matters here) --
+    core::Result<std::vector<DvsecHeader>> EnumerateCxlDvsecs(Bdf) override {
+        return core::Result<std::vector<DvsecHeader>>::Ok({});
+    }
+    core::Result<std::optional<DvsecHeader>> FindCxlDvsec(Bdf, CxlDvsecId) override {
+        return core::Result<std::optional<DvsecHeader>>::Ok(std::nullopt);
+    }
+    core::Result<CxlDeviceType> GetCxlDeviceType(Bdf) override {
+        return core::Result<CxlDeviceType>::Ok(CxlDeviceType::kType3);
+    }
+    core::Result<std::vector<RegisterBlockEntry>> GetRegisterBlocks(Bdf) override {
+        return core::Result<std::vector<RegisterBlockEntry>>::Ok(blocks_);
+    }
+    core::Result<core::DWord> ReadDvsecRegister(Bdf, ConfigOffset, uint16_t) override {
+        return core::Result<core::DWord>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> WriteDvsecRegister(Bdf, ConfigOffset, uint16_t, core::DWord) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    // -- PciBar --
+    core::Result<core::DWord> BarRead32(Bdf, uint8_t, uint64_t offset) override {
+        ++reads;
+        core::DWord value;
+        std::memcpy(&value, &bar_[offset], sizeof(value));
+        return core::Result<core::DWord>::Ok(value);
+    }
+    core::Result<core::QWord> BarRead64(Bdf, uint8_t, uint64_t offset) override {
+        ++reads;
+        core::QWord value;
+        std::memcpy(&value, &bar_[offset], sizeof(value));
+        return core::Result<core::QWord>::Ok(value);
+    }
+    core::Result<void> BarWrite32(Bdf, uint8_t, uint64_t offset, core::DWord value) override {
+        Put32(offset, value);
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> BarWrite64(Bdf, uint8_t, uint64_t offset, core::QWord value) override {
+        std::memcpy(&bar_[offset], &value, sizeof(value));
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> BarReadBuffer(Bdf, uint8_t, uint64_t offset, void* buffer,
+                                     std::size_t length) override {
+        ++buffer_reads;
+        std::memcpy(buffer, &bar_[offset], length);
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> BarWriteBuffer(Bdf, uint8_t, uint64_t offset, const void* buffer,
+                                      std::size_t length) override {
+        std::memcpy(&bar_[offset], buffer, length);
+        return core::Result<void>::Ok();
+    }
+
+    void Put32(uint64_t offset, uint32_t value) {
+        std::memcpy(&bar_[offset], &value, sizeof(value));
+    }
+    void ClearBlocks() { blocks_.clear(); }
+
+    int reads = 0;
+    int buffer_reads = 0;
+
+private:
+    std::vector<uint8_t> bar_;
+    std::vector<RegisterBlockEntry> blocks_;
+};
+
+TEST(CxlComponentTest, LocateFindsCacheMemRange) {
+    FakeCxlFunction fn;
+    auto location = CxlComponentRegisters::Locate(fn, fn, kBdf);
+    ASSERT_TRUE(location.IsOk());
+    EXPECT_EQ(location.Value(), (CxlComponentLocation{kBar, kCacheMem}));
+}
+
+TEST(CxlComponentTest, LocateWithoutComponentBlockIsNotFound) {
+    FakeCxlFunction fn;
+    fn.ClearBlocks();
+    auto location = CxlComponentRegisters::Locate(fn, fn, kBdf);
+    ASSERT_TRUE(location.IsError());
+    EXPECT_EQ(location.Error(), core::ErrorCode::kNotFound);
+}
+
+TEST(CxlComponentTest, SnapshotIsOneBulkRead) {
+    FakeCxlFunction fn;
+    CxlComponentRegisters regs(fn, kBdf, {kBar, kCacheMem});
+    CxlComponentSnapshot snapshot;
+    ASSERT_TRUE(regs.Snapshot(snapshot).IsOk());
+    ASSERT_TRUE(regs.Snapshot(snapshot).IsOk());
+    EXPECT_EQ(fn.buffer_reads, 2);
+    EXPECT_EQ(fn.reads, 0);
+    EXPECT_GT(snapshot.timestamp_ns, 0u);
+    EXPECT_EQ(snapshot.FindCapability(CxlCacheMemCapId::kRas), uint16_t{0x100});
+    EXPECT_EQ(snapshot.FindCapability(CxlCacheMemCapId::kHdmDecoder), uint16_t{0x200});
+    EXPECT_FALSE(snapshot.FindCapability(CxlCacheMemCapId::kIde).has_value());
+}
+
+TEST(CxlComponentTest, DecodesHdmDecoders) {
+    FakeCxlFunction fn;
+    fn.Put32(kHdm, 0x1 | (2u << 4));  // 2 decoders, 2 targets
+    fn.Put32(kHdm + 0x04, 1u << 1);   // enabled
+    // Decoder 0: 16 GiB at 0x10_0000_0000, 2-way x 4 KiB, committed, locked.
+    fn.Put32(kHdm + 0x10, 0x0FFFFFFF);  // low bits below 28 are reserved
+    fn.Put32(kHdm + 0x14, 0x10);
+    fn.Put32(kHdm + 0x18, 0);
+    fn.Put32(kHdm + 0x1C, 0x4);
+    fn.Put32(kHdm + 0x20, 0x4 | (1u << 4) | (1u << 8) | (1u << 10) | (1u << 12));
+    fn.Put32(kHdm + 0x24, 0x0201);
+    // Decoder 1: 3-way, error not committed.
+    fn.Put32(kHdm + 0x40, (8u << 4) | (1u << 11));
+
+    CxlComponentRegisters regs(fn, kBdf, {kBar, kCacheMem});
+    auto snapshot = regs.Snapshot();
+    ASSERT_TRUE(snapshot.IsOk());
+    auto hdm = snapshot.Value().HdmDecoders();
+    ASSERT_TRUE(hdm.IsOk());
+    EXPECT_EQ(hdm.Value().decoder_count, 2u);
+    EXPECT_EQ(hdm.Value().target_count, 2u);
+    EXPECT_TRUE(hdm.Value().enabled);
+    ASSERT_EQ(hdm.Value().decoders.size(), 2u);
+
+    const auto& d0 = hdm.Value().decoders[0];
+    EXPECT_EQ(d0.base, 0x10'0000'0000u);
+    EXPECT_EQ(d0.size, 0x4'0000'0000u);
+    EXPECT_EQ(d0.interleave_ways, 2u);
+    EXPECT_EQ(d0.interleave_granularity, 4096u);
+    EXPECT_TRUE(d0.lock_on_commit);
+    EXPECT_TRUE(d0.committed);
+    EXPECT_FALSE(d0.error_not_committed);
+    EXPECT_TRUE(d0.host_only);
+    EXPECT_EQ(d0.target_list_or_dpa_skip, 0x0201u);
+
+    const auto& d1 = hdm.Value().decoders[1];
+    EXPECT_EQ(d1.index, 1u);
+    EXPECT_EQ(d1.interleave_ways, 3u);
+    EXPECT_FALSE(d1.committed);
+    EXPECT_TRUE(d1.error_not_committed);
+}
+
+TEST(CxlComponentTest, DecodesRasStatus) {
+    FakeCxlFunction fn;
+    fn.Put32(kRas + 0x00, (1u << 2) | (1u << 5));  // status
+    fn.Put32(kRas + 0x04, 1u << 5);                // mask
+    fn.Put32(kRas + 0x08, 1u << 2);                // severity
+    fn.Put32(kRas + 0x0C, 1u << 1);
+    fn.Put32(kRas + 0x14, 2);                      // first error pointer
+    fn.Put32(kRas + 0x18, 0xCAFE0000);
+    fn.Put32(kRas + 0x54, 0x0000BEEF);
+
+    CxlComponentRegisters regs(fn, kBdf, {kBar, kCacheMem});
+    auto ras = regs.Snapshot().Value().Ras();
+    ASSERT_TRUE(ras.IsOk());
+    EXPECT_EQ(ras.Value().UncorrectablePending(), 1u << 2);
+    EXPECT_EQ(ras.Value().uncorrectable_severity, 1u << 2);
+    EXPECT_EQ(ras.Value().CorrectablePending(), 1u << 1);
+    EXPECT_EQ(ras.Value().first_error, 2u);
+    EXPECT_EQ(ras.Value().header_log[0], 0xCAFE0000u);
+    EXPECT_EQ(ras.Value().header_log[15], 0x0000BEEFu);
+}
+
+TEST(CxlComponentTest, MissingCapabilityIsNotFound) {
+    CxlComponentSnapshot snapshot;  // all zero: no CXL Capability Header
+    auto hdm = snapshot.HdmDecoders();
+    ASSERT_TRUE(hdm.IsError());
+    EXPECT_EQ(hdm.Error(), core::ErrorCode::kNotFound);
+    EXPECT_TRUE(snapshot.Ras().IsError());
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "plas/hal/interface/pci/cxl_dvsec.h"
+
+namespace plas::hal::pci {
+namespace {
+
+// Append an extended capability header at `offset` pointing to `next`.
+void PutExtHeader(std::vector<core::Byte>& config, std::size_t offset,
+                  uint16_t cap_id, std::size_t next) {
+    uint32_t header = static_cast<uint32_t>(cap_id) | (1u << 16) |
+                      (static_cast<uint32_t>(next) << 20);
+    std::memcpy(&config[offset], &header, sizeof(header));
+}
+
+void PutDvsec(std::vector<core::Byte>& config, std::size_t offset,
+              std::size_t next, uint16_t vendor, uint16_t id,
+              uint16_t length, uint8_t revision = 1) {
+    PutExtHeader(config, offset, static_cast<uint16_t>(ExtCapabilityId::kDvsec),
+                 next);
+    uint32_t header1 = vendor | (static_cast<uint32_t>(revision) << 16) |
+                       (static_cast<uint32_t>(length) << 20);
+    std::memcpy(&config[offset + 4], &header1, sizeof(header1));
+    std::memcpy(&config[offset + 8], &id, sizeof(id));
+}
+
+void PutRegisterBlock(std::vector<core::Byte>& config, std::size_t offset,
+                      uint8_t bir, CxlRegisterBlockId block_id,
+                      uint64_t block_offset) {
+    uint32_t low = (bir & 0x7u) |
+                   (static_cast<uint32_t>(block_id) << 8) |
+                   static_cast<uint32_t>(block_offset & 0xFFFF0000u);
+    uint32_t high = static_cast<uint32_t>(block_offset >> 32);
+    std::memcpy(&config[offset], &low, sizeof(low));
+    std::memcpy(&config[offset + 4], &high, sizeof(high));
+}
+
+// CXL Device DVSEC at 0x100, a non-CXL DVSEC at 0x140 and a Register
+// Locator at 0x180 with three entries (the second one empty).
+std::vector<core::Byte> BuildCxlConfig(uint16_t cxl_capability) {
+    std::vector<core::Byte> config(4096, 0);
+    PutDvsec(config, 0x100, 0x140, cxl::kCxlVendorId,
+             static_cast<uint16_t>(CxlDvsecId::kCxlDevice), 0x3C, 2);
+    std::memcpy(&config[0x10A], &cxl_capability, sizeof(cxl_capability));
+    PutDvsec(config, 0x140, 0x180, 0x8086, 0x0000, 0x10);
+    PutDvsec(config, 0x180, 0, cxl::kCxlVendorId,
+             static_cast<uint16_t>(CxlDvsecId::kRegisterLocator), 0x24);
+    PutRegisterBlock(config, 0x18C, 0, CxlRegisterBlockId::kComponentRegister,
+                     0x10000);
+    PutRegisterBlock(config, 0x194, 0, CxlRegisterBlockId::kEmpty, 0);
+    PutRegisterBlock(config, 0x19C, 2, CxlRegisterBlockId::kCxlDeviceRegister,
+                     0x100020000ULL);
+    return config;
+}
+
+CxlDvsecIndex ParseConfig(const std::vector<core::Byte>& config) {
+    auto caps = CapabilityIndex::Parse(config.data(), config.size());
+    return CxlDvsecIndex::Parse(config.data(), config.size(), caps);
+}
+
+TEST(CxlDvsecIndexTest, ParsesCxlDvsecHeaders) {
+    auto index = ParseConfig(BuildCxlConfig(0x0004));
+    ASSERT_EQ(index.dvsecs.size(), 2u);  // vendor 0x8086 DVSEC skipped
+    EXPECT_EQ(index.dvsecs[0],
+              (DvsecHeader{0x100, cxl::kCxlVendorId, 2,
+                           CxlDvsecId::kCxlDevice, 0x3C}));
+    EXPECT_EQ(index.dvsecs[1],
+              (DvsecHeader{0x180, cxl::kCxlVendorId, 1,
+                           CxlDvsecId::kRegisterLocator, 0x24}));
+}
+
+TEST(CxlDvsecIndexTest, FindById) {
+    auto index = ParseConfig(BuildCxlConfig(0x0004));
+    auto locator = index.Find(CxlDvsecId::kRegisterLocator);
+    ASSERT_TRUE(locator.has_value());
+    EXPECT_EQ(locator->offset, 0x180);
+    EXPECT_FALSE(index.Find(CxlDvsecId::kFlexBusPort).has_value());
+}
+
+TEST(CxlDvsecIndexTest, RegisterBlocksSkipEmptyEntries) {
+    auto index = ParseConfig(BuildCxlConfig(0x0004));
+    std::vector<RegisterBlockEntry> expected = {
+        {CxlRegisterBlockId::kComponentRegister, 0, 0x10000},
+        {CxlRegisterBlockId::kCxlDeviceRegister, 2, 0x100020000ULL},
+    };
+    EXPECT_EQ(index.register_blocks, expected);
+}
+
+TEST(CxlDvsecIndexTest, DeviceTypeFromCapability) {
+    // Cache_Capable (bit 0), IO_Capable (bit 1), Mem_Capable (bit 2).
+    EXPECT_EQ(ParseConfig(BuildCxlConfig(0x0003)).device_type,
+              CxlDeviceType::kType1);
+    EXPECT_EQ(ParseConfig(BuildCxlConfig(0x0007)).device_type,
+              CxlDeviceType::kType2);
+    EXPECT_EQ(ParseConfig(BuildCxlConfig(0x0006)).device_type,
+              CxlDeviceType::kType3);
+    EXPECT_EQ(ParseConfig(BuildCxlConfig(0x0002)).device_type,
+              CxlDeviceType::kUnknown);
+}
+
+TEST(CxlDvsecIndexTest, NoDvsecs) {
+    std::vector<core::Byte> config(4096, 0);
+    auto index = ParseConfig(config);
+    EXPECT_TRUE(index.dvsecs.empty());
+    EXPECT_TRUE(index.register_blocks.empty());
+    EXPECT_EQ(index.device_type, CxlDeviceType::kUnknown);
+}
+
+TEST(CxlDvsecIndexTest, TruncatedSnapshot) {
+    auto config = BuildCxlConfig(0x0004);
+    auto caps = CapabilityIndex::Parse(config.data(), config.size());
+    // Entries past the end of the snapshot are not read.
+    auto index = CxlDvsecIndex::Parse(config.data(), 0x194, caps);
+    ASSERT_EQ(index.dvsecs.size(), 2u);
+    ASSERT_EQ(index.register_blocks.size(), 1u);
+    EXPECT_EQ(index.register_blocks[0].block_id,
+              CxlRegisterBlockId::kComponentRegister);
+
+    EXPECT_TRUE(CxlDvsecIndex::Parse(nullptr, 0, caps).dvsecs.empty());
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
@@ -0,0 +1,338 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include <unistd.h>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/cxl_firmware.h"
+#include "plas/hal/interface/pci/cxl_mailbox.h"
+
+namespace plas::hal::pci {
+namespace {
+
+using Code = CxlMailboxReturnCode;
+
+constexpr Bdf kBdf{0x03, 0x00, 0x00};
+
+/// One Transfer FW part as the device received it.
+struct Part {
+    CxlFwTransferAction action;
+    uint8_t slot;
+    uint32_t offset_units;
+    std::vector<uint8_t> data;
+};
+
+/// Mailbox that accepts Transfer FW parts. Scripted return codes are handed
+/// out first (one per command), then kSuccess; kBackgroundCmdStarted makes
+/// GetBackgroundCmdStatus report "running" for background_polls_ calls.
+/// Only the base ExecuteCommandGather (concatenating) path is exercised.
+class FakeFwMailbox : public CxlMailbox {
+public:
+    plas::hal::Device* GetDevice() override { return nullptr; }
+
+    core::Result<CxlMailboxResult> ExecuteCommand(
+        Bdf bdf, CxlMailboxOpcode opcode,
+        const CxlMailboxPayload& payload) override {
+        return ExecuteCommand(bdf, static_cast<uint16_t>(opcode), payload);
+    }
+
+    core::Result<CxlMailboxResult> ExecuteCommand(
+        Bdf, uint16_t raw_opcode, const CxlMailboxPayload& payload) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++commands_;
+        if (raw_opcode != static_cast<uint16_t>(CxlMailboxOpcode::kTransferFw) ||
+            payload.size() < kCxlFwTransferHeaderSize ||
+            payload.size() > payload_size_) {
+            return core::Result<CxlMailboxResult>::Ok(
+                {Code::kInvalidInput, {}});
+        }
+        Code code = Code::kSuccess;
+        if (!script_.empty()) {
+            code = script_.front();
+            script_.pop_front();
+        }
+        if (code == Code::kBackgroundCmdStarted) {
+            polls_left_ = background_polls_;
+        }
+        if (!IsRetry(code)) {
+            Part part;
+            part.action = static_cast<CxlFwTransferAction>(payload[0]);
+            part.slot = payload[1];
+            part.offset_units = static_cast<uint32_t>(
+                payload[4] | (payload[5] << 8) | (payload[6] << 16) |
+                (payload[7] << 24));
+            part.data.assign(payload.begin() + kCxlFwTransferHeaderSize,
+                             payload.end());
+            parts_.push_back(std::move(part));
+        }
+        return core::Result<CxlMailboxResult>::Ok({code, {}});
+    }
+
+    core::Result<uint32_t> GetPayloadSize(Bdf) override {
+        return core::Result<uint32_t>::Ok(payload_size_);
+    }
+
+    core::Result<bool> IsReady(Bdf) override {
+        return core::Result<bool>::Ok(true);
+    }
+
+    core::Result<CxlMailboxResult> GetBackgroundCmdStatus(Bdf) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (polls_left_ > 0) {
+            --polls_left_;
+            return core::Result<CxlMailboxResult>::Ok(
+                {Code::kBackgroundCmdStarted, {}});
+        }
+        return core::Result<CxlMailboxResult>::Ok({background_result_, {}});
+    }
+
+    /// Image bytes reassembled from the data parts.
+    std::vector<uint8_t> Received() const {
+        std::vector<uint8_t> image;
+        for (const auto& part : parts_) {
+            if (part.action == CxlFwTransferAction::kAbort) continue;
+            std::size_t offset = part.offset_units * kCxlFwTransferUnit;
+            if (image.size() < offset + part.data.size()) {
+                image.resize(offset + part.data.size());
+            }
+            std::copy(part.data.begin(), part.data.end(),
+                      image.begin() + static_cast<std::ptrdiff_t>(offset));
+        }
+        return image;
+    }
+
+    uint32_t payload_size_ = 256;
+    std::deque<Code> script_;
+    int background_polls_ = 0;
+    Code background_result_ = Code::kSuccess;
+    std::vector<Part> parts_;
+    int commands_ = 0;
+
+private:
+    static bool IsRetry(Code code) {
+        return code == Code::kBusy || code == Code::kRetryRequired;
+    }
+
+    int polls_left_ = 0;
+    std::mutex mutex_;
+};
+
+std::vector<uint8_t> MakeImage(std::size_t size) {
+    std::vector<uint8_t> image(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        image[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+    return image;
+}
+
+CxlFwTransferOptions FastOptions() {
+    CxlFwTransferOptions options;
+    options.slot = 2;
+    options.backoff = std::chrono::microseconds(1);
+    options.max_backoff = std::chrono::microseconds(8);
+    options.background_poll = std::chrono::microseconds(1);
+    options.chunk_timeout = std::chrono::milliseconds(1000);
+    return options;
+}
+
+TEST(CxlFirmwareTest, SmallImageUsesFullTransfer) {
+    FakeFwMailbox mailbox;
+    mailbox.payload_size_ = 512;
+    auto image = MakeImage(200);
+
+    auto result = TransferFirmware(mailbox, kBdf, image.data(), image.size(),
+                                   FastOptions());
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), Code::kSuccess);
+    ASSERT_EQ(mailbox.parts_.size(), 1u);
+    EXPECT_EQ(mailbox.parts_[0].action, CxlFwTransferAction::kFull);
+    EXPECT_EQ(mailbox.parts_[0].slot, 2);
+    EXPECT_EQ(mailbox.parts_[0].data, image);
+}
+
+TEST(CxlFirmwareTest, LargeImageIsSplitIntoParts) {
+    FakeFwMailbox mailbox;  // 256-byte payload: 128 bytes of data per part
+    auto image = MakeImage(300);
+    std::vector<std::size_t> progress;
+
+    auto result = TransferFirmware(
+        mailbox, kBdf, image.data(), image.size(), FastOptions(),
+        [&](const CxlFwProgress& p) {
+            EXPECT_EQ(p.total, image.size());
+            progress.push_back(p.bytes_sent);
+        });
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), Code::kSuccess);
+
+    ASSERT_EQ(mailbox.parts_.size(), 3u);
+    EXPECT_EQ(mailbox.parts_[0].action, CxlFwTransferAction::kInitiate);
+    EXPECT_EQ(mailbox.parts_[1].action, CxlFwTransferAction::kContinue);
+    EXPECT_EQ(mailbox.parts_[2].action, CxlFwTransferAction::kEnd);
+    EXPECT_EQ(mailbox.parts_[1].offset_units, 1u);
+    EXPECT_EQ(mailbox.parts_[2].offset_units, 2u);
+    EXPECT_EQ(mailbox.parts_[2].slot, 2);
+    EXPECT_EQ(mailbox.parts_[2].data.size(), 44u);
+    EXPECT_EQ(mailbox.Received(), image);
+    EXPECT_EQ(progress, (std::vector<std::size_t>{128, 256, 300}));
+}
+
+TEST(CxlFirmwareTest, BusyAndRetryRequiredAreRetried) {
+    FakeFwMailbox mailbox;
+    mailbox.script_ = {Code::kBusy, Code::kRetryRequired, Code::kSuccess,
+                       Code::kBusy};
+    auto image = MakeImage(256);
+
+    auto result = TransferFirmware(mailbox, kBdf, image.data(), image.size(),
+                                   FastOptions());
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), Code::kSuccess);
+    EXPECT_EQ(mailbox.commands_, 5);
+    EXPECT_EQ(mailbox.parts_.size(), 2u);
+    EXPECT_EQ(mailbox.Received(), image);
+}
+
+TEST(CxlFirmwareTest, BackgroundPartIsPolledToCompletion) {
+    FakeFwMailbox mailbox;
+    mailbox.script_ = {Code::kBackgroundCmdStarted};
+    mailbox.background_polls_ = 3;
+    auto image = MakeImage(100);
+
+    auto result = TransferFirmware(mailbox, kBdf, image.data(), image.size(),
+                                   FastOptions());
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), Code::kSuccess);
+    EXPECT_EQ(mailbox.commands_, 1);
+
+    mailbox.parts_.clear();
+    mailbox.script_ = {Code::kBackgroundCmdStarted};
+    mailbox.background_result_ = Code::kFwAuthenticationFailed;
+    result = TransferFirmware(mailbox, kBdf, image.data(), image.size(),
+                              FastOptions());
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), Code::kFwAuthenticationFailed);
+}
+
+TEST(CxlFirmwareTest, RejectedPartAbortsTransfer) {
+    FakeFwMailbox mailbox;
+    mailbox.script_ = {Code::kSuccess, Code::kFwTransferOutOfOrder};
+    auto image = MakeImage(400);
+
+    auto result = TransferFirmware(mailbox, kBdf, image.data(), image.size(),
+                                   FastOptions());
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), Code::kFwTransferOutOfOrder);
+    ASSERT_EQ(mailbox.parts_.size(), 3u);
+    EXPECT_EQ(mailbox.parts_.back().action, CxlFwTransferAction::kAbort);
+    EXPECT_TRUE(mailbox.parts_.back().data.empty());
+}
+
+TEST(CxlFirmwareTest, PersistentBusyTimesOut) {
+    FakeFwMailbox mailbox;
+    mailbox.script_.assign(100000, Code::kBusy);
+    auto options = FastOptions();
+    options.chunk_timeout = std::chrono::milliseconds(5);
+    auto image = MakeImage(64);
+
+    auto result =
+        TransferFirmware(mailbox, kBdf, image.data(), image.size(), options);
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kTimeout));
+}
+
+TEST(CxlFirmwareTest, PayloadTooSmallForHeader) {
+    FakeFwMailbox mailbox;
+    mailbox.payload_size_ = 128;
+    auto image = MakeImage(64);
+    auto result = TransferFirmware(mailbox, kBdf, image.data(), image.size());
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+}
+
+TEST(CxlFirmwareTest, TransferAllRunsEveryTarget) {
+    constexpr std::size_t kTargets = 8;
+    std::vector<FakeFwMailbox> mailboxes(kTargets);
+    std::vector<CxlFwTarget> targets;
+    for (std::size_t i = 0; i < kTargets; ++i) {
+        mailboxes[i].script_ = {Code::kBusy, Code::kSuccess, Code::kBusy};
+        targets.push_back({&mailboxes[i], Bdf{static_cast<uint8_t>(i), 0, 0}});
+    }
+    mailboxes[3].script_ = {Code::kInvalidSlot};
+    targets.push_back({nullptr, Bdf{0xFF, 0, 0}});
+    auto image = MakeImage(1000);
+
+    std::atomic<std::size_t> reports{0};
+    std::vector<std::atomic<std::size_t>> sent(kTargets + 1);
+    auto options = FastOptions();
+    options.max_parallel = 4;
+    auto results = TransferFirmwareAll(
+        targets, image.data(), image.size(), options,
+        [&](const CxlFwProgress& p) {
+            reports.fetch_add(1);
+            sent[p.target].store(p.bytes_sent);
+        });
+
+    ASSERT_EQ(results.size(), kTargets + 1);
+    for (std::size_t i = 0; i < kTargets; ++i) {
+        ASSERT_TRUE(results[i].IsOk()) << i;
+        if (i == 3) {
+            EXPECT_EQ(results[i].Value(), Code::kInvalidSlot);
+            EXPECT_EQ(sent[i].load(), 0u);
+            continue;
+        }
+        EXPECT_EQ(results[i].Value(), Code::kSuccess) << i;
+        EXPECT_EQ(mailboxes[i].Received(), image) << i;
+        EXPECT_EQ(sent[i].load(), image.size()) << i;
+    }
+    EXPECT_TRUE(results[kTargets].IsError());
+    // 1000 bytes in 128-byte parts: 8 reports per successful target.
+    EXPECT_EQ(reports.load(), (kTargets - 1) * 8);
+}
+
+TEST(CxlFirmwareTest, ImageOpenMapsFile) {
+    char tmpl[] = "/tmp/plas_test_cxlfw_XXXXXX";
+    int fd = ::mkstemp(tmpl);
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+    std::string path = tmpl;
+    auto bytes = MakeImage(5000);
+    {
+        std::ofstream f(path, std::ios::binary);
+        f.write(reinterpret_cast<const char*>(bytes.data()),
+                static_cast<std::streamsize>(bytes.size()));
+    }
+
+    auto image = CxlFirmwareImage::Open(path);
+    ASSERT_TRUE(image.IsOk());
+    CxlFirmwareImage moved = std::move(image.Value());
+    ASSERT_EQ(moved.size(), bytes.size());
+    EXPECT_TRUE(std::equal(bytes.begin(), bytes.end(), moved.data()));
+    EXPECT_EQ(image.Value().data(), nullptr);
+
+    FakeFwMailbox mailbox;
+    mailbox.payload_size_ = 1024;
+    auto result = TransferFirmware(mailbox, kBdf, moved.data(), moved.size(),
+                                   FastOptions());
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(mailbox.Received(), bytes);
+
+    { std::ofstream truncate(path, std::ios::binary); }
+    auto empty = CxlFirmwareImage::Open(path);
+    EXPECT_EQ(empty.Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    ::unlink(path.c_str());
+
+    auto missing = CxlFirmwareImage::Open(path);
+    EXPECT_EQ(missing.Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
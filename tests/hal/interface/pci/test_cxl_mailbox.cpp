@@ -221,5 +221,30 @@ TEST(CxlMailboxTest, GetBackgroundCmdStatusError) {
     ASSERT_TRUE(result.IsError());
 }
 
+// --- ExecuteCommandPooled (default implementation) ---
+
+TEST(CxlMailboxTest, ExecuteCommandPooledCopiesResult) {
+    MockCxlMailboxDevice device;
+    device.execute_result_ = {CxlMailboxReturnCode::kSuccess, {0xA1, 0xB2}};
+    Bdf bdf{0x00, 0x03, 0x00};
+    const uint8_t input[] = {0x01, 0x02, 0x03};
+
+    auto result = device.ExecuteCommandPooled(bdf, 0x4200, input, 3);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(device.last_opcode_, 0x4200);
+    EXPECT_EQ(device.last_payload_, (CxlMailboxPayload{0x01, 0x02, 0x03}));
+    EXPECT_EQ(result.Value().return_code, CxlMailboxReturnCode::kSuccess);
+    EXPECT_TRUE(result.Value().payload == (CxlMailboxPayload{0xA1, 0xB2}));
+}
+
+TEST(CxlMailboxTest, ExecuteCommandPooledError) {
+    MockCxlMailboxDevice device;
+    device.execute_error_ = true;
+    Bdf bdf{0x00, 0x03, 0x00};
+
+    auto result = device.ExecuteCommandPooled(bdf, 0x4200, nullptr, 0);
+    ASSERT_TRUE(result.IsError());
+}
+
 }  // namespace
 }  // namespace plas::hal::pci
@@ -0,0 +1,408 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/cxl.h"
+#include "plas/hal/interface/pci/cxl_mmio_mailbox.h"
+#include "plas/hal/interface/pci/pci_bar.h"
+
+namespace plas::hal::pci {
+namespace {
+
+constexpr uint8_t kBar = 2;
+constexpr uint64_t kBlockOffset = 0x10000;           // CXL Device registers
+constexpr uint64_t kMailbox = kBlockOffset + 0x800;  // Primary Mailbox
+constexpr uint64_t kControl = kMailbox + 0x04;
+constexpr uint64_t kCommand = kMailbox + 0x08;
+constexpr uint64_t kStatus = kMailbox + 0x10;
+constexpr uint64_t kBackground = kMailbox + 0x18;
+constexpr uint64_t kPayload = kMailbox + 0x20;
+
+/// BAR 2 as plain memory with a CXL Device register block, plus a device
+/// model that answers commands when the doorbell is rung.
+class FakeCxlFunction : public PciBar, public Cxl {
+public:
+    FakeCxlFunction() : bar_(0x20000, 0) {
+        Put64(kBlockOffset, uint64_t{2} << 32);                 // 2 caps
+        Put64(kBlockOffset + 0x10, 0x0001 | (uint64_t{0x100} << 32));
+        Put64(kBlockOffset + 0x20, 0x0002 | (uint64_t{0x800} << 32));
+        Put32(kMailbox, 8);  // 256-byte payload
+    }
+
+    plas::hal::Device* GetDevice() override { return nullptr; }
+
+    // -- Cxl (only the Register Locator matters here) --
+    core::Result<std::vector<DvsecHeader>> EnumerateCxlDvsecs(Bdf) override {
+        return core::Result<std::vector<DvsecHeader>>::Ok({});
+    }
+    core::Result<std::optional<DvsecHeader>> FindCxlDvsec(
+        Bdf, CxlDvsecId) override {
+        return core::Result<std::optional<DvsecHeader>>::Ok(std::nullopt);
+    }
+    core::Result<CxlDeviceType> GetCxlDeviceType(Bdf) override {
+        return core::Result<CxlDeviceType>::Ok(CxlDeviceType::kType3);
+    }
+    core::Result<std::vector<RegisterBlockEntry>> GetRegisterBlocks(
+        Bdf) override {
+        return core::Result<std::vector<RegisterBlockEntry>>::Ok(blocks_);
+    }
+    core::Result<core::DWord> ReadDvsecRegister(Bdf, ConfigOffset,
+                                                uint16_t) override {
+        return core::Result<core::DWord>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> WriteDvsecRegister(Bdf, ConfigOffset, uint16_t,
+                                          core::DWord) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    // -- PciBar --
+    core::Result<core::DWord> BarRead32(Bdf, uint8_t, uint64_t offset) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++reads_;
+        return core::Result<core::DWord>::Ok(Get32(offset));
+    }
+    core::Result<core::QWord> BarRead64(Bdf, uint8_t, uint64_t offset) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++reads_;
+        return core::Result<core::QWord>::Ok(Get64(offset));
+    }
+    core::Result<void> BarWrite32(Bdf, uint8_t, uint64_t offset,
+                                  core::DWord value) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Put32(offset, value);
+        if (offset == kControl && (value & 1) && auto_complete_) {
+            CompleteLocked();
+        }
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> BarWrite64(Bdf, uint8_t, uint64_t offset,
+                                  core::QWord value) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Put64(offset, value);
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> BarReadBuffer(Bdf, uint8_t, uint64_t offset,
+                                     void* buffer, std::size_t length) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++buffer_reads_;
+        std::memcpy(buffer, &bar_[offset], length);
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> BarWriteBuffer(Bdf, uint8_t, uint64_t offset,
+                                      const void* buffer,
+                                      std::size_t length) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++buffer_writes_;
+        std::memcpy(&bar_[offset], buffer, length);
+        return core::Result<void>::Ok();
+    }
+
+    /// Device side: answer the pending command and clear the doorbell. The
+    /// response is the input payload reversed; kSanitize starts a
+    /// background operation instead.
+    void Complete() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        CompleteLocked();
+    }
+
+    void FinishBackground(CxlMailboxReturnCode code) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Put64(kStatus, 0);
+        uint64_t bg = Get64(kBackground) & 0xFFFF;
+        Put64(kBackground,
+              bg | (uint64_t{100} << 16) |
+                  (static_cast<uint64_t>(code) << 32));
+    }
+
+    std::vector<RegisterBlockEntry> blocks_ = {
+        {CxlRegisterBlockId::kComponentRegister, 0, 0},
+        {CxlRegisterBlockId::kCxlDeviceRegister, kBar, kBlockOffset},
+    };
+    bool auto_complete_ = true;
+    int reads_ = 0;
+    int buffer_reads_ = 0;
+    int buffer_writes_ = 0;
+    std::vector<uint16_t> opcodes_;
+
+private:
+    void CompleteLocked() {
+        uint64_t command = Get64(kCommand);
+        auto opcode = static_cast<uint16_t>(command & 0xFFFF);
+        std::size_t length = (command >> 16) & 0x1FFFFF;
+        opcodes_.push_back(opcode);
+        if (opcode == static_cast<uint16_t>(CxlMailboxOpcode::kSanitize)) {
+            Put64(kStatus,
+                  1 | (static_cast<uint64_t>(
+                           CxlMailboxReturnCode::kBackgroundCmdStarted)
+                       << 32));
+            Put64(kBackground, opcode | (uint64_t{40} << 16));
+            Put64(kCommand, opcode);  // no output payload
+        } else {
+            std::reverse(&bar_[kPayload], &bar_[kPayload] + length);
+            Put64(kStatus, 0);
+        }
+        Put32(kControl, Get32(kControl) & ~1u);
+    }
+
+    uint32_t Get32(uint64_t offset) const {
+        uint32_t value;
+        std::memcpy(&value, &bar_[offset], sizeof(value));
+        return value;
+    }
+    uint64_t Get64(uint64_t offset) const {
+        uint64_t value;
+        std::memcpy(&value, &bar_[offset], sizeof(value));
+        return value;
+    }
+    void Put32(uint64_t offset, uint32_t value) {
+        std::memcpy(&bar_[offset], &value, sizeof(value));
+    }
+    void Put64(uint64_t offset, uint64_t value) {
+        std::memcpy(&bar_[offset], &value, sizeof(value));
+    }
+
+    std::vector<uint8_t> bar_;
+    std::mutex mutex_;
+};
+
+constexpr Bdf kBdf{0x03, 0x00, 0x00};
+
+CxlMmioMailboxOptions FastOptions() {
+    CxlMmioMailboxOptions options;
+    options.timeout = std::chrono::milliseconds(20);
+    options.spin = std::chrono::microseconds(0);
+    options.poll_interval = std::chrono::microseconds(10);
+    return options;
+}
+
+TEST(CxlMmioMailboxTest, LocateFindsPrimaryMailbox) {
+    FakeCxlFunction fn;
+    auto location = CxlMmioMailbox::Locate(fn, fn, kBdf);
+    ASSERT_TRUE(location.IsOk());
+    EXPECT_EQ(location.Value(), (CxlMailboxLocation{kBar, kMailbox}));
+}
+
+TEST(CxlMmioMailboxTest, LocateWithoutDeviceRegisterBlock) {
+    FakeCxlFunction fn;
+    fn.blocks_.pop_back();
+    auto location = CxlMmioMailbox::Locate(fn, fn, kBdf);
+    ASSERT_TRUE(location.IsError());
+    EXPECT_EQ(location.Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+}
+
+TEST(CxlMmioMailboxTest, ExecuteRoundTrip) {
+    FakeCxlFunction fn;
+    CxlMmioMailbox mailbox(fn, kBdf, {kBar, kMailbox}, FastOptions());
+    EXPECT_EQ(mailbox.PayloadSize().Value(), 256u);
+    EXPECT_TRUE(mailbox.IsReady().Value());
+
+    auto result = mailbox.Execute(
+        static_cast<uint16_t>(CxlMailboxOpcode::kGetHealthInfo),
+        {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value().return_code, CxlMailboxReturnCode::kSuccess);
+    EXPECT_EQ(result.Value().payload,
+              (CxlMailboxPayload{11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1}));
+    EXPECT_EQ(fn.opcodes_,
+              std::vector<uint16_t>{static_cast<uint16_t>(
+                  CxlMailboxOpcode::kGetHealthInfo)});
+    // Payload moves as one buffer copy each way.
+    EXPECT_EQ(fn.buffer_writes_, 1);
+    EXPECT_EQ(fn.buffer_reads_, 1);
+}
+
+TEST(CxlMmioMailboxTest, ExecuteGathersHeaderAndData) {
+    FakeCxlFunction fn;
+    CxlMmioMailbox mailbox(fn, kBdf, {kBar, kMailbox}, FastOptions());
+    const uint8_t header[] = {1, 2, 3};
+    const uint8_t data[] = {4, 5};
+
+    auto result = mailbox.Execute(0x0201, header, sizeof(header), data,
+                                  sizeof(data));
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value().payload, (CxlMailboxPayload{5, 4, 3, 2, 1}));
+    // Each part goes straight into the payload registers.
+    EXPECT_EQ(fn.buffer_writes_, 2);
+
+    auto too_large = mailbox.Execute(0x0201, header, sizeof(header), data,
+                                     254);
+    EXPECT_EQ(too_large.Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    auto null_data = mailbox.Execute(0x0201, header, sizeof(header), nullptr,
+                                     1);
+    EXPECT_EQ(null_data.Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
+TEST(CxlMmioMailboxTest, ExecutePooledSteadyStateDoesNotAllocate) {
+    FakeCxlFunction fn;
+    CxlMmioMailbox mailbox(fn, kBdf, {kBar, kMailbox}, FastOptions());
+    const uint8_t input[] = {1, 2, 3, 4};
+
+    // Warm the thread's cache with one result of this size class.
+    ASSERT_TRUE(mailbox.ExecutePooled(0x0001, input, sizeof(input)).IsOk());
+    auto before = core::BufferPool::ThreadStats();
+    for (int i = 0; i < 100; ++i) {
+        auto result = mailbox.ExecutePooled(0x0001, input, sizeof(input));
+        ASSERT_TRUE(result.IsOk());
+        ASSERT_TRUE(result.Value().payload == (CxlMailboxPayload{4, 3, 2, 1}));
+    }
+    auto after = core::BufferPool::ThreadStats();
+    EXPECT_EQ(after.allocations, before.allocations);
+    EXPECT_EQ(after.reuses, before.reuses + 100);
+}
+
+TEST(CxlMmioMailboxTest, PayloadTooLarge) {
+    FakeCxlFunction fn;
+    CxlMmioMailbox mailbox(fn, kBdf, {kBar, kMailbox}, FastOptions());
+    auto result = mailbox.Execute(0x0001, CxlMailboxPayload(257));
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    EXPECT_TRUE(fn.opcodes_.empty());
+}
+
+TEST(CxlMmioMailboxTest, DoorbellTimeoutThenBusy) {
+    FakeCxlFunction fn;
+    fn.auto_complete_ = false;
+    CxlMmioMailbox mailbox(fn, kBdf, {kBar, kMailbox}, FastOptions());
+
+    auto result = mailbox.Execute(0x0001, {});
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kTimeout));
+
+    // The device still holds the doorbell.
+    EXPECT_FALSE(mailbox.IsReady().Value());
+    auto busy = mailbox.Execute(0x0001, {});
+    ASSERT_TRUE(busy.IsError());
+    EXPECT_EQ(busy.Error(), core::make_error_code(core::ErrorCode::kBusy));
+
+    fn.Complete();
+    EXPECT_TRUE(mailbox.IsReady().Value());
+}
+
+TEST(CxlMmioMailboxTest, SubmitAndTryComplete) {
+    FakeCxlFunction fn;
+    fn.auto_complete_ = false;
+    CxlMmioMailbox mailbox(fn, kBdf, {kBar, kMailbox}, FastOptions());
+
+    ASSERT_TRUE(mailbox.Submit(0x4200, {1, 2}).IsOk());
+    EXPECT_FALSE(mailbox.IsReady().Value());
+    auto busy = mailbox.Submit(0x4200, {});
+    EXPECT_EQ(busy.Error(), core::make_error_code(core::ErrorCode::kBusy));
+
+    auto pending = mailbox.TryComplete();
+    ASSERT_TRUE(pending.IsOk());
+    EXPECT_FALSE(pending.Value().has_value());
+
+    fn.Complete();
+    auto done = mailbox.TryComplete();
+    ASSERT_TRUE(done.IsOk());
+    ASSERT_TRUE(done.Value().has_value());
+    EXPECT_EQ(done.Value()->payload, (CxlMailboxPayload{2, 1}));
+
+    auto none = mailbox.TryComplete();
+    ASSERT_TRUE(none.IsError());
+    EXPECT_EQ(none.Error(), core::make_error_code(core::ErrorCode::kNotFound));
+}
+
+TEST(CxlMmioMailboxTest, BackgroundCommand) {
+    FakeCxlFunction fn;
+    CxlMmioMailbox mailbox(fn, kBdf, {kBar, kMailbox}, FastOptions());
+
+    auto started = mailbox.Execute(
+        static_cast<uint16_t>(CxlMailboxOpcode::kSanitize), {});
+    ASSERT_TRUE(started.IsOk());
+    EXPECT_EQ(started.Value().return_code,
+              CxlMailboxReturnCode::kBackgroundCmdStarted);
+    EXPECT_TRUE(started.Value().payload.empty());
+
+    auto running = mailbox.GetBackgroundStatus();
+    ASSERT_TRUE(running.IsOk());
+    EXPECT_TRUE(running.Value().running);
+    EXPECT_EQ(running.Value().opcode,
+              static_cast<uint16_t>(CxlMailboxOpcode::kSanitize));
+    EXPECT_EQ(running.Value().percent_complete, 40);
+
+    // The mailbox itself is free for foreground commands meanwhile.
+    EXPECT_TRUE(mailbox.Execute(0x0001, {7}).IsOk());
+
+    fn.FinishBackground(CxlMailboxReturnCode::kSuccess);
+    auto finished = mailbox.GetBackgroundStatus();
+    ASSERT_TRUE(finished.IsOk());
+    EXPECT_FALSE(finished.Value().running);
+    EXPECT_EQ(finished.Value().percent_complete, 100);
+    EXPECT_EQ(finished.Value().return_code, CxlMailboxReturnCode::kSuccess);
+}
+
+TEST(CxlMmioMailboxTest, DoorbellInterruptReplacesPolling) {
+    FakeCxlFunction fn;
+    fn.auto_complete_ = false;
+    fn.BarWrite32(kBdf, kBar, kMailbox, 8 | (1u << 5));  // doorbell-interrupt capable
+    auto options = FastOptions();
+    options.timeout = std::chrono::milliseconds(2000);
+    options.doorbell_irq = std::make_shared<IrqSignal>();
+    CxlMmioMailbox mailbox(fn, kBdf, {kBar, kMailbox}, options);
+
+    std::thread device([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        fn.Complete();
+        options.doorbell_irq->Notify();
+    });
+    auto result = mailbox.Execute(0x0001, {1, 2});
+    device.join();
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value().payload, (CxlMailboxPayload{2, 1}));
+    // The 20 ms wait took a handful of doorbell reads rather than one per
+    // poll interval, and the doorbell write enabled the interrupt.
+    EXPECT_LT(fn.reads_, 20);
+    EXPECT_NE(fn.BarRead32(kBdf, kBar, kControl).Value() & (1u << 1), 0u);
+}
+
+TEST(CxlMmioMailboxTest, DoorbellInterruptNeedsCapability) {
+    FakeCxlFunction fn;
+    auto options = FastOptions();
+    options.doorbell_irq = std::make_shared<IrqSignal>();
+    CxlMmioMailbox mailbox(fn, kBdf, {kBar, kMailbox}, options);
+    ASSERT_TRUE(mailbox.Execute(0x0001, {1}).IsOk());
+    EXPECT_EQ(fn.BarRead32(kBdf, kBar, kControl).Value() & (1u << 1), 0u);
+}
+
+TEST(CxlMmioMailboxTest, ConcurrentExecuteIsSerialized) {
+    FakeCxlFunction fn;
+    CxlMmioMailbox mailbox(fn, kBdf, {kBar, kMailbox}, FastOptions());
+
+    constexpr std::size_t kThreads = 4;
+    constexpr std::size_t kPerThread = 50;
+    std::vector<std::thread> threads;
+    std::vector<int> failures(kThreads, 0);
+    for (std::size_t t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (std::size_t i = 0; i < kPerThread; ++i) {
+                auto byte = static_cast<uint8_t>(t * kPerThread + i);
+                auto result = mailbox.Execute(0x0001, {byte, 0xEE});
+                if (result.IsError() ||
+                    result.Value().payload != CxlMailboxPayload{0xEE, byte}) {
+                    ++failures[t];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (std::size_t t = 0; t < kThreads; ++t) {
+        EXPECT_EQ(failures[t], 0);
+    }
+    EXPECT_EQ(fn.opcodes_.size(), kThreads * kPerThread);
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "plas/core/error.h"
+#include "plas/core/executor.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/pci/doe_inventory.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+
+namespace plas::hal::pci {
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr DoeProtocolId kDiscovery{doe_vendor::kPciSig, doe_type::kDoeDiscovery};
+constexpr DoeProtocolId kCma{doe_vendor::kPciSig, doe_type::kCma};
+
+/// Functions with DOE capabilities at fixed offsets; the mailbox at 0x200
+/// of any function fails. DoeDiscover takes `delay` and is counted.
+class FakeDoeBus : public Device, public PciConfig, public PciDoe {
+public:
+    core::Result<void> Init() override { return core::Result<void>::Ok(); }
+    core::Result<void> Open() override { return core::Result<void>::Ok(); }
+    core::Result<void> Close() override { return core::Result<void>::Ok(); }
+    core::Result<void> Reset() override { return core::Result<void>::Ok(); }
+    DeviceState GetState() const override { return DeviceState::kOpen; }
+    std::string GetName() const override { return "fake"; }
+    std::string GetUri() const override { return "fake://0"; }
+    std::string GetDriverName() const override { return "fake"; }
+    std::string InterfaceName() const override { return "PciConfig"; }
+    plas::hal::Device* GetDevice() override { return this; }
+
+    core::Result<core::Byte> ReadConfig8(Bdf, ConfigOffset) override {
+        return core::Result<core::Byte>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<core::Word> ReadConfig16(Bdf, ConfigOffset) override {
+        return core::Result<core::Word>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<core::DWord> ReadConfig32(Bdf, ConfigOffset) override {
+        return core::Result<core::DWord>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> WriteConfig8(Bdf, ConfigOffset, core::Byte) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> WriteConfig16(Bdf, ConfigOffset, core::Word) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> WriteConfig32(Bdf, ConfigOffset, core::DWord) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<std::optional<ConfigOffset>> FindCapability(Bdf, CapabilityId) override {
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+    core::Result<std::optional<ConfigOffset>> FindExtCapability(Bdf,
+                                                                ExtCapabilityId) override {
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+
+    core::Result<CapabilityIndex> GetCapabilityIndex(Bdf bdf) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = doe_offsets_.find(bdf.Pack());
+        if (it == doe_offsets_.end()) {
+            return core::Result<CapabilityIndex>::Err(core::ErrorCode::kNotFound);
+        }
+        CapabilityIndex index;
+        index.ext_capabilities[static_cast<uint16_t>(ExtCapabilityId::kDoe)] = it->second;
+        return core::Result<CapabilityIndex>::Ok(index);
+    }
+
+    core::Result<std::vector<DoeProtocolId>> DoeDiscover(Bdf, ConfigOffset offset) override {
+        int now = ++in_flight_;
+        int seen = max_in_flight.load();
+        while (now > seen && !max_in_flight.compare_exchange_weak(seen, now)) {
+        }
+        std::this_thread::sleep_for(delay);
+        ++discovers;
+        --in_flight_;
+        if (offset == 0x200) {
+            return core::Result<std::vector<DoeProtocolId>>::Err(core::ErrorCode::kTimeout);
+        }
+        return core::Result<std::vector<DoeProtocolId>>::Ok(
+            offset == 0x150 ? std::vector<DoeProtocolId>{kDiscovery}
+                            : std::vector<DoeProtocolId>{kDiscovery, kCma});
+    }
+    core::Result<DoePayload> DoeExchange(Bdf, ConfigOffset, DoeProtocolId,
+                                         const DoePayload&) override {
+        return core::Result<DoePayload>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    void SetDoe(Bdf bdf, std::vector<ConfigOffset> offsets) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        doe_offsets_[bdf.Pack()] = std::move(offsets);
+    }
+
+    std::chrono::milliseconds delay{0};
+    std::atomic<int> discovers{0};
+    std::atomic<int> max_in_flight{0};
+
+private:
+    std::mutex mutex_;
+    std::map<uint16_t, std::vector<ConfigOffset>> doe_offsets_;
+    std::atomic<int> in_flight_{0};
+};
+
+TEST(DoeInventoryTest, RefreshDiscoversEveryMailboxOnce) {
+    FakeDoeBus bus;
+    const Bdf a{0x10, 0x00, 0x00};
+    const Bdf b{0x11, 0x00, 0x00};
+    bus.SetDoe(a, {0x150, 0x180});
+    bus.SetDoe(b, {0x160});
+
+    DoeInventory inventory;
+    auto ia = inventory.AddDevice(bus, bus, a);
+    auto ib = inventory.AddDevice(bus, bus, b);
+    EXPECT_EQ(inventory.DeviceCount(), 2u);
+    EXPECT_TRUE(inventory.IsStale(ia));
+    EXPECT_EQ(bus.discovers, 0);
+
+    inventory.Refresh();
+    EXPECT_EQ(bus.discovers, 3);
+    EXPECT_FALSE(inventory.IsStale(ia));
+
+    auto entry = inventory.Get(ia);
+    ASSERT_TRUE(entry.IsOk());
+    EXPECT_EQ(entry.Value().bdf, a);
+    ASSERT_EQ(entry.Value().mailboxes.size(), 2u);
+    EXPECT_EQ(entry.Value().mailboxes[0].offset, 0x150);
+    EXPECT_EQ(entry.Value().mailboxes[0].protocols.size(), 1u);
+    EXPECT_EQ(entry.Value().mailboxes[1].protocols.size(), 2u);
+    EXPECT_EQ(entry.Value().FindMailbox(kCma), ConfigOffset{0x180});
+    EXPECT_EQ(entry.Value().FindMailbox(kDiscovery), ConfigOffset{0x150});
+    EXPECT_EQ(entry.Value().FindMailbox(DoeProtocolId{0x1234, 0x05}), std::nullopt);
+
+    // Cached: neither Get nor another Refresh goes back to the mailboxes.
+    ASSERT_TRUE(inventory.Get(ib).IsOk());
+    inventory.Refresh();
+    EXPECT_EQ(bus.discovers, 3);
+
+    EXPECT_EQ(inventory.Get(7).Error(), core::ErrorCode::kOutOfRange);
+}
+
+TEST(DoeInventoryTest, FailuresAreKeptPerEntry) {
+    FakeDoeBus bus;
+    const Bdf doe{0x12, 0x00, 0x00};
+    const Bdf missing{0x13, 0x00, 0x00};
+    bus.SetDoe(doe, {0x150, 0x200});
+
+    DoeInventory inventory;
+    auto id = inventory.AddDevice(bus, bus, doe);
+    auto im = inventory.AddDevice(bus, bus, missing);
+    inventory.Refresh();
+
+    auto entry = inventory.Get(id).Value();
+    ASSERT_EQ(entry.mailboxes.size(), 2u);
+    EXPECT_FALSE(entry.mailboxes[0].error);
+    EXPECT_EQ(entry.mailboxes[1].error, core::ErrorCode::kTimeout);
+    EXPECT_TRUE(entry.mailboxes[1].protocols.empty());
+
+    auto none = inventory.Get(im).Value();
+    EXPECT_EQ(none.error, core::ErrorCode::kNotFound);
+    EXPECT_TRUE(none.mailboxes.empty());
+}
+
+TEST(DoeInventoryTest, TopologyChangeAndInvalidateRediscover) {
+    FakeDoeBus bus;
+    const Bdf a{0x14, 0x00, 0x00};
+    const Bdf b{0x15, 0x00, 0x00};
+    bus.SetDoe(a, {0x150});
+    bus.SetDoe(b, {0x150});
+
+    DoeInventory inventory;
+    auto ia = inventory.AddDevice(bus, bus, a);
+    auto ib = inventory.AddDevice(bus, bus, b);
+    inventory.Refresh();
+    EXPECT_EQ(bus.discovers, 2);
+
+    inventory.Invalidate(ia);
+    EXPECT_TRUE(inventory.IsStale(ia));
+    EXPECT_FALSE(inventory.IsStale(ib));
+    ASSERT_TRUE(inventory.Get(ia).IsOk());
+    EXPECT_EQ(bus.discovers, 3);
+
+    // A rescan may have changed any function.
+    bus.SetDoe(b, {0x150, 0x180});
+    PciTopology::NotifyTopologyChanged();
+    EXPECT_TRUE(inventory.IsStale(ia));
+    EXPECT_TRUE(inventory.IsStale(ib));
+    inventory.Refresh();
+    EXPECT_EQ(bus.discovers, 6);
+    EXPECT_EQ(inventory.Get(ib).Value().mailboxes.size(), 2u);
+
+    inventory.InvalidateAll();
+    inventory.Refresh();
+    EXPECT_EQ(bus.discovers, 9);
+}
+
+TEST(DoeInventoryTest, MailboxesAreDiscoveredConcurrently) {
+    if (core::Executor::Shared().ThreadCount() == 0) {
+        GTEST_SKIP() << "no executor workers";
+    }
+    FakeDoeBus bus;
+    bus.delay = 20ms;
+    DoeInventory inventory;
+    for (uint8_t dev = 0; dev < 4; ++dev) {
+        Bdf bdf{0x20, dev, 0x00};
+        bus.SetDoe(bdf, {0x150, 0x180});
+        inventory.AddDevice(bus, bus, bdf);
+    }
+    inventory.Refresh();
+    EXPECT_EQ(bus.discovers, 8);
+    EXPECT_GT(bus.max_in_flight, 1);
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/ecam.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+
+namespace plas::hal::pci {
+namespace {
+
+struct McfgEntry {
+    uint64_t base;
+    uint16_t segment;
+    uint8_t start_bus;
+    uint8_t end_bus;
+};
+
+void PutLe(std::vector<uint8_t>& out, std::size_t at, uint64_t value,
+           std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; ++i) {
+        out[at + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+std::vector<uint8_t> BuildMcfg(const std::vector<McfgEntry>& entries) {
+    std::vector<uint8_t> table(44 + 16 * entries.size(), 0);
+    std::memcpy(table.data(), "MCFG", 4);
+    PutLe(table, 4, table.size(), 4);
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        std::size_t at = 44 + 16 * i;
+        PutLe(table, at, entries[i].base, 8);
+        PutLe(table, at + 8, entries[i].segment, 2);
+        table[at + 10] = entries[i].start_bus;
+        table[at + 11] = entries[i].end_bus;
+    }
+    return table;
+}
+
+PciAddress Addr(uint16_t domain, uint8_t bus, uint8_t dev, uint8_t fn) {
+    return PciAddress{domain, Bdf{bus, dev, fn}};
+}
+
+// ===== ParseMcfg =====
+
+TEST(EcamTest, ParseMcfgEntries) {
+    auto table = BuildMcfg({{0xE0000000, 0, 0, 0xFF},
+                            {0x3F000000000, 1, 0x80, 0x8F}});
+    auto result = Ecam::ParseMcfg(table.data(), table.size());
+    ASSERT_TRUE(result.IsOk());
+    const auto& regions = result.Value();
+    ASSERT_EQ(regions.size(), 2u);
+    EXPECT_EQ(regions[0].base_address, 0xE0000000u);
+    EXPECT_EQ(regions[0].segment, 0);
+    EXPECT_EQ(regions[0].end_bus, 0xFF);
+    EXPECT_EQ(regions[1].base_address, 0x3F000000000u);
+    EXPECT_EQ(regions[1].segment, 1);
+    EXPECT_EQ(regions[1].start_bus, 0x80);
+    EXPECT_EQ(regions[1].end_bus, 0x8F);
+}
+
+TEST(EcamTest, ParseMcfgRejectsBadSignature) {
+    auto table = BuildMcfg({{0xE0000000, 0, 0, 0xFF}});
+    table[0] = 'X';
+    auto result = Ecam::ParseMcfg(table.data(), table.size());
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
+TEST(EcamTest, ParseMcfgRejectsTruncatedTable) {
+    auto table = BuildMcfg({{0xE0000000, 0, 0, 0xFF}});
+    auto result = Ecam::ParseMcfg(table.data(), table.size() - 1);
+    EXPECT_TRUE(result.IsError());
+    EXPECT_TRUE(Ecam::ParseMcfg(nullptr, 0).IsError());
+}
+
+TEST(EcamTest, ParseMcfgSkipsInvertedBusRange) {
+    auto table = BuildMcfg({{0xE0000000, 0, 0x10, 0x0F}});
+    auto result = Ecam::ParseMcfg(table.data(), table.size());
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_TRUE(result.Value().empty());
+}
+
+// ===== EcamRegion =====
+
+TEST(EcamTest, RegionContainsAndAddress) {
+    EcamRegion region{0xE0000000, 0, 0x10, 0x1F};
+    EXPECT_TRUE(region.Contains(Addr(0, 0x10, 0, 0)));
+    EXPECT_TRUE(region.Contains(Addr(0, 0x1F, 31, 7)));
+    EXPECT_FALSE(region.Contains(Addr(0, 0x20, 0, 0)));
+    EXPECT_FALSE(region.Contains(Addr(1, 0x10, 0, 0)));
+
+    // base + bus << 20 | device << 15 | function << 12
+    EXPECT_EQ(region.ConfigAddress(Addr(0, 0x12, 3, 5)),
+              0xE0000000u + (0x12u << 20) + (3u << 15) + (5u << 12));
+}
+
+// ===== LoadRegions / FindRegion =====
+
+class EcamSysfsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char tmpl[] = "/tmp/plas_test_ecam_XXXXXX";
+        char* dir = ::mkdtemp(tmpl);
+        ASSERT_NE(dir, nullptr);
+        root_ = dir;
+        PciTopology::SetSysfsRoot(root_);
+    }
+
+    void TearDown() override {
+        std::string cmd = "rm -rf \"" + root_ + "\"";
+        int ret = ::system(cmd.c_str());
+        (void)ret;
+        PciTopology::SetSysfsRoot("/sys");
+    }
+
+    void WriteMcfg(const std::vector<uint8_t>& table) {
+        std::string dir = root_ + "/firmware/acpi/tables";
+        std::string cmd = "mkdir -p \"" + dir + "\"";
+        int ret = ::system(cmd.c_str());
+        (void)ret;
+        std::ofstream f(dir + "/MCFG", std::ios::binary);
+        f.write(reinterpret_cast<const char*>(table.data()),
+                static_cast<std::streamsize>(table.size()));
+    }
+
+    std::string root_;
+};
+
+TEST_F(EcamSysfsTest, MissingMcfgIsNotSupported) {
+    auto result = Ecam::LoadRegions();
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), core::make_error_code(core::ErrorCode::kNotSupported));
+}
+
+TEST_F(EcamSysfsTest, FindRegionBySegmentAndBus) {
+    WriteMcfg(BuildMcfg({{0xE0000000, 0, 0, 0x7F},
+                         {0xF0000000, 0, 0x80, 0xFF}}));
+
+    auto region = Ecam::FindRegion(Addr(0, 0x81, 0, 0));
+    ASSERT_TRUE(region.IsOk());
+    EXPECT_EQ(region.Value().base_address, 0xF0000000u);
+
+    auto missing = Ecam::FindRegion(Addr(2, 0, 0, 0));
+    ASSERT_TRUE(missing.IsError());
+    EXPECT_EQ(missing.Error(), core::make_error_code(core::ErrorCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
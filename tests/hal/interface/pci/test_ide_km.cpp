@@ -0,0 +1,331 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/ide_km.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+
+namespace plas::hal::pci {
+namespace {
+
+constexpr Bdf kBdf{0x0A, 0x00, 0x00};
+constexpr ConfigOffset kCmaDoe = 0x150;
+constexpr ConfigOffset kIdeKmDoe = 0x180;
+
+/// Function with two DOE instances (CMA at 0x150, IDE_KM at 0x180) that
+/// acknowledges every KEY_PROG / K_SET_GO and records what it received.
+class FakeIdeDevice : public PciConfig, public PciDoe {
+public:
+    plas::hal::Device* GetDevice() override { return nullptr; }
+
+    core::Result<core::Byte> ReadConfig8(Bdf, ConfigOffset) override {
+        return core::Result<core::Byte>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<core::Word> ReadConfig16(Bdf, ConfigOffset) override {
+        return core::Result<core::Word>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<core::DWord> ReadConfig32(Bdf, ConfigOffset) override {
+        return core::Result<core::DWord>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> WriteConfig8(Bdf, ConfigOffset, core::Byte) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> WriteConfig16(Bdf, ConfigOffset, core::Word) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> WriteConfig32(Bdf, ConfigOffset, core::DWord) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<std::optional<ConfigOffset>> FindCapability(
+        Bdf, CapabilityId) override {
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+    core::Result<std::optional<ConfigOffset>> FindExtCapability(
+        Bdf, ExtCapabilityId) override {
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+
+    core::Result<CapabilityIndex> GetCapabilityIndex(Bdf) override {
+        ++index_reads;
+        CapabilityIndex index;
+        auto& doe = index.ext_capabilities[static_cast<uint16_t>(
+            ExtCapabilityId::kDoe)];
+        doe.push_back(kCmaDoe);
+        if (has_ide_km) {
+            doe.push_back(kIdeKmDoe);
+        }
+        return core::Result<CapabilityIndex>::Ok(index);
+    }
+
+    core::Result<std::vector<DoeProtocolId>> DoeDiscover(
+        Bdf, ConfigOffset offset) override {
+        ++discovers;
+        std::vector<DoeProtocolId> protocols{
+            {doe_vendor::kPciSig, doe_type::kDoeDiscovery}};
+        protocols.push_back(offset == kIdeKmDoe
+                                ? kIdeKmProtocol
+                                : DoeProtocolId{doe_vendor::kPciSig,
+                                                doe_type::kCma});
+        return core::Result<std::vector<DoeProtocolId>>::Ok(protocols);
+    }
+
+    core::Result<DoePayload> DoeExchange(Bdf, ConfigOffset offset,
+                                         DoeProtocolId protocol,
+                                         const DoePayload& request) override {
+        if (offset != kIdeKmDoe ||
+            protocol.data_object_type != doe_type::kIdeKm) {
+            return core::Result<DoePayload>::Err(core::ErrorCode::kIOError);
+        }
+        if (fail_transport) {
+            return core::Result<DoePayload>::Err(core::ErrorCode::kTimeout);
+        }
+        int now = ++in_flight;
+        int seen = max_in_flight.load();
+        while (now > seen && !max_in_flight.compare_exchange_weak(seen, now)) {
+        }
+        if (delay.count() > 0) {
+            std::this_thread::sleep_for(delay);
+        }
+        --in_flight;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        messages.push_back(request);
+        auto type = static_cast<IdeKmMessageType>((request[0] >> 8) & 0xFF);
+        core::DWord dw1 = request[1] & 0xFFFF00FFu;
+        if (type == IdeKmMessageType::kKeyProg) {
+            if (request.size() != 12) {
+                dw1 |= 0x01u << 8;  // incorrect length
+            } else if ((request[1] & 0xFF) == reject_stream) {
+                dw1 |= 0x03u << 8;  // unsupported value
+            }
+            return core::Result<DoePayload>::Ok(
+                {static_cast<core::DWord>(IdeKmMessageType::kKeyProgAck) << 8,
+                 dw1});
+        }
+        if (type == IdeKmMessageType::kKeySetGo) {
+            auto ack = bad_go_ack ? IdeKmMessageType::kKeyProgAck
+                                  : IdeKmMessageType::kKeySetGoAck;
+            return core::Result<DoePayload>::Ok(
+                {static_cast<core::DWord>(ack) << 8, dw1});
+        }
+        return core::Result<DoePayload>::Err(core::ErrorCode::kIOError);
+    }
+
+    std::vector<DoePayload> Messages() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return messages;
+    }
+
+    bool has_ide_km = true;
+    bool fail_transport = false;
+    bool bad_go_ack = false;
+    uint32_t reject_stream = 0x100;  // none
+    std::chrono::milliseconds delay{0};
+    std::atomic<int> index_reads{0};
+    std::atomic<int> discovers{0};
+    std::vector<DoePayload> messages;
+
+    static std::atomic<int> in_flight;
+    static std::atomic<int> max_in_flight;
+
+private:
+    std::mutex mutex_;
+};
+
+std::atomic<int> FakeIdeDevice::in_flight{0};
+std::atomic<int> FakeIdeDevice::max_in_flight{0};
+
+/// TX/RX x PR/NPR/CPL keys for one stream.
+IdeKmBatch FullStream(FakeIdeDevice& device, uint8_t stream_id,
+                      uint8_t key_set, Bdf bdf = kBdf) {
+    IdeKmBatch batch{};
+    batch.doe = &device;
+    batch.config = &device;
+    batch.bdf = bdf;
+    for (uint8_t direction = 0; direction < 2; ++direction) {
+        for (uint8_t sub : {ide_sub_stream::kPosted, ide_sub_stream::kNonPosted,
+                            ide_sub_stream::kCompletion}) {
+            IdeKmKey key{};
+            key.stream = {stream_id, key_set, direction, sub};
+            for (std::size_t i = 0; i < key.key.size(); ++i) {
+                key.key[i] = 0xA0000000u | (direction << 8) | (sub << 4) |
+                             static_cast<core::DWord>(i);
+            }
+            key.iv = {0x1, static_cast<core::DWord>(sub)};
+            batch.keys.push_back(key);
+        }
+    }
+    return batch;
+}
+
+TEST(IdeKmTest, ProgramsEveryKeyThenSetsGo) {
+    FakeIdeDevice device;
+    IdeKmProgrammer programmer;
+
+    auto result = programmer.Program(FullStream(device, 3, 1));
+    ASSERT_TRUE(result.IsOk()) << result.Error().message();
+    EXPECT_TRUE(result.Value().activated);
+    ASSERT_EQ(result.Value().status.size(), 6u);
+    for (auto status : result.Value().status) {
+        EXPECT_EQ(status, IdeKmStatus::kSuccess);
+    }
+
+    auto messages = device.Messages();
+    ASSERT_EQ(messages.size(), 12u);
+    // All KEY_PROGs first, then all K_SET_GOs.
+    for (std::size_t i = 0; i < 6; ++i) {
+        EXPECT_EQ(messages[i].size(), 12u);
+        EXPECT_EQ(messages[i][0], 0x0200u);
+        EXPECT_EQ(messages[i + 6].size(), 2u);
+        EXPECT_EQ(messages[i + 6][0], 0x0400u);
+        EXPECT_EQ(messages[i + 6][1], messages[i][1]);
+    }
+    // TX (direction 0) NPR, key set 1: RxTx = 1, SubStream = 1.
+    EXPECT_EQ(messages[1][1], 0x00130003u);
+    EXPECT_EQ(messages[1][2], 0xA0000010u);
+    EXPECT_EQ(messages[1][11], 0x1u);  // IV DW1 = sub-stream
+    // RX (direction 1) CPL: RxTx = 0, SubStream = 2.
+    EXPECT_EQ(messages[5][1], 0x00210003u);
+}
+
+TEST(IdeKmTest, LocateIsCachedAcrossBatches) {
+    FakeIdeDevice device;
+    IdeKmProgrammer programmer;
+
+    auto offset = programmer.Locate(device, device, kBdf);
+    ASSERT_TRUE(offset.IsOk());
+    EXPECT_EQ(offset.Value(), kIdeKmDoe);
+    EXPECT_EQ(device.discovers.load(), 2);
+
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(programmer.Program(FullStream(device, 1, i & 1)).IsOk());
+    }
+    EXPECT_EQ(device.index_reads.load(), 1);
+    EXPECT_EQ(device.discovers.load(), 2);
+
+    PciTopology::NotifyTopologyChanged();
+    ASSERT_TRUE(programmer.Program(FullStream(device, 1, 0)).IsOk());
+    EXPECT_EQ(device.index_reads.load(), 2);
+
+    programmer.Forget(&device, kBdf);
+    ASSERT_TRUE(programmer.Locate(device, device, kBdf).IsOk());
+    EXPECT_EQ(device.index_reads.load(), 3);
+}
+
+TEST(IdeKmTest, NoIdeKmInstanceIsNotSupported) {
+    FakeIdeDevice device;
+    device.has_ide_km = false;
+    IdeKmProgrammer programmer;
+
+    auto result = programmer.Program(FullStream(device, 1, 0));
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    EXPECT_TRUE(device.Messages().empty());
+}
+
+TEST(IdeKmTest, RejectedKeySuppressesSetGo) {
+    FakeIdeDevice device;
+    device.reject_stream = 4;
+    IdeKmProgrammer programmer;
+    auto batch = FullStream(device, 2, 0);
+    auto rejected = FullStream(device, 4, 0);
+    batch.keys.push_back(rejected.keys[0]);
+
+    auto result = programmer.Program(batch);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_FALSE(result.Value().activated);
+    ASSERT_EQ(result.Value().status.size(), 7u);
+    EXPECT_EQ(result.Value().status[0], IdeKmStatus::kSuccess);
+    EXPECT_EQ(result.Value().status[6], IdeKmStatus::kUnsupportedValue);
+    EXPECT_EQ(device.Messages().size(), 7u);  // no K_SET_GO
+}
+
+TEST(IdeKmTest, SetGoCanBeDeferred) {
+    FakeIdeDevice device;
+    IdeKmProgrammer programmer;
+    auto batch = FullStream(device, 2, 1);
+    batch.set_go = false;
+
+    auto result = programmer.Program(batch);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_FALSE(result.Value().activated);
+    EXPECT_EQ(device.Messages().size(), 6u);
+}
+
+TEST(IdeKmTest, MismatchedAckIsIOError) {
+    FakeIdeDevice device;
+    device.bad_go_ack = true;
+    IdeKmProgrammer programmer;
+
+    auto result = programmer.Program(FullStream(device, 2, 0));
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), core::make_error_code(core::ErrorCode::kIOError));
+}
+
+TEST(IdeKmTest, TransportErrorDropsCachedOffset) {
+    FakeIdeDevice device;
+    IdeKmProgrammer programmer;
+    ASSERT_TRUE(programmer.Program(FullStream(device, 2, 0)).IsOk());
+
+    device.fail_transport = true;
+    auto result = programmer.Program(FullStream(device, 2, 1));
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), core::make_error_code(core::ErrorCode::kTimeout));
+
+    device.fail_transport = false;
+    ASSERT_TRUE(programmer.Program(FullStream(device, 2, 1)).IsOk());
+    EXPECT_EQ(device.index_reads.load(), 2);
+}
+
+TEST(IdeKmTest, InvalidArguments) {
+    FakeIdeDevice device;
+    IdeKmProgrammer programmer;
+
+    auto batch = FullStream(device, 1, 0);
+    batch.keys[0].stream.sub_stream = 0x10;
+    EXPECT_TRUE(programmer.Program(batch).IsError());
+    batch = FullStream(device, 1, 2);
+    EXPECT_TRUE(programmer.Program(batch).IsError());
+    batch = FullStream(device, 1, 0);
+    batch.doe = nullptr;
+    EXPECT_TRUE(programmer.Program(batch).IsError());
+    EXPECT_TRUE(device.Messages().empty());
+}
+
+TEST(IdeKmTest, ProgramAllOverlapsDevices) {
+    constexpr std::size_t kDevices = 8;
+    std::vector<std::unique_ptr<FakeIdeDevice>> devices;
+    std::vector<IdeKmBatch> batches;
+    for (std::size_t i = 0; i < kDevices; ++i) {
+        devices.push_back(std::make_unique<FakeIdeDevice>());
+        devices.back()->delay = std::chrono::milliseconds(1);
+        batches.push_back(FullStream(*devices.back(), 1, 1,
+                                     Bdf{static_cast<uint8_t>(i + 1), 0, 0}));
+    }
+    devices[3]->has_ide_km = false;
+    FakeIdeDevice::max_in_flight = 0;
+    IdeKmProgrammer programmer;
+
+    auto results = programmer.ProgramAll(batches);
+    ASSERT_EQ(results.size(), kDevices);
+    for (std::size_t i = 0; i < kDevices; ++i) {
+        EXPECT_EQ(results[i].IsOk(), i != 3) << "device " << i;
+        if (results[i].IsOk()) {
+            EXPECT_TRUE(results[i].Value().activated);
+            EXPECT_EQ(devices[i]->Messages().size(), 12u);
+        }
+    }
+    EXPECT_GT(FakeIdeDevice::max_in_flight.load(), 1);
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
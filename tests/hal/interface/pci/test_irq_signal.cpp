@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "plas/hal/interface/pci/irq_signal.h"
+
+namespace plas::hal::pci {
+namespace {
+
+using namespace std::chrono_literals;
+
+TEST(IrqSignalTest, WaitTimesOutWithoutNotify) {
+    IrqSignal signal;
+    auto token = signal.Arm();
+    EXPECT_FALSE(signal.Wait(token, IrqSignal::Clock::now() + 5ms));
+    EXPECT_EQ(signal.Count(), 0u);
+}
+
+TEST(IrqSignalTest, NotifyBeforeWaitIsNotLost) {
+    IrqSignal signal;
+    auto token = signal.Arm();
+    signal.Notify();  // lands between the register read and the wait
+    EXPECT_TRUE(signal.Wait(token, IrqSignal::Clock::now()));
+    EXPECT_EQ(signal.Count(), 1u);
+
+    // A fresh token only sees later interrupts.
+    EXPECT_FALSE(signal.Wait(signal.Arm(), IrqSignal::Clock::now() + 1ms));
+}
+
+TEST(IrqSignalTest, NotifyWakesWaiter) {
+    IrqSignal signal;
+    auto token = signal.Arm();
+    std::thread irq([&] {
+        std::this_thread::sleep_for(5ms);
+        signal.Notify();
+    });
+    EXPECT_TRUE(signal.Wait(token, IrqSignal::Clock::now() + 10s));
+    irq.join();
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
@@ -0,0 +1,298 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/pci/pci_aer.h"
+#include "plas/hal/interface/pci/pci_config.h"
+
+namespace plas::hal::pci {
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr ConfigOffset kPcieCap = 0x40;
+constexpr ConfigOffset kAerCap = 0x100;
+constexpr ConfigOffset kUncorrectable = kAerCap + 0x04;
+constexpr ConfigOffset kSeverity = kAerCap + 0x0C;
+constexpr ConfigOffset kCorrectable = kAerCap + 0x10;
+constexpr ConfigOffset kControl = kAerCap + 0x18;
+constexpr ConfigOffset kHeaderLog = kAerCap + 0x1C;
+constexpr ConfigOffset kRootStatus = kAerCap + 0x30;
+constexpr ConfigOffset kSourceId = kAerCap + 0x34;
+
+const Bdf kRootPort{0x00, 0x01, 0x00};
+const Bdf kEndpoint{0x01, 0x00, 0x00};
+const Bdf kLegacy{0x02, 0x00, 0x00};  // no AER
+
+/// A root port and an endpoint with AER, plus a function without it. The
+/// AER status registers are RW1C. Counts block reads and write batches.
+class FakeBus : public Device, public PciConfig {
+public:
+    FakeBus() {
+        InitFunction(kRootPort, PciePortType::kRootPort, true);
+        InitFunction(kEndpoint, PciePortType::kEndpoint, true);
+        InitFunction(kLegacy, PciePortType::kEndpoint, false);
+    }
+
+    core::Result<void> Init() override { return core::Result<void>::Ok(); }
+    core::Result<void> Open() override { return core::Result<void>::Ok(); }
+    core::Result<void> Close() override { return core::Result<void>::Ok(); }
+    core::Result<void> Reset() override { return core::Result<void>::Ok(); }
+    DeviceState GetState() const override { return DeviceState::kOpen; }
+    std::string GetName() const override { return "fake"; }
+    std::string GetUri() const override { return "fake://0"; }
+    std::string GetDriverName() const override { return "fake"; }
+    plas::hal::Device* GetDevice() override { return this; }
+
+    core::Result<core::Byte> ReadConfig8(Bdf bdf, ConfigOffset offset) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return core::Result<core::Byte>::Ok(space_[bdf.Pack()][offset]);
+    }
+    core::Result<core::Word> ReadConfig16(Bdf bdf, ConfigOffset offset) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return core::Result<core::Word>::Ok(
+            static_cast<core::Word>(Get32(space_[bdf.Pack()], offset)));
+    }
+    core::Result<core::DWord> ReadConfig32(Bdf bdf, ConfigOffset offset) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return core::Result<core::DWord>::Ok(Get32(space_[bdf.Pack()], offset));
+    }
+    core::Result<void> WriteConfig8(Bdf, ConfigOffset, core::Byte) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> WriteConfig16(Bdf, ConfigOffset, core::Word) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> WriteConfig32(Bdf bdf, ConfigOffset offset, core::DWord value) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& space = space_[bdf.Pack()];
+        if (offset == kUncorrectable || offset == kCorrectable || offset == kRootStatus) {
+            value = Get32(space, offset) & ~value;  // RW1C
+        }
+        Set32(space, offset, value);
+        return core::Result<void>::Ok();
+    }
+    std::size_t WriteConfigBatch(Bdf bdf, const ConfigWrite* writes, std::size_t count,
+                                 std::error_code* status) override {
+        ++batches;
+        return PciConfig::WriteConfigBatch(bdf, writes, count, status);
+    }
+    core::Result<std::optional<ConfigOffset>> FindCapability(Bdf, CapabilityId) override {
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+    core::Result<std::optional<ConfigOffset>> FindExtCapability(Bdf,
+                                                                ExtCapabilityId) override {
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+    core::Result<void> ReadConfigBlock(Bdf bdf, ConfigOffset offset, core::Byte* buffer,
+                                       std::size_t length) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++block_reads;
+        const auto& space = space_[bdf.Pack()];
+        std::copy(space.begin() + offset, space.begin() + offset + length, buffer);
+        return core::Result<void>::Ok();
+    }
+
+    /// Latch errors the way a device would: status bits accumulate.
+    void Raise(Bdf bdf, uint32_t uncorrectable, uint32_t correctable) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& space = space_[bdf.Pack()];
+        Set32(space, kUncorrectable, Get32(space, kUncorrectable) | uncorrectable);
+        Set32(space, kCorrectable, Get32(space, kCorrectable) | correctable);
+    }
+    void Set(Bdf bdf, ConfigOffset offset, uint32_t value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Set32(space_[bdf.Pack()], offset, value);
+    }
+    uint32_t Get(Bdf bdf, ConfigOffset offset) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return Get32(space_[bdf.Pack()], offset);
+    }
+
+    int block_reads = 0;
+    int batches = 0;
+
+private:
+    using Space = std::array<core::Byte, kConfigSpaceSize>;
+
+    void InitFunction(Bdf bdf, PciePortType type, bool aer) {
+        auto& space = space_[bdf.Pack()];
+        Set32(space, 0x00, 0x12341AB4);
+        space[0x06] = 0x10;  // capabilities list
+        space[0x34] = kPcieCap;
+        space[kPcieCap] = static_cast<core::Byte>(CapabilityId::kPciExpress);
+        space[kPcieCap + 0x02] = static_cast<core::Byte>(static_cast<uint8_t>(type) << 4 | 2);
+        if (aer) {
+            // Version 2, last extended capability.
+            Set32(space, kAerCap, (2u << 16) | static_cast<uint32_t>(ExtCapabilityId::kAer));
+            Set32(space, kSeverity, 0x00462030);  // the spec's default fatal set
+        }
+    }
+    static void Set32(Space& space, std::size_t offset, uint32_t value) {
+        for (std::size_t i = 0; i < 4; ++i) {
+            space[offset + i] = static_cast<core::Byte>(value >> (8 * i));
+        }
+    }
+    static uint32_t Get32(const Space& space, std::size_t offset) {
+        uint32_t value = 0;
+        for (std::size_t i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(space[offset + i]) << (8 * i);
+        }
+        return value;
+    }
+
+    std::mutex mutex_;
+    std::map<uint16_t, Space> space_;
+};
+
+PciAerCollectorOptions Quiet() {
+    PciAerCollectorOptions options;
+    options.report_interval = 0ms;
+    return options;
+}
+
+TEST(PciAerCollectorTest, RejectsFunctionWithoutAer) {
+    FakeBus bus;
+    PciAerCollector collector(Quiet());
+    auto result = collector.AddDevice(bus, kLegacy);
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), core::ErrorCode::kNotSupported);
+    EXPECT_EQ(collector.DeviceCount(), 0u);
+}
+
+TEST(PciAerCollectorTest, CleanPollIsOneBlockReadPerDeviceAndNoWrites) {
+    FakeBus bus;
+    PciAerCollector collector(Quiet());
+    ASSERT_EQ(collector.AddDevice(bus, kRootPort).Value(), 0u);
+    ASSERT_EQ(collector.AddDevice(bus, kEndpoint).Value(), 1u);
+    bus.block_reads = 0;
+
+    EXPECT_EQ(collector.Poll(), 0u);
+    EXPECT_EQ(bus.block_reads, 2);
+    EXPECT_EQ(bus.batches, 0);
+    PciAerRecord record;
+    EXPECT_EQ(collector.Pop(&record, 1), 0u);
+}
+
+TEST(PciAerCollectorTest, DecodesRecordAndClearsStatusInOneBatch) {
+    FakeBus bus;
+    PciAerCollector collector(Quiet());
+    ASSERT_TRUE(collector.AddDevice(bus, kRootPort).IsOk());
+    ASSERT_TRUE(collector.AddDevice(bus, kEndpoint).IsOk());
+
+    // Endpoint: Malformed TLP (fatal) first, Completion Timeout, Bad TLP.
+    bus.Raise(kEndpoint, (1u << 18) | (1u << 14), 1u << 6);
+    bus.Set(kEndpoint, kControl, 18);
+    bus.Set(kEndpoint, kHeaderLog, 0x4A000001);
+    bus.Set(kEndpoint, kHeaderLog + 12, 0xDEADBEEF);
+    // Root port: the error message it received from the endpoint.
+    bus.Set(kRootPort, kRootStatus, 0xF8000004);  // message number + fatal received
+    bus.Set(kRootPort, kSourceId, 0x01000000);
+
+    EXPECT_EQ(collector.Poll(), 2u);
+    EXPECT_EQ(bus.batches, 2);
+    EXPECT_EQ(bus.Get(kEndpoint, kUncorrectable), 0u);
+    EXPECT_EQ(bus.Get(kEndpoint, kCorrectable), 0u);
+    EXPECT_EQ(bus.Get(kRootPort, kRootStatus), 0xF8000000u);  // RO bits kept
+
+    PciAerRecord records[4];
+    ASSERT_EQ(collector.Pop(records, 4), 2u);
+    const auto& root = records[0];
+    EXPECT_EQ(root.device, 0u);
+    EXPECT_EQ(root.root_status, 0x04u);
+    EXPECT_EQ(root.source_id, 0x01000000u);
+
+    const auto& endpoint = records[1];
+    EXPECT_EQ(endpoint.device, 1u);
+    EXPECT_EQ(endpoint.uncorrectable, (1u << 18) | (1u << 14));
+    EXPECT_EQ(endpoint.Fatal(), 1u << 18);
+    EXPECT_EQ(endpoint.NonFatal(), 1u << 14);
+    EXPECT_EQ(endpoint.correctable, 1u << 6);
+    EXPECT_EQ(endpoint.first_error, 18);
+    EXPECT_EQ(endpoint.header_log[0], 0x4A000001u);
+    EXPECT_EQ(endpoint.header_log[3], 0xDEADBEEFu);
+    EXPECT_EQ(endpoint.root_status, 0u);  // not a root port
+    EXPECT_GT(endpoint.timestamp_ns, 0u);
+
+    EXPECT_EQ(collector.Poll(), 0u);  // cleared
+}
+
+TEST(PciAerCollectorTest, CountsBitsPerDevice) {
+    FakeBus bus;
+    PciAerCollector collector(Quiet());
+    ASSERT_TRUE(collector.AddDevice(bus, kEndpoint).IsOk());
+    for (int i = 0; i < 3; ++i) {
+        bus.Raise(kEndpoint, 1u << 20, (1u << 0) | (1u << 7));
+        collector.Poll();
+    }
+    bus.Raise(kEndpoint, 1u << 5, 0);  // Surprise Down, fatal
+    collector.Poll();
+
+    auto counters = collector.GetCounters(0);
+    ASSERT_TRUE(counters.IsOk());
+    EXPECT_EQ(counters.Value().records, 4u);
+    EXPECT_EQ(counters.Value().correctable, 6u);
+    EXPECT_EQ(counters.Value().nonfatal, 3u);
+    EXPECT_EQ(counters.Value().fatal, 1u);
+    EXPECT_EQ(counters.Value().read_errors, 0u);
+
+    auto unknown = collector.GetCounters(1);
+    ASSERT_TRUE(unknown.IsError());
+    EXPECT_EQ(unknown.Error(), core::ErrorCode::kOutOfRange);
+}
+
+TEST(PciAerCollectorTest, FullRingDropsNewRecords) {
+    FakeBus bus;
+    auto options = Quiet();
+    options.ring_capacity = 4;
+    PciAerCollector collector(options);
+    ASSERT_TRUE(collector.AddDevice(bus, kEndpoint).IsOk());
+    for (uint32_t i = 0; i < 6; ++i) {
+        bus.Raise(kEndpoint, 0, 1u << 0);
+        bus.Set(kEndpoint, kHeaderLog, i);
+        EXPECT_EQ(collector.Poll(), 1u);
+    }
+    EXPECT_EQ(collector.Dropped(), 2u);
+    EXPECT_EQ(collector.GetCounters(0).Value().records, 6u);  // still counted
+
+    PciAerRecord records[8];
+    ASSERT_EQ(collector.Pop(records, 8), 4u);
+    EXPECT_EQ(records[0].header_log[0], 0u);
+    EXPECT_EQ(records[3].header_log[0], 3u);
+}
+
+TEST(PciAerCollectorTest, StormIsReportedWithoutLosingCounts) {
+    FakeBus bus;
+    PciAerCollectorOptions options;
+    options.report_interval = 1h;  // only the first poll's summary is due
+    PciAerCollector collector(options);
+    ASSERT_TRUE(collector.AddDevice(bus, kEndpoint).IsOk());
+    for (int i = 0; i < 1000; ++i) {
+        bus.Raise(kEndpoint, 0, 1u << 12);
+        collector.Poll();
+    }
+    collector.FlushReports();
+    EXPECT_EQ(collector.GetCounters(0).Value().correctable, 1000u);
+
+    PciAerRecord records[1024];
+    EXPECT_EQ(collector.Pop(records, 1024), 1000u);
+}
+
+TEST(PciAerCollectorTest, NamesStatusBits) {
+    EXPECT_STREQ(PciAerCollector::UncorrectableName(5), "SurpriseDown");
+    EXPECT_STREQ(PciAerCollector::UncorrectableName(18), "MalformedTLP");
+    EXPECT_STREQ(PciAerCollector::CorrectableName(6), "BadTLP");
+    EXPECT_EQ(PciAerCollector::UncorrectableName(0), nullptr);
+    EXPECT_EQ(PciAerCollector::CorrectableName(31), nullptr);
+    EXPECT_EQ(PciAerCollector::CorrectableName(32), nullptr);
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
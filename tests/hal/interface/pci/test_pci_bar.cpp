@@ -259,5 +259,19 @@ TEST(PciBarTest, BarIndexRange) {
     EXPECT_EQ(device.last_bar_index_, 5u);
 }
 
+// --- Default mapping hooks ---
+
+TEST(PciBarTest, DefaultMappingIsUncachedOnly) {
+    MockPciBarDevice device;
+    Bdf bdf{0x00, 0x00, 0x00};
+
+    EXPECT_TRUE(device.SetBarMapping(bdf, 0, BarMapping::kUncached).IsOk());
+    auto wc = device.SetBarMapping(bdf, 0, BarMapping::kWriteCombining);
+    ASSERT_TRUE(wc.IsError());
+    EXPECT_EQ(wc.Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    EXPECT_TRUE(device.BarFlush(bdf, 0).IsOk());
+}
+
 }  // namespace
 }  // namespace plas::hal::pci
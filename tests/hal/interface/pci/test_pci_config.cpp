@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include "plas/hal/interface/device.h"
 #include "plas/hal/interface/pci/pci_config.h"
@@ -216,5 +217,60 @@ TEST(PciConfigTest, FindExtCapabilityNotFound) {
     EXPECT_FALSE(result.Value().has_value());
 }
 
+// --- ReadConfigBlock / SnapshotConfig (default implementation) ---
+
+TEST(PciConfigTest, ReadConfigBlockUnalignedComposesReads) {
+    MockPciConfigDevice dev;
+    Bdf bdf{0x01, 0x00, 0x00};
+    std::vector<core::Byte> buf(7, 0);
+    // 0x02-0x03 byte reads, 0x04 DWord read, 0x08 byte read
+    auto result = dev.ReadConfigBlock(bdf, 0x02, buf.data(), buf.size());
+    ASSERT_TRUE(result.IsOk());
+    std::vector<core::Byte> expected = {0xAA, 0xAA, 0x00, 0xFF,
+                                        0xEE, 0xDD, 0xAA};
+    EXPECT_EQ(buf, expected);
+    EXPECT_EQ(dev.last_offset_, 0x08);
+}
+
+TEST(PciConfigTest, ReadConfigBlockOutOfRange) {
+    MockPciConfigDevice dev;
+    Bdf bdf{0x01, 0x00, 0x00};
+    core::Byte buf[8] = {};
+    auto result = dev.ReadConfigBlock(bdf, 0xFFC, buf, sizeof(buf));
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), core::make_error_code(core::ErrorCode::kOutOfRange));
+}
+
+TEST(PciConfigTest, ReadConfigBlockNullBuffer) {
+    MockPciConfigDevice dev;
+    Bdf bdf{0x01, 0x00, 0x00};
+    auto result = dev.ReadConfigBlock(bdf, 0x00, nullptr, 4);
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
+TEST(PciConfigTest, SnapshotConfigFullSpace) {
+    MockPciConfigDevice dev;
+    Bdf bdf{0x01, 0x00, 0x00};
+    auto result = dev.SnapshotConfig(bdf);
+    ASSERT_TRUE(result.IsOk());
+    ASSERT_EQ(result.Value().size(), kConfigSpaceSize);
+    EXPECT_EQ(result.Value()[0x00], 0x00);
+    EXPECT_EQ(result.Value()[0x03], 0xDD);
+    EXPECT_EQ(dev.last_offset_, 0xFFC);
+}
+
+TEST(PciConfigTest, GetCapabilityIndexDefaultParsesSnapshot) {
+    MockPciConfigDevice dev;
+    Bdf bdf{0x01, 0x00, 0x00};
+    dev.read8_value_ = 0x00;
+    dev.read32_value_ = 0x00000000;
+    auto result = dev.GetCapabilityIndex(bdf);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_TRUE(result.Value().capabilities.empty());
+    EXPECT_TRUE(result.Value().ext_capabilities.empty());
+}
+
 }  // namespace
 }  // namespace plas::hal::pci
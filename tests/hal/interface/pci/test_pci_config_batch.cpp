@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/pci_config_batch.h"
+#include "plas/hal/interface/pci/pci_config_cache.h"
+
+namespace plas::hal::pci {
+namespace {
+
+/// Config space backed by a byte array that logs every access in order,
+/// e.g. "w4@10" or "r4@10".
+class FakeConfig : public PciConfig {
+public:
+    plas::hal::Device* GetDevice() override { return nullptr; }
+
+    core::Result<core::Byte> ReadConfig8(Bdf, ConfigOffset offset) override {
+        log.push_back("r1@" + Hex(offset));
+        return core::Result<core::Byte>::Ok(space[offset]);
+    }
+    core::Result<core::Word> ReadConfig16(Bdf, ConfigOffset offset) override {
+        log.push_back("r2@" + Hex(offset));
+        return core::Result<core::Word>::Ok(
+            static_cast<core::Word>(space[offset] | (space[offset + 1] << 8)));
+    }
+    core::Result<core::DWord> ReadConfig32(Bdf, ConfigOffset offset) override {
+        log.push_back("r4@" + Hex(offset));
+        if (fail_offset && *fail_offset == offset) {
+            return core::Result<core::DWord>::Err(core::ErrorCode::kIOError);
+        }
+        return core::Result<core::DWord>::Ok(Get32(offset));
+    }
+    core::Result<void> WriteConfig8(Bdf, ConfigOffset offset, core::Byte value) override {
+        return Write(offset, 1, value);
+    }
+    core::Result<void> WriteConfig16(Bdf, ConfigOffset offset, core::Word value) override {
+        return Write(offset, 2, value);
+    }
+    core::Result<void> WriteConfig32(Bdf, ConfigOffset offset, core::DWord value) override {
+        return Write(offset, 4, value);
+    }
+    core::Result<std::optional<ConfigOffset>> FindCapability(Bdf, CapabilityId) override {
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+    core::Result<std::optional<ConfigOffset>> FindExtCapability(Bdf, ExtCapabilityId) override {
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+    std::size_t WriteConfigBatch(Bdf bdf, const ConfigWrite* writes, std::size_t count,
+                                 std::error_code* status) override {
+        ++batches;
+        return PciConfig::WriteConfigBatch(bdf, writes, count, status);
+    }
+
+    core::DWord Get32(std::size_t offset) const {
+        return static_cast<core::DWord>(space[offset]) |
+               (static_cast<core::DWord>(space[offset + 1]) << 8) |
+               (static_cast<core::DWord>(space[offset + 2]) << 16) |
+               (static_cast<core::DWord>(space[offset + 3]) << 24);
+    }
+
+    std::array<core::Byte, kConfigSpaceSize> space{};
+    std::vector<std::string> log;
+    int batches = 0;
+    std::optional<ConfigOffset> fail_offset;
+
+private:
+    static std::string Hex(ConfigOffset offset) {
+        char buf[8];
+        std::snprintf(buf, sizeof(buf), "%X", offset);
+        return buf;
+    }
+
+    core::Result<void> Write(ConfigOffset offset, int width, core::DWord value) {
+        log.push_back("w" + std::to_string(width) + "@" + Hex(offset));
+        if (fail_offset && *fail_offset == offset) {
+            return core::Result<void>::Err(core::ErrorCode::kIOError);
+        }
+        for (int i = 0; i < width; ++i) {
+            space[offset + static_cast<std::size_t>(i)] = static_cast<core::Byte>(value >> (8 * i));
+        }
+        return core::Result<void>::Ok();
+    }
+};
+
+const Bdf kBdf{0x3B, 0x00, 0x0};
+
+std::error_code Code(core::ErrorCode code) { return core::make_error_code(code); }
+
+TEST(PciConfigBatchTest, NothingHappensBeforeFlush) {
+    FakeConfig config;
+    PciConfigBatch batch(config, kBdf);
+    auto index = batch.Write32(0x10, 0xFFFFFFFF);
+    EXPECT_TRUE(config.log.empty());
+    EXPECT_EQ(batch.Pending(), 1u);
+    EXPECT_EQ(batch.Status(index).Error(), Code(core::ErrorCode::kBusy));
+}
+
+TEST(PciConfigBatchTest, WritesRunInOrderAsOneBackendBatch) {
+    FakeConfig config;
+    PciConfigBatch batch(config, kBdf);
+    batch.Write32(0x108, 0x00400000);
+    batch.Write16(0x50, 0x0040);
+    batch.Write8(0x3C, 0x0A);
+
+    ASSERT_TRUE(batch.Flush().IsOk());
+    EXPECT_EQ(config.batches, 1);
+    EXPECT_EQ(config.log, (std::vector<std::string>{"w4@108", "w2@50", "w1@3C"}));
+    for (std::size_t i = 0; i < batch.Size(); ++i) {
+        EXPECT_TRUE(batch.Status(i).IsOk());
+    }
+    EXPECT_EQ(config.Get32(0x108), 0x00400000u);
+    EXPECT_EQ(config.space[0x3C], 0x0A);
+    EXPECT_EQ(batch.Pending(), 0u);
+}
+
+TEST(PciConfigBatchTest, ReadFencesTheWritesAroundIt) {
+    FakeConfig config;
+    PciConfigBatch batch(config, kBdf);
+    batch.Write32(0x104, 0x1);
+    batch.Write32(0x108, 0x2);
+    auto readback = batch.Read32(0x104);
+    batch.Write32(0x104, 0x3);
+
+    ASSERT_TRUE(batch.Flush().IsOk());
+    EXPECT_EQ(config.batches, 2);
+    EXPECT_EQ(config.log,
+              (std::vector<std::string>{"w4@104", "w4@108", "r4@104", "w4@104"}));
+    EXPECT_EQ(batch.Value(readback).Value(), 0x1u);
+    EXPECT_EQ(config.Get32(0x104), 0x3u);
+}
+
+TEST(PciConfigBatchTest, FailedWriteCancelsTheRest) {
+    FakeConfig config;
+    config.fail_offset = 0x20;
+    PciConfigBatch batch(config, kBdf);
+    auto first = batch.Write32(0x10, 0x1);
+    auto failing = batch.Write32(0x20, 0x2);
+    auto after = batch.Write32(0x30, 0x3);
+    auto read = batch.Read32(0x10);
+
+    auto result = batch.Flush();
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), Code(core::ErrorCode::kIOError));
+    EXPECT_TRUE(batch.Status(first).IsOk());
+    EXPECT_EQ(batch.Status(failing).Error(), Code(core::ErrorCode::kIOError));
+    EXPECT_EQ(batch.Status(after).Error(), Code(core::ErrorCode::kCancelled));
+    EXPECT_EQ(batch.Value(read).Error(), Code(core::ErrorCode::kCancelled));
+    EXPECT_EQ(config.log, (std::vector<std::string>{"w4@10", "w4@20"}));
+}
+
+TEST(PciConfigBatchTest, FailedReadCancelsTheRest) {
+    FakeConfig config;
+    config.fail_offset = 0x40;
+    PciConfigBatch batch(config, kBdf);
+    auto read = batch.Read32(0x40);
+    auto write = batch.Write32(0x10, 0x1);
+
+    EXPECT_TRUE(batch.Flush().IsError());
+    EXPECT_EQ(batch.Value(read).Error(), Code(core::ErrorCode::kIOError));
+    EXPECT_EQ(batch.Status(write).Error(), Code(core::ErrorCode::kCancelled));
+    EXPECT_EQ(config.batches, 0);
+}
+
+TEST(PciConfigBatchTest, InvalidWidthFailsThatWrite) {
+    FakeConfig config;
+    ConfigWrite writes[] = {{0x10, 4, 0x1}, {0x14, 3, 0x2}, {0x18, 4, 0x3}};
+    std::error_code status[3];
+    EXPECT_EQ(config.WriteConfigBatch(kBdf, writes, 3, status), 1u);
+    EXPECT_FALSE(status[0]);
+    EXPECT_EQ(status[1], Code(core::ErrorCode::kInvalidArgument));
+    EXPECT_EQ(status[2], Code(core::ErrorCode::kCancelled));
+}
+
+TEST(PciConfigBatchTest, LaterFlushRunsOnlyNewOperations) {
+    FakeConfig config;
+    PciConfigBatch batch(config, kBdf);
+    batch.Write32(0x10, 0x1);
+    ASSERT_TRUE(batch.Flush().IsOk());
+    batch.Write32(0x14, 0x2);
+    ASSERT_TRUE(batch.Flush().IsOk());
+    EXPECT_EQ(config.log, (std::vector<std::string>{"w4@10", "w4@14"}));
+    EXPECT_EQ(batch.Size(), 2u);
+
+    batch.Clear();
+    EXPECT_EQ(batch.Size(), 0u);
+    EXPECT_EQ(batch.Status(0).Error(), Code(core::ErrorCode::kOutOfRange));
+}
+
+TEST(PciConfigBatchTest, ValueOfAWriteIsInvalid) {
+    FakeConfig config;
+    PciConfigBatch batch(config, kBdf);
+    auto write = batch.Write32(0x10, 0x1);
+    ASSERT_TRUE(batch.Flush().IsOk());
+    EXPECT_EQ(batch.Value(write).Error(), Code(core::ErrorCode::kInvalidArgument));
+}
+
+TEST(PciConfigBatchTest, CacheDropsDWordsTheBatchWrote) {
+    FakeConfig config;
+    config.space[0x3C] = 0x05;
+    PciConfigCache cache(config, {{0x3C, 4, CachePolicy::kImmutable}});
+    EXPECT_EQ(cache.ReadConfig8(kBdf, 0x3C).Value(), 0x05);
+
+    PciConfigBatch batch(cache, kBdf);
+    batch.Write8(0x3C, 0x0B);
+    ASSERT_TRUE(batch.Flush().IsOk());
+    EXPECT_EQ(config.batches, 1);
+    EXPECT_EQ(cache.ReadConfig8(kBdf, 0x3C).Value(), 0x0B);
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
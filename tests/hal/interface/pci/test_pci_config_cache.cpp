@@ -0,0 +1,307 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <optional>
+#include <thread>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/pci_config_cache.h"
+
+namespace plas::hal::pci {
+namespace {
+
+/// Config space backed by a byte array, counting the calls that reach it.
+class FakeConfig : public PciConfig {
+public:
+    FakeConfig() {
+        Put32(0x00, 0x0A5410DE);  // vendor 0x10DE, device 0x0A54
+        Put32(0x04, 0x00100006);  // status / command
+        Put32(0x08, 0x01080200);  // class 01:08:02, rev 0
+        Put32(0x10, 0xFE000004);  // BAR0
+        Put32(0x2C, 0x12341AF4);
+        space[0x34] = 0x40;
+        space[0x0E] = 0x00;
+    }
+
+    plas::hal::Device* GetDevice() override { return nullptr; }
+
+    core::Result<core::Byte> ReadConfig8(Bdf, ConfigOffset offset) override {
+        ++reads;
+        return core::Result<core::Byte>::Ok(space[offset]);
+    }
+    core::Result<core::Word> ReadConfig16(Bdf, ConfigOffset offset) override {
+        ++reads;
+        return core::Result<core::Word>::Ok(
+            static_cast<core::Word>(space[offset] | (space[offset + 1] << 8)));
+    }
+    core::Result<core::DWord> ReadConfig32(Bdf, ConfigOffset offset) override {
+        ++reads;
+        if (fail_reads) {
+            return core::Result<core::DWord>::Err(core::ErrorCode::kIOError);
+        }
+        return core::Result<core::DWord>::Ok(Get32(offset));
+    }
+    core::Result<void> WriteConfig8(Bdf, ConfigOffset offset, core::Byte value) override {
+        ++writes;
+        space[offset] = value;
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> WriteConfig16(Bdf, ConfigOffset offset, core::Word value) override {
+        ++writes;
+        space[offset] = static_cast<core::Byte>(value);
+        space[offset + 1] = static_cast<core::Byte>(value >> 8);
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> WriteConfig32(Bdf, ConfigOffset offset, core::DWord value) override {
+        ++writes;
+        Put32(offset, value);
+        return core::Result<void>::Ok();
+    }
+    core::Result<std::optional<ConfigOffset>> FindCapability(Bdf, CapabilityId id) override {
+        ++capability_walks;
+        return core::Result<std::optional<ConfigOffset>>::Ok(
+            id == CapabilityId::kPciExpress ? std::optional<ConfigOffset>(0x40) : std::nullopt);
+    }
+    core::Result<std::optional<ConfigOffset>> FindExtCapability(Bdf, ExtCapabilityId) override {
+        ++capability_walks;
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+    core::Result<void> ReadConfigBlock(Bdf, ConfigOffset offset, core::Byte* buffer,
+                                       std::size_t length) override {
+        ++block_reads;
+        for (std::size_t i = 0; i < length; ++i) {
+            buffer[i] = space[offset + i];
+        }
+        return core::Result<void>::Ok();
+    }
+
+    core::DWord Get32(std::size_t offset) const {
+        return static_cast<core::DWord>(space[offset]) |
+               (static_cast<core::DWord>(space[offset + 1]) << 8) |
+               (static_cast<core::DWord>(space[offset + 2]) << 16) |
+               (static_cast<core::DWord>(space[offset + 3]) << 24);
+    }
+    void Put32(std::size_t offset, core::DWord value) {
+        for (int i = 0; i < 4; ++i) {
+            space[offset + static_cast<std::size_t>(i)] = static_cast<core::Byte>(value >> (8 * i));
+        }
+    }
+
+    std::array<core::Byte, kConfigSpaceSize> space{};
+    int reads = 0;
+    int writes = 0;
+    int block_reads = 0;
+    int capability_walks = 0;
+    bool fail_reads = false;
+};
+
+const Bdf kBdf{0x3B, 0x00, 0x0};
+
+TEST(PciConfigCacheTest, ImmutableFieldsReadHardwareOnce) {
+    FakeConfig backend;
+    PciConfigCache cache(backend);
+
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(cache.ReadConfig16(kBdf, 0x00).Value(), 0x10DE);
+        EXPECT_EQ(cache.ReadConfig16(kBdf, 0x02).Value(), 0x0A54);
+        EXPECT_EQ(cache.ReadConfig8(kBdf, 0x0B).Value(), 0x01);
+        EXPECT_EQ(cache.ReadConfig32(kBdf, 0x2C).Value(), 0x12341AF4u);
+    }
+    EXPECT_EQ(backend.reads, 3);  // DWords 0x00, 0x08, 0x2C
+
+    auto stats = cache.Stats();
+    EXPECT_EQ(stats.misses, 3u);
+    EXPECT_EQ(stats.hits, 397u);
+    EXPECT_EQ(stats.bypassed, 0u);
+    EXPECT_NEAR(stats.HitRate(), 397.0 / 400.0, 1e-9);
+}
+
+TEST(PciConfigCacheTest, UncachedRangesPassThrough) {
+    FakeConfig backend;
+    PciConfigCache cache(backend);
+
+    EXPECT_EQ(cache.ReadConfig16(kBdf, 0x06).Value(), 0x0010);
+    EXPECT_EQ(cache.ReadConfig16(kBdf, 0x06).Value(), 0x0010);
+    // Header Type is cached but BIST next to it is not: a 16-bit read of
+    // both goes to the backend.
+    EXPECT_TRUE(cache.ReadConfig16(kBdf, 0x0E).IsOk());
+    EXPECT_EQ(backend.reads, 3);
+    EXPECT_EQ(cache.Stats().bypassed, 3u);
+    EXPECT_EQ(cache.Stats().HitRate(), 0.0);
+}
+
+TEST(PciConfigCacheTest, WriteInvalidatesOverlappingDWord) {
+    FakeConfig backend;
+    PciConfigCache cache(backend);
+
+    EXPECT_EQ(cache.ReadConfig32(kBdf, 0x10).Value(), 0xFE000004u);
+    // BAR sizing: the all-ones write must not be answered from the cache,
+    // nor replaced by the written value.
+    ASSERT_TRUE(cache.WriteConfig32(kBdf, 0x10, 0xFFFFFFFF).IsOk());
+    backend.Put32(0x10, 0xFF000004);  // what the BAR reads back (16 MiB)
+    EXPECT_EQ(cache.ReadConfig32(kBdf, 0x10).Value(), 0xFF000004u);
+    EXPECT_EQ(backend.reads, 2);
+    EXPECT_GE(cache.Stats().invalidations, 1u);
+}
+
+TEST(PciConfigCacheTest, UntilWriteDropsOnAnyWriteToTheFunction) {
+    FakeConfig backend;
+    PciConfigCache cache(backend);
+    const Bdf other{0x3B, 0x00, 0x1};
+
+    cache.ReadConfig32(kBdf, 0x14);    // BAR1: kUntilWrite
+    cache.ReadConfig32(kBdf, 0x00);    // IDs: kImmutable
+    cache.ReadConfig32(other, 0x14);
+    ASSERT_EQ(backend.reads, 3);
+
+    // Command register write on kBdf only.
+    ASSERT_TRUE(cache.WriteConfig16(kBdf, 0x04, 0x0006).IsOk());
+    cache.ReadConfig32(kBdf, 0x14);
+    EXPECT_EQ(backend.reads, 4);
+    cache.ReadConfig32(kBdf, 0x00);
+    cache.ReadConfig32(other, 0x14);
+    EXPECT_EQ(backend.reads, 4);
+}
+
+TEST(PciConfigCacheTest, TtlExpires) {
+    FakeConfig backend;
+    PciConfigCache cache(backend, {{0x40, 4, CachePolicy::kTtl, std::chrono::milliseconds(20)}});
+
+    backend.Put32(0x40, 1);
+    EXPECT_EQ(cache.ReadConfig32(kBdf, 0x40).Value(), 1u);
+    backend.Put32(0x40, 2);
+    EXPECT_EQ(cache.ReadConfig32(kBdf, 0x40).Value(), 1u);
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_EQ(cache.ReadConfig32(kBdf, 0x40).Value(), 2u);
+    EXPECT_EQ(backend.reads, 2);
+}
+
+TEST(PciConfigCacheTest, SetPolicyAddsAndRemovesRanges) {
+    FakeConfig backend;
+    PciConfigCache cache(backend);
+
+    backend.Put32(0x40, 0x00020010);  // PCIe capability header
+    ASSERT_TRUE(cache.SetPolicy({0x40, 4, CachePolicy::kImmutable}).IsOk());
+    cache.ReadConfig32(kBdf, 0x40);
+    cache.ReadConfig32(kBdf, 0x40);
+    EXPECT_EQ(backend.reads, 1);
+
+    // Turning caching off drops what was kept.
+    cache.ReadConfig32(kBdf, 0x00);
+    ASSERT_EQ(backend.reads, 2);
+    ASSERT_TRUE(cache.SetPolicy({0x00, 4, CachePolicy::kNever}).IsOk());
+    EXPECT_EQ(cache.Stats().invalidations, 1u);
+    cache.ReadConfig32(kBdf, 0x00);
+    cache.ReadConfig32(kBdf, 0x00);
+    EXPECT_EQ(backend.reads, 4);
+
+    EXPECT_EQ(cache.SetPolicy({0xFFE, 4, CachePolicy::kImmutable}).Error(),
+              core::ErrorCode::kOutOfRange);
+}
+
+TEST(PciConfigCacheTest, InvalidateDropsFunction) {
+    FakeConfig backend;
+    PciConfigCache cache(backend);
+
+    cache.ReadConfig32(kBdf, 0x00);
+    cache.FindCapability(kBdf, CapabilityId::kPciExpress);
+    backend.Put32(0x00, 0x11112222);
+    cache.Invalidate(kBdf);
+    EXPECT_EQ(cache.ReadConfig32(kBdf, 0x00).Value(), 0x11112222u);
+    cache.FindCapability(kBdf, CapabilityId::kPciExpress);
+    EXPECT_EQ(backend.capability_walks, 2);
+
+    cache.InvalidateAll();
+    cache.ReadConfig32(kBdf, 0x00);
+    EXPECT_EQ(backend.reads, 3);
+}
+
+TEST(PciConfigCacheTest, CapabilityLookupsAreCached) {
+    FakeConfig backend;
+    PciConfigCache cache(backend);
+
+    for (int i = 0; i < 10; ++i) {
+        auto pcie = cache.FindCapability(kBdf, CapabilityId::kPciExpress);
+        ASSERT_TRUE(pcie.IsOk());
+        EXPECT_EQ(pcie.Value(), std::optional<ConfigOffset>(0x40));
+        auto doe = cache.FindExtCapability(kBdf, ExtCapabilityId::kDoe);
+        ASSERT_TRUE(doe.IsOk());
+        EXPECT_FALSE(doe.Value().has_value());
+    }
+    EXPECT_EQ(backend.capability_walks, 2);
+
+    // Writes do not change capability chains.
+    cache.WriteConfig16(kBdf, 0x04, 0);
+    cache.FindCapability(kBdf, CapabilityId::kPciExpress);
+    EXPECT_EQ(backend.capability_walks, 2);
+}
+
+TEST(PciConfigCacheTest, ReadConfigBlockMixesCacheAndBackend) {
+    FakeConfig backend;
+    PciConfigCache cache(backend);
+
+    std::array<core::Byte, 0x40> first{};
+    ASSERT_TRUE(cache.ReadConfigBlock(kBdf, 0, first.data(), first.size()).IsOk());
+    EXPECT_EQ(backend.block_reads, 1);
+    for (std::size_t i = 0; i < first.size(); ++i) {
+        EXPECT_EQ(first[i], backend.space[i]) << i;
+    }
+
+    // The header's cacheable DWords were kept; the rest is fetched again in
+    // runs between them.
+    backend.space[0x04] = 0x07;
+    std::array<core::Byte, 0x40> second{};
+    ASSERT_TRUE(cache.ReadConfigBlock(kBdf, 0, second.data(), second.size()).IsOk());
+    EXPECT_EQ(second[0x04], 0x07);
+    EXPECT_EQ(second[0x00], 0xDE);
+    EXPECT_EQ(backend.reads, 0);
+    EXPECT_GT(cache.Stats().hits, 0u);
+
+    // Typed reads hit what the block read stored.
+    EXPECT_EQ(cache.ReadConfig16(kBdf, 0x02).Value(), 0x0A54);
+    EXPECT_EQ(backend.reads, 0);
+}
+
+TEST(PciConfigCacheTest, ReadConfigBlockUnalignedAndErrors) {
+    FakeConfig backend;
+    PciConfigCache cache(backend);
+    cache.ReadConfig32(kBdf, 0x08);
+
+    std::array<core::Byte, 5> buf{};
+    ASSERT_TRUE(cache.ReadConfigBlock(kBdf, 0x07, buf.data(), buf.size()).IsOk());
+    for (std::size_t i = 0; i < buf.size(); ++i) {
+        EXPECT_EQ(buf[i], backend.space[0x07 + i]) << i;
+    }
+
+    EXPECT_EQ(cache.ReadConfigBlock(kBdf, 0xFFE, buf.data(), 4).Error(),
+              core::ErrorCode::kOutOfRange);
+    EXPECT_EQ(cache.ReadConfigBlock(kBdf, 0, nullptr, 4).Error(),
+              core::ErrorCode::kInvalidArgument);
+}
+
+TEST(PciConfigCacheTest, ErrorsAreNotCached) {
+    FakeConfig backend;
+    PciConfigCache cache(backend);
+
+    backend.fail_reads = true;
+    EXPECT_EQ(cache.ReadConfig32(kBdf, 0x00).Error(), core::ErrorCode::kIOError);
+    backend.fail_reads = false;
+    EXPECT_EQ(cache.ReadConfig32(kBdf, 0x00).Value(), 0x0A5410DEu);
+    EXPECT_EQ(backend.reads, 2);
+}
+
+TEST(PciConfigCacheTest, ForwardsInterface) {
+    FakeConfig backend;
+    PciConfigCache cache(backend);
+    EXPECT_EQ(cache.InterfaceName(), "PciConfig");
+    EXPECT_EQ(cache.GetDevice(), nullptr);
+    EXPECT_EQ(&cache.Backend(), &backend);
+
+    ASSERT_TRUE(cache.WriteConfig8(kBdf, 0x3C, 0x0B).IsOk());
+    EXPECT_EQ(backend.space[0x3C], 0x0B);
+    EXPECT_EQ(backend.writes, 1);
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
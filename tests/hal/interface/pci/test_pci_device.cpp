@@ -12,6 +12,9 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/ecam.h"
+#include "plas/hal/interface/pci/pci_config_batch.h"
 #include "plas/hal/interface/pci/pci_device.h"
 
 namespace plas::hal::pci {
@@ -155,7 +158,9 @@ protected:
 
     // Create a fake BAR resource file and resource<N> file for mmap.
     void CreateFakeBar(const std::string& device_bdf,
-                       uint8_t bar_index, uint64_t size) {
+                       uint8_t bar_index, uint64_t size,
+                       uint64_t flags = 0x00040200,
+                       bool write_combining = false) {
         // Resolve real path from symlink
         std::string link_path =
             sysfs_root_ + "/bus/pci/devices/" + device_bdf;
@@ -163,23 +168,27 @@ protected:
         ASSERT_NE(::realpath(link_path.c_str(), resolved), nullptr);
         std::string real_path(resolved);
 
-        // Write resource file (one line per BAR, format: start end flags)
+        // Write resource file (one line per BAR, format: start end flags),
+        // keeping the lines of BARs created earlier.
         std::string resource_path = real_path + "/resource";
-        std::ofstream resource(resource_path);
-        for (uint8_t i = 0; i <= 5; ++i) {
-            if (i == bar_index) {
-                // start=0, end=size-1, flags=0
-                char line[128];
-                std::snprintf(line, sizeof(line),
-                              "0x%016llx 0x%016llx 0x%016x",
-                              0ULL, static_cast<unsigned long long>(size - 1),
-                              0x00040200);
-                resource << line << "\n";
-            } else {
-                resource << "0x0000000000000000 0x0000000000000000 "
-                            "0x0000000000000000\n";
+        std::vector<std::string> lines(
+            6, "0x0000000000000000 0x0000000000000000 0x0000000000000000");
+        {
+            std::ifstream existing(resource_path);
+            for (auto& line : lines) {
+                if (!std::getline(existing, line)) break;
             }
         }
+        // start=0, end=size-1
+        char line[128];
+        std::snprintf(line, sizeof(line), "0x%016llx 0x%016llx 0x%016llx",
+                      0ULL, static_cast<unsigned long long>(size - 1),
+                      static_cast<unsigned long long>(flags));
+        lines[bar_index] = line;
+        std::ofstream resource(resource_path);
+        for (const auto& l : lines) {
+            resource << l << "\n";
+        }
         resource.close();
 
         // Create resourceN file with the right size (truncate to fill with
@@ -190,6 +199,12 @@ protected:
         ASSERT_GE(fd, 0);
         ASSERT_EQ(::ftruncate(fd, static_cast<off_t>(size)), 0);
         ::close(fd);
+
+        // resourceN_wc aliases the same backing file, like the real
+        // attribute aliases the same BAR.
+        if (write_combining) {
+            ASSERT_EQ(::link(res_file.c_str(), (res_file + "_wc").c_str()), 0);
+        }
     }
 
     void CreateTopology(
@@ -262,6 +277,39 @@ TEST_F(PciDeviceTest, DeviceInfoBridge) {
     EXPECT_TRUE(dev.Value().IsBridge());
 }
 
+TEST_F(PciDeviceTest, NumaLocality) {
+    CreateFakeDevice({"0000:00:01.0", "0000:03:00.0"});
+    std::string dir = sysfs_root_ + "/bus/pci/devices/0000:03:00.0";
+    WriteFile(dir + "/numa_node", "0\n");
+    WriteFile(dir + "/local_cpulist", "0\n");
+
+    auto dev = PciDevice::Open("0000:03:00.0");
+    ASSERT_TRUE(dev.IsOk());
+    EXPECT_EQ(dev.Value().NumaNode(), 0);
+    EXPECT_EQ(dev.Value().LocalCpus(), std::vector<int>{0});
+    EXPECT_EQ(&dev.Value().LocalExecutor(), &core::Executor::ForCpus({0}));
+
+    auto buffer = dev.Value().AllocateLocalBuffer(4096);
+    ASSERT_TRUE(buffer.IsOk());
+    EXPECT_EQ(buffer.Value().Size(), 4096u);
+}
+
+TEST_F(PciDeviceTest, NumaLocalityUnknown) {
+    CreateFakeDevice({"0000:00:01.0", "0000:03:00.0"});
+    auto dev = PciDevice::Open("0000:03:00.0");
+    ASSERT_TRUE(dev.IsOk());
+    EXPECT_EQ(dev.Value().NumaNode(), -1);
+    EXPECT_TRUE(dev.Value().LocalCpus().empty());
+    EXPECT_EQ(&dev.Value().LocalExecutor(), &core::Executor::Shared());
+    auto buffer = dev.Value().AllocateLocalBuffer(100);
+    ASSERT_TRUE(buffer.IsOk());
+    EXPECT_EQ(buffer.Value().Node(), -1);
+    auto lease = dev.Value().AcquireLocalBuffer(100);
+    ASSERT_TRUE(lease.IsOk());
+    EXPECT_EQ(lease.Value().Size(), 100u);
+    EXPECT_EQ(lease.Value().Node(), -1);
+}
+
 // ===== Config Read Tests =====
 
 TEST_F(PciDeviceTest, ReadConfig8) {
@@ -308,6 +356,106 @@ TEST_F(PciDeviceTest, ReadConfig32) {
     EXPECT_EQ(result.Value(), 0xA0008086u);
 }
 
+TEST_F(PciDeviceTest, ReadConfigBlock) {
+    auto config = BuildConfigBlob(0x00, PciePortType::kEndpoint);
+    config[0x00] = 0x86;
+    config[0x01] = 0x80;
+    config[0x02] = 0x00;
+    config[0x03] = 0xA0;
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, config);
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+
+    std::vector<uint8_t> buf(6, 0);
+    auto result = dev.Value().ReadConfigBlock(0x01, buf.data(), buf.size());
+    ASSERT_TRUE(result.IsOk());
+    std::vector<uint8_t> expected(config.begin() + 1, config.begin() + 7);
+    EXPECT_EQ(buf, expected);
+}
+
+TEST_F(PciDeviceTest, ReadConfigBlockPastEnd) {
+    // 256-byte config file: a read crossing its end is a short pread
+    auto config = BuildConfigBlob(0x00, PciePortType::kEndpoint, true, 256);
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, config);
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+
+    std::vector<uint8_t> buf(16, 0);
+    auto result = dev.Value().ReadConfigBlock(0xF8, buf.data(), buf.size());
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), core::make_error_code(core::ErrorCode::kIOError));
+
+    auto oob = dev.Value().ReadConfigBlock(0xFFC, buf.data(), buf.size());
+    ASSERT_TRUE(oob.IsError());
+    EXPECT_EQ(oob.Error(), core::make_error_code(core::ErrorCode::kOutOfRange));
+}
+
+TEST_F(PciDeviceTest, ReadConfigBlocksAcrossDevices) {
+    std::vector<std::vector<uint8_t>> configs;
+    std::vector<PciDevice> devices;
+    for (int i = 0; i < 3; ++i) {
+        auto config = BuildConfigBlob(0x00, PciePortType::kEndpoint);
+        config[0x00] = static_cast<uint8_t>(0x10 + i);
+        config[0x2C] = static_cast<uint8_t>(0xA0 + i);
+        std::string bdf = "0000:0" + std::to_string(i + 1) + ":00.0";
+        CreateFakeDevice({"0000:00:01.0", bdf}, config);
+        auto dev = PciDevice::Open(bdf);
+        ASSERT_TRUE(dev.IsOk());
+        devices.push_back(std::move(dev.Value()));
+        configs.push_back(std::move(config));
+    }
+
+    std::vector<std::vector<uint8_t>> bufs(5, std::vector<uint8_t>(4, 0));
+    std::vector<PciConfigBlockRead> reads = {
+        {&devices[0], 0x00, bufs[0].data(), 4},
+        {&devices[1], 0x2C, bufs[1].data(), 4},
+        {&devices[2], 0x00, bufs[2].data(), 4},
+        {&devices[2], 0xFE, bufs[3].data(), 4},   // short read at the end
+        {nullptr, 0x00, bufs[4].data(), 4},
+    };
+    auto results = PciDevice::ReadConfigBlocks(reads.data(), reads.size());
+    ASSERT_EQ(results.size(), reads.size());
+    ASSERT_TRUE(results[0].IsOk());
+    ASSERT_TRUE(results[1].IsOk());
+    ASSERT_TRUE(results[2].IsOk());
+    EXPECT_EQ(bufs[0], std::vector<uint8_t>(configs[0].begin(), configs[0].begin() + 4));
+    EXPECT_EQ(bufs[1], std::vector<uint8_t>(configs[1].begin() + 0x2C,
+                                            configs[1].begin() + 0x30));
+    EXPECT_EQ(bufs[2][0], 0x12);
+    EXPECT_EQ(results[3].Error(), core::make_error_code(core::ErrorCode::kIOError));
+    EXPECT_EQ(results[4].Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
+TEST_F(PciDeviceTest, SnapshotConfigExtended) {
+    auto config = BuildConfigBlobWithExtCap(
+        0x00, PciePortType::kEndpoint,
+        static_cast<uint16_t>(ExtCapabilityId::kDoe), 0x100);
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, config);
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+
+    auto result = dev.Value().SnapshotConfig();
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), config);
+}
+
+TEST_F(PciDeviceTest, SnapshotConfigLegacy) {
+    auto config = BuildConfigBlob(0x00, PciePortType::kEndpoint, true, 256);
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, config);
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+
+    auto result = dev.Value().SnapshotConfig();
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value().size(), kLegacyConfigSpaceSize);
+    EXPECT_EQ(result.Value(), config);
+}
+
 // ===== Config Write Tests =====
 
 TEST_F(PciDeviceTest, WriteConfig8ReadBack) {
@@ -356,6 +504,47 @@ TEST_F(PciDeviceTest, WriteConfig32ReadBack) {
     EXPECT_EQ(rd.Value(), 0xDEADBEEF);
 }
 
+TEST_F(PciDeviceTest, WriteConfigBatchCoalescesDWordRuns) {
+    auto config = BuildConfigBlob(0x00, PciePortType::kEndpoint, true, 256);
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, config);
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+
+    ConfigWrite writes[] = {{0x10, 4, 0x11111111},
+                            {0x14, 4, 0x22222222},
+                            {0x18, 4, 0x33333333},
+                            {0x3C, 1, 0x0A},
+                            {0x20, 4, 0x44444444}};
+    std::error_code status[5];
+    EXPECT_EQ(dev.Value().WriteConfigBatch(writes, 5, status), 5u);
+    for (const auto& s : status) {
+        EXPECT_FALSE(s);
+    }
+    EXPECT_EQ(dev.Value().ReadConfig32(0x14).Value(), 0x22222222u);
+    EXPECT_EQ(dev.Value().ReadConfig32(0x18).Value(), 0x33333333u);
+    EXPECT_EQ(dev.Value().ReadConfig8(0x3C).Value(), 0x0A);
+    EXPECT_EQ(dev.Value().ReadConfig32(0x20).Value(), 0x44444444u);
+}
+
+TEST_F(PciDeviceTest, ConfigBatchReadsBackBetweenWrites) {
+    auto config = BuildConfigBlob(0x00, PciePortType::kEndpoint, true, 256);
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, config);
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+
+    PciConfigBatch batch(dev.Value());
+    batch.Write32(0x10, 0xCAFEF00D);
+    batch.Write32(0x14, 0x12345678);
+    auto readback = batch.Read32(0x10);
+    batch.Write32(0x10, 0);
+    ASSERT_TRUE(batch.Flush().IsOk());
+    EXPECT_EQ(batch.Value(readback).Value(), 0xCAFEF00Du);
+    EXPECT_EQ(dev.Value().ReadConfig32(0x10).Value(), 0u);
+    EXPECT_EQ(dev.Value().ReadConfig32(0x14).Value(), 0x12345678u);
+}
+
 // ===== Capability Walking Tests =====
 
 TEST_F(PciDeviceTest, FindCapabilityPciExpress) {
@@ -444,6 +633,128 @@ TEST_F(PciDeviceTest, FindExtCapabilityNotPresent) {
     }
 }
 
+TEST_F(PciDeviceTest, GetCapabilityIndex) {
+    auto config = BuildConfigBlobWithExtCap(
+        0x00, PciePortType::kEndpoint,
+        static_cast<uint16_t>(ExtCapabilityId::kDoe), 0x100);
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, config);
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+
+    auto result = dev.Value().GetCapabilityIndex();
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value().Find(CapabilityId::kPciExpress),
+              ConfigOffset{0x40});
+    EXPECT_EQ(result.Value().FindAll(ExtCapabilityId::kDoe),
+              std::vector<ConfigOffset>{0x100});
+}
+
+TEST_F(PciDeviceTest, CapabilityIndexRebuiltAfterRescan) {
+    auto config = BuildConfigBlob(0x00, PciePortType::kEndpoint, true, 256);
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, config);
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+    ASSERT_TRUE(dev.Value().FindCapability(CapabilityId::kMsi).IsOk());
+    EXPECT_FALSE(
+        dev.Value().FindCapability(CapabilityId::kMsi).Value().has_value());
+
+    // Firmware update adds an MSI cap; the cached index is stale until a
+    // topology change bumps the generation.
+    auto updated = BuildConfigBlobWithCapChain(
+        0x00, PciePortType::kEndpoint,
+        static_cast<uint8_t>(CapabilityId::kMsi), 0x50);
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, updated);
+    EXPECT_FALSE(
+        dev.Value().FindCapability(CapabilityId::kMsi).Value().has_value());
+
+    ASSERT_TRUE(PciTopology::RescanAll().IsOk());
+    auto result = dev.Value().FindCapability(CapabilityId::kMsi);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), ConfigOffset{0x50});
+}
+
+// ===== CXL DVSEC Tests =====
+
+// Config blob with a Type 3 CXL Device DVSEC at 0x100 and a Register Locator
+// DVSEC at 0x140 holding one component register block in BAR 2.
+static std::vector<uint8_t> BuildCxlConfigBlob() {
+    auto config = BuildConfigBlob(0x00, PciePortType::kEndpoint, true, 4096);
+    auto put32 = [&config](std::size_t offset, uint32_t value) {
+        std::memcpy(&config[offset], &value, sizeof(value));
+    };
+    constexpr uint32_t kDvsec = static_cast<uint32_t>(ExtCapabilityId::kDvsec);
+    put32(0x100, kDvsec | (1u << 16) | (0x140u << 20));
+    put32(0x104, cxl::kCxlVendorId | (1u << 16) | (0x3Cu << 20));
+    put32(0x108, static_cast<uint32_t>(CxlDvsecId::kCxlDevice) |
+                     (0x0004u << 16));  // DVSEC CXL Capability: Mem_Capable
+    put32(0x140, kDvsec | (1u << 16));
+    put32(0x144, cxl::kCxlVendorId | (0x14u << 20));
+    put32(0x148, static_cast<uint32_t>(CxlDvsecId::kRegisterLocator));
+    put32(0x14C, 0x2 | (static_cast<uint32_t>(
+                            CxlRegisterBlockId::kComponentRegister)
+                        << 8) |
+                     0x00010000);
+    put32(0x150, 0);
+    return config;
+}
+
+TEST_F(PciDeviceTest, CxlDvsecs) {
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, BuildCxlConfigBlob());
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+
+    auto dvsecs = dev.Value().EnumerateCxlDvsecs();
+    ASSERT_TRUE(dvsecs.IsOk());
+    ASSERT_EQ(dvsecs.Value().size(), 2u);
+    EXPECT_EQ(dvsecs.Value()[0].dvsec_id, CxlDvsecId::kCxlDevice);
+    EXPECT_EQ(dvsecs.Value()[1].offset, 0x140);
+
+    auto locator = dev.Value().FindCxlDvsec(CxlDvsecId::kRegisterLocator);
+    ASSERT_TRUE(locator.IsOk());
+    ASSERT_TRUE(locator.Value().has_value());
+    EXPECT_EQ(locator.Value()->dvsec_length, 0x14);
+
+    auto type = dev.Value().GetCxlDeviceType();
+    ASSERT_TRUE(type.IsOk());
+    EXPECT_EQ(type.Value(), CxlDeviceType::kType3);
+
+    auto blocks = dev.Value().GetRegisterBlocks();
+    ASSERT_TRUE(blocks.IsOk());
+    ASSERT_EQ(blocks.Value().size(), 1u);
+    EXPECT_EQ(blocks.Value()[0],
+              (RegisterBlockEntry{CxlRegisterBlockId::kComponentRegister, 2,
+                                  0x10000}));
+
+    auto header2 = dev.Value().ReadDvsecRegister(0x100, 0x08);
+    ASSERT_TRUE(header2.IsOk());
+    EXPECT_EQ(header2.Value(), 0x00040000u);
+    EXPECT_EQ(dev.Value().ReadDvsecRegister(0xFF0, 0x10).Error(),
+              core::make_error_code(core::ErrorCode::kOutOfRange));
+}
+
+TEST_F(PciDeviceTest, CxlDvsecsCachedUntilRescan) {
+    auto plain = BuildConfigBlob(0x00, PciePortType::kEndpoint, true, 4096);
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, plain);
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+    ASSERT_TRUE(dev.Value().EnumerateCxlDvsecs().IsOk());
+    EXPECT_TRUE(dev.Value().EnumerateCxlDvsecs().Value().empty());
+    EXPECT_EQ(dev.Value().GetCxlDeviceType().Value(), CxlDeviceType::kUnknown);
+
+    // DVSECs appear in config space; lookups keep answering from the cache
+    // until a topology change bumps the generation.
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, BuildCxlConfigBlob());
+    EXPECT_TRUE(dev.Value().EnumerateCxlDvsecs().Value().empty());
+
+    ASSERT_TRUE(PciTopology::RescanAll().IsOk());
+    EXPECT_EQ(dev.Value().EnumerateCxlDvsecs().Value().size(), 2u);
+    EXPECT_EQ(dev.Value().GetCxlDeviceType().Value(), CxlDeviceType::kType3);
+}
+
 // ===== BAR MMIO Tests =====
 
 TEST_F(PciDeviceTest, BarRead32Write32) {
@@ -478,6 +789,32 @@ TEST_F(PciDeviceTest, BarRead64Write64) {
     EXPECT_EQ(rd.Value(), 0x0123456789ABCDEFULL);
 }
 
+TEST_F(PciDeviceTest, BarWindowSharesTheMapping) {
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, 0x00,
+                     PciePortType::kEndpoint);
+    CreateFakeBar("0000:01:00.0", 0, 4096);
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+
+    auto window = dev.Value().GetBarWindow(0);
+    ASSERT_TRUE(window.IsOk());
+    EXPECT_EQ(window.Value().Size(), 4096u);
+    EXPECT_TRUE(window.Value().Contains(4092, 4));
+    EXPECT_FALSE(window.Value().Contains(4093, 4));
+    EXPECT_FALSE(window.Value().Contains(~uint64_t{0}, 8));
+
+    window.Value().Write32(0x100, 0xCAFEBABE);
+    EXPECT_EQ(dev.Value().BarRead32(0, 0x100).Value(), 0xCAFEBABEu);
+    ASSERT_TRUE(dev.Value().BarWrite64(0, 0x200, 0x0123456789ABCDEFULL).IsOk());
+    EXPECT_EQ(window.Value().Read64(0x200), 0x0123456789ABCDEFULL);
+
+    EXPECT_EQ(dev.Value().GetBarWindow(1).Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+    EXPECT_EQ(dev.Value().GetBarWindow(6).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
 TEST_F(PciDeviceTest, BarReadWriteBuffer) {
     CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, 0x00,
                      PciePortType::kEndpoint);
@@ -497,6 +834,173 @@ TEST_F(PciDeviceTest, BarReadWriteBuffer) {
     EXPECT_EQ(std::memcmp(write_buf, read_buf, sizeof(write_buf)), 0);
 }
 
+TEST_F(PciDeviceTest, BarBufferExplicitWidth) {
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, 0x00,
+                     PciePortType::kEndpoint);
+    CreateFakeBar("0000:01:00.0", 0, 4096);
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+
+    std::vector<uint8_t> write_buf(256);
+    for (std::size_t i = 0; i < write_buf.size(); ++i) {
+        write_buf[i] = static_cast<uint8_t>(255 - i);
+    }
+    for (auto width : {MmioWidth::k32, MmioWidth::k64, MmioWidth::k128,
+                       MmioWidth::k256}) {
+        if (!IsMmioWidthSupported(width)) continue;
+        ASSERT_TRUE(dev.Value().BarWriteBuffer(0, 0x400, write_buf.data(),
+                                               write_buf.size(), width)
+                        .IsOk());
+        std::vector<uint8_t> read_buf(write_buf.size());
+        ASSERT_TRUE(dev.Value().BarReadBuffer(0, 0x400, read_buf.data(),
+                                              read_buf.size(), width)
+                        .IsOk());
+        EXPECT_EQ(read_buf, write_buf);
+    }
+
+    uint8_t small[6] = {};
+    auto misaligned =
+        dev.Value().BarReadBuffer(0, 0x402, small, sizeof(small),
+                                  MmioWidth::k32);
+    ASSERT_TRUE(misaligned.IsError());
+    EXPECT_EQ(misaligned.Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    EXPECT_TRUE(dev.Value().BarReadBuffer(0, 0x402, small, sizeof(small))
+                    .IsOk());
+}
+
+TEST_F(PciDeviceTest, BarResourcesCachedUntilRescan) {
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, 0x00,
+                     PciePortType::kEndpoint);
+    CreateFakeBar("0000:01:00.0", 0, 4096);
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+    auto bar0 = dev.Value().GetBarResource(0);
+    ASSERT_TRUE(bar0.IsOk());
+    EXPECT_EQ(bar0.Value().Size(), 4096u);
+    EXPECT_TRUE(bar0.Value().IsMemory());
+
+    // Rewriting `resource` is invisible until a topology change.
+    CreateFakeBar("0000:01:00.0", 1, 8192);
+    EXPECT_FALSE(dev.Value().GetBarResource(1).Value().IsImplemented());
+
+    ASSERT_TRUE(PciTopology::RescanAll().IsOk());
+    EXPECT_EQ(dev.Value().GetBarResource(1).Value().Size(), 8192u);
+    EXPECT_EQ(dev.Value().GetBarResource(0).Value().Size(), 4096u);
+
+    auto bad = dev.Value().GetBarResource(6);
+    ASSERT_TRUE(bad.IsError());
+    EXPECT_EQ(bad.Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
+TEST_F(PciDeviceTest, MapAllBarsMapsUpFront) {
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, 0x00,
+                     PciePortType::kEndpoint);
+    CreateFakeBar("0000:01:00.0", 0, 4096);
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+    ASSERT_TRUE(dev.Value().MapAllBars().IsOk());
+
+    // The mapping outlives the sysfs file, so no access opens it again.
+    std::string resource0 = dev.Value().SysfsPath() + "/resource0";
+    ASSERT_EQ(::unlink(resource0.c_str()), 0);
+    ASSERT_TRUE(dev.Value().BarWrite32(0, 0x10, 0x5A5A5A5A).IsOk());
+    auto rd = dev.Value().BarRead32(0, 0x10);
+    ASSERT_TRUE(rd.IsOk());
+    EXPECT_EQ(rd.Value(), 0x5A5A5A5Au);
+}
+
+TEST_F(PciDeviceTest, MapAllBarsSkipsIoBars) {
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, 0x00,
+                     PciePortType::kEndpoint);
+    CreateFakeBar("0000:01:00.0", 4, 32, 0x00040101);
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+    std::string resource4 = dev.Value().SysfsPath() + "/resource4";
+    ASSERT_EQ(::unlink(resource4.c_str()), 0);
+    EXPECT_TRUE(dev.Value().MapAllBars().IsOk());
+}
+
+TEST_F(PciDeviceTest, BarPrefetchableFlag) {
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, 0x00,
+                     PciePortType::kEndpoint);
+    CreateFakeBar("0000:01:00.0", 2, 4096, 0x0014220c);
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+
+    auto prefetchable = dev.Value().IsBarPrefetchable(2);
+    ASSERT_TRUE(prefetchable.IsOk());
+    EXPECT_TRUE(prefetchable.Value());
+
+    auto missing = dev.Value().IsBarPrefetchable(0);
+    ASSERT_TRUE(missing.IsError());
+    EXPECT_EQ(missing.Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+}
+
+TEST_F(PciDeviceTest, BarWriteCombiningMapping) {
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, 0x00,
+                     PciePortType::kEndpoint);
+    CreateFakeBar("0000:01:00.0", 2, 4096, 0x0014220c, true);
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+    EXPECT_EQ(dev.Value().GetBarMapping(2), BarMapping::kUncached);
+
+    ASSERT_TRUE(dev.Value().BarWrite32(2, 0x0, 0x11111111).IsOk());
+    ASSERT_TRUE(
+        dev.Value().SetBarMapping(2, BarMapping::kWriteCombining).IsOk());
+    EXPECT_EQ(dev.Value().GetBarMapping(2), BarMapping::kWriteCombining);
+
+    std::vector<uint8_t> data(512);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7);
+    }
+    ASSERT_TRUE(
+        dev.Value().BarWriteBuffer(2, 0x100, data.data(), data.size()).IsOk());
+    ASSERT_TRUE(dev.Value().BarWrite32(2, 0x0, 0x22222222).IsOk());
+    ASSERT_TRUE(dev.Value().BarFlush(2).IsOk());
+
+    // Back to uncached: the same BAR sees everything written through the
+    // write-combining mapping.
+    ASSERT_TRUE(dev.Value().SetBarMapping(2, BarMapping::kUncached).IsOk());
+    auto doorbell = dev.Value().BarRead32(2, 0x0);
+    ASSERT_TRUE(doorbell.IsOk());
+    EXPECT_EQ(doorbell.Value(), 0x22222222u);
+    std::vector<uint8_t> read_back(data.size());
+    ASSERT_TRUE(dev.Value()
+                    .BarReadBuffer(2, 0x100, read_back.data(),
+                                   read_back.size())
+                    .IsOk());
+    EXPECT_EQ(read_back, data);
+}
+
+TEST_F(PciDeviceTest, BarWriteCombiningRejectedForNonPrefetchable) {
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, 0x00,
+                     PciePortType::kEndpoint);
+    CreateFakeBar("0000:01:00.0", 0, 4096, 0x00040200, true);
+    CreateFakeBar("0000:01:00.0", 2, 4096, 0x0014220c);  // no resource2_wc
+
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+
+    auto bar0 = dev.Value().SetBarMapping(0, BarMapping::kWriteCombining);
+    ASSERT_TRUE(bar0.IsError());
+    EXPECT_EQ(bar0.Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    auto bar2 = dev.Value().SetBarMapping(2, BarMapping::kWriteCombining);
+    ASSERT_TRUE(bar2.IsError());
+    EXPECT_EQ(bar2.Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    EXPECT_EQ(dev.Value().GetBarMapping(0), BarMapping::kUncached);
+}
+
 TEST_F(PciDeviceTest, BarOutOfRange) {
     CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, 0x00,
                      PciePortType::kEndpoint);
@@ -614,6 +1118,36 @@ TEST_F(PciDeviceTest, FindRootPort) {
     EXPECT_EQ(root.Value().PortType(), PciePortType::kRootPort);
 }
 
+TEST_F(PciDeviceTest, TopologyFromSnapshot) {
+    CreateTopology(
+        {"0000:3a:00.0", "0000:3b:00.0", "0000:3c:08.0", "0000:41:00.0"},
+        {{0x01, PciePortType::kRootPort},
+         {0x01, PciePortType::kUpstreamPort},
+         {0x01, PciePortType::kDownstreamPort},
+         {0x00, PciePortType::kEndpoint}});
+    auto snapshot = PciTopologySnapshot::Build();
+    ASSERT_TRUE(snapshot.IsOk());
+
+    auto dev = PciDevice::Open("0000:3c:08.0");
+    ASSERT_TRUE(dev.IsOk());
+
+    auto parent = dev.Value().FindParent(snapshot.Value());
+    ASSERT_TRUE(parent.IsOk());
+    ASSERT_TRUE(parent.Value().has_value());
+    EXPECT_EQ(parent.Value()->AddressString(), "0000:3b:00.0");
+    EXPECT_EQ(parent.Value()->PortType(), PciePortType::kUpstreamPort);
+
+    auto children = dev.Value().FindChildren(snapshot.Value());
+    ASSERT_TRUE(children.IsOk());
+    ASSERT_EQ(children.Value().size(), 1u);
+    EXPECT_EQ(children.Value()[0].AddressString(), "0000:41:00.0");
+    EXPECT_EQ(children.Value()[0].PortType(), PciePortType::kEndpoint);
+
+    auto root = dev.Value().FindRootPort(snapshot.Value());
+    ASSERT_TRUE(root.IsOk());
+    EXPECT_EQ(root.Value().AddressString(), "0000:3a:00.0");
+}
+
 TEST_F(PciDeviceTest, GetPathToRoot) {
     CreateTopology(
         {"0000:3a:00.0", "0000:3b:00.0", "0000:41:00.0"},
@@ -670,6 +1204,161 @@ TEST_F(PciDeviceTest, Rescan) {
     EXPECT_EQ(ReadFileContent(std::string(resolved) + "/rescan"), "1");
 }
 
+// ===== ECAM Access Tests =====
+
+// Fake ECAM: MCFG maps segment 0, buses 0-1 at physical address 0, and a
+// sparse regular file stands in for /dev/mem.
+class PciDeviceEcamTest : public PciDeviceTest {
+protected:
+    void SetUp() override {
+        PciDeviceTest::SetUp();
+        std::vector<uint8_t> mcfg(60, 0);
+        std::memcpy(mcfg.data(), "MCFG", 4);
+        mcfg[4] = static_cast<uint8_t>(mcfg.size());
+        mcfg[44 + 11] = 0x01;  // end bus
+        MkdirP(sysfs_root_ + "/firmware/acpi/tables");
+        WriteBinaryFile(sysfs_root_ + "/firmware/acpi/tables/MCFG", mcfg);
+
+        mem_path_ = sysfs_root_ + "/mem";
+        WriteBinaryFile(mem_path_, {});
+        ASSERT_EQ(::truncate(mem_path_.c_str(), 2 << 20), 0);
+        Ecam::SetMemoryPath(mem_path_);
+    }
+
+    void TearDown() override {
+        Ecam::SetMemoryPath("/dev/mem");
+        PciDeviceTest::TearDown();
+    }
+
+    // Place `config` in the fake ECAM window of bus/device/function.
+    void WriteEcam(uint8_t bus, uint8_t dev, uint8_t fn,
+                   const std::vector<uint8_t>& config) {
+        int fd = ::open(mem_path_.c_str(), O_WRONLY);
+        ASSERT_GE(fd, 0);
+        off_t at = (static_cast<off_t>(bus) << 20) | (dev << 15) | (fn << 12);
+        ASSERT_EQ(::pwrite(fd, config.data(), config.size(), at),
+                  static_cast<ssize_t>(config.size()));
+        ::close(fd);
+    }
+
+    std::vector<uint8_t> ReadEcam(uint8_t bus, std::size_t offset,
+                                  std::size_t length) {
+        std::vector<uint8_t> data(length);
+        int fd = ::open(mem_path_.c_str(), O_RDONLY);
+        EXPECT_GE(fd, 0);
+        auto n = ::pread(fd, data.data(), length,
+                         (static_cast<off_t>(bus) << 20) + static_cast<off_t>(offset));
+        EXPECT_EQ(n, static_cast<ssize_t>(length));
+        ::close(fd);
+        return data;
+    }
+
+    std::string mem_path_;
+};
+
+TEST_F(PciDeviceEcamTest, DefaultOpenUsesSysfs) {
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"});
+    auto dev = PciDevice::Open("0000:01:00.0");
+    ASSERT_TRUE(dev.IsOk());
+    EXPECT_EQ(dev.Value().GetConfigAccess(), ConfigAccess::kSysfs);
+}
+
+TEST_F(PciDeviceEcamTest, ReadsComeFromEcamWindow) {
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"});
+    auto ecam_config = BuildConfigBlob(0x00, PciePortType::kEndpoint, true,
+                                       kConfigSpaceSize);
+    ecam_config[0x00] = 0x86;
+    ecam_config[0x01] = 0x80;
+    ecam_config[0x02] = 0x34;
+    ecam_config[0x03] = 0x12;
+    WriteEcam(1, 0, 0, ecam_config);
+
+    auto dev = PciDevice::Open("0000:01:00.0", ConfigAccess::kEcam);
+    ASSERT_TRUE(dev.IsOk());
+    EXPECT_EQ(dev.Value().GetConfigAccess(), ConfigAccess::kEcam);
+
+    auto id = dev.Value().ReadConfig32(0x00);
+    ASSERT_TRUE(id.IsOk());
+    EXPECT_EQ(id.Value(), 0x12348086u);
+    auto vendor = dev.Value().ReadConfig16(0x00);
+    ASSERT_TRUE(vendor.IsOk());
+    EXPECT_EQ(vendor.Value(), 0x8086);
+    auto byte = dev.Value().ReadConfig8(0x03);
+    ASSERT_TRUE(byte.IsOk());
+    EXPECT_EQ(byte.Value(), 0x12);
+
+    auto snapshot = dev.Value().SnapshotConfig();
+    ASSERT_TRUE(snapshot.IsOk());
+    EXPECT_EQ(snapshot.Value(), ecam_config);
+
+    auto pcie = dev.Value().FindCapability(CapabilityId::kPciExpress);
+    ASSERT_TRUE(pcie.IsOk());
+    ASSERT_TRUE(pcie.Value().has_value());
+    EXPECT_EQ(pcie.Value().value(), 0x40);
+}
+
+TEST_F(PciDeviceEcamTest, WritesGoToEcamWindow) {
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"});
+    auto dev = PciDevice::Open("0000:01:00.0", ConfigAccess::kEcam);
+    ASSERT_TRUE(dev.IsOk());
+
+    ASSERT_TRUE(dev.Value().WriteConfig32(0x10, 0xDEADBEEF).IsOk());
+    ASSERT_TRUE(dev.Value().WriteConfig16(0x04, 0x0147).IsOk());
+    EXPECT_EQ(ReadEcam(1, 0x10, 4),
+              (std::vector<uint8_t>{0xEF, 0xBE, 0xAD, 0xDE}));
+    EXPECT_EQ(ReadEcam(1, 0x04, 2), (std::vector<uint8_t>{0x47, 0x01}));
+}
+
+TEST_F(PciDeviceEcamTest, ReadConfigBlockFromEcam) {
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"});
+    std::vector<uint8_t> config(kConfigSpaceSize);
+    for (std::size_t i = 0; i < config.size(); ++i) {
+        config[i] = static_cast<uint8_t>(i * 7);
+    }
+    WriteEcam(1, 0, 0, config);
+
+    auto dev = PciDevice::Open("0000:01:00.0", ConfigAccess::kEcam);
+    ASSERT_TRUE(dev.IsOk());
+    std::vector<uint8_t> aligned(0x100);
+    ASSERT_TRUE(dev.Value().ReadConfigBlock(0x100, aligned.data(),
+                                            aligned.size()).IsOk());
+    EXPECT_TRUE(std::equal(aligned.begin(), aligned.end(),
+                           config.begin() + 0x100));
+    std::vector<uint8_t> unaligned(7);
+    ASSERT_TRUE(dev.Value().ReadConfigBlock(0x103, unaligned.data(),
+                                            unaligned.size()).IsOk());
+    EXPECT_TRUE(std::equal(unaligned.begin(), unaligned.end(),
+                           config.begin() + 0x103));
+}
+
+TEST_F(PciDeviceEcamTest, EcamFailsWithoutRegion) {
+    CreateFakeDevice({"0000:00:01.0"}, 0x01, PciePortType::kRootPort);
+    CreateFakeDevice({"0000:00:01.0", "0000:05:00.0"});
+
+    auto strict = PciDevice::Open("0000:05:00.0", ConfigAccess::kEcam);
+    ASSERT_TRUE(strict.IsError());
+    EXPECT_EQ(strict.Error(), core::make_error_code(core::ErrorCode::kNotFound));
+
+    auto fallback = PciDevice::Open("0000:05:00.0", ConfigAccess::kAuto);
+    ASSERT_TRUE(fallback.IsOk());
+    EXPECT_EQ(fallback.Value().GetConfigAccess(), ConfigAccess::kSysfs);
+}
+
+TEST_F(PciDeviceEcamTest, AutoFallsBackWhenMemoryUnavailable) {
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"});
+    Ecam::SetMemoryPath(sysfs_root_ + "/no_such_mem");
+
+    auto strict = PciDevice::Open("0000:01:00.0", ConfigAccess::kEcam);
+    ASSERT_TRUE(strict.IsError());
+    EXPECT_EQ(strict.Error(),
+              core::make_error_code(core::ErrorCode::kPermissionDenied));
+
+    auto fallback = PciDevice::Open("0000:01:00.0", ConfigAccess::kAuto);
+    ASSERT_TRUE(fallback.IsOk());
+    EXPECT_EQ(fallback.Value().GetConfigAccess(), ConfigAccess::kSysfs);
+    EXPECT_TRUE(fallback.Value().ReadConfig32(0x00).IsOk());
+}
+
 // ===== Move Semantics Tests =====
 
 TEST_F(PciDeviceTest, MoveConstruction) {
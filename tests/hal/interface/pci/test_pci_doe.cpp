@@ -144,5 +144,100 @@ TEST(PciDoeTest, DoeExchangeError) {
     ASSERT_TRUE(result.IsError());
 }
 
+// --- DoeExchangeInto (default implementation) ---
+
+TEST(PciDoeTest, DoeExchangeIntoCopiesResponse) {
+    MockPciDoeDevice device;
+    device.exchange_response_ = {0xAAAA0001, 0xBBBB0002};
+    Bdf bdf{0x03, 0x00, 0x00};
+    core::DWord request[] = {0x01, 0x02, 0x03};
+    core::DWord response[4] = {};
+
+    auto result = device.DoeExchangeInto(bdf, 0x150, {0x0001, 0x01}, request,
+                                         3, response, 4);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), 2u);
+    EXPECT_EQ(response[0], 0xAAAA0001u);
+    EXPECT_EQ(response[1], 0xBBBB0002u);
+    EXPECT_EQ(device.last_request_, (DoePayload{0x01, 0x02, 0x03}));
+}
+
+TEST(PciDoeTest, DoeExchangeIntoOverflow) {
+    MockPciDoeDevice device;
+    device.exchange_response_ = {1, 2, 3};
+    Bdf bdf{0x03, 0x00, 0x00};
+    core::DWord response[2] = {};
+
+    auto result = device.DoeExchangeInto(bdf, 0x150, {0x0001, 0x01}, nullptr,
+                                         0, response, 2);
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), core::make_error_code(core::ErrorCode::kOverflow));
+}
+
+TEST(PciDoeTest, DoeExchangeIntoNullBuffer) {
+    MockPciDoeDevice device;
+    Bdf bdf{0x03, 0x00, 0x00};
+
+    auto result = device.DoeExchangeInto(bdf, 0x150, {0x0001, 0x01}, nullptr,
+                                         1, nullptr, 0);
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
+// --- DoeExchangePooled ---
+
+TEST(PciDoeTest, DoeExchangePooledTrimsToResponse) {
+    MockPciDoeDevice device;
+    device.exchange_response_ = {0xAAAA0001, 0xBBBB0002};
+    Bdf bdf{0x03, 0x00, 0x00};
+    core::DWord request[] = {0x01};
+
+    auto result = device.DoeExchangePooled(bdf, 0x150, {0x0001, 0x01},
+                                           request, 1, 64);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_TRUE(result.Value() == (DoePayload{0xAAAA0001, 0xBBBB0002}));
+    EXPECT_GE(result.Value().Capacity(), 64u);
+    EXPECT_EQ(device.last_request_, (DoePayload{0x01}));
+}
+
+TEST(PciDoeTest, DoeExchangePooledOverflow) {
+    MockPciDoeDevice device;
+    device.exchange_response_ = DoePayload(100, 7);
+    Bdf bdf{0x03, 0x00, 0x00};
+
+    auto result = device.DoeExchangePooled(bdf, 0x150, {0x0001, 0x01},
+                                           nullptr, 0, 64);
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), core::make_error_code(core::ErrorCode::kOverflow));
+}
+
+// --- DoeExchangeAsync (default implementation) ---
+
+TEST(PciDoeTest, DoeExchangeAsyncReturnsResponse) {
+    MockPciDoeDevice device;
+    device.exchange_response_ = {0x11223344, 0x55667788};
+    Bdf bdf{0x03, 0x00, 0x00};
+
+    auto future = device.DoeExchangeAsync(bdf, 0x150, {0x0001, 0x01},
+                                          {0xCAFEBABE});
+    auto result = future.get();
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), device.exchange_response_);
+    EXPECT_EQ(device.last_request_, DoePayload{0xCAFEBABE});
+    EXPECT_EQ(device.last_doe_offset_, 0x150);
+}
+
+TEST(PciDoeTest, DoeExchangeAsyncPropagatesError) {
+    MockPciDoeDevice device;
+    device.exchange_error_ = true;
+    Bdf bdf{0x03, 0x00, 0x00};
+
+    auto result =
+        device.DoeExchangeAsync(bdf, 0x150, {0x0001, 0x01}, {}).get();
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), core::make_error_code(core::ErrorCode::kIOError));
+}
+
 }  // namespace
 }  // namespace plas::hal::pci
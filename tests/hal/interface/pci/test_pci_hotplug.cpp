@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/pci_hotplug.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+
+namespace plas::hal::pci {
+namespace {
+
+// Kernel uevent wire format: NUL-terminated fields.
+std::string Uevent(const std::vector<std::string>& fields) {
+    std::string message;
+    for (const auto& field : fields) {
+        message += field;
+        message.push_back('\0');
+    }
+    return message;
+}
+
+std::optional<PciHotplugEvent> Parse(const std::string& message) {
+    return ParseUevent(message.data(), message.size());
+}
+
+const char* kDevpath = "/devices/pci0000:00/0000:00:1c.0/0000:02:00.0";
+
+TEST(PciHotplugTest, ParsesAddEvent) {
+    auto event = Parse(Uevent({std::string("add@") + kDevpath, "ACTION=add",
+                               std::string("DEVPATH=") + kDevpath,
+                               "SUBSYSTEM=pci", "PCI_CLASS=10802",
+                               "PCI_ID=144D:A808",
+                               "PCI_SLOT_NAME=0000:02:00.0", "SEQNUM=4242"}));
+    ASSERT_TRUE(event.has_value());
+    EXPECT_EQ(event->action, PciHotplugAction::kAdd);
+    EXPECT_EQ(event->address, (PciAddress{0x0000, {0x02, 0x00, 0x00}}));
+}
+
+TEST(PciHotplugTest, ParsesRemoveEvent) {
+    auto event = Parse(Uevent({std::string("remove@") + kDevpath,
+                               "ACTION=remove", "SUBSYSTEM=pci",
+                               "PCI_SLOT_NAME=0001:3b:10.7"}));
+    ASSERT_TRUE(event.has_value());
+    EXPECT_EQ(event->action, PciHotplugAction::kRemove);
+    EXPECT_EQ(event->address, (PciAddress{0x0001, {0x3b, 0x10, 0x07}}));
+}
+
+TEST(PciHotplugTest, IgnoresOtherEvents) {
+    // Other subsystem.
+    EXPECT_FALSE(Parse(Uevent({"add@/devices/virtual/net/tap0", "ACTION=add",
+                               "SUBSYSTEM=net", "INTERFACE=tap0"})));
+    // Other action.
+    EXPECT_FALSE(Parse(Uevent({std::string("bind@") + kDevpath,
+                               "ACTION=bind", "SUBSYSTEM=pci",
+                               "PCI_SLOT_NAME=0000:02:00.0"})));
+    // No slot name.
+    EXPECT_FALSE(Parse(Uevent({std::string("add@") + kDevpath, "ACTION=add",
+                               "SUBSYSTEM=pci"})));
+    EXPECT_FALSE(Parse(Uevent({"ACTION=add", "SUBSYSTEM=pci",
+                               "PCI_SLOT_NAME=zzzz"})));
+    EXPECT_FALSE(ParseUevent(nullptr, 16));
+}
+
+TEST(PciHotplugTest, ToleratesMissingTerminator) {
+    std::string message = Uevent({"ACTION=remove", "SUBSYSTEM=pci",
+                                  "PCI_SLOT_NAME=0000:02:00.0"});
+    message.pop_back();
+    auto event = Parse(message);
+    ASSERT_TRUE(event.has_value());
+    EXPECT_EQ(event->action, PciHotplugAction::kRemove);
+}
+
+TEST(PciHotplugTest, DispatchBumpsGenerationAndRunsCallback) {
+    PciHotplugMonitor monitor;
+    std::vector<PciHotplugEvent> seen;
+    auto started =
+        monitor.Start([&seen](const PciHotplugEvent& e) { seen.push_back(e); });
+    if (started.IsError()) {
+        GTEST_SKIP() << "uevent socket unavailable: "
+                     << started.Error().message();
+    }
+    EXPECT_TRUE(monitor.IsRunning());
+    auto already = monitor.Start(nullptr);
+    ASSERT_TRUE(already.IsError());
+    EXPECT_EQ(already.Error(),
+              core::make_error_code(core::ErrorCode::kAlreadyOpen));
+
+    auto before = PciTopology::GetTopologyGeneration();
+    PciHotplugEvent event{PciHotplugAction::kRemove,
+                          PciAddress{0x0000, {0x02, 0x00, 0x00}}};
+    monitor.Dispatch(event);
+    EXPECT_GT(PciTopology::GetTopologyGeneration(), before);
+    ASSERT_EQ(seen.size(), 1u);
+    EXPECT_EQ(seen[0].address, event.address);
+
+    monitor.Stop();
+    EXPECT_FALSE(monitor.IsRunning());
+    monitor.Stop();  // idempotent
+}
+
+TEST(PciHotplugTest, DispatchWithoutCallbackOnlyBumpsGeneration) {
+    PciHotplugMonitor monitor;
+    auto before = PciTopology::GetTopologyGeneration();
+    monitor.Dispatch({PciHotplugAction::kAdd,
+                      PciAddress{0x0000, {0x02, 0x00, 0x00}}});
+    EXPECT_GT(PciTopology::GetTopologyGeneration(), before);
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <optional>
+
+#include "plas/core/deadline.h"
+#include "plas/core/error.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_link.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+
+namespace plas::hal::pci {
+namespace {
+
+constexpr ConfigOffset kPcieCap = 0x40;
+constexpr ConfigOffset kLinkControl = kPcieCap + 0x10;
+constexpr ConfigOffset kLinkStatus = kPcieCap + 0x12;
+constexpr ConfigOffset kLinkControl2 = kPcieCap + 0x30;
+
+/// A port whose link trains for `training_reads` Link Status reads after
+/// Retrain Link is written, then comes up at the Target Link Speed (capped
+/// at `partner_speed`).
+class FakePort : public Device, public PciConfig {
+public:
+    explicit FakePort(PciePortType type = PciePortType::kRootPort) {
+        space_[0x06] = 0x10;  // capabilities list
+        space_[0x34] = kPcieCap;
+        space_[kPcieCap] = static_cast<core::Byte>(CapabilityId::kPciExpress);
+        Set16(kPcieCap + 0x02, static_cast<uint16_t>(static_cast<uint8_t>(type) << 4 | 2));
+        Set32(kPcieCap + 0x0C, (1u << 20) | (16u << 4) | 4);  // Gen4 x16, DLLLA reporting
+        Set32(kPcieCap + 0x2C, 0x0Fu << 1);                     // Gen1-4
+        Set16(kLinkControl2, 4);
+        SetLink(4, 16);
+    }
+
+    core::Result<void> Init() override { return core::Result<void>::Ok(); }
+    core::Result<void> Open() override { return core::Result<void>::Ok(); }
+    core::Result<void> Close() override { return core::Result<void>::Ok(); }
+    core::Result<void> Reset() override { return core::Result<void>::Ok(); }
+    DeviceState GetState() const override { return DeviceState::kOpen; }
+    std::string GetName() const override { return "fake"; }
+    std::string GetUri() const override { return "fake://0"; }
+    std::string GetDriverName() const override { return "fake"; }
+    plas::hal::Device* GetDevice() override { return this; }
+
+    core::Result<core::Byte> ReadConfig8(Bdf, ConfigOffset offset) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return core::Result<core::Byte>::Ok(space_[offset]);
+    }
+    core::Result<core::Word> ReadConfig16(Bdf, ConfigOffset offset) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (offset == kLinkStatus) {
+            ++status_reads;
+            if (training_left > 0 && --training_left == 0) {
+                auto target = static_cast<uint8_t>(Get16(kLinkControl2) & 0xF);
+                SetLinkLocked(std::min(target, partner_speed), width_after);
+            }
+        }
+        return core::Result<core::Word>::Ok(Get16(offset));
+    }
+    core::Result<core::DWord> ReadConfig32(Bdf, ConfigOffset offset) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        core::DWord value = 0;
+        for (std::size_t i = 4; i-- > 0;) {
+            value = (value << 8) | space_[offset + i];
+        }
+        return core::Result<core::DWord>::Ok(value);
+    }
+    core::Result<void> WriteConfig8(Bdf, ConfigOffset, core::Byte) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> WriteConfig16(Bdf, ConfigOffset offset, core::Word value) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (offset == kLinkControl && (value & (1u << 5))) {
+            ++retrains;
+            value &= static_cast<core::Word>(~(1u << 5));  // reads back as 0
+            if (training_reads > 0) {
+                training_left = training_reads;
+                Set16Locked(kLinkStatus, static_cast<uint16_t>(
+                                             (Get16(kLinkStatus) | (1u << 11)) & ~(1u << 13)));
+            }
+        }
+        Set16Locked(offset, value);
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> WriteConfig32(Bdf, ConfigOffset, core::DWord) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<std::optional<ConfigOffset>> FindCapability(Bdf, CapabilityId) override {
+        return core::Result<std::optional<ConfigOffset>>::Ok(kPcieCap);
+    }
+    core::Result<std::optional<ConfigOffset>> FindExtCapability(Bdf,
+                                                                ExtCapabilityId) override {
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+    core::Result<CapabilityIndex> GetCapabilityIndex(Bdf bdf) override {
+        ++index_builds;
+        return PciConfig::GetCapabilityIndex(bdf);
+    }
+
+    void SetLink(uint8_t speed, uint8_t width) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        SetLinkLocked(speed, width);
+    }
+    void Set16(std::size_t offset, uint16_t value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Set16Locked(offset, value);
+    }
+    uint16_t LinkControl2() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return Get16(kLinkControl2);
+    }
+
+    int training_reads = 3;  ///< Link Status reads that still show training
+    uint8_t partner_speed = 4;
+    uint8_t width_after = 16;
+    int training_left = 0;
+    int status_reads = 0;
+    int retrains = 0;
+    int index_builds = 0;
+
+private:
+    void SetLinkLocked(uint8_t speed, uint8_t width) {
+        Set16Locked(kLinkStatus, static_cast<uint16_t>((1u << 13) | (width << 4) | speed));
+    }
+    void Set16Locked(std::size_t offset, uint16_t value) {
+        space_[offset] = static_cast<core::Byte>(value);
+        space_[offset + 1] = static_cast<core::Byte>(value >> 8);
+    }
+    void Set32(std::size_t offset, uint32_t value) {
+        for (std::size_t i = 0; i < 4; ++i) {
+            space_[offset + i] = static_cast<core::Byte>(value >> (8 * i));
+        }
+    }
+    uint16_t Get16(std::size_t offset) const {
+        return static_cast<uint16_t>(space_[offset] | (space_[offset + 1] << 8));
+    }
+
+    std::mutex mutex_;
+    std::array<core::Byte, kConfigSpaceSize> space_{};
+};
+
+const Bdf kBdf{0x00, 0x01, 0x00};
+
+TEST(PciLinkTest, DecodesLinkStatus) {
+    auto state = PciLinkState::Decode(0x2844);  // DLLLA, training, x4, Gen4
+    EXPECT_EQ(state.speed, PciLinkSpeed::kGen4);
+    EXPECT_EQ(state.width, 4);
+    EXPECT_TRUE(state.training);
+    EXPECT_TRUE(state.dll_active);
+    EXPECT_EQ(PciLinkState::Decode(0x0009).speed, PciLinkSpeed::kUnknown);
+}
+
+TEST(PciLinkTest, CapabilitiesAreReadOnce) {
+    FakePort port;
+    PciLink link(port, kBdf);
+    auto caps = link.GetCapabilities();
+    ASSERT_TRUE(caps.IsOk());
+    EXPECT_EQ(caps.Value().pcie_cap, kPcieCap);
+    EXPECT_EQ(caps.Value().port_type, PciePortType::kRootPort);
+    EXPECT_EQ(caps.Value().max_speed, PciLinkSpeed::kGen4);
+    EXPECT_EQ(caps.Value().max_width, 16);
+    EXPECT_TRUE(caps.Value().dll_active_reporting);
+    EXPECT_TRUE(caps.Value().Supports(PciLinkSpeed::kGen1));
+    EXPECT_TRUE(caps.Value().Supports(PciLinkSpeed::kGen4));
+    EXPECT_FALSE(caps.Value().Supports(PciLinkSpeed::kGen5));
+    EXPECT_TRUE(caps.Value().CanRetrain());
+
+    ASSERT_TRUE(link.GetState().IsOk());
+    ASSERT_TRUE(link.Retrain().IsOk());
+    EXPECT_EQ(port.index_builds, 1);
+
+    PciTopology::NotifyTopologyChanged();
+    ASSERT_TRUE(link.GetState().IsOk());
+    EXPECT_EQ(port.index_builds, 2);
+}
+
+TEST(PciLinkTest, RetrainWaitsForTrainingToFinish) {
+    FakePort port;
+    port.training_reads = 5;
+    PciLink link(port, kBdf);
+    auto transition = link.Retrain();
+    ASSERT_TRUE(transition.IsOk());
+    EXPECT_EQ(port.retrains, 1);
+    EXPECT_EQ(transition.Value().polls, 5u);
+    EXPECT_TRUE(transition.Value().observed_training);
+    EXPECT_FALSE(transition.Value().after.training);
+    EXPECT_TRUE(transition.Value().after.dll_active);
+    EXPECT_EQ(transition.Value().after.speed, PciLinkSpeed::kGen4);
+    EXPECT_GE(transition.Value().elapsed.count(), 0);
+}
+
+TEST(PciLinkTest, SetTargetSpeedWritesLinkControl2) {
+    FakePort port;
+    port.width_after = 8;
+    PciLink link(port, kBdf);
+
+    auto down = link.SetTargetSpeed(PciLinkSpeed::kGen2);
+    ASSERT_TRUE(down.IsOk());
+    EXPECT_EQ(port.LinkControl2() & 0xF, 2);
+    EXPECT_EQ(down.Value().before.speed, PciLinkSpeed::kGen4);
+    EXPECT_EQ(down.Value().after.speed, PciLinkSpeed::kGen2);
+    EXPECT_EQ(down.Value().after.width, 8);
+
+    // The partner tops out at Gen3: the link comes up slower than asked.
+    port.partner_speed = 3;
+    auto up = link.SetTargetSpeed(PciLinkSpeed::kGen4);
+    ASSERT_TRUE(up.IsOk());
+    EXPECT_EQ(up.Value().after.speed, PciLinkSpeed::kGen3);
+
+    EXPECT_EQ(link.SetTargetSpeed(PciLinkSpeed::kGen5).Error(), core::ErrorCode::kInvalidArgument);
+    EXPECT_EQ(port.retrains, 2);
+}
+
+TEST(PciLinkTest, RetrainNeedsADownstreamPort) {
+    FakePort endpoint(PciePortType::kEndpoint);
+    PciLink link(endpoint, kBdf);
+    EXPECT_EQ(link.Retrain().Error(), core::ErrorCode::kNotSupported);
+    EXPECT_EQ(link.SetTargetSpeed(PciLinkSpeed::kGen1).Error(), core::ErrorCode::kNotSupported);
+    EXPECT_EQ(endpoint.retrains, 0);
+}
+
+TEST(PciLinkTest, RetrainTimesOutWhileTheLinkKeepsTraining) {
+    FakePort port;
+    port.training_reads = 1 << 30;
+    PciLinkOptions options;
+    options.timeout = std::chrono::milliseconds(5);
+    options.spin = std::chrono::microseconds(100);
+    PciLink link(port, kBdf, options);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(link.Retrain().Error(), core::ErrorCode::kTimeout);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+
+    // The caller's deadline is shorter than options.timeout.
+    PciLink patient(port, kBdf);
+    {
+        core::ScopedDeadline scope(core::Deadline::After(std::chrono::milliseconds(5)));
+        EXPECT_EQ(patient.GetState().Value().training, true);
+        EXPECT_EQ(patient.Retrain().Error(), core::ErrorCode::kTimeout);
+    }
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
@@ -0,0 +1,337 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/core/executor.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_link_monitor.h"
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace plas::hal::pci {
+namespace {
+
+constexpr ConfigOffset kPcieCap = 0x40;
+constexpr ConfigOffset kAerCap = 0x100;
+
+/// Config space in memory: PCIe capability at 0x40 and, optionally, AER at
+/// 0x100.
+class FakeConfig : public Device, public PciConfig {
+public:
+    explicit FakeConfig(bool with_aer = true) {
+        space_[0x06] = 0x10;  // capabilities list
+        space_[0x34] = kPcieCap;
+        space_[kPcieCap] = static_cast<core::Byte>(CapabilityId::kPciExpress);
+        if (with_aer) {
+            space_[kAerCap] = static_cast<core::Byte>(ExtCapabilityId::kAer);
+            space_[kAerCap + 2] = 0x01;  // version 1, next = 0
+        }
+    }
+
+    core::Result<void> Init() override { return core::Result<void>::Ok(); }
+    core::Result<void> Open() override { return core::Result<void>::Ok(); }
+    core::Result<void> Close() override { return core::Result<void>::Ok(); }
+    core::Result<void> Reset() override { return core::Result<void>::Ok(); }
+    DeviceState GetState() const override { return DeviceState::kOpen; }
+    std::string GetName() const override { return "fake"; }
+    std::string GetUri() const override { return "fake://0"; }
+    std::string GetDriverName() const override { return "fake"; }
+    plas::hal::Device* GetDevice() override { return this; }
+
+    core::Result<core::Byte> ReadConfig8(Bdf /*bdf*/,
+                                          ConfigOffset offset) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fail_) {
+            return core::Result<core::Byte>::Err(core::ErrorCode::kIOError);
+        }
+        return core::Result<core::Byte>::Ok(space_[offset]);
+    }
+    core::Result<core::Word> ReadConfig16(Bdf /*bdf*/,
+                                           ConfigOffset offset) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fail_) {
+            return core::Result<core::Word>::Err(core::ErrorCode::kIOError);
+        }
+        return core::Result<core::Word>::Ok(static_cast<core::Word>(
+            space_[offset] | (space_[offset + 1] << 8)));
+    }
+    core::Result<core::DWord> ReadConfig32(Bdf /*bdf*/,
+                                            ConfigOffset offset) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fail_) {
+            return core::Result<core::DWord>::Err(core::ErrorCode::kIOError);
+        }
+        core::DWord value = 0;
+        for (std::size_t i = 4; i-- > 0;) {
+            value = (value << 8) | space_[offset + i];
+        }
+        return core::Result<core::DWord>::Ok(value);
+    }
+    core::Result<void> WriteConfig8(Bdf, ConfigOffset, core::Byte) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> WriteConfig16(Bdf, ConfigOffset, core::Word) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> WriteConfig32(Bdf, ConfigOffset,
+                                     core::DWord) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<std::optional<ConfigOffset>> FindCapability(
+        Bdf, CapabilityId) override {
+        ADD_FAILURE() << "monitor must not walk capabilities per sample";
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+    core::Result<std::optional<ConfigOffset>> FindExtCapability(
+        Bdf, ExtCapabilityId) override {
+        ADD_FAILURE() << "monitor must not walk capabilities per sample";
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+
+    void SetLinkStatus(uint16_t value) { Set16(kPcieCap + 0x12, value); }
+    void SetDeviceStatus(uint16_t value) { Set16(kPcieCap + 0x0A, value); }
+    void SetAer(uint32_t uncorrectable, uint32_t correctable) {
+        Set32(kAerCap + 0x04, uncorrectable);
+        Set32(kAerCap + 0x10, correctable);
+    }
+    void SetFail(bool fail) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fail_ = fail;
+    }
+
+private:
+    void Set16(std::size_t offset, uint16_t value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        space_[offset] = static_cast<core::Byte>(value);
+        space_[offset + 1] = static_cast<core::Byte>(value >> 8);
+    }
+    void Set32(std::size_t offset, uint32_t value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::size_t i = 0; i < 4; ++i) {
+            space_[offset + i] = static_cast<core::Byte>(value >> (8 * i));
+        }
+    }
+
+    std::mutex mutex_;
+    std::array<core::Byte, kConfigSpaceSize> space_{};
+    bool fail_ = false;
+};
+
+std::vector<PciLinkSample> Drain(const PciLinkMonitor& monitor,
+                                 uint64_t& cursor, uint64_t* lost = nullptr) {
+    std::vector<PciLinkSample> samples(64);
+    samples.resize(monitor.Read(cursor, samples.data(), samples.size(), lost));
+    return samples;
+}
+
+TEST(PciLinkMonitorTest, SamplesRegistersAtResolvedOffsets) {
+    FakeConfig with_aer;
+    FakeConfig without_aer(false);
+    with_aer.SetLinkStatus(0x1044);  // Gen4 x4, DLL active
+    with_aer.SetDeviceStatus(0x0001);
+    with_aer.SetAer(0x00004000, 0x00000041);
+    without_aer.SetLinkStatus(0x0083);
+
+    PciLinkMonitor monitor;
+    auto first = monitor.AddDevice(with_aer, Bdf{0x01, 0x00, 0x00});
+    auto second = monitor.AddDevice(without_aer, Bdf{0x02, 0x00, 0x00});
+    ASSERT_TRUE(first.IsOk());
+    ASSERT_TRUE(second.IsOk());
+    EXPECT_EQ(first.Value(), 0u);
+    EXPECT_EQ(second.Value(), 1u);
+    EXPECT_EQ(monitor.DeviceCount(), 2u);
+
+    uint64_t cursor = monitor.WritePosition();
+    monitor.SampleOnce();
+    auto samples = Drain(monitor, cursor);
+    ASSERT_EQ(samples.size(), 2u);
+    EXPECT_EQ(samples[0].device, 0u);
+    EXPECT_EQ(samples[0].link_status, 0x1044);
+    EXPECT_EQ(samples[0].device_status, 0x0001);
+    EXPECT_EQ(samples[0].aer_uncorrectable, 0x00004000u);
+    EXPECT_EQ(samples[0].aer_correctable, 0x00000041u);
+    EXPECT_EQ(samples[1].device, 1u);
+    EXPECT_EQ(samples[1].link_status, 0x0083);
+    EXPECT_EQ(samples[1].aer_uncorrectable, 0u);
+    EXPECT_GT(samples[0].timestamp_ns, 0u);
+    EXPECT_EQ(cursor, monitor.WritePosition());
+}
+
+TEST(PciLinkMonitorTest, FailedReadsAreAllOnes) {
+    FakeConfig config;
+    PciLinkMonitor monitor;
+    ASSERT_TRUE(monitor.AddDevice(config, Bdf{0x01, 0x00, 0x00}).IsOk());
+    config.SetFail(true);
+
+    uint64_t cursor = 0;
+    monitor.SampleOnce();
+    auto samples = Drain(monitor, cursor);
+    ASSERT_EQ(samples.size(), 1u);
+    EXPECT_EQ(samples[0].link_status, 0xFFFF);
+    EXPECT_EQ(samples[0].device_status, 0xFFFF);
+    EXPECT_EQ(samples[0].aer_uncorrectable, 0xFFFFFFFFu);
+}
+
+TEST(PciLinkMonitorTest, LappedReaderReportsLostSamples) {
+    FakeConfig config;
+    PciLinkMonitorOptions options;
+    options.ring_capacity = 5;  // rounded up to 8
+    PciLinkMonitor monitor(options);
+    ASSERT_TRUE(monitor.AddDevice(config, Bdf{0x01, 0x00, 0x00}).IsOk());
+
+    uint64_t cursor = 0;
+    for (uint16_t i = 0; i < 20; ++i) {
+        config.SetLinkStatus(i);
+        monitor.SampleOnce();
+    }
+    uint64_t lost = 0;
+    auto samples = Drain(monitor, cursor, &lost);
+    EXPECT_EQ(lost, 12u);
+    ASSERT_EQ(samples.size(), 8u);
+    EXPECT_EQ(samples.front().link_status, 12);
+    EXPECT_EQ(samples.back().link_status, 19);
+    EXPECT_EQ(cursor, 20u);
+}
+
+TEST(PciLinkMonitorTest, ChangeCallbackFiresOncePerChange) {
+    FakeConfig config;
+    config.SetLinkStatus(0x1044);
+    PciLinkMonitor monitor;
+    ASSERT_TRUE(monitor.AddDevice(config, Bdf{0x01, 0x00, 0x00}).IsOk());
+    std::vector<std::pair<PciLinkSample, PciLinkSample>> changes;
+    ASSERT_TRUE(monitor
+                    .SetChangeCallback([&changes](const PciLinkSample& before,
+                                                  const PciLinkSample& after) {
+                        changes.emplace_back(before, after);
+                    })
+                    .IsOk());
+
+    monitor.SampleOnce();  // baseline
+    monitor.SampleOnce();
+    EXPECT_TRUE(changes.empty());
+
+    config.SetAer(0, 0x1);  // correctable error logged
+    monitor.SampleOnce();
+    monitor.SampleOnce();
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].first.aer_correctable, 0u);
+    EXPECT_EQ(changes[0].second.aer_correctable, 1u);
+}
+
+TEST(PciLinkMonitorTest, DebounceSuppressesGlitches) {
+    FakeConfig config;
+    config.SetLinkStatus(0x1044);
+    PciLinkMonitorOptions options;
+    options.debounce = std::chrono::milliseconds(30);
+    PciLinkMonitor monitor(options);
+    ASSERT_TRUE(monitor.AddDevice(config, Bdf{0x01, 0x00, 0x00}).IsOk());
+    int changes = 0;
+    uint16_t reported = 0;
+    ASSERT_TRUE(monitor
+                    .SetChangeCallback([&](const PciLinkSample&,
+                                           const PciLinkSample& after) {
+                        ++changes;
+                        reported = after.link_status;
+                    })
+                    .IsOk());
+    monitor.SampleOnce();
+
+    // Link retrains briefly and comes back: no report.
+    config.SetLinkStatus(0x1844);  // link training
+    monitor.SampleOnce();
+    config.SetLinkStatus(0x1044);
+    monitor.SampleOnce();
+    EXPECT_EQ(changes, 0);
+
+    // Link drops to Gen1 for good: reported once it has held long enough.
+    config.SetLinkStatus(0x1041);
+    monitor.SampleOnce();
+    EXPECT_EQ(changes, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    monitor.SampleOnce();
+    EXPECT_EQ(changes, 1);
+    EXPECT_EQ(reported, 0x1041);
+}
+
+TEST(PciLinkMonitorTest, ThreadSamplesAtConfiguredRate) {
+    FakeConfig config;
+    PciLinkMonitorOptions options;
+    options.interval = std::chrono::milliseconds(5);
+    PciLinkMonitor monitor(options);
+    ASSERT_TRUE(monitor.AddDevice(config, Bdf{0x01, 0x00, 0x00}).IsOk());
+    ASSERT_TRUE(monitor.Start().IsOk());
+    EXPECT_TRUE(monitor.IsRunning());
+    EXPECT_TRUE(monitor.Start().IsError());
+
+    auto busy = monitor.AddDevice(config, Bdf{0x02, 0x00, 0x00});
+    ASSERT_TRUE(busy.IsError());
+    EXPECT_EQ(busy.Error(), core::make_error_code(core::ErrorCode::kBusy));
+
+    // A concurrent reader never blocks and sees samples in order.
+    uint64_t cursor = 0;
+    uint64_t last = 0;
+    std::size_t seen = 0;
+    auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    while (std::chrono::steady_clock::now() < deadline) {
+        for (const auto& sample : Drain(monitor, cursor)) {
+            EXPECT_GE(sample.timestamp_ns, last);
+            last = sample.timestamp_ns;
+            ++seen;
+        }
+    }
+    monitor.Stop();
+    EXPECT_FALSE(monitor.IsRunning());
+    EXPECT_GE(seen, 5u);
+    EXPECT_LE(monitor.WritePosition(), 30u);
+}
+
+TEST(PciLinkMonitorTest, SamplesOnTheExecutorOfItsCpus) {
+    PciLinkMonitorOptions options;
+    options.interval = std::chrono::milliseconds(2);
+    options.cpus = {0};
+#ifdef __linux__
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    ASSERT_EQ(sched_getaffinity(0, sizeof(mask), &mask), 0);
+    while (!CPU_ISSET(static_cast<std::size_t>(options.cpus[0]), &mask)) {
+        ++options.cpus[0];
+    }
+#endif
+    FakeConfig config;
+    PciLinkMonitor monitor(options);
+    ASSERT_TRUE(monitor.AddDevice(config, Bdf{0x01, 0x00, 0x00}).IsOk());
+    std::promise<bool> local;
+    std::atomic<bool> reported{false};
+    ASSERT_TRUE(monitor
+                    .SetChangeCallback([&](const PciLinkSample&, const PciLinkSample&) {
+                        if (!reported.exchange(true)) {
+                            local.set_value(
+                                core::Executor::ForCpus(options.cpus).RunningInThisThread());
+                        }
+                    })
+                    .IsOk());
+    ASSERT_TRUE(monitor.Start().IsOk());
+    while (monitor.WritePosition() == 0) {  // baseline sampled
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    config.SetLinkStatus(0x1041);
+    auto future = local.get_future();
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_TRUE(future.get());
+    monitor.Stop();
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
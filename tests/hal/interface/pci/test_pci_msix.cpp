@@ -0,0 +1,256 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/pci/pci_bar.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_msix.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+
+namespace plas::hal::pci {
+namespace {
+
+constexpr ConfigOffset kMsixCap = 0x70;
+constexpr uint16_t kVectors = 2048;
+constexpr uint64_t kTableOffset = 0x2000;  // in BAR 2
+constexpr uint64_t kPbaOffset = 0x100;     // in BAR 4
+
+const Bdf kBdf{0x05, 0x00, 0x00};
+
+/// A function with an MSI-X capability for kVectors vectors: table in
+/// BAR 2, PBA in BAR 4. Counts BAR calls.
+class FakeFunction : public Device, public PciConfig, public PciBar {
+public:
+    FakeFunction() {
+        config_[0x06] = 0x10;  // capabilities list
+        config_[0x34] = kMsixCap;
+        config_[kMsixCap] = static_cast<core::Byte>(CapabilityId::kMsix);
+        Set(config_.data(), kMsixCap + 0x02, 2, kVectors - 1);
+        Set(config_.data(), kMsixCap + 0x04, 4, kTableOffset | 2);
+        Set(config_.data(), kMsixCap + 0x08, 4, kPbaOffset | 4);
+        bars_[2].resize(kTableOffset + kVectors * 16);
+        bars_[4].resize(kPbaOffset + kVectors / 8);
+        // Reset state: every vector masked, with a TPH steering tag that
+        // mask changes must keep.
+        for (uint64_t v = 0; v < kVectors; ++v) {
+            Set(bars_[2].data(), kTableOffset + v * 16 + 12, 4, 0x00AB0001);
+        }
+    }
+
+    core::Result<void> Init() override { return core::Result<void>::Ok(); }
+    core::Result<void> Open() override { return core::Result<void>::Ok(); }
+    core::Result<void> Close() override { return core::Result<void>::Ok(); }
+    core::Result<void> Reset() override { return core::Result<void>::Ok(); }
+    DeviceState GetState() const override { return DeviceState::kOpen; }
+    std::string GetName() const override { return "fake"; }
+    std::string GetUri() const override { return "fake://0"; }
+    std::string GetDriverName() const override { return "fake"; }
+    plas::hal::Device* GetDevice() override { return this; }
+
+    core::Result<core::Byte> ReadConfig8(Bdf, ConfigOffset offset) override {
+        return core::Result<core::Byte>::Ok(config_[offset]);
+    }
+    core::Result<core::Word> ReadConfig16(Bdf, ConfigOffset offset) override {
+        return core::Result<core::Word>::Ok(
+            static_cast<core::Word>(Get(config_.data(), offset, 2)));
+    }
+    core::Result<core::DWord> ReadConfig32(Bdf, ConfigOffset offset) override {
+        return core::Result<core::DWord>::Ok(Get(config_.data(), offset, 4));
+    }
+    core::Result<void> WriteConfig8(Bdf, ConfigOffset, core::Byte) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> WriteConfig16(Bdf, ConfigOffset offset, core::Word value) override {
+        ++config_writes;
+        Set(config_.data(), offset, 2, value);
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> WriteConfig32(Bdf, ConfigOffset, core::DWord) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<std::optional<ConfigOffset>> FindCapability(Bdf, CapabilityId) override {
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+    core::Result<std::optional<ConfigOffset>> FindExtCapability(Bdf,
+                                                                ExtCapabilityId) override {
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+    core::Result<CapabilityIndex> GetCapabilityIndex(Bdf bdf) override {
+        ++index_builds;
+        return PciConfig::GetCapabilityIndex(bdf);
+    }
+
+    core::Result<core::DWord> BarRead32(Bdf, uint8_t index, uint64_t offset) override {
+        ++bar_calls;
+        return core::Result<core::DWord>::Ok(Get(bars_[index].data(), offset, 4));
+    }
+    core::Result<core::QWord> BarRead64(Bdf, uint8_t, uint64_t) override {
+        return core::Result<core::QWord>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> BarWrite32(Bdf, uint8_t index, uint64_t offset,
+                                  core::DWord value) override {
+        ++bar_calls;
+        ++bar_write32s;
+        Set(bars_[index].data(), offset, 4, value);
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> BarWrite64(Bdf, uint8_t, uint64_t, core::QWord) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> BarReadBuffer(Bdf, uint8_t index, uint64_t offset, void* buffer,
+                                     std::size_t length) override {
+        ++bar_calls;
+        if (offset + length > bars_[index].size()) {
+            return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+        }
+        std::memcpy(buffer, bars_[index].data() + offset, length);
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> BarWriteBuffer(Bdf, uint8_t index, uint64_t offset, const void* buffer,
+                                      std::size_t length) override {
+        ++bar_calls;
+        if (offset + length > bars_[index].size()) {
+            return core::Result<void>::Err(core::ErrorCode::kOutOfRange);
+        }
+        std::memcpy(bars_[index].data() + offset, buffer, length);
+        return core::Result<void>::Ok();
+    }
+
+    uint32_t VectorControl(uint64_t vector) const {
+        return Get(bars_[2].data(), kTableOffset + vector * 16 + 12, 4);
+    }
+    uint16_t MessageControl() const {
+        return static_cast<uint16_t>(Get(config_.data(), kMsixCap + 0x02, 2));
+    }
+    void SetPending(uint64_t vector) {
+        bars_[4][kPbaOffset + vector / 8] |= static_cast<uint8_t>(1u << (vector % 8));
+    }
+
+    int bar_calls = 0;
+    int bar_write32s = 0;
+    int config_writes = 0;
+    int index_builds = 0;
+
+private:
+    static void Set(uint8_t* base, uint64_t offset, uint64_t bytes, uint64_t value) {
+        for (uint64_t i = 0; i < bytes; ++i) {
+            base[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+    static uint32_t Get(const uint8_t* base, uint64_t offset, uint64_t bytes) {
+        uint32_t value = 0;
+        for (uint64_t i = bytes; i-- > 0;) {
+            value = (value << 8) | base[offset + i];
+        }
+        return value;
+    }
+
+    std::array<core::Byte, kConfigSpaceSize> config_{};
+    std::array<std::vector<uint8_t>, 6> bars_;
+};
+
+TEST(PciMsixTest, LocatesTableAndPbaOnce) {
+    FakeFunction function;
+    PciMsix msix(function, function, kBdf);
+    auto loc = msix.GetLocation();
+    ASSERT_TRUE(loc.IsOk());
+    EXPECT_EQ(loc.Value().cap, kMsixCap);
+    EXPECT_EQ(loc.Value().table_size, kVectors);
+    EXPECT_EQ(loc.Value().table_bar, 2);
+    EXPECT_EQ(loc.Value().table_offset, kTableOffset);
+    EXPECT_EQ(loc.Value().pba_bar, 4);
+    EXPECT_EQ(loc.Value().pba_offset, kPbaOffset);
+
+    PciMsixEntry entry{};
+    ASSERT_TRUE(msix.ReadEntries(7, &entry, 1).IsOk());
+    ASSERT_TRUE(msix.ReadPendingBits().IsOk());
+    EXPECT_EQ(function.index_builds, 1);
+
+    PciTopology::NotifyTopologyChanged();
+    ASSERT_TRUE(msix.GetLocation().IsOk());
+    EXPECT_EQ(function.index_builds, 2);
+}
+
+TEST(PciMsixTest, WholeTableMovesInOneCopyEachWay) {
+    FakeFunction function;
+    PciMsix msix(function, function, kBdf);
+    std::vector<PciMsixEntry> table(kVectors);
+    for (uint32_t v = 0; v < kVectors; ++v) {
+        table[v] = PciMsixEntry{0xFEE00000u | (v << 12), 0, 0x4000 + v, PciMsixEntry::kMask};
+    }
+    function.bar_calls = 0;
+    ASSERT_TRUE(msix.WriteEntries(0, table.data(), table.size()).IsOk());
+    EXPECT_EQ(function.bar_calls, 1);
+
+    std::vector<PciMsixEntry> readback(100);
+    ASSERT_TRUE(msix.ReadEntries(1000, readback.data(), readback.size()).IsOk());
+    EXPECT_EQ(function.bar_calls, 2);
+    EXPECT_EQ(readback[0].Address(), 0xFEE00000u | (1000u << 12));
+    EXPECT_EQ(readback[99].data, 0x4000u + 1099);
+    EXPECT_TRUE(readback[50].Masked());
+
+    EXPECT_EQ(msix.ReadEntries(kVectors - 1, readback.data(), 2).Error(),
+              core::ErrorCode::kOutOfRange);
+    EXPECT_EQ(msix.ReadEntries(0, nullptr, 1).Error(), core::ErrorCode::kInvalidArgument);
+}
+
+TEST(PciMsixTest, SetMaskedWritesOnlyChangedVectorControls) {
+    FakeFunction function;
+    PciMsix msix(function, function, kBdf);
+    auto unmasked = msix.SetMasked(0, 1024, false);
+    ASSERT_TRUE(unmasked.IsOk());
+    EXPECT_EQ(unmasked.Value(), 1024u);
+    EXPECT_EQ(function.VectorControl(0), 0x00AB0000u);  // steering tag kept
+    EXPECT_EQ(function.VectorControl(1023), 0x00AB0000u);
+    EXPECT_EQ(function.VectorControl(1024), 0x00AB0001u);
+
+    // Half of the range is already masked: only the other half is written.
+    function.bar_write32s = 0;
+    auto masked = msix.SetMasked(512, 1024, true);
+    ASSERT_TRUE(masked.IsOk());
+    EXPECT_EQ(masked.Value(), 512u);
+    EXPECT_EQ(function.bar_write32s, 512);
+    EXPECT_EQ(function.VectorControl(511), 0x00AB0000u);
+    EXPECT_EQ(function.VectorControl(512), 0x00AB0001u);
+
+    EXPECT_EQ(msix.SetMasked(2000, 100, true).Error(), core::ErrorCode::kOutOfRange);
+}
+
+TEST(PciMsixTest, MessageControlAndPendingBits) {
+    FakeFunction function;
+    PciMsix msix(function, function, kBdf);
+    EXPECT_FALSE(msix.IsEnabled().Value());
+    ASSERT_TRUE(msix.SetFunctionMasked(true).IsOk());
+    ASSERT_TRUE(msix.SetEnabled(true).IsOk());
+    EXPECT_TRUE(msix.IsEnabled().Value());
+    EXPECT_TRUE(msix.IsFunctionMasked().Value());
+    EXPECT_EQ(function.MessageControl(), 0xC000 | (kVectors - 1));
+    ASSERT_TRUE(msix.SetEnabled(true).IsOk());  // no change, no write
+    EXPECT_EQ(function.config_writes, 2);
+
+    function.SetPending(3);
+    function.SetPending(2047);
+    auto pending = msix.ReadPendingBits();
+    ASSERT_TRUE(pending.IsOk());
+    ASSERT_EQ(pending.Value().size(), kVectors / 64);
+    EXPECT_EQ(pending.Value()[0], 1u << 3);
+    EXPECT_EQ(pending.Value()[31], 1ull << 63);
+}
+
+TEST(PciMsixTest, NoCapabilityIsNotSupported) {
+    FakeFunction function;
+    ASSERT_TRUE(function.WriteConfig16(kBdf, 0x06, 0).IsOk());  // no capabilities list
+    PciMsix msix(function, function, kBdf);
+    EXPECT_EQ(msix.GetLocation().Error(), core::ErrorCode::kNotSupported);
+    PciMsixEntry entry{};
+    EXPECT_EQ(msix.ReadEntries(0, &entry, 1).Error(), core::ErrorCode::kNotSupported);
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
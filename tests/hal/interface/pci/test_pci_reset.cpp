@@ -0,0 +1,285 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_reset.h"
+
+namespace plas::hal::pci {
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr ConfigOffset kPcieCap = 0x40;
+constexpr ConfigOffset kRtrCap = 0x100;
+constexpr ConfigOffset kBridgeControl = 0x3E;
+constexpr ConfigOffset kDeviceControl = kPcieCap + 0x08;
+
+const Bdf kBridge{0x00, 0x01, 0x00};
+const Bdf kEndpoint{0x01, 0x00, 0x00};
+
+/// A root port at kBridge with one endpoint below it. After a reset the
+/// endpoint answers `dead_reads` Vendor ID reads with 0xFFFF, then
+/// `rrs_reads` with 0x0001, then normally.
+class FakeBus : public Device, public PciConfig {
+public:
+    FakeBus() {
+        auto& bridge = space_[kBridge.Pack()];
+        bridge[0x0E] = 0x01;  // Type 1 header
+        bridge[0x19] = 0x01;  // secondary bus
+        bridge[0x1A] = 0x01;  // subordinate bus
+        InitFunction(bridge, 0x8086, PciePortType::kRootPort);
+        Set32(bridge, kPcieCap + 0x0C, 1u << 20);  // DLL Link Active reporting
+        Set16(bridge, kPcieCap + 0x12, 1u << 13);  // link up
+
+        auto& endpoint = space_[kEndpoint.Pack()];
+        InitFunction(endpoint, 0x1234, PciePortType::kEndpoint);
+        Set32(endpoint, kPcieCap + 0x04, 1u << 28);  // FLR capable
+    }
+
+    core::Result<void> Init() override { return core::Result<void>::Ok(); }
+    core::Result<void> Open() override { return core::Result<void>::Ok(); }
+    core::Result<void> Close() override { return core::Result<void>::Ok(); }
+    core::Result<void> Reset() override { return core::Result<void>::Ok(); }
+    DeviceState GetState() const override { return DeviceState::kOpen; }
+    std::string GetName() const override { return "fake"; }
+    std::string GetUri() const override { return "fake://0"; }
+    std::string GetDriverName() const override { return "fake"; }
+    plas::hal::Device* GetDevice() override { return this; }
+
+    core::Result<core::Byte> ReadConfig8(Bdf bdf, ConfigOffset offset) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return core::Result<core::Byte>::Ok(space_[bdf.Pack()][offset]);
+    }
+    core::Result<core::Word> ReadConfig16(Bdf bdf, ConfigOffset offset) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (bdf == kEndpoint && offset == 0x00 && in_reset_) {
+            ++vendor_reads;
+            if (dead_left_ > 0) {
+                --dead_left_;
+                return core::Result<core::Word>::Ok(0xFFFF);
+            }
+            if (rrs_left_ > 0) {
+                --rrs_left_;
+                return core::Result<core::Word>::Ok(0x0001);
+            }
+            in_reset_ = false;
+        }
+        return core::Result<core::Word>::Ok(Get16(space_[bdf.Pack()], offset));
+    }
+    core::Result<core::DWord> ReadConfig32(Bdf bdf, ConfigOffset offset) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto& space = space_[bdf.Pack()];
+        return core::Result<core::DWord>::Ok(
+            static_cast<core::DWord>(Get16(space, offset)) |
+            (static_cast<core::DWord>(Get16(space, offset + 2)) << 16));
+    }
+    core::Result<void> WriteConfig8(Bdf, ConfigOffset, core::Byte) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> WriteConfig16(Bdf bdf, ConfigOffset offset, core::Word value) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (bdf == kBridge && offset == kBridgeControl) {
+            bool asserted = (value & (1u << 6)) != 0;
+            if (asserted) {
+                ++bus_resets;
+            } else if (Get16(space_[bdf.Pack()], offset) & (1u << 6)) {
+                StartReset();  // released
+            }
+        }
+        if (bdf == kEndpoint && offset == kDeviceControl && (value & (1u << 15))) {
+            ++flrs;
+            StartReset();
+            value &= 0x7FFF;
+        }
+        Set16(space_[bdf.Pack()], offset, value);
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> WriteConfig32(Bdf, ConfigOffset, core::DWord) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<std::optional<ConfigOffset>> FindCapability(Bdf, CapabilityId) override {
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+    core::Result<std::optional<ConfigOffset>> FindExtCapability(Bdf,
+                                                                ExtCapabilityId) override {
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+    core::Result<void> ReadConfigBlock(Bdf bdf, ConfigOffset offset, core::Byte* buffer,
+                                       std::size_t length) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto& space = space_[bdf.Pack()];
+        std::copy(space.begin() + offset, space.begin() + offset + length, buffer);
+        return core::Result<void>::Ok();
+    }
+
+    void SetImmediateReadiness(Bdf bdf) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& space = space_[bdf.Pack()];
+        Set16(space, 0x06, static_cast<uint16_t>(Get16(space, 0x06) | 1u));
+    }
+    /// Readiness Time Reporting with `reset` and `flr` in the register
+    /// encoding (value bits 8:0, scale bits 11:9).
+    void SetReadinessTimes(uint16_t reset, uint16_t flr) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& space = space_[kEndpoint.Pack()];
+        Set16(space, kRtrCap, static_cast<uint16_t>(ExtCapabilityId::kReadinessTimeReporting));
+        Set16(space, kRtrCap + 2, 0x0001);  // version 1, next = 0
+        Set32(space, kRtrCap + 0x04, (1u << 31) | reset);
+        Set32(space, kRtrCap + 0x08, flr);
+    }
+    void SetDrs() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Set32(space_[kBridge.Pack()], kPcieCap + 0x2C, 1u << 31);
+    }
+    void SetResponse(int dead_reads, int rrs_reads) {
+        dead_reads_ = dead_reads;
+        rrs_reads_ = rrs_reads;
+    }
+
+    int vendor_reads = 0;
+    int bus_resets = 0;
+    int flrs = 0;
+
+private:
+    using Space = std::array<core::Byte, kConfigSpaceSize>;
+
+    static void InitFunction(Space& space, uint16_t vendor, PciePortType type) {
+        Set16(space, 0x00, vendor);
+        space[0x06] = 0x10;  // capabilities list
+        space[0x34] = kPcieCap;
+        space[kPcieCap] = static_cast<core::Byte>(CapabilityId::kPciExpress);
+        Set16(space, kPcieCap + 0x02,
+              static_cast<uint16_t>(static_cast<uint8_t>(type) << 4 | 2));
+    }
+    static void Set16(Space& space, std::size_t offset, uint16_t value) {
+        space[offset] = static_cast<core::Byte>(value);
+        space[offset + 1] = static_cast<core::Byte>(value >> 8);
+    }
+    static void Set32(Space& space, std::size_t offset, uint32_t value) {
+        Set16(space, offset, static_cast<uint16_t>(value));
+        Set16(space, offset + 2, static_cast<uint16_t>(value >> 16));
+    }
+    static uint16_t Get16(const Space& space, std::size_t offset) {
+        return static_cast<uint16_t>(space[offset] | (space[offset + 1] << 8));
+    }
+    void StartReset() {
+        in_reset_ = true;
+        dead_left_ = dead_reads_;
+        rrs_left_ = rrs_reads_;
+    }
+
+    std::mutex mutex_;
+    std::map<uint16_t, Space> space_;
+    bool in_reset_ = false;
+    int dead_reads_ = 2;
+    int rrs_reads_ = 3;
+    int dead_left_ = 0;
+    int rrs_left_ = 0;
+};
+
+PciResetOptions FastOptions() {
+    PciResetOptions options;
+    options.reset_hold = 10us;
+    options.poll_interval = 20us;
+    return options;
+}
+
+TEST(PciResetTest, FlrWithImmediateReadinessPollsRightAway) {
+    FakeBus bus;
+    bus.SetImmediateReadiness(kEndpoint);
+    auto result = FunctionLevelReset(bus, kEndpoint, FastOptions());
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(bus.flrs, 1);
+    EXPECT_EQ(result.Value().source, PciReadinessSource::kImmediate);
+    EXPECT_EQ(result.Value().waited.count(), 0);
+    EXPECT_EQ(result.Value().polls, 6u);  // 2 dead, 3 RRS, 1 ready
+    EXPECT_EQ(result.Value().rrs_polls, 3u);
+    EXPECT_LT(result.Value().elapsed, 50ms);
+}
+
+TEST(PciResetTest, FlrUsesReportedReadinessTime) {
+    FakeBus bus;
+    bus.SetReadinessTimes(0, (2u << 9) | 3);  // FLR: 3 * 32^2 ns ~ 3 us
+    auto result = FunctionLevelReset(bus, kEndpoint, FastOptions());
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value().source, PciReadinessSource::kReadinessTime);
+    EXPECT_EQ(result.Value().waited.count(), 3);
+    EXPECT_LT(result.Value().elapsed, 50ms);
+}
+
+TEST(PciResetTest, FlrWithoutReadinessInfoWaitsMinWait) {
+    FakeBus bus;
+    auto options = FastOptions();
+    options.min_wait = 20ms;
+    auto result = FunctionLevelReset(bus, kEndpoint, options);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value().source, PciReadinessSource::kDefaultWait);
+    EXPECT_EQ(result.Value().waited, 20ms);
+    EXPECT_GE(result.Value().elapsed, 20ms);
+
+    // A bridge has no FLR capability bit in this fake.
+    EXPECT_EQ(FunctionLevelReset(bus, kBridge, options).Error(),
+              core::ErrorCode::kNotSupported);
+}
+
+TEST(PciResetTest, SecondaryBusResetWaitsForEveryFunction) {
+    FakeBus bus;
+    bus.SetDrs();
+    auto result = SecondaryBusReset(bus, kBridge, {kEndpoint}, FastOptions());
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(bus.bus_resets, 1);
+    EXPECT_EQ(result.Value().source, PciReadinessSource::kDrs);
+    EXPECT_EQ(result.Value().rrs_polls, 3u);
+    EXPECT_LT(result.Value().elapsed, 50ms);
+
+    // Only bridges can reset their secondary bus.
+    EXPECT_EQ(SecondaryBusReset(bus, kEndpoint, {}, FastOptions()).Error(),
+              core::ErrorCode::kInvalidArgument);
+}
+
+TEST(PciResetTest, CountsResetsPerFunction) {
+    FakeBus bus;
+    bus.SetImmediateReadiness(kEndpoint);
+    const Bdf sibling{0x01, 0x00, 0x01};
+    const Bdf other_bus{0x02, 0x00, 0x00};
+    auto endpoint = GetResetCount(kEndpoint);
+    auto bridge = GetResetCount(kBridge);
+    auto sibling_before = GetResetCount(sibling);
+    auto other_before = GetResetCount(other_bus);
+
+    ASSERT_TRUE(FunctionLevelReset(bus, kEndpoint, FastOptions()).IsOk());
+    EXPECT_EQ(GetResetCount(kEndpoint), endpoint + 1);
+    EXPECT_EQ(GetResetCount(sibling), sibling_before);
+
+    // SBR reaches every function on the bridge's secondary bus range.
+    ASSERT_TRUE(SecondaryBusReset(bus, kBridge, {kEndpoint}, FastOptions()).IsOk());
+    EXPECT_EQ(GetResetCount(kEndpoint), endpoint + 2);
+    EXPECT_EQ(GetResetCount(sibling), sibling_before + 1);
+    EXPECT_EQ(GetResetCount(kBridge), bridge);
+    EXPECT_EQ(GetResetCount(other_bus), other_before);
+
+    // Nothing was reset: not counted.
+    EXPECT_TRUE(FunctionLevelReset(bus, kBridge, FastOptions()).IsError());
+    EXPECT_EQ(GetResetCount(kBridge), bridge);
+}
+
+TEST(PciResetTest, TimesOutWhileTheFunctionKeepsRetrying) {
+    FakeBus bus;
+    bus.SetImmediateReadiness(kEndpoint);
+    bus.SetResponse(0, 1 << 30);
+    auto options = FastOptions();
+    options.timeout = 10ms;
+    EXPECT_EQ(SecondaryBusReset(bus, kBridge, {kEndpoint}, options).Error(),
+              core::ErrorCode::kTimeout);
+    EXPECT_GT(bus.vendor_reads, 1);
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
@@ -0,0 +1,267 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/ecam.h"
+#include "plas/hal/interface/pci/pci_sriov.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+
+namespace plas::hal::pci {
+namespace {
+
+static void MkdirP(const std::string& path) {
+    std::string cmd = "mkdir -p \"" + path + "\"";
+    int ret = ::system(cmd.c_str());
+    (void)ret;
+}
+
+static void WriteBinaryFile(const std::string& path, const std::vector<uint8_t>& data) {
+    std::ofstream f(path, std::ios::binary);
+    f.write(reinterpret_cast<const char*>(data.data()),
+            static_cast<std::streamsize>(data.size()));
+}
+
+static std::string ReadFileContent(const std::string& path) {
+    std::ifstream f(path);
+    std::string content;
+    std::getline(f, content);
+    return content;
+}
+
+static std::vector<uint8_t> ReadBinaryFile(const std::string& path, std::size_t offset,
+                                           std::size_t length) {
+    std::ifstream f(path, std::ios::binary);
+    f.seekg(static_cast<std::streamoff>(offset));
+    std::vector<uint8_t> data(length);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(length));
+    return data;
+}
+
+static void Set16(std::vector<uint8_t>& config, std::size_t offset, uint16_t value) {
+    config[offset] = static_cast<uint8_t>(value);
+    config[offset + 1] = static_cast<uint8_t>(value >> 8);
+}
+
+// 4 KiB config space of an endpoint; with `sriov`, an SR-IOV capability
+// at 0x100 with 4 of 8 VFs enabled, First VF Offset 0x80 and VF Stride 2:
+// PF 01:00.0 has VFs 01:10.0, 01:10.2, 01:10.4 and 01:10.6.
+static std::vector<uint8_t> BuildConfig(uint16_t vendor, bool sriov) {
+    std::vector<uint8_t> config(kConfigSpaceSize, 0);
+    Set16(config, 0x00, vendor);
+    config[0x06] = 0x10;  // capabilities list
+    config[0x34] = 0x40;
+    config[0x40] = 0x10;  // PCI Express, endpoint
+    config[0x42] = 0x02;
+    if (sriov) {
+        Set16(config, 0x100, static_cast<uint16_t>(ExtCapabilityId::kSriov));
+        Set16(config, 0x102, 0x0001);  // version 1, next = 0
+        Set16(config, 0x108, 0x0001);  // VF Enable
+        Set16(config, 0x10C, 8);       // InitialVFs
+        Set16(config, 0x10E, 8);       // TotalVFs
+        Set16(config, 0x110, 4);       // NumVFs
+        Set16(config, 0x114, 0x80);    // First VF Offset
+        Set16(config, 0x116, 2);       // VF Stride
+        Set16(config, 0x11A, 0x10ED);  // VF Device ID
+    }
+    return config;
+}
+
+const PciAddress kPf{0x0000, {0x01, 0x00, 0x00}};
+
+class PciSriovTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char tmpl[] = "/tmp/plas_test_sriov_XXXXXX";
+        char* dir = ::mkdtemp(tmpl);
+        ASSERT_NE(dir, nullptr);
+        sysfs_root_ = dir;
+        PciTopology::SetSysfsRoot(sysfs_root_);
+
+        pf_path_ = sysfs_root_ + "/devices/pci0000:00/0000:00:01.0/0000:01:00.0";
+        CreateDevice(pf_path_, "0000:01:00.0", BuildConfig(0x8086, true));
+        WriteBinaryFile(pf_path_ + "/sriov_numvfs", {'4', '\n'});
+        for (uint8_t fn = 0; fn < 8; fn += 2) {
+            std::string name = "0000:01:10." + std::to_string(fn);
+            CreateDevice(sysfs_root_ + "/devices/pci0000:00/0000:00:01.0/" + name, name,
+                         BuildConfig(static_cast<uint16_t>(0x1000 + fn), false));
+        }
+    }
+
+    void TearDown() override {
+        std::string cmd = "rm -rf \"" + sysfs_root_ + "\"";
+        int ret = ::system(cmd.c_str());
+        (void)ret;
+        PciTopology::SetSysfsRoot("/sys");
+    }
+
+    void CreateDevice(const std::string& real_path, const std::string& name,
+                      const std::vector<uint8_t>& config) {
+        MkdirP(real_path);
+        WriteBinaryFile(real_path + "/config", config);
+        MkdirP(sysfs_root_ + "/bus/pci/devices");
+        int rc = ::symlink(real_path.c_str(),
+                           (sysfs_root_ + "/bus/pci/devices/" + name).c_str());
+        (void)rc;
+    }
+
+    std::string VfConfigPath(uint8_t fn) const {
+        return sysfs_root_ + "/devices/pci0000:00/0000:00:01.0/0000:01:10." +
+               std::to_string(fn) + "/config";
+    }
+
+    std::string sysfs_root_;
+    std::string pf_path_;
+};
+
+TEST(PciSriovAddressTest, ComputesVfAddressesFromOffsetAndStride) {
+    PciAddress pf{0x0001, {0x3B, 0x00, 0x00}};
+    auto vfs = PciSriov::ComputeVfAddresses(pf, 1, 1, 3);
+    ASSERT_TRUE(vfs.IsOk());
+    ASSERT_EQ(vfs.Value().size(), 3u);
+    EXPECT_EQ(vfs.Value()[0], (PciAddress{0x0001, {0x3B, 0x00, 0x01}}));
+    EXPECT_EQ(vfs.Value()[2], (PciAddress{0x0001, {0x3B, 0x00, 0x03}}));
+
+    // Routing IDs carry into the bus number.
+    PciAddress last_fn{0x0000, {0x01, 0x1F, 0x07}};
+    auto crossing = PciSriov::ComputeVfAddresses(last_fn, 1, 8, 2);
+    ASSERT_TRUE(crossing.IsOk());
+    EXPECT_EQ(crossing.Value()[0], (PciAddress{0x0000, {0x02, 0x00, 0x00}}));
+    EXPECT_EQ(crossing.Value()[1], (PciAddress{0x0000, {0x02, 0x01, 0x00}}));
+
+    EXPECT_TRUE(PciSriov::ComputeVfAddresses(pf, 0, 1, 0).Value().empty());
+    EXPECT_EQ(PciSriov::ComputeVfAddresses(pf, 0, 1, 2).Error(),
+              core::ErrorCode::kInvalidArgument);
+    EXPECT_EQ(PciSriov::ComputeVfAddresses(pf, 1, 0, 2).Error(),
+              core::ErrorCode::kInvalidArgument);
+    EXPECT_EQ(PciSriov::ComputeVfAddresses({0, {0xFF, 0x00, 0x00}}, 0x100, 1, 1).Error(),
+              core::ErrorCode::kOutOfRange);
+}
+
+TEST_F(PciSriovTest, OpenReadsCapabilityAndEnabledVfs) {
+    auto sriov = PciSriov::Open(kPf);
+    ASSERT_TRUE(sriov.IsOk());
+    auto info = sriov.Value().GetInfo();
+    ASSERT_TRUE(info.IsOk());
+    EXPECT_EQ(info.Value().offset, 0x100);
+    EXPECT_EQ(info.Value().total_vfs, 8);
+    EXPECT_EQ(info.Value().num_vfs, 4);
+    EXPECT_TRUE(info.Value().enabled);
+    EXPECT_EQ(info.Value().vf_device_id, 0x10ED);
+
+    ASSERT_EQ(sriov.Value().NumVfs(), 4u);
+    EXPECT_EQ(sriov.Value().VfAddresses()[0], (PciAddress{0x0000, {0x01, 0x10, 0x00}}));
+    EXPECT_EQ(sriov.Value().VfAddresses()[3], (PciAddress{0x0000, {0x01, 0x10, 0x06}}));
+
+    // A VF has no SR-IOV capability of its own.
+    EXPECT_EQ(PciSriov::Open({0x0000, {0x01, 0x10, 0x00}}).Error(),
+              core::ErrorCode::kNotSupported);
+}
+
+TEST_F(PciSriovTest, VfConfigReachesEveryVf) {
+    auto sriov = PciSriov::Open(kPf);
+    ASSERT_TRUE(sriov.IsOk());
+    auto& config = sriov.Value().VfConfig();
+    for (uint8_t fn = 0; fn < 8; fn += 2) {
+        auto vendor = config.ReadConfig16({0x01, 0x10, fn}, 0x00);
+        ASSERT_TRUE(vendor.IsOk());
+        EXPECT_EQ(vendor.Value(), 0x1000 + fn);
+    }
+    ASSERT_TRUE(config.WriteConfig16({0x01, 0x10, 0x04}, 0x04, 0x0006).IsOk());
+    EXPECT_EQ(ReadBinaryFile(VfConfigPath(4), 0x04, 2), (std::vector<uint8_t>{0x06, 0x00}));
+    auto pcie = config.FindCapability({0x01, 0x10, 0x02}, CapabilityId::kPciExpress);
+    ASSERT_TRUE(pcie.IsOk());
+    EXPECT_EQ(pcie.Value(), std::optional<ConfigOffset>(0x40));
+
+    // Between the strided VFs, past the last one, and the PF itself.
+    EXPECT_EQ(config.ReadConfig16({0x01, 0x10, 0x01}, 0x00).Error(), core::ErrorCode::kNotFound);
+    EXPECT_EQ(config.ReadConfig16({0x01, 0x11, 0x00}, 0x00).Error(), core::ErrorCode::kNotFound);
+    EXPECT_EQ(config.ReadConfig16(kPf.bdf, 0x00).Error(), core::ErrorCode::kNotFound);
+}
+
+TEST_F(PciSriovTest, ForEachVfConfiguresAllVfs) {
+    auto sriov = PciSriov::Open(kPf);
+    ASSERT_TRUE(sriov.IsOk());
+    auto results = sriov.Value().ForEachVf([](PciConfig& config, Bdf vf) {
+        return config.WriteConfig32(vf, 0x10, 0xF0000000u | vf.Pack());
+    });
+    ASSERT_EQ(results.size(), 4u);
+    for (uint8_t fn = 0; fn < 8; fn += 2) {
+        EXPECT_TRUE(results[fn / 2].IsOk());
+        uint16_t rid = Bdf{0x01, 0x10, fn}.Pack();
+        EXPECT_EQ(ReadBinaryFile(VfConfigPath(fn), 0x10, 4),
+                  (std::vector<uint8_t>{static_cast<uint8_t>(rid),
+                                        static_cast<uint8_t>(rid >> 8), 0x00, 0xF0}));
+    }
+}
+
+TEST_F(PciSriovTest, EnableWritesSriovNumvfs) {
+    auto sriov = PciSriov::Open(kPf);
+    ASSERT_TRUE(sriov.IsOk());
+    EXPECT_EQ(sriov.Value().Enable(9).Error(), core::ErrorCode::kInvalidArgument);
+    EXPECT_EQ(ReadFileContent(pf_path_ + "/sriov_numvfs"), "4");
+
+    auto before = PciTopology::GetTopologyGeneration();
+    ASSERT_TRUE(sriov.Value().Enable(2).IsOk());
+    EXPECT_EQ(ReadFileContent(pf_path_ + "/sriov_numvfs"), "2");
+    EXPECT_EQ(PciTopology::GetTopologyGeneration(), before + 2);  // "0", then "2"
+    ASSERT_EQ(sriov.Value().NumVfs(), 2u);
+    EXPECT_TRUE(sriov.Value().VfConfig().ReadConfig16({0x01, 0x10, 0x02}, 0x00).IsOk());
+    EXPECT_EQ(sriov.Value().VfConfig().ReadConfig16({0x01, 0x10, 0x04}, 0x00).Error(),
+              core::ErrorCode::kNotFound);
+
+    ASSERT_TRUE(sriov.Value().Disable().IsOk());
+    EXPECT_EQ(ReadFileContent(pf_path_ + "/sriov_numvfs"), "0");
+    EXPECT_EQ(sriov.Value().NumVfs(), 0u);
+    EXPECT_TRUE(sriov.Value().ForEachVf([](PciConfig&, Bdf) {
+        return core::Result<void>::Ok();
+    }).empty());
+}
+
+// Fake ECAM as in test_pci_device.cpp: MCFG maps segment 0, buses 0-1 at
+// physical address 0, and a sparse regular file stands in for /dev/mem.
+TEST_F(PciSriovTest, EcamMapsAllVfsAtOnce) {
+    std::vector<uint8_t> mcfg(60, 0);
+    std::memcpy(mcfg.data(), "MCFG", 4);
+    mcfg[4] = static_cast<uint8_t>(mcfg.size());
+    mcfg[44 + 11] = 0x01;  // end bus
+    MkdirP(sysfs_root_ + "/firmware/acpi/tables");
+    WriteBinaryFile(sysfs_root_ + "/firmware/acpi/tables/MCFG", mcfg);
+    std::string mem_path = sysfs_root_ + "/mem";
+    WriteBinaryFile(mem_path, {});
+    ASSERT_EQ(::truncate(mem_path.c_str(), 2 << 20), 0);
+    Ecam::SetMemoryPath(mem_path);
+
+    int fd = ::open(mem_path.c_str(), O_RDWR);
+    ASSERT_GE(fd, 0);
+    auto pf = BuildConfig(0x8086, true);
+    ASSERT_EQ(::pwrite(fd, pf.data(), pf.size(), 1 << 20), static_cast<ssize_t>(pf.size()));
+    auto vf = BuildConfig(0xECA0, false);
+    ASSERT_EQ(::pwrite(fd, vf.data(), 2, (1 << 20) | (0x10 << 15) | (6 << 12)), 2);
+
+    auto sriov = PciSriov::Open(kPf, ConfigAccess::kEcam);
+    ASSERT_TRUE(sriov.IsOk());
+    auto& config = sriov.Value().VfConfig();
+    EXPECT_EQ(config.ReadConfig16({0x01, 0x10, 0x06}, 0x00).Value(), 0xECA0);
+    ASSERT_TRUE(config.WriteConfig32({0x01, 0x10, 0x02}, 0x10, 0xDEADBEEF).IsOk());
+    uint32_t bar = 0;
+    ASSERT_EQ(::pread(fd, &bar, sizeof(bar), (1 << 20) | (0x10 << 15) | (2 << 12) | 0x10),
+              4);
+    EXPECT_EQ(bar, 0xDEADBEEFu);
+    ::close(fd);
+    // The sysfs config files were not touched.
+    EXPECT_EQ(ReadBinaryFile(VfConfigPath(2), 0x10, 4), (std::vector<uint8_t>(4, 0)));
+
+    Ecam::SetMemoryPath("/dev/mem");
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
@@ -2,16 +2,24 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include "plas/core/error.h"
 #include "plas/hal/interface/pci/pci_topology.h"
+#include "plas/hal/interface/pci/pci_topology_snapshot.h"
 
 namespace plas::hal::pci {
 namespace {
@@ -224,6 +232,61 @@ TEST(PciAddressTest, FromStringOutOfRange) {
     EXPECT_TRUE(PciAddress::FromString("0000:00:00.8").IsError());
 }
 
+TEST(PciAddressTest, FromStringReportsOutOfRange) {
+    EXPECT_EQ(PciAddress::FromString("10000:00:00.0").Error(),
+              core::make_error_code(core::ErrorCode::kOutOfRange));
+    EXPECT_EQ(PciAddress::FromString("0000:00:00.x").Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
+TEST(PciAddressTest, ParseRejectsTrailingText) {
+    // sysfs port service devices sit next to child functions
+    PciAddress addr{0x1, {0x1, 0x1, 0x1}};
+    EXPECT_EQ(PciAddress::Parse("0000:00:01.0:pcie002", addr),
+              core::ErrorCode::kInvalidArgument);
+    EXPECT_EQ(PciAddress::Parse("0000:00:01.0/", addr), core::ErrorCode::kInvalidArgument);
+    EXPECT_EQ(PciAddress::Parse("0000:00:01.", addr), core::ErrorCode::kInvalidArgument);
+    EXPECT_EQ(addr, (PciAddress{0x1, {0x1, 0x1, 0x1}}));  // untouched on failure
+}
+
+constexpr PciAddress ParseAtCompileTime(std::string_view text) {
+    PciAddress addr{};
+    PciAddress::Parse(text, addr);
+    return addr;
+}
+
+TEST(PciAddressTest, ParseAndFormatAreConstexpr) {
+    constexpr PciAddress kAddr = ParseAtCompileTime("00AB:ff:1F.7");
+    static_assert(kAddr == PciAddress{0x00AB, {0xFF, 0x1F, 0x07}});
+
+    char buf[PciAddress::kStringLength];
+    EXPECT_EQ(std::string_view(buf, static_cast<std::size_t>(kAddr.ToChars(buf) - buf)),
+              "00ab:ff:1f.7");
+}
+
+TEST(PciAddressTest, BdfParseAndFormat) {
+    Bdf bdf{};
+    ASSERT_EQ(Bdf::Parse("3b:00.1", bdf), core::ErrorCode::kSuccess);
+    EXPECT_EQ(bdf, (Bdf{0x3B, 0x00, 0x01}));
+    EXPECT_EQ(Bdf::Parse("3b:20.0", bdf), core::ErrorCode::kOutOfRange);
+    EXPECT_EQ(Bdf::Parse("3b:00", bdf), core::ErrorCode::kInvalidArgument);
+
+    char buf[Bdf::kStringLength];
+    EXPECT_EQ(std::string(buf, Bdf{0x3B, 0x1F, 0x7}.ToChars(buf)), "3b:1f.7");
+}
+
+TEST(PciAddressTest, HashesKeyUnorderedContainers) {
+    std::unordered_map<PciAddress, int> by_address;
+    by_address[{0x0000, {0x3B, 0x00, 0x0}}] = 1;
+    by_address[{0x0001, {0x3B, 0x00, 0x0}}] = 2;
+    EXPECT_EQ(by_address.size(), 2u);
+    EXPECT_EQ((by_address[{0x0001, {0x3B, 0x00, 0x0}}]), 2);
+
+    std::unordered_set<Bdf> bdfs{{0x3B, 0x00, 0x0}, {0x3B, 0x00, 0x1}, {0x3B, 0x00, 0x0}};
+    EXPECT_EQ(bdfs.size(), 2u);
+    EXPECT_NE(std::hash<Bdf>{}({0x3B, 0x00, 0x0}), std::hash<Bdf>{}({0x3B, 0x00, 0x1}));
+}
+
 TEST(PciAddressTest, Equality) {
     PciAddress a{0x0000, {0x03, 0x00, 0x00}};
     PciAddress b{0x0000, {0x03, 0x00, 0x00}};
@@ -299,6 +362,34 @@ TEST_F(PciTopologyTest, GetDeviceInfoBridge) {
     EXPECT_TRUE(result.Value().is_bridge);
 }
 
+TEST_F(PciTopologyTest, GetDeviceInfoNumaLocality) {
+    CreateFakeDevice({"0000:00:01.0", "0000:03:00.0"});
+    CreateFakeDevice({"0000:00:01.0", "0000:03:00.1"});
+    std::string dir = sysfs_root_ + "/bus/pci/devices/0000:03:00.0";
+    WriteFile(dir + "/numa_node", "1\n");
+    WriteFile(dir + "/local_cpulist", "16-19,48\n");
+
+    auto info = PciTopology::GetDeviceInfo(PciAddress{0x0000, {0x03, 0x00, 0x00}});
+    ASSERT_TRUE(info.IsOk());
+    EXPECT_EQ(info.Value().numa_node, 1);
+    EXPECT_EQ(info.Value().local_cpus, (std::vector<int>{16, 17, 18, 19, 48}));
+
+    // No NUMA attributes (or numa_node -1): unknown.
+    auto other = PciTopology::GetDeviceInfo(PciAddress{0x0000, {0x03, 0x00, 0x01}});
+    ASSERT_TRUE(other.IsOk());
+    EXPECT_EQ(other.Value().numa_node, -1);
+    EXPECT_TRUE(other.Value().local_cpus.empty());
+
+    auto path = PciTopology::GetPathToRoot(PciAddress{0x0000, {0x03, 0x00, 0x00}});
+    ASSERT_TRUE(path.IsOk());
+    EXPECT_EQ(path.Value().front().numa_node, 1);
+    auto snapshot = PciTopologySnapshot::Build();
+    ASSERT_TRUE(snapshot.IsOk());
+    auto snap = snapshot.Value().GetDeviceInfo(PciAddress{0x0000, {0x03, 0x00, 0x00}});
+    ASSERT_TRUE(snap.IsOk());
+    EXPECT_EQ(snap.Value().local_cpus, info.Value().local_cpus);
+}
+
 TEST_F(PciTopologyTest, GetDeviceInfoNotFound) {
     PciAddress addr{0x0000, {0x99, 0x00, 0x00}};
     auto result = PciTopology::GetDeviceInfo(addr);
@@ -446,6 +537,23 @@ TEST_F(PciTopologyTest, RemoveDeviceNotFound) {
     EXPECT_TRUE(result.IsError());
 }
 
+TEST_F(PciTopologyTest, TopologyGenerationBumpsOnRescan) {
+    std::string rescan_dir = sysfs_root_ + "/bus/pci";
+    MkdirP(rescan_dir);
+    WriteFile(rescan_dir + "/rescan", "");
+
+    auto before = PciTopology::GetTopologyGeneration();
+    ASSERT_TRUE(PciTopology::RescanAll().IsOk());
+    EXPECT_EQ(PciTopology::GetTopologyGeneration(), before + 1);
+}
+
+TEST_F(PciTopologyTest, TopologyGenerationUnchangedOnFailure) {
+    auto before = PciTopology::GetTopologyGeneration();
+    PciAddress addr{0x0000, {0x99, 0x00, 0x00}};
+    EXPECT_TRUE(PciTopology::RemoveDevice(addr).IsError());
+    EXPECT_EQ(PciTopology::GetTopologyGeneration(), before);
+}
+
 TEST_F(PciTopologyTest, GetDeviceInfoNoPcieCap) {
     // Device without PCI Express capability
     CreateFakeDevice({"0000:00:01.0", "0000:03:00.0"}, 0x00,
@@ -569,5 +677,393 @@ TEST_F(PciTopologyTest, FindRootPortDirectChild) {
     EXPECT_EQ(result.Value(), expected_root);
 }
 
+// ===== PciTopologySnapshot Tests =====
+
+class PciTopologySnapshotTest : public PciTopologyTest {
+protected:
+    // Switch fabric: root port → upstream → two downstream ports, one
+    // endpoint each, plus a second root port with a multi-function device.
+    void CreateFabric() {
+        CreateTopology({"0000:3a:00.0", "0000:3b:00.0", "0000:3c:08.0",
+                        "0000:41:00.0"},
+                       {{0x01, PciePortType::kRootPort},
+                        {0x01, PciePortType::kUpstreamPort},
+                        {0x01, PciePortType::kDownstreamPort},
+                        {0x00, PciePortType::kEndpoint}});
+        CreateTopology({"0000:3a:00.0", "0000:3b:00.0", "0000:3c:10.0",
+                        "0000:42:00.0"},
+                       {{0x01, PciePortType::kRootPort},
+                        {0x01, PciePortType::kUpstreamPort},
+                        {0x01, PciePortType::kDownstreamPort},
+                        {0x00, PciePortType::kEndpoint}});
+        CreateTopology({"0000:00:01.0", "0000:01:00.0"},
+                       {{0x01, PciePortType::kRootPort},
+                        {0x00, PciePortType::kEndpoint}});
+        CreateFakeDevice({"0000:00:01.0", "0000:01:00.1"});
+    }
+};
+
+TEST_F(PciTopologySnapshotTest, MatchesLiveQueries) {
+    CreateFabric();
+    auto snapshot = PciTopologySnapshot::Build();
+    ASSERT_TRUE(snapshot.IsOk());
+    const auto& snap = snapshot.Value();
+    ASSERT_EQ(snap.Devices().size(), 9u);
+
+    for (const auto& node : snap.Devices()) {
+        const auto& addr = node.address;
+        SCOPED_TRACE(addr.ToString());
+
+        auto info = PciTopology::GetDeviceInfo(addr);
+        ASSERT_TRUE(info.IsOk());
+        EXPECT_EQ(node.port_type, info.Value().port_type);
+        EXPECT_EQ(node.is_bridge, info.Value().is_bridge);
+        EXPECT_EQ(node.sysfs_path, info.Value().sysfs_path);
+
+        EXPECT_EQ(snap.FindParent(addr).Value(),
+                  PciTopology::FindParent(addr).Value());
+
+        auto live_root = PciTopology::FindRootPort(addr);
+        auto snap_root = snap.FindRootPort(addr);
+        ASSERT_EQ(snap_root.IsOk(), live_root.IsOk());
+        if (live_root.IsOk()) {
+            EXPECT_EQ(snap_root.Value(), live_root.Value());
+        }
+
+        auto live_children = PciTopology::FindChildren(addr).Value();
+        auto snap_children = snap.FindChildren(addr).Value();
+        auto by_string = [](const PciAddress& a, const PciAddress& b) {
+            return a.ToString() < b.ToString();
+        };
+        std::sort(live_children.begin(), live_children.end(), by_string);
+        std::sort(snap_children.begin(), snap_children.end(), by_string);
+        EXPECT_EQ(snap_children, live_children);
+
+        auto live_path = PciTopology::GetPathToRoot(addr).Value();
+        auto snap_path = snap.GetPathToRoot(addr).Value();
+        ASSERT_EQ(snap_path.size(), live_path.size());
+        for (std::size_t i = 0; i < live_path.size(); ++i) {
+            EXPECT_EQ(snap_path[i].address, live_path[i].address);
+            EXPECT_EQ(snap_path[i].port_type, live_path[i].port_type);
+        }
+    }
+}
+
+TEST_F(PciTopologySnapshotTest, QueriesDoNotTouchSysfs) {
+    CreateFabric();
+    auto snapshot = PciTopologySnapshot::Build();
+    ASSERT_TRUE(snapshot.IsOk());
+
+    std::string cmd = "rm -rf \"" + sysfs_root_ + "\"/*";
+    ASSERT_EQ(::system(cmd.c_str()), 0);
+
+    PciAddress endpoint{0x0000, {0x42, 0x00, 0x00}};
+    auto root = snapshot.Value().FindRootPort(endpoint);
+    ASSERT_TRUE(root.IsOk());
+    EXPECT_EQ(root.Value(), (PciAddress{0x0000, {0x3a, 0x00, 0x00}}));
+    auto path = snapshot.Value().GetPathToRoot(endpoint);
+    ASSERT_TRUE(path.IsOk());
+    EXPECT_EQ(path.Value().size(), 4u);
+    EXPECT_EQ(path.Value()[1].port_type, PciePortType::kDownstreamPort);
+}
+
+TEST_F(PciTopologySnapshotTest, RefreshAfterTopologyChange) {
+    CreateFakeDevice({"0000:00:01.0"}, 0x01, PciePortType::kRootPort);
+    auto snapshot = PciTopologySnapshot::Build();
+    ASSERT_TRUE(snapshot.IsOk());
+    auto& snap = snapshot.Value();
+    EXPECT_FALSE(snap.IsStale());
+
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"});
+    PciAddress endpoint{0x0000, {0x01, 0x00, 0x00}};
+    EXPECT_FALSE(snap.Contains(endpoint));
+
+    // e.g. from a udev "add" event
+    PciTopology::NotifyTopologyChanged();
+    EXPECT_TRUE(snap.IsStale());
+    ASSERT_TRUE(snap.Refresh().IsOk());
+    EXPECT_FALSE(snap.IsStale());
+    EXPECT_TRUE(snap.Contains(endpoint));
+    auto children = snap.FindChildren(PciAddress{0x0000, {0x00, 0x01, 0x00}});
+    ASSERT_TRUE(children.IsOk());
+    ASSERT_EQ(children.Value().size(), 1u);
+    EXPECT_EQ(children.Value()[0], endpoint);
+}
+
+TEST_F(PciTopologySnapshotTest, UnknownDeviceIsNotFound) {
+    CreateFakeDevice({"0000:00:01.0"}, 0x01, PciePortType::kRootPort);
+    auto snapshot = PciTopologySnapshot::Build();
+    ASSERT_TRUE(snapshot.IsOk());
+
+    PciAddress missing{0x0000, {0x05, 0x00, 0x00}};
+    auto parent = snapshot.Value().FindParent(missing);
+    ASSERT_TRUE(parent.IsError());
+    EXPECT_EQ(parent.Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+    EXPECT_TRUE(snapshot.Value().FindChildren(missing).IsError());
+    EXPECT_TRUE(snapshot.Value().GetDeviceInfo(missing).IsError());
+}
+
+TEST_F(PciTopologySnapshotTest, ApplyHotplugEvents) {
+    CreateFabric();
+    auto snapshot = PciTopologySnapshot::Build();
+    ASSERT_TRUE(snapshot.IsOk());
+    auto& snap = snapshot.Value();
+    PciAddress downstream{0x0000, {0x3c, 0x08, 0x00}};
+    PciAddress endpoint{0x0000, {0x41, 0x00, 0x00}};
+
+    // Surprise removal of a downstream port takes its endpoint with it.
+    for (const auto& addr : {downstream, endpoint}) {
+        std::string link = PciTopology::GetSysfsPath(addr);
+        ASSERT_EQ(::unlink(link.c_str()), 0);
+    }
+    PciTopology::NotifyTopologyChanged();
+    EXPECT_TRUE(snap.IsStale());
+    ASSERT_TRUE(snap.Apply({PciHotplugAction::kRemove, downstream}).IsOk());
+    EXPECT_FALSE(snap.IsStale());
+    EXPECT_FALSE(snap.Contains(downstream));
+    EXPECT_FALSE(snap.Contains(endpoint));
+    EXPECT_EQ(snap.Devices().size(), 7u);
+    auto siblings = snap.FindChildren(PciAddress{0x0000, {0x3b, 0x00, 0x00}});
+    ASSERT_TRUE(siblings.IsOk());
+    ASSERT_EQ(siblings.Value().size(), 1u);
+    EXPECT_EQ(siblings.Value()[0], (PciAddress{0x0000, {0x3c, 0x10, 0x00}}));
+
+    // Hot-add: only the new devices are read; the result matches a rebuild.
+    CreateTopology({"0000:3a:00.0", "0000:3b:00.0", "0000:3c:08.0",
+                    "0000:41:00.0"},
+                   {{0x01, PciePortType::kRootPort},
+                    {0x01, PciePortType::kUpstreamPort},
+                    {0x01, PciePortType::kDownstreamPort},
+                    {0x00, PciePortType::kEndpoint}});
+    ASSERT_TRUE(snap.Apply({PciHotplugAction::kAdd, downstream}).IsOk());
+    ASSERT_TRUE(snap.Apply({PciHotplugAction::kAdd, endpoint}).IsOk());
+    auto root = snap.FindRootPort(endpoint);
+    ASSERT_TRUE(root.IsOk());
+    EXPECT_EQ(root.Value(), (PciAddress{0x0000, {0x3a, 0x00, 0x00}}));
+    auto rebuilt = PciTopologySnapshot::Build();
+    ASSERT_TRUE(rebuilt.IsOk());
+    ASSERT_EQ(snap.Devices().size(), rebuilt.Value().Devices().size());
+    for (std::size_t i = 0; i < snap.Devices().size(); ++i) {
+        const auto& addr = rebuilt.Value().Devices()[i].address;
+        EXPECT_EQ(snap.Devices()[i].address, addr);
+        EXPECT_EQ(snap.FindParent(addr).Value(),
+                  rebuilt.Value().FindParent(addr).Value());
+        EXPECT_EQ(snap.FindChildren(addr).Value(),
+                  rebuilt.Value().FindChildren(addr).Value());
+    }
+}
+
+TEST_F(PciTopologySnapshotTest, ApplyAddOfVanishedDeviceIsNotFound) {
+    CreateFabric();
+    auto snapshot = PciTopologySnapshot::Build();
+    ASSERT_TRUE(snapshot.IsOk());
+    auto result = snapshot.Value().Apply(
+        {PciHotplugAction::kAdd, PciAddress{0x0000, {0x50, 0x00, 0x00}}});
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+    EXPECT_EQ(snapshot.Value().Devices().size(), 9u);
+}
+
+TEST_F(PciTopologySnapshotTest, MissingDevicesDirIsNotFound) {
+    auto snapshot = PciTopologySnapshot::Build();
+    ASSERT_TRUE(snapshot.IsError());
+    EXPECT_EQ(snapshot.Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+}
+
+// ===== EnumerateAll Tests =====
+
+TEST_F(PciTopologySnapshotTest, EnumerateAllMatchesPerDeviceQueries) {
+    CreateFabric();
+    // Give the endpoint an identity and a trained Gen4 x8 link.
+    std::string config_path =
+        PciTopology::GetSysfsPath(PciAddress{0x0000, {0x41, 0x00, 0x00}}) +
+        "/config";
+    auto config = BuildConfigBlob(0x00, PciePortType::kEndpoint);
+    config[0x00] = 0x86; config[0x01] = 0x80;  // vendor 0x8086
+    config[0x02] = 0x53; config[0x03] = 0x0a;  // device 0x0a53
+    config[0x09] = 0x02; config[0x0A] = 0x08; config[0x0B] = 0x01;
+    config[0x52] = 0x84; config[0x53] = 0x00;  // Link Status: Gen4 x8
+    WriteBinaryFile(config_path, config);
+
+    for (std::size_t workers : {1u, 4u, 64u}) {
+        SCOPED_TRACE(workers);
+        auto inventory = PciTopology::EnumerateAll(workers);
+        ASSERT_TRUE(inventory.IsOk());
+        const auto& inv = inventory.Value();
+        auto snapshot = PciTopologySnapshot::Build();
+        ASSERT_TRUE(snapshot.IsOk());
+        const auto& devices = snapshot.Value().Devices();
+        ASSERT_EQ(inv.Size(), devices.size());
+        ASSERT_EQ(inv.vendor_ids.size(), inv.Size());
+        ASSERT_EQ(inv.link_status.size(), inv.Size());
+
+        for (std::size_t i = 0; i < inv.Size(); ++i) {
+            EXPECT_EQ(inv.addresses[i], devices[i].address);
+            EXPECT_EQ(inv.port_types[i], devices[i].port_type);
+            EXPECT_EQ(inv.header_types[i] == 0x01, devices[i].is_bridge);
+        }
+
+        auto endpoint = std::find(inv.addresses.begin(), inv.addresses.end(),
+                                  PciAddress{0x0000, {0x41, 0x00, 0x00}});
+        ASSERT_NE(endpoint, inv.addresses.end());
+        auto i = static_cast<std::size_t>(endpoint - inv.addresses.begin());
+        EXPECT_EQ(inv.vendor_ids[i], 0x8086);
+        EXPECT_EQ(inv.device_ids[i], 0x0a53);
+        EXPECT_EQ(inv.class_codes[i], 0x010802u);
+        EXPECT_EQ(inv.link_status[i], 0x0084);
+    }
+}
+
+TEST_F(PciTopologyTest, EnumerateAllUnreadableConfig) {
+    CreateFakeDevice({"0000:00:01.0"}, 0x01, PciePortType::kRootPort);
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, 0x00,
+                     PciePortType::kEndpoint, false);
+    std::string config_path =
+        PciTopology::GetSysfsPath(PciAddress{0x0000, {0x01, 0x00, 0x00}}) +
+        "/config";
+    ASSERT_EQ(::unlink(config_path.c_str()), 0);
+
+    auto inventory = PciTopology::EnumerateAll();
+    ASSERT_TRUE(inventory.IsOk());
+    const auto& inv = inventory.Value();
+    ASSERT_EQ(inv.Size(), 2u);
+    EXPECT_EQ(inv.addresses[0], (PciAddress{0x0000, {0x00, 0x01, 0x00}}));
+    EXPECT_EQ(inv.port_types[0], PciePortType::kRootPort);
+    EXPECT_EQ(inv.header_types[0], 0x01);
+    EXPECT_EQ(inv.vendor_ids[1], 0xFFFF);
+    EXPECT_EQ(inv.port_types[1], PciePortType::kUnknown);
+    EXPECT_EQ(inv.link_status[1], 0);
+}
+
+TEST_F(PciTopologyTest, EnumerateAllAndSnapshotSpanSeveralBatches) {
+    // 150 endpoints behind one root port: more than two 64-function
+    // batches, the last one partial.
+    CreateFakeDevice({"0000:00:01.0"}, 0x01, PciePortType::kRootPort);
+    for (int dev = 0; dev < 30; ++dev) {
+        for (int fn = 0; fn < 5; ++fn) {
+            char bdf[16];
+            std::snprintf(bdf, sizeof(bdf), "0000:01:%02x.%d", dev, fn);
+            CreateFakeDevice({"0000:00:01.0", bdf});
+        }
+    }
+
+    auto inventory = PciTopology::EnumerateAll(2);
+    ASSERT_TRUE(inventory.IsOk());
+    const auto& inv = inventory.Value();
+    ASSERT_EQ(inv.Size(), 151u);
+    EXPECT_EQ(inv.port_types[0], PciePortType::kRootPort);
+    for (std::size_t i = 1; i < inv.Size(); ++i) {
+        EXPECT_EQ(inv.port_types[i], PciePortType::kEndpoint) << i;
+    }
+
+    auto snapshot = PciTopologySnapshot::Build();
+    ASSERT_TRUE(snapshot.IsOk());
+    ASSERT_EQ(snapshot.Value().Devices().size(), 151u);
+    EXPECT_TRUE(snapshot.Value().Devices()[0].is_bridge);
+    EXPECT_EQ(snapshot.Value().Devices()[150].port_type,
+              PciePortType::kEndpoint);
+    auto children = snapshot.Value().FindChildren(PciAddress{0x0000, {0x00, 0x01, 0x00}});
+    ASSERT_TRUE(children.IsOk());
+    EXPECT_EQ(children.Value().size(), 150u);
+}
+
+TEST_F(PciTopologyTest, EnumerateAllMissingDevicesDir) {
+    auto inventory = PciTopology::EnumerateAll();
+    ASSERT_TRUE(inventory.IsError());
+    EXPECT_EQ(inventory.Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+}
+
+TEST_F(PciTopologyTest, RemoveAndRescanRemovesTopmostDevicesOnly) {
+    CreateFakeDevice({"0000:00:01.0"}, 0x01, PciePortType::kRootPort);
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"}, 0x01, PciePortType::kUpstreamPort);
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0", "0000:02:00.0"});
+    CreateFakeDevice({"0000:00:02.0"}, 0x01, PciePortType::kRootPort);
+    CreateFakeDevice({"0000:00:02.0", "0000:03:00.0"});
+    CreateFakeDevice({"0000:00:1f.0"}, 0x00, PciePortType::kRcIntegratedEndpoint);
+    MkdirP(sysfs_root_ + "/bus/pci");
+
+    std::string port1 = sysfs_root_ + "/devices/pci0000:00/0000:00:01.0";
+    std::string port2 = sysfs_root_ + "/devices/pci0000:00/0000:00:02.0";
+    std::string rciep = sysfs_root_ + "/devices/pci0000:00/0000:00:1f.0";
+    std::vector<PciAddress> devices = {
+        {0x0000, {0x02, 0x00, 0x00}},  // goes away with its parent below
+        {0x0000, {0x01, 0x00, 0x00}},
+        {0x0000, {0x03, 0x00, 0x00}},
+        {0x0000, {0x00, 0x1f, 0x00}},
+        {0x0000, {0x09, 0x00, 0x00}},  // does not exist
+    };
+    auto before = PciTopology::GetTopologyGeneration();
+    auto results = PciTopology::RemoveAndRescan(devices);
+    ASSERT_EQ(results.size(), devices.size());
+    for (std::size_t i = 0; i < 4; ++i) {
+        ASSERT_TRUE(results[i].IsOk()) << i;
+        EXPECT_EQ(results[i].Value().address, devices[i]);
+    }
+    EXPECT_EQ(results[4].Error(), core::make_error_code(core::ErrorCode::kNotFound));
+
+    EXPECT_EQ(ReadFileContent(port1 + "/0000:01:00.0/remove"), "1");
+    EXPECT_EQ(::access((port1 + "/0000:01:00.0/0000:02:00.0/remove").c_str(), F_OK), -1);
+    EXPECT_EQ(ReadFileContent(port1 + "/rescan"), "1");
+    EXPECT_EQ(ReadFileContent(port2 + "/0000:03:00.0/remove"), "1");
+    EXPECT_EQ(ReadFileContent(port2 + "/rescan"), "1");
+    EXPECT_EQ(ReadFileContent(rciep + "/remove"), "1");
+    EXPECT_EQ(ReadFileContent(sysfs_root_ + "/bus/pci/rescan"), "1");
+    // 3 removes, 3 rescans
+    EXPECT_EQ(PciTopology::GetTopologyGeneration(), before + 6);
+}
+
+TEST_F(PciTopologyTest, RemoveAndRescanWaitsForReappearance) {
+    using namespace std::chrono_literals;
+    CreateFakeDevice({"0000:00:01.0"}, 0x01, PciePortType::kRootPort);
+    CreateFakeDevice({"0000:00:01.0", "0000:01:00.0"});
+    std::string port = sysfs_root_ + "/devices/pci0000:00/0000:00:01.0";
+    std::string device = port + "/0000:01:00.0";
+    std::string link = sysfs_root_ + "/bus/pci/devices/0000:01:00.0";
+    // FIFOs make the writes rendezvous with the fake kernel below, so the
+    // device is gone by the time the rescan write returns.
+    ASSERT_EQ(::mkfifo((device + "/remove").c_str(), 0600), 0);
+    ASSERT_EQ(::mkfifo((port + "/rescan").c_str(), 0600), 0);
+
+    auto kernel = [&](bool comes_back) {
+        return std::thread([=] {
+            char buffer[8];
+            int fd = ::open((device + "/remove").c_str(), O_RDONLY);
+            ::unlink(link.c_str());
+            while (::read(fd, buffer, sizeof(buffer)) > 0) {
+            }
+            ::close(fd);
+            fd = ::open((port + "/rescan").c_str(), O_RDONLY);
+            while (::read(fd, buffer, sizeof(buffer)) > 0) {
+            }
+            ::close(fd);
+            if (comes_back) {
+                std::this_thread::sleep_for(20ms);
+                int rc = ::symlink(device.c_str(), link.c_str());
+                (void)rc;
+            }
+        });
+    };
+    PciRescanOptions options;
+    options.poll_interval = std::chrono::milliseconds(1);
+
+    auto thread = kernel(true);
+    auto results = PciTopology::RemoveAndRescan({{0x0000, {0x01, 0x00, 0x00}}}, options);
+    thread.join();
+    ASSERT_EQ(results.size(), 1u);
+    ASSERT_TRUE(results[0].IsOk());
+    EXPECT_GE(results[0].Value().reappear, 20ms);
+    EXPECT_GE(results[0].Value().reappear, results[0].Value().rescan);
+
+    options.timeout = std::chrono::milliseconds(20);
+    thread = kernel(false);
+    results = PciTopology::RemoveAndRescan({{0x0000, {0x01, 0x00, 0x00}}}, options);
+    thread.join();
+    EXPECT_EQ(results[0].Error(), core::make_error_code(core::ErrorCode::kTimeout));
+}
+
 }  // namespace
 }  // namespace plas::hal::pci
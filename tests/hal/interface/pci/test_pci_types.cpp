@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <vector>
+
 #include "plas/hal/interface/pci/types.h"
 
 namespace plas::hal::pci {
@@ -122,5 +124,69 @@ TEST(BdfTest, ConstexprFromPacked) {
     EXPECT_EQ(bdf.device, 0x1F);
 }
 
+// --- CapabilityIndex::Parse ---
+
+static void PutExtHeader(std::vector<core::Byte>& config, std::size_t offset,
+                         uint16_t id, uint16_t next) {
+    uint32_t header = static_cast<uint32_t>(id) | (1u << 16) |
+                      (static_cast<uint32_t>(next) << 20);
+    for (int i = 0; i < 4; ++i) {
+        config[offset + static_cast<std::size_t>(i)] =
+            static_cast<core::Byte>(header >> (8 * i));
+    }
+}
+
+TEST(CapabilityIndexTest, ParseStandardChain) {
+    std::vector<core::Byte> config(kLegacyConfigSpaceSize, 0);
+    config[0x06] = 0x10;  // Capabilities List
+    config[0x34] = 0x40;
+    config[0x40] = 0x10;  // PCIe
+    config[0x41] = 0x50;
+    config[0x50] = 0x05;  // MSI
+    config[0x51] = 0x00;
+
+    auto index = CapabilityIndex::Parse(config.data(), config.size());
+    EXPECT_EQ(index.Find(CapabilityId::kPciExpress), ConfigOffset{0x40});
+    EXPECT_EQ(index.Find(CapabilityId::kMsi), ConfigOffset{0x50});
+    EXPECT_FALSE(index.Find(CapabilityId::kMsix).has_value());
+    EXPECT_TRUE(index.ext_capabilities.empty());
+}
+
+TEST(CapabilityIndexTest, ParseMultipleDvsecInstances) {
+    std::vector<core::Byte> config(kConfigSpaceSize, 0);
+    PutExtHeader(config, 0x100, 0x0023, 0x150);  // DVSEC
+    PutExtHeader(config, 0x150, 0x002E, 0x200);  // DOE
+    PutExtHeader(config, 0x200, 0x0023, 0x000);  // DVSEC
+
+    auto index = CapabilityIndex::Parse(config.data(), config.size());
+    EXPECT_EQ(index.Find(ExtCapabilityId::kDoe), ConfigOffset{0x150});
+    auto dvsecs = index.FindAll(ExtCapabilityId::kDvsec);
+    ASSERT_EQ(dvsecs.size(), 2u);
+    EXPECT_EQ(dvsecs[0], 0x100);
+    EXPECT_EQ(dvsecs[1], 0x200);
+    EXPECT_TRUE(index.FindAll(ExtCapabilityId::kAer).empty());
+}
+
+TEST(CapabilityIndexTest, ParseStopsAtBackwardPointer) {
+    std::vector<core::Byte> config(kConfigSpaceSize, 0);
+    PutExtHeader(config, 0x100, 0x0001, 0x180);
+    PutExtHeader(config, 0x180, 0x002E, 0x100);  // loops back
+
+    auto index = CapabilityIndex::Parse(config.data(), config.size());
+    EXPECT_EQ(index.ext_capabilities.size(), 2u);
+    EXPECT_EQ(index.FindAll(ExtCapabilityId::kAer).size(), 1u);
+}
+
+TEST(CapabilityIndexTest, ParseTruncatedSnapshot) {
+    // Unprivileged sysfs read: 64 bytes, cap pointer beyond the end
+    std::vector<core::Byte> config(64, 0);
+    config[0x06] = 0x10;
+    config[0x34] = 0x40;
+
+    auto index = CapabilityIndex::Parse(config.data(), config.size());
+    EXPECT_TRUE(index.capabilities.empty());
+    EXPECT_TRUE(index.ext_capabilities.empty());
+}
+
 }  // namespace
 }  // namespace plas::hal::pci
@@ -0,0 +1,282 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+#include "plas/hal/interface/pci/register_io.h"
+#include "plas/hal/interface/pci/regs/aer.h"
+#include "plas/hal/interface/pci/regs/cxl_device.h"
+#include "plas/hal/interface/pci/regs/pcie_cap.h"
+
+namespace plas::hal::pci {
+namespace {
+
+using regs::pcie::DeviceStatus;
+using regs::pcie::LinkControl2;
+using regs::pcie::LinkStatus;
+
+constexpr ConfigOffset kPcieCap = 0x40;
+
+class FakeDeviceBase : public Device {
+public:
+    core::Result<void> Init() override { return core::Result<void>::Ok(); }
+    core::Result<void> Open() override { return core::Result<void>::Ok(); }
+    core::Result<void> Close() override { return core::Result<void>::Ok(); }
+    core::Result<void> Reset() override { return core::Result<void>::Ok(); }
+    DeviceState GetState() const override { return DeviceState::kOpen; }
+    std::string GetName() const override { return "fake"; }
+    std::string GetUri() const override { return "fake://0"; }
+    std::string GetDriverName() const override { return "fake"; }
+};
+
+/// Config space that records every access; RW1C behaves as in hardware.
+class FakeConfig : public FakeDeviceBase, public PciConfig {
+public:
+    plas::hal::Device* GetDevice() override { return this; }
+
+    core::Result<core::Byte> ReadConfig8(Bdf, ConfigOffset offset) override {
+        ++reads;
+        return core::Result<core::Byte>::Ok(space[offset]);
+    }
+    core::Result<core::Word> ReadConfig16(Bdf, ConfigOffset offset) override {
+        ++reads;
+        if (fail_reads) {
+            return core::Result<core::Word>::Err(core::ErrorCode::kIOError);
+        }
+        return core::Result<core::Word>::Ok(Get16(offset));
+    }
+    core::Result<core::DWord> ReadConfig32(Bdf, ConfigOffset offset) override {
+        ++reads;
+        return core::Result<core::DWord>::Ok(
+            static_cast<core::DWord>(Get16(offset) | (Get16(offset + 2) << 16)));
+    }
+    core::Result<void> WriteConfig8(Bdf, ConfigOffset, core::Byte) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> WriteConfig16(Bdf, ConfigOffset offset, core::Word value) override {
+        ++writes;
+        last_write = value;
+        auto w1c = offset == kPcieCap + DeviceStatus::kOffset ? DeviceStatus::kW1cMask
+                   : offset == kPcieCap + LinkStatus::kOffset ? LinkStatus::kW1cMask
+                                                              : uint16_t{0};
+        auto current = Get16(offset);
+        auto next = static_cast<uint16_t>(((current & w1c) & ~(value & w1c)) |
+                                          (value & ~w1c));
+        Set16(offset, next);
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> WriteConfig32(Bdf, ConfigOffset, core::DWord) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<std::optional<ConfigOffset>> FindCapability(Bdf, CapabilityId) override {
+        return core::Result<std::optional<ConfigOffset>>::Ok(kPcieCap);
+    }
+    core::Result<std::optional<ConfigOffset>> FindExtCapability(Bdf,
+                                                                ExtCapabilityId) override {
+        return core::Result<std::optional<ConfigOffset>>::Ok(std::nullopt);
+    }
+
+    uint16_t Get16(std::size_t offset) const {
+        return static_cast<uint16_t>(space[offset] | (space[offset + 1] << 8));
+    }
+    void Set16(std::size_t offset, uint16_t value) {
+        space[offset] = static_cast<core::Byte>(value);
+        space[offset + 1] = static_cast<core::Byte>(value >> 8);
+    }
+
+    std::array<core::Byte, 4096> space{};
+    int reads = 0;
+    int writes = 0;
+    uint16_t last_write = 0;
+    bool fail_reads = false;
+};
+
+class FakeBar : public FakeDeviceBase, public PciBar {
+public:
+    plas::hal::Device* GetDevice() override { return this; }
+
+    core::Result<core::DWord> BarRead32(Bdf, uint8_t bar_index, uint64_t offset) override {
+        last_bar = bar_index;
+        core::DWord value = 0;
+        std::memcpy(&value, &mmio[offset], sizeof(value));
+        ++reads32;
+        return core::Result<core::DWord>::Ok(value);
+    }
+    core::Result<core::QWord> BarRead64(Bdf, uint8_t bar_index, uint64_t offset) override {
+        last_bar = bar_index;
+        core::QWord value = 0;
+        std::memcpy(&value, &mmio[offset], sizeof(value));
+        ++reads64;
+        return core::Result<core::QWord>::Ok(value);
+    }
+    core::Result<void> BarWrite32(Bdf, uint8_t, uint64_t offset, core::DWord value) override {
+        std::memcpy(&mmio[offset], &value, sizeof(value));
+        ++writes32;
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> BarWrite64(Bdf, uint8_t, uint64_t offset, core::QWord value) override {
+        std::memcpy(&mmio[offset], &value, sizeof(value));
+        ++writes64;
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> BarReadBuffer(Bdf, uint8_t, uint64_t, void*, std::size_t) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+    core::Result<void> BarWriteBuffer(Bdf, uint8_t, uint64_t, const void*,
+                                      std::size_t) override {
+        return core::Result<void>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    std::array<core::Byte, 4096> mmio{};
+    uint8_t last_bar = 0xFF;
+    int reads32 = 0, reads64 = 0, writes32 = 0, writes64 = 0;
+};
+
+TEST(RegisterIoTest, ReadDecodesAtTheCapabilityOffset) {
+    FakeConfig config;
+    config.Set16(kPcieCap + 0x12, 0x2084);  // 16 GT/s x8, DLL active
+
+    auto status = ReadRegister<LinkStatus>(config, Bdf{}, kPcieCap);
+    ASSERT_TRUE(status.IsOk());
+    EXPECT_EQ(config.reads, 1);
+    EXPECT_EQ(status.Value().Get<LinkStatus::CurrentLinkSpeed>(), 4);
+    EXPECT_EQ(status.Value().Get<LinkStatus::NegotiatedLinkWidth>(), 8);
+    EXPECT_TRUE(status.Value().Get<LinkStatus::DataLinkLayerLinkActive>());
+    EXPECT_FALSE(status.Value().Get<LinkStatus::LinkTraining>());
+}
+
+TEST(RegisterIoTest, ModifyIsOneReadAndOneWrite) {
+    FakeConfig config;
+    config.Set16(kPcieCap + 0x30, 0x0023);  // Gen3, hw autonomous speed disable
+
+    auto modified = ModifyRegister<LinkControl2>(
+        config, Bdf{}, kPcieCap, [](core::RegisterValue<LinkControl2>& value) {
+            value.Set<LinkControl2::TargetLinkSpeed>(5);
+        });
+    ASSERT_TRUE(modified.IsOk());
+    EXPECT_EQ(config.reads, 1);
+    EXPECT_EQ(config.writes, 1);
+    EXPECT_EQ(config.Get16(kPcieCap + 0x30), 0x0025);
+    EXPECT_EQ(modified.Value().Raw(), 0x0025);
+}
+
+TEST(RegisterIoTest, ModifyLeavesRw1cBitsAlone) {
+    FakeConfig config;
+    // Correctable + unsupported request detected, transactions pending.
+    config.Set16(kPcieCap + 0x0A, 0x0029);
+
+    // Touching nothing must not clear the error bits that were read as 1.
+    ASSERT_TRUE(ModifyRegister<DeviceStatus>(config, Bdf{}, kPcieCap,
+                                             [](auto&) {})
+                    .IsOk());
+    EXPECT_EQ(config.last_write & DeviceStatus::kW1cMask, 0);
+    EXPECT_EQ(config.Get16(kPcieCap + 0x0A), 0x0029);
+
+    // Clearing one clears exactly that one.
+    ASSERT_TRUE(ModifyRegister<DeviceStatus>(
+                    config, Bdf{}, kPcieCap,
+                    [](core::RegisterValue<DeviceStatus>& value) {
+                        value.Set<DeviceStatus::CorrectableErrorDetected>(true);
+                    })
+                    .IsOk());
+    EXPECT_EQ(config.Get16(kPcieCap + 0x0A), 0x0028);
+}
+
+TEST(RegisterIoTest, ModifyDoesNotWriteAfterAFailedRead) {
+    FakeConfig config;
+    config.fail_reads = true;
+    bool called = false;
+    auto modified = ModifyRegister<LinkControl2>(config, Bdf{}, kPcieCap,
+                                                 [&](auto&) { called = true; });
+    ASSERT_TRUE(modified.IsError());
+    EXPECT_EQ(modified.Error(), core::ErrorCode::kIOError);
+    EXPECT_FALSE(called);
+    EXPECT_EQ(config.writes, 0);
+}
+
+TEST(RegisterIoTest, BarRegistersUseTheirWidth) {
+    using regs::cxl_device::Command;
+    using regs::cxl_device::MailboxControl;
+    using regs::cxl_device::MailboxStatus;
+    FakeBar bar;
+    constexpr uint64_t kMailbox = 0x100;
+    uint64_t status = (uint64_t{0x0017} << 32) | 1;  // busy, background op
+    std::memcpy(&bar.mmio[kMailbox + 0x10], &status, sizeof(status));
+
+    auto read = ReadRegister<MailboxStatus>(bar, Bdf{}, 2, kMailbox);
+    ASSERT_TRUE(read.IsOk());
+    EXPECT_EQ(bar.reads64, 1);
+    EXPECT_EQ(bar.last_bar, 2);
+    EXPECT_EQ(read.Value().Get<MailboxStatus::ReturnCode>(),
+              static_cast<CxlMailboxReturnCode>(0x0017));
+    EXPECT_TRUE(read.Value().Get<MailboxStatus::BackgroundOperation>());
+
+    ASSERT_TRUE(WriteRegister(bar, Bdf{}, 2, kMailbox,
+                              core::RegisterValue<Command>()
+                                  .Set<Command::Opcode>(0x4000)
+                                  .Set<Command::PayloadLength>(0x200))
+                    .IsOk());
+    EXPECT_EQ(bar.writes64, 1);
+    uint64_t command = 0;
+    std::memcpy(&command, &bar.mmio[kMailbox + 0x08], sizeof(command));
+    EXPECT_EQ(command, (uint64_t{0x200} << 16) | 0x4000);
+
+    ASSERT_TRUE(ModifyRegister<MailboxControl>(bar, Bdf{}, 2, kMailbox,
+                                               [](auto& value) {
+                                                   value.template Set<
+                                                       MailboxControl::Doorbell>(true);
+                                               })
+                    .IsOk());
+    EXPECT_EQ(bar.reads32, 1);
+    EXPECT_EQ(bar.writes32, 1);
+    EXPECT_EQ(bar.mmio[kMailbox + 0x04], 0x01);
+}
+
+TEST(RegisterIoTest, AerRootStatusMaskIsTheEventBits) {
+    using regs::aer::RootErrorStatus;
+    core::RegisterValue<RootErrorStatus> status(0xF800007Fu);
+    EXPECT_EQ(status.Get<RootErrorStatus::AdvancedErrorInterruptMessageNumber>(), 0x1F);
+    EXPECT_EQ(status.ForWrite(), 0xF8000000u);
+    EXPECT_EQ(RootErrorStatus::kW1cMask, 0x7Fu);
+}
+
+TEST(RegisterIoTest, PciDeviceConfigSpace) {
+    char tmpl[] = "/tmp/plas_test_regio_XXXXXX";
+    char* dir = ::mkdtemp(tmpl);
+    ASSERT_NE(dir, nullptr);
+    std::string root = dir;
+    std::string device_dir = root + "/bus/pci/devices/0000:00:01.0";
+    int ret = ::system(("mkdir -p \"" + device_dir + "\"").c_str());
+    (void)ret;
+    std::vector<char> blob(256, 0);
+    blob[kPcieCap + 0x30] = 0x03;  // Target Link Speed 8 GT/s
+    std::ofstream(device_dir + "/config", std::ios::binary)
+        .write(blob.data(), static_cast<std::streamsize>(blob.size()));
+    PciTopology::SetSysfsRoot(root);
+
+    PciAddress addr{};
+    ASSERT_EQ(PciAddress::Parse("0000:00:01.0", addr), core::ErrorCode::kSuccess);
+    auto device = PciDevice::Open(addr);
+    ASSERT_TRUE(device.IsOk());
+    auto modified = ModifyRegister<LinkControl2>(
+        device.Value(), kPcieCap, [](core::RegisterValue<LinkControl2>& value) {
+            value.Set<LinkControl2::TargetLinkSpeed>(1);
+        });
+    ASSERT_TRUE(modified.IsOk());
+    auto read = ReadRegister<LinkControl2>(device.Value(), kPcieCap);
+    ASSERT_TRUE(read.IsOk());
+    EXPECT_EQ(read.Value().Get<LinkControl2::TargetLinkSpeed>(), 1);
+
+    PciTopology::SetSysfsRoot("/sys");
+    ret = ::system(("rm -rf \"" + root + "\"").c_str());
+}
+
+}  // namespace
+}  // namespace plas::hal::pci
@@ -0,0 +1,530 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/interface/pci/pci_topology.h"
+#include "plas/hal/interface/pci/spdm.h"
+
+namespace plas::hal::pci::spdm {
+namespace {
+
+constexpr Bdf kBdf{0x05, 0x00, 0x00};
+constexpr ConfigOffset kDoeOffset = 0x160;
+constexpr uint8_t kDigestSize = 32;  // SHA-256
+constexpr uint8_t kSignatureSize = 64;  // ECDSA P-256
+
+/// Byte-level SPDM responder behind a PciDoe. It forgets the connection on
+/// GET_VERSION or Reset(), and answers anything but GET_VERSION /
+/// GET_CAPABILITIES / NEGOTIATE_ALGORITHMS with UnexpectedRequest until
+/// negotiated again. Scripted ERRORs are handed out per request code before
+/// the real answer.
+class FakeResponder : public PciDoe {
+public:
+    explicit FakeResponder(std::vector<uint8_t> versions = {0x10, 0x11, 0x12})
+        : versions_(std::move(versions)) {
+        chain_.resize(0x900);
+        for (std::size_t i = 0; i < chain_.size(); ++i) {
+            chain_[i] = static_cast<uint8_t>(i * 7);
+        }
+    }
+
+    plas::hal::Device* GetDevice() override { return nullptr; }
+
+    core::Result<std::vector<DoeProtocolId>> DoeDiscover(
+        Bdf, ConfigOffset) override {
+        return core::Result<std::vector<DoeProtocolId>>::Ok({kCmaProtocol});
+    }
+
+    core::Result<DoePayload> DoeExchange(Bdf, ConfigOffset,
+                                         DoeProtocolId protocol,
+                                         const DoePayload& request) override {
+        if (protocol.vendor_id != kCmaProtocol.vendor_id ||
+            protocol.data_object_type != kCmaProtocol.data_object_type) {
+            return core::Result<DoePayload>::Err(
+                core::ErrorCode::kNotSupported);
+        }
+        int now = ++in_flight;
+        int seen = max_in_flight.load();
+        while (now > seen && !max_in_flight.compare_exchange_weak(seen, now)) {
+        }
+        if (delay.count() > 0) {
+            std::this_thread::sleep_for(delay);
+        }
+
+        std::vector<uint8_t> bytes;
+        for (auto dw : request) {
+            for (int b = 0; b < 4; ++b) {
+                bytes.push_back(static_cast<uint8_t>(dw >> (8 * b)));
+            }
+        }
+        std::vector<uint8_t> response;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            response = Respond(bytes);
+        }
+        --in_flight;
+
+        DoePayload out((response.size() + 3) / 4, 0);
+        for (std::size_t i = 0; i < response.size(); ++i) {
+            out[i / 4] |= static_cast<core::DWord>(response[i]) << (8 * (i % 4));
+        }
+        return core::Result<DoePayload>::Ok(std::move(out));
+    }
+
+    void Reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        version_ = 0;
+        negotiated_ = false;
+    }
+
+    void FailNext(RequestCode code, SpdmError error, int times = 1) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int i = 0; i < times; ++i) {
+            script_[static_cast<uint8_t>(code)].push_back(error);
+        }
+    }
+
+    int Count(RequestCode code) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return counts_[static_cast<uint8_t>(code)];
+    }
+
+    std::vector<uint8_t> LastRequest(RequestCode code) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return last_[static_cast<uint8_t>(code)];
+    }
+
+    std::vector<uint8_t>& Chain() { return chain_; }
+
+    uint32_t flags = cap_flag::kCert | cap_flag::kChal | cap_flag::kMeasSig;
+    uint8_t digest = 0x11;
+    std::chrono::milliseconds delay{0};
+
+    static std::atomic<int> in_flight;
+    static std::atomic<int> max_in_flight;
+
+private:
+    std::vector<uint8_t> Error(uint8_t version, SpdmError error,
+                               uint8_t data = 0) {
+        return {version, static_cast<uint8_t>(ResponseCode::kError),
+                static_cast<uint8_t>(error), data};
+    }
+
+    static void Put16(std::vector<uint8_t>& out, uint16_t v) {
+        out.push_back(static_cast<uint8_t>(v));
+        out.push_back(static_cast<uint8_t>(v >> 8));
+    }
+    static void Put32(std::vector<uint8_t>& out, uint32_t v) {
+        Put16(out, static_cast<uint16_t>(v));
+        Put16(out, static_cast<uint16_t>(v >> 16));
+    }
+
+    std::vector<uint8_t> Respond(const std::vector<uint8_t>& request) {
+        uint8_t ver = request[0];
+        uint8_t code = request[1];
+
+        if (code == static_cast<uint8_t>(RequestCode::kRespondIfReady)) {
+            if (pending_.empty() || request[2] != pending_[1] ||
+                request[3] != kToken) {
+                return Error(ver, SpdmError::kUnexpectedRequest);
+            }
+            auto original = std::move(pending_);
+            pending_.clear();
+            return Answer(original);
+        }
+
+        ++counts_[code];
+        last_[code] = request;
+        auto& script = script_[code];
+        if (!script.empty()) {
+            SpdmError error = script.front();
+            script.erase(script.begin());
+            if (error == SpdmError::kResponseNotReady) {
+                pending_ = request;
+                auto out = Error(ver, error);
+                out.push_back(0);  // RDTExponent: 1 us
+                out.push_back(code);
+                out.push_back(kToken);
+                out.push_back(1);  // RDTM
+                return out;
+            }
+            return Error(ver, error);
+        }
+        return Answer(request);
+    }
+
+    std::vector<uint8_t> Answer(const std::vector<uint8_t>& request) {
+        uint8_t ver = request[0];
+        auto code = static_cast<RequestCode>(request[1]);
+        std::vector<uint8_t> out;
+
+        if (code == RequestCode::kGetVersion) {
+            version_ = 0;
+            negotiated_ = false;
+            out = {0x10, static_cast<uint8_t>(ResponseCode::kVersion), 0, 0, 0,
+                   static_cast<uint8_t>(versions_.size())};
+            for (uint8_t v : versions_) {
+                Put16(out, static_cast<uint16_t>(v << 8));
+            }
+            return out;
+        }
+        if (code == RequestCode::kGetCapabilities) {
+            version_ = ver;
+            out = {ver, static_cast<uint8_t>(ResponseCode::kCapabilities), 0,
+                   0, 0, 12, 0, 0};
+            Put32(out, flags);
+            if (ver >= 0x12) {
+                Put32(out, 0x1000);
+                Put32(out, 0x1000);
+            }
+            return out;
+        }
+        if (version_ == 0 || ver != version_) {
+            return Error(ver, SpdmError::kUnexpectedRequest);
+        }
+        if (code == RequestCode::kNegotiateAlgorithms) {
+            negotiated_ = true;
+            out = {ver, static_cast<uint8_t>(ResponseCode::kAlgorithms), 0, 0};
+            Put16(out, 36);
+            out.push_back(0x01);  // DMTF measurement spec
+            out.push_back(0);
+            Put32(out, 1u << 1);  // measurement hash SHA-256
+            Put32(out, 1u << 4);  // ECDSA P-256
+            Put32(out, hash_algo::kSha256);
+            out.resize(36, 0);
+            return out;
+        }
+        if (!negotiated_) {
+            return Error(ver, SpdmError::kUnexpectedRequest);
+        }
+        if (code == RequestCode::kGetDigests) {
+            out = {ver, static_cast<uint8_t>(ResponseCode::kDigests), 0, 0x01};
+            out.resize(4 + kDigestSize, digest);
+            return out;
+        }
+        if (code == RequestCode::kGetCertificate) {
+            std::size_t offset = request[4] | (request[5] << 8);
+            std::size_t length = request[6] | (request[7] << 8);
+            std::size_t portion =
+                std::min(length, chain_.size() - std::min(offset, chain_.size()));
+            out = {ver, static_cast<uint8_t>(ResponseCode::kCertificate),
+                   request[2], 0};
+            Put16(out, static_cast<uint16_t>(portion));
+            Put16(out, static_cast<uint16_t>(chain_.size() - offset - portion));
+            auto first = chain_.begin() + static_cast<std::ptrdiff_t>(offset);
+            out.insert(out.end(), first, first + static_cast<std::ptrdiff_t>(portion));
+            return out;
+        }
+        if (code == RequestCode::kGetMeasurements) {
+            bool sign = request[2] & 1;
+            if (sign && !(flags & cap_flag::kMeasSig)) {
+                return Error(ver, SpdmError::kInvalidRequest);
+            }
+            out = {ver, static_cast<uint8_t>(ResponseCode::kMeasurements),
+                   static_cast<uint8_t>(request[3] == 0 ? 3 : 0), 0};
+            std::vector<uint8_t> record;
+            if (request[3] != 0) {
+                for (uint8_t i = 1; i <= 3; ++i) {
+                    record.push_back(i);
+                    record.push_back(0x01);
+                    Put16(record, 4);
+                    record.insert(record.end(), 4, static_cast<uint8_t>(i * 0x10));
+                }
+            }
+            out.push_back(static_cast<uint8_t>(request[3] == 0 ? 0 : 3));
+            out.push_back(static_cast<uint8_t>(record.size()));
+            out.push_back(static_cast<uint8_t>(record.size() >> 8));
+            out.push_back(0);
+            out.insert(out.end(), record.begin(), record.end());
+            out.insert(out.end(), 32, 0x5A);  // responder nonce
+            Put16(out, 2);
+            out.push_back(0xCA);
+            out.push_back(0xFE);
+            if (sign) {
+                out.insert(out.end(), kSignatureSize, 0xEE);
+            }
+            return out;
+        }
+        return Error(ver, SpdmError::kUnsupportedRequest);
+    }
+
+    static constexpr uint8_t kToken = 0x77;
+
+    std::mutex mutex_;
+    std::vector<uint8_t> versions_;
+    std::vector<uint8_t> chain_;
+    uint8_t version_ = 0;
+    bool negotiated_ = false;
+    std::vector<uint8_t> pending_;
+    std::map<uint8_t, std::vector<SpdmError>> script_;
+    std::map<uint8_t, int> counts_;
+    std::map<uint8_t, std::vector<uint8_t>> last_;
+};
+
+std::atomic<int> FakeResponder::in_flight{0};
+std::atomic<int> FakeResponder::max_in_flight{0};
+
+Target TargetOf(FakeResponder& responder, Bdf bdf = kBdf) {
+    return Target{&responder, bdf, kDoeOffset};
+}
+
+TEST(SpdmTest, SizesFollowAlgorithm) {
+    EXPECT_EQ(HashSize(hash_algo::kSha256), 32u);
+    EXPECT_EQ(HashSize(hash_algo::kSha384), 48u);
+    EXPECT_EQ(HashSize(hash_algo::kSha256 | hash_algo::kSha384), 0u);
+    EXPECT_EQ(SignatureSize(1u << 4), 64u);    // ECDSA P-256
+    EXPECT_EQ(SignatureSize(1u << 8), 132u);   // ECDSA P-521
+    EXPECT_EQ(SignatureSize(1u << 2), 384u);   // RSASSA-3072
+}
+
+TEST(SpdmTest, FirstAttestRunsFullHandshake) {
+    FakeResponder responder;
+    Engine engine;
+
+    auto result = engine.Attest(TargetOf(responder));
+    ASSERT_TRUE(result.IsOk()) << result.Error().message();
+    const auto& a = result.Value();
+    EXPECT_FALSE(a.reused_connection);
+    EXPECT_FALSE(a.reused_certificate);
+    EXPECT_EQ(a.connection.version, 0x12);
+    EXPECT_EQ(a.connection.capabilities.ct_exponent, 12);
+    EXPECT_EQ(a.connection.capabilities.data_transfer_size, 0x1000u);
+    EXPECT_EQ(a.connection.algorithms.base_hash, hash_algo::kSha256);
+    EXPECT_EQ(a.connection.algorithms.base_asym, 1u << 4);
+
+    ASSERT_TRUE(a.certificate.has_value());
+    EXPECT_EQ(a.certificate->digest, std::vector<uint8_t>(kDigestSize, 0x11));
+    EXPECT_EQ(a.certificate->chain, responder.Chain());
+    EXPECT_EQ(responder.Count(RequestCode::kGetCertificate), 3);  // 0x900 / 0x400
+
+    ASSERT_EQ(a.measurements.blocks.size(), 3u);
+    EXPECT_EQ(a.measurements.blocks[2].index, 3);
+    EXPECT_EQ(a.measurements.blocks[2].data,
+              std::vector<uint8_t>(4, 0x30));
+    EXPECT_EQ(a.measurements.nonce, std::vector<uint8_t>(32, 0x5A));
+    EXPECT_EQ(a.measurements.opaque, (std::vector<uint8_t>{0xCA, 0xFE}));
+    EXPECT_TRUE(a.measurements.signature.empty());
+    EXPECT_TRUE(a.measurements.transcript.empty());
+
+    auto cached = engine.CachedConnection(TargetOf(responder));
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_EQ(cached->version, 0x12);
+}
+
+TEST(SpdmTest, ReattestSkipsHandshakeAndCertificate) {
+    FakeResponder responder;
+    Engine engine;
+    ASSERT_TRUE(engine.Attest(TargetOf(responder)).IsOk());
+
+    auto again = engine.Attest(TargetOf(responder));
+    ASSERT_TRUE(again.IsOk()) << again.Error().message();
+    EXPECT_TRUE(again.Value().reused_connection);
+    EXPECT_TRUE(again.Value().reused_certificate);
+    EXPECT_EQ(again.Value().certificate->chain, responder.Chain());
+    EXPECT_EQ(responder.Count(RequestCode::kGetVersion), 1);
+    EXPECT_EQ(responder.Count(RequestCode::kNegotiateAlgorithms), 1);
+    EXPECT_EQ(responder.Count(RequestCode::kGetCertificate), 3);
+    EXPECT_EQ(responder.Count(RequestCode::kGetDigests), 2);
+    EXPECT_EQ(responder.Count(RequestCode::kGetMeasurements), 2);
+}
+
+TEST(SpdmTest, ChangedDigestRefetchesCertificate) {
+    FakeResponder responder;
+    Engine engine;
+    ASSERT_TRUE(engine.Attest(TargetOf(responder)).IsOk());
+
+    responder.digest = 0x22;
+    responder.Chain().resize(0x100);
+    auto again = engine.Attest(TargetOf(responder));
+    ASSERT_TRUE(again.IsOk());
+    EXPECT_TRUE(again.Value().reused_connection);
+    EXPECT_FALSE(again.Value().reused_certificate);
+    EXPECT_EQ(again.Value().certificate->chain, responder.Chain());
+    EXPECT_EQ(responder.Count(RequestCode::kGetCertificate), 4);
+}
+
+TEST(SpdmTest, ResetResponderFallsBackToHandshake) {
+    FakeResponder responder;
+    Engine engine;
+    ASSERT_TRUE(engine.Attest(TargetOf(responder)).IsOk());
+
+    responder.Reset();
+    auto again = engine.Attest(TargetOf(responder));
+    ASSERT_TRUE(again.IsOk()) << again.Error().message();
+    EXPECT_FALSE(again.Value().reused_connection);
+    EXPECT_TRUE(again.Value().reused_certificate);
+    EXPECT_EQ(responder.Count(RequestCode::kGetVersion), 2);
+}
+
+TEST(SpdmTest, TopologyChangeDropsCache) {
+    FakeResponder responder;
+    Engine engine;
+    ASSERT_TRUE(engine.Attest(TargetOf(responder)).IsOk());
+
+    PciTopology::NotifyTopologyChanged();
+    EXPECT_FALSE(engine.CachedConnection(TargetOf(responder)).has_value());
+    auto again = engine.Attest(TargetOf(responder));
+    ASSERT_TRUE(again.IsOk());
+    EXPECT_FALSE(again.Value().reused_connection);
+    EXPECT_FALSE(again.Value().reused_certificate);
+}
+
+TEST(SpdmTest, ForgetDropsCache) {
+    FakeResponder responder;
+    Engine engine;
+    ASSERT_TRUE(engine.Attest(TargetOf(responder)).IsOk());
+
+    engine.Forget(TargetOf(responder));
+    EXPECT_FALSE(engine.CachedConnection(TargetOf(responder)).has_value());
+    auto again = engine.Attest(TargetOf(responder));
+    ASSERT_TRUE(again.IsOk());
+    EXPECT_FALSE(again.Value().reused_connection);
+}
+
+TEST(SpdmTest, BusyAndNotReadyAreRetried) {
+    FakeResponder responder;
+    responder.FailNext(RequestCode::kGetCapabilities, SpdmError::kBusy, 2);
+    responder.FailNext(RequestCode::kGetMeasurements,
+                       SpdmError::kResponseNotReady);
+    Engine engine;
+
+    auto result = engine.Attest(TargetOf(responder));
+    ASSERT_TRUE(result.IsOk()) << result.Error().message();
+    EXPECT_EQ(responder.Count(RequestCode::kGetCapabilities), 3);
+    EXPECT_EQ(responder.Count(RequestCode::kGetMeasurements), 1);
+    EXPECT_EQ(result.Value().measurements.blocks.size(), 3u);
+}
+
+TEST(SpdmTest, PersistentBusyTimesOut) {
+    FakeResponder responder;
+    responder.FailNext(RequestCode::kGetVersion, SpdmError::kBusy, 1000);
+    EngineOptions options;
+    options.retry_timeout = std::chrono::milliseconds(5);
+    options.backoff = std::chrono::microseconds(500);
+    Engine engine(options);
+
+    auto result = engine.Attest(TargetOf(responder));
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), core::make_error_code(core::ErrorCode::kTimeout));
+}
+
+TEST(SpdmTest, SignedMeasurementsCarryTranscript) {
+    FakeResponder responder;
+    EngineOptions options;
+    options.signed_measurements = true;
+    Engine engine(options);
+
+    auto result = engine.Attest(TargetOf(responder));
+    ASSERT_TRUE(result.IsOk()) << result.Error().message();
+    const auto& m = result.Value().measurements;
+    EXPECT_EQ(m.signature, std::vector<uint8_t>(kSignatureSize, 0xEE));
+
+    auto request = responder.LastRequest(RequestCode::kGetMeasurements);
+    ASSERT_GE(request.size(), 4u + 32u + 1u);  // nonce + slot
+    request.resize(4 + 32 + 1);                // drop the DOE padding
+    EXPECT_EQ(request[2], 0x01);
+    // Request first, then the response up to the signature.
+    ASSERT_GT(m.transcript.size(), request.size());
+    EXPECT_TRUE(std::equal(request.begin(), request.end(),
+                           m.transcript.begin()));
+    EXPECT_EQ(m.transcript[request.size() + 1],
+              static_cast<uint8_t>(ResponseCode::kMeasurements));
+    EXPECT_EQ(m.transcript.back(), 0xFE);  // last opaque byte
+}
+
+TEST(SpdmTest, SignedWithoutMeasSigIsNotSupported) {
+    FakeResponder responder;
+    responder.flags = cap_flag::kCert | cap_flag::kMeasNoSig;
+    EngineOptions options;
+    options.signed_measurements = true;
+    Engine engine(options);
+
+    auto result = engine.Attest(TargetOf(responder));
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    EXPECT_EQ(responder.Count(RequestCode::kGetMeasurements), 0);
+}
+
+TEST(SpdmTest, OlderVersionShortensCapabilities) {
+    FakeResponder responder({0x10, 0x11});
+    Engine engine;
+
+    auto result = engine.Attest(TargetOf(responder));
+    ASSERT_TRUE(result.IsOk()) << result.Error().message();
+    EXPECT_EQ(result.Value().connection.version, 0x11);
+    EXPECT_EQ(result.Value().connection.capabilities.max_message_size, 0u);
+    EXPECT_EQ(responder.LastRequest(RequestCode::kGetCapabilities).size(), 12u);
+}
+
+TEST(SpdmTest, NoCommonVersionIsNotSupported) {
+    FakeResponder responder({0x13});
+    Engine engine;
+
+    auto result = engine.Attest(TargetOf(responder));
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    EXPECT_EQ(responder.Count(RequestCode::kGetCapabilities), 0);
+}
+
+TEST(SpdmTest, UnsupportedRequestMapsToNotSupported) {
+    FakeResponder responder;
+    responder.FailNext(RequestCode::kGetDigests,
+                       SpdmError::kUnsupportedRequest);
+    Engine engine;
+
+    auto result = engine.Attest(TargetOf(responder));
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    EXPECT_FALSE(engine.CachedConnection(TargetOf(responder)).has_value());
+}
+
+TEST(SpdmTest, AttestAllRunsDevicesConcurrently) {
+    constexpr std::size_t kDevices = 24;
+    std::vector<std::unique_ptr<FakeResponder>> responders;
+    std::vector<Target> targets;
+    for (std::size_t i = 0; i < kDevices; ++i) {
+        responders.push_back(std::make_unique<FakeResponder>());
+        responders.back()->delay = std::chrono::milliseconds(1);
+        targets.push_back(TargetOf(*responders.back(),
+                                   Bdf{static_cast<uint8_t>(i + 1), 0, 0}));
+    }
+    responders[7]->FailNext(RequestCode::kGetVersion,
+                            SpdmError::kUnsupportedRequest);
+    FakeResponder::max_in_flight = 0;
+    Engine engine;
+
+    auto results = engine.AttestAll(targets);
+    ASSERT_EQ(results.size(), kDevices);
+    for (std::size_t i = 0; i < kDevices; ++i) {
+        EXPECT_EQ(results[i].IsOk(), i != 7) << "device " << i;
+    }
+    EXPECT_GT(FakeResponder::max_in_flight.load(), 1);
+
+    auto again = engine.AttestAll(targets);
+    EXPECT_TRUE(again[0].Value().reused_connection);
+    EXPECT_TRUE(again[7].IsOk());
+    EXPECT_FALSE(again[7].Value().reused_connection);
+}
+
+TEST(SpdmTest, NullDoeIsInvalid) {
+    Engine engine;
+    auto result = engine.Attest(Target{nullptr, kBdf, kDoeOffset});
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace plas::hal::pci::spdm
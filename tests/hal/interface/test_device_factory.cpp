@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <iterator>
 #include <memory>
 
 #include "plas/hal/interface/device.h"
@@ -8,6 +9,7 @@
 #include "plas/hal/interface/power_control.h"
 #include "plas/hal/interface/ssd_gpio.h"
 #include "plas/config/device_entry.h"
+#include "plas/config/device_table.h"
 #include "plas/core/error.h"
 
 // Include driver headers to trigger registration
@@ -23,6 +25,7 @@ using plas::hal::I2c;
 using plas::hal::PowerControl;
 using plas::hal::SsdGpio;
 using plas::config::DeviceEntry;
+using plas::config::DeviceTable;
 
 namespace {
 
@@ -123,6 +126,71 @@ TEST(DeviceFactoryTest, UnknownDriverFails) {
     EXPECT_TRUE(result.IsError());
 }
 
+TEST(DeviceFactoryTest, CreateFromTableEntry) {
+    DeviceTable table;
+    table.BeginEntry("aardvark0", "aardvark://0:0x50", "aardvark");
+    table.AddArg("bitrate", "100000");
+    table.BeginEntry("unknown", "unknown://0", "nonexistent_driver");
+    table.Finish();
+
+    auto result = DeviceFactory::CreateFromConfig(table[0]);
+    ASSERT_TRUE(result.IsOk()) << result.Error().message();
+    EXPECT_EQ(result.Value()->GetName(), "aardvark0");
+    EXPECT_EQ(result.Value()->GetUri(), "aardvark://0:0x50");
+
+    auto unknown = DeviceFactory::CreateFromConfig(table[1]);
+    ASSERT_TRUE(unknown.IsError());
+    EXPECT_EQ(unknown.Error(),
+              plas::core::make_error_code(plas::core::ErrorCode::kNotFound));
+}
+
+namespace builtin {
+
+constexpr DeviceFactory::BuiltinDriver kTable[] = {
+    {"builtin_pmu3", &DeviceFactory::Make<plas::hal::driver::Pmu3Device>},
+    {"builtin_aardvark", &DeviceFactory::Make<plas::hal::driver::AardvarkDevice>},
+    // Shadowed by the registered "aardvark" driver
+    {"aardvark", &DeviceFactory::Make<plas::hal::driver::Pmu3Device>},
+};
+
+}  // namespace builtin
+
+TEST(DeviceFactoryTest, BuiltinTableServesLookups) {
+    EXPECT_FALSE(DeviceFactory::HasDriver("builtin_pmu3"));
+    DeviceFactory::SetBuiltinDrivers(builtin::kTable, std::size(builtin::kTable));
+    EXPECT_TRUE(DeviceFactory::HasDriver("builtin_pmu3"));
+
+    DeviceEntry entry;
+    entry.nickname = "pmu3_builtin";
+    entry.uri = "pmu3://usb:PMU3-001";
+    entry.driver = "builtin_pmu3";
+    auto pmu = DeviceFactory::CreateFromConfig(entry);
+    ASSERT_TRUE(pmu.IsOk()) << pmu.Error().message();
+    EXPECT_NE(dynamic_cast<PowerControl*>(pmu.Value().get()), nullptr);
+
+    entry.uri = "aardvark://0:0x50";
+    entry.driver = "builtin_aardvark";
+    auto aardvark = DeviceFactory::CreateFromConfig(entry);
+    ASSERT_TRUE(aardvark.IsOk());
+    EXPECT_EQ(aardvark.Value()->GetDriverName(), "aardvark");
+
+    DeviceFactory::SetBuiltinDrivers(nullptr, 0);
+    EXPECT_FALSE(DeviceFactory::HasDriver("builtin_pmu3"));
+}
+
+TEST(DeviceFactoryTest, RegisteredDriverOverridesBuiltin) {
+    DeviceFactory::SetBuiltinDrivers(builtin::kTable, std::size(builtin::kTable));
+    DeviceEntry entry;
+    entry.nickname = "aardvark0";
+    entry.uri = "aardvark://0:0x50";
+    entry.driver = "aardvark";
+    auto result = DeviceFactory::CreateFromConfig(entry);
+    DeviceFactory::SetBuiltinDrivers(nullptr, 0);
+
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_NE(dynamic_cast<I2c*>(result.Value().get()), nullptr);
+}
+
 TEST(DeviceFactoryTest, DeviceLifecycle) {
     DeviceEntry entry;
     entry.nickname = "lifecycle_test";
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <type_traits>
+
+#include "mock_device.h"
+#include "plas/hal/interface/device_interfaces.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/power_control.h"
+#include "plas/hal/interface/ssd_gpio.h"
+
+namespace plas::hal {
+namespace {
+
+using test::MockDevice;
+
+/// PowerControl + SsdGpio, all calls succeed with defaults.
+class PowerGpioBase : public MockDevice, public PowerControl, public SsdGpio {
+public:
+    PowerGpioBase() : MockDevice("pmu", "mock://0") {}
+
+    Device* GetDevice() override { return this; }
+
+    core::Result<void> SetVoltage(core::Voltage) override { return core::Result<void>::Ok(); }
+    core::Result<core::Voltage> GetVoltage() override {
+        return core::Result<core::Voltage>::Ok(core::Voltage(0.0));
+    }
+    core::Result<void> SetCurrent(core::Current) override { return core::Result<void>::Ok(); }
+    core::Result<core::Current> GetCurrent() override {
+        return core::Result<core::Current>::Ok(core::Current(0.0));
+    }
+    core::Result<void> PowerOn() override { return core::Result<void>::Ok(); }
+    core::Result<void> PowerOff() override { return core::Result<void>::Ok(); }
+    core::Result<bool> IsPowerOn() override { return core::Result<bool>::Ok(true); }
+
+    core::Result<void> SetPerst(bool) override { return core::Result<void>::Ok(); }
+    core::Result<bool> GetPerst() override { return core::Result<bool>::Ok(false); }
+    core::Result<void> SetClkReq(bool) override { return core::Result<void>::Ok(); }
+    core::Result<bool> GetClkReq() override { return core::Result<bool>::Ok(false); }
+    core::Result<void> SetDualPort(bool) override { return core::Result<void>::Ok(); }
+    core::Result<bool> GetDualPort() override { return core::Result<bool>::Ok(false); }
+};
+
+/// The same device with a compile-time interface list.
+class ListedDevice : public PowerGpioBase {
+public:
+    using Interfaces = InterfaceList<PowerControl, SsdGpio>;
+    void* QueryInterface(InterfaceKind kind) override {
+        ++queries;
+        return QueryInterfaceOf(this, kind, Interfaces{});
+    }
+
+    int queries = 0;
+};
+
+static_assert(std::is_same_v<ImplementedInterfaces<ListedDevice>,
+                             InterfaceList<PowerControl, SsdGpio>>);
+static_assert(std::is_same_v<ImplementedInterfaces<MockDevice>, InterfaceList<>>);
+
+TEST(DeviceInterfacesTest, ListedInterfacesReturnTheirSubobjects) {
+    ListedDevice device;
+    EXPECT_EQ(device.QueryInterface(InterfaceKind::kPowerControl),
+              static_cast<void*>(static_cast<PowerControl*>(&device)));
+    EXPECT_EQ(device.QueryInterface(InterfaceKind::kSsdGpio),
+              static_cast<void*>(static_cast<SsdGpio*>(&device)));
+    // Distinct bases sit at distinct addresses; the pointer must be usable.
+    auto* gpio = static_cast<SsdGpio*>(device.QueryInterface(InterfaceKind::kSsdGpio));
+    EXPECT_EQ(gpio->GetDevice(), static_cast<Device*>(&device));
+}
+
+TEST(DeviceInterfacesTest, UnlistedInterfacesAreNull) {
+    ListedDevice device;
+    EXPECT_EQ(device.QueryInterface(InterfaceKind::kI2c), nullptr);
+    EXPECT_EQ(device.QueryInterface(InterfaceKind::kPciConfig), nullptr);
+    EXPECT_EQ(device.QueryInterface(InterfaceKind::kCount), nullptr);
+}
+
+TEST(DeviceInterfacesTest, InterfaceCastGoesThroughQueryInterface) {
+    ListedDevice device;
+    Device* base = &device;
+    EXPECT_EQ(InterfaceCast<PowerControl>(base), static_cast<PowerControl*>(&device));
+    EXPECT_EQ(InterfaceCast<I2c>(base), nullptr);
+    EXPECT_EQ(device.queries, 2);
+    EXPECT_EQ(InterfaceCast<PowerControl>(nullptr), nullptr);
+}
+
+TEST(DeviceInterfacesTest, DefaultQueryInterfaceProbesTheClass) {
+    PowerGpioBase device;
+    Device* base = &device;
+    EXPECT_EQ(InterfaceCast<PowerControl>(base), static_cast<PowerControl*>(&device));
+    EXPECT_EQ(InterfaceCast<SsdGpio>(base), static_cast<SsdGpio*>(&device));
+    EXPECT_EQ(InterfaceCast<I2c>(base), nullptr);
+
+    MockDevice plain("plain", "mock://1");
+    for (std::size_t k = 0; k < kInterfaceKindCount; ++k) {
+        EXPECT_EQ(plain.QueryInterface(static_cast<InterfaceKind>(k)), nullptr);
+    }
+}
+
+}  // namespace
+}  // namespace plas::hal
@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/i2c.h"
+
+namespace plas::hal {
+namespace {
+
+// Records every Read/Write so the default Transfer can be checked.
+class RecordingI2c : public I2c {
+public:
+    struct Op {
+        bool read;
+        core::Address addr;
+        size_t length;
+        bool stop;
+    };
+
+    Device* GetDevice() override { return nullptr; }
+
+    core::Result<size_t> Read(core::Address addr, core::Byte* data,
+                              size_t length, bool stop) override {
+        ops.push_back({true, addr, length, stop});
+        if (fail_at == ops.size()) {
+            return core::Result<size_t>::Err(core::ErrorCode::kIOError);
+        }
+        if (max_read != 0 && length > max_read) {
+            length = max_read;
+        }
+        for (size_t i = 0; i < length; ++i) {
+            data[i] = static_cast<core::Byte>(0xA0 + i);
+        }
+        return core::Result<size_t>::Ok(length);
+    }
+
+    core::Result<size_t> Write(core::Address addr, const core::Byte* data,
+                               size_t length, bool stop) override {
+        ops.push_back({false, addr, length, stop});
+        written.assign(data, data + length);
+        if (fail_at == ops.size()) {
+            return core::Result<size_t>::Err(core::ErrorCode::kIOError);
+        }
+        return core::Result<size_t>::Ok(length);
+    }
+
+    core::Result<size_t> WriteRead(core::Address, const core::Byte*, size_t,
+                                   core::Byte*, size_t) override {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    core::Result<void> SetBitrate(uint32_t) override {
+        return core::Result<void>::Ok();
+    }
+    uint32_t GetBitrate() const override { return 100000; }
+
+    std::vector<Op> ops;
+    size_t fail_at = 0;  // 1-based op index that fails; 0 = never
+    size_t max_read = 0;  // short-read limit; 0 = none
+    std::vector<core::Byte> written;
+};
+
+TEST(I2cTransferTest, DefaultRunsMessagesInOrder) {
+    RecordingI2c i2c;
+    core::Byte reg = 0x10;
+    core::Byte rbuf[3] = {};
+    I2cMessage msgs[2];
+    msgs[0].addr = 0x50;
+    msgs[0].data = &reg;
+    msgs[0].length = 1;
+    msgs[1].addr = 0x50;
+    msgs[1].data = rbuf;
+    msgs[1].length = sizeof(rbuf);
+    msgs[1].read = true;
+
+    auto result = i2c.Transfer(msgs, 2);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), 2u);
+
+    ASSERT_EQ(i2c.ops.size(), 2u);
+    EXPECT_FALSE(i2c.ops[0].read);
+    EXPECT_FALSE(i2c.ops[0].stop);  // repeated START into the read
+    EXPECT_TRUE(i2c.ops[1].read);
+    EXPECT_TRUE(i2c.ops[1].stop);
+    EXPECT_EQ(msgs[0].transferred, 1u);
+    EXPECT_EQ(msgs[1].transferred, 3u);
+    EXPECT_EQ(rbuf[0], 0xA0);
+    EXPECT_EQ(rbuf[2], 0xA2);
+}
+
+TEST(I2cTransferTest, LastMessageAlwaysStops) {
+    RecordingI2c i2c;
+    core::Byte buf[2] = {0x01, 0x02};
+    I2cMessage msg;
+    msg.addr = 0x20;
+    msg.data = buf;
+    msg.length = sizeof(buf);
+    msg.stop = false;
+
+    ASSERT_TRUE(i2c.Transfer(&msg, 1).IsOk());
+    ASSERT_EQ(i2c.ops.size(), 1u);
+    EXPECT_TRUE(i2c.ops[0].stop);
+}
+
+TEST(I2cTransferTest, ExplicitStopMidBatchIsHonoured) {
+    RecordingI2c i2c;
+    core::Byte a = 0x01;
+    core::Byte b = 0x02;
+    I2cMessage msgs[2];
+    msgs[0].addr = 0x20;
+    msgs[0].data = &a;
+    msgs[0].length = 1;
+    msgs[0].stop = true;
+    msgs[1].addr = 0x21;
+    msgs[1].data = &b;
+    msgs[1].length = 1;
+
+    ASSERT_TRUE(i2c.Transfer(msgs, 2).IsOk());
+    ASSERT_EQ(i2c.ops.size(), 2u);
+    EXPECT_TRUE(i2c.ops[0].stop);
+    EXPECT_EQ(i2c.ops[1].addr, 0x21);
+}
+
+TEST(I2cTransferTest, FailureAbortsRemainingMessages) {
+    RecordingI2c i2c;
+    i2c.fail_at = 2;
+    core::Byte buf = 0;
+    I2cMessage msgs[3];
+    for (auto& msg : msgs) {
+        msg.addr = 0x50;
+        msg.data = &buf;
+        msg.length = 1;
+    }
+
+    auto result = i2c.Transfer(msgs, 3);
+    EXPECT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), core::make_error_code(core::ErrorCode::kIOError));
+    EXPECT_EQ(i2c.ops.size(), 2u);
+    EXPECT_EQ(msgs[0].transferred, 1u);
+    EXPECT_EQ(msgs[2].transferred, 0u);
+}
+
+TEST(I2cTransferTest, NullMessagesRejected) {
+    RecordingI2c i2c;
+    auto result = i2c.Transfer(nullptr, 1);
+    EXPECT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    EXPECT_TRUE(i2c.ops.empty());
+}
+
+TEST(I2cTransferTest, EmptyBatchIsNoOp) {
+    RecordingI2c i2c;
+    auto result = i2c.Transfer(nullptr, 0);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), 0u);
+}
+
+TEST(I2cByteBufferTest, ReadBytesAppendsWhatWasRead) {
+    RecordingI2c i2c;
+    core::ByteBuffer buf{0x01};
+    i2c.max_read = 3;
+    auto result = i2c.ReadBytes(0x50, buf, 8);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), 3u);
+    const core::Byte expected[] = {0x01, 0xA0, 0xA1, 0xA2};
+    EXPECT_EQ(buf.View(), core::ByteView(expected));
+    EXPECT_TRUE(buf.IsInline());
+}
+
+TEST(I2cByteBufferTest, ReadBytesFailureLeavesBufferUnchanged) {
+    RecordingI2c i2c;
+    core::ByteBuffer buf{0x01, 0x02};
+    i2c.fail_at = 1;
+    EXPECT_TRUE(i2c.ReadBytes(0x50, buf, 16).IsError());
+    EXPECT_EQ(buf.Size(), 2u);
+}
+
+TEST(I2cByteBufferTest, WriteBytesSendsSlice) {
+    RecordingI2c i2c;
+    core::ByteBuffer buf{0x10, 0x20, 0x30, 0x40};
+    auto result = i2c.WriteBytes(0x50, buf.Slice(1, 2), false);
+    ASSERT_TRUE(result.IsOk());
+    ASSERT_EQ(i2c.ops.size(), 1u);
+    EXPECT_FALSE(i2c.ops[0].stop);
+    EXPECT_EQ(i2c.written, (std::vector<core::Byte>{0x20, 0x30}));
+}
+
+TEST(I2cProbeTest, DefaultProbeReadsOneByte) {
+    RecordingI2c i2c;
+    auto present = i2c.Probe(0x50);
+    ASSERT_TRUE(present.IsOk());
+    EXPECT_TRUE(present.Value());
+    ASSERT_EQ(i2c.ops.size(), 1u);
+    EXPECT_TRUE(i2c.ops[0].read);
+    EXPECT_EQ(i2c.ops[0].length, 1u);
+}
+
+TEST(I2cProbeTest, DefaultProbeTakesNackAsAbsent) {
+    RecordingI2c i2c;
+    i2c.fail_at = 1;  // kIOError, as backends report a NACK
+    auto present = i2c.Probe(0x51);
+    ASSERT_TRUE(present.IsOk());
+    EXPECT_FALSE(present.Value());
+}
+
+TEST(I2cProbeTest, DefaultScanProbesSpan) {
+    RecordingI2c i2c;
+    i2c.fail_at = 2;  // 0x11 NACKs
+    auto found = i2c.Scan(0x10, 0x12);
+    ASSERT_TRUE(found.IsOk());
+    EXPECT_EQ(found.Value(), (std::vector<core::Address>{0x10, 0x12}));
+    EXPECT_EQ(i2c.ops.size(), 3u);
+}
+
+TEST(I2cProbeTest, DefaultScanRejectsBadSpan) {
+    RecordingI2c i2c;
+    auto invalid = core::make_error_code(core::ErrorCode::kInvalidArgument);
+    EXPECT_EQ(i2c.Scan(0x20, 0x10).Error(), invalid);
+    EXPECT_EQ(i2c.Scan(0x00, 0x80).Error(), invalid);
+    EXPECT_TRUE(i2c.ops.empty());
+}
+
+}  // namespace
+}  // namespace plas::hal
@@ -0,0 +1,277 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/i2c_eeprom.h"
+
+namespace plas::hal {
+namespace {
+
+// 24Cxx model: block-select device addresses, a register pointer that page
+// writes wrap within the page, and a write cycle during which every access
+// NACKs (kIOError) for `busy_polls` attempts.
+class FakeEeprom : public I2c {
+public:
+    FakeEeprom(core::Address base, I2cEepromGeometry geometry)
+        : base_(base), geometry_(geometry), memory_(geometry.size, 0xFF) {}
+
+    Device* GetDevice() override { return nullptr; }
+
+    core::Result<size_t> Read(core::Address addr, core::Byte* data, size_t length,
+                              bool) override {
+        auto ack = Ack(addr);
+        if (ack.IsError()) {
+            return core::Result<size_t>::Err(ack.Error());
+        }
+        reads++;
+        for (size_t i = 0; i < length; ++i) {
+            data[i] = memory_[pointer_];
+            pointer_ = (pointer_ + 1) % memory_.size();
+        }
+        return core::Result<size_t>::Ok(length);
+    }
+
+    core::Result<size_t> Write(core::Address addr, const core::Byte* data, size_t length,
+                               bool) override {
+        auto ack = Ack(addr);
+        if (ack.IsError()) {
+            return core::Result<size_t>::Err(ack.Error());
+        }
+        size_t block = addr - base_;
+        size_t block_size = size_t{1} << (8 * geometry_.address_bytes);
+        size_t mem = 0;
+        for (size_t i = 0; i < geometry_.address_bytes && i < length; ++i) {
+            mem = (mem << 8) | data[i];
+        }
+        pointer_ = (block * block_size + mem) % memory_.size();
+        if (length <= geometry_.address_bytes) {
+            return core::Result<size_t>::Ok(length);
+        }
+        writes++;
+        size_t page_start = pointer_ & ~(geometry_.page_size - 1);
+        for (size_t i = geometry_.address_bytes; i < length; ++i) {
+            size_t at = page_start + (pointer_ - page_start + i - geometry_.address_bytes) %
+                                         geometry_.page_size;
+            if (!write_protect) {
+                memory_[at] = data[i];
+            }
+        }
+        busy_ = stuck ? SIZE_MAX : busy_polls;
+        return core::Result<size_t>::Ok(length);
+    }
+
+    core::Result<size_t> WriteRead(core::Address, const core::Byte*, size_t, core::Byte*,
+                                   size_t) override {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    core::Result<size_t> Transfer(I2cMessage* msgs, size_t count) override {
+        transfers++;
+        return I2c::Transfer(msgs, count);
+    }
+
+    core::Result<void> SetBitrate(uint32_t) override { return core::Result<void>::Ok(); }
+    uint32_t GetBitrate() const override { return 400000; }
+
+    std::vector<core::Byte>& Memory() { return memory_; }
+
+    size_t busy_polls = 0;
+    bool stuck = false;
+    bool write_protect = false;
+    int reads = 0;
+    int writes = 0;
+    int transfers = 0;
+    int nacks = 0;
+
+private:
+    core::Result<void> Ack(core::Address addr) {
+        size_t blocks = std::max<size_t>(
+            1, geometry_.size >> (8 * geometry_.address_bytes));
+        if (addr < base_ || addr >= base_ + blocks) {
+            return core::Result<void>::Err(core::ErrorCode::kIOError);
+        }
+        if (busy_ > 0) {
+            if (busy_ != SIZE_MAX) {
+                busy_--;
+            }
+            nacks++;
+            return core::Result<void>::Err(core::ErrorCode::kIOError);
+        }
+        return core::Result<void>::Ok();
+    }
+
+    core::Address base_;
+    I2cEepromGeometry geometry_;
+    std::vector<core::Byte> memory_;
+    size_t pointer_ = 0;
+    size_t busy_ = 0;
+};
+
+std::vector<core::Byte> Pattern(size_t length, uint8_t seed = 0) {
+    std::vector<core::Byte> data(length);
+    for (size_t i = 0; i < length; ++i) {
+        data[i] = static_cast<core::Byte>(i * 7 + seed);
+    }
+    return data;
+}
+
+I2cEepromGeometry Part(const char* name) {
+    auto geometry = I2cEepromGeometry::FromPart(name);
+    EXPECT_TRUE(geometry.IsOk()) << name;
+    return geometry.Value();
+}
+
+TEST(I2cEepromGeometryTest, KnownParts) {
+    auto c02 = Part("24c02");
+    EXPECT_EQ(c02.size, 256u);
+    EXPECT_EQ(c02.page_size, 8u);
+    EXPECT_EQ(c02.address_bytes, 1u);
+    auto c256 = Part("AT24C256");
+    EXPECT_EQ(c256.size, 32768u);
+    EXPECT_EQ(c256.page_size, 64u);
+    EXPECT_EQ(c256.address_bytes, 2u);
+    EXPECT_EQ(Part("24LC16").size, 2048u);
+    EXPECT_EQ(Part("m24c64").page_size, 32u);
+    EXPECT_EQ(Part("24aa1024").size, 131072u);
+    EXPECT_EQ(I2cEepromGeometry::FromPart("24c03").Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+    EXPECT_TRUE(I2cEepromGeometry::FromPart("lm75").IsError());
+}
+
+TEST(I2cEepromTest, WriteSplitsAtPageBoundaries) {
+    FakeEeprom chip(0x50, Part("24c32"));
+    I2cEeprom eeprom(chip, 0x50, Part("24c32"));
+    auto data = Pattern(100);
+    ASSERT_TRUE(eeprom.Write(20, data.data(), data.size()).IsOk());
+    // 12 bytes to the end of page 0, then 32 + 32 + 24.
+    EXPECT_EQ(eeprom.Stats().pages_written, 4u);
+    EXPECT_EQ(chip.writes, 4);
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), chip.Memory().begin() + 20));
+    EXPECT_EQ(chip.Memory()[19], 0xFF);
+    EXPECT_EQ(chip.Memory()[120], 0xFF);
+}
+
+TEST(I2cEepromTest, AckPollingReplacesFixedDelay) {
+    FakeEeprom chip(0x50, Part("24c02"));
+    chip.busy_polls = 3;
+    I2cEeprom eeprom(chip, 0x50, Part("24c02"));
+    auto data = Pattern(24);
+    ASSERT_TRUE(eeprom.Write(0, data.data(), data.size()).IsOk());
+    // Three pages: the second and third writes are retried through the
+    // previous cycle, then Probe() waits out the last one.
+    EXPECT_EQ(chip.writes, 3);
+    EXPECT_EQ(eeprom.Stats().ack_polls, 9u);
+    EXPECT_EQ(chip.nacks, 9);
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), chip.Memory().begin()));
+}
+
+TEST(I2cEepromTest, StuckWriteCycleTimesOut) {
+    FakeEeprom chip(0x50, Part("24c02"));
+    chip.stuck = true;
+    I2cEepromOptions options;
+    options.write_timeout = std::chrono::milliseconds(2);
+    I2cEeprom eeprom(chip, 0x50, Part("24c02"), options);
+    auto data = Pattern(16);
+    EXPECT_EQ(eeprom.Write(0, data.data(), data.size()).Error(),
+              core::make_error_code(core::ErrorCode::kTimeout));
+    EXPECT_EQ(chip.writes, 1);
+}
+
+TEST(I2cEepromTest, MissingPartFailsWithoutPolling) {
+    FakeEeprom chip(0x50, Part("24c02"));
+    I2cEeprom eeprom(chip, 0x57, Part("24c02"));
+    auto data = Pattern(4);
+    EXPECT_EQ(eeprom.Write(0, data.data(), data.size()).Error(),
+              core::make_error_code(core::ErrorCode::kIOError));
+    EXPECT_EQ(eeprom.Stats().ack_polls, 0u);
+}
+
+TEST(I2cEepromTest, ReadIsOneBatchedTransfer) {
+    auto geometry = Part("24c512");
+    FakeEeprom chip(0x50, geometry);
+    auto image = Pattern(geometry.size, 3);
+    chip.Memory() = image;
+    I2cEeprom eeprom(chip, 0x50, geometry);
+
+    std::vector<core::Byte> out(geometry.size);
+    ASSERT_TRUE(eeprom.Read(0, out.data(), out.size()).IsOk());
+    EXPECT_EQ(out, image);
+    EXPECT_EQ(chip.transfers, 1);
+    EXPECT_EQ(chip.reads, 2);  // two 32 KiB sequential reads
+    EXPECT_EQ(eeprom.Stats().bytes_read, geometry.size);
+}
+
+TEST(I2cEepromTest, ReadSplitsAtBlockSelect) {
+    auto geometry = Part("24c16");  // eight 256-byte blocks at 0x50-0x57
+    FakeEeprom chip(0x50, geometry);
+    auto image = Pattern(geometry.size, 5);
+    chip.Memory() = image;
+    I2cEeprom eeprom(chip, 0x50, geometry);
+
+    std::vector<core::Byte> out(600);
+    ASSERT_TRUE(eeprom.Read(200, out.data(), out.size()).IsOk());
+    EXPECT_TRUE(std::equal(out.begin(), out.end(), image.begin() + 200));
+    EXPECT_EQ(chip.transfers, 1);
+    EXPECT_EQ(chip.reads, 4);  // 56 + 256 + 256 + 32
+
+    auto data = Pattern(40, 9);
+    ASSERT_TRUE(eeprom.Write(0x1F0, data.data(), data.size()).IsOk());
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), chip.Memory().begin() + 0x1F0));
+}
+
+TEST(I2cEepromTest, RangeAndGeometryChecked) {
+    FakeEeprom chip(0x50, Part("24c02"));
+    I2cEeprom eeprom(chip, 0x50, Part("24c02"));
+    core::Byte buf[8] = {};
+    EXPECT_EQ(eeprom.Read(250, buf, 8).Error(),
+              core::make_error_code(core::ErrorCode::kOutOfRange));
+    EXPECT_EQ(eeprom.Write(0, nullptr, 8).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    EXPECT_TRUE(eeprom.Read(0, buf, 0).IsOk());
+
+    I2cEeprom odd(chip, 0x50, I2cEepromGeometry{300, 8, 1});
+    EXPECT_EQ(odd.Read(0, buf, 1).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    I2cEeprom misaligned(chip, 0x51, Part("24c04"));  // block select needs 0x50
+    EXPECT_EQ(misaligned.Read(0, buf, 1).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
+TEST(I2cEepromTest, SkipUnchangedWritesOnlyDifferingPages) {
+    FakeEeprom chip(0x50, Part("24c32"));
+    auto image = Pattern(128);
+    I2cEepromOptions options;
+    options.skip_unchanged = true;
+    I2cEeprom eeprom(chip, 0x50, Part("24c32"), options);
+    ASSERT_TRUE(eeprom.Write(0, image.data(), image.size()).IsOk());
+    EXPECT_EQ(chip.writes, 4);
+
+    image[70] ^= 0xFF;  // page 2 only
+    ASSERT_TRUE(eeprom.Write(0, image.data(), image.size()).IsOk());
+    EXPECT_EQ(chip.writes, 5);
+    EXPECT_EQ(eeprom.Stats().pages_skipped, 3u);
+    EXPECT_EQ(chip.Memory()[70], image[70]);
+}
+
+TEST(I2cEepromTest, VerifyReportsMismatch) {
+    FakeEeprom chip(0x50, Part("24c02"));
+    chip.write_protect = true;
+    I2cEepromOptions options;
+    options.verify = true;
+    I2cEeprom eeprom(chip, 0x50, Part("24c02"), options);
+    auto data = Pattern(16);
+    EXPECT_EQ(eeprom.Write(0, data.data(), data.size()).Error(),
+              core::make_error_code(core::ErrorCode::kDataLoss));
+
+    chip.write_protect = false;
+    EXPECT_TRUE(eeprom.Write(0, data.data(), data.size()).IsOk());
+    EXPECT_TRUE(eeprom.Verify(0, data.data(), data.size()).IsOk());
+}
+
+}  // namespace
+}  // namespace plas::hal
@@ -0,0 +1,309 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/i2c_register_map.h"
+
+namespace plas::hal {
+namespace {
+
+/// Targets with 8-bit (or 16-bit) register files and an auto-incrementing
+/// pointer, counting bus transactions.
+class FakeBus : public I2c {
+public:
+    struct Target {
+        std::array<core::Byte, 0x200> regs{};
+        uint8_t pointer_width = 1;
+        uint16_t pointer = 0;
+    };
+
+    Device* GetDevice() override { return nullptr; }
+
+    core::Result<size_t> Read(core::Address addr, core::Byte* data, size_t length,
+                              bool) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = targets.find(addr);
+        if (it == targets.end() || nack.count(addr)) {
+            return core::Result<size_t>::Err(core::ErrorCode::kIOError);
+        }
+        auto& t = it->second;
+        for (size_t i = 0; i < length; ++i) {
+            data[i] = t.regs[(t.pointer + i) % t.regs.size()];
+        }
+        t.pointer = static_cast<uint16_t>(t.pointer + length);
+        ++reads;
+        return core::Result<size_t>::Ok(length);
+    }
+
+    core::Result<size_t> Write(core::Address addr, const core::Byte* data, size_t length,
+                               bool) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = targets.find(addr);
+        if (it == targets.end() || nack.count(addr)) {
+            return core::Result<size_t>::Err(core::ErrorCode::kIOError);
+        }
+        auto& t = it->second;
+        size_t w = t.pointer_width;
+        t.pointer = w == 2 ? static_cast<uint16_t>(data[0] << 8 | data[1]) : data[0];
+        for (size_t i = w; i < length; ++i) {
+            t.regs[t.pointer++] = data[i];
+        }
+        ++writes;
+        return core::Result<size_t>::Ok(length);
+    }
+
+    core::Result<size_t> WriteRead(core::Address addr, const core::Byte* write_data,
+                                   size_t write_len, core::Byte* read_data,
+                                   size_t read_len) override {
+        auto w = Write(addr, write_data, write_len, false);
+        if (w.IsError()) {
+            return w;
+        }
+        --writes;
+        ++write_reads;
+        return Read(addr, read_data, read_len, true);
+    }
+
+    core::Result<size_t> Transfer(I2cMessage* msgs, size_t count) override {
+        ++transfers;
+        return I2c::Transfer(msgs, count);
+    }
+
+    core::Result<void> SetBitrate(uint32_t) override { return core::Result<void>::Ok(); }
+    uint32_t GetBitrate() const override { return 400000; }
+
+    std::mutex mutex;
+    std::map<core::Address, Target> targets;
+    std::set<core::Address> nack;
+    std::atomic<int> reads{0};
+    std::atomic<int> writes{0};
+    std::atomic<int> write_reads{0};
+    std::atomic<int> transfers{0};
+};
+
+TEST(I2cRegisterMapTest, ParsesTextMap) {
+    auto parsed = ParseI2cRegisterMap(
+        "tmp75@0x48: temp=0x00/2, config=0x01; "
+        "eeprom@0x50/a16/noinc: id=0x1F00/4/le/const, stat=3/100ms;");
+    ASSERT_TRUE(parsed.IsOk());
+    const auto& devices = parsed.Value();
+    ASSERT_EQ(devices.size(), 2u);
+    EXPECT_EQ(devices[0].name, "tmp75");
+    EXPECT_EQ(devices[0].addr, 0x48);
+    EXPECT_EQ(devices[0].offset_width, 1);
+    ASSERT_EQ(devices[0].registers.size(), 2u);
+    EXPECT_EQ(devices[0].registers[0].size, 2);
+    EXPECT_EQ(devices[0].registers[1].offset, 0x01);
+    EXPECT_EQ(devices[1].offset_width, 2);
+    EXPECT_FALSE(devices[1].auto_increment);
+    const auto& id = devices[1].registers[0];
+    EXPECT_EQ(id.offset, 0x1F00);
+    EXPECT_EQ(id.size, 4);
+    EXPECT_TRUE(id.little_endian);
+    EXPECT_TRUE(id.constant);
+    EXPECT_EQ(devices[1].registers[1].period, std::chrono::milliseconds(100));
+
+    for (const char* bad : {"tmp@0x48", "tmp@0x80: a=0", "tmp@0x48: a", "tmp@0x48: a=0/9",
+                            "tmp@0x48: a=0/fast", "tmp@0x48/x: a=0", "@0x48: a=0"}) {
+        EXPECT_EQ(ParseI2cRegisterMap(bad).Error(), core::ErrorCode::kInvalidArgument) << bad;
+    }
+    EXPECT_TRUE(ParseI2cRegisterMap("").Value().empty());
+}
+
+TEST(I2cRegisterMapTest, FortyRegistersInThreeTransfers) {
+    FakeBus bus;
+    I2cRegisterMap map(bus);
+    // Three sensors: 16 + 16 + 8 one-byte registers, each block contiguous.
+    for (core::Address addr : {0x40u, 0x41u, 0x42u}) {
+        auto& t = bus.targets[addr];
+        for (size_t i = 0; i < t.regs.size(); ++i) {
+            t.regs[i] = static_cast<core::Byte>(addr + i);
+        }
+        I2cRegisterDevice dev;
+        dev.name = "s" + std::to_string(addr);
+        dev.addr = addr;
+        for (uint16_t r = 0; r < (addr == 0x42 ? 8 : 16); ++r) {
+            dev.registers.push_back({"r" + std::to_string(r), r});
+        }
+        ASSERT_TRUE(map.AddDevice(dev).IsOk());
+    }
+
+    auto plan = map.PlanPoll();
+    ASSERT_EQ(plan.size(), 3u);
+    EXPECT_EQ(plan[0].length, 16);
+    EXPECT_EQ(plan[2].length, 8);
+
+    ASSERT_TRUE(map.Poll().IsOk());
+    EXPECT_EQ(bus.transfers, 1);   // one batch
+    EXPECT_EQ(bus.reads, 3);       // three block reads
+    EXPECT_EQ(map.Stats().transfers, 3u);
+    EXPECT_EQ(map.Stats().registers_read, 40u);
+
+    auto id = map.Find("s65", "r7");
+    ASSERT_TRUE(id.IsOk());
+    EXPECT_EQ(map.Value(id.Value()).Value(), 0x41u + 7);
+}
+
+TEST(I2cRegisterMapTest, GapsAndBlockSizeSplitReads) {
+    FakeBus bus;
+    bus.targets[0x48];
+    I2cRegisterMapOptions options;
+    options.max_gap = 2;
+    options.max_block = 8;
+    I2cRegisterMap map(bus, options);
+    ASSERT_TRUE(map.AddDevices("t@0x48: a=0/2, b=4/2, c=0x10, d=0x12/4, e=0x16/4").IsOk());
+
+    auto plan = map.PlanPoll();
+    ASSERT_EQ(plan.size(), 3u);
+    EXPECT_EQ(plan[0].offset, 0);      // a + 2-byte gap + b
+    EXPECT_EQ(plan[0].length, 6);
+    EXPECT_EQ(plan[1].offset, 0x10);   // c + d (e would make it 10 bytes)
+    EXPECT_EQ(plan[1].length, 6);
+    EXPECT_EQ(plan[2].offset, 0x16);
+}
+
+TEST(I2cRegisterMapTest, NoAutoIncrementReadsEachRegister) {
+    FakeBus bus;
+    bus.targets[0x48];
+    I2cRegisterMap map(bus);
+    ASSERT_TRUE(map.AddDevices("t@0x48/noinc: a=0, b=1, c=2").IsOk());
+    EXPECT_EQ(map.PlanPoll().size(), 3u);
+}
+
+TEST(I2cRegisterMapTest, DecodesByteOrderAndSixteenBitPointers) {
+    FakeBus bus;
+    auto& t = bus.targets[0x50];
+    t.pointer_width = 2;
+    t.regs[0x100] = 0x12;
+    t.regs[0x101] = 0x34;
+    I2cRegisterMap map(bus);
+    ASSERT_TRUE(map.AddDevices("e@0x50/a16: be=0x100/2, le=0x100/2/le").IsOk());
+    ASSERT_TRUE(map.Poll().IsOk());
+    EXPECT_EQ(map.Value(map.Find("e", "be").Value()).Value(), 0x1234u);
+    EXPECT_EQ(map.Value(map.Find("e", "le").Value()).Value(), 0x3412u);
+    EXPECT_EQ(map.Stats().transfers, 1u);  // overlapping registers share a read
+}
+
+TEST(I2cRegisterMapTest, ConstantRegistersAreCached) {
+    FakeBus bus;
+    bus.targets[0x40].regs[0xFE] = 0x54;
+    I2cRegisterMap map(bus);
+    ASSERT_TRUE(map.AddDevices("ina@0x40: id=0xFE/const, v=0x02/2").IsOk());
+    auto id = map.Find("ina", "id").Value();
+
+    ASSERT_TRUE(map.Poll().IsOk());
+    EXPECT_EQ(map.PlanPoll().size(), 1u);  // only v is still polled
+    ASSERT_TRUE(map.Poll().IsOk());
+    EXPECT_EQ(bus.reads, 3);
+
+    bus.targets[0x40].regs[0xFE] = 0;
+    EXPECT_EQ(map.Read(id).Value(), 0x54u);
+    EXPECT_EQ(bus.reads, 3);
+    EXPECT_EQ(map.Stats().cache_hits, 1u);
+    EXPECT_EQ(map.Write(id, 1).Error(), core::ErrorCode::kInvalidArgument);
+}
+
+TEST(I2cRegisterMapTest, PeriodsThrottleRegisters) {
+    FakeBus bus;
+    bus.targets[0x48];
+    I2cRegisterMap map(bus);
+    ASSERT_TRUE(map.AddDevices("t@0x48: fast=0, slow=0x20/3600s").IsOk());
+    ASSERT_TRUE(map.Poll().IsOk());
+    EXPECT_EQ(map.Stats().transfers, 2u);
+    ASSERT_TRUE(map.Poll().IsOk());
+    EXPECT_EQ(map.Stats().transfers, 3u);  // slow not due again
+}
+
+TEST(I2cRegisterMapTest, FailingTargetDoesNotHideOthers) {
+    FakeBus bus;
+    bus.targets[0x40].regs[0] = 0x11;
+    bus.targets[0x41].regs[0] = 0x22;
+    bus.nack.insert(0x41);
+    I2cRegisterMap map(bus);
+    ASSERT_TRUE(map.AddDevices("a@0x40: r=0; b@0x41: r=0").IsOk());
+
+    EXPECT_EQ(map.Poll().Error(), core::ErrorCode::kIOError);
+    EXPECT_EQ(map.Value(map.Find("a", "r").Value()).Value(), 0x11u);
+    EXPECT_EQ(map.Value(map.Find("b", "r").Value()).Error(), core::ErrorCode::kIOError);
+    EXPECT_EQ(map.Stats().errors, 1u);
+
+    bus.nack.clear();
+    ASSERT_TRUE(map.Poll().IsOk());
+    EXPECT_EQ(map.Value(map.Find("b", "r").Value()).Value(), 0x22u);
+}
+
+TEST(I2cRegisterMapTest, ReadAndWriteOneRegister) {
+    FakeBus bus;
+    bus.targets[0x48];
+    I2cRegisterMap map(bus);
+    ASSERT_TRUE(map.AddDevices("t@0x48: limit=0x02/2, le=0x04/2/le").IsOk());
+    auto limit = map.Find("t", "limit").Value();
+    auto le = map.Find("t", "le").Value();
+
+    EXPECT_EQ(map.Value(limit).Error(), core::ErrorCode::kNotFound);
+    ASSERT_TRUE(map.Write(limit, 0xABCD).IsOk());
+    EXPECT_EQ(bus.targets[0x48].regs[2], 0xAB);
+    EXPECT_EQ(bus.targets[0x48].regs[3], 0xCD);
+    EXPECT_EQ(map.Read(limit).Value(), 0xABCDu);
+    EXPECT_EQ(map.Value(limit).Value(), 0xABCDu);
+
+    ASSERT_TRUE(map.Write(le, 0xABCD).IsOk());
+    EXPECT_EQ(bus.targets[0x48].regs[4], 0xCD);
+    EXPECT_EQ(map.Write(le, 0x10000).Error(), core::ErrorCode::kInvalidArgument);
+    EXPECT_EQ(map.Read(99).Error(), core::ErrorCode::kNotFound);
+    EXPECT_EQ(map.Find("t", "nope").Error(), core::ErrorCode::kNotFound);
+}
+
+TEST(I2cRegisterMapTest, RejectsBadDevices) {
+    FakeBus bus;
+    I2cRegisterMap map(bus);
+    ASSERT_TRUE(map.AddDevices("t@0x48: a=0").IsOk());
+    EXPECT_EQ(map.AddDevices("t@0x49: a=0").Error(), core::ErrorCode::kInvalidArgument);
+    EXPECT_EQ(map.AddDevices("u@0x49: a=0, a=1").Error(), core::ErrorCode::kInvalidArgument);
+    EXPECT_EQ(map.AddDevices("u@0x49: a=0xFF/2").Error(), core::ErrorCode::kInvalidArgument);
+    // All or none.
+    EXPECT_EQ(map.AddDevices("u@0x49: a=0; u@0x4A: a=0").Error(),
+              core::ErrorCode::kInvalidArgument);
+    EXPECT_EQ(map.DeviceCount(), 1u);
+
+    I2cRegisterDevice bad;
+    bad.name = "w";
+    bad.offset_width = 3;
+    EXPECT_EQ(map.AddDevice(bad).Error(), core::ErrorCode::kInvalidArgument);
+}
+
+TEST(I2cRegisterMapTest, PollsOnTimer) {
+    FakeBus bus;
+    bus.targets[0x48];
+    I2cRegisterMapOptions options;
+    options.interval = std::chrono::milliseconds(1);
+    I2cRegisterMap map(bus, options);
+    ASSERT_TRUE(map.AddDevices("t@0x48: a=0").IsOk());
+
+    std::atomic<int> polls{0};
+    std::promise<void> three;
+    ASSERT_TRUE(map.Start([&](core::Result<void> result) {
+                       EXPECT_TRUE(result.IsOk());
+                       if (++polls == 3) {
+                           three.set_value();
+                       }
+                   }).IsOk());
+    EXPECT_TRUE(map.IsRunning());
+    EXPECT_EQ(map.Start().Error(), core::ErrorCode::kAlreadyOpen);
+    EXPECT_EQ(map.AddDevices("u@0x49: a=0").Error(), core::ErrorCode::kBusy);
+    ASSERT_EQ(three.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    map.Stop();
+    EXPECT_FALSE(map.IsRunning());
+    EXPECT_GE(map.Stats().polls, 3u);
+}
+
+}  // namespace
+}  // namespace plas::hal
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/i3c.h"
+
+namespace plas::hal {
+namespace {
+
+// SDR-only bus: every optional hook keeps its default.
+class SdrBus : public I3c {
+public:
+    Device* GetDevice() override { return nullptr; }
+    core::Result<size_t> Read(core::Address, core::Byte*, size_t length, bool) override {
+        return core::Result<size_t>::Ok(length);
+    }
+    core::Result<size_t> Write(core::Address, const core::Byte*, size_t length,
+                               bool) override {
+        return core::Result<size_t>::Ok(length);
+    }
+    core::Result<void> SendBroadcastCcc(uint8_t, const core::Byte*, size_t) override {
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> SendDirectCcc(uint8_t, core::Address, const core::Byte*,
+                                     size_t) override {
+        return core::Result<void>::Ok();
+    }
+    core::Result<size_t> RecvDirectCcc(uint8_t, core::Address, core::Byte*,
+                                       size_t) override {
+        return core::Result<size_t>::Ok(0);
+    }
+    core::Result<void> SetFrequency(core::Frequency) override {
+        return core::Result<void>::Ok();
+    }
+};
+
+// Controller with HDR-DDR and an IBI thread the test drives.
+class HdrBus : public SdrBus {
+public:
+    core::Result<size_t> HdrDdrRead(core::Address, uint8_t command, core::Byte* data,
+                                    size_t length) override {
+        if ((command & 0x80) == 0) {
+            return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+        }
+        std::memset(data, command, length);
+        return core::Result<size_t>::Ok(length);
+    }
+
+    core::Result<void> StartIbi(const I3cIbiOptions& options) override {
+        auto valid = ValidateIbiOptions(options);
+        if (valid.IsError()) {
+            return valid;
+        }
+        options_ = options;
+        active_ = true;
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> StopIbi() override {
+        active_ = false;
+        return core::Result<void>::Ok();
+    }
+    bool IsIbiActive() const override { return active_; }
+
+    // What the backend's IBI thread does for each interrupt.
+    void Raise(core::Address addr, uint64_t when, uint8_t mdb) {
+        I3cIbi ibi;
+        ibi.timestamp_ns = when;
+        ibi.addr = addr;
+        ibi.length = 1;
+        ibi.payload[0] = mdb;
+        if (options_.queue != nullptr) {
+            options_.queue->Push(ibi);
+        }
+        if (options_.callback) {
+            options_.callback(ibi);
+        }
+    }
+
+private:
+    I3cIbiOptions options_;
+    bool active_ = false;
+};
+
+TEST(I3cIbiTest, DefaultsAreUnsupported) {
+    SdrBus bus;
+    core::Byte buf[4] = {};
+    EXPECT_EQ(bus.HdrDdrRead(0x08, 0x80, buf, 4).Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    EXPECT_EQ(bus.HdrDdrWrite(0x08, 0x00, buf, 4).Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    I3cIbiQueue queue(4);
+    I3cIbiOptions options;
+    options.queue = &queue;
+    EXPECT_EQ(bus.StartIbi(options).Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    EXPECT_TRUE(bus.StopIbi().IsOk());
+    EXPECT_FALSE(bus.IsIbiActive());
+}
+
+TEST(I3cIbiTest, ValidateRequiresASink) {
+    I3cIbiOptions options;
+    EXPECT_EQ(I3c::ValidateIbiOptions(options).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    options.callback = [](const I3cIbi&) {};
+    EXPECT_TRUE(I3c::ValidateIbiOptions(options).IsOk());
+}
+
+TEST(I3cIbiTest, HdrDdrReadOverride) {
+    HdrBus bus;
+    core::Byte buf[8] = {};
+    auto read = bus.HdrDdrRead(0x08, 0x85, buf, sizeof(buf));
+    ASSERT_TRUE(read.IsOk());
+    EXPECT_EQ(read.Value(), sizeof(buf));
+    EXPECT_EQ(buf[7], 0x85);
+    EXPECT_TRUE(bus.HdrDdrRead(0x08, 0x05, buf, sizeof(buf)).IsError());
+}
+
+TEST(I3cIbiTest, QueueCarriesIbisAcrossThreads) {
+    HdrBus bus;
+    I3cIbiQueue queue(64);
+    std::atomic<int> calls{0};
+    I3cIbiOptions options;
+    options.targets = {0x08, 0x09};
+    options.queue = &queue;
+    options.callback = [&](const I3cIbi&) { calls++; };
+    ASSERT_TRUE(bus.StartIbi(options).IsOk());
+    EXPECT_TRUE(bus.IsIbiActive());
+
+    constexpr int kCount = 50;
+    std::thread producer([&] {
+        for (int i = 0; i < kCount; ++i) {
+            bus.Raise(i % 2 == 0 ? 0x08 : 0x09, 1000u + static_cast<uint64_t>(i),
+                      static_cast<uint8_t>(i));
+        }
+    });
+
+    std::vector<I3cIbi> seen;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (seen.size() < kCount && std::chrono::steady_clock::now() < deadline) {
+        I3cIbi batch[8];
+        size_t n = queue.Pop(batch, 8);
+        seen.insert(seen.end(), batch, batch + n);
+    }
+    producer.join();
+
+    ASSERT_EQ(seen.size(), static_cast<size_t>(kCount));
+    for (int i = 0; i < kCount; ++i) {
+        EXPECT_EQ(seen[static_cast<size_t>(i)].timestamp_ns, 1000u + static_cast<uint64_t>(i));
+        EXPECT_EQ(seen[static_cast<size_t>(i)].payload[0], static_cast<core::Byte>(i));
+    }
+    EXPECT_EQ(seen[1].addr, 0x09u);
+    EXPECT_EQ(calls.load(), kCount);
+    EXPECT_EQ(queue.Dropped(), 0u);
+
+    EXPECT_TRUE(bus.StopIbi().IsOk());
+    EXPECT_FALSE(bus.IsIbiActive());
+}
+
+}  // namespace
+}  // namespace plas::hal
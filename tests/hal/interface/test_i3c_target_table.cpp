@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/i3c.h"
+#include "plas/hal/interface/i3c_target_table.h"
+
+namespace plas::hal {
+namespace {
+
+I3cTargetInfo Target(core::Address addr, uint64_t pid) {
+    I3cTargetInfo info;
+    info.dynamic_address = addr;
+    info.pid = pid;
+    info.bcr = 0x27;
+    info.dcr = 0xDA;
+    return info;
+}
+
+TEST(I3cTargetTableTest, AssignableAddresses) {
+    EXPECT_FALSE(I3cTargetTable::IsAssignable(0x07));
+    EXPECT_TRUE(I3cTargetTable::IsAssignable(0x08));
+    EXPECT_TRUE(I3cTargetTable::IsAssignable(0x77));
+    EXPECT_FALSE(I3cTargetTable::IsAssignable(0x78));
+    EXPECT_FALSE(I3cTargetTable::IsAssignable(0x7E));
+    for (core::Address reserved : {0x3Eu, 0x5Eu, 0x6Eu, 0x76u}) {
+        EXPECT_FALSE(I3cTargetTable::IsAssignable(reserved)) << reserved;
+    }
+}
+
+TEST(I3cTargetTableTest, DecodesDaaRecord) {
+    const core::Byte record[I3cTargetTable::kDaaRecordSize] = {
+        0x04, 0x6A, 0x00, 0x00, 0x51, 0x18, 0x27, 0xDA};
+    auto info = I3cTargetTable::FromDaaRecord(record, 0x09);
+    EXPECT_EQ(info.dynamic_address, 0x09u);
+    EXPECT_EQ(info.pid, 0x046A00005118ull);
+    EXPECT_EQ(info.bcr, 0x27);
+    EXPECT_EQ(info.dcr, 0xDA);
+    EXPECT_TRUE(info.HdrCapable());
+    EXPECT_TRUE(info.IbiCapable());
+}
+
+TEST(I3cTargetTableTest, AddKeepsAddressOrderAndRejectsDuplicates) {
+    I3cTargetTable table;
+    ASSERT_TRUE(table.Add(Target(0x0A, 1)).IsOk());
+    ASSERT_TRUE(table.Add(Target(0x08, 2)).IsOk());
+    EXPECT_TRUE(table.Add(Target(0x08, 3)).IsError());  // address taken
+    EXPECT_TRUE(table.Add(Target(0x0B, 1)).IsError());  // PID taken
+    EXPECT_TRUE(table.Add(Target(0x7E, 4)).IsError());  // not assignable
+
+    auto targets = table.Targets();
+    ASSERT_EQ(targets.size(), 2u);
+    EXPECT_EQ(targets[0].dynamic_address, 0x08u);
+    EXPECT_EQ(targets[1].dynamic_address, 0x0Au);
+    EXPECT_EQ(table.FindByPid(1)->dynamic_address, 0x0Au);
+    EXPECT_FALSE(table.Find(0x09).has_value());
+
+    auto next = table.NextFreeAddress();
+    ASSERT_TRUE(next.IsOk());
+    EXPECT_EQ(next.Value(), 0x09u);
+    EXPECT_EQ(table.NextFreeAddress(0x3E).Value(), 0x3Fu);
+}
+
+TEST(I3cTargetTableTest, AnswersGetCccsFromCache) {
+    I3cTargetTable table;
+    ASSERT_TRUE(table.Add(Target(0x08, 0x046A00005118ull)).IsOk());
+
+    core::Byte buf[8] = {};
+    auto pid = table.Answer(i3c_ccc::kGetpid, 0x08, buf, sizeof(buf));
+    ASSERT_TRUE(pid.IsOk());
+    ASSERT_EQ(pid.Value(), 6u);
+    EXPECT_EQ(buf[0], 0x04);
+    EXPECT_EQ(buf[5], 0x18);
+    ASSERT_TRUE(table.Answer(i3c_ccc::kGetbcr, 0x08, buf, 1).IsOk());
+    EXPECT_EQ(buf[0], 0x27);
+    ASSERT_TRUE(table.Answer(i3c_ccc::kGetdcr, 0x08, buf, 1).IsOk());
+    EXPECT_EQ(buf[0], 0xDA);
+
+    EXPECT_EQ(table.Answer(i3c_ccc::kGetpid, 0x08, buf, 2).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    EXPECT_EQ(table.Answer(i3c_ccc::kGetbcr, 0x09, buf, 1).Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+    EXPECT_EQ(table.Answer(i3c_ccc::kGetmrl, 0x08, buf, 2).Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));  // never reported
+    EXPECT_EQ(table.Answer(0x90, 0x08, buf, 2).Error(),  // GETSTATUS
+              core::make_error_code(core::ErrorCode::kNotSupported));
+}
+
+TEST(I3cTargetTableTest, ObserveTracksSetCccs) {
+    I3cTargetTable table;
+    ASSERT_TRUE(table.Add(Target(0x08, 1)).IsOk());
+    ASSERT_TRUE(table.Add(Target(0x09, 2)).IsOk());
+
+    const core::Byte mrl[] = {0x01, 0x00};
+    table.Observe(i3c_ccc::kSetmrl, 0x09, mrl, sizeof(mrl));
+    EXPECT_EQ(table.Find(0x08)->max_read_length, 0);
+    EXPECT_EQ(table.Find(0x09)->max_read_length, 256);
+
+    const core::Byte mwl[] = {0x00, 0x40};
+    table.Observe(i3c_ccc::kSetmwlAll, 0, mwl, sizeof(mwl));
+    EXPECT_EQ(table.Find(0x08)->max_write_length, 64);
+    EXPECT_EQ(table.Find(0x09)->max_write_length, 64);
+
+    core::Byte buf[2] = {};
+    ASSERT_TRUE(table.Answer(i3c_ccc::kGetmrl, 0x09, buf, 2).IsOk());
+    EXPECT_EQ(buf[0], 0x01);
+    EXPECT_EQ(buf[1], 0x00);
+
+    const core::Byte newda[] = {0x20 << 1};
+    table.Observe(i3c_ccc::kSetnewda, 0x08, newda, sizeof(newda));
+    EXPECT_FALSE(table.Find(0x08).has_value());
+    EXPECT_EQ(table.Find(0x20)->pid, 1u);
+    EXPECT_EQ(table.Targets().back().dynamic_address, 0x20u);
+
+    table.Observe(i3c_ccc::kRstdaa, 0, nullptr, 0);
+    EXPECT_EQ(table.Size(), 0u);
+}
+
+TEST(I3cTest, DefaultTableHooksAreUnsupported) {
+    class Bare : public I3c {
+    public:
+        Device* GetDevice() override { return nullptr; }
+        core::Result<size_t> Read(core::Address, core::Byte*, size_t, bool) override {
+            return core::Result<size_t>::Ok(0);
+        }
+        core::Result<size_t> Write(core::Address, const core::Byte*, size_t,
+                                   bool) override {
+            return core::Result<size_t>::Ok(0);
+        }
+        core::Result<void> SendBroadcastCcc(uint8_t, const core::Byte*, size_t) override {
+            return core::Result<void>::Ok();
+        }
+        core::Result<void> SendDirectCcc(uint8_t, core::Address, const core::Byte*,
+                                         size_t) override {
+            return core::Result<void>::Ok();
+        }
+        core::Result<size_t> RecvDirectCcc(uint8_t, core::Address, core::Byte*,
+                                           size_t) override {
+            return core::Result<size_t>::Ok(0);
+        }
+        core::Result<void> SetFrequency(core::Frequency) override {
+            return core::Result<void>::Ok();
+        }
+    } bus;
+    EXPECT_EQ(bus.GetTargets().Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    EXPECT_EQ(bus.AssignDynamicAddresses().Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+}
+
+}  // namespace
+}  // namespace plas::hal
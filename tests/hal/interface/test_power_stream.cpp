@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/core/error.h"
+#include "plas/hal/driver/pmu3/pmu3_device.h"
+#include "plas/hal/interface/power_control.h"
+#include "plas/hal/interface/power_stream.h"
+
+namespace plas::hal {
+namespace {
+
+PowerSample MakeSample(double volts) {
+    PowerSample sample;
+    sample.voltage = core::Voltage(volts);
+    return sample;
+}
+
+// Instrument whose "continuous capture" yields a ramp: sample n reads n
+// volts and n / 1000 amps.
+class RampPowerControl : public PowerControl {
+public:
+    Device* GetDevice() override { return nullptr; }
+    core::Result<void> SetVoltage(core::Voltage) override { return core::Result<void>::Ok(); }
+    core::Result<core::Voltage> GetVoltage() override {
+        return core::Result<core::Voltage>::Ok(core::Voltage(0.0));
+    }
+    core::Result<void> SetCurrent(core::Current) override { return core::Result<void>::Ok(); }
+    core::Result<core::Current> GetCurrent() override {
+        return core::Result<core::Current>::Ok(core::Current(0.0));
+    }
+    core::Result<void> PowerOn() override { return core::Result<void>::Ok(); }
+    core::Result<void> PowerOff() override { return core::Result<void>::Ok(); }
+    core::Result<bool> IsPowerOn() override { return core::Result<bool>::Ok(true); }
+
+    core::Result<void> StartSampling(const PowerSamplingOptions& options,
+                                     PowerSampleRing& ring) override {
+        return capture_.Start(options, ring, [this](PowerSample* out, size_t max) {
+            blocks.fetch_add(1);
+            if (fail_after != 0 && next_ >= fail_after) {
+                return core::Result<size_t>::Err(core::ErrorCode::kIOError);
+            }
+            for (size_t i = 0; i < max; ++i, ++next_) {
+                out[i].voltage = core::Voltage(static_cast<double>(next_));
+                out[i].current = core::Current(static_cast<double>(next_) / 1000.0);
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            return core::Result<size_t>::Ok(max);
+        });
+    }
+    core::Result<void> StopSampling() override { return capture_.Stop(); }
+    bool IsSampling() const override { return capture_.IsRunning(); }
+
+    std::atomic<int> blocks{0};
+    uint64_t fail_after = 0;
+    PowerCapture capture_;
+
+private:
+    uint64_t next_ = 0;
+};
+
+void WaitFor(const std::function<bool()>& done) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!done() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST(PowerSampleRingTest, RoundsCapacityAndPreservesOrder) {
+    PowerSampleRing ring(5);
+    EXPECT_EQ(ring.Capacity(), 8u);
+
+    std::vector<PowerSample> in;
+    for (int i = 0; i < 6; ++i) {
+        in.push_back(MakeSample(i));
+    }
+    EXPECT_EQ(ring.Push(in.data(), in.size()), 6u);
+    EXPECT_EQ(ring.Size(), 6u);
+
+    PowerSample out[4];
+    ASSERT_EQ(ring.Pop(out, 4), 4u);
+    EXPECT_DOUBLE_EQ(out[3].voltage.Value(), 3.0);
+
+    // Wraps around the end of the slot array.
+    EXPECT_EQ(ring.Push(in.data(), in.size()), 6u);
+    ASSERT_EQ(ring.Pop(out, 4), 4u);
+    EXPECT_DOUBLE_EQ(out[0].voltage.Value(), 4.0);
+    EXPECT_DOUBLE_EQ(out[2].voltage.Value(), 0.0);
+    EXPECT_EQ(ring.Size(), 4u);
+}
+
+TEST(PowerSampleRingTest, FullRingDropsNewest) {
+    PowerSampleRing ring(4);
+    std::vector<PowerSample> in(6, MakeSample(1.0));
+    EXPECT_EQ(ring.Push(in.data(), in.size()), 4u);
+    EXPECT_EQ(ring.Dropped(), 2u);
+    EXPECT_EQ(ring.Push(in.data(), 1), 0u);
+    EXPECT_EQ(ring.Dropped(), 3u);
+}
+
+TEST(PowerCaptureTest, RejectsBadOptions) {
+    PowerSampleRing ring(16);
+    PowerSamplingOptions options;
+    options.block_samples = 32;  // larger than the ring
+    EXPECT_EQ(PowerCapture::Validate(options, ring).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    options.block_samples = 8;
+    options.rate_hz = 0;
+    EXPECT_TRUE(PowerCapture::Validate(options, ring).IsError());
+    options.rate_hz = 1000;
+    EXPECT_TRUE(PowerCapture::Validate(options, ring).IsOk());
+
+    PowerCapture capture;
+    EXPECT_TRUE(capture.Start(options, ring, nullptr).IsError());
+    EXPECT_FALSE(capture.IsRunning());
+    EXPECT_TRUE(capture.Stop().IsOk());
+}
+
+TEST(PowerCaptureTest, StreamsTimestampedBlocks) {
+    RampPowerControl pmu;
+    PowerSampleRing ring(4096);
+    PowerSamplingOptions options;
+    options.rate_hz = 10000;
+    options.block_samples = 50;
+    std::atomic<size_t> notified{0};
+    options.on_block = [&](size_t n) { notified.fetch_add(n); };
+
+    ASSERT_TRUE(pmu.StartSampling(options, ring).IsOk());
+    EXPECT_TRUE(pmu.IsSampling());
+    EXPECT_EQ(pmu.StartSampling(options, ring).Error(),
+              core::make_error_code(core::ErrorCode::kAlreadyOpen));
+
+    std::vector<PowerSample> got;
+    PowerSample buf[64];
+    WaitFor([&] {
+        size_t n = ring.Pop(buf, 64);
+        got.insert(got.end(), buf, buf + n);
+        return got.size() >= 500;
+    });
+    ASSERT_TRUE(pmu.StopSampling().IsOk());
+    EXPECT_FALSE(pmu.IsSampling());
+    for (size_t n; (n = ring.Pop(buf, 64)) > 0;) {
+        got.insert(got.end(), buf, buf + n);
+    }
+
+    ASSERT_GE(got.size(), 500u);
+    EXPECT_EQ(got.size() % 50, 0u);  // whole blocks only
+    EXPECT_EQ(pmu.capture_.SampleCount(), got.size());
+    EXPECT_EQ(notified.load(), got.size());
+    EXPECT_EQ(static_cast<size_t>(pmu.blocks.load()), got.size() / 50);
+    for (size_t i = 0; i < got.size(); ++i) {
+        ASSERT_DOUBLE_EQ(got[i].voltage.Value(), static_cast<double>(i));
+        // Sample clock: 100 us apart at 10 kHz, independent of delivery.
+        ASSERT_EQ(got[i].timestamp_ns - got[0].timestamp_ns, i * 100'000u);
+    }
+}
+
+TEST(PowerCaptureTest, ReaderErrorEndsCaptureAndIsReported) {
+    RampPowerControl pmu;
+    pmu.fail_after = 20;
+    PowerSampleRing ring(64);
+    PowerSamplingOptions options;
+    options.block_samples = 10;
+
+    ASSERT_TRUE(pmu.StartSampling(options, ring).IsOk());
+    WaitFor([&] { return pmu.blocks.load() >= 3; });
+    EXPECT_TRUE(pmu.IsSampling());  // until stopped
+    EXPECT_EQ(pmu.StopSampling().Error(),
+              core::make_error_code(core::ErrorCode::kIOError));
+    EXPECT_EQ(ring.Size(), 20u);
+
+    // Restartable after a failure.
+    pmu.fail_after = 0;
+    ASSERT_TRUE(pmu.StartSampling(options, ring).IsOk());
+    EXPECT_TRUE(pmu.StopSampling().IsOk());
+}
+
+TEST(PowerControlTest, SamplingIsUnsupportedByDefault) {
+    class Plain : public RampPowerControl {
+    public:
+        core::Result<void> StartSampling(const PowerSamplingOptions& options,
+                                         PowerSampleRing& ring) override {
+            return PowerControl::StartSampling(options, ring);
+        }
+        core::Result<void> StopSampling() override { return PowerControl::StopSampling(); }
+        bool IsSampling() const override { return PowerControl::IsSampling(); }
+    } plain;
+    PowerSampleRing ring(64);
+    EXPECT_EQ(plain.StartSampling({}, ring).Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    EXPECT_FALSE(plain.IsSampling());
+    EXPECT_TRUE(plain.StopSampling().IsOk());
+}
+
+TEST(PowerControlTest, Pmu3RequiresOpenAndValidOptions) {
+    config::DeviceEntry entry;
+    entry.nickname = "pmu";
+    entry.uri = "pmu3://usb:PMU3-001";
+    entry.driver = "pmu3";
+    driver::Pmu3Device pmu(entry);
+    PowerSampleRing ring(64);
+    PowerControl& power = pmu;
+
+    EXPECT_EQ(power.StartSampling({}, ring).Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    ASSERT_TRUE(pmu.Init().IsOk());
+    ASSERT_TRUE(pmu.Open().IsOk());
+
+    PowerSamplingOptions options;
+    options.rate_hz = 0;
+    EXPECT_EQ(power.StartSampling(options, ring).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    // No SDK in this build: the capture cannot be armed.
+    EXPECT_EQ(power.StartSampling({}, ring).Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    EXPECT_FALSE(power.IsSampling());
+    EXPECT_TRUE(power.StopSampling().IsOk());
+}
+
+}  // namespace
+}  // namespace plas::hal
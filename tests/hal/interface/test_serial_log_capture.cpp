@@ -0,0 +1,371 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/serial_log_capture.h"
+
+namespace plas::hal {
+namespace {
+
+namespace fs = std::filesystem;
+using std::chrono::milliseconds;
+
+// Unbuffered console: Read() hands out scripted chunks, 0 when idle.
+class ScriptedSerial : public Serial {
+public:
+    Device* GetDevice() override { return nullptr; }
+    core::Result<size_t> Read(core::Byte* data, size_t length) override {
+        std::lock_guard lock(mutex_);
+        if (chunks_.empty()) {
+            return core::Result<size_t>::Ok(0);
+        }
+        std::string& front = chunks_.front();
+        size_t n = std::min(length, front.size());
+        std::memcpy(data, front.data(), n);
+        front.erase(0, n);
+        if (front.empty()) {
+            chunks_.pop_front();
+        }
+        return core::Result<size_t>::Ok(n);
+    }
+    core::Result<size_t> Write(const core::Byte*, size_t length) override {
+        return core::Result<size_t>::Ok(length);
+    }
+    core::Result<void> SetBaudRate(uint32_t) override { return core::Result<void>::Ok(); }
+    uint32_t GetBaudRate() const override { return 115200; }
+    core::Result<void> Flush() override { return core::Result<void>::Ok(); }
+
+    void Feed(const std::string& chunk) {
+        std::lock_guard lock(mutex_);
+        chunks_.push_back(chunk);
+    }
+    bool Idle() {
+        std::lock_guard lock(mutex_);
+        return chunks_.empty();
+    }
+
+private:
+    std::mutex mutex_;
+    std::deque<std::string> chunks_;
+};
+
+// Buffered UART: ReadFor() blocks until data or timeout.
+class BufferedUart : public Uart {
+public:
+    Device* GetDevice() override { return nullptr; }
+    core::Result<size_t> Read(core::Byte*, size_t) override {
+        plain_reads_++;
+        return core::Result<size_t>::Err(core::ErrorCode::kIOError);
+    }
+    core::Result<size_t> Write(const core::Byte*, size_t length) override {
+        return core::Result<size_t>::Ok(length);
+    }
+    core::Result<void> SetBaudRate(uint32_t) override { return core::Result<void>::Ok(); }
+    uint32_t GetBaudRate() const override { return 115200; }
+    core::Result<void> SetParity(Parity) override { return core::Result<void>::Ok(); }
+
+    core::Result<size_t> ReadFor(core::Byte* data, size_t length,
+                                 milliseconds timeout) override {
+        std::unique_lock lock(mutex_);
+        if (!cv_.wait_for(lock, timeout, [&] { return !pending_.empty(); })) {
+            return core::Result<size_t>::Err(core::ErrorCode::kTimeout);
+        }
+        size_t n = std::min(length, pending_.size());
+        std::memcpy(data, pending_.data(), n);
+        pending_.erase(0, n);
+        return core::Result<size_t>::Ok(n);
+    }
+
+    void Feed(const std::string& text) {
+        {
+            std::lock_guard lock(mutex_);
+            pending_ += text;
+        }
+        cv_.notify_one();
+    }
+    bool Idle() {
+        std::lock_guard lock(mutex_);
+        return pending_.empty();
+    }
+
+    std::atomic<int> plain_reads_{0};
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::string pending_;
+};
+
+template <typename Pred>
+bool WaitUntil(Pred pred) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    return true;
+}
+
+std::string ReadFile(const fs::path& path) {
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+TEST(LinePatternMatcherTest, FindsOverlappingPatterns) {
+    LinePatternMatcher matcher({"he", "she", "his", "hers"});
+    std::vector<uint32_t> hits;
+    EXPECT_EQ(matcher.Match("ushers", hits), 3u);
+    EXPECT_EQ(hits, (std::vector<uint32_t>{0, 1, 3}));
+    EXPECT_EQ(matcher.Match("this", hits), 1u);
+    EXPECT_EQ(hits, (std::vector<uint32_t>{2}));
+    EXPECT_EQ(matcher.Match("HE SHE", hits), 0u);
+    EXPECT_EQ(matcher.Match("hehehe", hits), 1u);  // reported once per line
+}
+
+TEST(LinePatternMatcherTest, BootMarkers) {
+    LinePatternMatcher matcher({"PANIC", "READY", "\xff\xfe"});
+    std::vector<uint32_t> hits;
+    EXPECT_EQ(matcher.Match("[    1.234] Kernel PANIC - not syncing", hits), 1u);
+    EXPECT_EQ(hits[0], 0u);
+    EXPECT_EQ(matcher.Match("PANICREADY", hits), 2u);
+    EXPECT_EQ(matcher.Match("bin \xff\xfe tail", hits), 1u);
+    EXPECT_EQ(hits[0], 2u);
+    EXPECT_EQ(matcher.Match("PANI", hits), 0u);
+
+    LinePatternMatcher empty;
+    EXPECT_EQ(empty.Match("anything", hits), 0u);
+}
+
+TEST(SerialLogCaptureTest, FindNewlineMatchesScalar) {
+    std::vector<core::Byte> buf(100, 'x');
+    const core::Byte* b = buf.data();
+    EXPECT_EQ(SerialLogCapture::FindNewline(b, b + buf.size()), b + buf.size());
+    for (size_t pos = 0; pos < buf.size(); ++pos) {
+        buf[pos] = '\n';
+        for (size_t start : {size_t{0}, size_t{1}, size_t{7}, size_t{17}}) {
+            if (start > pos) {
+                continue;
+            }
+            EXPECT_EQ(SerialLogCapture::FindNewline(b + start, b + buf.size()), b + pos)
+                << pos << " from " << start;
+        }
+        EXPECT_EQ(SerialLogCapture::FindNewline(b, b + pos), b + pos);  // end excluded
+        buf[pos] = 'x';
+    }
+}
+
+TEST(SerialLogCaptureTest, ValidateRejectsBadOptions) {
+    SerialLogCaptureOptions options;
+    EXPECT_TRUE(SerialLogCapture::Validate(options).IsOk());
+    options.triggers = {"READY", ""};
+    EXPECT_EQ(SerialLogCapture::Validate(options).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    options.triggers = {"READY"};
+    options.max_line_length = 0;
+    EXPECT_TRUE(SerialLogCapture::Validate(options).IsError());
+    options.max_line_length = 80;
+    options.max_files = 0;
+    EXPECT_TRUE(SerialLogCapture::Validate(options).IsError());
+}
+
+TEST(SerialLogCaptureTest, SplitsLinesAcrossReadsAndFiresTriggers) {
+    ScriptedSerial serial;
+    std::mutex mutex;
+    std::vector<LogLine> lines;
+    std::vector<std::string> fired;
+
+    SerialLogCaptureOptions options;
+    options.triggers = {"PANIC", "READY"};
+    options.on_line = [&](const LogLine& line) {
+        std::lock_guard lock(mutex);
+        lines.push_back(line);
+    };
+    options.on_trigger = [&](const LogLine& line) {
+        std::lock_guard lock(mutex);
+        fired.push_back(line.text);
+    };
+
+    SerialLogCapture capture;
+    ASSERT_TRUE(capture.Start(serial, options).IsOk());
+    EXPECT_TRUE(capture.IsRunning());
+    EXPECT_EQ(capture.Start(serial, options).Error(),
+              core::make_error_code(core::ErrorCode::kAlreadyOpen));
+
+    serial.Feed("U-Boot 2024.01\r\nLoading ker");
+    serial.Feed("nel...\nsystem READY");
+    serial.Feed("\n");
+    ASSERT_TRUE(WaitUntil([&] { return capture.Stats().lines == 3; }));
+    serial.Feed("tail without newline");
+    ASSERT_TRUE(WaitUntil([&] { return serial.Idle(); }));
+    ASSERT_TRUE(capture.Stop().IsOk());
+    EXPECT_FALSE(capture.IsRunning());
+
+    ASSERT_EQ(lines.size(), 4u);
+    EXPECT_EQ(lines[0].text, "U-Boot 2024.01");
+    EXPECT_EQ(lines[1].text, "Loading kernel...");
+    EXPECT_EQ(lines[2].text, "system READY");
+    EXPECT_EQ(lines[2].triggers, (std::vector<uint32_t>{1}));
+    EXPECT_EQ(lines[3].text, "tail without newline");  // flushed by Stop()
+    for (size_t i = 0; i < lines.size(); ++i) {
+        EXPECT_EQ(lines[i].sequence, i);
+    }
+    EXPECT_LE(lines[0].timestamp_ns, lines[2].timestamp_ns);
+    EXPECT_EQ(fired, (std::vector<std::string>{"system READY"}));
+    EXPECT_EQ(capture.TriggerCount(0), 0u);
+    EXPECT_EQ(capture.TriggerCount(1), 1u);
+    EXPECT_EQ(capture.TriggerCount(7), 0u);
+
+    auto stats = capture.Stats();
+    EXPECT_EQ(stats.bytes_received, 67u);
+    EXPECT_EQ(stats.bytes_dropped, 0u);
+    EXPECT_EQ(stats.trigger_lines, 1u);
+}
+
+TEST(SerialLogCaptureTest, UsesReadForAndTruncatesLongLines) {
+    BufferedUart uart;
+    std::mutex mutex;
+    std::vector<LogLine> lines;
+    SerialLogCaptureOptions options;
+    options.max_line_length = 8;
+    options.on_line = [&](const LogLine& line) {
+        std::lock_guard lock(mutex);
+        lines.push_back(line);
+    };
+
+    SerialLogCapture capture;
+    ASSERT_TRUE(capture.Start(uart, options).IsOk());
+    uart.Feed("0123456789abcdefXY\nok\n");
+    ASSERT_TRUE(WaitUntil([&] { return capture.Stats().lines == 4; }));
+    ASSERT_TRUE(capture.Stop().IsOk());
+
+    ASSERT_EQ(lines.size(), 4u);
+    EXPECT_EQ(lines[0].text, "01234567");
+    EXPECT_TRUE(lines[0].truncated);
+    EXPECT_EQ(lines[1].text, "89abcdef");
+    EXPECT_TRUE(lines[1].truncated);
+    EXPECT_EQ(lines[2].text, "XY");
+    EXPECT_FALSE(lines[2].truncated);
+    EXPECT_EQ(lines[3].text, "ok");
+    EXPECT_EQ(capture.Stats().truncated_lines, 2u);
+    EXPECT_EQ(uart.plain_reads_.load(), 0);  // never fell back to Read()
+}
+
+TEST(SerialLogCaptureTest, SlowTriggerDoesNotStallReceive) {
+    BufferedUart uart;
+    std::atomic<bool> release{false};
+    SerialLogCaptureOptions options;
+    options.triggers = {"PANIC"};
+    options.on_trigger = [&](const LogLine&) {
+        while (!release.load()) {
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+    };
+
+    SerialLogCapture capture;
+    ASSERT_TRUE(capture.Start(uart, options).IsOk());
+    uart.Feed("Kernel PANIC\n");
+    ASSERT_TRUE(WaitUntil([&] { return capture.Stats().trigger_lines == 1; }));
+
+    // The matcher thread is stuck in the callback; reception carries on.
+    std::string burst;
+    for (int i = 0; i < 200; ++i) {
+        burst += "line " + std::to_string(i) + "\n";
+    }
+    uart.Feed(burst);
+    EXPECT_TRUE(WaitUntil([&] { return uart.Idle(); }));
+    EXPECT_EQ(capture.Stats().bytes_received, 13u + burst.size());
+    EXPECT_EQ(capture.Stats().lines, 1u);
+
+    release = true;
+    ASSERT_TRUE(WaitUntil([&] { return capture.Stats().lines == 201; }));
+    ASSERT_TRUE(capture.Stop().IsOk());
+    EXPECT_EQ(capture.Stats().bytes_dropped, 0u);
+}
+
+class SerialLogFileTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() /
+               ("plas_log_capture_" + std::to_string(::getpid()));
+        fs::remove_all(dir_);
+        fs::create_directories(dir_);
+    }
+    void TearDown() override { fs::remove_all(dir_); }
+
+    fs::path dir_;
+};
+
+TEST_F(SerialLogFileTest, WritesTimestampedRecords) {
+    ScriptedSerial serial;
+    SerialLogCaptureOptions options;
+    options.file_path = (dir_ / "dut0.log").string();
+    SerialLogCapture capture;
+    ASSERT_TRUE(capture.Start(serial, options).IsOk());
+    serial.Feed("first\nsecond\n");
+    ASSERT_TRUE(WaitUntil([&] { return capture.Stats().lines == 2; }));
+    ASSERT_TRUE(capture.Stop().IsOk());
+
+    const std::string text = ReadFile(dir_ / "dut0.log");
+    std::istringstream in(text);
+    std::string line;
+    ASSERT_TRUE(std::getline(in, line));
+    ASSERT_EQ(line.front(), '[');
+    EXPECT_NE(line.find("] first"), std::string::npos);
+    ASSERT_TRUE(std::getline(in, line));
+    EXPECT_NE(line.find("] second"), std::string::npos);
+    EXPECT_FALSE(std::getline(in, line));
+}
+
+TEST_F(SerialLogFileTest, RotatesBySize) {
+    ScriptedSerial serial;
+    SerialLogCaptureOptions options;
+    options.file_path = (dir_ / "dut0.log").string();
+    options.max_file_bytes = 100;
+    options.max_files = 3;
+    SerialLogCapture capture;
+    ASSERT_TRUE(capture.Start(serial, options).IsOk());
+    for (int i = 0; i < 40; ++i) {
+        serial.Feed("record " + std::to_string(i) + "\n");
+    }
+    ASSERT_TRUE(WaitUntil([&] { return capture.Stats().lines == 40; }));
+    ASSERT_TRUE(capture.Stop().IsOk());
+
+    EXPECT_TRUE(fs::exists(dir_ / "dut0.log"));
+    EXPECT_TRUE(fs::exists(dir_ / "dut0.log.1"));
+    EXPECT_TRUE(fs::exists(dir_ / "dut0.log.2"));
+    EXPECT_FALSE(fs::exists(dir_ / "dut0.log.3"));
+    EXPECT_LE(fs::file_size(dir_ / "dut0.log"), 100u);
+    EXPECT_LE(fs::file_size(dir_ / "dut0.log.1"), 100u);
+    EXPECT_NE(ReadFile(dir_ / "dut0.log").find("record 39"), std::string::npos);
+}
+
+TEST_F(SerialLogFileTest, UnwritableFileFailsStart) {
+    ScriptedSerial serial;
+    SerialLogCaptureOptions options;
+    options.file_path = (dir_ / "missing" / "dut0.log").string();
+    SerialLogCapture capture;
+    EXPECT_EQ(capture.Start(serial, options).Error(),
+              core::make_error_code(core::ErrorCode::kIOError));
+    EXPECT_FALSE(capture.IsRunning());
+}
+
+}  // namespace
+}  // namespace plas::hal
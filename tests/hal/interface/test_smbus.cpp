@@ -0,0 +1,283 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/interface_kind.h"
+#include "plas/hal/interface/smbus.h"
+
+namespace plas::hal {
+namespace {
+
+constexpr core::Address kAddr = 0x40;
+constexpr uint8_t kProcessCall = 0x30;
+constexpr uint8_t kBlockProcessCall = 0x31;
+
+uint8_t BitwisePec(const std::vector<core::Byte>& data) {
+    uint8_t crc = 0;
+    for (auto byte : data) {
+        crc = static_cast<uint8_t>(crc ^ byte);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = static_cast<uint8_t>((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+        }
+    }
+    return crc;
+}
+
+// SMBus target on plain I2c: byte/word registers, a block per command, a
+// process call returning the complement and a block process call
+// returning the block reversed. Responses carry a PEC when `pec` is set;
+// reads past a block clock out 0xFF, as from a released bus.
+class FakeSmBusTarget : public I2c {
+public:
+    Device* GetDevice() override { return nullptr; }
+
+    core::Result<size_t> Read(core::Address, core::Byte*, size_t, bool) override {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    core::Result<size_t> Write(core::Address addr, const core::Byte* data, size_t length,
+                               bool) override {
+        if (addr != kAddr) {
+            return core::Result<size_t>::Err(core::ErrorCode::kIOError);
+        }
+        last_write.assign(data, data + length);
+        for (size_t i = 1; i < length; ++i) {
+            regs[(data[0] + i - 1) & 0xFF] = data[i];
+        }
+        return core::Result<size_t>::Ok(length);
+    }
+
+    core::Result<size_t> WriteRead(core::Address addr, const core::Byte* write_data,
+                                   size_t write_len, core::Byte* read_data,
+                                   size_t read_len) override {
+        if (addr != kAddr) {
+            return core::Result<size_t>::Err(core::ErrorCode::kIOError);
+        }
+        write_reads++;
+        std::vector<core::Byte> write(write_data, write_data + write_len);
+        auto response = Response(write, read_len - (pec ? 1 : 0));
+        if (pec) {
+            std::vector<core::Byte> covered = {static_cast<core::Byte>(kAddr << 1)};
+            covered.insert(covered.end(), write.begin(), write.end());
+            covered.push_back(static_cast<core::Byte>((kAddr << 1) | 1));
+            covered.insert(covered.end(), response.begin(), response.end());
+            response.push_back(static_cast<core::Byte>(BitwisePec(covered) ^ corrupt));
+        }
+        for (size_t i = 0; i < read_len; ++i) {
+            read_data[i] = i < response.size() ? response[i] : 0xFF;
+        }
+        return core::Result<size_t>::Ok(read_len);
+    }
+
+    core::Result<void> SetBitrate(uint32_t) override { return core::Result<void>::Ok(); }
+    uint32_t GetBitrate() const override { return 100000; }
+
+    std::array<core::Byte, 256> regs{};
+    std::map<uint8_t, std::vector<core::Byte>> blocks;
+    std::vector<core::Byte> last_write;
+    bool pec = false;
+    uint8_t corrupt = 0;  ///< XORed into the PEC
+    int write_reads = 0;
+
+private:
+    std::vector<core::Byte> Response(const std::vector<core::Byte>& write, size_t length) {
+        uint8_t command = write[0];
+        if (command == kProcessCall) {
+            return {static_cast<core::Byte>(~write[1]), static_cast<core::Byte>(~write[2])};
+        }
+        if (command == kBlockProcessCall) {
+            std::vector<core::Byte> out(write.begin() + 1, write.end());
+            std::reverse(out.begin() + 1, out.end());
+            return out;
+        }
+        auto block = blocks.find(command);
+        if (block != blocks.end()) {
+            std::vector<core::Byte> out = {static_cast<core::Byte>(block->second.size())};
+            out.insert(out.end(), block->second.begin(), block->second.end());
+            return out;
+        }
+        std::vector<core::Byte> out(length);
+        for (size_t i = 0; i < length; ++i) {
+            out[i] = regs[(command + i) & 0xFF];
+        }
+        return out;
+    }
+};
+
+std::vector<core::Byte> Pattern(size_t length) {
+    std::vector<core::Byte> data(length);
+    for (size_t i = 0; i < length; ++i) {
+        data[i] = static_cast<core::Byte>(i * 7 + 1);
+    }
+    return data;
+}
+
+// ---------------------------------------------------------------------------
+// PEC
+// ---------------------------------------------------------------------------
+
+TEST(SmBusPecTest, CheckValue) {
+    const char* check = "123456789";
+    EXPECT_EQ(SmBusPec(reinterpret_cast<const core::Byte*>(check), 9), 0xF4);
+}
+
+TEST(SmBusPecTest, MatchesBitwiseCrcAndContinues) {
+    auto data = Pattern(300);
+    EXPECT_EQ(SmBusPec(data.data(), data.size()), BitwisePec(data));
+    uint8_t head = SmBusPec(data.data(), 100);
+    EXPECT_EQ(SmBusPec(data.data() + 100, 200, head), BitwisePec(data));
+    EXPECT_EQ(SmBusPec(nullptr, 0, 0x5A), 0x5A);
+}
+
+// ---------------------------------------------------------------------------
+// Protocol over I2cSmBus
+// ---------------------------------------------------------------------------
+
+TEST(SmBusTest, InterfaceKind) {
+    EXPECT_EQ(InterfaceKindOf<SmBus>::value, InterfaceKind::kSmBus);
+    FakeSmBusTarget target;
+    I2cSmBus smbus(target);
+    EXPECT_EQ(smbus.InterfaceName(), "SmBus");
+}
+
+TEST(SmBusTest, ByteAndWordData) {
+    FakeSmBusTarget target;
+    I2cSmBus smbus(target);
+    ASSERT_TRUE(smbus.WriteByteData(kAddr, 0x10, 0xA5).IsOk());
+    EXPECT_EQ(target.last_write, (std::vector<core::Byte>{0x10, 0xA5}));
+    ASSERT_TRUE(smbus.WriteWordData(kAddr, 0x20, 0x1234).IsOk());
+    EXPECT_EQ(target.last_write, (std::vector<core::Byte>{0x20, 0x34, 0x12}));
+
+    auto byte = smbus.ReadByteData(kAddr, 0x10);
+    ASSERT_TRUE(byte.IsOk());
+    EXPECT_EQ(byte.Value(), 0xA5);
+    auto word = smbus.ReadWordData(kAddr, 0x20);
+    ASSERT_TRUE(word.IsOk());
+    EXPECT_EQ(word.Value(), 0x1234);
+}
+
+TEST(SmBusTest, WritesAppendPec) {
+    FakeSmBusTarget target;
+    I2cSmBus smbus(target);
+    ASSERT_TRUE(smbus.WriteWordData(kAddr, 0x20, 0xBEEF, true).IsOk());
+    ASSERT_EQ(target.last_write.size(), 4u);
+    EXPECT_EQ(target.last_write[3], BitwisePec({kAddr << 1, 0x20, 0xEF, 0xBE}));
+}
+
+TEST(SmBusTest, ReadsCheckPec) {
+    FakeSmBusTarget target;
+    target.pec = true;
+    target.regs[0x08] = 0x77;
+    I2cSmBus smbus(target);
+    auto byte = smbus.ReadByteData(kAddr, 0x08, true);
+    ASSERT_TRUE(byte.IsOk());
+    EXPECT_EQ(byte.Value(), 0x77);
+
+    target.corrupt = 0x01;
+    auto bad = smbus.ReadByteData(kAddr, 0x08, true);
+    ASSERT_TRUE(bad.IsError());
+    EXPECT_EQ(bad.Error(), core::make_error_code(core::ErrorCode::kDataLoss));
+}
+
+TEST(SmBusTest, ProcessCall) {
+    FakeSmBusTarget target;
+    target.pec = true;
+    I2cSmBus smbus(target);
+    auto result = smbus.ProcessCall(kAddr, kProcessCall, 0x00FF, true);
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value(), 0xFF00);
+}
+
+TEST(SmBusTest, ShortBlockReadIsOneTransaction) {
+    FakeSmBusTarget target;
+    target.pec = true;
+    target.blocks[0x9A] = Pattern(12);
+    I2cSmBus smbus(target);
+    std::array<core::Byte, SmBus::kMaxBlock> block{};
+    auto result = smbus.BlockRead(kAddr, 0x9A, block.data(), block.size(), true);
+    ASSERT_TRUE(result.IsOk());
+    ASSERT_EQ(result.Value(), 12u);
+    EXPECT_TRUE(std::equal(block.begin(), block.begin() + 12, Pattern(12).begin()));
+    EXPECT_EQ(target.write_reads, 1);
+}
+
+TEST(SmBusTest, LongBlockReadRereadsOnce) {
+    FakeSmBusTarget target;
+    target.pec = true;
+    target.blocks[0x9A] = Pattern(200);
+    I2cSmBus smbus(target);
+    std::array<core::Byte, SmBus::kMaxBlock> block{};
+    auto result = smbus.BlockRead(kAddr, 0x9A, block.data(), block.size(), true);
+    ASSERT_TRUE(result.IsOk());
+    ASSERT_EQ(result.Value(), 200u);
+    EXPECT_TRUE(std::equal(block.begin(), block.begin() + 200, Pattern(200).begin()));
+    EXPECT_EQ(target.write_reads, 2);
+
+    // A longer read-ahead covers it in one.
+    I2cSmBus wide(target, SmBus::kMaxBlock);
+    target.write_reads = 0;
+    ASSERT_TRUE(wide.BlockRead(kAddr, 0x9A, block.data(), block.size(), true).IsOk());
+    EXPECT_EQ(target.write_reads, 1);
+}
+
+TEST(SmBusTest, BlockReadErrors) {
+    FakeSmBusTarget target;
+    target.pec = true;
+    target.blocks[0x9A] = Pattern(16);
+    I2cSmBus smbus(target);
+    std::array<core::Byte, 8> small{};
+    auto overflow = smbus.BlockRead(kAddr, 0x9A, small.data(), small.size(), true);
+    ASSERT_TRUE(overflow.IsError());
+    EXPECT_EQ(overflow.Error(), core::make_error_code(core::ErrorCode::kOverflow));
+
+    std::array<core::Byte, 32> block{};
+    target.corrupt = 0x80;
+    auto bad = smbus.BlockRead(kAddr, 0x9A, block.data(), block.size(), true);
+    ASSERT_TRUE(bad.IsError());
+    EXPECT_EQ(bad.Error(), core::make_error_code(core::ErrorCode::kDataLoss));
+
+    auto nack = smbus.BlockRead(0x41, 0x9A, block.data(), block.size());
+    ASSERT_TRUE(nack.IsError());
+    EXPECT_EQ(nack.Error(), core::make_error_code(core::ErrorCode::kIOError));
+}
+
+TEST(SmBusTest, BlockWrite) {
+    FakeSmBusTarget target;
+    I2cSmBus smbus(target);
+    auto data = Pattern(5);
+    ASSERT_TRUE(smbus.BlockWrite(kAddr, 0x50, data.data(), data.size(), true).IsOk());
+    std::vector<core::Byte> expected = {0x50, 5};
+    expected.insert(expected.end(), data.begin(), data.end());
+    std::vector<core::Byte> covered = {kAddr << 1};
+    covered.insert(covered.end(), expected.begin(), expected.end());
+    expected.push_back(BitwisePec(covered));
+    EXPECT_EQ(target.last_write, expected);
+
+    auto too_long = Pattern(SmBus::kMaxBlock + 1);
+    auto result = smbus.BlockWrite(kAddr, 0x50, too_long.data(), too_long.size());
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
+TEST(SmBusTest, BlockProcessCall) {
+    FakeSmBusTarget target;
+    target.pec = true;
+    I2cSmBus smbus(target);
+    auto data = Pattern(6);
+    std::array<core::Byte, 32> reply{};
+    auto result = smbus.BlockProcessCall(kAddr, kBlockProcessCall, data.data(), data.size(),
+                                         reply.data(), reply.size(), true);
+    ASSERT_TRUE(result.IsOk());
+    ASSERT_EQ(result.Value(), 6u);
+    EXPECT_TRUE(std::equal(reply.begin(), reply.begin() + 6, data.rbegin()));
+    EXPECT_EQ(target.write_reads, 1);
+}
+
+}  // namespace
+}  // namespace plas::hal
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/interface_kind.h"
+#include "plas/hal/interface/spi.h"
+
+namespace plas::hal {
+namespace {
+
+// Records every Exchange(); reads return 0xA0, 0xA1, ...
+class RecordingSpi : public Spi {
+public:
+    struct Call {
+        std::vector<core::Byte> write;
+        size_t length = 0;
+        bool read = false;
+        bool end = false;
+    };
+
+    Device* GetDevice() override { return nullptr; }
+
+    core::Result<size_t> Exchange(const core::Byte* write, core::Byte* read,
+                                  size_t length, bool end) override {
+        Call call;
+        if (write != nullptr) {
+            call.write.assign(write, write + length);
+        }
+        call.length = length;
+        call.read = read != nullptr;
+        call.end = end;
+        calls.push_back(call);
+        for (size_t i = 0; read != nullptr && i < length; ++i) {
+            read[i] = static_cast<core::Byte>(0xA0 + i);
+        }
+        return core::Result<size_t>::Ok(length);
+    }
+
+    core::Result<void> SetClock(core::Frequency freq) override {
+        clock = freq;
+        return core::Result<void>::Ok();
+    }
+    core::Frequency GetClock() const override { return clock; }
+    core::Result<void> SetMode(SpiMode) override { return core::Result<void>::Ok(); }
+
+    std::vector<Call> calls;
+    core::Frequency clock{1000000};
+};
+
+TEST(SpiTest, InterfaceKind) {
+    EXPECT_EQ(InterfaceKindOf<Spi>::value, InterfaceKind::kSpi);
+    RecordingSpi spi;
+    EXPECT_EQ(spi.InterfaceName(), "Spi");
+}
+
+TEST(SpiTest, EncodesHeaderMsbFirst) {
+    SpiCommand command;
+    command.opcode = 0x6B;
+    command.address = 0x01234567;
+    command.address_bytes = 4;
+    command.dummy_bytes = 1;
+    std::array<core::Byte, kSpiMaxCommandHeader> header{};
+    auto n = EncodeSpiCommandHeader(command, header.data());
+    ASSERT_TRUE(n.IsOk());
+    ASSERT_EQ(n.Value(), 6u);
+    EXPECT_EQ((std::vector<core::Byte>(header.begin(), header.begin() + 6)),
+              (std::vector<core::Byte>{0x6B, 0x01, 0x23, 0x45, 0x67, 0xFF}));
+
+    command.address_bytes = 3;
+    command.dummy_bytes = 0;
+    ASSERT_EQ(EncodeSpiCommandHeader(command, header.data()).Value(), 4u);
+    EXPECT_EQ(header[1], 0x23);
+}
+
+TEST(SpiTest, RejectsMalformedCommands) {
+    std::array<core::Byte, kSpiMaxCommandHeader> header{};
+    core::Byte data[4] = {};
+
+    SpiCommand bad_address;
+    bad_address.address_bytes = 2;
+    EXPECT_EQ(EncodeSpiCommandHeader(bad_address, header.data()).Error(),
+              core::ErrorCode::kInvalidArgument);
+
+    SpiCommand both;
+    both.write = data;
+    both.read = data;
+    both.length = sizeof(data);
+    EXPECT_EQ(EncodeSpiCommandHeader(both, header.data()).Error(),
+              core::ErrorCode::kInvalidArgument);
+
+    SpiCommand no_buffer;
+    no_buffer.length = 4;
+    EXPECT_EQ(EncodeSpiCommandHeader(no_buffer, header.data()).Error(),
+              core::ErrorCode::kInvalidArgument);
+
+    SpiCommand bad_lines;
+    bad_lines.lines = static_cast<SpiLines>(3);
+    EXPECT_EQ(EncodeSpiCommandHeader(bad_lines, header.data()).Error(),
+              core::ErrorCode::kInvalidArgument);
+}
+
+TEST(SpiTest, DefaultCommandHoldsChipSelectAcrossPhases) {
+    RecordingSpi spi;
+    core::Byte id[3] = {};
+    SpiCommand read_id;
+    read_id.opcode = 0x9F;
+    read_id.read = id;
+    read_id.length = sizeof(id);
+    auto n = spi.Command(read_id);
+    ASSERT_TRUE(n.IsOk());
+    EXPECT_EQ(n.Value(), 3u);
+    ASSERT_EQ(spi.calls.size(), 2u);
+    EXPECT_EQ(spi.calls[0].write, std::vector<core::Byte>{0x9F});
+    EXPECT_FALSE(spi.calls[0].end);
+    EXPECT_TRUE(spi.calls[1].read);
+    EXPECT_TRUE(spi.calls[1].end);
+    EXPECT_EQ(id[2], 0xA2);
+}
+
+TEST(SpiTest, DefaultCommandWithoutDataEndsAfterHeader) {
+    RecordingSpi spi;
+    SpiCommand write_enable;
+    write_enable.opcode = 0x06;
+    ASSERT_EQ(spi.Command(write_enable).Value(), 0u);
+    ASSERT_EQ(spi.calls.size(), 1u);
+    EXPECT_TRUE(spi.calls[0].end);
+}
+
+TEST(SpiTest, DefaultCommandRejectsMultiLineData) {
+    RecordingSpi spi;
+    core::Byte data[16] = {};
+    SpiCommand quad_read;
+    quad_read.opcode = 0x6B;
+    quad_read.address_bytes = 3;
+    quad_read.dummy_bytes = 1;
+    quad_read.lines = SpiLines::kQuad;
+    quad_read.read = data;
+    quad_read.length = sizeof(data);
+    EXPECT_EQ(spi.Command(quad_read).Error(), core::ErrorCode::kNotSupported);
+    EXPECT_TRUE(spi.calls.empty());
+}
+
+}  // namespace
+}  // namespace plas::hal
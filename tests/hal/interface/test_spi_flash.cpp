@@ -0,0 +1,290 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/spi.h"
+#include "plas/hal/interface/spi_flash.h"
+
+namespace plas::hal {
+namespace {
+
+constexpr std::size_t kSize = 256 * 1024;
+constexpr uint32_t kJedecId = 0xEF4012;  // 256 KiB
+
+// SPI-NOR part on Spi::Command: JEDEC ID, status (busy for `busy_polls`
+// reads after every program or erase), write enable, page program with
+// page wrap (bits only cleared), sector erase and fast reads.
+class FakeSpiNor : public Spi {
+public:
+    FakeSpiNor() : memory(kSize, 0xFF) {}
+
+    Device* GetDevice() override { return nullptr; }
+
+    core::Result<size_t> Exchange(const core::Byte*, core::Byte*, size_t, bool) override {
+        return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+    }
+
+    core::Result<size_t> Command(const SpiCommand& command) override {
+        opcodes[command.opcode]++;
+        if (command.opcode != 0x05 && busy > 0) {
+            return core::Result<size_t>::Err(core::ErrorCode::kIOError);  // not polled
+        }
+        std::size_t addr = command.address;
+        switch (command.opcode) {
+            case 0x9F:
+                command.read[0] = static_cast<core::Byte>(kJedecId >> 16);
+                command.read[1] = static_cast<core::Byte>(kJedecId >> 8);
+                command.read[2] = static_cast<core::Byte>(kJedecId);
+                return core::Result<size_t>::Ok(3);
+            case 0x05:
+                command.read[0] = busy > 0 ? 0x03 : 0x00;
+                if (busy > 0 && !stuck) {
+                    --busy;
+                }
+                return core::Result<size_t>::Ok(1);
+            case 0x06:
+                wel = true;
+                return core::Result<size_t>::Ok(0);
+            case 0x02:
+            case 0x32: {
+                if (!wel) {
+                    return core::Result<size_t>::Err(core::ErrorCode::kIOError);
+                }
+                std::size_t page = addr & ~std::size_t{255};
+                for (size_t i = 0; i < command.length; ++i) {
+                    memory[page + ((addr + i) & 255)] &= command.write[i];
+                }
+                if (corrupt_next) {
+                    memory[addr] ^= 0x01;
+                    corrupt_next = false;
+                }
+                Busy();
+                return core::Result<size_t>::Ok(command.length);
+            }
+            case 0x20:
+                if (!wel) {
+                    return core::Result<size_t>::Err(core::ErrorCode::kIOError);
+                }
+                std::fill_n(memory.begin() + static_cast<std::ptrdiff_t>(addr & ~std::size_t{4095}),
+                            4096, 0xFF);
+                Busy();
+                return core::Result<size_t>::Ok(0);
+            case 0x0B:
+            case 0x6B:
+                if (command.dummy_bytes != 1 || addr + command.length > memory.size()) {
+                    return core::Result<size_t>::Err(core::ErrorCode::kInvalidArgument);
+                }
+                std::copy_n(memory.begin() + static_cast<std::ptrdiff_t>(addr), command.length,
+                            command.read);
+                return core::Result<size_t>::Ok(command.length);
+            default:
+                return core::Result<size_t>::Err(core::ErrorCode::kNotSupported);
+        }
+    }
+
+    core::Result<void> SetClock(core::Frequency) override { return core::Result<void>::Ok(); }
+    core::Frequency GetClock() const override { return core::Frequency(1000000); }
+    core::Result<void> SetMode(SpiMode) override { return core::Result<void>::Ok(); }
+
+    void Busy() {
+        wel = false;
+        busy = busy_polls;
+    }
+
+    std::vector<core::Byte> memory;
+    std::map<uint8_t, int> opcodes;
+    int busy_polls = 2;
+    int busy = 0;
+    bool stuck = false;
+    bool wel = false;
+    bool corrupt_next = false;
+};
+
+std::vector<core::Byte> MakeImage(std::size_t size, uint8_t seed) {
+    std::vector<core::Byte> image(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        image[i] = static_cast<core::Byte>((i * 31 + seed) ^ (i >> 8));
+    }
+    return image;
+}
+
+class SpiFlashTest : public ::testing::Test {
+protected:
+    SpiFlashGeometry Geometry() { return SpiFlashGeometry::FromJedecId(kJedecId).Value(); }
+
+    FakeSpiNor nor_;
+};
+
+TEST(Crc32cTest, MatchesCheckValue) {
+    const std::string check = "123456789";
+    auto* data = reinterpret_cast<const core::Byte*>(check.data());
+    EXPECT_EQ(Crc32c(data, check.size()), 0xE3069283u);
+    // Continuation gives the same result as one call, at any split.
+    EXPECT_EQ(Crc32c(data + 5, 4, Crc32c(data, 5)), 0xE3069283u);
+    EXPECT_EQ(Crc32c(nullptr, 0), 0u);
+}
+
+TEST(Crc32cTest, LongBuffersAtAnyAlignment) {
+    auto image = MakeImage(4099, 7);
+    uint32_t bytewise = 0;
+    for (std::size_t i = 0; i < image.size(); ++i) {
+        bytewise = Crc32c(&image[i], 1, bytewise);
+    }
+    EXPECT_EQ(Crc32c(image.data(), image.size()), bytewise);
+    EXPECT_EQ(Crc32c(image.data() + 3, 1000, Crc32c(image.data(), 3)),
+              Crc32c(image.data(), 1003));
+}
+
+TEST(SpiFlashGeometryTest, FromJedecId) {
+    auto w25q256 = SpiFlashGeometry::FromJedecId(0xEF4019);
+    ASSERT_TRUE(w25q256.IsOk());
+    EXPECT_EQ(w25q256.Value().size, 32u << 20);
+    EXPECT_EQ(w25q256.Value().address_bytes, 4);
+
+    auto w25q128 = SpiFlashGeometry::FromJedecId(0xEF4018);
+    EXPECT_EQ(w25q128.Value().size, 16u << 20);
+    EXPECT_EQ(w25q128.Value().address_bytes, 3);
+
+    EXPECT_EQ(SpiFlashGeometry::FromJedecId(0x20BA20).Value().size, 64u << 20);
+    EXPECT_EQ(SpiFlashGeometry::FromJedecId(0xFFFFFF).Error(), core::ErrorCode::kNotFound);
+    EXPECT_EQ(SpiFlashGeometry::FromJedecId(0x000000).Error(), core::ErrorCode::kNotFound);
+    EXPECT_EQ(SpiFlashGeometry::FromJedecId(0xEF4005).Error(), core::ErrorCode::kNotFound);
+}
+
+TEST_F(SpiFlashTest, ReadsJedecId) {
+    auto id = SpiFlash::ReadJedecId(nor_);
+    ASSERT_TRUE(id.IsOk());
+    EXPECT_EQ(id.Value(), kJedecId);
+}
+
+TEST_F(SpiFlashTest, ProgramsErasedPartWithoutErasing) {
+    SpiFlash flash(nor_, Geometry());
+    auto image = MakeImage(64 * 1024, 1);
+    ASSERT_TRUE(flash.Program(0, image.data(), image.size()).IsOk());
+
+    EXPECT_TRUE(std::equal(image.begin(), image.end(), nor_.memory.begin()));
+    EXPECT_EQ(flash.Stats().pages_programmed, 256u);
+    EXPECT_EQ(flash.Stats().sectors_erased, 0u);
+    EXPECT_EQ(flash.Stats().crc32c, Crc32c(image.data(), image.size()));
+    EXPECT_GT(flash.Stats().status_polls, 0u);
+}
+
+TEST_F(SpiFlashTest, SkipsMatchingPagesAndErasesOnlyWhereNeeded) {
+    SpiFlash flash(nor_, Geometry());
+    auto image = MakeImage(32 * 1024, 2);
+    ASSERT_TRUE(flash.Program(0, image.data(), image.size()).IsOk());
+
+    // Same image: nothing to program.
+    flash.ResetStats();
+    nor_.opcodes.clear();
+    ASSERT_TRUE(flash.Program(0, image.data(), image.size()).IsOk());
+    EXPECT_EQ(flash.Stats().pages_programmed, 0u);
+    EXPECT_EQ(flash.Stats().pages_skipped, 128u);
+    EXPECT_EQ(nor_.opcodes[0x06], 0);
+
+    // Clearing bits in one page programs that page alone; setting a bit
+    // erases its sector and reprograms the sector's other pages.
+    ASSERT_NE(image[300], 0x00);
+    ASSERT_NE(image[20000], 0xFF);
+    image[300] = 0x00;
+    image[20000] = 0xFF;
+    flash.ResetStats();
+    ASSERT_TRUE(flash.Program(0, image.data(), image.size()).IsOk());
+    EXPECT_TRUE(std::equal(image.begin(), image.end(), nor_.memory.begin()));
+    EXPECT_EQ(flash.Stats().sectors_erased, 1u);
+    EXPECT_EQ(flash.Stats().pages_programmed, 17u);
+}
+
+TEST_F(SpiFlashTest, ErasedSectorKeepsBytesOutsideTheRange) {
+    SpiFlash flash(nor_, Geometry());
+    auto base = MakeImage(8192, 3);
+    ASSERT_TRUE(flash.Program(0, base.data(), base.size()).IsOk());
+
+    std::vector<core::Byte> patch(100, 0xFF);  // all bits set: forces an erase
+    ASSERT_TRUE(flash.Program(4000, patch.data(), patch.size()).IsOk());
+    EXPECT_EQ(flash.Stats().sectors_erased, 2u);
+    auto expected = base;
+    std::copy(patch.begin(), patch.end(), expected.begin() + 4000);
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), nor_.memory.begin()));
+}
+
+TEST_F(SpiFlashTest, WithoutSkipUnchangedErasesEverySector) {
+    SpiFlashOptions options;
+    options.skip_unchanged = false;
+    SpiFlash flash(nor_, Geometry(), options);
+    auto image = MakeImage(16 * 1024, 4);
+    ASSERT_TRUE(flash.Program(0, image.data(), image.size()).IsOk());
+    ASSERT_TRUE(flash.Program(0, image.data(), image.size()).IsOk());
+    EXPECT_EQ(flash.Stats().sectors_erased, 8u);
+    EXPECT_TRUE(std::equal(image.begin(), image.end(), nor_.memory.begin()));
+}
+
+TEST_F(SpiFlashTest, VerifyCatchesABadWrite) {
+    SpiFlash flash(nor_, Geometry());
+    auto image = MakeImage(4096, 5);
+    nor_.corrupt_next = true;
+    EXPECT_EQ(flash.Program(0, image.data(), image.size()).Error(), core::ErrorCode::kDataLoss);
+}
+
+TEST_F(SpiFlashTest, QuadReadAndProgramFile) {
+    SpiFlashOptions options;
+    options.read_lines = SpiLines::kQuad;
+    options.quad_program = true;
+    std::vector<std::size_t> progress;
+    options.progress = [&](std::size_t done, std::size_t total) {
+        EXPECT_EQ(total, 100000u);
+        progress.push_back(done);
+    };
+    SpiFlash flash(nor_, Geometry(), options);
+
+    auto image = MakeImage(100000, 6);
+    const std::string path = "test_spi_flash_image.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(image.data()),
+                  static_cast<std::streamsize>(image.size()));
+    }
+    auto programmed = flash.ProgramFile(path, 0x10000);
+    std::remove(path.c_str());
+    ASSERT_TRUE(programmed.IsOk());
+
+    EXPECT_TRUE(std::equal(image.begin(), image.end(), nor_.memory.begin() + 0x10000));
+    EXPECT_EQ(nor_.opcodes[0x0B], 0);
+    EXPECT_GT(nor_.opcodes[0x6B], 0);
+    EXPECT_GT(nor_.opcodes[0x32], 0);
+    ASSERT_EQ(progress.size(), 2u);  // two 64 KiB chunks
+    EXPECT_EQ(progress.back(), 100000u);
+
+    EXPECT_EQ(flash.ProgramFile("no_such_image.bin").Error(), core::ErrorCode::kNotFound);
+}
+
+TEST_F(SpiFlashTest, StatusPollingTimesOut) {
+    SpiFlashOptions options;
+    options.program_timeout = std::chrono::milliseconds(2);
+    SpiFlash flash(nor_, Geometry(), options);
+    nor_.stuck = true;
+    auto image = MakeImage(256, 7);
+    EXPECT_EQ(flash.Program(0, image.data(), image.size()).Error(), core::ErrorCode::kTimeout);
+}
+
+TEST_F(SpiFlashTest, RejectsBadRanges) {
+    SpiFlash flash(nor_, Geometry());
+    core::Byte byte = 0;
+    EXPECT_EQ(flash.Read(kSize, &byte, 1).Error(), core::ErrorCode::kOutOfRange);
+    EXPECT_EQ(flash.Program(kSize - 1, &byte, 2).Error(), core::ErrorCode::kOutOfRange);
+    EXPECT_EQ(flash.Read(0, nullptr, 1).Error(), core::ErrorCode::kInvalidArgument);
+
+    SpiFlashGeometry odd = Geometry();
+    odd.page_size = 200;
+    SpiFlash bad(nor_, odd);
+    EXPECT_EQ(bad.Read(0, &byte, 1).Error(), core::ErrorCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace plas::hal
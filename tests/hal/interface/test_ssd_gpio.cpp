@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/ssd_gpio.h"
+
+namespace plas::hal {
+namespace {
+
+// Per-pin backend, so the default batched calls can be checked.
+class RecordingGpio : public SsdGpio {
+public:
+    Device* GetDevice() override { return nullptr; }
+
+    core::Result<void> SetPerst(bool active) override { return Set("perst", perst, active); }
+    core::Result<bool> GetPerst() override { return Get("perst", perst); }
+    core::Result<void> SetClkReq(bool active) override { return Set("clkreq", clkreq, active); }
+    core::Result<bool> GetClkReq() override { return Get("clkreq", clkreq); }
+    core::Result<void> SetDualPort(bool enable) override { return Set("dual", dual, enable); }
+    core::Result<bool> GetDualPort() override { return Get("dual", dual); }
+
+    bool perst = false;
+    bool clkreq = false;
+    bool dual = false;
+    std::vector<std::string> ops;
+    std::string fail_on;
+
+private:
+    core::Result<void> Set(const std::string& pin, bool& state, bool value) {
+        ops.push_back("set " + pin);
+        if (pin == fail_on) {
+            return core::Result<void>::Err(core::ErrorCode::kIOError);
+        }
+        state = value;
+        return core::Result<void>::Ok();
+    }
+    core::Result<bool> Get(const std::string& pin, bool state) {
+        ops.push_back("get " + pin);
+        if (pin == fail_on) {
+            return core::Result<bool>::Err(core::ErrorCode::kIOError);
+        }
+        return core::Result<bool>::Ok(state);
+    }
+};
+
+TEST(SsdGpioTest, DefaultGetPinStateReadsEveryPin) {
+    RecordingGpio gpio;
+    gpio.perst = true;
+    gpio.dual = true;
+    auto state = gpio.GetPinState();
+    ASSERT_TRUE(state.IsOk());
+    EXPECT_EQ(state.Value().values, SsdPinState::kPerst | SsdPinState::kDualPort);
+    EXPECT_TRUE(state.Value().Perst());
+    EXPECT_FALSE(state.Value().ClkReq());
+    EXPECT_TRUE(state.Value().DualPort());
+    EXPECT_EQ(gpio.ops.size(), 3u);
+
+    gpio.fail_on = "clkreq";
+    EXPECT_EQ(gpio.GetPinState().Error(),
+              core::make_error_code(core::ErrorCode::kIOError));
+}
+
+TEST(SsdGpioTest, DefaultSetPinStateTouchesOnlyMaskedPins) {
+    RecordingGpio gpio;
+    gpio.dual = true;
+    ASSERT_TRUE(gpio.SetPinState(SsdPinState::kPerst | SsdPinState::kClkReq,
+                                 SsdPinState::kClkReq | SsdPinState::kDualPort)
+                    .IsOk());
+    EXPECT_FALSE(gpio.perst);
+    EXPECT_TRUE(gpio.clkreq);
+    EXPECT_TRUE(gpio.dual);  // not in the mask
+    EXPECT_EQ(gpio.ops, (std::vector<std::string>{"set perst", "set clkreq"}));
+
+    EXPECT_TRUE(gpio.SetPinState(0, SsdPinState::kAll).IsOk());
+    EXPECT_EQ(gpio.ops.size(), 2u);
+}
+
+TEST(SsdGpioTest, DefaultSetPinStateRejectsUnknownBitsAndStopsOnFailure) {
+    RecordingGpio gpio;
+    EXPECT_EQ(gpio.SetPinState(0x08, 0).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    EXPECT_TRUE(gpio.ops.empty());
+
+    gpio.fail_on = "perst";
+    EXPECT_EQ(gpio.SetPinState(SsdPinState::kAll, SsdPinState::kAll).Error(),
+              core::make_error_code(core::ErrorCode::kIOError));
+    EXPECT_EQ(gpio.ops, (std::vector<std::string>{"set perst"}));
+    EXPECT_FALSE(gpio.clkreq);
+}
+
+}  // namespace
+}  // namespace plas::hal
@@ -0,0 +1,234 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/ssd_gpio.h"
+#include "plas/hal/interface/ssd_pin_capture.h"
+
+namespace plas::hal {
+namespace {
+
+// Pins the test flips from its own thread; the capture polls them.
+class FakeGpio : public SsdGpio {
+public:
+    Device* GetDevice() override { return nullptr; }
+    core::Result<void> SetPerst(bool active) override { return Set(SsdPinState::kPerst, active); }
+    core::Result<bool> GetPerst() override { return Get(SsdPinState::kPerst); }
+    core::Result<void> SetClkReq(bool active) override { return Set(SsdPinState::kClkReq, active); }
+    core::Result<bool> GetClkReq() override { return Get(SsdPinState::kClkReq); }
+    core::Result<void> SetDualPort(bool enable) override {
+        return Set(SsdPinState::kDualPort, enable);
+    }
+    core::Result<bool> GetDualPort() override { return Get(SsdPinState::kDualPort); }
+
+    core::Result<SsdPinState> GetPinState() override {
+        if (reads.fetch_add(1) + 1 >= fail_from.load()) {
+            return core::Result<SsdPinState>::Err(core::ErrorCode::kIOError);
+        }
+        SsdPinState state;
+        state.values = pins.load();
+        return core::Result<SsdPinState>::Ok(state);
+    }
+
+    std::atomic<uint8_t> pins{0};
+    std::atomic<int> reads{0};
+    std::atomic<int> fail_from{1 << 30};  ///< first failing read (1-based)
+
+private:
+    core::Result<void> Set(uint8_t bit, bool active) {
+        pins.store(static_cast<uint8_t>(active ? (pins.load() | bit) : (pins.load() & ~bit)));
+        return core::Result<void>::Ok();
+    }
+    core::Result<bool> Get(uint8_t bit) {
+        return core::Result<bool>::Ok((pins.load() & bit) != 0);
+    }
+};
+
+// Backend with "hardware" capture: the test injects edges directly.
+class HardwareGpio : public FakeGpio {
+public:
+    core::Result<void> StartPinEvents(const SsdPinEventOptions& options) override {
+        if (start_error != core::ErrorCode::kSuccess) {
+            return core::Result<void>::Err(start_error);
+        }
+        callback = options.callback;
+        capturing = true;
+        return core::Result<void>::Ok();
+    }
+    core::Result<void> StopPinEvents() override {
+        capturing = false;
+        stops++;
+        return core::Result<void>::Ok();
+    }
+    bool IsCapturingPinEvents() const override { return capturing; }
+
+    std::function<void(const SsdPinEvent&)> callback;
+    core::ErrorCode start_error = core::ErrorCode::kSuccess;
+    bool capturing = false;
+    int stops = 0;
+};
+
+bool WaitFor(const std::function<bool()>& done) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    return true;
+}
+
+TEST(SsdPinEventCaptureTest, ValidatesOptions) {
+    SsdPinEventQueue queue(16);
+    SsdPinEventOptions options;
+    EXPECT_TRUE(SsdPinEventCapture::Validate(options).IsError());  // no sink
+    options.queue = &queue;
+    EXPECT_TRUE(SsdPinEventCapture::Validate(options).IsOk());
+    options.pins = 0;
+    EXPECT_TRUE(SsdPinEventCapture::Validate(options).IsError());
+    options.pins = 0x10;
+    EXPECT_TRUE(SsdPinEventCapture::Validate(options).IsError());
+    options.pins = SsdPinState::kPerst;
+    options.poll_interval = std::chrono::microseconds(0);
+    EXPECT_EQ(SsdPinEventCapture::Validate(options).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+}
+
+TEST(SsdPinEventCaptureTest, PollingReportsWatchedEdges) {
+    FakeGpio gpio;
+    gpio.pins = SsdPinState::kPerst;  // baseline: PERST# asserted
+    SsdPinEventQueue queue(64);
+    std::mutex mutex;
+    std::vector<SsdPinEvent> seen;
+
+    SsdPinEventOptions options;
+    options.pins = SsdPinState::kPerst | SsdPinState::kClkReq;
+    options.queue = &queue;
+    options.callback = [&](const SsdPinEvent& event) {
+        std::lock_guard lock(mutex);
+        seen.push_back(event);
+    };
+    options.poll_interval = std::chrono::microseconds(100);
+
+    SsdPinEventCapture capture;
+    ASSERT_TRUE(capture.Start(gpio, options).IsOk());
+    EXPECT_TRUE(capture.IsRunning());
+    EXPECT_TRUE(capture.IsPolling());
+    EXPECT_EQ(capture.Start(gpio, options).Error(),
+              core::make_error_code(core::ErrorCode::kAlreadyOpen));
+
+    const uint64_t before = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+    gpio.SetDualPort(true);  // not watched
+    gpio.SetClkReq(true);
+    ASSERT_TRUE(WaitFor([&] { return capture.EventCount() >= 1; }));
+    gpio.SetPerst(false);
+    ASSERT_TRUE(WaitFor([&] { return capture.EventCount() >= 2; }));
+    ASSERT_TRUE(capture.Stop().IsOk());
+    EXPECT_FALSE(capture.IsRunning());
+
+    SsdPinEvent events[8];
+    ASSERT_EQ(queue.Pop(events, 8), 2u);
+    EXPECT_EQ(events[0].pin, SsdPinState::kClkReq);
+    EXPECT_TRUE(events[0].level);
+    EXPECT_TRUE(events[0].state.DualPort());
+    EXPECT_EQ(events[1].pin, SsdPinState::kPerst);
+    EXPECT_FALSE(events[1].level);
+    for (int i = 0; i < 2; ++i) {
+        EXPECT_EQ(events[i].clock, SsdEventClock::kHost);
+        EXPECT_GT(events[i].window_ns, 0u);
+    }
+    EXPECT_GE(events[0].timestamp_ns, before);
+    EXPECT_GT(events[1].timestamp_ns, events[0].timestamp_ns);
+
+    std::lock_guard lock(mutex);
+    EXPECT_EQ(seen.size(), 2u);
+}
+
+TEST(SsdPinEventCaptureTest, PollErrorEndsCaptureAndIsReported) {
+    FakeGpio gpio;
+    SsdPinEventQueue queue(8);
+    SsdPinEventOptions options;
+    options.queue = &queue;
+
+    gpio.fail_from = 2;  // the baseline succeeds, the first poll fails
+    SsdPinEventCapture capture;
+    ASSERT_TRUE(capture.Start(gpio, options).IsOk());
+    ASSERT_TRUE(WaitFor([&] { return gpio.reads.load() >= 2; }));
+    EXPECT_EQ(capture.Stop().Error(), core::make_error_code(core::ErrorCode::kIOError));
+
+    // A failing baseline read fails Start() itself.
+    EXPECT_EQ(capture.Start(gpio, options).Error(),
+              core::make_error_code(core::ErrorCode::kIOError));
+    EXPECT_FALSE(capture.IsRunning());
+}
+
+TEST(SsdPinEventCaptureTest, PrefersHardwareCapture) {
+    HardwareGpio gpio;
+    SsdPinEventQueue queue(8);
+    std::atomic<int> calls{0};
+    SsdPinEventOptions options;
+    options.queue = &queue;
+    options.callback = [&](const SsdPinEvent&) { calls++; };
+
+    SsdPinEventCapture capture;
+    ASSERT_TRUE(capture.Start(gpio, options).IsOk());
+    EXPECT_FALSE(capture.IsPolling());
+    EXPECT_TRUE(gpio.IsCapturingPinEvents());
+    EXPECT_EQ(gpio.reads.load(), 0);  // no polling baseline
+
+    SsdPinEvent edge;
+    edge.timestamp_ns = 12345;
+    edge.pin = SsdPinState::kClkReq;
+    edge.level = true;
+    ASSERT_TRUE(gpio.callback);
+    gpio.callback(edge);
+
+    EXPECT_EQ(capture.EventCount(), 1u);
+    EXPECT_EQ(calls.load(), 1);
+    SsdPinEvent out;
+    ASSERT_EQ(queue.Pop(&out, 1), 1u);
+    EXPECT_EQ(out.timestamp_ns, 12345u);
+    EXPECT_EQ(out.clock, SsdEventClock::kHardware);
+
+    EXPECT_TRUE(capture.Stop().IsOk());
+    EXPECT_EQ(gpio.stops, 1);
+    EXPECT_TRUE(capture.Stop().IsOk());  // idempotent
+    EXPECT_EQ(gpio.stops, 1);
+}
+
+TEST(SsdPinEventCaptureTest, BackendErrorOtherThanUnsupportedIsReturned) {
+    HardwareGpio gpio;
+    gpio.start_error = core::ErrorCode::kNotInitialized;
+    SsdPinEventQueue queue(8);
+    SsdPinEventOptions options;
+    options.queue = &queue;
+
+    SsdPinEventCapture capture;
+    EXPECT_EQ(capture.Start(gpio, options).Error(),
+              core::make_error_code(core::ErrorCode::kNotInitialized));
+    EXPECT_FALSE(capture.IsRunning());
+    EXPECT_EQ(gpio.reads.load(), 0);
+}
+
+TEST(SsdPinEventCaptureTest, DefaultBackendIsUnsupported) {
+    FakeGpio gpio;
+    SsdPinEventOptions options;
+    SsdGpio& base = gpio;
+    EXPECT_EQ(base.StartPinEvents(options).Error(),
+              core::make_error_code(core::ErrorCode::kNotSupported));
+    EXPECT_FALSE(base.IsCapturingPinEvents());
+    EXPECT_TRUE(base.StopPinEvents().IsOk());
+}
+
+}  // namespace
+}  // namespace plas::hal
@@ -1,11 +1,22 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include "plas/hal/device_manager.h"
 #include "plas/hal/interface/device.h"
 #include "plas/hal/interface/i2c.h"
 #include "plas/hal/interface/power_control.h"
 #include "plas/hal/interface/serial.h"
 #include "plas/hal/interface/ssd_gpio.h"
+#include "plas/config/config_diff.h"
 #include "plas/config/config_node.h"
 #include "plas/config/device_entry.h"
 #include "plas/core/error.h"
@@ -46,7 +57,11 @@ protected:
     }
 
     void TearDown() override {
-        DeviceManager::GetInstance().Reset();
+        auto& mgr = DeviceManager::GetInstance();
+        mgr.SetIdleCloseTimeout(std::chrono::milliseconds(0));
+        mgr.SetLazyOpen(false);
+        mgr.StopHealthSupervisor();
+        mgr.Reset();
     }
 
     std::string FixturePath(const std::string& filename) {
@@ -62,6 +77,28 @@ TEST_F(DeviceManagerTest, GetInstanceReturnsSameReference) {
     EXPECT_EQ(&inst1, &inst2);
 }
 
+TEST_F(DeviceManagerTest, InstancesAreIndependent) {
+    DeviceManager a;
+    DeviceManager b;
+    std::thread load_a([&] {
+        ASSERT_TRUE(a.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+    });
+    std::thread load_b([&] {
+        ASSERT_TRUE(b.LoadFromConfig(FixturePath("device_manager_test.yaml")).IsOk());
+    });
+    load_a.join();
+    load_b.join();
+
+    EXPECT_EQ(a.DeviceCount(), 2u);
+    EXPECT_EQ(b.DeviceCount(), 2u);
+    EXPECT_EQ(DeviceManager::GetInstance().DeviceCount(), 0u);
+    EXPECT_NE(a.GetDevice("aardvark0"), b.GetDevice("aardvark0"));
+
+    a.Reset();
+    EXPECT_EQ(a.DeviceCount(), 0u);
+    EXPECT_EQ(b.DeviceCount(), 2u);
+}
+
 TEST_F(DeviceManagerTest, InitialStateEmpty) {
     EXPECT_EQ(DeviceManager::GetInstance().DeviceCount(), 0u);
     EXPECT_TRUE(DeviceManager::GetInstance().DeviceNames().empty());
@@ -104,6 +141,27 @@ TEST_F(DeviceManagerTest, LoadFromConfigDeviceCount) {
     EXPECT_EQ(mgr.DeviceCount(), 2u);
 }
 
+TEST_F(DeviceManagerTest, StreamFromConfigMatchesLoad) {
+    auto& mgr = DeviceManager::GetInstance();
+    for (const char* name :
+         {"device_manager_test.json", "device_manager_test.yaml"}) {
+        mgr.Reset();
+        auto result = mgr.StreamFromConfig(FixturePath(name));
+        ASSERT_TRUE(result.IsOk()) << name << ": " << result.Error().message();
+        auto names = mgr.DeviceNames();
+        ASSERT_EQ(names.size(), 2u);
+        EXPECT_EQ(names[0], "aardvark0");
+        EXPECT_EQ(names[1], "pmu3_main");
+    }
+
+    // A second load collides on nicknames, as with LoadFromConfig.
+    auto again = mgr.StreamFromConfig(FixturePath("device_manager_test.json"));
+    ASSERT_TRUE(again.IsError());
+    EXPECT_EQ(again.Error(),
+              plas::core::make_error_code(plas::core::ErrorCode::kAlreadyOpen));
+    EXPECT_EQ(mgr.DeviceCount(), 2u);
+}
+
 // --- LoadFromEntries tests ---
 
 TEST_F(DeviceManagerTest, LoadFromEntries) {
@@ -369,3 +427,978 @@ TEST_F(DeviceManagerTest, GetDevicesByInterfaceEmptyManager) {
     auto i2c_devices = mgr.GetDevicesByInterface<I2c>();
     EXPECT_TRUE(i2c_devices.empty());
 }
+
+// --- Lazy open tests ---
+
+TEST_F(DeviceManagerTest, LazyOpenOpensOnFirstGetDevice) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+    mgr.SetLazyOpen(true);
+    EXPECT_TRUE(mgr.IsLazyOpen());
+
+    EXPECT_EQ(mgr.PeekDevice("aardvark0")->GetState(),
+              DeviceState::kUninitialized);
+    auto* device = mgr.GetDevice("aardvark0");
+    ASSERT_NE(device, nullptr);
+    EXPECT_EQ(device->GetState(), DeviceState::kOpen);
+    EXPECT_EQ(mgr.PeekDevice("pmu3_main")->GetState(),
+              DeviceState::kUninitialized);
+}
+
+TEST_F(DeviceManagerTest, LazyOpenViaGetInterface) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+    mgr.SetLazyOpen(true);
+
+    auto* i2c = mgr.GetInterface<I2c>("aardvark0");
+    ASSERT_NE(i2c, nullptr);
+    EXPECT_EQ(mgr.PeekDevice("aardvark0")->GetState(), DeviceState::kOpen);
+}
+
+TEST_F(DeviceManagerTest, LazyOpenDisabledLeavesDevicesClosed) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+
+    auto* device = mgr.GetDevice("aardvark0");
+    ASSERT_NE(device, nullptr);
+    EXPECT_EQ(device->GetState(), DeviceState::kUninitialized);
+}
+
+TEST_F(DeviceManagerTest, LazyOpenConcurrentLookupsOpenOnce) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+    mgr.SetLazyOpen(true);
+
+    std::vector<std::thread> threads;
+    std::vector<DeviceState> states(8);
+    for (std::size_t t = 0; t < states.size(); ++t) {
+        threads.emplace_back([&mgr, &states, t] {
+            states[t] = mgr.GetDevice("aardvark0")->GetState();
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    for (auto state : states) {
+        EXPECT_EQ(state, DeviceState::kOpen);
+    }
+}
+
+TEST_F(DeviceManagerTest, IdleCloseReleasesAndReopens) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+    mgr.SetLazyOpen(true);
+    mgr.SetIdleCloseTimeout(std::chrono::milliseconds(20));
+    EXPECT_EQ(mgr.GetIdleCloseTimeout(), std::chrono::milliseconds(20));
+
+    auto* device = mgr.GetDevice("aardvark0");
+    ASSERT_EQ(device->GetState(), DeviceState::kOpen);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    mgr.CloseIdleDevices();
+    EXPECT_EQ(mgr.PeekDevice("aardvark0")->GetState(), DeviceState::kClosed);
+
+    EXPECT_EQ(mgr.GetDevice("aardvark0")->GetState(), DeviceState::kOpen);
+}
+
+TEST_F(DeviceManagerTest, IdleCloseSkipsExplicitlyOpenedDevices) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+    auto* device = mgr.GetDevice("aardvark0");
+    ASSERT_TRUE(device->Init().IsOk());
+    ASSERT_TRUE(device->Open().IsOk());
+
+    mgr.SetLazyOpen(true);
+    mgr.SetIdleCloseTimeout(std::chrono::milliseconds(1));
+    mgr.GetDevice("aardvark0");
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(mgr.CloseIdleDevices(), 0u);
+    EXPECT_EQ(device->GetState(), DeviceState::kOpen);
+}
+
+// --- Lock-free lookups ---
+
+TEST_F(DeviceManagerTest, LookupsDuringConcurrentAddDevice) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+
+    std::atomic<bool> done{false};
+    std::atomic<int> misses{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                if (mgr.GetInterface<I2c>("aardvark0") == nullptr) {
+                    ++misses;
+                }
+                mgr.DeviceNames();
+            }
+        });
+    }
+
+    for (int i = 0; i < 50; ++i) {
+        DeviceEntry entry;
+        entry.nickname = "extra" + std::to_string(i);
+        entry.driver = "aardvark";
+        entry.uri = "aardvark://" + std::to_string(i) + ":0x50";
+        ASSERT_TRUE(mgr.LoadFromEntries({entry}).IsOk());
+    }
+    done = true;
+    for (auto& th : readers) {
+        th.join();
+    }
+
+    EXPECT_EQ(misses.load(), 0);
+    EXPECT_EQ(mgr.DeviceCount(), 52u);
+    EXPECT_TRUE(mgr.HasDevice("extra49"));
+    auto names = mgr.DeviceNames();
+    EXPECT_TRUE(std::is_sorted(names.begin(), names.end()));
+}
+
+TEST_F(DeviceManagerTest, SupersededSnapshotsAreReclaimed) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+    auto handle = mgr.GetHandle<I2c>("aardvark0");
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                mgr.ForEachInterface<I2c>([](const std::string&, I2c*) {});
+                mgr.GetDevicesByInterface<I2c>();
+                mgr.HasDevice("aardvark0");
+            }
+        });
+    }
+    for (int i = 0; i < 200; ++i) {
+        DeviceEntry entry{"extra" + std::to_string(i), "aardvark://" + std::to_string(i) + ":0x50",
+                          "aardvark", {}};
+        ASSERT_TRUE(mgr.AddDevice(entry, std::make_unique<plas::hal::driver::AardvarkDevice>(entry))
+                        .IsOk());
+    }
+    done = true;
+    for (auto& th : readers) {
+        th.join();
+    }
+
+    // With no lookup in flight the next publish frees every old snapshot.
+    ASSERT_TRUE(mgr.AddToGroup("all", "aardvark0").IsOk());
+    EXPECT_EQ(mgr.GetMemoryReport().retained_bytes, 0u);
+    EXPECT_EQ(mgr.DeviceCount(), 202u);
+    EXPECT_EQ(handle.Get(), mgr.GetInterface<I2c>("aardvark0"));
+}
+
+TEST_F(DeviceManagerTest, AddDevicesPublishesOnceAndReportsTakenNames) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+
+    std::vector<std::pair<DeviceEntry, std::unique_ptr<plas::hal::Device>>> batch;
+    for (const auto* name : {"batch0", "aardvark0", "batch1", "batch0"}) {
+        DeviceEntry entry{name, "aardvark://7:0x50", "aardvark", {}};
+        batch.emplace_back(entry, std::make_unique<plas::hal::driver::AardvarkDevice>(entry));
+    }
+    auto results = mgr.AddDevices(std::move(batch));
+
+    ASSERT_EQ(results.size(), 4u);
+    EXPECT_TRUE(results[0].IsOk());
+    EXPECT_EQ(results[1].Error(), plas::core::ErrorCode::kAlreadyOpen);
+    EXPECT_TRUE(results[2].IsOk());
+    EXPECT_EQ(results[3].Error(), plas::core::ErrorCode::kAlreadyOpen);
+    EXPECT_EQ(mgr.DeviceCount(), 4u);
+    EXPECT_NE(mgr.GetInterface<I2c>("batch1"), nullptr);
+    EXPECT_EQ(mgr.GetDevice("aardvark0")->GetUri(), "aardvark://0:0x50");
+
+    auto loaded = mgr.LoadedEntries();
+    EXPECT_TRUE(std::any_of(loaded.begin(), loaded.end(),
+                            [](const DeviceEntry& e) { return e.nickname == "batch1"; }));
+}
+
+// --- Interface table / handles ---
+
+TEST_F(DeviceManagerTest, InterfaceTableMatchesDynamicCast) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+
+    for (const auto& name : mgr.DeviceNames()) {
+        auto* device = mgr.GetDevice(name);
+        EXPECT_EQ(mgr.GetInterface<I2c>(name), dynamic_cast<I2c*>(device));
+        EXPECT_EQ(mgr.GetInterface<PowerControl>(name),
+                  dynamic_cast<PowerControl*>(device));
+        EXPECT_EQ(mgr.GetInterface<SsdGpio>(name),
+                  dynamic_cast<SsdGpio*>(device));
+    }
+}
+
+TEST_F(DeviceManagerTest, ForEachInterfaceVisitsImplementersInOrder) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+
+    std::vector<std::string> names;
+    mgr.ForEachInterface<I2c>([&names](const std::string& name, I2c* i2c) {
+        EXPECT_NE(i2c, nullptr);
+        names.push_back(name);
+    });
+
+    auto listed = mgr.GetDevicesByInterface<I2c>();
+    ASSERT_EQ(names.size(), listed.size());
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        EXPECT_EQ(names[i], listed[i].first);
+    }
+    EXPECT_TRUE(std::is_sorted(names.begin(), names.end()));
+}
+
+TEST_F(DeviceManagerTest, HandleResolvesOnceAndSurvivesAddDevice) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+
+    auto handle = mgr.GetHandle<I2c>("aardvark0");
+    ASSERT_TRUE(handle);
+    EXPECT_EQ(handle.Get(), mgr.GetInterface<I2c>("aardvark0"));
+
+    EXPECT_FALSE(mgr.GetHandle<I2c>("pmu3_main"));
+    EXPECT_FALSE(mgr.GetHandle<I2c>("nonexistent"));
+    EXPECT_EQ(mgr.GetHandle<I2c>("nonexistent").Get(), nullptr);
+
+    DeviceEntry entry;
+    entry.nickname = "later";
+    entry.driver = "aardvark";
+    entry.uri = "aardvark://7:0x50";
+    ASSERT_TRUE(mgr.LoadFromEntries({entry}).IsOk());
+    EXPECT_EQ(handle.Get(), mgr.GetInterface<I2c>("aardvark0"));
+}
+
+TEST_F(DeviceManagerTest, HandleAppliesLazyOpen) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+    mgr.SetLazyOpen(true);
+
+    auto handle = mgr.GetHandle<I2c>("aardvark0");
+    ASSERT_TRUE(handle);
+    EXPECT_EQ(mgr.PeekDevice("aardvark0")->GetState(),
+              DeviceState::kUninitialized);
+    ASSERT_NE(handle.Get(), nullptr);
+    EXPECT_EQ(mgr.PeekDevice("aardvark0")->GetState(), DeviceState::kOpen);
+}
+
+TEST_F(DeviceManagerTest, HandleGoesStaleOnReset) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+
+    auto handle = mgr.GetHandle<PowerControl>("pmu3_main");
+    ASSERT_TRUE(handle.IsValid());
+    EXPECT_EQ(handle.Generation(), mgr.Generation());
+    auto copy = handle;
+    EXPECT_EQ(copy.Get(), handle.Get());
+
+    mgr.Reset();
+    EXPECT_FALSE(handle.IsValid());
+    EXPECT_EQ(handle.Get(), nullptr);
+    EXPECT_EQ(copy.Get(), nullptr);
+
+    // Re-resolving after reload yields a fresh, valid handle.
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+    auto fresh = mgr.GetHandle<PowerControl>("pmu3_main");
+    EXPECT_TRUE(fresh.IsValid());
+    EXPECT_FALSE(handle.IsValid());
+}
+
+TEST_F(DeviceManagerTest, HandleSharedAcrossThreads) {
+    static_assert(std::is_trivially_copyable_v<plas::hal::DeviceHandle<I2c>>);
+
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+    const auto handle = mgr.GetHandle<I2c>("aardvark0");
+    auto* expected = mgr.GetInterface<I2c>("aardvark0");
+
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([handle, expected, &mismatches] {
+            for (int i = 0; i < 10000; ++i) {
+                if (handle.Get() != expected) ++mismatches;
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    EXPECT_EQ(mismatches.load(), 0);
+}
+
+// --- PCI hotplug ---
+
+namespace {
+
+class FakePciDevice : public plas::hal::Device {
+public:
+    explicit FakePciDevice(std::string uri) : uri_(std::move(uri)) {}
+
+    plas::core::Result<void> Init() override {
+        state_ = DeviceState::kInitialized;
+        return plas::core::Result<void>::Ok();
+    }
+    plas::core::Result<void> Open() override {
+        if (state_ != DeviceState::kInitialized) {
+            return plas::core::Result<void>::Err(
+                plas::core::ErrorCode::kNotInitialized);
+        }
+        ++opens;
+        state_ = DeviceState::kOpen;
+        return plas::core::Result<void>::Ok();
+    }
+    plas::core::Result<void> Close() override {
+        ++closes;
+        state_ = DeviceState::kClosed;
+        return plas::core::Result<void>::Ok();
+    }
+    plas::core::Result<void> Reset() override { return Init(); }
+
+    DeviceState GetState() const override { return state_; }
+    std::string GetName() const override { return "fake"; }
+    std::string GetUri() const override { return uri_; }
+    std::string GetDriverName() const override { return "fake"; }
+
+    int opens = 0;
+    int closes = 0;
+
+private:
+    std::string uri_;
+    DeviceState state_ = DeviceState::kUninitialized;
+};
+
+const plas::hal::pci::PciAddress kHotplugAddr{0x0000, {0x01, 0x00, 0x00}};
+
+plas::hal::pci::PciHotplugEvent HotplugEvent(
+    plas::hal::pci::PciHotplugAction action) {
+    return {action, kHotplugAddr};
+}
+
+}  // namespace
+
+TEST_F(DeviceManagerTest, HotplugRemoveClosesAndAddReopens) {
+    using plas::hal::pci::PciHotplugAction;
+    auto& mgr = DeviceManager::GetInstance();
+    auto owned = std::make_unique<FakePciDevice>("pciutils://0000:01:00.0");
+    auto* device = owned.get();
+    ASSERT_TRUE(mgr.AddDevice("nvme0", std::move(owned)).IsOk());
+    ASSERT_TRUE(device->Init().IsOk());
+    ASSERT_TRUE(device->Open().IsOk());
+
+    EXPECT_EQ(mgr.HandlePciHotplug(HotplugEvent(PciHotplugAction::kRemove)),
+              1u);
+    EXPECT_EQ(device->GetState(), DeviceState::kClosed);
+    EXPECT_TRUE(mgr.IsDeviceRemoved("nvme0"));
+    // Duplicate events change nothing.
+    EXPECT_EQ(mgr.HandlePciHotplug(HotplugEvent(PciHotplugAction::kRemove)),
+              0u);
+    EXPECT_EQ(device->closes, 1);
+
+    EXPECT_EQ(mgr.HandlePciHotplug(HotplugEvent(PciHotplugAction::kAdd)), 1u);
+    EXPECT_FALSE(mgr.IsDeviceRemoved("nvme0"));
+    EXPECT_EQ(device->GetState(), DeviceState::kOpen);
+    EXPECT_EQ(device->opens, 2);
+}
+
+TEST_F(DeviceManagerTest, HotplugRemovedDeviceSkipsLazyOpen) {
+    using plas::hal::pci::PciHotplugAction;
+    auto& mgr = DeviceManager::GetInstance();
+    auto owned = std::make_unique<FakePciDevice>("pciutils://0000:01:00.0");
+    auto* device = owned.get();
+    ASSERT_TRUE(mgr.AddDevice("nvme0", std::move(owned)).IsOk());
+    mgr.SetLazyOpen(true);
+    ASSERT_EQ(mgr.GetDevice("nvme0")->GetState(), DeviceState::kOpen);
+
+    mgr.HandlePciHotplug(HotplugEvent(PciHotplugAction::kRemove));
+    EXPECT_EQ(mgr.GetDevice("nvme0")->GetState(), DeviceState::kClosed);
+    EXPECT_EQ(device->opens, 1);
+
+    // Lazily opened devices are reopened by the next lookup, not the event.
+    mgr.HandlePciHotplug(HotplugEvent(PciHotplugAction::kAdd));
+    EXPECT_EQ(device->GetState(), DeviceState::kClosed);
+    EXPECT_EQ(mgr.GetDevice("nvme0")->GetState(), DeviceState::kOpen);
+    EXPECT_EQ(device->opens, 2);
+}
+
+TEST_F(DeviceManagerTest, HotplugMatchesOnlyTheNamedFunction) {
+    using plas::hal::pci::PciHotplugAction;
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+    auto other = std::make_unique<FakePciDevice>("pciutils://0000:01:00.1");
+    auto* device = other.get();
+    ASSERT_TRUE(mgr.AddDevice("nvme1", std::move(other)).IsOk());
+    ASSERT_TRUE(device->Init().IsOk());
+    ASSERT_TRUE(device->Open().IsOk());
+
+    EXPECT_EQ(mgr.HandlePciHotplug(HotplugEvent(PciHotplugAction::kRemove)),
+              0u);
+    EXPECT_EQ(device->GetState(), DeviceState::kOpen);
+    EXPECT_FALSE(mgr.IsDeviceRemoved("nvme1"));
+    EXPECT_FALSE(mgr.IsDeviceRemoved("aardvark0"));
+}
+
+TEST_F(DeviceManagerTest, HotplugMonitorStartStop) {
+    auto& mgr = DeviceManager::GetInstance();
+    auto started = mgr.StartPciHotplugMonitor();
+    if (started.IsError()) {
+        GTEST_SKIP() << "uevent socket unavailable: "
+                     << started.Error().message();
+    }
+    EXPECT_TRUE(mgr.IsPciHotplugMonitorRunning());
+    EXPECT_TRUE(mgr.StartPciHotplugMonitor().IsError());
+    mgr.StopPciHotplugMonitor();
+    EXPECT_FALSE(mgr.IsPciHotplugMonitorRunning());
+}
+
+// --- Reload (ApplyDiff) tests ---
+
+TEST_F(DeviceManagerTest, LoadedEntriesTrackConfigDevicesOnly) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+    auto loaded = mgr.LoadedEntries();
+    EXPECT_EQ(loaded.size(), mgr.DeviceCount());
+    EXPECT_EQ(loaded[0].nickname, mgr.DeviceNames()[0]);
+
+    auto extra = plas::hal::DeviceFactory::CreateFromConfig(
+        DeviceEntry{"manual", "aardvark://9:0x50", "aardvark", {}});
+    ASSERT_TRUE(extra.IsOk());
+    ASSERT_TRUE(mgr.AddDevice("manual", std::move(extra).Value()).IsOk());
+    EXPECT_EQ(mgr.LoadedEntries().size(), loaded.size());
+
+    mgr.Reset();
+    EXPECT_TRUE(mgr.LoadedEntries().empty());
+}
+
+TEST_F(DeviceManagerTest, ApplyDiffTouchesOnlyChangedDevices) {
+    auto& mgr = DeviceManager::GetInstance();
+    std::vector<DeviceEntry> entries;
+    entries.push_back({"keep", "aardvark://0:0x50", "aardvark", {}});
+    entries.push_back({"edit", "aardvark://1:0x50", "aardvark", {}});
+    entries.push_back({"drop", "pmu3://usb:PMU3-001", "pmu3", {}});
+    ASSERT_TRUE(mgr.LoadFromEntries(entries).IsOk());
+    for (const auto& name : mgr.DeviceNames()) {
+        auto* dev = mgr.PeekDevice(name);
+        ASSERT_TRUE(dev->Init().IsOk());
+        ASSERT_TRUE(dev->Open().IsOk());
+    }
+    auto* keep = mgr.PeekDevice("keep");
+    auto* edit = mgr.PeekDevice("edit");
+    auto keep_handle = mgr.GetHandle<I2c>("keep");
+    auto edit_handle = mgr.GetHandle<I2c>("edit");
+
+    auto updated = entries;
+    updated[1].uri = "aardvark://1:0x51";
+    updated.pop_back();
+    updated.push_back({"new", "aardvark://2:0x50", "aardvark", {}});
+
+    auto diff = plas::config::DiffDevices(mgr.LoadedEntries(), updated);
+    EXPECT_EQ(diff.unchanged, 1u);
+    ASSERT_TRUE(mgr.ApplyDiff(diff).IsOk());
+
+    EXPECT_EQ(mgr.PeekDevice("keep"), keep);
+    EXPECT_EQ(keep->GetState(), DeviceState::kOpen);
+    EXPECT_TRUE(keep_handle.IsValid());
+
+    EXPECT_NE(mgr.PeekDevice("edit"), edit);
+    EXPECT_EQ(edit->GetState(), DeviceState::kClosed);
+    EXPECT_EQ(mgr.PeekDevice("edit")->GetUri(), "aardvark://1:0x51");
+    EXPECT_FALSE(edit_handle.IsValid());
+
+    EXPECT_FALSE(mgr.HasDevice("drop"));
+    ASSERT_TRUE(mgr.HasDevice("new"));
+    EXPECT_EQ(mgr.PeekDevice("new")->GetState(), DeviceState::kUninitialized);
+
+    EXPECT_TRUE(plas::config::DiffDevices(mgr.LoadedEntries(), updated).Empty());
+}
+
+TEST_F(DeviceManagerTest, ApplyDiffIsAllOrNothing) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromConfig(FixturePath("device_manager_test.json")).IsOk());
+    auto before = mgr.DeviceNames();
+
+    plas::config::DeviceDiff diff;
+    diff.added.push_back({"fine", "aardvark://5:0x50", "aardvark", {}});
+    diff.added.push_back({"bad", "nosuch://0:0", "nosuch", {}});
+    diff.removed.push_back(before[0]);
+    EXPECT_TRUE(mgr.ApplyDiff(diff).IsError());
+    EXPECT_EQ(mgr.DeviceNames(), before);
+
+    plas::config::DeviceDiff unknown;
+    unknown.removed.push_back("nonexistent");
+    EXPECT_EQ(mgr.ApplyDiff(unknown).Error(),
+              plas::core::make_error_code(plas::core::ErrorCode::kNotFound));
+
+    plas::config::DeviceDiff duplicate;
+    duplicate.added.push_back({before[0], "aardvark://6:0x50", "aardvark", {}});
+    EXPECT_EQ(mgr.ApplyDiff(duplicate).Error(),
+              plas::core::make_error_code(plas::core::ErrorCode::kAlreadyOpen));
+    EXPECT_EQ(mgr.DeviceNames(), before);
+}
+
+TEST_F(DeviceManagerTest, ApplyDiffRetiredDeviceSkipsLazyOpen) {
+    auto& mgr = DeviceManager::GetInstance();
+    std::vector<DeviceEntry> entries;
+    entries.push_back({"a", "aardvark://0:0x50", "aardvark", {}});
+    ASSERT_TRUE(mgr.LoadFromEntries(entries).IsOk());
+    mgr.SetLazyOpen(true);
+    auto handle = mgr.GetHandle<I2c>("a");
+    ASSERT_NE(handle.Get(), nullptr);
+
+    entries[0].args["bitrate"] = "400";
+    ASSERT_TRUE(mgr.ApplyDiff(
+        plas::config::DiffDevices(mgr.LoadedEntries(), entries)).IsOk());
+    EXPECT_EQ(handle.Get(), nullptr);
+    EXPECT_EQ(mgr.PeekDevice("a")->GetState(), DeviceState::kUninitialized);
+    ASSERT_NE(mgr.GetInterface<I2c>("a"), nullptr);
+    EXPECT_EQ(mgr.PeekDevice("a")->GetState(), DeviceState::kOpen);
+}
+
+// --- Health supervision ---
+
+namespace {
+
+/// Device whose link can be cut: it reports kError once `unplugged` is set
+/// and refuses to open until `failing_opens` runs out.
+class FlakyDevice : public plas::hal::Device {
+public:
+    plas::core::Result<void> Init() override {
+        state_ = DeviceState::kInitialized;
+        return plas::core::Result<void>::Ok();
+    }
+    plas::core::Result<void> Open() override {
+        if (failing_opens > 0) {
+            --failing_opens;
+            return plas::core::Result<void>::Err(plas::core::ErrorCode::kIOError);
+        }
+        ++opens;
+        state_ = DeviceState::kOpen;
+        return plas::core::Result<void>::Ok();
+    }
+    plas::core::Result<void> Close() override {
+        state_ = DeviceState::kClosed;
+        return plas::core::Result<void>::Ok();
+    }
+    plas::core::Result<void> Reset() override { return Init(); }
+
+    DeviceState GetState() const override { return state_; }
+    std::string GetName() const override { return "flaky"; }
+    std::string GetUri() const override { return "flaky://0:0"; }
+    std::string GetDriverName() const override { return "flaky"; }
+
+    void Unplug(int refused_opens) {
+        failing_opens = refused_opens;
+        state_ = DeviceState::kError;
+    }
+
+    std::atomic<int> failing_opens{0};
+    std::atomic<int> opens{0};
+
+private:
+    std::atomic<DeviceState> state_{DeviceState::kUninitialized};
+};
+
+plas::hal::HealthSupervisorOptions ManualTicks() {
+    plas::hal::HealthSupervisorOptions options;
+    options.probe_interval = std::chrono::hours(1);  // ticks come from the test
+    options.initial_backoff = std::chrono::milliseconds(1);
+    options.max_backoff = std::chrono::milliseconds(4);
+    return options;
+}
+
+/// Run supervisor passes until one reconnects a device (or give up).
+bool TickUntilReconnected(DeviceManager& mgr) {
+    for (int i = 0; i < 2000; ++i) {
+        if (mgr.CheckDeviceHealth() > 0) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+}  // namespace
+
+TEST_F(DeviceManagerTest, HealthSupervisorRejectsBadOptions) {
+    auto& mgr = DeviceManager::GetInstance();
+    auto options = ManualTicks();
+    options.probe_interval = std::chrono::milliseconds(0);
+    EXPECT_TRUE(mgr.StartHealthSupervisor(options).IsError());
+    options = ManualTicks();
+    options.max_backoff = std::chrono::milliseconds(0);
+    EXPECT_TRUE(mgr.StartHealthSupervisor(options).IsError());
+    EXPECT_FALSE(mgr.IsHealthSupervisorRunning());
+
+    ASSERT_TRUE(mgr.StartHealthSupervisor(ManualTicks()).IsOk());
+    EXPECT_TRUE(mgr.IsHealthSupervisorRunning());
+    mgr.StopHealthSupervisor();
+    EXPECT_FALSE(mgr.IsHealthSupervisorRunning());
+}
+
+TEST_F(DeviceManagerTest, HealthSupervisorReconnectsWithBackoff) {
+    auto& mgr = DeviceManager::GetInstance();
+    auto owned = std::make_unique<FlakyDevice>();
+    auto* device = owned.get();
+    ASSERT_TRUE(mgr.AddDevice("adapter", std::move(owned)).IsOk());
+    ASSERT_TRUE(device->Init().IsOk());
+    ASSERT_TRUE(device->Open().IsOk());
+    ASSERT_TRUE(mgr.StartHealthSupervisor(ManualTicks()).IsOk());
+
+    EXPECT_EQ(mgr.CheckDeviceHealth(), 0u);  // healthy: nothing to do
+    device->Unplug(3);
+    EXPECT_EQ(mgr.CheckDeviceHealth(), 0u);  // outage detected
+    auto report = mgr.GetHealthReport();
+    ASSERT_EQ(report.size(), 1u);
+    EXPECT_TRUE(report[0].reconnecting);
+
+    ASSERT_TRUE(TickUntilReconnected(mgr));
+    EXPECT_EQ(device->GetState(), DeviceState::kOpen);
+    report = mgr.GetHealthReport();
+    EXPECT_EQ(report[0].nickname, "adapter");
+    EXPECT_FALSE(report[0].reconnecting);
+    EXPECT_EQ(report[0].disconnects, 1u);
+    EXPECT_EQ(report[0].reconnects, 1u);
+    EXPECT_EQ(report[0].failed_attempts, 3u);
+    EXPECT_GT(report[0].downtime.count(), 0);
+    EXPECT_EQ(report[0].longest_outage, report[0].downtime);
+}
+
+TEST_F(DeviceManagerTest, HealthSupervisorUsesProbeAndSkipsClosedDevices) {
+    auto& mgr = DeviceManager::GetInstance();
+    auto open = std::make_unique<FlakyDevice>();
+    auto closed = std::make_unique<FlakyDevice>();
+    auto* probed = open.get();
+    auto* idle = closed.get();
+    ASSERT_TRUE(mgr.AddDevice("open", std::move(open)).IsOk());
+    ASSERT_TRUE(mgr.AddDevice("closed", std::move(closed)).IsOk());
+    ASSERT_TRUE(probed->Init().IsOk());
+    ASSERT_TRUE(probed->Open().IsOk());
+
+    std::atomic<bool> alive{false};
+    auto options = ManualTicks();
+    options.probe = [&](plas::hal::Device& device) {
+        return &device != probed || alive.load();
+    };
+    ASSERT_TRUE(mgr.StartHealthSupervisor(options).IsOk());
+    mgr.CheckDeviceHealth();
+    alive = true;
+    ASSERT_TRUE(TickUntilReconnected(mgr));
+    EXPECT_EQ(probed->opens.load(), 2);
+    EXPECT_EQ(idle->opens.load(), 0);
+    EXPECT_EQ(idle->GetState(), DeviceState::kUninitialized);
+}
+
+TEST_F(DeviceManagerTest, ReconnectPolicyFailFastOrWait) {
+    auto& mgr = DeviceManager::GetInstance();
+    auto owned = std::make_unique<FlakyDevice>();
+    auto* device = owned.get();
+    ASSERT_TRUE(mgr.AddDevice("adapter", std::move(owned)).IsOk());
+    ASSERT_TRUE(device->Init().IsOk());
+    ASSERT_TRUE(device->Open().IsOk());
+
+    // Fail fast: the lookup returns the broken device immediately.
+    ASSERT_TRUE(mgr.StartHealthSupervisor(ManualTicks()).IsOk());
+    device->Unplug(0);
+    mgr.CheckDeviceHealth();
+    EXPECT_EQ(mgr.GetDevice("adapter")->GetState(), DeviceState::kError);
+    ASSERT_TRUE(TickUntilReconnected(mgr));
+
+    // Wait: the lookup returns once the running supervisor reconnected.
+    auto options = ManualTicks();
+    options.probe_interval = std::chrono::milliseconds(2);
+    options.policy = plas::hal::ReconnectPolicy::kWait;
+    options.wait_timeout = std::chrono::seconds(10);
+    ASSERT_TRUE(mgr.StartHealthSupervisor(options).IsOk());
+    device->Unplug(2);
+    for (int i = 0; i < 2000 && !mgr.GetHealthReport()[0].reconnecting; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(mgr.GetHealthReport()[0].reconnecting);
+    EXPECT_EQ(mgr.GetDevice("adapter")->GetState(), DeviceState::kOpen);
+    EXPECT_EQ(mgr.GetHealthReport()[0].reconnects, 2u);
+}
+
+// --- Group tests ---
+
+namespace {
+
+std::vector<DeviceEntry> RackEntries() {
+    std::vector<DeviceEntry> entries;
+    entries.push_back({"i2c0", "aardvark://0:0x50", "aardvark", {{"group", "rack3"}}});
+    entries.push_back({"i2c1", "aardvark://1:0x50", "aardvark", {{"group", " rack3 , psu "}}});
+    entries.push_back({"pmu", "pmu3://usb:PMU3-001", "pmu3", {{"group", "psu,rack3"}}});
+    entries.push_back({"loose", "aardvark://2:0x50", "aardvark", {}});
+    return entries;
+}
+
+}  // namespace
+
+TEST_F(DeviceManagerTest, GroupsComeFromConfigArgs) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromEntries(RackEntries()).IsOk());
+
+    EXPECT_EQ(mgr.GroupNames(), (std::vector<std::string>{"psu", "rack3"}));
+    EXPECT_EQ(mgr.GroupMembers("rack3"),
+              (std::vector<std::string>{"i2c0", "i2c1", "pmu"}));
+    EXPECT_EQ(mgr.GroupMembers("psu"), (std::vector<std::string>{"i2c1", "pmu"}));
+    EXPECT_TRUE(mgr.GroupMembers("nosuch").empty());
+}
+
+TEST_F(DeviceManagerTest, AddToGroupSurvivesReloadUntilReset) {
+    auto& mgr = DeviceManager::GetInstance();
+    auto entries = RackEntries();
+    ASSERT_TRUE(mgr.LoadFromEntries(entries).IsOk());
+
+    EXPECT_EQ(mgr.AddToGroup("rack3", "nosuch").Error(),
+              plas::core::make_error_code(plas::core::ErrorCode::kNotFound));
+    EXPECT_EQ(mgr.AddToGroup("", "loose").Error(),
+              plas::core::make_error_code(plas::core::ErrorCode::kInvalidArgument));
+    ASSERT_TRUE(mgr.AddToGroup("rack3", "loose").IsOk());
+    ASSERT_TRUE(mgr.AddToGroup("rack3", "i2c0").IsOk());  // already a member
+    EXPECT_EQ(mgr.GroupMembers("rack3"),
+              (std::vector<std::string>{"i2c0", "i2c1", "loose", "pmu"}));
+
+    auto updated = entries;
+    updated[1].args["group"] = "psu";
+    updated[3].uri = "aardvark://3:0x50";
+    ASSERT_TRUE(mgr.ApplyDiff(plas::config::DiffDevices(mgr.LoadedEntries(), updated)).IsOk());
+    EXPECT_EQ(mgr.GroupMembers("rack3"),
+              (std::vector<std::string>{"i2c0", "loose", "pmu"}));
+
+    mgr.Reset();
+    EXPECT_TRUE(mgr.GroupNames().empty());
+}
+
+TEST_F(DeviceManagerTest, ForEachInGroupRunsMembersInParallel) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromEntries(RackEntries()).IsOk());
+
+    std::atomic<int> calls{0};
+    auto reads = mgr.ForEachInGroup<I2c>("rack3", [&](I2c& i2c) {
+        ++calls;
+        auto* device = dynamic_cast<plas::hal::Device*>(&i2c);
+        if (device->GetName() == "i2c1") {
+            return plas::core::Result<std::string>::Err(plas::core::ErrorCode::kIOError);
+        }
+        return plas::core::Result<std::string>::Ok(device->GetUri());
+    });
+    ASSERT_TRUE(reads.IsOk());
+    EXPECT_EQ(calls.load(), 2);  // pmu is not an I2c
+
+    const auto& devices = reads.Value().devices;
+    ASSERT_EQ(devices.size(), 2u);
+    EXPECT_EQ(devices[0].nickname, "i2c0");
+    EXPECT_EQ(devices[0].result.Value(), "aardvark://0:0x50");
+    EXPECT_EQ(devices[1].nickname, "i2c1");
+    EXPECT_TRUE(devices[1].result.IsError());
+    EXPECT_EQ(reads.Value().FailedCount(), 1u);
+    EXPECT_FALSE(reads.Value().AllOk());
+    EXPECT_EQ(reads.Value().Status().Error(),
+              plas::core::make_error_code(plas::core::ErrorCode::kIOError));
+
+    auto missing = mgr.ForEachInGroup<I2c>("nosuch", [](I2c&) {
+        return plas::core::Result<void>::Ok();
+    });
+    EXPECT_EQ(missing.Error(),
+              plas::core::make_error_code(plas::core::ErrorCode::kNotFound));
+}
+
+TEST_F(DeviceManagerTest, ForEachInGroupAppliesLazyOpen) {
+    auto& mgr = DeviceManager::GetInstance();
+    ASSERT_TRUE(mgr.LoadFromEntries(RackEntries()).IsOk());
+    mgr.SetLazyOpen(true);
+
+    auto states = mgr.ForEachInGroup<PowerControl>("psu", [](PowerControl& power) {
+        return plas::core::Result<DeviceState>::Ok(
+            dynamic_cast<plas::hal::Device&>(power).GetState());
+    }, 1);
+    ASSERT_TRUE(states.IsOk());
+    ASSERT_EQ(states.Value().devices.size(), 1u);
+    EXPECT_EQ(states.Value().devices[0].nickname, "pmu");
+    EXPECT_EQ(states.Value().devices[0].result.Value(), DeviceState::kOpen);
+    EXPECT_TRUE(states.Value().AllOk());
+}
+
+// --- Read coalescing ---
+
+TEST_F(DeviceManagerTest, ReadCoalescingFromConfigArg) {
+    auto& mgr = DeviceManager::GetInstance();
+    std::vector<DeviceEntry> entries;
+    entries.push_back({"sensor", "aardvark://0:0x48", "aardvark", {{"coalesce_reads_us", "500"}}});
+    entries.push_back({"typo", "aardvark://1:0x48", "aardvark", {{"coalesce_reads_us", "5ms"}}});
+    entries.push_back({"plain", "aardvark://2:0x48", "aardvark", {}});
+    ASSERT_TRUE(mgr.LoadFromEntries(entries).IsOk());
+
+    EXPECT_TRUE(mgr.IsReadCoalescing("sensor"));
+    EXPECT_FALSE(mgr.IsReadCoalescing("typo"));
+    EXPECT_FALSE(mgr.IsReadCoalescing("plain"));
+
+    auto* device = mgr.GetDevice("sensor");
+    auto* i2c = mgr.GetInterface<I2c>("sensor");
+    ASSERT_NE(i2c, nullptr);
+    EXPECT_NE(i2c, dynamic_cast<I2c*>(device));  // the coalescing wrapper
+    EXPECT_EQ(i2c->GetDevice(), device);
+    EXPECT_EQ(mgr.GetHandle<I2c>("sensor").Get(), i2c);
+    EXPECT_EQ(mgr.GetInterface<I2c>("plain"), dynamic_cast<I2c*>(mgr.GetDevice("plain")));
+
+    auto stats = mgr.GetReadCoalescingStats("sensor");
+    ASSERT_TRUE(stats.IsOk());
+    EXPECT_EQ(stats.Value().reads, 0u);
+    EXPECT_EQ(mgr.GetReadCoalescingStats("plain").Error(),
+              plas::core::make_error_code(plas::core::ErrorCode::kNotFound));
+}
+
+TEST_F(DeviceManagerTest, EnableReadCoalescingSurvivesReloadUntilReset) {
+    auto& mgr = DeviceManager::GetInstance();
+    auto entries = RackEntries();
+    entries[0].args["coalesce_reads_us"] = "0";
+    ASSERT_TRUE(mgr.LoadFromEntries(entries).IsOk());
+
+    EXPECT_EQ(mgr.EnableReadCoalescing("nosuch").Error(),
+              plas::core::make_error_code(plas::core::ErrorCode::kNotFound));
+    plas::hal::ReadCoalescingOptions negative;
+    negative.freshness = std::chrono::microseconds(-1);
+    EXPECT_EQ(mgr.EnableReadCoalescing("loose", negative).Error(),
+              plas::core::make_error_code(plas::core::ErrorCode::kInvalidArgument));
+
+    ASSERT_TRUE(mgr.EnableReadCoalescing("loose").IsOk());
+    ASSERT_TRUE(mgr.DisableReadCoalescing("i2c0").IsOk());  // overrides the arg
+    EXPECT_TRUE(mgr.IsReadCoalescing("loose"));
+    EXPECT_FALSE(mgr.IsReadCoalescing("i2c0"));
+    EXPECT_EQ(mgr.GetInterface<I2c>("i2c0"), dynamic_cast<I2c*>(mgr.GetDevice("i2c0")));
+    auto coalesced = mgr.GetDevicesByInterface<I2c>();
+    ASSERT_EQ(coalesced.size(), 3u);
+    EXPECT_EQ(coalesced[2].first, "loose");
+    EXPECT_NE(coalesced[2].second, dynamic_cast<I2c*>(mgr.GetDevice("loose")));
+
+    auto updated = entries;
+    updated[3].uri = "aardvark://3:0x50";
+    ASSERT_TRUE(mgr.ApplyDiff(plas::config::DiffDevices(mgr.LoadedEntries(), updated)).IsOk());
+    EXPECT_TRUE(mgr.IsReadCoalescing("loose"));
+    EXPECT_EQ(mgr.GetInterface<I2c>("loose")->GetDevice(), mgr.GetDevice("loose"));
+    EXPECT_FALSE(mgr.IsReadCoalescing("i2c0"));
+
+    mgr.Reset();
+    ASSERT_TRUE(mgr.LoadFromEntries(entries).IsOk());
+    EXPECT_TRUE(mgr.IsReadCoalescing("i2c0"));
+    EXPECT_FALSE(mgr.IsReadCoalescing("loose"));
+}
+
+// --- Interceptors ---
+
+TEST_F(DeviceManagerTest, InterceptorsFromConfigArgWrapOutsideCoalescing) {
+    auto& mgr = DeviceManager::GetInstance();
+    std::vector<DeviceEntry> entries;
+    entries.push_back({"sensor", "aardvark://0:0x48", "aardvark",
+                       {{"interceptors", "trace, nosuch,metrics"}, {"coalesce_reads_us", "0"}}});
+    entries.push_back({"plain", "aardvark://1:0x48", "aardvark", {}});
+    ASSERT_TRUE(mgr.LoadFromEntries(entries).IsOk());
+
+    EXPECT_EQ(mgr.GetInterceptors("sensor"), (std::vector<std::string>{"trace", "metrics"}));
+    EXPECT_TRUE(mgr.GetInterceptors("plain").empty());
+    EXPECT_TRUE(mgr.GetInterceptors("nosuch").empty());
+
+    auto* device = mgr.GetDevice("sensor");
+    auto* i2c = mgr.GetInterface<I2c>("sensor");
+    ASSERT_NE(i2c, nullptr);
+    EXPECT_NE(i2c, dynamic_cast<I2c*>(device));
+    EXPECT_EQ(i2c->GetDevice(), device);
+    EXPECT_EQ(mgr.GetHandle<I2c>("sensor").Get(), i2c);
+    EXPECT_EQ(mgr.GetInterface<I2c>("plain"), dynamic_cast<I2c*>(mgr.GetDevice("plain")));
+
+    // Dropping coalescing rebuilds the chain over the device's own I2c.
+    ASSERT_TRUE(mgr.DisableReadCoalescing("sensor").IsOk());
+    auto* rewrapped = mgr.GetInterface<I2c>("sensor");
+    EXPECT_NE(rewrapped, i2c);
+    EXPECT_NE(rewrapped, dynamic_cast<I2c*>(device));
+    EXPECT_EQ(rewrapped->GetDevice(), device);
+}
+
+TEST_F(DeviceManagerTest, RetryAttemptsArgAddsInnermostRetryInterceptor) {
+    auto& mgr = DeviceManager::GetInstance();
+    std::vector<DeviceEntry> entries;
+    entries.push_back({"flaky", "aardvark://0:0x48", "aardvark", {{"retry_attempts", "3"}}});
+    entries.push_back({"traced", "aardvark://1:0x48", "aardvark",
+                       {{"interceptors", "trace"}, {"retry_attempts", "2"}}});
+    entries.push_back({"explicit", "aardvark://2:0x48", "aardvark",
+                       {{"interceptors", "retry,metrics"}, {"retry_attempts", "2"}}});
+    ASSERT_TRUE(mgr.LoadFromEntries(entries).IsOk());
+
+    EXPECT_EQ(mgr.GetInterceptors("flaky"), (std::vector<std::string>{"retry"}));
+    EXPECT_EQ(mgr.GetInterceptors("traced"), (std::vector<std::string>{"trace", "retry"}));
+    EXPECT_EQ(mgr.GetInterceptors("explicit"), (std::vector<std::string>{"retry", "metrics"}));
+    auto* i2c = mgr.GetInterface<I2c>("flaky");
+    ASSERT_NE(i2c, nullptr);
+    EXPECT_NE(i2c, dynamic_cast<I2c*>(mgr.GetDevice("flaky")));
+}
+
+TEST_F(DeviceManagerTest, SetInterceptorsOverridesArgUntilReset) {
+    auto& mgr = DeviceManager::GetInstance();
+    auto entries = RackEntries();
+    entries[0].args["interceptors"] = "metrics";
+    ASSERT_TRUE(mgr.LoadFromEntries(entries).IsOk());
+
+    EXPECT_EQ(mgr.SetInterceptors("nosuch", {"metrics"}).Error(),
+              plas::core::make_error_code(plas::core::ErrorCode::kNotFound));
+    EXPECT_EQ(mgr.SetInterceptors("loose", {"metrics", "nosuch"}).Error(),
+              plas::core::make_error_code(plas::core::ErrorCode::kInvalidArgument));
+
+    ASSERT_TRUE(mgr.SetInterceptors("loose", {"trace"}).IsOk());
+    ASSERT_TRUE(mgr.SetInterceptors("i2c0", {}).IsOk());  // overrides the arg
+    EXPECT_EQ(mgr.GetInterceptors("loose"), (std::vector<std::string>{"trace"}));
+    EXPECT_TRUE(mgr.GetInterceptors("i2c0").empty());
+    EXPECT_EQ(mgr.GetInterface<I2c>("i2c0"), dynamic_cast<I2c*>(mgr.GetDevice("i2c0")));
+    auto* pmu = mgr.GetInterface<PowerControl>("pmu");
+    EXPECT_EQ(pmu, dynamic_cast<PowerControl*>(mgr.GetDevice("pmu")));
+    ASSERT_TRUE(mgr.SetInterceptors("pmu", {"metrics"}).IsOk());
+    EXPECT_NE(mgr.GetInterface<PowerControl>("pmu"), pmu);
+
+    auto updated = entries;
+    updated[3].uri = "aardvark://3:0x50";
+    ASSERT_TRUE(mgr.ApplyDiff(plas::config::DiffDevices(mgr.LoadedEntries(), updated)).IsOk());
+    EXPECT_EQ(mgr.GetInterceptors("loose"), (std::vector<std::string>{"trace"}));
+    EXPECT_EQ(mgr.GetInterface<I2c>("loose")->GetDevice(), mgr.GetDevice("loose"));
+
+    mgr.Reset();
+    ASSERT_TRUE(mgr.LoadFromEntries(entries).IsOk());
+    EXPECT_EQ(mgr.GetInterceptors("i2c0"), (std::vector<std::string>{"metrics"}));
+    EXPECT_TRUE(mgr.GetInterceptors("loose").empty());
+}
+
+// --- Memory accounting ---
+
+TEST_F(DeviceManagerTest, MemoryReportSplitsDevicesAndSubsystems) {
+    auto& mgr = DeviceManager::GetInstance();
+    std::vector<DeviceEntry> entries;
+    entries.push_back({"plain", "aardvark://0:0x48", "aardvark", {}});
+    entries.push_back({"sensor", "aardvark://1:0x48", "aardvark",
+                       {{"coalesce_reads_us", "500"},
+                        {"interceptors", "metrics"},
+                        {"group", std::string(200, 'g')}}});
+    ASSERT_TRUE(mgr.LoadFromEntries(entries).IsOk());
+
+    auto report = mgr.GetMemoryReport();
+    ASSERT_EQ(report.devices.size(), 2u);
+    const auto& plain = report.devices[0];
+    const auto& sensor = report.devices[1];
+    EXPECT_EQ(plain.nickname, "plain");
+    EXPECT_EQ(sensor.driver, "aardvark");
+    EXPECT_GT(plain.registry_bytes, 0u);
+    EXPECT_EQ(plain.layer_bytes, 0u);
+    EXPECT_GT(sensor.layer_bytes, 0u);
+    // The 200-byte group name and the arg nodes are counted.
+    EXPECT_GT(sensor.config_bytes, plain.config_bytes + 200);
+    EXPECT_EQ(report.config_bytes, plain.config_bytes + sensor.config_bytes);
+    EXPECT_EQ(report.layer_bytes, sensor.layer_bytes);
+    EXPECT_GE(report.registry_bytes, plain.registry_bytes + sensor.registry_bytes);
+    EXPECT_EQ(report.drivers.at("aardvark"), report.device_bytes);
+
+    // A replaced device stays until Reset().
+    auto updated = entries;
+    updated[0].uri = "aardvark://2:0x48";
+    ASSERT_TRUE(mgr.ApplyDiff(plas::config::DiffDevices(mgr.LoadedEntries(), updated)).IsOk());
+    EXPECT_GT(mgr.GetMemoryReport().retained_bytes, report.retained_bytes);
+
+    mgr.Reset();
+    report = mgr.GetMemoryReport();
+    EXPECT_TRUE(report.devices.empty());
+    EXPECT_EQ(report.retained_bytes, 0u);
+    EXPECT_EQ(report.config_bytes, 0u);
+}
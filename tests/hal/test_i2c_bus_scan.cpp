@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/device_manager.h"
+#include "plas/hal/i2c_bus_scan.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/i2c.h"
+
+using plas::core::Address;
+using plas::core::Byte;
+using plas::core::ErrorCode;
+using plas::core::Result;
+using plas::hal::DeviceManager;
+using plas::hal::I2cBusScanner;
+using plas::hal::I2cScanOptions;
+using std::chrono::milliseconds;
+
+namespace {
+
+// I2C adapter whose bus ACKs `present`; everything else NACKs (kIOError).
+class FakeBus : public plas::hal::Device, public plas::hal::I2c {
+public:
+    FakeBus(std::string uri, std::set<Address> present)
+        : uri_(std::move(uri)), present_(std::move(present)) {}
+
+    Result<void> Init() override { return Result<void>::Ok(); }
+    Result<void> Open() override { return Result<void>::Ok(); }
+    Result<void> Close() override { return Result<void>::Ok(); }
+    Result<void> Reset() override { return Result<void>::Ok(); }
+    plas::hal::DeviceState GetState() const override {
+        return plas::hal::DeviceState::kOpen;
+    }
+    std::string GetName() const override { return uri_; }
+    std::string GetUri() const override { return uri_; }
+    std::string GetDriverName() const override { return "fake"; }
+    plas::hal::Device* GetDevice() override { return this; }
+
+    Result<size_t> Read(Address addr, Byte* data, size_t length, bool) override {
+        reads++;
+        if (fail != ErrorCode::kSuccess) {
+            return Result<size_t>::Err(fail);
+        }
+        if (present_.count(addr) == 0) {
+            return Result<size_t>::Err(ErrorCode::kIOError);
+        }
+        std::fill(data, data + length, Byte{0});
+        return Result<size_t>::Ok(length);
+    }
+    Result<size_t> Write(Address, const Byte*, size_t length, bool) override {
+        return Result<size_t>::Ok(length);
+    }
+    Result<size_t> WriteRead(Address, const Byte*, size_t, Byte*, size_t) override {
+        return Result<size_t>::Err(ErrorCode::kNotSupported);
+    }
+    Result<void> SetBitrate(uint32_t) override { return Result<void>::Ok(); }
+    uint32_t GetBitrate() const override { return 100000; }
+
+    std::atomic<int> reads{0};
+    ErrorCode fail = ErrorCode::kSuccess;
+
+private:
+    std::string uri_;
+    std::set<Address> present_;
+};
+
+// Overrides Scan() to record its arguments and to wait until `expected`
+// scans are running at once.
+class RendezvousBus : public FakeBus {
+public:
+    struct Gate {
+        std::mutex mutex;
+        std::condition_variable cv;
+        int arrived = 0;
+        int expected = 0;
+    };
+
+    RendezvousBus(std::string uri, Gate& gate) : FakeBus(std::move(uri), {0x20}), gate_(gate) {}
+
+    Result<std::vector<Address>> Scan(Address first, Address last,
+                                      milliseconds timeout) override {
+        seen_first = first;
+        seen_last = last;
+        seen_timeout = timeout;
+        std::unique_lock<std::mutex> lock(gate_.mutex);
+        gate_.arrived++;
+        gate_.cv.notify_all();
+        overlapped = gate_.cv.wait_for(lock, std::chrono::seconds(5),
+                                       [this] { return gate_.arrived >= gate_.expected; });
+        return Result<std::vector<Address>>::Ok({0x20});
+    }
+
+    Address seen_first = 0;
+    Address seen_last = 0;
+    milliseconds seen_timeout{0};
+    bool overlapped = false;
+
+private:
+    Gate& gate_;
+};
+
+class I2cBusScanTest : public ::testing::Test {
+protected:
+    void TearDown() override { DeviceManager::GetInstance().Reset(); }
+
+    FakeBus* Add(const std::string& name, const std::string& uri, std::set<Address> present) {
+        auto bus = std::make_unique<FakeBus>(uri, std::move(present));
+        auto* raw = bus.get();
+        EXPECT_TRUE(DeviceManager::GetInstance().AddDevice(name, std::move(bus)).IsOk());
+        return raw;
+    }
+};
+
+TEST(I2cBusScanBusOfTest, StripsTargetField) {
+    EXPECT_EQ(I2cBusScanner::BusOf("aardvark://0:0x50"), "aardvark://0");
+    EXPECT_EQ(I2cBusScanner::BusOf("ft4222h://0:1"), "ft4222h://0");
+    EXPECT_EQ(I2cBusScanner::BusOf("sim://i2c"), "sim://i2c");
+    EXPECT_EQ(I2cBusScanner::BusOf("no-scheme:1"), "no-scheme:1");
+}
+
+TEST_F(I2cBusScanTest, FindsRespondingAddresses) {
+    Add("tmp", "fake://0:0x48", {0x48, 0x50, 0x08, 0x78});
+    I2cBusScanner scanner(DeviceManager::GetInstance(), I2cScanOptions{});
+    auto scans = scanner.ScanAll();
+    ASSERT_EQ(scans.size(), 1u);
+    EXPECT_EQ(scans[0].bus, "fake://0");
+    EXPECT_FALSE(scans[0].error);
+    // 0x78 is reserved and outside the default span.
+    EXPECT_EQ(scans[0].addresses, (std::vector<Address>{0x08, 0x48, 0x50}));
+    EXPECT_TRUE(scans[0].Responds(0x50));
+    EXPECT_FALSE(scans[0].Responds(0x51));
+    EXPECT_FALSE(scans[0].cached);
+}
+
+TEST_F(I2cBusScanTest, DevicesSharingABusAreScannedOnce) {
+    auto* a = Add("eeprom", "fake://0:0x50", {0x48, 0x50});
+    auto* b = Add("sensor", "fake://0:0x48", {0x48, 0x50});
+    Add("other", "fake://1:0x20", {0x20});
+    I2cBusScanner scanner(DeviceManager::GetInstance());
+    auto scans = scanner.ScanAll();
+    ASSERT_EQ(scans.size(), 2u);
+    EXPECT_EQ(scans[0].bus, "fake://0");
+    EXPECT_EQ(scans[0].devices, (std::vector<std::string>{"eeprom", "sensor"}));
+    EXPECT_EQ(scans[1].addresses, (std::vector<Address>{0x20}));
+    EXPECT_EQ(a->reads.load(), 0x77 - 0x08 + 1);
+    EXPECT_EQ(b->reads.load(), 0);
+}
+
+TEST_F(I2cBusScanTest, ResultsAreCachedUntilInvalidated) {
+    auto* bus = Add("tmp", "fake://0:0x48", {0x48});
+    I2cBusScanner scanner(DeviceManager::GetInstance());
+    scanner.ScanAll();
+    int first = bus->reads.load();
+
+    auto again = scanner.ScanAll();
+    ASSERT_EQ(again.size(), 1u);
+    EXPECT_TRUE(again[0].cached);
+    EXPECT_EQ(again[0].addresses, (std::vector<Address>{0x48}));
+    EXPECT_EQ(bus->reads.load(), first);
+    EXPECT_TRUE(scanner.Cached("fake://0").IsOk());
+
+    scanner.Invalidate("fake://0");
+    EXPECT_TRUE(scanner.Cached("fake://0").IsError());
+    EXPECT_FALSE(scanner.ScanAll()[0].cached);
+    EXPECT_EQ(bus->reads.load(), 2 * first);
+}
+
+TEST_F(I2cBusScanTest, CacheTtlExpires) {
+    auto* bus = Add("tmp", "fake://0:0x48", {0x48});
+    I2cScanOptions options;
+    options.cache_ttl = milliseconds(1);
+    I2cBusScanner scanner(DeviceManager::GetInstance(), options);
+    scanner.ScanAll();
+    int first = bus->reads.load();
+    std::this_thread::sleep_for(milliseconds(5));
+    EXPECT_FALSE(scanner.ScanAll()[0].cached);
+    EXPECT_EQ(bus->reads.load(), 2 * first);
+}
+
+TEST_F(I2cBusScanTest, FailedScansAreReportedAndNotCached) {
+    auto* bus = Add("dead", "fake://0:0x48", {0x48});
+    bus->fail = ErrorCode::kNotSupported;
+    I2cBusScanner scanner(DeviceManager::GetInstance());
+    auto scans = scanner.ScanAll();
+    ASSERT_EQ(scans.size(), 1u);
+    EXPECT_EQ(scans[0].error, plas::core::make_error_code(ErrorCode::kNotSupported));
+    EXPECT_TRUE(scans[0].addresses.empty());
+    EXPECT_TRUE(scanner.Cached("fake://0").IsError());
+
+    bus->fail = ErrorCode::kSuccess;
+    auto retry = scanner.ScanAll();
+    EXPECT_FALSE(retry[0].error);
+    EXPECT_EQ(retry[0].addresses, (std::vector<Address>{0x48}));
+}
+
+TEST_F(I2cBusScanTest, ScanOneDeviceByNickname) {
+    Add("tmp", "fake://0:0x48", {0x48});
+    Add("other", "fake://1:0x20", {0x20});
+    I2cBusScanner scanner(DeviceManager::GetInstance());
+    auto scan = scanner.Scan("other");
+    ASSERT_TRUE(scan.IsOk());
+    EXPECT_EQ(scan.Value().bus, "fake://1");
+    EXPECT_EQ(scan.Value().addresses, (std::vector<Address>{0x20}));
+    EXPECT_TRUE(scanner.Cached("fake://0").IsError());  // not scanned
+    EXPECT_EQ(scanner.Scan("missing").Error(),
+              plas::core::make_error_code(ErrorCode::kNotFound));
+}
+
+TEST_F(I2cBusScanTest, BusesAreScannedInParallel) {
+    constexpr int kBuses = 4;
+    RendezvousBus::Gate gate;
+    gate.expected = kBuses;
+    std::vector<RendezvousBus*> buses;
+    for (int i = 0; i < kBuses; ++i) {
+        auto uri = "fake://" + std::to_string(i) + ":0x20";
+        auto bus = std::make_unique<RendezvousBus>(uri, gate);
+        buses.push_back(bus.get());
+        ASSERT_TRUE(DeviceManager::GetInstance()
+                        .AddDevice("bus" + std::to_string(i), std::move(bus))
+                        .IsOk());
+    }
+
+    I2cScanOptions options;
+    options.workers = kBuses;
+    options.probe_timeout = milliseconds(3);
+    options.first = 0x10;
+    options.last = 0x30;
+    I2cBusScanner scanner(DeviceManager::GetInstance(), options);
+    auto scans = scanner.ScanAll();
+    ASSERT_EQ(scans.size(), static_cast<size_t>(kBuses));
+    for (auto* bus : buses) {
+        EXPECT_TRUE(bus->overlapped);
+        EXPECT_EQ(bus->seen_first, 0x10u);
+        EXPECT_EQ(bus->seen_last, 0x30u);
+        EXPECT_EQ(bus->seen_timeout, milliseconds(3));
+    }
+}
+
+}  // namespace
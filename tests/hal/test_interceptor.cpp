@@ -0,0 +1,342 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/core/error.h"
+#include "plas/hal/interceptor.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/pci/cxl_mailbox.h"
+#include "plas/hal/metrics.h"
+
+using plas::config::DeviceEntry;
+using plas::core::Byte;
+using plas::core::ErrorCode;
+using plas::core::Result;
+using plas::hal::CallInfo;
+using plas::hal::CallKind;
+using plas::hal::I2c;
+using plas::hal::InterceptorBase;
+using plas::hal::InterceptorChain;
+using plas::hal::InterceptorRegistry;
+using plas::hal::InterfaceKind;
+using plas::hal::InterfaceTable;
+using plas::hal::MetricOp;
+using plas::hal::MetricsRegistry;
+
+namespace {
+
+const DeviceEntry kFake{"fake", "", "", {}};
+
+class FakeI2c : public plas::hal::Device, public I2c {
+public:
+    Result<void> Init() override { return Result<void>::Ok(); }
+    Result<void> Open() override { return Result<void>::Ok(); }
+    Result<void> Close() override { return Result<void>::Ok(); }
+    Result<void> Reset() override { return Result<void>::Ok(); }
+    plas::hal::DeviceState GetState() const override {
+        return plas::hal::DeviceState::kOpen;
+    }
+    std::string GetName() const override { return "fake"; }
+    std::string GetUri() const override { return "fake://0:0x50"; }
+    std::string GetDriverName() const override { return "fake"; }
+    plas::hal::Device* GetDevice() override { return this; }
+
+    Result<size_t> Read(plas::core::Address addr, Byte* data, size_t length,
+                        bool) override {
+        ++reads;
+        if (addr == 0x60 && busy_reads > 0) {
+            --busy_reads;
+            return Result<size_t>::Err(ErrorCode::kBusy);
+        }
+        if (addr == 0x7F) {
+            return Result<size_t>::Err(ErrorCode::kIOError);
+        }
+        std::memset(data, 0xA5, length);
+        return Result<size_t>::Ok(length);
+    }
+    Result<size_t> Write(plas::core::Address, const Byte*, size_t length, bool) override {
+        return Result<size_t>::Ok(length);
+    }
+    Result<size_t> WriteRead(plas::core::Address addr, const Byte*, size_t, Byte* read_data,
+                             size_t read_len) override {
+        return Read(addr, read_data, read_len, true);
+    }
+    Result<void> SetBitrate(uint32_t bitrate) override {
+        bitrate_ = bitrate;
+        return Result<void>::Ok();
+    }
+    uint32_t GetBitrate() const override { return bitrate_; }
+
+    int reads = 0;
+    int busy_reads = 0;  ///< reads of 0x60 that fail with kBusy first
+
+private:
+    uint32_t bitrate_ = 100000;
+};
+
+namespace pci = plas::hal::pci;
+
+// Reports kBusy `busy` times before running a command.
+class FakeMailbox : public pci::CxlMailbox {
+public:
+    plas::hal::Device* GetDevice() override { return nullptr; }
+    Result<pci::CxlMailboxResult> ExecuteCommand(pci::Bdf bdf, pci::CxlMailboxOpcode opcode,
+                                                 const pci::CxlMailboxPayload& payload) override {
+        return ExecuteCommand(bdf, static_cast<uint16_t>(opcode), payload);
+    }
+    Result<pci::CxlMailboxResult> ExecuteCommand(pci::Bdf, uint16_t,
+                                                 const pci::CxlMailboxPayload&) override {
+        ++commands;
+        auto code = busy > 0 ? pci::CxlMailboxReturnCode::kBusy
+                             : pci::CxlMailboxReturnCode::kSuccess;
+        busy = busy > 0 ? busy - 1 : 0;
+        return Result<pci::CxlMailboxResult>::Ok({code, {}});
+    }
+    Result<uint32_t> GetPayloadSize(pci::Bdf) override { return Result<uint32_t>::Ok(512); }
+    Result<bool> IsReady(pci::Bdf) override { return Result<bool>::Ok(true); }
+    Result<pci::CxlMailboxResult> GetBackgroundCmdStatus(pci::Bdf) override {
+        return Result<pci::CxlMailboxResult>::Ok({pci::CxlMailboxReturnCode::kSuccess, {}});
+    }
+
+    int busy = 0;
+    int commands = 0;
+};
+
+InterfaceTable TableOf(FakeI2c& device) {
+    InterfaceTable table{};
+    table[static_cast<std::size_t>(InterfaceKind::kI2c)] = static_cast<I2c*>(&device);
+    return table;
+}
+
+I2c* I2cOf(const InterfaceTable& table) {
+    return static_cast<I2c*>(table[static_cast<std::size_t>(InterfaceKind::kI2c)]);
+}
+
+// Appends its tag to a shared log on the way in and out.
+class TagInterceptor : public InterceptorBase<TagInterceptor> {
+public:
+    TagInterceptor(std::string tag, std::vector<std::string>& log)
+        : tag_(std::move(tag)), log_(log) {}
+
+    template <typename Call>
+    auto Around(const CallInfo& info, Call&& call) -> decltype(call()) {
+        log_.push_back(tag_ + ">" + info.op);
+        auto result = call();
+        log_.push_back(tag_ + "<");
+        return result;
+    }
+
+private:
+    std::string tag_;
+    std::vector<std::string>& log_;
+};
+
+// Answers reads of 0x10 without reaching the device.
+class StubInterceptor : public InterceptorBase<StubInterceptor> {
+public:
+    template <typename Call>
+    auto Around(const CallInfo& info, Call&& call) -> decltype(call()) {
+        if constexpr (std::is_same_v<decltype(call()), Result<size_t>>) {
+            if (info.kind == CallKind::kRead && info.address == 0x10) {
+                return Result<size_t>::Ok(info.bytes);
+            }
+        }
+        return call();
+    }
+};
+
+std::vector<std::string> g_log;
+
+class InterceptorTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        InterceptorRegistry::Register("outer", [](const plas::config::DeviceEntry&) {
+            return std::make_unique<TagInterceptor>("outer", g_log);
+        });
+        InterceptorRegistry::Register("inner", [](const plas::config::DeviceEntry&) {
+            return std::make_unique<TagInterceptor>("inner", g_log);
+        });
+        InterceptorRegistry::Register("stub", [](const plas::config::DeviceEntry&) {
+            return std::make_unique<StubInterceptor>();
+        });
+    }
+
+    void SetUp() override { g_log.clear(); }
+};
+
+}  // namespace
+
+TEST_F(InterceptorTest, FirstNameIsOutermost) {
+    FakeI2c device;
+    InterceptorChain chain(kFake, {"outer", "inner"}, TableOf(device));
+    EXPECT_EQ(chain.Names(), (std::vector<std::string>{"outer", "inner"}));
+
+    auto* i2c = I2cOf(chain.Outer());
+    ASSERT_NE(i2c, nullptr);
+    EXPECT_NE(i2c, static_cast<I2c*>(&device));
+    EXPECT_EQ(i2c->GetDevice(), &device);
+
+    Byte buf[2] = {};
+    ASSERT_TRUE(i2c->Read(0x50, buf, sizeof(buf)).IsOk());
+    EXPECT_EQ(buf[0], 0xA5);
+    EXPECT_EQ(device.reads, 1);
+    EXPECT_EQ(g_log, (std::vector<std::string>{"outer>Read", "inner>Read", "inner<", "outer<"}));
+}
+
+TEST_F(InterceptorTest, PlainForwardsBypassInterceptors) {
+    FakeI2c device;
+    InterceptorChain chain(kFake, {"outer"}, TableOf(device));
+    auto* i2c = I2cOf(chain.Outer());
+
+    ASSERT_TRUE(i2c->SetBitrate(400000).IsOk());
+    EXPECT_EQ(i2c->GetBitrate(), 400000u);
+    // SetBitrate is intercepted (it returns a Result); GetBitrate is not.
+    EXPECT_EQ(g_log, (std::vector<std::string>{"outer>SetBitrate", "outer<"}));
+}
+
+TEST_F(InterceptorTest, InterceptorCanAnswerWithoutTheDevice) {
+    FakeI2c device;
+    InterceptorChain chain(kFake, {"stub"}, TableOf(device));
+    auto* i2c = I2cOf(chain.Outer());
+
+    Byte buf[4] = {};
+    auto stubbed = i2c->Read(0x10, buf, sizeof(buf));
+    ASSERT_TRUE(stubbed.IsOk());
+    EXPECT_EQ(stubbed.Value(), 4u);
+    EXPECT_EQ(device.reads, 0);
+    ASSERT_TRUE(i2c->Read(0x11, buf, sizeof(buf)).IsOk());
+    EXPECT_EQ(device.reads, 1);
+}
+
+TEST_F(InterceptorTest, UnknownNamesAndMissingInterfacesAreLeftOut) {
+    FakeI2c device;
+    auto inner = TableOf(device);
+    InterceptorChain chain(kFake, {"nosuch", "inner"}, inner);
+    EXPECT_EQ(chain.Names(), (std::vector<std::string>{"inner"}));
+    EXPECT_FALSE(InterceptorRegistry::Has("nosuch"));
+    EXPECT_EQ(InterceptorRegistry::Create("nosuch", kFake), nullptr);
+
+    // Only the I2c entry was wrapped.
+    for (std::size_t k = 0; k < inner.size(); ++k) {
+        if (k != static_cast<std::size_t>(InterfaceKind::kI2c)) {
+            EXPECT_EQ(chain.Outer()[k], nullptr);
+        }
+    }
+    EXPECT_EQ(chain.Inner(), inner);
+
+    InterceptorChain empty(kFake, {}, inner);
+    EXPECT_TRUE(empty.Names().empty());
+    EXPECT_EQ(empty.Outer(), inner);
+}
+
+TEST_F(InterceptorTest, MetricsInterceptorRecordsCallsAndErrors) {
+    auto& registry = MetricsRegistry::GetInstance();
+    registry.Reset();
+    registry.SetEnabled(true);
+    ASSERT_TRUE(InterceptorRegistry::Has("metrics"));
+    ASSERT_TRUE(InterceptorRegistry::Has("trace"));
+
+    FakeI2c device;
+    InterceptorChain chain({"intercepted", "", "", {}}, {"metrics", "trace"}, TableOf(device));
+    auto* i2c = I2cOf(chain.Outer());
+    Byte buf[8] = {};
+    ASSERT_TRUE(i2c->Read(0x50, buf, sizeof(buf)).IsOk());
+    EXPECT_TRUE(i2c->Read(0x7F, buf, sizeof(buf)).IsError());
+    ASSERT_TRUE(i2c->SetBitrate(400000).IsOk());  // control: not sampled
+    registry.SetEnabled(false);
+
+    auto snapshot = registry.Snapshot({"intercepted"});
+    const auto* reads = snapshot.Find("intercepted", MetricOp::kI2cRead);
+    ASSERT_NE(reads, nullptr);
+    EXPECT_EQ(reads->count, 2u);
+    EXPECT_EQ(reads->errors, 1u);
+    EXPECT_EQ(reads->bytes, 8u);
+    EXPECT_EQ(snapshot.operations.size(), 1u);
+    registry.Reset();
+}
+
+TEST_F(InterceptorTest, RetryInterceptorRetriesTransientErrors) {
+    auto& registry = MetricsRegistry::GetInstance();
+    registry.Reset();
+    ASSERT_TRUE(InterceptorRegistry::Has("retry"));
+
+    FakeI2c device;
+    device.busy_reads = 2;
+    DeviceEntry entry{"retried", "", "",
+                      {{"retry_attempts", "3"}, {"retry_backoff_us", "10"}}};
+    InterceptorChain chain(entry, {"retry"}, TableOf(device));
+    auto* i2c = I2cOf(chain.Outer());
+    Byte buf[2] = {};
+    ASSERT_TRUE(i2c->Read(0x60, buf, sizeof(buf)).IsOk());
+    EXPECT_EQ(device.reads, 3);
+
+    // Permanent errors are returned at once; a third kBusy exhausts the policy.
+    EXPECT_TRUE(i2c->Read(0x7F, buf, sizeof(buf)).IsError());
+    EXPECT_EQ(device.reads, 4);
+    device.busy_reads = 5;
+    EXPECT_EQ(i2c->Read(0x60, buf, sizeof(buf)).Error(), ErrorCode::kBusy);
+    EXPECT_EQ(device.reads, 7);
+
+    auto snapshot = registry.Snapshot({"retried"});
+    const auto* retries = snapshot.FindRetries("retried");
+    ASSERT_NE(retries, nullptr);
+    EXPECT_EQ(retries->retried_calls, 2u);
+    EXPECT_EQ(retries->retries, 4u);
+    EXPECT_EQ(retries->recovered, 1u);
+    EXPECT_EQ(retries->exhausted, 1u);
+    EXPECT_GT(retries->backoff_us, 0u);
+    registry.Reset();
+}
+
+TEST_F(InterceptorTest, RetryInterceptorRetriesBusyMailboxReturnCodes) {
+    FakeMailbox mailbox;
+    mailbox.busy = 2;
+    InterfaceTable table{};
+    table[static_cast<std::size_t>(InterfaceKind::kCxlMailbox)] =
+        static_cast<pci::CxlMailbox*>(&mailbox);
+    DeviceEntry entry{"mailbox", "", "", {{"retry_attempts", "4"}, {"retry_backoff_us", "1"}}};
+    InterceptorChain chain(entry, {"retry"}, table);
+    auto* wrapped = static_cast<pci::CxlMailbox*>(
+        chain.Outer()[static_cast<std::size_t>(InterfaceKind::kCxlMailbox)]);
+    ASSERT_NE(wrapped, static_cast<pci::CxlMailbox*>(&mailbox));
+
+    auto result = wrapped->ExecuteCommand(pci::Bdf{}, uint16_t{0x0001}, {});
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_EQ(result.Value().return_code, pci::CxlMailboxReturnCode::kSuccess);
+    EXPECT_EQ(mailbox.commands, 3);
+    MetricsRegistry::GetInstance().Reset();
+}
+
+TEST(RetryPolicyFromArgsTest, ParsesRetryArgs) {
+    EXPECT_FALSE(plas::hal::RetryPolicyFromArgs(kFake).has_value());
+
+    DeviceEntry entry{"dev", "", "",
+                      {{"retry_attempts", "4"},
+                       {"retry_backoff_us", "50"},
+                       {"retry_max_backoff_us", "800"},
+                       {"retry_jitter", "0"},
+                       {"retry_on", "busy, io"}}};
+    auto policy = plas::hal::RetryPolicyFromArgs(entry);
+    ASSERT_TRUE(policy.has_value());
+    EXPECT_EQ(policy->max_attempts, 4u);
+    EXPECT_EQ(policy->initial_backoff.count(), 50);
+    EXPECT_EQ(policy->max_backoff.count(), 800);
+    EXPECT_EQ(policy->jitter, 0.0);
+    EXPECT_TRUE(policy->IsRetryable(make_error_code(ErrorCode::kIOError)));
+    EXPECT_FALSE(policy->IsRetryable(make_error_code(ErrorCode::kTimeout)));
+
+    // Malformed values keep the defaults.
+    entry.args = {{"retry_attempts", "2"}, {"retry_jitter", "2"}, {"retry_on", "busy,bogus"}};
+    policy = plas::hal::RetryPolicyFromArgs(entry);
+    ASSERT_TRUE(policy.has_value());
+    EXPECT_EQ(policy->jitter, plas::core::RetryPolicy{}.jitter);
+    EXPECT_EQ(policy->retry_on, plas::core::RetryPolicy{}.retry_on);
+    entry.args = {{"retry_attempts", "many"}};
+    EXPECT_FALSE(plas::hal::RetryPolicyFromArgs(entry).has_value());
+}
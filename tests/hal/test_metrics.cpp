@@ -0,0 +1,258 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "plas/hal/device_manager.h"
+#include "plas/hal/metrics.h"
+
+using plas::hal::DeviceManager;
+using plas::hal::DeviceMetrics;
+using plas::hal::LatencyHistogram;
+using plas::hal::MetricOp;
+using plas::hal::MetricsRegistry;
+using plas::hal::MetricsDeferScope;
+using plas::hal::MetricsTimer;
+
+namespace {
+
+class FakeDevice : public plas::hal::Device {
+public:
+    explicit FakeDevice(std::string name) : name_(std::move(name)) {}
+
+    plas::core::Result<void> Init() override {
+        return plas::core::Result<void>::Ok();
+    }
+    plas::core::Result<void> Open() override {
+        return plas::core::Result<void>::Ok();
+    }
+    plas::core::Result<void> Close() override {
+        return plas::core::Result<void>::Ok();
+    }
+    plas::core::Result<void> Reset() override {
+        return plas::core::Result<void>::Ok();
+    }
+    plas::hal::DeviceState GetState() const override {
+        return plas::hal::DeviceState::kInitialized;
+    }
+    std::string GetName() const override { return name_; }
+    std::string GetUri() const override { return "fake://0:0"; }
+    std::string GetDriverName() const override { return "fake"; }
+
+private:
+    std::string name_;
+};
+
+}  // namespace
+
+class MetricsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        MetricsRegistry::GetInstance().Reset();
+        MetricsRegistry::GetInstance().SetEnabled(true);
+    }
+
+    void TearDown() override {
+        MetricsRegistry::GetInstance().SetEnabled(false);
+        MetricsRegistry::GetInstance().Reset();
+        DeviceManager::GetInstance().Reset();
+    }
+};
+
+// --- LatencyHistogram ---
+
+TEST(LatencyHistogramTest, SmallValuesHaveOwnBuckets) {
+    for (uint64_t v = 0; v < LatencyHistogram::kSubBuckets; ++v) {
+        EXPECT_EQ(LatencyHistogram::BucketIndex(v), v);
+        EXPECT_EQ(LatencyHistogram::BucketLowerBound(v), v);
+    }
+}
+
+TEST(LatencyHistogramTest, LowerBoundWithinRelativeError) {
+    for (uint64_t v : {uint64_t{8}, uint64_t{9}, uint64_t{15}, uint64_t{16},
+                       uint64_t{1000}, uint64_t{123456789},
+                       UINT64_MAX}) {
+        auto index = LatencyHistogram::BucketIndex(v);
+        ASSERT_LT(index, LatencyHistogram::kBucketCount);
+        uint64_t lower = LatencyHistogram::BucketLowerBound(index);
+        EXPECT_LE(lower, v);
+        EXPECT_GE(static_cast<double>(lower), static_cast<double>(v) * 0.875);
+        EXPECT_EQ(LatencyHistogram::BucketIndex(lower), index);
+    }
+}
+
+// --- Registry ---
+
+TEST_F(MetricsTest, GetDeviceMetricsIsStable) {
+    auto& registry = MetricsRegistry::GetInstance();
+    DeviceMetrics* a = registry.GetDeviceMetrics("dev0");
+    EXPECT_EQ(registry.GetDeviceMetrics("dev0"), a);
+    EXPECT_NE(registry.GetDeviceMetrics("dev1"), a);
+}
+
+TEST_F(MetricsTest, RecordsCountsBytesAndErrors) {
+    auto* metrics = MetricsRegistry::GetInstance().GetDeviceMetrics("dev0");
+    metrics->Record(MetricOp::kI2cRead, 1000, 16, true);
+    metrics->Record(MetricOp::kI2cRead, 3000, 16, true);
+    metrics->Record(MetricOp::kI2cRead, 2000, 0, false);
+
+    auto snapshot = MetricsRegistry::GetInstance().Snapshot();
+    const auto* stats = snapshot.Find("dev0", MetricOp::kI2cRead);
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->count, 3u);
+    EXPECT_EQ(stats->errors, 1u);
+    EXPECT_EQ(stats->bytes, 32u);
+    EXPECT_EQ(stats->min_ns, 1000u);
+    EXPECT_EQ(stats->max_ns, 3000u);
+    EXPECT_EQ(stats->MeanNs(), 2000u);
+    EXPECT_DOUBLE_EQ(stats->BytesPerSecond(), 32.0 * 1e9 / 6000.0);
+    EXPECT_EQ(snapshot.Find("dev0", MetricOp::kI2cWrite), nullptr);
+}
+
+TEST_F(MetricsTest, PercentileFollowsDistribution) {
+    auto* metrics = MetricsRegistry::GetInstance().GetDeviceMetrics("dev0");
+    for (int i = 0; i < 99; ++i) {
+        metrics->Record(MetricOp::kBarRead, 100, 4, true);
+    }
+    metrics->Record(MetricOp::kBarRead, 1000000, 4, true);
+
+    auto snapshot = MetricsRegistry::GetInstance().Snapshot();
+    const auto* stats = snapshot.Find("dev0", MetricOp::kBarRead);
+    ASSERT_NE(stats, nullptr);
+    EXPECT_NEAR(static_cast<double>(stats->PercentileNs(50)), 100.0, 12.5);
+    EXPECT_NEAR(static_cast<double>(stats->PercentileNs(99)), 100.0, 12.5);
+    EXPECT_EQ(stats->PercentileNs(100),
+              LatencyHistogram::BucketLowerBound(
+                  LatencyHistogram::BucketIndex(1000000)));
+}
+
+TEST_F(MetricsTest, ResetZeroesCountersKeepsPointers) {
+    auto& registry = MetricsRegistry::GetInstance();
+    auto* metrics = registry.GetDeviceMetrics("dev0");
+    metrics->Record(MetricOp::kDoeExchange, 500, 8, true);
+    registry.Reset();
+    EXPECT_TRUE(registry.Snapshot().operations.empty());
+    EXPECT_EQ(registry.GetDeviceMetrics("dev0"), metrics);
+}
+
+// --- MetricsTimer ---
+
+TEST_F(MetricsTest, TimerRecordsOnDestruction) {
+    auto* metrics = MetricsRegistry::GetInstance().GetDeviceMetrics("dev0");
+    {
+        MetricsTimer timer(metrics, MetricOp::kPciConfigRead, 4);
+    }
+    {
+        MetricsTimer timer(metrics, MetricOp::kPciConfigRead, 4);
+        timer.SetError();
+    }
+    auto snapshot = MetricsRegistry::GetInstance().Snapshot();
+    const auto* stats = snapshot.Find("dev0", MetricOp::kPciConfigRead);
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->count, 2u);
+    EXPECT_EQ(stats->errors, 1u);
+    EXPECT_EQ(stats->bytes, 4u);
+}
+
+TEST_F(MetricsTest, TimerIsNoOpWhenDisabled) {
+    auto& registry = MetricsRegistry::GetInstance();
+    auto* metrics = registry.GetDeviceMetrics("dev0");
+    registry.SetEnabled(false);
+    {
+        MetricsTimer timer(metrics, MetricOp::kI2cWrite, 2);
+    }
+    {
+        MetricsTimer timer(nullptr, MetricOp::kI2cWrite, 2);
+    }
+    EXPECT_TRUE(registry.Snapshot().operations.empty());
+}
+
+TEST_F(MetricsTest, DeferScopeRecordsWhenItEnds) {
+    auto& registry = MetricsRegistry::GetInstance();
+    auto* metrics = registry.GetDeviceMetrics("dev0");
+    {
+        MetricsDeferScope scope(1);
+        {
+            MetricsTimer timer(metrics, MetricOp::kSpiRead, 8);
+        }
+        {
+            MetricsTimer timer(metrics, MetricOp::kSpiWrite, 8);  // past capacity
+        }
+        EXPECT_EQ(scope.Held(), 1u);
+        auto snapshot = registry.Snapshot();
+        EXPECT_EQ(snapshot.Find("dev0", MetricOp::kSpiRead), nullptr);
+        EXPECT_NE(snapshot.Find("dev0", MetricOp::kSpiWrite), nullptr);
+    }
+    auto snapshot = registry.Snapshot();
+    const auto* stats = snapshot.Find("dev0", MetricOp::kSpiRead);
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->count, 1u);
+    EXPECT_EQ(stats->bytes, 8u);
+}
+
+TEST_F(MetricsTest, ConcurrentRecordIsLossless) {
+    auto* metrics = MetricsRegistry::GetInstance().GetDeviceMetrics("dev0");
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 10000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([metrics] {
+            for (uint64_t i = 0; i < kPerThread; ++i) {
+                metrics->Record(MetricOp::kI2cWrite, 10 + i % 50, 1, true);
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    auto snapshot = MetricsRegistry::GetInstance().Snapshot();
+    const auto* stats = snapshot.Find("dev0", MetricOp::kI2cWrite);
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->count, static_cast<uint64_t>(kThreads * kPerThread));
+    EXPECT_EQ(stats->bytes, static_cast<uint64_t>(kThreads * kPerThread));
+    EXPECT_EQ(stats->min_ns, 10u);
+    EXPECT_EQ(stats->max_ns, 59u);
+}
+
+// --- DeviceManager ---
+
+TEST_F(MetricsTest, DeviceManagerSnapshotOnlyCoversManagedDevices) {
+    auto& dm = DeviceManager::GetInstance();
+    ASSERT_TRUE(dm.AddDevice("managed",
+                             std::make_unique<FakeDevice>("managed")).IsOk());
+
+    auto& registry = MetricsRegistry::GetInstance();
+    registry.GetDeviceMetrics("managed")
+        ->Record(MetricOp::kI2cRead, 100, 1, true);
+    registry.GetDeviceMetrics("other")
+        ->Record(MetricOp::kI2cRead, 100, 1, true);
+
+    auto snapshot = dm.GetMetricsSnapshot();
+    ASSERT_EQ(snapshot.operations.size(), 1u);
+    EXPECT_EQ(snapshot.operations[0].device, "managed");
+    EXPECT_TRUE(dm.IsMetricsEnabled());
+
+    dm.ResetMetrics();
+    EXPECT_TRUE(dm.GetMetricsSnapshot().operations.empty());
+}
+
+TEST_F(MetricsTest, SnapshotCarriesLockStats) {
+    auto& dm = DeviceManager::GetInstance();
+    dm.ResetMetrics();
+    ASSERT_TRUE(dm.AddDevice("locked",
+                             std::make_unique<FakeDevice>("locked")).IsOk());
+
+    auto snapshot = dm.GetMetricsSnapshot();
+    if (!plas::core::kLockStatsEnabled) {
+        EXPECT_TRUE(snapshot.locks.empty());
+        return;
+    }
+    const auto* manager = snapshot.FindLock("device_manager");
+    ASSERT_NE(manager, nullptr);
+    EXPECT_GE(manager->acquisitions, 1u);
+    EXPECT_EQ(snapshot.FindLock("no.such.lock"), nullptr);
+
+    dm.ResetMetrics();
+    EXPECT_EQ(MetricsRegistry::GetInstance().Snapshot().FindLock("device_manager"), nullptr);
+}
@@ -0,0 +1,330 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "plas/core/deadline.h"
+#include "plas/core/error.h"
+#include "plas/core/realtime.h"
+#include "plas/hal/device_manager.h"
+#include "plas/hal/interface/power_control.h"
+#include "plas/hal/interface/ssd_gpio.h"
+#include "plas/hal/power_sequencer.h"
+
+using plas::core::ErrorCode;
+using plas::core::Result;
+using plas::hal::DeviceManager;
+using plas::hal::PowerSequencer;
+using plas::hal::PowerSequenceTarget;
+using plas::hal::PowerStep;
+using plas::hal::PowerStepAction;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+namespace {
+
+// Power slot that records every call it receives.
+class FakeSlot : public plas::hal::Device,
+                 public plas::hal::PowerControl,
+                 public plas::hal::SsdGpio {
+public:
+    explicit FakeSlot(std::string name) : name_(std::move(name)) {}
+
+    Result<void> Init() override { return Result<void>::Ok(); }
+    Result<void> Open() override { return Result<void>::Ok(); }
+    Result<void> Close() override { return Result<void>::Ok(); }
+    Result<void> Reset() override { return Result<void>::Ok(); }
+    plas::hal::DeviceState GetState() const override {
+        return plas::hal::DeviceState::kOpen;
+    }
+    std::string GetName() const override { return name_; }
+    std::string GetUri() const override { return "fake://0:0"; }
+    std::string GetDriverName() const override { return "fake"; }
+    plas::hal::Device* GetDevice() override { return this; }
+
+    Result<void> SetVoltage(plas::core::Voltage v) override {
+        return Record("volts=" + std::to_string(static_cast<int>(v.Value() * 1000)));
+    }
+    Result<plas::core::Voltage> GetVoltage() override {
+        return Result<plas::core::Voltage>::Ok(plas::core::Voltage(0.0));
+    }
+    Result<void> SetCurrent(plas::core::Current) override { return Record("amps"); }
+    Result<plas::core::Current> GetCurrent() override {
+        return Result<plas::core::Current>::Ok(plas::core::Current(0.0));
+    }
+    Result<void> PowerOn() override { return Record("on"); }
+    Result<void> PowerOff() override { return Record("off"); }
+    Result<bool> IsPowerOn() override { return Result<bool>::Ok(false); }
+
+    Result<void> SetPerst(bool active) override {
+        return Record(active ? "perst+" : "perst-");
+    }
+    Result<bool> GetPerst() override { return Result<bool>::Ok(false); }
+    Result<void> SetClkReq(bool active) override {
+        return Record(active ? "clkreq+" : "clkreq-");
+    }
+    Result<bool> GetClkReq() override { return Result<bool>::Ok(false); }
+    Result<void> SetDualPort(bool) override { return Record("dual"); }
+    Result<bool> GetDualPort() override { return Result<bool>::Ok(false); }
+
+    PowerSequenceTarget Target() { return {name_, this, this}; }
+
+    std::vector<std::string> ops;
+    std::string fail_on;
+
+private:
+    Result<void> Record(const std::string& op) {
+        ops.push_back(op);
+        if (op == fail_on) {
+            return Result<void>::Err(ErrorCode::kIOError);
+        }
+        return Result<void>::Ok();
+    }
+
+    std::string name_;
+};
+
+std::vector<PowerStep> PowerCycle() {
+    return {
+        PowerStep::Perst(true),
+        PowerStep::PowerOff(),
+        PowerStep::Delay(milliseconds(5)),
+        PowerStep::SetVoltage(plas::core::Voltage(3.3)),
+        PowerStep::PowerOn(),
+        PowerStep::Delay(milliseconds(10)),
+        PowerStep::ClkReq(true),
+        PowerStep::Delay(milliseconds(2)),
+        PowerStep::Perst(false),
+    };
+}
+
+// Scheduler jitter on a loaded CI host; the assertions are about ordering
+// and absolute scheduling, not real-time guarantees.
+constexpr uint64_t kSlackNs = 20'000'000;
+
+}  // namespace
+
+TEST(PowerSequencerTest, RunsTimelineInOrderOnEverySlot) {
+    std::vector<std::unique_ptr<FakeSlot>> slots;
+    std::vector<PowerSequenceTarget> targets;
+    for (int i = 0; i < 8; ++i) {
+        slots.push_back(std::make_unique<FakeSlot>("slot" + std::to_string(i)));
+        targets.push_back(slots.back()->Target());
+    }
+
+    PowerSequencer sequencer(PowerCycle());
+    EXPECT_EQ(sequencer.Duration(), milliseconds(17));
+    auto result = sequencer.Run(targets);
+    ASSERT_TRUE(result.IsOk());
+    const auto& report = result.Value();
+    EXPECT_TRUE(report.Ok());
+    ASSERT_EQ(report.slots.size(), 8u);
+
+    const std::vector<std::string> expected = {"perst+", "off",     "volts=3300",
+                                               "on",     "clkreq+", "perst-"};
+    const std::vector<uint64_t> scheduled = {0, 0, 5'000'000, 5'000'000,
+                                             15'000'000, 17'000'000};
+    for (size_t s = 0; s < slots.size(); ++s) {
+        EXPECT_EQ(slots[s]->ops, expected);
+        const auto& slot = report.slots[s];
+        EXPECT_EQ(slot.name, "slot" + std::to_string(s));
+        EXPECT_TRUE(slot.completed);
+        ASSERT_EQ(slot.steps.size(), expected.size());
+        for (size_t i = 0; i < slot.steps.size(); ++i) {
+            const auto& step = slot.steps[i];
+            EXPECT_EQ(step.scheduled_ns, scheduled[i]);
+            EXPECT_GE(step.start_ns, step.scheduled_ns);
+            EXPECT_GE(step.end_ns, step.start_ns);
+            EXPECT_LT(step.LatenessNs(), kSlackNs);
+        }
+        EXPECT_EQ(slot.steps[4].step, 6u);  // timeline index, delays included
+        EXPECT_EQ(slot.steps[4].action, PowerStepAction::kClkReq);
+    }
+    EXPECT_GE(report.duration_ns, 17'000'000u);
+    EXPECT_LT(report.MaxLatenessNs(), kSlackNs);
+}
+
+TEST(PowerSequencerTest, StaggerOffsetsSlots) {
+    FakeSlot a("a"), b("b"), c("c");
+    PowerSequencer sequencer({PowerStep::PowerOn()});
+    PowerSequencer::Options options;
+    options.stagger = milliseconds(4);
+
+    auto result = sequencer.Run({a.Target(), b.Target(), c.Target()}, options);
+    ASSERT_TRUE(result.IsOk());
+    const auto& slots = result.Value().slots;
+    EXPECT_EQ(slots[0].steps[0].scheduled_ns, 0u);
+    EXPECT_EQ(slots[1].steps[0].scheduled_ns, 4'000'000u);
+    EXPECT_EQ(slots[2].steps[0].scheduled_ns, 8'000'000u);
+    EXPECT_GE(slots[2].steps[0].start_ns, 8'000'000u);
+}
+
+TEST(PowerSequencerTest, FailingSlotStopsAloneByDefault) {
+    FakeSlot good("good"), bad("bad");
+    bad.fail_on = "on";
+
+    PowerSequencer sequencer(PowerCycle());
+    auto result = sequencer.Run({good.Target(), bad.Target()});
+    ASSERT_TRUE(result.IsOk());
+    const auto& report = result.Value();
+    EXPECT_FALSE(report.Ok());
+    EXPECT_TRUE(report.slots[0].completed);
+    EXPECT_EQ(good.ops.size(), 6u);
+
+    const auto& failed = report.slots[1];
+    EXPECT_FALSE(failed.completed);
+    EXPECT_EQ(failed.error, plas::core::make_error_code(ErrorCode::kIOError));
+    ASSERT_EQ(failed.steps.size(), 4u);
+    EXPECT_EQ(failed.steps.back().error, failed.error);
+    EXPECT_EQ(bad.ops.back(), "on");
+}
+
+TEST(PowerSequencerTest, ContinueOnErrorRunsRemainingSteps) {
+    FakeSlot bad("bad");
+    bad.fail_on = "off";
+    PowerSequencer::Options options;
+    options.stop_on_error = false;
+
+    auto result = PowerSequencer(PowerCycle()).Run({bad.Target()}, options);
+    ASSERT_TRUE(result.IsOk());
+    const auto& slot = result.Value().slots[0];
+    EXPECT_FALSE(slot.completed);
+    EXPECT_EQ(slot.steps.size(), 6u);
+    EXPECT_TRUE(slot.error);
+    EXPECT_FALSE(slot.steps[0].error);
+    EXPECT_TRUE(slot.steps[1].error);
+}
+
+TEST(PowerSequencerTest, RealtimeModeRunsTimelineAndReportsJitter) {
+    FakeSlot a("a"), b("b");
+    a.ops.reserve(8);  // the doubles' own bookkeeping stays off the clock too
+    b.ops.reserve(8);
+    PowerSequencer::Options options;
+    options.realtime = true;
+    options.realtime_options.fifo_priority = 0;  // leave the test host's scheduler alone
+    options.realtime_cpus = {-1};
+
+    auto result = PowerSequencer(PowerCycle()).Run({a.Target(), b.Target()}, options);
+    ASSERT_TRUE(result.IsOk());
+    const auto& report = result.Value();
+    EXPECT_TRUE(report.Ok());
+    for (const auto& slot : report.slots) {
+        ASSERT_EQ(slot.steps.size(), 6u);
+        EXPECT_EQ(slot.steps[2].scheduled_ns, 5'000'000u);
+        EXPECT_EQ(slot.steps[5].scheduled_ns, 17'000'000u);
+        for (const auto& step : slot.steps) {
+            EXPECT_GE(step.start_ns, step.scheduled_ns);
+            EXPECT_GE(step.end_ns, step.start_ns);
+        }
+        EXPECT_FALSE(slot.realtime.fifo);
+        EXPECT_FALSE(slot.realtime.pinned);
+        EXPECT_EQ(slot.realtime.hardware_clock, plas::core::TscClock::Get().IsHardware());
+    }
+    EXPECT_EQ(a.ops.back(), "perst-");
+
+    const auto jitter = report.Jitter();
+    EXPECT_EQ(jitter.samples, 12u);
+    EXPECT_EQ(jitter.max_ns, report.MaxLatenessNs());
+    EXPECT_LE(jitter.min_ns, jitter.p99_ns);
+    EXPECT_LE(jitter.p99_ns, jitter.max_ns);
+    EXPECT_LT(jitter.max_ns, kSlackNs);
+}
+
+TEST(PowerSequencerTest, RealtimeModeKeepsFailuresPerSlot) {
+    FakeSlot good("good"), bad("bad");
+    bad.fail_on = "on";
+    PowerSequencer::Options options;
+    options.realtime = true;
+    options.realtime_options.fifo_priority = 0;
+
+    auto result = PowerSequencer(PowerCycle()).Run({good.Target(), bad.Target()}, options);
+    ASSERT_TRUE(result.IsOk());
+    const auto& report = result.Value();
+    EXPECT_TRUE(report.slots[0].completed);
+    EXPECT_EQ(report.slots[1].error, plas::core::make_error_code(ErrorCode::kIOError));
+    EXPECT_EQ(report.slots[1].steps.size(), 4u);
+}
+
+TEST(PowerSequencerTest, SlotsStopAtCallersDeadline) {
+    FakeSlot a("a"), b("b");
+    plas::core::ScopedDeadline scope(plas::core::Deadline::After(milliseconds(10)));
+
+    // Steps at 0 and 5 ms fit; ClkReq at 15 ms does not.
+    auto result = PowerSequencer(PowerCycle()).Run({a.Target(), b.Target()});
+    ASSERT_TRUE(result.IsOk());
+    for (const auto& slot : result.Value().slots) {
+        EXPECT_FALSE(slot.completed);
+        EXPECT_EQ(slot.error, plas::core::make_error_code(ErrorCode::kTimeout));
+        EXPECT_EQ(slot.steps.size(), 4u);
+    }
+    EXPECT_EQ(a.ops.size(), 4u);
+    EXPECT_EQ(b.ops.size(), 4u);
+}
+
+TEST(PowerSequencerTest, RejectsTargetsMissingInterfaces) {
+    FakeSlot slot("s");
+    PowerSequencer sequencer(PowerCycle());
+    EXPECT_EQ(sequencer.Run({}).Error(),
+              plas::core::make_error_code(ErrorCode::kInvalidArgument));
+
+    PowerSequenceTarget no_gpio{"s", &slot, nullptr};
+    EXPECT_EQ(sequencer.Run({no_gpio}).Error(),
+              plas::core::make_error_code(ErrorCode::kInvalidArgument));
+    EXPECT_TRUE(slot.ops.empty());
+
+    // A power-only timeline does not need SsdGpio.
+    PowerSequencer power_only({PowerStep::PowerOff(), PowerStep::PowerOn()});
+    EXPECT_TRUE(power_only.Run({no_gpio}).IsOk());
+}
+
+TEST(PowerSequencerTest, ResolvesTargetsFromDeviceManager) {
+    auto& dm = DeviceManager::GetInstance();
+    auto slot = std::make_unique<FakeSlot>("pmu_a");
+    auto* raw = slot.get();
+    ASSERT_TRUE(dm.AddDevice("pmu_a", std::move(slot)).IsOk());
+
+    auto targets = PowerSequencer::ResolveTargets(dm, {"pmu_a"});
+    ASSERT_TRUE(targets.IsOk());
+    ASSERT_EQ(targets.Value().size(), 1u);
+    EXPECT_EQ(targets.Value()[0].power, static_cast<plas::hal::PowerControl*>(raw));
+    EXPECT_EQ(targets.Value()[0].gpio, static_cast<plas::hal::SsdGpio*>(raw));
+
+    EXPECT_EQ(PowerSequencer::ResolveTargets(dm, {"pmu_a", "missing"}).Error(),
+              plas::core::make_error_code(ErrorCode::kNotFound));
+    dm.Reset();
+}
+
+TEST(PowerSequencerTest, PinsStepUsesOneSetPinStateCall) {
+    // Overrides the batched call, as a native backend would.
+    class BatchedSlot : public FakeSlot {
+    public:
+        using FakeSlot::FakeSlot;
+        Result<void> SetPinState(uint8_t mask, uint8_t values) override {
+            ops.push_back("pins " + std::to_string(mask) + "/" + std::to_string(values));
+            return Result<void>::Ok();
+        }
+    } slot("s");
+    using plas::hal::SsdPinState;
+
+    PowerSequencer sequencer({PowerStep::Pins(SsdPinState::kPerst | SsdPinState::kClkReq,
+                                              SsdPinState::kClkReq)});
+    auto result = sequencer.Run({slot.Target()});
+    ASSERT_TRUE(result.IsOk());
+    EXPECT_TRUE(result.Value().Ok());
+    EXPECT_EQ(slot.ops, (std::vector<std::string>{"pins 3/2"}));
+    EXPECT_EQ(result.Value().slots[0].steps[0].action, PowerStepAction::kPins);
+
+    // Pins needs SsdGpio.
+    PowerSequenceTarget power_only{"p", &slot, nullptr};
+    EXPECT_EQ(sequencer.Run({power_only}).Error(),
+              plas::core::make_error_code(ErrorCode::kInvalidArgument));
+}
+
+TEST(PowerSequencerTest, ActionNames) {
+    EXPECT_STREQ(plas::hal::ToString(PowerStepAction::kPerst), "Perst");
+    EXPECT_STREQ(plas::hal::ToString(PowerStepAction::kPins), "Pins");
+    EXPECT_STREQ(plas::hal::ToString(PowerStepAction::kDelay), "Delay");
+}
@@ -0,0 +1,303 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/core/deadline.h"
+#include "plas/core/error.h"
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/pci/cxl_mailbox.h"
+#include "plas/hal/read_coalescing.h"
+
+using plas::core::Byte;
+using plas::core::ErrorCode;
+using plas::core::Result;
+using plas::hal::ReadCoalescingLayer;
+using plas::hal::ReadCoalescingOptions;
+using plas::hal::pci::Bdf;
+using plas::hal::pci::CxlMailboxOpcode;
+using plas::hal::pci::CxlMailboxPayload;
+using plas::hal::pci::CxlMailboxResult;
+using plas::hal::pci::CxlMailboxReturnCode;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+namespace {
+
+// Temperature sensor with a CXL mailbox: counts the transactions that reach
+// it, and can hold reads until Release().
+class FakeSensor : public plas::hal::Device,
+                   public plas::hal::I2c,
+                   public plas::hal::pci::CxlMailbox {
+public:
+    Result<void> Init() override { return Result<void>::Ok(); }
+    Result<void> Open() override { return Result<void>::Ok(); }
+    Result<void> Close() override { return Result<void>::Ok(); }
+    Result<void> Reset() override { return Result<void>::Ok(); }
+    plas::hal::DeviceState GetState() const override {
+        return plas::hal::DeviceState::kOpen;
+    }
+    std::string GetName() const override { return "sensor"; }
+    std::string GetUri() const override { return "fake://0:0x48"; }
+    std::string GetDriverName() const override { return "fake"; }
+    plas::hal::Device* GetDevice() override { return this; }
+
+    Result<size_t> Read(plas::core::Address addr, Byte* data, size_t length,
+                        bool) override {
+        Transaction();
+        if (fail_next.exchange(false)) {
+            return Result<size_t>::Err(ErrorCode::kIOError);
+        }
+        for (size_t i = 0; i < length; ++i) {
+            data[i] = static_cast<Byte>(addr + temperature);
+        }
+        return Result<size_t>::Ok(length);
+    }
+    Result<size_t> Write(plas::core::Address, const Byte* data, size_t length,
+                         bool) override {
+        Transaction();
+        if (length > 0) {
+            temperature = data[0];
+        }
+        return Result<size_t>::Ok(length);
+    }
+    Result<size_t> WriteRead(plas::core::Address addr, const Byte* write, size_t write_len,
+                             Byte* read, size_t read_len) override {
+        Transaction();
+        for (size_t i = 0; i < read_len; ++i) {
+            read[i] = static_cast<Byte>(addr + (write_len > 0 ? write[0] : 0) + temperature);
+        }
+        return Result<size_t>::Ok(read_len);
+    }
+    Result<void> SetBitrate(uint32_t) override { return Result<void>::Ok(); }
+    uint32_t GetBitrate() const override { return 100000; }
+
+    Result<CxlMailboxResult> ExecuteCommand(Bdf bdf, CxlMailboxOpcode opcode,
+                                            const CxlMailboxPayload& payload) override {
+        return ExecuteCommand(bdf, static_cast<uint16_t>(opcode), payload);
+    }
+    Result<CxlMailboxResult> ExecuteCommand(Bdf, uint16_t, const CxlMailboxPayload&) override {
+        Transaction();
+        return Result<CxlMailboxResult>::Ok(
+            CxlMailboxResult{return_code, CxlMailboxPayload{temperature}});
+    }
+    Result<uint32_t> GetPayloadSize(Bdf) override { return Result<uint32_t>::Ok(256); }
+    Result<bool> IsReady(Bdf) override { return Result<bool>::Ok(true); }
+    Result<CxlMailboxResult> GetBackgroundCmdStatus(Bdf) override {
+        return Result<CxlMailboxResult>::Err(ErrorCode::kNotSupported);
+    }
+
+    /// Make transactions wait until Release().
+    void Hold() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        held_ = true;
+    }
+    void Release() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            held_ = false;
+        }
+        released_.notify_all();
+    }
+
+    std::atomic<int> transactions{0};
+    std::atomic<bool> fail_next{false};
+    Byte temperature = 40;
+    CxlMailboxReturnCode return_code = CxlMailboxReturnCode::kSuccess;
+
+private:
+    void Transaction() {
+        ++transactions;
+        std::unique_lock<std::mutex> lock(mutex_);
+        released_.wait(lock, [this] { return !held_; });
+    }
+
+    std::mutex mutex_;
+    std::condition_variable released_;
+    bool held_ = false;
+};
+
+// Poll until `pred` holds or a second passes.
+template <typename Pred>
+bool WaitFor(Pred pred) {
+    auto until = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() >= until) return false;
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    return true;
+}
+
+ReadCoalescingOptions Fresh(std::chrono::microseconds window) {
+    ReadCoalescingOptions options;
+    options.freshness = window;
+    return options;
+}
+
+}  // namespace
+
+TEST(ReadCoalescingTest, LayerWrapsImplementedInterfacesOnly) {
+    FakeSensor sensor;
+    ReadCoalescingLayer layer(sensor, {});
+    ASSERT_NE(layer.GetI2c(), nullptr);
+    ASSERT_NE(layer.GetCxlMailbox(), nullptr);
+    EXPECT_EQ(layer.GetSmBus(), nullptr);
+    EXPECT_EQ(layer.GetPciConfig(), nullptr);
+    EXPECT_EQ(layer.GetI2c()->GetDevice(), &sensor);
+}
+
+TEST(ReadCoalescingTest, ConcurrentIdenticalReadsShareOneTransaction) {
+    FakeSensor sensor;
+    ReadCoalescingLayer layer(sensor, {});
+    auto* i2c = layer.GetI2c();
+    sensor.Hold();
+
+    constexpr std::size_t kReaders = 4;
+    std::vector<std::vector<Byte>> got(kReaders, std::vector<Byte>(2));
+    std::vector<std::thread> readers;
+    const Byte reg = 0x05;
+    for (std::size_t i = 0; i < kReaders; ++i) {
+        readers.emplace_back([&, i] {
+            auto r = i2c->WriteRead(0x48, &reg, 1, got[i].data(), got[i].size());
+            EXPECT_TRUE(r.IsOk());
+            EXPECT_EQ(r.Value(), 2u);
+        });
+    }
+    ASSERT_TRUE(WaitFor([&] {
+        return layer.Coalescer().Stats().joined == kReaders - 1;
+    }));
+    sensor.Release();
+    for (auto& t : readers) t.join();
+
+    EXPECT_EQ(sensor.transactions.load(), 1);
+    for (const auto& bytes : got) {
+        EXPECT_EQ(bytes, (std::vector<Byte>{0x48 + 0x05 + 40, 0x48 + 0x05 + 40}));
+    }
+    auto stats = layer.Coalescer().Stats();
+    EXPECT_EQ(stats.reads, 1u);
+    EXPECT_EQ(stats.fresh_hits, 0u);
+}
+
+TEST(ReadCoalescingTest, DifferentReadsDoNotShare) {
+    FakeSensor sensor;
+    ReadCoalescingLayer layer(sensor, Fresh(std::chrono::seconds(10)));
+    auto* i2c = layer.GetI2c();
+
+    Byte a = 0, b = 0;
+    const Byte reg0 = 0, reg1 = 1;
+    ASSERT_TRUE(i2c->WriteRead(0x48, &reg0, 1, &a, 1).IsOk());
+    ASSERT_TRUE(i2c->WriteRead(0x48, &reg1, 1, &b, 1).IsOk());
+    ASSERT_TRUE(i2c->WriteRead(0x49, &reg0, 1, &b, 1).IsOk());
+    Byte block[2];
+    ASSERT_TRUE(i2c->Read(0x48, block, 2).IsOk());
+    EXPECT_EQ(sensor.transactions.load(), 4);
+    EXPECT_EQ(b, 0x49 + 40);
+}
+
+TEST(ReadCoalescingTest, FreshnessWindowReusesCompletedReads) {
+    FakeSensor sensor;
+    ReadCoalescingLayer inflight_only(sensor, {});
+    Byte value = 0;
+    ASSERT_TRUE(inflight_only.GetI2c()->Read(0x48, &value, 1).IsOk());
+    ASSERT_TRUE(inflight_only.GetI2c()->Read(0x48, &value, 1).IsOk());
+    EXPECT_EQ(sensor.transactions.load(), 2);
+
+    ReadCoalescingLayer windowed(sensor, Fresh(microseconds(20000)));
+    ASSERT_TRUE(windowed.GetI2c()->Read(0x48, &value, 1).IsOk());
+    sensor.temperature = 41;  // changes behind the window's back
+    ASSERT_TRUE(windowed.GetI2c()->Read(0x48, &value, 1).IsOk());
+    EXPECT_EQ(sensor.transactions.load(), 3);
+    EXPECT_EQ(value, 0x48 + 40);
+    EXPECT_EQ(windowed.Coalescer().Stats().fresh_hits, 1u);
+
+    std::this_thread::sleep_for(milliseconds(30));
+    ASSERT_TRUE(windowed.GetI2c()->Read(0x48, &value, 1).IsOk());
+    EXPECT_EQ(sensor.transactions.load(), 4);
+    EXPECT_EQ(value, 0x48 + 41);
+}
+
+TEST(ReadCoalescingTest, WritesAndErrorsAreNotReused) {
+    FakeSensor sensor;
+    ReadCoalescingLayer layer(sensor, Fresh(std::chrono::seconds(10)));
+    auto* i2c = layer.GetI2c();
+
+    Byte value = 0;
+    ASSERT_TRUE(i2c->Read(0x48, &value, 1).IsOk());
+    const Byte setpoint = 50;
+    ASSERT_TRUE(i2c->Write(0x48, &setpoint, 1).IsOk());
+    ASSERT_TRUE(i2c->Read(0x48, &value, 1).IsOk());
+    EXPECT_EQ(value, 0x48 + 50);
+    EXPECT_EQ(sensor.transactions.load(), 3);
+    EXPECT_EQ(layer.Coalescer().Stats().invalidations, 1u);
+
+    sensor.fail_next = true;
+    ASSERT_TRUE(i2c->Write(0x48, &setpoint, 1).IsOk());
+    EXPECT_TRUE(i2c->Read(0x48, &value, 1).IsError());
+    EXPECT_TRUE(i2c->Read(0x48, &value, 1).IsOk());
+    EXPECT_EQ(sensor.transactions.load(), 6);
+}
+
+TEST(ReadCoalescingTest, WaiterStopsAtItsDeadline) {
+    FakeSensor sensor;
+    ReadCoalescingLayer layer(sensor, {});
+    auto* i2c = layer.GetI2c();
+    sensor.Hold();
+
+    std::thread leader([&] {
+        Byte value = 0;
+        EXPECT_TRUE(i2c->Read(0x48, &value, 1).IsOk());
+    });
+    ASSERT_TRUE(WaitFor([&] { return sensor.transactions.load() == 1; }));
+    {
+        plas::core::ScopedDeadline scope(plas::core::Deadline::After(milliseconds(20)));
+        Byte value = 0;
+        EXPECT_EQ(i2c->Read(0x48, &value, 1).Error(),
+                  plas::core::make_error_code(ErrorCode::kTimeout));
+    }
+    sensor.Release();
+    leader.join();
+    EXPECT_EQ(sensor.transactions.load(), 1);
+}
+
+TEST(ReadCoalescingTest, CxlCoalescesReadOnlyCommandsThatSucceed) {
+    FakeSensor sensor;
+    ReadCoalescingLayer layer(sensor, Fresh(std::chrono::seconds(10)));
+    auto* mailbox = layer.GetCxlMailbox();
+    Bdf bdf{0x3a, 0, 0};
+
+    auto health = mailbox->ExecuteCommand(bdf, CxlMailboxOpcode::kGetHealthInfo, {});
+    ASSERT_TRUE(health.IsOk());
+    health = mailbox->ExecuteCommand(bdf, CxlMailboxOpcode::kGetHealthInfo, {});
+    ASSERT_TRUE(health.IsOk());
+    EXPECT_EQ(health.Value().payload, CxlMailboxPayload{40});
+    EXPECT_EQ(sensor.transactions.load(), 1);
+
+    // Writes always reach the device and drop the shared health info.
+    ASSERT_TRUE(mailbox->ExecuteCommand(bdf, CxlMailboxOpcode::kSetTimestamp, {}).IsOk());
+    ASSERT_TRUE(mailbox->ExecuteCommand(bdf, CxlMailboxOpcode::kSetTimestamp, {}).IsOk());
+    ASSERT_TRUE(mailbox->ExecuteCommand(bdf, CxlMailboxOpcode::kGetHealthInfo, {}).IsOk());
+    EXPECT_EQ(sensor.transactions.load(), 4);
+
+    // Pooled reads share the same flights.
+    ASSERT_TRUE(mailbox
+                    ->ExecuteCommandPooled(
+                        bdf, static_cast<uint16_t>(CxlMailboxOpcode::kGetHealthInfo),
+                        nullptr, 0)
+                    .IsOk());
+    EXPECT_EQ(sensor.transactions.load(), 4);
+
+    // A busy mailbox is not an answer worth keeping.
+    sensor.return_code = CxlMailboxReturnCode::kBusy;
+    ASSERT_TRUE(mailbox->ExecuteCommand(bdf, CxlMailboxOpcode::kGetAlertConfig, {}).IsOk());
+    sensor.return_code = CxlMailboxReturnCode::kSuccess;
+    auto alert = mailbox->ExecuteCommand(bdf, CxlMailboxOpcode::kGetAlertConfig, {});
+    ASSERT_TRUE(alert.IsOk());
+    EXPECT_EQ(alert.Value().return_code, CxlMailboxReturnCode::kSuccess);
+    EXPECT_EQ(sensor.transactions.load(), 6);
+}
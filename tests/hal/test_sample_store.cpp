@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/core/executor.h"
+#include "plas/hal/sample_store.h"
+#include "plas/hal/sampler.h"
+
+using plas::core::ErrorCode;
+using plas::core::Result;
+using plas::hal::Sample;
+using plas::hal::Sampler;
+using plas::hal::SamplerOptions;
+using plas::hal::SampleStore;
+using plas::hal::SampleStoreOptions;
+using plas::hal::SampleStoreReader;
+using namespace std::chrono_literals;
+
+namespace {
+
+std::vector<Sample> MakeSamples(std::size_t count, uint64_t start_ns = 1000) {
+    std::vector<Sample> samples(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        samples[i].timestamp_ns = start_ns + i * 1000;
+        samples[i].value = 3.3 + static_cast<double>(i % 7) * 0.01;
+    }
+    return samples;
+}
+
+}  // namespace
+
+class SampleStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = "test_sample_store_" + std::to_string(::testing::UnitTest::GetInstance()
+                                                          ->current_test_info()
+                                                          ->line());
+        std::filesystem::remove_all(dir_);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(dir_); }
+
+    SampleStoreOptions SmallBlocks() {
+        SampleStoreOptions options;
+        options.block_samples = 100;
+        options.map_window = 16384;
+        return options;
+    }
+
+    std::string dir_;
+};
+
+TEST_F(SampleStoreTest, RoundTripsSamplesAcrossBlocks) {
+    auto samples = MakeSamples(1050);
+    samples[10].error = ErrorCode::kTimeout;
+    {
+        SampleStore store(SmallBlocks());
+        ASSERT_TRUE(store.Open(dir_).IsOk());
+        ASSERT_TRUE(store.Append("psu0.voltage", samples.data(), 500).IsOk());
+        ASSERT_TRUE(store.Append("psu0.voltage", samples.data() + 500, 550).IsOk());
+    }  // Close() writes the last, short block
+
+    SampleStoreReader reader(dir_);
+    std::vector<Sample> out;
+    auto n = reader.Query("psu0.voltage", 0, UINT64_MAX, out);
+    ASSERT_TRUE(n.IsOk());
+    ASSERT_EQ(n.Value(), samples.size());
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        EXPECT_EQ(out[i].timestamp_ns, samples[i].timestamp_ns);
+        EXPECT_EQ(out[i].value, samples[i].value);
+    }
+    EXPECT_EQ(out[10].error, ErrorCode::kTimeout);
+    EXPECT_TRUE(out[11].Ok());
+
+    auto range = reader.GetRange("psu0.voltage");
+    ASSERT_TRUE(range.IsOk());
+    EXPECT_EQ(range.Value().count, 1050u);
+    EXPECT_EQ(range.Value().errors, 1u);
+    EXPECT_EQ(range.Value().blocks, 11u);
+    EXPECT_EQ(range.Value().first_ns, samples.front().timestamp_ns);
+    EXPECT_EQ(range.Value().last_ns, samples.back().timestamp_ns);
+}
+
+TEST_F(SampleStoreTest, QueriesATimeRange) {
+    auto samples = MakeSamples(1000);
+    SampleStore store(SmallBlocks());
+    ASSERT_TRUE(store.Open(dir_).IsOk());
+    ASSERT_TRUE(store.Append("temp", samples.data(), samples.size()).IsOk());
+    store.Close();
+
+    SampleStoreReader reader(dir_);
+    std::vector<Sample> out;
+    auto n = reader.Query("temp", samples[250].timestamp_ns, samples[349].timestamp_ns, out);
+    ASSERT_TRUE(n.IsOk());
+    ASSERT_EQ(n.Value(), 100u);
+    EXPECT_EQ(out.front().timestamp_ns, samples[250].timestamp_ns);
+    EXPECT_EQ(out.back().timestamp_ns, samples[349].timestamp_ns);
+
+    EXPECT_EQ(reader.Query("temp", 0, 500, out).Value(), 0u);
+    EXPECT_EQ(reader.Query("missing", 0, UINT64_MAX, out).Error(), ErrorCode::kNotFound);
+}
+
+TEST_F(SampleStoreTest, RepeatedValuesCompress) {
+    std::vector<Sample> samples(10000);
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        samples[i].timestamp_ns = 1'000'000'000 + i * 1'000'000;  // 1 ms apart
+        samples[i].value = 12.0;
+    }
+    SampleStore store;
+    ASSERT_TRUE(store.Open(dir_).IsOk());
+    ASSERT_TRUE(store.Append("psu0.voltage", samples.data(), samples.size()).IsOk());
+    store.Close();
+
+    // Three columns of about a byte each, against 32 bytes per Sample.
+    auto size = std::filesystem::file_size(dir_ + "/psu0.voltage.samples");
+    EXPECT_LT(size, samples.size() * 6);
+}
+
+TEST_F(SampleStoreTest, ReopenAppendsAndFlushMakesSamplesVisible) {
+    auto samples = MakeSamples(300);
+    {
+        SampleStore store(SmallBlocks());
+        ASSERT_TRUE(store.Open(dir_).IsOk());
+        ASSERT_TRUE(store.Append("a/b", samples.data(), 150).IsOk());
+    }
+
+    SampleStore store(SmallBlocks());
+    ASSERT_TRUE(store.Open(dir_).IsOk());
+    ASSERT_TRUE(store.Append("a/b", samples.data() + 150, 120).IsOk());
+
+    SampleStoreReader reader(dir_);
+    EXPECT_EQ(reader.GetRange("a/b").Value().count, 250u);  // 20 still pending
+    ASSERT_TRUE(store.Flush().IsOk());
+    EXPECT_EQ(reader.GetRange("a/b").Value().count, 270u);
+
+    std::vector<Sample> out;
+    ASSERT_EQ(reader.Query("a/b", 0, UINT64_MAX, out).Value(), 270u);
+    EXPECT_EQ(out[149].timestamp_ns, samples[149].timestamp_ns);
+    EXPECT_EQ(out[150].timestamp_ns, samples[150].timestamp_ns);
+
+    auto signals = reader.ListSignals();
+    ASSERT_TRUE(signals.IsOk());
+    EXPECT_EQ(signals.Value(), std::vector<std::string>{"a/b"});
+}
+
+TEST_F(SampleStoreTest, RejectsBadArguments) {
+    SampleStore store;
+    Sample sample;
+    EXPECT_EQ(store.Append("x", &sample, 1).Error(), ErrorCode::kNotInitialized);
+    EXPECT_EQ(store.Open("").Error(), ErrorCode::kInvalidArgument);
+
+    SampleStoreOptions tiny;
+    tiny.map_window = 1024;
+    EXPECT_EQ(SampleStore(tiny).Open(dir_).Error(), ErrorCode::kInvalidArgument);
+
+    ASSERT_TRUE(store.Open(dir_).IsOk());
+    EXPECT_EQ(store.Open(dir_).Error(), ErrorCode::kAlreadyOpen);
+    EXPECT_EQ(store.Append("", &sample, 1).Error(), ErrorCode::kInvalidArgument);
+    EXPECT_EQ(store.Append(std::string(200, 'x'), &sample, 1).Error(),
+              ErrorCode::kInvalidArgument);
+}
+
+TEST_F(SampleStoreTest, DrainsSamplerRings) {
+    plas::core::Executor executor{plas::core::ExecutorOptions{2, {}, "store-test"}};
+    SamplerOptions options;
+    options.executor = &executor;
+    Sampler sampler(options);
+    ASSERT_TRUE(sampler.AddSignal({"psu0.current", 2ms, "", [] {
+                                       return Result<double>::Ok(1.5);
+                                   }})
+                    .IsOk());
+
+    SampleStore store;
+    ASSERT_TRUE(store.Open(dir_).IsOk());
+    ASSERT_TRUE(sampler.Start().IsOk());
+    std::size_t moved = 0;
+    for (int i = 0; i < 5; ++i) {
+        std::this_thread::sleep_for(10ms);
+        moved += store.Drain(sampler).Value();
+    }
+    sampler.Stop();
+    moved += store.Drain(sampler).Value();
+    ASSERT_TRUE(store.Flush().IsOk());
+
+    SampleStoreReader reader(dir_);
+    std::vector<Sample> out;
+    ASSERT_GT(moved, 5u);
+    ASSERT_EQ(reader.Query("psu0.current", 0, UINT64_MAX, out).Value(), moved);
+    EXPECT_EQ(out[0].value, 1.5);
+}
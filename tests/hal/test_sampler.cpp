@@ -0,0 +1,274 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/core/error.h"
+#include "plas/core/executor.h"
+#include "plas/hal/device_manager.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/power_control.h"
+#include "plas/hal/sampler.h"
+
+using plas::core::ErrorCode;
+using plas::core::Result;
+using plas::hal::DeviceManager;
+using plas::hal::Sample;
+using plas::hal::Sampler;
+using plas::hal::SamplerOptions;
+using plas::hal::SamplerSignal;
+using plas::hal::SignalId;
+using namespace std::chrono_literals;
+
+namespace {
+
+// PSU with a PMBus-style I2C side: GetVoltage/GetCurrent return fixed
+// values; register reads return the register number in every byte.
+class FakePsu : public plas::hal::Device,
+                public plas::hal::PowerControl,
+                public plas::hal::I2c {
+public:
+    Result<void> Init() override { return Result<void>::Ok(); }
+    Result<void> Open() override { return Result<void>::Ok(); }
+    Result<void> Close() override { return Result<void>::Ok(); }
+    Result<void> Reset() override { return Result<void>::Ok(); }
+    plas::hal::DeviceState GetState() const override { return plas::hal::DeviceState::kOpen; }
+    std::string GetName() const override { return "psu"; }
+    std::string GetUri() const override { return "fake://psu"; }
+    std::string GetDriverName() const override { return "fake"; }
+    plas::hal::Device* GetDevice() override { return this; }
+
+    // -- PowerControl --
+    Result<void> SetVoltage(plas::core::Voltage) override { return Result<void>::Ok(); }
+    Result<plas::core::Voltage> GetVoltage() override {
+        return Result<plas::core::Voltage>::Ok(plas::core::Voltage(12.0));
+    }
+    Result<void> SetCurrent(plas::core::Current) override { return Result<void>::Ok(); }
+    Result<plas::core::Current> GetCurrent() override {
+        return Result<plas::core::Current>::Ok(plas::core::Current(1.5));
+    }
+    Result<void> PowerOn() override { return Result<void>::Ok(); }
+    Result<void> PowerOff() override { return Result<void>::Ok(); }
+    Result<bool> IsPowerOn() override { return Result<bool>::Ok(true); }
+
+    // -- I2c --
+    Result<size_t> Read(plas::core::Address, plas::core::Byte*, size_t, bool) override {
+        return Result<size_t>::Err(ErrorCode::kNotSupported);
+    }
+    Result<size_t> Write(plas::core::Address, const plas::core::Byte*, size_t, bool) override {
+        return Result<size_t>::Err(ErrorCode::kNotSupported);
+    }
+    Result<size_t> WriteRead(plas::core::Address, const plas::core::Byte*, size_t,
+                             plas::core::Byte*, size_t) override {
+        return Result<size_t>::Err(ErrorCode::kNotSupported);
+    }
+    Result<size_t> Transfer(plas::hal::I2cMessage* msgs, size_t count) override {
+        ++transfers;
+        messages += count;
+        plas::core::Byte reg = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (!msgs[i].read) {
+                reg = msgs[i].data[0];
+                continue;
+            }
+            for (size_t b = 0; b < msgs[i].length; ++b) {
+                msgs[i].data[b] = reg;
+            }
+        }
+        return Result<size_t>::Ok(count);
+    }
+    Result<void> SetBitrate(uint32_t) override { return Result<void>::Ok(); }
+    uint32_t GetBitrate() const override { return 100000; }
+
+    std::atomic<int> transfers{0};
+    std::atomic<std::size_t> messages{0};
+};
+
+class SamplerTest : public ::testing::Test {
+protected:
+    void SetUp() override { DeviceManager::GetInstance().Reset(); }
+    void TearDown() override { DeviceManager::GetInstance().Reset(); }
+
+    SamplerOptions Options() {
+        SamplerOptions options;
+        options.executor = &executor_;
+        return options;
+    }
+
+    plas::core::Executor executor_{plas::core::ExecutorOptions{2, {}, "sampler-test"}};
+};
+
+std::vector<Sample> Drain(Sampler& sampler, SignalId id) {
+    std::vector<Sample> samples(4096);
+    samples.resize(sampler.Read(id, samples.data(), samples.size()));
+    return samples;
+}
+
+TEST_F(SamplerTest, RejectsBadSignals) {
+    Sampler sampler(Options());
+    EXPECT_EQ(sampler.Start().Error(), ErrorCode::kNotInitialized);
+
+    auto read = [] { return Result<double>::Ok(1.0); };
+    EXPECT_TRUE(sampler.AddSignal({"a", 10ms, "", read}).IsOk());
+    EXPECT_EQ(sampler.AddSignal({"a", 10ms, "", read}).Error(), ErrorCode::kInvalidArgument);
+    EXPECT_EQ(sampler.AddSignal({"b", 0ms, "", read}).Error(), ErrorCode::kInvalidArgument);
+
+    Sampler unread(Options());
+    ASSERT_TRUE(unread.AddSignal({"c", 10ms, "", nullptr}).IsOk());
+    EXPECT_EQ(unread.Start().Error(), ErrorCode::kInvalidArgument);
+
+    ASSERT_TRUE(sampler.Start().IsOk());
+    EXPECT_EQ(sampler.Start().Error(), ErrorCode::kAlreadyOpen);
+    EXPECT_EQ(sampler.AddSignal({"d", 10ms, "", read}).Error(), ErrorCode::kBusy);
+    sampler.Stop();
+    EXPECT_FALSE(sampler.IsRunning());
+}
+
+TEST_F(SamplerTest, SamplesEachSignalAtItsOwnRate) {
+    Sampler sampler(Options());
+    std::atomic<int> fast_reads{0};
+    auto fast = sampler.AddSignal({"fast", 2ms, "", [&] {
+                                       return Result<double>::Ok(++fast_reads);
+                                   }});
+    auto slow = sampler.AddSignal({"slow", 20ms, "", [] { return Result<double>::Ok(7.0); }});
+    ASSERT_TRUE(fast.IsOk() && slow.IsOk());
+
+    ASSERT_TRUE(sampler.Start().IsOk());
+    std::this_thread::sleep_for(200ms);
+    sampler.Stop();
+
+    auto fast_samples = Drain(sampler, fast.Value());
+    auto slow_samples = Drain(sampler, slow.Value());
+    ASSERT_GE(slow_samples.size(), 3u);
+    EXPECT_GT(fast_samples.size(), 3 * slow_samples.size());
+    EXPECT_EQ(slow_samples[0].value, 7.0);
+    for (std::size_t i = 1; i < fast_samples.size(); ++i) {
+        EXPECT_GT(fast_samples[i].value, fast_samples[i - 1].value);
+        EXPECT_GT(fast_samples[i].timestamp_ns, fast_samples[i - 1].timestamp_ns);
+    }
+    EXPECT_EQ(sampler.GetStats(fast.Value()).Value().samples, fast_samples.size());
+}
+
+TEST_F(SamplerTest, DueSignalsOfOneKeyAreReadTogether) {
+    Sampler sampler(Options());
+    std::atomic<int> calls{0};
+    std::atomic<int> widest{0};
+    ASSERT_TRUE(sampler
+                    .SetBatchReader("bus0",
+                                    [&](const uint32_t* tags, std::size_t count, Sample* out) {
+                                        ++calls;
+                                        widest = std::max<int>(widest, static_cast<int>(count));
+                                        for (std::size_t i = 0; i < count; ++i) {
+                                            out[i].value = tags[i];
+                                        }
+                                    })
+                    .IsOk());
+    for (uint32_t tag = 0; tag < 3; ++tag) {
+        ASSERT_TRUE(sampler.AddSignal({"s" + std::to_string(tag), 5ms, "bus0", nullptr, tag})
+                        .IsOk());
+    }
+
+    ASSERT_TRUE(sampler.Start().IsOk());
+    std::this_thread::sleep_for(60ms);
+    sampler.Stop();
+
+    EXPECT_EQ(widest, 3);
+    auto samples = Drain(sampler, *sampler.FindSignal("s2"));
+    ASSERT_FALSE(samples.empty());
+    EXPECT_EQ(samples[0].value, 2.0);
+    EXPECT_EQ(static_cast<std::size_t>(calls.load()), samples.size());
+}
+
+TEST_F(SamplerTest, SlowReadsSkipInsteadOfQueueing) {
+    Sampler sampler(Options());
+    std::atomic<int> running{0};
+    std::atomic<int> overlap{0};
+    auto id = sampler.AddSignal({"slow", 1ms, "", [&] {
+                                     if (++running > 1) ++overlap;
+                                     std::this_thread::sleep_for(20ms);
+                                     --running;
+                                     return Result<double>::Err(ErrorCode::kTimeout);
+                                 }});
+    ASSERT_TRUE(id.IsOk());
+
+    ASSERT_TRUE(sampler.Start().IsOk());
+    std::this_thread::sleep_for(100ms);
+    sampler.Stop();
+    EXPECT_EQ(running, 0);  // Stop() waited for the read in progress
+
+    auto stats = sampler.GetStats(id.Value()).Value();
+    EXPECT_EQ(overlap, 0);
+    EXPECT_LE(stats.samples, 7u);
+    EXPECT_GT(stats.skipped, 50u);
+    EXPECT_EQ(stats.errors, stats.samples);
+    auto samples = Drain(sampler, id.Value());
+    ASSERT_FALSE(samples.empty());
+    EXPECT_EQ(samples[0].error, ErrorCode::kTimeout);
+    EXPECT_EQ(sampler.GetStats(99).Error(), ErrorCode::kOutOfRange);
+}
+
+TEST_F(SamplerTest, FullRingDropsNewSamples) {
+    auto options = Options();
+    options.ring_capacity = 4;
+    Sampler sampler(options);
+    auto id = sampler.AddSignal({"a", 1ms, "", [] { return Result<double>::Ok(1.0); }});
+    ASSERT_TRUE(sampler.Start().IsOk());
+    std::this_thread::sleep_for(30ms);
+    sampler.Stop();
+
+    auto stats = sampler.GetStats(id.Value()).Value();
+    EXPECT_EQ(Drain(sampler, id.Value()).size(), 4u);
+    EXPECT_EQ(stats.dropped, stats.samples - 4);
+}
+
+TEST_F(SamplerTest, AddsSignalsFromConfigArgs) {
+    auto& dm = DeviceManager::GetInstance();
+    auto device = std::make_unique<FakePsu>();
+    auto* psu = device.get();
+    plas::config::DeviceEntry entry{"psu0", "fake://psu", "fake", {}};
+    entry.args[plas::config::kSampleArg] =
+        "voltage@5ms, current@5ms, i2c:0x58:0x8B:2@5ms, i2c:0x58:0x8C@5ms";
+    ASSERT_TRUE(dm.AddDevice(entry, std::move(device)).IsOk());
+
+    Sampler sampler(Options());
+    auto added = sampler.AddFromConfig(dm);
+    ASSERT_TRUE(added.IsOk());
+    EXPECT_EQ(added.Value(), 4u);
+    auto volts = sampler.FindSignal("psu0.voltage");
+    auto vout = sampler.FindSignal("psu0.i2c:0x58:0x8B:2");
+    auto iout = sampler.FindSignal("psu0.i2c:0x58:0x8C");
+    ASSERT_TRUE(volts && vout && iout);
+
+    ASSERT_TRUE(sampler.Start().IsOk());
+    std::this_thread::sleep_for(40ms);
+    sampler.Stop();
+
+    auto v = Drain(sampler, *volts);
+    auto reg2 = Drain(sampler, *vout);
+    auto reg1 = Drain(sampler, *iout);
+    ASSERT_FALSE(v.empty());
+    ASSERT_FALSE(reg2.empty());
+    EXPECT_EQ(v[0].value, 12.0);
+    EXPECT_EQ(reg2[0].value, 0x8B8B);
+    EXPECT_EQ(reg1[0].value, 0x8C);
+    // Both register reads of a round share one Transfer.
+    EXPECT_EQ(psu->messages.load(), 4 * static_cast<std::size_t>(psu->transfers.load()));
+}
+
+TEST_F(SamplerTest, RejectsMalformedConfigArgs) {
+    auto& dm = DeviceManager::GetInstance();
+    plas::config::DeviceEntry entry{"psu0", "fake://psu", "fake", {}};
+    entry.args[plas::config::kSampleArg] = "voltage@5ms,temperature@1s";
+    ASSERT_TRUE(dm.AddDevice(entry, std::make_unique<FakePsu>()).IsOk());
+
+    Sampler sampler(Options());
+    EXPECT_EQ(sampler.AddFromConfig(dm).Error(), ErrorCode::kInvalidArgument);
+    EXPECT_EQ(sampler.SignalCount(), 0u);  // all or nothing
+}
+
+}  // namespace
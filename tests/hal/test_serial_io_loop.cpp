@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/serial_io_loop.h"
+
+namespace plas::hal {
+namespace {
+
+using std::chrono::milliseconds;
+
+// A pipe pair stands in for a UART: the loop serves one end, the test
+// plays the remote side on the other.
+class SerialIoLoopTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(::pipe(rx_pipe_), 0);
+        ASSERT_EQ(::pipe(tx_pipe_), 0);
+    }
+
+    void TearDown() override {
+        for (int fd : {rx_pipe_[0], rx_pipe_[1], tx_pipe_[0], tx_pipe_[1]}) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+
+    void Send(const std::string& text) {
+        ASSERT_EQ(::write(rx_pipe_[1], text.data(), text.size()),
+                  static_cast<ssize_t>(text.size()));
+    }
+
+    int rx_pipe_[2] = {-1, -1};  // test writes [1], loop reads [0]
+    int tx_pipe_[2] = {-1, -1};  // loop writes [1], test reads [0]
+    SerialIoLoop loop_;
+};
+
+TEST_F(SerialIoLoopTest, ReadTimesOutWhenIdle) {
+    auto id = loop_.AddPort(rx_pipe_[0], {});
+    ASSERT_TRUE(id.IsOk());
+    EXPECT_EQ(loop_.PortCount(), 1u);
+
+    core::Byte buf[8];
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(loop_.Read(id.Value(), buf, sizeof(buf), milliseconds(30)).Error(),
+              core::make_error_code(core::ErrorCode::kTimeout));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, milliseconds(25));
+    EXPECT_TRUE(loop_.RemovePort(id.Value()).IsOk());
+    EXPECT_EQ(loop_.RemovePort(id.Value()).Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+}
+
+TEST_F(SerialIoLoopTest, BuffersInBackgroundAndNotifies) {
+    std::atomic<int> ready{0};
+    SerialPortOptions options;
+    options.on_readable = [&] { ready++; };
+    auto id = loop_.AddPort(rx_pipe_[0], options);
+    ASSERT_TRUE(id.IsOk());
+    EXPECT_NE(::fcntl(rx_pipe_[0], F_GETFL) & O_NONBLOCK, 0);
+
+    Send("hello ");
+    Send("world");
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (loop_.Available(id.Value()) < 11 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    EXPECT_EQ(loop_.Available(id.Value()), 11u);
+    EXPECT_GE(ready.load(), 1);
+
+    core::Byte buf[32];
+    auto n = loop_.Read(id.Value(), buf, sizeof(buf), milliseconds(0));
+    ASSERT_TRUE(n.IsOk());
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(buf), n.Value()), "hello world");
+    EXPECT_EQ(loop_.Available(id.Value()), 0u);
+    EXPECT_TRUE(loop_.RemovePort(id.Value()).IsOk());
+}
+
+TEST_F(SerialIoLoopTest, BlockedReaderWakesOnData) {
+    auto id = loop_.AddPort(rx_pipe_[0], {});
+    ASSERT_TRUE(id.IsOk());
+    std::thread remote([&] {
+        std::this_thread::sleep_for(milliseconds(20));
+        Send("x");
+    });
+    core::Byte buf[4];
+    auto n = loop_.Read(id.Value(), buf, sizeof(buf), milliseconds(5000));
+    remote.join();
+    ASSERT_TRUE(n.IsOk());
+    EXPECT_EQ(n.Value(), 1u);
+    EXPECT_EQ(buf[0], 'x');
+    EXPECT_TRUE(loop_.RemovePort(id.Value()).IsOk());
+}
+
+TEST_F(SerialIoLoopTest, OverflowDropsNewestAndCounts) {
+    SerialPortOptions options;
+    options.rx_capacity = 16;
+    auto id = loop_.AddPort(rx_pipe_[0], options);
+    ASSERT_TRUE(id.IsOk());
+    Send(std::string(40, 'a'));
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (loop_.RxDropped(id.Value()) < 24 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    EXPECT_EQ(loop_.Available(id.Value()), 16u);
+    EXPECT_EQ(loop_.RxDropped(id.Value()), 24u);
+    EXPECT_TRUE(loop_.RemovePort(id.Value()).IsOk());
+}
+
+TEST_F(SerialIoLoopTest, HangupEndsReadsAfterDrain) {
+    auto id = loop_.AddPort(rx_pipe_[0], {});
+    ASSERT_TRUE(id.IsOk());
+    Send("ab");
+    ::close(rx_pipe_[1]);
+    rx_pipe_[1] = -1;
+
+    core::Byte buf[4];
+    std::string got;
+    for (int i = 0; i < 3 && got.size() < 2; ++i) {
+        auto n = loop_.Read(id.Value(), buf, sizeof(buf), milliseconds(1000));
+        ASSERT_TRUE(n.IsOk());
+        got.append(reinterpret_cast<char*>(buf), n.Value());
+    }
+    EXPECT_EQ(got, "ab");
+    EXPECT_EQ(loop_.Read(id.Value(), buf, sizeof(buf), milliseconds(1000)).Error(),
+              core::make_error_code(core::ErrorCode::kIOError));
+    EXPECT_TRUE(loop_.RemovePort(id.Value()).IsOk());
+}
+
+TEST_F(SerialIoLoopTest, WriteQueuesAndDrains) {
+    auto id = loop_.AddPort(tx_pipe_[1], {});
+    ASSERT_TRUE(id.IsOk());
+
+    // Larger than the pipe buffer: the loop must finish it on EPOLLOUT
+    // while the remote side reads.
+    const std::vector<core::Byte> payload(256 * 1024, 0x5A);
+    std::vector<core::Byte> received;
+    std::thread remote([&] {
+        core::Byte buf[4096];
+        while (received.size() < payload.size()) {
+            ssize_t n = ::read(tx_pipe_[0], buf, sizeof(buf));
+            if (n <= 0) {
+                break;
+            }
+            received.insert(received.end(), buf, buf + n);
+        }
+    });
+
+    size_t sent = 0;
+    while (sent < payload.size()) {
+        auto n = loop_.Write(id.Value(), payload.data() + sent, payload.size() - sent,
+                             milliseconds(5000));
+        ASSERT_TRUE(n.IsOk());
+        sent += n.Value();
+    }
+    EXPECT_TRUE(loop_.Drain(id.Value(), milliseconds(5000)).IsOk());
+    remote.join();
+    EXPECT_EQ(received, payload);
+    EXPECT_TRUE(loop_.RemovePort(id.Value()).IsOk());
+}
+
+TEST_F(SerialIoLoopTest, WriteTimesOutWhenRemoteStalls) {
+    SerialPortOptions options;
+    options.tx_capacity = 16;
+    auto id = loop_.AddPort(tx_pipe_[1], options);
+    ASSERT_TRUE(id.IsOk());
+
+    // Nobody reads tx_pipe_[0]: once the pipe and the ring are full,
+    // Write() returns kTimeout instead of blocking forever.
+    const std::vector<core::Byte> chunk(4096, 0x11);
+    core::Result<size_t> result = core::Result<size_t>::Ok(0);
+    for (int i = 0; i < 1024 && result.IsOk(); ++i) {
+        result = loop_.Write(id.Value(), chunk.data(), chunk.size(), milliseconds(20));
+    }
+    EXPECT_EQ(result.Error(), core::make_error_code(core::ErrorCode::kTimeout));
+    EXPECT_EQ(loop_.Drain(id.Value(), milliseconds(20)).Error(),
+              core::make_error_code(core::ErrorCode::kTimeout));
+    EXPECT_TRUE(loop_.RemovePort(id.Value()).IsOk());
+}
+
+TEST_F(SerialIoLoopTest, ManyPortsOneLoop) {
+    constexpr int kPorts = 16;
+    std::vector<int> fds;
+    std::vector<SerialIoLoop::PortId> ids;
+    for (int i = 0; i < kPorts; ++i) {
+        int p[2];
+        ASSERT_EQ(::pipe(p), 0);
+        fds.push_back(p[0]);
+        fds.push_back(p[1]);
+        auto id = loop_.AddPort(p[0], {});
+        ASSERT_TRUE(id.IsOk());
+        ids.push_back(id.Value());
+        const char c = static_cast<char>('A' + i);
+        ASSERT_EQ(::write(p[1], &c, 1), 1);
+    }
+    EXPECT_EQ(loop_.PortCount(), static_cast<size_t>(kPorts));
+    for (int i = 0; i < kPorts; ++i) {
+        core::Byte b = 0;
+        auto n = loop_.Read(ids[static_cast<size_t>(i)], &b, 1, milliseconds(5000));
+        ASSERT_TRUE(n.IsOk());
+        EXPECT_EQ(b, static_cast<core::Byte>('A' + i));
+    }
+    for (auto id : ids) {
+        EXPECT_TRUE(loop_.RemovePort(id).IsOk());
+    }
+    for (int fd : fds) {
+        ::close(fd);
+    }
+    EXPECT_EQ(loop_.PortCount(), 0u);
+}
+
+TEST(SerialIoLoopArgs, RejectsBadPorts) {
+    SerialIoLoop loop;
+    EXPECT_EQ(loop.AddPort(-1, {}).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    SerialPortOptions options;
+    options.rx_capacity = 0;
+    EXPECT_EQ(loop.AddPort(0, options).Error(),
+              core::make_error_code(core::ErrorCode::kInvalidArgument));
+    core::Byte b;
+    EXPECT_EQ(loop.Read(42, &b, 1, milliseconds(0)).Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+    EXPECT_EQ(loop.Available(42), 0u);
+}
+
+}  // namespace
+}  // namespace plas::hal
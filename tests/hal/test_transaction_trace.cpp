@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "plas/hal/interface/device.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/transaction_trace.h"
+
+using plas::core::Byte;
+using plas::core::ErrorCode;
+using plas::core::Result;
+using plas::hal::InterfaceKind;
+using plas::hal::TraceFile;
+using plas::hal::TraceOp;
+using plas::hal::TraceRecord;
+using plas::hal::TraceWriter;
+
+namespace {
+
+std::string TracePath(const std::string& name) {
+    return ::testing::TempDir() + name;
+}
+
+class FakeDevice : public plas::hal::Device {
+public:
+    Result<void> Init() override { return Result<void>::Ok(); }
+    Result<void> Open() override { return Result<void>::Ok(); }
+    Result<void> Close() override { return Result<void>::Ok(); }
+    Result<void> Reset() override { return Result<void>::Ok(); }
+    plas::hal::DeviceState GetState() const override {
+        return plas::hal::DeviceState::kOpen;
+    }
+    std::string GetName() const override { return "fake0"; }
+    std::string GetUri() const override { return "fake://0:0x50"; }
+    std::string GetDriverName() const override { return "fake"; }
+};
+
+/// Reads return incrementing bytes; address 0x51 NACKs.
+class FakeI2cDevice : public FakeDevice, public plas::hal::I2c {
+public:
+    plas::hal::Device* GetDevice() override { return this; }
+    Result<size_t> Read(plas::core::Address addr, Byte* data, size_t length,
+                        bool) override {
+        if (addr == 0x51) return Result<size_t>::Err(ErrorCode::kIOError);
+        for (size_t i = 0; i < length; ++i) data[i] = static_cast<Byte>(next_++);
+        return Result<size_t>::Ok(length);
+    }
+    Result<size_t> Write(plas::core::Address addr, const Byte*, size_t length,
+                         bool) override {
+        if (addr == 0x51) return Result<size_t>::Err(ErrorCode::kIOError);
+        return Result<size_t>::Ok(length);
+    }
+    Result<size_t> WriteRead(plas::core::Address addr, const Byte* w, size_t wl,
+                             Byte* r, size_t rl) override {
+        auto written = Write(addr, w, wl, false);
+        if (written.IsError()) return written;
+        return Read(addr, r, rl, true);
+    }
+    Result<void> SetBitrate(uint32_t bitrate) override {
+        bitrate_ = bitrate;
+        return Result<void>::Ok();
+    }
+    uint32_t GetBitrate() const override { return bitrate_; }
+
+private:
+    int next_ = 0;
+    uint32_t bitrate_ = 100000;
+};
+
+}  // namespace
+
+// --- File format ---
+
+TEST(TransactionTraceTest, RoundTripsDevicesAndRecords) {
+    const auto path = TracePath("trace_roundtrip.plastrace");
+    {
+        auto writer = TraceWriter::Open(path);
+        ASSERT_TRUE(writer.IsOk());
+        auto& w = *writer.Value();
+        EXPECT_EQ(w.AddDevice({"eeprom", "aardvark://0:0x50", "aardvark",
+                               1u << static_cast<uint32_t>(InterfaceKind::kI2c)}),
+                  0u);
+        EXPECT_EQ(w.AddDevice({"nvme", "pciutils://0000:03:00.0", "pciutils", 0x1C0}), 1u);
+
+        TraceRecord read;
+        read.device = 0;
+        read.op = TraceOp::kI2cWriteRead;
+        read.start_ns = 5000;
+        read.duration_ns = 123456;
+        read.target = 0x50;
+        read.length = 3;
+        read.value = 3;
+        read.request = {0x00, 0x10};
+        read.response = {0xAA, 0xBB, 0xCC};
+        w.Write(read);
+
+        // Completed out of order: starts before the previous record.
+        TraceRecord doe;
+        doe.device = 1;
+        doe.op = TraceOp::kDoeExchange;
+        doe.error = ErrorCode::kTimeout;
+        doe.start_ns = 4000;
+        doe.duration_ns = 1000000;
+        doe.target = 0x0300;
+        doe.offset = 0x160;
+        doe.arg = 0x00011E98;
+        doe.request = plas::hal::EncodeTraceDWords(std::vector<uint32_t>{1, 2}.data(), 2);
+        w.Write(doe);
+
+        TraceRecord bar;
+        bar.device = 1;
+        bar.op = TraceOp::kBarRead64;
+        bar.start_ns = 7000;
+        bar.value = 0xFEDCBA9876543210ull;
+        bar.arg = 2;
+        bar.offset = 0x1000;
+        w.Write(bar);
+        EXPECT_EQ(w.RecordCount(), 3u);
+        EXPECT_TRUE(w.Flush().IsOk());
+    }
+
+    auto loaded = TraceFile::Load(path);
+    ASSERT_TRUE(loaded.IsOk());
+    const auto& trace = loaded.Value();
+    ASSERT_EQ(trace.devices.size(), 2u);
+    EXPECT_EQ(trace.devices[0].name, "eeprom");
+    EXPECT_EQ(trace.devices[0].uri, "aardvark://0:0x50");
+    EXPECT_TRUE(trace.devices[0].Has(InterfaceKind::kI2c));
+    EXPECT_FALSE(trace.devices[0].Has(InterfaceKind::kPciConfig));
+    EXPECT_EQ(trace.FindDevice("nvme"), 1);
+    EXPECT_EQ(trace.FindDevice("missing"), -1);
+
+    ASSERT_EQ(trace.records.size(), 3u);
+    const auto& r0 = trace.records[0];
+    EXPECT_EQ(r0.op, TraceOp::kI2cWriteRead);
+    EXPECT_EQ(r0.start_ns, 5000u);
+    EXPECT_EQ(r0.duration_ns, 123456u);
+    EXPECT_EQ(r0.request, (std::vector<Byte>{0x00, 0x10}));
+    EXPECT_EQ(r0.response, (std::vector<Byte>{0xAA, 0xBB, 0xCC}));
+    const auto& r1 = trace.records[1];
+    EXPECT_EQ(r1.start_ns, 4000u);
+    EXPECT_EQ(r1.error, ErrorCode::kTimeout);
+    EXPECT_EQ(r1.arg, 0x00011E98u);
+    EXPECT_EQ(plas::hal::DecodeTraceDWords(r1.request), (std::vector<uint32_t>{1, 2}));
+    EXPECT_EQ(trace.records[2].value, 0xFEDCBA9876543210ull);
+    EXPECT_EQ(trace.records[2].start_ns, 7000u);
+}
+
+TEST(TransactionTraceTest, TruncatedTailIsDropped) {
+    const auto path = TracePath("trace_truncated.plastrace");
+    {
+        auto writer = TraceWriter::Open(path);
+        ASSERT_TRUE(writer.IsOk());
+        writer.Value()->AddDevice({"dev", "fake://0:0", "fake", 1});
+        for (int i = 0; i < 10; ++i) {
+            TraceRecord record;
+            record.op = TraceOp::kI2cWrite;
+            record.request.assign(100, static_cast<Byte>(i));
+            writer.Value()->Write(record);
+        }
+    }
+    std::ifstream in(path, std::ios::binary);
+    std::string bytes{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    in.close();
+    std::ofstream(path, std::ios::binary | std::ios::trunc)
+        << bytes.substr(0, bytes.size() - 50);
+
+    auto loaded = TraceFile::Load(path);
+    ASSERT_TRUE(loaded.IsOk());
+    EXPECT_EQ(loaded.Value().records.size(), 9u);
+}
+
+TEST(TransactionTraceTest, RejectsMissingAndForeignFiles) {
+    EXPECT_EQ(TraceFile::Load(TracePath("no_such.plastrace")).Error(), ErrorCode::kNotFound);
+    const auto path = TracePath("not_a_trace.txt");
+    std::ofstream(path) << "hello, world";
+    EXPECT_EQ(TraceFile::Load(path).Error(), ErrorCode::kDataLoss);
+    EXPECT_EQ(TraceWriter::Open("/nonexistent-dir/x.plastrace").Error(), ErrorCode::kIOError);
+}
+
+// --- Recording ---
+
+TEST(TransactionTraceTest, RecordingExposesOnlyWrappedInterfaces) {
+    auto writer = TraceWriter::Open(TracePath("trace_plain.plastrace")).Value();
+    auto plain = std::make_unique<FakeDevice>();
+    auto* raw = plain.get();
+    auto same = plas::hal::RecordTransactions(std::move(plain), writer);
+    EXPECT_EQ(same.get(), raw);  // nothing to record
+
+    auto wrapped = plas::hal::RecordTransactions(std::make_unique<FakeI2cDevice>(), writer);
+    EXPECT_NE(dynamic_cast<plas::hal::I2c*>(wrapped.get()), nullptr);
+    EXPECT_EQ(dynamic_cast<plas::hal::pci::PciConfig*>(wrapped.get()), nullptr);
+    EXPECT_EQ(wrapped->GetName(), "fake0");
+    EXPECT_EQ(wrapped->GetDriverName(), "fake");
+    EXPECT_EQ(dynamic_cast<plas::hal::I2c*>(wrapped.get())->GetDevice(), wrapped.get());
+}
+
+TEST(TransactionTraceTest, RecordsI2cCallsAndErrors) {
+    const auto path = TracePath("trace_i2c.plastrace");
+    {
+        auto writer = TraceWriter::Open(path).Value();
+        auto device = plas::hal::RecordTransactions(std::make_unique<FakeI2cDevice>(), writer);
+        auto* i2c = dynamic_cast<plas::hal::I2c*>(device.get());
+        ASSERT_NE(i2c, nullptr);
+
+        Byte buf[4] = {};
+        const Byte reg[] = {0x10};
+        ASSERT_TRUE(i2c->WriteRead(0x50, reg, 1, buf, 4).IsOk());
+        EXPECT_TRUE(i2c->Read(0x51, buf, 2).IsError());
+
+        Byte payload[] = {0xDE, 0xAD};
+        Byte rx[2] = {};
+        plas::hal::I2cMessage msgs[2] = {{0x50, payload, 2, false, false, 0},
+                                         {0x50, rx, 2, true, false, 0}};
+        ASSERT_TRUE(i2c->Transfer(msgs, 2).IsOk());
+        EXPECT_EQ(writer->RecordCount(), 4u);
+    }
+
+    auto trace = TraceFile::Load(path).Value();
+    ASSERT_EQ(trace.devices.size(), 1u);
+    EXPECT_EQ(trace.devices[0].name, "fake0");
+    ASSERT_EQ(trace.records.size(), 4u);
+
+    const auto& wr = trace.records[0];
+    EXPECT_EQ(wr.op, TraceOp::kI2cWriteRead);
+    EXPECT_EQ(wr.target, 0x50u);
+    EXPECT_EQ(wr.request, (std::vector<Byte>{0x10}));
+    EXPECT_EQ(wr.response, (std::vector<Byte>{0, 1, 2, 3}));
+    EXPECT_EQ(wr.value, 4u);
+
+    const auto& nack = trace.records[1];
+    EXPECT_EQ(nack.op, TraceOp::kI2cRead);
+    EXPECT_EQ(nack.error, ErrorCode::kIOError);
+    EXPECT_EQ(nack.length, 2u);
+    EXPECT_EQ(nack.arg, 1u);  // stop
+    EXPECT_TRUE(nack.response.empty());
+
+    EXPECT_EQ(trace.records[2].op, TraceOp::kI2cWrite);
+    EXPECT_EQ(trace.records[2].request, (std::vector<Byte>{0xDE, 0xAD}));
+    EXPECT_EQ(trace.records[2].arg, 0u);
+    EXPECT_EQ(trace.records[3].op, TraceOp::kI2cRead);
+    EXPECT_EQ(trace.records[3].response, (std::vector<Byte>{4, 5}));
+    EXPECT_EQ(trace.records[3].arg, 1u);  // last message ends with STOP
+}
@@ -0,0 +1,64 @@
+// Compiles the logging macros with a WARN floor, as a release build using
+// -DPLAS_LOG_COMPILED_LEVEL=WARN would, overriding the target's default.
+#undef PLAS_LOG_COMPILED_LEVEL
+#define PLAS_LOG_COMPILED_LEVEL 3  // PLAS_LOG_LEVEL_WARN
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+
+#include "plas/log/log_config.h"
+#include "plas/log/logger.h"
+
+using plas::log::LogConfig;
+using plas::log::LogLevel;
+using plas::log::Logger;
+
+namespace {
+
+class LogCompiledLevelTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::filesystem::create_directories(log_dir_);
+        LogConfig config;
+        config.log_dir = log_dir_;
+        config.file_prefix = "compiled_level";
+        config.level = LogLevel::kTrace;  // runtime level lets everything through
+        config.console_enabled = false;
+        Logger::GetInstance().Init(config);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(log_dir_); }
+
+    std::string log_dir_ = "test_logs_compiled_level";
+};
+
+TEST_F(LogCompiledLevelTest, LevelsBelowFloorAreCompiledOut) {
+    int evaluated = 0;
+    auto make_msg = [&evaluated] {
+        ++evaluated;
+        return std::string("msg");
+    };
+
+    PLAS_LOG_TRACE(make_msg());
+    PLAS_LOG_DEBUG(make_msg());
+    PLAS_LOG_INFO(make_msg());
+    PLAS_LOG_DEBUGF("%d", ++evaluated);
+    EXPECT_EQ(evaluated, 0);
+}
+
+TEST_F(LogCompiledLevelTest, LevelsAtOrAboveFloorStillLog) {
+    int evaluated = 0;
+    auto make_msg = [&evaluated] {
+        ++evaluated;
+        return std::string("msg");
+    };
+
+    PLAS_LOG_WARN(make_msg());
+    PLAS_LOG_ERROR(make_msg());
+    PLAS_LOG_CRITICALF("%d", ++evaluated);
+    EXPECT_EQ(evaluated, 3);
+}
+
+}  // namespace
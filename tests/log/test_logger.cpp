@@ -1,16 +1,38 @@
 #include <gtest/gtest.h>
 
 #include <filesystem>
+#include <fstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "plas/log/log_config.h"
 #include "plas/log/log_level.h"
 #include "plas/log/logger.h"
 
 using plas::log::LogConfig;
+using plas::log::LogFileMode;
 using plas::log::LogLevel;
+using plas::log::LogOverflowPolicy;
 using plas::log::Logger;
 
+namespace {
+
+std::size_t CountLinesContaining(const std::string& path,
+                                 const std::string& needle) {
+    std::ifstream in(path);
+    std::string line;
+    std::size_t count = 0;
+    while (std::getline(in, line)) {
+        if (line.find(needle) != std::string::npos) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+}  // namespace
+
 class LoggerTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -76,6 +98,328 @@ TEST_F(LoggerTest, AllLogLevels) {
     logger.Critical("critical message");
 }
 
+TEST_F(LoggerTest, ShouldLogFollowsLevel) {
+    LogConfig config;
+    config.log_dir = log_dir_;
+    config.file_prefix = "should_log";
+    config.level = LogLevel::kWarn;
+    config.console_enabled = false;
+
+    auto& logger = Logger::GetInstance();
+    logger.Init(config);
+
+    EXPECT_FALSE(logger.ShouldLog(LogLevel::kDebug));
+    EXPECT_FALSE(logger.ShouldLog(LogLevel::kInfo));
+    EXPECT_TRUE(logger.ShouldLog(LogLevel::kWarn));
+    EXPECT_TRUE(logger.ShouldLog(LogLevel::kCritical));
+
+    logger.SetLevel(LogLevel::kTrace);
+    EXPECT_TRUE(logger.ShouldLog(LogLevel::kTrace));
+}
+
+TEST_F(LoggerTest, MacrosSkipArgumentsBelowLevel) {
+    LogConfig config;
+    config.log_dir = log_dir_;
+    config.file_prefix = "lazy";
+    config.level = LogLevel::kError;
+    config.console_enabled = false;
+    Logger::GetInstance().Init(config);
+
+    int evaluated = 0;
+    auto make_msg = [&evaluated] {
+        ++evaluated;
+        return std::string("built");
+    };
+
+    PLAS_LOG_DEBUG(make_msg());
+    PLAS_LOG_INFO(make_msg());
+    PLAS_LOG_DEBUGF("%s %d", make_msg().c_str(), ++evaluated);
+    EXPECT_EQ(evaluated, 0);
+
+    PLAS_LOG_ERROR(make_msg());
+    PLAS_LOG_ERRORF("value=%d", ++evaluated);
+    EXPECT_EQ(evaluated, 2);
+}
+
+TEST_F(LoggerTest, MacrosWorkAsSingleStatement) {
+    LogConfig config;
+    config.log_dir = log_dir_;
+    config.file_prefix = "stmt";
+    config.level = LogLevel::kTrace;
+    config.console_enabled = false;
+    Logger::GetInstance().Init(config);
+
+    bool flag = true;
+    if (flag)
+        PLAS_LOG_INFO("taken");
+    else
+        PLAS_LOG_WARN("not taken");
+    PLAS_LOG_TRACEF("no args");
+}
+
+TEST_F(LoggerTest, AsyncBlockWritesEveryMessage) {
+    LogConfig config;
+    config.log_dir = log_dir_;
+    config.file_prefix = "async_block";
+    config.level = LogLevel::kTrace;
+    config.console_enabled = false;
+    config.async_enabled = true;
+    config.async_queue_size = 8;
+    config.overflow_policy = LogOverflowPolicy::kBlock;
+
+    auto& logger = Logger::GetInstance();
+    logger.Init(config);
+
+    const int kThreads = 4;
+    const int kPerThread = 250;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&logger, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                logger.Warn("async-block t=" + std::to_string(t));
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    logger.Flush();
+
+    EXPECT_EQ(CountLinesContaining(logger.GetCurrentLogFile(), "async-block"),
+              static_cast<std::size_t>(kThreads * kPerThread));
+    auto drops = logger.GetDropStats();
+    EXPECT_EQ(drops.dropped_oldest, 0u);
+    EXPECT_EQ(drops.dropped_newest, 0u);
+}
+
+TEST_F(LoggerTest, AsyncDropNewestAccountsForEveryMessage) {
+    LogConfig config;
+    config.log_dir = log_dir_;
+    config.file_prefix = "async_drop_newest";
+    config.level = LogLevel::kTrace;
+    config.console_enabled = false;
+    config.async_enabled = true;
+    config.async_queue_size = 2;
+    config.overflow_policy = LogOverflowPolicy::kDropNewest;
+
+    auto& logger = Logger::GetInstance();
+    logger.Init(config);
+
+    const std::size_t kMessages = 2000;
+    for (std::size_t i = 0; i < kMessages; ++i) {
+        logger.Info("drop-newest " + std::to_string(i));
+    }
+    logger.Flush();
+
+    auto written =
+        CountLinesContaining(logger.GetCurrentLogFile(), "drop-newest");
+    auto drops = logger.GetDropStats();
+    EXPECT_EQ(drops.dropped_oldest, 0u);
+    EXPECT_EQ(written + drops.dropped_newest, kMessages);
+}
+
+TEST_F(LoggerTest, AsyncDropOldestAccountsForEveryMessage) {
+    LogConfig config;
+    config.log_dir = log_dir_;
+    config.file_prefix = "async_drop_oldest";
+    config.level = LogLevel::kTrace;
+    config.console_enabled = false;
+    config.async_enabled = true;
+    config.async_queue_size = 2;
+    config.overflow_policy = LogOverflowPolicy::kDropOldest;
+
+    auto& logger = Logger::GetInstance();
+    logger.Init(config);
+
+    const std::size_t kMessages = 2000;
+    for (std::size_t i = 0; i < kMessages; ++i) {
+        logger.Info("drop-oldest " + std::to_string(i));
+    }
+    logger.Flush();
+
+    auto path = logger.GetCurrentLogFile();
+    auto written = CountLinesContaining(path, "drop-oldest");
+    auto drops = logger.GetDropStats();
+    EXPECT_EQ(drops.dropped_newest, 0u);
+    EXPECT_EQ(written + drops.dropped_oldest, kMessages);
+    // The newest message always survives under drop-oldest.
+    EXPECT_EQ(CountLinesContaining(path, "drop-oldest 1999"), 1u);
+}
+
+TEST_F(LoggerTest, ReinitSwitchesBackToSync) {
+    LogConfig config;
+    config.log_dir = log_dir_;
+    config.file_prefix = "reinit";
+    config.level = LogLevel::kTrace;
+    config.console_enabled = false;
+    config.async_enabled = true;
+
+    auto& logger = Logger::GetInstance();
+    logger.Init(config);
+    logger.Info("reinit-async");
+
+    config.async_enabled = false;
+    logger.Init(config);  // drains the async writer before rebuilding
+    logger.Info("reinit-sync");
+    logger.Flush();
+
+    auto path = logger.GetCurrentLogFile();
+    EXPECT_EQ(CountLinesContaining(path, "reinit-async"), 1u);
+    EXPECT_EQ(CountLinesContaining(path, "reinit-sync"), 1u);
+}
+
+TEST_F(LoggerTest, BackgroundFileRotatesAtLineBoundaries) {
+    LogConfig config;
+    config.log_dir = log_dir_;
+    config.file_prefix = "background";
+    config.level = LogLevel::kTrace;
+    config.console_enabled = false;
+    config.max_file_size = 4096;
+    config.max_files = 20;
+    config.file_mode = LogFileMode::kBackground;
+    config.file_buffer_size = 1024;
+
+    auto& logger = Logger::GetInstance();
+    logger.Init(config);
+    const auto base = logger.GetCurrentLogFile();
+    EXPECT_TRUE(std::filesystem::exists(base + ".next"));
+
+    const std::size_t kMessages = 400;  // ~60 bytes each: several files
+    for (std::size_t i = 0; i < kMessages; ++i) {
+        logger.Info("background-line " + std::to_string(i));
+    }
+    logger.Flush();
+
+    std::vector<std::string> files{base};
+    for (int i = 1; i <= 20; ++i) {
+        auto rotated = log_dir_ + "/background." + std::to_string(i) + ".log";
+        if (std::filesystem::exists(rotated)) {
+            files.push_back(rotated);
+        }
+    }
+    EXPECT_GT(files.size(), 3u);
+    std::size_t lines = 0;
+    for (const auto& file : files) {
+        EXPECT_LE(std::filesystem::file_size(file), config.max_file_size) << file;
+        lines += CountLinesContaining(file, "background-line");
+    }
+    EXPECT_EQ(lines, kMessages);
+    EXPECT_EQ(CountLinesContaining(base, "background-line 399"), 1u);
+
+    // Re-init stops the writer and removes the preallocated file.
+    config.file_mode = LogFileMode::kDirect;
+    logger.Init(config);
+    EXPECT_FALSE(std::filesystem::exists(base + ".next"));
+}
+
+TEST_F(LoggerTest, BackgroundFileKeepsMaxFiles) {
+    LogConfig config;
+    config.log_dir = log_dir_;
+    config.file_prefix = "bg_keep";
+    config.level = LogLevel::kTrace;
+    config.console_enabled = false;
+    config.max_file_size = 1024;
+    config.max_files = 2;
+    config.file_mode = LogFileMode::kBackground;
+    config.async_enabled = true;
+
+    auto& logger = Logger::GetInstance();
+    logger.Init(config);
+    for (int i = 0; i < 500; ++i) {
+        logger.Warn("bg-keep " + std::to_string(i));
+    }
+    logger.Flush();
+
+    EXPECT_TRUE(std::filesystem::exists(log_dir_ + "/bg_keep.1.log"));
+    EXPECT_TRUE(std::filesystem::exists(log_dir_ + "/bg_keep.2.log"));
+    EXPECT_FALSE(std::filesystem::exists(log_dir_ + "/bg_keep.3.log"));
+    EXPECT_EQ(CountLinesContaining(logger.GetCurrentLogFile(), "bg-keep 499"), 1u);
+
+    config.file_mode = LogFileMode::kDirect;
+    config.async_enabled = false;
+    logger.Init(config);
+}
+
+TEST_F(LoggerTest, DeviceLevelsOverrideTheGlobalLevel) {
+    LogConfig config;
+    config.log_dir = log_dir_;
+    config.file_prefix = "device_level";
+    config.level = LogLevel::kWarn;
+    config.console_enabled = false;
+
+    auto& logger = Logger::GetInstance();
+    logger.Init(config);
+    logger.SetDeviceLevel("dut0", LogLevel::kDebug);
+    logger.SetDeviceLevel("dut0", LogLevel::kOff, "Spi");
+    EXPECT_EQ(logger.GetDeviceLevel("dut0"), LogLevel::kDebug);
+    EXPECT_EQ(logger.GetDeviceLevel("dut0", "I2c"), LogLevel::kDebug);
+    EXPECT_EQ(logger.GetDeviceLevel("dut0", "Spi"), LogLevel::kOff);
+    EXPECT_EQ(logger.GetDeviceLevel("dut1", "I2c"), LogLevel::kWarn);
+
+    std::string dut0 = "dut0";
+    PLAS_LOG_DEVICE_DEBUG(dut0, "I2c", "dev-debug shown");
+    PLAS_LOG_DEVICE_DEBUG("dut1", "I2c", "dev-debug hidden");
+    PLAS_LOG_DEVICE_ERROR(dut0, "Spi", "dev-error hidden");
+    PLAS_LOG_DEVICE_ERROR("dut1", "Spi", "dev-error shown");
+    PLAS_LOG_DEBUG("dev-debug global hidden");
+    logger.Flush();
+
+    auto path = logger.GetCurrentLogFile();
+    EXPECT_EQ(CountLinesContaining(path, "[dut0][I2c] dev-debug shown"), 1u);
+    EXPECT_EQ(CountLinesContaining(path, "[dut1][Spi] dev-error shown"), 1u);
+    EXPECT_EQ(CountLinesContaining(path, "hidden"), 0u);
+
+    logger.ClearDeviceLevel("dut0", "Spi");
+    EXPECT_EQ(logger.GetDeviceLevel("dut0", "Spi"), LogLevel::kDebug);
+    logger.ClearDeviceLevels();
+    EXPECT_EQ(logger.GetDeviceLevel("dut0"), LogLevel::kWarn);
+    EXPECT_FALSE(logger.ShouldLog(LogLevel::kDebug, "dut0"));
+}
+
+TEST_F(LoggerTest, RepeatSamplingKeepsOneInN) {
+    LogConfig config;
+    config.log_dir = log_dir_;
+    config.file_prefix = "repeat";
+    config.level = LogLevel::kTrace;
+    config.console_enabled = false;
+    config.repeat_sample_every = 10;
+
+    auto& logger = Logger::GetInstance();
+    logger.Init(config);
+    for (int i = 0; i < 100; ++i) {
+        PLAS_LOG_DEVICE_ERROR("dut0", "I2c", "repeat-storm nack");
+        if (i % 50 == 0) {
+            logger.Error("repeat-other " + std::to_string(i));
+        }
+    }
+    logger.Flush();
+
+    auto path = logger.GetCurrentLogFile();
+    EXPECT_EQ(CountLinesContaining(path, "repeat-storm"), 10u);
+    EXPECT_EQ(CountLinesContaining(path, "[9 identical suppressed]"), 9u);
+    EXPECT_EQ(CountLinesContaining(path, "repeat-other"), 2u);
+    EXPECT_EQ(logger.GetDropStats().suppressed_repeats, 90u);
+
+    config.repeat_sample_every = 0;
+    logger.Init(config);
+    EXPECT_EQ(logger.GetDropStats().suppressed_repeats, 0u);
+}
+
+TEST(LoggerFormatTest, FormatsPrintfStyle) {
+    EXPECT_EQ(Logger::Format("addr=0x%02X len=%zu", 0x50u, size_t{4}),
+              "addr=0x50 len=4");
+    EXPECT_EQ(Logger::Format("plain"), "plain");
+    EXPECT_EQ(Logger::Format(nullptr), "");
+}
+
+TEST(LoggerFormatTest, FormatsLongMessages) {
+    std::string big(1000, 'x');
+    auto out = Logger::Format("[%s]", big.c_str());
+    EXPECT_EQ(out.size(), big.size() + 2);
+    EXPECT_EQ(out.front(), '[');
+    EXPECT_EQ(out.back(), ']');
+}
+
 TEST(LogLevelTest, ToString) {
     EXPECT_EQ(plas::log::ToString(LogLevel::kTrace), "Trace");
     EXPECT_EQ(plas::log::ToString(LogLevel::kDebug), "Debug");
@@ -85,3 +429,52 @@ TEST(LogLevelTest, ToString) {
     EXPECT_EQ(plas::log::ToString(LogLevel::kCritical), "Critical");
     EXPECT_EQ(plas::log::ToString(LogLevel::kOff), "Off");
 }
+
+// --- Own instances ---
+
+TEST_F(LoggerTest, ScopedCurrentRoutesMacrosToOwnLogger) {
+    LogConfig config;
+    config.log_dir = log_dir_;
+    config.file_prefix = "tenant";
+    config.level = LogLevel::kTrace;
+    config.console_enabled = false;
+
+    Logger tenant;
+    tenant.Init(config);
+    EXPECT_EQ(&Logger::Current(), &Logger::GetInstance());
+    {
+        Logger::ScopedCurrent scope(tenant);
+        EXPECT_EQ(&Logger::Current(), &tenant);
+        PLAS_LOG_INFO("routed to the tenant logger");
+    }
+    EXPECT_EQ(&Logger::Current(), &Logger::GetInstance());
+    tenant.Flush();
+
+    EXPECT_EQ(CountLinesContaining(tenant.GetCurrentLogFile(), "routed to the tenant logger"),
+              1u);
+}
+
+TEST_F(LoggerTest, DeferScopeHoldsMessagesUntilItEnds) {
+    LogConfig config;
+    config.log_dir = log_dir_;
+    config.file_prefix = "deferred";
+    config.level = LogLevel::kTrace;
+    config.console_enabled = false;
+
+    Logger logger;
+    logger.Init(config);
+    {
+        Logger::DeferScope scope(2, 64);
+        logger.Info("held first");
+        logger.Info(std::string(100, 'x'));  // longer than reserved: written now
+        logger.Debug("held second");
+        logger.Info("past capacity");
+        EXPECT_EQ(scope.Held(), 2u);
+        logger.Flush();
+        EXPECT_EQ(CountLinesContaining(logger.GetCurrentLogFile(), "held"), 0u);
+        EXPECT_EQ(CountLinesContaining(logger.GetCurrentLogFile(), "past capacity"), 1u);
+    }
+    logger.Flush();
+    EXPECT_EQ(CountLinesContaining(logger.GetCurrentLogFile(), "held first"), 1u);
+    EXPECT_EQ(CountLinesContaining(logger.GetCurrentLogFile(), "held second"), 1u);
+}
@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/log/trace.h"
+
+using plas::log::TraceConfig;
+using plas::log::TraceFileHeader;
+using plas::log::TraceInterface;
+using plas::log::TraceOp;
+using plas::log::TraceRecord;
+using plas::log::TraceSpan;
+using plas::log::Tracer;
+
+namespace {
+
+struct TraceFile {
+    TraceFileHeader header{};
+    std::vector<TraceRecord> slots;
+};
+
+TraceFile ReadTraceFile(const std::string& path) {
+    TraceFile file;
+    std::ifstream in(path, std::ios::binary);
+    in.read(reinterpret_cast<char*>(&file.header), sizeof(file.header));
+    file.slots.resize(file.header.capacity);
+    in.read(reinterpret_cast<char*>(file.slots.data()),
+            static_cast<std::streamsize>(file.slots.size() *
+                                         sizeof(TraceRecord)));
+    return file;
+}
+
+}  // namespace
+
+class TracerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = "test_trace_" + std::to_string(::testing::UnitTest::GetInstance()
+                                                  ->current_test_info()
+                                                  ->line());
+        path_ = dir_ + "/bus.trace";
+    }
+
+    void TearDown() override {
+        Tracer::GetInstance().Close();
+        std::filesystem::remove_all(dir_);
+    }
+
+    void OpenTrace(std::size_t capacity) {
+        TraceConfig config;
+        config.path = path_;
+        config.capacity = capacity;
+        ASSERT_TRUE(Tracer::GetInstance().Open(config).IsOk());
+    }
+
+    std::string dir_;
+    std::string path_;
+};
+
+TEST_F(TracerTest, DisabledByDefault) {
+    EXPECT_FALSE(Tracer::GetInstance().IsEnabled());
+    { TraceSpan span(1, TraceInterface::kI2c, TraceOp::kRead, 0x50, 4); }
+    EXPECT_EQ(Tracer::GetInstance().GetRecordCount(), 0u);
+}
+
+TEST_F(TracerTest, OpenCreatesFixedSizeFile) {
+    OpenTrace(128);
+    EXPECT_TRUE(Tracer::GetInstance().IsEnabled());
+    EXPECT_EQ(Tracer::GetInstance().GetPath(), path_);
+    EXPECT_EQ(std::filesystem::file_size(path_),
+              sizeof(TraceFileHeader) + 128 * sizeof(TraceRecord));
+
+    Tracer::GetInstance().Close();
+    auto file = ReadTraceFile(path_);
+    EXPECT_EQ(std::memcmp(file.header.magic, plas::log::kTraceMagic,
+                          sizeof(file.header.magic)),
+              0);
+    EXPECT_EQ(file.header.version, plas::log::kTraceFormatVersion);
+    EXPECT_EQ(file.header.record_size, sizeof(TraceRecord));
+    EXPECT_EQ(file.header.capacity, 128u);
+}
+
+TEST_F(TracerTest, OpenTwiceFails) {
+    OpenTrace(16);
+    TraceConfig config;
+    config.path = path_;
+    auto result = Tracer::GetInstance().Open(config);
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(),
+              plas::core::make_error_code(plas::core::ErrorCode::kAlreadyOpen));
+}
+
+TEST_F(TracerTest, ZeroCapacityRejected) {
+    TraceConfig config;
+    config.path = path_;
+    config.capacity = 0;
+    auto result = Tracer::GetInstance().Open(config);
+    ASSERT_TRUE(result.IsError());
+    EXPECT_EQ(result.Error(), plas::core::make_error_code(
+                                  plas::core::ErrorCode::kInvalidArgument));
+}
+
+TEST_F(TracerTest, SpanWritesRecord) {
+    auto id = Tracer::GetInstance().RegisterDevice("trace_span_dev");
+    OpenTrace(16);
+    {
+        TraceSpan span(id, TraceInterface::kPciConfig, TraceOp::kWrite, 0x10,
+                       4, 0x0108, 7);
+        span.SetStatus(
+            plas::core::make_error_code(plas::core::ErrorCode::kTimeout));
+    }
+    EXPECT_EQ(Tracer::GetInstance().GetRecordCount(), 1u);
+    Tracer::GetInstance().Close();
+
+    auto file = ReadTraceFile(path_);
+    EXPECT_EQ(file.header.write_index, 1u);
+    ASSERT_GE(file.header.device_count, id);
+    EXPECT_STREQ(file.header.device_names[id - 1], "trace_span_dev");
+
+    const auto& rec = file.slots[0];
+    EXPECT_EQ(rec.sequence, 1u);
+    EXPECT_EQ(rec.device_id, id);
+    EXPECT_EQ(rec.interface, static_cast<uint8_t>(TraceInterface::kPciConfig));
+    EXPECT_EQ(rec.op, static_cast<uint8_t>(TraceOp::kWrite));
+    EXPECT_EQ(rec.address, 0x10u);
+    EXPECT_EQ(rec.length, 4u);
+    EXPECT_EQ(rec.target, 0x0108u);
+    EXPECT_EQ(rec.extra, 7u);
+    EXPECT_EQ(rec.status,
+              static_cast<uint16_t>(plas::core::ErrorCode::kTimeout));
+    EXPECT_GE(rec.timestamp_ns, file.header.start_time_ns);
+}
+
+TEST_F(TracerTest, RingWrapsKeepingNewest) {
+    OpenTrace(8);
+    for (uint64_t i = 0; i < 20; ++i) {
+        TraceSpan span(0, TraceInterface::kI2c, TraceOp::kRead, i, 1);
+    }
+    Tracer::GetInstance().Close();
+
+    auto file = ReadTraceFile(path_);
+    EXPECT_EQ(file.header.write_index, 20u);
+    for (uint64_t n = 12; n < 20; ++n) {
+        const auto& rec = file.slots[n % 8];
+        EXPECT_EQ(rec.sequence, n + 1);
+        EXPECT_EQ(rec.address, n);
+    }
+}
+
+TEST_F(TracerTest, RecordAfterCloseIsDropped) {
+    OpenTrace(8);
+    Tracer::GetInstance().Close();
+    EXPECT_FALSE(Tracer::GetInstance().IsEnabled());
+    TraceRecord rec{};
+    Tracer::GetInstance().Record(rec);
+    EXPECT_EQ(Tracer::GetInstance().GetRecordCount(), 0u);
+}
+
+TEST_F(TracerTest, RegisterDeviceIsStable) {
+    auto& tracer = Tracer::GetInstance();
+    auto a = tracer.RegisterDevice("trace_stable_a");
+    auto b = tracer.RegisterDevice("trace_stable_b");
+    EXPECT_NE(a, 0u);
+    EXPECT_NE(b, 0u);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(tracer.RegisterDevice("trace_stable_a"), a);
+}
+
+TEST_F(TracerTest, ConcurrentWritersFillDistinctSlots) {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 500;
+    OpenTrace(kThreads * kPerThread);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                TraceSpan span(static_cast<uint16_t>(t + 1),
+                               TraceInterface::kI2c, TraceOp::kWrite,
+                               static_cast<uint64_t>(i), 2);
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    Tracer::GetInstance().Close();
+
+    auto file = ReadTraceFile(path_);
+    ASSERT_EQ(file.header.write_index,
+              static_cast<uint64_t>(kThreads * kPerThread));
+    std::vector<int> per_device(kThreads + 1, 0);
+    for (std::size_t i = 0; i < file.slots.size(); ++i) {
+        EXPECT_EQ(file.slots[i].sequence, i + 1);
+        per_device[file.slots[i].device_id]++;
+    }
+    for (std::size_t t = 1; t <= kThreads; ++t) {
+        EXPECT_EQ(per_device[t], kPerThread);
+    }
+}
+
+TEST(TraceEnumTest, ToString) {
+    EXPECT_STREQ(plas::log::ToString(TraceInterface::kI2c), "i2c");
+    EXPECT_STREQ(plas::log::ToString(TraceInterface::kPciDoe), "pci-doe");
+    EXPECT_STREQ(plas::log::ToString(TraceOp::kWriteRead), "write-read");
+    EXPECT_STREQ(plas::log::ToString(static_cast<TraceOp>(200)), "unknown");
+}
+
+TEST(SystemTraceTest, BackendMatchesBuild) {
+    using plas::log::SystemTrace;
+    if (!plas::log::kSystemTraceCompiled) {
+        EXPECT_STREQ(SystemTrace::Backend(), "none");
+        EXPECT_FALSE(SystemTrace::IsActive());
+    } else {
+        EXPECT_STRNE(SystemTrace::Backend(), "none");
+    }
+    // Safe with or without a backend or a recording session.
+    SystemTrace::Initialize();
+    auto id = Tracer::GetInstance().RegisterDevice("system_trace_dev");
+    TraceSpan span(id, TraceInterface::kI2c, TraceOp::kRead, 0x50, 2);
+    span.SetLength(1);
+}
@@ -0,0 +1,574 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "plas/core/error.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/mctp/endpoint.h"
+#include "plas/mctp/framing.h"
+#include "plas/mctp/packet_pool.h"
+#include "plas/mctp/smbus_binding.h"
+
+using plas::core::Address;
+using plas::core::Byte;
+using plas::core::ErrorCode;
+using plas::core::Result;
+using plas::core::make_error_code;
+using namespace plas::mctp;
+using std::chrono::milliseconds;
+
+namespace {
+
+constexpr Address kHostAddr = 0x10;
+constexpr Eid kHostEid = 0x08;
+
+std::vector<Byte> Body(std::size_t length, uint8_t seed = 0) {
+    std::vector<Byte> body(length);
+    for (std::size_t i = 0; i < length; ++i) {
+        body[i] = static_cast<Byte>(i * 3 + seed);
+    }
+    return body;
+}
+
+/// SMBus frame as a target receives it (command code onwards).
+std::vector<Byte> Frame(Address from, Address to, const Byte* packet, std::size_t length) {
+    std::vector<Byte> frame = {MctpSmbusBinding::kCommandCode, static_cast<Byte>(1 + length),
+                               static_cast<Byte>((from << 1) | 1)};
+    frame.insert(frame.end(), packet, packet + length);
+    Byte addr = static_cast<Byte>(to << 1);
+    frame.push_back(MctpSmbusBinding::Pec(frame.data(), frame.size(),
+                                          MctpSmbusBinding::Pec(&addr, 1)));
+    return frame;
+}
+
+/// I2C bus of MCTP endpoints: reassembles every SMBus write it sees and
+/// hands complete messages (with the target address) to `on_message`.
+class FakeSmbus : public plas::hal::I2c {
+public:
+    plas::hal::Device* GetDevice() override { return nullptr; }
+
+    Result<size_t> Read(Address, Byte*, size_t, bool) override {
+        return Result<size_t>::Err(ErrorCode::kNotSupported);
+    }
+
+    Result<size_t> Write(Address addr, const Byte* data, size_t length, bool) override {
+        std::function<void(Address, MctpMessage)> handler;
+        MctpMessage message;
+        bool complete = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            frames.emplace_back(data, data + length);
+            if (nack.count(addr)) {
+                return Result<size_t>::Err(ErrorCode::kIOError);
+            }
+            Byte dest = static_cast<Byte>(addr << 1);
+            if (length < 3 || data[0] != MctpSmbusBinding::kCommandCode ||
+                data[1] != length - 3 ||
+                MctpSmbusBinding::Pec(data, length - 1, MctpSmbusBinding::Pec(&dest, 1)) !=
+                    data[length - 1]) {
+                bad_frames++;
+                return Result<size_t>::Ok(length);
+            }
+            auto packet = pool.Acquire().Value();
+            std::copy(data + 3, data + length - 1, packet.Data());
+            packet.Resize(length - 4);
+            complete = reassembler.Push(std::move(packet), message);
+            handler = on_message;
+        }
+        if (complete && handler) {
+            handler(addr, std::move(message));
+        }
+        return Result<size_t>::Ok(length);
+    }
+
+    Result<size_t> WriteRead(Address, const Byte*, size_t, Byte*, size_t) override {
+        return Result<size_t>::Err(ErrorCode::kNotSupported);
+    }
+    Result<void> SetBitrate(uint32_t) override { return Result<void>::Ok(); }
+    uint32_t GetBitrate() const override { return 100000; }
+
+    std::mutex mutex;
+    std::vector<std::vector<Byte>> frames;
+    std::set<Address> nack;
+    int bad_frames = 0;
+    MctpPacketPool pool{64, kHeaderSize + 250};
+    MctpReassembler reassembler;
+    std::function<void(Address, MctpMessage)> on_message;
+};
+
+/// Send `body` from the endpoint (`eid` at `addr`) to the host as SMBus
+/// writes delivered to `binding`.
+void Reply(MctpSmbusBinding& binding, Address addr, Eid eid, bool tag_owner, uint8_t tag,
+           uint8_t type, const std::vector<Byte>& body, std::size_t mtu = kBaselineMtu) {
+    MctpHeader header;
+    header.source = eid;
+    header.destination = kHostEid;
+    header.tag_owner = tag_owner;
+    header.tag = tag;
+    MctpFragmenter fragmenter(header, type, body.data(), body.size(), mtu);
+    std::vector<Byte> packet(kHeaderSize + mtu);
+    while (std::size_t n = fragmenter.Next(packet.data())) {
+        auto frame = Frame(addr, kHostAddr, packet.data(), n);
+        ASSERT_TRUE(binding.Deliver(frame.data(), frame.size()).IsOk());
+    }
+}
+
+constexpr uint8_t kNvmeMi = static_cast<uint8_t>(MctpMessageType::kNvmeMi);
+
+// --- framing -----------------------------------------------------------------
+
+TEST(MctpHeaderTest, EncodeDecodeRoundTrip) {
+    MctpHeader header;
+    header.destination = 0x1D;
+    header.source = 0x08;
+    header.som = true;
+    header.sequence = 2;
+    header.tag_owner = true;
+    header.tag = 5;
+    Byte raw[kHeaderSize];
+    header.Encode(raw);
+    EXPECT_EQ(raw[0], 0x01);
+    EXPECT_EQ(raw[3], 0x80 | 0x20 | 0x08 | 0x05);
+
+    auto decoded = MctpHeader::Decode(raw, sizeof(raw));
+    ASSERT_TRUE(decoded.IsOk());
+    EXPECT_EQ(decoded.Value().destination, 0x1D);
+    EXPECT_TRUE(decoded.Value().som);
+    EXPECT_FALSE(decoded.Value().eom);
+    EXPECT_EQ(decoded.Value().sequence, 2);
+    EXPECT_EQ(decoded.Value().tag, 5);
+
+    raw[0] = 0x02;
+    EXPECT_EQ(MctpHeader::Decode(raw, sizeof(raw)).Error(),
+              make_error_code(ErrorCode::kNotSupported));
+    EXPECT_EQ(MctpHeader::Decode(raw, 3).Error(), make_error_code(ErrorCode::kInvalidArgument));
+}
+
+TEST(MctpFragmenterTest, SplitsAtMtu) {
+    auto body = Body(150);  // 151 payload bytes with the type byte
+    MctpHeader header;
+    header.destination = 0x20;
+    MctpFragmenter fragmenter(header, kNvmeMi, body.data(), body.size(), 64);
+    EXPECT_EQ(fragmenter.PacketCount(), 3u);
+
+    Byte packet[kHeaderSize + 64];
+    std::vector<std::size_t> sizes;
+    std::vector<Byte> flags;
+    std::vector<Byte> joined;
+    while (std::size_t n = fragmenter.Next(packet)) {
+        sizes.push_back(n);
+        flags.push_back(packet[3]);
+        joined.insert(joined.end(), packet + kHeaderSize, packet + n);
+    }
+    EXPECT_EQ(sizes, (std::vector<std::size_t>{68, 68, 27}));
+    EXPECT_EQ(flags, (std::vector<Byte>{0x80, 0x10, 0x60}));  // SOM/seq0, seq1, EOM/seq2
+    ASSERT_EQ(joined.size(), 151u);
+    EXPECT_EQ(joined[0], kNvmeMi);
+    EXPECT_TRUE(std::equal(body.begin(), body.end(), joined.begin() + 1));
+    EXPECT_TRUE(fragmenter.Done());
+}
+
+// --- pool and reassembly -----------------------------------------------------
+
+std::vector<MctpPacket> Packets(MctpPacketPool& pool, const MctpHeader& header, uint8_t type,
+                                const std::vector<Byte>& body, std::size_t mtu) {
+    MctpFragmenter fragmenter(header, type, body.data(), body.size(), mtu);
+    std::vector<MctpPacket> packets;
+    for (;;) {
+        auto packet = pool.Acquire().Value();
+        std::size_t n = fragmenter.Next(packet.Data());
+        if (n == 0) {
+            break;
+        }
+        packet.Resize(n);
+        packets.push_back(std::move(packet));
+    }
+    return packets;
+}
+
+TEST(MctpPacketPoolTest, FixedCapacity) {
+    MctpPacketPool pool(2);
+    auto a = pool.Acquire();
+    auto b = pool.Acquire();
+    ASSERT_TRUE(a.IsOk() && b.IsOk());
+    EXPECT_EQ(pool.Acquire().Error(), make_error_code(ErrorCode::kResourceExhausted));
+    EXPECT_EQ(a.Value().Capacity(), kHeaderSize + kBaselineMtu);
+    a.Value().Release();
+    EXPECT_EQ(pool.Available(), 1u);
+    EXPECT_TRUE(pool.Acquire().IsOk());
+    auto stats = pool.GetStats();
+    EXPECT_EQ(stats.exhausted, 1u);
+    EXPECT_EQ(stats.high_water, 2u);
+}
+
+TEST(MctpReassemblerTest, ChainsPacketsWithoutCopying) {
+    MctpPacketPool pool(16);
+    MctpReassembler reassembler;
+    MctpHeader header;
+    header.source = 0x20;
+    header.destination = kHostEid;
+    header.tag = 3;
+    auto body = Body(200);
+    auto packets = Packets(pool, header, kNvmeMi | kIntegrityCheckBit, body, 64);
+    ASSERT_EQ(packets.size(), 4u);
+
+    MctpMessage message;
+    for (std::size_t i = 0; i < packets.size(); ++i) {
+        EXPECT_EQ(reassembler.Push(std::move(packets[i]), message), i + 1 == 4);
+    }
+    EXPECT_EQ(message.Source(), 0x20);
+    EXPECT_EQ(message.Tag(), 3);
+    EXPECT_EQ(message.Type(), kNvmeMi);
+    EXPECT_TRUE(message.IntegrityCheck());
+    EXPECT_EQ(message.PacketCount(), 4u);
+    EXPECT_EQ(message.ToVector(), body);
+    Byte tail[10];
+    EXPECT_EQ(message.CopyTo(tail, sizeof(tail), 190), 10u);
+    EXPECT_EQ(tail[0], body[190]);
+
+    // The message owns the four pool packets until it goes away.
+    EXPECT_EQ(pool.Available(), 12u);
+    message.Clear();
+    EXPECT_EQ(pool.Available(), 16u);
+}
+
+TEST(MctpReassemblerTest, InterleavedSenders) {
+    MctpPacketPool pool(16);
+    MctpReassembler reassembler;
+    MctpHeader a;
+    a.source = 0x20;
+    MctpHeader b;
+    b.source = 0x21;
+    auto body_a = Body(100, 1);
+    auto body_b = Body(100, 2);
+    auto pa = Packets(pool, a, kNvmeMi, body_a, 64);
+    auto pb = Packets(pool, b, kNvmeMi, body_b, 64);
+
+    MctpMessage out;
+    EXPECT_FALSE(reassembler.Push(std::move(pa[0]), out));
+    EXPECT_FALSE(reassembler.Push(std::move(pb[0]), out));
+    EXPECT_EQ(reassembler.InProgress(), 2u);
+    ASSERT_TRUE(reassembler.Push(std::move(pb[1]), out));
+    EXPECT_EQ(out.Source(), 0x21);
+    EXPECT_EQ(out.ToVector(), body_b);
+    ASSERT_TRUE(reassembler.Push(std::move(pa[1]), out));
+    EXPECT_EQ(out.ToVector(), body_a);
+}
+
+TEST(MctpReassemblerTest, DropsOnSequenceGapAndTimeout) {
+    MctpPacketPool pool(16);
+    MctpReassembler reassembler;
+    MctpHeader header;
+    header.source = 0x20;
+    auto packets = Packets(pool, header, kNvmeMi, Body(200), 64);
+
+    MctpMessage out;
+    EXPECT_FALSE(reassembler.Push(std::move(packets[0]), out));
+    EXPECT_FALSE(reassembler.Push(std::move(packets[2]), out));  // skipped seq 1
+    EXPECT_FALSE(reassembler.Push(std::move(packets[3]), out));  // nothing in progress
+    auto stats = reassembler.GetStats();
+    EXPECT_EQ(stats.dropped_messages, 1u);
+    EXPECT_EQ(stats.dropped_packets, 2u);
+    EXPECT_EQ(pool.Available(), 15u);  // only packets[1] is still held
+
+    auto more = Packets(pool, header, kNvmeMi, Body(100), 64);
+    auto start = MctpReassembler::Clock::now();
+    EXPECT_FALSE(reassembler.Push(std::move(more[0]), out, start));
+    reassembler.Expire(start + milliseconds(150));
+    EXPECT_EQ(reassembler.InProgress(), 0u);
+    EXPECT_EQ(reassembler.GetStats().dropped_messages, 2u);
+}
+
+TEST(MctpReassemblerTest, RejectsOversizeMessage) {
+    MctpPacketPool pool(16);
+    MctpReassemblerOptions options;
+    options.max_message = 100;
+    MctpReassembler reassembler(options);
+    MctpHeader header;
+    auto packets = Packets(pool, header, kNvmeMi, Body(150), 64);
+    MctpMessage out;
+    for (auto& packet : packets) {
+        EXPECT_FALSE(reassembler.Push(std::move(packet), out));
+    }
+    EXPECT_EQ(reassembler.GetStats().dropped_messages, 1u);
+    EXPECT_EQ(pool.Available(), 16u);
+}
+
+// --- SMBus binding -----------------------------------------------------------
+
+TEST(MctpSmbusBindingTest, PecIsCrc8) {
+    const char* check = "123456789";
+    EXPECT_EQ(MctpSmbusBinding::Pec(reinterpret_cast<const Byte*>(check), 9), 0xF4);
+}
+
+TEST(MctpSmbusBindingTest, SendWritesBlockWithPec) {
+    FakeSmbus bus;
+    MctpSmbusBinding binding(bus, kHostAddr);
+    Byte packet[] = {0x01, 0x20, 0x08, 0xC8, kNvmeMi, 0xAA};
+    ASSERT_TRUE(binding.Send(0x30, packet, sizeof(packet)).IsOk());
+    ASSERT_EQ(bus.frames.size(), 1u);
+    const auto& frame = bus.frames[0];
+    ASSERT_EQ(frame.size(), 3 + sizeof(packet) + 1);
+    EXPECT_EQ(frame[0], 0x0F);
+    EXPECT_EQ(frame[1], 1 + sizeof(packet));
+    EXPECT_EQ(frame[2], (kHostAddr << 1) | 1);
+    EXPECT_EQ(bus.bad_frames, 0);
+
+    EXPECT_EQ(binding.Send(0x80, packet, sizeof(packet)).Error(),
+              make_error_code(ErrorCode::kInvalidArgument));
+    std::vector<Byte> big(kHeaderSize + kBaselineMtu + 1);
+    EXPECT_EQ(binding.Send(0x30, big.data(), big.size()).Error(),
+              make_error_code(ErrorCode::kInvalidArgument));
+}
+
+TEST(MctpSmbusBindingTest, DeliverValidatesFrames) {
+    FakeSmbus bus;
+    MctpSmbusOptions options;
+    options.inbound_depth = 1;
+    MctpSmbusBinding binding(bus, kHostAddr, options);
+    Byte packet[] = {0x01, kHostEid, 0x20, 0xC0, kNvmeMi, 1, 2, 3};
+    auto frame = Frame(0x30, kHostAddr, packet, sizeof(packet));
+
+    auto corrupt = frame;
+    corrupt[6] ^= 1;
+    EXPECT_EQ(binding.Deliver(corrupt.data(), corrupt.size()).Error(),
+              make_error_code(ErrorCode::kDataLoss));
+    auto wrong = frame;
+    wrong[0] = 0x10;
+    EXPECT_EQ(binding.Deliver(wrong.data(), wrong.size()).Error(),
+              make_error_code(ErrorCode::kInvalidArgument));
+    EXPECT_EQ(binding.Deliver(frame.data(), frame.size() - 2).Error(),
+              make_error_code(ErrorCode::kInvalidArgument));
+
+    ASSERT_TRUE(binding.Deliver(frame.data(), frame.size()).IsOk());
+    EXPECT_EQ(binding.Deliver(frame.data(), frame.size()).Error(),
+              make_error_code(ErrorCode::kResourceExhausted));
+
+    Byte out[kHeaderSize + kBaselineMtu];
+    MctpPhysAddr source = 0;
+    auto n = binding.Receive(out, sizeof(out), source, milliseconds(0));
+    ASSERT_TRUE(n.IsOk());
+    EXPECT_EQ(n.Value(), sizeof(packet));
+    EXPECT_EQ(source, 0x30u);
+    EXPECT_TRUE(std::equal(packet, packet + sizeof(packet), out));
+    EXPECT_EQ(binding.Receive(out, sizeof(out), source, milliseconds(1)).Error(),
+              make_error_code(ErrorCode::kTimeout));
+
+    auto stats = binding.GetStats();
+    EXPECT_EQ(stats.rejected, 3u);
+    EXPECT_EQ(stats.overflows, 1u);
+}
+
+// --- endpoint ----------------------------------------------------------------
+
+class MctpEndpointTest : public ::testing::Test {
+protected:
+    MctpEndpointTest() : binding(bus, kHostAddr, Options()) {}
+
+    static MctpSmbusOptions Options() {
+        MctpSmbusOptions options;
+        options.inbound_depth = 128;  // whole bursts of replies
+        return options;
+    }
+
+    void SetUp() override {
+        for (Eid eid = 0x20; eid < 0x24; ++eid) {
+            endpoint.AddRoute(eid, 0x30 + (eid - 0x20));
+        }
+    }
+
+    /// Echo every request back with the body reversed, from the EID it was
+    /// sent to.
+    void Echo() {
+        bus.on_message = [this](Address addr, MctpMessage request) {
+            auto body = request.ToVector();
+            std::reverse(body.begin(), body.end());
+            Reply(binding, addr, request.Destination(), false, request.Tag(), request.Type(),
+                  body);
+        };
+    }
+
+    FakeSmbus bus;
+    MctpSmbusBinding binding;
+    MctpEndpoint endpoint{binding};
+};
+
+TEST_F(MctpEndpointTest, RequestResponse) {
+    Echo();
+    ASSERT_TRUE(endpoint.Start().IsOk());
+    auto body = Body(150);  // three packets each way
+    auto reply = endpoint.Request(0x21, kNvmeMi, body.data(), body.size(), milliseconds(1000));
+    ASSERT_TRUE(reply.IsOk()) << reply.Error().message();
+    std::reverse(body.begin(), body.end());
+    EXPECT_EQ(reply.Value().ToVector(), body);
+    EXPECT_EQ(reply.Value().Source(), 0x21);
+    EXPECT_FALSE(reply.Value().TagOwner());
+    EXPECT_EQ(reply.Value().PacketCount(), 3u);
+    EXPECT_EQ(endpoint.Outstanding(0x21), 0u);
+    EXPECT_EQ(endpoint.GetStats().responses, 1u);
+}
+
+TEST_F(MctpEndpointTest, ManyRequestsInFlight) {
+    // The endpoints answer only once every request has arrived, and in
+    // reverse order: serial request/response would time out.
+    constexpr std::size_t kPerEid = 8;
+    constexpr std::size_t kTotal = 4 * kPerEid;
+    std::vector<std::pair<Address, MctpMessage>> held;
+    bus.on_message = [&](Address addr, MctpMessage request) {
+        held.emplace_back(addr, std::move(request));
+        if (held.size() < kTotal) {
+            return;
+        }
+        for (auto it = held.rbegin(); it != held.rend(); ++it) {
+            Reply(binding, it->first, it->second.Destination(), false, it->second.Tag(),
+                  kNvmeMi, it->second.ToVector());
+        }
+        held.clear();
+    };
+    ASSERT_TRUE(endpoint.Start().IsOk());
+
+    std::vector<MctpRequest> requests;
+    for (std::size_t i = 0; i < kTotal; ++i) {
+        Eid dest = static_cast<Eid>(0x20 + i % 4);
+        Byte body[2] = {dest, static_cast<Byte>(i)};
+        auto request = endpoint.Submit(dest, kNvmeMi, body, sizeof(body));
+        ASSERT_TRUE(request.IsOk()) << i;
+        requests.push_back(request.Value());
+    }
+    EXPECT_EQ(endpoint.Outstanding(0x20), kPerEid);
+    for (std::size_t i = 0; i < kTotal; ++i) {
+        auto reply = endpoint.Wait(requests[i], milliseconds(1000));
+        ASSERT_TRUE(reply.IsOk()) << i;
+        EXPECT_EQ(reply.Value().ToVector(),
+                  (std::vector<Byte>{requests[i].destination, static_cast<Byte>(i)}));
+    }
+    EXPECT_EQ(endpoint.GetStats().responses, kTotal);
+    // Only the receive thread's next packet is still out of the pool.
+    EXPECT_LE(endpoint.PoolStats().in_use, 1u);
+}
+
+TEST_F(MctpEndpointTest, WindowLimitsOutstandingRequests) {
+    MctpEndpointOptions options;
+    options.window = 2;
+    MctpEndpoint limited(binding, options);
+    limited.AddRoute(0x20, 0x30);
+    ASSERT_TRUE(limited.Start().IsOk());
+    Byte body[1] = {0};
+    auto a = limited.Submit(0x20, kNvmeMi, body, 1);
+    auto b = limited.Submit(0x20, kNvmeMi, body, 1);
+    ASSERT_TRUE(a.IsOk() && b.IsOk());
+    EXPECT_NE(a.Value().tag, b.Value().tag);
+    EXPECT_EQ(limited.Submit(0x20, kNvmeMi, body, 1).Error(),
+              make_error_code(ErrorCode::kBusy));
+    limited.Cancel(a.Value());
+    EXPECT_TRUE(limited.Submit(0x20, kNvmeMi, body, 1).IsOk());
+    EXPECT_EQ(limited.Wait(a.Value(), milliseconds(0)).Error(),
+              make_error_code(ErrorCode::kNotFound));
+}
+
+TEST_F(MctpEndpointTest, TimeoutReleasesTagAndDropsLateResponse) {
+    ASSERT_TRUE(endpoint.Start().IsOk());
+    Byte body[1] = {7};
+    auto request = endpoint.Submit(0x22, kNvmeMi, body, 1);
+    ASSERT_TRUE(request.IsOk());
+    EXPECT_EQ(endpoint.Wait(request.Value(), milliseconds(20)).Error(),
+              make_error_code(ErrorCode::kTimeout));
+    EXPECT_EQ(endpoint.Outstanding(0x22), 0u);
+
+    Reply(binding, 0x32, 0x22, false, request.Value().tag, kNvmeMi, {7});
+    for (int i = 0; i < 200 && endpoint.GetStats().unmatched == 0; ++i) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    EXPECT_EQ(endpoint.GetStats().unmatched, 1u);
+    EXPECT_EQ(endpoint.GetStats().timeouts, 1u);
+}
+
+TEST_F(MctpEndpointTest, ErrorsBeforeSending) {
+    Byte body[1] = {0};
+    EXPECT_EQ(endpoint.Submit(0x20, kNvmeMi, body, 1).Error(),
+              make_error_code(ErrorCode::kNotInitialized));
+    ASSERT_TRUE(endpoint.Start().IsOk());
+    EXPECT_EQ(endpoint.Start().Error(), make_error_code(ErrorCode::kAlreadyOpen));
+    EXPECT_EQ(endpoint.Submit(0x40, kNvmeMi, body, 1).Error(),
+              make_error_code(ErrorCode::kNotFound));
+    bus.nack.insert(0x31);
+    EXPECT_EQ(endpoint.Submit(0x21, kNvmeMi, body, 1).Error(),
+              make_error_code(ErrorCode::kIOError));
+    EXPECT_EQ(endpoint.Outstanding(0x21), 0u);
+}
+
+TEST_F(MctpEndpointTest, InboundRequestsReachHandler) {
+    std::mutex mutex;
+    std::vector<Byte> seen;
+    ASSERT_TRUE(endpoint
+                    .SetRequestHandler([&](MctpMessage request) {
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            seen = request.ToVector();
+                        }
+                        Byte answer[2] = {0x00, 0x42};
+                        EXPECT_TRUE(endpoint.Respond(request, request.Type(), answer, 2).IsOk());
+                    })
+                    .IsOk());
+    ASSERT_TRUE(endpoint.Start().IsOk());
+    EXPECT_EQ(endpoint.SetRequestHandler({}).Error(), make_error_code(ErrorCode::kBusy));
+
+    // From an EID without a configured route: learned from the packet.
+    std::vector<MctpMessage> responses;
+    bus.on_message = [&](Address addr, MctpMessage response) {
+        EXPECT_EQ(addr, 0x3Au);
+        responses.push_back(std::move(response));
+    };
+    Reply(binding, 0x3A, 0x2A, true, 6, kNvmeMi, {1, 2, 3});
+    for (int i = 0; i < 500 && endpoint.GetStats().handled == 0; ++i) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    endpoint.Stop();
+    EXPECT_EQ(seen, (std::vector<Byte>{1, 2, 3}));
+    ASSERT_EQ(responses.size(), 1u);
+    EXPECT_EQ(responses[0].Tag(), 6);
+    EXPECT_FALSE(responses[0].TagOwner());
+    EXPECT_EQ(responses[0].Destination(), 0x2A);
+    EXPECT_EQ(responses[0].ToVector(), (std::vector<Byte>{0x00, 0x42}));
+    EXPECT_EQ(endpoint.Route(0x2A).Value(), 0x3Au);
+}
+
+TEST_F(MctpEndpointTest, StopCancelsWaiters) {
+    ASSERT_TRUE(endpoint.Start().IsOk());
+    Byte body[1] = {0};
+    auto request = endpoint.Submit(0x20, kNvmeMi, body, 1);
+    ASSERT_TRUE(request.IsOk());
+    std::thread stopper([&] {
+        std::this_thread::sleep_for(milliseconds(20));
+        endpoint.Stop();
+    });
+    EXPECT_EQ(endpoint.Wait(request.Value(), milliseconds(5000)).Error(),
+              make_error_code(ErrorCode::kCancelled));
+    stopper.join();
+}
+
+TEST_F(MctpEndpointTest, MisaddressedPacketsAreDropped) {
+    ASSERT_TRUE(endpoint.Start().IsOk());
+    MctpHeader header;
+    header.source = 0x20;
+    header.destination = 0x55;
+    header.som = header.eom = true;
+    Byte packet[kHeaderSize + 1];
+    header.Encode(packet);
+    packet[kHeaderSize] = kNvmeMi;
+    auto frame = Frame(0x30, kHostAddr, packet, sizeof(packet));
+    ASSERT_TRUE(binding.Deliver(frame.data(), frame.size()).IsOk());
+    for (int i = 0; i < 500 && endpoint.GetStats().misaddressed == 0; ++i) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    EXPECT_EQ(endpoint.GetStats().misaddressed, 1u);
+}
+
+}  // namespace
@@ -0,0 +1,241 @@
+#include <gtest/gtest.h>
+
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/core/error.h"
+#include "plas/hal/device_manager.h"
+#include "plas/hal/driver/sim/sim_device.h"
+#include "plas/hal/interface/device_factory.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/transaction_trace.h"
+#include "plas/remote/remote_device.h"
+#include "plas/remote/remote_server.h"
+
+namespace plas::remote {
+namespace {
+
+using hal::TraceOp;
+using hal::TraceRecord;
+
+constexpr hal::pci::Bdf kBdf{0x03, 0x00, 0x0};
+
+config::DeviceEntry MakeEntry(const std::string& nickname, const std::string& uri,
+                              const std::string& driver,
+                              const std::map<std::string, std::string>& args = {}) {
+    return config::DeviceEntry{nickname, uri, driver, args};
+}
+
+/// A loopback RemoteServer in front of sim devices "eeprom" and "nvme".
+class RemoteTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        RemoteDevice::Register();
+        auto& dm = hal::DeviceManager::GetInstance();
+        dm.Reset();
+        Add(std::make_unique<hal::driver::SimI2cDevice>(
+            MakeEntry("eeprom", "sim://i2c:0x50", "sim")));
+        Add(std::make_unique<hal::driver::SimPciDevice>(
+            MakeEntry("nvme", "sim://pci:0000:03:00.0", "sim",
+                      {{"vendor_id", "0x144d"}, {"doe_protocols", "0001:01"}})));
+
+        RemoteServerOptions options;
+        options.bind_address = "127.0.0.1";
+        options.port = 0;
+        ASSERT_TRUE(server_.Start(options).IsOk());
+    }
+
+    void TearDown() override {
+        server_.Stop();
+        hal::DeviceManager::GetInstance().Reset();
+    }
+
+    static void Add(std::unique_ptr<hal::Device> device) {
+        ASSERT_TRUE(device->Init().IsOk());
+        ASSERT_TRUE(device->Open().IsOk());
+        std::string name = device->GetName();
+        ASSERT_TRUE(hal::DeviceManager::GetInstance().AddDevice(name, std::move(device)).IsOk());
+    }
+
+    std::string Uri(const std::string& nickname) const {
+        return "remote://127.0.0.1:" + std::to_string(server_.Port()) + "/" + nickname;
+    }
+
+    std::unique_ptr<hal::Device> Connect(const std::string& nickname) {
+        auto created = hal::DeviceFactory::CreateFromConfig(
+            MakeEntry("remote-" + nickname, Uri(nickname), "remote", {{"timeout_ms", "2000"}}));
+        EXPECT_TRUE(created.IsOk());
+        auto device = std::move(created).Value();
+        EXPECT_TRUE(device->Init().IsOk());
+        EXPECT_TRUE(device->Open().IsOk());
+        return device;
+    }
+
+    static TraceRecord ConfigRead32(uint64_t offset) {
+        TraceRecord call;
+        call.op = TraceOp::kConfigRead32;
+        call.target = kBdf.Pack();
+        call.offset = offset;
+        return call;
+    }
+
+    RemoteServer server_;
+};
+
+TEST_F(RemoteTest, ExposesRemoteInterfaces) {
+    auto eeprom = Connect("eeprom");
+    EXPECT_NE(dynamic_cast<hal::I2c*>(eeprom.get()), nullptr);
+    EXPECT_EQ(dynamic_cast<hal::pci::PciConfig*>(eeprom.get()), nullptr);
+    EXPECT_EQ(eeprom->GetDriverName(), "remote");
+    EXPECT_EQ(dynamic_cast<RemoteDevice*>(eeprom.get())->GetRemoteDriverName(), "sim");
+
+    auto nvme = Connect("nvme");
+    EXPECT_NE(dynamic_cast<hal::pci::PciConfig*>(nvme.get()), nullptr);
+    EXPECT_NE(dynamic_cast<hal::pci::PciDoe*>(nvme.get()), nullptr);
+    EXPECT_EQ(dynamic_cast<hal::I2c*>(nvme.get()), nullptr);
+}
+
+TEST_F(RemoteTest, ServesI2cAndPciCalls) {
+    auto eeprom = Connect("eeprom");
+    auto* i2c = dynamic_cast<hal::I2c*>(eeprom.get());
+    const core::Byte write[] = {0x10, 0xA1, 0xB2, 0xC3};
+    ASSERT_TRUE(i2c->Write(0x50, write, sizeof(write)).IsOk());
+    const core::Byte reg = 0x10;
+    core::Byte buf[3] = {};
+    ASSERT_EQ(i2c->WriteRead(0x50, &reg, 1, buf, 3).Value(), 3u);
+    EXPECT_EQ(buf[0], 0xA1);
+    EXPECT_EQ(buf[2], 0xC3);
+    EXPECT_EQ(i2c->Read(0x51, buf, 1).Error(),
+              core::make_error_code(core::ErrorCode::kIOError));
+
+    auto nvme = Connect("nvme");
+    auto* config = dynamic_cast<hal::pci::PciConfig*>(nvme.get());
+    auto* doe = dynamic_cast<hal::pci::PciDoe*>(nvme.get());
+    EXPECT_EQ(config->ReadConfig32(kBdf, 0x00).Value(), 0x0001144Du);
+    auto echo = doe->DoeExchange(kBdf, 0x100, {0x0001, 0x01}, {0xCAFE});
+    ASSERT_TRUE(echo.IsOk());
+    EXPECT_EQ(echo.Value(), (hal::pci::DoePayload{0xCAFE}));
+}
+
+TEST_F(RemoteTest, BatchIsOneRequestAndStopsAtFirstFailure) {
+    auto eeprom = Connect("eeprom");
+    auto* remote = dynamic_cast<RemoteDevice*>(eeprom.get());
+    const uint64_t before = server_.GetStats().requests;
+
+    std::vector<TraceRecord> calls(3);
+    calls[0].op = TraceOp::kI2cWrite;
+    calls[0].target = 0x50;
+    calls[0].arg = 1;
+    calls[0].request = {0x00, 0x42};
+    calls[1].op = TraceOp::kI2cRead;
+    calls[1].target = 0x51;  // NACK
+    calls[1].arg = 1;
+    calls[1].length = 1;
+    calls[2] = calls[0];
+    ASSERT_TRUE(remote->ExecuteBatch(calls.data(), calls.size()).IsOk());
+    EXPECT_EQ(calls[0].error, core::ErrorCode::kSuccess);
+    EXPECT_EQ(calls[1].error, core::ErrorCode::kIOError);
+    EXPECT_EQ(calls[2].error, core::ErrorCode::kCancelled);
+    EXPECT_EQ(server_.GetStats().requests, before + 1);
+
+    // I2c::Transfer goes out as a single batch too.
+    core::Byte data[2] = {};
+    hal::I2cMessage msgs[2] = {{0x50, calls[0].request.data(), 1, false, false, 0},
+                               {0x50, data, 1, true, true, 0}};
+    ASSERT_TRUE(dynamic_cast<hal::I2c*>(eeprom.get())->Transfer(msgs, 2).IsOk());
+    EXPECT_EQ(data[0], 0x42);
+    EXPECT_EQ(server_.GetStats().requests, before + 2);
+}
+
+TEST_F(RemoteTest, PipelinesRequests) {
+    auto nvme = Connect("nvme");
+    auto* remote = dynamic_cast<RemoteDevice*>(nvme.get());
+
+    std::vector<std::future<core::Result<std::vector<TraceRecord>>>> inflight;
+    for (uint64_t i = 0; i < 64; ++i) {
+        inflight.push_back(remote->Submit({ConfigRead32(0x00), ConfigRead32((i % 16) * 4)}));
+    }
+    for (auto& future : inflight) {
+        auto served = future.get();
+        ASSERT_TRUE(served.IsOk());
+        ASSERT_EQ(served.Value().size(), 2u);
+        EXPECT_EQ(served.Value()[0].value, 0x0001144Du);
+        EXPECT_EQ(served.Value()[1].error, core::ErrorCode::kSuccess);
+    }
+
+    // Calls from several threads share the connection.
+    std::vector<std::thread> threads;
+    std::vector<int> failures(4, 0);
+    for (std::size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            auto* config = dynamic_cast<hal::pci::PciConfig*>(nvme.get());
+            for (int i = 0; i < 200; ++i) {
+                auto id = config->ReadConfig32(kBdf, 0x00);
+                if (id.IsError() || id.Value() != 0x0001144Du) ++failures[t];
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(failures, std::vector<int>(4, 0));
+    EXPECT_EQ(server_.GetStats().connections, 1u);
+}
+
+TEST_F(RemoteTest, ReportsUnknownDeviceAndBadUri) {
+    auto missing = hal::DeviceFactory::CreateFromConfig(
+        MakeEntry("dut", Uri("missing"), "remote"));
+    ASSERT_TRUE(missing.IsOk());
+    EXPECT_EQ(missing.Value()->Init().Error(),
+              core::make_error_code(core::ErrorCode::kNotFound));
+
+    for (const auto& uri : {"remote://127.0.0.1", "remote://127.0.0.1:0/eeprom",
+                            "remote:///eeprom", "remote://127.0.0.1:x/eeprom"}) {
+        auto device = RemoteDevice::Create(MakeEntry("dut", uri, "remote"),
+                                           config::DeviceUri::Parse(uri));
+        EXPECT_EQ(device->Init().Error(),
+                  core::make_error_code(core::ErrorCode::kInvalidArgument))
+            << uri;
+    }
+}
+
+TEST(RemoteServerOptionsTest, ListensOnLoopbackByDefault) {
+    EXPECT_EQ(RemoteServerOptions{}.bind_address, "127.0.0.1");
+}
+
+TEST_F(RemoteTest, ReattachingADeviceReusesItsHandle) {
+    // Devices of one endpoint share a connection; each Connect attaches.
+    auto first = Connect("nvme");
+    auto second = Connect("nvme");
+    auto eeprom = Connect("eeprom");
+    auto* config = dynamic_cast<hal::pci::PciConfig*>(second.get());
+    EXPECT_EQ(config->ReadConfig32(kBdf, 0x00).Value(), 0x0001144Du);
+    EXPECT_EQ(server_.GetStats().connections, 1u);
+    EXPECT_EQ(server_.GetStats().attachments, 2u);
+}
+
+TEST_F(RemoteTest, ReconnectsAfterServerRestart) {
+    auto nvme = Connect("nvme");
+    auto* config = dynamic_cast<hal::pci::PciConfig*>(nvme.get());
+    ASSERT_TRUE(config->ReadConfig32(kBdf, 0x00).IsOk());
+
+    const uint16_t port = server_.Port();
+    server_.Stop();
+    EXPECT_EQ(config->ReadConfig32(kBdf, 0x00).Error(),
+              core::make_error_code(core::ErrorCode::kIOError));
+
+    RemoteServerOptions options;
+    options.bind_address = "127.0.0.1";
+    options.port = port;
+    ASSERT_TRUE(server_.Start(options).IsOk());
+    ASSERT_TRUE(nvme->Reset().IsOk());
+    EXPECT_EQ(config->ReadConfig32(kBdf, 0x00).Value(), 0x0001144Du);
+}
+
+}  // namespace
+}  // namespace plas::remote
@@ -0,0 +1,297 @@
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plas/config/device_entry.h"
+#include "plas/core/error.h"
+#include "plas/hal/device_manager.h"
+#include "plas/hal/driver/sim/sim_device.h"
+#include "plas/hal/interface/device_factory.h"
+#include "plas/hal/interface/i2c.h"
+#include "plas/hal/interface/pci/pci_config.h"
+#include "plas/hal/interface/pci/pci_doe.h"
+#include "plas/hal/transaction_trace.h"
+#include "plas/remote/shm_broker.h"
+#include "plas/remote/shm_device.h"
+
+namespace plas::remote {
+namespace {
+
+using hal::TraceOp;
+using hal::TraceRecord;
+
+constexpr hal::pci::Bdf kBdf{0x03, 0x00, 0x0};
+
+config::DeviceEntry MakeEntry(const std::string& nickname, const std::string& uri,
+                              const std::string& driver,
+                              const std::map<std::string, std::string>& args = {}) {
+    return config::DeviceEntry{nickname, uri, driver, args};
+}
+
+/// A ShmBroker in front of sim devices "eeprom" and "nvme". Clients run in
+/// this process or in forked children.
+class ShmBrokerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ShmDevice::Register();
+        auto& dm = hal::DeviceManager::GetInstance();
+        dm.Reset();
+        Add(std::make_unique<hal::driver::SimI2cDevice>(
+            MakeEntry("eeprom", "sim://i2c:0x50", "sim")));
+        Add(std::make_unique<hal::driver::SimPciDevice>(
+            MakeEntry("nvme", "sim://pci:0000:03:00.0", "sim",
+                      {{"vendor_id", "0x144d"}, {"doe_protocols", "0001:01"}})));
+
+        options_.name = "plas-test-" + std::to_string(::getpid());
+        options_.slots = 4;
+        options_.ring_bytes = 16 * 1024;
+        ASSERT_TRUE(broker_.Start(options_).IsOk());
+    }
+
+    void TearDown() override {
+        broker_.Stop();
+        hal::DeviceManager::GetInstance().Reset();
+    }
+
+    static void Add(std::unique_ptr<hal::Device> device) {
+        ASSERT_TRUE(device->Init().IsOk());
+        ASSERT_TRUE(device->Open().IsOk());
+        std::string name = device->GetName();
+        ASSERT_TRUE(hal::DeviceManager::GetInstance().AddDevice(name, std::move(device)).IsOk());
+    }
+
+    std::string Uri(const std::string& nickname) const {
+        return "shm://" + options_.name + ":" + nickname;
+    }
+
+    std::unique_ptr<hal::Device> Connect(const std::string& nickname) {
+        auto created = hal::DeviceFactory::CreateFromConfig(
+            MakeEntry("shm-" + nickname, Uri(nickname), "shm", {{"timeout_ms", "2000"}}));
+        EXPECT_TRUE(created.IsOk());
+        auto device = std::move(created).Value();
+        EXPECT_TRUE(device->Init().IsOk());
+        EXPECT_TRUE(device->Open().IsOk());
+        return device;
+    }
+
+    /// Run `body` in a forked child; its return value is the exit status.
+    template <typename Body>
+    static pid_t Fork(Body body) {
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            ::_exit(body());
+        }
+        return pid;
+    }
+
+    static int Wait(pid_t pid) {
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+
+    ShmBrokerOptions options_;
+    ShmBroker broker_;
+};
+
+TEST_F(ShmBrokerTest, ServesI2cAndPciCalls) {
+    auto eeprom = Connect("eeprom");
+    EXPECT_EQ(eeprom->GetDriverName(), "shm");
+    EXPECT_EQ(dynamic_cast<ShmDevice*>(eeprom.get())->GetRemoteDriverName(), "sim");
+    EXPECT_EQ(dynamic_cast<hal::pci::PciConfig*>(eeprom.get()), nullptr);
+    auto* i2c = dynamic_cast<hal::I2c*>(eeprom.get());
+    ASSERT_NE(i2c, nullptr);
+    const core::Byte write[] = {0x10, 0xA1, 0xB2, 0xC3};
+    ASSERT_TRUE(i2c->Write(0x50, write, sizeof(write)).IsOk());
+    const core::Byte reg = 0x10;
+    core::Byte buf[3] = {};
+    ASSERT_EQ(i2c->WriteRead(0x50, &reg, 1, buf, 3).Value(), 3u);
+    EXPECT_EQ(buf[0], 0xA1);
+    EXPECT_EQ(buf[2], 0xC3);
+    EXPECT_EQ(i2c->Read(0x51, buf, 1).Error(),
+              core::make_error_code(core::ErrorCode::kIOError));
+
+    auto nvme = Connect("nvme");
+    auto* config = dynamic_cast<hal::pci::PciConfig*>(nvme.get());
+    auto* doe = dynamic_cast<hal::pci::PciDoe*>(nvme.get());
+    ASSERT_NE(doe, nullptr);
+    EXPECT_EQ(config->ReadConfig32(kBdf, 0x00).Value(), 0x0001144Du);
+    auto echo = doe->DoeExchange(kBdf, 0x100, {0x0001, 0x01}, {0xCAFE});
+    ASSERT_TRUE(echo.IsOk());
+    EXPECT_EQ(echo.Value(), (hal::pci::DoePayload{0xCAFE}));
+    EXPECT_EQ(broker_.GetStats().attaches, 2u);
+}
+
+TEST_F(ShmBrokerTest, BatchIsOneRequestAndStopsAtFirstFailure) {
+    auto eeprom = Connect("eeprom");
+    auto* shm = dynamic_cast<ShmDevice*>(eeprom.get());
+    const uint64_t before = broker_.GetStats().requests;
+
+    std::vector<TraceRecord> calls(3);
+    calls[0].op = TraceOp::kI2cWrite;
+    calls[0].target = 0x50;
+    calls[0].arg = 1;
+    calls[0].request = {0x00, 0x42};
+    calls[1].op = TraceOp::kI2cRead;
+    calls[1].target = 0x51;  // NACK
+    calls[1].arg = 1;
+    calls[1].length = 1;
+    calls[2] = calls[0];
+    ASSERT_TRUE(shm->ExecuteBatch(calls.data(), calls.size()).IsOk());
+    EXPECT_EQ(calls[0].error, core::ErrorCode::kSuccess);
+    EXPECT_EQ(calls[1].error, core::ErrorCode::kIOError);
+    EXPECT_EQ(calls[2].error, core::ErrorCode::kCancelled);
+    EXPECT_EQ(broker_.GetStats().requests, before + 1);
+
+    core::Byte data[1] = {};
+    hal::I2cMessage msgs[2] = {{0x50, calls[0].request.data(), 1, false, false, 0},
+                               {0x50, data, 1, true, true, 0}};
+    ASSERT_TRUE(dynamic_cast<hal::I2c*>(eeprom.get())->Transfer(msgs, 2).IsOk());
+    EXPECT_EQ(data[0], 0x42);
+    EXPECT_EQ(broker_.GetStats().requests, before + 2);
+}
+
+TEST_F(ShmBrokerTest, ServesSeveralProcessesAtOnce) {
+    // Every child writes its own EEPROM byte and reads it back under one
+    // batch, so interleaving between clients would show up as a mismatch.
+    std::vector<pid_t> children;
+    for (int child = 0; child < 3; ++child) {
+        children.push_back(Fork([this, child] {
+            auto created = hal::DeviceFactory::CreateFromConfig(
+                MakeEntry("eeprom", Uri("eeprom"), "shm"));
+            if (created.IsError() || created.Value()->Init().IsError() ||
+                created.Value()->Open().IsError()) {
+                return 100;
+            }
+            auto* shm = dynamic_cast<ShmDevice*>(created.Value().get());
+            int failures = 0;
+            for (int i = 0; i < 500; ++i) {
+                const auto value = static_cast<core::Byte>(child * 64 + i % 64);
+                std::vector<TraceRecord> calls(2);
+                calls[0].op = TraceOp::kI2cWrite;
+                calls[0].target = 0x50;
+                calls[0].arg = 1;
+                calls[0].request = {0x20, value};
+                calls[1].op = TraceOp::kI2cWriteRead;
+                calls[1].target = 0x50;
+                calls[1].length = 1;
+                calls[1].request = {0x20};
+                if (shm->ExecuteBatch(calls.data(), calls.size()).IsError() ||
+                    calls[1].response != std::vector<core::Byte>{value}) {
+                    ++failures;
+                }
+            }
+            return failures;
+        }));
+    }
+    for (pid_t pid : children) {
+        EXPECT_EQ(Wait(pid), 0);
+    }
+    EXPECT_EQ(broker_.GetStats().requests, 3u * 500u);
+}
+
+TEST_F(ShmBrokerTest, ReclaimsSlotsOfDeadClients) {
+    // Children that hold every slot and exit without detaching.
+    std::vector<pid_t> children;
+    for (uint32_t i = 0; i < options_.slots; ++i) {
+        children.push_back(Fork([this] {
+            auto created = hal::DeviceFactory::CreateFromConfig(
+                MakeEntry("nvme", Uri("nvme"), "shm"));
+            if (created.IsError() || created.Value()->Init().IsError()) {
+                return 1;
+            }
+            created.Value().release();  // leak: the slot stays claimed
+            return 0;
+        }));
+    }
+    for (pid_t pid : children) {
+        ASSERT_EQ(Wait(pid), 0);
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (broker_.GetStats().reclaimed < options_.slots &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_EQ(broker_.GetStats().reclaimed, options_.slots);
+    auto nvme = Connect("nvme");
+    EXPECT_EQ(dynamic_cast<hal::pci::PciConfig*>(nvme.get())->ReadConfig32(kBdf, 0).Value(),
+              0x0001144Du);
+}
+
+TEST_F(ShmBrokerTest, ReportsBadUriMissingDeviceAndFullBroker) {
+    for (const auto& uri : {std::string("shm://eeprom"), std::string("shm://bad/name:eeprom"),
+                            std::string("shm://:eeprom"), Uri("")}) {
+        auto device = ShmDevice::Create(MakeEntry("dut", uri, "shm"),
+                                        config::DeviceUri::Parse(uri));
+        EXPECT_EQ(device->Init().Error(),
+                  core::make_error_code(core::ErrorCode::kInvalidArgument))
+            << uri;
+    }
+    auto missing = ShmDevice::Create(MakeEntry("dut", Uri("missing"), "shm"),
+                                     config::DeviceUri::Parse(Uri("missing")));
+    EXPECT_EQ(missing->Init().Error(), core::make_error_code(core::ErrorCode::kNotFound));
+    auto no_broker = ShmDevice::Create(MakeEntry("dut", "shm://no-such-broker:eeprom", "shm"),
+                                       config::DeviceUri::Parse("shm://no-such-broker:eeprom"));
+    EXPECT_EQ(no_broker->Init().Error(), core::make_error_code(core::ErrorCode::kNotFound));
+
+    std::vector<std::unique_ptr<hal::Device>> held;
+    for (uint32_t i = 0; i < options_.slots; ++i) {
+        held.push_back(Connect("eeprom"));
+    }
+    auto full = ShmDevice::Create(MakeEntry("dut", Uri("eeprom"), "shm"),
+                                  config::DeviceUri::Parse(Uri("eeprom")));
+    EXPECT_EQ(full->Init().Error(),
+              core::make_error_code(core::ErrorCode::kResourceExhausted));
+    held.pop_back();  // detaching frees the slot for the next client
+    auto next = Connect("eeprom");
+    EXPECT_EQ(next->GetState(), hal::DeviceState::kOpen);
+
+    ShmBroker second;
+    EXPECT_EQ(second.Start(options_).Error(),
+              core::make_error_code(core::ErrorCode::kAlreadyOpen));
+}
+
+TEST_F(ShmBrokerTest, RefusesBatchesLargerThanTheRing) {
+    auto nvme = Connect("nvme");
+    auto* shm = dynamic_cast<ShmDevice*>(nvme.get());
+    TraceRecord read;
+    read.op = TraceOp::kConfigReadBlock;
+    read.target = kBdf.Pack();
+    read.length = options_.ring_bytes;
+    EXPECT_EQ(shm->Execute(read).Error(), core::make_error_code(core::ErrorCode::kOverflow));
+
+    TraceRecord write;
+    write.op = TraceOp::kI2cWrite;
+    write.request.resize(options_.ring_bytes);
+    EXPECT_EQ(shm->Execute(write).Error(), core::make_error_code(core::ErrorCode::kOverflow));
+
+    // The slot is still in sync.
+    EXPECT_EQ(dynamic_cast<hal::pci::PciConfig*>(nvme.get())->ReadConfig32(kBdf, 0).Value(),
+              0x0001144Du);
+}
+
+TEST_F(ShmBrokerTest, ReattachesAfterBrokerRestart) {
+    auto nvme = Connect("nvme");
+    auto* config = dynamic_cast<hal::pci::PciConfig*>(nvme.get());
+    ASSERT_TRUE(config->ReadConfig32(kBdf, 0x00).IsOk());
+
+    broker_.Stop();
+    EXPECT_EQ(config->ReadConfig32(kBdf, 0x00).Error(),
+              core::make_error_code(core::ErrorCode::kIOError));
+
+    ASSERT_TRUE(broker_.Start(options_).IsOk());
+    ASSERT_TRUE(nvme->Reset().IsOk());
+    EXPECT_EQ(config->ReadConfig32(kBdf, 0x00).Value(), 0x0001144Du);
+}
+
+}  // namespace
+}  // namespace plas::remote